@@ -0,0 +1,116 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiCallProfile.h
+ *   Declaration of functionality for counting and timing calls the application makes to the
+ *   DirectInput and WinMM entry points that Xidi implements.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "ApiWindows.h"
+#include "ApiXidi.h"
+#include "DurationHistogram.h"
+
+/// Counts and times the enclosing entry point, starting from wherever this macro appears until it
+/// returns. Must appear at most once per function. Reads no clock and records nothing if API call
+/// profiling is disabled.
+#define PROFILE_API_CALL()                                                                         \
+  static ::Xidi::ApiCallProfile::SMethodProfile* const kMethodProfile =                            \
+      ::Xidi::ApiCallProfile::Register(__FUNCTIONW__);                                             \
+  const ::Xidi::ApiCallProfile::ScopedCall profiledApiCall(kMethodProfile)
+
+namespace Xidi
+{
+  namespace ApiCallProfile
+  {
+    /// Type used to report statistics.
+    using SMethodStatistics = Api::IApiCallProfile::SMethodStatistics;
+
+    /// Statistics collected for a single entry point. Updated using relaxed atomic operations so
+    /// that any number of threads can record and read at the same time.
+    struct SMethodProfile
+    {
+      /// Number of calls made.
+      std::atomic<uint64_t> numCalls;
+
+      /// Total time spent in all calls, in performance counter ticks.
+      std::atomic<uint64_t> totalTicks;
+
+      /// Distribution of the time spent in each call.
+      DurationHistogram callDuration;
+    };
+
+    /// Determines whether or not API call profiling is enabled in the configuration file.
+    /// @return `true` if so, `false` if not.
+    bool IsEnabled(void);
+
+    /// Retrieves the statistics object for the entry point with the specified name, creating it if
+    /// it does not already exist.
+    /// @param [in] methodName Name of the entry point, which must remain valid for the lifetime
+    /// of the process.
+    /// @return Pointer to the statistics object, which is never destroyed, or `nullptr` if API
+    /// call profiling is disabled.
+    SMethodProfile* Register(const wchar_t* methodName);
+
+    /// Records a single call to an entry point.
+    /// @param [in] methodProfile Statistics object for the entry point.
+    /// @param [in] beginTicks Performance counter value when the call began.
+    /// @param [in] endTicks Performance counter value when the call ended.
+    void RecordCall(SMethodProfile* methodProfile, int64_t beginTicks, int64_t endTicks);
+
+    /// Retrieves a snapshot of the statistics for all entry points called so far, in order of
+    /// method name.
+    /// @param [out] statistics Filled in with statistics for as many entry points as fit.
+    /// @return Total number of entry points called so far.
+    size_t GetStatistics(std::span<SMethodStatistics> statistics);
+
+    /// Outputs the statistics collected for all entry points as informational messages. Does
+    /// nothing if API call profiling is disabled.
+    void OutputSummary(void);
+
+    /// Measures the time from its construction to its destruction and records it as a single call
+    /// to an entry point. Typically created using the `PROFILE_API_CALL` macro.
+    class ScopedCall
+    {
+    public:
+
+      inline ScopedCall(SMethodProfile* methodProfile)
+          : methodProfile(methodProfile), beginTicks((nullptr == methodProfile) ? 0 : Now())
+      {}
+
+      ScopedCall(const ScopedCall& other) = delete;
+
+      inline ~ScopedCall(void)
+      {
+        if (nullptr != methodProfile) RecordCall(methodProfile, beginTicks, Now());
+      }
+
+    private:
+
+      /// Retrieves the current performance counter value.
+      /// @return Current performance counter value.
+      static inline int64_t Now(void)
+      {
+        LARGE_INTEGER performanceCounter;
+        QueryPerformanceCounter(&performanceCounter);
+        return performanceCounter.QuadPart;
+      }
+
+      /// Statistics object for the entry point, or `nullptr` if API call profiling is disabled.
+      SMethodProfile* const methodProfile;
+
+      /// Performance counter value when the call began.
+      const int64_t beginTicks;
+    };
+  } // namespace ApiCallProfile
+} // namespace Xidi
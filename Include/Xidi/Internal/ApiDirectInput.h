@@ -35,6 +35,40 @@
 #define DIDFT_OPTIONAL 0x80000000
 #endif
 
+/// Xidi-specific device property with which applications can control how often the physical
+/// controller behind a device is polled and how often the device's state change event is signalled
+/// due to axis movement alone. Supported only with `DIPH_DEVICE` and exchanged using a
+/// #DIPROPXIDIPOLLINGPOLICY structure. Applications that do not know about Xidi never use it, and
+/// applications that do can detect that it is unavailable because other implementations of
+/// DirectInput reject it as unsupported.
+inline constexpr GUID DIPROP_XIDI_POLLINGPOLICY = {
+    0x58494449, 0x5050, 0x4f4c, {'X', 'I', 'D', 'I', 'P', 'O', 'L', 'L'}};
+
+/// Value of #DIPROPXIDIPOLLINGPOLICY::dwStateChangeEventPeriodMilliseconds that reverts to the
+/// state change event period set in the configuration file.
+inline constexpr DWORD DIPROPXIDI_STATECHANGEEVENTPERIOD_DEFAULT = static_cast<DWORD>(-1);
+
+/// Property structure for #DIPROP_XIDI_POLLINGPOLICY. Polling period requests from all devices
+/// associated with the same physical controller are arbitrated so that the shortest requested
+/// period wins, and each device's request is withdrawn when it is changed to 0 or when the device
+/// is released. Requests never make polling less frequent than the period set in the
+/// configuration file.
+struct DIPROPXIDIPOLLINGPOLICY
+{
+  /// Standard property header.
+  DIPROPHEADER diph;
+
+  /// When setting, requested physical controller polling period in milliseconds, or 0 to
+  /// withdraw any previous request. When getting, polling period currently in effect.
+  DWORD dwPollingPeriodMilliseconds;
+
+  /// Minimum time between state change event signals caused by axis movement alone, in
+  /// milliseconds, 0 for no minimum. When setting, can also be
+  /// #DIPROPXIDI_STATECHANGEEVENTPERIOD_DEFAULT to use the period set in the configuration file.
+  /// When getting, period currently in effect.
+  DWORD dwStateChangeEventPeriodMilliseconds;
+};
+
 /// Enumerates supported DirectInput interface version classes.
 enum class EDirectInputVersion
 {
@@ -101,6 +135,11 @@ template <> struct DirectInputTypes<EDirectInputVersion::k8A>
     return (IsEqualIID(iid, IID_IUnknown) || IsEqualIID(iid, IID_IDirectInputDevice8A));
   }
 
+  static inline const IID& DirectInputDeviceIID(void)
+  {
+    return IID_IDirectInputDevice8A;
+  }
+
   static inline DWORD XinputGamepadDeviceType(void)
   {
     return ((DIDEVTYPE_HID) | (DI8DEVTYPE_GAMEPAD) | ((DI8DEVTYPEGAMEPAD_STANDARD) << 8));
@@ -143,6 +182,11 @@ template <> struct DirectInputTypes<EDirectInputVersion::k8W>
     return (IsEqualIID(iid, IID_IUnknown) || IsEqualIID(iid, IID_IDirectInputDevice8W));
   }
 
+  static inline const IID& DirectInputDeviceIID(void)
+  {
+    return IID_IDirectInputDevice8W;
+  }
+
   static inline DWORD XinputGamepadDeviceType(void)
   {
     return ((DIDEVTYPE_HID) | (DI8DEVTYPE_GAMEPAD) | ((DI8DEVTYPEGAMEPAD_STANDARD) << 8));
@@ -186,6 +230,11 @@ template <> struct DirectInputTypes<EDirectInputVersion::kLegacyA>
         IsEqualIID(iid, IID_IDirectInputDevice2A) || IsEqualIID(iid, IID_IDirectInputDeviceA));
   }
 
+  static inline const IID& DirectInputDeviceIID(void)
+  {
+    return IID_IDirectInputDevice7A;
+  }
+
   static inline DWORD XinputGamepadDeviceType(void)
   {
     return (
@@ -231,6 +280,11 @@ template <> struct DirectInputTypes<EDirectInputVersion::kLegacyW>
         IsEqualIID(iid, IID_IDirectInputDevice2W) || IsEqualIID(iid, IID_IDirectInputDeviceW));
   }
 
+  static inline const IID& DirectInputDeviceIID(void)
+  {
+    return IID_IDirectInputDevice7W;
+  }
+
   static inline DWORD XinputGamepadDeviceType(void)
   {
     return (
@@ -23,6 +23,8 @@
 
 // clang-format on
 
+#include <cfgmgr32.h>
 #include <psapi.h>
 #include <shlobj.h>
 #include <shlwapi.h>
+#include <tlhelp32.h>
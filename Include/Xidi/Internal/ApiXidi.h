@@ -11,14 +11,19 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <span>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <Infra/Core/ProcessInfo.h>
 
+#include "ControllerTypes.h"
+
 namespace Xidi
 {
   namespace Api
@@ -35,7 +40,37 @@ namespace Xidi
       ImportFunctions,
 
       /// IImportFunctions2
-      ImportFunctions2
+      ImportFunctions2,
+
+      /// IControllerMapper
+      ControllerMapper,
+
+      /// IInputEmissionStatistics
+      InputEmissionStatistics,
+
+      /// IInputLatency
+      InputLatency,
+
+      /// IPollingStatistics
+      PollingStatistics,
+
+      /// IControllerState
+      ControllerState,
+
+      /// IStateExport
+      StateExport,
+
+      /// IStateChangeSubscription
+      StateChangeSubscription,
+
+      /// IFlightRecorder
+      FlightRecorder,
+
+      /// IApiCallProfile
+      ApiCallProfile,
+
+      /// IControllerStatus
+      ControllerStatus
     };
 
     /// Xidi API base class. All API classes must inherit from this class.
@@ -51,6 +86,23 @@ namespace Xidi
       virtual ~IXidi(void) = default;
     };
 
+    /// Summary of a distribution of durations, used by API classes that report timing statistics.
+    /// Percentiles are accurate to within one eighth of their value.
+    struct SDurationStatistics
+    {
+      /// Number of samples included in the statistics.
+      uint64_t numSamples;
+
+      /// Median duration, in microseconds.
+      uint64_t p50Microseconds;
+
+      /// 99th percentile duration, in microseconds.
+      uint64_t p99Microseconds;
+
+      /// Largest single duration, in microseconds.
+      uint64_t maxMicroseconds;
+    };
+
     /// Xidi API class for obtaining metadata about the running Xidi module.
     /// Guaranteed to be implemented and available in all Xidi modules.
     class IMetadata : public IXidi
@@ -111,6 +163,517 @@ namespace Xidi
       inline IImportFunctions2(void) : IXidi(EClass::ImportFunctions2) {}
     };
 
+    /// Xidi API class for inspecting and replacing the mapper used for each physical controller
+    /// while the application is running. Allows switching between controller layouts without
+    /// restarting the application. Physical controllers are identified by zero-based index.
+    class IControllerMapper : public IXidi
+    {
+    public:
+
+      /// Retrieves and returns the name of the mapper currently used for the specified physical
+      /// controller.
+      /// @param [in] controllerIndex Zero-based index of the physical controller of interest.
+      /// @return Name of the mapper, or an empty string if the index is out of range.
+      virtual std::wstring_view GetMapperName(unsigned int controllerIndex) const = 0;
+
+      /// Replaces the mapper used for the specified physical controller with the mapper of the
+      /// specified name. Threads servicing the physical controller are not blocked, and they pick
+      /// up the new mapper before their next use of it. Virtual controllers that already exist keep
+      /// the capabilities they were created with, so applications may need to acquire their
+      /// devices again if the capabilities of the two mappers differ.
+      /// @param [in] controllerIndex Zero-based index of the physical controller of interest.
+      /// @param [in] mapperName Name of the mapper to use, which can be any built-in mapper or any
+      /// custom mapper defined in the configuration file.
+      /// @return `true` if the mapper was replaced, `false` if the index is out of range or no
+      /// mapper exists with the specified name.
+      virtual bool SetMapper(unsigned int controllerIndex, std::wstring_view mapperName) = 0;
+
+    protected:
+
+      inline IControllerMapper(void) : IXidi(EClass::ControllerMapper) {}
+    };
+
+    /// Xidi API class for inspecting how much keyboard and mouse input Xidi submits to the system
+    /// on behalf of virtual keyboard and mouse mappers, and how long doing so takes. All counters
+    /// are cumulative since the emitter started.
+    class IInputEmissionStatistics : public IXidi
+    {
+    public:
+
+      /// Enumeration of emitters that submit input to the system.
+      enum class EEmitter
+      {
+        Keyboard,
+        Mouse
+      };
+
+      /// Statistics for a single emitter.
+      struct SStatistics
+      {
+        /// Number of times the emitter checked for input to be submitted.
+        uint64_t numTicks;
+
+        /// Number of key or button state transitions detected.
+        uint64_t numTransitions;
+
+        /// Number of calls made to `SendInput`.
+        uint64_t numSendInputCalls;
+
+        /// Number of calls made to `SendInput` that did not send all of the supplied events.
+        uint64_t numSendInputFailures;
+
+        /// Number of input events that `SendInput` reported as sent.
+        uint64_t numEventsSent;
+
+        /// Total time spent inside `SendInput`, in microseconds.
+        uint64_t totalSendInputMicroseconds;
+
+        /// Number of latency measurements included in the latency statistics.
+        uint64_t numLatencySamples;
+
+        /// Total time between the earliest mapper contribution and the emission of the transitions
+        /// it caused, in microseconds, summed over all latency measurements.
+        uint64_t totalLatencyMicroseconds;
+
+        /// Largest single latency measurement, in microseconds.
+        uint64_t maxLatencyMicroseconds;
+      };
+
+      /// Retrieves a snapshot of the statistics for the specified emitter.
+      /// @param [in] emitter Emitter of interest.
+      /// @return Statistics for the emitter.
+      virtual SStatistics GetStatistics(EEmitter emitter) const = 0;
+
+    protected:
+
+      inline IInputEmissionStatistics(void) : IXidi(EClass::InputEmissionStatistics) {}
+    };
+
+    /// Xidi API class for inspecting how long physical controller input takes to reach the
+    /// application. Each sample follows one change in virtual controller state from the moment
+    /// XInput reports it until the application first reads virtual controller state afterwards,
+    /// and is broken down into stages. Only available if input latency tracing is enabled in the
+    /// configuration file. Physical controllers are identified by zero-based index. All statistics
+    /// are cumulative since the application started.
+    class IInputLatency : public IXidi
+    {
+    public:
+
+      /// Enumeration of the stages into which each sample is broken down.
+      enum class EStage
+      {
+        /// From XInput returning physical controller state to the mapper producing virtual
+        /// controller state from it.
+        Mapping,
+
+        /// From the mapper producing virtual controller state to that state being published for
+        /// all readers.
+        Publication,
+
+        /// From publication to all virtual controllers having applied their properties to the new
+        /// state.
+        Delivery,
+
+        /// From all virtual controllers having the new state to the application first reading it
+        /// using `GetDeviceState`, `GetDeviceData`, `joyGetPos`, or `joyGetPosEx`.
+        ApplicationRead,
+
+        /// From XInput returning physical controller state to the application first reading the
+        /// resulting virtual controller state. Covers all other stages.
+        EndToEnd,
+
+        /// Not used as a value. Identifies the number of enumerators present in this enumeration.
+        Count
+      };
+
+      /// Statistics for a single stage of a single physical controller.
+      using SStageStatistics = SDurationStatistics;
+
+      /// Determines whether or not input latency is being traced.
+      /// @return `true` if so, `false` if not, in which case all statistics are empty.
+      virtual bool IsEnabled(void) const = 0;
+
+      /// Retrieves a snapshot of the statistics for the specified stage of the specified physical
+      /// controller.
+      /// @param [in] controllerIndex Zero-based index of the physical controller of interest.
+      /// @param [in] stage Stage of interest.
+      /// @return Statistics for the stage, which are empty if either parameter is out of range.
+      virtual SStageStatistics GetStatistics(unsigned int controllerIndex, EStage stage) const = 0;
+
+    protected:
+
+      inline IInputLatency(void) : IXidi(EClass::InputLatency) {}
+    };
+
+    /// Xidi API class for inspecting how closely the threads that poll physical controllers keep
+    /// to their configured schedule and how long each part of a poll takes. Physical controllers
+    /// are identified by zero-based index. All statistics are cumulative since the application
+    /// started.
+    class IPollingStatistics : public IXidi
+    {
+    public:
+
+      /// Statistics for a single physical controller.
+      struct SStatistics
+      {
+        /// Configured polling period, in microseconds, or 0 if the polling thread has not started.
+        uint64_t configuredPeriodMicroseconds;
+
+        /// Whether or not the polling thread waits using a high-resolution waitable timer.
+        bool isHighResolutionTimer;
+
+        /// System timer resolution requested at startup, in milliseconds, or 0 if the request
+        /// failed. Only relevant if the polling thread does not use a high-resolution timer.
+        unsigned int systemTimerResolutionMilliseconds;
+
+        /// Number of whole polling periods that were skipped because the polling thread woke up
+        /// too late to poll on schedule.
+        uint64_t numMissedDeadlines;
+
+        /// Time between the starts of successive scheduled polls while the physical controller
+        /// is connected.
+        SDurationStatistics pollInterval;
+
+        /// Time spent in each XInput state query, including on-demand polls.
+        SDurationStatistics xinputGetStateDuration;
+
+        /// Time spent by the mapper producing virtual controller state from each change in
+        /// physical controller state, including on-demand polls.
+        SDurationStatistics mappingDuration;
+      };
+
+      /// Retrieves a snapshot of the statistics for the specified physical controller.
+      /// @param [in] controllerIndex Zero-based index of the physical controller of interest.
+      /// @return Statistics for the physical controller, which are empty if the index is out of
+      /// range.
+      virtual SStatistics GetStatistics(unsigned int controllerIndex) const = 0;
+
+    protected:
+
+      inline IPollingStatistics(void) : IXidi(EClass::PollingStatistics) {}
+    };
+
+    /// Xidi API class for reading the current state of all physical controllers in a single call,
+    /// intended for integrations such as overlays that need all of them at once. Physical
+    /// controllers are identified by zero-based index.
+    class IControllerState : public IXidi
+    {
+    public:
+
+      /// State of a single physical controller.
+      struct SControllerState
+      {
+        /// Physical controller state, as most recently polled.
+        Controller::SPhysicalState physicalState;
+
+        /// Generation number of the physical controller state. Increases every time that state
+        /// changes, so comparing it with a previous value is sufficient to detect a change.
+        uint64_t physicalStateGeneration;
+
+        /// Virtual controller state produced by the mapper from the physical controller state,
+        /// before any application-specified properties are applied.
+        Controller::SState rawVirtualState;
+
+        /// Generation number of the virtual controller state. Increases every time that state
+        /// changes, so comparing it with a previous value is sufficient to detect a change.
+        uint64_t rawVirtualStateGeneration;
+      };
+
+      /// Retrieves and returns the number of physical controllers whose state is available.
+      /// @return Number of physical controllers.
+      virtual unsigned int GetControllerCount(void) const = 0;
+
+      /// Retrieves the current state of the physical controllers, starting with the one at index 0,
+      /// for as many physical controllers as there are elements in the supplied buffer. Each
+      /// element is read without waiting for any thread that polls physical controllers, and its
+      /// physical controller state is never older than the one from which its virtual controller
+      /// state was produced.
+      /// @param [out] states Buffer to be filled with physical controller states.
+      /// @return Number of elements filled, which is the smaller of the buffer size and the number
+      /// of physical controllers.
+      virtual unsigned int GetStates(std::span<SControllerState> states) const = 0;
+
+    protected:
+
+      inline IControllerState(void) : IXidi(EClass::ControllerState) {}
+    };
+
+    /// Xidi API class for reading the state of physical controllers directly from memory that Xidi
+    /// updates whenever it polls them, without making any calls. Intended for companion modules
+    /// that read state at their own rate. Physical controllers are identified by zero-based index.
+    class IStateExport : public IXidi
+    {
+    public:
+
+      /// Version of the layout of #SStateBlock. Changes whenever the layout changes, including
+      /// whenever the layout of the controller state it holds changes.
+      static constexpr uint32_t kStateBlockVersion = 2;
+
+      /// Holds the state of a single physical controller, protected by a sequence lock so that any
+      /// number of readers can read it without ever blocking the thread that writes it. Each block
+      /// starts on its own cache line.
+      struct alignas(64) SStateBlock
+      {
+        /// Number of storage words needed to hold a controller state.
+        static constexpr size_t kWordCount =
+            (sizeof(IControllerState::SControllerState) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        /// Layout version of this block, which readers should compare with #kStateBlockVersion
+        /// before reading anything else.
+        const uint32_t version = kStateBlockVersion;
+
+        /// Sequence number, which is odd while a write is in progress and increases by 2 with
+        /// every completed write.
+        std::atomic<uint32_t> sequence = 0;
+
+        /// Storage for the controller state.
+        std::atomic<uint64_t> words[kWordCount] = {};
+
+        /// Reads the controller state held in this block, retrying for as long as a write
+        /// overlaps. Never blocks the writer.
+        /// @param [out] state Filled in with the controller state.
+        /// @return `true` if the state was read, `false` if the layout version of this block does
+        /// not match the layout version known to the reader.
+        inline bool Read(IControllerState::SControllerState& state) const
+        {
+          if (kStateBlockVersion != version) return false;
+
+          uint64_t snapshot[kWordCount];
+          uint32_t sequenceBefore = 0;
+          uint32_t sequenceAfter = 0;
+
+          do
+          {
+            do
+            {
+              sequenceBefore = sequence.load(std::memory_order_acquire);
+            } while (0 != (sequenceBefore & 1));
+
+            for (size_t i = 0; i < kWordCount; ++i)
+              snapshot[i] = words[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            sequenceAfter = sequence.load(std::memory_order_relaxed);
+          } while (sequenceBefore != sequenceAfter);
+
+          std::memcpy(&state, snapshot, sizeof(state));
+          return true;
+        }
+
+        /// Writes a new controller state to this block. Must only be invoked by one thread at a
+        /// time.
+        /// @param [in] state New controller state.
+        inline void Write(const IControllerState::SControllerState& state)
+        {
+          uint64_t newWords[kWordCount] = {};
+          std::memcpy(newWords, &state, sizeof(state));
+
+          const uint32_t currentSequence = sequence.load(std::memory_order_relaxed);
+          sequence.store(currentSequence + 1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+
+          for (size_t i = 0; i < kWordCount; ++i)
+            words[i].store(newWords[i], std::memory_order_relaxed);
+
+          sequence.store(currentSequence + 2, std::memory_order_release);
+        }
+      };
+
+      /// Retrieves read-only access to the state blocks of all physical controllers, which remain
+      /// valid for as long as the Xidi module is loaded. Element index is physical controller
+      /// index.
+      /// @return Read-only view of the state blocks.
+      virtual std::span<const SStateBlock> GetStateBlocks(void) const = 0;
+
+    protected:
+
+      inline IStateExport(void) : IXidi(EClass::StateExport) {}
+    };
+
+    /// Xidi API class for receiving notifications whenever the state of a physical controller
+    /// changes, so that integrations such as companion modules and overlays can react to new state
+    /// without polling for it. Physical controllers are identified by zero-based index.
+    class IStateChangeSubscription : public IXidi
+    {
+    public:
+
+      /// Type of function invoked whenever the state of a physical controller changes, either its
+      /// physical state or the raw virtual state produced from it. Invoked on the thread that
+      /// polls the physical controller, so it must return quickly and must not invoke any methods
+      /// of this interface.
+      /// @param [in] controllerIndex Index of the physical controller whose state changed.
+      /// @param [in] state New state of the physical controller.
+      /// @param [in] changedElements Virtual controller elements whose raw virtual state values
+      /// differ from the previous notification for the same physical controller. Zero if only the
+      /// physical state changed.
+      /// @param [in] timestamp Performance counter value at which the poll that produced the new
+      /// state began.
+      /// @param [in] context Opaque value that was supplied when subscribing.
+      using TStateChangeCallback = void (*)(
+          unsigned int controllerIndex,
+          const IControllerState::SControllerState& state,
+          Controller::TElementMask changedElements,
+          int64_t timestamp,
+          void* context);
+
+      /// Subscribes for notifications whenever the state of the specified physical controller
+      /// changes. The same callback can be subscribed more than once with different contexts.
+      /// @param [in] controllerIndex Index of the physical controller of interest.
+      /// @param [in] callback Function to invoke on every state change.
+      /// @param [in] context Opaque value to pass to the callback function.
+      /// @return `true` if the subscription was successful, `false` if the physical controller
+      /// index is invalid or the callback is already subscribed with the same context.
+      virtual bool Subscribe(
+          unsigned int controllerIndex, TStateChangeCallback callback, void* context) = 0;
+
+      /// Removes a subscription previously created using #Subscribe. Once this method returns the
+      /// callback function is not executing and will not be invoked again for this subscription.
+      /// @param [in] controllerIndex Index of the physical controller of interest.
+      /// @param [in] callback Function that was subscribed.
+      /// @param [in] context Opaque value that was supplied when subscribing.
+      /// @return `true` if the subscription existed and was removed, `false` otherwise.
+      virtual bool Unsubscribe(
+          unsigned int controllerIndex, TStateChangeCallback callback, void* context) = 0;
+
+    protected:
+
+      inline IStateChangeSubscription(void) : IXidi(EClass::StateChangeSubscription) {}
+    };
+
+    /// Xidi API class for writing the contents of the flight recorder to a file on demand. The
+    /// flight recorder always retains the most recent physical controller states, DirectInput and
+    /// WinMM calls made by the application, and force feedback writes, so that a file written
+    /// right after a problem occurs describes what led up to it.
+    class IFlightRecorder : public IXidi
+    {
+    public:
+
+      /// Writes everything the flight recorder currently retains to the specified file, replacing
+      /// it if it exists. Recording continues while the file is written.
+      /// @param [in] filename Name of the file to write. Must be null-terminated.
+      /// @return `true` if successful, `false` if the file could not be written or another file is
+      /// already being written.
+      virtual bool DumpToFile(std::wstring_view filename) const = 0;
+
+    protected:
+
+      inline IFlightRecorder(void) : IXidi(EClass::FlightRecorder) {}
+    };
+
+    /// Xidi API class for inspecting how often the application calls each DirectInput and WinMM
+    /// entry point that Xidi implements and how long each call takes. Only available if API call
+    /// profiling is enabled in the configuration file. All statistics are cumulative since the
+    /// application started.
+    class IApiCallProfile : public IXidi
+    {
+    public:
+
+      /// Statistics for a single entry point.
+      struct SMethodStatistics
+      {
+        /// Fully-qualified name of the entry point, which remains valid for as long as the Xidi
+        /// module is loaded. Methods of class templates are reported separately for each
+        /// DirectInput version.
+        std::wstring_view methodName;
+
+        /// Number of calls made.
+        uint64_t numCalls;
+
+        /// Total time spent in all calls, in microseconds. Includes time spent in any application
+        /// callbacks invoked during a call, such as during enumeration.
+        uint64_t totalMicroseconds;
+
+        /// Distribution of the time spent in each call.
+        SDurationStatistics callDuration;
+      };
+
+      /// Determines whether or not API call profiling is enabled.
+      /// @return `true` if so, `false` if not.
+      virtual bool IsEnabled(void) const = 0;
+
+      /// Retrieves a snapshot of the statistics for entry points that the application has called
+      /// at least once, in order of method name.
+      /// @param [out] statistics Filled in with statistics for as many entry points as fit.
+      /// @return Total number of entry points that the application has called, which can be larger
+      /// than the number filled in.
+      virtual size_t GetStatistics(std::span<SMethodStatistics> statistics) const = 0;
+
+    protected:
+
+      inline IApiCallProfile(void) : IXidi(EClass::ApiCallProfile) {}
+    };
+
+    /// Xidi API class for reading the battery and capabilities information of physical
+    /// controllers. Xidi queries this information at a low rate, and whenever a physical
+    /// controller is connected, and caches the results. Consumers such as overlays can read the
+    /// cached results as often as they like instead of issuing their own XInput queries, which on
+    /// wireless controllers compete with polling for the same link. Queries only start the first
+    /// time a consumer reads the cached results. Physical controllers are identified by
+    /// zero-based index.
+    class IControllerStatus : public IXidi
+    {
+    public:
+
+      /// Battery and capabilities information for a single physical controller. Values use the
+      /// same encoding as the corresponding members of the XInput capabilities and battery
+      /// information structures.
+      struct SControllerStatus
+      {
+        /// Time of the most recent query, in milliseconds since system start as reported by
+        /// `GetTickCount64`, or 0 if no query has happened yet. All other members are meaningless
+        /// if this member is 0.
+        uint64_t queryTimeMilliseconds;
+
+        /// Whether or not the physical controller was connected as of the most recent query.
+        bool isConnected;
+
+        /// Whether or not the capabilities members hold information.
+        bool hasCapabilities;
+
+        /// Whether or not the battery members hold information.
+        bool hasBatteryInformation;
+
+        /// Device type, corresponding to the `Type` member of `XINPUT_CAPABILITIES`.
+        uint8_t type;
+
+        /// Device subtype, corresponding to the `SubType` member of `XINPUT_CAPABILITIES`.
+        uint8_t subType;
+
+        /// Device feature flags, corresponding to the `Flags` member of `XINPUT_CAPABILITIES`.
+        uint16_t flags;
+
+        /// Battery type, corresponding to the `BatteryType` member of
+        /// `XINPUT_BATTERY_INFORMATION`.
+        uint8_t batteryType;
+
+        /// Battery level, corresponding to the `BatteryLevel` member of
+        /// `XINPUT_BATTERY_INFORMATION`.
+        uint8_t batteryLevel;
+      };
+
+      /// Determines whether or not querying battery and capabilities information is enabled.
+      /// Information is only available if it is enabled in the configuration file and physical
+      /// controllers are read using XInput.
+      /// @return `true` if so, `false` if not.
+      virtual bool IsEnabled(void) const = 0;
+
+      /// Retrieves and returns the number of physical controllers whose status is available.
+      /// @return Number of physical controllers.
+      virtual unsigned int GetControllerCount(void) const = 0;
+
+      /// Retrieves the cached status of the physical controllers, starting with the one at index
+      /// 0, for as many physical controllers as there are elements in the supplied buffer. Never
+      /// issues any XInput queries on the calling thread.
+      /// @param [out] statuses Buffer to be filled with physical controller statuses.
+      /// @return Number of elements filled, which is the smaller of the buffer size and the number
+      /// of physical controllers.
+      virtual unsigned int GetStatuses(std::span<SControllerStatus> statuses) const = 0;
+
+    protected:
+
+      inline IControllerStatus(void) : IXidi(EClass::ControllerStatus) {}
+    };
+
     /// Interface for accessing and replacing the functions for a single library's import table.
     class IMutableImportTable
     {
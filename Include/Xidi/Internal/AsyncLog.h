@@ -0,0 +1,56 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AsyncLog.h
+ *   Declaration of a mechanism for writing log messages on a background thread instead of on the
+ *   thread that produces them.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <sal.h>
+
+#include <Infra/Core/Message.h>
+
+namespace Xidi
+{
+  namespace AsyncLog
+  {
+    /// Starts a background thread that writes out messages submitted using #OutputFormatted.
+    /// Until this function is invoked, messages are written out synchronously on the thread that
+    /// submits them. Has no effect after the first invocation.
+    void Enable(void);
+
+    /// Formats and submits a message for output, in the same way as the function of the same name
+    /// in the Infra::Message namespace. Intended for messages produced on paths that applications
+    /// invoke frequently, such as reading controller state, where the cost of writing to the log
+    /// would otherwise change the timing being observed. Once enabled, the formatted message is
+    /// placed into a fixed-capacity buffer that belongs to the calling thread and is written out
+    /// later by the background thread, so messages submitted this way may be written after
+    /// messages that were output synchronously in the meantime. If a thread's buffer is full the
+    /// message is dropped, and the number of dropped messages is reported the next time the
+    /// buffer is drained. Messages that are too long to fit are truncated.
+    /// @param [in] severity Severity of the message.
+    /// @param [in] format Format string, using the same syntax as `printf`.
+    void OutputFormatted(
+        Infra::Message::ESeverity severity, _Printf_format_string_ const wchar_t* format, ...);
+
+    /// Determines if a message of the specified severity would be output, in the same way as the
+    /// function of the same name in the Infra::Message namespace. Builds that skip verbose logging
+    /// never output messages more verbose than informational, so for those messages the check is
+    /// resolved at compile time and the code that formats them is removed entirely.
+    /// @param [in] severity Severity of the message.
+    /// @return `true` if a message of the specified severity would be output, `false` otherwise.
+    inline bool WillOutputMessageOfSeverity(Infra::Message::ESeverity severity)
+    {
+#ifdef XIDI_SKIP_VERBOSE_LOGGING
+      if (severity > Infra::Message::ESeverity::Info) return false;
+#endif
+      return Infra::Message::WillOutputMessageOfSeverity(severity);
+    }
+  } // namespace AsyncLog
+} // namespace Xidi
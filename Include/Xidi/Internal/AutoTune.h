@@ -0,0 +1,106 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AutoTune.h
+ *   Declaration of functionality for learning settings suited to the way the running executable
+ *   reads input, and for persisting them in a per-executable profile.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <Infra/Core/Configuration.h>
+
+#include "ApiWindows.h"
+#include "Settings.h"
+
+namespace Xidi
+{
+  namespace AutoTune
+  {
+    /// Observations of how the application read input over a session, from which settings are
+    /// suggested.
+    struct SObservations
+    {
+      /// Duration of the session, in milliseconds.
+      uint64_t sessionMilliseconds;
+
+      /// Number of calls that read device state, namely `GetDeviceState`, `joyGetPos`, and
+      /// `joyGetPosEx`.
+      uint64_t numStateReads;
+
+      /// Number of calls that read buffered events, namely `GetDeviceData`.
+      uint64_t numBufferedReads;
+
+      /// Number of calls to `Poll`.
+      uint64_t numPolls;
+
+      /// Number of calls to `SetEventNotification`.
+      uint64_t numEventNotificationRequests;
+
+      /// Median time from new virtual controller state becoming available to the application
+      /// reading it, in microseconds, if the input latency tracer measured it.
+      std::optional<uint64_t> applicationReadMicroseconds;
+    };
+
+    /// Settings suggested for the application based on observations of a session.
+    struct STunedSettings
+    {
+      /// Physical controller polling period, in milliseconds.
+      unsigned int pollingPeriodMilliseconds;
+
+      /// Whether or not polling a device or retrieving its state reads the physical controller.
+      bool onDemandPolling;
+
+      /// Whether or not consecutive axis motion events are coalesced in the event buffer.
+      bool coalesceAxisEvents;
+
+      /// Minimum time between state change events caused by axis movement alone, in milliseconds,
+      /// if the application requests state change notifications at all.
+      std::optional<DWORD> stateChangeEventPeriodMilliseconds;
+    };
+
+    /// Determines whether or not learning is enabled in the configuration file.
+    /// @return `true` if so, `false` if not.
+    bool IsLearningEnabled(void);
+
+    /// Marks the start of the session over which observations are collected. Does nothing if
+    /// learning is disabled.
+    void BeginSession(void);
+
+    /// Suggests settings suited to the way the application read input over a session.
+    /// @param [in] observations Observations of the session.
+    /// @return Suggested settings, or no value if the session was too short or the application
+    /// read too little input to draw any conclusions.
+    std::optional<STunedSettings> SuggestSettings(const SObservations& observations);
+
+    /// Generates the contents of a profile file that holds the specified settings. Profile files
+    /// use configuration file syntax so that they can be read using the configuration file reader.
+    /// @param [in] tunedSettings Settings to be held in the profile.
+    /// @return Contents of the profile file.
+    std::string ProfileFileContents(const STunedSettings& tunedSettings);
+
+    /// Applies the settings held in a profile to typed settings. Settings that are present in the
+    /// configuration file always take precedence over those in the profile.
+    /// @param [in] profileData Configuration data read from the profile file.
+    /// @param [in] configData Configuration data read from the configuration file.
+    /// @param [in, out] settings Typed settings extracted from the configuration file, to be
+    /// updated with settings from the profile.
+    void ApplyProfile(
+        const Infra::Configuration::ConfigurationData& profileData,
+        const Infra::Configuration::ConfigurationData& configData,
+        SSettings& settings);
+
+    /// Suggests settings based on observations of the session that is ending, outputs them as
+    /// informational messages, and writes them to the profile of the running executable if so
+    /// configured. Does nothing if learning is disabled.
+    void OutputSummary(void);
+  } // namespace AutoTune
+} // namespace Xidi
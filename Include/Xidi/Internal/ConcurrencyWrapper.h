@@ -11,12 +11,25 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <shared_mutex>
 #include <stop_token>
+#include <type_traits>
+
+#include "ProfiledMutex.h"
 
 namespace Xidi
 {
+  /// Type used to identify successive updates to data held by a concurrency wrapper. Every time
+  /// the wrapped data are written, the generation number increases. Comparing generation numbers
+  /// is therefore sufficient to detect that an update happened, without comparing the data.
+  using TGeneration = uint64_t;
+
   /// Wraps data in a way that is concurrency-safe following a single-producer multiple-consumer
   /// threading model.
   /// @tparam DataType Underlying wrapped data type.
@@ -32,32 +45,53 @@ namespace Xidi
       return data;
     }
 
+    /// Retrieves and returns the stored data, along with its generation number, in a
+    /// concurrency-safe way.
+    /// @param [out] externalGeneration Filled in with the generation number of the returned data.
+    /// @return Underlying wrapped data.
+    inline DataType Get(TGeneration& externalGeneration)
+    {
+      std::shared_lock lock(mutex);
+      externalGeneration = generation;
+      return data;
+    }
+
+    /// Retrieves the generation number of the stored data, without copying them, in a
+    /// concurrency-safe way.
+    /// @return Generation number of the stored data.
+    inline TGeneration GetGeneration(void)
+    {
+      std::shared_lock lock(mutex);
+      return generation;
+    }
+
     /// Writes to the stored data in a concurrency-safe way.
     /// @param [in] newData New data to be stored.
     inline void Set(const DataType& newData)
     {
       std::unique_lock lock(mutex);
       data = newData;
+      generation += 1;
     }
 
     /// Updates the stored data in a concurrency-safe way and notifies all waiting threads of the
     /// change. Operations are conditional on the new data being different than the currently-stored
-    /// data.
+    /// data. Comparison and publication happen together while holding the lock.
     /// @param [in] newData New data to be stored.
     /// @return `true` if the new data differ from the old and hence an update was performed,
     /// `false` otherwise.
     inline bool Update(const DataType& newData)
     {
-      // This unguarded read is safe because by design only one thread, the one that produces
-      // updated data, ever invokes this method. All other threads use guarded reads.
-      if (newData != data)
       {
-        Set(newData);
-        updateNotifier.notify_all();
-        return true;
+        std::unique_lock lock(mutex);
+        if (newData == data) return false;
+
+        data = newData;
+        generation += 1;
       }
 
-      return false;
+      updateNotifier.notify_all();
+      return true;
     }
 
     /// Waits for the stored data to be updated.
@@ -86,15 +120,323 @@ namespace Xidi
       return true;
     }
 
+    /// Waits for the stored data to be updated, using generation numbers rather than the data
+    /// themselves to detect updates.
+    /// This function is fully concurrency-safe. If needed, the caller can interrupt the wait using
+    /// a stop token.
+    /// @param [out] externalData Filled in with the updated data.
+    /// @param [in,out] externalGeneration On input, generation number of the last-known data for
+    /// the calling thread. On output, filled in with the generation number of the updated data.
+    /// @param [in] stopToken Token that allows the wait to be interrupted.
+    /// @return `true` if the wait succeeded and an update occurred, `false` if no updates were made
+    /// due to interrupted wait.
+    inline bool WaitForUpdate(
+        DataType& externalData, TGeneration& externalGeneration, std::stop_token stopToken)
+    {
+      std::shared_lock lock(mutex);
+
+      updateNotifier.wait(
+          lock,
+          stopToken,
+          [this, &externalGeneration]() -> bool
+          {
+            return (generation != externalGeneration);
+          });
+
+      if (stopToken.stop_requested()) return false;
+
+      externalData = data;
+      externalGeneration = generation;
+      return true;
+    }
+
   private:
 
     /// Wrapped data.
     DataType data;
 
+    /// Generation number of the wrapped data.
+    TGeneration generation = 0;
+
     /// Condition variable used to wait for updates to the underlying wrapped data.
     std::condition_variable_any updateNotifier;
 
     /// Mutex for protecting against concurrent accesses to the underlying wrapped data.
-    std::shared_mutex mutex;
+    ProfiledMutex<std::shared_mutex> mutex{L"ConcurrencyWrapper::mutex"};
+  };
+
+  /// Wraps data in a way that is concurrency-safe following a single-producer multiple-consumer
+  /// threading model, using a sequence lock instead of a mutex. Readers never block the writer and
+  /// never block each other, which makes this wrapper suitable for data that are read very often.
+  /// A reader that overlaps with a write simply retries. Waiting for updates does use a mutex and
+  /// a condition variable, but the writer only touches them if at least one thread is waiting.
+  /// Exposes the same interface as #ConcurrencyWrapper.
+  /// @tparam DataType Underlying wrapped data type, which must be trivially copyable.
+  template <typename DataType> class SeqLockConcurrencyWrapper
+  {
+    static_assert(
+        std::is_trivially_copyable_v<DataType>,
+        "Sequence lock wrapper requires a trivially-copyable data type.");
+
+  public:
+
+    SeqLockConcurrencyWrapper(void) : sequence(0), storage(), waiterCount(0), writerData()
+    {
+      Set(DataType());
+    }
+
+    SeqLockConcurrencyWrapper(const SeqLockConcurrencyWrapper& other) = delete;
+
+    /// Retrieves and returns the stored data in a concurrency-safe way. Never blocks the writer.
+    /// @return Underlying wrapped data.
+    inline DataType Get(void) const
+    {
+      TGeneration unusedGeneration = 0;
+      return Get(unusedGeneration);
+    }
+
+    /// Retrieves and returns the stored data, along with its generation number, in a
+    /// concurrency-safe way. Never blocks the writer.
+    /// @param [out] externalGeneration Filled in with the generation number of the returned data.
+    /// @return Underlying wrapped data.
+    inline DataType Get(TGeneration& externalGeneration) const
+    {
+      TStorageWord snapshot[kStorageWordCount];
+      uint64_t sequenceBefore = 0;
+      uint64_t sequenceAfter = 0;
+
+      do
+      {
+        // An odd sequence number means a write is in progress.
+        do
+        {
+          sequenceBefore = sequence.load(std::memory_order_acquire);
+        } while (0 != (sequenceBefore & 1));
+
+        for (size_t i = 0; i < kStorageWordCount; ++i)
+          snapshot[i] = storage[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        sequenceAfter = sequence.load(std::memory_order_relaxed);
+      } while (sequenceBefore != sequenceAfter);
+
+      DataType data;
+      std::memcpy(&data, snapshot, sizeof(DataType));
+      externalGeneration = SequenceToGeneration(sequenceAfter);
+      return data;
+    }
+
+    /// Retrieves the generation number of the most recently completed write, without reading the
+    /// stored data. Never blocks the writer. Useful for cheaply checking if the stored data have
+    /// changed since they were last read.
+    /// @return Generation number of the stored data.
+    inline TGeneration GetGeneration(void) const
+    {
+      return SequenceToGeneration(sequence.load(std::memory_order_acquire));
+    }
+
+    /// Retrieves and returns part of the stored data in a concurrency-safe way, reading only the
+    /// units of storage that hold the requested part. Never blocks the writer. Useful for frequent
+    /// queries of small parts of large data.
+    /// @tparam PartType Type of the requested part, which must be trivially-copyable.
+    /// @param [in] partOffsetBytes Offset of the requested part within the wrapped data, in bytes.
+    /// @return Requested part of the underlying wrapped data.
+    template <typename PartType> inline PartType GetPart(size_t partOffsetBytes) const
+    {
+      static_assert(
+          std::is_trivially_copyable_v<PartType>,
+          "Parts of wrapped data must be trivially-copyable.");
+
+      const size_t firstWord = partOffsetBytes / sizeof(TStorageWord);
+      const size_t endWord =
+          (partOffsetBytes + sizeof(PartType) + sizeof(TStorageWord) - 1) / sizeof(TStorageWord);
+
+      TStorageWord snapshot[kStorageWordCount];
+      uint64_t sequenceBefore = 0;
+      uint64_t sequenceAfter = 0;
+
+      do
+      {
+        do
+        {
+          sequenceBefore = sequence.load(std::memory_order_acquire);
+        } while (0 != (sequenceBefore & 1));
+
+        for (size_t i = firstWord; i < endWord; ++i)
+          snapshot[i] = storage[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        sequenceAfter = sequence.load(std::memory_order_relaxed);
+      } while (sequenceBefore != sequenceAfter);
+
+      PartType part;
+      std::memcpy(
+          &part, reinterpret_cast<const uint8_t*>(snapshot) + partOffsetBytes, sizeof(part));
+      return part;
+    }
+
+    /// Writes to the stored data in a concurrency-safe way. Must only be invoked by the single
+    /// thread that produces updated data.
+    /// @param [in] newData New data to be stored.
+    inline void Set(const DataType& newData)
+    {
+      TStorageWord newStorage[kStorageWordCount] = {};
+      std::memcpy(newStorage, &newData, sizeof(DataType));
+
+      const uint64_t currentSequence = sequence.load(std::memory_order_relaxed);
+      sequence.store(currentSequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (size_t i = 0; i < kStorageWordCount; ++i)
+        storage[i].store(newStorage[i], std::memory_order_relaxed);
+
+      sequence.store(currentSequence + 2, std::memory_order_release);
+      writerData = newData;
+    }
+
+    /// Updates the stored data in a concurrency-safe way and notifies all waiting threads of the
+    /// change. Operations are conditional on the new data being different than the currently-stored
+    /// data.
+    /// @param [in] newData New data to be stored.
+    /// @return `true` if the new data differ from the old and hence an update was performed,
+    /// `false` otherwise.
+    inline bool Update(const DataType& newData)
+    {
+      // Only the thread that produces updated data ever invokes this method, so it can compare
+      // against its own private copy of the stored data without going through the sequence lock.
+      if (newData != writerData)
+      {
+        Set(newData);
+
+        // Pairs with the fence in the waiting method. Either the waiter sees the new data, or the
+        // writer sees the waiter and goes through the mutex to notify it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (0 != waiterCount.load(std::memory_order_relaxed))
+        {
+          {
+            std::scoped_lock lock(waitMutex);
+          }
+          updateNotifier.notify_all();
+        }
+
+        return true;
+      }
+
+      return false;
+    }
+
+    /// Waits for the stored data to be updated.
+    /// This function is fully concurrency-safe. If needed, the caller can interrupt the wait using
+    /// a stop token.
+    /// @param [in,out] externalData On input, used to identify the last-known data for the calling
+    /// thread. On output, filled in with the updated data.
+    /// @param [in] stopToken Token that allows the wait to be interrupted.
+    /// @return `true` if the wait succeeded and an update occurred, `false` if no updates were made
+    /// due to invalid parameter or interrupted wait.
+    inline bool WaitForUpdate(DataType& externalData, std::stop_token stopToken)
+    {
+      DataType currentData = Get();
+
+      if (currentData == externalData)
+      {
+        waiterCount.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        {
+          std::unique_lock lock(waitMutex);
+          updateNotifier.wait(
+              lock,
+              stopToken,
+              [this, &externalData, &currentData]() -> bool
+              {
+                currentData = Get();
+                return (currentData != externalData);
+              });
+        }
+
+        waiterCount.fetch_sub(1, std::memory_order_relaxed);
+      }
+
+      if (stopToken.stop_requested()) return false;
+
+      externalData = currentData;
+      return true;
+    }
+
+    /// Waits for the stored data to be updated, using generation numbers rather than the data
+    /// themselves to detect updates.
+    /// This function is fully concurrency-safe. If needed, the caller can interrupt the wait using
+    /// a stop token.
+    /// @param [out] externalData Filled in with the updated data.
+    /// @param [in,out] externalGeneration On input, generation number of the last-known data for
+    /// the calling thread. On output, filled in with the generation number of the updated data.
+    /// @param [in] stopToken Token that allows the wait to be interrupted.
+    /// @return `true` if the wait succeeded and an update occurred, `false` if no updates were made
+    /// due to interrupted wait.
+    inline bool WaitForUpdate(
+        DataType& externalData, TGeneration& externalGeneration, std::stop_token stopToken)
+    {
+      if (GetGeneration() == externalGeneration)
+      {
+        waiterCount.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        {
+          std::unique_lock lock(waitMutex);
+          updateNotifier.wait(
+              lock,
+              stopToken,
+              [this, &externalGeneration]() -> bool
+              {
+                return (GetGeneration() != externalGeneration);
+              });
+        }
+
+        waiterCount.fetch_sub(1, std::memory_order_relaxed);
+      }
+
+      if (stopToken.stop_requested()) return false;
+
+      externalData = Get(externalGeneration);
+      return true;
+    }
+
+  private:
+
+    /// Converts a sequence number to a generation number. Each write advances the sequence number
+    /// by two, once at the start and once at the end.
+    /// @param [in] sequenceNumber Sequence number to convert.
+    /// @return Corresponding generation number.
+    static inline TGeneration SequenceToGeneration(uint64_t sequenceNumber)
+    {
+      return static_cast<TGeneration>(sequenceNumber >> 1);
+    }
+
+    /// Type of each individual unit of storage. Chosen to be the native word size, so that each
+    /// unit of storage can be accessed atomically without locking.
+    using TStorageWord = uintptr_t;
+
+    /// Number of storage units needed to hold the wrapped data.
+    static constexpr size_t kStorageWordCount =
+        ((sizeof(DataType) + sizeof(TStorageWord) - 1) / sizeof(TStorageWord));
+
+    /// Sequence number used to detect concurrent writes. Odd while a write is in progress.
+    std::atomic<uint64_t> sequence;
+
+    /// Wrapped data, stored as an array of atomic words so that concurrent reads and writes are
+    /// well-defined. Readers detect and discard torn reads using the sequence number.
+    std::atomic<TStorageWord> storage[kStorageWordCount];
+
+    /// Number of threads currently waiting for updates to the underlying wrapped data.
+    std::atomic<unsigned int> waiterCount;
+
+    /// Copy of the wrapped data that is only accessed by the thread that produces updated data.
+    DataType writerData;
+
+    /// Condition variable used to wait for updates to the underlying wrapped data.
+    std::condition_variable_any updateNotifier;
+
+    /// Mutex used exclusively for waiting for updates to the underlying wrapped data.
+    std::mutex waitMutex;
   };
 } // namespace Xidi
@@ -0,0 +1,31 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ConfigurationWatcher.h
+ *   Declaration of functionality for reapplying custom mappers when the configuration file is
+ *   modified while the application is running.
+ **************************************************************************************************/
+
+#pragma once
+
+#include "XidiConfigReader.h"
+
+namespace Xidi
+{
+  namespace ConfigurationWatcher
+  {
+    /// Starts watching the configuration file for modifications on a background thread. Whenever
+    /// it is modified, the configuration file is read again, the custom mappers whose sections
+    /// changed are rebuilt along with any custom mappers that use them as templates, and the
+    /// rebuilt mappers replace the old versions on all physical controllers that were using them.
+    /// All other settings continue to require the application to be restarted. Has no effect
+    /// after the first invocation.
+    /// @param [in] customMapperSectionHashes Hashes of the custom mapper sections that were
+    /// present when the configuration file was first read.
+    void Start(XidiConfigReader::TCustomMapperSectionHashes&& customMapperSectionHashes);
+  } // namespace ConfigurationWatcher
+} // namespace Xidi
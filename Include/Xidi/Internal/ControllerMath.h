@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 
 #include "ControllerTypes.h"
@@ -35,6 +36,116 @@ namespace Xidi
         constexpr bool operator==(const SAnalogStickCoordinates& other) const = default;
       };
 
+      /// Number of lanes in the parameters used to transform all virtual controller axis values at
+      /// once. Rounded up from the number of axes so that the transformation operates on whole
+      /// vectors. Extra lanes are never transformed.
+      inline constexpr unsigned int kAxisTransformLaneCount = 8;
+
+      /// Number of fractional bits in the fixed-point range scale factors used to transform virtual
+      /// controller axis values.
+      inline constexpr unsigned int kAxisTransformScaleFactorFractionBits = 16;
+
+      static_assert(
+          kAxisTransformLaneCount >= static_cast<unsigned int>(EAxis::Count),
+          "Axis transformation lanes cannot hold all virtual controller axes.");
+
+      /// Parameters for transforming the values of all virtual controller axes at once, which
+      /// applies deadzone, saturation, and range. Stored one array per parameter, with one lane per
+      /// axis indexed by axis enumerator. Distances are measured from the deadzone cutoff of each
+      /// side of an axis towards its extreme. Range scale factors are fixed-point values with
+      /// #kAxisTransformScaleFactorFractionBits fractional bits, split into 32-bit halves.
+      struct SAxisTransformParameters
+      {
+        /// Whether or not each axis is transformed, either all bits set or all bits clear. Axes
+        /// that are not transformed pass through unchanged.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> transformMask;
+
+        /// Highest raw analog value on the positive side of each axis that falls within the
+        /// deadzone region.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> deadzoneCutoffPositive;
+
+        /// Lowest raw analog value on the negative side of each axis that falls within the
+        /// deadzone region.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> deadzoneCutoffNegative;
+
+        /// Distance past the positive deadzone cutoff at which each axis is saturated.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> saturationDistancePositive;
+
+        /// Distance past the negative deadzone cutoff at which each axis is saturated.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> saturationDistanceNegative;
+
+        /// Low halves of the range scale factors for the positive side of each axis.
+        alignas(16) std::array<uint32_t, kAxisTransformLaneCount> rangeScaleLowPositive;
+
+        /// High halves of the range scale factors for the positive side of each axis.
+        alignas(16) std::array<uint32_t, kAxisTransformLaneCount> rangeScaleHighPositive;
+
+        /// Low halves of the range scale factors for the negative side of each axis.
+        alignas(16) std::array<uint32_t, kAxisTransformLaneCount> rangeScaleLowNegative;
+
+        /// High halves of the range scale factors for the negative side of each axis.
+        alignas(16) std::array<uint32_t, kAxisTransformLaneCount> rangeScaleHighNegative;
+
+        /// Minimum reportable value for each axis.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> rangeMin;
+
+        /// Maximum reportable value for each axis.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> rangeMax;
+
+        /// Neutral value for each axis.
+        alignas(16) std::array<int32_t, kAxisTransformLaneCount> rangeNeutral;
+      };
+
+      /// Number of segments in each of the lookup tables used by table-driven circle-to-square
+      /// correction. Each table holds one more entry than this so that every segment has both of
+      /// its endpoints available for linear interpolation.
+      inline constexpr unsigned int kCircleToSquareTableSegmentCount = 1024;
+
+      /// Number of fractional bits in the fixed-point multipliers held in the lookup tables used by
+      /// table-driven circle-to-square correction.
+      inline constexpr unsigned int kCircleToSquareMultiplierFractionBits = 30;
+
+      /// Precomputed lookup tables for applying circle-to-square correction to analog stick
+      /// coordinates without any floating-point operations. Built once for a specific amount of
+      /// correction. Holds fixed-point multipliers with #kCircleToSquareMultiplierFractionBits
+      /// fractional bits, which are already weighted by the amount of correction.
+      struct SCircleToSquareTable
+      {
+        /// Whether or not any correction is applied. If not, coordinates pass through unchanged
+        /// and the lookup tables are unused.
+        bool isEnabled;
+
+        /// Multipliers for coordinates within a circular range of motion, indexed by the ratio of
+        /// the smaller to the larger absolute coordinate, from 0.0 to 1.0.
+        std::array<uint32_t, kCircleToSquareTableSegmentCount + 1> multiplierByRatio;
+
+        /// Multipliers for coordinates outside of a circular range of motion, indexed by the
+        /// unweighted multiplier that would bring the larger absolute coordinate to the edge of
+        /// the range, from 0.5 to 1.5.
+        std::array<uint32_t, kCircleToSquareTableSegmentCount + 1> multiplierByUnweightedMultiplier;
+      };
+
+      /// Precomputed parameters for applying deadzone and saturation transformations to raw analog
+      /// values without any floating-point operations.
+      struct SRawAnalogTransformParameters
+      {
+        /// Whether or not any transformation is applied. If not, values pass through unchanged.
+        bool isEnabled;
+
+        /// Highest absolute analog value that falls within the deadzone region.
+        int32_t deadzoneCutoff;
+
+        /// Lowest absolute analog value that falls within the saturation region.
+        int32_t saturationCutoff;
+      };
+
+      /// Precomputed lookup table for applying deadzone and saturation transformations to raw
+      /// trigger values. Indexed by raw trigger value.
+      struct SRawTriggerTransformTable
+      {
+        std::array<uint8_t, (kTriggerValueMax - kTriggerValueMin) + 1> transformedValue;
+      };
+
       /// Threshold value used to determine if a trigger is considered "pressed" or not as a digital
       /// button.
       inline constexpr uint8_t kTriggerPressedThreshold = (kTriggerValueMax - kTriggerValueMin) / 6;
@@ -56,6 +167,15 @@ namespace Xidi
       int16_t ApplyRawAnalogTransform(
           int16_t analogValue, unsigned int deadzonePercent, unsigned int saturationPercent);
 
+      /// Applies deadzone and saturation transformations to a raw analog value using precomputed
+      /// parameters. Results are within 1 of #ApplyRawAnalogTransform, which computes the same
+      /// transformation in floating-point.
+      /// @param [in] analogValue Analog value to transform.
+      /// @param [in] parameters Precomputed transformation parameters.
+      /// @return Transformed analog value.
+      int16_t ApplyRawAnalogTransform(
+          int16_t analogValue, const SRawAnalogTransformParameters& parameters);
+
       /// Applies deadzone and saturation transformations to a raw trigger value.
       /// @param [in] analogValue Analog value for which a deadzone should be applied.
       /// @param [in] deadzoneHudnredthsOfPercent Hundredths of a percent of the analog range for
@@ -63,6 +183,17 @@ namespace Xidi
       uint8_t ApplyRawTriggerTransform(
           uint8_t triggerValue, unsigned int deadzonePercent, unsigned int saturationPercent);
 
+      /// Applies deadzone and saturation transformations to a raw trigger value using a precomputed
+      /// lookup table. Results are identical to #ApplyRawTriggerTransform.
+      /// @param [in] triggerValue Trigger value to transform.
+      /// @param [in] table Precomputed lookup table.
+      /// @return Transformed trigger value.
+      inline uint8_t ApplyRawTriggerTransform(
+          uint8_t triggerValue, const SRawTriggerTransformTable& table)
+      {
+        return table.transformedValue[triggerValue];
+      }
+
       /// Determines if an analog reading is considered "pressed" as a digital button in the
       /// negative direction.
       /// @param [in] analogValue Analog reading from the XInput controller.
@@ -97,6 +228,41 @@ namespace Xidi
         return (triggerValue >= kTriggerPressedThreshold);
       }
 
+      /// Computes the lookup tables for applying circle-to-square correction without any
+      /// floating-point operations.
+      /// @param [in] amountFraction Value between 0.0 and 1.0 that determines the amount of
+      /// transformation to apply.
+      /// @return Lookup tables for the specified amount of transformation.
+      SCircleToSquareTable MakeCircleToSquareTable(double amountFraction);
+
+      /// Computes the parameters for applying deadzone and saturation transformations to raw
+      /// analog values without any floating-point operations.
+      /// @param [in] deadzonePercent Percentage of the analog range for which the deadzone should
+      /// be applied.
+      /// @param [in] saturationPercent Percentage of the analog range beyond which values should
+      /// be saturated.
+      /// @return Transformation parameters.
+      constexpr SRawAnalogTransformParameters MakeRawAnalogTransformParameters(
+          unsigned int deadzonePercent, unsigned int saturationPercent)
+      {
+        return {
+            .isEnabled = ((0 != deadzonePercent) || (100 != saturationPercent)),
+            .deadzoneCutoff =
+                (int32_t)(((kAnalogValueMax - kAnalogValueNeutral) * deadzonePercent) / 100),
+            .saturationCutoff =
+                (int32_t)(((kAnalogValueMax - kAnalogValueNeutral) * saturationPercent) / 100)};
+      }
+
+      /// Computes the lookup table for applying deadzone and saturation transformations to raw
+      /// trigger values.
+      /// @param [in] deadzonePercent Percentage of the trigger range for which the deadzone should
+      /// be applied.
+      /// @param [in] saturationPercent Percentage of the trigger range beyond which values should
+      /// be saturated.
+      /// @return Lookup table.
+      SRawTriggerTransformTable MakeRawTriggerTransformTable(
+          unsigned int deadzonePercent, unsigned int saturationPercent);
+
       /// Applies a correction to convert the coordinates of an analog stick reading
       /// from circle to square. On many controllers, the analog stick range of motion follows a
       /// circular pattern, but sometimes the application expects a square (for example, diagonals
@@ -110,6 +276,35 @@ namespace Xidi
       /// circular range of motion to a square range of motion.
       SAnalogStickCoordinates TransformCoordinatesCircleToSquare(
           SAnalogStickCoordinates cirleCoords, double amountFraction);
+
+      /// Applies a correction to convert the coordinates of an analog stick reading from circle to
+      /// square using precomputed lookup tables. Results are within 1 of the floating-point
+      /// version of this function, but no floating-point operations are performed.
+      /// @param [in] circleCoords Physical coordinates read from the analog stick, assumed to be on
+      /// a circular range of motion.
+      /// @param [in] table Precomputed lookup tables.
+      /// @return Replacement analog stick coordinates after the transformation is applied from a
+      /// circular range of motion to a square range of motion.
+      SAnalogStickCoordinates TransformCoordinatesCircleToSquare(
+          SAnalogStickCoordinates circleCoords, const SCircleToSquareTable& table);
+
+      /// Transforms a single virtual controller axis value by applying deadzone, saturation, and
+      /// range. This is the scalar reference implementation of #TransformAxisValues.
+      /// @param [in] axisValue Raw axis value to transform.
+      /// @param [in] parameters Axis transformation parameters.
+      /// @param [in] axis Axis whose lane of the parameters is to be used.
+      /// @return Transformed axis value.
+      int32_t TransformAxisValue(
+          int32_t axisValue, const SAxisTransformParameters& parameters, EAxis axis);
+
+      /// Transforms the values of all virtual controller axes at once by applying deadzone,
+      /// saturation, and range. Uses SSE4.1 vector instructions if the processor supports them and
+      /// otherwise falls back to #TransformAxisValue. Results are identical either way.
+      /// @param [in,out] axisValues Raw axis values to be transformed in place.
+      /// @param [in] parameters Axis transformation parameters.
+      void TransformAxisValues(
+          std::array<int32_t, static_cast<int>(EAxis::Count)>& axisValues,
+          const SAxisTransformParameters& parameters);
     } // namespace Math
   }   // namespace Controller
 } // namespace Xidi
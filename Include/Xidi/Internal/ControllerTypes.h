@@ -11,9 +11,12 @@
 
 #pragma once
 
+#include <emmintrin.h>
+
 #include <algorithm>
 #include <array>
 #include <bitset>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
@@ -21,10 +24,14 @@ namespace Xidi
 {
   namespace Controller
   {
-    /// Number of physical controllers that the underlying system supports.
-    /// Not all will necessarily be physically present at any given time.
-    /// Maximum allowable controller identifier is one less than this value.
-    inline constexpr uint16_t kPhysicalControllerCount = 4;
+    /// Maximum number of physical controllers that can be supported, which determines the size of
+    /// all per-controller data structures. The number actually supported is configurable up to
+    /// this limit. Not all will necessarily be physically present at any given time.
+    inline constexpr uint16_t kMaxPhysicalControllerCount = 16;
+
+    /// Number of physical controllers supported by default, which matches the number supported by
+    /// the XInput API.
+    inline constexpr uint16_t kDefaultPhysicalControllerCount = 4;
 
     /// Maximum possible reading from an XInput controller's analog stick.
     /// Value taken from XInput documentation.
@@ -52,7 +59,7 @@ namespace Xidi
     inline constexpr int32_t kTriggerValueMid = (kTriggerValueMax + kTriggerValueMin) / 2;
 
     /// Integer type used to identify physical controllers to the underlying system interfaces.
-    using TControllerIdentifier = std::remove_const_t<decltype(kPhysicalControllerCount)>;
+    using TControllerIdentifier = std::remove_const_t<decltype(kMaxPhysicalControllerCount)>;
 
     /// Enumerates all supported axis types using DirectInput terminology.
     /// It is not necessarily the case that all of these axes are present in a virtual controller.
@@ -368,16 +375,117 @@ namespace Xidi
         sizeof(UPovDirection::components) == sizeof(UPovDirection::all),
         "Mismatch in POV view sizes.");
 
+    /// Holds the pressed (`true`) or unpressed (`false`) state of all buttons, one bit per button
+    /// in enumerator order. Unlike a bitset, whose storage is implementation-defined, the bits are
+    /// packed into a single fixed-width word so that copying, comparing, and combining button
+    /// states are each a single integer operation.
+    struct SButtonSet
+    {
+      /// Integer type used to hold button states.
+      using TWord = uint32_t;
+
+      /// Reference to a single button within a button set, used to modify its pressed state.
+      class Reference
+      {
+      public:
+
+        constexpr Reference(TWord& word, TWord mask) : word(word), mask(mask) {}
+
+        constexpr Reference(const Reference& other) = default;
+
+        constexpr Reference& operator=(bool isPressed)
+        {
+          word = ((true == isPressed) ? (word | mask) : (word & ~mask));
+          return *this;
+        }
+
+        constexpr Reference& operator=(const Reference& other)
+        {
+          return (*this = static_cast<bool>(other));
+        }
+
+        constexpr operator bool(void) const
+        {
+          return (0 != (word & mask));
+        }
+
+      private:
+
+        /// Word that holds the referenced button.
+        TWord& word;
+
+        /// Mask that identifies the referenced button within the word.
+        const TWord mask;
+      };
+
+      /// Button states, one bit per button with the first button in the least-significant bit.
+      TWord word = 0;
+
+      constexpr SButtonSet(void) = default;
+
+      constexpr SButtonSet(TWord initialWord) : word(initialWord) {}
+
+      constexpr bool operator==(const SButtonSet& other) const = default;
+
+      constexpr SButtonSet operator^(const SButtonSet& other) const
+      {
+        return SButtonSet(word ^ other.word);
+      }
+
+      constexpr SButtonSet& operator|=(const SButtonSet& other)
+      {
+        word |= other.word;
+        return *this;
+      }
+
+      constexpr bool operator[](size_t index) const
+      {
+        return (0 != (word & ((TWord)1 << index)));
+      }
+
+      constexpr Reference operator[](size_t index)
+      {
+        return Reference(word, ((TWord)1 << index));
+      }
+
+      /// Retrieves the number of buttons held in a button set.
+      /// @return Number of buttons.
+      static constexpr size_t size(void)
+      {
+        return static_cast<size_t>(EButton::Count);
+      }
+
+      /// Retrieves all button states as a single integer, one bit per button.
+      /// @return Bitmask in which set bits identify pressed buttons.
+      constexpr unsigned long to_ulong(void) const
+      {
+        return static_cast<unsigned long>(word);
+      }
+
+      /// Retrieves all button states as a single integer, one bit per button.
+      /// @return Bitmask in which set bits identify pressed buttons.
+      constexpr unsigned long long to_ullong(void) const
+      {
+        return static_cast<unsigned long long>(word);
+      }
+    };
+
+    static_assert(
+        static_cast<size_t>(EButton::Count) <= (8 * sizeof(SButtonSet::TWord)),
+        "Number of buttons does not fit into a button set word.");
+
     /// Native data format for virtual controllers, used internally to represent controller state.
-    /// Validity or invalidity of each element depends on the mapper.
-    struct SState
+    /// Validity or invalidity of each element depends on the mapper. States are copied and compared
+    /// many times per poll, so the layout is fixed, trivially copyable, and aligned such that a
+    /// state never straddles a cache line. Axes remain 32-bit because processed states hold values
+    /// in application-specified DirectInput ranges.
+    struct alignas(32) SState
     {
       /// Values for all axes, one element per axis.
       std::array<int32_t, static_cast<int>(EAxis::Count)> axis;
 
-      /// Pressed (`true`) or unpressed (`false`) state for each button, one bit per button. Bitset
-      /// is used as a size optimization, given the number of buttons.
-      std::bitset<static_cast<int>(EButton::Count)> button;
+      /// Pressed (`true`) or unpressed (`false`) state for each button, one bit per button.
+      SButtonSet button;
 
       /// POV direction, presented simultaneously as individual components and as an aggregate
       /// quantity.
@@ -385,13 +493,22 @@ namespace Xidi
 
       constexpr bool operator==(const SState& other) const
       {
-        return (
-            std::equal(
-                std::cbegin(other.axis),
-                std::cend(other.axis),
-                std::cbegin(axis),
-                std::cend(axis)) &&
-            (other.button == button) && (other.povDirection == povDirection));
+        // Differences are accumulated without branching so that the comparison reduces to a few
+        // wide operations over the whole structure.
+        uint32_t difference =
+            (other.button.word ^ button.word) | (other.povDirection.all ^ povDirection.all);
+        for (size_t i = 0; i < axis.size(); ++i)
+          difference |= static_cast<uint32_t>(other.axis[i] ^ axis[i]);
+
+        return (0 == difference);
+      }
+
+      /// Retrieves the pressed state of all buttons as a single bitmask, with one bit per button
+      /// in enumerator order. Useful for consumers that report buttons as a packed integer.
+      /// @return Bitmask in which set bits identify pressed buttons.
+      inline uint32_t ButtonBitmask(void) const
+      {
+        return static_cast<uint32_t>(button.word);
       }
 
       constexpr int32_t operator[](EAxis desiredAxis) const
@@ -414,7 +531,7 @@ namespace Xidi
         return axis[static_cast<int>(desiredAxis)];
       }
 
-      constexpr decltype(button)::reference operator[](EButton desiredButton)
+      constexpr SButtonSet::Reference operator[](EButton desiredButton)
       {
         return button[static_cast<int>(desiredButton)];
       }
@@ -426,6 +543,79 @@ namespace Xidi
     };
 
     static_assert(sizeof(SState) <= 32, "Data structure size constraint violation.");
+    static_assert(
+        std::is_trivially_copyable_v<SState>, "Controller state must be trivially copyable.");
+
+    /// Identifies a set of virtual controller elements, one bit per element. Axes occupy the lowest
+    /// bits in enumerator order, followed by buttons in enumerator order, followed by the POV.
+    using TElementMask = uint64_t;
+
+    /// Bit position of the first button within an element mask.
+    inline constexpr unsigned int kElementMaskButtonShift = static_cast<unsigned int>(EAxis::Count);
+
+    /// Bit position of the POV within an element mask.
+    inline constexpr unsigned int kElementMaskPovShift =
+        kElementMaskButtonShift + static_cast<unsigned int>(EButton::Count);
+
+    /// Element mask that identifies all virtual controller elements.
+    inline constexpr TElementMask kElementMaskAll =
+        (((TElementMask)1 << kElementMaskPovShift) << 1) - 1;
+
+    static_assert(
+        (kElementMaskPovShift + 1) <= (8 * sizeof(TElementMask)),
+        "Number of virtual controller elements does not fit into an element mask.");
+
+    /// Computes the element mask that identifies a single virtual controller element.
+    /// @param [in] element Virtual controller element of interest.
+    /// @return Element mask identifying just that element, or an empty mask if the element is not
+    /// an axis, button, or POV.
+    constexpr TElementMask ElementMaskForElement(SElementIdentifier element)
+    {
+      switch (element.type)
+      {
+        case EElementType::Axis:
+          return ((TElementMask)1 << static_cast<unsigned int>(element.axis));
+        case EElementType::Button:
+          return (
+              (TElementMask)1
+              << (kElementMaskButtonShift + static_cast<unsigned int>(element.button)));
+        case EElementType::Pov:
+          return ((TElementMask)1 << kElementMaskPovShift);
+        default:
+          return 0;
+      }
+    }
+
+    static_assert(
+        (0 == offsetof(SState, axis)) && (24 == offsetof(SState, button)) &&
+            (28 == offsetof(SState, povDirection)) && (32 == sizeof(SState)),
+        "Controller state layout does not match the lanes used to compare states.");
+
+    /// Determines which virtual controller elements differ between two virtual controller states.
+    /// Each state is compared as eight 32-bit lanes, which are the six axes followed by the button
+    /// word and the POV, using two vector comparisons. Individual buttons are then identified by
+    /// the bits that differ within the button word.
+    /// @param [in] stateA First state to compare.
+    /// @param [in] stateB Second state to compare.
+    /// @return Element mask identifying all elements whose values differ.
+    inline TElementMask ElementMaskForStateDifference(const SState& stateA, const SState& stateB)
+    {
+      const __m128i* const lanesA = reinterpret_cast<const __m128i*>(&stateA);
+      const __m128i* const lanesB = reinterpret_cast<const __m128i*>(&stateB);
+
+      const unsigned int lanesEqualLow = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(
+          _mm_cmpeq_epi32(_mm_load_si128(&lanesA[0]), _mm_load_si128(&lanesB[0]))));
+      const unsigned int lanesEqualHigh = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(
+          _mm_cmpeq_epi32(_mm_load_si128(&lanesA[1]), _mm_load_si128(&lanesB[1]))));
+      const unsigned int lanesDifferent = ~(lanesEqualLow | (lanesEqualHigh << 4));
+
+      constexpr unsigned int kAxisLanes = (1u << static_cast<unsigned int>(EAxis::Count)) - 1;
+      constexpr unsigned int kPovLane = 1u << 7;
+
+      return ((TElementMask)(lanesDifferent & kAxisLanes)) |
+          ((TElementMask)(stateA.button.word ^ stateB.button.word) << kElementMaskButtonShift) |
+          ((0 != (lanesDifferent & kPovLane)) ? ((TElementMask)1 << kElementMaskPovShift) : 0);
+    }
 
     /// Enumerates possible statuses for physical controller devices.
     enum class EPhysicalDeviceStatus : uint8_t
@@ -469,8 +659,9 @@ namespace Xidi
 
     /// Enumerates all digital buttons that might be present on a physical controller. As an
     /// implementation simplification, the order of enumerators corresponds to the ordering used in
-    /// XInput. One enumerator exists per possible button. Guide and Share buttons are not actually
-    /// used, but they still have space allocated for them on a speculative basis.
+    /// XInput. One enumerator exists per possible button. The Guide button is only reported if the
+    /// extended XInput state query is enabled. The Share button is not actually used, but it still
+    /// has space allocated for it on a speculative basis.
     enum class EPhysicalButton : uint8_t
     {
       DpadUp,
@@ -483,7 +674,7 @@ namespace Xidi
       RS,
       LB,
       RB,
-      UnusedGuide,
+      Guide,
       UnusedShare,
       A,
       B,
@@ -494,6 +685,59 @@ namespace Xidi
       Count
     };
 
+    /// Enumerates all axes of rotation that might be measured by a motion sensor present on a
+    /// physical controller. One enumerator exists per possible axis, from the point of view of a
+    /// user holding the controller.
+    enum class EPhysicalMotionAxis : uint8_t
+    {
+      /// Rotation about the horizontal axis running from the left grip to the right grip, which
+      /// tilts the controller towards or away from the user.
+      Pitch,
+
+      /// Rotation about the vertical axis, which turns the controller left or right.
+      Yaw,
+
+      /// Rotation about the horizontal axis pointing away from the user, which tilts the
+      /// controller to the left or right.
+      Roll,
+
+      /// Sentinel value, total number of enumerators
+      Count
+    };
+
+    /// Number of physical motion units that represent an angular velocity of one degree per
+    /// second. Motion sensor readings are expressed in these units.
+    inline constexpr int32_t kPhysicalMotionUnitsPerDegreePerSecond = 16;
+
+    /// Single reading from a physical controller's motion sensor. Motion sensors are generally
+    /// sampled much more often than physical controllers are polled, so readings are delivered in
+    /// batches and integrated once per poll.
+    struct SPhysicalMotionSample
+    {
+      /// Performance counter value at which the reading was taken.
+      int64_t timestamp;
+
+      /// Angular velocity about each axis, in physical motion units, one element per axis.
+      std::array<int16_t, static_cast<int>(EPhysicalMotionAxis::Count)> angularVelocity;
+    };
+
+    /// Data format for representing physical controller motion, as integrated from motion sensor
+    /// readings over the course of one poll. Kept separate from #SPhysicalState so that physical
+    /// controllers without motion sensors, which are the common case, do not pay for it.
+    struct SPhysicalMotion
+    {
+      /// Average angular velocity about each axis since the previous poll, in physical motion
+      /// units, one element per axis.
+      std::array<int16_t, static_cast<int>(EPhysicalMotionAxis::Count)> angularVelocity;
+
+      constexpr bool operator==(const SPhysicalMotion& other) const = default;
+
+      constexpr int16_t operator[](EPhysicalMotionAxis desiredAxis) const
+      {
+        return angularVelocity[static_cast<int>(desiredAxis)];
+      }
+    };
+
     /// Data format for representing physical controller state, as received from controller devices
     /// and before being passed through a mapper.
     struct SPhysicalState
@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <limits>
-#include <map>
 #include <memory>
 #include <optional>
 #include <set>
+#include <vector>
 
 #include "ApiDirectInput.h"
 #include "ControllerTypes.h"
@@ -62,6 +64,17 @@ namespace Xidi
   {
   public:
 
+    /// Value used in place of a real offset to indicate that no valid offset exists.
+    static constexpr TOffset kInvalidOffsetValue = std::numeric_limits<TOffset>::max();
+
+    /// Specifies the maximum size of an application data packet, in bytes.
+    static constexpr TOffset kMaxDataPacketSizeBytes = 4096;
+
+    /// Element identifier value used in place of a real element to indicate that no element is
+    /// associated with an offset. The whole controller is never associated with any one offset.
+    static constexpr Controller::SElementIdentifier kInvalidElementValue = {
+        .type = Controller::EElementType::WholeController};
+
     /// Holds everything needed to reason about an application's data format.
     /// Generally intended for internal use, but examining the contents can be useful for testing.
     struct SDataFormatSpec
@@ -87,10 +100,11 @@ namespace Xidi
       /// virtual controller can only have one POV.
       TOffset povOffset;
 
-      /// Reverse map from application data format offset to virtual controller element.
+      /// Reverse lookup table from application data format offset to virtual controller element.
       /// Applications are allowed to identify controller elements by data format offset, so this
-      /// map enables that functionality.
-      std::map<TOffset, Controller::SElementIdentifier> offsetElementMap;
+      /// table enables that functionality. One slot exists for each possible offset, and slots for
+      /// offsets with no associated element hold #kInvalidElementValue.
+      std::array<Controller::SElementIdentifier, kMaxDataPacketSizeBytes> offsetElement;
 
       inline SDataFormatSpec(TOffset packetSizeBytes)
           : packetSizeBytes(packetSizeBytes),
@@ -98,12 +112,14 @@ namespace Xidi
             axisOffset(),
             buttonOffset(),
             povOffset(kInvalidOffsetValue),
-            offsetElementMap()
+            offsetElement()
       {
         for (auto& offsetValue : axisOffset)
           offsetValue = kInvalidOffsetValue;
         for (auto& offsetValue : buttonOffset)
           offsetValue = kInvalidOffsetValue;
+
+        offsetElement.fill(kInvalidElementValue);
       }
 
       inline bool operator==(const SDataFormatSpec& other) const
@@ -113,7 +129,7 @@ namespace Xidi
             (povOffsetsUnused == other.povOffsetsUnused) &&
             (0 == memcmp(axisOffset, other.axisOffset, sizeof(axisOffset))) &&
             (0 == memcmp(buttonOffset, other.buttonOffset, sizeof(axisOffset))) &&
-            (povOffset == other.povOffset) && (offsetElementMap == other.offsetElementMap));
+            (povOffset == other.povOffset) && (offsetElement == other.offsetElement));
       }
 
       /// Associates the specified element with the specified offset into the application's data
@@ -138,7 +154,7 @@ namespace Xidi
             break;
         }
 
-        offsetElementMap[offset] = element;
+        offsetElement[offset] = element;
       }
 
       /// Adds a new unused POV offset to the tracked set of unused POV offsets.
@@ -149,12 +165,6 @@ namespace Xidi
       }
     };
 
-    /// Value used in place of a real offset to indicate that no valid offset exists.
-    static constexpr TOffset kInvalidOffsetValue = std::numeric_limits<TOffset>::max();
-
-    /// Specifies the maximum size of an application data packet, in bytes.
-    static constexpr TOffset kMaxDataPacketSizeBytes = 4096;
-
     /// Value used to indicate to the application that a button is pressed.
     static constexpr TButtonValue kButtonValuePressed = 0x80;
 
@@ -174,6 +184,21 @@ namespace Xidi
     static std::unique_ptr<DataFormat> CreateFromApplicationFormatSpec(
         const DIDATAFORMAT& appFormatSpec, const Controller::SCapabilities controllerCapabilities);
 
+    /// Obtains a data format representation for an application's DirectInput data format
+    /// specification, reusing a previously-created instance if the same specification was already
+    /// accepted for a virtual controller with the same capabilities. Applications typically supply
+    /// the same data format to every device they create and may set it repeatedly, so this avoids
+    /// parsing the same specification over and over. Instances are identified by the contents of
+    /// the specification, not by its address. Failure is the same as for
+    /// #CreateFromApplicationFormatSpec.
+    /// @param [in] appFormatSpec Application-provided DirectInput data format specification.
+    /// @param [in] controllerCapabilities Capabilities of the virtual controller for which the data
+    /// format is being specified.
+    /// @return Shared read-only pointer to the data format representation, or `nullptr` if there
+    /// is an issue with the application format specification.
+    static std::shared_ptr<const DataFormat> GetOrCreateFromApplicationFormatSpec(
+        const DIDATAFORMAT& appFormatSpec, const Controller::SCapabilities controllerCapabilities);
+
     /// Generates a DirectInput axis value from a virtual controller axis value.
     /// @param [in] axis Virtual controller axis value.
     /// @return Corresponding DirectInput value.
@@ -199,12 +224,50 @@ namespace Xidi
     /// @param [in] offset Application data format offset for which an associated virtual controller
     /// element is desired.
     /// @return Associated virtual controller element if an offset is defined for it.
-    std::optional<Controller::SElementIdentifier> GetElementForOffset(TOffset offset) const;
+    inline std::optional<Controller::SElementIdentifier> GetElementForOffset(TOffset offset) const
+    {
+      if (offset >= kMaxDataPacketSizeBytes) return std::nullopt;
+
+      const Controller::SElementIdentifier element = dataFormatSpec.offsetElement[offset];
+      if (kInvalidElementValue == element) return std::nullopt;
+
+      return element;
+    }
 
     /// Maps from virtual controller element to an offset within the application's data format.
+    /// Offsets are held in tables indexed by element, so this lookup is cheap enough to be used
+    /// once per buffered event.
     /// @param [in] element Virtual controller element for which an offset is desired.
     /// @return Associated offset if it is defined in the application's data format.
-    std::optional<TOffset> GetOffsetForElement(Controller::SElementIdentifier element) const;
+    inline std::optional<TOffset> GetOffsetForElement(Controller::SElementIdentifier element) const
+    {
+      switch (element.type)
+      {
+        case Controller::EElementType::Axis:
+          if (kInvalidOffsetValue != dataFormatSpec.axisOffset[(int)element.axis])
+            return dataFormatSpec.axisOffset[(int)element.axis];
+          break;
+
+        case Controller::EElementType::Button:
+          if (kInvalidOffsetValue != dataFormatSpec.buttonOffset[(int)element.button])
+            return dataFormatSpec.buttonOffset[(int)element.button];
+          break;
+
+        case Controller::EElementType::Pov:
+          if (kInvalidOffsetValue != dataFormatSpec.povOffset) return dataFormatSpec.povOffset;
+          break;
+      }
+
+      return std::nullopt;
+    }
+
+    /// Retrieves all of the virtual controller elements with which the application's data format
+    /// associates an offset, all at once. Equivalent to checking every element with #HasElement.
+    /// @return Element mask identifying the elements present in the data format.
+    inline Controller::TElementMask GetElements(void) const
+    {
+      return presentElements;
+    }
 
     /// Retrieves and returns the total number of bytes in the data format represented by this
     /// object. Does not do any error checking.
@@ -252,6 +315,19 @@ namespace Xidi
         TOffset packetBufferSizeBytes,
         const Controller::SState& controllerState) const;
 
+    /// Formats only the specified elements of the specified virtual controller state and writes
+    /// them to the specified buffer, leaving everything else in the buffer untouched. Useful for
+    /// patching an application data packet that was previously written in its entirety using
+    /// #WriteDataPacket, in which case the result is the same as writing the whole packet again
+    /// provided that all elements that changed since then are specified. Failure indicates an
+    /// issue with the arguments passed.
+    /// @return `true` on success, `false` on failure due to invalid arguments.
+    bool WriteDataPacketElements(
+        void* packetBuffer,
+        TOffset packetBufferSizeBytes,
+        const Controller::SState& controllerState,
+        Controller::TElementMask elements) const;
+
   private:
 
     /// Objects cannot be constructed externally. This constructor requires a complete data
@@ -260,13 +336,129 @@ namespace Xidi
     /// object.
     inline DataFormat(
         const Controller::SCapabilities controllerCapabilities, SDataFormatSpec&& dataFormatSpec)
-        : controllerCapabilities(controllerCapabilities), dataFormatSpec(std::move(dataFormatSpec))
-    {}
+        : controllerCapabilities(controllerCapabilities),
+          dataFormatSpec(std::move(dataFormatSpec)),
+          packetTemplate(),
+          packetWriteOperations(),
+          presentElements(),
+          standardFormat(EStandardFormat::None),
+          standardFormatAxisMask(),
+          standardFormatButtonMask(0),
+          standardFormatHasPov(false)
+    {
+      CompilePacketWriter();
+    }
+
+    /// Enumerates the kinds of operations that make up a compiled application data packet writer.
+    enum class EPacketWriteOperationKind : uint8_t
+    {
+      /// Writes one axis value. Source identifies the axis.
+      Axis,
+
+      /// Writes the state of a run of buttons that occupy consecutive button indices and
+      /// consecutive offsets. Source identifies the first button in the run, and count is the
+      /// number of buttons in the run.
+      ButtonRun,
+
+      /// Writes the POV value.
+      Pov
+    };
+
+    /// Single operation within a compiled application data packet writer.
+    struct SPacketWriteOperation
+    {
+      /// Kind of operation.
+      EPacketWriteOperationKind kind;
+
+      /// Index of the virtual controller element that supplies the value, which is interpreted
+      /// based on the kind of operation.
+      uint8_t source;
+
+      /// Number of virtual controller elements written by this operation.
+      uint8_t count;
+
+      /// Offset within the application data packet at which the value is written.
+      TOffset offset;
+
+      /// Virtual controller elements written by this operation.
+      Controller::TElementMask elements;
+    };
+
+    /// Enumerates the standard DirectInput joystick data formats, which are written directly as
+    /// the corresponding DirectInput structures rather than by executing write operations.
+    enum class EStandardFormat : uint8_t
+    {
+      /// Not a standard data format.
+      None,
+
+      /// Same layout as `c_dfDIJoystick`, written as a `DIJOYSTATE` structure.
+      Joystick,
+
+      /// Same layout as `c_dfDIJoystick2`, written as a `DIJOYSTATE2` structure.
+      Joystick2
+    };
+
+    /// Determines if the data format specification lays out the application data packet the same
+    /// way as one of the standard DirectInput joystick data formats. This is the case if every
+    /// element with an offset is located where the corresponding `DIJOYSTATE` member is and every
+    /// POV slot not occupied by the virtual controller's POV is initialized to center position.
+    /// @return Standard data format that was identified, if any.
+    EStandardFormat IdentifyStandardFormat(void) const;
+
+    /// Compiles the data format specification into the packet template and list of write
+    /// operations that are used when writing application data packets. Invoked once, during
+    /// construction, so that writing a data packet does not need to consult every possible
+    /// element of the data format specification.
+    void CompilePacketWriter(void);
+
+    /// Writes a complete application data packet for a standard DirectInput joystick data format.
+    /// Every member of the corresponding structure is written at its fixed location, so neither
+    /// the packet template nor the write operations are consulted.
+    /// @param [out] packetByteBuffer Buffer that holds the application data packet.
+    /// @param [in] controllerState Virtual controller state from which values are read.
+    void WriteStandardFormatDataPacket(
+        uint8_t* packetByteBuffer, const Controller::SState& controllerState) const;
+
+    /// Executes the compiled write operations that write any of the specified virtual controller
+    /// elements into an application data packet.
+    /// @param [out] packetByteBuffer Buffer that holds the application data packet.
+    /// @param [in] controllerState Virtual controller state from which values are read.
+    /// @param [in] elements Virtual controller elements to be written.
+    void ExecutePacketWriteOperations(
+        uint8_t* packetByteBuffer,
+        const Controller::SState& controllerState,
+        Controller::TElementMask elements) const;
 
     /// Controller capabilities. Often consulted when identifying controller objects.
     const Controller::SCapabilities controllerCapabilities;
 
     /// Complete description of the application's data format.
     const SDataFormatSpec dataFormatSpec;
+
+    /// Initial contents of every application data packet, before any controller state is written.
+    /// Everything is 0 except for unused POVs, which are initialized to center position.
+    std::vector<uint8_t> packetTemplate;
+
+    /// Operations that write controller state into an application data packet, one per used axis
+    /// and POV and one per run of buttons. Ordered by kind and then by source element.
+    std::vector<SPacketWriteOperation> packetWriteOperations;
+
+    /// All virtual controller elements that have an offset in the application's data format.
+    Controller::TElementMask presentElements;
+
+    /// Standard DirectInput joystick data format with the same layout as the application's data
+    /// format, if any.
+    EStandardFormat standardFormat;
+
+    /// Masks applied to axis values when writing a standard data format, one per axis. All bits
+    /// are set for axes that have an offset and clear for those that do not.
+    std::array<int32_t, (int)Controller::EAxis::Count> standardFormatAxisMask;
+
+    /// Buttons that have an offset when writing a standard data format, one bit per button.
+    Controller::SButtonSet::TWord standardFormatButtonMask;
+
+    /// Whether or not the virtual controller's POV has an offset when writing a standard data
+    /// format.
+    bool standardFormatHasPov;
   };
 } // namespace Xidi
@@ -31,11 +31,15 @@
   static std::wstring_view _Xidi_DllFunctionsInternal_GetLibraryPath_##libraryName(void)
 
 /// Defines an exported function to be forwarded to the specified DLL, such that the DLL name was
-/// previously defined using one of the preceding macros.
+/// previously defined using one of the preceding macros. The destination address initially refers
+/// to a resolver stub, implemented in assembly, that resolves this one function the first time it
+/// is called and then replaces itself with the resolved address.
 #define DLL_EXPORT_FORWARD(libraryName, funcName)                                                  \
   namespace _Xidi_DllFunctionsInternal                                                             \
   {                                                                                                \
-    extern "C" void* _ptr_export_##libraryName##_##funcName = nullptr;                             \
+    extern "C" void _resolve_export_##libraryName##_##funcName(void);                              \
+    extern "C" void* _ptr_export_##libraryName##_##funcName =                                      \
+        reinterpret_cast<void*>(&_resolve_export_##libraryName##_##funcName);                      \
     static ::Xidi::DllFunctions::ForwardedFunction dllForwardedFunctionInstance_##funcName(        \
         &_Xidi_DllFunctionsInternal_GetLibraryPath_##libraryName,                                  \
         #funcName,                                                                                 \
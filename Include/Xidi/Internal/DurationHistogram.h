@@ -0,0 +1,145 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file DurationHistogram.h
+ *   Declaration and implementation of a concurrency-safe histogram of durations.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "ApiXidi.h"
+
+namespace Xidi
+{
+  /// Distribution of durations, in microseconds, with bounded relative error. Durations below
+  /// the linear bucket count each get their own bucket. Above that, each power of two is split
+  /// evenly into a fixed number of sub-buckets. Counters are updated using relaxed atomic
+  /// operations so that any number of threads can record and read at the same time.
+  class DurationHistogram
+  {
+  public:
+
+    DurationHistogram(void) : numSamples(0), maxMicroseconds(0), bucketCounts() {}
+
+    DurationHistogram(const DurationHistogram& other) = delete;
+
+    /// Computes statistics from the durations recorded so far.
+    /// @return Statistics for the recorded durations.
+    Api::SDurationStatistics GetStatistics(void) const
+    {
+      Api::SDurationStatistics statistics = {
+          .numSamples = numSamples.load(std::memory_order_relaxed),
+          .maxMicroseconds = maxMicroseconds.load(std::memory_order_relaxed)};
+
+      statistics.p50Microseconds = Percentile(statistics.numSamples, 50);
+      statistics.p99Microseconds = Percentile(statistics.numSamples, 99);
+      return statistics;
+    }
+
+    /// Records a single duration.
+    /// @param [in] microseconds Duration to record.
+    void Record(uint64_t microseconds)
+    {
+      bucketCounts[BucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+      numSamples.fetch_add(1, std::memory_order_relaxed);
+
+      uint64_t currentMaxMicroseconds = maxMicroseconds.load(std::memory_order_relaxed);
+      while ((microseconds > currentMaxMicroseconds) &&
+             (false ==
+              maxMicroseconds.compare_exchange_weak(
+                  currentMaxMicroseconds, microseconds, std::memory_order_relaxed)))
+        ;
+    }
+
+  private:
+
+    /// Number of durations, starting from 0, that each get their own bucket.
+    static constexpr unsigned int kLinearBucketCount = 16;
+
+    /// Number of bits used to select a sub-bucket within each power of two.
+    static constexpr unsigned int kSubBucketBits = 3;
+
+    /// Exponent of the smallest power of two that is split into sub-buckets.
+    static constexpr unsigned int kMinExponent = std::bit_width(kLinearBucketCount) - 1;
+
+    /// Exponent of the largest power of two that is split into sub-buckets. Anything larger is
+    /// counted in the last bucket.
+    static constexpr unsigned int kMaxExponent = 31;
+
+    /// Total number of buckets.
+    static constexpr unsigned int kBucketCount =
+        kLinearBucketCount + ((kMaxExponent - kMinExponent + 1) << kSubBucketBits);
+
+    /// Determines which bucket holds the specified duration.
+    /// @param [in] microseconds Duration of interest.
+    /// @return Index of the bucket.
+    static unsigned int BucketIndex(uint64_t microseconds)
+    {
+      if (microseconds < kLinearBucketCount) return (unsigned int)microseconds;
+
+      const unsigned int exponent = (unsigned int)std::bit_width(microseconds) - 1;
+      if (exponent > kMaxExponent) return (kBucketCount - 1);
+
+      const unsigned int subBucket =
+          (unsigned int)(microseconds >> (exponent - kSubBucketBits)) &
+          ((1u << kSubBucketBits) - 1);
+      return kLinearBucketCount + ((exponent - kMinExponent) << kSubBucketBits) + subBucket;
+    }
+
+    /// Determines the largest duration that the specified bucket holds.
+    /// @param [in] bucketIndex Index of the bucket of interest.
+    /// @return Largest duration in the bucket.
+    static uint64_t BucketUpperBound(unsigned int bucketIndex)
+    {
+      if (bucketIndex < kLinearBucketCount) return bucketIndex;
+
+      const unsigned int exponent =
+          kMinExponent + ((bucketIndex - kLinearBucketCount) >> kSubBucketBits);
+      const uint64_t subBucket =
+          (uint64_t)((bucketIndex - kLinearBucketCount) & ((1u << kSubBucketBits) - 1));
+      const uint64_t subBucketWidth = 1ull << (exponent - kSubBucketBits);
+
+      return (1ull << exponent) + ((subBucket + 1) * subBucketWidth) - 1;
+    }
+
+    /// Computes the specified percentile of the recorded durations.
+    /// @param [in] totalSamples Number of samples to take as the total.
+    /// @param [in] percentile Percentile of interest, from 1 to 100.
+    /// @return Upper bound of the bucket that contains the percentile, limited to the largest
+    /// duration recorded, or 0 if nothing is recorded.
+    uint64_t Percentile(uint64_t totalSamples, unsigned int percentile) const
+    {
+      if (0 == totalSamples) return 0;
+
+      const uint64_t targetRank = ((totalSamples * percentile) + 99) / 100;
+      uint64_t rank = 0;
+
+      for (unsigned int i = 0; i < kBucketCount; ++i)
+      {
+        rank += bucketCounts[i].load(std::memory_order_relaxed);
+        if (rank >= targetRank)
+          return std::min(BucketUpperBound(i), maxMicroseconds.load(std::memory_order_relaxed));
+      }
+
+      return maxMicroseconds.load(std::memory_order_relaxed);
+    }
+
+    /// Number of durations recorded.
+    std::atomic<uint64_t> numSamples;
+
+    /// Largest duration recorded.
+    std::atomic<uint64_t> maxMicroseconds;
+
+    /// Number of durations recorded in each bucket.
+    std::atomic<uint64_t> bucketCounts[kBucketCount];
+  };
+} // namespace Xidi
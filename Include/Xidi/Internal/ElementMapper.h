@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "ControllerTypes.h"
@@ -27,6 +28,8 @@ namespace Xidi
 {
   namespace Controller
   {
+    class ElementMapperProgram;
+
     /// Interface for mapping an XInput controller element's state reading to an internal controller
     /// state data structure value. An instance of this object exists for each XInput controller
     /// element in a mapper.
@@ -36,6 +39,28 @@ namespace Xidi
 
       virtual ~IElementMapper(void) = default;
 
+      /// Allocates storage for an element mapper object. Element mappers are small and numerous,
+      /// so their storage is carved out of contiguous blocks shared by all element mappers rather
+      /// than obtained by individual heap allocations. This applies to all ways of dynamically
+      /// creating element mappers, including `std::make_unique` and #Clone.
+      /// @param [in] size Size of the element mapper object, in bytes.
+      /// @return Pointer to the allocated storage.
+      static void* operator new(size_t size);
+
+      /// Releases storage for an element mapper object that was previously allocated using the
+      /// class-specific allocation function.
+      /// @param [in] ptr Pointer to the storage to be released.
+      /// @param [in] size Size of the element mapper object, in bytes.
+      static void operator delete(void* ptr, size_t size);
+
+      /// Appends to the specified program the instructions that make the same contributions as
+      /// this element mapper. The default implementation appends a single instruction that forwards
+      /// to this element mapper's virtual methods, which produces identical results for any element
+      /// mapper but is not devirtualized. Element mappers that are compiled to instructions must be
+      /// kept alive at least as long as the program.
+      /// @param [in,out] program Program to which instructions are appended.
+      virtual void AppendToProgram(ElementMapperProgram& program) const;
+
       /// Allocates, constructs, and returns a pointer to a copy of this element mapper.
       /// @return Smart pointer to a copy of this element mapper.
       virtual std::unique_ptr<IElementMapper> Clone(void) const = 0;
@@ -125,6 +150,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -165,6 +191,7 @@ namespace Xidi
       inline constexpr ButtonMapper(EButton button) : IElementMapper(), button(button) {}
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -216,6 +243,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -277,15 +305,196 @@ namespace Xidi
       {}
 
       // AxisMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
+      std::unique_ptr<IElementMapper> Clone(void) const override;
+      void ContributeFromAnalogValue(
+          SState& controllerState,
+          int16_t analogValue,
+          uint32_t sourceIdentifier = 0) const override;
+      void ContributeFromTriggerValue(
+          SState& controllerState,
+          uint8_t triggerValue,
+          uint32_t sourceIdentifier = 0) const override;
+    };
+
+    /// Filters the input reading from an XInput controller element and then forwards it to another
+    /// element mapper, for suppressing the noise produced by worn analog sticks and triggers. When
+    /// filtering removes a change entirely the forwarded value stays the same, so nothing
+    /// downstream of the mapper sees a change either. Button readings are forwarded unmodified.
+    /// Filter state is held separately for each physical controller and is reset by a neutral
+    /// contribution. Each contribution is treated as one sample, so smoothing filters converge
+    /// towards a steady reading as the physical controller keeps reporting it.
+    class FilterMapper : public IElementMapper
+    {
+    public:
+
+      /// Enumerates the supported filter kernels. All of them have a fixed per-sample cost.
+      enum class EFilterType : uint8_t
+      {
+        /// Forwards the previously-forwarded value until the reading moves away from it by more
+        /// than a threshold, at which point the reading itself is forwarded.
+        Hysteresis,
+
+        /// Exponential moving average with a fixed smoothing factor.
+        ExponentialMovingAverage,
+
+        /// Exponential moving average whose smoothing is relaxed as the reading changes faster,
+        /// following the "one euro" filter, so that slow movement is smoothed heavily but fast
+        /// movement is followed with little lag.
+        OneEuro,
+
+        /// Separates the press and release points of analog to digital conversions. A reading is
+        /// pressed once it reaches the usual pressed threshold, but it is only released once it
+        /// recedes from that threshold by more than a margin. Until then the threshold value is
+        /// forwarded in place of the reading, so that digital targets stay pressed.
+        PressRelease
+      };
+
+      /// Maximum allowed strength for hysteresis filters, as a percentage of the element range.
+      static constexpr unsigned int kMaxHysteresisStrength = 25;
+
+      /// Maximum allowed strength for smoothing filters, as a percentage of the reading that is
+      /// carried over from one sample to the next.
+      static constexpr unsigned int kMaxSmoothingStrength = 99;
+
+      /// Maximum allowed strength for press and release filters, as a percentage of the element
+      /// range. Keeps the release point on the same side of neutral as the pressed threshold.
+      static constexpr unsigned int kMaxPressReleaseStrength = 10;
+
+      /// Determines the maximum allowed strength for the specified filter type.
+      /// @param [in] filterType Filter type of interest.
+      /// @return Maximum allowed strength.
+      static constexpr unsigned int MaxStrength(EFilterType filterType)
+      {
+        switch (filterType)
+        {
+          case EFilterType::Hysteresis:
+            return kMaxHysteresisStrength;
+
+          case EFilterType::PressRelease:
+            return kMaxPressReleaseStrength;
+
+          default:
+            return kMaxSmoothingStrength;
+        }
+      }
+
+      /// Creates a filter mapper.
+      /// @param [in] filterType Filter kernel to apply.
+      /// @param [in] strength For hysteresis filters, the threshold as a percentage of the range
+      /// of the element being filtered. For smoothing filters, the percentage of the previously
+      /// forwarded value that is retained with each sample while the reading is steady. For press
+      /// and release filters, the release margin as a percentage of the range of the element being
+      /// filtered. Clamped to the maximum allowed for the filter type.
+      /// @param [in] elementMapper Mapper to which filtered input is forwarded.
+      FilterMapper(
+          EFilterType filterType,
+          unsigned int strength,
+          std::unique_ptr<const IElementMapper>&& elementMapper);
+
+      FilterMapper(const FilterMapper& other);
+
+      /// Retrieves and returns a raw read-only pointer to the underlying element mapper. This
+      /// object maintains ownership over the returned pointer.
+      /// @return Read-only pointer to the underlying element mapper.
+      inline const IElementMapper* GetElementMapper(void) const
+      {
+        return elementMapper.get();
+      }
+
+      /// Retrieves the filter kernel that this mapper applies.
+      /// @return Filter type.
+      inline EFilterType GetFilterType(void) const
+      {
+        return filterType;
+      }
+
+      /// Retrieves the filter strength that this mapper applies, after clamping.
+      /// @return Filter strength.
+      inline unsigned int GetStrength(void) const
+      {
+        return strength;
+      }
+
+      // IElementMapper
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
           int16_t analogValue,
           uint32_t sourceIdentifier = 0) const override;
+      void ContributeFromButtonValue(
+          SState& controllerState,
+          bool buttonPressed,
+          uint32_t sourceIdentifier = 0) const override;
       void ContributeFromTriggerValue(
           SState& controllerState,
           uint8_t triggerValue,
           uint32_t sourceIdentifier = 0) const override;
+      void ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier = 0) const override;
+      int GetTargetElementCount(void) const override;
+      std::optional<SElementIdentifier> GetTargetElementAt(int index) const override;
+
+    private:
+
+      /// Filter state for a single physical controller. Values are fixed-point with
+      /// #kFractionBits fractional bits, in the units of the element being filtered.
+      struct SFilterState
+      {
+        /// Whether or not any sample has been received since the state was last reset.
+        bool valid;
+
+        /// Previously-received reading.
+        int32_t previousReading;
+
+        /// Previously-forwarded value.
+        int32_t output;
+
+        /// Smoothed magnitude of the per-sample change in reading. Only used by one euro filters.
+        int32_t speed;
+
+        /// Direction in which the reading is currently pressed, either -1, 0 for not pressed, or
+        /// +1. Only used by press and release filters.
+        int8_t pressedDirection;
+      };
+
+      /// Number of fractional bits in filter state values.
+      static constexpr int kFractionBits = 8;
+
+      /// Applies the filter kernel to a single sample.
+      /// @param [in] sourceIdentifier Opaque identifier for the source of the sample.
+      /// @param [in] reading Sample value in the units of the element being filtered.
+      /// @param [in] elementRange Full range of the element being filtered.
+      /// @return Filtered value in the units of the element being filtered.
+      int32_t Filter(uint32_t sourceIdentifier, int32_t reading, int32_t elementRange) const;
+
+      /// Applies the press and release filter kernel to a single sample.
+      /// @param [in] sourceIdentifier Opaque identifier for the source of the sample.
+      /// @param [in] reading Sample value in the units of the element being filtered.
+      /// @param [in] elementRange Full range of the element being filtered.
+      /// @param [in] negativeThreshold Value at and below which the reading is pressed in the
+      /// negative direction.
+      /// @param [in] positiveThreshold Value at and above which the reading is pressed in the
+      /// positive direction.
+      /// @return Filtered value in the units of the element being filtered.
+      int32_t FilterPressRelease(
+          uint32_t sourceIdentifier,
+          int32_t reading,
+          int32_t elementRange,
+          int32_t negativeThreshold,
+          int32_t positiveThreshold) const;
+
+      /// Filter kernel to apply.
+      const EFilterType filterType;
+
+      /// Filter strength, as described in the constructor.
+      const unsigned int strength;
+
+      /// Mapper to which filtered input is forwarded.
+      const std::unique_ptr<const IElementMapper> elementMapper;
+
+      /// Filter state, one per physical controller. Contributions for any single physical
+      /// controller are never made concurrently.
+      mutable std::array<SFilterState, kMaxPhysicalControllerCount> filterState;
     };
 
     /// Inverts the input reading from an XInput controller element and then forwards it to another
@@ -311,6 +520,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -354,6 +564,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -410,6 +621,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const override;
@@ -453,6 +665,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -494,6 +707,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -559,6 +773,7 @@ namespace Xidi
       }
 
       // IElementMapper
+      void AppendToProgram(ElementMapperProgram& program) const override;
       std::unique_ptr<IElementMapper> Clone(void) const override;
       void ContributeFromAnalogValue(
           SState& controllerState,
@@ -586,5 +801,331 @@ namespace Xidi
       /// controller element is in "negative" state.
       const std::unique_ptr<const IElementMapper> negativeMapper;
     };
+
+    /// Repeatedly presses and releases the target of another element mapper for as long as the
+    /// associated XInput controller element is held, commonly known as "turbo" or "auto-fire." An
+    /// element is held if a button mapper would consider it pressed. While held, the reading is
+    /// forwarded unmodified during the first half of each repetition and replaced with a released
+    /// reading during the second half, starting with the first half as soon as the element becomes
+    /// held. Time is measured using the timestamp of the physical controller poll that produced
+    /// the reading, so no additional threads or timers are needed, but the physical controller
+    /// state must be mapped again on every poll for as long as any turbo mapper is held. Repetition
+    /// state is held separately for each physical controller and is reset by a neutral
+    /// contribution.
+    class TurboMapper : public IElementMapper
+    {
+    public:
+
+      /// Minimum allowed repetition rate, in presses per second.
+      static constexpr unsigned int kMinRate = 1;
+
+      /// Maximum allowed repetition rate, in presses per second. Faster rates would be shorter
+      /// than a few polls of the physical controller and could not be reproduced faithfully.
+      static constexpr unsigned int kMaxRate = 30;
+
+      /// Creates a turbo mapper.
+      /// @param [in] rate Number of presses per second. Clamped to the allowed range.
+      /// @param [in] elementMapper Mapper to which input is forwarded.
+      TurboMapper(unsigned int rate, std::unique_ptr<const IElementMapper>&& elementMapper);
+
+      TurboMapper(const TurboMapper& other);
+
+      /// Determines if any turbo mapper was held during the most recent mapping of the state of
+      /// the specified physical controller. If so, that physical controller's state must be mapped
+      /// again on every poll, even if it does not change, for its mapped state to stay current.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller.
+      /// @return `true` if so, `false` otherwise.
+      static bool IsAnyHeld(uint32_t sourceControllerIdentifier);
+
+      /// Sets the time at which the state of the specified physical controller that is about to be
+      /// mapped was read, and forgets whether any turbo mapper was held during the previous
+      /// mapping. Must be invoked before each mapping of that physical controller's state.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller.
+      /// @param [in] timestampMicroseconds Time of the poll, in microseconds, on any monotonic
+      /// clock that is used consistently for the same physical controller.
+      static void SetMappingTimestamp(
+          uint32_t sourceControllerIdentifier, int64_t timestampMicroseconds);
+
+      /// Retrieves and returns a raw read-only pointer to the underlying element mapper. This
+      /// object maintains ownership over the returned pointer.
+      /// @return Read-only pointer to the underlying element mapper.
+      inline const IElementMapper* GetElementMapper(void) const
+      {
+        return elementMapper.get();
+      }
+
+      /// Retrieves the repetition rate that this mapper applies, after clamping.
+      /// @return Number of presses per second.
+      inline unsigned int GetRate(void) const
+      {
+        return rate;
+      }
+
+      // IElementMapper
+      std::unique_ptr<IElementMapper> Clone(void) const override;
+      void ContributeFromAnalogValue(
+          SState& controllerState,
+          int16_t analogValue,
+          uint32_t sourceIdentifier = 0) const override;
+      void ContributeFromButtonValue(
+          SState& controllerState,
+          bool buttonPressed,
+          uint32_t sourceIdentifier = 0) const override;
+      void ContributeFromTriggerValue(
+          SState& controllerState,
+          uint8_t triggerValue,
+          uint32_t sourceIdentifier = 0) const override;
+      void ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier = 0) const override;
+      int GetTargetElementCount(void) const override;
+      std::optional<SElementIdentifier> GetTargetElementAt(int index) const override;
+
+    private:
+
+      /// Repetition state for a single physical controller.
+      struct SRepetitionState
+      {
+        /// Whether or not the associated XInput controller element was held as of the previous
+        /// contribution.
+        bool held;
+
+        /// Time at which the associated XInput controller element became held, in microseconds.
+        int64_t heldSinceMicroseconds;
+      };
+
+      /// Updates the repetition state for a single contribution and determines if the reading
+      /// should be forwarded unmodified.
+      /// @param [in] sourceIdentifier Opaque identifier for the source of the reading.
+      /// @param [in] isHeld Whether or not the reading holds the associated XInput controller
+      /// element.
+      /// @return `true` if the reading should be forwarded unmodified, `false` if a released
+      /// reading should be forwarded instead.
+      bool IsInPressedPhase(uint32_t sourceIdentifier, bool isHeld) const;
+
+      /// Repetition rate, as described in the constructor.
+      const unsigned int rate;
+
+      /// Mapper to which input is forwarded.
+      const std::unique_ptr<const IElementMapper> elementMapper;
+
+      /// Repetition state, one per physical controller. Contributions for any single physical
+      /// controller are never made concurrently.
+      mutable std::array<SRepetitionState, kMaxPhysicalControllerCount> repetitionState;
+    };
+
+    /// Flattened and devirtualized form of the element mappers for a set of XInput controller
+    /// elements. Each tree of element mappers is compiled into a contiguous run of instructions
+    /// which are then executed by a switch-dispatched interpreter rather than by virtual method
+    /// calls. Compound element mappers are flattened into the instructions for their underlying
+    /// element mappers, and element mappers that transform or route their input, such as invert
+    /// and split mappers, become instructions that govern a block of the instructions that follow
+    /// them. Contributions are identical to those made by the element mappers themselves.
+    class ElementMapperProgram
+    {
+    public:
+
+      /// Enumerates all possible kinds of instructions.
+      enum class EOpcode : uint8_t
+      {
+        /// Contributes to a virtual controller axis, like #AxisMapper.
+        Axis,
+
+        /// Contributes to a virtual controller button, like #ButtonMapper.
+        Button,
+
+        /// Contributes to a virtual controller axis, like #DigitalAxisMapper.
+        DigitalAxis,
+
+        /// Forwards to the virtual methods of an element mapper that has no instructions of its
+        /// own.
+        Forward,
+
+        /// Inverts the input value and passes it to the block of instructions that follows.
+        Invert,
+
+        /// Contributes to a keyboard key, like #KeyboardMapper.
+        Keyboard,
+
+        /// Contributes to a mouse axis, like #MouseAxisMapper.
+        MouseAxis,
+
+        /// Contributes to a mouse button, like #MouseButtonMapper.
+        MouseButton,
+
+        /// Contributes to a virtual controller POV direction, like #PovMapper.
+        Pov,
+
+        /// Passes the input value to one of the two blocks of instructions that follow and a
+        /// neutral contribution to the other, like #SplitMapper.
+        Split
+      };
+
+      /// Single instruction, consisting of an opcode and its operands.
+      struct SInstruction
+      {
+        /// Kind of instruction.
+        EOpcode opcode;
+
+        /// Operands, interpreted based on the opcode.
+        union
+        {
+          /// Target virtual controller axis. Used by axis and digital axis instructions.
+          struct
+          {
+            EAxis axis;
+            EAxisDirection direction;
+          } axis;
+
+          /// Target virtual controller button. Used by button instructions.
+          EButton button;
+
+          /// Element mapper to which contributions are forwarded. Used by forward instructions.
+          const IElementMapper* forward;
+
+          /// Number of instructions that follow and receive the inverted input value. Used by
+          /// invert instructions.
+          uint32_t invertBlockLength;
+
+          /// Target keyboard key. Used by keyboard instructions.
+          Keyboard::TKeyIdentifier key;
+
+          /// Target mouse axis. Used by mouse axis instructions.
+          struct
+          {
+            Mouse::EMouseAxis axis;
+            EAxisDirection direction;
+          } mouseAxis;
+
+          /// Target mouse button. Used by mouse button instructions.
+          Mouse::EMouseButton mouseButton;
+
+          /// Target virtual controller POV direction. Used by POV instructions.
+          EPovDirection povDirection;
+
+          /// Numbers of instructions that follow and make up the positive and negative blocks, in
+          /// that order. Used by split instructions.
+          struct
+          {
+            uint32_t positiveBlockLength;
+            uint32_t negativeBlockLength;
+          } split;
+        } operand;
+      };
+
+      /// Compiles the specified element mappers, one per XInput controller element, into a single
+      /// program. Element mappers may be `nullptr`, in which case the corresponding XInput
+      /// controller element makes no contributions.
+      /// @param [in] elementMappers Element mappers to compile, indexed by XInput controller
+      /// element.
+      ElementMapperProgram(std::span<const std::unique_ptr<const IElementMapper>> elementMappers);
+
+      /// Compiles a single element mapper into a program, as if it were the element mapper for the
+      /// XInput controller element at index 0. Useful for examining the instructions that make up
+      /// an element mapper.
+      /// @param [in] elementMapper Element mapper to compile, or `nullptr`.
+      explicit ElementMapperProgram(const IElementMapper* elementMapper);
+
+      ElementMapperProgram(const ElementMapperProgram& other) = delete;
+
+      /// Appends a single instruction that does not govern any other instructions. Intended to be
+      /// used by element mappers while they are being compiled.
+      /// @param [in] instruction Instruction to append.
+      void AppendInstruction(const SInstruction& instruction);
+
+      /// Appends an invert instruction followed by the instructions for the specified element
+      /// mapper. Intended to be used by element mappers while they are being compiled.
+      /// @param [in] elementMapper Element mapper that receives inverted input, or `nullptr`.
+      void AppendInvert(const IElementMapper* elementMapper);
+
+      /// Appends a split instruction followed by the instructions for the specified positive and
+      /// negative element mappers. Intended to be used by element mappers while they are being
+      /// compiled.
+      /// @param [in] positiveMapper Element mapper for positive input, or `nullptr`.
+      /// @param [in] negativeMapper Element mapper for negative input, or `nullptr`.
+      void AppendSplit(const IElementMapper* positiveMapper, const IElementMapper* negativeMapper);
+
+      /// Makes the contributions to controller state from a given analog reading that the element
+      /// mapper for the specified XInput controller element would make.
+      /// @param [in] elementIndex Index of the XInput controller element.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] analogValue Raw analog stick value from the XInput controller.
+      /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+      /// triggering the contribution.
+      void ContributeFromAnalogValue(
+          unsigned int elementIndex,
+          SState& controllerState,
+          int16_t analogValue,
+          uint32_t sourceIdentifier) const;
+
+      /// Makes the contributions to controller state from a given button reading that the element
+      /// mapper for the specified XInput controller element would make.
+      /// @param [in] elementIndex Index of the XInput controller element.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] buttonPressed Button state from the XInput controller.
+      /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+      /// triggering the contribution.
+      void ContributeFromButtonValue(
+          unsigned int elementIndex,
+          SState& controllerState,
+          bool buttonPressed,
+          uint32_t sourceIdentifier) const;
+
+      /// Makes the contributions to controller state from a given trigger reading that the element
+      /// mapper for the specified XInput controller element would make.
+      /// @param [in] elementIndex Index of the XInput controller element.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] triggerValue Trigger value from the XInput controller.
+      /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+      /// triggering the contribution.
+      void ContributeFromTriggerValue(
+          unsigned int elementIndex,
+          SState& controllerState,
+          uint8_t triggerValue,
+          uint32_t sourceIdentifier) const;
+
+      /// Makes the neutral contributions to controller state that the element mapper for the
+      /// specified XInput controller element would make.
+      /// @param [in] elementIndex Index of the XInput controller element.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+      /// triggering the contribution.
+      void ContributeNeutral(
+          unsigned int elementIndex, SState& controllerState, uint32_t sourceIdentifier) const;
+
+      /// Retrieves and returns the instructions compiled for the specified XInput controller
+      /// element. Primarily useful for tests.
+      /// @param [in] elementIndex Index of the XInput controller element.
+      /// @return Read-only view of the instructions.
+      inline std::span<const SInstruction> GetInstructions(unsigned int elementIndex) const
+      {
+        const SInstructionRange& range = instructionRanges[elementIndex];
+        return std::span<const SInstruction>(instructions).subspan(range.first, range.count);
+      }
+
+      /// Determines if the instructions compiled for the specified XInput controller element have
+      /// effects outside of the controller state data structure, such as keyboard and mouse
+      /// contributions. Instructions that forward to other element mappers are conservatively
+      /// assumed to have such effects.
+      /// @param [in] elementIndex Index of the XInput controller element.
+      /// @return `true` if so, `false` otherwise.
+      bool HasSideEffects(unsigned int elementIndex) const;
+
+    private:
+
+      /// Identifies the run of instructions compiled for a single XInput controller element.
+      struct SInstructionRange
+      {
+        /// Index of the first instruction.
+        uint32_t first;
+
+        /// Number of instructions.
+        uint32_t count;
+      };
+
+      /// All instructions, for all XInput controller elements, stored contiguously.
+      std::vector<SInstruction> instructions;
+
+      /// Run of instructions for each XInput controller element.
+      std::vector<SInstructionRange> instructionRanges;
+    };
   } // namespace Controller
 } // namespace Xidi
@@ -0,0 +1,123 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ElementMapperCache.h
+ *   Declaration of a persistent binary cache of element mappers parsed from strings.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ApiWindows.h"
+#include "ElementMapper.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    /// Persistent cache of element mappers that were previously parsed from strings in a
+    /// configuration file. Element mappers are stored in binary form as the instructions they
+    /// compile to, so that they can be reconstructed without being parsed again. The cache file is
+    /// keyed by a hash of the configuration file contents and is only used if that hash matches,
+    /// otherwise it is rebuilt from scratch as element mappers are parsed.
+    class ElementMapperCache
+    {
+    public:
+
+      /// Serialized representation of an element mapper. Each instruction occupies a fixed number
+      /// of consecutive words.
+      using TSerializedElementMapper = std::vector<uint32_t>;
+
+      /// Opens the specified cache file and loads its contents if they were produced from a
+      /// configuration file with the specified hash. Any problem with the cache file is treated
+      /// the same as the cache file being absent.
+      /// @param [in] cacheFilename Path and filename of the cache file. Must be null-terminated.
+      /// @param [in] sourceHash Hash of the configuration file contents.
+      ElementMapperCache(std::wstring_view cacheFilename, uint64_t sourceHash);
+
+      ElementMapperCache(const ElementMapperCache& other) = delete;
+
+      ~ElementMapperCache(void);
+
+      /// Computes a hash of the contents of the specified file, intended for use as the source
+      /// hash of a cache file.
+      /// @param [in] filename Path and filename of the file to hash. Must be null-terminated.
+      /// @return Hash of the file contents, if the file could be read.
+      static std::optional<uint64_t> HashFileContents(std::wstring_view filename);
+
+      /// Reconstructs an element mapper from its serialized representation.
+      /// @param [in] serializedElementMapper Serialized representation of the element mapper.
+      /// @return Reconstructed element mapper, which is `nullptr` if the serialized element mapper
+      /// is empty, or nothing if the serialized representation is invalid.
+      static std::optional<std::unique_ptr<IElementMapper>> DeserializeElementMapper(
+          std::span<const uint32_t> serializedElementMapper);
+
+      /// Produces the serialized representation of an element mapper. Only element mappers that
+      /// compile entirely to built-in instructions can be serialized.
+      /// @param [in] elementMapper Element mapper to serialize, or `nullptr`.
+      /// @return Serialized representation of the element mapper, or nothing if it cannot be
+      /// serialized.
+      static std::optional<TSerializedElementMapper> SerializeElementMapper(
+          const IElementMapper* elementMapper);
+
+      /// Attempts to reconstruct the element mapper that was previously parsed from the specified
+      /// string.
+      /// @param [in] elementMapperString String from which the element mapper was parsed.
+      /// @return Reconstructed element mapper, which may be `nullptr`, or nothing if the string is
+      /// not present in the cache.
+      std::optional<std::unique_ptr<IElementMapper>> Lookup(
+          std::wstring_view elementMapperString) const;
+
+      /// Records that the specified element mapper was parsed from the specified string, so that
+      /// it can be reconstructed next time. Does nothing if the element mapper cannot be
+      /// serialized.
+      /// @param [in] elementMapperString String from which the element mapper was parsed.
+      /// @param [in] elementMapper Element mapper that was parsed, or `nullptr`.
+      void Record(std::wstring_view elementMapperString, const IElementMapper* elementMapper);
+
+      /// Writes the cache file if anything was recorded since it was loaded. Cached element mappers
+      /// cannot be looked up after this method is invoked.
+      /// @return `true` if the cache file is up-to-date, `false` if it could not be written.
+      bool Save(void);
+
+    private:
+
+      /// Releases the view of the loaded cache file and forgets all of the element mappers it
+      /// contained.
+      void CloseCacheFile(void);
+
+      /// Path and filename of the cache file.
+      std::wstring cacheFilename;
+
+      /// Hash of the configuration file contents from which the cached element mappers came.
+      uint64_t sourceHash;
+
+      /// Handle of the file mapping object for the loaded cache file, or `nullptr` if none.
+      HANDLE cacheFileMapping;
+
+      /// Base address of the view of the loaded cache file, or `nullptr` if none.
+      const void* cacheFileView;
+
+      /// Element mappers contained in the loaded cache file. Both the strings and the serialized
+      /// element mappers refer directly to the view of the cache file.
+      std::unordered_map<std::wstring_view, std::span<const uint32_t>> loadedElementMappers;
+
+      /// Element mappers recorded since the cache file was loaded, which will be written out the
+      /// next time the cache file is saved.
+      std::map<std::wstring, TSerializedElementMapper, std::less<>> recordedElementMappers;
+    };
+  } // namespace Controller
+} // namespace Xidi
@@ -0,0 +1,211 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file FlightRecorder.h
+ *   Declaration of an always-on, fixed-size, in-memory record of recent physical controller
+ *   states, API calls, and force feedback writes, which can be written to a file on demand for
+ *   diagnosing problems that cannot be reproduced with logging enabled.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace FlightRecorder
+  {
+    /// Identifies a file as a flight recorder dump. Spells "XIFR" when stored in little-endian
+    /// order.
+    inline constexpr uint32_t kFileMagic = 0x52464958;
+
+    /// Version of the dump file format. Incremented for any change to the layout of the file
+    /// header, of a record, or of the name table.
+    inline constexpr uint16_t kFileVersion = 1;
+
+    /// Number of records retained in memory. Once full, each new record replaces the oldest one.
+    inline constexpr size_t kRecordCapacity = 32768;
+
+    /// Maximum number of distinct API function names that can be written to a single dump file.
+    /// Records that refer to any others have their name index set to #kNameIndexUnknown.
+    inline constexpr size_t kMaxNameCount = 256;
+
+    /// Name index that identifies an API function name that is not contained in the name table.
+    inline constexpr uint16_t kNameIndexUnknown = 0xffff;
+
+    /// Header at the very beginning of a dump file. Immediately followed by all of the records in
+    /// the order they were recorded and then by the name table. Each name table entry is a 16-bit
+    /// length followed by that many UTF-16 code units, without a terminator.
+    struct SFileHeader
+    {
+      /// Always equal to #kFileMagic.
+      uint32_t magic;
+
+      /// Always equal to #kFileVersion.
+      uint16_t version;
+
+      /// Size of each record, in bytes.
+      uint16_t recordSize;
+
+      /// Frequency of the performance counter used to produce record timestamps, in counts per
+      /// second.
+      int64_t performanceCounterFrequency;
+
+      /// Number of records in the file.
+      uint32_t recordCount;
+
+      /// Number of entries in the name table.
+      uint32_t nameCount;
+    };
+
+    static_assert(24 == sizeof(SFileHeader), "Dump file header layout is unexpected.");
+
+    /// Enumerates the kinds of events that are recorded.
+    enum class ERecordType : uint8_t
+    {
+      /// Newly-published physical controller state.
+      PhysicalState,
+
+      /// Invocation of a DirectInput or WinMM function by the application.
+      ApiCall,
+
+      /// Vibration write to a physical controller.
+      ForceFeedbackWrite
+    };
+
+    /// Single recorded event, as it appears in a dump file.
+    struct SRecord
+    {
+      /// Performance counter value at the time of the event.
+      int64_t timestamp;
+
+      /// Position of this record in the sequence of all records, which identifies any records lost
+      /// to concurrent writes while dumping.
+      uint32_t sequence;
+
+      /// Kind of event, one of the #ERecordType enumerators.
+      uint8_t type;
+
+      /// Identifier of the physical controller involved in the event.
+      uint8_t controllerIdentifier;
+
+      /// Not used. Always zero.
+      uint16_t reserved;
+
+      /// Event-specific data, interpreted according to the record type.
+      union
+      {
+        /// Used by #ERecordType::PhysicalState records.
+        struct
+        {
+          /// Device status, one of the #Controller::EPhysicalDeviceStatus enumerators.
+          uint8_t deviceStatus;
+
+          /// Left and right trigger values, in that order.
+          uint8_t trigger[2];
+
+          /// Not used. Always zero.
+          uint8_t reserved1;
+
+          /// Button state, one bit per #Controller::EPhysicalButton enumerator.
+          uint16_t buttons;
+
+          /// Not used. Always zero.
+          uint16_t reserved2;
+
+          /// Left stick X, left stick Y, right stick X, and right stick Y values, in that order.
+          int16_t stick[4];
+        } physicalState;
+
+        /// Used by #ERecordType::ApiCall records.
+        struct
+        {
+          /// Identifier of the interface object on which the function was invoked, or the WinMM
+          /// joystick identifier for WinMM functions.
+          uint32_t objectId;
+
+          /// Result code that was returned to the application.
+          uint32_t result;
+
+          /// Index of the function name in the name table.
+          uint16_t nameIndex;
+
+          /// Not used. Always zero.
+          uint16_t reserved1;
+
+          /// Not used. Always zero.
+          uint32_t reserved2;
+        } apiCall;
+
+        /// Used by #ERecordType::ForceFeedbackWrite records.
+        struct
+        {
+          /// Left and right motor speeds that were written, in that order.
+          uint16_t motorSpeed[2];
+
+          /// Result code from the backend that performed the write.
+          uint32_t result;
+
+          /// Not used. Always zero.
+          uint64_t reserved;
+        } forceFeedbackWrite;
+      };
+    };
+
+    static_assert(32 == sizeof(SRecord), "Dump file record layout is unexpected.");
+
+    /// Records physical controller state that was just published.
+    /// @param [in] controllerIdentifier Identifier of the physical controller.
+    /// @param [in] physicalState New physical controller state.
+    void RecordPhysicalState(
+        Controller::TControllerIdentifier controllerIdentifier,
+        const Controller::SPhysicalState& physicalState);
+
+    /// Records the invocation of a DirectInput or WinMM function by the application.
+    /// @param [in] functionName Name of the function. Must have static storage duration, such as
+    /// the value of `__FUNCTIONW__`, because only its address is stored until a dump is written.
+    /// @param [in] controllerIdentifier Identifier of the controller on which the function
+    /// operated.
+    /// @param [in] objectId Identifier of the interface object on which the function was invoked.
+    /// @param [in] result Result code returned to the application.
+    void RecordApiCall(
+        const wchar_t* functionName,
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint32_t objectId,
+        uint32_t result);
+
+    /// Records a vibration write to a physical controller.
+    /// @param [in] controllerIdentifier Identifier of the physical controller.
+    /// @param [in] leftMotorSpeed Left motor speed that was written.
+    /// @param [in] rightMotorSpeed Right motor speed that was written.
+    /// @param [in] result Result code from the backend that performed the write.
+    void RecordForceFeedbackWrite(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint16_t leftMotorSpeed,
+        uint16_t rightMotorSpeed,
+        DWORD result);
+
+    /// Writes all retained records to the specified file, replacing it if it exists. Recording
+    /// continues while the file is written. Does not allocate memory, so it is also safe to invoke
+    /// from an unhandled exception filter. Only one dump can be written at a time.
+    /// @param [in] filename Name of the file to write. Must be null-terminated.
+    /// @return `true` if successful, `false` otherwise.
+    bool DumpToFile(std::wstring_view filename);
+
+    /// Arranges for all retained records to be written to the specified file if the process
+    /// crashes due to an unhandled exception. Any previously-installed unhandled exception filter
+    /// is invoked afterwards. Subsequent invocations have no effect.
+    /// @param [in] filename Name of the file to write. Must be null-terminated and remain valid
+    /// for the lifetime of the process.
+    void DumpOnCrash(std::wstring_view filename);
+  } // namespace FlightRecorder
+} // namespace Xidi
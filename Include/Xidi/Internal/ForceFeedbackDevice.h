@@ -12,12 +12,18 @@
 
 #pragma once
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <shared_mutex>
 
+#include "ApiBitSet.h"
 #include "ForceFeedbackEffect.h"
 #include "ForceFeedbackTypes.h"
+#include "ProfiledMutex.h"
 
 namespace Xidi
 {
@@ -27,7 +33,11 @@ namespace Xidi
     {
       /// Emulates a force feedback system that would normally reside on a physical device. Includes
       /// buffers for storage and all effect playback logic. Concurrency-safe, but not safe to be
-      /// constructed during dynamic initialization.
+      /// constructed during dynamic initialization. Changes to effects, such as downloading,
+      /// starting, and stopping, are validated immediately but are delivered as commands through a
+      /// lock-free queue and applied at the start of the next playback operation. This way the
+      /// threads that change effects never wait for effect playback to finish, and effect playback
+      /// never waits for them either.
       class Device
       {
       public:
@@ -54,8 +64,15 @@ namespace Xidi
         /// Allows a base timestamp to be provided, which should only ever be done during testing.
         Device(TEffectTimeMs timestampBase);
 
+        Device(const Device& other) = delete;
+
+        ~Device(void);
+
         /// Adds the specified effect into the device buffer or updates its parameters if it already
         /// exists in the device buffer. Does not check that the effect is completely defined.
+        /// Updates to an effect that has not been started since it was added or last stopped cannot
+        /// affect playback, so they are staged and delivered together with the command that next
+        /// starts the effect. Repeated updates to such an effect are thereby coalesced.
         /// @param [in] effect Effect object to be added or updated.
         /// @return `true` on success, `false` on failure. This method will fail if too many effects
         /// already exist in the device buffer.
@@ -63,93 +80,119 @@ namespace Xidi
 
         /// Clears all effects from this device and resets any paused or muted states that might
         /// have been set.
-        inline void Clear(void)
-        {
-          std::unique_lock lock(mutex);
-          readyEffects.clear();
-          playingEffects.clear();
-          stateEffectsAreMuted = false;
-          stateEffectsArePaused = false;
-        }
+        void Clear(void);
 
         /// Retrieves and returns the number of effects that exist in the device buffer and are
         /// currently playing. For the purposes of this method call, effects are considered playing
         /// even if the device is paused and even if the effects are in their start delay period.
         /// @return Number of effects on the device that are currently playing.
-        inline unsigned int GetCountPlayingEffects(void)
-        {
-          std::shared_lock lock(mutex);
-          return (unsigned int)playingEffects.size();
-        }
+        unsigned int GetCountPlayingEffects(void);
+
+        /// Retrieves the amount of time from the most recent playback operation until the next
+        /// transition, which is the point at which a playing effect either finishes its start
+        /// delay or reaches the end of an iteration. Intended to allow a thread that plays effects
+        /// to schedule playback so that transitions are not delayed.
+        /// @return Time in milliseconds until the next transition, or `std::nullopt` if no
+        /// transition is pending.
+        std::optional<TEffectTimeMs> GetTimeUntilNextTransition(void);
 
         /// Retrieves and returns the total number of effects that exist in the device buffer.
+        /// Lock-free.
         /// @return Total number of effects on the device.
         inline unsigned int GetCountTotalEffects(void)
         {
-          std::shared_lock lock(mutex);
-          return (unsigned int)(playingEffects.size() + readyEffects.size());
+          return countTotalEffects.load(std::memory_order_acquire);
         }
 
         /// Determines if the device is empty or not.
-        /// The device is empty if no effects exist within its buffers.
+        /// The device is empty if no effects exist within its buffers. Lock-free.
         /// @return `true` if so, `false` if not.
         inline bool IsDeviceEmpty(void)
         {
           return (0 == GetCountTotalEffects());
         }
 
-        /// Determines if the force feedback system's output state is muted.
+        /// Determines if the force feedback system's output state is muted. Lock-free.
         /// @return `true` if so, `false` otherwise.
         inline bool IsDeviceOutputMuted(void)
         {
-          return stateEffectsAreMuted;
+          return stateEffectsAreMuted.load(std::memory_order_acquire);
         }
 
-        /// Determines if the force feedback system is currently paused.
+        /// Determines if the force feedback system is currently paused. Lock-free.
         /// @return `true` if so, `false` otherwise.
         inline bool IsDeviceOutputPaused(void)
         {
-          return stateEffectsArePaused;
+          return stateEffectsArePaused.load(std::memory_order_acquire);
         }
 
-        /// Determines if the device is playing any effects or not.
+        /// Determines if the device is playing any effects or not. Lock-free. Effects that have
+        /// been started are considered playing right away, but effects that finish playing or are
+        /// stopped are only considered no longer playing once the next playback operation happens.
         /// @return `true` if so, `false` if not.
         inline bool IsDevicePlayingAnyEffects(void)
         {
-          return (0 != GetCountPlayingEffects());
+          return (
+              (0 != countUnappliedStartCommands.load(std::memory_order_acquire)) ||
+              (0 != countPlayingEffects.load(std::memory_order_acquire)));
         }
 
+        /// Determines if the device is idle, meaning no effects are playing and no changes to
+        /// effects are waiting to be applied. An idle device produces no output until its effects
+        /// are changed.
+        /// @return `true` if so, `false` if not.
+        bool IsDeviceIdle(void);
+
         /// Determines if the identified effect is loaded into the device buffer.
         /// @param [in] id Identifier of the effect of interest.
         /// @return `true` if so, `false` if not.
         inline bool IsEffectOnDevice(TEffectIdentifier id)
         {
-          std::shared_lock lock(mutex);
-          return (readyEffects.contains(id) || playingEffects.contains(id));
+          std::scoped_lock lock(commandMutex);
+          return FindEffectSlot(id).has_value();
         }
 
         /// Determines if the identified effect is loaded into the device buffer and currently
-        /// playing.
+        /// playing. Applies any pending changes to effects first, so the result is always up to
+        /// date. Effects also publish their playing state as of the most recent playback operation,
+        /// which can be checked without any locking using Effect::IsPlaying.
         /// @param [in] id Identifier of the effect of interest.
         /// @return `true` if so, `false` if not.
         bool IsEffectPlaying(TEffectIdentifier id);
 
         /// Computes the magnitude components for all of the effects that are currently playing.
         /// Any effects that are completed are automatically stopped.
+        /// @param [in] conditionInput State of the virtual controller axes, to which any condition
+        /// effects that are playing respond.
         /// @param [in] timestamp Effective relative timestamp for the playback operation. Generally
         /// should not be passed (which would mean use the current time), but exposed for testing.
         /// @return Magnitude components that result from playing all of the effects at the current
         /// time.
         TOrderedMagnitudeComponents PlayEffects(
+            const SConditionInput& conditionInput,
             std::optional<TEffectTimeMs> timestamp = std::nullopt);
 
+        /// Computes the magnitude components for all of the effects that are currently playing,
+        /// presenting all virtual controller axes as centered and at rest to any condition effects.
+        /// Any effects that are completed are automatically stopped.
+        /// @param [in] timestamp Effective relative timestamp for the playback operation. Generally
+        /// should not be passed (which would mean use the current time), but exposed for testing.
+        /// @return Magnitude components that result from playing all of the effects at the current
+        /// time.
+        inline TOrderedMagnitudeComponents PlayEffects(
+            std::optional<TEffectTimeMs> timestamp = std::nullopt)
+        {
+          return PlayEffects(SConditionInput(), timestamp);
+        }
+
         /// Sets the force feedback system's muted state.
         /// In muted state effects play but no output is actually produced.
         /// @param [in] muted `true` if effects should be muted, `false` otherwise.
         inline void SetMutedState(bool muted)
         {
           std::unique_lock lock(mutex);
-          stateEffectsAreMuted = muted;
+          stateEffectsAreMuted.store(muted, std::memory_order_release);
+          lastPlaybackResultIsReusable = false;
         }
 
         /// Sets the force feedback system's paused state.
@@ -159,11 +202,26 @@ namespace Xidi
         inline void SetPauseState(bool paused)
         {
           std::unique_lock lock(mutex);
-          stateEffectsArePaused = paused;
+          stateEffectsArePaused.store(paused, std::memory_order_release);
+          lastPlaybackResultIsReusable = false;
+        }
+
+        /// Sets the longest window of time over which the output of each effect is averaged by a
+        /// playback operation. Each playback operation averages over the time elapsed since the
+        /// previous one, up to this limit, so that changes in magnitude that happen between
+        /// playback operations are reflected in the output rather than being missed. Condition
+        /// effects are not averaged.
+        /// @param [in] averagingWindow Maximum averaging window, in milliseconds. A value of 0 or
+        /// 1 disables averaging, so that each effect is evaluated only at the time of playback.
+        inline void SetAveragingWindow(TEffectTimeMs averagingWindow)
+        {
+          std::unique_lock lock(mutex);
+          averagingWindowMaximum = averagingWindow;
+          lastPlaybackResultIsReusable = false;
         }
 
         /// Starts playing the identified effect. If the effect is already playing, it is restarted
-        /// from the beginning.
+        /// from the beginning. Any staged parameter updates are delivered first.
         /// @param [in] id Identifier of the effect of interest.
         /// @param [in] numIterations Number of times to repeat the effect.
         /// @param [in] timestamp Starting relative timestamp to associate with the effect.
@@ -182,7 +240,8 @@ namespace Xidi
         /// Stops playing the identified effect if it is currently playing.
         /// @param [in] od Identifier of the effect of interest.
         /// @return `true` on success, `false` on failure. This method will fail if the identified
-        /// effect is not currently playing.
+        /// effect has not been started since it was downloaded or last stopped. Effects that
+        /// finish playing on their own are not considered stopped for this purpose.
         bool StopEffect(TEffectIdentifier id);
 
         /// Removes the identified effect from the device buffer. It is automatically stopped if it
@@ -192,25 +251,192 @@ namespace Xidi
         /// effect does not exist in the device buffer.
         bool RemoveEffect(TEffectIdentifier id);
 
+        /// Blocks for as long as the device is idle. Intended to be used by a thread that plays
+        /// effects so that it does not need to wake up periodically when there is nothing to play.
+        void WaitWhileDeviceIdle(void);
+
       private:
 
-        /// Enforces proper concurrency control for this object.
-        std::shared_mutex mutex;
+        /// Type used to identify a slot in the device buffer.
+        using TEffectSlot = unsigned int;
+
+        /// Type used to represent a set of slots in the device buffer.
+        using TEffectSlotSet = BitSet<kEffectMaxCount>;
+
+        /// Number of entries in the index that maps effect identifiers to slots. Kept at twice the
+        /// maximum number of effects so that probe sequences stay short even when the device buffer
+        /// is full, and a power of two so that identifiers can be reduced to entries by masking.
+        static constexpr unsigned int kEffectSlotIndexSize = 2 * kEffectMaxCount;
+
+        static_assert(
+            0 == (kEffectSlotIndexSize & (kEffectSlotIndexSize - 1)),
+            "Effect slot index size must be a power of two.");
+
+        /// Value used to mark entries in the index that maps effect identifiers to slots as empty.
+        static constexpr TEffectSlot kEffectSlotIndexEmpty = kEffectMaxCount;
 
-        /// Holds all force feedback effects that are available on the device but not
-        /// playing.
-        std::map<TEffectIdentifier, SEffectData> readyEffects;
+        /// Enumerates the kinds of changes to effects that can be delivered as commands.
+        enum class ECommandType : uint8_t
+        {
+          /// Places a new effect into an empty slot.
+          Add,
+
+          /// Synchronizes the parameters of the effect in a slot.
+          Update,
+
+          /// Starts or restarts playing the effect in a slot.
+          Start,
+
+          /// Stops playing the effect in a slot.
+          Stop,
+
+          /// Stops playing all effects.
+          StopAll,
+
+          /// Removes the effect from a slot.
+          Remove
+        };
+
+        /// Describes a single change to effects. Commands form an intrusive singly-linked list.
+        struct SCommand
+        {
+          /// Kind of change.
+          ECommandType type;
 
-        /// Holds all force feedback effects that are currently playing on the device.
-        std::map<TEffectIdentifier, SEffectData> playingEffects;
+          /// Slot affected by the change. Not used by #ECommandType::StopAll.
+          TEffectSlot slot;
+
+          /// Effect to be added, or effect from which parameters are to be synchronized.
+          std::unique_ptr<Effect> effect;
+
+          /// Number of times to repeat an effect that is being started.
+          unsigned int numIterations;
+
+          /// Absolute timestamp at which an effect that is being started was requested to start.
+          TEffectTimeMs timestamp;
+
+          /// Next command in the list.
+          SCommand* next;
+        };
+
+        /// Applies all pending commands in the order in which they were enqueued. The caller must
+        /// hold an exclusive lock on #mutex. If any commands are applied then the result of the
+        /// most recent playback operation is no longer considered reusable and the playback status
+        /// is published again.
+        void ApplyPendingCommands(void);
+
+        /// Enqueues a command to be applied at the start of the next playback operation. The
+        /// caller must hold #commandMutex so that commands are enqueued in the same order as the
+        /// changes they make to the slot assignment state.
+        /// @param [in] command Command to be enqueued.
+        void EnqueueCommand(std::unique_ptr<SCommand> command);
+
+        /// Publishes the playing state of each effect on the device, along with the number of
+        /// effects that are playing, so that they can be queried without any locking. The caller
+        /// must hold an exclusive lock on #mutex.
+        void PublishPlaybackStatus(void);
+
+        /// Computes the entry in the index that maps effect identifiers to slots at which the
+        /// search for the identified effect begins. Identifiers are allocated sequentially, so
+        /// their low-order bits are already well distributed.
+        /// @param [in] id Identifier of the effect of interest.
+        /// @return Home entry for the identified effect.
+        static inline unsigned int EffectSlotIndexHome(TEffectIdentifier id)
+        {
+          return (unsigned int)(id & (kEffectSlotIndexSize - 1));
+        }
+
+        /// Locates the slot in the device buffer that holds the identified effect. Effect
+        /// identifiers are unique across all devices, so they cannot be used as slot indices
+        /// directly. Instead, slots are found by way of an open-addressed index keyed by
+        /// identifier. The caller must hold #commandMutex.
+        /// @param [in] id Identifier of the effect of interest.
+        /// @return Slot that holds the identified effect, or nothing if the effect does not exist
+        /// in the device buffer.
+        std::optional<TEffectSlot> FindEffectSlot(TEffectIdentifier id) const;
+
+        /// Makes the identified effect findable in the specified slot. The effect must not already
+        /// be in the index. The caller must hold #commandMutex.
+        /// @param [in] id Identifier of the effect being placed into the slot.
+        /// @param [in] slot Slot into which the effect is being placed.
+        void InsertEffectSlotIndex(TEffectIdentifier id, TEffectSlot slot);
+
+        /// Removes the identified effect from the index, moving later entries back so that their
+        /// probe sequences remain unbroken. The caller must hold #commandMutex.
+        /// @param [in] id Identifier of the effect being removed, which must be in the index.
+        void EraseEffectSlotIndex(TEffectIdentifier id);
+
+        /// Serializes changes to effects and guards the slot assignment state, which consists of
+        /// #effectSlotIdentifiers, #effectSlotIndex, #effectSlotPlayingStates, #occupiedSlots,
+        /// #startedSlots, and #stagedEffects. Never held by playback.
+        ProfiledMutex<std::mutex> commandMutex;
+
+        /// Identifiers of the effects assigned to each slot. Only slots present in #occupiedSlots
+        /// hold valid identifiers.
+        std::array<TEffectIdentifier, kEffectMaxCount> effectSlotIdentifiers;
+
+        /// Open-addressed index, using linear probing, that maps the identifiers of the effects in
+        /// occupied slots to those slots. Each entry holds either a slot or #kEffectSlotIndexEmpty.
+        std::array<TEffectSlot, kEffectSlotIndexSize> effectSlotIndex;
+
+        /// Playing state flags of the effects assigned to each slot, held so that effects that are
+        /// stopped or removed can be shown as no longer playing without waiting for playback.
+        std::array<std::shared_ptr<std::atomic<bool>>, kEffectMaxCount> effectSlotPlayingStates;
+
+        /// Set of slots that are assigned an effect, including by commands not yet applied.
+        TEffectSlotSet occupiedSlots;
+
+        /// Set of slots whose effects have been started and not since stopped, including by
+        /// commands not yet applied. Always a subset of #occupiedSlots.
+        TEffectSlotSet startedSlots;
+
+        /// Parameter updates for effects that are not in #startedSlots, held until each such
+        /// effect is next started. Each one is reused for subsequent updates to the same effect.
+        std::array<std::unique_ptr<Effect>, kEffectMaxCount> stagedEffects;
+
+        /// Number of slots in #occupiedSlots, readable without any locking.
+        std::atomic<unsigned int> countTotalEffects;
+
+        /// Number of start commands that have been enqueued but not yet applied. Incremented before
+        /// each such command is enqueued so that it never undercounts.
+        std::atomic<unsigned int> countUnappliedStartCommands;
+
+        /// Commands that have been enqueued but not yet applied, most recently enqueued first.
+        std::atomic<SCommand*> pendingCommands;
+
+        /// Incremented each time a command is enqueued. Threads that wait for the device to stop
+        /// being idle wait for this value to change.
+        std::atomic<uint32_t> commandGeneration;
+
+        /// Enforces proper concurrency control for the playback state, which consists of all
+        /// members from this one onwards.
+        ProfiledMutex<std::shared_mutex> mutex;
+
+        /// Holds all force feedback effects that are available on the device, whether playing or
+        /// not, in fixed slots so that no allocation occurs as effects start, stop, and finish.
+        std::array<SEffectData, kEffectMaxCount> effectSlots;
+
+        /// Set of slots in #effectSlots that hold an effect that is currently playing.
+        TEffectSlotSet playingSlots;
+
+        /// Set of slots whose effects were most recently published as playing.
+        TEffectSlotSet publishedPlayingSlots;
+
+        /// Number of slots in #playingSlots as most recently published, readable without any
+        /// locking.
+        std::atomic<unsigned int> countPlayingEffects;
 
         /// Indicates whether or not the force feedback effects are muted or not.
-        /// If so, no effects produce any output but time can advance.
-        bool stateEffectsAreMuted;
+        /// If so, no effects produce any output but time can advance. Readable without any locking.
+        std::atomic<bool> stateEffectsAreMuted;
 
         /// Indicates whether playback of force feedback effects is paused or not.
-        /// If so, no effects produce any output and time stops.
-        bool stateEffectsArePaused;
+        /// If so, no effects produce any output and time stops. Readable without any locking.
+        std::atomic<bool> stateEffectsArePaused;
+
+        /// Longest window of time, in milliseconds, over which a playback operation averages the
+        /// output of each effect.
+        TEffectTimeMs averagingWindowMaximum;
 
         /// Base timestamp, used to establish a way of transforming system uptime to
         /// relative time elapsed since object creation.
@@ -218,6 +444,25 @@ namespace Xidi
 
         /// Caches the relative timestamp of the last playback operation.
         TEffectTimeMs timestampRelativeLastPlay;
+
+        /// Relative timestamp of the next transition, as computed by the last playback operation.
+        std::optional<TEffectTimeMs> timestampRelativeNextTransition;
+
+        /// Relative timestamp of the earliest point in time at which playback could produce a
+        /// result different from #lastPlaybackResult. Not set if no such point is known, which
+        /// happens when no effects are playing.
+        std::optional<TEffectTimeMs> timestampRelativeNextChange;
+
+        /// Result of the last playback operation that was not paused.
+        TOrderedMagnitudeComponents lastPlaybackResult;
+
+        /// Whether or not #lastPlaybackResult can be returned by a playback operation that happens
+        /// before #timestampRelativeNextChange. Cleared whenever playback state changes for any
+        /// reason other than the passage of time, and never set while condition effects are
+        /// playing because their output depends on axis state. When output is being averaged this
+        /// is also not set unless the output of every effect was stable throughout its averaging
+        /// window.
+        bool lastPlaybackResultIsReusable;
       };
     } // namespace ForceFeedback
   }   // namespace Controller
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "ForceFeedbackParameters.h"
 #include "ForceFeedbackTypes.h"
@@ -51,6 +54,17 @@ namespace Xidi
         /// effect's envelope transformation, if it exists.
         TEffectValue ApplyEnvelope(TEffectTimeMs rawTime, TEffectValue sustainLevel) const;
 
+        /// Determines how long the envelope transformation leaves a fixed sustain level unchanged
+        /// starting at a given time. Intended to be invoked by subclasses to assist with
+        /// determining how long their magnitude remains stable but exposed for testing. For
+        /// performance reasons this method does not check if the effect is ill-formed and may
+        /// throw an exception if it is.
+        /// @param [in] rawTime Time from which stability is being determined. Raw input to the
+        /// function that computes magnitude as a function of time.
+        /// @return Earliest raw time after the specified time at which the envelope transformation
+        /// could produce a different value for the same sustain level, capped at the duration.
+        TEffectTimeMs ComputeEnvelopeStableUntil(TEffectTimeMs rawTime) const;
+
         /// Clears this effect's envelope parameter structure, which results in disabling envelope
         /// transformations for this effect.
         inline void ClearEnvelope(void)
@@ -80,6 +94,32 @@ namespace Xidi
         /// completely defined (i.e. parameters are all set), and any other value otherwise.
         TEffectValue ComputeMagnitude(TEffectTimeMs time) const;
 
+        /// Determines how long the magnitude of the force that this effect generates remains the
+        /// same as its magnitude at the given time, taking into account that magnitude is only
+        /// computed once per sample period. Intended to be invoked externally so that a previously
+        /// computed magnitude can be reused instead of being recomputed. For performance reasons
+        /// this method does not check for any errors and may throw an exception if the effect is
+        /// ill-defined.
+        /// @param [in] time Time from which stability is being determined relative to when the
+        /// application requested the effect be started.
+        /// @return Earliest time at which the magnitude could differ from its magnitude at the
+        /// given time. This is at most the duration, at which point the magnitude drops to zero,
+        /// unless the duration has already elapsed, in which case the magnitude never changes.
+        TEffectTimeMs ComputeMagnitudeStableUntil(TEffectTimeMs time) const;
+
+        /// Computes the average magnitude of the force that this effect generates over the given
+        /// window of time. Magnitude only changes on whole milliseconds, so this is the exact
+        /// integral of the magnitude over the window divided by its length. Intended to be invoked
+        /// externally to avoid aliasing when force feedback output is updated less often than the
+        /// magnitude changes. For performance reasons this method does not check for any errors
+        /// and may throw an exception if the effect is ill-defined.
+        /// @param [in] startTime Start of the window, inclusive, relative to when the application
+        /// requested the effect be started.
+        /// @param [in] endTime End of the window, exclusive. Must be after the start.
+        /// @return Average magnitude over the window, assuming the effect is completely defined
+        /// (i.e. parameters are all set), and any other value otherwise.
+        TEffectValue ComputeAverageMagnitude(TEffectTimeMs startTime, TEffectTimeMs endTime) const;
+
         /// Computes the magnitude component vector of the force that this effect should generate at
         /// the given time.
         /// @param [in] time Time for which the magnitude is being requested relative to when the
@@ -105,6 +145,35 @@ namespace Xidi
           return OrderMagnitudeComponents(ComputeMagnitudeComponents(time));
         }
 
+        /// Computes the average magnitude component vector of the force that this effect generates
+        /// over the given window of time using a globally-understood ordering scheme for the
+        /// components.
+        /// @param [in] startTime Start of the window, inclusive, relative to when the application
+        /// requested the effect be started.
+        /// @param [in] endTime End of the window, exclusive. Must be after the start.
+        /// @return Average magnitude component vector over the window, assuming the effect is
+        /// completely defined (i.e. parameters are all set), and any other value otherwise.
+        inline TOrderedMagnitudeComponents ComputeAverageOrderedMagnitudeComponents(
+            TEffectTimeMs startTime, TEffectTimeMs endTime) const
+        {
+          return OrderMagnitudeComponents(commonParameters.direction.ComputeMagnitudeComponents(
+              ComputeAverageMagnitude(startTime, endTime)));
+        }
+
+        /// Computes the magnitude component vector of the force that this effect should generate at
+        /// the given time in response to the supplied axis state, using a globally-understood
+        /// ordering scheme for the components. Effects that are not condition effects ignore the
+        /// axis state, in which case this method is equivalent to the version that accepts only a
+        /// time. Performs no error checking, just like the other magnitude computation methods.
+        /// @param [in] time Time for which the magnitude is being requested relative to when the
+        /// application requested the effect be started.
+        /// @param [in] conditionInput State of the virtual controller axes.
+        /// @return Ordered magnitude component vector that corresponds to the given time and axis
+        /// state, assuming the effect is completely defined (i.e. parameters are all set), and any
+        /// other value otherwise.
+        TOrderedMagnitudeComponents ComputeOrderedMagnitudeComponents(
+            TEffectTimeMs time, const SConditionInput& conditionInput) const;
+
         /// Provides access to the direction vector associated with this force feedback effect.
         /// @return Mutable reference to the direction vector object.
         inline DirectionVector& Direction(void)
@@ -200,6 +269,24 @@ namespace Xidi
           return id;
         }
 
+        /// Determines if this effect is currently playing on a force feedback device, as most
+        /// recently published by that device. Lock-free, so that applications can poll effect
+        /// status as often as they like without contending with playback.
+        /// @return `true` if so, `false` otherwise.
+        inline bool IsPlaying(void) const
+        {
+          return playingState->load(std::memory_order_acquire);
+        }
+
+        /// Provides access to the playing state flag of this effect, which is shared among all
+        /// copies of this effect so that the copy held by a force feedback device can publish it
+        /// for all others to see. Intended to be used by force feedback devices.
+        /// @return Shared pointer to the playing state flag.
+        inline const std::shared_ptr<std::atomic<bool>>& PlayingState(void) const
+        {
+          return playingState;
+        }
+
         /// Initializes the axes associated with this force feedback effect to a simple default of
         /// the X axis.
         /// @return `true` if the associated axis initialization operation succeeded, `false`
@@ -223,12 +310,24 @@ namespace Xidi
         }
 
         /// Verifies that all required parameters have been specified for this effect.
-        /// If this method returns `true` then the effect is ready to be played.
+        /// If this method returns `true` then the effect is ready to be played. Condition effects
+        /// act on each associated axis separately and therefore do not require a direction.
         /// @return `true` if all parameters have been specified for this effect, `false` otherwise.
         inline bool IsCompletelyDefined(void) const
         {
           return (
-              HasCompleteDirection() && HasDuration() && IsTypeSpecificEffectCompletelyDefined());
+              ((true == IsConditionEffect()) ? HasAssociatedAxes() : HasCompleteDirection()) &&
+              HasDuration() && IsTypeSpecificEffectCompletelyDefined());
+        }
+
+        /// Determines if this effect is a condition effect, meaning that the force it generates
+        /// depends on the state of the virtual controller axes rather than on time alone. Playback
+        /// results that include condition effects cannot be reused from one playback operation to
+        /// the next. The default implementation indicates that it is not.
+        /// @return `true` if this is a condition effect, `false` otherwise.
+        virtual bool IsConditionEffect(void) const
+        {
+          return false;
         }
 
         /// Orders the elements in a magnitude component vector using a globally-understood ordering
@@ -372,6 +471,34 @@ namespace Xidi
         /// completely defined (i.e. all parameters are set), and any other value otherwise.
         virtual TEffectValue ComputeRawMagnitude(TEffectTimeMs rawTime) const = 0;
 
+        /// Internal implementation of calculations for determining how long the raw magnitude of a
+        /// force feedback effect remains the same as its raw magnitude at a given time. The default
+        /// implementation conservatively assumes that the raw magnitude can change at any time.
+        /// Subclasses whose magnitude stays fixed over some or all of their duration should
+        /// override this method.
+        /// @param [in] rawTime Time from which stability is being determined. Raw input to the
+        /// function that computes magnitude as a function of time.
+        /// @return Earliest raw time after the specified time at which the raw magnitude could
+        /// differ from its value at the specified time. Any value at or beyond the duration
+        /// indicates that the raw magnitude stays the same for the remainder of the duration.
+        virtual TEffectTimeMs ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const
+        {
+          return rawTime + 1;
+        }
+
+        /// Internal implementation of calculations for computing the ordered magnitude component
+        /// vector of a condition effect in response to axis state, before gain is applied. Only
+        /// invoked for effects that identify themselves as condition effects. The default
+        /// implementation produces no force.
+        /// @param [in] conditionInput State of the virtual controller axes.
+        /// @return Raw ordered magnitude component vector, assuming the effect is completely
+        /// defined, and any other value otherwise.
+        virtual TOrderedMagnitudeComponents ComputeRawConditionMagnitudeComponents(
+            const SConditionInput& conditionInput) const
+        {
+          return {};
+        }
+
         /// Verifies that all required type-specific parameters have been specified for this effect.
         /// The default implementation simply returns `true` because no type-specific parameters
         /// exist in the base case. Subclasses that define their own type-specific parameters should
@@ -405,6 +532,11 @@ namespace Xidi
 
         /// Holds parameters common to all effects.
         SCommonParameters commonParameters;
+
+        /// Whether or not this effect is currently playing on a force feedback device. Shared with
+        /// all copies of this effect rather than being copied, since copies all represent the same
+        /// effect.
+        std::shared_ptr<std::atomic<bool>> playingState;
       };
 
       /// Intermediate abstract class for all effects that define their own type-specific
@@ -547,6 +679,7 @@ namespace Xidi
 
         // Effect
         TEffectValue ComputeRawMagnitude(TEffectTimeMs rawTime) const override;
+        TEffectTimeMs ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const override;
       };
 
       /// Holds all type-specific parameters for periodic effects.
@@ -691,6 +824,194 @@ namespace Xidi
 
         // Effect
         TEffectValue ComputeRawMagnitude(TEffectTimeMs rawTime) const override;
+        TEffectTimeMs ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const override;
+      };
+
+      /// Holds all type-specific parameters for custom force effects.
+      struct SCustomForceParameters
+      {
+        /// Magnitudes of the force samples, each of which must fall within the allowed magnitude
+        /// range. Held in an immutable buffer so that all copies of an effect, such as those made
+        /// while staging parameter updates and those loaded into a device buffer, share the same
+        /// samples rather than each holding their own. Must not be empty.
+        std::shared_ptr<const std::vector<TEffectValue>> samples;
+
+        /// Amount of time for which each sample is played. Must be at least 1.
+        TEffectTimeMs samplePeriod;
+
+        bool operator==(const SCustomForceParameters& other) const
+        {
+          if (other.samplePeriod != samplePeriod) return false;
+          if (other.samples == samples) return true;
+          if ((nullptr == other.samples) || (nullptr == samples)) return false;
+          return (*other.samples == *samples);
+        }
+      };
+
+      /// Implements a force feedback effect based on a force whose magnitude is given by a table of
+      /// samples, played one after the other and repeated for as long as the effect plays.
+      class CustomForceEffect : public EffectWithTypeSpecificParameters<SCustomForceParameters>
+      {
+      public:
+
+        // EffectWithTypeSpecificParameters
+        bool AreTypeSpecificParametersValid(
+            const SCustomForceParameters& newTypeSpecificParameters) const override;
+        void CheckAndFixTypeSpecificParameters(
+            SCustomForceParameters& newTypeSpecificParameters) const override;
+
+        // Effect
+        std::unique_ptr<Effect> Clone(void) const override;
+
+      protected:
+
+        // Effect
+        TEffectValue ComputeRawMagnitude(TEffectTimeMs rawTime) const override;
+        TEffectTimeMs ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const override;
+      };
+
+      /// Holds the parameters that define how a condition effect acts on a single axis.
+      struct SAxisCondition
+      {
+        /// Value of the condition metric at which no force is generated, which must fall within
+        /// the allowed magnitude range.
+        TEffectValue offset;
+
+        /// Coefficient applied when the metric is above the offset, which must fall within the
+        /// allowed magnitude range. Positive values produce a force that opposes the metric.
+        TEffectValue positiveCoefficient;
+
+        /// Coefficient applied when the metric is below the offset, which must fall within the
+        /// allowed magnitude range. Positive values produce a force that opposes the metric.
+        TEffectValue negativeCoefficient;
+
+        /// Maximum magnitude of the force generated when the metric is above the offset, which
+        /// must be non-negative and within the allowed magnitude range.
+        TEffectValue positiveSaturation;
+
+        /// Maximum magnitude of the force generated when the metric is below the offset, which
+        /// must be non-negative and within the allowed magnitude range.
+        TEffectValue negativeSaturation;
+
+        /// Distance from the offset within which no force is generated, which must be
+        /// non-negative and within the allowed magnitude range.
+        TEffectValue deadBand;
+
+        constexpr bool operator==(const SAxisCondition& other) const = default;
+      };
+
+      /// Holds all type-specific parameters for condition effects.
+      struct SConditionParameters
+      {
+        /// Number of valid elements in the axis condition array. If this is 1 then the single
+        /// condition applies to all of the associated axes, otherwise each condition applies to
+        /// the associated axis at the same position.
+        int count;
+
+        /// Axis conditions, one per associated axis.
+        std::array<SAxisCondition, kEffectAxesMaximumNumber> axis;
+
+        constexpr bool operator==(const SConditionParameters& other) const = default;
+      };
+
+      /// Abstract base class for condition effects, which generate force in response to the state
+      /// of the virtual controller axes. Each associated axis is treated separately: a condition
+      /// metric, such as position or velocity, is compared with the condition offset and the
+      /// distance between them is multiplied by a coefficient and limited by a saturation value.
+      class ConditionEffect : public EffectWithTypeSpecificParameters<SConditionParameters>
+      {
+      public:
+
+        /// Computes the force that a single axis condition generates for the given value of the
+        /// condition metric. Intended for internal use but exposed for testing. The default
+        /// implementation generates a force proportional to the distance from the edge of the
+        /// dead band.
+        /// @param [in] axisCondition Condition parameters for the axis.
+        /// @param [in] metric Current value of the condition metric for the axis.
+        /// @return Magnitude of the resulting force along the axis.
+        virtual TEffectValue ComputeAxisForce(
+            const SAxisCondition& axisCondition, TEffectValue metric) const;
+
+        /// Selects the condition metric to which this effect responds.
+        /// @param [in] conditionInput State of the virtual controller axes.
+        /// @return Read-only reference to the selected metric, one element per axis.
+        virtual const TOrderedMagnitudeComponents& SelectMetric(
+            const SConditionInput& conditionInput) const = 0;
+
+        // EffectWithTypeSpecificParameters
+        bool AreTypeSpecificParametersValid(
+            const SConditionParameters& newTypeSpecificParameters) const override;
+        void CheckAndFixTypeSpecificParameters(
+            SConditionParameters& newTypeSpecificParameters) const override;
+
+        // Effect
+        bool IsConditionEffect(void) const override;
+
+      protected:
+
+        // Effect
+        TEffectValue ComputeRawMagnitude(TEffectTimeMs rawTime) const override;
+        TEffectTimeMs ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const override;
+        TOrderedMagnitudeComponents ComputeRawConditionMagnitudeComponents(
+            const SConditionInput& conditionInput) const override;
+      };
+
+      /// Concrete implementation of a condition effect that responds to axis position, pulling
+      /// each axis towards the offset.
+      class SpringEffect : public ConditionEffect
+      {
+      public:
+
+        // ConditionEffect
+        const TOrderedMagnitudeComponents& SelectMetric(
+            const SConditionInput& conditionInput) const override;
+
+        // Effect
+        std::unique_ptr<Effect> Clone(void) const override;
+      };
+
+      /// Concrete implementation of a condition effect that responds to axis velocity, resisting
+      /// motion in proportion to how fast each axis moves.
+      class DamperEffect : public ConditionEffect
+      {
+      public:
+
+        // ConditionEffect
+        const TOrderedMagnitudeComponents& SelectMetric(
+            const SConditionInput& conditionInput) const override;
+
+        // Effect
+        std::unique_ptr<Effect> Clone(void) const override;
+      };
+
+      /// Concrete implementation of a condition effect that responds to axis acceleration,
+      /// resisting changes in how fast each axis moves.
+      class InertiaEffect : public ConditionEffect
+      {
+      public:
+
+        // ConditionEffect
+        const TOrderedMagnitudeComponents& SelectMetric(
+            const SConditionInput& conditionInput) const override;
+
+        // Effect
+        std::unique_ptr<Effect> Clone(void) const override;
+      };
+
+      /// Concrete implementation of a condition effect that responds to axis velocity, resisting
+      /// motion with a force that does not depend on how fast each axis moves.
+      class FrictionEffect : public ConditionEffect
+      {
+      public:
+
+        // ConditionEffect
+        TEffectValue ComputeAxisForce(
+            const SAxisCondition& axisCondition, TEffectValue metric) const override;
+        const TOrderedMagnitudeComponents& SelectMetric(
+            const SConditionInput& conditionInput) const override;
+
+        // Effect
+        std::unique_ptr<Effect> Clone(void) const override;
       };
     } // namespace ForceFeedback
   }   // namespace Controller
@@ -148,6 +148,10 @@ namespace Xidi
 
       private:
 
+        /// Recomputes the unit projection of this direction vector onto each of its axes. Must be
+        /// invoked whenever the direction changes.
+        void UpdateProjection(void);
+
         /// Number of axes represented by this direction vector.
         int numAxes;
 
@@ -177,6 +181,12 @@ namespace Xidi
         /// one axis is present and with certain specific values when only one axis is
         /// present.
         std::array<TEffectValue, kEffectAxesMaximumNumber - 1> spherical;
+
+        /// Per-axis components of a force with unit magnitude that points in the direction
+        /// represented by this vector. Derived from the other representations whenever the
+        /// direction changes so that splitting a force into its components only requires one
+        /// multiplication per axis.
+        TMagnitudeComponents projection;
       };
 
       /// Structure for representing an envelope that might be applied to an effect.
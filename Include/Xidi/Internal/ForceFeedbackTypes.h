@@ -91,6 +91,28 @@ namespace Xidi
       /// depend on the number or types of axes actually associated with the force feedback effect.
       using TOrderedMagnitudeComponents = std::array<TEffectValue, static_cast<int>(EAxis::Count)>;
 
+      /// Holds the state of the virtual controller axes to which condition effects respond. Each
+      /// quantity is expressed in the same units as effect magnitudes, so that a fully-deflected
+      /// axis has a position of #kEffectForceMagnitudeMaximum or #kEffectForceMagnitudeMinimum.
+      /// Quantities are ordered using the same scheme as #TOrderedMagnitudeComponents.
+      struct SConditionInput
+      {
+        /// Time, in milliseconds, over which velocity and acceleration are measured. For example,
+        /// a velocity of 10000 means the axis moves half of its range in this amount of time.
+        static constexpr TEffectTimeMs kTimeBaseMs = 100;
+
+        /// Position of each axis.
+        TOrderedMagnitudeComponents position;
+
+        /// Change in position of each axis per #kTimeBaseMs milliseconds.
+        TOrderedMagnitudeComponents velocity;
+
+        /// Change in velocity of each axis per #kTimeBaseMs milliseconds.
+        TOrderedMagnitudeComponents acceleration;
+
+        constexpr bool operator==(const SConditionInput& other) const = default;
+      };
+
       /// Describes a force feedback actuator element on a virtual controller.
       /// A force feedback actuator can be mapped to an axis and a direction mode on that axis.
       /// The information is used to determine what source of information is used to send output to
@@ -21,6 +21,8 @@
 
 namespace Xidi
 {
+  struct SSettings;
+
   namespace Globals
   {
     /// Determines if this process has input focus based on whether or not a window it owns is at
@@ -28,12 +30,33 @@ namespace Xidi
     /// @return `true` if so, `false` if not.
     bool DoesCurrentProcessHaveInputFocus(void);
 
+    /// Waits for this process to have input focus, returning as soon as it does. Uses foreground
+    /// window change notifications when they are available so that waiting threads are woken up
+    /// immediately when input focus is gained.
+    /// @param [in] timeoutMilliseconds Maximum amount of time to wait.
+    /// @return `true` if this process has input focus, `false` if the timeout elapsed first.
+    bool WaitForInputFocus(unsigned int timeoutMilliseconds);
+
     /// Retrieves the configuration object that represents the data read from a configuration file.
     /// @return Read-only configuration object reference.
     const Infra::Configuration::ConfigurationData& GetConfigurationData(void);
 
+    /// Retrieves the typed representation of the controller-independent settings read from a
+    /// configuration file. Intended for code that consults settings frequently, since reading a
+    /// field is much cheaper than looking up a setting by section and name.
+    /// @return Read-only settings object reference.
+    const SSettings& GetSettings(void);
+
+    /// Ensures that all run-time initialization has completed, performing it on the calling thread
+    /// if it has not yet started and otherwise waiting for it to finish. Must be invoked by every
+    /// top-level entry point that depends on the configuration file or on anything initialized
+    /// based on its contents. Cannot be invoked from within a DLL entry point.
+    void EnsureInitialized(void);
+
     /// Performs run-time initialization.
     /// This function only performs operations that are safe to perform within a DLL entry point.
+    /// In the main Xidi library, anything that depends on the configuration file is deferred to a
+    /// thread pool work item and can be awaited using #EnsureInitialized.
     void Initialize(void);
   } // namespace Globals
 } // namespace Xidi
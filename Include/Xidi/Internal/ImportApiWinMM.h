@@ -34,6 +34,7 @@ namespace Xidi
     MMRESULT joySetThreshold(UINT uJoyID, UINT uThreshold);
 
     MMRESULT timeBeginPeriod(UINT uPeriod);
+    MMRESULT timeEndPeriod(UINT uPeriod);
     MMRESULT timeGetDevCaps(LPTIMECAPS ptc, UINT cbtc);
     DWORD timeGetTime(void);
 
@@ -22,14 +22,41 @@
 
 // clang-format on
 
+#include <array>
+
 namespace Xidi
 {
   namespace ImportApiXInput
   {
+    /// Filenames of all supported XInput libraries, in order from most preferred to least
+    /// preferred.
+    inline constexpr std::array<const wchar_t*, 5> kXInputLibraryNamesOrdered = {
+        L"xinput1_4.dll", L"xinput1_3.dll", L"xinput1_2.dll", L"xinput1_1.dll", L"xinput9_1_0.dll"};
+
     /// Dynamically loads the XInput library and sets up all imported function calls.
     void Initialize(void);
 
     DWORD XInputGetState(DWORD dwUserIndex, XINPUT_STATE* pState);
     DWORD XInputSetState(DWORD dwUserIndex, XINPUT_VIBRATION* pVibration);
+
+    /// Determines if the loaded XInput library offers the extended state query, which is exported
+    /// by ordinal only and additionally reports the Guide button.
+    /// @return `true` if the extended state query is available, `false` otherwise.
+    bool IsXInputGetStateExAvailable(void);
+
+    /// Queries controller state using the extended state query, which reports everything that
+    /// the standard query reports plus the Guide button. If the extended state query is not
+    /// available, behaves identically to the standard query.
+    DWORD XInputGetStateEx(DWORD dwUserIndex, XINPUT_STATE* pState);
+
+    /// Queries controller capabilities. Not every XInput library offers this query, in which case
+    /// `ERROR_NOT_SUPPORTED` is returned.
+    DWORD XInputGetCapabilities(
+        DWORD dwUserIndex, DWORD dwFlags, XINPUT_CAPABILITIES* pCapabilities);
+
+    /// Queries controller battery information. Not every XInput library offers this query, in
+    /// which case `ERROR_NOT_SUPPORTED` is returned.
+    DWORD XInputGetBatteryInformation(
+        DWORD dwUserIndex, BYTE devType, XINPUT_BATTERY_INFORMATION* pBatteryInformation);
   } // namespace ImportApiXInput
 } // namespace Xidi
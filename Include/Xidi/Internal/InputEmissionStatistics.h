@@ -0,0 +1,121 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file InputEmissionStatistics.h
+ *   Declaration of counters that describe keyboard and mouse input submitted to the system.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ApiWindows.h"
+#include "ApiXidi.h"
+
+namespace Xidi
+{
+  /// Collects statistics about the keyboard or mouse input that a single emitter submits to the
+  /// system. Counters are updated using relaxed atomic operations so that they can be read at any
+  /// time from any thread. Timing uses the performance counter.
+  class InputEmissionStatistics
+  {
+  public:
+
+    /// Type used to report statistics.
+    using SStatistics = Api::IInputEmissionStatistics::SStatistics;
+
+    /// Creates a statistics object for the named emitter.
+    /// @param [in] emitterName Name of the emitter, used when outputting summaries. Must remain
+    /// valid for the lifetime of this object.
+    InputEmissionStatistics(std::wstring_view emitterName);
+
+    InputEmissionStatistics(const InputEmissionStatistics& other) = delete;
+
+    /// Retrieves and returns the current value of the performance counter.
+    /// @return Current performance counter value.
+    static int64_t Now(void);
+
+    /// Retrieves a snapshot of all of the statistics collected so far.
+    /// @return Collected statistics.
+    SStatistics GetStatistics(void) const;
+
+    /// Outputs a summary of the collected statistics if enough time has passed since the last
+    /// summary. Only the emitter itself should invoke this method.
+    /// @param [in] nowTicks Current performance counter value.
+    void OutputSummaryIfDue(int64_t nowTicks);
+
+    /// Records the time between the earliest mapper contribution and the emission of the
+    /// transitions it caused.
+    /// @param [in] contributionTicks Performance counter value at the time of the earliest
+    /// contribution.
+    /// @param [in] emissionTicks Performance counter value at the time of emission.
+    void RecordLatency(int64_t contributionTicks, int64_t emissionTicks);
+
+    /// Records that the emitter checked for input to be submitted.
+    inline void RecordTick(void)
+    {
+      numTicks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Records that the emitter detected key or button state transitions.
+    /// @param [in] count Number of transitions detected.
+    inline void RecordTransitions(unsigned int count)
+    {
+      numTransitions.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /// Submits the specified input events to the system and records how many were sent and how
+    /// long it took.
+    /// @param [in] inputEvents Input events to submit.
+    /// @return Number of input events sent, as reported by the system.
+    UINT SendInput(std::vector<INPUT>& inputEvents);
+
+  private:
+
+    /// Converts a number of performance counter ticks to microseconds.
+    /// @param [in] ticks Number of performance counter ticks.
+    /// @return Equivalent number of microseconds.
+    static uint64_t TicksToMicroseconds(int64_t ticks);
+
+    /// Name of the emitter, used when outputting summaries.
+    std::wstring_view emitterName;
+
+    /// Number of times the emitter checked for input to be submitted.
+    std::atomic<uint64_t> numTicks;
+
+    /// Number of key or button state transitions detected.
+    std::atomic<uint64_t> numTransitions;
+
+    /// Number of calls made to `SendInput`.
+    std::atomic<uint64_t> numSendInputCalls;
+
+    /// Number of calls made to `SendInput` that did not send all of the supplied events.
+    std::atomic<uint64_t> numSendInputFailures;
+
+    /// Number of input events that `SendInput` reported as sent.
+    std::atomic<uint64_t> numEventsSent;
+
+    /// Total time spent inside `SendInput`, in performance counter ticks.
+    std::atomic<int64_t> totalSendInputTicks;
+
+    /// Number of latency measurements.
+    std::atomic<uint64_t> numLatencySamples;
+
+    /// Sum of all latency measurements, in performance counter ticks.
+    std::atomic<int64_t> totalLatencyTicks;
+
+    /// Largest single latency measurement, in performance counter ticks.
+    std::atomic<int64_t> maxLatencyTicks;
+
+    /// Performance counter value at or after which the next summary is due, or 0 if the first
+    /// summary has not yet been scheduled.
+    int64_t nextSummaryTicks;
+  };
+} // namespace Xidi
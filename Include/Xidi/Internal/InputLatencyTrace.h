@@ -0,0 +1,84 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file InputLatencyTrace.h
+ *   Declaration of functionality for measuring how long physical controller input takes to reach
+ *   the application.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace InputLatencyTrace
+    {
+      /// Type used to identify the stages into which each sample is broken down.
+      using EStage = Api::IInputLatency::EStage;
+
+      /// Type used to report statistics.
+      using SStageStatistics = Api::IInputLatency::SStageStatistics;
+
+      /// Performance counter values captured as a single change in physical controller state
+      /// makes its way through to virtual controllers. Any value of 0 means the sample was not
+      /// captured because tracing is disabled.
+      struct SSample
+      {
+        /// When XInput returned the physical controller state.
+        int64_t xinputTicks;
+
+        /// When the mapper finished producing virtual controller state.
+        int64_t mappedTicks;
+
+        /// When the virtual controller state was published for all readers.
+        int64_t publishedTicks;
+
+        /// When all virtual controllers finished refreshing their state.
+        int64_t deliveredTicks;
+      };
+
+      /// Determines whether or not input latency tracing is enabled in the configuration file.
+      /// @return `true` if so, `false` if not.
+      bool IsEnabled(void);
+
+      /// Captures the current performance counter value for inclusion in a sample.
+      /// @return Current performance counter value, or 0 if tracing is disabled.
+      int64_t Stamp(void);
+
+      /// Submits a completed sample for the specified physical controller. The next application
+      /// read of that physical controller completes the sample and records it. If a sample is
+      /// still waiting for an application read then it is replaced. Must only be invoked by the
+      /// thread currently polling the physical controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] sample Sample to submit.
+      void SubmitSample(TControllerIdentifier controllerIdentifier, const SSample& sample);
+
+      /// Records that the application just read virtual controller state derived from the
+      /// specified physical controller. If this is the first read since a sample was submitted,
+      /// then the sample is completed and added to the statistics. Concurrency-safe.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      void RecordApplicationRead(TControllerIdentifier controllerIdentifier);
+
+      /// Retrieves a snapshot of the statistics for the specified stage of the specified physical
+      /// controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] stage Stage of interest.
+      /// @return Statistics for the stage, which are empty if either parameter is out of range.
+      SStageStatistics GetStatistics(TControllerIdentifier controllerIdentifier, EStage stage);
+
+      /// Outputs a summary of the statistics collected for all physical controllers as
+      /// informational messages. Does nothing if tracing is disabled.
+      void OutputSummary(void);
+    } // namespace InputLatencyTrace
+  } // namespace Controller
+} // namespace Xidi
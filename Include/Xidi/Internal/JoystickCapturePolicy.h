@@ -0,0 +1,60 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file JoystickCapturePolicy.h
+ *   Declaration and implementation of the policy that determines when WinMM joystick capture
+ *   messages are delivered.
+ **************************************************************************************************/
+
+#pragma once
+
+#include "ApiWindows.h"
+
+namespace Xidi
+{
+  namespace WrapperJoyWinMM
+  {
+    /// Describes how the thread that delivers joystick capture messages waits between rounds of
+    /// messages. Each round reads the virtual controller state once and posts the resulting
+    /// messages to the capturing window.
+    struct SCaptureWaitPolicy
+    {
+      /// Whether or not a change in virtual controller state ends the wait before a round.
+      bool wakeOnStateChange;
+
+      /// Maximum time to wait before a round, in milliseconds, or `INFINITE` if only a change in
+      /// virtual controller state can end the wait.
+      DWORD timeoutMilliseconds;
+
+      /// Time to wait after a round before waiting for the next one, in milliseconds. Any state
+      /// change that happens during this time remains pending and ends the next wait immediately.
+      DWORD holdOffMilliseconds;
+    };
+
+    /// Determines how the thread that delivers joystick capture messages waits between rounds.
+    /// If only changes are of interest, a round happens when state changes, but at most once per
+    /// period. Otherwise, a round happens exactly once per period no matter how often state
+    /// changes, as documented for `joySetCapture`.
+    /// @param [in] periodMilliseconds Capture period, already clamped to the supported range.
+    /// @param [in] changedOnly Whether or not movement messages are posted only when positions
+    /// change.
+    /// @return Wait policy for the capture thread.
+    constexpr SCaptureWaitPolicy CaptureWaitPolicy(UINT periodMilliseconds, bool changedOnly)
+    {
+      if (true == changedOnly)
+        return {
+            .wakeOnStateChange = true,
+            .timeoutMilliseconds = INFINITE,
+            .holdOffMilliseconds = periodMilliseconds};
+
+      return {
+          .wakeOnStateChange = false,
+          .timeoutMilliseconds = periodMilliseconds,
+          .holdOffMilliseconds = 0};
+    }
+  } // namespace WrapperJoyWinMM
+} // namespace Xidi
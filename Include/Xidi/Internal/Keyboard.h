@@ -12,13 +12,27 @@
 
 #pragma once
 
+#include <cstdint>
+
+#include "ApiXidi.h"
+
 namespace Xidi
 {
   namespace Keyboard
   {
-    /// Number of milliseconds to wait between physical keyboard update attempts.
+    /// Default number of milliseconds to wait between physical keyboard update attempts. Can be
+    /// overridden using the configuration file.
     inline constexpr unsigned int kKeyboardUpdatePeriodMilliseconds = 10;
 
+    /// Default number of milliseconds a virtual keyboard key must be held before it starts
+    /// repeating. Key repeat is disabled by default. Can be overridden using the configuration
+    /// file.
+    inline constexpr unsigned int kKeyboardRepeatDelayMilliseconds = 0;
+
+    /// Default number of milliseconds between repeats of a held virtual keyboard key. Can be
+    /// overridden using the configuration file.
+    inline constexpr unsigned int kKeyboardRepeatPeriodMilliseconds = 33;
+
     /// Number of keyboard keys that exist in total on a virtual keyboard.
     /// Value taken from DirectInput documentation, which indicates keyboard state is reported as an
     /// array of 256 bytes.
@@ -29,6 +43,32 @@ namespace Xidi
     /// constants).
     using TKeyIdentifier = unsigned int;
 
+    /// Determines if the DirectInput keyboard backend is enabled. If so, virtual keyboard state is
+    /// not submitted to the system as keyboard input events and is instead surfaced directly to
+    /// the application through the system keyboard DirectInput device.
+    /// @return `true` if the DirectInput keyboard backend is enabled, `false` otherwise.
+    bool IsDirectInputBackendEnabled(void);
+
+    /// Marks all of the keys that are pressed on the virtual keyboard as pressed in a DirectInput
+    /// keyboard state buffer. Keys not pressed on the virtual keyboard are left unchanged.
+    /// @param [in, out] keyboardState DirectInput keyboard state buffer, which contains one byte
+    /// per keyboard key indexed by scan code.
+    void MergeIntoDirectInputKeyboardState(uint8_t (&keyboardState)[kVirtualKeyboardKeyCount]);
+
+    /// Retrieves statistics about the keyboard input that has been submitted to the system.
+    /// @return Snapshot of the keyboard emitter's statistics.
+    Api::IInputEmissionStatistics::SStatistics GetEmissionStatistics(void);
+
+    /// Begins a batch of key state submissions on the calling thread. Until the matching call to
+    /// #EndSubmissionBatch, key state submissions made by the calling thread are collected rather
+    /// than committed individually, and they are then committed to the virtual keyboard all at
+    /// once. Batches can be nested, in which case only the outermost batch commits.
+    void BeginSubmissionBatch(void);
+
+    /// Ends a batch of key state submissions on the calling thread. If this ends the outermost
+    /// batch, then all collected key state submissions are committed to the virtual keyboard.
+    void EndSubmissionBatch(void);
+
     /// Submits a key state of pressed.
     /// @param [in] key Keyboard key that is affected.
     void SubmitKeyPressedState(TKeyIdentifier key);
@@ -36,5 +76,24 @@ namespace Xidi
     /// Submits a key state of released.
     /// @param [in] key Keyboard key that is affected.
     void SubmitKeyReleasedState(TKeyIdentifier key);
+
+    /// Scoped wrapper around a batch of key state submissions on the calling thread. The batch
+    /// begins when this object is created and ends when it is destroyed.
+    class ScopedSubmissionBatch
+    {
+    public:
+
+      inline ScopedSubmissionBatch(void)
+      {
+        BeginSubmissionBatch();
+      }
+
+      ScopedSubmissionBatch(const ScopedSubmissionBatch& other) = delete;
+
+      inline ~ScopedSubmissionBatch(void)
+      {
+        EndSubmissionBatch();
+      }
+    };
   } // namespace Keyboard
 } // namespace Xidi
@@ -0,0 +1,59 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file LiveMetrics.h
+ *   Declaration of functionality for exporting live metrics to external tools using a shared
+ *   memory section.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "LiveMetricsLayout.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace LiveMetrics
+    {
+      /// Determines whether or not live metrics export is enabled by the configuration.
+      /// @return `true` if live metrics are exported, `false` otherwise.
+      bool IsEnabled(void);
+
+      /// Creates the shared memory section and starts the thread that periodically updates it.
+      /// Does nothing if live metrics export is disabled or if it was already started.
+      /// @param [in] updatePeriodMilliseconds Time between updates of the shared memory section,
+      /// in milliseconds.
+      void Start(unsigned int updatePeriodMilliseconds);
+
+      /// Records the physical actuator values most recently written to the specified physical
+      /// controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] physicalActuatorValues Physical actuator values that were written.
+      void RecordActuatorValues(
+          TControllerIdentifier controllerIdentifier,
+          const ForceFeedback::SPhysicalActuatorComponents& physicalActuatorValues);
+
+      /// Records the state of the virtual controllers registered with the specified physical
+      /// controller, as observed while delivering a state change to them.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] numVirtualControllers Number of registered virtual controllers.
+      /// @param [in] eventBufferCount Largest number of events held by the event buffer of any of
+      /// the registered virtual controllers.
+      /// @param [in] eventBufferCapacity Capacity of the event buffer holding the most events.
+      void RecordVirtualControllers(
+          TControllerIdentifier controllerIdentifier,
+          uint32_t numVirtualControllers,
+          uint32_t eventBufferCount,
+          uint32_t eventBufferCapacity);
+    } // namespace LiveMetrics
+  } // namespace Controller
+} // namespace Xidi
@@ -0,0 +1,184 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file LiveMetricsLayout.h
+ *   Layout of the shared memory section through which live metrics are exported to external
+ *   tools. Depends only on fixed-width integer types so that external tools can use it directly.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace LiveMetrics
+    {
+      /// Format string for the name of the shared memory section. The only format argument is
+      /// the identifier of the process whose metrics are exported, so each process gets its own
+      /// section.
+      inline constexpr wchar_t kSectionNameFormat[] = L"Local\\Xidi.LiveMetrics.%u";
+
+      /// Value of the magic number field in a valid shared memory section, "XDLM" in memory order.
+      inline constexpr uint32_t kSectionMagic = 0x4d4c4458;
+
+      /// Version of the layout defined in this file. Incremented whenever the layout changes in a
+      /// way that is not compatible with readers of previous versions.
+      inline constexpr uint32_t kSectionVersion = 2;
+
+      /// Number of physical controller slots present in the shared memory section. Slots beyond
+      /// the number of physical controllers supported by the exporting process are zero-filled.
+      inline constexpr uint32_t kControllerSlotCount = 16;
+
+      /// Distribution of a measured duration, mirroring the Xidi API duration statistics.
+      struct SDuration
+      {
+        /// Number of measurements included in the distribution.
+        uint64_t numSamples;
+
+        /// Median duration, in microseconds.
+        uint64_t p50Microseconds;
+
+        /// 99th percentile duration, in microseconds.
+        uint64_t p99Microseconds;
+
+        /// Longest duration, in microseconds.
+        uint64_t maxMicroseconds;
+      };
+
+      /// Metrics for a single physical controller slot.
+      struct SControllerSlot
+      {
+        /// Physical device status: 0 if connected and functioning, 1 if not connected, 2 if it has
+        /// experienced an error.
+        uint32_t physicalDeviceStatus;
+
+        /// Physical digital button states, one bit per button using XInput bit positions.
+        uint32_t physicalButtons;
+
+        /// Physical analog stick values, ordered as left X, left Y, right X, right Y.
+        int16_t physicalStick[4];
+
+        /// Physical analog trigger values, ordered as left, right.
+        uint8_t physicalTrigger[2];
+
+        /// Unused, present for alignment.
+        uint8_t reserved[2];
+
+        /// Raw virtual axis values before per-device properties are applied, ordered as X, Y, Z,
+        /// RotX, RotY, RotZ.
+        int32_t virtualAxis[6];
+
+        /// Raw virtual button states, one bit per button with button 1 in the least-significant
+        /// bit.
+        uint32_t virtualButtons;
+
+        /// Raw virtual POV direction states, one bit per direction ordered as up, down, left, right
+        /// starting from the least-significant bit.
+        uint32_t virtualPov;
+
+        /// Force feedback actuator values most recently written to the physical controller, ordered
+        /// as left motor, right motor, left impulse trigger, right impulse trigger.
+        uint16_t actuatorValue[4];
+
+        /// Number of virtual controllers registered to receive state changes from this physical
+        /// controller, as of the most recent state change.
+        uint32_t numVirtualControllers;
+
+        /// Largest number of events held by the event buffer of any virtual controller registered
+        /// with this physical controller, as of the most recent state change.
+        uint32_t eventBufferCount;
+
+        /// Capacity of the event buffer identified by the event buffer count.
+        uint32_t eventBufferCapacity;
+
+        /// Configured polling period, in microseconds, or 0 if polling has not started.
+        uint64_t pollConfiguredPeriodMicroseconds;
+
+        /// Number of whole polling periods that were skipped because polling woke up too late.
+        uint64_t pollMissedDeadlines;
+
+        /// Time between the starts of successive scheduled polls.
+        SDuration pollInterval;
+
+        /// Time spent in each XInput state query.
+        SDuration xinputGetStateDuration;
+
+        /// Time spent by the mapper producing virtual controller state.
+        SDuration mappingDuration;
+      };
+
+      /// Metrics for a single keyboard or mouse input emitter.
+      struct SEmitter
+      {
+        /// Number of times the emitter checked for input to be submitted.
+        uint64_t numTicks;
+
+        /// Number of key or button state transitions detected.
+        uint64_t numTransitions;
+
+        /// Number of calls made to `SendInput`.
+        uint64_t numSendInputCalls;
+
+        /// Number of calls made to `SendInput` that did not send all of the supplied events.
+        uint64_t numSendInputFailures;
+
+        /// Number of input events that `SendInput` reported as sent.
+        uint64_t numEventsSent;
+      };
+
+      /// Complete contents of the shared memory section. Readers must use the sequence number to
+      /// obtain a consistent snapshot: it is odd while an update is in progress, so a reader
+      /// copies the section only after observing an even sequence number and retries if the
+      /// sequence number is different once the copy is complete.
+      struct SSection
+      {
+        /// Identifies the section as containing Xidi live metrics. Always #kSectionMagic.
+        uint32_t magic;
+
+        /// Layout version. Always #kSectionVersion.
+        uint32_t version;
+
+        /// Total size of the section, in bytes.
+        uint32_t size;
+
+        /// Identifier of the process whose metrics are exported.
+        uint32_t processId;
+
+        /// Sequence number for obtaining consistent snapshots.
+        uint32_t sequence;
+
+        /// Unused, present for alignment.
+        uint32_t reserved;
+
+        /// Frequency of the performance counter, in ticks per second.
+        int64_t performanceCounterFrequency;
+
+        /// Performance counter value when the section was most recently updated, which lets readers
+        /// detect that the exporting process has stopped updating it.
+        int64_t updatePerformanceCounter;
+
+        /// Number of updates made to the section since it was created.
+        uint64_t updateCount;
+
+        /// Metrics for each physical controller slot.
+        SControllerSlot controller[kControllerSlotCount];
+
+        /// Metrics for the keyboard input emitter.
+        SEmitter keyboard;
+
+        /// Metrics for the mouse input emitter.
+        SEmitter mouse;
+      };
+
+      static_assert(
+          0 == (sizeof(SControllerSlot) % 8), "Data structure size constraint violation.");
+    } // namespace LiveMetrics
+  } // namespace Controller
+} // namespace Xidi
@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string_view>
 
 #include "ApiBitSet.h"
 #include "ApiWindows.h"
+#include "ControllerMath.h"
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "ForceFeedbackTypes.h"
@@ -71,8 +73,61 @@ namespace Xidi
         std::unique_ptr<const IElementMapper> buttonStart = nullptr;
         std::unique_ptr<const IElementMapper> buttonLS = nullptr;
         std::unique_ptr<const IElementMapper> buttonRS = nullptr;
+        std::unique_ptr<const IElementMapper> buttonGuide = nullptr;
       };
 
+      /// Number of physical controller elements, and therefore element mappers, in an element map.
+      static constexpr unsigned int kElementCount =
+          sizeof(SElementMap) / sizeof(std::unique_ptr<const IElementMapper>);
+
+      /// Identifies a set of physical controller elements, one bit per element, using element map
+      /// positions as bit positions.
+      using TElementMapMask = uint32_t;
+
+      static_assert(
+          kElementCount <= (8 * sizeof(TElementMapMask)),
+          "Number of physical controller elements does not fit into an element map mask.");
+
+      /// Maximum number of chords that a single mapper can hold.
+      static constexpr unsigned int kMaxChordCount = 8;
+
+      /// Combination of physical controller buttons that must all be held at the same time,
+      /// together with the element mapper that receives a button press while they are. Buttons that
+      /// make up a held chord do not contribute through the element map, which allows, for example,
+      /// holding LB and pressing A to send a keyboard key without also pressing whatever A is
+      /// normally mapped to. A chord that contains no buttons is unused.
+      struct SChord
+      {
+        /// Physical controller buttons that make up the chord.
+        TElementMapMask elements = 0;
+
+        /// Element mapper that receives a button press while the chord is held. May be `nullptr`,
+        /// in which case holding the chord only suppresses the buttons that make it up.
+        std::unique_ptr<const IElementMapper> elementMapper = nullptr;
+      };
+
+      /// All chords held by a mapper, evaluated in order each time physical controller state is
+      /// mapped. Storage is fixed in size so that evaluating chords never allocates memory.
+      using TChords = std::array<SChord, kMaxChordCount>;
+
+      /// Values of all physical controller elements, indexed by element map position. Button
+      /// values are represented as 0 or 1 and trigger values are represented without modification,
+      /// so that all values can be held and compared uniformly.
+      using TElementValues = std::array<int16_t, kElementCount>;
+
+      /// Signature of a function that makes, in a single pass, all of the contributions to
+      /// controller state that a particular fixed element map would make. Built-in mappers supply
+      /// such functions, which are generated at compile time, so that mapping does not need to
+      /// interpret the compiled element mapper program.
+      using TSpecializedMapFunc = void (*)(
+          const TElementValues& elementValues,
+          SState& controllerState,
+          uint32_t sourceControllerIdentifier);
+
+      /// Signature of a function that attempts to create and register a mapper object of the
+      /// specified name when one is first requested.
+      using TOnDemandBuildFunc = const Mapper* (*)(std::wstring_view mapperName);
+
       /// Physical force feedback actuator mappers, one per force feedback actuator.
       /// For force feedback actuators that are not used, the `valid` bit is set to 0.
       /// Names correspond to the enumerators in the #ForceFeedback::EActuator enumeration.
@@ -150,6 +205,26 @@ namespace Xidi
           sizeof(UForceFeedbackActuatorMap::named) == sizeof(UForceFeedbackActuatorMap::all),
           "Force feedback actuator field mismatch.");
 
+      /// Force feedback actuator map lowered into a matrix with one row per physical force
+      /// feedback actuator and one column per virtual force feedback axis. The raw strength of a
+      /// physical actuator is the Euclidean norm of its row's weighted virtual magnitude
+      /// components, with separate weights for positive and negative components. This expresses
+      /// both single-axis and magnitude projection modes uniformly, so that mapping is a fixed
+      /// multiply-accumulate rather than per-actuator branching. Weights are stored squared.
+      struct SForceFeedbackActuatorMatrix
+      {
+        /// Type used to hold one squared weight per actuator and axis.
+        using TWeights = std::array<
+            std::array<ForceFeedback::TEffectValue, static_cast<int>(EAxis::Count)>,
+            static_cast<int>(ForceFeedback::EActuator::Count)>;
+
+        /// Squared weights applied to positive virtual magnitude components.
+        TWeights positiveWeights;
+
+        /// Squared weights applied to negative virtual magnitude components.
+        TWeights negativeWeights;
+      };
+
       /// Set of axes that must be present on all virtual controllers.
       /// Contents are based on expectations of both DirectInput and WinMM state data structures.
       /// If no element mappers contribute to these axes then they will be continually reported as
@@ -177,6 +252,109 @@ namespace Xidi
       static constexpr SForceFeedbackActuatorMap kDefaultForceFeedbackActuatorMap = {
           .leftMotor = kDefaultForceFeedbackActuator, .rightMotor = kDefaultForceFeedbackActuator};
 
+      /// Extra transformations applied to raw analog values read from a physical controller before
+      /// they are passed to element mappers. These are read from the configuration file, either
+      /// globally or per controller, and can be used by users to correct for physical controller
+      /// characteristics. They are unrelated to any properties configured by the application.
+      struct SPhysicalTransformProfile
+      {
+        /// Fraction of circle-to-square correction to apply to the left stick, from 0.0 to 1.0.
+        double circleToSquareFractionStickLeft;
+
+        /// Fraction of circle-to-square correction to apply to the right stick, from 0.0 to 1.0.
+        double circleToSquareFractionStickRight;
+
+        /// Deadzone to apply to the left stick, as a percentage of its analog range.
+        unsigned int deadzonePercentStickLeft;
+
+        /// Deadzone to apply to the right stick, as a percentage of its analog range.
+        unsigned int deadzonePercentStickRight;
+
+        /// Deadzone to apply to the LT trigger, as a percentage of its analog range.
+        unsigned int deadzonePercentTriggerLT;
+
+        /// Deadzone to apply to the RT trigger, as a percentage of its analog range.
+        unsigned int deadzonePercentTriggerRT;
+
+        /// Saturation to apply to the left stick, as a percentage of its analog range.
+        unsigned int saturationPercentStickLeft;
+
+        /// Saturation to apply to the right stick, as a percentage of its analog range.
+        unsigned int saturationPercentStickRight;
+
+        /// Saturation to apply to the LT trigger, as a percentage of its analog range.
+        unsigned int saturationPercentTriggerLT;
+
+        /// Saturation to apply to the RT trigger, as a percentage of its analog range.
+        unsigned int saturationPercentTriggerRT;
+
+        constexpr bool operator==(const SPhysicalTransformProfile& other) const = default;
+      };
+
+      /// Default physical transform profile, which leaves raw analog values unchanged.
+      /// Used whenever a physical transform profile is not provided.
+      static constexpr SPhysicalTransformProfile kDefaultPhysicalTransformProfile = {
+          .circleToSquareFractionStickLeft = 0.0,
+          .circleToSquareFractionStickRight = 0.0,
+          .deadzonePercentStickLeft = 0,
+          .deadzonePercentStickRight = 0,
+          .deadzonePercentTriggerLT = 0,
+          .deadzonePercentTriggerRT = 0,
+          .saturationPercentStickLeft = 100,
+          .saturationPercentStickRight = 100,
+          .saturationPercentTriggerLT = 100,
+          .saturationPercentTriggerRT = 100};
+
+      /// Physical transform profile compiled into a form that can be applied to raw analog values
+      /// using only integer arithmetic and table lookups. Compiling a profile is comparatively
+      /// expensive and is intended to happen once, so that mapping physical controller states does
+      /// not require any floating-point math.
+      struct SCompiledPhysicalTransform
+      {
+        /// Circle-to-square correction table for the left stick.
+        Math::SCircleToSquareTable circleToSquareStickLeft;
+
+        /// Circle-to-square correction table for the right stick.
+        Math::SCircleToSquareTable circleToSquareStickRight;
+
+        /// Deadzone and saturation parameters for the left stick.
+        Math::SRawAnalogTransformParameters analogTransformStickLeft;
+
+        /// Deadzone and saturation parameters for the right stick.
+        Math::SRawAnalogTransformParameters analogTransformStickRight;
+
+        /// Deadzone and saturation lookup table for the LT trigger.
+        Math::SRawTriggerTransformTable triggerTransformLT;
+
+        /// Deadzone and saturation lookup table for the RT trigger.
+        Math::SRawTriggerTransformTable triggerTransformRT;
+      };
+
+      /// Caller-owned state that allows physical controller states to be mapped incrementally, one
+      /// instance per physical controller. Holds the physical controller element values seen by the
+      /// previous mapping along with the contributions each element mapper made in response. Must
+      /// be reset whenever a mapping is done by any other means, such as for a neutral state.
+      struct SIncrementalMappingState
+      {
+        /// Mapper that produced the cached contributions, or `nullptr` if there are none.
+        const Mapper* mapper = nullptr;
+
+        /// Value of each physical controller element, after raw transformations were applied, as
+        /// seen by the previous mapping. Indexed by element map position.
+        std::array<int16_t, kElementCount> elementValue = {};
+
+        /// Contribution made by each element mapper during the most recent mapping in which it was
+        /// invoked. Indexed by element map position.
+        std::array<SState, kElementCount> elementContribution = {};
+
+        /// Discards all cached contributions so that the next incremental mapping invokes every
+        /// element mapper.
+        inline void Reset(void)
+        {
+          mapper = nullptr;
+        }
+      };
+
       /// Each controller element must supply a unique element mapper which becomes owned by this
       /// object. For controller elements that are not used, `nullptr` may be set instead.
       Mapper(
@@ -184,6 +362,24 @@ namespace Xidi
           SElementMap&& elements,
           SForceFeedbackActuatorMap forceFeedbackActuators = kDefaultForceFeedbackActuatorMap);
 
+      /// Same as above, but additionally supplies chords, which become owned by this object.
+      Mapper(
+          const std::wstring_view name,
+          SElementMap&& elements,
+          TChords&& chords,
+          SForceFeedbackActuatorMap forceFeedbackActuators = kDefaultForceFeedbackActuatorMap);
+
+      /// Same as the first constructor, but additionally supplies a function that makes the same
+      /// contributions as the element map all at once. Intended for built-in mappers whose element
+      /// maps are known at compile time. The caller is responsible for ensuring that the function
+      /// and the element map agree, because the function is used for full mapping and the element
+      /// map for everything else.
+      Mapper(
+          const std::wstring_view name,
+          SElementMap&& elements,
+          TSpecializedMapFunc specializedMapFunc,
+          SForceFeedbackActuatorMap forceFeedbackActuators = kDefaultForceFeedbackActuatorMap);
+
       /// Does not require or register a name for this mapper. This version is primarily useful for
       /// testing. Requires that a unique mapper be specified for each controller element, which in
       /// turn becomes owned by this object. For controller elements that are not used, `nullptr`
@@ -192,6 +388,12 @@ namespace Xidi
           SElementMap&& elements,
           SForceFeedbackActuatorMap forceFeedbackActuators = kDefaultForceFeedbackActuatorMap);
 
+      /// Copies all element mappers and then compiles them again, so that the copy does not refer
+      /// to any element mappers owned by the original. Primarily useful for testing. Any
+      /// specialized mapping function is intentionally not copied, so the copy always maps using
+      /// its compiled element mapper program.
+      Mapper(const Mapper& other);
+
       /// In general, mapper objects should not be destroyed once created.
       /// However, tests may create mappers as temporaries that end up being destroyed.
       ~Mapper(void);
@@ -202,6 +404,8 @@ namespace Xidi
       /// Retrieves and returns a pointer to the mapper object whose name is specified.
       /// Mapper objects are created and managed internally, so this operation does not dynamically
       /// allocate or deallocate memory, nor should the caller attempt to free the returned pointer.
+      /// If no mapper of the specified name is registered, the on-demand build function is given
+      /// the opportunity to create one.
       /// @param [in] mapperName Name of the desired mapper. Supported built-in values are defined
       /// in "MapperDefinitions.cpp" as mapper instances, but more could be built and registered at
       /// runtime.
@@ -216,6 +420,33 @@ namespace Xidi
       /// requested.
       static const Mapper* GetConfigured(TControllerIdentifier controllerIdentifier);
 
+      /// Compiles the specified physical transform profile into a form that can be applied to raw
+      /// analog values without any floating-point math.
+      /// @param [in] transformProfile Physical transform profile to compile.
+      /// @return Compiled physical transform.
+      static SCompiledPhysicalTransform CompilePhysicalTransformProfile(
+          const SPhysicalTransformProfile& transformProfile);
+
+      /// Retrieves and returns the physical transform profile read from the configuration file for
+      /// the specified controller identifier. Settings in the per-controller properties section
+      /// take precedence over settings in the controller-independent properties section, and any
+      /// settings not present in either retain their default values. Profiles are built once, on
+      /// first invocation, and returned subsequently by reference.
+      /// @param [in] controllerIdentifier Identifier of the controller for which a physical
+      /// transform profile is requested.
+      /// @return Read-only reference to the physical transform profile.
+      static const SPhysicalTransformProfile& GetConfiguredPhysicalTransformProfile(
+          TControllerIdentifier controllerIdentifier);
+
+      /// Retrieves and returns the compiled form of the physical transform profile read from the
+      /// configuration file for the specified controller identifier. Compilation happens once, on
+      /// first invocation, and the result is returned subsequently by reference.
+      /// @param [in] controllerIdentifier Identifier of the controller for which a compiled
+      /// physical transform is requested.
+      /// @return Read-only reference to the compiled physical transform.
+      static const SCompiledPhysicalTransform& GetConfiguredPhysicalTransform(
+          TControllerIdentifier controllerIdentifier);
+
       /// Retrieves and returns a pointer to the default mapper object.
       /// @return Pointer to the default mapper object, or `nullptr` if there is no default.
       static inline const Mapper* GetDefault(void)
@@ -223,6 +454,11 @@ namespace Xidi
         return GetByName(L"");
       }
 
+      /// Retrieves and returns the compiled form of the default physical transform profile, which
+      /// leaves raw analog values unchanged.
+      /// @return Read-only reference to the compiled default physical transform.
+      static const SCompiledPhysicalTransform& GetDefaultPhysicalTransform(void);
+
       /// Retrieves and returns a pointer to a mapper object that does nothing and affects no
       /// controller elements. Can be used as a fall-back in the event of an error. Always returns a
       /// valid address.
@@ -232,9 +468,48 @@ namespace Xidi
       /// Checks if a mapper of the specified name is known and registered.
       /// @param [in] mapperName Name of the mapper to check.
       /// @return `true` if it is registered, `false` otherwise.
-      static inline bool IsMapperNameKnown(std::wstring_view mapperName)
+      static bool IsMapperNameKnown(std::wstring_view mapperName);
+
+      /// Sets the function to be invoked whenever a mapper is requested by name but no mapper of
+      /// that name is registered. The function is given the opportunity to create and register a
+      /// mapper of that name, allowing mapper objects to be created on demand.
+      /// @param [in] onDemandBuildFunc Function to invoke, or `nullptr` to disable creating mapper
+      /// objects on demand.
+      static void SetOnDemandBuildFunc(TOnDemandBuildFunc onDemandBuildFunc);
+
+      /// Computes the opaque source identifier that is to be passed to an element mapper.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+      /// associated with the state being mapped.
+      /// @param [in] elementMapIndex Positional index of the element mapper within the overall
+      /// element map.
+      /// @return Opaque source identifier value that can be passed to the element mapper.
+      static constexpr uint32_t SourceIdentifierForElementMapper(
+          uint32_t sourceControllerIdentifier, uint32_t elementMapIndex)
       {
-        return (nullptr != GetByName(mapperName));
+        return (sourceControllerIdentifier << 8) + elementMapIndex;
+      }
+
+      /// Computes the opaque source identifier that is to be passed to the element mapper of a
+      /// chord. These never collide with the source identifiers used for the element map or with
+      /// those used by anything else that contributes on behalf of a physical controller.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+      /// associated with the state being mapped.
+      /// @param [in] chordIndex Positional index of the chord within the mapper's chords.
+      /// @return Opaque source identifier value that can be passed to the element mapper.
+      static constexpr uint32_t SourceIdentifierForChord(
+          uint32_t sourceControllerIdentifier, uint32_t chordIndex)
+      {
+        return SourceIdentifierForElementMapper(sourceControllerIdentifier, 0x80 + chordIndex);
+      }
+
+      /// Recovers the opaque identifier of the physical controller from a source identifier that
+      /// was passed to an element mapper. Inverse of #SourceIdentifierForElementMapper.
+      /// @param [in] sourceIdentifier Opaque source identifier passed to an element mapper.
+      /// @return Opaque identifier of the associated physical controller.
+      static constexpr uint32_t SourceControllerIdentifierFromSourceIdentifier(
+          uint32_t sourceIdentifier)
+      {
+        return (sourceIdentifier >> 8);
       }
 
       /// Returns a copy of this mapper's element map.
@@ -245,8 +520,20 @@ namespace Xidi
         return elements;
       }
 
+      /// Returns a copy of this mapper's chords.
+      /// Useful for dynamically generating new mappers using this mapper as a template.
+      /// @return Copy of this mapper's chords.
+      TChords CloneChords(void) const;
+
+      /// Returns a read-only reference to this mapper's chords. Primarily useful for testing.
+      /// @return Read-only reference to this mapper's chords.
+      inline const TChords& Chords(void) const
+      {
+        return chords;
+      }
+
       /// Returns a read-only reference to this mapper's element map.
-      /// Primarily useful for tests.
+      /// Useful for tests and for selectively cloning parts of the element map.
       /// @return Read-only reference to this mapper's element map.
       inline const UElementMap& ElementMap(void) const
       {
@@ -256,8 +543,9 @@ namespace Xidi
       /// Retrieves and returns the capabilities of the virtual controller layout implemented by the
       /// mapper. Controller capabilities act as metadata that are used internally and can be
       /// presented to applications.
-      /// @return Capabilities of the virtual controller.
-      inline SCapabilities GetCapabilities(void) const
+      /// @return Read-only reference to the capabilities of the virtual controller, which are
+      /// computed once when the mapper is created.
+      inline const SCapabilities& GetCapabilities(void) const
       {
         return capabilities;
       }
@@ -290,11 +578,71 @@ namespace Xidi
       /// Maps from physical controller state to virtual controller state.
       /// Does not apply any properties configured by the application, such as deadzone and range.
       /// @param [in] physicalState Physical controller state from which to read.
+      /// @param [in] transform Compiled extra transformations to apply to raw analog values read
+      /// from the physical controller.
       /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
       /// associated with the state being mapped.
       /// @return Controller state object that was filled as a result of the mapping.
       SState MapStatePhysicalToVirtual(
-          SPhysicalState physicalState, uint32_t sourceControllerIdentifier) const;
+          SPhysicalState physicalState,
+          const SCompiledPhysicalTransform& transform,
+          uint32_t sourceControllerIdentifier) const;
+
+      /// Maps from physical controller state to virtual controller state, compiling the specified
+      /// physical transform profile first. Compilation is expensive, so this version is primarily
+      /// useful for testing.
+      /// @param [in] physicalState Physical controller state from which to read.
+      /// @param [in] transformProfile Extra transformations to apply to raw analog values read
+      /// from the physical controller.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+      /// associated with the state being mapped.
+      /// @return Controller state object that was filled as a result of the mapping.
+      inline SState MapStatePhysicalToVirtual(
+          SPhysicalState physicalState,
+          const SPhysicalTransformProfile& transformProfile,
+          uint32_t sourceControllerIdentifier) const
+      {
+        return MapStatePhysicalToVirtual(
+            physicalState,
+            CompilePhysicalTransformProfile(transformProfile),
+            sourceControllerIdentifier);
+      }
+
+      /// Maps from physical controller state to virtual controller state incrementally. Only the
+      /// element mappers whose physical controller elements changed since the previous mapping are
+      /// invoked, and the contributions of all other element mappers are reused. Element mappers
+      /// with effects outside of the virtual controller state, such as keyboard and mouse element
+      /// mappers, are all invoked together whenever any of them has a changed physical controller
+      /// element, which preserves how keyboard and mouse contributions from multiple sources
+      /// combine without submitting redundant contributions on every mapping. Produces the same
+      /// result as a full mapping. Does not apply any properties configured by the application,
+      /// such as deadzone and range.
+      /// @param [in] physicalState Physical controller state from which to read.
+      /// @param [in] transform Compiled extra transformations to apply to raw analog values read
+      /// from the physical controller.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+      /// associated with the state being mapped.
+      /// @param [in,out] mappingState Incremental mapping state for the physical controller,
+      /// updated to reflect this mapping.
+      /// @return Controller state object that was filled as a result of the mapping.
+      SState MapStatePhysicalToVirtualIncremental(
+          SPhysicalState physicalState,
+          const SCompiledPhysicalTransform& transform,
+          uint32_t sourceControllerIdentifier,
+          SIncrementalMappingState& mappingState) const;
+
+      /// Maps from physical controller state to virtual controller state without applying any
+      /// extra transformations to raw analog values. Primarily useful for testing.
+      /// @param [in] physicalState Physical controller state from which to read.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+      /// associated with the state being mapped.
+      /// @return Controller state object that was filled as a result of the mapping.
+      inline SState MapStatePhysicalToVirtual(
+          SPhysicalState physicalState, uint32_t sourceControllerIdentifier) const
+      {
+        return MapStatePhysicalToVirtual(
+            physicalState, GetDefaultPhysicalTransform(), sourceControllerIdentifier);
+      }
 
       /// Maps from physical controller state to virtual controller state in which the physical
       /// controller is completely neutral and possibly even disconnected. Does not apply any
@@ -306,19 +654,56 @@ namespace Xidi
 
     private:
 
+      /// Evaluates all chords for a physical controller and makes their contributions to the
+      /// specified controller state. Physical controller buttons that belong to a held chord, or
+      /// to a chord that was held at any time since they were pressed, have their values cleared
+      /// so that they do not also contribute through the element map.
+      /// @param [in,out] elementValues Values of all physical controller elements.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+      /// associated with the state being mapped.
+      void ContributeFromChords(
+          TElementValues& elementValues,
+          SState& controllerState,
+          uint32_t sourceControllerIdentifier) const;
+
       /// All controller element mappers.
       const UElementMap elements;
 
+      /// All controller element mappers, compiled into a flat program that is executed whenever
+      /// physical controller state is mapped to virtual controller state. Initialization of this
+      /// member depends on prior initialization of #elements so it must come after.
+      const ElementMapperProgram program;
+
+      /// All chords.
+      const TChords chords;
+
       /// All force feedback actuator mappings.
       const UForceFeedbackActuatorMap forceFeedbackActuators;
 
+      /// All force feedback actuator mappings, lowered into a matrix that is used whenever virtual
+      /// force feedback is mapped to physical actuators. Initialization of this member depends on
+      /// prior initialization of #forceFeedbackActuators so it must come after.
+      const SForceFeedbackActuatorMatrix forceFeedbackActuatorMatrix;
+
       /// Capabilities of the controller described by the element mappers in aggregate.
-      /// Initialization of this member depends on prior initialization of #elements so it
-      /// must come after.
+      /// Initialization of this member depends on prior initialization of #elements and #chords so
+      /// it must come after.
       const SCapabilities capabilities;
 
       /// Name of this mapper.
       const std::wstring_view name;
+
+      /// Optional function that makes the same contributions as #program all at once, or `nullptr`
+      /// if this mapper has no such function.
+      const TSpecializedMapFunc specializedMapFunc;
+
+      /// Physical controller buttons, one set per physical controller, that belong to a chord that
+      /// was held at some point since they were last released. Keeping these from contributing
+      /// through the element map until they are released means that letting go of a chord one
+      /// button at a time does not momentarily press whatever the remaining buttons are normally
+      /// mapped to. Only accessed while mapping the state of the corresponding physical controller.
+      mutable std::array<TElementMapMask, kMaxPhysicalControllerCount> chordLatchedElements;
     };
   } // namespace Controller
 } // namespace Xidi
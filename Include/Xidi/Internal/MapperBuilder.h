@@ -14,7 +14,10 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <set>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "ApiWindows.h"
 #include "ControllerTypes.h"
@@ -42,6 +45,10 @@ namespace Xidi
       /// mapper is built.
       using TForceFeedbackActuatorSpec = std::map<unsigned int, ForceFeedback::SActuatorElement>;
 
+      /// Maps from chord index to chord object.
+      /// Used within a blueprint to describe the chords to be created when the mapper is built.
+      using TChordSpec = std::map<unsigned int, Mapper::SChord>;
+
       /// Holds a description about how to build a single mapper object.
       struct SBlueprint
       {
@@ -63,6 +70,11 @@ namespace Xidi
         /// actuator configuration.
         TForceFeedbackActuatorSpec ffActuatorChangesFromTemplate;
 
+        /// Holds changes in chords to be applied to the template when the mapper is being built.
+        /// For mappers being built from scratch without a template, holds all of the chords. A
+        /// chord that contains no buttons removes the corresponding chord of the template.
+        TChordSpec chordChangesFromTemplate;
+
         /// Flag for specifying if an attempt was made to build the mapper described by this
         /// blueprint. Used to detect dependency cycles due to mappers specifying each other as
         /// templates.
@@ -72,6 +84,15 @@ namespace Xidi
         bool buildCanAttempt = true;
       };
 
+      /// Allows a blueprint held by this object to be built into a mapper object that replaces an
+      /// existing mapper object of the specified name, which would otherwise be a conflict. Until
+      /// the replacement is built, other blueprints that use the existing mapper as a template
+      /// cause the replacement to be built first. Intended for rebuilding mappers whose
+      /// configuration changed while the application is running. The mapper object being
+      /// replaced is not destroyed.
+      /// @param [in] mapperName Name of the mapper that may be replaced.
+      void AllowReplacingMapper(std::wstring_view mapperName);
+
       /// Attempts to build mapper objects based on all of the blueprints known to this mapper
       /// builder object. Once a build attempt is made on a blueprint, that blueprint can no longer
       /// be modified.
@@ -80,18 +101,36 @@ namespace Xidi
 
       /// Attempts to use a blueprint to build a mapper object of the specified name.
       /// Once a build attempt is made on a blueprint, that blueprint can no longer be modified.
-      /// This method will fail if a mapper already exists with the specified name or if there is a
-      /// blueprint template issue. If this method succeeds, then a mapper object was successfully
-      /// created and can now be referenced by name. Any returned pointers are owned by the internal
-      /// mapper registry.
+      /// This method will fail if a mapper already exists with the specified name, unless it is
+      /// allowed to be replaced, or if there is a blueprint template issue. If this method
+      /// succeeds, then a mapper object was successfully created and can now be referenced by
+      /// name. Any returned pointers are owned by the internal mapper registry.
       /// @param [in] mapperName Name that identifies the mapper described by a blueprint.
       /// @return Pointer to the new mapper object if successful, `nullptr` otherwise.
       const Mapper* Build(std::wstring_view mapperName);
 
+      /// Attempts to use a blueprint to build a mapper object of the specified name, but only if
+      /// the blueprint exists and no build attempt has yet been made on it. Unlike building by
+      /// name, nothing is reported if no such blueprint is available. Intended for building mapper
+      /// objects on demand the first time they are requested.
+      /// @param [in] mapperName Name that identifies the mapper described by a blueprint.
+      /// @return Pointer to the new mapper object if successful, `nullptr` otherwise.
+      const Mapper* BuildIfPending(std::wstring_view mapperName);
+
+      /// Checks if every blueprint on which no build attempt has yet been made could be built
+      /// successfully, without building any of them. Only template dependencies are checked,
+      /// because everything else about a blueprint is validated as it is filled in.
+      /// @return `true` if all of the blueprints can be built, `false` otherwise.
+      inline bool CanBuildAll(void) const
+      {
+        return ComputeBuildLevels().has_value();
+      }
+
       /// Deletes all blueprints held by this object, resetting it to a pristine state.
       inline void Clear(void)
       {
         blueprints.clear();
+        replaceableMapperNames.clear();
       }
 
       /// Removes an element mapper from this blueprint's element map specification so it is not
@@ -185,6 +224,34 @@ namespace Xidi
       /// @return `true` if successful, `false` otherwise.
       bool InvalidateBlueprint(std::wstring_view mapperName);
 
+      /// Deletes the blueprint for the specified mapper without building it. If the blueprint was
+      /// going to replace an existing mapper object, then the existing mapper object remains in
+      /// use, including by any blueprints that refer to it as a template.
+      /// @param [in] mapperName Name that identifies the blueprint to delete.
+      /// @return `true` if successful, `false` if no such blueprint exists.
+      bool RemoveBlueprint(std::wstring_view mapperName);
+
+      /// Sets a specific chord to be applied as a modification to the template when this object is
+      /// built into a mapper. If the chord contains no buttons, then the modification to be applied
+      /// to the template is chord removal. This method will fail if the mapper name does not
+      /// identify an existing blueprint or if the chord index is out of bounds.
+      /// @param [in] mapperName Name that identifies the mapper whose chord is being set.
+      /// @param [in] chordIndex Index of the chord within the mapper's chords.
+      /// @param [in] chord Chord to use, which becomes owned by this object.
+      /// @return `true` if successful, `false` otherwise.
+      bool SetBlueprintChord(
+          std::wstring_view mapperName, unsigned int chordIndex, Mapper::SChord&& chord);
+
+      /// Convenience wrapper for both parsing a chord name string and applying a chord as a
+      /// template modification. In addition to other reasons why this operation might fail, this
+      /// method will fail if the chord name string cannot be mapped to a valid chord index.
+      /// @param [in] mapperName Name that identifies the mapper whose chord is being set.
+      /// @param [in] chordString String that identifies the chord. Must be null-terminated.
+      /// @param [in] chord Chord to use, which becomes owned by this object.
+      /// @return `true` if successful, `false` otherwise.
+      bool SetBlueprintChord(
+          std::wstring_view mapperName, std::wstring_view chordString, Mapper::SChord&& chord);
+
       /// Sets a specific element mapper to be applied as a modification to the template when this
       /// object is built into a mapper. If `nullptr` is specified, then the modification to be
       /// applied to the template is element mapper removal. Use #ClearBlueprintElementMapper to
@@ -253,8 +320,33 @@ namespace Xidi
 
     private:
 
+      /// Groups all blueprints that have not yet been built into dependency levels, such that
+      /// each blueprint's template is either an existing mapper or a blueprint in an earlier
+      /// level. Blueprints within the same level do not depend on one another. Within each level,
+      /// blueprints appear in the same order as they are stored.
+      /// @return Blueprint names grouped by dependency level, or nothing if any blueprint has a
+      /// template issue that would cause its build to fail.
+      std::optional<std::vector<std::vector<std::wstring_view>>> ComputeBuildLevels(void) const;
+
+      /// Builds mapper objects from a group of blueprints that do not depend on one another. The
+      /// mapper objects are constructed concurrently, but messages are output in the same order
+      /// as the blueprints are supplied. All templates must already exist as mapper objects.
+      /// @param [in] mapperNames Names of the blueprints to build.
+      /// @return `true` if successful in building all of them, `false` otherwise.
+      bool BuildIndependent(std::span<const std::wstring_view> mapperNames);
+
+      /// Determines if the specified name identifies an existing mapper object that this object
+      /// is not going to replace, meaning that it can be used as-is by any blueprint that refers to
+      /// it as a template.
+      /// @param [in] mapperName Name of the mapper to check.
+      /// @return `true` if the existing mapper object is final, `false` otherwise.
+      bool IsMapperNameResolved(std::wstring_view mapperName) const;
+
       /// Holds all known mapper blueprints.
       std::map<std::wstring_view, SBlueprint> blueprints;
+
+      /// Holds the names of existing mappers that blueprints are allowed to replace.
+      std::set<std::wstring_view> replaceableMapperNames;
     };
   } // namespace Controller
 } // namespace Xidi
@@ -41,6 +41,11 @@ namespace Xidi
       using ForceFeedbackActuatorOrError =
           Infra::ValueOrError<ForceFeedback::SActuatorElement, std::wstring>;
 
+      /// Type alias for representing either a chord or an error message.
+      /// Intended to be returned from functions that parse chord strings and can be used to hold
+      /// semantically-rich error messages for the user.
+      using ChordOrError = Infra::ValueOrError<Mapper::SChord, std::wstring>;
+
       /// Holds a partially-separated representation of a string that has been parsed at the very
       /// highest level. This view of the input string is separated into type and parameter
       /// portions. For example, the string "Axis(RotY, +)" would be separated into "Axis" as the
@@ -102,6 +107,13 @@ namespace Xidi
       std::optional<unsigned int> FindForceFeedbackActuatorIndex(
           std::wstring_view ffActuatorString);
 
+      /// Attempts to identify the index within a mapper's chords that corresponds to the chord
+      /// identified by the input string. See "MapperParser.cpp" for strings that will be
+      /// recognized as valid.
+      /// @param [in] chordString String to parse that supposedly identifies a chord.
+      /// @return Chord index, if it could be identified based on the input string.
+      std::optional<unsigned int> FindChordIndex(std::wstring_view chordString);
+
       /// Attempts to build an element mapper using the supplied string.
       /// This is the main entry point intended for use when parsing element mappers from strings.
       /// @param [in] elementMapperString Input string supposedly representing an element mapper.
@@ -118,6 +130,16 @@ namespace Xidi
       ForceFeedbackActuatorOrError ForceFeedbackActuatorFromString(
           std::wstring_view ffActuatorString);
 
+      /// Attempts to build a chord using the supplied string. Chord strings are comma-separated
+      /// lists in which every parameter but the last identifies a physical controller button that
+      /// is part of the chord, and the last parameter is the element mapper that receives a button
+      /// press while the chord is held. Example: "ButtonLB, ButtonA, Keyboard(F5)". At least two
+      /// buttons are required, and sticks and triggers are not allowed.
+      /// This is the main entry point intended for use when parsing chords from strings.
+      /// @param [in] chordString Input string supposedly representing a chord.
+      /// @return Chord object if successful, error message string otherwise.
+      ChordOrError ChordFromString(std::wstring_view chordString);
+
       /// Determines if the specified controller element string is valid and recognized as
       /// identifying a controller element. See "MapperParser.cpp" for strings that will be
       /// recognized as valid.
@@ -138,6 +160,15 @@ namespace Xidi
         return FindForceFeedbackActuatorIndex(ffActuatorString).has_value();
       }
 
+      /// Determines if the specified chord string is valid and recognized as identifying a chord.
+      /// See "MapperParser.cpp" for strings that will be recognized as valid.
+      /// @param [in] chordString String to be checked.
+      /// @return `true` if the input string is recognized, `false` otherwise.
+      inline bool IsChordStringValid(std::wstring_view chordString)
+      {
+        return FindChordIndex(chordString).has_value();
+      }
+
       /// Internal function exposed for testing.
       /// Computes the recursion depth of the specified element mapper string.
       /// Some element mappers contain other embedded element mappers, which introduces a recursive
@@ -219,6 +250,14 @@ namespace Xidi
       /// @return Pointer to the new mapper object if successful, error message string otherwise.
       ElementMapperOrError MakeDigitalAxisMapper(std::wstring_view params);
 
+      /// Internal function exposed for testing.
+      /// Attempts to build a #FilterMapper using the supplied parameters.
+      /// Parameter string should consist of a string identifying the filter type, a number
+      /// specifying the filter strength, and a string representing an element mapper.
+      /// @param [in] params Parameter string.
+      /// @return Pointer to the new mapper object if successful, error message string otherwise.
+      ElementMapperOrError MakeFilterMapper(std::wstring_view params);
+
       /// Internal function exposed for testing.
       /// Attempts to build an #InvertMapper using the supplied parameters.
       /// Parameter string should consist of a string representing an element mapper.
@@ -272,6 +311,14 @@ namespace Xidi
       /// @return Pointer to the new mapper object if successful, error message string otherwise.
       ElementMapperOrError MakeSplitMapper(std::wstring_view params);
 
+      /// Internal function exposed for testing.
+      /// Attempts to build a #TurboMapper using the supplied parameters.
+      /// Parameter string should consist of a number specifying the rate in presses per second and
+      /// a string representing an element mapper.
+      /// @param [in] params Parameter string.
+      /// @return Pointer to the new mapper object if successful, error message string otherwise.
+      ElementMapperOrError MakeTurboMapper(std::wstring_view params);
+
       /// Internal function exposed for testing.
       /// Attempts to build a force feedback actuator description object that matches the default
       /// actuator configuration. No parameters are allowed.
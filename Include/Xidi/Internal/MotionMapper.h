@@ -0,0 +1,102 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MotionMapper.h
+ *   Declaration of functionality for mapping physical controller motion to virtual controller
+ *   elements and to the virtual mouse.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    /// Maps physical controller motion to virtual controller elements. Each axis of rotation is
+    /// converted to an analog value proportional to its angular velocity and then sent to an
+    /// element mapper, so that the usual element mappers determine the destination. For example, a
+    /// mouse axis mapper turns the controller into a pointing device and an axis mapper makes it
+    /// behave like an analog stick. Motion is mapped separately from, and in addition to, the
+    /// element map of the mapper that handles the rest of the physical controller.
+    class MotionMapper
+    {
+    public:
+
+      /// Element mappers to which motion is sent, one per axis of rotation. Axes whose element
+      /// mapper is `nullptr` are ignored.
+      using TAxisMappers = std::array<
+          std::unique_ptr<const IElementMapper>,
+          static_cast<int>(EPhysicalMotionAxis::Count)>;
+
+      /// Default angular velocity, in degrees per second, that produces an extreme analog value.
+      static constexpr unsigned int kDefaultFullScaleDegreesPerSecond = 360;
+
+      /// Creates a motion mapper.
+      /// @param [in] axisMappers Element mappers to which motion is sent, one per axis.
+      /// @param [in] fullScaleDegreesPerSecond Angular velocity, in degrees per second, that
+      /// produces an extreme analog value. Faster motion saturates.
+      MotionMapper(TAxisMappers&& axisMappers, unsigned int fullScaleDegreesPerSecond);
+
+      /// Computes the average angular velocity represented by a batch of motion sensor readings,
+      /// weighting each reading by the time that elapsed since the reading before it. Performs no
+      /// floating-point operations.
+      /// @param [in] samples Motion sensor readings, oldest first.
+      /// @param [in,out] previousTimestamp Timestamp of the reading that came before the batch, or
+      /// 0 if there was none. Updated to the timestamp of the last reading in the batch.
+      /// @return Integrated motion, which is all zero if the batch is empty.
+      static SPhysicalMotion IntegrateSamples(
+          std::span<const SPhysicalMotionSample> samples, int64_t& previousTimestamp);
+
+      /// Computes the opaque source identifier to be used for contributions of the specified axis.
+      /// These never collide with the source identifiers used for the element map of a mapper.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller.
+      /// @param [in] axis Axis of rotation.
+      /// @return Opaque source identifier.
+      static uint32_t SourceIdentifierForAxis(
+          uint32_t sourceControllerIdentifier, EPhysicalMotionAxis axis);
+
+      /// Retrieves the element mapper to which motion about the specified axis is sent.
+      /// @param [in] axis Axis of rotation.
+      /// @return Read-only pointer to the element mapper, which may be `nullptr`.
+      inline const IElementMapper* GetAxisMapper(EPhysicalMotionAxis axis) const
+      {
+        return axisMappers[static_cast<int>(axis)].get();
+      }
+
+      /// Converts physical controller motion to analog values and contributes them to the
+      /// specified virtual controller state through the element mappers held by this object.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] motion Integrated physical controller motion.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller.
+      void ContributeFromMotion(
+          SState& controllerState,
+          const SPhysicalMotion& motion,
+          uint32_t sourceControllerIdentifier) const;
+
+      /// Makes a neutral contribution through all of the element mappers held by this object.
+      /// @param [in,out] controllerState Controller state data structure to be updated.
+      /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller.
+      void ContributeNeutral(SState& controllerState, uint32_t sourceControllerIdentifier) const;
+
+    private:
+
+      /// Element mappers to which motion is sent, one per axis of rotation.
+      const TAxisMappers axisMappers;
+
+      /// Angular velocity, in physical motion units, that produces an extreme analog value.
+      const int32_t fullScaleMotionUnits;
+    };
+  } // namespace Controller
+} // namespace Xidi
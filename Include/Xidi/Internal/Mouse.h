@@ -14,11 +14,14 @@
 
 #include <cstdint>
 
+#include "ApiXidi.h"
+
 namespace Xidi
 {
   namespace Mouse
   {
-    /// Number of milliseconds to wait between physical mouse update attempts.
+    /// Default number of milliseconds to wait between physical mouse update attempts. Can be
+    /// overridden using the configuration file.
     inline constexpr unsigned int kMouseUpdatePeriodMilliseconds = 7;
 
     /// Maximum number of internal units of mouse motion, which represents extreme motion in the
@@ -79,6 +82,21 @@ namespace Xidi
       Count
     };
 
+    /// Retrieves statistics about the mouse input that has been submitted to the system.
+    /// @return Snapshot of the mouse emitter's statistics.
+    Api::IInputEmissionStatistics::SStatistics GetEmissionStatistics(void);
+
+    /// Begins a batch of mouse state submissions on the calling thread. Until the matching call to
+    /// #EndSubmissionBatch, mouse button and mouse movement submissions made by the calling thread
+    /// are collected rather than committed individually, and they are then committed to the
+    /// virtual mouse all at once. Batches can be nested, in which case only the outermost batch
+    /// commits.
+    void BeginSubmissionBatch(void);
+
+    /// Ends a batch of mouse state submissions on the calling thread. If this ends the outermost
+    /// batch, then all collected mouse state submissions are committed to the virtual mouse.
+    void EndSubmissionBatch(void);
+
     /// Submits a mouse button state of pressed.
     /// @param [in] button Mouse button that is affected.
     void SubmitMouseButtonPressedState(EMouseButton button);
@@ -93,5 +111,24 @@ namespace Xidi
     /// mouse axis.
     /// @param [in] sourceIdentifier Opaque identifier for the source of the mouse movement event.
     void SubmitMouseMovement(EMouseAxis axis, int mouseMovementUnits, uint32_t sourceIdentifier);
+
+    /// Scoped wrapper around a batch of mouse state submissions on the calling thread. The batch
+    /// begins when this object is created and ends when it is destroyed.
+    class ScopedSubmissionBatch
+    {
+    public:
+
+      inline ScopedSubmissionBatch(void)
+      {
+        BeginSubmissionBatch();
+      }
+
+      ScopedSubmissionBatch(const ScopedSubmissionBatch& other) = delete;
+
+      inline ~ScopedSubmissionBatch(void)
+      {
+        EndSubmissionBatch();
+      }
+    };
   } // namespace Mouse
 } // namespace Xidi
@@ -0,0 +1,136 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PeriodicTimer.h
+ *   Declaration of a timer for driving periodic work against fixed deadlines.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ApiWindows.h"
+
+namespace Xidi
+{
+  /// Drives periodic work by waiting until fixed, evenly-spaced deadlines rather than sleeping for
+  /// a fixed amount of time after work completes. This way the time spent doing work does not
+  /// accumulate into the period and jitter remains bounded. If possible, a high-resolution waitable
+  /// timer is used so that periods as short as 1 ms are honored independently of the system timer
+  /// resolution. Not concurrency-safe, so each thread that performs periodic work is expected to
+  /// own its own instance.
+  class PeriodicTimer
+  {
+  public:
+
+    /// Creates a periodic timer with the specified period.
+    /// @param [in] periodMilliseconds Desired period in milliseconds. Values of 0 are treated as 1.
+    /// @param [in] preferHighResolution Whether or not a high-resolution waitable timer should be
+    /// used if the system supports it.
+    PeriodicTimer(unsigned int periodMilliseconds, bool preferHighResolution = true);
+
+    PeriodicTimer(const PeriodicTimer& other) = delete;
+
+    ~PeriodicTimer(void);
+
+    /// Retrieves and returns the current time in the same units this timer uses internally.
+    /// @return Current performance counter value.
+    static int64_t Now(void);
+
+    /// Converts a duration in microseconds to the units this timer uses internally.
+    /// @param [in] microseconds Duration in microseconds.
+    /// @return Equivalent number of performance counter ticks.
+    static int64_t TicksFromMicroseconds(int64_t microseconds);
+
+    /// Converts a duration in the units this timer uses internally to microseconds.
+    /// @param [in] ticks Number of performance counter ticks.
+    /// @return Equivalent number of microseconds.
+    static int64_t MicrosecondsFromTicks(int64_t ticks);
+
+    /// Retrieves and returns the next deadline of this timer.
+    /// @return Performance counter value of the next deadline, or 0 if there is no deadline yet.
+    inline int64_t GetNextDeadline(void) const
+    {
+      return nextDeadline;
+    }
+
+    /// Retrieves and returns the period of this timer.
+    /// @return Period in milliseconds.
+    inline unsigned int GetPeriodMilliseconds(void) const
+    {
+      return periodMilliseconds;
+    }
+
+    /// Retrieves and returns the period of this timer in the units it uses internally.
+    /// @return Period in performance counter ticks.
+    inline int64_t GetPeriodTicks(void) const
+    {
+      return periodTicks;
+    }
+
+    /// Determines if this timer is backed by a high-resolution waitable timer.
+    /// @return `true` if so, `false` otherwise.
+    inline bool IsHighResolution(void) const
+    {
+      return isHighResolution;
+    }
+
+    /// Discards the current deadline so that the next wait is a full period from the time it is
+    /// requested. Useful after the owning thread intentionally pauses for longer than a period.
+    inline void Reset(void)
+    {
+      nextDeadline = 0;
+    }
+
+    /// Changes the period of this timer. Takes effect starting with the next deadline.
+    /// @param [in] newPeriodMilliseconds New period in milliseconds. Values of 0 are treated as 1.
+    void SetPeriodMilliseconds(unsigned int newPeriodMilliseconds);
+
+    /// Changes the period of this timer with finer granularity than whole milliseconds. Takes
+    /// effect starting with the next deadline.
+    /// @param [in] newPeriodTicks New period in performance counter ticks. Values less than 1 are
+    /// treated as 1.
+    void SetPeriodTicks(int64_t newPeriodTicks);
+
+    /// Moves the next deadline, and therefore the phase of all subsequent deadlines, by the
+    /// specified amount. Has no effect if there is no deadline yet.
+    /// @param [in] ticks Number of performance counter ticks by which to move the next deadline,
+    /// which may be negative to move it earlier.
+    inline void ShiftNextDeadline(int64_t ticks)
+    {
+      if (0 != nextDeadline) nextDeadline += ticks;
+    }
+
+    /// Blocks until the next deadline. If the deadline has already passed then this method returns
+    /// immediately. Any whole periods that were missed completely are skipped rather than made up,
+    /// which prevents bursts of back-to-back iterations after the calling thread is delayed.
+    /// @return Number of whole periods that were skipped.
+    unsigned int WaitForNextPeriod(void);
+
+  private:
+
+    /// Blocks for the specified number of performance counter ticks.
+    /// @param [in] ticks Number of ticks for which to block.
+    void WaitTicks(int64_t ticks);
+
+    /// Period in milliseconds, as requested.
+    unsigned int periodMilliseconds;
+
+    /// Period converted to performance counter ticks.
+    int64_t periodTicks;
+
+    /// Performance counter value of the next deadline, or 0 if there is no deadline yet.
+    int64_t nextDeadline;
+
+    /// Handle of the underlying waitable timer object. May be `NULL` if waitable timer creation
+    /// failed, in which case the timer falls back to coarse sleeps.
+    HANDLE timerHandle;
+
+    /// Whether or not the underlying waitable timer object is high-resolution.
+    bool isHighResolution;
+  };
+} // namespace Xidi
@@ -11,44 +11,137 @@
 
 #pragma once
 
+#include <span>
 #include <stop_token>
 
 #include "ApiWindows.h"
+#include "ApiXidi.h"
+#include "ConcurrencyWrapper.h"
 #include "ControllerTypes.h"
 #include "ForceFeedbackDevice.h"
+#include "Mapper.h"
 #include "VirtualController.h"
 
 namespace Xidi
 {
   namespace Controller
   {
-    /// Number of milliseconds to wait between polling attempts.
+    /// Default number of milliseconds to wait between polling attempts. Can be overridden using the
+    /// configuration file.
     inline constexpr unsigned int kPhysicalPollingPeriodMilliseconds = 5;
 
-    /// Number of milliseconds to wait between force feedback actuation passes.
+    /// Default number of milliseconds to wait between force feedback actuation passes. Can be
+    /// overridden using the configuration file.
     inline constexpr unsigned int kPhysicalForceFeedbackPeriodMilliseconds = 5;
 
+    /// Default number of milliseconds to wait between polling attempts while this process does not
+    /// have input focus. Can be overridden using the configuration file.
+    inline constexpr unsigned int kPhysicalBackgroundPollingPeriodMilliseconds = 100;
+
+    /// Default number of seconds to wait between queries of physical controller battery and
+    /// capabilities information. Can be overridden using the configuration file.
+    inline constexpr unsigned int kPhysicalControllerStatusPeriodSeconds = 10;
+
     /// Number of milliseconds to wait between attempts to communicate with the physical hardware if
     /// the last attempt resulted in an error, such as the controller being disconnected.
     inline constexpr unsigned int kPhysicalErrorBackoffPeriodMilliseconds = 100;
 
+    /// Maximum number of milliseconds to wait between attempts to communicate with physical
+    /// hardware that is not connected. Starting from the error back-off period, the wait time
+    /// doubles after each attempt that finds no hardware, up to this limit. Device arrival
+    /// notifications from the system cut the wait short.
+    inline constexpr unsigned int kPhysicalDisconnectedBackoffMaximumMilliseconds = 2000;
+
+    /// Minimum number of milliseconds between polls of the same physical controller requested on
+    /// demand by applications. Requests made sooner than this after the previous poll are satisfied
+    /// by the result of that poll.
+    inline constexpr unsigned int kPhysicalOnDemandPollMinimumIntervalMilliseconds = 1;
+
+    /// Number of milliseconds between checks, in cooperative mode, for physical controllers that
+    /// the application has stopped servicing by reading their state. Any such physical controller
+    /// is serviced at this rate until the application resumes.
+    inline constexpr unsigned int kPhysicalCooperativeWatchdogPeriodMilliseconds = 100;
+
+    /// Retrieves and returns the number of physical controllers that are supported, which can be
+    /// customized in the configuration file. Valid controller identifiers are all less than this
+    /// value, which is never more than #kMaxPhysicalControllerCount. Concurrency-safe.
+    /// @return Number of supported physical controllers.
+    TControllerIdentifier GetPhysicalControllerCount(void);
+
+    /// Determines if the specified physical controller is enabled, which can be customized in the
+    /// configuration file. Disabled physical controllers are never polled, mapped, or actuated, and
+    /// they are always reported as not connected. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return `true` if the identifier is valid and the physical controller is enabled, `false`
+    /// otherwise.
+    bool IsPhysicalControllerEnabled(TControllerIdentifier controllerIdentifier);
+
+    /// Retrieves and returns the number of milliseconds between force feedback actuation passes,
+    /// which can be customized in the configuration file. Concurrency-safe.
+    /// @return Force feedback actuation period in milliseconds.
+    unsigned int GetForceFeedbackPeriodMilliseconds(void);
+
     /// Retrieves and returns the capabilities of the controller layout implemented by the mapper
     /// associated with the specified physical controller. Controller capabilities act as metadata
     /// that are used internally and can be presented to applications. Concurrency-safe.
     /// @return Capabilities associated with the specified physical controller.
     SCapabilities GetControllerCapabilities(TControllerIdentifier controllerIdentifier);
 
+    /// Retrieves and returns the mapper currently used for the specified physical controller.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return Pointer to the mapper, which is never destroyed and is always valid.
+    const Mapper* GetControllerMapper(TControllerIdentifier controllerIdentifier);
+
     /// Retrieves the instantaneous physical state of the specified controller. Concurrency-safe.
     /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
     /// @return Physical controller state data.
     SPhysicalState GetCurrentPhysicalControllerState(TControllerIdentifier controllerIdentifier);
 
+    /// Retrieves the instantaneous physical state of the specified controller, along with a
+    /// generation number that identifies that state. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [out] generation Filled in with the generation number of the returned state.
+    /// @return Physical controller state data.
+    SPhysicalState GetCurrentPhysicalControllerState(
+        TControllerIdentifier controllerIdentifier, TGeneration& generation);
+
     /// Retrieves the instantaneous raw state of the specified controller after it is mapped to a
     /// virtual state but without any further processing. Concurrency-safe.
     /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
     /// @return Raw virtual controller state data.
     SState GetCurrentRawVirtualControllerState(TControllerIdentifier controllerIdentifier);
 
+    /// Retrieves read-only access to the exported state blocks of all physical controllers, which
+    /// are updated whenever physical controller state changes and remain valid for the lifetime of
+    /// the process. Concurrency-safe.
+    /// @return Read-only view of the exported state blocks, one per physical controller.
+    std::span<const Api::IStateExport::SStateBlock> GetExportedStateBlocks(void);
+
+    /// Retrieves the instantaneous raw state of the specified controller after it is mapped to a
+    /// virtual state but without any further processing, along with a generation number that
+    /// identifies that state. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [out] generation Filled in with the generation number of the returned state.
+    /// @return Raw virtual controller state data.
+    SState GetCurrentRawVirtualControllerState(
+        TControllerIdentifier controllerIdentifier, TGeneration& generation);
+
+    /// Retrieves the generation number of the instantaneous raw virtual state of the specified
+    /// controller, without retrieving the state itself. Comparing it with a generation number
+    /// previously obtained from #GetCurrentRawVirtualControllerState is enough to determine if the
+    /// state has changed since. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return Generation number of the current raw virtual controller state.
+    TGeneration GetCurrentRawVirtualControllerStateGeneration(
+        TControllerIdentifier controllerIdentifier);
+
+    /// Discards the mapper cached for the specified physical controller and resolves it again from
+    /// the configuration. Equivalent to setting the configured mapper using
+    /// #SetControllerMapper. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    void InvalidateConfiguredMapper(TControllerIdentifier controllerIdentifier);
+
     /// Attempts to register the specified virtual controller for force feedback with the specified
     /// physical controller. Concurrency-safe.
     /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
@@ -66,6 +159,145 @@ namespace Xidi
     void PhysicalControllerForceFeedbackUnregister(
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController);
 
+    /// Recomputes the overall gain applied to force feedback effects played on the specified
+    /// physical controller. Intended to be invoked whenever a virtual controller registered for
+    /// force feedback changes its force feedback gain property. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    void PhysicalControllerForceFeedbackRefreshGain(TControllerIdentifier controllerIdentifier);
+
+    /// Registers the specified virtual controller to receive raw virtual state updates from the
+    /// specified physical controller. Registered virtual controllers have their state refreshed
+    /// directly by the thread that polls the physical controller, so they do not need a thread of
+    /// their own. As part of registration the virtual controller's state is refreshed using the
+    /// current raw virtual state. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] virtualController Pointer to the virtual controller of interest.
+    /// @return `true` if registration succeeded, `false` if the parameters are invalid.
+    bool PhysicalControllerStateChangeRegister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController);
+
+    /// Unregisters the specified virtual controller from receiving raw virtual state updates if it
+    /// is currently registered with the specified physical controller. Once this function returns,
+    /// the virtual controller is guaranteed not to receive any further updates. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] virtualController Pointer to the virtual controller of interest.
+    void PhysicalControllerStateChangeUnregister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController);
+
+    /// Subscribes the specified callback function for notifications whenever the state of the
+    /// specified physical controller changes. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] callback Function to invoke on every state change.
+    /// @param [in] context Opaque value to pass to the callback function.
+    /// @return `true` if successful, `false` if the parameters are invalid or the callback function
+    /// is already subscribed with the same context.
+    bool PhysicalControllerStateChangeSubscribe(
+        TControllerIdentifier controllerIdentifier,
+        Api::IStateChangeSubscription::TStateChangeCallback callback,
+        void* context);
+
+    /// Removes the subscription of the specified callback function for notifications of state
+    /// changes of the specified physical controller, if it exists. Upon return the callback
+    /// function is guaranteed not to be executing for this subscription. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] callback Function that was subscribed.
+    /// @param [in] context Opaque value that was supplied when subscribing.
+    /// @return `true` if the subscription existed and was removed, `false` otherwise.
+    bool PhysicalControllerStateChangeUnsubscribe(
+        TControllerIdentifier controllerIdentifier,
+        Api::IStateChangeSubscription::TStateChangeCallback callback,
+        void* context);
+
+    /// Informs the physical controller layer that the application just read virtual controller
+    /// state derived from the specified physical controller. If polling alignment is enabled, the
+    /// timing of these reads is used to schedule polls shortly before the application is expected
+    /// to read again. Otherwise this function does nothing. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    void NotifyApplicationStateRead(TControllerIdentifier controllerIdentifier);
+
+    /// Informs the physical controller layer that the application just obtained virtual controller
+    /// state derived from the specified physical controller, either as a snapshot or as buffered
+    /// events. If input latency tracing is enabled, the first such notification after each change
+    /// in state completes the measurement of how long that change took to reach the application.
+    /// Otherwise this function does nothing. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    void NotifyApplicationStateObserved(TControllerIdentifier controllerIdentifier);
+
+    /// Registers a request, made by the application through a virtual controller, to poll the
+    /// specified physical controller with the specified period. Requests made through all virtual
+    /// controllers are arbitrated so that the shortest requested period wins, although no request
+    /// makes polling less frequent than the configured polling period. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] periodMilliseconds Requested polling period, in milliseconds.
+    void RequestPollingPeriod(
+        TControllerIdentifier controllerIdentifier, unsigned int periodMilliseconds);
+
+    /// Withdraws a request previously registered using #RequestPollingPeriod. Once the last
+    /// outstanding request for a physical controller is withdrawn, it is again polled using the
+    /// configured polling period. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] periodMilliseconds Polling period that was requested, in milliseconds.
+    void WithdrawPollingPeriodRequest(
+        TControllerIdentifier controllerIdentifier, unsigned int periodMilliseconds);
+
+    /// Retrieves the polling period currently in effect for the specified physical controller,
+    /// taking into account all outstanding application requests. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return Polling period in milliseconds.
+    unsigned int GetEffectivePollingPeriodMilliseconds(TControllerIdentifier controllerIdentifier);
+
+    /// Determines if the controller status service, which queries battery and capabilities
+    /// information for all physical controllers at a low rate and caches the results, is enabled.
+    /// @return `true` if so, `false` if not.
+    bool IsControllerStatusServiceEnabled(void);
+
+    /// Retrieves the battery and capabilities information most recently queried for the specified
+    /// physical controller by the controller status service. Starts the controller status service
+    /// the first time it is invoked, so queries only happen if something reads their results.
+    /// Never issues any queries itself. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return Cached battery and capabilities information, which indicates that no query has
+    /// happened yet if the controller status service was just started or is disabled.
+    Api::IControllerStatus::SControllerStatus GetControllerStatus(
+        TControllerIdentifier controllerIdentifier);
+
+    /// Polls the specified physical controller immediately on the calling thread, rather than
+    /// waiting for the next periodic poll, and publishes the result to all registered virtual
+    /// controllers. Rate-limited, so this function does nothing if the physical controller was
+    /// polled very recently, and it also does nothing if the physical controller is not connected.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return `true` if a poll was performed, `false` otherwise.
+    bool PollPhysicalControllerOnDemand(TControllerIdentifier controllerIdentifier);
+
+    /// Services the specified physical controller on the calling thread if cooperative mode is
+    /// enabled, in which case no threads exist to do so. Polls the physical controller once its
+    /// polling period, or its back-off period if it is not connected, has elapsed since the
+    /// previous poll, and performs a force feedback actuation pass once the force feedback
+    /// actuation period has elapsed since the previous one. Intended to be invoked whenever the
+    /// application reads virtual controller state derived from the specified physical controller.
+    /// Does nothing if cooperative mode is disabled or if another thread is already servicing the
+    /// same physical controller. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    void ServicePhysicalControllerCooperatively(TControllerIdentifier controllerIdentifier);
+
+    /// Performs all of the one-time work that would otherwise happen the first time any physical
+    /// controller is accessed, including loading the native XInput library, reading the initial
+    /// state of each physical controller, and starting all worker threads. Returns once that work
+    /// is complete. Concurrency-safe.
+    void PrewarmPhysicalControllers(void);
+
+    /// Replaces the mapper used for the specified physical controller while the application is
+    /// running. The new mapper is published without blocking the threads that poll the physical
+    /// controller or actuate its force feedback, and each of them picks it up before its next use.
+    /// Any single virtual controller state is always produced entirely by one mapper. Before the
+    /// new mapper is first used, the previous mapper withdraws any keyboard or mouse contributions
+    /// it was making. Virtual controllers that already exist keep the capabilities they were
+    /// created with. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] mapper Mapper to use, which the caller must guarantee is never destroyed.
+    void SetControllerMapper(TControllerIdentifier controllerIdentifier, const Mapper* mapper);
+
     /// Waits for the specified physical controller's state to change. When it does, retrieves and
     /// returns the new state. This function is fully concurrency-safe. If needed, the caller can
     /// interrupt the wait using a stop token.
@@ -97,5 +329,23 @@ namespace Xidi
         TControllerIdentifier controllerIdentifier,
         SState& state,
         std::stop_token stopToken = std::stop_token());
+
+    /// Waits for the specified physical controller's raw virtual state to change, using generation
+    /// numbers rather than state comparisons to detect the change. When it does, retrieves and
+    /// returns the new state. This function is fully concurrency-safe. If needed, the caller can
+    /// interrupt the wait using a stop token.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [out] state Filled in with the updated state of the physical controller.
+    /// @param [in,out] generation On input, generation number of the last-known state for the
+    /// calling thread. On output, filled in with the generation number of the updated state.
+    /// @param [in] stopToken Token that allows the wait to be interrupted. Defaults to an empty
+    /// token that does not allow interruption.
+    /// @return `true` if the wait succeeded and the output structure was updated, `false` if no
+    /// updates were made due to invalid parameter or interrupted wait.
+    bool WaitForRawVirtualControllerStateChange(
+        TControllerIdentifier controllerIdentifier,
+        SState& state,
+        TGeneration& generation,
+        std::stop_token stopToken = std::stop_token());
   } // namespace Controller
 } // namespace Xidi
@@ -0,0 +1,116 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PhysicalControllerBackend.h
+ *   Declaration of the interface through which physical controllers are read and actuated, along
+ *   with the available implementations of it.
+ **************************************************************************************************/
+
+#pragma once
+
+// XInput header files depend on Windows header files, which are are sensitive to include order.
+// See "ApiWindows.h" for more information.
+
+// clang-format off
+
+#include "ApiWindows.h"
+#include <xinput.h>
+
+// clang-format on
+
+#include <cstdint>
+#include <span>
+
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    /// Interface for a system API that reads physical controller state and writes physical
+    /// controller vibration. State is exchanged using XInput data structures and result codes
+    /// regardless of the API in use, so that state sharing, trace recording, and statistics all
+    /// work the same way with every backend.
+    class IPhysicalControllerBackend
+    {
+    public:
+
+      virtual ~IPhysicalControllerBackend(void) = default;
+
+      /// Retrieves a short human-readable name for this backend, for use in log messages.
+      /// @return Backend name.
+      virtual const wchar_t* GetName(void) const = 0;
+
+      /// Reads the current state of a physical controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller to read.
+      /// @param [in] includeGuideButton Whether or not the Guide button should be reported, if
+      /// this backend is capable of doing so.
+      /// @param [out] xinputState Filled in with the state of the physical controller. Only
+      /// meaningful if the read succeeded.
+      /// @param [out] readingTimestamp Filled in with the performance counter value at which the
+      /// underlying hardware reading was taken, or 0 if this backend does not know.
+      /// @return XInput result code, either `ERROR_SUCCESS` or an error code.
+      virtual DWORD ReadState(
+          TControllerIdentifier controllerIdentifier,
+          bool includeGuideButton,
+          XINPUT_STATE& xinputState,
+          int64_t& readingTimestamp) = 0;
+
+      /// Retrieves all motion sensor readings received from a physical controller since the
+      /// previous invocation, oldest first, up to the capacity of the supplied buffer. Readings
+      /// that do not fit are discarded. Backends that cannot read motion sensors do not override
+      /// this method, and none of the currently-available backends can.
+      /// @param [in] controllerIdentifier Identifier of the physical controller to read.
+      /// @param [out] samples Buffer to be filled in with motion sensor readings.
+      /// @return Number of readings written to the buffer.
+      virtual unsigned int ReadMotion(
+          TControllerIdentifier controllerIdentifier, std::span<SPhysicalMotionSample> samples)
+      {
+        return 0;
+      }
+
+      /// Writes vibration values to all of the force feedback actuators of a physical controller.
+      /// Backends silently ignore any actuators they do not support.
+      /// @param [in] controllerIdentifier Identifier of the physical controller to actuate.
+      /// @param [in] vibration Physical actuator values, already scaled for output.
+      /// @return XInput result code, either `ERROR_SUCCESS` or an error code.
+      virtual DWORD WriteVibration(
+          TControllerIdentifier controllerIdentifier,
+          ForceFeedback::SPhysicalActuatorComponents vibration) = 0;
+    };
+
+    namespace PhysicalControllerBackend
+    {
+      /// Function invoked whenever a backend detects that a physical controller was connected.
+      using TArrivalCallback = void (*)(void);
+
+      /// Function invoked whenever a backend receives new state for a physical controller.
+      using TReportCallback = void (*)(TControllerIdentifier);
+
+      /// Retrieves the backend that uses the XInput library, which is always available.
+      /// @return Reference to the XInput backend object.
+      IPhysicalControllerBackend& XInput(void);
+
+      /// Attempts to create the backend that uses the `Windows.Gaming.Input` gamepad API, which
+      /// is event-driven and supports impulse triggers. Requires Windows 10 or later. The created
+      /// object, if any, is never destroyed.
+      /// @param [in] arrivalCallback Function to invoke whenever a gamepad is connected.
+      /// @return Pointer to the backend object, or `nullptr` if it could not be created.
+      IPhysicalControllerBackend* CreateWindowsGamingInput(TArrivalCallback arrivalCallback);
+
+      /// Attempts to create the backend that receives HID input reports through the Raw Input API
+      /// on a dedicated thread, which delivers each state change as soon as the report arrives.
+      /// Only reads XInput-compatible controllers. The created object, if any, is never destroyed.
+      /// @param [in] arrivalCallback Function to invoke whenever a controller is connected.
+      /// @param [in] reportCallback Function to invoke whenever a controller reports new state.
+      /// @return Pointer to the backend object, or `nullptr` if it could not be created.
+      IPhysicalControllerBackend* CreateRawInput(
+          TArrivalCallback arrivalCallback, TReportCallback reportCallback);
+    } // namespace PhysicalControllerBackend
+  } // namespace Controller
+} // namespace Xidi
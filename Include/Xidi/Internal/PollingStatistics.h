@@ -0,0 +1,79 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PollingStatistics.h
+ *   Declaration of statistics about how physical controller polling is scheduled and how long
+ *   each part of a poll takes.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace PollingStatistics
+    {
+      /// Type used to report statistics.
+      using SStatistics = Api::IPollingStatistics::SStatistics;
+
+      /// Retrieves a snapshot of the statistics for the specified physical controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @return Statistics for the physical controller, which are empty if the identifier is out
+      /// of range.
+      SStatistics GetStatistics(TControllerIdentifier controllerIdentifier);
+
+      /// Records the system timer resolution that was successfully requested at startup.
+      /// @param [in] resolutionMilliseconds System timer resolution, in milliseconds.
+      void RecordSystemTimerResolution(unsigned int resolutionMilliseconds);
+
+      /// Records how the polling thread for the specified physical controller schedules polls.
+      /// Only that polling thread should invoke this function.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] periodTicks Configured polling period, in performance counter ticks.
+      /// @param [in] isHighResolution Whether or not polls are scheduled using a high-resolution
+      /// waitable timer.
+      void RecordTimerConfiguration(
+          TControllerIdentifier controllerIdentifier, int64_t periodTicks, bool isHighResolution);
+
+      /// Records the outcome of the polling thread waiting for the next scheduled poll of the
+      /// specified physical controller. Only that polling thread should invoke this function.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] pollTicks Performance counter value when the wait completed.
+      /// @param [in] previousPollTicks Performance counter value when the previous wait completed,
+      /// or 0 if the previous poll was not on the same schedule, in which case no interval is
+      /// recorded.
+      /// @param [in] skippedPeriods Number of whole polling periods skipped by the wait.
+      void RecordScheduledPoll(
+          TControllerIdentifier controllerIdentifier,
+          int64_t pollTicks,
+          int64_t previousPollTicks,
+          unsigned int skippedPeriods);
+
+      /// Records the duration of a single XInput state query for the specified physical
+      /// controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] beginTicks Performance counter value immediately before the query.
+      /// @param [in] endTicks Performance counter value immediately after the query.
+      void RecordXInputGetState(
+          TControllerIdentifier controllerIdentifier, int64_t beginTicks, int64_t endTicks);
+
+      /// Records how long the mapper took to produce virtual controller state for the specified
+      /// physical controller.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [in] beginTicks Performance counter value immediately before mapping.
+      /// @param [in] endTicks Performance counter value immediately after mapping.
+      void RecordMapping(
+          TControllerIdentifier controllerIdentifier, int64_t beginTicks, int64_t endTicks);
+    } // namespace PollingStatistics
+  } // namespace Controller
+} // namespace Xidi
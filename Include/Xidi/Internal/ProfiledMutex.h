@@ -0,0 +1,180 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ProfiledMutex.h
+ *   Mutex wrapper that optionally measures lock contention. Profiling is enabled at build time by
+ *   defining the preprocessor symbol `XIDI_PROFILE_LOCKS`. Otherwise the wrapper is exactly the
+ *   underlying mutex type and adds no overhead.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Xidi
+{
+  namespace LockProfile
+  {
+    /// Contention statistics collected for all mutex objects that share a name.
+    struct SLockStatistics
+    {
+      /// Number of times the lock was acquired, in any mode.
+      std::atomic<uint64_t> numAcquisitions;
+
+      /// Number of acquisitions that had to wait because the lock was not immediately available.
+      std::atomic<uint64_t> numContendedAcquisitions;
+
+      /// Total time spent waiting for contended acquisitions, in nanoseconds.
+      std::atomic<uint64_t> totalWaitNanoseconds;
+
+      /// Longest time spent waiting for a single contended acquisition, in nanoseconds.
+      std::atomic<uint64_t> maxWaitNanoseconds;
+
+      /// Total time the lock was held in exclusive mode, in nanoseconds.
+      std::atomic<uint64_t> totalHoldNanoseconds;
+
+      /// Longest time the lock was held in exclusive mode at once, in nanoseconds.
+      std::atomic<uint64_t> maxHoldNanoseconds;
+    };
+
+    /// Clock used to measure wait and hold times.
+    using TClock = std::chrono::steady_clock;
+
+    /// Retrieves the statistics object for all mutex objects with the specified name, creating it
+    /// if it does not already exist.
+    /// @param [in] name Name of the lock, which must remain valid for the lifetime of the process.
+    /// @return Pointer to the statistics object, which is never destroyed.
+    SLockStatistics* Register(const wchar_t* name);
+
+    /// Records a single acquisition of a lock.
+    /// @param [in] statistics Statistics object for the lock.
+    /// @param [in] waitTime Time spent waiting for the lock, or zero if the acquisition was not
+    /// contended.
+    void RecordAcquisition(SLockStatistics* statistics, TClock::duration waitTime);
+
+    /// Records a single release of a lock that was held in exclusive mode.
+    /// @param [in] statistics Statistics object for the lock.
+    /// @param [in] holdTime Time for which the lock was held.
+    void RecordRelease(SLockStatistics* statistics, TClock::duration holdTime);
+
+    /// Outputs the statistics collected for all locks as informational messages. Does nothing if
+    /// lock profiling is not enabled at build time.
+    void OutputSummary(void);
+  } // namespace LockProfile
+
+#ifdef XIDI_PROFILE_LOCKS
+  /// Wraps a mutex and measures how long threads wait to acquire it and for how long they hold
+  /// it. Statistics are aggregated across all mutex objects that share the same name.
+  /// Satisfies the same locking requirements as the wrapped mutex type.
+  /// @tparam MutexType Underlying mutex type.
+  template <typename MutexType> class ProfiledMutex
+  {
+  public:
+
+    inline ProfiledMutex(const wchar_t* name)
+        : mutex(), statistics(LockProfile::Register(name)), acquireTime(), recursionDepth(0)
+    {}
+
+    ProfiledMutex(const ProfiledMutex& other) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex& other) = delete;
+
+    inline void lock(void)
+    {
+      if (true == mutex.try_lock())
+      {
+        OnExclusiveAcquired(LockProfile::TClock::duration::zero());
+        return;
+      }
+
+      const auto waitStartTime = LockProfile::TClock::now();
+      mutex.lock();
+      OnExclusiveAcquired(LockProfile::TClock::now() - waitStartTime);
+    }
+
+    inline bool try_lock(void)
+    {
+      if (false == mutex.try_lock()) return false;
+
+      OnExclusiveAcquired(LockProfile::TClock::duration::zero());
+      return true;
+    }
+
+    inline void unlock(void)
+    {
+      recursionDepth -= 1;
+      if (0 == recursionDepth)
+        LockProfile::RecordRelease(statistics, LockProfile::TClock::now() - acquireTime);
+
+      mutex.unlock();
+    }
+
+    inline void lock_shared(void)
+    {
+      if (true == mutex.try_lock_shared())
+      {
+        LockProfile::RecordAcquisition(statistics, LockProfile::TClock::duration::zero());
+        return;
+      }
+
+      const auto waitStartTime = LockProfile::TClock::now();
+      mutex.lock_shared();
+      LockProfile::RecordAcquisition(statistics, LockProfile::TClock::now() - waitStartTime);
+    }
+
+    inline bool try_lock_shared(void)
+    {
+      if (false == mutex.try_lock_shared()) return false;
+
+      LockProfile::RecordAcquisition(statistics, LockProfile::TClock::duration::zero());
+      return true;
+    }
+
+    inline void unlock_shared(void)
+    {
+      mutex.unlock_shared();
+    }
+
+  private:
+
+    /// Records an acquisition in exclusive mode, which is also the start of a hold period unless
+    /// the underlying mutex is recursive and was already held by the calling thread.
+    /// @param [in] waitTime Time spent waiting for the lock.
+    inline void OnExclusiveAcquired(LockProfile::TClock::duration waitTime)
+    {
+      if (0 == recursionDepth) acquireTime = LockProfile::TClock::now();
+      recursionDepth += 1;
+
+      LockProfile::RecordAcquisition(statistics, waitTime);
+    }
+
+    /// Underlying mutex.
+    MutexType mutex;
+
+    /// Statistics object shared by all mutex objects with the same name.
+    LockProfile::SLockStatistics* const statistics;
+
+    /// Time at which the current exclusive hold period started. Only accessed by the owner.
+    LockProfile::TClock::time_point acquireTime;
+
+    /// Number of times the owner has acquired the lock in exclusive mode without releasing it.
+    /// Only accessed by the owner.
+    unsigned int recursionDepth;
+  };
+#else
+  /// Identical to the underlying mutex type. Accepts and ignores a name so that declarations are
+  /// the same whether or not lock profiling is enabled.
+  /// @tparam MutexType Underlying mutex type.
+  template <typename MutexType> class ProfiledMutex : public MutexType
+  {
+  public:
+
+    inline ProfiledMutex(const wchar_t*) : MutexType() {}
+  };
+#endif
+} // namespace Xidi
@@ -0,0 +1,164 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file Settings.h
+ *   Declaration of a typed snapshot of the controller-independent settings in the configuration
+ *   file.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ApiDirectInput.h"
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+#include "PhysicalController.h"
+
+namespace Xidi
+{
+  /// Holds the values of controller-independent configuration settings that are consulted
+  /// frequently, converted to the types in which they are used. Produced once, right after the
+  /// configuration file is read. Each field holds the value from the configuration file if it is
+  /// present and the built-in default otherwise, so a default-constructed object represents an
+  /// empty configuration file.
+  struct SSettings
+  {
+    /// Settings from the controller-independent properties section.
+    struct SProperties
+    {
+      /// Whether or not axes in motion are extrapolated when the application retrieves state.
+      bool axisExtrapolation = false;
+
+      /// Physical controller polling period while this process does not have input focus, in
+      /// milliseconds, or 0 to stop polling entirely while in the background.
+      unsigned int backgroundPollingPeriodMilliseconds =
+          Controller::kPhysicalBackgroundPollingPeriodMilliseconds;
+
+      /// Whether or not consecutive axis motion events are coalesced in the event buffer.
+      bool coalesceAxisEvents = false;
+
+      /// Time between queries of physical controller battery and capabilities information, in
+      /// seconds, or 0 to disable the controller status service.
+      unsigned int controllerStatusPeriodSeconds =
+          Controller::kPhysicalControllerStatusPeriodSeconds;
+
+      /// Whether or not physical controllers are serviced on application threads.
+      bool cooperativeMode = false;
+
+      /// Whether or not force feedback output is averaged over each actuation period.
+      bool forceFeedbackAveraging = false;
+
+      /// Physical force feedback actuation period, in milliseconds.
+      unsigned int forceFeedbackPeriodMilliseconds =
+          Controller::kPhysicalForceFeedbackPeriodMilliseconds;
+
+      /// Minimum time between writes to the physical actuators, in milliseconds.
+      DWORD forceFeedbackWritePeriodMilliseconds = 0;
+
+      /// Minimum change in physical actuator values that causes a write, as a percentage of the
+      /// actuator value range.
+      int forceFeedbackWriteThresholdPercent = 0;
+
+      /// Whether or not the Guide button is requested, subject to XInput library support.
+      bool guideButton = false;
+
+      /// Whether or not physical controllers are polled using a high-resolution timer.
+      bool highResolutionPolling = false;
+
+      /// Whether or not application device state buffers are updated incrementally.
+      bool incrementalDeviceState = false;
+
+      /// Whether or not only changed physical controller elements are mapped on each poll.
+      bool incrementalMapping = false;
+
+      /// Whether or not virtual keyboard state is surfaced through the system keyboard device.
+      bool keyboardDirectInput = false;
+
+      /// Virtual keyboard update period, in milliseconds.
+      unsigned int keyboardPeriodMilliseconds = Keyboard::kKeyboardUpdatePeriodMilliseconds;
+
+      /// Time a virtual keyboard key must be held before it repeats, in milliseconds, or 0 if key
+      /// repeat is disabled.
+      unsigned int keyboardRepeatDelayMilliseconds = Keyboard::kKeyboardRepeatDelayMilliseconds;
+
+      /// Time between repeats of a held virtual keyboard key, in milliseconds.
+      unsigned int keyboardRepeatPeriodMilliseconds = Keyboard::kKeyboardRepeatPeriodMilliseconds;
+
+      /// Whether or not virtual keyboard state is submitted at the end of each submission.
+      bool keyboardSynchronous = false;
+
+      /// Virtual mouse update period, in milliseconds.
+      unsigned int mousePeriodMilliseconds = Mouse::kMouseUpdatePeriodMilliseconds;
+
+      /// Whether or not virtual mouse wheel movement is submitted in fractions of a detent.
+      bool mouseWheelHighResolution = false;
+
+      /// Whether or not polling a device or retrieving its state reads the physical controller.
+      bool onDemandPolling = false;
+
+      /// Number of physical controller slots, already clamped to the supported range.
+      Controller::TControllerIdentifier physicalControllerCount =
+          Controller::kDefaultPhysicalControllerCount;
+
+      /// Bit mask of enabled physical controller slots, one bit per slot.
+      uint32_t physicalControllerMask = UINT32_MAX;
+
+      /// Whether or not reading and mapping each physical controller happen on separate threads.
+      bool pipelinedPolling = false;
+
+      /// Whether or not polls are scheduled to land shortly before application reads.
+      bool pollingAlignment = false;
+
+      /// Physical controller polling period, in milliseconds.
+      unsigned int pollingPeriodMilliseconds = Controller::kPhysicalPollingPeriodMilliseconds;
+
+      /// Whether or not physical controller state is shared with other processes.
+      bool sharePhysicalControllerState = false;
+
+      /// Whether or not all physical controllers are serviced by a single scheduler thread.
+      bool singleThreadedPolling = false;
+
+      /// Minimum axis movement that signals a state change event, as a percentage of the axis
+      /// range, or 0 to signal on any change.
+      int64_t stateChangeEventAxisThresholdPercent = 0;
+
+      /// Minimum time between state change events caused by axis movement alone, in milliseconds.
+      DWORD stateChangeEventPeriodMilliseconds = 0;
+
+      /// Maximum analog stick value change that is treated as noise.
+      int stickNoiseThreshold = 0;
+
+      /// Maximum trigger value change that is treated as noise.
+      int triggerNoiseThreshold = 0;
+
+      /// Whether or not built-in properties are applied to mouse movement and WinMM axes.
+      bool useBuiltinProperties = true;
+
+      /// Whether or not game controller enumeration presents only Xidi virtual controllers.
+      bool virtualControllersOnly = false;
+    } properties;
+
+    /// Settings from the workarounds section.
+    struct SWorkarounds
+    {
+      /// Bit mask of virtual controllers presented to the application, one bit per controller.
+      uint64_t activeVirtualControllerMask = UINT64_MAX;
+
+      /// Whether or not object enumeration ignores requests from the callback to stop.
+      bool ignoreEnumObjectsCallbackReturnCode = false;
+
+      /// Return code of the polling method on virtual controllers.
+      DWORD pollReturnCode = DI_NOEFFECT;
+
+      /// Whether or not virtual controllers are given short names.
+      bool useShortVirtualControllerNames = false;
+    } workarounds;
+  };
+} // namespace Xidi
@@ -0,0 +1,55 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file StartupTrace.h
+ *   Declaration of timing measurements for the phases of startup and initialization.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace Xidi
+{
+  namespace StartupTrace
+  {
+    /// Measures how long a single phase of startup takes, from construction to destruction, using
+    /// the performance counter. Phases can be nested within one another on the same thread. Once
+    /// the outermost phase on a thread completes, all of the phases it contains are reported
+    /// together as a single trace.
+    class ScopedPhase
+    {
+    public:
+
+      /// Begins measuring a phase.
+      /// @param [in] phaseName Name of the phase. Must be null-terminated and have static storage
+      /// duration.
+      ScopedPhase(std::wstring_view phaseName);
+
+      ScopedPhase(const ScopedPhase& other) = delete;
+
+      /// Finishes measuring the phase.
+      ~ScopedPhase(void);
+
+    private:
+
+      /// Position of the record for this phase among those belonging to the current thread's
+      /// trace, or `SIZE_MAX` if tracing was already disabled when this phase began.
+      size_t recordIndex;
+    };
+
+    /// Specifies how traces are reported. Until this function is invoked traces are retained so
+    /// that startup phases that complete before the configuration file is read can still be
+    /// reported. If no reporting mechanism is enabled then retained traces are discarded and no
+    /// further phases are measured. Only the first invocation has any effect.
+    /// @param [in] outputToLog Whether or not to output a summary of each trace as informational
+    /// messages.
+    /// @param [in] emitEvents Whether or not to emit each phase as a TraceLogging event.
+    void Configure(bool outputToLog, bool emitEvents);
+  } // namespace StartupTrace
+} // namespace Xidi
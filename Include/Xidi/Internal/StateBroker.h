@@ -0,0 +1,69 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file StateBroker.h
+ *   Declaration of functionality for sharing physical controller state between all processes in
+ *   the same session that use Xidi, such that only one of them queries XInput.
+ **************************************************************************************************/
+
+#pragma once
+
+// XInput header files depend on Windows header files, which are are sensitive to include order.
+// See "ApiWindows.h" for more information.
+
+// clang-format off
+
+#include "ApiWindows.h"
+#include <xinput.h>
+
+// clang-format on
+
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace StateBroker
+    {
+      /// Determines whether or not physical controller state sharing is enabled by the
+      /// configuration.
+      /// @return `true` if physical controller state is shared between processes, `false`
+      /// otherwise.
+      bool IsEnabled(void);
+
+      /// Opens the shared memory section and determines whether this process owns physical
+      /// controller polling or subscribes to another process that does. If this process is a
+      /// subscriber, it automatically takes over ownership if the owning process exits. Does
+      /// nothing if state sharing is disabled or if it was already started.
+      void Start(void);
+
+      /// Publishes the result of an XInput state query so that subscribing processes can read it.
+      /// Does nothing unless this process owns physical controller polling.
+      /// @param [in] controllerIdentifier Identifier of the physical controller that was queried.
+      /// @param [in] result Result code that XInput returned.
+      /// @param [in] xinputState State data that XInput filled in. Only used if the query
+      /// succeeded.
+      void PublishXInputState(
+          TControllerIdentifier controllerIdentifier,
+          DWORD result,
+          const XINPUT_STATE& xinputState);
+
+      /// Attempts to answer an XInput state query using the state most recently published by the
+      /// process that owns physical controller polling. Fails, without side effects, if state
+      /// sharing is disabled or if this process is itself the owner, in which case XInput should
+      /// be queried directly.
+      /// @param [in] controllerIdentifier Identifier of the physical controller being queried.
+      /// @param [out] result Filled in with the XInput result code that was published.
+      /// @param [out] xinputState Filled in with the state data that was published. Only
+      /// meaningful if the published result code indicates success.
+      /// @return `true` if the query was answered, `false` otherwise.
+      bool TryReadXInputState(
+          TControllerIdentifier controllerIdentifier, DWORD& result, XINPUT_STATE& xinputState);
+    } // namespace StateBroker
+  } // namespace Controller
+} // namespace Xidi
@@ -11,9 +11,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <bit>
 #include <cstdint>
-
-#include <boost/circular_buffer.hpp>
+#include <memory>
+#include <span>
 
 #include "ControllerTypes.h"
 
@@ -22,10 +24,16 @@ namespace Xidi
   namespace Controller
   {
     /// Implements a state change event buffer for a virtual controller. Used for providing buffered
-    /// event functionality. Methods are not concurrency-safe, so some form of external concurrency
-    /// control is required. Behavior is modelled after DirectInput buffered event documentation.
+    /// event functionality. Behavior is modelled after DirectInput buffered event documentation.
     /// For example, number of events stored is artificially limited to one less than declared
-    /// capacity.
+    /// capacity. Internally the buffer is a ring with a power-of-two number of slots that supports
+    /// one producer, which appends events, concurrently with one consumer, which reads and pops
+    /// events, without either of them needing to acquire a lock. Storage is not allocated until
+    /// events are actually appended and then grows geometrically up to what the declared capacity
+    /// requires, so that applications that request a large buffer but rarely fill it do not pay
+    /// for it up front. Changing the capacity, growing storage while events are present, and
+    /// releasing idle storage are not concurrency-safe and require that the consumer not be
+    /// active.
     class StateChangeEventBuffer
     {
     public:
@@ -82,48 +90,150 @@ namespace Xidi
         /// System time in milliseconds when the event was generated.
         uint32_t timestamp;
 
-        /// Chronological sequence number of this event. Supposed to be globally monotonic with
-        /// respect to all other input events, but in practice it is locally monotonic with respect
-        /// to all virtual controller events.
+        /// Chronological sequence number of this event. Globally monotonic with respect to all
+        /// other events in all event buffers, because every event buffer draws its sequence
+        /// numbers from the same counter in the order in which events are appended.
         uint32_t sequence;
       };
 
       static_assert(sizeof(SEvent) <= 16, "Data structure size constraint violation.");
 
+      /// Identifies a run of the oldest events in an event buffer without copying them. Because the
+      /// underlying storage is a ring, the events are split into at most two contiguous spans, the
+      /// first of which holds the oldest events. Intended to be used by the consumer for draining
+      /// events in bulk.
+      struct SEventSpans
+      {
+        /// Free-running counter value that identifies the first event in the run.
+        uint32_t firstEvent;
+
+        /// Oldest events in the run, up to the end of the underlying storage.
+        std::span<const SEvent> older;
+
+        /// Remaining events in the run, continuing from the start of the underlying storage.
+        std::span<const SEvent> newer;
+
+        /// Retrieves and returns the total number of events in the run.
+        /// @return Number of events across both spans.
+        inline uint32_t GetCount(void) const
+        {
+          return (uint32_t)(older.size() + newer.size());
+        }
+      };
+
       /// Maximum allowed event buffer capacity, measured in number of events. Computed to allow a
       /// maximum of 1MB for event storage.
       static constexpr uint32_t kEventBufferCapacityMax = (1024 * 1024) / sizeof(SEvent);
 
+      /// Minimum number of slots allocated at a time for event storage, unless the declared
+      /// capacity requires fewer.
+      static constexpr uint32_t kEventStorageSlotCountMin = 64;
+
+      /// Amount of time, in milliseconds, after which storage is considered idle if the consumer
+      /// has not read or popped any events and the buffer is overflowing.
+      static constexpr uint32_t kEventStorageIdleMilliseconds = 10000;
+
       /// Constructs an empty event buffer with capacity of 0, which means this event buffer is
       /// disabled until it is enabled by request.
-      inline StateChangeEventBuffer(void) : eventBuffer(), eventBufferOverflowed() {}
+      inline StateChangeEventBuffer(void)
+          : events(),
+            eventBufferCapacity(0),
+            slotIndexMask(0),
+            head(0),
+            tail(0),
+            eventBufferOverflowed(false),
+            consumerActivity(false),
+            lastConsumerActivityTimestamp(0),
+            storageIsDormant(false),
+            stateGeneration(0)
+      {}
+
+      StateChangeEventBuffer(const StateChangeEventBuffer& other) = delete;
 
       /// Allows read-only access to events by index, without performing any bounds-checking. Event
-      /// with index 0 is the oldest, and higher indices indicate more recent events.
+      /// with index 0 is the oldest, and higher indices indicate more recent events. Intended to be
+      /// used by the consumer.
       /// @param [in] index Index of the desired event.
       /// @return Read-only reference to the event at the desired index.
       inline const SEvent& operator[](uint32_t index) const
       {
-        return eventBuffer[index];
+        return events[(head.load(std::memory_order_acquire) + index) & slotIndexMask];
       }
 
-      /// Appends a single event to the event buffer, given its data.
+      /// Appends a single event to the event buffer, given its data. If the event buffer is full
+      /// then the oldest event is discarded and an overflow condition is triggered. If storage was
+      /// released as idle then the event is discarded, and the overflow condition maintained, until
+      /// the consumer is next active. Intended to be used by the producer. Storage is allocated or
+      /// grown as needed, which is only safe concurrently with the consumer if the buffer is empty,
+      /// so a producer that runs concurrently with a consumer should use #HasStorageFor and
+      /// #ReserveStorage ahead of time.
       /// @param [in] eventData Event data to append.
       /// @param [in] timestamp Timestamp to apply to the appended event.
       void AppendEvent(SEventData eventData, uint32_t timestamp);
 
+      /// Attempts to merge an axis event into the most recent unread event for the same axis, so
+      /// that a continuously-moving axis does not consume a new event slot every time it changes.
+      /// Only events appended since the most recent button or POV event are eligible, which means
+      /// button and POV edges are never merged or reordered with respect to axis events. The
+      /// merged event keeps its position, timestamp, and sequence number and only receives the
+      /// updated axis value. Intended to be used by the producer, but because the event is modified
+      /// in place, the caller must ensure the consumer is not concurrently active.
+      /// @param [in] eventData Event data to merge.
+      /// @return `true` if the event was merged, `false` if it should be appended instead.
+      bool CoalesceAxisEvent(SEventData eventData);
+
+      /// Determines if storage is idle, meaning the buffer is overflowing and the consumer has not
+      /// been active for at least #kEventStorageIdleMilliseconds. Intended to be used by the
+      /// producer.
+      /// @param [in] timestamp Current timestamp, in the same units as event timestamps.
+      /// @return `true` if storage is idle and can be released by #ReleaseIdleStorage, `false`
+      /// otherwise.
+      bool CheckStorageIdle(uint32_t timestamp);
+
       /// Retrieves and returns the capacity of this event buffer.
       /// @return Event buffer capacity.
       inline uint32_t GetCapacity(void) const
       {
-        return (uint32_t)eventBuffer.capacity();
+        return eventBufferCapacity;
+      }
+
+      /// Retrieves and returns the number of slots currently allocated for event storage, which is
+      /// 0 until events are appended and never more than what the capacity requires.
+      /// @return Number of allocated event slots.
+      inline uint32_t GetStorageSlotCount(void) const
+      {
+        return ((nullptr == events) ? 0 : (slotIndexMask + 1));
       }
 
       /// Retrieves and returns the number of events currently present in this event buffer.
       /// @return Event count in this event buffer.
       inline uint32_t GetCount(void) const
       {
-        return (uint32_t)eventBuffer.size();
+        // Head is loaded first because it never passes tail, so the difference cannot underflow.
+        const uint32_t currentHead = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - currentHead;
+      }
+
+      /// Checks if the events identified by a previous call to #PeekOldestEvents are still intact,
+      /// meaning the producer has not since overwritten any of their storage. Events discarded due
+      /// to overflow are still intact as long as their storage has not been reused. Intended to be
+      /// used by the consumer after it is finished reading events.
+      /// @param [in] eventSpans Events previously identified by #PeekOldestEvents.
+      /// @return `true` if all events are intact, `false` if they must be identified and read
+      /// again.
+      bool AreEventsIntact(const SEventSpans& eventSpans) const;
+
+      /// Checks if allocated storage is sufficient to append the specified number of events without
+      /// growing. Intended to be used by the producer.
+      /// @param [in] numEventsToAppend Number of events the producer intends to append.
+      /// @return `true` if storage is sufficient, `false` if #ReserveStorage needs to be invoked.
+      inline bool HasStorageFor(uint32_t numEventsToAppend) const
+      {
+        const uint32_t storageSlotCount = GetStorageSlotCount();
+        return (
+            (storageSlotCount == RequiredStorageSlotCount()) ||
+            ((tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) +
+              numEventsToAppend) <= storageSlotCount));
       }
 
       /// Checks if this event buffer is enabled.
@@ -133,19 +243,54 @@ namespace Xidi
         return (0 != GetCapacity());
       }
 
+      /// Retrieves and returns the generation of the controller state whose change produced the
+      /// most recently appended events. Intended to be used by the consumer to determine cheaply if
+      /// any events were appended since it last looked.
+      /// @return State generation recorded by the producer, or 0 if none was ever recorded.
+      inline uint64_t GetStateGeneration(void) const
+      {
+        return stateGeneration.load(std::memory_order_acquire);
+      }
+
       /// Checks if an overflow condition has occurred on this buffer that has yet to be cleared.
       /// @return `true` if an overflow condition is present, `false` otherwise.
       inline bool IsOverflowed(void) const
       {
-        return eventBufferOverflowed;
+        return eventBufferOverflowed.load(std::memory_order_acquire);
       }
 
+      /// Identifies up to the specified number of the oldest events in the buffer, without copying
+      /// or removing them. Intended to be used by the consumer. Because the producer may append
+      /// events concurrently, the consumer should verify using #AreEventsIntact that the events are
+      /// still intact after it is finished reading them.
+      /// @param [in] maxCount Maximum number of events to identify.
+      /// @return Spans that together hold the identified events, oldest first.
+      SEventSpans PeekOldestEvents(uint32_t maxCount) const;
+
+      /// Removes and discards the events identified by a previous call to #PeekOldestEvents and
+      /// clears any present overflow condition. Events already discarded due to overflow in the
+      /// meantime are skipped. Takes constant time. Intended to be used by the consumer.
+      /// @param [in] eventSpans Events previously identified by #PeekOldestEvents.
+      void PopEvents(const SEventSpans& eventSpans);
+
       /// Removes and discards the oldest events from the buffer and clears any present overflow
       /// condition. Performs appropriate bounds-checking to ensure at most the specified number
-      /// events are removed.
+      /// events are removed. Intended to be used by the consumer.
       /// @param [in] numEventsToPop Maximum number of events to remove.
       void PopOldestEvents(uint32_t numEventsToPop);
 
+      /// Discards all events and releases event storage after #CheckStorageIdle has determined it
+      /// is idle. The overflow condition remains present, and subsequently appended events are
+      /// discarded until the consumer is next active. Not concurrency-safe with respect to the
+      /// consumer.
+      void ReleaseIdleStorage(void);
+
+      /// Grows event storage geometrically, if needed, so that the specified number of events can
+      /// be appended without growing again. Events already present are retained. Not
+      /// concurrency-safe with respect to the consumer.
+      /// @param [in] numEventsToAppend Number of events the producer intends to append.
+      void ReserveStorage(uint32_t numEventsToAppend);
+
       /// Sets the capacity of this event buffer.
       /// Disables this event buffer if the specified capacity is equal to 0.
       /// Sets the capacity to #kEventBufferCapacityMax if the specified capacity is greater than
@@ -153,19 +298,91 @@ namespace Xidi
       /// event buffer, an overflow condition is triggered and the oldest excess events are
       /// discarded. Buffer always maintains one free space, so the actual number of events stored
       /// is one less than capacity. This is to be consistent with documentation for
-      /// IDirectInputDevice8::GetDeviceData.
+      /// IDirectInputDevice8::GetDeviceData. Storage is only allocated as needed to hold the events
+      /// that are retained. Not concurrency-safe.
       /// @param [in] capacity Desired event buffer capacity.
       void SetCapacity(uint32_t capacity);
 
+      /// Records the generation of the controller state whose change produced the events most
+      /// recently appended. Intended to be used by the producer after appending them.
+      /// @param [in] generation State generation to record.
+      inline void SetStateGeneration(uint64_t generation)
+      {
+        stateGeneration.store(generation, std::memory_order_release);
+      }
+
     private:
 
-      /// Underlying event buffer object. Holds all individual event elements.
-      boost::circular_buffer<SEvent> eventBuffer;
+      /// Discards the oldest events until the number of events stored is less than capacity.
+      /// @return `true` if any events were discarded, `false` otherwise.
+      bool HandlePossibleOverflow(void);
+
+      /// Checks if the consumer has been active since the last time this method was invoked and,
+      /// if so, records the timestamp and ends any dormancy due to idle storage being released.
+      /// Intended to be used by the producer.
+      /// @param [in] timestamp Current timestamp, in the same units as event timestamps.
+      void NoteConsumerActivity(uint32_t timestamp);
+
+      /// Marks the consumer as having been active. Intended to be used by the consumer.
+      inline void SignalConsumerActivity(void) const
+      {
+        if (false == consumerActivity.load(std::memory_order_relaxed))
+          consumerActivity.store(true, std::memory_order_relaxed);
+      }
+
+      /// Computes the number of slots that event storage needs to have for the buffer to hold its
+      /// entire declared capacity, which is the smallest power of two that is no less than
+      /// capacity.
+      /// @return Required number of event slots, or 0 if the buffer is disabled.
+      inline uint32_t RequiredStorageSlotCount(void) const
+      {
+        return ((0 == eventBufferCapacity) ? 0 : std::bit_ceil(eventBufferCapacity));
+      }
+
+      /// Replaces event storage with storage that has the specified number of slots, retaining the
+      /// events present. Free-running counters are unaffected.
+      /// @param [in] newSlotCount Number of slots in the new storage, which must be a power of two
+      /// no less than the number of events present, or 0 if no events are present.
+      void ResizeStorage(uint32_t newSlotCount);
+
+      /// Underlying event storage. Holds all individual event elements. The number of slots is a
+      /// power of two and never more than the smallest power of two that is no less than capacity.
+      /// Not allocated until needed.
+      std::unique_ptr<SEvent[]> events;
+
+      /// Declared capacity of this event buffer, in number of events.
+      uint32_t eventBufferCapacity;
+
+      /// Mask applied to free-running event counters to obtain slot indices.
+      uint32_t slotIndexMask;
+
+      /// Free-running counter that identifies the oldest event in the buffer. Advanced by the
+      /// consumer when popping and by the producer when discarding events due to overflow.
+      alignas(64) std::atomic<uint32_t> head;
+
+      /// Free-running counter that identifies the slot to which the next event is appended.
+      /// Advanced only by the producer.
+      alignas(64) std::atomic<uint32_t> tail;
 
       /// Overflow flag for the event buffer. Set whenever an operation causes the event buffer to
       /// hit capacity and discard some previously-stored events. Cleared whenever events are
       /// retrieved such that the event buffer goes below capacity.
-      bool eventBufferOverflowed;
+      std::atomic<bool> eventBufferOverflowed;
+
+      /// Set whenever the consumer reads or pops events, and cleared whenever the producer notices.
+      mutable std::atomic<bool> consumerActivity;
+
+      /// Timestamp at which the producer most recently noticed consumer activity. Accessed only by
+      /// the producer.
+      uint32_t lastConsumerActivityTimestamp;
+
+      /// Whether or not idle storage was released and the consumer has not been active since.
+      /// Accessed only by the producer.
+      bool storageIsDormant;
+
+      /// Generation of the controller state whose change produced the most recently appended
+      /// events. Written only by the producer.
+      std::atomic<uint64_t> stateGeneration;
     };
   } // namespace Controller
 } // namespace Xidi
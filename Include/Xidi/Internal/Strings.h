@@ -43,12 +43,17 @@
 #define XIDI_EFFECT_NAME_SAWTOOTH_UP                           "Sawtooth Up"
 #define XIDI_EFFECT_NAME_SAWTOOTH_DOWN                         "Sawtooth Down"
 #define XIDI_EFFECT_NAME_CUSTOM_FORCE                          "Custom Force"
+#define XIDI_EFFECT_NAME_SPRING                                "Spring"
+#define XIDI_EFFECT_NAME_DAMPER                                "Damper"
+#define XIDI_EFFECT_NAME_INERTIA                               "Inertia"
+#define XIDI_EFFECT_NAME_FRICTION                              "Friction"
 
 // String prefixes and suffixes that need to be consumed as they are but also combined into longer
 // literals. All exist as wide-character strings only.
 #define XIDI_CONFIG_PROPERTIES_PREFIX_CIRCLE_TO_SQUARE_PERCENT L"CircleToSquarePercent"
 #define XIDI_CONFIG_PROPERTIES_PREFIX_DEADZONE_PERCENT         L"DeadzonePercent"
 #define XIDI_CONFIG_PROPERTIES_PREFIX_SATURATION_PERCENT       L"SaturationPercent"
+#define XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS      L"PeriodMilliseconds"
 #define XIDI_CONFIG_PROPERTIES_SUFFIX_STICK_LEFT               L"StickLeft"
 #define XIDI_CONFIG_PROPERTIES_SUFFIX_STICK_RIGHT              L"StickRight"
 #define XIDI_CONFIG_PROPERTIES_SUFFIX_TRIGGER_LT               L"TriggerLT"
@@ -61,12 +66,21 @@ namespace Xidi
     // These strings can safely be used at any time, including to perform static initialization.
     // Views are guaranteed to be null-terminated.
 
+    /// Base name of the Configuration Manager library to import.
+    inline constexpr std::wstring_view kStrLibraryNameCfgMgr32 = L"cfgmgr32.dll";
+
+    /// Base name of the COM base library, from which Windows Runtime functions are imported.
+    inline constexpr std::wstring_view kStrLibraryNameCombase = L"combase.dll";
+
     /// Base name of the DirectInput library to import.
     inline constexpr std::wstring_view kStrLibraryNameDirectInput = L"dinput.dll";
 
     /// Base name of the DirectInput8 library to import.
     inline constexpr std::wstring_view kStrLibraryNameDirectInput8 = L"dinput8.dll";
 
+    /// Base name of the HID library, from which HID report parsing functions are imported.
+    inline constexpr std::wstring_view kStrLibraryNameHid = L"hid.dll";
+
     /// Base name of the WinMM library to import.
     inline constexpr std::wstring_view kStrLibraryNameWinMM = L"winmm.dll";
 
@@ -82,12 +96,43 @@ namespace Xidi
     /// Configuration file setting for specifying the logging verbosity level.
     inline constexpr std::wstring_view kStrConfigurationSettingLogLevel = L"Level";
 
+    /// Configuration file setting for writing frequently-produced log messages on a background
+    /// thread instead of on the application thread that produces them.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogAsynchronous = L"Asynchronous";
+
+    /// Configuration file setting for counting and timing every call the application makes to a
+    /// DirectInput or WinMM entry point implemented by Xidi.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogApiCallProfile =
+        L"ApiCallProfile";
+
+    /// Configuration file setting for measuring how long physical controller input takes to reach
+    /// the application, broken down by stage.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogInputLatencyTrace =
+        L"InputLatencyTrace";
+
+    /// Configuration file setting for exporting live metrics through a shared memory section that
+    /// external tools, such as overlays, can read while the application is running.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogLiveMetrics = L"LiveMetrics";
+
+    /// Configuration file setting for outputting a breakdown of how long each phase of startup
+    /// takes as informational messages.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogStartupTrace = L"StartupTrace";
+
+    /// Configuration file setting for emitting a TraceLogging event for each phase of startup.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogStartupTraceEvents =
+        L"StartupTraceEvents";
+
     /// Configuration file section name for mapper-related settings.
     inline constexpr std::wstring_view kStrConfigurationSectionMapper = L"Mapper";
 
     /// Configuration file setting for specifying the mapper type.
     inline constexpr std::wstring_view kStrConfigurationSettingMapperType = L"Type";
 
+    /// Configuration file setting for enabling custom mappers to be rebuilt and reapplied while
+    /// the application is running whenever the configuration file is modified.
+    inline constexpr std::wstring_view kStrConfigurationSettingMapperReloadOnChange =
+        L"ReloadOnChange";
+
     /// Prefix for configuration file sections that define custom mappers.
     inline constexpr std::wstring_view kStrConfigurationSectionCustomMapperPrefix = L"CustomMapper";
 
@@ -115,11 +160,311 @@ namespace Xidi
         kStrConfigurationSettingPropertiesMouseSpeedScalingFactorPercent =
             L"MouseSpeedScalingFactorPercent";
 
+    /// Configuration file setting for enabling axis extrapolation. When enabled, axes in motion are
+    /// extrapolated from their recent velocity to the time at which the application retrieves
+    /// DirectInput device state, which hides some of the time that passed since the physical
+    /// controller was polled without polling more often.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesAxisExtrapolation =
+        L"AxisExtrapolation";
+
+    /// Configuration file setting for customizing the amount of time between physical controller
+    /// polling attempts while this process does not have input focus, expressed in milliseconds.
+    /// Polling resumes at the normal rate as soon as input focus is regained. A value of 0 stops
+    /// polling entirely while in the background, and a value no greater than the normal polling
+    /// period keeps polling at the normal rate for applications that need background input.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesBackgroundPollingPeriodMilliseconds =
+            L"BackgroundPolling" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for enabling coalescing of buffered axis events. When enabled, a
+    /// change to an axis that still has an unread buffered event updates that event in place
+    /// instead of appending a new one, as long as no button or POV event came after it. This keeps
+    /// a moving stick from overflowing small event buffers and causing button presses to be lost.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesCoalesceAxisEvents =
+        L"CoalesceAxisEvents";
+
+    /// Configuration file setting for specifying the time, in seconds, between queries of physical
+    /// controller battery and capabilities information. Results are cached and made available
+    /// through the Xidi API, so that overlays and other consumers do not need to issue their own
+    /// XInput queries. Queries also happen whenever a physical controller is connected, and only
+    /// once something actually reads the cached results. A value of 0 disables the queries.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesControllerStatusPeriodSeconds =
+            L"ControllerStatusPeriodSeconds";
+
+    /// Configuration file setting for enabling cooperative mode. When enabled, no threads are
+    /// created to poll physical controllers or actuate their force feedback. Instead, that work is
+    /// performed at a limited rate on the application's own thread whenever it reads controller
+    /// state, and virtual keyboard events are submitted synchronously. A low-frequency watchdog
+    /// keeps physical controllers serviced if the application stops reading state.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesCooperativeMode =
+        L"CooperativeMode";
+
+    /// Configuration file setting for enabling averaging of force feedback output. When enabled,
+    /// each force feedback actuation pass writes the average output of each effect over the time
+    /// since the previous pass instead of its output at that instant, so that effects that change
+    /// faster than the actuation rate are not aliased.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesForceFeedbackAveraging =
+        L"ForceFeedbackAveraging";
+
+    /// Configuration file setting for customizing the amount of time between force feedback
+    /// actuation passes, expressed in milliseconds.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesForceFeedbackPeriodMilliseconds =
+            L"ForceFeedback" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for customizing the minimum amount of time between writes of
+    /// vibration values to physical controllers, expressed in milliseconds. Changes that arrive
+    /// sooner are delayed, except for motors that are starting or stopping.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesForceFeedbackWritePeriodMilliseconds =
+            L"ForceFeedbackWrite" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for customizing the smallest change in vibration strength that
+    /// is written to physical controllers, expressed as a percentage of the maximum possible
+    /// strength. Smaller changes are suppressed, except for motors that are starting or stopping.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesForceFeedbackWriteThresholdPercent =
+            L"ForceFeedbackWriteThresholdPercent";
+
+    /// Configuration file setting for enabling the Guide button. When enabled, physical controllers
+    /// are read using the extended XInput state query, which also reports the Guide button, so that
+    /// it can be mapped like any other button.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesGuideButton =
+        L"GuideButton";
+
+    /// Configuration file setting for enabling the high-resolution physical controller polling
+    /// engine. When enabled, physical controllers are polled against fixed deadlines using a
+    /// high-resolution waitable timer instead of sleeping for a fixed amount of time between polls.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesHighResolutionPolling =
+        L"HighResolutionPolling";
+
+    /// Configuration file setting for enabling incremental device state retrieval. When enabled,
+    /// an application that repeatedly retrieves device state into the same buffer gets only the
+    /// changed parts of its data packet rewritten. DirectInput does not guarantee that applications
+    /// leave their buffers untouched between calls, so this setting is disabled by default.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesIncrementalDeviceState =
+        L"IncrementalDeviceState";
+
+    /// Configuration file setting for enabling incremental mapping of physical controller state.
+    /// When enabled, only the element mappers whose physical controller elements changed since the
+    /// previous poll are asked for contributions, and the rest are reused from the previous poll.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesIncrementalMapping =
+        L"IncrementalMapping";
+
+    /// Configuration file setting for enabling the DirectInput keyboard backend. When enabled,
+    /// virtual keyboard state is surfaced directly through the system keyboard DirectInput device
+    /// instead of being submitted to the system as keyboard input events.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesKeyboardDirectInput =
+        L"KeyboardDirectInput";
+
+    /// Configuration file setting for customizing the amount of time between attempts to submit
+    /// virtual keyboard events to the system, expressed in milliseconds.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesKeyboardPeriodMilliseconds =
+            L"Keyboard" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for customizing the amount of time a virtual keyboard key must
+    /// be held before it starts repeating, expressed in milliseconds. Key repeat is disabled if
+    /// this is 0.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesKeyboardRepeatDelayMilliseconds =
+            L"KeyboardRepeatDelayMilliseconds";
+
+    /// Configuration file setting for customizing the amount of time between repeats of a held
+    /// virtual keyboard key, expressed in milliseconds.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesKeyboardRepeatPeriodMilliseconds =
+            L"KeyboardRepeatPeriodMilliseconds";
+
+    /// Configuration file setting for enabling synchronous virtual keyboard event submission. When
+    /// enabled, virtual keyboard events are submitted to the system as soon as the controller poll
+    /// that produced them is mapped, rather than by a separate thread on its own period.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesKeyboardSynchronous =
+        L"KeyboardSynchronous";
+
+    /// Configuration file setting for customizing the angular velocity of physical controller
+    /// motion, expressed in degrees per second, that is mapped to an extreme analog value.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesMotionFullScaleDegreesPerSecond =
+            L"MotionFullScaleDegreesPerSecond";
+
+    /// Configuration file setting for specifying the element mapper to which physical controller
+    /// motion about the pitch axis is sent. Motion is not mapped unless at least one axis has an
+    /// element mapper.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesMotionPitch =
+        L"MotionPitch";
+
+    /// Configuration file setting for specifying the element mapper to which physical controller
+    /// motion about the roll axis is sent.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesMotionRoll =
+        L"MotionRoll";
+
+    /// Configuration file setting for specifying the element mapper to which physical controller
+    /// motion about the yaw axis is sent.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesMotionYaw = L"MotionYaw";
+
+    /// Configuration file setting for customizing the amount of time between attempts to submit
+    /// virtual mouse events to the system, expressed in milliseconds.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesMousePeriodMilliseconds =
+        L"Mouse" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for enabling high-resolution virtual mouse wheel events. When
+    /// enabled, wheel movement is submitted to the system in fractions of a wheel detent, which
+    /// applications that support high-resolution wheels use for smooth scrolling. Otherwise it is
+    /// only submitted in whole detents.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesMouseWheelHighResolution =
+        L"MouseWheelHighResolution";
+
+    /// Configuration file setting for enabling on-demand physical controller polling. When enabled,
+    /// an application that polls a DirectInput device or retrieves its state causes the physical
+    /// controller to be read immediately on the application's own thread, at a limited rate, so
+    /// that the state it sees is as fresh as its own frame rate allows.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesOnDemandPolling =
+        L"OnDemandPolling";
+
+    /// Configuration file setting for enabling pipelined physical controller polling. When enabled,
+    /// each physical controller gets one thread that only reads it on a strict schedule and a second
+    /// thread that maps the most recent reading, so that the time spent mapping cannot delay the
+    /// next read.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesPipelinedPolling =
+        L"PipelinedPolling";
+
+    /// Configuration file setting for enabling alignment of physical controller polling to the rate
+    /// at which the application reads controller state. When enabled, the timing of application
+    /// reads is measured and polls are scheduled to land just before each expected read, which
+    /// lowers average input latency without polling more often.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesPollingAlignment =
+        L"PollingAlignment";
+
+    /// Configuration file setting for customizing the amount of time between physical controller
+    /// polling attempts, expressed in milliseconds.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesPollingPeriodMilliseconds =
+            L"Polling" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for enabling the single-threaded physical controller scheduler.
+    /// When enabled, one thread services all physical controllers, including polling, force
+    /// feedback actuation, and status monitoring, instead of each controller getting its own set of
+    /// threads.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesSingleThreadedPolling =
+        L"SingleThreadedPolling";
+
+    /// Configuration file setting for customizing the smallest change in any single axis, expressed
+    /// as a percentage of the axis range, for which the application-supplied state change event is
+    /// signalled when no button or POV changed. Changes to buttons and POVs are always signalled.
+    /// The application still sees smaller axis changes whenever it next reads state.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesStateChangeEventAxisThresholdPercent =
+            L"StateChangeEventAxisThresholdPercent";
+
+    /// Configuration file setting for customizing the minimum amount of time between signals of
+    /// the application-supplied state change event for changes that only involve axes, expressed
+    /// in milliseconds.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesStateChangeEventPeriodMilliseconds =
+            L"StateChangeEvent" XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS;
+
+    /// Configuration file setting for enabling prewarming of physical controllers. When enabled,
+    /// physical controllers are initialized on a background thread as soon as the configuration
+    /// file is loaded, rather than on the first call the application makes that needs them.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesPrewarmControllers =
+        L"PrewarmControllers";
+
+    /// Configuration file setting for sharing physical controller state between all processes in
+    /// the same session that use Xidi. When enabled, only one of those processes queries XInput
+    /// and the rest read the state it publishes.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesSharePhysicalControllerState =
+            L"SharePhysicalControllerState";
+
+    /// Configuration file setting for customizing the number of physical controllers that are
+    /// supported. More than the default number are only useful with a backend other than XInput.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesPhysicalControllerCount = L"PhysicalControllerCount";
+
+    /// Configuration file setting for specifying which physical controllers are enabled, as a
+    /// bitmask with one bit per physical controller starting from the least significant bit.
+    /// Disabled physical controllers are never polled, mapped, or actuated, and their virtual
+    /// controllers are not presented to applications.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesPhysicalControllerMask =
+        L"PhysicalControllerMask";
+
+    /// Configuration file setting for customizing the smallest change in a physical controller
+    /// analog stick axis value that is published, expressed in raw stick units. Axes that move by
+    /// less keep their previously-published value, so that noise from an otherwise idle stick does
+    /// not cause repeated state publication and mapping.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesStickNoiseThreshold =
+        L"StickNoiseThreshold";
+
+    /// Configuration file setting for customizing the smallest change in a physical controller
+    /// trigger value that is published, expressed in raw trigger units.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesTriggerNoiseThreshold =
+        L"TriggerNoiseThreshold";
+
+    /// Configuration file setting for selecting the system API through which physical controllers
+    /// are read and actuated. XInput is used by default.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesPhysicalControllerBackend = L"PhysicalControllerBackend";
+
+    /// Configuration file value for reading and actuating physical controllers using XInput.
+    inline constexpr std::wstring_view kStrConfigurationValuePhysicalControllerBackendXInput =
+        L"XInput";
+
+    /// Configuration file value for reading and actuating physical controllers using the
+    /// `Windows.Gaming.Input` gamepad API, which supports impulse triggers.
+    inline constexpr std::wstring_view
+        kStrConfigurationValuePhysicalControllerBackendWindowsGamingInput = L"WindowsGamingInput";
+
+    /// Configuration file value for reading physical controllers by parsing HID input reports
+    /// received through the Raw Input API as soon as they arrive.
+    inline constexpr std::wstring_view kStrConfigurationValuePhysicalControllerBackendRawInput =
+        L"RawInput";
+
+    /// Configuration file setting for selecting the XInput library from which XInput functions are
+    /// imported. Either the filename of one of the supported XInput libraries, which is tried
+    /// before all the others, or a value requesting that the library with the lowest measured
+    /// per-call cost be selected.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesXInputLibrary =
+        L"XInputLibrary";
+
+    /// Configuration file value for selecting whichever loadable XInput library has the lowest
+    /// measured per-call cost on this machine.
+    inline constexpr std::wstring_view kStrConfigurationValueXInputLibraryFastest = L"Fastest";
+
+    /// Configuration file setting for selecting the type of processor core on which
+    /// latency-critical background threads, such as physical controller polling, should run.
+    /// Only meaningful on processors that have more than one type of core.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingsPropertiesLatencyCriticalThreadCores =
+            L"LatencyCriticalThreadCores";
+
+    /// Configuration file setting for selecting the type of processor core on which housekeeping
+    /// background threads, such as logging and status monitoring, should run. Only meaningful on
+    /// processors that have more than one type of core.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesHousekeepingThreadCores =
+        L"HousekeepingThreadCores";
+
+    /// Configuration file value for selecting the highest-performance processor cores, which also
+    /// opts the affected threads out of power throttling.
+    inline constexpr std::wstring_view kStrConfigurationValueThreadCoresPerformance =
+        L"Performance";
+
+    /// Configuration file value for selecting the most power-efficient processor cores, which also
+    /// opts the affected threads into power throttling.
+    inline constexpr std::wstring_view kStrConfigurationValueThreadCoresEfficiency = L"Efficiency";
+
     /// Configuration file setting for enabling or disabling built-in properties like deadzone and
     /// saturation, which are used for interfaces that do not normally allow for customization.
     inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesUseBuiltinProperties =
         L"UseBuiltInProperties";
 
+    /// Configuration file setting for enumerating only Xidi virtual controllers whenever an
+    /// application enumerates game controllers, without asking the system about its own game
+    /// controllers at all. Enumeration of other types of devices is unaffected.
+    inline constexpr std::wstring_view kStrConfigurationSettingsPropertiesVirtualControllersOnly =
+        L"VirtualControllersOnly";
+
     /// Configuration file setting for correcting the left analog stick's circular field of motion
     /// to a square field of motion, expressed as a percent of the maximum possible amount of
     /// correction (perfect circle to perfect square).
@@ -216,9 +561,58 @@ namespace Xidi
         kStrConfigurationSettingsWorkaroundsUseShortVirtualControllerNames =
             L"UseShortVirtualControllerNames";
 
+    /// Configuration file section name for the flight recorder, which always retains the most
+    /// recent physical controller states, API calls, and force feedback writes in memory.
+    inline constexpr std::wstring_view kStrConfigurationSectionFlightRecorder = L"FlightRecorder";
+
+    /// Configuration file setting for specifying the name of a file to which the flight recorder
+    /// should write everything it retains if the process crashes.
+    inline constexpr std::wstring_view kStrConfigurationSettingFlightRecorderCrashDumpFile =
+        L"CrashDumpFile";
+
+    /// Configuration file section name for learning settings suited to the running executable.
+    inline constexpr std::wstring_view kStrConfigurationSectionAutoTune = L"AutoTune";
+
+    /// Configuration file setting for observing how the application reads input over the session
+    /// and outputting suggested settings as informational messages when it exits.
+    inline constexpr std::wstring_view kStrConfigurationSettingAutoTuneLearn = L"Learn";
+
+    /// Configuration file setting for also writing suggested settings to the auto-tuning profile
+    /// of the running executable when the application exits.
+    inline constexpr std::wstring_view kStrConfigurationSettingAutoTuneSaveProfile =
+        L"SaveProfile";
+
+    /// Configuration file setting for reading the auto-tuning profile of the running executable
+    /// and using it for any settings the configuration file does not specify.
+    inline constexpr std::wstring_view kStrConfigurationSettingAutoTuneUseProfile = L"UseProfile";
+
+    /// Configuration file section name for recording and replaying traces of XInput state queries.
+    inline constexpr std::wstring_view kStrConfigurationSectionXInputTrace = L"XInputTrace";
+
+    /// Configuration file setting for specifying the name of a file to which XInput state queries
+    /// should be recorded.
+    inline constexpr std::wstring_view kStrConfigurationSettingXInputTraceRecordFile =
+        L"RecordFile";
+
+    /// Configuration file setting for specifying the name of a previously-recorded trace file from
+    /// which XInput state queries should be answered instead of using the native XInput library.
+    inline constexpr std::wstring_view kStrConfigurationSettingXInputTraceReplayFile =
+        L"ReplayFile";
+
     // These strings are not safe to access before run-time, and should not be used to perform
     // dynamic initialization. Views are guaranteed to be null-terminated.
 
+    /// Complete path and filename of the auto-tuning profile of the running executable, which is
+    /// placed alongside the configuration file.
+    std::wstring_view GetAutoTuneProfileFilename(void);
+
+    /// Complete path and filename of the configuration file.
+    std::wstring_view GetConfigurationFilename(void);
+
+    /// Complete path and filename of the element mapper cache file, which is placed alongside the
+    /// configuration file.
+    std::wstring_view GetElementMapperCacheFilename(void);
+
     /// Form name.
     /// Use this to identify Xidi's form (dinput, dinput8, winmm) in areas of user interaction.
     std::wstring_view GetFormName(void);
@@ -238,6 +632,10 @@ namespace Xidi
     /// Complete path and filename of the main Xidi library.
     std::wstring_view GetXidiMainLibraryFilename(void);
 
+    /// Complete path and filename of the file that records the outcome of measuring the per-call
+    /// cost of each XInput library, which is placed alongside the configuration file.
+    std::wstring_view GetXInputLibraryProbeCacheFilename(void);
+
     /// Returns a string representing the specified axis type.
     /// @param [in] axis Axis type for which a string is requested.
     /// @return String representation of the axis type.
@@ -250,12 +648,21 @@ namespace Xidi
     Infra::TemporaryString GuidToString(const GUID& guid);
 
     /// Retrieves a string used to represent a per-controller mapper type configuration setting.
-    /// These are initialized on first invocation and returned subsequently as read-only views.
+    /// These are generated at compile time and returned as read-only views.
     /// An empty view is returned if an invalid controller identifier is specified.
     /// @param [in] controllerIdentifier Controller identifier for which a string is desired.
     /// @return Corresponding configuration setting string, or an empty view if the controller
     /// identifier is out of range.
     std::wstring_view MapperTypeConfigurationNameString(
         Controller::TControllerIdentifier controllerIdentifier);
+
+    /// Retrieves a string used to represent a per-controller properties configuration section.
+    /// These are generated at compile time and returned as read-only views.
+    /// An empty view is returned if an invalid controller identifier is specified.
+    /// @param [in] controllerIdentifier Controller identifier for which a string is desired.
+    /// @return Corresponding configuration section string, or an empty view if the controller
+    /// identifier is out of range.
+    std::wstring_view PropertiesConfigurationSectionString(
+        Controller::TControllerIdentifier controllerIdentifier);
   } // namespace Strings
 } // namespace Xidi
@@ -0,0 +1,130 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file TraceEvents.h
+ *   Declaration of TraceLogging events emitted from frequently-executed paths, for correlating
+ *   controller input and force feedback with application frame timing in performance analysis
+ *   tools.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DECLARE_PROVIDER(xidiTraceEventsProvider);
+
+namespace Xidi
+{
+  namespace TraceEvents
+  {
+    /// Registers the TraceLogging provider so that its events can be collected. Until this
+    /// function is invoked no events are emitted. Must be paired with #Unregister before this
+    /// library is unloaded.
+    void Register(void);
+
+    /// Unregisters the TraceLogging provider. Safe to invoke even if it is not registered.
+    void Unregister(void);
+
+    /// Determines if any trace session is currently collecting events from the TraceLogging
+    /// provider. Does not make any system calls.
+    /// @return `true` if so, `false` if not.
+    inline bool IsEnabled(void)
+    {
+      return (TRUE == TraceLoggingProviderEnabled(xidiTraceEventsProvider, 0, 0));
+    }
+
+    /// Implementations of each event. Invoked through the wrappers below, which first check that
+    /// the provider is enabled so that nothing else happens if no trace session is collecting.
+    void EmitPollBegin(Controller::TControllerIdentifier controllerIdentifier);
+    void EmitPollEnd(
+        Controller::TControllerIdentifier controllerIdentifier,
+        Controller::EPhysicalDeviceStatus deviceStatus);
+    void EmitStatePublished(Controller::TControllerIdentifier controllerIdentifier);
+    void EmitEventBufferOverflow(const void* eventBuffer, uint32_t capacity);
+    void EmitForceFeedbackTick(
+        Controller::TControllerIdentifier controllerIdentifier, unsigned int activeEffectCount);
+    void EmitXInputSetState(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint16_t leftMotorSpeed,
+        uint16_t rightMotorSpeed,
+        DWORD result);
+    void EmitSendInputBatch(std::wstring_view emitterName, UINT numRequested, UINT numSent);
+
+    /// Emits the start of a single poll of a physical controller.
+    /// @param [in] controllerIdentifier Identifier of the physical controller being polled.
+    inline void PollBegin(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (true == IsEnabled()) EmitPollBegin(controllerIdentifier);
+    }
+
+    /// Emits the end of a single poll of a physical controller.
+    /// @param [in] controllerIdentifier Identifier of the physical controller that was polled.
+    /// @param [in] deviceStatus Device status read by the poll.
+    inline void PollEnd(
+        Controller::TControllerIdentifier controllerIdentifier,
+        Controller::EPhysicalDeviceStatus deviceStatus)
+    {
+      if (true == IsEnabled()) EmitPollEnd(controllerIdentifier, deviceStatus);
+    }
+
+    /// Emits that new raw virtual controller state was published for a physical controller.
+    /// @param [in] controllerIdentifier Identifier of the physical controller whose state changed.
+    inline void StatePublished(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (true == IsEnabled()) EmitStatePublished(controllerIdentifier);
+    }
+
+    /// Emits that a virtual controller event buffer discarded its oldest events due to overflow.
+    /// @param [in] eventBuffer Address of the event buffer, which identifies it within a trace.
+    /// @param [in] capacity Capacity of the event buffer.
+    inline void EventBufferOverflow(const void* eventBuffer, uint32_t capacity)
+    {
+      if (true == IsEnabled()) EmitEventBufferOverflow(eventBuffer, capacity);
+    }
+
+    /// Emits a single pass of force feedback actuation that plays effects. Because determining
+    /// the number of active effects can require acquiring a lock, callers are expected to check
+    /// #IsEnabled themselves before doing so.
+    /// @param [in] controllerIdentifier Identifier of the physical controller being actuated.
+    /// @param [in] activeEffectCount Number of effects currently playing.
+    inline void ForceFeedbackTick(
+        Controller::TControllerIdentifier controllerIdentifier, unsigned int activeEffectCount)
+    {
+      if (true == IsEnabled()) EmitForceFeedbackTick(controllerIdentifier, activeEffectCount);
+    }
+
+    /// Emits a vibration write to a physical controller.
+    /// @param [in] controllerIdentifier Identifier of the physical controller written.
+    /// @param [in] leftMotorSpeed Left motor speed that was written.
+    /// @param [in] rightMotorSpeed Right motor speed that was written.
+    /// @param [in] result Return code from `XInputSetState`.
+    inline void XInputSetState(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint16_t leftMotorSpeed,
+        uint16_t rightMotorSpeed,
+        DWORD result)
+    {
+      if (true == IsEnabled())
+        EmitXInputSetState(controllerIdentifier, leftMotorSpeed, rightMotorSpeed, result);
+    }
+
+    /// Emits a batch of keyboard or mouse input events submitted to the system.
+    /// @param [in] emitterName Name of the emitter that submitted the batch.
+    /// @param [in] numRequested Number of input events in the batch.
+    /// @param [in] numSent Number of input events that `SendInput` reported as sent.
+    inline void SendInputBatch(std::wstring_view emitterName, UINT numRequested, UINT numSent)
+    {
+      if (true == IsEnabled()) EmitSendInputBatch(emitterName, numRequested, numSent);
+    }
+  } // namespace TraceEvents
+} // namespace Xidi
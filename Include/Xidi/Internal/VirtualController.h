@@ -12,18 +12,23 @@
 #pragma once
 
 #include <array>
-#include <bitset>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <stop_token>
-#include <thread>
+#include <optional>
 #include <utility>
 
+#include "ConcurrencyWrapper.h"
+#include "ControllerMath.h"
 #include "ControllerTypes.h"
 #include "ForceFeedbackDevice.h"
 #include "ForceFeedbackTypes.h"
 #include "Mapper.h"
+#include "ProfiledMutex.h"
 #include "StateChangeEventBuffer.h"
 
 namespace Xidi
@@ -34,9 +39,10 @@ namespace Xidi
     /// controller. Obtains state input from XInput, maps XInput data to virtual controller data,
     /// and applies transforms based on application-specified properties. Supports both
     /// instantaneous state and buffered state change events. All methods are concurrency-safe
-    /// unless otherwise specified. However, bulk operations (such as reading multiple events from
-    /// the event buffer) are not atomic unless the caller manually obtains a virtual controller's
-    /// lock.
+    /// unless otherwise specified. State and properties are published as snapshots, so reading
+    /// them never blocks, and only threads that modify this virtual controller contend on its lock.
+    /// However, bulk operations (such as reading multiple events from the event buffer) are not
+    /// atomic unless the caller manually obtains a virtual controller's event buffer lock.
     class VirtualController
     {
     public:
@@ -76,57 +82,32 @@ namespace Xidi
       /// Default value for force feedback gain. No scaling down of effects by default.
       static constexpr uint32_t kFfGainDefault = kFfGainMax;
 
+      /// Number of fractional bits in the fixed-point scale factors used to transform axis values.
+      static constexpr unsigned int kAxisScaleFactorFractionBits =
+          Math::kAxisTransformScaleFactorFractionBits;
+
       /// Permits users of the associated virtual controller to ignore certain controller elements
       /// and cause them not to generate state change events. For use with buffered events.
       class EventFilter
       {
       public:
 
-        /// Base index for axis elements of the filter.
-        static constexpr unsigned int kBaseIndexAxis = 0;
-
-        /// Base index for button elements of the filter.
-        static constexpr unsigned int kBaseIndexButton = (unsigned int)EAxis::Count;
-
-        /// Base index for the POV element of the filter.
-        static constexpr unsigned int kBaseIndexPov =
-            (unsigned int)EAxis::Count + (unsigned int)EButton::Count;
-
-        /// Computes the filter index that corresponds to a given controller element, with very
-        /// little error checking.
-        /// @param [in] element Controller index for which the filter index is desired.
-        /// @return Corresponding filter index.
-        static inline unsigned int ElementToIndex(SElementIdentifier element)
-        {
-          switch (element.type)
-          {
-            case EElementType::Axis:
-              return kBaseIndexAxis + (unsigned int)element.axis;
-            case EElementType::Button:
-              return kBaseIndexButton + (unsigned int)element.button;
-            case EElementType::Pov:
-              return kBaseIndexPov;
-            default:
-              return (unsigned int)-1; // This should never happen.
-          }
-        }
-
         /// Adds all controller elements to the filter.
-        inline EventFilter(void) : filter(ULLONG_MAX) {}
+        constexpr EventFilter(void) : filter(kElementMaskAll) {}
 
         /// Adds the specified virtual controller element to the filter so that events are generated
         /// for it.
         /// @param [in] element Desired virtual controller element.
         inline void Add(SElementIdentifier element)
         {
-          filter.set(ElementToIndex(element));
+          filter |= ElementMaskForElement(element);
         }
 
         /// Adds all virtual controller elements to the filter, essentially turning the filter into
         /// a no-op and generating events for all elements.
         inline void AddAll(void)
         {
-          filter.set();
+          filter = kElementMaskAll;
         }
 
         /// Tests if the filter contains the specified virtual controller element.
@@ -134,7 +115,14 @@ namespace Xidi
         /// @return `true` if it is contained in the filter, `false` otherwise.
         inline bool Contains(SElementIdentifier element) const
         {
-          return filter.test(ElementToIndex(element));
+          return (0 != (filter & ElementMaskForElement(element)));
+        }
+
+        /// Retrieves all of the virtual controller elements contained in the filter.
+        /// @return Element mask identifying the elements contained in the filter.
+        inline TElementMask GetElements(void) const
+        {
+          return filter;
         }
 
         /// Remove the specified virtual controller element from the filter so that events are not
@@ -142,20 +130,28 @@ namespace Xidi
         /// @param [in] element Desired virtual controller element.
         inline void Remove(SElementIdentifier element)
         {
-          filter.reset(ElementToIndex(element));
+          filter &= ~ElementMaskForElement(element);
         }
 
         /// Removes all virtual controller elements from the filter, resulting in no events being
         /// generated whatsoever.
         inline void RemoveAll(void)
         {
-          filter.reset();
+          filter = 0;
+        }
+
+        /// Replaces the contents of the filter such that it contains exactly the specified virtual
+        /// controller elements.
+        /// @param [in] elements Element mask identifying the elements to be contained.
+        inline void SetElements(TElementMask elements)
+        {
+          filter = (elements & kElementMaskAll);
         }
 
       private:
 
         /// Holds the filter itself, one bit per virtual controller element.
-        std::bitset<(int)EAxis::Count + (int)EButton::Count + 1> filter;
+        TElementMask filter;
       };
 
       /// Properties of an individual axis.
@@ -174,11 +170,11 @@ namespace Xidi
 
         /// Highest raw analog value on the positive side of the axis that falls within the deadzone
         /// region. Values at or below this should report neutral.
-        int32_t deadzoneRawCutoffPositive;
+        int32_t deadzoneRawCutoffPositive = kAnalogValueNeutral;
 
         /// Lowest raw analog value on the negative side of the axis that fallw within the deadzone
         /// region. Values at or above this should report neutral.
-        int32_t deadzoneRawCutoffNegative;
+        int32_t deadzoneRawCutoffNegative = kAnalogValueNeutral;
 
         /// Saturation point of the axis, expressed as a percentage of its physical range in both
         /// directions. Can be from 0 (entire axis is saturated) to 10000 (do not saturate at all).
@@ -186,20 +182,30 @@ namespace Xidi
 
         /// Lowest raw analog value on the positive side of the axis that faills within the
         /// saturation region. Values at or above this should report extreme.
-        int32_t saturationRawCutoffPositive;
+        int32_t saturationRawCutoffPositive = kAnalogValueNeutral;
 
         /// Minimum value in the range of raw analog values that falls within the deadzone. Values
         /// at or below this should report extreme.
-        int32_t saturationRawCutoffNegative;
+        int32_t saturationRawCutoffNegative = kAnalogValueNeutral;
 
         /// Minimum reportable value for the axis.
-        int32_t rangeMin;
+        int32_t rangeMin = 0;
 
         /// Maximum reportable value for the axis.
-        int32_t rangeMax;
+        int32_t rangeMax = 0;
 
         /// Neutral value for the axis.
-        int32_t rangeNeutral;
+        int32_t rangeNeutral = 0;
+
+        /// Fixed-point factor by which the distance of a raw analog value past the positive
+        /// deadzone cutoff is scaled to obtain its distance from neutral in the reportable range.
+        /// Derived from the deadzone, saturation, and range whenever any of them changes.
+        uint64_t rangeScalePositive = 0;
+
+        /// Fixed-point factor by which the distance of a raw analog value past the negative
+        /// deadzone cutoff is scaled to obtain its distance from neutral in the reportable range.
+        /// Derived from the deadzone, saturation, and range whenever any of them changes.
+        uint64_t rangeScaleNegative = 0;
 
         constexpr SAxisProperties(void)
         {
@@ -221,6 +227,7 @@ namespace Xidi
               (((kAnalogValueMax - kAnalogValueNeutral) * (int32_t)newDeadzone) / kAxisDeadzoneMax);
           deadzoneRawCutoffNegative = kAnalogValueNeutral -
               (((kAnalogValueNeutral - kAnalogValueMin) * (int32_t)newDeadzone) / kAxisDeadzoneMax);
+          UpdateRangeScaleFactors();
         }
 
         /// Sets the range and ensures value consistency between fields, but otherwise performs no
@@ -232,6 +239,7 @@ namespace Xidi
           rangeMin = newRangeMin;
           rangeMax = newRangeMax;
           rangeNeutral = ((newRangeMin + newRangeMax) / 2);
+          UpdateRangeScaleFactors();
         }
 
         /// Sets the saturation and ensures value consistency between fields, but otherwise performs
@@ -246,6 +254,7 @@ namespace Xidi
           saturationRawCutoffNegative = kAnalogValueNeutral -
               (((kAnalogValueNeutral - kAnalogValueMin) * (int32_t)newSaturation) /
                kAxisSaturationMax);
+          UpdateRangeScaleFactors();
         }
 
         /// Sets whether or not the transformations identified by this object should be enabled for
@@ -256,6 +265,30 @@ namespace Xidi
         {
           transformationsEnabled = newTransformationsEnabled;
         }
+
+        /// Recomputes the fixed-point range scale factors so that they are consistent with the
+        /// current deadzone, saturation, and range. Transforming an axis value then requires only
+        /// a multiplication and a shift. If the saturation region begins at or before the end of
+        /// the deadzone region then no raw analog value is ever scaled, so the corresponding factor
+        /// is simply set to 0.
+        constexpr void UpdateRangeScaleFactors(void)
+        {
+          const int64_t rawDistancePositive =
+              (int64_t)saturationRawCutoffPositive - (int64_t)deadzoneRawCutoffPositive;
+          const int64_t rawDistanceNegative =
+              (int64_t)deadzoneRawCutoffNegative - (int64_t)saturationRawCutoffNegative;
+          const int64_t rangeDistancePositive = (int64_t)rangeMax - (int64_t)rangeNeutral;
+          const int64_t rangeDistanceNegative = (int64_t)rangeNeutral - (int64_t)rangeMin;
+
+          rangeScalePositive = ((rawDistancePositive > 0) && (rangeDistancePositive > 0))
+              ? (((uint64_t)rangeDistancePositive << kAxisScaleFactorFractionBits) /
+                 (uint64_t)rawDistancePositive)
+              : 0;
+          rangeScaleNegative = ((rawDistanceNegative > 0) && (rangeDistanceNegative > 0))
+              ? (((uint64_t)rangeDistanceNegative << kAxisScaleFactorFractionBits) /
+                 (uint64_t)rawDistanceNegative)
+              : 0;
+        }
       };
 
       /// Properties that apply to the whole device.
@@ -308,12 +341,41 @@ namespace Xidi
         }
       };
 
+      /// Carries processed state from one virtual controller's state refresh to the next, for
+      /// virtual controllers that are refreshed one after another using the same raw state.
+      /// Virtual controllers with identical axis properties share a single set of axis
+      /// transformation parameters, so all but the first of them can reuse the processed state
+      /// instead of applying the same properties again. All of them also share the timestamp of
+      /// any buffered events they generate, since those events result from one physical input.
+      struct SSharedRefresh
+      {
+        /// Axis transformation parameters used to produce the processed state, or `nullptr` if
+        /// no processed state has been produced yet. Holding a reference keeps the parameters,
+        /// and therefore their identity, valid for as long as this object exists.
+        std::shared_ptr<const Math::SAxisTransformParameters> axisTransformParameters;
+
+      /// Number of property transactions currently open. Accessed only with `controllerMutex`
+      /// held.
+      unsigned int propertyTransactionDepth;
+
+      /// Whether or not properties changed while property transactions were open and therefore
+      /// need to be reapplied once the outermost one ends. Accessed only with `controllerMutex`
+      /// held.
+      bool arePropertiesPendingReapply;
+
+        /// Processed state produced by applying the axis transformation parameters.
+        SState stateProcessed;
+
+        /// Timestamp applied to buffered events, or no value if no virtual controller has
+        /// generated any buffered events yet.
+        std::optional<uint32_t> eventTimestamp;
+      };
+
       VirtualController(TControllerIdentifier controllerId);
 
       VirtualController(const VirtualController& other) = delete;
 
-      /// Cleans up and terminates the background monitoring thread, and unregisters this controller
-      /// for force feedback.
+      /// Unregisters this controller for physical controller state changes and for force feedback.
       ~VirtualController(void);
 
       /// Modifies the contents of the specified controller state object by applying this virtual
@@ -352,6 +414,14 @@ namespace Xidi
         eventFilter.RemoveAll();
       }
 
+      /// Replaces the contents of this virtual controller's event filter so that events are
+      /// generated for exactly the specified virtual controller elements.
+      /// @param [in] elements Element mask identifying the desired virtual controller elements.
+      inline void EventFilterSetElements(TElementMask elements)
+      {
+        eventFilter.SetElements(elements);
+      }
+
       /// Allows access to the force feedback device buffer on the physical controller associated
       /// with this virtual controller.
       /// @return Pointer to the buffer if this controller is registered with the physical
@@ -385,15 +455,30 @@ namespace Xidi
       /// Retrieves and returns the capabilities of this virtual controller.
       /// Controller capabilities act as metadata that are used internally and can be presented to
       /// applications.
-      /// @return Data structure representing the capabilities of this virtual controller.
-      SCapabilities GetCapabilities(void) const;
+      /// @return Read-only reference to the data structure representing the capabilities of this
+      /// virtual controller, which do not change during its lifetime.
+      inline const SCapabilities& GetCapabilities(void) const
+      {
+        return capabilities;
+      }
+
+      /// Retrieves and returns all of the properties of the specified axis. Only the properties of
+      /// the target axis are read, so applications that query axis properties very frequently do
+      /// not cause the properties of every axis to be copied each time.
+      /// @param [in] axis Target axis.
+      /// @return Properties associated with the target axis.
+      inline SAxisProperties GetAxisProperties(EAxis axis) const
+      {
+        return properties.GetPart<SAxisProperties>(
+            offsetof(SProperties, axis) + (sizeof(SAxisProperties) * static_cast<size_t>(axis)));
+      }
 
       /// Retrieves and returns the deadzone property of the specified axis.
       /// @param [in] axis Target axis.
       /// @return Deadzone value associated with the target axis.
       inline uint32_t GetAxisDeadzone(EAxis axis) const
       {
-        return properties[axis].deadzone;
+        return GetAxisProperties(axis).deadzone;
       }
 
       /// Retrieves and returns the range property of the specified axis.
@@ -402,7 +487,8 @@ namespace Xidi
       /// second is the maximum.
       inline std::pair<int32_t, int32_t> GetAxisRange(EAxis axis) const
       {
-        return std::make_pair(properties[axis].rangeMin, properties[axis].rangeMax);
+        const SAxisProperties axisProperties = GetAxisProperties(axis);
+        return std::make_pair(axisProperties.rangeMin, axisProperties.rangeMax);
       }
 
       /// Retrieves and returns the saturation property of the specified axis.
@@ -410,7 +496,7 @@ namespace Xidi
       /// @return Saturation value associated with the target axis.
       inline uint32_t GetAxisSaturation(EAxis axis) const
       {
-        return properties[axis].saturation;
+        return GetAxisProperties(axis).saturation;
       }
 
       /// Retrieves and returns whether or not values read from the physical controller for the
@@ -419,7 +505,7 @@ namespace Xidi
       /// @return Whether or not transformationso are enabled for the target axis.
       inline bool GetAxisTransformationsEnabled(EAxis axis) const
       {
-        return properties[axis].transformationsEnabled;
+        return GetAxisProperties(axis).transformationsEnabled;
       }
 
       /// Retrieves and returns the capacity of the event buffer in number of events.
@@ -436,10 +522,22 @@ namespace Xidi
         return eventBuffer.GetCount();
       }
 
+      /// Retrieves and returns the generation of the state of this virtual controller whose change
+      /// produced the most recent events appended to the event buffer. Comparing it with a
+      /// previous value is sufficient to detect that new events were appended, without acquiring
+      /// the event buffer lock.
+      /// @return State generation associated with the most recent buffered events, or 0 if no
+      /// events were ever buffered.
+      inline uint64_t GetEventBufferStateGeneration(void) const
+      {
+        return eventBuffer.GetStateGeneration();
+      }
+
       /// Retrieves a read-only reference to a buffered event at the specified index, without
       /// performing any bounds-checking. Event with index 0 is the oldest, and higher indices
       /// indicate more recent events. To prevent the event buffer from being modified while
-      /// accessing multiple events, the caller should first obtain this virtual controller's lock.
+      /// accessing multiple events, the caller should first obtain this virtual controller's event
+      /// buffer lock.
       /// @param [in] index Index of the desired event.
       /// @return Read-only reference to the event at the desired index.
       inline const StateChangeEventBuffer::SEvent& GetEventBufferEvent(uint32_t index) const
@@ -447,11 +545,34 @@ namespace Xidi
         return eventBuffer[index];
       }
 
+      /// Identifies up to the specified number of the oldest buffered events without copying or
+      /// removing them. The caller should first obtain this virtual controller's event buffer lock
+      /// and, once finished reading, verify that the events are still intact.
+      /// @param [in] maxCount Maximum number of events to identify.
+      /// @return Spans that together hold the identified events, oldest first.
+      inline StateChangeEventBuffer::SEventSpans PeekEventBufferOldestEvents(
+          uint32_t maxCount) const
+      {
+        return eventBuffer.PeekOldestEvents(maxCount);
+      }
+
+      /// Checks if buffered events previously identified by #PeekEventBufferOldestEvents are still
+      /// intact, meaning they were not overwritten by new events while being read.
+      /// @param [in] eventSpans Events previously identified.
+      /// @return `true` if all events are intact, `false` if they must be identified and read
+      /// again.
+      inline bool AreEventBufferEventsIntact(
+          const StateChangeEventBuffer::SEventSpans& eventSpans) const
+      {
+        return eventBuffer.AreEventsIntact(eventSpans);
+      }
+
       /// Retrieves and returns the force feedback gain property for this controller.
       /// @return Force feedback gain property value.
       inline uint32_t GetForceFeedbackGain(void) const
       {
-        return (uint32_t)properties.device.ffGain;
+        return (uint32_t)properties.GetPart<SDeviceProperties>(offsetof(SProperties, device))
+            .ffGain;
       }
 
       /// Retrieves and returns this controller's identifier.
@@ -462,8 +583,65 @@ namespace Xidi
       }
 
       /// Retrieves and returns the latest view of the state of this virtual controller.
+      /// Never blocks, even while the state is being refreshed, unless a new raw state must first
+      /// be pulled from the physical controller.
       /// @return Current state of this virtual controller.
-      SState GetState(void);
+      inline SState GetState(void) const
+      {
+        PullState();
+        return stateProcessed.Get().state;
+      }
+
+      /// Determines which elements of the state of this virtual controller have changed since the
+      /// specified state generation. If that generation is too old for its changes to still be
+      /// remembered, then all elements are reported as changed. To obtain a result that is
+      /// consistent with the state itself, use #GetStateSince instead.
+      /// @param [in] sinceGeneration State generation of interest, previously obtained using
+      /// #GetStateGeneration or #GetStateSince.
+      /// @return Element mask identifying all elements that might have changed.
+      TElementMask GetStateChangedElementsSince(uint64_t sinceGeneration) const;
+
+      /// Retrieves and returns the generation of the state of this virtual controller. Generation
+      /// number increases by one every time the processed state changes.
+      /// @return Current state generation.
+      inline uint64_t GetStateGeneration(void) const
+      {
+        PullState();
+        return stateProcessed.GetPart<uint64_t>(offsetof(SStateSnapshot, generation));
+      }
+
+      /// Retrieves and returns the latest view of the state of this virtual controller along with
+      /// its generation and the elements that changed since the specified state generation, all
+      /// taken from the same snapshot. Never blocks, even while the state is being refreshed, unless
+      /// a new raw state must first be pulled from the physical controller.
+      /// @param [in] sinceGeneration State generation of interest, previously obtained using
+      /// #GetStateGeneration or this method.
+      /// @param [out] changedElements Filled in with an element mask identifying all elements that
+      /// might have changed since the state generation of interest.
+      /// @param [out] generation Filled in with the generation of the returned state.
+      /// @return Current state of this virtual controller.
+      SState GetStateSince(
+          uint64_t sinceGeneration, TElementMask& changedElements, uint64_t& generation) const;
+
+      /// Behaves the same as #GetStateSince, except that axes in motion are extrapolated forward to
+      /// the current time using their recently-observed velocity. This hides some of the time that
+      /// passed since the state was read from the physical controller. Extrapolation is limited to
+      /// a short horizon after the most recent state change, beyond which the axis is assumed to
+      /// have stopped, and it never leaves the axis range. An axis that reverses direction is not
+      /// extrapolated until its motion is consistent again.
+      /// @param [in] sinceGeneration State generation of interest, previously obtained using
+      /// #GetStateGeneration or either this method or #GetStateSince.
+      /// @param [out] changedElements Filled in with an element mask identifying all elements that
+      /// might have changed since the state generation of interest.
+      /// @param [out] generation Filled in with the generation of the returned state.
+      /// @param [out] extrapolatedElements Filled in with an element mask identifying all axes
+      /// whose values in the returned state were extrapolated.
+      /// @return Current state of this virtual controller, with axes extrapolated.
+      SState GetStateSinceExtrapolated(
+          uint64_t sinceGeneration,
+          TElementMask& changedElements,
+          uint64_t& generation,
+          TElementMask& extrapolatedElements) const;
 
       /// Checks if this virtual controller has a state change event handle which would be signalled
       /// on virtual controller state change.
@@ -487,36 +665,100 @@ namespace Xidi
         return eventBuffer.IsOverflowed();
       }
 
-      /// Locks this virtual controller for ensuring proper concurrency control.
-      /// The returned lock object is scoped and, as a result, will automatically unlock this
-      /// virtual controller upon its destruction. Used internally for this purpose, and can be used
-      /// externally for locking ahead of bulk events or direct event buffer access.
+      /// Locks this virtual controller for modification. Serializes the thread that refreshes this
+      /// virtual controller's state with threads that change its properties or its event filter.
+      /// Reading state or properties does not require this lock. The returned lock object is
+      /// scoped and, as a result, will automatically unlock this virtual controller upon its
+      /// destruction. Not recursive, so it must not be held while invoking methods of this virtual
+      /// controller that modify it.
       /// @return Scoped lock object that has acquired this virtual controller's concurrency control
       /// mutex.
-      inline std::unique_lock<std::recursive_mutex> Lock(void)
+      inline std::unique_lock<ProfiledMutex<std::mutex>> Lock(void)
       {
         return std::unique_lock(controllerMutex);
       }
 
+      /// Locks this virtual controller's event buffer for consumption. Only one consumer may read
+      /// and pop events at a time, but doing so does not contend with the thread that refreshes
+      /// this virtual controller's state and appends new events. The returned lock object is
+      /// scoped and, as a result, will automatically unlock the event buffer upon its destruction.
+      /// @return Scoped lock object that has acquired this virtual controller's event buffer mutex.
+      inline std::unique_lock<ProfiledMutex<std::recursive_mutex>> LockEventBuffer(void)
+      {
+        return std::unique_lock(eventBufferMutex);
+      }
+
+      /// Removes and discards buffered events previously identified by #PeekEventBufferOldestEvents
+      /// and clears any present overflow condition. Takes constant time.
+      /// @param [in] eventSpans Events previously identified.
+      void PopEventBufferEvents(const StateChangeEventBuffer::SEventSpans& eventSpans);
+
       /// Removes and discards up to the specified number of the oldest events from this virtual
       /// controller's event buffer and clears any present overflow condition.
       /// @param [in] numEventsToPop Maximum number of events to remove.
       void PopEventBufferOldestEvents(uint32_t numEventsToPop);
 
+      /// Begins a property transaction. Until the matching #EndPropertyTransaction, the property
+      /// setters validate and store new property values as usual, and those values are immediately
+      /// visible to the property getters, but they are not yet applied to this virtual controller's
+      /// state. Useful for changing several properties at once without reprocessing the state after
+      /// each one. Transactions can be nested, in which case the outermost one determines when the
+      /// new property values are applied. Must not be invoked with this virtual controller's lock
+      /// held.
+      void BeginPropertyTransaction(void);
+
+      /// Ends a property transaction previously begun with #BeginPropertyTransaction. If this is
+      /// the outermost transaction and any property changed while it was open, then the new
+      /// property values are applied to this virtual controller's state exactly once. Must not be
+      /// invoked with this virtual controller's lock held.
+      void EndPropertyTransaction(void);
+
       /// Generates this virtual controller's processed state view by applying this virtual
-      /// controller's properties to its raw state view. Not concurrency-safe, and primarily
-      /// intended for internal use.
+      /// controller's properties to its raw state view and publishes it if it changed. Not
+      /// concurrency-safe unless this virtual controller's lock is held, and primarily intended for
+      /// internal use.
       void ReapplyProperties(void);
 
       /// Refreshes the virtual controller's state using the supplied new state data.
-      /// Primarily intended to be called by a background thread, but exposed externally for
-      /// testing.
+      /// Primarily intended to be called by the thread that polls the associated physical
+      /// controller, but exposed externally for testing.
       /// @param [in] newRawVirtualStateData Raw virtual controller state data to apply to this
       /// virtual controller's internal state view.
       /// @return `true` if the state of the controller changed as a result of applying the new
       /// state data, `false` otherwise.
       bool RefreshState(SState newRawVirtualStateData);
 
+      /// Refreshes the virtual controller's state using the supplied new state data, reusing the
+      /// processed state produced by an earlier refresh of a different virtual controller if its
+      /// properties are identical to this one's. The same shared refresh object must only ever be
+      /// used with the same raw virtual controller state data.
+      /// @param [in] newRawVirtualStateData Raw virtual controller state data to apply to this
+      /// virtual controller's internal state view.
+      /// @param [in, out] sharedRefresh Processed state shared between virtual controllers being
+      /// refreshed using the same raw virtual controller state data.
+      /// @return `true` if the state of the controller changed as a result of applying the new
+      /// state data, `false` otherwise.
+      bool RefreshState(SState newRawVirtualStateData, SSharedRefresh& sharedRefresh);
+
+      /// Behaves the same as #RefreshState, except that if nothing observes changes to this virtual
+      /// controller's state as they happen, meaning it has neither an event buffer nor a state
+      /// change event handle, then this virtual controller is in pull mode and nothing is done at
+      /// all, not even acquiring its lock. Instead, the next read of its state compares the
+      /// generation of the raw state published by the physical controller with the generation it
+      /// last processed and applies properties only if they differ. A consumer that only reads on
+      /// its own schedule, such as the WinMM interface, therefore costs nothing while the physical
+      /// controller is being polled. Switching to push mode happens automatically once an event
+      /// buffer or a state change event handle is configured. Intended to be called by the thread
+      /// that polls the associated physical controller, and only after the new raw state data
+      /// have been published to the physical controller's state.
+      /// @param [in] newRawVirtualStateData Raw virtual controller state data to apply to this
+      /// virtual controller's internal state view.
+      /// @param [in, out] sharedRefresh Processed state shared between virtual controllers being
+      /// refreshed using the same raw virtual controller state data.
+      /// @return `true` if the state of the controller changed as a result of applying the new
+      /// state data, `false` if it did not or if this virtual controller is in pull mode.
+      bool RefreshStateOrDefer(SState newRawVirtualStateData, SSharedRefresh& sharedRefresh);
+
       /// Sets the deadzone property for a single axis.
       /// @param [in] axis Target axis.
       /// @param [in] deadzone Desired deadzone value.
@@ -587,45 +829,228 @@ namespace Xidi
       /// entirely.
       void SetStateChangeEvent(HANDLE eventHandle);
 
-      /// Signals the state change event.
-      /// Intended to be invoked internally.
+      /// Retrieves the minimum time between state change event signals caused by axis movement
+      /// alone that is currently in effect for this virtual controller.
+      /// @return Minimum time between signals in milliseconds, 0 if there is no minimum.
+      DWORD GetStateChangeEventPeriod(void) const;
+
+      /// Overrides the minimum time between state change event signals caused by axis movement
+      /// alone for this virtual controller. Otherwise the configuration file determines this
+      /// period for all virtual controllers.
+      /// @param [in] periodMilliseconds Minimum time between signals in milliseconds, 0 for no
+      /// minimum, or no value to revert to the period set in the configuration file.
+      void SetStateChangeEventPeriod(std::optional<DWORD> periodMilliseconds);
+
+      /// Signals the state change event, unless the configuration file limits signals and the
+      /// state changes since the previous signal do not qualify. If only axes changed and the
+      /// minimum time between signals has not yet elapsed, a trailing signal is scheduled for when
+      /// it does, so that the final position of an axis that stops moving is still signalled.
+      /// Concurrency-safe, and invoked after a refresh that changed the state of this virtual
+      /// controller. Intended to be invoked internally.
       void SignalStateChangeEvent(void);
 
     private:
 
+      /// Sentinel value indicating that the state change event period is not overridden.
+      static constexpr DWORD kStateChangeEventPeriodNotOverridden = static_cast<DWORD>(-1);
+
+      /// Sentinel value indicating that the generation of the raw state is not known, either
+      /// because it was pushed or because it has never been pulled.
+      static constexpr TGeneration kStateRawGenerationUnknown = static_cast<TGeneration>(-1);
+
+      /// Number of most recent state changes for which the set of changed elements is remembered.
+      static constexpr unsigned int kStateChangeHistoryCount = 16;
+
+      /// Maximum amount of time after the most recent state change for which axes are
+      /// extrapolated. Axes in motion change at every poll, so a longer gap means they stopped.
+      static constexpr std::chrono::milliseconds kAxisExtrapolationHorizon =
+          std::chrono::milliseconds(8);
+
+      /// Maximum amount of time between consecutive state changes for them to be used to estimate
+      /// axis velocity. Motion that resumes after a longer gap starts again from no velocity.
+      static constexpr std::chrono::milliseconds kAxisVelocityMaximumSampleInterval =
+          std::chrono::milliseconds(25);
+
+      /// Weight given to each new velocity sample when smoothing the axis velocity estimate.
+      static constexpr float kAxisVelocitySmoothingFactor = 0.5f;
+
+      /// Fully processed state of the virtual controller, along with enough history to determine
+      /// which elements changed recently. Published as a single unit so that readers always see a
+      /// consistent view.
+      struct SStateSnapshot
+      {
+        /// State of the virtual controller with all properties applied.
+        SState state;
+
+        /// Generation of the state, incremented every time it changes.
+        uint64_t generation;
+
+        /// Elements that changed as part of each of the most recent state changes, indexed by
+        /// state generation modulo the size of the history.
+        std::array<TElementMask, kStateChangeHistoryCount> changeHistory;
+
+        /// Estimated velocity of each axis, in axis units per millisecond, as of the time the state
+        /// was published.
+        std::array<float, static_cast<int>(EAxis::Count)> axisVelocity;
+
+        /// Time at which the state was published.
+        std::chrono::steady_clock::time_point publishTime;
+      };
+
+      /// Determines which elements changed between the specified state generation and the state
+      /// held in the specified snapshot.
+      /// @param [in] snapshot State snapshot to examine.
+      /// @param [in] sinceGeneration State generation of interest.
+      /// @return Element mask identifying all elements that might have changed.
+      static TElementMask ChangedElementsSince(
+          const SStateSnapshot& snapshot, uint64_t sinceGeneration);
+
+      /// Determines if this virtual controller's state can be pulled from the physical controller
+      /// when it is read rather than pushed to it whenever it changes. Must be invoked with this
+      /// virtual controller's lock held.
+      /// @return `true` if so, `false` otherwise.
+      bool CanPullState(void) const;
+
+      /// Brings this virtual controller's processed state up to date with the raw state published
+      /// by the physical controller, if this virtual controller is in pull mode. Does nothing in
+      /// push mode, in which the processed state is always up to date.
+      inline void PullState(void) const
+      {
+        if (true == isPullModeActive.load(std::memory_order_acquire)) PullStateSlow();
+      }
+
+      /// Implements the part of #PullState that is needed in pull mode. Acquires this virtual
+      /// controller's lock only if the physical controller has published a raw state that has not
+      /// yet been processed. Must not be invoked with the lock held.
+      void PullStateSlow(void) const;
+
+      /// Brings this virtual controller's processed state up to date with the raw state published
+      /// by the physical controller, if this virtual controller is in pull mode. Must be invoked
+      /// with this virtual controller's lock held.
+      void PullStateLocked(void);
+
+      /// Replaces the raw state with the one published by the physical controller if its
+      /// generation differs from the one last pulled. Must be invoked with this virtual
+      /// controller's lock held.
+      /// @return `true` if the raw state was replaced, `false` if it was already up to date.
+      bool PullRawStateLocked(void);
+
+      /// Schedules a trailing signal of the state change event after the specified delay, unless
+      /// one is already scheduled. Must be invoked with `stateChangeSignalMutex` held.
+      /// @param [in] delayMilliseconds Time from now after which to signal, in milliseconds.
+      void ScheduleTrailingStateChangeSignal(DWORD delayMilliseconds);
+
+      /// Switches between pull mode and push mode according to whether or not anything observes
+      /// changes to this virtual controller's state as they happen. Must be invoked with this
+      /// virtual controller's lock held, whenever the event buffer or the state change event handle
+      /// changes.
+      void UpdateRefreshMode(void);
+
+      /// Reapplies properties after they have been changed, unless a property transaction is open,
+      /// in which case properties are instead marked as needing to be reapplied once it ends. Must
+      /// be invoked with this virtual controller's lock held.
+      void ReapplyChangedProperties(void);
+
+      /// Publishes a new processed state, recording which elements changed, if it differs from the
+      /// currently-published processed state. Must be invoked with this virtual controller's lock
+      /// held.
+      /// @param [in] newStateProcessed New processed state.
+      /// @param [out] oldStateProcessed Filled in with the previously-published processed state.
+      /// @param [in] isPhysicalSample Whether or not the new state was produced by a new physical
+      /// controller sample, as opposed to a change in properties. Only physical samples contribute
+      /// to axis velocity estimates.
+      /// @return `true` if the new state differs and was published, `false` otherwise.
+      bool PublishStateProcessed(
+          const SState& newStateProcessed, SState& oldStateProcessed, bool isPhysicalSample);
+
       /// Controller identifier to be used when communicating with the underlying real controller.
       const TControllerIdentifier kControllerIdentifier;
 
-      /// Provides concurrency control to the data structures in this virtual controller.
-      std::recursive_mutex controllerMutex;
-
-      /// Buffer for holding controller state change events.
+      /// Capabilities of this virtual controller, which are determined by the mapper and do not
+      /// change during the lifetime of this object. Obtained once, at construction time, so that
+      /// refreshing state does not require them to be rebuilt.
+      const SCapabilities capabilities;
+
+      /// Serializes all modifications to the data structures in this virtual controller. Readers of
+      /// state and properties never acquire it, so it is contended only by writers.
+      ProfiledMutex<std::mutex> controllerMutex;
+
+      /// Serializes consumers of the event buffer with each other and with changes to the event
+      /// buffer capacity. Not needed to append events, which is done with `controllerMutex` held.
+      /// The thread that refreshes state tries to acquire it without waiting, so that it can merge
+      /// axis events in place or release idle event storage if no consumer is active, and waits
+      /// for it only when event storage needs to grow. It must therefore never be held while
+      /// waiting to acquire `controllerMutex`.
+      ProfiledMutex<std::recursive_mutex> eventBufferMutex;
+
+      /// Buffer for holding controller state change events. Events are appended while refreshing
+      /// state and are consumed concurrently by the application.
       StateChangeEventBuffer eventBuffer;
 
       /// Filter to be used for deciding which controller elements are allowed to generate buffered
-      /// events. Default state is all controller elements are included in the filter.
+      /// events. Default state is all controller elements are included in the filter. Modified
+      /// only with `controllerMutex` held.
       EventFilter eventFilter;
 
-      /// All properties associated with this virtual controller.
-      SProperties properties;
+      /// All properties associated with this virtual controller. Changed rarely and only with
+      /// `controllerMutex` held, each time by publishing a complete new copy, so that readers never
+      /// observe a partially-applied change.
+      SeqLockConcurrencyWrapper<SProperties> properties;
+
+      /// Axis properties converted to the form used to transform all axis values at once. Updated
+      /// whenever properties are reapplied and accessed only with `controllerMutex` held. Shared
+      /// with all other virtual controllers whose axis properties are identical.
+      std::shared_ptr<const Math::SAxisTransformParameters> axisTransformParameters;
 
       /// State of the virtual controller as of the last refresh.
-      /// Raw values, with no properties or other processing applied.
+      /// Raw values, with no properties or other processing applied. Accessed only with
+      /// `controllerMutex` held.
       SState stateRaw;
 
+      /// Generation number, as published by the physical controller, of the raw state last pulled
+      /// into `stateRaw`. Holds #kStateRawGenerationUnknown if `stateRaw` was last pushed, so that
+      /// the next pull always replaces it. Modified only with `controllerMutex` held but read
+      /// without locking, so that readers can tell if they need to pull.
+      std::atomic<TGeneration> stateRawGeneration;
+
+      /// Whether or not this virtual controller is in pull mode, in which the physical controller
+      /// does not push raw states to it and readers pull them instead. Modified only with
+      /// `controllerMutex` held but read without locking both by readers and by the thread that
+      /// pushes raw states.
+      std::atomic<bool> isPullModeActive;
+
       /// State of the virtual controller as of the last refresh.
-      /// Fully processed, all properties have been applied.
-      SState stateProcessed;
+      /// Fully processed, all properties have been applied. Published at the polling rate and read
+      /// without locking.
+      SeqLockConcurrencyWrapper<SStateSnapshot> stateProcessed;
 
       /// State change event notification handle, optionally provided by applications.
       /// The underlying event object is owned by the application, not by this object.
       HANDLE stateChangeEventHandle;
 
-      /// Background thread that monitors the associated physical controller for updates.
-      std::thread physicalControllerMonitor;
-
-      /// Used to indicate that the physical controller monitor thread should stop running.
-      std::stop_source physicalControllerMonitorStop;
+      /// Minimum time between state change event signals caused by axis movement alone, in
+      /// milliseconds, overriding the configuration file for this virtual controller. Holds
+      /// #kStateChangeEventPeriodNotOverridden if there is no override.
+      std::atomic<DWORD> stateChangeEventPeriodOverride;
+
+      /// State of the virtual controller as of the most recent signal of the state change event.
+      /// Only maintained if signals are limited, and accessed only with `stateChangeSignalMutex`
+      /// held.
+      SState stateLastSignalled;
+
+      /// Time, in milliseconds as reported by the system multimedia timer, of the most recent
+      /// signal of the state change event. Maintained and accessed the same way as
+      /// `stateLastSignalled`.
+      DWORD timeLastSignalled;
+
+      /// Serializes signalling the state change event between the thread that refreshes state and
+      /// the thread pool thread that delivers trailing signals.
+      ProfiledMutex<std::mutex> stateChangeSignalMutex;
+
+      /// Thread pool timer used to deliver a trailing state change event signal once the minimum
+      /// time between signals has elapsed. Created the first time a signal is postponed and
+      /// accessed only with `stateChangeSignalMutex` held, other than during destruction.
+      PTP_TIMER trailingSignalTimer;
 
       /// Pointer to the physical device force feedback buffer. Valid only if this virtual
       /// controller object is registered for force feedback, `nullptr` all other times.
@@ -12,8 +12,11 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 #include "ApiDirectInput.h"
 #include "DataFormat.h"
@@ -213,8 +216,57 @@ namespace Xidi
     /// requires that an applicaton acquire the device in exclusive mode.
     ECooperativeLevel cooperativeLevel;
 
-    /// Data format specification for communicating with the DirectInput application.
-    std::unique_ptr<DataFormat> dataFormat;
+    /// Prebuilt object instance information record for a single object presented by this device.
+    struct SObjectInstanceRecord
+    {
+      /// Virtual controller element that the object represents, or the whole controller if the
+      /// object is a HID collection.
+      Controller::SElementIdentifier element;
+
+      /// Object instance information, complete except for the offset, which depends on the data
+      /// format and is therefore filled in whenever the record is used.
+      typename DirectInputTypes<diVersion>::DeviceObjectInstanceType instance;
+    };
+
+    /// Object instance information for all objects presented by this device, in enumeration order.
+    /// Built once at construction time from the virtual controller's capabilities, which do not
+    /// change afterwards, so that enumerating objects does not regenerate any of it.
+    std::vector<SObjectInstanceRecord> objectInstanceTable;
+
+    /// Data format specification for communicating with the DirectInput application. Shared with
+    /// all other devices to which the application has set the same data format.
+    std::shared_ptr<const DataFormat> dataFormat;
+
+    /// Information about the most recent application data packet written in its entirety or in
+    /// part when the application retrieved device state. A ready-made copy of the packet is kept
+    /// and is only updated when the virtual controller state generation moves, so that repeated
+    /// retrievals of unchanged state are just a copy. If incremental device state retrieval is
+    /// enabled and the application supplies the same buffer again, only the elements that changed
+    /// since then are written. Invalidated whenever the data format changes.
+    struct
+    {
+      /// Application buffer into which the data packet was written, or `nullptr` if invalid.
+      const void* buffer = nullptr;
+
+      /// Size of the application buffer, in bytes.
+      DWORD bufferSizeBytes = 0;
+
+      /// Generation of the virtual controller state that was written.
+      uint64_t stateGeneration = 0;
+
+      /// Axes whose written values were extrapolated rather than taken from the virtual controller
+      /// state as published, which means they must be written again even if the generation of
+      /// that state does not move.
+      Controller::TElementMask extrapolatedElements = 0;
+
+      /// Copy of the data packet that was written, or empty if invalid.
+      std::vector<uint8_t> packet;
+    } lastDeviceState;
+
+    /// Serializes application threads that retrieve device state with each other and with changes
+    /// to the data format. Never acquired by the thread that refreshes virtual controller state,
+    /// so retrieving device state never waits for it.
+    std::mutex deviceStateMutex;
 
     /// Registry of all force feedback effect objects created by this object. Deliberately not
     /// type-safe to avoid a circular dependency between header files. Used exclusively to allow
@@ -224,6 +276,11 @@ namespace Xidi
     /// Reference count.
     std::atomic<unsigned long> refCount;
 
+    /// Physical controller polling period requested by the application using the Xidi-specific
+    /// polling policy property, in milliseconds, or 0 if there is no outstanding request. Any
+    /// outstanding request is withdrawn when this object is destroyed.
+    std::atomic<DWORD> requestedPollingPeriodMilliseconds;
+
     /// Storage for all properties that are silently supported but not used by Xidi. Others can be
     /// added here as needed.
     struct
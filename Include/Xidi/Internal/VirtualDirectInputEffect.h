@@ -132,17 +132,18 @@ namespace Xidi
       return DI_OK;
     }
 
-    /// Clones the underlying effect, updates the clone's type-specific effect parameters, and
-    /// returns the result. Can be overridden by subclasses. The default implementation does nothing
-    /// and returns success.
+    /// Updates the type-specific effect parameters of the supplied effect object, which is
+    /// expected to be of the same type as the underlying effect. Can be overridden by subclasses.
+    /// The default implementation does nothing and returns success.
     /// @param [in] peff Structure containing type-specific effect parameter data.
-    /// @return Either a copy of the effect with type-specific parameters updated or `nullptr` if
-    /// the parameters are invalid. Parameters are invalid if the size in the input structure is
-    /// wrong or if a semantic validity check fails.
-    virtual std::unique_ptr<Controller::ForceFeedback::Effect> CloneAndSetTypeSpecificParameters(
-        LPCDIEFFECT peff)
+    /// @param [in, out] targetEffect Effect object whose type-specific parameters are to be set.
+    /// @return `true` if the parameters were valid and successfully set, `false` otherwise.
+    /// Parameters are invalid if the size in the input structure is wrong or if a semantic
+    /// validity check fails.
+    virtual bool SetTypeSpecificParameters(
+        LPCDIEFFECT peff, Controller::ForceFeedback::Effect& targetEffect)
     {
-      return effect->Clone();
+      return true;
     }
 
   private:
@@ -153,6 +154,11 @@ namespace Xidi
     /// Underlying force feedback effect object.
     std::unique_ptr<Controller::ForceFeedback::Effect> effect;
 
+    /// Effect object of the same type and identifier as the underlying effect, used to stage and
+    /// validate parameter updates before they are committed. Allocated once at construction so
+    /// that setting parameters does not need to clone the underlying effect each time.
+    std::unique_ptr<Controller::ForceFeedback::Effect> stagingEffect;
+
     /// GUID that identifies this effect.
     const GUID& effectGuid;
 
@@ -214,27 +220,22 @@ namespace Xidi
       return DI_OK;
     }
 
-    std::unique_ptr<Controller::ForceFeedback::Effect> CloneAndSetTypeSpecificParameters(
-        LPCDIEFFECT peff)
+    bool SetTypeSpecificParameters(
+        LPCDIEFFECT peff, Controller::ForceFeedback::Effect& targetEffect) override
     {
-      if (peff->cbTypeSpecificParams < sizeof(DirectInputTypeSpecificParameterType)) return nullptr;
+      if (peff->cbTypeSpecificParams < sizeof(DirectInputTypeSpecificParameterType)) return false;
 
-      if (nullptr == peff->lpvTypeSpecificParams) return nullptr;
+      if (nullptr == peff->lpvTypeSpecificParams) return false;
 
       const DirectInputTypeSpecificParameterType& directInputTypeSpecificParams =
           *((DirectInputTypeSpecificParameterType*)peff->lpvTypeSpecificParams);
       const TypeSpecificParameterType typeSpecificParameters =
           ConvertFromDirectInput(directInputTypeSpecificParams);
 
-      std::unique_ptr<Controller::ForceFeedback::Effect> updatedEffect =
-          TypedUnderlyingEffect().Clone();
-      if (false ==
-          ((Controller::ForceFeedback::EffectWithTypeSpecificParameters<TypeSpecificParameterType>*)
-               updatedEffect.get())
-              ->SetTypeSpecificParameters(typeSpecificParameters))
-        return nullptr;
-
-      return std::move(updatedEffect);
+      return static_cast<
+                 Controller::ForceFeedback::EffectWithTypeSpecificParameters<
+                     TypeSpecificParameterType>&>(targetEffect)
+          .SetTypeSpecificParameters(typeSpecificParameters);
     }
 
     /// Converts from the DirectInput type-specific parameter type to the internal type-specific
@@ -387,4 +388,157 @@ namespace Xidi
     // VirtualDirectInputEffect
     void DumpTypeSpecificParameters(LPCDIEFFECT peff) const override;
   };
+
+  /// Concrete DirectInput force feedback effect object type for custom force effects. DirectInput
+  /// passes custom force samples by pointer, so conversion is done here rather than by the template
+  /// for single-structure type-specific parameters. Samples are copied into an immutable buffer
+  /// once per parameter update, and only if they differ from the samples the effect already holds.
+  /// @tparam charMode Selects between ASCII ("A" suffix) and Unicode ("W") suffix versions of types
+  /// and interfaces.
+  template <EDirectInputVersion diVersion> class CustomForceDirectInputEffect
+      : public VirtualDirectInputEffect<diVersion>
+  {
+  public:
+
+    inline CustomForceDirectInputEffect(
+        VirtualDirectInputDeviceBase<diVersion>& associatedDevice,
+        const Controller::ForceFeedback::CustomForceEffect& effect,
+        const GUID& effectGuid)
+        : VirtualDirectInputEffect<diVersion>(associatedDevice, effect, effectGuid)
+    {}
+
+  protected:
+
+    /// Type-casts and returns a reference to the underlying effect.
+    /// No run-time checks are performed, but the type-cast operation is safe based on the types
+    /// allowed for the initialization constructor parameters.
+    /// @return Type-casted reference to the underlying effect.
+    inline Controller::ForceFeedback::CustomForceEffect& TypedUnderlyingEffect(void)
+    {
+      return static_cast<Controller::ForceFeedback::CustomForceEffect&>(
+          VirtualDirectInputEffect<diVersion>::UnderlyingEffect());
+    }
+
+    // VirtualDirectInputEffect
+    void DumpTypeSpecificParameters(LPCDIEFFECT peff) const override;
+    HRESULT GetTypeSpecificParameters(LPDIEFFECT peff) override;
+    bool SetTypeSpecificParameters(
+        LPCDIEFFECT peff, Controller::ForceFeedback::Effect& targetEffect) override;
+  };
+
+  /// Concrete DirectInput force feedback effect object type for condition effects. DirectInput
+  /// represents the type-specific parameters of condition effects as an array of structures, one
+  /// per axis or a single one that applies to all axes, so conversion is done here rather than by
+  /// the template for single-structure type-specific parameters.
+  /// @tparam charMode Selects between ASCII ("A" suffix) and Unicode ("W") suffix versions of types
+  /// and interfaces.
+  template <EDirectInputVersion diVersion> class ConditionDirectInputEffect
+      : public VirtualDirectInputEffect<diVersion>
+  {
+  public:
+
+    inline ConditionDirectInputEffect(
+        VirtualDirectInputDeviceBase<diVersion>& associatedDevice,
+        const Controller::ForceFeedback::ConditionEffect& effect,
+        const GUID& effectGuid)
+        : VirtualDirectInputEffect<diVersion>(associatedDevice, effect, effectGuid)
+    {}
+
+  protected:
+
+    /// Type-casts and returns a reference to the underlying effect.
+    /// No run-time checks are performed, but the type-cast operation is safe based on the types
+    /// allowed for the initialization constructor parameters.
+    /// @return Type-casted reference to the underlying effect.
+    inline Controller::ForceFeedback::ConditionEffect& TypedUnderlyingEffect(void)
+    {
+      return static_cast<Controller::ForceFeedback::ConditionEffect&>(
+          VirtualDirectInputEffect<diVersion>::UnderlyingEffect());
+    }
+
+    /// Converts a single-axis condition from DirectInput format to internal format. Performs no
+    /// error-checking.
+    /// @param [in] diCondition Single-axis condition in DirectInput format.
+    /// @return Results of the conversion.
+    static inline Controller::ForceFeedback::SAxisCondition ConvertFromDirectInput(
+        const DICONDITION& diCondition)
+    {
+      return {
+          .offset = (Controller::ForceFeedback::TEffectValue)diCondition.lOffset,
+          .positiveCoefficient =
+              (Controller::ForceFeedback::TEffectValue)diCondition.lPositiveCoefficient,
+          .negativeCoefficient =
+              (Controller::ForceFeedback::TEffectValue)diCondition.lNegativeCoefficient,
+          .positiveSaturation =
+              (Controller::ForceFeedback::TEffectValue)diCondition.dwPositiveSaturation,
+          .negativeSaturation =
+              (Controller::ForceFeedback::TEffectValue)diCondition.dwNegativeSaturation,
+          .deadBand = (Controller::ForceFeedback::TEffectValue)diCondition.lDeadBand};
+    }
+
+    /// Converts a single-axis condition from internal format to DirectInput format. Performs no
+    /// error-checking.
+    /// @param [in] axisCondition Single-axis condition in internal format.
+    /// @return Results of the conversion.
+    static inline DICONDITION ConvertToDirectInput(
+        const Controller::ForceFeedback::SAxisCondition& axisCondition)
+    {
+      return {
+          .lOffset = (LONG)axisCondition.offset,
+          .lPositiveCoefficient = (LONG)axisCondition.positiveCoefficient,
+          .lNegativeCoefficient = (LONG)axisCondition.negativeCoefficient,
+          .dwPositiveSaturation = (DWORD)axisCondition.positiveSaturation,
+          .dwNegativeSaturation = (DWORD)axisCondition.negativeSaturation,
+          .lDeadBand = (LONG)axisCondition.deadBand};
+    }
+
+    // VirtualDirectInputEffect
+    void DumpTypeSpecificParameters(LPCDIEFFECT peff) const override;
+
+    HRESULT GetTypeSpecificParameters(LPDIEFFECT peff) override
+    {
+      if (false == TypedUnderlyingEffect().HasTypeSpecificParameters())
+        return DIERR_INVALIDPARAM;
+
+      const Controller::ForceFeedback::SConditionParameters& conditionParameters =
+          TypedUnderlyingEffect().GetTypeSpecificParameters().value();
+      const DWORD requiredSize = (DWORD)(sizeof(DICONDITION) * conditionParameters.count);
+
+      if (peff->cbTypeSpecificParams < requiredSize)
+      {
+        peff->cbTypeSpecificParams = requiredSize;
+        return DIERR_MOREDATA;
+      }
+
+      if (nullptr == peff->lpvTypeSpecificParams) return DIERR_INVALIDPARAM;
+
+      peff->cbTypeSpecificParams = requiredSize;
+      for (int i = 0; i < conditionParameters.count; ++i)
+        ((DICONDITION*)peff->lpvTypeSpecificParams)[i] =
+            ConvertToDirectInput(conditionParameters.axis[i]);
+
+      return DI_OK;
+    }
+
+    bool SetTypeSpecificParameters(
+        LPCDIEFFECT peff, Controller::ForceFeedback::Effect& targetEffect) override
+    {
+      if ((0 == peff->cbTypeSpecificParams) ||
+          (0 != (peff->cbTypeSpecificParams % sizeof(DICONDITION))))
+        return false;
+
+      const int count = (int)(peff->cbTypeSpecificParams / sizeof(DICONDITION));
+      if (count > Controller::ForceFeedback::kEffectAxesMaximumNumber) return false;
+
+      if (nullptr == peff->lpvTypeSpecificParams) return false;
+
+      Controller::ForceFeedback::SConditionParameters conditionParameters = {.count = count};
+      for (int i = 0; i < count; ++i)
+        conditionParameters.axis[i] =
+            ConvertFromDirectInput(((const DICONDITION*)peff->lpvTypeSpecificParams)[i]);
+
+      return static_cast<Controller::ForceFeedback::ConditionEffect&>(targetEffect)
+          .SetTypeSpecificParameters(conditionParameters);
+    }
+  };
 } // namespace Xidi
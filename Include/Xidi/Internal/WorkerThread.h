@@ -0,0 +1,141 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file WorkerThread.h
+ *   Declaration of functionality for creating named background threads with priorities, and
+ *   optionally processor core types, that reflect how sensitive they are to scheduling latency.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "ApiWindows.h"
+
+namespace Xidi
+{
+  namespace WorkerThread
+  {
+    /// Enumerates the scheduling priority classes available to background threads. Housekeeping
+    /// and latency-critical threads can additionally be restricted to a type of processor core
+    /// using the configuration file.
+    enum class EPriority
+    {
+      /// Periodic monitoring, logging, and other work that can tolerate delays. Runs below
+      /// normal priority.
+      Housekeeping,
+
+      /// Work that has no particular latency requirements. Runs at normal priority.
+      Normal,
+
+      /// Physical controller polling, force feedback actuation, and delivery of input events to
+      /// the system or the application. Runs above normal priority.
+      LatencyCritical
+    };
+
+    /// Stack size reserved for detached background threads, in bytes. None of them use more than
+    /// a small fraction of the linker default of 1 MB.
+    inline constexpr size_t kDetachedThreadStackReservationBytes = 256 * 1024;
+
+    /// Assigns a name, visible in debuggers and profilers, and a scheduling priority to the
+    /// calling thread.
+    /// @param [in] name Name to assign.
+    /// @param [in] priority Scheduling priority class to assign.
+    void ConfigureCurrentThread(std::wstring_view name, EPriority priority);
+
+    /// Creates a thread with a reduced stack reservation that runs the specified entry point
+    /// and then exits. Intended to be used internally by #StartDetached.
+    /// @param [in] threadProc Entry point of the new thread.
+    /// @param [in] threadParam Parameter to pass to the entry point.
+    /// @return `true` if the thread was created, `false` otherwise.
+    bool CreateDetachedWithReducedStack(LPTHREAD_START_ROUTINE threadProc, LPVOID threadParam);
+
+    /// Holds everything that a detached background thread needs to start running.
+    /// @tparam Callable Type of the bound entry point.
+    template <typename Callable> struct SDetachedThreadStartInfo
+    {
+      /// Name to assign to the thread.
+      std::wstring name;
+
+      /// Scheduling priority class to assign to the thread.
+      EPriority priority;
+
+      /// Entry point, with all of its arguments already bound.
+      Callable entryPoint;
+    };
+
+    /// Entry point of every detached background thread. Takes ownership of the start
+    /// information, configures the thread, and invokes the bound entry point.
+    /// @tparam Callable Type of the bound entry point.
+    /// @param [in] threadParam Pointer to the start information.
+    /// @return Always 0.
+    template <typename Callable> DWORD WINAPI DetachedThreadProc(LPVOID threadParam)
+    {
+      std::unique_ptr<SDetachedThreadStartInfo<Callable>> startInfo(
+          static_cast<SDetachedThreadStartInfo<Callable>*>(threadParam));
+
+      ConfigureCurrentThread(startInfo->name, startInfo->priority);
+      std::move(startInfo->entryPoint)();
+      return 0;
+    }
+
+    /// Creates a named and prioritized thread that can later be joined. These use the default
+    /// stack reservation because they are owned by objects that expect to manage them as
+    /// standard thread objects.
+    /// @param [in] name Name to assign to the thread.
+    /// @param [in] priority Scheduling priority class to assign to the thread.
+    /// @param [in] entryPoint Function for the thread to run.
+    /// @param [in] args Arguments to pass to the thread function.
+    /// @return Newly-created thread object.
+    template <typename Function, typename... Args> std::thread Create(
+        std::wstring_view name, EPriority priority, Function&& entryPoint, Args&&... args)
+    {
+      return std::thread(
+          [threadName = std::wstring(name), priority](auto boundEntryPoint) -> void
+          {
+            ConfigureCurrentThread(threadName, priority);
+            std::move(boundEntryPoint)();
+          },
+          std::bind_front(std::forward<Function>(entryPoint), std::forward<Args>(args)...));
+    }
+
+    /// Starts a named and prioritized thread that runs independently until its function
+    /// returns. These use a reduced stack reservation. If a thread with a reduced stack
+    /// reservation cannot be created, a thread with the default stack reservation is used.
+    /// @param [in] name Name to assign to the thread.
+    /// @param [in] priority Scheduling priority class to assign to the thread.
+    /// @param [in] entryPoint Function for the thread to run.
+    /// @param [in] args Arguments to pass to the thread function.
+    template <typename Function, typename... Args> void StartDetached(
+        std::wstring_view name, EPriority priority, Function&& entryPoint, Args&&... args)
+    {
+      using TCallable = std::decay_t<decltype(std::bind_front(
+          std::forward<Function>(entryPoint), std::forward<Args>(args)...))>;
+
+      std::unique_ptr<SDetachedThreadStartInfo<TCallable>> startInfo(
+          new SDetachedThreadStartInfo<TCallable>{
+              .name = std::wstring(name),
+              .priority = priority,
+              .entryPoint = std::bind_front(
+                  std::forward<Function>(entryPoint), std::forward<Args>(args)...)});
+
+      if (true == CreateDetachedWithReducedStack(&DetachedThreadProc<TCallable>, startInfo.get()))
+      {
+        startInfo.release();
+        return;
+      }
+
+      std::thread(&DetachedThreadProc<TCallable>, startInfo.release()).detach();
+    }
+  } // namespace WorkerThread
+} // namespace Xidi
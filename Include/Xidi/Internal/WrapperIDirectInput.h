@@ -11,13 +11,48 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "ApiDirectInput.h"
+#include "ApiGUID.h"
 
 namespace Xidi
 {
+  /// Holds everything needed to create a system-supplied IDirectInput object at some point after
+  /// the application asked for a DirectInput interface object. Creating the system object loads
+  /// and initializes the system DirectInput library, which is slow and entirely unnecessary for
+  /// applications that only ever use Xidi virtual controllers.
+  struct SUnderlyingDIObjectCreateParams
+  {
+    /// Function that creates the system object. Signature matches that of `DirectInput8Create`.
+    HRESULT (*createFunc)(
+        HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter);
+
+    /// Instance handle to pass to the creation function.
+    HINSTANCE hinst;
+
+    /// DirectInput version to pass to the creation function.
+    DWORD dwVersion;
+
+    /// Interface identifier to pass to the creation function.
+    IID riidltf;
+
+    /// Aggregating object to pass to the creation function.
+    LPUNKNOWN punkOuter;
+  };
+
   /// Wraps the IDirectInput interface of all supported versions to hook into all calls to it. Holds
-  /// an underlying instance of an IDirectInput object but wraps all method invocations. This base
-  /// class only contains methods common to all supported versions of DirectInput.
+  /// an underlying instance of an IDirectInput object but wraps all method invocations. The
+  /// underlying object can be supplied up front or created the first time a method needs it. This
+  /// base class only contains methods common to all supported versions of DirectInput.
   /// @tparam diVersion DirectInput version enumerator.
   template <EDirectInputVersion diVersion> class WrapperIDirectInputBase
       : public DirectInputTypes<diVersion>::IDirectInputType
@@ -26,6 +61,16 @@ namespace Xidi
 
     WrapperIDirectInputBase(DirectInputTypes<diVersion>::IDirectInputType* underlyingDIObject);
 
+    WrapperIDirectInputBase(const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams);
+
+    /// Determines if the underlying IDirectInput object exists, either because it was supplied up
+    /// front or because something has needed it since.
+    /// @return `true` if the underlying object exists, `false` otherwise.
+    inline bool HasUnderlyingDIObject(void) const
+    {
+      return (nullptr != underlyingDIObject.load());
+    }
+
     /// Callback used to scan for any XInput-compatible game controllers.
     static BOOL __stdcall CallbackEnumGameControllersXInputScan(
         const DirectInputTypes<diVersion>::DeviceInstanceType* lpddi, LPVOID pvRef);
@@ -59,8 +104,73 @@ namespace Xidi
 
   protected:
 
-    /// The underlying IDirectInput8 object that this instance wraps.
-    DirectInputTypes<diVersion>::IDirectInputType* underlyingDIObject;
+    /// Type used to hold the results of a single device enumeration requested of the underlying
+    /// IDirectInput object.
+    using TDeviceInstanceList =
+        std::vector<typename DirectInputTypes<diVersion>::DeviceInstanceType>;
+
+    /// Discards all cached device information if the system has reported that devices were
+    /// connected or disconnected since it was cached. Caller must hold the cache mutex.
+    void DiscardCachedDevicesIfChanged(void);
+
+    /// Determines if the device identified by the specified instance GUID supports XInput. The
+    /// system's list of device interfaces is consulted first, and only if that is inconclusive is
+    /// the device created and queried. The result is cached so that neither needs to happen again.
+    /// @param [in] instanceGUID DirectInput instance GUID identifying the device.
+    /// @param [in] productGUID DirectInput product GUID of the device, or all zeroes if unknown.
+    /// @return `true` if the device supports XInput, `false` otherwise.
+    bool DoesSystemDeviceSupportXInput(REFGUID instanceGUID, REFGUID productGUID);
+
+    /// Enumerates devices using the underlying IDirectInput object. If possible, the results of an
+    /// earlier identical enumeration are replayed instead of asking the system again.
+    /// @param [in] dwDevType Device type filter, passed unchanged to the underlying object.
+    /// @param [in] lpCallback Callback to invoke for each enumerated device.
+    /// @param [in] pvRef Argument to be provided to the callback.
+    /// @param [in] dwFlags Enumeration flags, passed unchanged to the underlying object.
+    /// @return Result of the enumeration.
+    HRESULT EnumSystemDevices(
+        DWORD dwDevType,
+        DirectInputTypes<diVersion>::EnumDevicesCallbackType lpCallback,
+        LPVOID pvRef,
+        DWORD dwFlags);
+
+    /// Retrieves the underlying IDirectInput object, creating it first if it does not yet exist.
+    /// Creation is attempted at most once, and if it fails then the error code is available in
+    /// #underlyingDIObjectCreateResult.
+    /// @return Pointer to the underlying object, or `nullptr` if it could not be created.
+    DirectInputTypes<diVersion>::IDirectInputType* UnderlyingDIObject(void);
+
+    /// Number of references to this object held by the application.
+    std::atomic<ULONG> refCount;
+
+    /// The underlying IDirectInput object that this instance wraps, or `nullptr` if it has not
+    /// yet been created.
+    std::atomic<typename DirectInputTypes<diVersion>::IDirectInputType*> underlyingDIObject;
+
+    /// Parameters for creating the underlying object, present only if creation has not yet been
+    /// attempted.
+    std::optional<SUnderlyingDIObjectCreateParams> underlyingDIObjectCreateParams;
+
+    /// Result of creating the underlying object, which is returned to the application by any
+    /// method that needs the underlying object if creation failed.
+    HRESULT underlyingDIObjectCreateResult;
+
+    /// Serializes creation of the underlying object.
+    std::mutex underlyingDIObjectMutex;
+
+    /// Results of enumerations previously requested of the underlying object, keyed by device type
+    /// filter and enumeration flags. Some applications enumerate devices very frequently, and the
+    /// system enumeration is slow.
+    std::map<std::pair<DWORD, DWORD>, std::shared_ptr<const TDeviceInstanceList>> cachedDevices;
+
+    /// Whether or not each system device, identified by instance GUID, supports XInput.
+    std::unordered_map<GUID, bool> cachedDeviceSupportsXInput;
+
+    /// Device change count at the time cached device information was last known to be valid.
+    uint64_t cachedDeviceChangeCount;
+
+    /// Serializes access to cached device information.
+    std::mutex cachedDevicesMutex;
   };
 
   /// Subclass for methods only present in version 8 of the IDirectInput interface.
@@ -76,6 +186,11 @@ namespace Xidi
         : WrapperIDirectInputBase<diVersion>(underlyingDIObject)
     {}
 
+    inline WrapperIDirectInputVersion8Only(
+        const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+        : WrapperIDirectInputBase<diVersion>(underlyingDIObjectCreateParams)
+    {}
+
     // IDirectInput8
     HRESULT __stdcall ConfigureDevices(
         LPDICONFIGUREDEVICESCALLBACK lpdiCallback,
@@ -103,6 +218,11 @@ namespace Xidi
         : WrapperIDirectInputBase<diVersion>(underlyingDIObject)
     {}
 
+    inline WrapperIDirectInputVersionLegacyOnly(
+        const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+        : WrapperIDirectInputBase<diVersion>(underlyingDIObjectCreateParams)
+    {}
+
     // IDirectInput7
     HRESULT __stdcall CreateDeviceEx(
         REFGUID rguid, REFIID riid, LPVOID* lplpDirectInputDevice, LPUNKNOWN pUnkOuter) override;
@@ -124,6 +244,11 @@ namespace Xidi
         DirectInputTypes<EDirectInputVersion::k8A>::IDirectInputType* underlyingDIObject)
         : WrapperIDirectInputVersion8Only(underlyingDIObject)
     {}
+
+    inline WrapperIDirectInput(
+        const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+        : WrapperIDirectInputVersion8Only(underlyingDIObjectCreateParams)
+    {}
   };
 
   template <> class WrapperIDirectInput<EDirectInputVersion::k8W>
@@ -135,6 +260,11 @@ namespace Xidi
         DirectInputTypes<EDirectInputVersion::k8W>::IDirectInputType* underlyingDIObject)
         : WrapperIDirectInputVersion8Only(underlyingDIObject)
     {}
+
+    inline WrapperIDirectInput(
+        const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+        : WrapperIDirectInputVersion8Only(underlyingDIObjectCreateParams)
+    {}
   };
 
   template <> class WrapperIDirectInput<EDirectInputVersion::kLegacyA>
@@ -146,6 +276,11 @@ namespace Xidi
         DirectInputTypes<EDirectInputVersion::kLegacyA>::IDirectInputType* underlyingDIObject)
         : WrapperIDirectInputVersionLegacyOnly(underlyingDIObject)
     {}
+
+    inline WrapperIDirectInput(
+        const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+        : WrapperIDirectInputVersionLegacyOnly(underlyingDIObjectCreateParams)
+    {}
   };
 
   template <> class WrapperIDirectInput<EDirectInputVersion::kLegacyW>
@@ -157,5 +292,10 @@ namespace Xidi
         DirectInputTypes<EDirectInputVersion::kLegacyW>::IDirectInputType* underlyingDIObject)
         : WrapperIDirectInputVersionLegacyOnly(underlyingDIObject)
     {}
+
+    inline WrapperIDirectInput(
+        const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+        : WrapperIDirectInputVersionLegacyOnly(underlyingDIObjectCreateParams)
+    {}
   };
 } // namespace Xidi
@@ -0,0 +1,193 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file WrapperIDirectInputDeviceKeyboard.h
+ *   Declaration of the wrapper class for the system keyboard's IDirectInputDevice interface.
+ **************************************************************************************************/
+
+#pragma once
+
+#include "ApiDirectInput.h"
+
+namespace Xidi
+{
+  /// Wraps the IDirectInputDevice interface of the system keyboard for all supported versions of
+  /// DirectInput. Holds an underlying instance of an IDirectInputDevice object and passes all
+  /// method invocations through to it, except that virtual keyboard state is merged into the
+  /// keyboard state the application retrieves. This is the DirectInput keyboard backend, which
+  /// allows applications to see virtual keyboard key presses without any keyboard input events
+  /// reaching the system. This base class only contains methods common to all supported versions
+  /// of DirectInput.
+  /// @tparam diVersion DirectInput version enumerator.
+  template <EDirectInputVersion diVersion> class WrapperIDirectInputDeviceKeyboardBase
+      : public DirectInputTypes<diVersion>::IDirectInputDeviceType
+  {
+  public:
+
+    WrapperIDirectInputDeviceKeyboardBase(
+        DirectInputTypes<diVersion>::IDirectInputDeviceType* underlyingDIObject);
+
+    // IDirectInputDevice (legacy and 8)
+    HRESULT __stdcall Acquire(void) override;
+    HRESULT __stdcall CreateEffect(
+        REFGUID rguid,
+        LPCDIEFFECT lpeff,
+        LPDIRECTINPUTEFFECT* ppdeff,
+        LPUNKNOWN punkOuter) override;
+    HRESULT __stdcall EnumCreatedEffectObjects(
+        LPDIENUMCREATEDEFFECTOBJECTSCALLBACK lpCallback, LPVOID pvRef, DWORD fl) override;
+    HRESULT __stdcall EnumEffects(
+        DirectInputTypes<diVersion>::EnumEffectsCallbackType lpCallback,
+        LPVOID pvRef,
+        DWORD dwEffType) override;
+    HRESULT __stdcall EnumEffectsInFile(
+        DirectInputTypes<diVersion>::ConstStringType lptszFileName,
+        LPDIENUMEFFECTSINFILECALLBACK pec,
+        LPVOID pvRef,
+        DWORD dwFlags) override;
+    HRESULT __stdcall EnumObjects(
+        DirectInputTypes<diVersion>::EnumObjectsCallbackType lpCallback,
+        LPVOID pvRef,
+        DWORD dwFlags) override;
+    HRESULT __stdcall Escape(LPDIEFFESCAPE pesc) override;
+    HRESULT __stdcall GetCapabilities(LPDIDEVCAPS lpDIDevCaps) override;
+    HRESULT __stdcall GetDeviceData(
+        DWORD cbObjectData, LPDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD dwFlags) override;
+    HRESULT __stdcall GetDeviceInfo(
+        DirectInputTypes<diVersion>::DeviceInstanceType* pdidi) override;
+    HRESULT __stdcall GetDeviceState(DWORD cbData, LPVOID lpvData) override;
+    HRESULT __stdcall GetEffectInfo(
+        DirectInputTypes<diVersion>::EffectInfoType* pdei, REFGUID rguid) override;
+    HRESULT __stdcall GetForceFeedbackState(LPDWORD pdwOut) override;
+    HRESULT __stdcall GetObjectInfo(
+        DirectInputTypes<diVersion>::DeviceObjectInstanceType* pdidoi,
+        DWORD dwObj,
+        DWORD dwHow) override;
+    HRESULT __stdcall GetProperty(REFGUID rguidProp, LPDIPROPHEADER pdiph) override;
+    HRESULT __stdcall Initialize(HINSTANCE hinst, DWORD dwVersion, REFGUID rguid) override;
+    HRESULT __stdcall Poll(void) override;
+    HRESULT __stdcall RunControlPanel(HWND hwndOwner, DWORD dwFlags) override;
+    HRESULT __stdcall SendDeviceData(
+        DWORD cbObjectData, LPCDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD fl) override;
+    HRESULT __stdcall SendForceFeedbackCommand(DWORD dwFlags) override;
+    HRESULT __stdcall SetCooperativeLevel(HWND hwnd, DWORD dwFlags) override;
+    HRESULT __stdcall SetDataFormat(LPCDIDATAFORMAT lpdf) override;
+    HRESULT __stdcall SetEventNotification(HANDLE hEvent) override;
+    HRESULT __stdcall SetProperty(REFGUID rguidProp, LPCDIPROPHEADER pdiph) override;
+    HRESULT __stdcall Unacquire(void) override;
+    HRESULT __stdcall WriteEffectToFile(
+        DirectInputTypes<diVersion>::ConstStringType lptszFileName,
+        DWORD dwEntries,
+        LPDIFILEEFFECT rgDiFileEft,
+        DWORD dwFlags) override;
+
+    // IUnknown
+    HRESULT __stdcall QueryInterface(REFIID riid, LPVOID* ppvObj) override;
+    ULONG __stdcall AddRef(void) override;
+    ULONG __stdcall Release(void) override;
+
+  protected:
+
+    /// The underlying IDirectInputDevice object that this instance wraps.
+    DirectInputTypes<diVersion>::IDirectInputDeviceType* underlyingDIObject;
+  };
+
+  /// Subclass for methods only present in version 8 of the IDirectInputDevice interface.
+  /// @tparam diVersion DirectInput version enumerator. Must identify version 8.
+  template <EDirectInputVersion diVersion>
+    requires (DirectInputVersionIs8<diVersion>)
+  class WrapperIDirectInputDeviceKeyboardVersion8Only
+      : public WrapperIDirectInputDeviceKeyboardBase<diVersion>
+  {
+  public:
+
+    inline WrapperIDirectInputDeviceKeyboardVersion8Only(
+        DirectInputTypes<diVersion>::IDirectInputDeviceType* underlyingDIObject)
+        : WrapperIDirectInputDeviceKeyboardBase<diVersion>(underlyingDIObject)
+    {}
+
+    // IDirectInputDevice8
+    HRESULT __stdcall BuildActionMap(
+        DirectInputTypes<diVersion>::ActionFormatType* lpdiaf,
+        DirectInputTypes<diVersion>::ConstStringType lpszUserName,
+        DWORD dwFlags) override;
+    HRESULT __stdcall GetImageInfo(
+        DirectInputTypes<diVersion>::DeviceImageInfoHeaderType* lpdiDevImageInfoHeader) override;
+    HRESULT __stdcall SetActionMap(
+        DirectInputTypes<diVersion>::ActionFormatType* lpdiActionFormat,
+        DirectInputTypes<diVersion>::ConstStringType lptszUserName,
+        DWORD dwFlags) override;
+  };
+
+  /// Subclass for methods only present in legacy versions of the IDirectInputDevice interface.
+  /// @tparam diVersion DirectInput version enumerator. Must identify a legacy version.
+  template <EDirectInputVersion diVersion>
+    requires (DirectInputVersionIsLegacy<diVersion>)
+  class WrapperIDirectInputDeviceKeyboardVersionLegacyOnly
+      : public WrapperIDirectInputDeviceKeyboardBase<diVersion>
+  {
+  public:
+
+    inline WrapperIDirectInputDeviceKeyboardVersionLegacyOnly(
+        DirectInputTypes<diVersion>::IDirectInputDeviceType* underlyingDIObject)
+        : WrapperIDirectInputDeviceKeyboardBase<diVersion>(underlyingDIObject)
+    {}
+  };
+
+  /// Templated wrapper for all supported versions of the system keyboard's IDirectInputDevice
+  /// interface. The unspecialized version does nothing, but individual specialized versions exist
+  /// for all possible enumerators.
+  /// @tparam diVersion DirectInput version enumerator.
+  template <EDirectInputVersion diVersion> class WrapperIDirectInputDeviceKeyboard
+  {};
+
+  template <> class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::k8A>
+      : public WrapperIDirectInputDeviceKeyboardVersion8Only<EDirectInputVersion::k8A>
+  {
+  public:
+
+    inline WrapperIDirectInputDeviceKeyboard(
+        DirectInputTypes<EDirectInputVersion::k8A>::IDirectInputDeviceType* underlyingDIObject)
+        : WrapperIDirectInputDeviceKeyboardVersion8Only(underlyingDIObject)
+    {}
+  };
+
+  template <> class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::k8W>
+      : public WrapperIDirectInputDeviceKeyboardVersion8Only<EDirectInputVersion::k8W>
+  {
+  public:
+
+    inline WrapperIDirectInputDeviceKeyboard(
+        DirectInputTypes<EDirectInputVersion::k8W>::IDirectInputDeviceType* underlyingDIObject)
+        : WrapperIDirectInputDeviceKeyboardVersion8Only(underlyingDIObject)
+    {}
+  };
+
+  template <> class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::kLegacyA>
+      : public WrapperIDirectInputDeviceKeyboardVersionLegacyOnly<EDirectInputVersion::kLegacyA>
+  {
+  public:
+
+    inline WrapperIDirectInputDeviceKeyboard(
+        DirectInputTypes<EDirectInputVersion::kLegacyA>::IDirectInputDeviceType*
+            underlyingDIObject)
+        : WrapperIDirectInputDeviceKeyboardVersionLegacyOnly(underlyingDIObject)
+    {}
+  };
+
+  template <> class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::kLegacyW>
+      : public WrapperIDirectInputDeviceKeyboardVersionLegacyOnly<EDirectInputVersion::kLegacyW>
+  {
+  public:
+
+    inline WrapperIDirectInputDeviceKeyboard(
+        DirectInputTypes<EDirectInputVersion::kLegacyW>::IDirectInputDeviceType*
+            underlyingDIObject)
+        : WrapperIDirectInputDeviceKeyboardVersionLegacyOnly(underlyingDIObject)
+    {}
+  };
+} // namespace Xidi
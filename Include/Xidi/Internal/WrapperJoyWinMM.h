@@ -17,6 +17,11 @@ namespace Xidi
 {
   namespace WrapperJoyWinMM
   {
+    /// Starts enumerating the joystick devices WinMM makes available on a background thread, so
+    /// that the results are ready, or at least closer to being ready, by the time an application
+    /// first invokes a WinMM joystick function. Safe to invoke while the library is being loaded.
+    void BeginSystemDeviceEnumeration(void);
+
     extern "C"
     {
       MMRESULT __stdcall joyConfigChanged(DWORD dwFlags);
@@ -0,0 +1,36 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file XInputDeviceInterfaces.h
+ *   Declaration of functionality for identifying XInput devices using the system's list of
+ *   device interfaces, without needing to create DirectInput device objects.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "ApiWindows.h"
+
+namespace Xidi
+{
+  namespace XInputDeviceInterfaces
+  {
+    /// Determines if the DirectInput device with the specified product GUID supports XInput by
+    /// checking if any present HID device interface with the same vendor and product IDs has a
+    /// path that identifies it as an XInput device. The system's list of device interfaces is read
+    /// only once per device change count and then reused for all devices.
+    /// @param [in] productGUID DirectInput product GUID of the device to check.
+    /// @param [in] deviceChangeCount Number of device changes the system has reported so far. A
+    /// change in this value means the previously-read list of device interfaces is stale.
+    /// @return `true` if the device supports XInput, `false` if not, or no value if this could not
+    /// be determined because the product GUID does not contain vendor and product IDs or because
+    /// the system's list of device interfaces is unavailable.
+    std::optional<bool> DoesProductSupportXInput(REFGUID productGUID, uint64_t deviceChangeCount);
+  } // namespace XInputDeviceInterfaces
+} // namespace Xidi
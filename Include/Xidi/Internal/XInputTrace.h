@@ -0,0 +1,132 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file XInputTrace.h
+ *   Declaration of functionality for recording XInput state queries to a trace file and
+ *   replaying them in place of the native XInput library.
+ **************************************************************************************************/
+
+#pragma once
+
+// XInput header files depend on Windows header files, which are are sensitive to include order.
+// See "ApiWindows.h" for more information.
+
+// clang-format off
+
+#include "ApiWindows.h"
+#include <xinput.h>
+
+// clang-format on
+
+#include <cstdint>
+
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace XInputTrace
+  {
+    /// Identifies a file as an XInput trace. Spells "XIXT" when stored in little-endian order.
+    inline constexpr uint32_t kFileMagic = 0x54584958;
+
+    /// Version of the trace file format. Incremented for any change to the layout of the file
+    /// header or of a record.
+    inline constexpr uint16_t kFileVersion = 1;
+
+    /// Header at the very beginning of a trace file.
+    struct SFileHeader
+    {
+      /// Always equal to #kFileMagic.
+      uint32_t magic;
+
+      /// Always equal to #kFileVersion.
+      uint16_t version;
+
+      /// Size of each record, in bytes.
+      uint16_t recordSize;
+
+      /// Frequency of the performance counter used to produce record timestamps, in counts per
+      /// second.
+      int64_t performanceCounterFrequency;
+    };
+
+    static_assert(16 == sizeof(SFileHeader), "Trace file header layout is unexpected.");
+
+    /// Single XInput state query, as it was issued to and answered by the native XInput library.
+    /// A trace file contains any number of these immediately following the file header.
+    struct SRecord
+    {
+      /// Performance counter value at the time of the query, relative to the start of recording.
+      int64_t timestamp;
+
+      /// Result code that XInput returned.
+      uint32_t result;
+
+      /// Packet number that XInput reported. Only meaningful if the query succeeded.
+      uint32_t packetNumber;
+
+      /// Button state that XInput reported, using the XInput bit layout.
+      uint16_t buttons;
+
+      /// Identifier of the physical controller that was queried.
+      uint8_t controllerIdentifier;
+
+      /// Not used. Always zero.
+      uint8_t reserved1;
+
+      /// Left and right trigger values that XInput reported, in that order.
+      uint8_t trigger[2];
+
+      /// Left stick X, left stick Y, right stick X, and right stick Y values that XInput
+      /// reported, in that order.
+      int16_t stick[4];
+
+      /// Not used. Always zero.
+      uint16_t reserved2;
+    };
+
+    static_assert(32 == sizeof(SRecord), "Trace file record layout is unexpected.");
+
+    /// Determines if XInput state queries should be recorded to a trace file. The first
+    /// invocation opens the trace file named in the configuration file.
+    /// @return `true` if recording is active, `false` otherwise.
+    bool IsRecording(void);
+
+    /// Determines if XInput state queries should be answered from a trace file instead of by the
+    /// native XInput library. The first invocation loads the trace file named in the
+    /// configuration file.
+    /// @return `true` if replay is active, `false` otherwise.
+    bool IsReplaying(void);
+
+    /// Appends the result of a single XInput state query to the trace file. Records are buffered
+    /// and written to the file in batches. Has no effect unless recording is active.
+    /// @param [in] controllerIdentifier Identifier of the physical controller that was queried.
+    /// @param [in] result Result code that XInput returned.
+    /// @param [in] xinputState State data that XInput filled in. Only used if the query
+    /// succeeded.
+    void Record(
+        Controller::TControllerIdentifier controllerIdentifier,
+        DWORD result,
+        const XINPUT_STATE& xinputState);
+
+    /// Answers an XInput state query using the next record in the trace for the specified
+    /// physical controller. Records are handed out in the order they were recorded, one per query,
+    /// without regard for their timestamps. Once all of a controller's records are consumed, that
+    /// controller is reported as not connected.
+    /// @param [in] dwUserIndex Identifier of the physical controller being queried.
+    /// @param [out] pState Filled in with the recorded state data.
+    /// @return Recorded XInput result code.
+    DWORD __stdcall ReplayXInputGetState(DWORD dwUserIndex, XINPUT_STATE* pState);
+
+    /// Accepts and discards an XInput vibration request while replay is active.
+    /// @param [in] dwUserIndex Identifier of the physical controller being written.
+    /// @param [in] pVibration Vibration values to write.
+    /// @return `ERROR_SUCCESS` for any physical controller that has recorded state data,
+    /// `ERROR_DEVICE_NOT_CONNECTED` otherwise.
+    DWORD __stdcall ReplayXInputSetState(DWORD dwUserIndex, XINPUT_VIBRATION* pVibration);
+  } // namespace XInputTrace
+} // namespace Xidi
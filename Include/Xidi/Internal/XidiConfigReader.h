@@ -14,21 +14,73 @@
 #include <Infra/Core/Configuration.h>
 
 #ifndef XIDI_SKIP_MAPPERS
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "ElementMapperCache.h"
 #include "MapperBuilder.h"
 #endif
 
 #include <string_view>
 
+#include "Settings.h"
+
 namespace Xidi
 {
   using namespace ::Infra::Configuration;
 
+#ifndef XIDI_SKIP_MAPPERS
+  /// Enumerates the possible operations to be performed on a custom mapper blueprint.
+  enum class EBlueprintOperation
+  {
+    /// Indicates an error.
+    Error,
+
+    /// Set an element mapper for a controller element.
+    SetElementMapper,
+
+    /// Set a force feedback actuator configuration for a physical force feedback actuator.
+    SetForceFeedbackActuator,
+
+    /// Set a chord.
+    SetChord,
+
+    /// Set the blueprint template.
+    SetTemplate,
+  };
+#endif
+
   class XidiConfigReader : public ConfigurationFileReader
   {
+  public:
+
+    /// Converts the controller-independent settings held in configuration data to their typed
+    /// representation. Settings that are absent keep their built-in default values.
+    /// @param [in] configData Configuration data, typically the result of reading a configuration
+    /// file successfully.
+    /// @return Typed settings.
+    static SSettings ExtractSettings(const ConfigurationData& configData);
+
 #ifndef XIDI_SKIP_MAPPERS
 
   public:
 
+    /// Maps from custom mapper name to a hash of the contents of the configuration file section
+    /// that defines it. Two sections with the same hash are considered to define the same mapper.
+    using TCustomMapperSectionHashes = std::map<std::wstring, uint64_t, std::less<>>;
+
+    /// Sets the object to be filled with hashes of all custom mapper sections during the next
+    /// configuration file read attempt. Upon completion of the next read attempt the pointer held
+    /// by this object is automatically cleared.
+    /// @param [in] newCustomMapperSectionHashes Pointer to the object that will receive custom
+    /// mapper section hashes, or `nullptr` if they are not needed.
+    inline void SetCustomMapperSectionHashes(
+        TCustomMapperSectionHashes* newCustomMapperSectionHashes)
+    {
+      customMapperSectionHashes = newCustomMapperSectionHashes;
+    }
+
     /// Sets the mapper builder object to be filled with custom mapper blueprints during the next
     /// configuration file read attempt. Upon completion of the next read attempt the pointer held
     /// by this object is automatically cleared.
@@ -39,6 +91,17 @@ namespace Xidi
       customMapperBuilder = newCustomMapperBuilder;
     }
 
+    /// Sets the cache to be consulted before parsing element mapper strings, and to be updated
+    /// with any element mappers that do need to be parsed, during the next configuration file read
+    /// attempt. Upon completion of the next read attempt the pointer held by this object is
+    /// automatically cleared.
+    /// @param [in] newElementMapperCache Pointer to the element mapper cache, or `nullptr` to parse
+    /// all element mapper strings.
+    inline void SetElementMapperCache(Controller::ElementMapperCache* newElementMapperCache)
+    {
+      elementMapperCache = newElementMapperCache;
+    }
+
 #endif
 
   protected:
@@ -59,8 +122,31 @@ namespace Xidi
 
   private:
 
+    /// Determines the operation that should be performed on a mapper blueprint for a custom mapper
+    /// configuration setting whose value is being processed. The configuration file reader always
+    /// requests the type of a value before processing it, so the operation is normally already
+    /// known from that request and does not need to be determined again.
+    /// @param [in] name Configuration setting name.
+    /// @return Operation to perform.
+    EBlueprintOperation BlueprintOperationForValue(std::wstring_view name);
+
     /// Holds custom mapper blueprints parsed from configuration files.
-    Controller::MapperBuilder* customMapperBuilder;
+    Controller::MapperBuilder* customMapperBuilder = nullptr;
+
+    /// Holds previously-parsed element mappers, if available.
+    Controller::ElementMapperCache* elementMapperCache = nullptr;
+
+    /// Receives hashes of custom mapper sections, if requested.
+    TCustomMapperSectionHashes* customMapperSectionHashes = nullptr;
+
+    /// Name of the custom mapper configuration setting whose type was most recently requested.
+    /// Owned by this object because the configuration file reader does not guarantee that the
+    /// string it passes remains valid, but its buffer is reused from one setting to the next.
+    std::wstring lastBlueprintOperationName;
+
+    /// Operation to be performed on a mapper blueprint for the custom mapper configuration setting
+    /// whose type was most recently requested.
+    EBlueprintOperation lastBlueprintOperation = EBlueprintOperation::Error;
 
 #endif
   };
@@ -0,0 +1,49 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AllocationTracker.h
+ *   Declaration of a mechanism for counting dynamic memory allocations, which can be used by tests
+ *   to verify that code paths do not allocate.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+namespace XidiTest
+{
+  /// Retrieves the number of dynamic memory allocations made by the calling thread since it
+  /// started. Only allocations made using the global allocation operators are counted.
+  /// @return Number of dynamic memory allocations made so far by the calling thread.
+  uint64_t GetCurrentThreadAllocationCount(void);
+
+  /// Counts the number of dynamic memory allocations made by the calling thread while an instance
+  /// of this object exists. Allocations made by other threads are not counted. Instances are
+  /// intended to be created and queried on the same thread.
+  class ScopedAllocationCounter
+  {
+  public:
+
+    inline ScopedAllocationCounter(void)
+        : allocationCountAtConstruction(GetCurrentThreadAllocationCount())
+    {}
+
+    /// Retrieves the number of dynamic memory allocations the calling thread has made since this
+    /// object was created.
+    /// @return Number of dynamic memory allocations made while this object exists.
+    inline uint64_t GetAllocationCount(void) const
+    {
+      return GetCurrentThreadAllocationCount() - allocationCountAtConstruction;
+    }
+
+  private:
+
+    /// Number of dynamic memory allocations made by the calling thread when this object was
+    /// created.
+    uint64_t allocationCountAtConstruction;
+  };
+} // namespace XidiTest
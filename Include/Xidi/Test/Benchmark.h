@@ -0,0 +1,76 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file Benchmark.h
+ *   Declaration of a minimal microbenchmark harness along with the macros used to define
+ *   benchmark cases.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace XidiBenchmark
+{
+  /// Function signature for the body of a benchmark case. Each invocation must perform the
+  /// operation being measured exactly the specified number of times.
+  using TBenchmarkCaseFunc = void (*)(uint64_t numIterations);
+
+  /// Sink for values whose computation must not be optimized away. Written by #DoNotOptimize.
+  extern const void* volatile benchmarkValueSink;
+
+  /// Prevents the compiler from optimizing away the computation of the specified value by making
+  /// its address observable outside of the benchmark case.
+  /// @param [in] value Value whose computation must be retained.
+  template <typename ValueType> inline void DoNotOptimize(const ValueType& value)
+  {
+    benchmarkValueSink = &value;
+  }
+
+  /// Reports an additional measurement, beyond time per operation, for the benchmark case that is
+  /// currently running. Measurements reported during the final run of each benchmark case are
+  /// output below its time per operation. They are informational only and are neither written to
+  /// results files nor compared against baselines.
+  /// @param [in] metricName Name of the measurement.
+  /// @param [in] value Measured value.
+  /// @param [in] unit Unit in which the value is expressed.
+  void ReportMetric(std::wstring_view metricName, double value, std::wstring_view unit);
+
+  /// Registers a single benchmark case with the harness upon construction. Objects of this type
+  /// are created by the #BENCHMARK_CASE macro and are not intended to be created directly.
+  class BenchmarkCase
+  {
+  public:
+
+    BenchmarkCase(std::wstring_view name, TBenchmarkCaseFunc benchmarkCaseFunc);
+  };
+
+  namespace Harness
+  {
+    /// Runs all registered benchmark cases whose names begin with the specified prefix, in
+    /// alphabetical order, and outputs the time per operation for each. If a baseline file is
+    /// specified, each result is compared against the corresponding result in the baseline.
+    /// @param [in] prefix Prefix that benchmark case names must begin with to be run.
+    /// @param [in] baselineFilename Name of a file previously written by this harness that holds
+    /// baseline results, or `nullptr` for no comparison.
+    /// @param [in] resultsFilename Name of a file to which results should be written so that they
+    /// can later be used as a baseline, or `nullptr` to skip writing results.
+    /// @return Number of benchmark cases that regressed relative to the baseline, which is 0 if
+    /// no baseline is specified, or -1 if the baseline or results file could not be used.
+    int RunBenchmarksWithMatchingPrefix(
+        std::wstring_view prefix, const wchar_t* baselineFilename, const wchar_t* resultsFilename);
+  } // namespace Harness
+} // namespace XidiBenchmark
+
+/// Defines and registers a benchmark case with the specified name. The body that follows receives
+/// a parameter named `numIterations` and must perform the measured operation that many times.
+#define BENCHMARK_CASE(name)                                                                       \
+  static void BenchmarkCaseBody_##name(uint64_t numIterations);                                    \
+  static const ::XidiBenchmark::BenchmarkCase benchmarkCaseInstance_##name(                        \
+      L#name, &BenchmarkCaseBody_##name);                                                          \
+  static void BenchmarkCaseBody_##name(uint64_t numIterations)
@@ -0,0 +1,111 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file BenchmarkConfiguration.h
+ *   Generator for synthetic configuration files consisting of many custom mappers, for use in
+ *   benchmark cases that measure startup time.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace XidiBenchmark
+{
+  /// Synthetic configuration file along with the parts of it that benchmark cases need to refer
+  /// to individually.
+  struct SBenchmarkConfiguration
+  {
+    /// Complete contents of the configuration file.
+    std::wstring fileContents;
+
+    /// Names of all of the custom mappers defined in the configuration file, in the order in
+    /// which they are defined.
+    std::vector<std::wstring> customMapperNames;
+
+    /// All of the element mapper strings that appear in the configuration file, in the order in
+    /// which they appear.
+    std::vector<std::wstring> elementMapperStrings;
+  };
+
+  /// Generates a deterministic configuration file that defines the specified number of custom
+  /// mappers, similar to one that is shared between many users. Most custom mappers use a
+  /// template, either a built-in mapper or the custom mapper defined just before them, and each
+  /// one maps most controller elements using a mix of simple and nested element mappers.
+  /// @param [in] numCustomMappers Number of custom mappers to define.
+  /// @return Generated configuration file.
+  inline SBenchmarkConfiguration MakeBenchmarkConfiguration(unsigned int numCustomMappers)
+  {
+    constexpr std::wstring_view kControllerElementNames[] = {
+        L"StickLeftX",  L"StickLeftY", L"StickRightX", L"StickRightY", L"DpadUp",
+        L"DpadDown",    L"DpadLeft",   L"DpadRight",   L"TriggerLT",   L"TriggerRT",
+        L"ButtonA",     L"ButtonB",    L"ButtonX",     L"ButtonY",     L"ButtonLB",
+        L"ButtonRB",    L"ButtonBack", L"ButtonStart", L"ButtonLS",    L"ButtonRS",
+        L"ButtonGuide"};
+
+    constexpr std::wstring_view kElementMapperStrings[] = {
+        L"Axis(X)",
+        L"Axis(Y, +)",
+        L"Axis(RotX, negative)",
+        L"Button(1)",
+        L"Button(12)",
+        L"Pov(Up)",
+        L"Pov(Right)",
+        L"DigitalAxis(Z, +)",
+        L"Invert(Axis(RotY))",
+        L"Split(Button(3), Button(4))",
+        L"Compound(Button(5), Pov(Down))",
+        L"Compound(Invert(Axis(X)), Split(Button(6), Null))",
+        L"Null"};
+
+    SBenchmarkConfiguration configuration;
+
+    for (unsigned int i = 0; i < numCustomMappers; ++i)
+    {
+      configuration.customMapperNames.push_back(L"Benchmark" + std::to_wstring(i));
+      const std::wstring& customMapperName = configuration.customMapperNames.back();
+
+      configuration.fileContents += L"[CustomMapper:" + customMapperName + L"]\n";
+
+      // Every eighth custom mapper is built from scratch. Of the rest, half use a built-in mapper
+      // as a template and half use the previous custom mapper, so that building has template
+      // dependencies to resolve.
+      if (0 != (i % 8))
+      {
+        configuration.fileContents += L"Template = ";
+        configuration.fileContents +=
+            ((0 != (i % 2)) ? std::wstring(L"StandardGamepad")
+                            : configuration.customMapperNames[i - 1]);
+        configuration.fileContents += L"\n";
+      }
+
+      for (size_t element = 0; element < _countof(kControllerElementNames); ++element)
+      {
+        // Some controller elements are left alone so that mappers that use a template inherit
+        // them from it.
+        if (0 == ((i + element) % 5)) continue;
+
+        const std::wstring_view elementMapperString =
+            kElementMapperStrings[((i * 7) + element) % _countof(kElementMapperStrings)];
+
+        configuration.elementMapperStrings.emplace_back(elementMapperString);
+        configuration.fileContents += kControllerElementNames[element];
+        configuration.fileContents += L" = ";
+        configuration.fileContents += elementMapperString;
+        configuration.fileContents += L"\n";
+      }
+
+      configuration.fileContents += L"\n";
+    }
+
+    return configuration;
+  }
+} // namespace XidiBenchmark
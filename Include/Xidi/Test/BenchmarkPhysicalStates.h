@@ -0,0 +1,68 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file BenchmarkPhysicalStates.h
+ *   Generation of physical controller states used as input to benchmark cases.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ControllerTypes.h"
+
+namespace XidiBenchmark
+{
+  using ::Xidi::Controller::EPhysicalButton;
+  using ::Xidi::Controller::EPhysicalDeviceStatus;
+  using ::Xidi::Controller::EPhysicalStick;
+  using ::Xidi::Controller::EPhysicalTrigger;
+  using ::Xidi::Controller::SPhysicalState;
+
+  /// Number of distinct physical states produced by #MakeBenchmarkPhysicalStates. Benchmark cases
+  /// cycle through them so that successive iterations do not see identical input.
+  inline constexpr size_t kNumBenchmarkPhysicalStates = 64;
+
+  /// Type used to hold the physical states that benchmark cases cycle through.
+  using TBenchmarkPhysicalStates = std::array<SPhysicalState, kNumBenchmarkPhysicalStates>;
+
+  /// Generates a deterministic sequence of pseudo-random physical controller states, in which all
+  /// sticks, triggers, and buttons vary.
+  /// @return Generated physical controller states.
+  inline TBenchmarkPhysicalStates MakeBenchmarkPhysicalStates(void)
+  {
+    TBenchmarkPhysicalStates physicalStates;
+    uint32_t pseudoRandomValue = 1;
+
+    for (auto& physicalState : physicalStates)
+    {
+      physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+
+      for (int stick = 0; stick < static_cast<int>(EPhysicalStick::Count); ++stick)
+      {
+        pseudoRandomValue = (pseudoRandomValue * 1103515245) + 12345;
+        physicalState.stick[stick] = static_cast<int16_t>(pseudoRandomValue >> 16);
+      }
+
+      for (int trigger = 0; trigger < static_cast<int>(EPhysicalTrigger::Count); ++trigger)
+      {
+        pseudoRandomValue = (pseudoRandomValue * 1103515245) + 12345;
+        physicalState.trigger[trigger] = static_cast<uint8_t>(pseudoRandomValue >> 16);
+      }
+
+      for (int button = 0; button < static_cast<int>(EPhysicalButton::Count); ++button)
+      {
+        pseudoRandomValue = (pseudoRandomValue * 1103515245) + 12345;
+        physicalState.button[button] = (0 != (pseudoRandomValue & 0x00010000));
+      }
+    }
+
+    return physicalStates;
+  }
+} // namespace XidiBenchmark
@@ -0,0 +1,118 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MockForceFeedbackActuator.h
+ *   Declaration of a mock physical actuator that drives a force feedback device buffer the same
+ *   way the physical controller actuation thread does, but using a simulated clock.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "ForceFeedbackDevice.h"
+#include "ForceFeedbackTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller::ForceFeedback;
+
+  /// Single write to the mock physical actuators, recorded in the order in which it happened.
+  struct SActuatorWrite
+  {
+    /// Simulated time at which the write happened.
+    TEffectTimeMs timestamp;
+
+    /// Magnitude components written to the actuators.
+    TOrderedMagnitudeComponents magnitudeComponents;
+  };
+
+  /// Owns a force feedback device buffer and plays its effects by following the same schedule as
+  /// the physical controller actuation thread: waiting while the device is idle and the actuators
+  /// are at rest, otherwise sleeping for one actuation period or until the next transition if that
+  /// comes sooner. Time only advances when a test case requests it, so results are completely
+  /// deterministic. Actuators are written only when their values change, and every such write is
+  /// recorded in place of an actual call to `XInputSetState`.
+  class MockForceFeedbackActuator
+  {
+  public:
+
+    /// Creates a mock actuator whose simulated clock starts at time 0.
+    /// @param [in] actuationPeriod Time between actuation passes while effects are playing.
+    MockForceFeedbackActuator(TEffectTimeMs actuationPeriod);
+
+    MockForceFeedbackActuator(const MockForceFeedbackActuator& other) = delete;
+
+    /// Advances the simulated clock to the specified time, performing all actuation passes that
+    /// would have happened in the meantime. Commands should be issued to the device buffer between
+    /// invocations of this method, using the current simulated time as their timestamps.
+    /// @param [in] time Simulated time to which to advance, which must not be in the past.
+    void AdvanceTo(TEffectTimeMs time);
+
+    /// Retrieves the number of actuation passes performed so far.
+    /// @return Number of actuation passes.
+    inline uint64_t GetActuationPassCount(void) const
+    {
+      return actuationPassCount;
+    }
+
+    /// Retrieves all writes to the mock physical actuators performed so far.
+    /// @return Read-only reference to the recorded writes, in chronological order.
+    inline const std::vector<SActuatorWrite>& GetActuatorWrites(void) const
+    {
+      return actuatorWrites;
+    }
+
+    /// Retrieves the force feedback device buffer on which effects are played.
+    /// @return Mutable reference to the device buffer.
+    inline Device& GetDevice(void)
+    {
+      return device;
+    }
+
+    /// Retrieves the current simulated time.
+    /// @return Current simulated time.
+    inline TEffectTimeMs Now(void) const
+    {
+      return currentTime;
+    }
+
+  private:
+
+    /// Performs a single actuation pass at the current simulated time, recording a write to the
+    /// mock physical actuators if their values change.
+    void ActuateOnce(void);
+
+    /// Computes how long the actuation thread would sleep after an actuation pass.
+    /// @return Sleep time.
+    TEffectTimeMs ComputeSleepTime(void);
+
+    /// Time between actuation passes while effects are playing.
+    const TEffectTimeMs kActuationPeriod;
+
+    /// Device buffer on which effects are played.
+    Device device;
+
+    /// Current simulated time.
+    TEffectTimeMs currentTime;
+
+    /// Simulated time of the next actuation pass, or nothing if waiting for the device to become
+    /// non-idle.
+    std::optional<TEffectTimeMs> nextActuationTime;
+
+    /// Values most recently written to the mock physical actuators.
+    TOrderedMagnitudeComponents currentActuatorValues;
+
+    /// All writes to the mock physical actuators performed so far.
+    std::vector<SActuatorWrite> actuatorWrites;
+
+    /// Number of actuation passes performed so far.
+    uint64_t actuationPassCount;
+  };
+} // namespace XidiTest
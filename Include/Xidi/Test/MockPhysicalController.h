@@ -45,9 +45,13 @@ namespace XidiTest
 
     ~MockPhysicalController(void);
 
-    /// Advances to the next physical state.
-    /// Intended to be invoked internally only.
-    void AdvancePhysicalState(void);
+    /// Unregisters a virtual controller for raw virtual state updates.
+    /// @param [in] controllerToUnregister Pointer to the virtual controller object that should be
+    /// unregistered for raw virtual state updates.
+    inline void EraseStateChangeRegistration(VirtualController* controllerToUnregister)
+    {
+      stateChangeRegistration.erase(controllerToUnregister);
+    }
 
     /// Unregisters a virtual controller for force feedback.
     /// @param [in] controllerToRegister Pointer to the virtual controller object that should be
@@ -71,6 +75,14 @@ namespace XidiTest
     /// @return Current raw virtual state being reported to the test cases that request it.
     SState GetCurrentRawVirtualState(void) const;
 
+    /// Retrieves and returns the generation number of the current physical state, which for mock
+    /// physical controllers is the index of the current physical state.
+    /// @return Generation number of the current physical state.
+    inline TGeneration GetCurrentGeneration(void) const
+    {
+      return static_cast<TGeneration>(currentPhysicalStateIndex);
+    }
+
     /// Provides access to the force feedback device object.
     /// @return Reference to the force feedback device object.
     inline ForceFeedback::Device& GetForceFeedbackDevice(void)
@@ -86,6 +98,14 @@ namespace XidiTest
       forceFeedbackRegistration.insert(controllerToRegister);
     }
 
+    /// Registers a virtual controller for raw virtual state updates.
+    /// @param [in] controllerToRegister Pointer to the virtual controller object that should be
+    /// registered for raw virtual state updates.
+    inline void InsertStateChangeRegistration(VirtualController* controllerToRegister)
+    {
+      stateChangeRegistration.insert(controllerToRegister);
+    }
+
     /// Checks if the specified virtual controller is registered for force feedback.
     /// @return `true` if so, `false` if not.
     inline bool IsVirtualControllerRegisteredForForceFeedback(
@@ -94,6 +114,14 @@ namespace XidiTest
       return forceFeedbackRegistration.contains(controllerToCheck);
     }
 
+    /// Checks if the specified virtual controller is registered for raw virtual state updates.
+    /// @return `true` if so, `false` if not.
+    inline bool IsVirtualControllerRegisteredForStateChange(
+        VirtualController* controllerToCheck) const
+    {
+      return stateChangeRegistration.contains(controllerToCheck);
+    }
+
     /// Retrieves and returns the controller identifier associated with this object.
     /// @return Associated controller identifier.
     inline TControllerIdentifier GetControllerIdentifier(void) const
@@ -101,17 +129,10 @@ namespace XidiTest
       return kControllerIdentifier;
     }
 
-    /// Retrieves and returns whether or not an advancement to the next physical state has been
-    /// requested.
-    /// @return `true` if so, `false` if not.
-    inline bool IsAdvanceStateRequested(void) const
-    {
-      return advanceRequested;
-    }
-
-    /// Requests an advancement to the next physical state.
-    /// Test will fail due to a test implementation issue if attempting to advance past the end of
-    /// the physical state array.
+    /// Advances to the next physical state and delivers the resulting raw virtual state to all
+    /// virtual controllers registered for raw virtual state updates, just like the polling thread
+    /// would do for a real physical controller. Test will fail due to a test implementation issue
+    /// if attempting to advance past the end of the physical state array.
     void RequestAdvancePhysicalState(void);
 
   private:
@@ -130,11 +151,6 @@ namespace XidiTest
     /// Begins at 0 and increases whenever a test case advances to the next physical state.
     size_t currentPhysicalStateIndex;
 
-    /// Flag which specifies whether or not the next wait-for-state-change operation should
-    /// result in an advancement of the reported physical state to the next element in the
-    /// physical state array.
-    bool advanceRequested;
-
     /// Force feedback device associated with the physical controller.
     /// Initialized to use a base timestamp of 0.
     ForceFeedback::Device forceFeedbackDevice;
@@ -145,5 +161,8 @@ namespace XidiTest
 
     /// Virtual controllers registered for force feedback.
     std::set<const VirtualController*> forceFeedbackRegistration;
+
+    /// Virtual controllers registered for raw virtual state updates.
+    std::set<VirtualController*> stateChangeRegistration;
   };
 } // namespace XidiTest
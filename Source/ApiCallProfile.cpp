@@ -0,0 +1,157 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiCallProfile.cpp
+ *   Implementation of functionality for counting and timing calls the application makes to the
+ *   DirectInput and WinMM entry points that Xidi implements.
+ **************************************************************************************************/
+
+#include "ApiCallProfile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string_view>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "Globals.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace ApiCallProfile
+  {
+    /// Retrieves the registry of entry point statistics objects, keyed by method name.
+    /// @return Mutable reference to the registry.
+    static std::map<std::wstring_view, SMethodProfile>& Registry(void)
+    {
+      static std::map<std::wstring_view, SMethodProfile> registry;
+      return registry;
+    }
+
+    /// Retrieves the mutex that guards the registry of entry point statistics objects. Only held
+    /// while registering a new entry point or reading statistics, never while recording a call.
+    /// @return Mutable reference to the mutex.
+    static std::mutex& RegistryMutex(void)
+    {
+      static std::mutex registryMutex;
+      return registryMutex;
+    }
+
+    /// Retrieves and returns the frequency of the performance counter.
+    /// @return Number of performance counter ticks per second.
+    static int64_t PerformanceCounterFrequency(void)
+    {
+      static const int64_t kFrequency = []() -> int64_t
+      {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return frequency.QuadPart;
+      }();
+
+      return kFrequency;
+    }
+
+    /// Converts a number of performance counter ticks to microseconds.
+    /// @param [in] ticks Number of performance counter ticks.
+    /// @return Equivalent number of microseconds.
+    static inline uint64_t MicrosecondsFromTicks(uint64_t ticks)
+    {
+      return (uint64_t)(((double)ticks * 1000000.0) / (double)PerformanceCounterFrequency());
+    }
+
+    /// Fills in a statistics structure from the statistics object for a single entry point.
+    /// @param [in] methodName Name of the entry point.
+    /// @param [in] methodProfile Statistics object for the entry point.
+    /// @return Statistics for the entry point.
+    static SMethodStatistics MethodStatistics(
+        std::wstring_view methodName, const SMethodProfile& methodProfile)
+    {
+      return {
+          .methodName = methodName,
+          .numCalls = methodProfile.numCalls.load(std::memory_order_relaxed),
+          .totalMicroseconds =
+              MicrosecondsFromTicks(methodProfile.totalTicks.load(std::memory_order_relaxed)),
+          .callDuration = methodProfile.callDuration.GetStatistics()};
+    }
+
+    bool IsEnabled(void)
+    {
+      // Auto-tuning learns from the calls the application makes, so it needs them profiled too.
+      static const bool kApiCallProfileEnabled =
+          (Globals::GetConfigurationData()[Strings::kStrConfigurationSectionLog]
+                                          [Strings::kStrConfigurationSettingLogApiCallProfile]
+                                              .ValueOr(false) ||
+           Globals::GetConfigurationData()[Strings::kStrConfigurationSectionAutoTune]
+                                          [Strings::kStrConfigurationSettingAutoTuneLearn]
+                                              .ValueOr(false));
+      return kApiCallProfileEnabled;
+    }
+
+    SMethodProfile* Register(const wchar_t* methodName)
+    {
+      if (false == IsEnabled()) return nullptr;
+
+      std::scoped_lock lock(RegistryMutex());
+      return &Registry().try_emplace(methodName).first->second;
+    }
+
+    void RecordCall(SMethodProfile* methodProfile, int64_t beginTicks, int64_t endTicks)
+    {
+      const uint64_t callTicks = ((endTicks > beginTicks) ? (uint64_t)(endTicks - beginTicks) : 0);
+
+      methodProfile->numCalls.fetch_add(1, std::memory_order_relaxed);
+      methodProfile->totalTicks.fetch_add(callTicks, std::memory_order_relaxed);
+      methodProfile->callDuration.Record(MicrosecondsFromTicks(callTicks));
+    }
+
+    size_t GetStatistics(std::span<SMethodStatistics> statistics)
+    {
+      std::scoped_lock lock(RegistryMutex());
+
+      size_t numMethods = 0;
+      for (const auto& [methodName, methodProfile] : Registry())
+      {
+        if (numMethods < statistics.size())
+          statistics[numMethods] = MethodStatistics(methodName, methodProfile);
+
+        numMethods += 1;
+      }
+
+      return numMethods;
+    }
+
+    void OutputSummary(void)
+    {
+      if (false == IsEnabled()) return;
+      if (false == Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Info))
+        return;
+
+      std::scoped_lock lock(RegistryMutex());
+      for (const auto& [methodName, methodProfile] : Registry())
+      {
+        const SMethodStatistics methodStatistics = MethodStatistics(methodName, methodProfile);
+        if (0 == methodStatistics.numCalls) continue;
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"API calls to %s: %llu calls, total %llu us, p50 %llu us, p99 %llu us, maximum %llu us.",
+            methodName.data(),
+            methodStatistics.numCalls,
+            methodStatistics.totalMicroseconds,
+            methodStatistics.callDuration.p50Microseconds,
+            methodStatistics.callDuration.p99Microseconds,
+            methodStatistics.callDuration.maxMicroseconds);
+      }
+    }
+  } // namespace ApiCallProfile
+} // namespace Xidi
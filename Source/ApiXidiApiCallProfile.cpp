@@ -0,0 +1,42 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiApiCallProfile.cpp
+ *   Implementation of the ApiCallProfile interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include <cstddef>
+#include <span>
+
+#include "ApiCallProfile.h"
+#include "ApiXidi.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IApiCallProfile.
+    class ApiCallProfileProvider : public IApiCallProfile
+    {
+    public:
+
+      // IApiCallProfile
+      bool IsEnabled(void) const override
+      {
+        return ApiCallProfile::IsEnabled();
+      }
+
+      size_t GetStatistics(std::span<SMethodStatistics> statistics) const override
+      {
+        return ApiCallProfile::GetStatistics(statistics);
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static ApiCallProfileProvider apiCallProfileProvider;
+  } // namespace Api
+} // namespace Xidi
@@ -0,0 +1,85 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiControllerMapper.cpp
+ *   Implementation of the ControllerMapper interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include <string_view>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "PhysicalController.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IControllerMapper.
+    class ControllerMapperSwitcher : public IControllerMapper
+    {
+    public:
+
+      // IControllerMapper
+      std::wstring_view GetMapperName(unsigned int controllerIndex) const override
+      {
+        if (controllerIndex >= Controller::GetPhysicalControllerCount()) return std::wstring_view();
+
+        return Controller::GetControllerMapper(
+                   static_cast<Controller::TControllerIdentifier>(controllerIndex))
+            ->GetName();
+      }
+
+      bool SetMapper(unsigned int controllerIndex, std::wstring_view mapperName) override
+      {
+        if (controllerIndex >= Controller::GetPhysicalControllerCount()) return false;
+
+        const Controller::TControllerIdentifier controllerIdentifier =
+            static_cast<Controller::TControllerIdentifier>(controllerIndex);
+
+        const Controller::Mapper* const newMapper = Controller::Mapper::GetByName(mapperName);
+        if (nullptr == newMapper)
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Physical controller %u: Could not locate mapper \"%.*s\" requested using the Xidi API.",
+              (unsigned int)(1 + controllerIdentifier),
+              (int)mapperName.length(),
+              mapperName.data());
+          return false;
+        }
+
+        const Controller::Mapper* const oldMapper =
+            Controller::GetControllerMapper(controllerIdentifier);
+        Controller::SetControllerMapper(controllerIdentifier, newMapper);
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Physical controller %u: Switched from mapper \"%s\" to mapper \"%s\".",
+            (unsigned int)(1 + controllerIdentifier),
+            oldMapper->GetName().data(),
+            newMapper->GetName().data());
+
+        if (oldMapper->GetCapabilities() != newMapper->GetCapabilities())
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Physical controller %u: Mapper \"%s\" has different capabilities than mapper \"%s\". Existing virtual controllers keep their previous capabilities.",
+              (unsigned int)(1 + controllerIdentifier),
+              newMapper->GetName().data(),
+              oldMapper->GetName().data());
+
+        return true;
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static ControllerMapperSwitcher controllerMapperSwitcher;
+  } // namespace Api
+} // namespace Xidi
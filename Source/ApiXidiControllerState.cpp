@@ -0,0 +1,63 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiControllerState.cpp
+ *   Implementation of the ControllerState interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <span>
+
+#include "ApiXidi.h"
+#include "ConcurrencyWrapper.h"
+#include "ControllerTypes.h"
+#include "PhysicalController.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IControllerState.
+    class ControllerStateProvider : public IControllerState
+    {
+    public:
+
+      // IControllerState
+      unsigned int GetControllerCount(void) const override
+      {
+        return (unsigned int)Controller::GetPhysicalControllerCount();
+      }
+
+      unsigned int GetStates(std::span<SControllerState> states) const override
+      {
+        const unsigned int numStates =
+            (unsigned int)std::min(states.size(), (size_t)GetControllerCount());
+
+        for (unsigned int i = 0; i < numStates; ++i)
+        {
+          // Polling updates physical controller state before mapping it to virtual controller
+          // state, so reading them in the opposite order means the physical controller state is
+          // never older than the one from which the virtual controller state was produced.
+          TGeneration rawVirtualStateGeneration = 0;
+          states[i].rawVirtualState = Controller::GetCurrentRawVirtualControllerState(
+              (Controller::TControllerIdentifier)i, rawVirtualStateGeneration);
+          states[i].rawVirtualStateGeneration = rawVirtualStateGeneration;
+
+          TGeneration physicalStateGeneration = 0;
+          states[i].physicalState = Controller::GetCurrentPhysicalControllerState(
+              (Controller::TControllerIdentifier)i, physicalStateGeneration);
+          states[i].physicalStateGeneration = physicalStateGeneration;
+        }
+
+        return numStates;
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static ControllerStateProvider controllerStateProvider;
+  } // namespace Api
+} // namespace Xidi
@@ -0,0 +1,54 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiControllerStatus.cpp
+ *   Implementation of the ControllerStatus interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <span>
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "PhysicalController.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IControllerStatus.
+    class ControllerStatusProvider : public IControllerStatus
+    {
+    public:
+
+      // IControllerStatus
+      bool IsEnabled(void) const override
+      {
+        return Controller::IsControllerStatusServiceEnabled();
+      }
+
+      unsigned int GetControllerCount(void) const override
+      {
+        return (unsigned int)Controller::GetPhysicalControllerCount();
+      }
+
+      unsigned int GetStatuses(std::span<SControllerStatus> statuses) const override
+      {
+        const unsigned int numStatuses =
+            (unsigned int)std::min(statuses.size(), (size_t)GetControllerCount());
+
+        for (unsigned int i = 0; i < numStatuses; ++i)
+          statuses[i] = Controller::GetControllerStatus((Controller::TControllerIdentifier)i);
+
+        return numStatuses;
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static ControllerStatusProvider controllerStatusProvider;
+  } // namespace Api
+} // namespace Xidi
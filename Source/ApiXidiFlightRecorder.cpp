@@ -0,0 +1,36 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiFlightRecorder.cpp
+ *   Implementation of the FlightRecorder interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include <string_view>
+
+#include "ApiXidi.h"
+#include "FlightRecorder.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IFlightRecorder.
+    class FlightRecorderProvider : public IFlightRecorder
+    {
+    public:
+
+      // IFlightRecorder
+      bool DumpToFile(std::wstring_view filename) const override
+      {
+        return FlightRecorder::DumpToFile(filename);
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static FlightRecorderProvider flightRecorderProvider;
+  } // namespace Api
+} // namespace Xidi
@@ -0,0 +1,45 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiInputEmissionStatistics.cpp
+ *   Implementation of the InputEmissionStatistics interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include "ApiXidi.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IInputEmissionStatistics.
+    class InputEmissionStatisticsProvider : public IInputEmissionStatistics
+    {
+    public:
+
+      // IInputEmissionStatistics
+      SStatistics GetStatistics(EEmitter emitter) const override
+      {
+        switch (emitter)
+        {
+          case EEmitter::Keyboard:
+            return Keyboard::GetEmissionStatistics();
+
+          case EEmitter::Mouse:
+            return Mouse::GetEmissionStatistics();
+
+          default:
+            return {};
+        }
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static InputEmissionStatisticsProvider inputEmissionStatisticsProvider;
+  } // namespace Api
+} // namespace Xidi
@@ -0,0 +1,43 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiInputLatency.cpp
+ *   Implementation of the InputLatency interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "InputLatencyTrace.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IInputLatency.
+    class InputLatencyProvider : public IInputLatency
+    {
+    public:
+
+      // IInputLatency
+      bool IsEnabled(void) const override
+      {
+        return Controller::InputLatencyTrace::IsEnabled();
+      }
+
+      SStageStatistics GetStatistics(unsigned int controllerIndex, EStage stage) const override
+      {
+        if (controllerIndex >= Controller::kMaxPhysicalControllerCount) return {};
+
+        return Controller::InputLatencyTrace::GetStatistics(
+            (Controller::TControllerIdentifier)controllerIndex, stage);
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static InputLatencyProvider inputLatencyProvider;
+  } // namespace Api
+} // namespace Xidi
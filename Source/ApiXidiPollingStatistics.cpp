@@ -0,0 +1,38 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiPollingStatistics.cpp
+ *   Implementation of the PollingStatistics interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "PollingStatistics.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IPollingStatistics.
+    class PollingStatisticsProvider : public IPollingStatistics
+    {
+    public:
+
+      // IPollingStatistics
+      SStatistics GetStatistics(unsigned int controllerIndex) const override
+      {
+        if (controllerIndex >= Controller::kMaxPhysicalControllerCount) return {};
+
+        return Controller::PollingStatistics::GetStatistics(
+            (Controller::TControllerIdentifier)controllerIndex);
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static PollingStatisticsProvider pollingStatisticsProvider;
+  } // namespace Api
+} // namespace Xidi
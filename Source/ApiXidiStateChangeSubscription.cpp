@@ -0,0 +1,44 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiStateChangeSubscription.cpp
+ *   Implementation of the StateChangeSubscription interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "PhysicalController.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IStateChangeSubscription.
+    class StateChangeSubscriptionProvider : public IStateChangeSubscription
+    {
+    public:
+
+      // IStateChangeSubscription
+      bool Subscribe(
+          unsigned int controllerIndex, TStateChangeCallback callback, void* context) override
+      {
+        return Controller::PhysicalControllerStateChangeSubscribe(
+            (Controller::TControllerIdentifier)controllerIndex, callback, context);
+      }
+
+      bool Unsubscribe(
+          unsigned int controllerIndex, TStateChangeCallback callback, void* context) override
+      {
+        return Controller::PhysicalControllerStateChangeUnsubscribe(
+            (Controller::TControllerIdentifier)controllerIndex, callback, context);
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static StateChangeSubscriptionProvider stateChangeSubscriptionProvider;
+  } // namespace Api
+} // namespace Xidi
@@ -0,0 +1,36 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiXidiStateExport.cpp
+ *   Implementation of the StateExport interface part of the Xidi API.
+ **************************************************************************************************/
+
+#include <span>
+
+#include "ApiXidi.h"
+#include "PhysicalController.h"
+
+namespace Xidi
+{
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IStateExport.
+    class StateExportProvider : public IStateExport
+    {
+    public:
+
+      // IStateExport
+      std::span<const SStateBlock> GetStateBlocks(void) const override
+      {
+        return Controller::GetExportedStateBlocks();
+      }
+    };
+
+    // Singleton Xidi API implementation object.
+    static StateExportProvider stateExportProvider;
+  } // namespace Api
+} // namespace Xidi
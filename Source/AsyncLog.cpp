@@ -0,0 +1,205 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AsyncLog.cpp
+ *   Implementation of a mechanism for writing log messages on a background thread instead of on
+ *   the thread that produces them.
+ **************************************************************************************************/
+
+#include "AsyncLog.h"
+
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "WorkerThread.h"
+
+namespace Xidi
+{
+  namespace AsyncLog
+  {
+    /// Maximum number of characters in a single message, including the terminating null character.
+    static constexpr size_t kMaxMessageLength = 384;
+
+    /// Number of messages each thread's buffer can hold before messages start being dropped.
+    static constexpr size_t kMessageBufferCapacity = 128;
+
+    /// Amount of time, in milliseconds, that the background thread waits between successive
+    /// passes over all of the message buffers.
+    static constexpr DWORD kWriterIntervalMilliseconds = 10;
+
+    /// Holds a single formatted message waiting to be written out.
+    struct SMessage
+    {
+      /// Severity of the message.
+      Infra::Message::ESeverity severity;
+
+      /// Formatted message text, null-terminated.
+      wchar_t text[kMaxMessageLength];
+    };
+
+    /// Fixed-capacity ring of messages produced by a single thread and consumed by the background
+    /// thread. Each counter is only ever modified by one side, so no locking is needed.
+    struct SMessageBuffer
+    {
+      /// Identifier of the thread that produces the messages.
+      DWORD threadId;
+
+      /// Total number of messages ever placed into the buffer. Modified only by the producer.
+      std::atomic<size_t> writeCount;
+
+      /// Total number of messages ever written out of the buffer. Modified only by the consumer.
+      std::atomic<size_t> readCount;
+
+      /// Number of messages dropped because the buffer was full since they were last reported.
+      std::atomic<unsigned int> droppedCount;
+
+      /// Storage for the messages themselves, indexed by count modulo capacity.
+      std::array<SMessage, kMessageBufferCapacity> messages;
+    };
+
+    /// Whether or not messages are being written out by the background thread.
+    static std::atomic<bool> isEnabled = false;
+
+    /// Guards the list of message buffers.
+    static std::mutex messageBuffersMutex;
+
+    /// All message buffers that might still contain messages. A buffer whose thread has exited is
+    /// owned only by this list and is released once it has been drained.
+    static std::vector<std::shared_ptr<SMessageBuffer>> messageBuffers;
+
+    /// Message buffer that belongs to the current thread, if it has submitted any messages.
+    static thread_local std::shared_ptr<SMessageBuffer> currentThreadMessageBuffer;
+
+    /// Retrieves the message buffer that belongs to the current thread, creating and registering
+    /// it if this is the first message the current thread has submitted.
+    /// @return Message buffer for the current thread.
+    static SMessageBuffer& CurrentThreadMessageBuffer(void)
+    {
+      if (nullptr == currentThreadMessageBuffer)
+      {
+        currentThreadMessageBuffer = std::make_shared<SMessageBuffer>();
+        currentThreadMessageBuffer->threadId = GetCurrentThreadId();
+
+        std::scoped_lock lock(messageBuffersMutex);
+        messageBuffers.push_back(currentThreadMessageBuffer);
+      }
+
+      return *currentThreadMessageBuffer;
+    }
+
+    /// Writes out all of the messages currently held in the specified buffer, followed by a
+    /// warning if any messages were dropped. Caller must hold the message buffers mutex.
+    /// @param [in] messageBuffer Buffer to drain.
+    static void DrainMessageBuffer(SMessageBuffer& messageBuffer)
+    {
+      const size_t writeCount = messageBuffer.writeCount.load(std::memory_order_acquire);
+
+      for (size_t readCount = messageBuffer.readCount.load(std::memory_order_relaxed);
+           readCount != writeCount;
+           ++readCount)
+      {
+        const SMessage& message = messageBuffer.messages[readCount % kMessageBufferCapacity];
+        Infra::Message::Output(message.severity, message.text);
+        messageBuffer.readCount.store(readCount + 1, std::memory_order_release);
+      }
+
+      const unsigned int droppedCount =
+          messageBuffer.droppedCount.exchange(0, std::memory_order_relaxed);
+      if (0 != droppedCount)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Dropped %u log message(s) from thread %u because they were produced faster than they could be written.",
+            droppedCount,
+            (unsigned int)messageBuffer.threadId);
+      }
+    }
+
+    /// Repeatedly drains all of the message buffers. Intended to be the entry point of the
+    /// background thread, and never returns.
+    static void WriteMessages(void)
+    {
+      while (true)
+      {
+        Sleep(kWriterIntervalMilliseconds);
+
+        std::scoped_lock lock(messageBuffersMutex);
+
+        for (auto messageBufferIter = messageBuffers.begin();
+             messageBufferIter != messageBuffers.end();)
+        {
+          DrainMessageBuffer(**messageBufferIter);
+
+          // Only this list refers to the buffer once its thread has exited, and since no more
+          // messages can be placed into it the buffer can now be released.
+          if (1 == messageBufferIter->use_count())
+            messageBufferIter = messageBuffers.erase(messageBufferIter);
+          else
+            ++messageBufferIter;
+        }
+      }
+    }
+
+    void Enable(void)
+    {
+      static std::once_flag enableFlag;
+      std::call_once(
+          enableFlag,
+          []() -> void
+          {
+            WorkerThread::StartDetached(
+                L"Xidi Log Writer", WorkerThread::EPriority::Housekeeping, WriteMessages);
+            isEnabled.store(true, std::memory_order_release);
+          });
+    }
+
+    void OutputFormatted(
+        Infra::Message::ESeverity severity, _Printf_format_string_ const wchar_t* format, ...)
+    {
+      if (false == Infra::Message::WillOutputMessageOfSeverity(severity)) return;
+
+      va_list args;
+      va_start(args, format);
+
+      if (false == isEnabled.load(std::memory_order_acquire))
+      {
+        wchar_t text[kMaxMessageLength];
+        _vsnwprintf_s(text, _countof(text), _TRUNCATE, format, args);
+        Infra::Message::Output(severity, text);
+      }
+      else
+      {
+        SMessageBuffer& messageBuffer = CurrentThreadMessageBuffer();
+        const size_t writeCount = messageBuffer.writeCount.load(std::memory_order_relaxed);
+
+        if ((writeCount - messageBuffer.readCount.load(std::memory_order_acquire)) >=
+            kMessageBufferCapacity)
+        {
+          messageBuffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+          SMessage& message = messageBuffer.messages[writeCount % kMessageBufferCapacity];
+          message.severity = severity;
+          _vsnwprintf_s(message.text, _countof(message.text), _TRUNCATE, format, args);
+          messageBuffer.writeCount.store(writeCount + 1, std::memory_order_release);
+        }
+      }
+
+      va_end(args);
+    }
+  } // namespace AsyncLog
+} // namespace Xidi
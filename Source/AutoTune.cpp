@@ -0,0 +1,353 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AutoTune.cpp
+ *   Implementation of functionality for learning settings suited to the way the running
+ *   executable reads input, and for persisting them in a per-executable profile.
+ **************************************************************************************************/
+
+#include "AutoTune.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <Infra/Core/Configuration.h>
+#include <Infra/Core/Message.h>
+
+#include "ApiCallProfile.h"
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Globals.h"
+#include "InputLatencyTrace.h"
+#include "Settings.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace AutoTune
+  {
+    /// Shortest session from which settings are suggested, in milliseconds.
+    static constexpr uint64_t kMinimumSessionMilliseconds = 30000;
+
+    /// Fewest reads of input from which settings are suggested.
+    static constexpr uint64_t kMinimumReads = 1000;
+
+    /// Longest polling period that is ever suggested, in milliseconds. Corresponds to one frame at
+    /// 60 frames per second, beyond which input would visibly lag behind even a slow input loop.
+    static constexpr unsigned int kMaximumPollingPeriodMilliseconds = 16;
+
+    /// Number of polls per read of buffered events at or beyond which coalescing axis events is
+    /// suggested, because most axis motion events would otherwise never be looked at individually.
+    static constexpr uint64_t kCoalesceAxisEventsMinimumPollsPerRead = 4;
+
+    /// Value of the system tick count when the session began, or 0 if it has not begun.
+    static uint64_t sessionBeginMilliseconds = 0;
+
+    /// Pairs of setting name and value, in configuration file syntax.
+    using TSettingValues = std::vector<std::pair<std::wstring_view, std::wstring>>;
+
+    /// Reads a Boolean setting from the auto-tuning section of the configuration file.
+    /// @param [in] name Name of the setting to read.
+    /// @return Value of the setting, or `false` if it is absent.
+    static bool ReadBooleanSetting(std::wstring_view name)
+    {
+      return Globals::GetConfigurationData()[Strings::kStrConfigurationSectionAutoTune][name]
+          .ValueOr(false);
+    }
+
+    /// Represents the specified settings as pairs of setting name and value, in the order in which
+    /// they should be output.
+    /// @param [in] tunedSettings Settings to represent.
+    /// @return Pairs of setting name and value.
+    static TSettingValues TunedSettingValues(const STunedSettings& tunedSettings)
+    {
+      TSettingValues settingValues = {
+          {Strings::kStrConfigurationSettingsPropertiesCoalesceAxisEvents,
+           ((true == tunedSettings.coalesceAxisEvents) ? L"yes" : L"no")},
+          {Strings::kStrConfigurationSettingsPropertiesOnDemandPolling,
+           ((true == tunedSettings.onDemandPolling) ? L"yes" : L"no")},
+          {Strings::kStrConfigurationSettingsPropertiesPollingPeriodMilliseconds,
+           std::to_wstring(tunedSettings.pollingPeriodMilliseconds)}};
+
+      if (true == tunedSettings.stateChangeEventPeriodMilliseconds.has_value())
+        settingValues.emplace_back(
+            Strings::kStrConfigurationSettingsPropertiesStateChangeEventPeriodMilliseconds,
+            std::to_wstring(tunedSettings.stateChangeEventPeriodMilliseconds.value()));
+
+      return settingValues;
+    }
+
+    /// Collects observations of the session that is ending from the API call profiler and, if it
+    /// is enabled, the input latency tracer.
+    /// @return Observations of the session.
+    static SObservations ObserveSession(void)
+    {
+      SObservations observations = {
+          .sessionMilliseconds = (GetTickCount64() - sessionBeginMilliseconds)};
+
+      std::vector<ApiCallProfile::SMethodStatistics> methodStatistics(
+          ApiCallProfile::GetStatistics({}));
+      methodStatistics.resize(
+          std::min(methodStatistics.size(), ApiCallProfile::GetStatistics(methodStatistics)));
+
+      // Method names are fully-qualified and, for DirectInput devices, there is one per interface
+      // version, so each method is identified by the last component of its name.
+      for (const auto& methodStatistic : methodStatistics)
+      {
+        const std::wstring_view methodName = methodStatistic.methodName;
+
+        if ((true == methodName.ends_with(L"::GetDeviceState")) ||
+            (true == methodName.ends_with(L"::joyGetPos")) ||
+            (true == methodName.ends_with(L"::joyGetPosEx")))
+          observations.numStateReads += methodStatistic.numCalls;
+        else if (true == methodName.ends_with(L"::GetDeviceData"))
+          observations.numBufferedReads += methodStatistic.numCalls;
+        else if (true == methodName.ends_with(L"::Poll"))
+          observations.numPolls += methodStatistic.numCalls;
+        else if (true == methodName.ends_with(L"::SetEventNotification"))
+          observations.numEventNotificationRequests += methodStatistic.numCalls;
+      }
+
+      // The physical controller that produced the most samples is the one the application
+      // actually uses, and is therefore the most representative of its input loop.
+      if (true == Controller::InputLatencyTrace::IsEnabled())
+      {
+        uint64_t mostSamples = 0;
+
+        for (Controller::TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < Controller::kMaxPhysicalControllerCount;
+             ++controllerIdentifier)
+        {
+          const Controller::InputLatencyTrace::SStageStatistics stageStatistics =
+              Controller::InputLatencyTrace::GetStatistics(
+                  controllerIdentifier, Controller::InputLatencyTrace::EStage::ApplicationRead);
+
+          if (stageStatistics.numSamples > mostSamples)
+          {
+            mostSamples = stageStatistics.numSamples;
+            observations.applicationReadMicroseconds = stageStatistics.p50Microseconds;
+          }
+        }
+      }
+
+      return observations;
+    }
+
+    /// Writes the specified contents to the profile file of the running executable.
+    /// @param [in] contents Contents to write.
+    /// @return `true` if the profile file was written successfully, `false` otherwise.
+    static bool WriteProfileFile(const std::string& contents)
+    {
+      const std::wstring profileFilename(Strings::GetAutoTuneProfileFilename());
+
+      // The profile file is written under a temporary name and then moved into place, so that a
+      // partially-written profile file is never read.
+      const std::wstring temporaryProfileFilename = profileFilename + L".tmp";
+      HANDLE profileFile = CreateFile(
+          temporaryProfileFilename.c_str(),
+          GENERIC_WRITE,
+          0,
+          nullptr,
+          CREATE_ALWAYS,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == profileFile)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to write auto-tuning profile file %s (last error = %u).",
+            profileFilename.c_str(),
+            (unsigned int)GetLastError());
+        return false;
+      }
+
+      DWORD numBytesWritten = 0;
+      const bool writeSucceeded =
+          ((0 !=
+            WriteFile(
+                profileFile, contents.data(), (DWORD)contents.size(), &numBytesWritten, nullptr)) &&
+           (contents.size() == numBytesWritten));
+      CloseHandle(profileFile);
+
+      if ((false == writeSucceeded) ||
+          (0 ==
+           MoveFileEx(
+               temporaryProfileFilename.c_str(),
+               profileFilename.c_str(),
+               MOVEFILE_REPLACE_EXISTING)))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to write auto-tuning profile file %s (last error = %u).",
+            profileFilename.c_str(),
+            (unsigned int)GetLastError());
+        DeleteFile(temporaryProfileFilename.c_str());
+        return false;
+      }
+
+      return true;
+    }
+
+    bool IsLearningEnabled(void)
+    {
+      static const bool kLearningEnabled =
+          ReadBooleanSetting(Strings::kStrConfigurationSettingAutoTuneLearn);
+      return kLearningEnabled;
+    }
+
+    void BeginSession(void)
+    {
+      if (false == IsLearningEnabled()) return;
+      sessionBeginMilliseconds = GetTickCount64();
+    }
+
+    std::optional<STunedSettings> SuggestSettings(const SObservations& observations)
+    {
+      const uint64_t numReads = observations.numStateReads + observations.numBufferedReads;
+      if ((observations.sessionMilliseconds < kMinimumSessionMilliseconds) ||
+          (numReads < kMinimumReads))
+        return std::nullopt;
+
+      // The average interval between reads over the whole session includes any time during which
+      // the application was not reading input at all, such as while loading. If the application
+      // read latency is known then it gives a better estimate, because reads are spread evenly
+      // over the interval between them and so the median wait for a read is half that interval.
+      uint64_t readIntervalMicroseconds = (observations.sessionMilliseconds * 1000) / numReads;
+      if ((true == observations.applicationReadMicroseconds.has_value()) &&
+          (0 != observations.applicationReadMicroseconds.value()))
+        readIntervalMicroseconds = std::min(
+            readIntervalMicroseconds, (2 * observations.applicationReadMicroseconds.value()));
+
+      // Polling twice per read means every read sees state that is at most half a read interval
+      // old, and polling any faster would mostly produce state that is never read.
+      const unsigned int pollingPeriodMilliseconds = std::clamp<unsigned int>(
+          (unsigned int)(readIntervalMicroseconds / 2000), 1, kMaximumPollingPeriodMilliseconds);
+
+      STunedSettings tunedSettings = {
+          .pollingPeriodMilliseconds = pollingPeriodMilliseconds,
+          .onDemandPolling = ((observations.numPolls * 10) >= (numReads * 9)),
+          .coalesceAxisEvents =
+              ((0 != observations.numBufferedReads) &&
+               (readIntervalMicroseconds >=
+                (kCoalesceAxisEventsMinimumPollsPerRead * pollingPeriodMilliseconds * 1000)))};
+
+      // Notifications caused by axis movement alone are of no use if they arrive faster than the
+      // application reads, so they are limited to about two per read.
+      if (0 != observations.numEventNotificationRequests)
+        tunedSettings.stateChangeEventPeriodMilliseconds = std::clamp<DWORD>(
+            (DWORD)(readIntervalMicroseconds / 2000),
+            pollingPeriodMilliseconds,
+            kMaximumPollingPeriodMilliseconds);
+
+      return tunedSettings;
+    }
+
+    std::string ProfileFileContents(const STunedSettings& tunedSettings)
+    {
+      std::wstring wideContents;
+      wideContents.append(L"; Generated by auto-tuning.\n");
+      wideContents.append(L"; Settings in the configuration file take precedence.\n");
+      wideContents.append(L"[").append(Strings::kStrConfigurationSectionProperties).append(L"]\n");
+
+      for (const auto& [name, value] : TunedSettingValues(tunedSettings))
+        wideContents.append(name).append(L" = ").append(value).append(L"\n");
+
+      // All setting names and values are plain ASCII, so each character narrows without loss.
+      std::string contents;
+      contents.reserve(wideContents.length());
+      for (const wchar_t wideChar : wideContents)
+        contents.push_back((char)wideChar);
+
+      return contents;
+    }
+
+    void ApplyProfile(
+        const Infra::Configuration::ConfigurationData& profileData,
+        const Infra::Configuration::ConfigurationData& configData,
+        SSettings& settings)
+    {
+      const auto& configPropertiesData = configData[Strings::kStrConfigurationSectionProperties];
+      const auto& profilePropertiesData = profileData[Strings::kStrConfigurationSectionProperties];
+      SSettings::SProperties& properties = settings.properties;
+
+      // Each setting keeps the value it already has if either the configuration file specifies
+      // it or the profile does not.
+      auto applyBoolean = [&configPropertiesData, &profilePropertiesData](
+                              std::wstring_view name, bool& setting) -> void
+      {
+        if (true == configPropertiesData.Contains(name)) return;
+        setting = profilePropertiesData[name].ValueOr(setting);
+      };
+      auto applyInteger = [&configPropertiesData, &profilePropertiesData]<typename IntegerType>(
+                              std::wstring_view name, IntegerType& setting) -> void
+      {
+        if (true == configPropertiesData.Contains(name)) return;
+        setting = static_cast<IntegerType>(
+            profilePropertiesData[name].ValueOr(static_cast<int64_t>(setting)));
+      };
+
+      applyBoolean(
+          Strings::kStrConfigurationSettingsPropertiesCoalesceAxisEvents,
+          properties.coalesceAxisEvents);
+      applyBoolean(
+          Strings::kStrConfigurationSettingsPropertiesOnDemandPolling, properties.onDemandPolling);
+      applyInteger(
+          Strings::kStrConfigurationSettingsPropertiesPollingPeriodMilliseconds,
+          properties.pollingPeriodMilliseconds);
+      applyInteger(
+          Strings::kStrConfigurationSettingsPropertiesStateChangeEventPeriodMilliseconds,
+          properties.stateChangeEventPeriodMilliseconds);
+    }
+
+    void OutputSummary(void)
+    {
+      if (false == IsLearningEnabled()) return;
+
+      const SObservations observations = ObserveSession();
+      const std::optional<STunedSettings> maybeTunedSettings = SuggestSettings(observations);
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Auto-tuning observed %llu state reads, %llu buffered reads, and %llu polls over %llu seconds.",
+          observations.numStateReads,
+          observations.numBufferedReads,
+          observations.numPolls,
+          (observations.sessionMilliseconds / 1000));
+
+      if (false == maybeTunedSettings.has_value())
+      {
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Info,
+            L"Auto-tuning did not observe enough input reads to suggest any settings.");
+        return;
+      }
+
+      for (const auto& [name, value] : TunedSettingValues(maybeTunedSettings.value()))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Auto-tuning suggests setting %s to %s in the %s section.",
+            name.data(),
+            value.c_str(),
+            Strings::kStrConfigurationSectionProperties.data());
+      }
+
+      if (false == ReadBooleanSetting(Strings::kStrConfigurationSettingAutoTuneSaveProfile)) return;
+
+      if (true == WriteProfileFile(ProfileFileContents(maybeTunedSettings.value())))
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Auto-tuning wrote suggested settings to profile file %s.",
+            Strings::GetAutoTuneProfileFilename().data());
+    }
+  } // namespace AutoTune
+} // namespace Xidi
@@ -0,0 +1,228 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file BenchmarkHarness.cpp
+ *   Implementation of a minimal microbenchmark harness.
+ **************************************************************************************************/
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ApiWindows.h"
+
+namespace XidiBenchmark
+{
+  const void* volatile benchmarkValueSink = nullptr;
+
+  /// Minimum amount of time a single measurement needs to take for it to be considered reliable.
+  static constexpr int64_t kMinimumMeasurementMicroseconds = 100000;
+
+  /// Number of measurements taken for each benchmark case. The median is reported.
+  static constexpr unsigned int kNumMeasurements = 5;
+
+  /// Fractional increase in time per operation, relative to the baseline, beyond which a
+  /// benchmark case is considered to have regressed.
+  static constexpr double kRegressionThreshold = 0.10;
+
+  /// Single additional measurement reported by a benchmark case using #ReportMetric.
+  struct SMetric
+  {
+    std::wstring name;
+    double value;
+    std::wstring unit;
+  };
+
+  /// Additional measurements reported by the benchmark case that is currently running, in the
+  /// order in which they were reported. Cleared at the start of every run of a benchmark case.
+  static std::vector<SMetric> currentMetrics;
+
+  /// Retrieves the registry of all benchmark cases, keyed by name. Using a function-local static
+  /// object ensures the registry exists before any benchmark case is registered, regardless of
+  /// static initialization order.
+  /// @return Mutable reference to the registry.
+  static std::map<std::wstring_view, TBenchmarkCaseFunc>& BenchmarkCaseRegistry(void)
+  {
+    static std::map<std::wstring_view, TBenchmarkCaseFunc> registry;
+    return registry;
+  }
+
+  /// Retrieves and returns the current value of the performance counter.
+  /// @return Current performance counter value.
+  static int64_t PerformanceCounterNow(void)
+  {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+  }
+
+  /// Retrieves and returns the frequency of the performance counter.
+  /// @return Number of performance counter ticks per second.
+  static int64_t PerformanceCounterFrequency(void)
+  {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+  }
+
+  /// Invokes a benchmark case once with the specified number of iterations and measures how long
+  /// it takes.
+  /// @param [in] benchmarkCaseFunc Body of the benchmark case.
+  /// @param [in] numIterations Number of iterations to request.
+  /// @return Elapsed time, in microseconds.
+  static int64_t MeasureMicroseconds(TBenchmarkCaseFunc benchmarkCaseFunc, uint64_t numIterations)
+  {
+    currentMetrics.clear();
+
+    const int64_t beginTicks = PerformanceCounterNow();
+    benchmarkCaseFunc(numIterations);
+    const int64_t endTicks = PerformanceCounterNow();
+
+    return ((endTicks - beginTicks) * 1000000) / PerformanceCounterFrequency();
+  }
+
+  /// Runs a single benchmark case. The number of iterations is first calibrated so that each
+  /// measurement takes long enough to be reliable, and then several measurements are taken.
+  /// @param [in] benchmarkCaseFunc Body of the benchmark case.
+  /// @return Median time per operation across all measurements, in nanoseconds.
+  static double RunBenchmarkCase(TBenchmarkCaseFunc benchmarkCaseFunc)
+  {
+    uint64_t numIterations = 1;
+    int64_t elapsedMicroseconds = MeasureMicroseconds(benchmarkCaseFunc, numIterations);
+
+    while (elapsedMicroseconds < (kMinimumMeasurementMicroseconds / 10))
+    {
+      numIterations *= 2;
+      elapsedMicroseconds = MeasureMicroseconds(benchmarkCaseFunc, numIterations);
+    }
+
+    numIterations = std::max<uint64_t>(
+        1,
+        (numIterations * kMinimumMeasurementMicroseconds) /
+            (uint64_t)std::max<int64_t>(1, elapsedMicroseconds));
+
+    std::array<double, kNumMeasurements> nanosecondsPerOperation;
+    for (auto& measurement : nanosecondsPerOperation)
+      measurement =
+          ((double)MeasureMicroseconds(benchmarkCaseFunc, numIterations) * 1000.0) /
+          (double)numIterations;
+
+    std::sort(nanosecondsPerOperation.begin(), nanosecondsPerOperation.end());
+    return nanosecondsPerOperation[kNumMeasurements / 2];
+  }
+
+  /// Reads baseline results from a file previously written by this harness. Each line holds the
+  /// name of a benchmark case followed by its time per operation in nanoseconds.
+  /// @param [in] baselineFilename Name of the file to read.
+  /// @param [out] baseline Filled with the baseline results, keyed by benchmark case name.
+  /// @return `true` if the file was read successfully, `false` otherwise.
+  static bool ReadBaseline(
+      const wchar_t* baselineFilename, std::map<std::wstring, double>& baseline)
+  {
+    FILE* baselineFile = nullptr;
+    if (0 != _wfopen_s(&baselineFile, baselineFilename, L"r")) return false;
+
+    wchar_t name[256];
+    double nanoseconds = 0.0;
+    while (2 ==
+           fwscanf_s(
+               baselineFile, L"%255s %lf", name, (unsigned int)_countof(name), &nanoseconds))
+      baseline[name] = nanoseconds;
+
+    fclose(baselineFile);
+    return true;
+  }
+
+  void ReportMetric(std::wstring_view metricName, double value, std::wstring_view unit)
+  {
+    currentMetrics.push_back(
+        {.name = std::wstring(metricName), .value = value, .unit = std::wstring(unit)});
+  }
+
+  BenchmarkCase::BenchmarkCase(std::wstring_view name, TBenchmarkCaseFunc benchmarkCaseFunc)
+  {
+    BenchmarkCaseRegistry()[name] = benchmarkCaseFunc;
+  }
+
+  namespace Harness
+  {
+    int RunBenchmarksWithMatchingPrefix(
+        std::wstring_view prefix, const wchar_t* baselineFilename, const wchar_t* resultsFilename)
+    {
+      std::map<std::wstring, double> baseline;
+      if ((nullptr != baselineFilename) && (false == ReadBaseline(baselineFilename, baseline)))
+      {
+        fwprintf(stderr, L"Unable to read baseline file %s.\n", baselineFilename);
+        return -1;
+      }
+
+      FILE* resultsFile = nullptr;
+      if ((nullptr != resultsFilename) && (0 != _wfopen_s(&resultsFile, resultsFilename, L"w")))
+      {
+        fwprintf(stderr, L"Unable to write results file %s.\n", resultsFilename);
+        return -1;
+      }
+
+      int numRegressions = 0;
+      unsigned int numBenchmarkCasesRun = 0;
+
+      for (const auto& benchmarkCase : BenchmarkCaseRegistry())
+      {
+        if (false == benchmarkCase.first.starts_with(prefix)) continue;
+
+        const double nanosecondsPerOperation = RunBenchmarkCase(benchmarkCase.second);
+        numBenchmarkCasesRun += 1;
+
+        const std::wstring name(benchmarkCase.first);
+        const auto baselineResult = baseline.find(name);
+
+        if (baseline.cend() == baselineResult)
+        {
+          wprintf(L"%-72s %12.1f ns/op\n", name.c_str(), nanosecondsPerOperation);
+        }
+        else
+        {
+          const double change = (nanosecondsPerOperation - baselineResult->second) /
+              std::max(baselineResult->second, 0.001);
+          const bool isRegression = (change > kRegressionThreshold);
+          if (true == isRegression) numRegressions += 1;
+
+          wprintf(
+              L"%-72s %12.1f ns/op  %+7.1f%% vs %.1f ns/op%s\n",
+              name.c_str(),
+              nanosecondsPerOperation,
+              change * 100.0,
+              baselineResult->second,
+              ((true == isRegression) ? L"  REGRESSION" : L""));
+        }
+
+        for (const auto& metric : currentMetrics)
+          wprintf(L"  %-70s %12.1f %s\n", metric.name.c_str(), metric.value, metric.unit.c_str());
+
+        if (nullptr != resultsFile)
+          fwprintf(resultsFile, L"%s %.3f\n", name.c_str(), nanosecondsPerOperation);
+      }
+
+      if (nullptr != resultsFile) fclose(resultsFile);
+
+      wprintf(L"\nRan %u benchmark case(s).", numBenchmarkCasesRun);
+      if (false == baseline.empty())
+        wprintf(
+            L" %d regressed by more than %.0f%%.", numRegressions, kRegressionThreshold * 100.0);
+      wprintf(L"\n");
+
+      return numRegressions;
+    }
+  } // namespace Harness
+} // namespace XidiBenchmark
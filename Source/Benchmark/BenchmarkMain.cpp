@@ -0,0 +1,43 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file BenchmarkMain.cpp
+ *   Entry point for the benchmark executable.
+ **************************************************************************************************/
+
+#include <string_view>
+
+#include "Benchmark.h"
+#include "Globals.h"
+
+/// Command-line option that precedes the name of a baseline file against which to compare.
+static constexpr std::wstring_view kOptionBaseline = L"--baseline=";
+
+/// Command-line option that precedes the name of a file to which to write results.
+static constexpr std::wstring_view kOptionSave = L"--save=";
+
+int wmain(int argc, const wchar_t* argv[])
+{
+  std::wstring_view prefix = L"";
+  const wchar_t* baselineFilename = nullptr;
+  const wchar_t* resultsFilename = nullptr;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::wstring_view argument = argv[i];
+
+    if (true == argument.starts_with(kOptionBaseline))
+      baselineFilename = &argv[i][kOptionBaseline.length()];
+    else if (true == argument.starts_with(kOptionSave))
+      resultsFilename = &argv[i][kOptionSave.length()];
+    else
+      prefix = argument;
+  }
+
+  return XidiBenchmark::Harness::RunBenchmarksWithMatchingPrefix(
+      prefix, baselineFilename, resultsFilename);
+}
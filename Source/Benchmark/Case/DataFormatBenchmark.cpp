@@ -0,0 +1,135 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file DataFormatBenchmark.cpp
+ *   Benchmarks for writing application data packets using the standard DirectInput formats, both
+ *   directly and by executing compiled write operations.
+ **************************************************************************************************/
+
+#include "DataFormat.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ApiDirectInput.h"
+#include "Benchmark.h"
+#include "BenchmarkPhysicalStates.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi;
+  using namespace ::Xidi::Controller;
+
+  /// Builds the object format specification that DirectInput uses for its built-in joystick data
+  /// formats, `c_dfDIJoystick` and `c_dfDIJoystick2`. The extended axes present only in
+  /// `DIJOYSTATE2` are omitted because virtual controllers never present them.
+  /// @param [in] numButtons Number of buttons in the data format.
+  /// @return Object format specification, one element per object.
+  static std::vector<DIOBJECTDATAFORMAT> MakeJoystickObjectFormatSpec(unsigned int numButtons)
+  {
+    const std::array<std::pair<const GUID*, DWORD>, 8> kAxes = {{
+        {&GUID_XAxis, DIJOFS_X},
+        {&GUID_YAxis, DIJOFS_Y},
+        {&GUID_ZAxis, DIJOFS_Z},
+        {&GUID_RxAxis, DIJOFS_RX},
+        {&GUID_RyAxis, DIJOFS_RY},
+        {&GUID_RzAxis, DIJOFS_RZ},
+        {&GUID_Slider, DIJOFS_SLIDER(0)},
+        {&GUID_Slider, DIJOFS_SLIDER(1)},
+    }};
+
+    std::vector<DIOBJECTDATAFORMAT> objectFormatSpec;
+
+    for (const auto& axis : kAxes)
+      objectFormatSpec.push_back(
+          {.pguid = axis.first,
+           .dwOfs = axis.second,
+           .dwType = (DIDFT_OPTIONAL | DIDFT_AXIS | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+
+    for (int pov = 0; pov < 4; ++pov)
+      objectFormatSpec.push_back(
+          {.pguid = &GUID_POV,
+           .dwOfs = (DWORD)DIJOFS_POV(pov),
+           .dwType = (DIDFT_OPTIONAL | DIDFT_POV | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+
+    for (unsigned int button = 0; button < numButtons; ++button)
+      objectFormatSpec.push_back(
+          {.pguid = nullptr,
+           .dwOfs = (DWORD)DIJOFS_BUTTON(button),
+           .dwType = (DIDFT_OPTIONAL | DIDFT_BUTTON | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+
+    return objectFormatSpec;
+  }
+
+  /// Data packet with the same layout as `DIJOYSTATE` but with extra space at the end. Prevents
+  /// the data packet from being recognized as a standard data format, so that it is written by
+  /// executing compiled write operations.
+  struct SPaddedJoyState
+  {
+    DIJOYSTATE joyState;
+    DWORD padding;
+  };
+
+  /// Writes a sequence of varying virtual controller states into a data packet using the
+  /// specified standard data format.
+  /// @tparam DataPacketType Type of the data packet structure.
+  /// @param [in] numButtons Number of buttons in the data format.
+  /// @param [in] numIterations Number of data packets to write.
+  template <typename DataPacketType> static void BenchmarkWriteDataPacket(
+      unsigned int numButtons, uint64_t numIterations)
+  {
+    const Mapper& mapper = *Mapper::GetByName(L"StandardGamepad");
+
+    std::vector<DIOBJECTDATAFORMAT> objectFormatSpec = MakeJoystickObjectFormatSpec(numButtons);
+    const DIDATAFORMAT formatSpec = {
+        .dwSize = sizeof(DIDATAFORMAT),
+        .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+        .dwFlags = DIDF_ABSAXIS,
+        .dwDataSize = sizeof(DataPacketType),
+        .dwNumObjs = (DWORD)objectFormatSpec.size(),
+        .rgodf = objectFormatSpec.data()};
+
+    const std::unique_ptr<DataFormat> dataFormat =
+        DataFormat::CreateFromApplicationFormatSpec(formatSpec, mapper.GetCapabilities());
+
+    const TBenchmarkPhysicalStates physicalStates = MakeBenchmarkPhysicalStates();
+    std::array<SState, kNumBenchmarkPhysicalStates> virtualStates;
+    for (size_t i = 0; i < physicalStates.size(); ++i)
+      virtualStates[i] = mapper.MapStatePhysicalToVirtual(physicalStates[i], 0);
+
+    DataPacketType dataPacket;
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      dataFormat->WriteDataPacket(
+          &dataPacket, sizeof(dataPacket), virtualStates[i % virtualStates.size()]);
+      DoNotOptimize(dataPacket);
+    }
+  }
+
+  BENCHMARK_CASE(DataFormat_WriteDataPacket_DIJoystick)
+  {
+    BenchmarkWriteDataPacket<DIJOYSTATE>(32, numIterations);
+  }
+
+  BENCHMARK_CASE(DataFormat_WriteDataPacket_DIJoystick2)
+  {
+    BenchmarkWriteDataPacket<DIJOYSTATE2>(128, numIterations);
+  }
+
+  BENCHMARK_CASE(DataFormat_WriteDataPacket_DIJoystickNotStandard)
+  {
+    BenchmarkWriteDataPacket<SPaddedJoyState>(32, numIterations);
+  }
+} // namespace XidiBenchmark
@@ -0,0 +1,67 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ForceFeedbackDeviceBenchmark.cpp
+ *   Benchmarks for playing force feedback effects on a force feedback device buffer.
+ **************************************************************************************************/
+
+#include "ForceFeedbackDevice.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "Benchmark.h"
+#include "ForceFeedbackTypes.h"
+#include "MockForceFeedbackEffect.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi::Controller::ForceFeedback;
+  using ::XidiTest::MockEffect;
+
+  /// Duration of each effect. Playback timestamps wrap around before reaching it, so that effects
+  /// never complete no matter how many iterations are requested.
+  static constexpr TEffectTimeMs kEffectDuration = 1000000;
+
+  /// Plays the specified number of simultaneously-playing effects. Each iteration advances the
+  /// playback timestamp so that results of previous playback operations cannot be reused.
+  /// @param [in] numEffects Number of effects to play simultaneously.
+  /// @param [in] numIterations Number of playback operations to perform.
+  static void BenchmarkPlayEffects(unsigned int numEffects, uint64_t numIterations)
+  {
+    Device device(0);
+    std::vector<MockEffect> effects(numEffects);
+
+    for (auto& effect : effects)
+    {
+      effect.InitializeDefaultAssociatedAxes();
+      effect.InitializeDefaultDirection();
+      effect.SetDuration(kEffectDuration);
+
+      device.AddOrUpdateEffect(effect);
+      device.StartEffect(effect.Identifier(), 1, 0);
+    }
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+      DoNotOptimize(device.PlayEffects((TEffectTimeMs)(1 + (i % (kEffectDuration - 1)))));
+  }
+
+  BENCHMARK_CASE(ForceFeedbackDevice_PlayEffects_1)
+  {
+    BenchmarkPlayEffects(1, numIterations);
+  }
+
+  BENCHMARK_CASE(ForceFeedbackDevice_PlayEffects_16)
+  {
+    BenchmarkPlayEffects(16, numIterations);
+  }
+
+  BENCHMARK_CASE(ForceFeedbackDevice_PlayEffects_256)
+  {
+    BenchmarkPlayEffects(Device::kEffectMaxCount, numIterations);
+  }
+} // namespace XidiBenchmark
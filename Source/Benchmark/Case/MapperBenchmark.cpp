@@ -0,0 +1,70 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MapperBenchmark.cpp
+ *   Benchmarks for mapping physical controller state to virtual controller state.
+ **************************************************************************************************/
+
+#include "Mapper.h"
+
+#include <cstdint>
+#include <string_view>
+
+#include "Benchmark.h"
+#include "BenchmarkPhysicalStates.h"
+#include "ControllerTypes.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi::Controller;
+
+  /// Opaque source identifier to use for all mapping operations.
+  static constexpr uint32_t kOpaqueSourceIdentifier = 0;
+
+  /// Maps a sequence of varying physical states using the specified built-in mapper.
+  /// @param [in] mapperName Name of the built-in mapper to use.
+  /// @param [in] numIterations Number of physical states to map.
+  static void BenchmarkBuiltinMapper(std::wstring_view mapperName, uint64_t numIterations)
+  {
+    static const TBenchmarkPhysicalStates kPhysicalStates = MakeBenchmarkPhysicalStates();
+
+    const Mapper* const mapper = Mapper::GetByName(mapperName);
+    const Mapper::SCompiledPhysicalTransform& transform = Mapper::GetDefaultPhysicalTransform();
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      const SState virtualState = mapper->MapStatePhysicalToVirtual(
+          kPhysicalStates[i % kPhysicalStates.size()], transform, kOpaqueSourceIdentifier);
+      DoNotOptimize(virtualState);
+    }
+  }
+
+  BENCHMARK_CASE(Mapper_MapStatePhysicalToVirtual_DigitalGamepad)
+  {
+    BenchmarkBuiltinMapper(L"DigitalGamepad", numIterations);
+  }
+
+  BENCHMARK_CASE(Mapper_MapStatePhysicalToVirtual_ExtendedGamepad)
+  {
+    BenchmarkBuiltinMapper(L"ExtendedGamepad", numIterations);
+  }
+
+  BENCHMARK_CASE(Mapper_MapStatePhysicalToVirtual_StandardGamepad)
+  {
+    BenchmarkBuiltinMapper(L"StandardGamepad", numIterations);
+  }
+
+  BENCHMARK_CASE(Mapper_MapStatePhysicalToVirtual_XInputNative)
+  {
+    BenchmarkBuiltinMapper(L"XInputNative", numIterations);
+  }
+
+  BENCHMARK_CASE(Mapper_MapStatePhysicalToVirtual_XInputSharedTriggers)
+  {
+    BenchmarkBuiltinMapper(L"XInputSharedTriggers", numIterations);
+  }
+} // namespace XidiBenchmark
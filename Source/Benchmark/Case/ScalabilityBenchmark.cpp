@@ -0,0 +1,181 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ScalabilityBenchmark.cpp
+ *   Benchmarks for publishing physical controller state changes to many DirectInput device
+ *   objects spread across multiple physical controllers.
+ **************************************************************************************************/
+
+#include "VirtualDirectInputDevice.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ApiDirectInput.h"
+#include "ApiWindows.h"
+#include "Benchmark.h"
+#include "BenchmarkPhysicalStates.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "MockPhysicalController.h"
+#include "VirtualController.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi;
+  using namespace ::Xidi::Controller;
+  using ::XidiTest::MockPhysicalController;
+
+  /// Type of DirectInput device object created by all benchmark cases in this file.
+  using TDeviceObject = VirtualDirectInputDevice<EDirectInputVersion::k8W>;
+
+  /// Retrieves the total amount of processor time, both kernel and user, consumed so far by all
+  /// threads in this process. Windows updates this value at the granularity of the system timer,
+  /// so it is only meaningful over intervals much longer than that.
+  /// @return Processor time, in nanoseconds.
+  static uint64_t ProcessCpuTimeNanoseconds(void)
+  {
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (0 == GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+      return 0;
+
+    const uint64_t kernelTime100ns =
+        ((uint64_t)kernelTime.dwHighDateTime << 32) | (uint64_t)kernelTime.dwLowDateTime;
+    const uint64_t userTime100ns =
+        ((uint64_t)userTime.dwHighDateTime << 32) | (uint64_t)userTime.dwLowDateTime;
+
+    return (kernelTime100ns + userTime100ns) * 100;
+  }
+
+  /// Retrieves the amount of physical memory currently resident in this process's working set.
+  /// @return Working set size, in bytes.
+  static int64_t ProcessWorkingSetBytes(void)
+  {
+    PROCESS_MEMORY_COUNTERS memoryCounters = {.cb = sizeof(memoryCounters)};
+    if (0 == GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+      return 0;
+
+    return (int64_t)memoryCounters.WorkingSetSize;
+  }
+
+  /// Counts the threads that currently exist in this process.
+  /// @return Number of threads.
+  static unsigned int ProcessThreadCount(void)
+  {
+    const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (INVALID_HANDLE_VALUE == snapshot) return 0;
+
+    const DWORD currentProcessId = GetCurrentProcessId();
+    unsigned int numThreads = 0;
+
+    THREADENTRY32 threadEntry = {.dwSize = sizeof(threadEntry)};
+    for (BOOL haveThreadEntry = Thread32First(snapshot, &threadEntry); TRUE == haveThreadEntry;
+         haveThreadEntry = Thread32Next(snapshot, &threadEntry))
+    {
+      if (currentProcessId == threadEntry.th32OwnerProcessID) numThreads += 1;
+    }
+
+    CloseHandle(snapshot);
+    return numThreads;
+  }
+
+  /// Creates the specified number of DirectInput device objects, spread evenly across physical
+  /// controllers, each with a state change event like an application waiting for input would set.
+  /// Then repeatedly publishes a physical controller state change to one physical controller at a
+  /// time, in turn, which refreshes and signals every device object associated with it. In
+  /// addition to time per published state change, reports process processor time per published
+  /// state change, which includes any work done by other threads, along with resident memory per
+  /// device object and thread counts. Time per operation includes creating the device objects,
+  /// whereas processor time per published state change covers only publishing.
+  /// @param [in] numDeviceObjects Number of device objects to create.
+  /// @param [in] numIterations Number of state changes to publish.
+  static void BenchmarkPublishStateChanges(unsigned int numDeviceObjects, uint64_t numIterations)
+  {
+    static const TBenchmarkPhysicalStates kPhysicalStates = MakeBenchmarkPhysicalStates();
+
+    const Mapper& mapper = *Mapper::GetByName(L"StandardGamepad");
+    const TControllerIdentifier numPhysicalControllers = std::min<TControllerIdentifier>(
+        (TControllerIdentifier)numDeviceObjects, GetPhysicalControllerCount());
+
+    // Mock physical controllers cannot advance past the end of their physical state arrays, so
+    // there must be enough physical states for every physical controller's share of iterations.
+    // All of them can share the same array because it is only ever read.
+    std::vector<SPhysicalState> physicalStates((numIterations / numPhysicalControllers) + 2);
+    for (size_t i = 0; i < physicalStates.size(); ++i)
+      physicalStates[i] = kPhysicalStates[i % kPhysicalStates.size()];
+
+    std::vector<std::unique_ptr<MockPhysicalController>> physicalControllers;
+    for (TControllerIdentifier i = 0; i < numPhysicalControllers; ++i)
+      physicalControllers.push_back(std::make_unique<MockPhysicalController>(
+          i, mapper, physicalStates.data(), physicalStates.size()));
+
+    const int64_t workingSetBytesBefore = ProcessWorkingSetBytes();
+    const unsigned int numThreadsBefore = ProcessThreadCount();
+
+    std::vector<std::unique_ptr<TDeviceObject>> deviceObjects;
+    std::vector<HANDLE> stateChangeEvents;
+    for (unsigned int i = 0; i < numDeviceObjects; ++i)
+    {
+      const TControllerIdentifier controllerIdentifier =
+          (TControllerIdentifier)(i % numPhysicalControllers);
+      deviceObjects.push_back(std::make_unique<TDeviceObject>(
+          std::make_unique<VirtualController>(controllerIdentifier)));
+
+      stateChangeEvents.push_back(CreateEvent(nullptr, FALSE, FALSE, nullptr));
+      deviceObjects.back()->SetEventNotification(stateChangeEvents.back());
+    }
+
+    const int64_t workingSetBytesAfter = ProcessWorkingSetBytes();
+    const unsigned int numThreadsAfter = ProcessThreadCount();
+
+    const uint64_t cpuTimeBegin = ProcessCpuTimeNanoseconds();
+    for (uint64_t i = 0; i < numIterations; ++i)
+      physicalControllers[i % numPhysicalControllers]->RequestAdvancePhysicalState();
+    const uint64_t cpuTimeEnd = ProcessCpuTimeNanoseconds();
+
+    ReportMetric(
+        L"Process CPU time per published state change",
+        (double)(cpuTimeEnd - cpuTimeBegin) / (double)numIterations,
+        L"ns");
+    ReportMetric(
+        L"Resident memory per device object",
+        (double)(workingSetBytesAfter - workingSetBytesBefore) / (double)numDeviceObjects,
+        L"bytes");
+    ReportMetric(L"Threads in process", (double)numThreadsAfter, L"threads");
+    ReportMetric(
+        L"Threads added by device objects",
+        (double)((int)numThreadsAfter - (int)numThreadsBefore),
+        L"threads");
+
+    deviceObjects.clear();
+    for (HANDLE stateChangeEvent : stateChangeEvents)
+      CloseHandle(stateChangeEvent);
+  }
+
+  BENCHMARK_CASE(Scalability_PublishStateChange_001DeviceObjects)
+  {
+    BenchmarkPublishStateChanges(1, numIterations);
+  }
+
+  BENCHMARK_CASE(Scalability_PublishStateChange_008DeviceObjects)
+  {
+    BenchmarkPublishStateChanges(8, numIterations);
+  }
+
+  BENCHMARK_CASE(Scalability_PublishStateChange_064DeviceObjects)
+  {
+    BenchmarkPublishStateChanges(64, numIterations);
+  }
+
+  BENCHMARK_CASE(Scalability_PublishStateChange_256DeviceObjects)
+  {
+    BenchmarkPublishStateChanges(256, numIterations);
+  }
+} // namespace XidiBenchmark
@@ -0,0 +1,210 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file StartupBenchmark.cpp
+ *   Benchmarks for the startup work of reading a large configuration file, parsing the element
+ *   mappers it contains, and building the custom mappers it defines.
+ **************************************************************************************************/
+
+#include "XidiConfigReader.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "ApiWindows.h"
+#include "Benchmark.h"
+#include "BenchmarkConfiguration.h"
+#include "Mapper.h"
+#include "MapperBuilder.h"
+#include "MapperParser.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi;
+  using namespace ::Xidi::Controller;
+
+  /// Holds a synthetic configuration along with the name of the file to which it was written.
+  struct SBenchmarkConfigurationFile
+  {
+    SBenchmarkConfiguration configuration;
+    std::wstring filename;
+  };
+
+  /// Retrieves the synthetic configuration that defines the specified number of custom mappers,
+  /// generating it and writing it to a file in the temporary directory the first time it is
+  /// requested. The file contains only ASCII characters, so it is written as such.
+  /// @param [in] numCustomMappers Number of custom mappers the configuration defines.
+  /// @return Read-only reference to the configuration and the name of its file.
+  static const SBenchmarkConfigurationFile& BenchmarkConfigurationFile(
+      unsigned int numCustomMappers)
+  {
+    static std::map<unsigned int, SBenchmarkConfigurationFile> configurationFiles;
+
+    auto configurationFile = configurationFiles.find(numCustomMappers);
+    if (configurationFiles.end() != configurationFile) return configurationFile->second;
+
+    SBenchmarkConfigurationFile newConfigurationFile = {
+        .configuration = MakeBenchmarkConfiguration(numCustomMappers)};
+
+    wchar_t temporaryDirectory[MAX_PATH + 1] = {};
+    GetTempPath(_countof(temporaryDirectory), temporaryDirectory);
+    newConfigurationFile.filename = std::wstring(temporaryDirectory) + L"XidiBenchmark" +
+        std::to_wstring(numCustomMappers) + L".ini";
+
+    FILE* outputFile = nullptr;
+    if (0 == _wfopen_s(&outputFile, newConfigurationFile.filename.c_str(), L"wb"))
+    {
+      for (const wchar_t character : newConfigurationFile.configuration.fileContents)
+        fputc((int)character, outputFile);
+
+      fclose(outputFile);
+    }
+    else
+    {
+      fwprintf(
+          stderr,
+          L"Unable to write benchmark configuration file %s.\n",
+          newConfigurationFile.filename.c_str());
+    }
+
+    return configurationFiles.emplace(numCustomMappers, std::move(newConfigurationFile))
+        .first->second;
+  }
+
+  /// Reads the specified synthetic configuration file the way Xidi does at startup, which also
+  /// parses all of its element mapper strings and fills the specified mapper builder with
+  /// blueprints for all of its custom mappers.
+  /// @param [in] configurationFile Synthetic configuration file to read.
+  /// @param [in,out] mapperBuilder Mapper builder object to receive custom mapper blueprints.
+  static void ReadBenchmarkConfigurationFile(
+      const SBenchmarkConfigurationFile& configurationFile, MapperBuilder& mapperBuilder)
+  {
+    XidiConfigReader configReader;
+    configReader.SetMapperBuilder(&mapperBuilder);
+    DoNotOptimize(configReader.ReadConfigurationFile(configurationFile.filename));
+  }
+
+  /// Repeatedly reads a synthetic configuration file, including the element mapper parsing and
+  /// blueprint creation that happen while reading.
+  /// @param [in] numCustomMappers Number of custom mappers the configuration file defines.
+  /// @param [in] numIterations Number of times to read the configuration file.
+  static void BenchmarkReadConfigurationFile(unsigned int numCustomMappers, uint64_t numIterations)
+  {
+    const SBenchmarkConfigurationFile& configurationFile =
+        BenchmarkConfigurationFile(numCustomMappers);
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      MapperBuilder mapperBuilder;
+      ReadBenchmarkConfigurationFile(configurationFile, mapperBuilder);
+    }
+  }
+
+  /// Repeatedly parses every element mapper string that appears in a synthetic configuration
+  /// file, without reading the file itself.
+  /// @param [in] numCustomMappers Number of custom mappers the configuration file defines.
+  /// @param [in] numIterations Number of times to parse all of the element mapper strings.
+  static void BenchmarkParseElementMappers(unsigned int numCustomMappers, uint64_t numIterations)
+  {
+    const SBenchmarkConfigurationFile& configurationFile =
+        BenchmarkConfigurationFile(numCustomMappers);
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      for (const auto& elementMapperString : configurationFile.configuration.elementMapperStrings)
+        DoNotOptimize(MapperParser::ElementMapperFromString(elementMapperString));
+    }
+  }
+
+  /// Repeatedly reads a synthetic configuration file and then builds all of the custom mappers it
+  /// defines. Blueprints can only be built once, so the file must be read again before every
+  /// build, which means time per operation includes reading. Time spent building alone is
+  /// reported separately. Built mappers are destroyed after every iteration so that the next
+  /// one can build mappers with the same names.
+  /// @param [in] numCustomMappers Number of custom mappers the configuration file defines.
+  /// @param [in] numIterations Number of times to read the configuration file and build mappers.
+  static void BenchmarkBuildCustomMappers(unsigned int numCustomMappers, uint64_t numIterations)
+  {
+    const SBenchmarkConfigurationFile& configurationFile =
+        BenchmarkConfigurationFile(numCustomMappers);
+
+    LARGE_INTEGER performanceCounterFrequency;
+    QueryPerformanceFrequency(&performanceCounterFrequency);
+
+    int64_t buildTicks = 0;
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      MapperBuilder mapperBuilder;
+      ReadBenchmarkConfigurationFile(configurationFile, mapperBuilder);
+
+      LARGE_INTEGER buildBegin;
+      LARGE_INTEGER buildEnd;
+      QueryPerformanceCounter(&buildBegin);
+      DoNotOptimize(mapperBuilder.Build());
+      QueryPerformanceCounter(&buildEnd);
+      buildTicks += (buildEnd.QuadPart - buildBegin.QuadPart);
+
+      for (const auto& customMapperName : configurationFile.configuration.customMapperNames)
+        delete Mapper::GetByName(customMapperName);
+    }
+
+    ReportMetric(
+        L"Build time per iteration, excluding reading",
+        ((double)buildTicks * 1000000000.0) /
+            ((double)performanceCounterFrequency.QuadPart * (double)numIterations),
+        L"ns");
+  }
+
+  BENCHMARK_CASE(Startup_MapperBuilder_Build_0016CustomMappers)
+  {
+    BenchmarkBuildCustomMappers(16, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_MapperBuilder_Build_0128CustomMappers)
+  {
+    BenchmarkBuildCustomMappers(128, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_MapperBuilder_Build_0512CustomMappers)
+  {
+    BenchmarkBuildCustomMappers(512, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_MapperParser_ElementMapperFromString_0016CustomMappers)
+  {
+    BenchmarkParseElementMappers(16, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_MapperParser_ElementMapperFromString_0128CustomMappers)
+  {
+    BenchmarkParseElementMappers(128, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_MapperParser_ElementMapperFromString_0512CustomMappers)
+  {
+    BenchmarkParseElementMappers(512, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_XidiConfigReader_ReadConfigurationFile_0016CustomMappers)
+  {
+    BenchmarkReadConfigurationFile(16, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_XidiConfigReader_ReadConfigurationFile_0128CustomMappers)
+  {
+    BenchmarkReadConfigurationFile(128, numIterations);
+  }
+
+  BENCHMARK_CASE(Startup_XidiConfigReader_ReadConfigurationFile_0512CustomMappers)
+  {
+    BenchmarkReadConfigurationFile(512, numIterations);
+  }
+} // namespace XidiBenchmark
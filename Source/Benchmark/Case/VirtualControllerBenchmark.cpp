@@ -0,0 +1,98 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file VirtualControllerBenchmark.cpp
+ *   Benchmarks for delivering raw virtual controller state to virtual controllers.
+ **************************************************************************************************/
+
+#include "VirtualController.h"
+
+#include <array>
+#include <cstdint>
+
+#include "Benchmark.h"
+#include "BenchmarkPhysicalStates.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "MockPhysicalController.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi::Controller;
+  using ::XidiTest::MockPhysicalController;
+
+  /// Identifier of the physical controller used by all benchmark cases in this file.
+  static constexpr TControllerIdentifier kBenchmarkControllerIdentifier = 0;
+
+  /// Event buffer capacity to use for benchmark cases that enable event buffering.
+  static constexpr uint32_t kEventBufferCapacity = 1024;
+
+  /// Retrieves the mapper used by all benchmark cases in this file.
+  /// @return Read-only reference to the mapper.
+  static const Mapper& BenchmarkMapper(void)
+  {
+    return *Mapper::GetByName(L"StandardGamepad");
+  }
+
+  /// Produces the raw virtual states that benchmark cases in this file cycle through, by mapping
+  /// the benchmark physical states.
+  /// @return Raw virtual states.
+  static const std::array<SState, kNumBenchmarkPhysicalStates>& BenchmarkRawVirtualStates(void)
+  {
+    static const std::array<SState, kNumBenchmarkPhysicalStates> kRawVirtualStates = []()
+    {
+      const TBenchmarkPhysicalStates physicalStates = MakeBenchmarkPhysicalStates();
+      std::array<SState, kNumBenchmarkPhysicalStates> rawVirtualStates;
+
+      for (size_t i = 0; i < physicalStates.size(); ++i)
+        rawVirtualStates[i] = BenchmarkMapper().MapStatePhysicalToVirtual(
+            physicalStates[i], kBenchmarkControllerIdentifier);
+
+      return rawVirtualStates;
+    }();
+
+    return kRawVirtualStates;
+  }
+
+  // Refreshes the state of a virtual controller that has a deadzone and saturation configured but
+  // no event buffer.
+  BENCHMARK_CASE(VirtualController_RefreshState)
+  {
+    const auto& rawVirtualStates = BenchmarkRawVirtualStates();
+
+    MockPhysicalController physicalController(kBenchmarkControllerIdentifier, BenchmarkMapper());
+    VirtualController controller(kBenchmarkControllerIdentifier);
+    controller.SetAllAxisDeadzone(1000);
+    controller.SetAllAxisSaturation(9000);
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+      DoNotOptimize(controller.RefreshState(rawVirtualStates[i % rawVirtualStates.size()]));
+  }
+
+  // Refreshes the state of a virtual controller that has event buffering enabled, which means
+  // every state change is also turned into buffered events. Events are discarded whenever the
+  // buffer fills up so that it never overflows.
+  BENCHMARK_CASE(VirtualController_RefreshState_EventBuffer)
+  {
+    const auto& rawVirtualStates = BenchmarkRawVirtualStates();
+
+    MockPhysicalController physicalController(kBenchmarkControllerIdentifier, BenchmarkMapper());
+    VirtualController controller(kBenchmarkControllerIdentifier);
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      DoNotOptimize(controller.RefreshState(rawVirtualStates[i % rawVirtualStates.size()]));
+
+      if (controller.GetEventBufferCount() >= (kEventBufferCapacity / 2))
+      {
+        auto lock = controller.LockEventBuffer();
+        controller.PopEventBufferOldestEvents(controller.GetEventBufferCount());
+      }
+    }
+  }
+} // namespace XidiBenchmark
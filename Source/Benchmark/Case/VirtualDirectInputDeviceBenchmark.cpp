@@ -0,0 +1,142 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file VirtualDirectInputDeviceBenchmark.cpp
+ *   Benchmarks for retrieving buffered events through the DirectInput device interface.
+ **************************************************************************************************/
+
+#include "VirtualDirectInputDevice.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ApiDirectInput.h"
+#include "Benchmark.h"
+#include "BenchmarkPhysicalStates.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "MockPhysicalController.h"
+
+namespace XidiBenchmark
+{
+  using namespace ::Xidi;
+  using namespace ::Xidi::Controller;
+  using ::XidiTest::MockPhysicalController;
+
+  /// Identifier of the physical controller used by all benchmark cases in this file.
+  static constexpr TControllerIdentifier kBenchmarkControllerIdentifier = 0;
+
+  /// Event buffer size, in number of events, that the application requests.
+  static constexpr DWORD kBufferSize = 64;
+
+  /// Data packet structure that the application requests. Large enough to cover all of the
+  /// elements that the mapper used in this file presents, all of which are optional.
+  struct SBenchmarkDataPacket
+  {
+    TAxisValue axis[6];
+    EPovValue pov;
+    TButtonValue button[16];
+  };
+
+  static_assert(
+      0 == (sizeof(SBenchmarkDataPacket) % 4), "Data packet size must be divisible by 4.");
+
+  /// Repeatedly reports a state change to a virtual controller and then drains all resulting
+  /// buffered events through its DirectInput device interface, the way an application that uses
+  /// buffered input would.
+  /// @param [in] popEvents Whether the drain removes events from the buffer or only peeks at them.
+  /// @param [in] numIterations Number of state changes to report and drain.
+  static void BenchmarkGetDeviceData(bool popEvents, uint64_t numIterations)
+  {
+    static const TBenchmarkPhysicalStates kPhysicalStates = MakeBenchmarkPhysicalStates();
+
+    constexpr const GUID* kAxisGuids[_countof(SBenchmarkDataPacket::axis)] = {
+        &GUID_XAxis, &GUID_YAxis, &GUID_ZAxis, &GUID_RxAxis, &GUID_RyAxis, &GUID_RzAxis};
+
+    std::vector<DIOBJECTDATAFORMAT> objectFormatSpec;
+    for (int i = 0; i < _countof(SBenchmarkDataPacket::axis); ++i)
+      objectFormatSpec.push_back(
+          {.pguid = kAxisGuids[i],
+           .dwOfs = (DWORD)(offsetof(SBenchmarkDataPacket, axis) + (i * sizeof(TAxisValue))),
+           .dwType = (DIDFT_OPTIONAL | DIDFT_AXIS | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+    objectFormatSpec.push_back(
+        {.pguid = &GUID_POV,
+         .dwOfs = offsetof(SBenchmarkDataPacket, pov),
+         .dwType = (DIDFT_OPTIONAL | DIDFT_POV | DIDFT_ANYINSTANCE),
+         .dwFlags = 0});
+    for (int i = 0; i < _countof(SBenchmarkDataPacket::button); ++i)
+      objectFormatSpec.push_back(
+          {.pguid = &GUID_Button,
+           .dwOfs =
+               (DWORD)(offsetof(SBenchmarkDataPacket, button) + (i * sizeof(TButtonValue))),
+           .dwType = (DIDFT_OPTIONAL | DIDFT_BUTTON | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+
+    const DIDATAFORMAT formatSpec = {
+        .dwSize = sizeof(DIDATAFORMAT),
+        .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+        .dwFlags = DIDF_ABSAXIS,
+        .dwDataSize = sizeof(SBenchmarkDataPacket),
+        .dwNumObjs = (DWORD)objectFormatSpec.size(),
+        .rgodf = objectFormatSpec.data()};
+
+    constexpr DIPROPDWORD kBufferSizeProperty = {
+        .diph =
+            {.dwSize = sizeof(DIPROPDWORD),
+             .dwHeaderSize = sizeof(DIPROPHEADER),
+             .dwObj = 0,
+             .dwHow = DIPH_DEVICE},
+        .dwData = kBufferSize};
+
+    const Mapper& mapper = *Mapper::GetByName(L"StandardGamepad");
+    MockPhysicalController physicalController(kBenchmarkControllerIdentifier, mapper);
+
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(
+        std::make_unique<VirtualController>(kBenchmarkControllerIdentifier));
+    diController.SetDataFormat(&formatSpec);
+    diController.SetProperty(DIPROP_BUFFERSIZE, (LPCDIPROPHEADER)&kBufferSizeProperty);
+
+    std::array<DIDEVICEOBJECTDATA, kBufferSize> objectData;
+
+    for (uint64_t i = 0; i < numIterations; ++i)
+    {
+      diController.GetVirtualController().RefreshState(mapper.MapStatePhysicalToVirtual(
+          kPhysicalStates[i % kPhysicalStates.size()], kBenchmarkControllerIdentifier));
+
+      DWORD numObjectDataElements = (DWORD)objectData.size();
+      diController.GetDeviceData(
+          sizeof(DIDEVICEOBJECTDATA),
+          objectData.data(),
+          &numObjectDataElements,
+          ((true == popEvents) ? 0 : DIGDD_PEEK));
+      DoNotOptimize(objectData);
+
+      // Peeking leaves events in the buffer, so they are flushed separately to keep the buffer
+      // from overflowing.
+      if (false == popEvents)
+      {
+        numObjectDataElements = INFINITE;
+        diController.GetDeviceData(
+            sizeof(DIDEVICEOBJECTDATA), nullptr, &numObjectDataElements, 0);
+      }
+    }
+  }
+
+  BENCHMARK_CASE(VirtualDirectInputDevice_GetDeviceData_Peek)
+  {
+    BenchmarkGetDeviceData(false, numIterations);
+  }
+
+  BENCHMARK_CASE(VirtualDirectInputDevice_GetDeviceData_Pop)
+  {
+    BenchmarkGetDeviceData(true, numIterations);
+  }
+} // namespace XidiBenchmark
@@ -0,0 +1,330 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ConfigurationWatcher.cpp
+ *   Implementation of functionality for reapplying custom mappers when the configuration file is
+ *   modified while the application is running.
+ **************************************************************************************************/
+
+#include "ConfigurationWatcher.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ElementMapperCache.h"
+#include "Mapper.h"
+#include "MapperBuilder.h"
+#include "PhysicalController.h"
+#include "Strings.h"
+#include "WorkerThread.h"
+#include "XidiConfigReader.h"
+
+namespace Xidi
+{
+  namespace ConfigurationWatcher
+  {
+    /// Amount of time, in milliseconds, to wait after the configuration file is modified before
+    /// reading it. Editors commonly save a file using several separate write operations, and this
+    /// gives them a chance to finish so that the file is only read once.
+    static constexpr DWORD kModificationSettleTimeMilliseconds = 250;
+
+    /// Size, in bytes, of the buffer that receives directory change notifications.
+    static constexpr DWORD kNotificationBufferSize = 4096;
+
+    /// Determines if any of the directory change notifications in the specified buffer refer to
+    /// the specified file.
+    /// @param [in] notificationBuffer Buffer filled by a directory change notification request.
+    /// @param [in] fileName Name of the file of interest, without any directory component.
+    /// @return `true` if the file is mentioned, `false` otherwise.
+    static bool DoesNotificationMentionFile(
+        const void* notificationBuffer, std::wstring_view fileName)
+    {
+      const uint8_t* nextNotification = reinterpret_cast<const uint8_t*>(notificationBuffer);
+
+      while (true)
+      {
+        const FILE_NOTIFY_INFORMATION* const notification =
+            reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(nextNotification);
+
+        // File names in change notifications are not null-terminated, and Windows file names are
+        // not case-sensitive.
+        if (CSTR_EQUAL ==
+            CompareStringOrdinal(
+                notification->FileName,
+                (int)(notification->FileNameLength / sizeof(wchar_t)),
+                fileName.data(),
+                (int)fileName.length(),
+                TRUE))
+          return true;
+
+        if (0 == notification->NextEntryOffset) return false;
+
+        nextNotification += notification->NextEntryOffset;
+      }
+    }
+
+    /// Reads the configuration file again and rebuilds all of the custom mappers that are affected
+    /// by whatever changed since the last time it was read. A custom mapper is affected if its
+    /// section is new or changed, or if its template is itself affected. Rebuilt mappers replace
+    /// the old versions on all physical controllers that were using them. If the configuration
+    /// file contains any errors then nothing is changed.
+    /// @param [in,out] customMapperSectionHashes Hashes of the custom mapper sections as they were
+    /// the last time any changes were applied. Updated to reflect any changes applied.
+    static void ReapplyCustomMappers(
+        XidiConfigReader::TCustomMapperSectionHashes& customMapperSectionHashes)
+    {
+      Controller::MapperBuilder mapperBuilder;
+      XidiConfigReader::TCustomMapperSectionHashes updatedSectionHashes;
+
+      // Every custom mapper that was ever defined by the configuration file was defined with
+      // whatever name it has, so the new configuration file contents are allowed to replace it.
+      for (const auto& sectionHash : customMapperSectionHashes)
+        mapperBuilder.AllowReplacingMapper(sectionHash.first);
+
+      XidiConfigReader configReader;
+      configReader.SetMapperBuilder(&mapperBuilder);
+      configReader.SetCustomMapperSectionHashes(&updatedSectionHashes);
+
+      // Sections that did not change contain element mapper strings that are already cached, so
+      // only the strings that actually changed are parsed.
+      std::optional<Controller::ElementMapperCache> elementMapperCache;
+      const std::optional<uint64_t> maybeConfigurationFileHash =
+          Controller::ElementMapperCache::HashFileContents(Strings::GetConfigurationFilename());
+      if (true == maybeConfigurationFileHash.has_value())
+      {
+        elementMapperCache.emplace(
+            Strings::GetElementMapperCacheFilename(), maybeConfigurationFileHash.value());
+        configReader.SetElementMapperCache(&elementMapperCache.value());
+      }
+
+      configReader.ReadConfigurationFile();
+
+      if (true == configReader.HasErrorMessages())
+      {
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Error,
+            L"Errors were encountered while reading the modified configuration file.");
+        configReader.LogAllErrorMessages();
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Error,
+            L"None of the changes to the configuration file were applied. Fix the errors and save the configuration file again.");
+        return;
+      }
+
+      std::set<std::wstring_view> affectedMapperNames;
+      for (const auto& updatedSectionHash : updatedSectionHashes)
+      {
+        const auto previousSectionHash = customMapperSectionHashes.find(updatedSectionHash.first);
+        if ((customMapperSectionHashes.cend() == previousSectionHash) ||
+            (previousSectionHash->second != updatedSectionHash.second))
+          affectedMapperNames.insert(updatedSectionHash.first);
+      }
+
+      // Changes propagate along template dependencies, so keep scanning until no more custom
+      // mappers are found to depend on affected custom mappers.
+      bool affectedMapperNamesGrew = true;
+      while (true == affectedMapperNamesGrew)
+      {
+        affectedMapperNamesGrew = false;
+
+        for (const auto& updatedSectionHash : updatedSectionHashes)
+        {
+          if (true == affectedMapperNames.contains(updatedSectionHash.first)) continue;
+
+          const std::optional<std::wstring_view> maybeTemplateName =
+              mapperBuilder.GetBlueprintTemplate(updatedSectionHash.first);
+          if ((true == maybeTemplateName.has_value()) &&
+              (true == affectedMapperNames.contains(maybeTemplateName.value())))
+          {
+            affectedMapperNames.insert(updatedSectionHash.first);
+            affectedMapperNamesGrew = true;
+          }
+        }
+      }
+
+      // Unaffected custom mappers that were already built are left exactly as they are, and any
+      // blueprint that uses one of them as a template uses the existing mapper object. Unaffected
+      // custom mappers that were never built are kept as blueprints in case they are needed as
+      // templates.
+      for (const auto& updatedSectionHash : updatedSectionHashes)
+      {
+        if ((false == affectedMapperNames.contains(updatedSectionHash.first)) &&
+            (true == Controller::Mapper::IsMapperNameKnown(updatedSectionHash.first)))
+          mapperBuilder.RemoveBlueprint(updatedSectionHash.first);
+      }
+
+      if (true == affectedMapperNames.empty())
+      {
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Info,
+            L"No custom mappers were affected by the changes to the configuration file.");
+        return;
+      }
+
+      if (false == mapperBuilder.Build())
+      {
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Error,
+            L"Errors were encountered while rebuilding custom mappers affected by the changes to the configuration file. Some changes might not have been applied.");
+      }
+
+      if (true == elementMapperCache.has_value()) elementMapperCache->Save();
+
+      for (Controller::TControllerIdentifier controllerIdentifier = 0;
+           controllerIdentifier < Controller::GetPhysicalControllerCount();
+           ++controllerIdentifier)
+      {
+        const Controller::Mapper* const currentMapper =
+            Controller::GetControllerMapper(controllerIdentifier);
+        const std::wstring_view currentMapperName = currentMapper->GetName();
+        if (false == affectedMapperNames.contains(currentMapperName)) continue;
+
+        // If the replacement failed to build then the mapper registered under this name is still
+        // the one already in use.
+        const Controller::Mapper* const rebuiltMapper =
+            Controller::Mapper::GetByName(currentMapperName);
+        if ((nullptr == rebuiltMapper) || (currentMapper == rebuiltMapper)) continue;
+
+        Controller::SetControllerMapper(controllerIdentifier, rebuiltMapper);
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Applied rebuilt mapper %s to Xidi virtual controller %u.",
+            currentMapperName.data(),
+            (1 + (unsigned int)controllerIdentifier));
+      }
+
+      for (const auto& updatedSectionHash : updatedSectionHashes)
+        customMapperSectionHashes.insert_or_assign(
+            updatedSectionHash.first, updatedSectionHash.second);
+    }
+
+    /// Watches the directory that contains the configuration file for changes and reapplies custom
+    /// mappers whenever the configuration file itself is modified. Intended to be the entry point
+    /// of a background thread, and never returns unless an error prevents further watching.
+    /// @param [in] customMapperSectionHashes Hashes of the custom mapper sections that were
+    /// present when the configuration file was first read.
+    static void WatchConfigurationFile(
+        XidiConfigReader::TCustomMapperSectionHashes customMapperSectionHashes)
+    {
+      const std::wstring_view configurationFilename = Strings::GetConfigurationFilename();
+
+      const size_t fileNameStartPosition = configurationFilename.find_last_of(L'\\');
+      if (std::wstring_view::npos == fileNameStartPosition)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Unable to watch configuration file %s for changes because its directory could not be determined.",
+            configurationFilename.data());
+        return;
+      }
+
+      const std::wstring directoryName(configurationFilename.substr(0, fileNameStartPosition));
+      const std::wstring_view fileName = configurationFilename.substr(1 + fileNameStartPosition);
+
+      const HANDLE directoryHandle = CreateFile(
+          directoryName.c_str(),
+          FILE_LIST_DIRECTORY,
+          (FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE),
+          nullptr,
+          OPEN_EXISTING,
+          FILE_FLAG_BACKUP_SEMANTICS,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == directoryHandle)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Unable to watch configuration file %s for changes (last error = %u).",
+            configurationFilename.data(),
+            (unsigned int)GetLastError());
+        return;
+      }
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Watching configuration file %s for changes to custom mappers.",
+          configurationFilename.data());
+
+      std::optional<uint64_t> lastConfigurationFileHash =
+          Controller::ElementMapperCache::HashFileContents(configurationFilename);
+
+      // Change notifications are made up of structures that must be aligned on a DWORD boundary.
+      alignas(DWORD) uint8_t notificationBuffer[kNotificationBufferSize];
+
+      while (true)
+      {
+        DWORD numBytesReturned = 0;
+        if (0 ==
+            ReadDirectoryChangesW(
+                directoryHandle,
+                notificationBuffer,
+                sizeof(notificationBuffer),
+                FALSE,
+                (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE),
+                &numBytesReturned,
+                nullptr,
+                nullptr))
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Error,
+              L"Stopped watching configuration file %s for changes (last error = %u).",
+              configurationFilename.data(),
+              (unsigned int)GetLastError());
+          break;
+        }
+
+        // If no bytes are returned then there were too many changes to fit into the buffer, in
+        // which case the configuration file might have been one of them.
+        if ((0 != numBytesReturned) &&
+            (false == DoesNotificationMentionFile(notificationBuffer, fileName)))
+          continue;
+
+        Sleep(kModificationSettleTimeMilliseconds);
+
+        // Notifications are also generated when the configuration file is touched without its
+        // contents changing, and saving a file can involve it briefly not existing at all.
+        const std::optional<uint64_t> configurationFileHash =
+            Controller::ElementMapperCache::HashFileContents(configurationFilename);
+        if ((false == configurationFileHash.has_value()) ||
+            (lastConfigurationFileHash == configurationFileHash))
+          continue;
+
+        lastConfigurationFileHash = configurationFileHash;
+
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Info,
+            L"Configuration file was modified. Rebuilding affected custom mappers. Changes to any other settings require the application to be restarted.");
+        ReapplyCustomMappers(customMapperSectionHashes);
+      }
+
+      CloseHandle(directoryHandle);
+    }
+
+    void Start(XidiConfigReader::TCustomMapperSectionHashes&& customMapperSectionHashes)
+    {
+      static std::once_flag startFlag;
+      std::call_once(
+          startFlag,
+          [&customMapperSectionHashes]() -> void
+          {
+            WorkerThread::StartDetached(
+                L"Xidi Configuration Watcher",
+                WorkerThread::EPriority::Housekeeping,
+                WatchConfigurationFile,
+                std::move(customMapperSectionHashes));
+          });
+    }
+  } // namespace ConfigurationWatcher
+} // namespace Xidi
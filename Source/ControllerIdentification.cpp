@@ -12,9 +12,14 @@
 
 #include "ControllerIdentification.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 
 #include <Infra/Core/Configuration.h>
 #include <Infra/Core/Message.h>
@@ -27,6 +32,8 @@
 #include "ControllerTypes.h"
 #include "Globals.h"
 #include "Mapper.h"
+#include "PhysicalController.h"
+#include "Settings.h"
 #include "Strings.h"
 
 namespace Xidi
@@ -149,12 +156,7 @@ namespace Xidi
   /// @return `true` if the short name format should be used, `false` otherwise.
   static bool ShouldUseShortNameFormatForVirtualControllers(void)
   {
-    static const bool useShortVirtualControllerNames =
-        Globals::GetConfigurationData()
-            [Strings::kStrConfigurationSectionWorkarounds]
-            [Strings::kStrConfigurationSettingsWorkaroundsUseShortVirtualControllerNames]
-                .ValueOr(false);
-    return useShortVirtualControllerNames;
+    return Globals::GetSettings().workarounds.useShortVirtualControllerNames;
   }
 
   std::optional<bool> ApproximatelyEqualVendorAndProductId(
@@ -325,16 +327,16 @@ namespace Xidi
   {
     std::unique_ptr<typename DirectInputTypes<diVersion>::DeviceInstanceType> instanceInfo =
         std::make_unique<typename DirectInputTypes<diVersion>::DeviceInstanceType>();
-    uint32_t numControllersToEnumerate = Controller::kPhysicalControllerCount;
+    uint32_t numControllersToEnumerate = Controller::GetPhysicalControllerCount();
 
     const uint64_t activeVirtualControllerMask =
-        Globals::GetConfigurationData()
-            [Strings::kStrConfigurationSectionWorkarounds]
-            [Strings::kStrConfigurationSettingWorkaroundsActiveVirtualControllerMask]
-                .ValueOr(UINT64_MAX);
+        Globals::GetSettings().workarounds.activeVirtualControllerMask;
 
     for (uint32_t idx = 0; idx < numControllersToEnumerate; ++idx)
     {
+      if (false == Controller::IsPhysicalControllerEnabled((Controller::TControllerIdentifier)idx))
+        continue;
+
       if ((true == forceFeedbackRequired) && (false == DoesControllerSupportForceFeedback(idx)))
         continue;
 
@@ -418,10 +420,18 @@ namespace Xidi
         (unsigned int)hidCollectionNumber);
   }
 
-  template <EDirectInputVersion diVersion> void FillVirtualControllerInfo(
-      typename DirectInputTypes<diVersion>::DeviceInstanceType& instanceInfo,
-      Controller::TControllerIdentifier controllerId)
+  /// Builds a complete DirectInput device information structure, using the latest version of the
+  /// structure, for the virtual controller with the specified identifier.
+  /// @tparam diVersion DirectInput version enumerator.
+  /// @param [in] controllerId Identifier of the controller for which information is to be built.
+  /// @return Filled device information structure.
+  template <EDirectInputVersion diVersion> static
+      typename DirectInputTypes<diVersion>::DeviceInstanceType BuildVirtualControllerInfo(
+          Controller::TControllerIdentifier controllerId)
   {
+    typename DirectInputTypes<diVersion>::DeviceInstanceType instanceInfo = {
+        .dwSize = sizeof(instanceInfo)};
+
     instanceInfo.guidInstance = VirtualControllerGuid(controllerId);
     instanceInfo.guidProduct = VirtualControllerGuid(controllerId);
     instanceInfo.dwDevType = DirectInputTypes<diVersion>::XinputGamepadDeviceType();
@@ -430,21 +440,55 @@ namespace Xidi
     FillVirtualControllerName(
         instanceInfo.tszProductName, _countof(instanceInfo.tszProductName), controllerId);
 
+    if (true == DoesControllerSupportForceFeedback(controllerId))
+      instanceInfo.guidFFDriver = kVirtualControllerForceFeedbackDriverGuid;
+    else
+      instanceInfo.guidFFDriver = {};
+
+    const SHidUsageData virtualControllerHidData = HidUsageDataForVirtualController();
+    instanceInfo.wUsagePage = virtualControllerHidData.usagePage;
+    instanceInfo.wUsage = virtualControllerHidData.usage;
+
+    return instanceInfo;
+  }
+
+  template <EDirectInputVersion diVersion> void FillVirtualControllerInfo(
+      typename DirectInputTypes<diVersion>::DeviceInstanceType& instanceInfo,
+      Controller::TControllerIdentifier controllerId)
+  {
+    using TDeviceInstance = typename DirectInputTypes<diVersion>::DeviceInstanceType;
+
+    // Everything in the device information structure is determined by the controller identifier
+    // and by configuration that does not change once loaded, so the structures are built once,
+    // including their product and instance name strings, and afterwards just copied.
+    static TDeviceInstance virtualControllerInfo[Controller::kMaxPhysicalControllerCount];
+    static std::once_flag virtualControllerInfoFlag;
+
+    std::call_once(
+        virtualControllerInfoFlag,
+        []() -> void
+        {
+          for (Controller::TControllerIdentifier i = 0; i < _countof(virtualControllerInfo); ++i)
+            virtualControllerInfo[i] = BuildVirtualControllerInfo<diVersion>(i);
+        });
+
+    TDeviceInstance uncachedInstanceInfo;
+    const TDeviceInstance* builtInstanceInfo = &uncachedInstanceInfo;
+    if (controllerId < _countof(virtualControllerInfo))
+      builtInstanceInfo = &virtualControllerInfo[controllerId];
+    else
+      uncachedInstanceInfo = BuildVirtualControllerInfo<diVersion>(controllerId);
+
     // DirectInput versions 5 and higher include extra members in this structure, and this is
-    // indicated on input using the size member of the structure.
-    if (instanceInfo.dwSize >
-        offsetof(typename DirectInputTypes<diVersion>::DeviceInstanceType, tszProductName) +
-            sizeof(DirectInputTypes<diVersion>::DeviceInstanceType::tszProductName))
-    {
-      if (true == DoesControllerSupportForceFeedback(controllerId))
-        instanceInfo.guidFFDriver = kVirtualControllerForceFeedbackDriverGuid;
-      else
-        instanceInfo.guidFFDriver = {};
-
-      const SHidUsageData virtualControllerHidData = HidUsageDataForVirtualController();
-      instanceInfo.wUsagePage = virtualControllerHidData.usagePage;
-      instanceInfo.wUsage = virtualControllerHidData.usage;
-    }
+    // indicated on input using the size member of the structure. Whichever version it is, the size
+    // member itself is left unchanged and everything after it is copied.
+    constexpr size_t kCopyOffset = offsetof(TDeviceInstance, guidInstance);
+    const size_t copyEnd = std::min((size_t)instanceInfo.dwSize, sizeof(TDeviceInstance));
+    if (copyEnd > kCopyOffset)
+      std::memcpy(
+          reinterpret_cast<uint8_t*>(&instanceInfo) + kCopyOffset,
+          reinterpret_cast<const uint8_t*>(builtInstanceInfo) + kCopyOffset,
+          copyEnd - kCopyOffset);
   }
 
   template void FillVirtualControllerInfo<EDirectInputVersion::k8A>(
@@ -459,33 +503,39 @@ namespace Xidi
   template <> int FillVirtualControllerName<LPSTR>(
       LPSTR buf, size_t bufcount, Controller::TControllerIdentifier controllerIndex)
   {
-    Infra::TemporaryBuffer<CHAR> xidiControllerNameFormatString;
-    LoadStringA(
-        Infra::ProcessInfo::GetThisModuleInstanceHandle(),
-        (ShouldUseShortNameFormatForVirtualControllers()
-             ? IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_SHORT_NAME_FORMAT
-             : IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_NAME_FORMAT),
-        xidiControllerNameFormatString.Data(),
-        xidiControllerNameFormatString.Capacity());
-
-    return sprintf_s(
-        buf, bufcount, (LPCSTR)xidiControllerNameFormatString.Data(), (controllerIndex + 1));
+    static const std::string xidiControllerNameFormatString = []() -> std::string
+    {
+      Infra::TemporaryBuffer<CHAR> loadedFormatString;
+      LoadStringA(
+          Infra::ProcessInfo::GetThisModuleInstanceHandle(),
+          (ShouldUseShortNameFormatForVirtualControllers()
+               ? IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_SHORT_NAME_FORMAT
+               : IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_NAME_FORMAT),
+          loadedFormatString.Data(),
+          loadedFormatString.Capacity());
+      return loadedFormatString.Data();
+    }();
+
+    return sprintf_s(buf, bufcount, xidiControllerNameFormatString.c_str(), (controllerIndex + 1));
   }
 
   template <> int FillVirtualControllerName<LPWSTR>(
       LPWSTR buf, size_t bufcount, Controller::TControllerIdentifier controllerIndex)
   {
-    Infra::TemporaryBuffer<WCHAR> xidiControllerNameFormatString;
-    LoadStringW(
-        Infra::ProcessInfo::GetThisModuleInstanceHandle(),
-        (ShouldUseShortNameFormatForVirtualControllers()
-             ? IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_SHORT_NAME_FORMAT
-             : IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_NAME_FORMAT),
-        xidiControllerNameFormatString.Data(),
-        xidiControllerNameFormatString.Capacity());
-
-    return swprintf_s(
-        buf, bufcount, (LPCWSTR)xidiControllerNameFormatString.Data(), (controllerIndex + 1));
+    static const std::wstring xidiControllerNameFormatString = []() -> std::wstring
+    {
+      Infra::TemporaryBuffer<WCHAR> loadedFormatString;
+      LoadStringW(
+          Infra::ProcessInfo::GetThisModuleInstanceHandle(),
+          (ShouldUseShortNameFormatForVirtualControllers()
+               ? IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_SHORT_NAME_FORMAT
+               : IDS_XIDI_CONTROLLERIDENTIFICATION_CONTROLLER_NAME_FORMAT),
+          loadedFormatString.Data(),
+          loadedFormatString.Capacity());
+      return loadedFormatString.Data();
+    }();
+
+    return swprintf_s(buf, bufcount, xidiControllerNameFormatString.c_str(), (controllerIndex + 1));
   }
 
   template <typename StringType> int FillVirtualControllerPath(
@@ -531,7 +581,7 @@ namespace Xidi
     Controller::TControllerIdentifier xindex =
         ExtractVirtualControllerInstanceFromGuid(instanceGUID);
 
-    if (xindex < Controller::kPhysicalControllerCount)
+    if (xindex < Controller::GetPhysicalControllerCount())
     {
       GUID realXInputGUID = VirtualControllerGuid(xindex);
       if (realXInputGUID == instanceGUID) return (Controller::TControllerIdentifier)xindex;
@@ -12,7 +12,14 @@
 
 #include "ControllerMath.h"
 
+#include <intrin.h>
+#include <smmintrin.h>
+
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 
 #include "ControllerTypes.h"
 
@@ -22,6 +29,190 @@ namespace Xidi
   {
     namespace Math
     {
+      /// Lowest axis value that is distinguishable by the axis transformation. All lower values
+      /// produce the same result.
+      static constexpr int32_t kAxisTransformValueMin = (int32_t)kAnalogValueMin - 1;
+
+      /// Highest axis value that is distinguishable by the axis transformation. All higher values
+      /// produce the same result.
+      static constexpr int32_t kAxisTransformValueMax = (int32_t)kAnalogValueMax + 1;
+
+      /// Number of fractional bits in the fixed-point positions used to index into circle-to-square
+      /// correction lookup tables. Positions range from 0 to 1 and the integer part of the scaled
+      /// position identifies the segment.
+      static constexpr unsigned int kCircleToSquarePositionFractionBits = 20;
+
+      /// Number of fractional bits in a fixed-point position that are used to interpolate within a
+      /// single segment of a circle-to-square correction lookup table.
+      static constexpr unsigned int kCircleToSquareSegmentFractionBits =
+          kCircleToSquarePositionFractionBits - 10;
+
+      static_assert(
+          (1u << (kCircleToSquarePositionFractionBits - kCircleToSquareSegmentFractionBits)) ==
+              kCircleToSquareTableSegmentCount,
+          "Circle-to-square lookup table position bits do not match the number of segments.");
+
+      /// Lowest unweighted multiplier represented in the circle-to-square correction lookup table
+      /// for coordinates outside of a circular range of motion.
+      static constexpr double kCircleToSquareUnweightedMultiplierMin = 0.5;
+
+      /// Square of the radius of a circular range of motion, beyond which coordinates are treated
+      /// as being outside of it.
+      static constexpr int64_t kCircleToSquareRadiusSquaredMax =
+          (int64_t)kAnalogValueMax * (int64_t)kAnalogValueMax;
+
+      /// Looks up a fixed-point multiplier in a circle-to-square correction lookup table, linearly
+      /// interpolating between the two entries that bound the specified position.
+      /// @param [in] table Lookup table to use.
+      /// @param [in] position Fixed-point position from 0 to 1 with
+      /// #kCircleToSquarePositionFractionBits fractional bits.
+      /// @return Fixed-point multiplier at the specified position.
+      static inline int64_t InterpolateCircleToSquareMultiplier(
+          const std::array<uint32_t, kCircleToSquareTableSegmentCount + 1>& table, int64_t position)
+      {
+        constexpr int64_t kSegmentFractionMask =
+            ((int64_t)1 << kCircleToSquareSegmentFractionBits) - 1;
+
+        position = std::clamp(
+            position, (int64_t)0, (int64_t)1 << kCircleToSquarePositionFractionBits);
+
+        const size_t segment = (size_t)(position >> kCircleToSquareSegmentFractionBits);
+        if (segment >= kCircleToSquareTableSegmentCount) return (int64_t)table.back();
+
+        const int64_t segmentStart = (int64_t)table[segment];
+        const int64_t segmentEnd = (int64_t)table[segment + 1];
+        return segmentStart +
+            (((segmentEnd - segmentStart) * (position & kSegmentFractionMask)) >>
+             kCircleToSquareSegmentFractionBits);
+      }
+
+      /// Applies a fixed-point multiplier to a single analog stick coordinate, truncating towards
+      /// zero the same way as converting a floating-point product to an integer would.
+      /// @param [in] coordinate Coordinate to which the multiplier should be applied.
+      /// @param [in] multiplier Fixed-point multiplier with
+      /// #kCircleToSquareMultiplierFractionBits fractional bits.
+      /// @return Coordinate after the multiplier is applied.
+      static inline int16_t ApplyCircleToSquareMultiplier(int16_t coordinate, int64_t multiplier)
+      {
+        constexpr int64_t kMultiplierOne = (int64_t)1 << kCircleToSquareMultiplierFractionBits;
+
+        const int64_t product = ((int64_t)coordinate * multiplier) / kMultiplierOne;
+        return (int16_t)std::clamp(
+            product,
+            (int64_t)std::numeric_limits<int16_t>::min(),
+            (int64_t)std::numeric_limits<int16_t>::max());
+      }
+
+      /// Determines if the processor supports SSE4.1 vector instructions.
+      /// @return `true` if so, `false` otherwise.
+      static bool IsSse41Supported(void)
+      {
+        static const bool kIsSse41Supported = []() -> bool
+        {
+          int cpuInfo[4] = {};
+          __cpuid(cpuInfo, 0);
+          if (cpuInfo[0] < 1) return false;
+
+          // SSE4.1 support is indicated by bit 19 of ECX.
+          __cpuid(cpuInfo, 1);
+          return (0 != (cpuInfo[2] & (1 << 19)));
+        }();
+
+        return kIsSse41Supported;
+      }
+
+      /// Scales a distance past a deadzone cutoff into the reportable range using a fixed-point
+      /// range scale factor. Only the low 32 bits of the result are produced, which is sufficient
+      /// because the scaled distance is always added to or subtracted from a range neutral value to
+      /// obtain a result that is itself within range.
+      /// @param [in] distance Distance past the deadzone cutoff, which is always less than 2^16.
+      /// @param [in] rangeScaleLow Low half of the range scale factor.
+      /// @param [in] rangeScaleHigh High half of the range scale factor.
+      /// @return Low 32 bits of the scaled distance.
+      static inline uint32_t ScaleAxisDistance(
+          uint32_t distance, uint32_t rangeScaleLow, uint32_t rangeScaleHigh)
+      {
+        const uint32_t scaledLow =
+            (uint32_t)(((uint64_t)distance * (uint64_t)rangeScaleLow) >>
+                       kAxisTransformScaleFactorFractionBits);
+        const uint32_t scaledHigh = (distance * rangeScaleHigh)
+            << (32 - kAxisTransformScaleFactorFractionBits);
+
+        return scaledLow + scaledHigh;
+      }
+
+      /// Transforms four consecutive lanes of virtual controller axis values using SSE4.1 vector
+      /// instructions. Identical lane by lane to #TransformAxisValue.
+      /// @param [in,out] axisValues Aligned location of the four axis values to transform in place.
+      /// @param [in] parameters Axis transformation parameters.
+      /// @param [in] firstLane Index of the first of the four lanes, which must be a multiple of 4.
+      static inline void TransformAxisValuesSse41(
+          int32_t* axisValues, const SAxisTransformParameters& parameters, unsigned int firstLane)
+      {
+        const __m128i rawValue = _mm_load_si128((const __m128i*)axisValues);
+        const __m128i value = _mm_max_epi32(
+            _mm_set1_epi32(kAxisTransformValueMin),
+            _mm_min_epi32(rawValue, _mm_set1_epi32(kAxisTransformValueMax)));
+
+        const __m128i transformMask =
+            _mm_load_si128((const __m128i*)&parameters.transformMask[firstLane]);
+        const __m128i isPositive = _mm_cmpgt_epi32(value, _mm_set1_epi32(kAnalogValueNeutral));
+
+        const __m128i distance = _mm_blendv_epi8(
+            _mm_sub_epi32(
+                _mm_load_si128((const __m128i*)&parameters.deadzoneCutoffNegative[firstLane]),
+                value),
+            _mm_sub_epi32(
+                value,
+                _mm_load_si128((const __m128i*)&parameters.deadzoneCutoffPositive[firstLane])),
+            isPositive);
+        const __m128i saturationDistance = _mm_blendv_epi8(
+            _mm_load_si128((const __m128i*)&parameters.saturationDistanceNegative[firstLane]),
+            _mm_load_si128((const __m128i*)&parameters.saturationDistancePositive[firstLane]),
+            isPositive);
+        const __m128i rangeScaleLow = _mm_blendv_epi8(
+            _mm_load_si128((const __m128i*)&parameters.rangeScaleLowNegative[firstLane]),
+            _mm_load_si128((const __m128i*)&parameters.rangeScaleLowPositive[firstLane]),
+            isPositive);
+        const __m128i rangeScaleHigh = _mm_blendv_epi8(
+            _mm_load_si128((const __m128i*)&parameters.rangeScaleHighNegative[firstLane]),
+            _mm_load_si128((const __m128i*)&parameters.rangeScaleHighPositive[firstLane]),
+            isPositive);
+
+        const __m128i isInDeadzone = _mm_cmpgt_epi32(_mm_set1_epi32(1), distance);
+        const __m128i isSaturated = _mm_xor_si128(
+            _mm_cmpgt_epi32(saturationDistance, distance), _mm_set1_epi32(-1));
+
+        // Unsigned 32-bit by 32-bit multiplication producing 64-bit results only operates on even
+        // lanes, so odd lanes are shifted into position, multiplied separately, and recombined.
+        const __m128i scaledLowEven = _mm_srli_epi64(
+            _mm_mul_epu32(distance, rangeScaleLow), kAxisTransformScaleFactorFractionBits);
+        const __m128i scaledLowOdd = _mm_slli_epi64(
+            _mm_srli_epi64(
+                _mm_mul_epu32(_mm_srli_epi64(distance, 32), _mm_srli_epi64(rangeScaleLow, 32)),
+                kAxisTransformScaleFactorFractionBits),
+            32);
+        const __m128i scaledLow = _mm_blend_epi16(scaledLowEven, scaledLowOdd, 0b11001100);
+        const __m128i scaledHigh = _mm_slli_epi32(
+            _mm_mullo_epi32(distance, rangeScaleHigh), 32 - kAxisTransformScaleFactorFractionBits);
+        const __m128i scaled = _mm_add_epi32(scaledLow, scaledHigh);
+
+        const __m128i rangeNeutral =
+            _mm_load_si128((const __m128i*)&parameters.rangeNeutral[firstLane]);
+        const __m128i rangeExtreme = _mm_blendv_epi8(
+            _mm_load_si128((const __m128i*)&parameters.rangeMin[firstLane]),
+            _mm_load_si128((const __m128i*)&parameters.rangeMax[firstLane]),
+            isPositive);
+
+        __m128i result = _mm_blendv_epi8(
+            _mm_sub_epi32(rangeNeutral, scaled), _mm_add_epi32(rangeNeutral, scaled), isPositive);
+        result = _mm_blendv_epi8(result, rangeExtreme, isSaturated);
+        result = _mm_blendv_epi8(result, rangeNeutral, isInDeadzone);
+        result = _mm_blendv_epi8(rawValue, result, transformMask);
+
+        _mm_store_si128((__m128i*)axisValues, result);
+      }
+
       int16_t ApplyRawAnalogTransform(
           int16_t analogValue, unsigned int deadzonePercent, unsigned int saturationPercent)
       {
@@ -46,6 +237,25 @@ namespace Xidi
         return kAnalogValueNeutral + (int16_t)(transformedAnalogBase * transformationScaleFactor);
       }
 
+      int16_t ApplyRawAnalogTransform(
+          int16_t analogValue, const SRawAnalogTransformParameters& parameters)
+      {
+        if (false == parameters.isEnabled) return analogValue;
+
+        const int32_t absoluteAnalogValue = std::abs((int32_t)analogValue);
+        if (absoluteAnalogValue <= parameters.deadzoneCutoff) return kAnalogValueNeutral;
+        if (absoluteAnalogValue >= parameters.saturationCutoff)
+          return ((analogValue >= 0) ? kAnalogValueMax : kAnalogValueMin);
+
+        const int32_t transformedAnalogBase =
+            ((analogValue >= 0) ? ((int32_t)analogValue - parameters.deadzoneCutoff)
+                                : ((int32_t)analogValue + parameters.deadzoneCutoff));
+
+        return (int16_t)(kAnalogValueNeutral +
+                         ((transformedAnalogBase * (kAnalogValueMax - kAnalogValueNeutral)) /
+                          (parameters.saturationCutoff - parameters.deadzoneCutoff)));
+      }
+
       uint8_t ApplyRawTriggerTransform(
           uint8_t triggerValue, unsigned int deadzonePercent, unsigned int saturationPercent)
       {
@@ -70,6 +280,111 @@ namespace Xidi
         return kTriggerValueMin + (uint8_t)(transformedTriggerBase * transformationScaleFactor);
       }
 
+      SCircleToSquareTable MakeCircleToSquareTable(double amountFraction)
+      {
+        SCircleToSquareTable table = {.isEnabled = (0.0 != amountFraction)};
+        if (false == table.isEnabled) return table;
+
+        constexpr double kMultiplierScale =
+            (double)((int64_t)1 << kCircleToSquareMultiplierFractionBits);
+
+        for (unsigned int i = 0; i <= kCircleToSquareTableSegmentCount; ++i)
+        {
+          const double position = (double)i / (double)kCircleToSquareTableSegmentCount;
+
+          // Within a circular range of motion the unweighted multiplier is the ratio of the radius
+          // to the larger absolute coordinate, which depends only on the ratio of the two
+          // coordinates.
+          const double multiplierWithinCircle = std::sqrt(1.0 + (position * position));
+          const double multiplierOutsideCircle = kCircleToSquareUnweightedMultiplierMin + position;
+
+          table.multiplierByRatio[i] =
+              (uint32_t)(std::pow(multiplierWithinCircle, amountFraction) * kMultiplierScale);
+          table.multiplierByUnweightedMultiplier[i] =
+              (uint32_t)(std::pow(multiplierOutsideCircle, amountFraction) * kMultiplierScale);
+        }
+
+        return table;
+      }
+
+      SRawTriggerTransformTable MakeRawTriggerTransformTable(
+          unsigned int deadzonePercent, unsigned int saturationPercent)
+      {
+        SRawTriggerTransformTable table = {};
+
+        for (unsigned int i = 0; i < table.transformedValue.size(); ++i)
+          table.transformedValue[i] = ApplyRawTriggerTransform(
+              (uint8_t)(kTriggerValueMin + i), deadzonePercent, saturationPercent);
+
+        return table;
+      }
+
+      int32_t TransformAxisValue(
+          int32_t axisValue, const SAxisTransformParameters& parameters, EAxis axis)
+      {
+        const unsigned int lane = static_cast<unsigned int>(axis);
+        if (0 == parameters.transformMask[lane]) return axisValue;
+
+        // Deadzone and saturation cutoffs are all within the analog range, so every raw value
+        // beyond it is treated the same as a value just one past its end. Clamping keeps all of the
+        // intermediate distances small without changing the result.
+        const int32_t value = std::clamp(axisValue, kAxisTransformValueMin, kAxisTransformValueMax);
+
+        if (value > kAnalogValueNeutral)
+        {
+          const int32_t distance = value - parameters.deadzoneCutoffPositive[lane];
+
+          if (distance <= 0)
+            return parameters.rangeNeutral[lane];
+          else if (distance >= parameters.saturationDistancePositive[lane])
+            return parameters.rangeMax[lane];
+          else
+            return (int32_t)(
+                (uint32_t)parameters.rangeNeutral[lane] +
+                ScaleAxisDistance(
+                    (uint32_t)distance,
+                    parameters.rangeScaleLowPositive[lane],
+                    parameters.rangeScaleHighPositive[lane]));
+        }
+        else
+        {
+          const int32_t distance = parameters.deadzoneCutoffNegative[lane] - value;
+
+          if (distance <= 0)
+            return parameters.rangeNeutral[lane];
+          else if (distance >= parameters.saturationDistanceNegative[lane])
+            return parameters.rangeMin[lane];
+          else
+            return (int32_t)(
+                (uint32_t)parameters.rangeNeutral[lane] -
+                ScaleAxisDistance(
+                    (uint32_t)distance,
+                    parameters.rangeScaleLowNegative[lane],
+                    parameters.rangeScaleHighNegative[lane]));
+        }
+      }
+
+      void TransformAxisValues(
+          std::array<int32_t, static_cast<int>(EAxis::Count)>& axisValues,
+          const SAxisTransformParameters& parameters)
+      {
+        if (true == IsSse41Supported())
+        {
+          alignas(16) std::array<int32_t, kAxisTransformLaneCount> lanes = {};
+          std::copy(axisValues.cbegin(), axisValues.cend(), lanes.begin());
+
+          for (unsigned int firstLane = 0; firstLane < kAxisTransformLaneCount; firstLane += 4)
+            TransformAxisValuesSse41(&lanes[firstLane], parameters, firstLane);
+
+          std::copy(lanes.cbegin(), lanes.cbegin() + axisValues.size(), axisValues.begin());
+        }
+        else
+        {
+          for (unsigned int i = 0; i < axisValues.size(); ++i)
+            axisValues[i] = TransformAxisValue(axisValues[i], parameters, static_cast<EAxis>(i));
+        }
+      }
+
       SAnalogStickCoordinates TransformCoordinatesCircleToSquare(
           SAnalogStickCoordinates circleCoords, double amountFraction)
       {
@@ -89,6 +404,46 @@ namespace Xidi
             .y = static_cast<int16_t>(y * weightedMultiplier),
         };
       }
+
+      SAnalogStickCoordinates TransformCoordinatesCircleToSquare(
+          SAnalogStickCoordinates circleCoords, const SCircleToSquareTable& table)
+      {
+        if (false == table.isEnabled) return circleCoords;
+
+        const int64_t absoluteX = std::abs((int64_t)circleCoords.x);
+        const int64_t absoluteY = std::abs((int64_t)circleCoords.y);
+        const int64_t largerCoordinate = std::max(absoluteX, absoluteY);
+        const int64_t smallerCoordinate = std::min(absoluteX, absoluteY);
+        if (0 == largerCoordinate) return circleCoords;
+
+        int64_t multiplier = 0;
+
+        if (((absoluteX * absoluteX) + (absoluteY * absoluteY)) <= kCircleToSquareRadiusSquaredMax)
+        {
+          multiplier = InterpolateCircleToSquareMultiplier(
+              table.multiplierByRatio,
+              (smallerCoordinate << kCircleToSquarePositionFractionBits) / largerCoordinate);
+        }
+        else
+        {
+          // Outside of a circular range of motion the radius is limited to the edge of the range,
+          // so the unweighted multiplier brings the larger coordinate exactly to that edge.
+          constexpr int64_t kUnweightedMultiplierMin =
+              (int64_t)(kCircleToSquareUnweightedMultiplierMin *
+                        (double)((int64_t)1 << kCircleToSquarePositionFractionBits));
+
+          const int64_t unweightedMultiplier =
+              ((int64_t)kAnalogValueMax << kCircleToSquarePositionFractionBits) / largerCoordinate;
+          multiplier = InterpolateCircleToSquareMultiplier(
+              table.multiplierByUnweightedMultiplier,
+              unweightedMultiplier - kUnweightedMultiplierMin);
+        }
+
+        return SAnalogStickCoordinates{
+            .x = ApplyCircleToSquareMultiplier(circleCoords.x, multiplier),
+            .y = ApplyCircleToSquareMultiplier(circleCoords.y, multiplier),
+        };
+      }
     } // namespace Math
   }   // namespace Controller
 } // namespace Xidi
@@ -12,14 +12,21 @@
 
 #include "DataFormat.h"
 
-#include <map>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <Infra/Core/Message.h>
 
+#include "AsyncLog.h"
 #include "ApiBitSet.h"
 #include "ApiDirectInput.h"
 #include "ControllerTypes.h"
@@ -283,7 +290,7 @@ namespace Xidi
   {
     constexpr Infra::Message::ESeverity kDumpSeverity = Infra::Message::ESeverity::Debug;
 
-    if (Infra::Message::WillOutputMessageOfSeverity(kDumpSeverity))
+    if (AsyncLog::WillOutputMessageOfSeverity(kDumpSeverity))
     {
       Infra::Message::Output(kDumpSeverity, L"Begin dump of data format specification.");
 
@@ -405,6 +412,215 @@ namespace Xidi
     return std::nullopt;
   }
 
+  /// Converts the states of eight consecutive buttons into eight consecutive DirectInput button
+  /// values, packed such that they can be written to an application data packet using a single
+  /// store.
+  /// @param [in] buttonBits Button states, one bit per button, with the first button in the
+  /// least-significant position.
+  /// @return Corresponding DirectInput button values, with the first button in the
+  /// least-significant byte.
+  static inline uint64_t DirectInputButtonValuesFromBits(uint8_t buttonBits)
+  {
+    static_assert(
+        0 == DataFormat::kButtonValueNotPressed,
+        "Packed button value conversion requires unpressed buttons to be represented by 0.");
+
+    // Multiplying by this constant places copies of the low seven bits such that bit n ends up as
+    // the least-significant bit of byte n. The most-significant bit is moved separately because its
+    // copy would otherwise collide with the copy of bit 0 that belongs to the next byte.
+    static constexpr uint64_t kSpreadMultiplier = 0x0002040810204081ull;
+    static constexpr uint64_t kLowBitOfEachByte = 0x0101010101010101ull;
+
+    const uint64_t lowBits =
+        (((uint64_t)(buttonBits & 0x7f) * kSpreadMultiplier) & kLowBitOfEachByte);
+    const uint64_t highBit = ((uint64_t)(buttonBits >> 7) << 56);
+
+    return ((lowBits | highBit) * DataFormat::kButtonValuePressed);
+  }
+
+  /// Writes the states of a run of consecutive buttons to consecutive locations within an
+  /// application data packet. Most of the run is written eight buttons at a time.
+  /// @param [out] destination Location within the application data packet of the first button.
+  /// @param [in] buttonBits Button states, one bit per button, with the first button in the run in
+  /// the least-significant position.
+  /// @param [in] buttonCount Number of buttons in the run.
+  static inline void WriteButtonRun(
+      uint8_t* destination, uint64_t buttonBits, unsigned int buttonCount)
+  {
+    for (; buttonCount >= 8; buttonCount -= 8)
+    {
+      const uint64_t buttonValues = DirectInputButtonValuesFromBits((uint8_t)buttonBits);
+      std::memcpy(destination, &buttonValues, sizeof(buttonValues));
+
+      destination += 8;
+      buttonBits >>= 8;
+    }
+
+    for (; buttonCount > 0; --buttonCount)
+    {
+      *destination = DataFormat::DirectInputButtonValue(0 != (buttonBits & 1));
+
+      destination += 1;
+      buttonBits >>= 1;
+    }
+  }
+
+  void DataFormat::CompilePacketWriter(void)
+  {
+    packetTemplate.assign(dataFormatSpec.packetSizeBytes, 0);
+    for (auto povOffsetUnused : dataFormatSpec.povOffsetsUnused)
+    {
+      EPovValue* const valueLocation = (EPovValue*)(&packetTemplate[povOffsetUnused]);
+      *valueLocation = EPovValue::Center;
+    }
+
+    packetWriteOperations.clear();
+
+    // Axis values
+    for (int i = 0; i < _countof(dataFormatSpec.axisOffset); ++i)
+    {
+      if (kInvalidOffsetValue == dataFormatSpec.axisOffset[i]) continue;
+
+      packetWriteOperations.push_back(
+          {.kind = EPacketWriteOperationKind::Axis,
+           .source = (uint8_t)i,
+           .count = 1,
+           .offset = dataFormatSpec.axisOffset[i],
+           .elements = Controller::ElementMaskForElement(
+               {.type = Controller::EElementType::Axis, .axis = (Controller::EAxis)i})});
+    }
+
+    // Button values
+    // Applications commonly place buttons one after the other in the same order as the virtual
+    // controller, as is the case with the `c_dfDIJoystick` and `c_dfDIJoystick2` formats, so such
+    // buttons are combined into runs that can be written several at a time.
+    for (int i = 0; i < _countof(dataFormatSpec.buttonOffset); ++i)
+    {
+      if (kInvalidOffsetValue == dataFormatSpec.buttonOffset[i]) continue;
+
+      if (false == packetWriteOperations.empty())
+      {
+        SPacketWriteOperation& lastOperation = packetWriteOperations.back();
+        if ((EPacketWriteOperationKind::ButtonRun == lastOperation.kind) &&
+            (i == (lastOperation.source + lastOperation.count)) &&
+            (dataFormatSpec.buttonOffset[i] == (lastOperation.offset + lastOperation.count)))
+        {
+          lastOperation.count += 1;
+          lastOperation.elements |= Controller::ElementMaskForElement(
+              {.type = Controller::EElementType::Button, .button = (Controller::EButton)i});
+          continue;
+        }
+      }
+
+      packetWriteOperations.push_back(
+          {.kind = EPacketWriteOperationKind::ButtonRun,
+           .source = (uint8_t)i,
+           .count = 1,
+           .offset = dataFormatSpec.buttonOffset[i],
+           .elements = Controller::ElementMaskForElement(
+               {.type = Controller::EElementType::Button, .button = (Controller::EButton)i})});
+    }
+
+    // POV value
+    if (kInvalidOffsetValue != dataFormatSpec.povOffset)
+    {
+      packetWriteOperations.push_back(
+          {.kind = EPacketWriteOperationKind::Pov,
+           .source = 0,
+           .count = 1,
+           .offset = dataFormatSpec.povOffset,
+           .elements =
+               Controller::ElementMaskForElement({.type = Controller::EElementType::Pov})});
+    }
+
+    packetWriteOperations.shrink_to_fit();
+
+    presentElements = 0;
+    for (const auto& packetWriteOperation : packetWriteOperations)
+      presentElements |= packetWriteOperation.elements;
+
+    standardFormat = IdentifyStandardFormat();
+    if (EStandardFormat::None != standardFormat)
+    {
+      for (int i = 0; i < _countof(dataFormatSpec.axisOffset); ++i)
+        standardFormatAxisMask[i] =
+            ((kInvalidOffsetValue != dataFormatSpec.axisOffset[i]) ? -1 : 0);
+
+      standardFormatButtonMask = 0;
+      for (int i = 0; i < _countof(dataFormatSpec.buttonOffset); ++i)
+      {
+        if (kInvalidOffsetValue != dataFormatSpec.buttonOffset[i])
+          standardFormatButtonMask |= ((Controller::SButtonSet::TWord)1 << i);
+      }
+
+      standardFormatHasPov = (kInvalidOffsetValue != dataFormatSpec.povOffset);
+    }
+  }
+
+  DataFormat::EStandardFormat DataFormat::IdentifyStandardFormat(void) const
+  {
+    static_assert(
+        (offsetof(DIJOYSTATE, rgdwPOV) == offsetof(DIJOYSTATE2, rgdwPOV)) &&
+            (offsetof(DIJOYSTATE, rgbButtons) == offsetof(DIJOYSTATE2, rgbButtons)),
+        "DIJOYSTATE is expected to be a prefix of DIJOYSTATE2.");
+    static_assert(
+        _countof(DIJOYSTATE::rgbButtons) >= (int)Controller::EButton::Count,
+        "DIJOYSTATE is expected to have room for all virtual controller buttons.");
+
+    static constexpr TOffset kStandardAxisOffsets[] = {
+        DIJOFS_X, DIJOFS_Y, DIJOFS_Z, DIJOFS_RX, DIJOFS_RY, DIJOFS_RZ};
+    static_assert(
+        _countof(kStandardAxisOffsets) == (int)Controller::EAxis::Count,
+        "Standard axis offsets must be specified for all axes.");
+
+    EStandardFormat identifiedFormat = EStandardFormat::None;
+    switch (dataFormatSpec.packetSizeBytes)
+    {
+      case sizeof(DIJOYSTATE):
+        identifiedFormat = EStandardFormat::Joystick;
+        break;
+
+      case sizeof(DIJOYSTATE2):
+        identifiedFormat = EStandardFormat::Joystick2;
+        break;
+
+      default:
+        return EStandardFormat::None;
+    }
+
+    for (int i = 0; i < _countof(dataFormatSpec.axisOffset); ++i)
+    {
+      if ((kInvalidOffsetValue != dataFormatSpec.axisOffset[i]) &&
+          (kStandardAxisOffsets[i] != dataFormatSpec.axisOffset[i]))
+        return EStandardFormat::None;
+    }
+
+    for (int i = 0; i < _countof(dataFormatSpec.buttonOffset); ++i)
+    {
+      if ((kInvalidOffsetValue != dataFormatSpec.buttonOffset[i]) &&
+          ((TOffset)DIJOFS_BUTTON(i) != dataFormatSpec.buttonOffset[i]))
+        return EStandardFormat::None;
+    }
+
+    // The virtual controller's POV, if present, occupies the first POV slot. Writing a standard
+    // data format initializes all of the other POV slots to center position, so the application
+    // must have defined every one of them as an unused POV.
+    if ((kInvalidOffsetValue != dataFormatSpec.povOffset) &&
+        ((TOffset)DIJOFS_POV(0) != dataFormatSpec.povOffset))
+      return EStandardFormat::None;
+
+    std::set<TOffset> standardPovOffsetsUnused;
+    for (int i = 0; i < _countof(DIJOYSTATE::rgdwPOV); ++i)
+    {
+      if ((TOffset)DIJOFS_POV(i) != dataFormatSpec.povOffset)
+        standardPovOffsetsUnused.insert((TOffset)DIJOFS_POV(i));
+    }
+
+    if (standardPovOffsetsUnused != dataFormatSpec.povOffsetsUnused) return EStandardFormat::None;
+
+    return identifiedFormat;
+  }
+
   std::unique_ptr<DataFormat> DataFormat::CreateFromApplicationFormatSpec(
       const DIDATAFORMAT& appFormatSpec, const Controller::SCapabilities controllerCapabilities)
   {
@@ -663,6 +879,100 @@ namespace Xidi
         new DataFormat(controllerCapabilities, std::move(dataFormatSpec)));
   }
 
+  /// Maximum number of data format objects held for reuse. Applications generally use very few
+  /// distinct data formats, so this limit is only reached by an application that keeps generating
+  /// new ones, in which case any further data formats are created without being held for reuse.
+  static constexpr size_t kMaxReusableDataFormatCount = 64;
+
+  /// Produces a key that identifies an application data format specification together with the
+  /// capabilities of the virtual controller for which it is being specified. The key holds the
+  /// contents of every object format specification, including the GUIDs to which they point,
+  /// because applications are free to build the same data format at different addresses.
+  /// @param [in] appFormatSpec Application-provided DirectInput data format specification.
+  /// @param [in] controllerCapabilities Capabilities of the virtual controller.
+  /// @return Key that identifies the combination, or nothing if the specification does not
+  /// contain any object format specifications that can be read.
+  static std::optional<std::string> ReusableDataFormatKey(
+      const DIDATAFORMAT& appFormatSpec, const Controller::SCapabilities controllerCapabilities)
+  {
+    if ((appFormatSpec.dwNumObjs < 1) || (nullptr == appFormatSpec.rgodf)) return std::nullopt;
+
+    std::string key;
+    key.reserve(
+        sizeof(controllerCapabilities) + (3 * sizeof(DWORD)) +
+        (appFormatSpec.dwNumObjs * (1 + sizeof(GUID) + (3 * sizeof(DWORD)))));
+
+    auto appendToKey = [&key](const void* data, size_t dataSizeBytes) -> void
+    {
+      key.append(reinterpret_cast<const char*>(data), dataSizeBytes);
+    };
+
+    const uint8_t capabilitiesSummary[] = {
+        (uint8_t)controllerCapabilities.numAxes,
+        (uint8_t)controllerCapabilities.numButtons,
+        (uint8_t)controllerCapabilities.hasPov};
+    appendToKey(capabilitiesSummary, sizeof(capabilitiesSummary));
+
+    for (int i = 0; i < (int)controllerCapabilities.numAxes; ++i)
+    {
+      const uint8_t axisSummary[] = {
+          (uint8_t)controllerCapabilities.axisCapabilities[i].type,
+          (uint8_t)controllerCapabilities.axisCapabilities[i].supportsForceFeedback};
+      appendToKey(axisSummary, sizeof(axisSummary));
+    }
+
+    appendToKey(&appFormatSpec.dwFlags, sizeof(appFormatSpec.dwFlags));
+    appendToKey(&appFormatSpec.dwDataSize, sizeof(appFormatSpec.dwDataSize));
+    appendToKey(&appFormatSpec.dwNumObjs, sizeof(appFormatSpec.dwNumObjs));
+
+    for (DWORD i = 0; i < appFormatSpec.dwNumObjs; ++i)
+    {
+      const DIOBJECTDATAFORMAT& objectFormatSpec = appFormatSpec.rgodf[i];
+
+      const uint8_t hasGuid = ((nullptr != objectFormatSpec.pguid) ? 1 : 0);
+      appendToKey(&hasGuid, sizeof(hasGuid));
+      if (nullptr != objectFormatSpec.pguid)
+        appendToKey(objectFormatSpec.pguid, sizeof(*objectFormatSpec.pguid));
+
+      appendToKey(&objectFormatSpec.dwOfs, sizeof(objectFormatSpec.dwOfs));
+      appendToKey(&objectFormatSpec.dwType, sizeof(objectFormatSpec.dwType));
+      appendToKey(&objectFormatSpec.dwFlags, sizeof(objectFormatSpec.dwFlags));
+    }
+
+    return key;
+  }
+
+  std::shared_ptr<const DataFormat> DataFormat::GetOrCreateFromApplicationFormatSpec(
+      const DIDATAFORMAT& appFormatSpec, const Controller::SCapabilities controllerCapabilities)
+  {
+    static std::mutex reusableDataFormatsMutex;
+    static std::unordered_map<std::string, std::shared_ptr<const DataFormat>> reusableDataFormats;
+
+    std::optional<std::string> maybeKey =
+        ReusableDataFormatKey(appFormatSpec, controllerCapabilities);
+    if (false == maybeKey.has_value())
+      return CreateFromApplicationFormatSpec(appFormatSpec, controllerCapabilities);
+
+    std::scoped_lock lock(reusableDataFormatsMutex);
+
+    const auto reusableDataFormatIter = reusableDataFormats.find(maybeKey.value());
+    if (reusableDataFormats.end() != reusableDataFormatIter)
+    {
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Accepted application data format, which is identical to one that was previously accepted. Total data packet size is %u byte(s).",
+          appFormatSpec.dwDataSize);
+      return reusableDataFormatIter->second;
+    }
+
+    std::shared_ptr<const DataFormat> newDataFormat =
+        CreateFromApplicationFormatSpec(appFormatSpec, controllerCapabilities);
+    if ((nullptr != newDataFormat) && (reusableDataFormats.size() < kMaxReusableDataFormatCount))
+      reusableDataFormats.emplace(std::move(maybeKey.value()), newDataFormat);
+
+    return newDataFormat;
+  }
+
   EPovValue DataFormat::DirectInputPovValue(Controller::UPovDirection pov)
   {
     static constexpr EPovValue kPovDirectionValues[3][3] = {
@@ -678,36 +988,83 @@ namespace Xidi
     return kPovDirectionValues[1 + yCoord][1 + xCoord];
   }
 
-  std::optional<Controller::SElementIdentifier> DataFormat::GetElementForOffset(
-      TOffset offset) const
+  void DataFormat::ExecutePacketWriteOperations(
+      uint8_t* packetByteBuffer,
+      const Controller::SState& controllerState,
+      Controller::TElementMask elements) const
   {
-    const auto elementRecord = dataFormatSpec.offsetElementMap.find(offset);
-    if (elementRecord != dataFormatSpec.offsetElementMap.cend()) return elementRecord->second;
+    const uint64_t buttonBits = (uint64_t)controllerState.button.to_ullong();
 
-    return std::nullopt;
-  }
-
-  std::optional<TOffset> DataFormat::GetOffsetForElement(
-      Controller::SElementIdentifier element) const
-  {
-    switch (element.type)
+    for (const auto& packetWriteOperation : packetWriteOperations)
     {
-      case Controller::EElementType::Axis:
-        if (kInvalidOffsetValue != dataFormatSpec.axisOffset[(int)element.axis])
-          return dataFormatSpec.axisOffset[(int)element.axis];
-        break;
+      if (0 == (packetWriteOperation.elements & elements)) continue;
 
-      case Controller::EElementType::Button:
-        if (kInvalidOffsetValue != dataFormatSpec.buttonOffset[(int)element.button])
-          return dataFormatSpec.buttonOffset[(int)element.button];
-        break;
+      uint8_t* const valueLocation = &packetByteBuffer[packetWriteOperation.offset];
 
-      case Controller::EElementType::Pov:
-        if (kInvalidOffsetValue != dataFormatSpec.povOffset) return dataFormatSpec.povOffset;
-        break;
+      switch (packetWriteOperation.kind)
+      {
+        case EPacketWriteOperationKind::Axis:
+          *((TAxisValue*)valueLocation) =
+              DirectInputAxisValue(controllerState.axis[packetWriteOperation.source]);
+          break;
+
+        case EPacketWriteOperationKind::ButtonRun:
+          WriteButtonRun(
+              valueLocation,
+              (buttonBits >> packetWriteOperation.source),
+              packetWriteOperation.count);
+          break;
+
+        case EPacketWriteOperationKind::Pov:
+          *((EPovValue*)valueLocation) = DirectInputPovValue(controllerState.povDirection);
+          break;
+      }
     }
+  }
 
-    return std::nullopt;
+  void DataFormat::WriteStandardFormatDataPacket(
+      uint8_t* packetByteBuffer, const Controller::SState& controllerState) const
+  {
+    DIJOYSTATE* const joyState = (DIJOYSTATE*)packetByteBuffer;
+
+    joyState->lX = DirectInputAxisValue(
+        controllerState.axis[(int)Controller::EAxis::X] &
+        standardFormatAxisMask[(int)Controller::EAxis::X]);
+    joyState->lY = DirectInputAxisValue(
+        controllerState.axis[(int)Controller::EAxis::Y] &
+        standardFormatAxisMask[(int)Controller::EAxis::Y]);
+    joyState->lZ = DirectInputAxisValue(
+        controllerState.axis[(int)Controller::EAxis::Z] &
+        standardFormatAxisMask[(int)Controller::EAxis::Z]);
+    joyState->lRx = DirectInputAxisValue(
+        controllerState.axis[(int)Controller::EAxis::RotX] &
+        standardFormatAxisMask[(int)Controller::EAxis::RotX]);
+    joyState->lRy = DirectInputAxisValue(
+        controllerState.axis[(int)Controller::EAxis::RotY] &
+        standardFormatAxisMask[(int)Controller::EAxis::RotY]);
+    joyState->lRz = DirectInputAxisValue(
+        controllerState.axis[(int)Controller::EAxis::RotZ] &
+        standardFormatAxisMask[(int)Controller::EAxis::RotZ]);
+
+    joyState->rglSlider[0] = 0;
+    joyState->rglSlider[1] = 0;
+
+    joyState->rgdwPOV[0] =
+        (DWORD)((true == standardFormatHasPov) ? DirectInputPovValue(controllerState.povDirection)
+                                               : EPovValue::Center);
+    joyState->rgdwPOV[1] = (DWORD)EPovValue::Center;
+    joyState->rgdwPOV[2] = (DWORD)EPovValue::Center;
+    joyState->rgdwPOV[3] = (DWORD)EPovValue::Center;
+
+    WriteButtonRun(
+        joyState->rgbButtons,
+        (uint64_t)(controllerState.button.word & standardFormatButtonMask),
+        _countof(joyState->rgbButtons));
+
+    // Other than having room for more buttons, everything that a `DIJOYSTATE2` structure adds
+    // beyond a `DIJOYSTATE` structure is not present on virtual controllers.
+    if (EStandardFormat::Joystick2 == standardFormat)
+      ZeroMemory(&packetByteBuffer[sizeof(DIJOYSTATE)], sizeof(DIJOYSTATE2) - sizeof(DIJOYSTATE));
   }
 
   bool DataFormat::WriteDataPacket(
@@ -720,45 +1077,39 @@ namespace Xidi
 
     uint8_t* const packetByteBuffer = (uint8_t*)packetBuffer;
 
-    // Initialize the application data packet.
-    // Everything not explicitly written will be 0, except for unused POVs which must be initialized
-    // to center position.
-    ZeroMemory(packetBuffer, packetBufferSizeBytes);
-    for (auto povOffsetUnused : dataFormatSpec.povOffsetsUnused)
+    if (EStandardFormat::None != standardFormat)
     {
-      EPovValue* const valueLocation = (EPovValue*)(&packetByteBuffer[povOffsetUnused]);
-      *valueLocation = EPovValue::Center;
+      WriteStandardFormatDataPacket(packetByteBuffer, controllerState);
     }
-
-    // Axis values
-    for (int i = 0; i < _countof(dataFormatSpec.axisOffset); ++i)
+    else
     {
-      if (kInvalidOffsetValue != dataFormatSpec.axisOffset[i])
-      {
-        TAxisValue* const valueLocation =
-            (TAxisValue*)(&packetByteBuffer[dataFormatSpec.axisOffset[i]]);
-        *valueLocation = DirectInputAxisValue(controllerState.axis[i]);
-      }
+      // Initialize the application data packet.
+      // Everything not explicitly written will be 0, except for unused POVs which must be
+      // initialized to center position. All of this is captured by the packet template.
+      std::copy(packetTemplate.cbegin(), packetTemplate.cend(), packetByteBuffer);
+      ExecutePacketWriteOperations(packetByteBuffer, controllerState, Controller::kElementMaskAll);
     }
 
-    // Button values
-    for (int i = 0; i < _countof(dataFormatSpec.buttonOffset); ++i)
+    // Any space beyond the end of the data packet is zeroed out.
+    if (packetBufferSizeBytes > dataFormatSpec.packetSizeBytes)
     {
-      if (kInvalidOffsetValue != dataFormatSpec.buttonOffset[i])
-      {
-        TButtonValue* const valueLocation =
-            (TButtonValue*)(&packetByteBuffer[dataFormatSpec.buttonOffset[i]]);
-        *valueLocation = DirectInputButtonValue(controllerState.button[i]);
-      }
+      ZeroMemory(
+          &packetByteBuffer[dataFormatSpec.packetSizeBytes],
+          packetBufferSizeBytes - dataFormatSpec.packetSizeBytes);
     }
 
-    // POV value
-    if (kInvalidOffsetValue != dataFormatSpec.povOffset)
-    {
-      EPovValue* const valueLocation = (EPovValue*)(&packetByteBuffer[dataFormatSpec.povOffset]);
-      *valueLocation = DirectInputPovValue(controllerState.povDirection);
-    }
+    return true;
+  }
+
+  bool DataFormat::WriteDataPacketElements(
+      void* packetBuffer,
+      TOffset packetBufferSizeBytes,
+      const Controller::SState& controllerState,
+      Controller::TElementMask elements) const
+  {
+    if (packetBufferSizeBytes < dataFormatSpec.packetSizeBytes) return false;
 
+    ExecutePacketWriteOperations((uint8_t*)packetBuffer, controllerState, elements);
     return true;
   }
 } // namespace Xidi
@@ -12,7 +12,6 @@
 
 #include "DllFunctions.h"
 
-#include <map>
 #include <mutex>
 #include <string_view>
 #include <unordered_map>
@@ -35,22 +34,26 @@ namespace Xidi
         Infra::Strings::CaseInsensitiveHasher<wchar_t>,
         Infra::Strings::CaseInsensitiveEqualityComparator<wchar_t>>;
 
-    /// Type alias for mapping from a function name to a forwarded function object. Function names
-    /// are case-sensitive.
-    using TForwardedFunctionNameToObjectMap = std::map<std::string_view, ForwardedFunction*>;
+    /// Type alias for mapping from the address of the variable that holds a forwarded function's
+    /// destination address to the associated forwarded function object.
+    using TForwardedFunctionAddressToObjectMap = std::unordered_map<void**, ForwardedFunction*>;
 
     /// Holds handles for all libraries to which functions are being forwarded.
     static TLibraryNameToHandleMap libraryHandles;
 
-    /// Holds an index of all registered forwarded functions. Maps from forwarded function name to
-    /// associated object.
-    static TForwardedFunctionNameToObjectMap allForwardedFunctions;
+    /// Holds an index of all registered forwarded functions. Maps from destination address
+    /// variable to associated object.
+    static TForwardedFunctionAddressToObjectMap allForwardedFunctions;
+
+    /// Serializes resolution of forwarded functions, which can be triggered concurrently by
+    /// multiple threads each calling a different exported function for the first time.
+    static std::mutex forwardedFunctionResolveMutex;
 
     ForwardedFunction::ForwardedFunction(
         ForwardedFunction::TLibraryPathFunc libraryPathFunc, std::string_view funcName, void** ptr)
         : libraryPathFunc(libraryPathFunc), funcName(funcName), ptr(ptr)
     {
-      allForwardedFunctions.emplace(funcName, this);
+      allForwardedFunctions.emplace(ptr, this);
     }
 
     /// Writes to the log a failure to import a specific function from a library.
@@ -119,48 +122,44 @@ namespace Xidi
   } // namespace DllFunctions
 } // namespace Xidi
 
-/// Initializes the destination addresses of all forwarded functions. Invoked automatically from the
-/// assembly implementation of the individual exported functions.
-extern "C" void DllForwardedFunctionsInitialize(void)
+/// Resolves the destination address of a single forwarded function and stores it so that all
+/// subsequent calls go directly to it. Invoked automatically from the assembly implementation of
+/// the resolver stub for each individual exported function, the first time that function is
+/// called.
+/// @param [in] ptr Address of the variable that holds the destination address of the exported
+/// function being called.
+extern "C" void DllForwardedFunctionResolve(void** ptr)
 {
   using namespace Xidi::DllFunctions;
 
-  static std::once_flag initializationFlag;
-  std::call_once(
-      initializationFlag,
-      []() -> void
-      {
-        while (false == allForwardedFunctions.empty())
-        {
-          auto dllForwardedFunction = allForwardedFunctions.extract(allForwardedFunctions.cbegin());
-          std::wstring_view libraryPath = dllForwardedFunction.mapped()->GetLibraryPath();
-
-          auto libraryHandleIter = libraryHandles.find(libraryPath);
-          if (libraryHandles.end() == libraryHandleIter)
-          {
-            HMODULE loadedLibraryHandle =
-                LoadLibrary(dllForwardedFunction.mapped()->GetLibraryPath().data());
-            if (nullptr == loadedLibraryHandle)
-            {
-              TerminateProcessBecauseLibraryNotLoaded(
-                  dllForwardedFunction.mapped()->GetLibraryPath());
-              return;
-            }
-            libraryHandleIter = libraryHandles.emplace(libraryPath, loadedLibraryHandle).first;
-          }
-
-          HMODULE libraryHandle = libraryHandleIter->second;
-          void* procAddress = GetProcAddress(
-              libraryHandle, dllForwardedFunction.mapped()->GetFunctionName().data());
-          if (nullptr == procAddress)
-          {
-            TerminateProcessBecauseImportFailed(
-                dllForwardedFunction.mapped()->GetLibraryPath(),
-                dllForwardedFunction.mapped()->GetFunctionName());
-            return;
-          }
-
-          dllForwardedFunction.mapped()->SetProcAddress(procAddress);
-        }
-      });
+  std::scoped_lock lock(forwardedFunctionResolveMutex);
+
+  auto dllForwardedFunctionIter = allForwardedFunctions.find(ptr);
+  if (allForwardedFunctions.end() == dllForwardedFunctionIter) return;
+
+  ForwardedFunction* const dllForwardedFunction = dllForwardedFunctionIter->second;
+  std::wstring_view libraryPath = dllForwardedFunction->GetLibraryPath();
+
+  auto libraryHandleIter = libraryHandles.find(libraryPath);
+  if (libraryHandles.end() == libraryHandleIter)
+  {
+    HMODULE loadedLibraryHandle = LoadLibrary(libraryPath.data());
+    if (nullptr == loadedLibraryHandle)
+    {
+      TerminateProcessBecauseLibraryNotLoaded(libraryPath);
+      return;
+    }
+    libraryHandleIter = libraryHandles.emplace(libraryPath, loadedLibraryHandle).first;
+  }
+
+  void* procAddress =
+      GetProcAddress(libraryHandleIter->second, dllForwardedFunction->GetFunctionName().data());
+  if (nullptr == procAddress)
+  {
+    TerminateProcessBecauseImportFailed(libraryPath, dllForwardedFunction->GetFunctionName());
+    return;
+  }
+
+  dllForwardedFunction->SetProcAddress(procAddress);
+  allForwardedFunctions.erase(dllForwardedFunctionIter);
 }
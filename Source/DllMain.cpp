@@ -12,6 +12,14 @@
 #include "ApiWindows.h"
 #include "Globals.h"
 
+#ifndef XIDI_SKIP_MAPPERS
+#include "ApiCallProfile.h"
+#include "AutoTune.h"
+#include "InputLatencyTrace.h"
+#include "ProfiledMutex.h"
+#include "TraceEvents.h"
+#endif
+
 /// Performs library initialization and teardown functions.
 /// Invoked automatically by the operating system.
 /// Refer to Windows documentation for more information.
@@ -35,6 +43,13 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ulReasonForCall, LPVOID lpReserved)
       break;
 
     case DLL_PROCESS_DETACH:
+#ifndef XIDI_SKIP_MAPPERS
+      Xidi::ApiCallProfile::OutputSummary();
+      Xidi::AutoTune::OutputSummary();
+      Xidi::Controller::InputLatencyTrace::OutputSummary();
+      Xidi::LockProfile::OutputSummary();
+      Xidi::TraceEvents::Unregister();
+#endif
       break;
   }
 
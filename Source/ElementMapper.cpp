@@ -12,28 +12,161 @@
 
 #include "ElementMapper.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
 #include <optional>
 
 #include "ControllerMath.h"
 #include "ControllerTypes.h"
 #include "Globals.h"
 #include "Keyboard.h"
+#include "Mapper.h"
 #include "Mouse.h"
+#include "Settings.h"
 #include "Strings.h"
 
 namespace Xidi
 {
   namespace Controller
   {
-    std::unique_ptr<IElementMapper> AxisMapper::Clone(void) const
+    /// Supplies storage for element mapper objects. Element mappers are small and numerous, and
+    /// configuration files that define many custom mappers would otherwise create thousands of
+    /// individual heap allocations scattered across the heap. Instead, storage is carved out of
+    /// large contiguous blocks, so that the element mappers of a mapper end up close together in
+    /// memory. Storage that is released is kept on a per-size free list for reuse. Blocks are
+    /// never returned to the system because mapper objects are generally never destroyed.
+    class ElementMapperStoragePool
     {
-      return std::make_unique<AxisMapper>(*this);
-    }
+    public:
 
-    void AxisMapper::ContributeFromAnalogValue(
-        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
+      /// Granularity, in bytes, of the sizes of storage slots handed out by the pool. Also
+      /// determines the alignment of all storage slots.
+      static constexpr size_t kSlotGranularity = alignof(std::max_align_t);
+
+      /// Largest object size, in bytes, that is served from the pool. Larger objects are rare and
+      /// are passed through to the global allocator.
+      static constexpr size_t kMaxPooledSize = 256;
+
+      /// Number of distinct storage slot sizes handed out by the pool.
+      static constexpr size_t kNumSizeClasses = kMaxPooledSize / kSlotGranularity;
+
+      /// Size, in bytes, of each contiguous block from which storage slots are carved.
+      static constexpr size_t kBlockSize = 64 * 1024;
+
+      /// Returns a reference to the singleton instance of this class.
+      /// @return Reference to the singleton instance.
+      static ElementMapperStoragePool& GetInstance(void)
+      {
+        static ElementMapperStoragePool elementMapperStoragePool;
+        return elementMapperStoragePool;
+      }
+
+      /// Allocates storage for an object of the specified size.
+      /// @param [in] size Size of the object, in bytes.
+      /// @return Pointer to the allocated storage. Never `nullptr`.
+      void* Allocate(size_t size)
+      {
+        if (size > kMaxPooledSize) return ::operator new(size);
+
+        const size_t sizeClass = SizeClassForSize(size);
+        std::scoped_lock lock(poolGuard);
+
+        if (nullptr != freeLists[sizeClass])
+        {
+          SFreeSlot* const freeSlot = freeLists[sizeClass];
+          freeLists[sizeClass] = freeSlot->next;
+          return freeSlot;
+        }
+
+        const size_t slotSize = SlotSizeForSizeClass(sizeClass);
+        if ((nullptr == currentBlock) || ((kBlockSize - currentBlockUsed) < slotSize))
+        {
+          currentBlock = static_cast<std::byte*>(::operator new(kBlockSize));
+          currentBlockUsed = 0;
+        }
+
+        void* const slot = &currentBlock[currentBlockUsed];
+        currentBlockUsed += slotSize;
+        return slot;
+      }
+
+      /// Releases storage that was previously obtained from #Allocate.
+      /// @param [in] ptr Pointer to the storage to be released.
+      /// @param [in] size Size of the object, in bytes, which must match the size that was passed
+      /// to #Allocate.
+      void Deallocate(void* ptr, size_t size)
+      {
+        if (nullptr == ptr) return;
+
+        if (size > kMaxPooledSize)
+        {
+          ::operator delete(ptr, size);
+          return;
+        }
+
+        const size_t sizeClass = SizeClassForSize(size);
+        std::scoped_lock lock(poolGuard);
+
+        SFreeSlot* const freeSlot = static_cast<SFreeSlot*>(ptr);
+        freeSlot->next = freeLists[sizeClass];
+        freeLists[sizeClass] = freeSlot;
+      }
+
+    private:
+
+      /// Overlaid on top of storage slots that have been released to track them for reuse.
+      struct SFreeSlot
+      {
+        SFreeSlot* next;
+      };
+
+      ElementMapperStoragePool(void) = default;
+
+      ElementMapperStoragePool(const ElementMapperStoragePool& other) = delete;
+
+      /// Computes the size class that serves objects of the specified size.
+      /// @param [in] size Size of the object, in bytes, which must be at most #kMaxPooledSize.
+      /// @return Index of the size class.
+      static constexpr size_t SizeClassForSize(size_t size)
+      {
+        return ((size - 1) / kSlotGranularity);
+      }
+
+      /// Computes the size of the storage slots in the specified size class.
+      /// @param [in] sizeClass Index of the size class.
+      /// @return Size of each storage slot, in bytes.
+      static constexpr size_t SlotSizeForSizeClass(size_t sizeClass)
+      {
+        return ((sizeClass + 1) * kSlotGranularity);
+      }
+
+      /// Released storage slots available for reuse, one list per size class.
+      SFreeSlot* freeLists[kNumSizeClasses] = {};
+
+      /// Block from which new storage slots are currently being carved.
+      std::byte* currentBlock = nullptr;
+
+      /// Number of bytes of the current block that have already been carved into storage slots.
+      size_t currentBlockUsed = 0;
+
+      /// Guards access to the pool. Element mappers are mostly created while configuration is
+      /// being read, but nothing prevents them from being created on any thread.
+      std::mutex poolGuard;
+    };
+
+    /// Contributes to a virtual controller axis from an analog reading.
+    /// Shared by #AxisMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] axis Target axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    static inline void ContributeAxis(
+        SState& controllerState, EAxis axis, EAxisDirection direction, int16_t analogValue)
     {
       int32_t axisValueToContribute = (int32_t)analogValue;
 
@@ -54,8 +187,14 @@ namespace Xidi
       controllerState[axis] += axisValueToContribute;
     }
 
-    void AxisMapper::ContributeFromButtonValue(
-        SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
+    /// Contributes to a virtual controller axis from a button reading.
+    /// Shared by #AxisMapper, #DigitalAxisMapper, and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] axis Target axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    static inline void ContributeAxis(
+        SState& controllerState, EAxis axis, EAxisDirection direction, bool buttonPressed)
     {
       int32_t axisValueToContribute = 0;
 
@@ -77,8 +216,14 @@ namespace Xidi
       controllerState[axis] += axisValueToContribute;
     }
 
-    void AxisMapper::ContributeFromTriggerValue(
-        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
+    /// Contributes to a virtual controller axis from a trigger reading.
+    /// Shared by #AxisMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] axis Target axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    static inline void ContributeAxis(
+        SState& controllerState, EAxis axis, EAxisDirection direction, uint8_t triggerValue)
     {
       constexpr double kBidirectionalStepSize = (double)(kAnalogValueMax - kAnalogValueMin) /
           (double)(kTriggerValueMax - kTriggerValueMin);
@@ -110,6 +255,638 @@ namespace Xidi
       controllerState[axis] += axisValueToContribute;
     }
 
+    /// Contributes to a virtual controller button from an analog reading.
+    /// Shared by #ButtonMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] button Target button.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    static inline void ContributeButton(
+        SState& controllerState, EButton button, int16_t analogValue)
+    {
+      controllerState[button] = (controllerState[button] || Math::IsAnalogPressed(analogValue));
+    }
+
+    /// Contributes to a virtual controller button from a button reading.
+    /// Shared by #ButtonMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] button Target button.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    static inline void ContributeButton(SState& controllerState, EButton button, bool buttonPressed)
+    {
+      controllerState[button] = (controllerState[button] || buttonPressed);
+    }
+
+    /// Contributes to a virtual controller button from a trigger reading.
+    /// Shared by #ButtonMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] button Target button.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    static inline void ContributeButton(
+        SState& controllerState, EButton button, uint8_t triggerValue)
+    {
+      controllerState[button] = (controllerState[button] || Math::IsTriggerPressed(triggerValue));
+    }
+
+    /// Contributes to a virtual controller axis from an analog reading, removing analog
+    /// functionality. Shared by #DigitalAxisMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] axis Target axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    static inline void ContributeDigitalAxis(
+        SState& controllerState, EAxis axis, EAxisDirection direction, int16_t analogValue)
+    {
+      int32_t axisValueToContribute = 0;
+
+      switch (direction)
+      {
+        case EAxisDirection::Both:
+          if (Math::IsAnalogPressedNegative(analogValue))
+            axisValueToContribute = kAnalogValueMin;
+          else if (Math::IsAnalogPressedPositive(analogValue))
+            axisValueToContribute = kAnalogValueMax;
+          break;
+
+        case EAxisDirection::Positive:
+          if (Math::IsAnalogPressedPositive(analogValue)) axisValueToContribute = kAnalogValueMax;
+          break;
+
+        case EAxisDirection::Negative:
+          if (Math::IsAnalogPressedNegative(analogValue)) axisValueToContribute = kAnalogValueMin;
+          break;
+      }
+
+      controllerState[axis] += axisValueToContribute;
+    }
+
+    /// Contributes to a virtual controller axis from a button reading, which for digital axes is
+    /// the same as for regular axes. Shared by #DigitalAxisMapper and compiled element mapper
+    /// programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] axis Target axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    static inline void ContributeDigitalAxis(
+        SState& controllerState, EAxis axis, EAxisDirection direction, bool buttonPressed)
+    {
+      ContributeAxis(controllerState, axis, direction, buttonPressed);
+    }
+
+    /// Contributes to a virtual controller axis from a trigger reading, removing analog
+    /// functionality. Shared by #DigitalAxisMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] axis Target axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    static inline void ContributeDigitalAxis(
+        SState& controllerState, EAxis axis, EAxisDirection direction, uint8_t triggerValue)
+    {
+      ContributeAxis(controllerState, axis, direction, Math::IsTriggerPressed(triggerValue));
+    }
+
+    /// Contributes to a keyboard key from a pressed or released state.
+    /// Shared by #KeyboardMapper and compiled element mapper programs.
+    /// @param [in] key Target keyboard key.
+    /// @param [in] keyPressed Whether or not the key should be considered pressed.
+    static inline void ContributeKeyboard(Keyboard::TKeyIdentifier key, bool keyPressed)
+    {
+      if (true == keyPressed)
+        Keyboard::SubmitKeyPressedState(key);
+      else
+        Keyboard::SubmitKeyReleasedState(key);
+    }
+
+    /// Contributes to a mouse axis from an analog reading.
+    /// Shared by #MouseAxisMapper and compiled element mapper programs.
+    /// @param [in] axis Target mouse axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static inline void ContributeMouseAxis(
+        Mouse::EMouseAxis axis,
+        EAxisDirection direction,
+        int16_t analogValue,
+        uint32_t sourceIdentifier)
+    {
+      const bool kEnableMouseAxisProperites =
+          Globals::GetSettings().properties.useBuiltinProperties;
+
+      constexpr double kAnalogToMouseScalingFactor =
+          (double)(Mouse::kMouseMovementUnitsMax - Mouse::kMouseMovementUnitsMin) /
+          (double)(kAnalogValueMax - kAnalogValueMin);
+
+      constexpr unsigned int kAnalogMouseDeadzonePercent = 8;
+      constexpr unsigned int kAnalogMouseSaturationPercent = 92;
+      const int16_t analogValueForContribution =
+          (kEnableMouseAxisProperites
+               ? Math::ApplyRawAnalogTransform(
+                     analogValue, kAnalogMouseDeadzonePercent, kAnalogMouseSaturationPercent)
+               : analogValue);
+
+      const double mouseAxisValueRaw =
+          ((double)(analogValueForContribution - kAnalogValueNeutral) *
+           kAnalogToMouseScalingFactor);
+      const double mouseAxisValueTransformed = mouseAxisValueRaw;
+
+      int mouseAxisValueToContribute = (int)mouseAxisValueTransformed;
+
+      switch (direction)
+      {
+        case EAxisDirection::Both:
+          break;
+
+        case EAxisDirection::Positive:
+          mouseAxisValueToContribute =
+              (mouseAxisValueToContribute - Mouse::kMouseMovementUnitsMin) / 2;
+          break;
+
+        case EAxisDirection::Negative:
+          mouseAxisValueToContribute =
+              (mouseAxisValueToContribute - Mouse::kMouseMovementUnitsMax) / 2;
+          break;
+      }
+
+      Mouse::SubmitMouseMovement(axis, mouseAxisValueToContribute, sourceIdentifier);
+    }
+
+    /// Contributes to a mouse axis from a button reading.
+    /// Shared by #MouseAxisMapper and compiled element mapper programs.
+    /// @param [in] axis Target mouse axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static inline void ContributeMouseAxis(
+        Mouse::EMouseAxis axis,
+        EAxisDirection direction,
+        bool buttonPressed,
+        uint32_t sourceIdentifier)
+    {
+      constexpr double kMouseButtonContributionScalingFactor = 0.5;
+
+      int mouseAxisValueToContribute = Mouse::kMouseMovementUnitsNeutral;
+
+      switch (direction)
+      {
+        case EAxisDirection::Both:
+          mouseAxisValueToContribute +=
+              (int)(kMouseButtonContributionScalingFactor *
+                    (double)(buttonPressed ? (Mouse::kMouseMovementUnitsMax -
+                                              Mouse::kMouseMovementUnitsNeutral)
+                                           : (Mouse::kMouseMovementUnitsMin -
+                                              Mouse::kMouseMovementUnitsNeutral)));
+          break;
+
+        case EAxisDirection::Positive:
+          mouseAxisValueToContribute +=
+              (int)(kMouseButtonContributionScalingFactor *
+                    (double)(buttonPressed ? (Mouse::kMouseMovementUnitsMax -
+                                              Mouse::kMouseMovementUnitsNeutral)
+                                           : 0));
+          break;
+
+        case EAxisDirection::Negative:
+          mouseAxisValueToContribute +=
+              (int)(kMouseButtonContributionScalingFactor *
+                    (double)(buttonPressed ? (Mouse::kMouseMovementUnitsMin -
+                                              Mouse::kMouseMovementUnitsNeutral)
+                                           : 0));
+          break;
+      }
+
+      Mouse::SubmitMouseMovement(axis, mouseAxisValueToContribute, sourceIdentifier);
+    }
+
+    /// Contributes to a mouse axis from a trigger reading.
+    /// Shared by #MouseAxisMapper and compiled element mapper programs.
+    /// @param [in] axis Target mouse axis.
+    /// @param [in] direction Target axis direction.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static inline void ContributeMouseAxis(
+        Mouse::EMouseAxis axis,
+        EAxisDirection direction,
+        uint8_t triggerValue,
+        uint32_t sourceIdentifier)
+    {
+      const bool kEnableMouseAxisProperites =
+          Globals::GetSettings().properties.useBuiltinProperties;
+
+      constexpr double kBidirectionalStepSize =
+          (double)(Mouse::kMouseMovementUnitsMax - Mouse::kMouseMovementUnitsMin) /
+          (double)(kTriggerValueMax - kTriggerValueMin);
+      constexpr double kPositiveStepSize =
+          (double)Mouse::kMouseMovementUnitsMax / (double)(kTriggerValueMax - kTriggerValueMin);
+      constexpr double kNegativeStepSize =
+          (double)Mouse::kMouseMovementUnitsMin / (double)(kTriggerValueMax - kTriggerValueMin);
+
+      constexpr unsigned int kTriggerMouseDeadzonePercent = 8;
+      constexpr unsigned int kTriggerMouseSaturationPercent = 92;
+      const uint8_t triggerValueForContribution =
+          (kEnableMouseAxisProperites
+               ? Math::ApplyRawTriggerTransform(
+                     triggerValue, kTriggerMouseDeadzonePercent, kTriggerMouseSaturationPercent)
+               : triggerValue);
+
+      int mouseAxisValueToContribute = 0;
+
+      switch (direction)
+      {
+        case EAxisDirection::Both:
+          mouseAxisValueToContribute =
+              (int)((double)triggerValueForContribution * kBidirectionalStepSize) +
+              Mouse::kMouseMovementUnitsMin;
+          break;
+
+        case EAxisDirection::Positive:
+          mouseAxisValueToContribute =
+              (int)((double)triggerValueForContribution * kPositiveStepSize) +
+              Mouse::kMouseMovementUnitsNeutral;
+          break;
+
+        case EAxisDirection::Negative:
+          mouseAxisValueToContribute =
+              (int)((double)triggerValueForContribution * kNegativeStepSize) -
+              Mouse::kMouseMovementUnitsNeutral;
+          break;
+      }
+
+      Mouse::SubmitMouseMovement(axis, mouseAxisValueToContribute, sourceIdentifier);
+    }
+
+    /// Contributes to a mouse button from a pressed or released state.
+    /// Shared by #MouseButtonMapper and compiled element mapper programs.
+    /// @param [in] mouseButton Target mouse button.
+    /// @param [in] mouseButtonPressed Whether or not the mouse button should be considered pressed.
+    static inline void ContributeMouseButton(
+        Mouse::EMouseButton mouseButton, bool mouseButtonPressed)
+    {
+      if (true == mouseButtonPressed)
+        Mouse::SubmitMouseButtonPressedState(mouseButton);
+      else
+        Mouse::SubmitMouseButtonReleasedState(mouseButton);
+    }
+
+    /// Contributes to a virtual controller POV direction from a pressed state. Released states
+    /// make no contribution. Shared by #PovMapper and compiled element mapper programs.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] povDirection Target POV direction.
+    /// @param [in] povDirectionPressed Whether or not the POV direction should be considered
+    /// pressed.
+    static inline void ContributePov(
+        SState& controllerState, EPovDirection povDirection, bool povDirectionPressed)
+    {
+      if (true == povDirectionPressed)
+        controllerState.povDirection.components[(int)povDirection] = true;
+    }
+
+    /// Determines if an analog reading is pressed, for element mappers that target digital
+    /// elements. Overloaded so that compiled element mapper programs can be written generically.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    /// @return `true` if pressed, `false` otherwise.
+    static inline bool IsPressed(int16_t analogValue)
+    {
+      return Math::IsAnalogPressed(analogValue);
+    }
+
+    /// Determines if a button reading is pressed, for element mappers that target digital
+    /// elements. Overloaded so that compiled element mapper programs can be written generically.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    /// @return `true` if pressed, `false` otherwise.
+    static inline bool IsPressed(bool buttonPressed)
+    {
+      return buttonPressed;
+    }
+
+    /// Determines if a trigger reading is pressed, for element mappers that target digital
+    /// elements. Overloaded so that compiled element mapper programs can be written generically.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    /// @return `true` if pressed, `false` otherwise.
+    static inline bool IsPressed(uint8_t triggerValue)
+    {
+      return Math::IsTriggerPressed(triggerValue);
+    }
+
+    /// Inverts an analog reading. Shared by #InvertMapper and compiled element mapper programs.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    /// @return Inverted analog value.
+    static inline int16_t InvertValue(int16_t analogValue)
+    {
+      return (int16_t)((kAnalogValueMax + kAnalogValueMin) - (int32_t)analogValue);
+    }
+
+    /// Inverts a button reading. Shared by #InvertMapper and compiled element mapper programs.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    /// @return Inverted button state.
+    static inline bool InvertValue(bool buttonPressed)
+    {
+      return !buttonPressed;
+    }
+
+    /// Inverts a trigger reading. Shared by #InvertMapper and compiled element mapper programs.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    /// @return Inverted trigger value.
+    static inline uint8_t InvertValue(uint8_t triggerValue)
+    {
+      return (uint8_t)((kTriggerValueMax + kTriggerValueMin) - (int32_t)triggerValue);
+    }
+
+    /// Determines if an analog reading is positive for the purpose of split element mappers.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    /// @return `true` if positive, `false` if negative.
+    static inline bool IsSplitPositive(int16_t analogValue)
+    {
+      return ((int32_t)analogValue >= kAnalogValueNeutral);
+    }
+
+    /// Determines if a button reading is positive for the purpose of split element mappers.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    /// @return `true` if positive, `false` if negative.
+    static inline bool IsSplitPositive(bool buttonPressed)
+    {
+      return buttonPressed;
+    }
+
+    /// Determines if a trigger reading is positive for the purpose of split element mappers.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    /// @return `true` if positive, `false` if negative.
+    static inline bool IsSplitPositive(uint8_t triggerValue)
+    {
+      return ((int32_t)triggerValue >= kTriggerValueMid);
+    }
+
+    /// Computes the value that a split element mapper passes to whichever of its two underlying
+    /// element mappers is active. Analog and trigger readings are passed through unchanged.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    /// @return Value to pass to the active element mapper.
+    static inline int16_t SplitValue(int16_t analogValue)
+    {
+      return analogValue;
+    }
+
+    /// Computes the value that a split element mapper passes to whichever of its two underlying
+    /// element mappers is active. For button readings the active element mapper always receives a
+    /// pressed state, since being selected is what it means for its side of the split to be active.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    /// @return Value to pass to the active element mapper.
+    static inline bool SplitValue(bool buttonPressed)
+    {
+      return true;
+    }
+
+    /// Computes the value that a split element mapper passes to whichever of its two underlying
+    /// element mappers is active. Analog and trigger readings are passed through unchanged.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    /// @return Value to pass to the active element mapper.
+    static inline uint8_t SplitValue(uint8_t triggerValue)
+    {
+      return triggerValue;
+    }
+
+    /// Forwards an analog contribution to an element mapper's virtual method.
+    /// @param [in] elementMapper Element mapper to which the contribution is forwarded.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] analogValue Raw analog stick value from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static inline void ContributeForward(
+        const IElementMapper* elementMapper,
+        SState& controllerState,
+        int16_t analogValue,
+        uint32_t sourceIdentifier)
+    {
+      elementMapper->ContributeFromAnalogValue(controllerState, analogValue, sourceIdentifier);
+    }
+
+    /// Forwards a button contribution to an element mapper's virtual method.
+    /// @param [in] elementMapper Element mapper to which the contribution is forwarded.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] buttonPressed Button state from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static inline void ContributeForward(
+        const IElementMapper* elementMapper,
+        SState& controllerState,
+        bool buttonPressed,
+        uint32_t sourceIdentifier)
+    {
+      elementMapper->ContributeFromButtonValue(controllerState, buttonPressed, sourceIdentifier);
+    }
+
+    /// Forwards a trigger contribution to an element mapper's virtual method.
+    /// @param [in] elementMapper Element mapper to which the contribution is forwarded.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] triggerValue Trigger value from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static inline void ContributeForward(
+        const IElementMapper* elementMapper,
+        SState& controllerState,
+        uint8_t triggerValue,
+        uint32_t sourceIdentifier)
+    {
+      elementMapper->ContributeFromTriggerValue(controllerState, triggerValue, sourceIdentifier);
+    }
+
+    /// Executes a block of compiled element mapper instructions to make neutral contributions.
+    /// Invert and split instructions have no effect on neutral contributions because every
+    /// instruction they govern makes a neutral contribution regardless, so the block is simply
+    /// executed in order.
+    /// @param [in] instructions Instructions to execute.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    static void ExecuteNeutralInstructions(
+        std::span<const ElementMapperProgram::SInstruction> instructions,
+        SState& controllerState,
+        uint32_t sourceIdentifier)
+    {
+      using EOpcode = ElementMapperProgram::EOpcode;
+
+      for (const auto& instruction : instructions)
+      {
+        switch (instruction.opcode)
+        {
+          case EOpcode::Forward:
+            instruction.operand.forward->ContributeNeutral(controllerState, sourceIdentifier);
+            break;
+
+          case EOpcode::Keyboard:
+            Keyboard::SubmitKeyReleasedState(instruction.operand.key);
+            break;
+
+          case EOpcode::MouseAxis:
+            Mouse::SubmitMouseMovement(
+                instruction.operand.mouseAxis.axis,
+                Mouse::kMouseMovementUnitsNeutral,
+                sourceIdentifier);
+            break;
+
+          case EOpcode::MouseButton:
+            Mouse::SubmitMouseButtonReleasedState(instruction.operand.mouseButton);
+            break;
+
+          default:
+            break;
+        }
+      }
+    }
+
+    /// Executes a block of compiled element mapper instructions to make contributions from a given
+    /// input value. Invert and split instructions execute the blocks they govern recursively and
+    /// then skip over them.
+    /// @tparam ValueType Type of input value, which determines whether it is an analog, button, or
+    /// trigger reading.
+    /// @param [in] instructions Instructions to execute.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] value Input value from the XInput controller.
+    /// @param [in] sourceIdentifier Opaque identifier for the specific controller element that is
+    /// triggering the contribution.
+    template <typename ValueType> static void ExecuteInstructions(
+        std::span<const ElementMapperProgram::SInstruction> instructions,
+        SState& controllerState,
+        ValueType value,
+        uint32_t sourceIdentifier)
+    {
+      using EOpcode = ElementMapperProgram::EOpcode;
+
+      for (size_t i = 0; i < instructions.size(); ++i)
+      {
+        const ElementMapperProgram::SInstruction& instruction = instructions[i];
+
+        switch (instruction.opcode)
+        {
+          case EOpcode::Axis:
+            ContributeAxis(
+                controllerState,
+                instruction.operand.axis.axis,
+                instruction.operand.axis.direction,
+                value);
+            break;
+
+          case EOpcode::Button:
+            ContributeButton(controllerState, instruction.operand.button, value);
+            break;
+
+          case EOpcode::DigitalAxis:
+            ContributeDigitalAxis(
+                controllerState,
+                instruction.operand.axis.axis,
+                instruction.operand.axis.direction,
+                value);
+            break;
+
+          case EOpcode::Forward:
+            ContributeForward(
+                instruction.operand.forward, controllerState, value, sourceIdentifier);
+            break;
+
+          case EOpcode::Invert:
+            ExecuteInstructions(
+                instructions.subspan(i + 1, instruction.operand.invertBlockLength),
+                controllerState,
+                InvertValue(value),
+                sourceIdentifier);
+            i += instruction.operand.invertBlockLength;
+            break;
+
+          case EOpcode::Keyboard:
+            ContributeKeyboard(instruction.operand.key, IsPressed(value));
+            break;
+
+          case EOpcode::MouseAxis:
+            ContributeMouseAxis(
+                instruction.operand.mouseAxis.axis,
+                instruction.operand.mouseAxis.direction,
+                value,
+                sourceIdentifier);
+            break;
+
+          case EOpcode::MouseButton:
+            ContributeMouseButton(instruction.operand.mouseButton, IsPressed(value));
+            break;
+
+          case EOpcode::Pov:
+            ContributePov(controllerState, instruction.operand.povDirection, IsPressed(value));
+            break;
+
+          case EOpcode::Split:
+          {
+            const auto positiveInstructions =
+                instructions.subspan(i + 1, instruction.operand.split.positiveBlockLength);
+            const auto negativeInstructions = instructions.subspan(
+                i + 1 + instruction.operand.split.positiveBlockLength,
+                instruction.operand.split.negativeBlockLength);
+
+            if (true == IsSplitPositive(value))
+            {
+              ExecuteInstructions(
+                  positiveInstructions, controllerState, SplitValue(value), sourceIdentifier);
+              ExecuteNeutralInstructions(negativeInstructions, controllerState, sourceIdentifier);
+            }
+            else
+            {
+              ExecuteInstructions(
+                  negativeInstructions, controllerState, SplitValue(value), sourceIdentifier);
+              ExecuteNeutralInstructions(positiveInstructions, controllerState, sourceIdentifier);
+            }
+
+            i += (instruction.operand.split.positiveBlockLength +
+                  instruction.operand.split.negativeBlockLength);
+            break;
+          }
+        }
+      }
+    }
+
+    void* IElementMapper::operator new(size_t size)
+    {
+      return ElementMapperStoragePool::GetInstance().Allocate(size);
+    }
+
+    void IElementMapper::operator delete(void* ptr, size_t size)
+    {
+      ElementMapperStoragePool::GetInstance().Deallocate(ptr, size);
+    }
+
+    void IElementMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::Forward, .operand = {.forward = this}});
+    }
+
+    void AxisMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::Axis,
+           .operand = {.axis = {.axis = axis, .direction = direction}}});
+    }
+
+    std::unique_ptr<IElementMapper> AxisMapper::Clone(void) const
+    {
+      return std::make_unique<AxisMapper>(*this);
+    }
+
+    void AxisMapper::ContributeFromAnalogValue(
+        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
+    {
+      ContributeAxis(controllerState, axis, direction, analogValue);
+    }
+
+    void AxisMapper::ContributeFromButtonValue(
+        SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
+    {
+      ContributeAxis(controllerState, axis, direction, buttonPressed);
+    }
+
+    void AxisMapper::ContributeFromTriggerValue(
+        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
+    {
+      ContributeAxis(controllerState, axis, direction, triggerValue);
+    }
+
     int AxisMapper::GetTargetElementCount(void) const
     {
       return 1;
@@ -122,6 +899,12 @@ namespace Xidi
       return SElementIdentifier({.type = EElementType::Axis, .axis = axis});
     }
 
+    void ButtonMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::Button, .operand = {.button = button}});
+    }
+
     std::unique_ptr<IElementMapper> ButtonMapper::Clone(void) const
     {
       return std::make_unique<ButtonMapper>(*this);
@@ -130,19 +913,19 @@ namespace Xidi
     void ButtonMapper::ContributeFromAnalogValue(
         SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
     {
-      controllerState[button] = (controllerState[button] || Math::IsAnalogPressed(analogValue));
+      ContributeButton(controllerState, button, analogValue);
     }
 
     void ButtonMapper::ContributeFromButtonValue(
         SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
-      controllerState[button] = (controllerState[button] || buttonPressed);
+      ContributeButton(controllerState, button, buttonPressed);
     }
 
     void ButtonMapper::ContributeFromTriggerValue(
         SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
-      controllerState[button] = (controllerState[button] || Math::IsTriggerPressed(triggerValue));
+      ContributeButton(controllerState, button, triggerValue);
     }
 
     int ButtonMapper::GetTargetElementCount(void) const
@@ -157,6 +940,14 @@ namespace Xidi
       return SElementIdentifier({.type = EElementType::Button, .button = button});
     }
 
+    void CompoundMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      for (const auto& elementMapper : elementMappers)
+      {
+        if (nullptr != elementMapper) elementMapper->AppendToProgram(program);
+      }
+    }
+
     std::unique_ptr<IElementMapper> CompoundMapper::Clone(void) const
     {
       return std::make_unique<CompoundMapper>(*this);
@@ -232,45 +1023,348 @@ namespace Xidi
         }
       }
 
-      return std::nullopt;
+      return std::nullopt;
+    }
+
+    void DigitalAxisMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::DigitalAxis,
+           .operand = {.axis = {.axis = GetAxis(), .direction = GetAxisDirection()}}});
+    }
+
+    std::unique_ptr<IElementMapper> DigitalAxisMapper::Clone(void) const
+    {
+      return std::make_unique<DigitalAxisMapper>(*this);
+    }
+
+    void DigitalAxisMapper::ContributeFromAnalogValue(
+        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
+    {
+      ContributeDigitalAxis(controllerState, GetAxis(), GetAxisDirection(), analogValue);
+    }
+
+    void DigitalAxisMapper::ContributeFromTriggerValue(
+        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
+    {
+      ContributeDigitalAxis(controllerState, GetAxis(), GetAxisDirection(), triggerValue);
+    }
+
+    ElementMapperProgram::ElementMapperProgram(
+        std::span<const std::unique_ptr<const IElementMapper>> elementMappers)
+        : instructions(), instructionRanges()
+    {
+      instructionRanges.reserve(elementMappers.size());
+
+      for (const auto& elementMapper : elementMappers)
+      {
+        const uint32_t first = (uint32_t)instructions.size();
+        if (nullptr != elementMapper) elementMapper->AppendToProgram(*this);
+
+        instructionRanges.push_back(
+            {.first = first, .count = (uint32_t)instructions.size() - first});
+      }
+
+      instructions.shrink_to_fit();
+    }
+
+    ElementMapperProgram::ElementMapperProgram(const IElementMapper* elementMapper)
+        : instructions(), instructionRanges()
+    {
+      if (nullptr != elementMapper) elementMapper->AppendToProgram(*this);
+
+      instructionRanges.push_back({.first = 0, .count = (uint32_t)instructions.size()});
+    }
+
+    void ElementMapperProgram::AppendInstruction(const SInstruction& instruction)
+    {
+      instructions.push_back(instruction);
+    }
+
+    void ElementMapperProgram::AppendInvert(const IElementMapper* elementMapper)
+    {
+      const size_t headerIndex = instructions.size();
+      AppendInstruction({.opcode = EOpcode::Invert, .operand = {.invertBlockLength = 0}});
+
+      if (nullptr != elementMapper) elementMapper->AppendToProgram(*this);
+
+      instructions[headerIndex].operand.invertBlockLength =
+          (uint32_t)(instructions.size() - headerIndex - 1);
+    }
+
+    void ElementMapperProgram::AppendSplit(
+        const IElementMapper* positiveMapper, const IElementMapper* negativeMapper)
+    {
+      const size_t headerIndex = instructions.size();
+      AppendInstruction(
+          {.opcode = EOpcode::Split,
+           .operand = {.split = {.positiveBlockLength = 0, .negativeBlockLength = 0}}});
+
+      if (nullptr != positiveMapper) positiveMapper->AppendToProgram(*this);
+      const size_t positiveEnd = instructions.size();
+
+      if (nullptr != negativeMapper) negativeMapper->AppendToProgram(*this);
+      const size_t negativeEnd = instructions.size();
+
+      instructions[headerIndex].operand.split.positiveBlockLength =
+          (uint32_t)(positiveEnd - headerIndex - 1);
+      instructions[headerIndex].operand.split.negativeBlockLength =
+          (uint32_t)(negativeEnd - positiveEnd);
+    }
+
+    void ElementMapperProgram::ContributeFromAnalogValue(
+        unsigned int elementIndex,
+        SState& controllerState,
+        int16_t analogValue,
+        uint32_t sourceIdentifier) const
+    {
+      ExecuteInstructions(
+          GetInstructions(elementIndex), controllerState, analogValue, sourceIdentifier);
+    }
+
+    void ElementMapperProgram::ContributeFromButtonValue(
+        unsigned int elementIndex,
+        SState& controllerState,
+        bool buttonPressed,
+        uint32_t sourceIdentifier) const
+    {
+      ExecuteInstructions(
+          GetInstructions(elementIndex), controllerState, buttonPressed, sourceIdentifier);
+    }
+
+    void ElementMapperProgram::ContributeFromTriggerValue(
+        unsigned int elementIndex,
+        SState& controllerState,
+        uint8_t triggerValue,
+        uint32_t sourceIdentifier) const
+    {
+      ExecuteInstructions(
+          GetInstructions(elementIndex), controllerState, triggerValue, sourceIdentifier);
+    }
+
+    void ElementMapperProgram::ContributeNeutral(
+        unsigned int elementIndex, SState& controllerState, uint32_t sourceIdentifier) const
+    {
+      ExecuteNeutralInstructions(GetInstructions(elementIndex), controllerState, sourceIdentifier);
+    }
+
+    bool ElementMapperProgram::HasSideEffects(unsigned int elementIndex) const
+    {
+      for (const auto& instruction : GetInstructions(elementIndex))
+      {
+        switch (instruction.opcode)
+        {
+          case EOpcode::Forward:
+          case EOpcode::Keyboard:
+          case EOpcode::MouseAxis:
+          case EOpcode::MouseButton:
+            return true;
+
+          default:
+            break;
+        }
+      }
+
+      return false;
+    }
+
+    /// Speed, as a percentage of the element range per sample, at and above which one euro
+    /// filters stop smoothing entirely.
+    static constexpr int32_t kOneEuroFullSpeedPercent = 5;
+
+    FilterMapper::FilterMapper(
+        EFilterType filterType,
+        unsigned int strength,
+        std::unique_ptr<const IElementMapper>&& elementMapper)
+        : filterType(filterType),
+          strength(std::min(strength, MaxStrength(filterType))),
+          elementMapper(std::move(elementMapper)),
+          filterState()
+    {}
+
+    FilterMapper::FilterMapper(const FilterMapper& other)
+        : filterType(other.filterType),
+          strength(other.strength),
+          elementMapper((other.elementMapper != nullptr) ? other.elementMapper->Clone() : nullptr),
+          filterState()
+    {}
+
+    int32_t FilterMapper::Filter(
+        uint32_t sourceIdentifier, int32_t reading, int32_t elementRange) const
+    {
+      SFilterState& state = filterState
+          [Mapper::SourceControllerIdentifierFromSourceIdentifier(sourceIdentifier) %
+           filterState.size()];
+      const int32_t fixedReading = reading * (1 << kFractionBits);
+
+      if (false == state.valid)
+      {
+        state = {
+            .valid = true, .previousReading = fixedReading, .output = fixedReading, .speed = 0};
+        return reading;
+      }
+
+      // Percentage of the difference between the reading and the previous output that is kept
+      // out of the new output. Only used by smoothing filters.
+      int32_t retainedPercent = (int32_t)strength;
+
+      switch (filterType)
+      {
+        case EFilterType::Hysteresis:
+        {
+          const int32_t threshold = ((elementRange * (int32_t)strength) / 100) << kFractionBits;
+          if (std::abs(fixedReading - state.output) > threshold) state.output = fixedReading;
+          retainedPercent = 0;
+          break;
+        }
+
+        case EFilterType::OneEuro:
+        {
+          // Smoothing is relaxed linearly with speed, which approximates raising the cutoff
+          // frequency in proportion to speed without needing any transcendental functions.
+          const int32_t fullSpeed =
+              ((elementRange * kOneEuroFullSpeedPercent) / 100) << kFractionBits;
+          state.speed += (std::abs(fixedReading - state.previousReading) - state.speed) / 2;
+          retainedPercent -= (retainedPercent * std::min(state.speed, fullSpeed)) / fullSpeed;
+          break;
+        }
+
+        default:
+          break;
+      }
+
+      if (EFilterType::Hysteresis != filterType)
+        state.output += (int32_t)(
+            ((int64_t)(fixedReading - state.output) * (int64_t)(100 - retainedPercent)) / 100);
+
+      state.previousReading = fixedReading;
+      return (state.output + (1 << (kFractionBits - 1))) >> kFractionBits;
+    }
+
+    int32_t FilterMapper::FilterPressRelease(
+        uint32_t sourceIdentifier,
+        int32_t reading,
+        int32_t elementRange,
+        int32_t negativeThreshold,
+        int32_t positiveThreshold) const
+    {
+      SFilterState& state = filterState
+          [Mapper::SourceControllerIdentifierFromSourceIdentifier(sourceIdentifier) %
+           filterState.size()];
+
+      if (false == state.valid) state = {.valid = true, .pressedDirection = 0};
+
+      const int32_t releaseMargin = (elementRange * (int32_t)strength) / 100;
+
+      if (reading >= positiveThreshold)
+      {
+        state.pressedDirection = 1;
+        return reading;
+      }
+      else if (reading <= negativeThreshold)
+      {
+        state.pressedDirection = -1;
+        return reading;
+      }
+      else if ((1 == state.pressedDirection) && (reading >= (positiveThreshold - releaseMargin)))
+      {
+        return positiveThreshold;
+      }
+      else if ((-1 == state.pressedDirection) && (reading <= (negativeThreshold + releaseMargin)))
+      {
+        return negativeThreshold;
+      }
+
+      state.pressedDirection = 0;
+      return reading;
+    }
+
+    std::unique_ptr<IElementMapper> FilterMapper::Clone(void) const
+    {
+      return std::make_unique<FilterMapper>(*this);
+    }
+
+    void FilterMapper::ContributeFromAnalogValue(
+        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
+    {
+      if (nullptr == elementMapper) return;
+
+      const int32_t filteredValue = std::clamp(
+          ((EFilterType::PressRelease == filterType)
+               ? FilterPressRelease(
+                     sourceIdentifier,
+                     (int32_t)analogValue,
+                     (kAnalogValueMax - kAnalogValueMin),
+                     Math::kAnalogPressedThresholdNegative,
+                     Math::kAnalogPressedThresholdPositive)
+               : Filter(
+                     sourceIdentifier, (int32_t)analogValue, (kAnalogValueMax - kAnalogValueMin))),
+          (int32_t)std::numeric_limits<int16_t>::min(),
+          (int32_t)std::numeric_limits<int16_t>::max());
+      elementMapper->ContributeFromAnalogValue(
+          controllerState, (int16_t)filteredValue, sourceIdentifier);
     }
 
-    std::unique_ptr<IElementMapper> DigitalAxisMapper::Clone(void) const
+    void FilterMapper::ContributeFromButtonValue(
+        SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
-      return std::make_unique<DigitalAxisMapper>(*this);
+      if (nullptr != elementMapper)
+        elementMapper->ContributeFromButtonValue(controllerState, buttonPressed, sourceIdentifier);
     }
 
-    void DigitalAxisMapper::ContributeFromAnalogValue(
-        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
+    void FilterMapper::ContributeFromTriggerValue(
+        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
-      int32_t axisValueToContribute = 0;
+      if (nullptr == elementMapper) return;
+
+      // Triggers are only ever pressed in the positive direction, so the negative threshold is
+      // placed out of reach.
+      const int32_t filteredValue = std::clamp(
+          ((EFilterType::PressRelease == filterType)
+               ? FilterPressRelease(
+                     sourceIdentifier,
+                     (int32_t)triggerValue,
+                     (kTriggerValueMax - kTriggerValueMin),
+                     (kTriggerValueMin - 1),
+                     Math::kTriggerPressedThreshold)
+               : Filter(
+                     sourceIdentifier,
+                     (int32_t)triggerValue,
+                     (kTriggerValueMax - kTriggerValueMin))),
+          kTriggerValueMin,
+          kTriggerValueMax);
+      elementMapper->ContributeFromTriggerValue(
+          controllerState, (uint8_t)filteredValue, sourceIdentifier);
+    }
 
-      switch (GetAxisDirection())
-      {
-        case EAxisDirection::Both:
-          if (Math::IsAnalogPressedNegative(analogValue))
-            axisValueToContribute = kAnalogValueMin;
-          else if (Math::IsAnalogPressedPositive(analogValue))
-            axisValueToContribute = kAnalogValueMax;
-          break;
+    void FilterMapper::ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier) const
+    {
+      filterState
+          [Mapper::SourceControllerIdentifierFromSourceIdentifier(sourceIdentifier) %
+           filterState.size()]
+              .valid = false;
 
-        case EAxisDirection::Positive:
-          if (Math::IsAnalogPressedPositive(analogValue)) axisValueToContribute = kAnalogValueMax;
-          break;
+      if (nullptr != elementMapper)
+        elementMapper->ContributeNeutral(controllerState, sourceIdentifier);
+    }
 
-        case EAxisDirection::Negative:
-          if (Math::IsAnalogPressedNegative(analogValue)) axisValueToContribute = kAnalogValueMin;
-          break;
-      }
+    int FilterMapper::GetTargetElementCount(void) const
+    {
+      if (nullptr != elementMapper) return elementMapper->GetTargetElementCount();
 
-      controllerState[GetAxis()] += axisValueToContribute;
+      return 0;
     }
 
-    void DigitalAxisMapper::ContributeFromTriggerValue(
-        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
+    std::optional<SElementIdentifier> FilterMapper::GetTargetElementAt(int index) const
+    {
+      if (nullptr != elementMapper) return elementMapper->GetTargetElementAt(index);
+
+      return std::nullopt;
+    }
+
+    void InvertMapper::AppendToProgram(ElementMapperProgram& program) const
     {
-      ContributeFromButtonValue(
-          controllerState, Math::IsTriggerPressed(triggerValue), sourceIdentifier);
+      program.AppendInvert(elementMapper.get());
     }
 
     std::unique_ptr<IElementMapper> InvertMapper::Clone(void) const
@@ -282,35 +1376,24 @@ namespace Xidi
         SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
     {
       if (nullptr != elementMapper)
-      {
-        const int32_t invertedAnalogValue =
-            (kAnalogValueMax + kAnalogValueMin) - (int32_t)analogValue;
         elementMapper->ContributeFromAnalogValue(
-            controllerState, (int16_t)invertedAnalogValue, sourceIdentifier);
-      }
+            controllerState, InvertValue(analogValue), sourceIdentifier);
     }
 
     void InvertMapper::ContributeFromButtonValue(
         SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
       if (nullptr != elementMapper)
-      {
-        const bool invertedButtonValue = !buttonPressed;
         elementMapper->ContributeFromButtonValue(
-            controllerState, invertedButtonValue, sourceIdentifier);
-      }
+            controllerState, InvertValue(buttonPressed), sourceIdentifier);
     }
 
     void InvertMapper::ContributeFromTriggerValue(
         SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
       if (nullptr != elementMapper)
-      {
-        const int32_t invertedTriggerValue =
-            (kTriggerValueMax + kTriggerValueMin) - (int32_t)triggerValue;
         elementMapper->ContributeFromTriggerValue(
-            controllerState, (uint8_t)invertedTriggerValue, sourceIdentifier);
-      }
+            controllerState, InvertValue(triggerValue), sourceIdentifier);
     }
 
     void InvertMapper::ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier) const
@@ -333,6 +1416,12 @@ namespace Xidi
       return std::nullopt;
     }
 
+    void KeyboardMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::Keyboard, .operand = {.key = key}});
+    }
+
     std::unique_ptr<IElementMapper> KeyboardMapper::Clone(void) const
     {
       return std::make_unique<KeyboardMapper>(*this);
@@ -341,28 +1430,19 @@ namespace Xidi
     void KeyboardMapper::ContributeFromAnalogValue(
         SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
     {
-      if (true == Math::IsAnalogPressed(analogValue))
-        Keyboard::SubmitKeyPressedState(key);
-      else
-        Keyboard::SubmitKeyReleasedState(key);
+      ContributeKeyboard(key, IsPressed(analogValue));
     }
 
     void KeyboardMapper::ContributeFromButtonValue(
         SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
-      if (true == buttonPressed)
-        Keyboard::SubmitKeyPressedState(key);
-      else
-        Keyboard::SubmitKeyReleasedState(key);
+      ContributeKeyboard(key, IsPressed(buttonPressed));
     }
 
     void KeyboardMapper::ContributeFromTriggerValue(
         SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
-      if (true == Math::IsTriggerPressed(triggerValue))
-        Keyboard::SubmitKeyPressedState(key);
-      else
-        Keyboard::SubmitKeyReleasedState(key);
+      ContributeKeyboard(key, IsPressed(triggerValue));
     }
 
     void KeyboardMapper::ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier) const
@@ -380,6 +1460,13 @@ namespace Xidi
       return std::nullopt;
     }
 
+    void MouseAxisMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::MouseAxis,
+           .operand = {.mouseAxis = {.axis = axis, .direction = direction}}});
+    }
+
     std::unique_ptr<IElementMapper> MouseAxisMapper::Clone(void) const
     {
       return std::make_unique<MouseAxisMapper>(*this);
@@ -388,137 +1475,19 @@ namespace Xidi
     void MouseAxisMapper::ContributeFromAnalogValue(
         SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
     {
-      static const bool kEnableMouseAxisProperites =
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesUseBuiltinProperties]
-                  .ValueOr(true);
-
-      constexpr double kAnalogToMouseScalingFactor =
-          (double)(Mouse::kMouseMovementUnitsMax - Mouse::kMouseMovementUnitsMin) /
-          (double)(kAnalogValueMax - kAnalogValueMin);
-
-      constexpr unsigned int kAnalogMouseDeadzonePercent = 8;
-      constexpr unsigned int kAnalogMouseSaturationPercent = 92;
-      const int16_t analogValueForContribution =
-          (kEnableMouseAxisProperites
-               ? Math::ApplyRawAnalogTransform(
-                     analogValue, kAnalogMouseDeadzonePercent, kAnalogMouseSaturationPercent)
-               : analogValue);
-
-      const double mouseAxisValueRaw =
-          ((double)(analogValueForContribution - kAnalogValueNeutral) *
-           kAnalogToMouseScalingFactor);
-      const double mouseAxisValueTransformed = mouseAxisValueRaw;
-
-      int mouseAxisValueToContribute = (int)mouseAxisValueTransformed;
-
-      switch (direction)
-      {
-        case EAxisDirection::Both:
-          break;
-
-        case EAxisDirection::Positive:
-          mouseAxisValueToContribute =
-              (mouseAxisValueToContribute - Mouse::kMouseMovementUnitsMin) / 2;
-          break;
-
-        case EAxisDirection::Negative:
-          mouseAxisValueToContribute =
-              (mouseAxisValueToContribute - Mouse::kMouseMovementUnitsMax) / 2;
-          break;
-      }
-
-      Mouse::SubmitMouseMovement(axis, mouseAxisValueToContribute, sourceIdentifier);
+      ContributeMouseAxis(axis, direction, analogValue, sourceIdentifier);
     }
 
     void MouseAxisMapper::ContributeFromButtonValue(
         SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
-      constexpr double kMouseButtonContributionScalingFactor = 0.5;
-
-      int mouseAxisValueToContribute = Mouse::kMouseMovementUnitsNeutral;
-
-      switch (direction)
-      {
-        case EAxisDirection::Both:
-          mouseAxisValueToContribute +=
-              (int)(kMouseButtonContributionScalingFactor *
-                    (double)(buttonPressed ? (Mouse::kMouseMovementUnitsMax -
-                                              Mouse::kMouseMovementUnitsNeutral)
-                                           : (Mouse::kMouseMovementUnitsMin -
-                                              Mouse::kMouseMovementUnitsNeutral)));
-          break;
-
-        case EAxisDirection::Positive:
-          mouseAxisValueToContribute +=
-              (int)(kMouseButtonContributionScalingFactor *
-                    (double)(buttonPressed ? (Mouse::kMouseMovementUnitsMax -
-                                              Mouse::kMouseMovementUnitsNeutral)
-                                           : 0));
-          break;
-
-        case EAxisDirection::Negative:
-          mouseAxisValueToContribute +=
-              (int)(kMouseButtonContributionScalingFactor *
-                    (double)(buttonPressed ? (Mouse::kMouseMovementUnitsMin -
-                                              Mouse::kMouseMovementUnitsNeutral)
-                                           : 0));
-          break;
-      }
-
-      Mouse::SubmitMouseMovement(axis, mouseAxisValueToContribute, sourceIdentifier);
+      ContributeMouseAxis(axis, direction, buttonPressed, sourceIdentifier);
     }
 
     void MouseAxisMapper::ContributeFromTriggerValue(
         SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
-      static const bool kEnableMouseAxisProperites =
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesUseBuiltinProperties]
-                  .ValueOr(true);
-
-      constexpr double kBidirectionalStepSize =
-          (double)(Mouse::kMouseMovementUnitsMax - Mouse::kMouseMovementUnitsMin) /
-          (double)(kTriggerValueMax - kTriggerValueMin);
-      constexpr double kPositiveStepSize =
-          (double)Mouse::kMouseMovementUnitsMax / (double)(kTriggerValueMax - kTriggerValueMin);
-      constexpr double kNegativeStepSize =
-          (double)Mouse::kMouseMovementUnitsMin / (double)(kTriggerValueMax - kTriggerValueMin);
-
-      constexpr unsigned int kTriggerMouseDeadzonePercent = 8;
-      constexpr unsigned int kTriggerMouseSaturationPercent = 92;
-      const uint8_t triggerValueForContribution =
-          (kEnableMouseAxisProperites
-               ? Math::ApplyRawTriggerTransform(
-                     triggerValue, kTriggerMouseDeadzonePercent, kTriggerMouseSaturationPercent)
-               : triggerValue);
-
-      int mouseAxisValueToContribute = 0;
-
-      switch (direction)
-      {
-        case EAxisDirection::Both:
-          mouseAxisValueToContribute =
-              (int)((double)triggerValueForContribution * kBidirectionalStepSize) +
-              Mouse::kMouseMovementUnitsMin;
-          break;
-
-        case EAxisDirection::Positive:
-          mouseAxisValueToContribute =
-              (int)((double)triggerValueForContribution * kPositiveStepSize) +
-              Mouse::kMouseMovementUnitsNeutral;
-          break;
-
-        case EAxisDirection::Negative:
-          mouseAxisValueToContribute =
-              (int)((double)triggerValueForContribution * kNegativeStepSize) -
-              Mouse::kMouseMovementUnitsNeutral;
-          break;
-      }
-
-      Mouse::SubmitMouseMovement(axis, mouseAxisValueToContribute, sourceIdentifier);
+      ContributeMouseAxis(axis, direction, triggerValue, sourceIdentifier);
     }
 
     void MouseAxisMapper::ContributeNeutral(
@@ -537,6 +1506,13 @@ namespace Xidi
       return std::nullopt;
     }
 
+    void MouseButtonMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::MouseButton,
+           .operand = {.mouseButton = mouseButton}});
+    }
+
     std::unique_ptr<IElementMapper> MouseButtonMapper::Clone(void) const
     {
       return std::make_unique<MouseButtonMapper>(*this);
@@ -545,28 +1521,19 @@ namespace Xidi
     void MouseButtonMapper::ContributeFromAnalogValue(
         SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
     {
-      if (true == Math::IsAnalogPressed(analogValue))
-        Mouse::SubmitMouseButtonPressedState(mouseButton);
-      else
-        Mouse::SubmitMouseButtonReleasedState(mouseButton);
+      ContributeMouseButton(mouseButton, IsPressed(analogValue));
     }
 
     void MouseButtonMapper::ContributeFromButtonValue(
         SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
-      if (true == buttonPressed)
-        Mouse::SubmitMouseButtonPressedState(mouseButton);
-      else
-        Mouse::SubmitMouseButtonReleasedState(mouseButton);
+      ContributeMouseButton(mouseButton, IsPressed(buttonPressed));
     }
 
     void MouseButtonMapper::ContributeFromTriggerValue(
         SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
-      if (true == Math::IsTriggerPressed(triggerValue))
-        Mouse::SubmitMouseButtonPressedState(mouseButton);
-      else
-        Mouse::SubmitMouseButtonReleasedState(mouseButton);
+      ContributeMouseButton(mouseButton, IsPressed(triggerValue));
     }
 
     void MouseButtonMapper::ContributeNeutral(
@@ -585,6 +1552,13 @@ namespace Xidi
       return std::nullopt;
     }
 
+    void PovMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendInstruction(
+          {.opcode = ElementMapperProgram::EOpcode::Pov,
+           .operand = {.povDirection = povDirection}});
+    }
+
     std::unique_ptr<IElementMapper> PovMapper::Clone(void) const
     {
       return std::make_unique<PovMapper>(*this);
@@ -593,21 +1567,19 @@ namespace Xidi
     void PovMapper::ContributeFromAnalogValue(
         SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
     {
-      if (true == Math::IsAnalogPressed(analogValue))
-        controllerState.povDirection.components[(int)povDirection] = true;
+      ContributePov(controllerState, povDirection, IsPressed(analogValue));
     }
 
     void PovMapper::ContributeFromButtonValue(
         SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
     {
-      if (true == buttonPressed) controllerState.povDirection.components[(int)povDirection] = true;
+      ContributePov(controllerState, povDirection, IsPressed(buttonPressed));
     }
 
     void PovMapper::ContributeFromTriggerValue(
         SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
     {
-      if (true == Math::IsTriggerPressed(triggerValue))
-        controllerState.povDirection.components[(int)povDirection] = true;
+      ContributePov(controllerState, povDirection, IsPressed(triggerValue));
     }
 
     int PovMapper::GetTargetElementCount(void) const
@@ -622,6 +1594,11 @@ namespace Xidi
       return SElementIdentifier({.type = EElementType::Pov});
     }
 
+    void SplitMapper::AppendToProgram(ElementMapperProgram& program) const
+    {
+      program.AppendSplit(positiveMapper.get(), negativeMapper.get());
+    }
+
     std::unique_ptr<IElementMapper> SplitMapper::Clone(void) const
     {
       return std::make_unique<SplitMapper>(*this);
@@ -728,5 +1705,132 @@ namespace Xidi
 
       return std::nullopt;
     }
+
+    /// Timestamp of the poll that produced the physical controller state being mapped, in
+    /// microseconds, one per physical controller. Used by turbo mappers.
+    static std::array<int64_t, kMaxPhysicalControllerCount> turboMappingTimestampMicroseconds;
+
+    /// Whether or not any turbo mapper was held during the most recent mapping, one per physical
+    /// controller.
+    static std::array<bool, kMaxPhysicalControllerCount> turboAnyHeld;
+
+    TurboMapper::TurboMapper(
+        unsigned int rate, std::unique_ptr<const IElementMapper>&& elementMapper)
+        : rate(std::clamp(rate, kMinRate, kMaxRate)),
+          elementMapper(std::move(elementMapper)),
+          repetitionState()
+    {}
+
+    TurboMapper::TurboMapper(const TurboMapper& other)
+        : rate(other.rate),
+          elementMapper((other.elementMapper != nullptr) ? other.elementMapper->Clone() : nullptr),
+          repetitionState()
+    {}
+
+    bool TurboMapper::IsAnyHeld(uint32_t sourceControllerIdentifier)
+    {
+      return turboAnyHeld[sourceControllerIdentifier % turboAnyHeld.size()];
+    }
+
+    void TurboMapper::SetMappingTimestamp(
+        uint32_t sourceControllerIdentifier, int64_t timestampMicroseconds)
+    {
+      turboMappingTimestampMicroseconds
+          [sourceControllerIdentifier % turboMappingTimestampMicroseconds.size()] =
+              timestampMicroseconds;
+      turboAnyHeld[sourceControllerIdentifier % turboAnyHeld.size()] = false;
+    }
+
+    bool TurboMapper::IsInPressedPhase(uint32_t sourceIdentifier, bool isHeld) const
+    {
+      const uint32_t sourceControllerIdentifier =
+          Mapper::SourceControllerIdentifierFromSourceIdentifier(sourceIdentifier) %
+          kMaxPhysicalControllerCount;
+      SRepetitionState& state = repetitionState[sourceControllerIdentifier];
+
+      if (false == isHeld)
+      {
+        state.held = false;
+        return true;
+      }
+
+      const int64_t now = turboMappingTimestampMicroseconds[sourceControllerIdentifier];
+      if (false == state.held)
+      {
+        state.held = true;
+        state.heldSinceMicroseconds = now;
+      }
+
+      turboAnyHeld[sourceControllerIdentifier] = true;
+
+      const int64_t periodMicroseconds = 1000000 / (int64_t)rate;
+      const int64_t elapsedMicroseconds = std::max<int64_t>(0, now - state.heldSinceMicroseconds);
+      return ((elapsedMicroseconds % periodMicroseconds) < (periodMicroseconds / 2));
+    }
+
+    std::unique_ptr<IElementMapper> TurboMapper::Clone(void) const
+    {
+      return std::make_unique<TurboMapper>(*this);
+    }
+
+    void TurboMapper::ContributeFromAnalogValue(
+        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const
+    {
+      if (nullptr == elementMapper) return;
+
+      if (true == IsInPressedPhase(sourceIdentifier, Math::IsAnalogPressed(analogValue)))
+        elementMapper->ContributeFromAnalogValue(controllerState, analogValue, sourceIdentifier);
+      else
+        elementMapper->ContributeFromAnalogValue(
+            controllerState, (int16_t)kAnalogValueNeutral, sourceIdentifier);
+    }
+
+    void TurboMapper::ContributeFromButtonValue(
+        SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const
+    {
+      if (nullptr == elementMapper) return;
+
+      elementMapper->ContributeFromButtonValue(
+          controllerState,
+          ((true == IsInPressedPhase(sourceIdentifier, buttonPressed)) && (true == buttonPressed)),
+          sourceIdentifier);
+    }
+
+    void TurboMapper::ContributeFromTriggerValue(
+        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const
+    {
+      if (nullptr == elementMapper) return;
+
+      if (true == IsInPressedPhase(sourceIdentifier, Math::IsTriggerPressed(triggerValue)))
+        elementMapper->ContributeFromTriggerValue(controllerState, triggerValue, sourceIdentifier);
+      else
+        elementMapper->ContributeFromTriggerValue(
+            controllerState, (uint8_t)kTriggerValueMin, sourceIdentifier);
+    }
+
+    void TurboMapper::ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier) const
+    {
+      repetitionState
+          [Mapper::SourceControllerIdentifierFromSourceIdentifier(sourceIdentifier) %
+           repetitionState.size()]
+              .held = false;
+
+      if (nullptr != elementMapper)
+        elementMapper->ContributeNeutral(controllerState, sourceIdentifier);
+    }
+
+    int TurboMapper::GetTargetElementCount(void) const
+    {
+      if (nullptr != elementMapper) return elementMapper->GetTargetElementCount();
+
+      return 0;
+    }
+
+    std::optional<SElementIdentifier> TurboMapper::GetTargetElementAt(int index) const
+    {
+      if (nullptr != elementMapper) return elementMapper->GetTargetElementAt(index);
+
+      return std::nullopt;
+    }
   } // namespace Controller
 } // namespace Xidi
@@ -0,0 +1,581 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ElementMapperCache.cpp
+ *   Implementation of a persistent binary cache of element mappers parsed from strings.
+ **************************************************************************************************/
+
+#include "ElementMapperCache.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    /// Value that identifies the start of an element mapper cache file.
+    static constexpr uint32_t kCacheFileMagic = 0x4d454958;
+
+    /// Version of the cache file format. Must be changed whenever the cache file layout or the
+    /// instruction encoding changes, and whenever an existing element mapper string is parsed
+    /// differently, so that cache files written by other versions are ignored.
+    static constexpr uint32_t kCacheFileFormatVersion = 1;
+
+    /// Maximum size of a cache file that will be loaded, in bytes. Anything larger than this is
+    /// assumed not to be a valid cache file.
+    static constexpr uint64_t kCacheFileMaxSizeBytes = 16 * 1024 * 1024;
+
+    /// Number of words that make up each serialized instruction: opcode and two operands.
+    static constexpr size_t kWordsPerInstruction = 3;
+
+    /// Header at the start of the cache file.
+    struct SCacheFileHeader
+    {
+      /// Always #kCacheFileMagic.
+      uint32_t magic;
+
+      /// Always #kCacheFileFormatVersion.
+      uint32_t formatVersion;
+
+      /// Hash of the configuration file contents from which the cached element mappers came.
+      uint64_t sourceHash;
+
+      /// Number of entries that follow the header.
+      uint32_t entryCount;
+
+      /// Not used. Keeps the entries that follow aligned.
+      uint32_t reserved;
+    };
+
+    /// Header at the start of each cache file entry. It is followed by the element mapper string,
+    /// padded to a multiple of 4 bytes, and then by the serialized element mapper.
+    struct SCacheFileEntryHeader
+    {
+      /// Length of the element mapper string, in characters.
+      uint32_t stringLength;
+
+      /// Length of the serialized element mapper, in words.
+      uint32_t serializedLength;
+    };
+
+    /// Computes the number of bytes of cache file space occupied by a string of the specified
+    /// length, including padding.
+    /// @param [in] stringLength Length of the string, in characters.
+    /// @return Number of bytes occupied by the string.
+    static inline size_t PaddedStringSizeBytes(size_t stringLength)
+    {
+      return ((stringLength * sizeof(wchar_t)) + 3) & ~((size_t)3);
+    }
+
+    /// Encodes a single instruction into its serialized form.
+    /// @param [in] instruction Instruction to encode.
+    /// @return Serialized instruction, or nothing if the instruction cannot be serialized.
+    static std::optional<std::array<uint32_t, kWordsPerInstruction>> EncodeInstruction(
+        const ElementMapperProgram::SInstruction& instruction)
+    {
+      using EOpcode = ElementMapperProgram::EOpcode;
+      const uint32_t opcode = (uint32_t)instruction.opcode;
+
+      switch (instruction.opcode)
+      {
+        case EOpcode::Axis:
+        case EOpcode::DigitalAxis:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode,
+              (uint32_t)instruction.operand.axis.axis,
+              (uint32_t)instruction.operand.axis.direction};
+
+        case EOpcode::Button:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode, (uint32_t)instruction.operand.button, 0};
+
+        case EOpcode::Invert:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode, instruction.operand.invertBlockLength, 0};
+
+        case EOpcode::Keyboard:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode, (uint32_t)instruction.operand.key, 0};
+
+        case EOpcode::MouseAxis:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode,
+              (uint32_t)instruction.operand.mouseAxis.axis,
+              (uint32_t)instruction.operand.mouseAxis.direction};
+
+        case EOpcode::MouseButton:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode, (uint32_t)instruction.operand.mouseButton, 0};
+
+        case EOpcode::Pov:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode, (uint32_t)instruction.operand.povDirection, 0};
+
+        case EOpcode::Split:
+          return std::array<uint32_t, kWordsPerInstruction>{
+              opcode,
+              instruction.operand.split.positiveBlockLength,
+              instruction.operand.split.negativeBlockLength};
+
+        default:
+          // Forwarding instructions refer to element mapper objects, which cannot be serialized.
+          return std::nullopt;
+      }
+    }
+
+    static std::optional<std::unique_ptr<IElementMapper>> DecodeBlock(
+        std::span<const uint32_t> words);
+
+    /// Decodes the first element mapper from a sequence of serialized instructions, including
+    /// any element mappers nested within it.
+    /// @param [in,out] words Serialized instructions, advanced past those that were decoded.
+    /// @return Decoded element mapper, or nothing if the serialized instructions are invalid.
+    static std::optional<std::unique_ptr<IElementMapper>> DecodeElementMapper(
+        std::span<const uint32_t>& words)
+    {
+      using EOpcode = ElementMapperProgram::EOpcode;
+
+      if ((words.size() < kWordsPerInstruction) ||
+          (words[0] > (uint32_t)std::numeric_limits<std::underlying_type_t<EOpcode>>::max()))
+        return std::nullopt;
+
+      const EOpcode opcode = (EOpcode)words[0];
+      const uint32_t operandA = words[1];
+      const uint32_t operandB = words[2];
+      words = words.subspan(kWordsPerInstruction);
+
+      switch (opcode)
+      {
+        case EOpcode::Axis:
+        case EOpcode::DigitalAxis:
+          if ((operandA >= (uint32_t)EAxis::Count) || (operandB >= (uint32_t)EAxisDirection::Count))
+            return std::nullopt;
+          if (EOpcode::Axis == opcode)
+            return std::make_unique<AxisMapper>((EAxis)operandA, (EAxisDirection)operandB);
+          return std::make_unique<DigitalAxisMapper>((EAxis)operandA, (EAxisDirection)operandB);
+
+        case EOpcode::Button:
+          if (operandA >= (uint32_t)EButton::Count) return std::nullopt;
+          return std::make_unique<ButtonMapper>((EButton)operandA);
+
+        case EOpcode::Keyboard:
+          if (operandA >= Keyboard::kVirtualKeyboardKeyCount) return std::nullopt;
+          return std::make_unique<KeyboardMapper>((Keyboard::TKeyIdentifier)operandA);
+
+        case EOpcode::MouseAxis:
+          if ((operandA >= (uint32_t)Mouse::EMouseAxis::Count) ||
+              (operandB >= (uint32_t)EAxisDirection::Count))
+            return std::nullopt;
+          return std::make_unique<MouseAxisMapper>(
+              (Mouse::EMouseAxis)operandA, (EAxisDirection)operandB);
+
+        case EOpcode::MouseButton:
+          if (operandA >= (uint32_t)Mouse::EMouseButton::Count) return std::nullopt;
+          return std::make_unique<MouseButtonMapper>((Mouse::EMouseButton)operandA);
+
+        case EOpcode::Pov:
+          if (operandA >= (uint32_t)EPovDirection::Count) return std::nullopt;
+          return std::make_unique<PovMapper>((EPovDirection)operandA);
+
+        case EOpcode::Invert:
+        {
+          if (operandA > (words.size() / kWordsPerInstruction)) return std::nullopt;
+
+          auto maybeElementMapper = DecodeBlock(words.first(operandA * kWordsPerInstruction));
+          if (false == maybeElementMapper.has_value()) return std::nullopt;
+
+          words = words.subspan(operandA * kWordsPerInstruction);
+          return std::make_unique<InvertMapper>(std::move(maybeElementMapper.value()));
+        }
+
+        case EOpcode::Split:
+        {
+          if ((operandA > (words.size() / kWordsPerInstruction)) ||
+              (operandB > ((words.size() / kWordsPerInstruction) - operandA)))
+            return std::nullopt;
+
+          auto maybePositiveMapper = DecodeBlock(words.first(operandA * kWordsPerInstruction));
+          if (false == maybePositiveMapper.has_value()) return std::nullopt;
+          words = words.subspan(operandA * kWordsPerInstruction);
+
+          auto maybeNegativeMapper = DecodeBlock(words.first(operandB * kWordsPerInstruction));
+          if (false == maybeNegativeMapper.has_value()) return std::nullopt;
+          words = words.subspan(operandB * kWordsPerInstruction);
+
+          return std::make_unique<SplitMapper>(
+              std::move(maybePositiveMapper.value()), std::move(maybeNegativeMapper.value()));
+        }
+
+        default:
+          return std::nullopt;
+      }
+    }
+
+    /// Decodes an entire block of serialized instructions into a single element mapper. Blocks
+    /// of more than one element mapper are the result of compiling compound element mappers, so
+    /// they are decoded back into compound element mappers.
+    /// @param [in] words Serialized instructions that make up the block.
+    /// @return Decoded element mapper, which is `nullptr` if the block is empty, or nothing if the
+    /// serialized instructions are invalid.
+    static std::optional<std::unique_ptr<IElementMapper>> DecodeBlock(
+        std::span<const uint32_t> words)
+    {
+      CompoundMapper::TElementMappers elementMappers;
+      size_t numElementMappers = 0;
+
+      while (false == words.empty())
+      {
+        if (numElementMappers == elementMappers.size()) return std::nullopt;
+
+        auto maybeElementMapper = DecodeElementMapper(words);
+        if (false == maybeElementMapper.has_value()) return std::nullopt;
+
+        elementMappers[numElementMappers++] = std::move(maybeElementMapper.value());
+      }
+
+      switch (numElementMappers)
+      {
+        case 0:
+          return nullptr;
+
+        case 1:
+          return std::move(elementMappers[0]);
+
+        default:
+          return std::make_unique<CompoundMapper>(std::move(elementMappers));
+      }
+    }
+
+    /// Parses the contents of a cache file and locates all of the element mappers it contains.
+    /// @param [in] contents Complete contents of the cache file.
+    /// @param [in] sourceHash Hash of the configuration file contents that must match the hash
+    /// stored in the cache file.
+    /// @param [out] elementMappers Filled with all of the element mappers in the cache file, which
+    /// continue to refer to the cache file contents.
+    /// @return `true` if the cache file is valid and matches the source hash, `false` otherwise.
+    static bool ParseCacheFile(
+        std::span<const uint8_t> contents,
+        uint64_t sourceHash,
+        std::unordered_map<std::wstring_view, std::span<const uint32_t>>& elementMappers)
+    {
+      if (contents.size() < sizeof(SCacheFileHeader)) return false;
+
+      const SCacheFileHeader& header = *((const SCacheFileHeader*)contents.data());
+      if ((kCacheFileMagic != header.magic) || (kCacheFileFormatVersion != header.formatVersion) ||
+          (sourceHash != header.sourceHash))
+        return false;
+
+      size_t offset = sizeof(SCacheFileHeader);
+      for (uint32_t i = 0; i < header.entryCount; ++i)
+      {
+        if ((contents.size() - offset) < sizeof(SCacheFileEntryHeader)) return false;
+
+        const SCacheFileEntryHeader& entryHeader =
+            *((const SCacheFileEntryHeader*)&contents[offset]);
+        offset += sizeof(SCacheFileEntryHeader);
+
+        const size_t stringSizeBytes = PaddedStringSizeBytes(entryHeader.stringLength);
+        const size_t serializedSizeBytes = (size_t)entryHeader.serializedLength * sizeof(uint32_t);
+        if ((contents.size() - offset) < (stringSizeBytes + serializedSizeBytes)) return false;
+
+        const std::wstring_view elementMapperString(
+            (const wchar_t*)&contents[offset], entryHeader.stringLength);
+        offset += stringSizeBytes;
+
+        const std::span<const uint32_t> serializedElementMapper(
+            (const uint32_t*)&contents[offset], entryHeader.serializedLength);
+        offset += serializedSizeBytes;
+
+        elementMappers.insert({elementMapperString, serializedElementMapper});
+      }
+
+      return true;
+    }
+
+    ElementMapperCache::ElementMapperCache(std::wstring_view cacheFilename, uint64_t sourceHash)
+        : cacheFilename(cacheFilename),
+          sourceHash(sourceHash),
+          cacheFileMapping(nullptr),
+          cacheFileView(nullptr),
+          loadedElementMappers(),
+          recordedElementMappers()
+    {
+      HANDLE cacheFile = CreateFile(
+          this->cacheFilename.c_str(),
+          GENERIC_READ,
+          FILE_SHARE_READ,
+          nullptr,
+          OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == cacheFile) return;
+
+      LARGE_INTEGER cacheFileSize = {};
+      if ((0 != GetFileSizeEx(cacheFile, &cacheFileSize)) &&
+          (cacheFileSize.QuadPart >= (LONGLONG)sizeof(SCacheFileHeader)) &&
+          (cacheFileSize.QuadPart <= (LONGLONG)kCacheFileMaxSizeBytes))
+        cacheFileMapping = CreateFileMapping(cacheFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+      CloseHandle(cacheFile);
+      if (nullptr == cacheFileMapping) return;
+
+      cacheFileView = MapViewOfFile(cacheFileMapping, FILE_MAP_READ, 0, 0, 0);
+      if ((nullptr == cacheFileView) ||
+          (false ==
+           ParseCacheFile(
+               std::span<const uint8_t>(
+                   (const uint8_t*)cacheFileView, (size_t)cacheFileSize.QuadPart),
+               sourceHash,
+               loadedElementMappers)))
+      {
+        CloseCacheFile();
+        return;
+      }
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Loaded %u element mapper(s) from cache file %s.",
+          (unsigned int)loadedElementMappers.size(),
+          this->cacheFilename.c_str());
+    }
+
+    ElementMapperCache::~ElementMapperCache(void)
+    {
+      CloseCacheFile();
+    }
+
+    void ElementMapperCache::CloseCacheFile(void)
+    {
+      loadedElementMappers.clear();
+
+      if (nullptr != cacheFileView)
+      {
+        UnmapViewOfFile(cacheFileView);
+        cacheFileView = nullptr;
+      }
+
+      if (nullptr != cacheFileMapping)
+      {
+        CloseHandle(cacheFileMapping);
+        cacheFileMapping = nullptr;
+      }
+    }
+
+    std::optional<uint64_t> ElementMapperCache::HashFileContents(std::wstring_view filename)
+    {
+      // FNV-1a, 64-bit variant.
+      constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+      constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+      HANDLE file = CreateFile(
+          filename.data(),
+          GENERIC_READ,
+          FILE_SHARE_READ | FILE_SHARE_WRITE,
+          nullptr,
+          OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == file) return std::nullopt;
+
+      uint64_t hash = kFnvOffsetBasis;
+      uint8_t buffer[4096];
+      DWORD numBytesRead = 0;
+      bool readSucceeded = true;
+
+      do
+      {
+        readSucceeded = (0 != ReadFile(file, buffer, sizeof(buffer), &numBytesRead, nullptr));
+        for (DWORD i = 0; i < numBytesRead; ++i)
+        {
+          hash ^= (uint64_t)buffer[i];
+          hash *= kFnvPrime;
+        }
+      } while ((true == readSucceeded) && (0 != numBytesRead));
+
+      CloseHandle(file);
+
+      if (false == readSucceeded) return std::nullopt;
+      return hash;
+    }
+
+    std::optional<std::unique_ptr<IElementMapper>> ElementMapperCache::DeserializeElementMapper(
+        std::span<const uint32_t> serializedElementMapper)
+    {
+      if (0 != (serializedElementMapper.size() % kWordsPerInstruction)) return std::nullopt;
+      return DecodeBlock(serializedElementMapper);
+    }
+
+    std::optional<ElementMapperCache::TSerializedElementMapper> ElementMapperCache::
+        SerializeElementMapper(const IElementMapper* elementMapper)
+    {
+      const ElementMapperProgram program(elementMapper);
+      const auto instructions = program.GetInstructions(0);
+
+      TSerializedElementMapper serializedElementMapper;
+      serializedElementMapper.reserve(instructions.size() * kWordsPerInstruction);
+
+      for (const auto& instruction : instructions)
+      {
+        const auto maybeEncodedInstruction = EncodeInstruction(instruction);
+        if (false == maybeEncodedInstruction.has_value()) return std::nullopt;
+
+        serializedElementMapper.insert(
+            serializedElementMapper.end(),
+            maybeEncodedInstruction->cbegin(),
+            maybeEncodedInstruction->cend());
+      }
+
+      // Compound element mappers are limited in how many element mappers they can hold, so make
+      // sure that whatever was serialized can actually be reconstructed.
+      if (false == DeserializeElementMapper(serializedElementMapper).has_value())
+        return std::nullopt;
+
+      return serializedElementMapper;
+    }
+
+    std::optional<std::unique_ptr<IElementMapper>> ElementMapperCache::Lookup(
+        std::wstring_view elementMapperString) const
+    {
+      const auto loadedElementMapper = loadedElementMappers.find(elementMapperString);
+      if (loadedElementMappers.cend() != loadedElementMapper)
+        return DeserializeElementMapper(loadedElementMapper->second);
+
+      const auto recordedElementMapper = recordedElementMappers.find(elementMapperString);
+      if (recordedElementMappers.cend() != recordedElementMapper)
+        return DeserializeElementMapper(recordedElementMapper->second);
+
+      return std::nullopt;
+    }
+
+    void ElementMapperCache::Record(
+        std::wstring_view elementMapperString, const IElementMapper* elementMapper)
+    {
+      auto maybeSerializedElementMapper = SerializeElementMapper(elementMapper);
+      if (false == maybeSerializedElementMapper.has_value()) return;
+
+      recordedElementMappers.insert_or_assign(
+          std::wstring(elementMapperString), std::move(maybeSerializedElementMapper.value()));
+    }
+
+    bool ElementMapperCache::Save(void)
+    {
+      if (true == recordedElementMappers.empty()) return true;
+
+      // Everything that was loaded is still valid, so it is carried over into the new cache file.
+      for (const auto& loadedElementMapper : loadedElementMappers)
+      {
+        recordedElementMappers.try_emplace(
+            std::wstring(loadedElementMapper.first),
+            loadedElementMapper.second.begin(),
+            loadedElementMapper.second.end());
+      }
+
+      CloseCacheFile();
+
+      std::vector<uint8_t> contents(sizeof(SCacheFileHeader));
+      *((SCacheFileHeader*)contents.data()) = {
+          .magic = kCacheFileMagic,
+          .formatVersion = kCacheFileFormatVersion,
+          .sourceHash = sourceHash,
+          .entryCount = (uint32_t)recordedElementMappers.size(),
+          .reserved = 0};
+
+      for (const auto& recordedElementMapper : recordedElementMappers)
+      {
+        const std::wstring& elementMapperString = recordedElementMapper.first;
+        const TSerializedElementMapper& serializedElementMapper = recordedElementMapper.second;
+
+        const SCacheFileEntryHeader entryHeader = {
+            .stringLength = (uint32_t)elementMapperString.length(),
+            .serializedLength = (uint32_t)serializedElementMapper.size()};
+        const size_t stringSizeBytes = PaddedStringSizeBytes(elementMapperString.length());
+        const size_t serializedSizeBytes = serializedElementMapper.size() * sizeof(uint32_t);
+
+        size_t offset = contents.size();
+        contents.resize(offset + sizeof(entryHeader) + stringSizeBytes + serializedSizeBytes, 0);
+
+        std::memcpy(&contents[offset], &entryHeader, sizeof(entryHeader));
+        offset += sizeof(entryHeader);
+
+        std::memcpy(
+            &contents[offset],
+            elementMapperString.data(),
+            elementMapperString.length() * sizeof(wchar_t));
+        offset += stringSizeBytes;
+
+        std::memcpy(&contents[offset], serializedElementMapper.data(), serializedSizeBytes);
+      }
+
+      // The new cache file is written in its entirety under a temporary name and then moved into
+      // place, so that a partially-written cache file is never observed.
+      const std::wstring temporaryCacheFilename = cacheFilename + L".tmp";
+      HANDLE cacheFile = CreateFile(
+          temporaryCacheFilename.c_str(),
+          GENERIC_WRITE,
+          0,
+          nullptr,
+          CREATE_ALWAYS,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == cacheFile)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to write element mapper cache file %s (last error = %u).",
+            cacheFilename.c_str(),
+            (unsigned int)GetLastError());
+        return false;
+      }
+
+      DWORD numBytesWritten = 0;
+      const bool writeSucceeded =
+          ((0 != WriteFile(cacheFile, contents.data(), (DWORD)contents.size(), &numBytesWritten,
+                           nullptr)) &&
+           (contents.size() == numBytesWritten));
+      CloseHandle(cacheFile);
+
+      if ((false == writeSucceeded) ||
+          (0 ==
+           MoveFileEx(
+               temporaryCacheFilename.c_str(), cacheFilename.c_str(), MOVEFILE_REPLACE_EXISTING)))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to write element mapper cache file %s (last error = %u).",
+            cacheFilename.c_str(),
+            (unsigned int)GetLastError());
+        DeleteFile(temporaryCacheFilename.c_str());
+        return false;
+      }
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Wrote %u element mapper(s) to cache file %s.",
+          (unsigned int)recordedElementMappers.size(),
+          cacheFilename.c_str());
+      return true;
+    }
+  } // namespace Controller
+} // namespace Xidi
@@ -15,6 +15,7 @@
 
 #include "ApiDirectInput.h"
 #include "DirectInputClassFactory.h"
+#include "Globals.h"
 #include "ImportApiDirectInput.h"
 #include "WrapperIDirectInput.h"
 
@@ -74,9 +75,61 @@ namespace Xidi
           Infra::Message::ESeverity::Info, L"Successfully created a DirectInput interface object.");
     }
 
+    /// Creates the system version 8 IDirectInput object that underlies a Xidi DirectInput
+    /// interface object. Invoked the first time the Xidi object needs it, if ever.
+    static HRESULT CreateSystemDirectInput8(
+        HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
+    {
+      const HRESULT result = ImportApiDirectInput::Version8::DirectInput8Create(
+          hinst, dwVersion, riidltf, ppvOut, punkOuter);
+      if (DI_OK != result) LogSystemCreateError(result);
+
+      return result;
+    }
+
+    /// Creates the system legacy ASCII IDirectInput object that underlies a Xidi DirectInput
+    /// interface object. Invoked the first time the Xidi object needs it, if ever. The interface
+    /// identifier is implied and therefore ignored.
+    static HRESULT CreateSystemDirectInputLegacyA(
+        HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
+    {
+      const HRESULT result = ImportApiDirectInput::VersionLegacy::DirectInputCreateA(
+          hinst, dwVersion, reinterpret_cast<LPDIRECTINPUTA*>(ppvOut), punkOuter);
+      if (DI_OK != result) LogSystemCreateError(result);
+
+      return result;
+    }
+
+    /// Creates the system legacy Unicode IDirectInput object that underlies a Xidi DirectInput
+    /// interface object. Invoked the first time the Xidi object needs it, if ever. The interface
+    /// identifier is implied and therefore ignored.
+    static HRESULT CreateSystemDirectInputLegacyW(
+        HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
+    {
+      const HRESULT result = ImportApiDirectInput::VersionLegacy::DirectInputCreateW(
+          hinst, dwVersion, reinterpret_cast<LPDIRECTINPUTW*>(ppvOut), punkOuter);
+      if (DI_OK != result) LogSystemCreateError(result);
+
+      return result;
+    }
+
+    /// Creates the system legacy IDirectInput object of the specified interface that underlies a
+    /// Xidi DirectInput interface object. Invoked the first time the Xidi object needs it, if ever.
+    static HRESULT CreateSystemDirectInputLegacyEx(
+        HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
+    {
+      const HRESULT result = ImportApiDirectInput::VersionLegacy::DirectInputCreateEx(
+          hinst, dwVersion, riidltf, ppvOut, punkOuter);
+      if (DI_OK != result) LogSystemCreateError(result);
+
+      return result;
+    }
+
     HRESULT __stdcall Version8DirectInput8Create(
         HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
     {
+      Globals::EnsureInitialized();
+
       void* diObject = nullptr;
 
       if (dwVersion < dinputVersion8Min || dwVersion > dinputVersion8Max)
@@ -91,31 +144,29 @@ namespace Xidi
         return DIERR_INVALIDPARAM;
       }
 
-      HRESULT result = ImportApiDirectInput::Version8::DirectInput8Create(
-          hinst, dwVersion, riidltf, &diObject, punkOuter);
-      if (DI_OK != result)
-      {
-        LogSystemCreateError(result);
-        return result;
-      }
+      // The system object is created only once the application makes a request that needs it.
+      const SUnderlyingDIObjectCreateParams createParams = {
+          .createFunc = &CreateSystemDirectInput8,
+          .hinst = hinst,
+          .dwVersion = dwVersion,
+          .riidltf = riidltf,
+          .punkOuter = punkOuter};
 
       if (IID_IDirectInput8W == riidltf)
-        diObject = new WrapperIDirectInput<EDirectInputVersion::k8W>(
-            reinterpret_cast<IDirectInput8W*>(diObject));
+        diObject = new WrapperIDirectInput<EDirectInputVersion::k8W>(createParams);
       else
-        diObject = new WrapperIDirectInput<EDirectInputVersion::k8A>(
-            reinterpret_cast<IDirectInput8A*>(diObject));
+        diObject = new WrapperIDirectInput<EDirectInputVersion::k8A>(createParams);
 
       *ppvOut = (LPVOID)diObject;
 
       LogSystemCreateSuccess();
-      return result;
+      return DI_OK;
     }
 
     HRESULT __stdcall VersionLegacyDirectInputCreateA(
         HINSTANCE hinst, DWORD dwVersion, LPDIRECTINPUTA* ppDI, LPUNKNOWN punkOuter)
     {
-      IDirectInputA* diObject = nullptr;
+      Globals::EnsureInitialized();
 
       if (dwVersion < dinputVersionLegacyMin || dwVersion > dinputVersionLegacyMax)
       {
@@ -123,26 +174,24 @@ namespace Xidi
         return E_FAIL;
       }
 
-      HRESULT result = ImportApiDirectInput::VersionLegacy::DirectInputCreateA(
-          hinst, dinputVersionLegacy, reinterpret_cast<LPDIRECTINPUTA*>(&diObject), punkOuter);
-      if (DI_OK != result)
-      {
-        LogSystemCreateError(result);
-        return result;
-      }
+      // The system object is created only once the application makes a request that needs it.
+      const SUnderlyingDIObjectCreateParams createParams = {
+          .createFunc = &CreateSystemDirectInputLegacyA,
+          .hinst = hinst,
+          .dwVersion = dinputVersionLegacy,
+          .riidltf = IID_IDirectInput7A,
+          .punkOuter = punkOuter};
 
-      diObject = new WrapperIDirectInput<EDirectInputVersion::kLegacyA>(
-          reinterpret_cast<IDirectInput7A*>(diObject));
-      *ppDI = (LPDIRECTINPUTA)diObject;
+      *ppDI = (LPDIRECTINPUTA) new WrapperIDirectInput<EDirectInputVersion::kLegacyA>(createParams);
 
       LogSystemCreateSuccess();
-      return result;
+      return DI_OK;
     }
 
     HRESULT __stdcall VersionLegacyDirectInputCreateW(
         HINSTANCE hinst, DWORD dwVersion, LPDIRECTINPUTW* ppDI, LPUNKNOWN punkOuter)
     {
-      IDirectInputW* diObject = nullptr;
+      Globals::EnsureInitialized();
 
       if (dwVersion < dinputVersionLegacyMin || dwVersion > dinputVersionLegacyMax)
       {
@@ -150,25 +199,25 @@ namespace Xidi
         return E_FAIL;
       }
 
-      HRESULT result = ImportApiDirectInput::VersionLegacy::DirectInputCreateW(
-          hinst, dinputVersionLegacy, reinterpret_cast<LPDIRECTINPUTW*>(&diObject), punkOuter);
-      if (DI_OK != result)
-      {
-        LogSystemCreateError(result);
-        return result;
-      }
+      // The system object is created only once the application makes a request that needs it.
+      const SUnderlyingDIObjectCreateParams createParams = {
+          .createFunc = &CreateSystemDirectInputLegacyW,
+          .hinst = hinst,
+          .dwVersion = dinputVersionLegacy,
+          .riidltf = IID_IDirectInput7W,
+          .punkOuter = punkOuter};
 
-      diObject = new WrapperIDirectInput<EDirectInputVersion::kLegacyW>(
-          reinterpret_cast<IDirectInput7W*>(diObject));
-      *ppDI = (LPDIRECTINPUTW)diObject;
+      *ppDI = (LPDIRECTINPUTW) new WrapperIDirectInput<EDirectInputVersion::kLegacyW>(createParams);
 
       LogSystemCreateSuccess();
-      return result;
+      return DI_OK;
     }
 
     HRESULT __stdcall VersionLegacyDirectInputCreateEx(
         HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
     {
+      Globals::EnsureInitialized();
+
       void* diObject = nullptr;
 
       if (dwVersion < dinputVersionLegacyMin || dwVersion > dinputVersionLegacyMax)
@@ -185,39 +234,24 @@ namespace Xidi
         return DIERR_INVALIDPARAM;
       }
 
-      HRESULT result;
-      BOOL useUnicode = FALSE;
+      // The system object is created only once the application makes a request that needs it.
+      const SUnderlyingDIObjectCreateParams createParams = {
+          .createFunc = &CreateSystemDirectInputLegacyEx,
+          .hinst = hinst,
+          .dwVersion = dinputVersionLegacy,
+          .riidltf = riidltf,
+          .punkOuter = punkOuter};
 
       if (IID_IDirectInputW == riidltf || IID_IDirectInput2W == riidltf ||
           IID_IDirectInput7W == riidltf)
-      {
-        useUnicode = TRUE;
-        result = ImportApiDirectInput::VersionLegacy::DirectInputCreateEx(
-            hinst, dinputVersionLegacy, riidltf, &diObject, punkOuter);
-      }
+        diObject = new WrapperIDirectInput<EDirectInputVersion::kLegacyW>(createParams);
       else
-      {
-        result = ImportApiDirectInput::VersionLegacy::DirectInputCreateEx(
-            hinst, dinputVersionLegacy, riidltf, &diObject, punkOuter);
-      }
-
-      if (DI_OK != result)
-      {
-        LogSystemCreateError(result);
-        return result;
-      }
-
-      if (TRUE == useUnicode)
-        diObject = new WrapperIDirectInput<EDirectInputVersion::kLegacyW>(
-            reinterpret_cast<IDirectInput7W*>(diObject));
-      else
-        diObject = new WrapperIDirectInput<EDirectInputVersion::kLegacyA>(
-            reinterpret_cast<IDirectInput7A*>(diObject));
+        diObject = new WrapperIDirectInput<EDirectInputVersion::kLegacyA>(createParams);
 
       *ppvOut = diObject;
 
       LogSystemCreateSuccess();
-      return result;
+      return DI_OK;
     }
 
     HRESULT __stdcall Version8DllRegisterServer(void)
@@ -252,6 +286,8 @@ namespace Xidi
 
     HRESULT __stdcall Version8DllGetClassObject(REFCLSID rclsid, REFIID riid, LPVOID* ppv)
     {
+      Globals::EnsureInitialized();
+
       if (DirectInputClassFactory::CanCreateObjectsOfClass(rclsid))
       {
         if (IsEqualIID(IID_IClassFactory, riid))
@@ -279,6 +315,8 @@ namespace Xidi
 
     HRESULT __stdcall VersionLegacyDllGetClassObject(REFCLSID rclsid, REFIID riid, LPVOID* ppv)
     {
+      Globals::EnsureInitialized();
+
       if (DirectInputClassFactory::CanCreateObjectsOfClass(rclsid))
       {
         if (IsEqualIID(IID_IClassFactory, riid))
@@ -0,0 +1,361 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file FlightRecorder.cpp
+ *   Implementation of an always-on, fixed-size, in-memory record of recent physical controller
+ *   states, API calls, and force feedback writes, which can be written to a file on demand for
+ *   diagnosing problems that cannot be reproduced with logging enabled.
+ **************************************************************************************************/
+
+#include "FlightRecorder.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <string_view>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace FlightRecorder
+  {
+    /// Number of 64-bit words in each record.
+    static constexpr size_t kRecordWordCount = sizeof(SRecord) / sizeof(uint64_t);
+
+    /// Index of the word in each record that holds the sequence number, which is written last and
+    /// read first so that records being written concurrently can be detected.
+    static constexpr size_t kSequenceWordIndex = offsetof(SRecord, sequence) / sizeof(uint64_t);
+
+    /// Offset within the event-specific data of API call records at which, while in memory, the
+    /// address of the function name is held in place of its name table index.
+    static constexpr size_t kFunctionNameOffset = offsetof(decltype(SRecord::apiCall), nameIndex);
+
+    static_assert(
+        (sizeof(const wchar_t*) + kFunctionNameOffset) <= sizeof(SRecord::apiCall),
+        "API call records do not have room for the address of a function name.");
+
+    /// Number of records written to a dump file at a time.
+    static constexpr size_t kDumpBatchSize = 256;
+
+    static_assert(
+        0 == (sizeof(SRecord) % sizeof(uint64_t)), "Records must consist of whole words.");
+
+    /// Storage for a single record in memory, protected by its own sequence number so that a dump
+    /// can be written without ever blocking any thread that is recording. Each slot starts at an
+    /// offset that keeps it within a single cache line.
+    struct alignas(sizeof(SRecord)) SRecordSlot
+    {
+      /// Contents of the record. While a record is being written its sequence number is zero.
+      std::atomic<uint64_t> words[kRecordWordCount];
+    };
+
+    /// Retained records, used as a ring.
+    static SRecordSlot recordSlots[kRecordCapacity];
+
+    /// Position in the sequence of all records of the next record to be written.
+    static std::atomic<uint64_t> nextRecordPosition = 0;
+
+    /// Set while a dump is being written, because the buffers used to write it are shared.
+    static std::atomic_flag dumpInProgress;
+
+    /// Records read from memory but not yet written to the dump file.
+    static SRecord dumpBatch[kDumpBatchSize];
+
+    /// Name table for the dump file being written.
+    static const wchar_t* dumpNames[kMaxNameCount];
+
+    /// File to be written if the process crashes, or `nullptr` if none.
+    static const wchar_t* crashDumpFilename = nullptr;
+
+    /// Unhandled exception filter that was installed before the one that writes a crash dump.
+    static LPTOP_LEVEL_EXCEPTION_FILTER previousUnhandledExceptionFilter = nullptr;
+
+    /// Computes the sequence number for the record at the specified position. Never zero, because
+    /// zero identifies a record that is being written.
+    /// @param [in] position Position of the record in the sequence of all records.
+    /// @return Sequence number of the record.
+    static inline uint32_t SequenceNumberForPosition(uint64_t position)
+    {
+      const uint32_t sequence = (uint32_t)position + 1;
+      return ((0 == sequence) ? 1 : sequence);
+    }
+
+    /// Appends a record to the ring, replacing the oldest one if the ring is full. The caller
+    /// fills in everything but the timestamp and the sequence number.
+    /// @param [in] record Record to append.
+    static void AppendRecord(SRecord record)
+    {
+      LARGE_INTEGER now;
+      QueryPerformanceCounter(&now);
+      record.timestamp = now.QuadPart;
+
+      const uint64_t position = nextRecordPosition.fetch_add(1, std::memory_order_relaxed);
+      record.sequence = SequenceNumberForPosition(position);
+
+      uint64_t recordWords[kRecordWordCount];
+      std::memcpy(recordWords, &record, sizeof(record));
+
+      SRecordSlot& slot = recordSlots[position % kRecordCapacity];
+      slot.words[kSequenceWordIndex].store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (size_t i = 0; i < kRecordWordCount; ++i)
+      {
+        if (kSequenceWordIndex != i) slot.words[i].store(recordWords[i], std::memory_order_relaxed);
+      }
+
+      slot.words[kSequenceWordIndex].store(
+          recordWords[kSequenceWordIndex], std::memory_order_release);
+    }
+
+    /// Reads the record at the specified position, unless it is being written or has already been
+    /// replaced by a newer one.
+    /// @param [in] position Position of the record in the sequence of all records.
+    /// @param [out] record Filled in with the contents of the record.
+    /// @return `true` if the record was read, `false` otherwise.
+    static bool ReadRecord(uint64_t position, SRecord& record)
+    {
+      const SRecordSlot& slot = recordSlots[position % kRecordCapacity];
+      uint64_t recordWords[kRecordWordCount];
+
+      const uint64_t sequenceWord = slot.words[kSequenceWordIndex].load(std::memory_order_acquire);
+      for (size_t i = 0; i < kRecordWordCount; ++i)
+        recordWords[i] = slot.words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (sequenceWord != slot.words[kSequenceWordIndex].load(std::memory_order_relaxed))
+        return false;
+
+      std::memcpy(&record, recordWords, sizeof(record));
+      return (SequenceNumberForPosition(position) == record.sequence);
+    }
+
+    /// Determines the name table index for the specified function name, adding it to the name
+    /// table if it is not already present. Names are compared by content because the same name
+    /// can be stored at several addresses.
+    /// @param [in] functionName Function name to look up.
+    /// @param [in,out] nameCount Number of entries in the name table.
+    /// @return Name table index, or #kNameIndexUnknown if the name table is full.
+    static uint16_t NameIndexForFunctionName(const wchar_t* functionName, uint32_t& nameCount)
+    {
+      for (uint32_t i = 0; i < nameCount; ++i)
+      {
+        if ((dumpNames[i] == functionName) || (0 == std::wcscmp(dumpNames[i], functionName)))
+          return (uint16_t)i;
+      }
+
+      if (nameCount >= kMaxNameCount) return kNameIndexUnknown;
+
+      dumpNames[nameCount] = functionName;
+      return (uint16_t)(nameCount++);
+    }
+
+    /// Writes the specified data to a file.
+    /// @param [in] file Handle to the file.
+    /// @param [in] data Data to write.
+    /// @param [in] size Number of bytes to write.
+    /// @return `true` if all of the data was written, `false` otherwise.
+    static bool WriteToFile(HANDLE file, const void* data, DWORD size)
+    {
+      DWORD numBytesWritten = 0;
+      return ((0 != WriteFile(file, data, size, &numBytesWritten, nullptr)) &&
+              (size == numBytesWritten));
+    }
+
+    /// Writes all retained records and the resulting name table to an open dump file, following
+    /// a file header that is filled in but still needs to be written.
+    /// @param [in] file Handle to the dump file, positioned just past the space for the header.
+    /// @param [out] fileHeader Filled in with the number of records and names written.
+    /// @return `true` if successful, `false` otherwise.
+    static bool WriteRecordsAndNames(HANDLE file, SFileHeader& fileHeader)
+    {
+      const uint64_t endPosition = nextRecordPosition.load(std::memory_order_acquire);
+      const uint64_t beginPosition =
+          ((endPosition > kRecordCapacity) ? (endPosition - kRecordCapacity) : 0);
+
+      size_t dumpBatchCount = 0;
+
+      for (uint64_t position = beginPosition; position < endPosition; ++position)
+      {
+        SRecord& record = dumpBatch[dumpBatchCount];
+        if (false == ReadRecord(position, record)) continue;
+
+        if ((uint8_t)ERecordType::ApiCall == record.type)
+        {
+          const wchar_t* functionName = nullptr;
+          std::memcpy(
+              &functionName,
+              reinterpret_cast<const uint8_t*>(&record.apiCall) + kFunctionNameOffset,
+              sizeof(functionName));
+          const uint32_t objectId = record.apiCall.objectId;
+          const uint32_t result = record.apiCall.result;
+
+          record.apiCall = {
+              .objectId = objectId,
+              .result = result,
+              .nameIndex =
+                  ((nullptr == functionName)
+                       ? kNameIndexUnknown
+                       : NameIndexForFunctionName(functionName, fileHeader.nameCount))};
+        }
+
+        fileHeader.recordCount += 1;
+        dumpBatchCount += 1;
+
+        if (kDumpBatchSize == dumpBatchCount)
+        {
+          if (false == WriteToFile(file, dumpBatch, (DWORD)sizeof(dumpBatch))) return false;
+          dumpBatchCount = 0;
+        }
+      }
+
+      if ((0 != dumpBatchCount) &&
+          (false == WriteToFile(file, dumpBatch, (DWORD)(dumpBatchCount * sizeof(SRecord)))))
+        return false;
+
+      for (uint32_t i = 0; i < fileHeader.nameCount; ++i)
+      {
+        const uint16_t nameLength = (uint16_t)std::wcslen(dumpNames[i]);
+        if ((false == WriteToFile(file, &nameLength, sizeof(nameLength))) ||
+            (false == WriteToFile(file, dumpNames[i], (DWORD)(nameLength * sizeof(wchar_t)))))
+          return false;
+      }
+
+      return true;
+    }
+
+    /// Writes a crash dump and then invokes the previously-installed unhandled exception filter.
+    /// @param [in] exceptionInfo Information about the unhandled exception.
+    /// @return Result of the previously-installed unhandled exception filter, if there is one, or
+    /// `EXCEPTION_CONTINUE_SEARCH` otherwise.
+    static LONG __stdcall DumpOnCrashUnhandledExceptionFilter(EXCEPTION_POINTERS* exceptionInfo)
+    {
+      DumpToFile(crashDumpFilename);
+
+      if (nullptr != previousUnhandledExceptionFilter)
+        return previousUnhandledExceptionFilter(exceptionInfo);
+
+      return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    void RecordPhysicalState(
+        Controller::TControllerIdentifier controllerIdentifier,
+        const Controller::SPhysicalState& physicalState)
+    {
+      SRecord record = {
+          .type = (uint8_t)ERecordType::PhysicalState,
+          .controllerIdentifier = (uint8_t)controllerIdentifier};
+      record.physicalState = {
+          .deviceStatus = (uint8_t)physicalState.deviceStatus,
+          .trigger = {physicalState.trigger[0], physicalState.trigger[1]},
+          .buttons = (uint16_t)physicalState.button.to_ulong(),
+          .stick = {
+              physicalState.stick[0],
+              physicalState.stick[1],
+              physicalState.stick[2],
+              physicalState.stick[3]}};
+
+      AppendRecord(record);
+    }
+
+    void RecordApiCall(
+        const wchar_t* functionName,
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint32_t objectId,
+        uint32_t result)
+    {
+      SRecord record = {
+          .type = (uint8_t)ERecordType::ApiCall,
+          .controllerIdentifier = (uint8_t)controllerIdentifier};
+      record.apiCall = {.objectId = objectId, .result = result};
+      std::memcpy(
+          reinterpret_cast<uint8_t*>(&record.apiCall) + kFunctionNameOffset,
+          &functionName,
+          sizeof(functionName));
+
+      AppendRecord(record);
+    }
+
+    void RecordForceFeedbackWrite(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint16_t leftMotorSpeed,
+        uint16_t rightMotorSpeed,
+        DWORD result)
+    {
+      SRecord record = {
+          .type = (uint8_t)ERecordType::ForceFeedbackWrite,
+          .controllerIdentifier = (uint8_t)controllerIdentifier};
+      record.forceFeedbackWrite = {
+          .motorSpeed = {leftMotorSpeed, rightMotorSpeed}, .result = (uint32_t)result};
+
+      AppendRecord(record);
+    }
+
+    bool DumpToFile(std::wstring_view filename)
+    {
+      if ((true == filename.empty()) || (true == dumpInProgress.test_and_set()))
+        return false;
+
+      HANDLE file = CreateFile(
+          filename.data(),
+          GENERIC_WRITE,
+          FILE_SHARE_READ,
+          nullptr,
+          CREATE_ALWAYS,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == file)
+      {
+        dumpInProgress.clear();
+        return false;
+      }
+
+      LARGE_INTEGER performanceCounterFrequency = {};
+      QueryPerformanceFrequency(&performanceCounterFrequency);
+
+      SFileHeader fileHeader = {
+          .magic = kFileMagic,
+          .version = kFileVersion,
+          .recordSize = (uint16_t)sizeof(SRecord),
+          .performanceCounterFrequency = performanceCounterFrequency.QuadPart};
+
+      // The header is written twice, first to reserve space for it and then again once the
+      // number of records and names is known.
+      const LARGE_INTEGER fileBeginning = {};
+      const bool dumpSucceeded =
+          ((true == WriteToFile(file, &fileHeader, sizeof(fileHeader))) &&
+           (true == WriteRecordsAndNames(file, fileHeader)) &&
+           (0 != SetFilePointerEx(file, fileBeginning, nullptr, FILE_BEGIN)) &&
+           (true == WriteToFile(file, &fileHeader, sizeof(fileHeader))));
+
+      CloseHandle(file);
+      dumpInProgress.clear();
+
+      return dumpSucceeded;
+    }
+
+    void DumpOnCrash(std::wstring_view filename)
+    {
+      if ((true == filename.empty()) || (nullptr != crashDumpFilename)) return;
+
+      crashDumpFilename = filename.data();
+      previousUnhandledExceptionFilter =
+          SetUnhandledExceptionFilter(&DumpOnCrashUnhandledExceptionFilter);
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Flight recorder will write to %s if this process crashes.",
+          crashDumpFilename);
+    }
+  } // namespace FlightRecorder
+} // namespace Xidi
@@ -12,8 +12,12 @@
 
 #include "ForceFeedbackDevice.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <utility>
 
 #include "ForceFeedbackEffect.h"
 #include "ForceFeedbackTypes.h"
@@ -39,162 +43,562 @@ namespace Xidi
             timestampBase;
       }
 
+      /// Updates the supplied earliest timestamp if the supplied candidate timestamp comes before
+      /// it or if there is no earliest timestamp yet.
+      /// @param [in,out] earliestTimestamp Earliest timestamp seen so far, if any.
+      /// @param [in] candidateTimestamp Timestamp to be considered.
+      static inline void UpdateEarliestTimestamp(
+          std::optional<TEffectTimeMs>& earliestTimestamp, TEffectTimeMs candidateTimestamp)
+      {
+        if ((false == earliestTimestamp.has_value()) || (candidateTimestamp < *earliestTimestamp))
+          earliestTimestamp = candidateTimestamp;
+      }
+
       Device::Device(void) : Device(ImportApiWinMM::timeGetTime()) {}
 
       Device::Device(TEffectTimeMs timestampBase)
-          : mutex(),
-            readyEffects(),
-            playingEffects(),
+          : commandMutex(L"ForceFeedback::Device::commandMutex"),
+            effectSlotIdentifiers(),
+            effectSlotIndex(),
+            effectSlotPlayingStates(),
+            occupiedSlots(),
+            startedSlots(),
+            stagedEffects(),
+            countTotalEffects(0),
+            countUnappliedStartCommands(0),
+            pendingCommands(nullptr),
+            commandGeneration(0),
+            mutex(L"ForceFeedback::Device::mutex"),
+            effectSlots(),
+            playingSlots(),
+            publishedPlayingSlots(),
+            countPlayingEffects(0),
             stateEffectsAreMuted(),
             stateEffectsArePaused(),
+            averagingWindowMaximum(),
             timestampBase(timestampBase),
-            timestampRelativeLastPlay()
-      {}
+            timestampRelativeLastPlay(),
+            timestampRelativeNextTransition(),
+            timestampRelativeNextChange(),
+            lastPlaybackResult(),
+            lastPlaybackResultIsReusable()
+      {
+        effectSlotIndex.fill(kEffectSlotIndexEmpty);
+      }
+
+      Device::~Device(void)
+      {
+        SCommand* command = pendingCommands.exchange(nullptr, std::memory_order_acquire);
+        while (nullptr != command)
+        {
+          SCommand* const nextCommand = command->next;
+          delete command;
+          command = nextCommand;
+        }
+      }
 
       bool Device::AddOrUpdateEffect(const Effect& effect)
       {
-        std::unique_lock lock(mutex);
+        std::scoped_lock lock(commandMutex);
 
-        auto playingEffectIter = playingEffects.find(effect.Identifier());
-        if (playingEffects.end() != playingEffectIter)
-          return playingEffectIter->second.effect->SyncParametersFrom(effect);
+        std::optional<TEffectSlot> slot = FindEffectSlot(effect.Identifier());
+        if (true == slot.has_value())
+        {
+          if (true == startedSlots.contains(*slot))
+          {
+            EnqueueCommand(std::unique_ptr<SCommand>(new SCommand(
+                {.type = ECommandType::Update, .slot = *slot, .effect = effect.Clone()})));
+          }
+          else if (nullptr != stagedEffects[*slot])
+          {
+            stagedEffects[*slot]->SyncParametersFrom(effect);
+          }
+          else
+          {
+            stagedEffects[*slot] = effect.Clone();
+          }
+
+          return true;
+        }
 
-        auto readyEffectIter = readyEffects.find(effect.Identifier());
-        if (readyEffects.end() != readyEffectIter)
-          return readyEffectIter->second.effect->SyncParametersFrom(effect);
+        if (occupiedSlots.size() >= kEffectMaxCount) return false;
 
-        if ((playingEffects.size() + readyEffects.size()) >= kEffectMaxCount) return false;
+        TEffectSlot freeSlot = 0;
+        while (true == occupiedSlots.contains(freeSlot))
+          freeSlot += 1;
 
-        readyEffects.emplace(std::make_pair(effect.Identifier(), effect.Clone()));
+        effectSlotIdentifiers[freeSlot] = effect.Identifier();
+        InsertEffectSlotIndex(effect.Identifier(), freeSlot);
+        effectSlotPlayingStates[freeSlot] = effect.PlayingState();
+        occupiedSlots.insert(freeSlot);
+        startedSlots.erase(freeSlot);
+        stagedEffects[freeSlot] = nullptr;
+        countTotalEffects.store((unsigned int)occupiedSlots.size(), std::memory_order_release);
 
+        EnqueueCommand(std::unique_ptr<SCommand>(new SCommand(
+            {.type = ECommandType::Add, .slot = freeSlot, .effect = effect.Clone()})));
         return true;
       }
 
+      void Device::ApplyPendingCommands(void)
+      {
+        SCommand* pendingCommandList = pendingCommands.exchange(nullptr, std::memory_order_acquire);
+        if (nullptr == pendingCommandList) return;
+
+        lastPlaybackResultIsReusable = false;
+        unsigned int countAppliedStartCommands = 0;
+
+        // Commands are pushed onto the front of the list as they are enqueued, so the list must be
+        // reversed to apply them in the order in which they were enqueued.
+        SCommand* orderedCommandList = nullptr;
+        while (nullptr != pendingCommandList)
+        {
+          SCommand* const nextCommand = pendingCommandList->next;
+          pendingCommandList->next = orderedCommandList;
+          orderedCommandList = pendingCommandList;
+          pendingCommandList = nextCommand;
+        }
+
+        while (nullptr != orderedCommandList)
+        {
+          std::unique_ptr<SCommand> command(orderedCommandList);
+          orderedCommandList = command->next;
+
+          switch (command->type)
+          {
+            case ECommandType::Add:
+              effectSlots[command->slot] = {.effect = std::move(command->effect)};
+              playingSlots.erase(command->slot);
+              break;
+
+            case ECommandType::Update:
+              effectSlots[command->slot].effect->SyncParametersFrom(*command->effect);
+              break;
+
+            case ECommandType::Start:
+              effectSlots[command->slot].startTime =
+                  RelativeTimestamp(timestampBase, command->timestamp) +
+                  effectSlots[command->slot].effect->GetStartDelay();
+              effectSlots[command->slot].numIterationsLeft = command->numIterations - 1;
+              playingSlots.insert(command->slot);
+              publishedPlayingSlots.erase(command->slot);
+              countAppliedStartCommands += 1;
+              break;
+
+            case ECommandType::Stop:
+              playingSlots.erase(command->slot);
+              break;
+
+            case ECommandType::StopAll:
+              playingSlots.clear();
+              break;
+
+            case ECommandType::Remove:
+              effectSlots[command->slot].effect->PlayingState()->store(
+                  false, std::memory_order_release);
+              effectSlots[command->slot].effect = nullptr;
+              playingSlots.erase(command->slot);
+              publishedPlayingSlots.erase(command->slot);
+              break;
+          }
+        }
+
+        // Applied start commands are only discounted once the effects they started have been
+        // published as playing, so that there is no window during which neither is counted.
+        PublishPlaybackStatus();
+        if (0 != countAppliedStartCommands)
+          countUnappliedStartCommands.fetch_sub(
+              countAppliedStartCommands, std::memory_order_release);
+      }
+
+      void Device::Clear(void)
+      {
+        std::scoped_lock lock(commandMutex, mutex);
+
+        // Pending commands would only change effects that are about to be cleared anyway, so they
+        // are applied just so that they are released.
+        ApplyPendingCommands();
+
+        for (auto slot : occupiedSlots)
+        {
+          effectSlotPlayingStates[slot]->store(false, std::memory_order_release);
+          effectSlotPlayingStates[slot] = nullptr;
+          effectSlots[slot].effect = nullptr;
+          stagedEffects[slot] = nullptr;
+        }
+
+        effectSlotIndex.fill(kEffectSlotIndexEmpty);
+        occupiedSlots.clear();
+        startedSlots.clear();
+        playingSlots.clear();
+        publishedPlayingSlots.clear();
+        countTotalEffects.store(0, std::memory_order_release);
+        countPlayingEffects.store(0, std::memory_order_release);
+        stateEffectsAreMuted = false;
+        stateEffectsArePaused = false;
+        timestampRelativeNextTransition = std::nullopt;
+        lastPlaybackResultIsReusable = false;
+      }
+
+      void Device::EnqueueCommand(std::unique_ptr<SCommand> command)
+      {
+        SCommand* const newCommand = command.release();
+        newCommand->next = pendingCommands.load(std::memory_order_relaxed);
+        while (false ==
+               pendingCommands.compare_exchange_weak(
+                   newCommand->next,
+                   newCommand,
+                   std::memory_order_release,
+                   std::memory_order_relaxed))
+          ;
+          ;
+
+        commandGeneration.fetch_add(1, std::memory_order_release);
+        commandGeneration.notify_all();
+      }
+
+      void Device::EraseEffectSlotIndex(TEffectIdentifier id)
+      {
+        unsigned int hole = EffectSlotIndexHome(id);
+        while (id != effectSlotIdentifiers[effectSlotIndex[hole]])
+          hole = (hole + 1) & (kEffectSlotIndexSize - 1);
+
+        // Entries after the hole are moved back into it unless that would place them before their
+        // home entries, in which case they could no longer be found.
+        for (unsigned int entry = (hole + 1) & (kEffectSlotIndexSize - 1);
+             kEffectSlotIndexEmpty != effectSlotIndex[entry];
+             entry = (entry + 1) & (kEffectSlotIndexSize - 1))
+        {
+          const unsigned int home =
+              EffectSlotIndexHome(effectSlotIdentifiers[effectSlotIndex[entry]]);
+          const unsigned int distanceFromHomeToEntry = (entry - home) & (kEffectSlotIndexSize - 1);
+          const unsigned int distanceFromHoleToEntry = (entry - hole) & (kEffectSlotIndexSize - 1);
+
+          if (distanceFromHomeToEntry >= distanceFromHoleToEntry)
+          {
+            effectSlotIndex[hole] = effectSlotIndex[entry];
+            hole = entry;
+          }
+        }
+
+        effectSlotIndex[hole] = kEffectSlotIndexEmpty;
+      }
+
+      std::optional<Device::TEffectSlot> Device::FindEffectSlot(TEffectIdentifier id) const
+      {
+        for (unsigned int entry = EffectSlotIndexHome(id);
+             kEffectSlotIndexEmpty != effectSlotIndex[entry];
+             entry = (entry + 1) & (kEffectSlotIndexSize - 1))
+        {
+          if (id == effectSlotIdentifiers[effectSlotIndex[entry]]) return effectSlotIndex[entry];
+        }
+
+        return std::nullopt;
+      }
+
+      std::optional<TEffectTimeMs> Device::GetTimeUntilNextTransition(void)
+      {
+        std::unique_lock lock(mutex);
+
+        if ((true == stateEffectsArePaused) ||
+            (false == timestampRelativeNextTransition.has_value()))
+          return std::nullopt;
+
+        return *timestampRelativeNextTransition - timestampRelativeLastPlay;
+      }
+
+      unsigned int Device::GetCountPlayingEffects(void)
+      {
+        std::unique_lock lock(mutex);
+        ApplyPendingCommands();
+
+        return (unsigned int)playingSlots.size();
+      }
+
+      void Device::InsertEffectSlotIndex(TEffectIdentifier id, TEffectSlot slot)
+      {
+        unsigned int entry = EffectSlotIndexHome(id);
+        while (kEffectSlotIndexEmpty != effectSlotIndex[entry])
+          entry = (entry + 1) & (kEffectSlotIndexSize - 1);
+
+        effectSlotIndex[entry] = slot;
+      }
+
+      bool Device::IsDeviceIdle(void)
+      {
+        std::unique_lock lock(mutex);
+        return (
+            (true == playingSlots.empty()) &&
+            (nullptr == pendingCommands.load(std::memory_order_acquire)));
+      }
+
       bool Device::IsEffectPlaying(TEffectIdentifier id)
       {
-        std::shared_lock lock(mutex);
+        std::scoped_lock lock(commandMutex, mutex);
+        ApplyPendingCommands();
 
-        auto playingEffectIter = playingEffects.find(id);
-        if (playingEffects.end() == playingEffectIter) return false;
+        const std::optional<TEffectSlot> slot = FindEffectSlot(id);
+        if ((false == slot.has_value()) || (false == playingSlots.contains(*slot))) return false;
 
         // This last check filters out effects that are pending playback but have not yet officially
         // started due to a start delay.
-        return (timestampRelativeLastPlay >= playingEffectIter->second.startTime);
+        return (timestampRelativeLastPlay >= effectSlots[*slot].startTime);
       }
 
-      TOrderedMagnitudeComponents Device::PlayEffects(std::optional<TEffectTimeMs> timestamp)
+      TOrderedMagnitudeComponents Device::PlayEffects(
+          const SConditionInput& conditionInput, std::optional<TEffectTimeMs> timestamp)
       {
         std::unique_lock lock(mutex);
 
         const TEffectTimeMs relativeTimestampPlayback = RelativeTimestamp(timestampBase, timestamp);
 
+        // Time does not advance while paused. The timestamp base is adjusted before pending
+        // commands are applied so that effects started while paused begin at the point in time at
+        // which playback was paused, even if playback was not invoked for a while beforehand
+        // because the device was idle.
         if (true == stateEffectsArePaused)
-        {
           timestampBase += (relativeTimestampPlayback - timestampRelativeLastPlay);
-          return {};
+
+        ApplyPendingCommands();
+
+        if (true == stateEffectsArePaused) return {};
+
+        // Between change points every playing effect produces exactly the same output as it did
+        // during the previous playback operation, so there is no need to evaluate any of them.
+        if ((true == lastPlaybackResultIsReusable) &&
+            (relativeTimestampPlayback >= timestampRelativeLastPlay) &&
+            ((false == timestampRelativeNextChange.has_value()) ||
+             (relativeTimestampPlayback < *timestampRelativeNextChange)))
+        {
+          timestampRelativeLastPlay = relativeTimestampPlayback;
+          return lastPlaybackResult;
         }
 
+        // Output is averaged over the time since the previous playback operation so that nothing
+        // that happened in between is missed.
+        TEffectTimeMs averagingWindow = 1;
+        if (relativeTimestampPlayback > timestampRelativeLastPlay)
+          averagingWindow = std::clamp(
+              relativeTimestampPlayback - timestampRelativeLastPlay,
+              (TEffectTimeMs)1,
+              std::max((TEffectTimeMs)1, averagingWindowMaximum));
+
         timestampRelativeLastPlay = relativeTimestampPlayback;
 
         TOrderedMagnitudeComponents playbackResult = {};
+        TEffectSlotSet finishedSlots;
+        std::optional<TEffectTimeMs> nextTransition;
+        std::optional<TEffectTimeMs> nextChange;
+        bool conditionEffectIsPlaying = false;
+        bool averagedOutputIsStable = true;
 
-        auto playingEffectIter = playingEffects.begin();
-        while (playingEffectIter != playingEffects.end())
+        for (auto slot : playingSlots)
         {
-          SEffectData& effectData = playingEffectIter->second;
+          SEffectData& effectData = effectSlots[slot];
 
-          // Effects with start delays would be added to the playing effects data structure with
-          // start times in the future. This check skips playback of effects that have not
-          // officially started playing due to a start delay parameter.
-          if (relativeTimestampPlayback >= effectData.startTime)
+          // Effects with start delays would be marked as playing with start times in the future.
+          // This check skips playback of effects that have not officially started playing due to a
+          // start delay parameter.
+          if (relativeTimestampPlayback < effectData.startTime)
           {
-            const TEffectTimeMs effectPlayTime = relativeTimestampPlayback - effectData.startTime;
+            UpdateEarliestTimestamp(nextTransition, effectData.startTime);
+            continue;
+          }
+
+          TEffectTimeMs effectPlayTime = relativeTimestampPlayback - effectData.startTime;
 
-            if (effectPlayTime >= effectData.effect->GetDuration())
+          if (effectPlayTime >= effectData.effect->GetDuration())
+          {
+            // An iteration of the effect has finished playing.
+            // If there are iterations left then repeat the effect, otherwise remove it from
+            // playback. Removal is deferred until iteration is complete so that the set being
+            // iterated is not modified.
+            if (effectData.numIterationsLeft > 0)
             {
-              // An iteration of the effect has finished playing.
-              // If there are iterations left then repeat the effect, otherwise remove it from
-              // playback.
-              if (effectData.numIterationsLeft > 0)
-              {
-                effectData.numIterationsLeft -= 1;
-                effectData.startTime = relativeTimestampPlayback;
-
-                if (false == stateEffectsAreMuted)
-                  playbackResult += effectData.effect->ComputeOrderedMagnitudeComponents(0);
-              }
-              else
-              {
-                // As soon as the playing effect is removed from its container the iterator is
-                // invalidated. Therefore, move on to the next effect before removing it. This path
-                // is the only one that bypasses the auto-increment that occurs at the end of a loop
-                // iteration.
-                auto finishedEffectIter = playingEffectIter++;
-                readyEffects.insert(playingEffects.extract(finishedEffectIter));
-                continue;
-              }
+              effectData.numIterationsLeft -= 1;
+              effectData.startTime = relativeTimestampPlayback;
+              effectPlayTime = 0;
             }
             else
             {
-              // Effect is currently playing.
-              // This is as simple as computing its magnitude components and adding them to the
-              // result.
-              if (false == stateEffectsAreMuted)
-                playbackResult +=
-                    effectData.effect->ComputeOrderedMagnitudeComponents(effectPlayTime);
+              finishedSlots.insert(slot);
+              continue;
             }
           }
 
-          ++playingEffectIter;
+          // Effect is currently playing.
+          // This is as simple as computing its magnitude components and adding them to the result.
+          if (true == effectData.effect->IsConditionEffect())
+          {
+            conditionEffectIsPlaying = true;
+
+            if (false == stateEffectsAreMuted)
+              playbackResult += effectData.effect->ComputeOrderedMagnitudeComponents(
+                  effectPlayTime, conditionInput);
+          }
+          else if (averagingWindow > 1)
+          {
+            // Averaging windows never reach back before the start of the current iteration.
+            const TEffectTimeMs averagingStartTime =
+                (effectPlayTime + 1) - std::min(averagingWindow, effectPlayTime + 1);
+            if (effectData.effect->ComputeMagnitudeStableUntil(averagingStartTime) <=
+                effectPlayTime)
+              averagedOutputIsStable = false;
+
+            if (false == stateEffectsAreMuted)
+              playbackResult += effectData.effect->ComputeAverageOrderedMagnitudeComponents(
+                  averagingStartTime, effectPlayTime + 1);
+          }
+          else
+          {
+            if (false == stateEffectsAreMuted)
+              playbackResult +=
+                  effectData.effect->ComputeOrderedMagnitudeComponents(effectPlayTime);
+          }
+
+          UpdateEarliestTimestamp(
+              nextTransition, effectData.startTime + effectData.effect->GetDuration().value());
+
+          // Each effect reports how long its output stays the same, such as throughout the sustain
+          // portion of an envelope, so that the combined output can be reused until then.
+          UpdateEarliestTimestamp(
+              nextChange,
+              effectData.startTime +
+                  effectData.effect->ComputeMagnitudeStableUntil(effectPlayTime));
         }
 
+        for (auto slot : finishedSlots)
+          playingSlots.erase(slot);
+
+        if (true == nextTransition.has_value())
+          UpdateEarliestTimestamp(nextChange, *nextTransition);
+
+        timestampRelativeNextTransition = nextTransition;
+        timestampRelativeNextChange = nextChange;
+        lastPlaybackResult = playbackResult;
+        lastPlaybackResultIsReusable =
+            ((false == conditionEffectIsPlaying) && (true == averagedOutputIsStable));
+
+        PublishPlaybackStatus();
         return playbackResult;
       }
 
+      void Device::PublishPlaybackStatus(void)
+      {
+        TEffectSlotSet currentPlayingSlots;
+
+        // Effects that are still in their start delay period are not yet considered playing, to
+        // match what is reported for individual effects when queried directly.
+        for (auto slot : playingSlots)
+        {
+          if (timestampRelativeLastPlay >= effectSlots[slot].startTime)
+            currentPlayingSlots.insert(slot);
+        }
+
+        for (auto slot : publishedPlayingSlots)
+        {
+          if (false == currentPlayingSlots.contains(slot))
+            effectSlots[slot].effect->PlayingState()->store(false, std::memory_order_release);
+        }
+
+        // Only transitions are published. Stopping an effect clears its playing state directly, so
+        // an effect that is already published as playing must not be marked as playing again in
+        // case it was stopped after pending commands were applied. Starting an effect removes it
+        // from the published set so that it is published again.
+        for (auto slot : currentPlayingSlots)
+        {
+          if (false == publishedPlayingSlots.contains(slot))
+            effectSlots[slot].effect->PlayingState()->store(true, std::memory_order_release);
+        }
+
+        publishedPlayingSlots = currentPlayingSlots;
+        countPlayingEffects.store((unsigned int)playingSlots.size(), std::memory_order_release);
+      }
+
       bool Device::StartEffect(
           TEffectIdentifier id, unsigned int numIterations, std::optional<TEffectTimeMs> timestamp)
       {
         if (0 == numIterations) return true;
 
-        std::unique_lock lock(mutex);
+        std::scoped_lock lock(commandMutex);
+
+        const std::optional<TEffectSlot> slot = FindEffectSlot(id);
+        if (false == slot.has_value()) return false;
 
-        auto readyEffectIter = readyEffects.find(id);
-        if (readyEffects.end() == readyEffectIter) return false;
+        startedSlots.insert(*slot);
+        countUnappliedStartCommands.fetch_add(1, std::memory_order_acq_rel);
 
-        readyEffectIter->second.startTime = RelativeTimestamp(timestampBase, timestamp) +
-            readyEffectIter->second.effect->GetStartDelay();
-        readyEffectIter->second.numIterationsLeft = numIterations - 1;
+        if (nullptr != stagedEffects[*slot])
+        {
+          EnqueueCommand(std::unique_ptr<SCommand>(new SCommand(
+              {.type = ECommandType::Update,
+               .slot = *slot,
+               .effect = std::move(stagedEffects[*slot])})));
+        }
 
-        return playingEffects.insert(readyEffects.extract(readyEffectIter)).inserted;
+        EnqueueCommand(std::unique_ptr<SCommand>(new SCommand(
+            {.type = ECommandType::Start,
+             .slot = *slot,
+             .numIterations = numIterations,
+             .timestamp = timestamp.value_or(ImportApiWinMM::timeGetTime())})));
+        return true;
       }
 
       void Device::StopAllEffects(void)
       {
-        std::unique_lock lock(mutex);
+        std::scoped_lock lock(commandMutex);
 
-        while (false == playingEffects.empty())
-          readyEffects.insert(playingEffects.extract(playingEffects.cbegin()));
+        for (auto slot : startedSlots)
+          effectSlotPlayingStates[slot]->store(false, std::memory_order_release);
+
+        startedSlots.clear();
+        EnqueueCommand(std::unique_ptr<SCommand>(new SCommand({.type = ECommandType::StopAll})));
       }
 
       bool Device::StopEffect(TEffectIdentifier id)
       {
-        std::unique_lock lock(mutex);
+        std::scoped_lock lock(commandMutex);
 
-        auto playingEffectIter = playingEffects.find(id);
-        if (playingEffects.end() == playingEffectIter) return false;
+        const std::optional<TEffectSlot> slot = FindEffectSlot(id);
+        if ((false == slot.has_value()) || (false == startedSlots.contains(*slot))) return false;
 
-        return readyEffects.insert(playingEffects.extract(playingEffectIter)).inserted;
+        startedSlots.erase(*slot);
+        effectSlotPlayingStates[*slot]->store(false, std::memory_order_release);
+        EnqueueCommand(
+            std::unique_ptr<SCommand>(new SCommand({.type = ECommandType::Stop, .slot = *slot})));
+        return true;
       }
 
       bool Device::RemoveEffect(TEffectIdentifier id)
       {
-        std::unique_lock lock(mutex);
-
-        if (0 != readyEffects.erase(id)) return true;
+        std::scoped_lock lock(commandMutex);
+
+        const std::optional<TEffectSlot> slot = FindEffectSlot(id);
+        if (false == slot.has_value()) return false;
+
+        EraseEffectSlotIndex(id);
+        occupiedSlots.erase(*slot);
+        startedSlots.erase(*slot);
+        stagedEffects[*slot] = nullptr;
+        effectSlotPlayingStates[*slot]->store(false, std::memory_order_release);
+        effectSlotPlayingStates[*slot] = nullptr;
+        countTotalEffects.store((unsigned int)occupiedSlots.size(), std::memory_order_release);
+        EnqueueCommand(
+            std::unique_ptr<SCommand>(new SCommand({.type = ECommandType::Remove, .slot = *slot})));
+        return true;
+      }
 
-        if (0 != playingEffects.erase(id)) return true;
+      void Device::WaitWhileDeviceIdle(void)
+      {
+        while (true)
+        {
+          // The generation is read before checking for idleness so that a command enqueued in
+          // between causes the wait to return immediately.
+          const uint32_t lastCommandGeneration = commandGeneration.load(std::memory_order_acquire);
+          if (false == IsDeviceIdle()) return;
 
-        return false;
+          commandGeneration.wait(lastCommandGeneration, std::memory_order_acquire);
+        }
       }
     } // namespace ForceFeedback
   }   // namespace Controller
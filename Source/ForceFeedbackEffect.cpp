@@ -11,9 +11,15 @@
 
 #include "ForceFeedbackEffect.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "ForceFeedbackMath.h"
 
@@ -26,7 +32,64 @@ namespace Xidi
       /// Holds the next available value for a force feedback effect identifier.
       static std::atomic<TEffectIdentifier> nextEffectIdentifier = 0;
 
-      Effect::Effect(void) : id(nextEffectIdentifier++), commonParameters() {}
+      /// Number of entries in the sine wave lookup table, one per whole hundredth of a degree
+      /// from 0 to 360 degrees inclusive.
+      static constexpr unsigned int kSineTableSize = 36001;
+
+      /// Determines if the supplied single-axis condition parameters are valid.
+      /// @param [in] axisCondition Single-axis condition parameters to check.
+      /// @return `true` if all parameters fall within their allowed ranges, `false` otherwise.
+      static bool IsAxisConditionValid(const SAxisCondition& axisCondition)
+      {
+        for (const TEffectValue signedParameter :
+             {axisCondition.offset,
+              axisCondition.positiveCoefficient,
+              axisCondition.negativeCoefficient})
+        {
+          if ((signedParameter < kEffectForceMagnitudeMinimum) ||
+              (signedParameter > kEffectForceMagnitudeMaximum))
+            return false;
+        }
+
+        for (const TEffectValue unsignedParameter :
+             {axisCondition.positiveSaturation,
+              axisCondition.negativeSaturation,
+              axisCondition.deadBand})
+        {
+          if ((unsignedParameter < 0) || (unsignedParameter > kEffectForceMagnitudeMaximum))
+            return false;
+        }
+
+        return true;
+      }
+
+      /// Retrieves the sine wave lookup table, building it on first access.
+      /// Because sine values are always rounded to the nearest multiple of the math rounding
+      /// precision, each entry is stored as that multiple rather than as a floating-point value.
+      /// This keeps the table small while producing exactly the same results as computing the sine
+      /// directly.
+      /// @return Read-only reference to the sine wave lookup table.
+      static const std::array<int8_t, kSineTableSize>& SineTable(void)
+      {
+        static const std::array<int8_t, kSineTableSize> kSineTable = []() -> auto
+        {
+          std::array<int8_t, kSineTableSize> sineTable = {};
+
+          for (unsigned int angle = 0; angle < kSineTableSize; ++angle)
+            sineTable[angle] =
+                (int8_t)(TrigonometrySine((TEffectValue)angle) / kMathRoundingPrecision);
+
+          return sineTable;
+        }();
+
+        return kSineTable;
+      }
+
+      Effect::Effect(void)
+          : id(nextEffectIdentifier++),
+            commonParameters(),
+            playingState(std::make_shared<std::atomic<bool>>(false))
+      {}
 
       bool ConstantForceEffect::AreTypeSpecificParametersValid(
           const SConstantForceParameters& newTypeSpecificParameters) const
@@ -70,6 +133,39 @@ namespace Xidi
         return true;
       }
 
+      bool CustomForceEffect::AreTypeSpecificParametersValid(
+          const SCustomForceParameters& newTypeSpecificParameters) const
+      {
+        if ((nullptr == newTypeSpecificParameters.samples) ||
+            (true == newTypeSpecificParameters.samples->empty()))
+          return false;
+
+        if (newTypeSpecificParameters.samplePeriod < 1) return false;
+
+        for (const TEffectValue sample : *newTypeSpecificParameters.samples)
+        {
+          if ((sample < kEffectForceMagnitudeMinimum) || (sample > kEffectForceMagnitudeMaximum))
+            return false;
+        }
+
+        return true;
+      }
+
+      bool ConditionEffect::AreTypeSpecificParametersValid(
+          const SConditionParameters& newTypeSpecificParameters) const
+      {
+        if ((newTypeSpecificParameters.count < kEffectAxesMinimumNumber) ||
+            (newTypeSpecificParameters.count > kEffectAxesMaximumNumber))
+          return false;
+
+        for (int i = 0; i < newTypeSpecificParameters.count; ++i)
+        {
+          if (false == IsAxisConditionValid(newTypeSpecificParameters.axis[i])) return false;
+        }
+
+        return true;
+      }
+
       void ConstantForceEffect::CheckAndFixTypeSpecificParameters(
           SConstantForceParameters& newTypeSpecificParameters) const
       {
@@ -79,6 +175,56 @@ namespace Xidi
           newTypeSpecificParameters.magnitude = kEffectForceMagnitudeMaximum;
       }
 
+      void CustomForceEffect::CheckAndFixTypeSpecificParameters(
+          SCustomForceParameters& newTypeSpecificParameters) const
+      {
+        // A sample period of 0 means to use the default, which is the shortest possible.
+        if (newTypeSpecificParameters.samplePeriod < 1) newTypeSpecificParameters.samplePeriod = 1;
+
+        // Samples are immutable, so fixing them requires a new buffer. This only happens when an
+        // application supplies out-of-range samples.
+        if ((nullptr == newTypeSpecificParameters.samples) ||
+            (true == newTypeSpecificParameters.samples->empty()))
+          return;
+
+        std::vector<TEffectValue> fixedSamples(*newTypeSpecificParameters.samples);
+        for (TEffectValue& sample : fixedSamples)
+          sample = std::clamp(sample, kEffectForceMagnitudeMinimum, kEffectForceMagnitudeMaximum);
+
+        if (fixedSamples != *newTypeSpecificParameters.samples)
+          newTypeSpecificParameters.samples =
+              std::make_shared<const std::vector<TEffectValue>>(std::move(fixedSamples));
+      }
+
+      void ConditionEffect::CheckAndFixTypeSpecificParameters(
+          SConditionParameters& newTypeSpecificParameters) const
+      {
+        // An invalid number of conditions cannot be fixed because there is no way to know which
+        // conditions the application intended to supply.
+        if ((newTypeSpecificParameters.count < kEffectAxesMinimumNumber) ||
+            (newTypeSpecificParameters.count > kEffectAxesMaximumNumber))
+          return;
+
+        for (int i = 0; i < newTypeSpecificParameters.count; ++i)
+        {
+          SAxisCondition& axisCondition = newTypeSpecificParameters.axis[i];
+
+          for (TEffectValue* signedParameter :
+               {&axisCondition.offset,
+                &axisCondition.positiveCoefficient,
+                &axisCondition.negativeCoefficient})
+            *signedParameter = std::clamp(
+                *signedParameter, kEffectForceMagnitudeMinimum, kEffectForceMagnitudeMaximum);
+
+          for (TEffectValue* unsignedParameter :
+               {&axisCondition.positiveSaturation,
+                &axisCondition.negativeSaturation,
+                &axisCondition.deadBand})
+            *unsignedParameter = std::clamp(
+                *unsignedParameter, kEffectForceMagnitudeZero, kEffectForceMagnitudeMaximum);
+        }
+      }
+
       std::unique_ptr<Effect> ConstantForceEffect::Clone(void) const
       {
         return std::make_unique<ConstantForceEffect>(*this);
@@ -89,6 +235,12 @@ namespace Xidi
         return std::make_unique<RampForceEffect>(*this);
       }
 
+      std::unique_ptr<Effect> CustomForceEffect::Clone(void) const
+      {
+        // Copying the type-specific parameters shares the sample buffer rather than copying it.
+        return std::make_unique<CustomForceEffect>(*this);
+      }
+
       std::unique_ptr<Effect> SawtoothDownEffect::Clone(void) const
       {
         return std::make_unique<SawtoothDownEffect>(*this);
@@ -114,6 +266,31 @@ namespace Xidi
         return std::make_unique<TriangleWaveEffect>(*this);
       }
 
+      std::unique_ptr<Effect> SpringEffect::Clone(void) const
+      {
+        return std::make_unique<SpringEffect>(*this);
+      }
+
+      std::unique_ptr<Effect> DamperEffect::Clone(void) const
+      {
+        return std::make_unique<DamperEffect>(*this);
+      }
+
+      std::unique_ptr<Effect> InertiaEffect::Clone(void) const
+      {
+        return std::make_unique<InertiaEffect>(*this);
+      }
+
+      std::unique_ptr<Effect> FrictionEffect::Clone(void) const
+      {
+        return std::make_unique<FrictionEffect>(*this);
+      }
+
+      bool ConditionEffect::IsConditionEffect(void) const
+      {
+        return true;
+      }
+
       TEffectValue PeriodicEffect::ComputePhase(TEffectTimeMs rawTime) const
       {
         const TEffectValue rawTimeInPeriods =
@@ -164,6 +341,147 @@ namespace Xidi
           return -ApplyEnvelope(rawTime, -magnitude);
       }
 
+      TEffectValue CustomForceEffect::ComputeRawMagnitude(TEffectTimeMs rawTime) const
+      {
+        const SCustomForceParameters& customForceParameters = GetTypeSpecificParameters().value();
+        const std::vector<TEffectValue>& samples = *customForceParameters.samples;
+
+        const TEffectValue magnitude =
+            samples[(rawTime / customForceParameters.samplePeriod) % samples.size()];
+
+        if (magnitude >= 0)
+          return ApplyEnvelope(rawTime, magnitude);
+        else
+          return -ApplyEnvelope(rawTime, -magnitude);
+      }
+
+      TEffectValue ConditionEffect::ComputeRawMagnitude(TEffectTimeMs rawTime) const
+      {
+        return kEffectForceMagnitudeZero;
+      }
+
+      TEffectTimeMs ConstantForceEffect::ComputeRawMagnitudeStableUntil(
+          TEffectTimeMs rawTime) const
+      {
+        // The magnitude itself is fixed, so only the envelope can cause it to change.
+        return ComputeEnvelopeStableUntil(rawTime);
+      }
+
+      TEffectTimeMs RampForceEffect::ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const
+      {
+        const SRampForceParameters& rampParameters = GetTypeSpecificParameters().value();
+        if (rampParameters.magnitudeStart != rampParameters.magnitudeEnd) return rawTime + 1;
+
+        return ComputeEnvelopeStableUntil(rawTime);
+      }
+
+      TEffectTimeMs CustomForceEffect::ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const
+      {
+        // Each sample is held for an entire custom force sample period, after which the next
+        // sample takes over.
+        const TEffectTimeMs samplePeriod = GetTypeSpecificParameters().value().samplePeriod;
+        const TEffectTimeMs nextSampleTime = rawTime - (rawTime % samplePeriod) + samplePeriod;
+
+        return std::min(nextSampleTime, ComputeEnvelopeStableUntil(rawTime));
+      }
+
+      TEffectTimeMs ConditionEffect::ComputeRawMagnitudeStableUntil(TEffectTimeMs rawTime) const
+      {
+        // Condition effects respond to axis state, not to time.
+        return GetDuration().value();
+      }
+
+      TOrderedMagnitudeComponents ConditionEffect::ComputeRawConditionMagnitudeComponents(
+          const SConditionInput& conditionInput) const
+      {
+        const SConditionParameters& conditionParameters = GetTypeSpecificParameters().value();
+        const SAssociatedAxes& associatedAxes = GetAssociatedAxes().value();
+        const TOrderedMagnitudeComponents& metric = SelectMetric(conditionInput);
+
+        TOrderedMagnitudeComponents magnitudeComponents = {};
+
+        for (int i = 0; i < associatedAxes.count; ++i)
+        {
+          const bool conditionAppliesToAllAxes = (1 == conditionParameters.count);
+          if ((false == conditionAppliesToAllAxes) && (i >= conditionParameters.count)) break;
+
+          const int axisIndex = (int)associatedAxes.type[i];
+          magnitudeComponents[axisIndex] = ComputeAxisForce(
+              conditionParameters.axis[(true == conditionAppliesToAllAxes) ? 0 : i],
+              metric[axisIndex]);
+        }
+
+        return magnitudeComponents;
+      }
+
+      TEffectValue ConditionEffect::ComputeAxisForce(
+          const SAxisCondition& axisCondition, TEffectValue metric) const
+      {
+        const TEffectValue displacement = metric - axisCondition.offset;
+
+        if (displacement > axisCondition.deadBand)
+          return std::clamp(
+              -(axisCondition.positiveCoefficient * (displacement - axisCondition.deadBand)) /
+                  kEffectModifierRelativeDenominator,
+              -axisCondition.positiveSaturation,
+              axisCondition.positiveSaturation);
+
+        if (displacement < -axisCondition.deadBand)
+          return std::clamp(
+              -(axisCondition.negativeCoefficient * (displacement + axisCondition.deadBand)) /
+                  kEffectModifierRelativeDenominator,
+              -axisCondition.negativeSaturation,
+              axisCondition.negativeSaturation);
+
+        return kEffectForceMagnitudeZero;
+      }
+
+      TEffectValue FrictionEffect::ComputeAxisForce(
+          const SAxisCondition& axisCondition, TEffectValue metric) const
+      {
+        // Friction opposes motion with a force whose strength is given directly by the coefficient
+        // rather than being proportional to how fast the axis is moving.
+        const TEffectValue displacement = metric - axisCondition.offset;
+
+        if (displacement > axisCondition.deadBand)
+          return std::clamp(
+              -axisCondition.positiveCoefficient,
+              -axisCondition.positiveSaturation,
+              axisCondition.positiveSaturation);
+
+        if (displacement < -axisCondition.deadBand)
+          return std::clamp(
+              axisCondition.negativeCoefficient,
+              -axisCondition.negativeSaturation,
+              axisCondition.negativeSaturation);
+
+        return kEffectForceMagnitudeZero;
+      }
+
+      const TOrderedMagnitudeComponents& SpringEffect::SelectMetric(
+          const SConditionInput& conditionInput) const
+      {
+        return conditionInput.position;
+      }
+
+      const TOrderedMagnitudeComponents& DamperEffect::SelectMetric(
+          const SConditionInput& conditionInput) const
+      {
+        return conditionInput.velocity;
+      }
+
+      const TOrderedMagnitudeComponents& InertiaEffect::SelectMetric(
+          const SConditionInput& conditionInput) const
+      {
+        return conditionInput.acceleration;
+      }
+
+      const TOrderedMagnitudeComponents& FrictionEffect::SelectMetric(
+          const SConditionInput& conditionInput) const
+      {
+        return conditionInput.velocity;
+      }
+
       TEffectValue SawtoothDownEffect::WaveformAmplitude(TEffectValue phase) const
       {
         // Per DirectInput documentation, sawtooth down waves start at +1 and descend all the way to
@@ -192,6 +510,16 @@ namespace Xidi
 
       TEffectValue SineWaveEffect::WaveformAmplitude(TEffectValue phase) const
       {
+        // Phases computed during playback are always whole numbers of degree hundredths within a
+        // single cycle, so a lookup avoids invoking the sine function once per effect per playback
+        // iteration. Other inputs fall back to computing the sine directly.
+        if ((phase >= 0) && (phase < (TEffectValue)kSineTableSize))
+        {
+          const unsigned int phaseIndex = (unsigned int)phase;
+          if ((TEffectValue)phaseIndex == phase)
+            return (TEffectValue)SineTable()[phaseIndex] * kMathRoundingPrecision;
+        }
+
         return TrigonometrySine(phase);
       }
 
@@ -257,6 +585,25 @@ namespace Xidi
         return sustainLevel;
       }
 
+      TEffectTimeMs Effect::ComputeEnvelopeStableUntil(TEffectTimeMs rawTime) const
+      {
+        const TEffectTimeMs duration = commonParameters.duration.value();
+        if (false == commonParameters.envelope.has_value()) return duration;
+
+        const SEnvelope& envelope = commonParameters.envelope.value();
+
+        // Attack and fade both change the output continuously. Boundaries here match those used
+        // by the envelope transformation itself, in which the fade begins strictly after its
+        // start time.
+        if (rawTime < envelope.attackTime) return rawTime + 1;
+
+        const TEffectTimeMs fadeStartTime = duration - envelope.fadeTime;
+        if (rawTime > fadeStartTime) return rawTime + 1;
+        if (fadeStartTime >= duration) return duration;
+
+        return fadeStartTime + 1;
+      }
+
       TEffectValue Effect::ComputeMagnitude(TEffectTimeMs time) const
       {
         if (time >= commonParameters.duration.value_or(0)) return kEffectForceMagnitudeZero;
@@ -264,6 +611,60 @@ namespace Xidi
         const TEffectTimeMs rawTime = time - (time % commonParameters.samplePeriodForComputations);
         return ComputeRawMagnitude(rawTime) * commonParameters.gainFraction;
       }
+
+      TEffectTimeMs Effect::ComputeMagnitudeStableUntil(TEffectTimeMs time) const
+      {
+        const TEffectTimeMs duration = commonParameters.duration.value_or(0);
+        if (time >= duration) return std::numeric_limits<TEffectTimeMs>::max();
+
+        const TEffectTimeMs samplePeriod = commonParameters.samplePeriodForComputations;
+        const TEffectTimeMs rawTime = time - (time % samplePeriod);
+
+        // Magnitude is only recomputed at the start of each sample period, so a change in the raw
+        // magnitude does not take effect until the first sample period boundary at or after it.
+        const TEffectTimeMs rawStableUntil = ComputeRawMagnitudeStableUntil(rawTime);
+        if (rawStableUntil >= duration) return duration;
+
+        const TEffectTimeMs timeUntilBoundary =
+            (samplePeriod - (rawStableUntil % samplePeriod)) % samplePeriod;
+        if (timeUntilBoundary >= (duration - rawStableUntil)) return duration;
+
+        return rawStableUntil + timeUntilBoundary;
+      }
+
+      TEffectValue Effect::ComputeAverageMagnitude(
+          TEffectTimeMs startTime, TEffectTimeMs endTime) const
+      {
+        TEffectValue weightedSum = 0;
+
+        // Each stretch of time over which the magnitude is stable contributes in proportion to its
+        // length, so the magnitude only needs to be computed once per stretch.
+        TEffectTimeMs time = startTime;
+        while (time < endTime)
+        {
+          const TEffectTimeMs stretchEndTime =
+              std::min(endTime, ComputeMagnitudeStableUntil(time));
+          weightedSum += ComputeMagnitude(time) * (TEffectValue)(stretchEndTime - time);
+          time = stretchEndTime;
+        }
+
+        return weightedSum / (TEffectValue)(endTime - startTime);
+      }
+
+      TOrderedMagnitudeComponents Effect::ComputeOrderedMagnitudeComponents(
+          TEffectTimeMs time, const SConditionInput& conditionInput) const
+      {
+        if (false == IsConditionEffect()) return ComputeOrderedMagnitudeComponents(time);
+
+        if (time >= commonParameters.duration.value_or(0)) return {};
+
+        TOrderedMagnitudeComponents magnitudeComponents =
+            ComputeRawConditionMagnitudeComponents(conditionInput);
+        for (auto& magnitudeComponent : magnitudeComponents)
+          magnitudeComponent *= commonParameters.gainFraction;
+
+        return magnitudeComponents;
+      }
     } // namespace ForceFeedback
   }   // namespace Controller
 } // namespace Xidi
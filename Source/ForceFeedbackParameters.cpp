@@ -47,7 +47,8 @@ namespace Xidi
             originalCoordinateSystem(),
             cartesian(),
             polar(),
-            spherical()
+            spherical(),
+            projection()
       {}
 
       TMagnitudeComponents DirectionVector::ComputeMagnitudeComponents(TEffectValue magnitude) const
@@ -56,66 +57,8 @@ namespace Xidi
 
         if (0 != magnitude)
         {
-          if (true == isOmnidirectional)
-          {
-            // For omni-directional forces, the magnitude is simply copied without transformation to
-            // all components. All of the coordinate systems contain invalid values so they cannot
-            // be consulted directly.
-
-            for (int i = 0; i < numAxes; ++i)
-              magnitudeComponents[i] = magnitude;
-          }
-          else if (1 == numAxes)
-          {
-            // For single-axis forces, only the direction of the single Cartesian coordinate
-            // matters.
-
-            if (cartesian[0] > 0)
-              magnitudeComponents[0] = magnitude;
-            else
-              magnitudeComponents[0] = -magnitude;
-          }
-          else
-          {
-            // For multi-axis forces, the spherical coordinate system makes it easy to convert to
-            // individual components. This is in essence a spherical-to-Cartesian conversion using
-            // the force's magnitude as input.
-
-            for (int i = 0; i < numAxes; ++i)
-              magnitudeComponents[i] = magnitude;
-
-            // Intuition for this algorithm is as follows.
-            // Component of the highest-numbered dimension (i.e. the highest-indexed element in the
-            // Cartesian component array) has a projection along it that is the sine of the
-            // highest-index spherical coordinate angle. All other components use a projection of
-            // that same angle along the orthogonal plane, which is to say multiply by the cosine of
-            // that same angle. This acts as a sort of dimensionality reduction which then repeats.
-
-            // Following this logic for a two-dimensional vector, and assuming dimensions X and Y in
-            // that order:
-            // * Y component = magnitude * sin(spherical[0])
-            // * X component = magnitude * cos(spherical[0])
-            // Extending that logic to three dimensions, and assuming dimensions
-            // X, Y, and Z in that order
-            // * Z component = magnitude * sin(spherical[1])
-            // * X-Y projection vector magnitude = magnitude * cos(spherical[1])
-            // * Y component = (X-Y projection) * sin(spherical[0])
-            // * X component = (X-Y projection) * cos(spherical[0]).
-
-            // Same can be extended to four and more dimensions. This pair of loops simply
-            // implements the above intuition.
-
-            for (int coordinateIndex = 0; coordinateIndex < (numAxes - 1); ++coordinateIndex)
-            {
-              for (int axisIndex = 0; axisIndex < numAxes; ++axisIndex)
-              {
-                if (axisIndex <= coordinateIndex)
-                  magnitudeComponents[axisIndex] *= TrigonometryCosine(spherical[coordinateIndex]);
-                else if (axisIndex == (coordinateIndex + 1))
-                  magnitudeComponents[axisIndex] *= TrigonometrySine(spherical[coordinateIndex]);
-              }
-            }
-          }
+          for (int i = 0; i < numAxes; ++i)
+            magnitudeComponents[i] = magnitude * projection[i];
         }
 
         return magnitudeComponents;
@@ -226,6 +169,7 @@ namespace Xidi
           }
         }
 
+        UpdateProjection();
         return true;
       }
 
@@ -262,6 +206,7 @@ namespace Xidi
         spherical[0] = 27000 + polar;
         if (spherical[0] >= 36000) spherical[0] -= 36000;
 
+        UpdateProjection();
         return true;
       }
 
@@ -283,6 +228,7 @@ namespace Xidi
         if (1 == numAxes)
         {
           cartesian[0] = 1;
+          UpdateProjection();
         }
         else
         {
@@ -302,6 +248,7 @@ namespace Xidi
           // Convert to Cartesian.
           // Assume a magnitude of 100,000,000 so there will be reasonable precision in the integer
           // part of each Cartesian component.
+          UpdateProjection();
           cartesian = ComputeMagnitudeComponents(100000000);
         }
 
@@ -319,6 +266,72 @@ namespace Xidi
         cartesian.fill(0);
         polar = 0;
         spherical.fill(0);
+
+        UpdateProjection();
+      }
+      void DirectionVector::UpdateProjection(void)
+      {
+        projection.fill(0);
+
+        if (true == isOmnidirectional)
+        {
+          // For omni-directional forces, the magnitude is simply copied without transformation to
+          // all components. All of the coordinate systems contain invalid values so they cannot be
+          // consulted directly.
+
+          for (int i = 0; i < numAxes; ++i)
+            projection[i] = 1;
+        }
+        else if (1 == numAxes)
+        {
+          // For single-axis forces, only the direction of the single Cartesian coordinate matters.
+
+          if (cartesian[0] > 0)
+            projection[0] = 1;
+          else
+            projection[0] = -1;
+        }
+        else
+        {
+          // For multi-axis forces, the spherical coordinate system makes it easy to convert to
+          // individual components. This is in essence a spherical-to-Cartesian conversion using a
+          // unit magnitude as input.
+
+          for (int i = 0; i < numAxes; ++i)
+            projection[i] = 1;
+
+          // Intuition for this algorithm is as follows.
+          // Component of the highest-numbered dimension (i.e. the highest-indexed element in the
+          // Cartesian component array) has a projection along it that is the sine of the
+          // highest-index spherical coordinate angle. All other components use a projection of
+          // that same angle along the orthogonal plane, which is to say multiply by the cosine of
+          // that same angle. This acts as a sort of dimensionality reduction which then repeats.
+
+          // Following this logic for a two-dimensional vector, and assuming dimensions X and Y in
+          // that order:
+          // * Y component = magnitude * sin(spherical[0])
+          // * X component = magnitude * cos(spherical[0])
+          // Extending that logic to three dimensions, and assuming dimensions
+          // X, Y, and Z in that order
+          // * Z component = magnitude * sin(spherical[1])
+          // * X-Y projection vector magnitude = magnitude * cos(spherical[1])
+          // * Y component = (X-Y projection) * sin(spherical[0])
+          // * X component = (X-Y projection) * cos(spherical[0]).
+
+          // Same can be extended to four and more dimensions. This pair of loops simply
+          // implements the above intuition.
+
+          for (int coordinateIndex = 0; coordinateIndex < (numAxes - 1); ++coordinateIndex)
+          {
+            for (int axisIndex = 0; axisIndex < numAxes; ++axisIndex)
+            {
+              if (axisIndex <= coordinateIndex)
+                projection[axisIndex] *= TrigonometryCosine(spherical[coordinateIndex]);
+              else if (axisIndex == (coordinateIndex + 1))
+                projection[axisIndex] *= TrigonometrySine(spherical[coordinateIndex]);
+            }
+          }
+        }
       }
     } // namespace ForceFeedback
   }   // namespace Controller
@@ -12,26 +12,42 @@
 
 #include "Globals.h"
 
+#include <atomic>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 
 #include <Infra/Core/Configuration.h>
 #include <Infra/Core/Message.h>
 #include <Infra/Core/ProcessInfo.h>
 
 #include "ApiWindows.h"
+#include "Settings.h"
 #include "Strings.h"
+#include "WorkerThread.h"
 
 #include "GitVersionInfo.generated.h"
 
 #ifndef XIDI_SKIP_CONFIG
 #include "XidiConfigReader.h"
 #ifndef XIDI_SKIP_MAPPERS
+#include "AsyncLog.h"
+#include "AutoTune.h"
+#include "ConfigurationWatcher.h"
+#include "ElementMapperCache.h"
+#include "FlightRecorder.h"
 #include "Mapper.h"
 #include "MapperBuilder.h"
+#include "PhysicalController.h"
+#include "StartupTrace.h"
+#include "TraceEvents.h"
+#include "WrapperJoyWinMM.h"
 #endif
 #endif
 
@@ -45,13 +61,45 @@ namespace Xidi
   {
 #ifndef XIDI_SKIP_CONFIG
 #ifndef XIDI_SKIP_MAPPERS
+#ifndef XIDI_SKIP_CUSTOM_MAPPERS
     /// Holds custom mapper blueprints produced while reading from a configuration file.
     static Controller::MapperBuilder customMapperBuilder;
 
-    /// Attempts to build all custom mappers held by the custom mapper builder object.
-    /// Upon completion, regardless of outcome, clears out all of the stored blueprint objects.
+    /// Serializes access to the custom mapper builder object once custom mappers are being built
+    /// on demand.
+    static std::mutex customMapperBuilderMutex;
+
+    /// Holds hashes of the custom mapper sections read from a configuration file, which are needed
+    /// to identify changes if custom mappers are reapplied when the configuration file changes.
+    static XidiConfigReader::TCustomMapperSectionHashes customMapperSectionHashes;
+
+    /// Builds a custom mapper from its blueprint the first time it is requested by name.
+    /// @param [in] mapperName Name of the requested mapper.
+    /// @return Pointer to the newly-built mapper, or `nullptr` if no such mapper can be built.
+    static const Controller::Mapper* BuildCustomMapperOnDemand(std::wstring_view mapperName)
+    {
+      std::scoped_lock lock(customMapperBuilderMutex);
+
+      // Another thread might have built the same mapper while this thread was waiting.
+      if (true == Controller::Mapper::IsMapperNameKnown(mapperName))
+        return Controller::Mapper::GetByName(mapperName);
+
+      return customMapperBuilder.BuildIfPending(mapperName);
+    }
+
+    /// Prepares all custom mappers held by the custom mapper builder object. If all of them can be
+    /// built then they are left as blueprints and each is built the first time it is requested,
+    /// since only the mappers actually assigned to controllers are ever needed. Otherwise all of
+    /// them are built immediately so that errors are reported right away, and upon completion,
+    /// regardless of outcome, all of the stored blueprint objects are cleared out.
     static inline void BuildCustomMappers(void)
     {
+      if (true == customMapperBuilder.CanBuildAll())
+      {
+        Controller::Mapper::SetOnDemandBuildFunc(&BuildCustomMapperOnDemand);
+        return;
+      }
+
       if (false == customMapperBuilder.Build())
       {
         if (true == Infra::Message::IsLogFileEnabled())
@@ -66,6 +114,7 @@ namespace Xidi
 
       customMapperBuilder.Clear();
     }
+#endif
 #endif
 
     /// Generates and returns the file path for a Xidi log file. This is a combination of the
@@ -111,6 +160,12 @@ namespace Xidi
     /// @param [in] logLevel Logging level to configure as the minimum severity for output.
     static void EnableLog(Infra::Message::ESeverity logLevel)
     {
+#ifdef XIDI_SKIP_VERBOSE_LOGGING
+      // Builds that skip verbose logging cannot output anything more verbose than informational
+      // messages, so requesting such messages is the same as requesting informational messages.
+      if (logLevel > Infra::Message::ESeverity::Info) logLevel = Infra::Message::ESeverity::Info;
+#endif
+
       static std::once_flag enableLogFlag;
       std::call_once(
           enableLogFlag,
@@ -142,14 +197,271 @@ namespace Xidi
     }
 #endif
 
+    /// Determines if this process owns the specified window.
+    /// @param [in] window Handle of the window of interest.
+    /// @return `true` if so, `false` if not.
+    static inline bool IsWindowOwnedByCurrentProcess(HWND window)
+    {
+      DWORD windowProcess = 0;
+      GetWindowThreadProcessId(window, &windowProcess);
+
+      return (GetCurrentProcessId() == windowProcess);
+    }
+
+    /// Maintains a cached view of whether or not this process has input focus. The cached value is
+    /// updated by a system event hook whenever the foreground window changes, so querying it does
+    /// not require any system calls. The hook is serviced by a dedicated thread that runs a
+    /// message loop. A manual-reset event mirrors the cached value so that other threads can wait
+    /// for input focus to be gained. Wraps the thread handle to ensure safe termination and
+    /// clean-up.
+    class ForegroundChangeMonitor
+    {
+    public:
+
+      inline ForegroundChangeMonitor(void)
+          : monitorThread(),
+            monitorThreadId(0),
+            monitorActive(false),
+            haveInputFocus(false),
+            inputFocusEvent(CreateEvent(nullptr, TRUE, FALSE, nullptr))
+      {}
+
+      ForegroundChangeMonitor(const ForegroundChangeMonitor& other) = delete;
+
+      /// Safely exits the monitor thread if it is started.
+      ~ForegroundChangeMonitor(void)
+      {
+        if (true == monitorThread.joinable())
+        {
+          PostThreadMessage(monitorThreadId.load(std::memory_order_acquire), WM_QUIT, 0, 0);
+          monitorThread.join();
+        }
+
+        if (nullptr != inputFocusEvent) CloseHandle(inputFocusEvent);
+      }
+
+      /// Retrieves the cached view of whether or not this process has input focus.
+      /// @return Cached input focus state, or no value if the monitor is not active.
+      inline std::optional<bool> HaveInputFocus(void) const
+      {
+        if (false == monitorActive.load(std::memory_order_acquire)) return std::nullopt;
+        return haveInputFocus.load(std::memory_order_relaxed);
+      }
+
+      /// Waits for this process to have input focus, based on the cached view.
+      /// @param [in] timeoutMilliseconds Maximum amount of time to wait.
+      /// @return `true` if this process has input focus, `false` if the timeout elapsed first or
+      /// the monitor is not active.
+      inline bool WaitForInputFocus(DWORD timeoutMilliseconds) const
+      {
+        if ((false == monitorActive.load(std::memory_order_acquire)) ||
+            (nullptr == inputFocusEvent))
+          return false;
+
+        return (WAIT_OBJECT_0 == WaitForSingleObject(inputFocusEvent, timeoutMilliseconds));
+      }
+
+      /// Updates the cached view of whether or not this process has input focus by querying the
+      /// system for the current foreground window.
+      inline void RefreshInputFocus(void)
+      {
+        const bool newHaveInputFocus = IsWindowOwnedByCurrentProcess(GetForegroundWindow());
+        haveInputFocus.store(newHaveInputFocus, std::memory_order_relaxed);
+
+        if (nullptr == inputFocusEvent) return;
+
+        if (true == newHaveInputFocus)
+          SetEvent(inputFocusEvent);
+        else
+          ResetEvent(inputFocusEvent);
+      }
+
+      /// Starts the monitor thread and waits for it to install its system event hook.
+      /// Idempotent and concurrency-safe.
+      inline void Start(void)
+      {
+        std::call_once(
+            startFlag,
+            [this]() -> void
+            {
+              std::promise<bool> hookInstalled;
+              std::future<bool> hookInstalledResult = hookInstalled.get_future();
+
+              monitorThread = WorkerThread::Create(
+                  L"Xidi Foreground Monitor",
+                  WorkerThread::EPriority::Housekeeping,
+                  MonitorForegroundChanges,
+                  this,
+                  std::move(hookInstalled));
+
+              if (false == hookInstalledResult.get())
+              {
+                monitorThread.join();
+                Infra::Message::Output(
+                    Infra::Message::ESeverity::Warning,
+                    L"Failed to install the foreground window change hook. Input focus will be queried from the system each time it is needed.");
+              }
+            });
+      }
+
+    private:
+
+      /// Receives notifications from the system whenever the foreground window changes.
+      /// Parameters are documented in the Windows API.
+      static void CALLBACK HandleForegroundChange(
+          HWINEVENTHOOK hWinEventHook,
+          DWORD event,
+          HWND hwnd,
+          LONG idObject,
+          LONG idChild,
+          DWORD idEventThread,
+          DWORD dwmsEventTime);
+
+      /// Installs the system event hook and runs a message loop so that the system can deliver
+      /// foreground window change notifications to this thread.
+      /// @param [in] monitor Monitor object whose cached state is to be updated.
+      /// @param [in] hookInstalled Promise to fulfill once it is known whether or not the system
+      /// event hook was installed.
+      static void MonitorForegroundChanges(
+          ForegroundChangeMonitor* monitor, std::promise<bool> hookInstalled)
+      {
+        // Creating the message queue before reporting success ensures that a quit message posted
+        // during destruction is never lost.
+        MSG message;
+        PeekMessage(&message, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+        monitor->monitorThreadId.store(GetCurrentThreadId(), std::memory_order_release);
+
+        const HWINEVENTHOOK hook = SetWinEventHook(
+            EVENT_SYSTEM_FOREGROUND,
+            EVENT_SYSTEM_FOREGROUND,
+            nullptr,
+            HandleForegroundChange,
+            0,
+            0,
+            WINEVENT_OUTOFCONTEXT);
+
+        if (nullptr == hook)
+        {
+          hookInstalled.set_value(false);
+          return;
+        }
+
+        monitor->RefreshInputFocus();
+        monitor->monitorActive.store(true, std::memory_order_release);
+        hookInstalled.set_value(true);
+
+        while (GetMessage(&message, nullptr, 0, 0) > 0)
+        {
+          TranslateMessage(&message);
+          DispatchMessage(&message);
+        }
+
+        monitor->monitorActive.store(false, std::memory_order_release);
+        UnhookWinEvent(hook);
+
+        // Threads waiting for input focus must not remain blocked once the monitor has exited.
+        if (nullptr != monitor->inputFocusEvent) SetEvent(monitor->inputFocusEvent);
+      }
+
+      /// Handle for the monitor thread itself.
+      std::thread monitorThread;
+
+      /// Thread identifier of the monitor thread, used for asking it to exit.
+      std::atomic<DWORD> monitorThreadId;
+
+      /// Ensures the monitor thread is started at most once.
+      std::once_flag startFlag;
+
+      /// Whether or not the cached input focus state is being maintained.
+      std::atomic<bool> monitorActive;
+
+      /// Cached input focus state.
+      std::atomic<bool> haveInputFocus;
+
+      /// Manual-reset event that is signalled whenever the cached input focus state indicates that
+      /// this process has input focus.
+      HANDLE inputFocusEvent;
+    };
+
+    /// Singleton object that maintains the cached input focus state.
+    static ForegroundChangeMonitor foregroundChangeMonitor;
+
+    void CALLBACK ForegroundChangeMonitor::HandleForegroundChange(
+        HWINEVENTHOOK hWinEventHook,
+        DWORD event,
+        HWND hwnd,
+        LONG idObject,
+        LONG idChild,
+        DWORD idEventThread,
+        DWORD dwmsEventTime)
+    {
+      // Out-of-context notifications are delivered asynchronously, so by the time this one arrives
+      // the foreground window might have changed again. Querying it directly keeps the cached
+      // state consistent with the most recent change.
+      foregroundChangeMonitor.RefreshInputFocus();
+    }
+
     bool DoesCurrentProcessHaveInputFocus(void)
     {
-      DWORD foregroundProcess = 0;
-      GetWindowThreadProcessId(GetForegroundWindow(), &foregroundProcess);
+      foregroundChangeMonitor.Start();
+
+      const std::optional<bool> maybeCachedInputFocus = foregroundChangeMonitor.HaveInputFocus();
+      if (true == maybeCachedInputFocus.has_value()) return maybeCachedInputFocus.value();
+
+      return IsWindowOwnedByCurrentProcess(GetForegroundWindow());
+    }
+
+    bool WaitForInputFocus(unsigned int timeoutMilliseconds)
+    {
+      if (true == DoesCurrentProcessHaveInputFocus()) return true;
+      if (true == foregroundChangeMonitor.WaitForInputFocus(timeoutMilliseconds)) return true;
+
+      // Without the foreground change monitor there is no notification to wait for, so the best
+      // that can be done is to check again once the timeout elapses.
+      if (false == foregroundChangeMonitor.HaveInputFocus().has_value())
+      {
+        Sleep(timeoutMilliseconds);
+        return IsWindowOwnedByCurrentProcess(GetForegroundWindow());
+      }
 
-      return (GetCurrentProcessId() == foregroundProcess);
+      return false;
     }
 
+    /// Typed representation of the controller-independent settings in the configuration data.
+    /// Extracted as soon as the configuration file is read, and holds built-in defaults until then.
+    static SSettings settings;
+
+#if !defined(XIDI_SKIP_CONFIG) && !defined(XIDI_SKIP_MAPPERS)
+    /// Reads the auto-tuning profile of the running executable, if it exists, and uses it for any
+    /// settings that the configuration file does not specify.
+    /// @param [in] configData Configuration data read from the configuration file.
+    static void ApplyAutoTuneProfile(const Infra::Configuration::ConfigurationData& configData)
+    {
+      const std::wstring_view profileFilename = Strings::GetAutoTuneProfileFilename();
+      if (INVALID_FILE_ATTRIBUTES == GetFileAttributes(profileFilename.data())) return;
+
+      XidiConfigReader profileReader;
+      const Infra::Configuration::ConfigurationData profileData =
+          profileReader.ReadConfigurationFile(profileFilename);
+
+      if (true == profileReader.HasErrorMessages())
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Errors were encountered while reading auto-tuning profile file %s, so it was not applied.",
+            profileFilename.data());
+        profileReader.LogAllErrorMessages();
+        return;
+      }
+
+      AutoTune::ApplyProfile(profileData, configData, settings);
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Applied auto-tuning profile file %s to settings not specified in the configuration file.",
+          profileFilename.data());
+    }
+#endif
+
     const Infra::Configuration::ConfigurationData& GetConfigurationData(void)
     {
       static Infra::Configuration::ConfigurationData configData;
@@ -163,7 +475,25 @@ namespace Xidi
             XidiConfigReader configReader;
 
 #ifndef XIDI_SKIP_MAPPERS
+            const StartupTrace::ScopedPhase readPhase(L"Globals::GetConfigurationData");
+
+#ifndef XIDI_SKIP_CUSTOM_MAPPERS
             configReader.SetMapperBuilder(&customMapperBuilder);
+            configReader.SetCustomMapperSectionHashes(&customMapperSectionHashes);
+
+            // Element mappers parsed from a configuration file are cached alongside it, and the
+            // cache is only trusted for the exact configuration file contents that produced it.
+            std::optional<Controller::ElementMapperCache> elementMapperCache;
+            const std::optional<uint64_t> maybeConfigurationFileHash =
+                Controller::ElementMapperCache::HashFileContents(
+                    Strings::GetConfigurationFilename());
+            if (true == maybeConfigurationFileHash.has_value())
+            {
+              elementMapperCache.emplace(
+                  Strings::GetElementMapperCacheFilename(), maybeConfigurationFileHash.value());
+              configReader.SetElementMapperCache(&elementMapperCache.value());
+            }
+#endif
 #endif
 
             configData = configReader.ReadConfigurationFile();
@@ -171,7 +501,12 @@ namespace Xidi
             if (false == configReader.HasErrorMessages())
             {
 #ifndef XIDI_SKIP_MAPPERS
+#ifndef XIDI_SKIP_CUSTOM_MAPPERS
+              const StartupTrace::ScopedPhase customMapperPhase(L"Globals::BuildCustomMappers");
               BuildCustomMappers();
+
+              if (true == elementMapperCache.has_value()) elementMapperCache->Save();
+#endif
 #endif
             }
             else
@@ -192,19 +527,145 @@ namespace Xidi
 
               configData.Clear();
             }
+
+            settings = XidiConfigReader::ExtractSettings(configData);
+
+#ifndef XIDI_SKIP_MAPPERS
+            if (true ==
+                configData[Strings::kStrConfigurationSectionAutoTune]
+                          [Strings::kStrConfigurationSettingAutoTuneUseProfile]
+                              .ValueOr(false))
+              ApplyAutoTuneProfile(configData);
+#endif
           });
 #endif
 
       return configData;
     }
 
-    void Initialize(void)
+    const SSettings& GetSettings(void)
     {
+      // Settings are extracted as part of reading the configuration file.
+      GetConfigurationData();
+      return settings;
+    }
+
 #ifndef XIDI_SKIP_CONFIG
+    /// Performs all run-time initialization that depends on the configuration file, which must be
+    /// read and parsed first. In the main Xidi library this is too slow to do while holding the
+    /// loader lock, so it is deferred until after the DLL entry point returns.
+    static void InitializeFromConfiguration(void)
+    {
+#ifndef XIDI_SKIP_MAPPERS
+      const StartupTrace::ScopedPhase initializePhase(L"Globals::Initialize");
+#endif
+
       EnableLogIfConfigured();
 
 #ifndef XIDI_SKIP_MAPPERS
+      AutoTune::BeginSession();
+
+      if ((true == Infra::Message::IsLogFileEnabled()) &&
+          (true ==
+           GetConfigurationData()[Strings::kStrConfigurationSectionLog]
+                                 [Strings::kStrConfigurationSettingLogAsynchronous]
+                                     .ValueOr(false)))
+        AsyncLog::Enable();
+
+      StartupTrace::Configure(
+          GetConfigurationData()[Strings::kStrConfigurationSectionLog]
+                                [Strings::kStrConfigurationSettingLogStartupTrace]
+                                    .ValueOr(false),
+          GetConfigurationData()[Strings::kStrConfigurationSectionLog]
+                                [Strings::kStrConfigurationSettingLogStartupTraceEvents]
+                                    .ValueOr(false));
+
+      const auto& configData = GetConfigurationData();
+      if ((true == configData.Contains(Strings::kStrConfigurationSectionFlightRecorder)) &&
+          (true ==
+           configData[Strings::kStrConfigurationSectionFlightRecorder].Contains(
+               Strings::kStrConfigurationSettingFlightRecorderCrashDumpFile)))
+        FlightRecorder::DumpOnCrash(
+            configData[Strings::kStrConfigurationSectionFlightRecorder]
+                      [Strings::kStrConfigurationSettingFlightRecorderCrashDumpFile]
+                          ->GetString());
+
       Controller::Mapper::DumpRegisteredMappers();
+      WrapperJoyWinMM::BeginSystemDeviceEnumeration();
+
+#ifndef XIDI_SKIP_CUSTOM_MAPPERS
+      if (true ==
+          GetConfigurationData()[Strings::kStrConfigurationSectionMapper]
+                                [Strings::kStrConfigurationSettingMapperReloadOnChange]
+                                    .ValueOr(false))
+        ConfigurationWatcher::Start(std::move(customMapperSectionHashes));
+#endif
+
+      if (true ==
+          GetConfigurationData()[Strings::kStrConfigurationSectionProperties]
+                                [Strings::kStrConfigurationSettingsPropertiesPrewarmControllers]
+                                    .ValueOr(false))
+        WorkerThread::StartDetached(
+            L"Xidi Controller Prewarm",
+            WorkerThread::EPriority::Normal,
+            Controller::PrewarmPhysicalControllers);
+#endif
+    }
+
+#ifndef XIDI_SKIP_MAPPERS
+    /// Set once deferred initialization is complete. Entry points into the main Xidi library are
+    /// invoked frequently, so checking this flag avoids the overhead of the once flag below in the
+    /// common case.
+    static std::atomic<bool> isInitialized = false;
+
+    /// Ensures deferred initialization happens exactly once, and causes any threads that need it
+    /// while it is in progress to wait for it to finish.
+    static std::once_flag initializeFlag;
+
+    /// Thread pool callback that performs deferred initialization.
+    /// @param [in] instance Callback instance, not used.
+    /// @param [in] context Callback context, not used.
+    static void __stdcall DeferredInitializeCallback(PTP_CALLBACK_INSTANCE instance, PVOID context)
+    {
+      EnsureInitialized();
+    }
+#endif
+#endif
+
+    void EnsureInitialized(void)
+    {
+#ifndef XIDI_SKIP_CONFIG
+#ifndef XIDI_SKIP_MAPPERS
+      if (true == isInitialized.load(std::memory_order_acquire)) return;
+
+      std::call_once(initializeFlag, &InitializeFromConfiguration);
+      isInitialized.store(true, std::memory_order_release);
+#endif
+#endif
+    }
+
+    void Initialize(void)
+    {
+#ifndef XIDI_SKIP_CONFIG
+#ifndef XIDI_SKIP_MAPPERS
+      TraceEvents::Register();
+
+      // The thread pool holds a reference to this library until the callback returns, so it
+      // cannot be unloaded while deferred initialization is still in progress. If the callback
+      // cannot be queued then initialization happens right away, as it would without deferral.
+      TP_CALLBACK_ENVIRON callbackEnvironment;
+      InitializeThreadpoolEnvironment(&callbackEnvironment);
+      SetThreadpoolCallbackLibrary(
+          &callbackEnvironment, Infra::ProcessInfo::GetThisModuleInstanceHandle());
+      const bool deferredInitializationQueued =
+          (0 !=
+           TrySubmitThreadpoolCallback(
+               &DeferredInitializeCallback, nullptr, &callbackEnvironment));
+      DestroyThreadpoolEnvironment(&callbackEnvironment);
+
+      if (false == deferredInitializationQueued) EnsureInitialized();
+#else
+      InitializeFromConfiguration();
 #endif
 #endif
     }
@@ -9,6 +9,8 @@
  *   Implementation of hook for CoCreateInstance.
  **************************************************************************************************/
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <string_view>
 
@@ -22,6 +24,37 @@
 
 namespace Xidi
 {
+  /// First 64 bits of `CLSID_DirectInput`, consisting of its first three fields in memory order.
+  /// The class identifiers `CLSID_DirectInput`, `CLSID_DirectInputDevice`, `CLSID_DirectInput8`,
+  /// and `CLSID_DirectInputDevice8` are identical except for bits 0 and 2 of the first field.
+  static constexpr uint64_t kDirectInputClassIdLow = 0x11cfb25925e609e0ull;
+
+  /// Mask that selects the bits of #kDirectInputClassIdLow that are the same for all DirectInput
+  /// class identifiers.
+  static constexpr uint64_t kDirectInputClassIdLowMask = ~0x0000000000000005ull;
+
+  /// Last 64 bits of all DirectInput class identifiers, consisting of the eight bytes of their last
+  /// field in memory order.
+  static constexpr uint64_t kDirectInputClassIdHigh = 0x000054534544c7bfull;
+
+  /// Quickly determines if the specified class identifier could be one of the DirectInput class
+  /// identifiers. This check is intended to reject all other classes with as little work as
+  /// possible, since every COM object creation in the process is checked.
+  /// @param [in] rclsid Class identifier to check.
+  /// @return `true` if the class identifier might identify a DirectInput class, `false` if it
+  /// definitely does not.
+  static inline bool MightBeDirectInputClass(REFCLSID rclsid)
+  {
+    static_assert(sizeof(CLSID) == (2 * sizeof(uint64_t)), "Unexpected class identifier size.");
+
+    uint64_t clsidWords[2];
+    std::memcpy(clsidWords, &rclsid, sizeof(clsidWords));
+
+    return (
+        (kDirectInputClassIdHigh == clsidWords[1]) &&
+        (kDirectInputClassIdLow == (clsidWords[0] & kDirectInputClassIdLowMask)));
+  }
+
   /// Creates an instance of the specified COM object by invoking the provided DllGetClassObject
   /// procedure to retrieve the class factory object.
   static HRESULT CreateInstance(
@@ -96,6 +129,11 @@ namespace Xidi
 HRESULT StaticHook_CoCreateInstance::Hook(
     REFCLSID rclsid, LPUNKNOWN pUnkOuter, DWORD dwClsContext, REFIID riid, LPVOID* ppv)
 {
+  // Most COM objects created by the process have nothing to do with DirectInput, so these are
+  // passed through before anything else happens.
+  if (false == Xidi::MightBeDirectInputClass(rclsid))
+    return Original(rclsid, pUnkOuter, dwClsContext, riid, ppv);
+
   static const HMODULE xidiLibraryHandle =
       LoadLibraryW(Xidi::Strings::GetXidiMainLibraryFilename().data());
   if (nullptr == xidiLibraryHandle)
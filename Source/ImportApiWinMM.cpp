@@ -64,6 +64,7 @@ namespace Xidi
         MMRESULT(__stdcall* joySetCapture)(HWND, UINT, UINT, BOOL);
         MMRESULT(__stdcall* joySetThreshold)(UINT, UINT);
         MMRESULT(__stdcall* timeBeginPeriod)(UINT);
+        MMRESULT(__stdcall* timeEndPeriod)(UINT);
         MMRESULT(__stdcall* timeGetDevCaps)(LPTIMECAPS, UINT);
         DWORD(__stdcall* timeGetTime)(void);
       } named;
@@ -150,6 +151,7 @@ namespace Xidi
             TRY_IMPORT(libraryPath, loadedLibrary, joySetCapture);
             TRY_IMPORT(libraryPath, loadedLibrary, joySetThreshold);
             TRY_IMPORT(libraryPath, loadedLibrary, timeBeginPeriod);
+            TRY_IMPORT(libraryPath, loadedLibrary, timeEndPeriod);
             TRY_IMPORT(libraryPath, loadedLibrary, timeGetDevCaps);
             TRY_IMPORT(libraryPath, loadedLibrary, timeGetTime);
 
@@ -226,6 +228,12 @@ namespace Xidi
       return importTable.named.timeBeginPeriod(uPeriod);
     }
 
+    MMRESULT timeEndPeriod(UINT uPeriod)
+    {
+      if (nullptr == importTable.named.timeEndPeriod) Initialize();
+      return importTable.named.timeEndPeriod(uPeriod);
+    }
+
     MMRESULT timeGetDevCaps(LPTIMECAPS ptc, UINT cbtc)
     {
       if (nullptr == importTable.named.timeGetDevCaps) Initialize();
@@ -12,14 +12,24 @@
 
 #include "ImportApiXInput.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 
 #include <Infra/Core/Message.h>
 #include <Infra/Core/ProcessInfo.h>
 
 #include "ApiWindows.h"
 #include "DllFunctions.h"
+#include "Globals.h"
+#include "StartupTrace.h"
+#include "Strings.h"
+#include "WorkerThread.h"
+#include "XInputTrace.h"
 
 /// Computes the index of the specified named function in the pointer array of the import table.
 #define IMPORT_TABLE_INDEX_OF(name)                                                                \
@@ -61,6 +71,42 @@ namespace Xidi
     /// Holds the imported WinMM API function addresses.
     static UImportTable importTable;
 
+    /// Ordinal of the extended XInput state query, which is not exported by name.
+    static constexpr WORD kXInputGetStateExOrdinal = 100;
+
+    /// Layout of the data filled in by the extended XInput state query. Identical to the standard
+    /// state structure except for some additional trailing data that are not used.
+    struct SXInputStateEx
+    {
+      XINPUT_STATE state;
+      DWORD reserved;
+    };
+
+    /// Holds the address of the extended XInput state query, or `nullptr` if the loaded XInput
+    /// library does not offer it. Kept separate from the import table because, unlike everything
+    /// in the import table, this function is optional.
+    static DWORD(__stdcall* importXInputGetStateEx)(DWORD, SXInputStateEx*);
+
+    /// Holds the address of the capabilities query, or `nullptr` if unavailable. Optional, and
+    /// never available while a trace is being replayed because traces do not record it.
+    static DWORD(__stdcall* importXInputGetCapabilities)(DWORD, DWORD, XINPUT_CAPABILITIES*);
+
+    /// Holds the address of the battery information query, or `nullptr` if unavailable. Optional
+    /// for the same reasons as the capabilities query, and also because older XInput libraries do
+    /// not offer it.
+    static DWORD(__stdcall* importXInputGetBatteryInformation)(
+        DWORD, BYTE, XINPUT_BATTERY_INFORMATION*);
+
+    /// Answers the extended XInput state query from a trace file while replay is active. Recorded
+    /// button state already includes the Guide button if it was recorded using the extended query.
+    /// @param [in] dwUserIndex Identifier of the physical controller being queried.
+    /// @param [out] pStateEx Filled in with the recorded state data.
+    /// @return Recorded XInput result code.
+    static DWORD __stdcall ReplayXInputGetStateEx(DWORD dwUserIndex, SXInputStateEx* pStateEx)
+    {
+      return XInputTrace::ReplayXInputGetState(dwUserIndex, &pStateEx->state);
+    }
+
     /// Shows an error and terminates the process in the event of failure to import a particular
     /// function from the import library.
     /// @param [in] libraryName Name of the library from which the import is being attempted.
@@ -85,6 +131,198 @@ namespace Xidi
       TerminateProcess(Infra::ProcessInfo::GetCurrentProcessHandle(), (UINT)-1);
     }
 
+    /// Number of rounds of calls made to each XInput library when measuring its per-call cost.
+    /// The cheapest round is taken as representative so that preemption during a round does not
+    /// skew the outcome.
+    static constexpr unsigned int kXInputLibraryProbeRounds = 16;
+
+    /// Number of state queries made to each physical controller slot during each round of
+    /// measuring the per-call cost of an XInput library.
+    static constexpr unsigned int kXInputLibraryProbeCallsPerSlot = 8;
+
+    /// Maximum size of the XInput library probe cache file, in bytes.
+    static constexpr DWORD kXInputLibraryProbeCacheFileMaxSizeBytes = 64;
+
+    /// Determines the position of the specified XInput library in the list of supported libraries.
+    /// @param [in] xinputLibraryName Filename of the XInput library to look up.
+    /// @return Index of the library in the list of supported XInput libraries, or no value if it
+    /// is not supported.
+    static std::optional<size_t> XInputLibraryIndexFromName(std::wstring_view xinputLibraryName)
+    {
+      for (size_t i = 0; i < kXInputLibraryNamesOrdered.size(); ++i)
+      {
+        if (xinputLibraryName == kXInputLibraryNamesOrdered[i]) return i;
+      }
+
+      return std::nullopt;
+    }
+
+    /// Retrieves the XInput library selection from the configuration file.
+    /// @return Configured XInput library selection, or an empty string if none is configured.
+    static std::wstring_view GetConfiguredXInputLibrary(void)
+    {
+      const auto& configData = Globals::GetConfigurationData();
+      if (false == configData.Contains(Strings::kStrConfigurationSectionProperties)) return {};
+
+      const auto& propertiesConfigData = configData[Strings::kStrConfigurationSectionProperties];
+      if (false ==
+          propertiesConfigData.Contains(Strings::kStrConfigurationSettingsPropertiesXInputLibrary))
+        return {};
+
+      return propertiesConfigData[Strings::kStrConfigurationSettingsPropertiesXInputLibrary]
+          ->GetString();
+    }
+
+    /// Reads the outcome of a previous measurement of XInput library per-call cost.
+    /// @return Index of the XInput library that was measured to be fastest, or no value if no
+    /// valid measurement outcome is available.
+    static std::optional<size_t> ReadXInputLibraryProbeCache(void)
+    {
+      HANDLE cacheFile = CreateFile(
+          Strings::GetXInputLibraryProbeCacheFilename().data(),
+          GENERIC_READ,
+          FILE_SHARE_READ,
+          nullptr,
+          OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == cacheFile) return std::nullopt;
+
+      wchar_t contents[kXInputLibraryProbeCacheFileMaxSizeBytes / sizeof(wchar_t)] = {};
+      DWORD numBytesRead = 0;
+      const bool readSucceeded =
+          (0 != ReadFile(cacheFile, contents, sizeof(contents), &numBytesRead, nullptr));
+      CloseHandle(cacheFile);
+
+      if (false == readSucceeded) return std::nullopt;
+      return XInputLibraryIndexFromName(
+          std::wstring_view(contents, numBytesRead / sizeof(wchar_t)));
+    }
+
+    /// Records the outcome of measuring XInput library per-call cost so that subsequent processes
+    /// on the same machine can use it without measuring again.
+    /// @param [in] xinputLibraryIndex Index of the XInput library measured to be fastest.
+    static void WriteXInputLibraryProbeCache(size_t xinputLibraryIndex)
+    {
+      const std::wstring cacheFilename(Strings::GetXInputLibraryProbeCacheFilename());
+      const std::wstring_view contents = kXInputLibraryNamesOrdered[xinputLibraryIndex];
+
+      // The cache file is written under a temporary name and then moved into place, so that a
+      // partially-written cache file is never observed.
+      const std::wstring temporaryCacheFilename = cacheFilename + L".tmp";
+      HANDLE cacheFile = CreateFile(
+          temporaryCacheFilename.c_str(),
+          GENERIC_WRITE,
+          0,
+          nullptr,
+          CREATE_ALWAYS,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == cacheFile)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to write XInput library probe cache file %s (last error = %u).",
+            cacheFilename.c_str(),
+            (unsigned int)GetLastError());
+        return;
+      }
+
+      const DWORD contentsSizeBytes = (DWORD)(contents.length() * sizeof(wchar_t));
+      DWORD numBytesWritten = 0;
+      const bool writeSucceeded =
+          ((0 != WriteFile(cacheFile, contents.data(), contentsSizeBytes, &numBytesWritten,
+                           nullptr)) &&
+           (contentsSizeBytes == numBytesWritten));
+      CloseHandle(cacheFile);
+
+      if ((false == writeSucceeded) ||
+          (0 ==
+           MoveFileEx(
+               temporaryCacheFilename.c_str(), cacheFilename.c_str(), MOVEFILE_REPLACE_EXISTING)))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to write XInput library probe cache file %s (last error = %u).",
+            cacheFilename.c_str(),
+            (unsigned int)GetLastError());
+        DeleteFile(temporaryCacheFilename.c_str());
+      }
+    }
+
+    /// Measures the per-call cost of the state query in each loadable XInput library and records
+    /// which one is fastest. Querying every slot includes the cost of querying empty slots, which
+    /// differs considerably between XInput libraries. Intended to run on a background thread, and
+    /// affects only the XInput library selected by subsequent processes.
+    static void ProbeXInputLibraries(void)
+    {
+      LARGE_INTEGER performanceFrequency = {};
+      QueryPerformanceFrequency(&performanceFrequency);
+
+      std::optional<size_t> fastestLibraryIndex;
+      int64_t fastestLibraryRoundTicks = INT64_MAX;
+
+      for (size_t i = 0; i < kXInputLibraryNamesOrdered.size(); ++i)
+      {
+        HMODULE probedLibrary = LoadLibraryEx(kXInputLibraryNamesOrdered[i], nullptr, 0);
+        if (nullptr == probedLibrary) continue;
+
+        const auto probedXInputGetState =
+            reinterpret_cast<decltype(importTable.named.XInputGetState)>(
+                GetProcAddress(probedLibrary, "XInputGetState"));
+        if (nullptr == probedXInputGetState)
+        {
+          FreeLibrary(probedLibrary);
+          continue;
+        }
+
+        int64_t cheapestRoundTicks = INT64_MAX;
+        for (unsigned int round = 0; round < kXInputLibraryProbeRounds; ++round)
+        {
+          LARGE_INTEGER roundBegin = {};
+          LARGE_INTEGER roundEnd = {};
+
+          QueryPerformanceCounter(&roundBegin);
+          for (unsigned int call = 0; call < kXInputLibraryProbeCallsPerSlot; ++call)
+          {
+            for (DWORD userIndex = 0; userIndex < XUSER_MAX_COUNT; ++userIndex)
+            {
+              XINPUT_STATE unusedState;
+              probedXInputGetState(userIndex, &unusedState);
+            }
+          }
+          QueryPerformanceCounter(&roundEnd);
+
+          cheapestRoundTicks =
+              std::min(cheapestRoundTicks, roundEnd.QuadPart - roundBegin.QuadPart);
+        }
+
+        FreeLibrary(probedLibrary);
+
+        constexpr unsigned int kCallsPerRound = kXInputLibraryProbeCallsPerSlot * XUSER_MAX_COUNT;
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Measured XInput state query cost of %s at %.3f microseconds per call.",
+            kXInputLibraryNamesOrdered[i],
+            ((double)cheapestRoundTicks * 1000000.0) /
+                ((double)performanceFrequency.QuadPart * (double)kCallsPerRound));
+
+        if (cheapestRoundTicks < fastestLibraryRoundTicks)
+        {
+          fastestLibraryIndex = i;
+          fastestLibraryRoundTicks = cheapestRoundTicks;
+        }
+      }
+
+      if (false == fastestLibraryIndex.has_value()) return;
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Selected %s as the fastest XInput library, effective the next time XInput functions are imported.",
+          kXInputLibraryNamesOrdered[*fastestLibraryIndex]);
+      WriteXInputLibraryProbeCache(*fastestLibraryIndex);
+    }
+
     void Initialize(void)
     {
       static std::once_flag initializeFlag;
@@ -92,15 +330,56 @@ namespace Xidi
           initializeFlag,
           []() -> void
           {
-            // Try loading each possible DLL, in order from most preferred to least preferred.
-            constexpr std::array kXInputLibraryNamesOrdered = {
-                L"xinput1_4.dll",
-                L"xinput1_3.dll",
-                L"xinput1_2.dll",
-                L"xinput1_1.dll",
-                L"xinput9_1_0.dll"};
-
-            for (const auto& xinputLibraryName : kXInputLibraryNamesOrdered)
+            const StartupTrace::ScopedPhase initializePhase(L"ImportApiXInput::Initialize");
+
+            // A trace being replayed takes the place of the native XInput library entirely.
+            if (true == XInputTrace::IsReplaying())
+            {
+              importTable.named.XInputGetState = &XInputTrace::ReplayXInputGetState;
+              importTable.named.XInputSetState = &XInputTrace::ReplayXInputSetState;
+              importXInputGetStateEx = &ReplayXInputGetStateEx;
+
+              Infra::Message::Output(
+                  Infra::Message::ESeverity::Info,
+                  L"Replaying XInput state queries from a trace file instead of importing XInput functions.");
+              return;
+            }
+
+            // An explicitly-configured XInput library, or the one previously measured to be
+            // fastest, is tried first. All others are then tried in order from most preferred to
+            // least preferred. If the fastest library is requested but has not yet been measured,
+            // the measurement happens in the background and takes effect in subsequent processes.
+            const std::wstring_view configuredXInputLibrary = GetConfiguredXInputLibrary();
+            std::optional<size_t> firstXInputLibraryIndex;
+
+            if (Strings::kStrConfigurationValueXInputLibraryFastest == configuredXInputLibrary)
+            {
+              firstXInputLibraryIndex = ReadXInputLibraryProbeCache();
+              if (false == firstXInputLibraryIndex.has_value())
+              {
+                Infra::Message::Output(
+                    Infra::Message::ESeverity::Info,
+                    L"Measuring the per-call cost of each XInput library in the background.");
+                WorkerThread::StartDetached(
+                    L"Xidi XInput Library Probe",
+                    WorkerThread::EPriority::Housekeeping,
+                    ProbeXInputLibraries);
+              }
+            }
+            else if (false == configuredXInputLibrary.empty())
+            {
+              firstXInputLibraryIndex = XInputLibraryIndexFromName(configuredXInputLibrary);
+            }
+
+            std::array<const wchar_t*, kXInputLibraryNamesOrdered.size()> xinputLibraryNames =
+                kXInputLibraryNamesOrdered;
+            if (true == firstXInputLibraryIndex.has_value())
+              std::rotate(
+                  xinputLibraryNames.begin(),
+                  std::next(xinputLibraryNames.begin(), *firstXInputLibraryIndex),
+                  std::next(xinputLibraryNames.begin(), *firstXInputLibraryIndex + 1));
+
+            for (const auto& xinputLibraryName : xinputLibraryNames)
             {
               // Initialize the import table.
               ZeroMemory(&importTable, sizeof(importTable));
@@ -125,6 +404,29 @@ namespace Xidi
               IMPORT_OR_TERMINATE(xinputLibraryName, loadedLibrary, XInputGetState);
               IMPORT_OR_TERMINATE(xinputLibraryName, loadedLibrary, XInputSetState);
 
+              // The extended state query is optional, and its absence is not an error.
+              importXInputGetStateEx =
+                  reinterpret_cast<decltype(importXInputGetStateEx)>(GetProcAddress(
+                      loadedLibrary, MAKEINTRESOURCEA(kXInputGetStateExOrdinal)));
+              if (nullptr != importXInputGetStateEx)
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Info,
+                    L"Extended XInput state query is available from %s.",
+                    xinputLibraryName);
+              else
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Info,
+                    L"Extended XInput state query is not available from %s.",
+                    xinputLibraryName);
+
+              // Capabilities and battery information queries are likewise optional.
+              importXInputGetCapabilities =
+                  reinterpret_cast<decltype(importXInputGetCapabilities)>(
+                      GetProcAddress(loadedLibrary, "XInputGetCapabilities"));
+              importXInputGetBatteryInformation =
+                  reinterpret_cast<decltype(importXInputGetBatteryInformation)>(
+                      GetProcAddress(loadedLibrary, "XInputGetBatteryInformation"));
+
               // Initialization complete.
               Infra::Message::OutputFormatted(
                   Infra::Message::ESeverity::Info,
@@ -147,5 +449,39 @@ namespace Xidi
       if (nullptr == importTable.named.XInputSetState) Initialize();
       return importTable.named.XInputSetState(dwUserIndex, pVibration);
     }
+
+    bool IsXInputGetStateExAvailable(void)
+    {
+      Initialize();
+      return (nullptr != importXInputGetStateEx);
+    }
+
+    DWORD XInputGetStateEx(DWORD dwUserIndex, XINPUT_STATE* pState)
+    {
+      if (nullptr == importTable.named.XInputGetState) Initialize();
+      if (nullptr == importXInputGetStateEx)
+        return importTable.named.XInputGetState(dwUserIndex, pState);
+
+      SXInputStateEx stateEx;
+      const DWORD result = importXInputGetStateEx(dwUserIndex, &stateEx);
+      *pState = stateEx.state;
+      return result;
+    }
+
+    DWORD XInputGetCapabilities(
+        DWORD dwUserIndex, DWORD dwFlags, XINPUT_CAPABILITIES* pCapabilities)
+    {
+      Initialize();
+      if (nullptr == importXInputGetCapabilities) return ERROR_NOT_SUPPORTED;
+      return importXInputGetCapabilities(dwUserIndex, dwFlags, pCapabilities);
+    }
+
+    DWORD XInputGetBatteryInformation(
+        DWORD dwUserIndex, BYTE devType, XINPUT_BATTERY_INFORMATION* pBatteryInformation)
+    {
+      Initialize();
+      if (nullptr == importXInputGetBatteryInformation) return ERROR_NOT_SUPPORTED;
+      return importXInputGetBatteryInformation(dwUserIndex, devType, pBatteryInformation);
+    }
   } // namespace ImportApiXInput
 } // namespace Xidi
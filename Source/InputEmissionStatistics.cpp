@@ -0,0 +1,152 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file InputEmissionStatistics.cpp
+ *   Implementation of counters that describe keyboard and mouse input submitted to the system.
+ **************************************************************************************************/
+
+#include "InputEmissionStatistics.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "AsyncLog.h"
+#include "TraceEvents.h"
+
+namespace Xidi
+{
+  /// Amount of time between summaries of the collected statistics, in seconds.
+  static constexpr int64_t kSummaryPeriodSeconds = 60;
+
+  /// Retrieves and returns the frequency of the performance counter.
+  /// @return Number of performance counter ticks per second.
+  static int64_t PerformanceCounterFrequency(void)
+  {
+    static const int64_t kFrequency = []() -> int64_t
+    {
+      LARGE_INTEGER frequency;
+      QueryPerformanceFrequency(&frequency);
+      return frequency.QuadPart;
+    }();
+
+    return kFrequency;
+  }
+
+  InputEmissionStatistics::InputEmissionStatistics(std::wstring_view emitterName)
+      : emitterName(emitterName),
+        numTicks(0),
+        numTransitions(0),
+        numSendInputCalls(0),
+        numSendInputFailures(0),
+        numEventsSent(0),
+        totalSendInputTicks(0),
+        numLatencySamples(0),
+        totalLatencyTicks(0),
+        maxLatencyTicks(0),
+        nextSummaryTicks(0)
+  {}
+
+  int64_t InputEmissionStatistics::Now(void)
+  {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+  }
+
+  InputEmissionStatistics::SStatistics InputEmissionStatistics::GetStatistics(void) const
+  {
+    return {
+        .numTicks = numTicks.load(std::memory_order_relaxed),
+        .numTransitions = numTransitions.load(std::memory_order_relaxed),
+        .numSendInputCalls = numSendInputCalls.load(std::memory_order_relaxed),
+        .numSendInputFailures = numSendInputFailures.load(std::memory_order_relaxed),
+        .numEventsSent = numEventsSent.load(std::memory_order_relaxed),
+        .totalSendInputMicroseconds =
+            TicksToMicroseconds(totalSendInputTicks.load(std::memory_order_relaxed)),
+        .numLatencySamples = numLatencySamples.load(std::memory_order_relaxed),
+        .totalLatencyMicroseconds =
+            TicksToMicroseconds(totalLatencyTicks.load(std::memory_order_relaxed)),
+        .maxLatencyMicroseconds =
+            TicksToMicroseconds(maxLatencyTicks.load(std::memory_order_relaxed))};
+  }
+
+  void InputEmissionStatistics::OutputSummaryIfDue(int64_t nowTicks)
+  {
+    const int64_t kSummaryPeriodTicks = kSummaryPeriodSeconds * PerformanceCounterFrequency();
+
+    if (0 == nextSummaryTicks)
+    {
+      nextSummaryTicks = nowTicks + kSummaryPeriodTicks;
+      return;
+    }
+
+    if (nowTicks < nextSummaryTicks) return;
+    nextSummaryTicks = nowTicks + kSummaryPeriodTicks;
+
+    if (false == AsyncLog::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Debug))
+      return;
+
+    const SStatistics statistics = GetStatistics();
+    Infra::Message::OutputFormatted(
+        Infra::Message::ESeverity::Debug,
+        L"%.*s emitter statistics: %llu ticks, %llu transitions, %llu events sent in %llu SendInput calls (%llu failed, %llu us total), average latency %llu us, maximum latency %llu us.",
+        (int)emitterName.length(),
+        emitterName.data(),
+        statistics.numTicks,
+        statistics.numTransitions,
+        statistics.numEventsSent,
+        statistics.numSendInputCalls,
+        statistics.numSendInputFailures,
+        statistics.totalSendInputMicroseconds,
+        ((0 == statistics.numLatencySamples)
+             ? 0ull
+             : (statistics.totalLatencyMicroseconds / statistics.numLatencySamples)),
+        statistics.maxLatencyMicroseconds);
+  }
+
+  void InputEmissionStatistics::RecordLatency(int64_t contributionTicks, int64_t emissionTicks)
+  {
+    const int64_t latencyTicks = emissionTicks - contributionTicks;
+    if (latencyTicks < 0) return;
+
+    numLatencySamples.fetch_add(1, std::memory_order_relaxed);
+    totalLatencyTicks.fetch_add(latencyTicks, std::memory_order_relaxed);
+
+    // Only the emitter records latency, so there is no competing writer for the maximum.
+    if (latencyTicks > maxLatencyTicks.load(std::memory_order_relaxed))
+      maxLatencyTicks.store(latencyTicks, std::memory_order_relaxed);
+  }
+
+  UINT InputEmissionStatistics::SendInput(std::vector<INPUT>& inputEvents)
+  {
+    const int64_t startTicks = Now();
+    const UINT numSent =
+        ::SendInput((UINT)inputEvents.size(), inputEvents.data(), (int)sizeof(INPUT));
+    const int64_t endTicks = Now();
+    TraceEvents::SendInputBatch(emitterName, (UINT)inputEvents.size(), numSent);
+
+    numSendInputCalls.fetch_add(1, std::memory_order_relaxed);
+    numEventsSent.fetch_add(numSent, std::memory_order_relaxed);
+    totalSendInputTicks.fetch_add(endTicks - startTicks, std::memory_order_relaxed);
+
+    if (numSent != (UINT)inputEvents.size())
+      numSendInputFailures.fetch_add(1, std::memory_order_relaxed);
+
+    return numSent;
+  }
+
+  uint64_t InputEmissionStatistics::TicksToMicroseconds(int64_t ticks)
+  {
+    if (ticks <= 0) return 0;
+    return (uint64_t)((ticks * 1000000) / PerformanceCounterFrequency());
+  }
+} // namespace Xidi
@@ -0,0 +1,173 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file InputLatencyTrace.cpp
+ *   Implementation of functionality for measuring how long physical controller input takes to
+ *   reach the application.
+ **************************************************************************************************/
+
+#include "InputLatencyTrace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "ConcurrencyWrapper.h"
+#include "ControllerTypes.h"
+#include "DurationHistogram.h"
+#include "Globals.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace InputLatencyTrace
+    {
+      /// Names of each stage, used when outputting summaries. Must be in the same order as the
+      /// stage enumerators.
+      static constexpr std::wstring_view kStageNames[] = {
+          L"Mapping", L"Publication", L"Delivery", L"ApplicationRead", L"EndToEnd"};
+      static_assert(_countof(kStageNames) == (unsigned int)EStage::Count);
+
+      /// Most recently submitted sample for each physical controller.
+      static SeqLockConcurrencyWrapper<SSample> submittedSample[kMaxPhysicalControllerCount];
+
+      /// Generation of the most recently submitted sample that an application read has already
+      /// completed, for each physical controller.
+      static std::atomic<TGeneration> completedSampleGeneration[kMaxPhysicalControllerCount];
+
+      /// Distribution of durations of each stage for each physical controller.
+      static DurationHistogram
+          stageHistogram[kMaxPhysicalControllerCount][(unsigned int)EStage::Count];
+
+      /// Retrieves and returns the frequency of the performance counter.
+      /// @return Number of performance counter ticks per second.
+      static int64_t PerformanceCounterFrequency(void)
+      {
+        static const int64_t kFrequency = []() -> int64_t
+        {
+          LARGE_INTEGER frequency;
+          QueryPerformanceFrequency(&frequency);
+          return frequency.QuadPart;
+        }();
+
+        return kFrequency;
+      }
+
+      /// Converts the interval between two performance counter values to microseconds.
+      /// @param [in] beginTicks Performance counter value at the start of the interval.
+      /// @param [in] endTicks Performance counter value at the end of the interval.
+      /// @return Length of the interval in microseconds, or 0 if it is negative.
+      static uint64_t IntervalMicroseconds(int64_t beginTicks, int64_t endTicks)
+      {
+        if (endTicks <= beginTicks) return 0;
+        return (uint64_t)(((endTicks - beginTicks) * 1000000) / PerformanceCounterFrequency());
+      }
+
+      bool IsEnabled(void)
+      {
+        static const bool kInputLatencyTraceEnabled =
+            Globals::GetConfigurationData()[Strings::kStrConfigurationSectionLog]
+                                           [Strings::kStrConfigurationSettingLogInputLatencyTrace]
+                                               .ValueOr(false);
+
+        return kInputLatencyTraceEnabled;
+      }
+
+      int64_t Stamp(void)
+      {
+        if (false == IsEnabled()) return 0;
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+      }
+
+      void SubmitSample(TControllerIdentifier controllerIdentifier, const SSample& sample)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+        if (0 == sample.xinputTicks) return;
+
+        submittedSample[controllerIdentifier].Set(sample);
+      }
+
+      void RecordApplicationRead(TControllerIdentifier controllerIdentifier)
+      {
+        if (false == IsEnabled()) return;
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        const int64_t readTicks = Stamp();
+
+        TGeneration sampleGeneration = 0;
+        const SSample sample = submittedSample[controllerIdentifier].Get(sampleGeneration);
+        if (0 == sample.xinputTicks) return;
+
+        // Only the first read of each sample completes it. Whichever reader manages to advance
+        // the completed generation is the one that records the sample.
+        TGeneration completedGeneration =
+            completedSampleGeneration[controllerIdentifier].load(std::memory_order_relaxed);
+        do
+        {
+          if (sampleGeneration <= completedGeneration) return;
+        } while (false ==
+                 completedSampleGeneration[controllerIdentifier].compare_exchange_weak(
+                     completedGeneration, sampleGeneration, std::memory_order_relaxed));
+
+        const uint64_t stageMicroseconds[] = {
+            IntervalMicroseconds(sample.xinputTicks, sample.mappedTicks),
+            IntervalMicroseconds(sample.mappedTicks, sample.publishedTicks),
+            IntervalMicroseconds(sample.publishedTicks, sample.deliveredTicks),
+            IntervalMicroseconds(sample.deliveredTicks, readTicks),
+            IntervalMicroseconds(sample.xinputTicks, readTicks)};
+        static_assert(_countof(stageMicroseconds) == (unsigned int)EStage::Count);
+
+        for (unsigned int i = 0; i < _countof(stageMicroseconds); ++i)
+          stageHistogram[controllerIdentifier][i].Record(stageMicroseconds[i]);
+      }
+
+      SStageStatistics GetStatistics(TControllerIdentifier controllerIdentifier, EStage stage)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return {};
+        if ((unsigned int)stage >= (unsigned int)EStage::Count) return {};
+
+        return stageHistogram[controllerIdentifier][(unsigned int)stage].GetStatistics();
+      }
+
+      void OutputSummary(void)
+      {
+        if (false == IsEnabled()) return;
+        if (false == Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Info))
+          return;
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kMaxPhysicalControllerCount;
+             ++controllerIdentifier)
+        {
+          for (unsigned int i = 0; i < (unsigned int)EStage::Count; ++i)
+          {
+            const SStageStatistics statistics = GetStatistics(controllerIdentifier, (EStage)i);
+            if (0 == statistics.numSamples) continue;
+
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Info,
+                L"Input latency for physical controller %u, stage %s: %llu samples, p50 %llu us, p99 %llu us, maximum %llu us.",
+                (unsigned int)(1 + controllerIdentifier),
+                kStageNames[i].data(),
+                statistics.numSamples,
+                statistics.p50Microseconds,
+                statistics.p99Microseconds,
+                statistics.maxMicroseconds);
+          }
+        }
+      }
+    } // namespace InputLatencyTrace
+  } // namespace Controller
+} // namespace Xidi
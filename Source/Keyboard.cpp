@@ -12,8 +12,16 @@
 
 #include "Keyboard.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <optional>
 #include <stop_token>
 #include <thread>
 #include <vector>
@@ -24,48 +32,86 @@
 #include "ApiWindows.h"
 #include "ControllerTypes.h"
 #include "Globals.h"
+#include "InputEmissionStatistics.h"
+#include "ProfiledMutex.h"
+#include "Settings.h"
+#include "Strings.h"
+#include "WorkerThread.h"
 
 namespace Xidi
 {
   namespace Keyboard
   {
+#ifndef XIDI_SKIP_INPUT_EMISSION
     /// Type used to represent the state of an entire virtual keyboard.
     using TState = BitSet<kVirtualKeyboardKeyCount>;
 
+    /// Number of bits in each word of the arrays used to hold marked key contributions.
+    static constexpr unsigned int kBitsPerContributionWord = 64;
+
+    /// Number of words needed to hold one bit for each virtual keyboard key.
+    static constexpr unsigned int kNumContributionWords =
+        kVirtualKeyboardKeyCount / kBitsPerContributionWord;
+
+    static_assert(
+        0 == (kVirtualKeyboardKeyCount % kBitsPerContributionWord),
+        "Virtual keyboard key count must be a multiple of the contribution word size.");
+
     /// Tracks "pressed" and "released" key state contributions and generates keyboard state
-    /// snapshots.
+    /// snapshots. Contributions are registered using atomic operations on arrays of words so that
+    /// submissions from multiple threads never need to acquire a lock. The lock this object holds
+    /// is only needed by the consumers of keyboard state snapshots.
     class StateContributionTracker
     {
     public:
 
       inline StateContributionTracker(void)
+          : pressedKeys(),
+            notReleasedKeys(),
+            hasContributions(false),
+            keyboardStateGuard(L"Keyboard::keyboardStateGuard"),
+            earliestContributionTicks(0),
+            contributionsAvailable(),
+            waitingForContributions(false)
+      {
+        for (auto& notReleasedKeysWord : notReleasedKeys)
+          notReleasedKeysWord.store(~0ull, std::memory_order_relaxed);
+      }
+
+      /// Determines if any key press or key release contributions have been registered since the
+      /// last snapshot.
+      /// @return `true` if contributions have been registered, `false` if not.
+      inline bool HasContributions(void) const
       {
-        Reset();
+        return hasContributions.load(std::memory_order_relaxed);
       }
 
       /// Determines if the specified key is marked as having been pressed since the last snapshot.
       /// A key marked pressed can also be marked released. The two are not mutually exclusive.
       /// @param [in] key Identifier of the keyboard key of interest.
       /// @return `true` if it is marked pressed, `false` if not.
-      constexpr bool IsMarkedPressed(TKeyIdentifier key) const
+      inline bool IsMarkedPressed(TKeyIdentifier key) const
       {
-        return pressedKeys.contains(key);
+        return (0 !=
+                (pressedKeys[WordIndex(key)].load(std::memory_order_relaxed) & WordBitMask(key)));
       }
 
       /// Determines if the specified key is marked as having been released since the last snapshot.
       /// A key marked released can also be marked pressed. The two are not mutually exclusive.
       /// @param [in] key Identifier of the keyboard key of interest.
       /// @return `true` if it is marked released, `false` if not.
-      constexpr bool IsMarkedReleased(TKeyIdentifier key) const
+      inline bool IsMarkedReleased(TKeyIdentifier key) const
       {
-        return !(notReleasedKeys.contains(key));
+        return (0 ==
+                (notReleasedKeys[WordIndex(key)].load(std::memory_order_relaxed) &
+                 WordBitMask(key)));
       }
 
-      /// Locks this object for ensuring proper concurrency control.
-      /// The returned lock object is scoped and, as a result, will automatically unlock upon its
-      /// destruction.
+      /// Locks this object for ensuring proper concurrency control among consumers of keyboard
+      /// state snapshots. The returned lock object is scoped and, as a result, will automatically
+      /// unlock upon its destruction.
       /// @return Scoped lock object that has acquired this object's concurrency control mutex.
-      inline std::unique_lock<std::mutex> Lock(void)
+      inline std::unique_lock<ProfiledMutex<std::mutex>> Lock(void)
       {
         return std::unique_lock(keyboardStateGuard);
       }
@@ -73,62 +119,412 @@ namespace Xidi
       /// Registers a key press contribution.
       /// Has no effect if the key is already marked as being pressed since the last snapshot.
       /// @param [in] key Identifier of the target keyboard key.
-      constexpr void MarkPressed(TKeyIdentifier key)
+      inline void MarkPressed(TKeyIdentifier key)
       {
-        pressedKeys.insert(key);
+        pressedKeys[WordIndex(key)].fetch_or(WordBitMask(key), std::memory_order_release);
+        hasContributions.store(true, std::memory_order_relaxed);
+        RecordContributionTime();
       }
 
       /// Registers a key release contribution.
       /// Has no effect if the key is already marked as being released since the last snapshot.
       /// @param [in] key Identifier of the target keyboard key.
-      constexpr void MarkRelease(TKeyIdentifier key)
+      inline void MarkRelease(TKeyIdentifier key)
+      {
+        notReleasedKeys[WordIndex(key)].fetch_and(~WordBitMask(key), std::memory_order_release);
+        hasContributions.store(true, std::memory_order_relaxed);
+        RecordContributionTime();
+      }
+
+      /// Registers all of the key press and key release contributions collected by a submission
+      /// batch. Performs at most one atomic operation per word.
+      /// @param [in] batchPressedKeys Keys submitted as pressed while the batch was open.
+      /// @param [in] batchReleasedKeys Keys submitted as released while the batch was open.
+      void MarkBatch(const TState& batchPressedKeys, const TState& batchReleasedKeys)
+      {
+        uint64_t pressedKeysMasks[kNumContributionWords] = {};
+        uint64_t releasedKeysMasks[kNumContributionWords] = {};
+
+        for (auto key : batchPressedKeys)
+          pressedKeysMasks[WordIndex((TKeyIdentifier)key)] |= WordBitMask((TKeyIdentifier)key);
+
+        for (auto key : batchReleasedKeys)
+          releasedKeysMasks[WordIndex((TKeyIdentifier)key)] |= WordBitMask((TKeyIdentifier)key);
+
+        for (unsigned int i = 0; i < kNumContributionWords; ++i)
+        {
+          if (0 != pressedKeysMasks[i])
+            pressedKeys[i].fetch_or(pressedKeysMasks[i], std::memory_order_release);
+
+          if (0 != releasedKeysMasks[i])
+            notReleasedKeys[i].fetch_and(~releasedKeysMasks[i], std::memory_order_release);
+        }
+
+        hasContributions.store(true, std::memory_order_relaxed);
+        RecordContributionTime();
+      }
+
+      /// Wakes up the keyboard update thread if it is waiting for contributions. Should be invoked
+      /// after registering contributions. Only acquires this object's lock if the keyboard update
+      /// thread is actually waiting.
+      inline void NotifyContributions(void)
       {
-        notReleasedKeys.erase(key);
+        // Pairs with the fence in the waiting thread. Either this thread sees that the keyboard
+        // update thread is waiting, or the keyboard update thread sees these contributions before
+        // waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (true == waitingForContributions.load(std::memory_order_relaxed))
+        {
+          auto lock = Lock();
+          contributionsAvailable.notify_one();
+        }
+      }
+
+      /// Retrieves the time of the earliest contribution registered since the last time this
+      /// method was invoked, and resets it so that the next contribution is recorded.
+      /// @return Performance counter value at the time of the earliest contribution, or 0 if there
+      /// have been no contributions.
+      inline int64_t TakeEarliestContributionTicks(void)
+      {
+        return earliestContributionTicks.exchange(0, std::memory_order_relaxed);
       }
 
       /// Computes the next keyboard snapshot by applying the marked changes to the specified
       /// previous snapshot. Afterwards, resets internal state so no keys are marked as pressed or
-      /// released.
+      /// released. The caller must hold this object's lock.
       /// @param [in] previousSnapshot Previous snapshot against which to apply the marked changes.
-      constexpr TState SnapshotRelativeTo(const TState& previousSnapshot)
+      TState SnapshotRelativeTo(const TState& previousSnapshot)
       {
+        hasContributions.store(false, std::memory_order_relaxed);
+
+        TState pressedKeysSnapshot;
+        TState notReleasedKeysSnapshot;
+
+        for (unsigned int i = 0; i < kNumContributionWords; ++i)
+        {
+          // Releases are swapped out before presses. A key that is pressed and then released while
+          // this snapshot is being taken therefore either appears pressed now and released in the
+          // next snapshot, or is entirely deferred to the next snapshot. It can never get stuck in
+          // the pressed state.
+          const uint64_t notReleasedKeysWord =
+              notReleasedKeys[i].exchange(~0ull, std::memory_order_acquire);
+          const uint64_t pressedKeysWord = pressedKeys[i].exchange(0, std::memory_order_acquire);
+
+          InsertWordIntoState(notReleasedKeysSnapshot, i, notReleasedKeysWord);
+          InsertWordIntoState(pressedKeysSnapshot, i, pressedKeysWord);
+        }
+
         // If a key is marked pressed since the last snapshot, then no matter what it is pressed in
         // the next snapshot. Otherwise, a key continues to be pressed if it was pressed in the last
         // snapshot and not released since.
-        const TState nextSnapshot = pressedKeys | (previousSnapshot & notReleasedKeys);
-
-        Reset();
-        return nextSnapshot;
+        return (pressedKeysSnapshot | (previousSnapshot & notReleasedKeysSnapshot));
       }
 
       /// Computes a keyboard state snapshot using only the marked changes.
       /// Afterwards, resets internal state so no keys are marked as pressed or released.
-      constexpr TState Snapshot(void)
+      inline TState Snapshot(void)
       {
         return SnapshotRelativeTo(TState());
       }
 
-      /// Resets all marked contributions back to empty.
-      constexpr void Reset(void)
+      /// Blocks until contributions are registered or a stop is requested.
+      /// @param [in] lock Scoped lock object that has acquired this object's lock.
+      /// @param [in] stopToken Stop token used to indicate that waiting should end early.
+      inline void WaitForContributions(
+          std::unique_lock<ProfiledMutex<std::mutex>>& lock, std::stop_token stopToken)
       {
-        pressedKeys.clear();
-        notReleasedKeys.fill();
+        waitingForContributions.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        contributionsAvailable.wait(
+            lock,
+            stopToken,
+            [this]() -> bool
+            {
+              return HasContributions();
+            });
+
+        waitingForContributions.store(false, std::memory_order_relaxed);
       }
 
     private:
 
-      /// Set of keys marked "pressed" since the last snapshot.
-      TState pressedKeys;
+      /// Records the time of a contribution if it is the earliest one since the last time the
+      /// earliest contribution time was taken.
+      inline void RecordContributionTime(void)
+      {
+        if (0 != earliestContributionTicks.load(std::memory_order_relaxed)) return;
+
+        int64_t expected = 0;
+        earliestContributionTicks.compare_exchange_strong(
+            expected, InputEmissionStatistics::Now(), std::memory_order_relaxed);
+      }
+
+      /// Determines which contribution word holds the bit for the specified key.
+      /// @param [in] key Identifier of the keyboard key of interest.
+      /// @return Index of the contribution word.
+      static constexpr unsigned int WordIndex(TKeyIdentifier key)
+      {
+        return (key / kBitsPerContributionWord);
+      }
+
+      /// Generates a mask that selects the bit for the specified key within its contribution word.
+      /// @param [in] key Identifier of the keyboard key of interest.
+      /// @return Mask with only the bit for the key set.
+      static constexpr uint64_t WordBitMask(TKeyIdentifier key)
+      {
+        return (1ull << (key % kBitsPerContributionWord));
+      }
 
-      /// Inverted set of keys marked "released" since the last snapshot.
+      /// Adds to a keyboard state object all of the keys whose bits are set in a contribution word.
+      /// @param [in, out] state Keyboard state object to which keys are added.
+      /// @param [in] wordIndex Index of the contribution word.
+      /// @param [in] word Contents of the contribution word.
+      static inline void InsertWordIntoState(TState& state, unsigned int wordIndex, uint64_t word)
+      {
+        while (0 != word)
+        {
+          state.insert((wordIndex * kBitsPerContributionWord) + std::countr_zero(word));
+          word &= (word - 1);
+        }
+      }
+
+      /// Set of keys marked "pressed" since the last snapshot, one bit per key.
+      std::array<std::atomic<uint64_t>, kNumContributionWords> pressedKeys;
+
+      /// Inverted set of keys marked "released" since the last snapshot, one bit per key.
       /// Keys present in this set have not been marked released since the last snapshot.
-      TState notReleasedKeys;
+      std::array<std::atomic<uint64_t>, kNumContributionWords> notReleasedKeys;
+
+      /// Whether or not any contributions have been registered since the last snapshot.
+      std::atomic<bool> hasContributions;
+
+      /// Performance counter value at the time of the earliest contribution registered since it
+      /// was last taken, or 0 if there have been none.
+      std::atomic<int64_t> earliestContributionTicks;
+
+      /// For ensuring proper concurrency control among consumers of keyboard state snapshots.
+      ProfiledMutex<std::mutex> keyboardStateGuard;
+
+      /// Signalled when contributions are registered while the keyboard update thread is waiting.
+      std::condition_variable_any contributionsAvailable;
+
+      /// Whether or not the keyboard update thread is waiting for contributions.
+      std::atomic<bool> waitingForContributions;
+    };
+
+    /// Retrieves the desired physical keyboard update period, which can be customized in the
+    /// configuration file.
+    /// @return Keyboard update period in milliseconds.
+    static unsigned int GetKeyboardUpdatePeriodMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.keyboardPeriodMilliseconds;
+    }
 
-      /// For ensuring proper concurrency control of accesses to the virtual keyboard state
-      /// represented by this object.
-      std::mutex keyboardStateGuard;
+    /// Retrieves the desired amount of time a virtual keyboard key must be held before it starts
+    /// repeating, which can be customized in the configuration file.
+    /// @return Key repeat delay in milliseconds, or 0 if key repeat is disabled.
+    static unsigned int GetKeyboardRepeatDelayMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.keyboardRepeatDelayMilliseconds;
+    }
+
+    /// Retrieves the desired amount of time between repeats of a held virtual keyboard key, which
+    /// can be customized in the configuration file.
+    /// @return Key repeat period in milliseconds.
+    static unsigned int GetKeyboardRepeatPeriodMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.keyboardRepeatPeriodMilliseconds;
+    }
+
+    /// Determines if virtual keyboard state should be updated synchronously, at the end of each
+    /// submission, instead of by the keyboard update thread. Can be enabled in the configuration
+    /// file and is implied by the DirectInput keyboard backend and by cooperative mode.
+    /// @return `true` if synchronous submission is enabled, `false` otherwise.
+    static bool IsSynchronousSubmissionEnabled(void)
+    {
+      const SSettings::SProperties& settings = Globals::GetSettings().properties;
+
+      return (true == settings.keyboardDirectInput) || (true == settings.cooperativeMode) ||
+          (true == settings.keyboardSynchronous);
+    }
+
+    /// Generates the proper flags indicating how the scan code should be interpreted for the given
+    /// keyboard key.
+    /// @param [in] key Keyboard key identifier.
+    /// @return Flags indicating how the scan code corresponding to the identified key should be
+    /// interpreted.
+    static inline DWORD KeyboardEventFlags(TKeyIdentifier key)
+    {
+      // Any key identifiers higher than the maximum 7-bit value are "extended" keys and need to be
+      // flagged as such.
+      if (key > 0x7f)
+        return (KEYEVENTF_SCANCODE | KEYEVENTF_EXTENDEDKEY);
+      else
+        return KEYEVENTF_SCANCODE;
+    }
+
+    /// Generates the proper 16-bit scan code for the given keyboard key.
+    /// @param [in] key Keyboard key identifier.
+    /// @return Proper 16-bit scan code to use for the key.
+    static inline WORD KeyboardEventScanCode(TKeyIdentifier key)
+    {
+      // Only the bottom 7 bits of the key identifier are used.
+      // Any key identifiers higher than the maximum 7-bit value are "extended" keys for which a
+      // prefix of 0xe0 is needed in the full 16-bit quantity.
+      if (key > 0x7f)
+        return ((0xe0 << 8) | (key & 0x7f));
+      else
+        return key;
+    }
+
+    /// Generates keyboard input events for all of the keys whose states differ between two
+    /// keyboard state snapshots and appends them to the supplied container.
+    /// @param [in] previousKeyboardState Keyboard state that was last submitted to the system.
+    /// @param [in] nextKeyboardState Keyboard state that is about to be submitted to the system.
+    /// @param [in, out] keyboardEvents Container to which keyboard input events are appended.
+    static void AppendKeyboardEvents(
+        const TState& previousKeyboardState,
+        const TState& nextKeyboardState,
+        std::vector<INPUT>& keyboardEvents)
+    {
+      const TState transitionedKeys = nextKeyboardState ^ previousKeyboardState;
+
+      for (auto transitionedKeyIter : transitionedKeys)
+      {
+        const int transitionedKey = (int)transitionedKeyIter;
+
+        if (nextKeyboardState.contains(transitionedKey))
+        {
+          // Key with a transition is present in the next snapshot. This means it was pressed.
+          keyboardEvents.emplace_back(INPUT(
+              {.type = INPUT_KEYBOARD,
+               .ki = {
+                   .wScan = KeyboardEventScanCode(transitionedKey),
+                   .dwFlags = KeyboardEventFlags(transitionedKey)}}));
+        }
+        else
+        {
+          // Key with a transition is not present in the next snapshot. This means it was released.
+          keyboardEvents.emplace_back(INPUT(
+              {.type = INPUT_KEYBOARD,
+               .ki = {
+                   .wScan = KeyboardEventScanCode(transitionedKey),
+                   .dwFlags = KEYEVENTF_KEYUP | KeyboardEventFlags(transitionedKey)}}));
+        }
+      }
+    }
+
+    /// Emulates typematic key repeat for virtual keyboard keys. As with a physical keyboard, only
+    /// the most recently pressed key repeats, starting once it has been held for the repeat delay
+    /// and continuing every repeat period until it is released.
+    class KeyRepeatScheduler
+    {
+    public:
+
+      /// Clock used for measuring how long keys are held.
+      using TClock = std::chrono::steady_clock;
+
+      inline KeyRepeatScheduler(
+          unsigned int repeatDelayMilliseconds, unsigned int repeatPeriodMilliseconds)
+          : repeatDelay(repeatDelayMilliseconds),
+            repeatPeriod(std::max(1u, repeatPeriodMilliseconds)),
+            repeatingKey(),
+            nextRepeatTime()
+      {}
+
+      /// Determines if key repeat is enabled.
+      /// @return `true` if so, `false` if not.
+      inline bool IsEnabled(void) const
+      {
+        return (repeatDelay.count() > 0);
+      }
+
+      /// Updates which key is repeating based on the keyboard state transition that is about to be
+      /// submitted and appends a repeated key press event if one is due.
+      /// @param [in] previousKeyboardState Keyboard state that was last submitted to the system.
+      /// @param [in] nextKeyboardState Keyboard state that is about to be submitted to the system.
+      /// @param [in] now Current time.
+      /// @param [in, out] keyboardEvents Container to which keyboard input events are appended.
+      void Update(
+          const TState& previousKeyboardState,
+          const TState& nextKeyboardState,
+          TClock::time_point now,
+          std::vector<INPUT>& keyboardEvents)
+      {
+        if (false == IsEnabled()) return;
+
+        const TState newlyPressedKeys =
+            (nextKeyboardState ^ previousKeyboardState) & nextKeyboardState;
+
+        for (auto newlyPressedKey : newlyPressedKeys)
+        {
+          repeatingKey = (TKeyIdentifier)newlyPressedKey;
+          nextRepeatTime = now + repeatDelay;
+        }
+
+        if (false == repeatingKey.has_value()) return;
+
+        if (false == nextKeyboardState.contains(repeatingKey.value()))
+        {
+          repeatingKey.reset();
+          return;
+        }
+
+        if (now < nextRepeatTime) return;
+
+        keyboardEvents.emplace_back(INPUT(
+            {.type = INPUT_KEYBOARD,
+             .ki = {
+                 .wScan = KeyboardEventScanCode(repeatingKey.value()),
+                 .dwFlags = KeyboardEventFlags(repeatingKey.value())}}));
+
+        // Repeats are never queued up, so a stall results in one repeat rather than a burst.
+        nextRepeatTime += repeatPeriod;
+        if (nextRepeatTime <= now) nextRepeatTime = now + repeatPeriod;
+      }
+
+    private:
+
+      /// Amount of time a key must be held before it starts repeating.
+      std::chrono::milliseconds repeatDelay;
+
+      /// Amount of time between repeats of a held key.
+      std::chrono::milliseconds repeatPeriod;
+
+      /// Key that is currently repeating, if any.
+      std::optional<TKeyIdentifier> repeatingKey;
+
+      /// Time at which the repeating key is next due to repeat.
+      TClock::time_point nextRepeatTime;
     };
 
+    /// Statistics about keyboard input submitted to the system.
+    static InputEmissionStatistics keyboardEmissionStatistics(L"Keyboard");
+
+    /// Submits keyboard input events to the system and records statistics about them.
+    /// Afterwards, clears the supplied container.
+    /// @param [in, out] keyboardEvents Keyboard input events to submit.
+    /// @param [in] numTransitions Number of key transitions represented by the input events.
+    /// @param [in] contributionTicks Performance counter value at the time of the earliest
+    /// contribution that led to the input events, or 0 if not known.
+    static void SendKeyboardEvents(
+        std::vector<INPUT>& keyboardEvents, size_t numTransitions, int64_t contributionTicks)
+    {
+      keyboardEmissionStatistics.RecordTransitions((unsigned int)numTransitions);
+      if (true == keyboardEvents.empty()) return;
+
+      keyboardEmissionStatistics.SendInput(keyboardEvents);
+      keyboardEvents.clear();
+
+      if ((numTransitions > 0) && (0 != contributionTicks))
+        keyboardEmissionStatistics.RecordLatency(contributionTicks, InputEmissionStatistics::Now());
+    }
+
+    /// Amount of time without any key transitions, while no keys are pressed, after which the
+    /// keyboard update thread stops polling and waits for new contributions.
+    static constexpr unsigned int kKeyboardIdleMillisecondsBeforeWaiting = 1000;
+
     /// Manages a thread that continuously runs and updates the physical keyboard state from virtual
     /// keyboard state. Wraps the thread handle to ensure safe termination and clean-up.
     class KeyboardUpdateThread
@@ -161,45 +557,21 @@ namespace Xidi
         if ((false == keyboardUpdateThread.joinable()) &&
             (false == keyboardUpdateStop.stop_requested()))
         {
-          keyboardUpdateThread = std::thread(
-              UpdatePhysicalKeyboardState, &keyboardTracker, keyboardUpdateStop.get_token());
+          keyboardUpdateThread = WorkerThread::Create(
+              L"Xidi Keyboard Emitter",
+              WorkerThread::EPriority::LatencyCritical,
+              UpdatePhysicalKeyboardState,
+              &keyboardTracker,
+              keyboardUpdateStop.get_token());
         }
       }
 
     private:
 
-      /// Generates the proper flags indicating how the scan code should be interpreted for the
-      /// given keyboard key.
-      /// @param [in] key Keyboard key identifier.
-      /// @return Flags indicating how the scan code corresponding to the identified key should be
-      /// interpreted.
-      static inline DWORD KeyboardEventFlags(TKeyIdentifier key)
-      {
-        // Any key identifiers higher than the maximum 7-bit value are "extended" keys and need to
-        // be flagged as such.
-        if (key > 0x7f)
-          return (KEYEVENTF_SCANCODE | KEYEVENTF_EXTENDEDKEY);
-        else
-          return KEYEVENTF_SCANCODE;
-      }
-
-      /// Generates the proper 16-bit scan code for the given keyboard key.
-      /// @param [in] key Keyboard key identifier.
-      /// @return Proper 16-bit scan code to use for the key.
-      static inline WORD KeyboardEventScanCode(TKeyIdentifier key)
-      {
-        // Only the bottom 7 bits of the key identifier are used.
-        // Any key identifiers higher than the maximum 7-bit value are "extended" keys for which a
-        // prefix of 0xe0 is needed in the full 16-bit quantity.
-        if (key > 0x7f)
-          return ((0xe0 << 8) | (key & 0x7f));
-        else
-          return key;
-      }
-
       /// Periodically checks for changes between the previous and next views of the virtual
       /// keyboard key states. On detected state change, generates and submits a keyboard input
-      /// event to the system.
+      /// event to the system. Stops polling while the virtual keyboard is idle and resumes as
+      /// soon as new contributions are registered.
       /// @param [in] keyboardTracker Pointer to the keyboard state contribution tracker object to
       /// use for updates.
       /// @param [in] keyboardUpdateStopToken Stop token used to indicate that this method should
@@ -211,17 +583,39 @@ namespace Xidi
         keyboardEvents.reserve(kVirtualKeyboardKeyCount);
 
         TState previousKeyboardState;
+        const unsigned int kUpdatePeriodMilliseconds = GetKeyboardUpdatePeriodMilliseconds();
+
+        KeyRepeatScheduler keyRepeatScheduler(
+            GetKeyboardRepeatDelayMilliseconds(), GetKeyboardRepeatPeriodMilliseconds());
+
+        const unsigned int kIdleUpdatePeriodsBeforeWaiting = std::max(
+            1u, kKeyboardIdleMillisecondsBeforeWaiting / std::max(1u, kUpdatePeriodMilliseconds));
+        unsigned int numIdleUpdatePeriods = 0;
 
         while (true)
         {
-          Sleep(kKeyboardUpdatePeriodMilliseconds);
+          if (numIdleUpdatePeriods >= kIdleUpdatePeriodsBeforeWaiting)
+          {
+            auto lock = keyboardTracker->Lock();
+            keyboardTracker->WaitForContributions(lock, keyboardUpdateStopToken);
+            numIdleUpdatePeriods = 0;
+          }
+
+          Sleep(kUpdatePeriodMilliseconds);
 
           const bool haveInputFocus = Globals::DoesCurrentProcessHaveInputFocus();
           const bool terminationRequested = keyboardUpdateStopToken.stop_requested();
 
+          keyboardEmissionStatistics.RecordTick();
+
+          size_t numTransitions = 0;
+          int64_t contributionTicks = 0;
+
           {
             auto lock = keyboardTracker->Lock();
 
+            const bool hadContributions = keyboardTracker->HasContributions();
+            contributionTicks = keyboardTracker->TakeEarliestContributionTicks();
             TState nextKeyboardState = keyboardTracker->SnapshotRelativeTo(previousKeyboardState);
 
             // If the current process does not have input focus or this thread is exiting then all
@@ -229,42 +623,27 @@ namespace Xidi
             if ((false == haveInputFocus) || (true == terminationRequested))
               nextKeyboardState.clear();
 
-            const TState transitionedKeys = nextKeyboardState ^ previousKeyboardState;
-
-            for (auto transitionedKeyIter : transitionedKeys)
-            {
-              const int transitionedKey = (int)transitionedKeyIter;
-
-              if (nextKeyboardState.contains(transitionedKey))
-              {
-                // Key with a transition is present in the next snapshot. This means it was pressed.
-                keyboardEvents.emplace_back(INPUT(
-                    {.type = INPUT_KEYBOARD,
-                     .ki = {
-                         .wScan = KeyboardEventScanCode(transitionedKey),
-                         .dwFlags = KeyboardEventFlags(transitionedKey)}}));
-              }
-              else
-              {
-                // Key with a transition is present in the next snapshot. This means it was
-                // released.
-                keyboardEvents.emplace_back(INPUT(
-                    {.type = INPUT_KEYBOARD,
-                     .ki = {
-                         .wScan = KeyboardEventScanCode(transitionedKey),
-                         .dwFlags = KEYEVENTF_KEYUP | KeyboardEventFlags(transitionedKey)}}));
-              }
-            }
+            AppendKeyboardEvents(previousKeyboardState, nextKeyboardState, keyboardEvents);
+            numTransitions = keyboardEvents.size();
+            keyRepeatScheduler.Update(
+                previousKeyboardState,
+                nextKeyboardState,
+                KeyRepeatScheduler::TClock::now(),
+                keyboardEvents);
 
             previousKeyboardState = nextKeyboardState;
-          }
 
-          if (keyboardEvents.size() > 0)
-          {
-            SendInput((UINT)keyboardEvents.size(), keyboardEvents.data(), (int)sizeof(INPUT));
-            keyboardEvents.clear();
+            // Keys that remain pressed still need to be released if input focus is lost, so the
+            // virtual keyboard is only idle once no keys are pressed.
+            if ((false == hadContributions) && (true == previousKeyboardState.empty()))
+              numIdleUpdatePeriods += 1;
+            else
+              numIdleUpdatePeriods = 0;
           }
 
+          SendKeyboardEvents(keyboardEvents, numTransitions, contributionTicks);
+          keyboardEmissionStatistics.OutputSummaryIfDue(InputEmissionStatistics::Now());
+
           if (true == terminationRequested) break;
         }
       }
@@ -287,6 +666,100 @@ namespace Xidi
     /// Singleton object that wraps the keyboard update thread.
     static KeyboardUpdateThread keyboardUpdateThread(keyboardTracker);
 
+    /// Submits physical keyboard state from virtual keyboard state on the thread that made the
+    /// virtual keyboard state submissions, for use when synchronous submission is enabled.
+    /// Replaces the keyboard update thread in that mode.
+    class SynchronousKeyboardSubmitter
+    {
+    public:
+
+      inline SynchronousKeyboardSubmitter(StateContributionTracker& keyboardTracker)
+          : keyboardTracker(keyboardTracker), previousKeyboardState(), keyboardEvents()
+      {
+        keyboardEvents.reserve(kVirtualKeyboardKeyCount);
+      }
+
+      SynchronousKeyboardSubmitter(const SynchronousKeyboardSubmitter& other) = delete;
+
+      /// Submits all keys that are still pressed to the system as released.
+      ~SynchronousKeyboardSubmitter(void)
+      {
+        if (true == previousKeyboardState.empty()) return;
+
+        auto lock = keyboardTracker.Lock();
+        SubmitUnlocked(true);
+      }
+
+      /// Retrieves the keyboard state that was last submitted. The caller must hold the keyboard
+      /// state contribution tracker's lock.
+      /// @return Last submitted keyboard state.
+      inline const TState& GetKeyboardStateUnlocked(void) const
+      {
+        return previousKeyboardState;
+      }
+
+      /// Applies the marked changes to the last submitted keyboard state and submits any
+      /// resulting key transitions to the system, unless the DirectInput keyboard backend is
+      /// enabled, in which case the new keyboard state is only recorded. The caller must hold the
+      /// keyboard state contribution tracker's lock.
+      /// @param [in] releaseAllKeys Whether or not all keys should be submitted as released
+      /// regardless of the marked changes.
+      void SubmitUnlocked(bool releaseAllKeys = false)
+      {
+        const int64_t contributionTicks = keyboardTracker.TakeEarliestContributionTicks();
+        TState nextKeyboardState = keyboardTracker.SnapshotRelativeTo(previousKeyboardState);
+
+        // If the current process does not have input focus then all pressed keys should be
+        // submitted to the system as released.
+        if ((true == releaseAllKeys) || (false == Globals::DoesCurrentProcessHaveInputFocus()))
+          nextKeyboardState.clear();
+
+        if (true == IsDirectInputBackendEnabled())
+        {
+          previousKeyboardState = nextKeyboardState;
+          return;
+        }
+
+        AppendKeyboardEvents(previousKeyboardState, nextKeyboardState, keyboardEvents);
+        previousKeyboardState = nextKeyboardState;
+
+        SendKeyboardEvents(keyboardEvents, keyboardEvents.size(), contributionTicks);
+      }
+
+    private:
+
+      /// Keyboard contribution tracker object from which marked changes are obtained.
+      StateContributionTracker& keyboardTracker;
+
+      /// Keyboard state that was last submitted to the system.
+      TState previousKeyboardState;
+
+      /// Buffer to hold keyboard events awaiting submission to the system.
+      std::vector<INPUT> keyboardEvents;
+    };
+
+    /// Singleton object that performs synchronous keyboard state submission, if it is enabled.
+    /// Declared after the keyboard contribution tracker so that it is destroyed first.
+    static SynchronousKeyboardSubmitter synchronousKeyboardSubmitter(keyboardTracker);
+
+    /// Key state submissions collected on the calling thread while a submission batch is open.
+    struct SSubmissionBatch
+    {
+      /// Nesting depth of the open submission batches. Submissions are collected only while this
+      /// value is nonzero.
+      unsigned int depth;
+
+      /// Keys submitted as pressed while the batch is open.
+      TState pressedKeys;
+
+      /// Keys submitted as released while the batch is open.
+      TState releasedKeys;
+    };
+
+    /// Per-thread submission batch, so that mapping on one thread never defers or commits key
+    /// state submissions made on another.
+    static thread_local SSubmissionBatch submissionBatch = {};
+
     /// Initializes internal data structures, creates internal threads, and begins periodically
     /// checking for keyboard events that need to be submitted. Idempotent and concurrency-safe.
     static void InitializeAndBeginUpdating(void)
@@ -296,34 +769,147 @@ namespace Xidi
           initFlag,
           []() -> void
           {
+            if (true == IsDirectInputBackendEnabled())
+            {
+              Infra::Message::Output(
+                  Infra::Message::ESeverity::Info,
+                  L"Initialized the DirectInput keyboard backend. Virtual keyboard state is surfaced through the system keyboard device and not submitted as keyboard input events.");
+              return;
+            }
+
+            if (true == IsSynchronousSubmissionEnabled())
+            {
+              Infra::Message::Output(
+                  Infra::Message::ESeverity::Info,
+                  L"Initialized synchronous keyboard event submission.");
+              return;
+            }
+
             keyboardUpdateThread.Start();
             Infra::Message::OutputFormatted(
                 Infra::Message::ESeverity::Info,
                 L"Initialized the keyboard event thread. Desired update period is %u ms.",
-                kKeyboardUpdatePeriodMilliseconds);
+                GetKeyboardUpdatePeriodMilliseconds());
           });
     }
 
+    bool IsDirectInputBackendEnabled(void)
+    {
+      return Globals::GetSettings().properties.keyboardDirectInput;
+    }
+
+    void MergeIntoDirectInputKeyboardState(uint8_t (&keyboardState)[kVirtualKeyboardKeyCount])
+    {
+      // DirectInput reports a key as pressed by setting the high bit of its state byte.
+      constexpr uint8_t kKeyPressed = 0x80;
+
+      auto lock = keyboardTracker.Lock();
+
+      for (auto key : synchronousKeyboardSubmitter.GetKeyboardStateUnlocked())
+        keyboardState[(unsigned int)key] |= kKeyPressed;
+    }
+
+    /// Causes newly-registered key contributions to take effect. In synchronous mode they are
+    /// submitted immediately, and otherwise the keyboard update thread is woken up if needed.
+    static void PublishContributions(void)
+    {
+      if (true == IsSynchronousSubmissionEnabled())
+      {
+        auto lock = keyboardTracker.Lock();
+        synchronousKeyboardSubmitter.SubmitUnlocked();
+      }
+      else
+      {
+        keyboardTracker.NotifyContributions();
+      }
+    }
+
+    Api::IInputEmissionStatistics::SStatistics GetEmissionStatistics(void)
+    {
+      return keyboardEmissionStatistics.GetStatistics();
+    }
+
+    void BeginSubmissionBatch(void)
+    {
+      submissionBatch.depth += 1;
+    }
+
+    void EndSubmissionBatch(void)
+    {
+      if (0 == submissionBatch.depth) return;
+
+      submissionBatch.depth -= 1;
+      if (0 != submissionBatch.depth) return;
+
+      if ((true == submissionBatch.pressedKeys.empty()) &&
+          (true == submissionBatch.releasedKeys.empty()))
+        return;
+
+      InitializeAndBeginUpdating();
+
+      keyboardTracker.MarkBatch(submissionBatch.pressedKeys, submissionBatch.releasedKeys);
+      PublishContributions();
+
+      submissionBatch.pressedKeys.clear();
+      submissionBatch.releasedKeys.clear();
+    }
+
     void SubmitKeyPressedState(TKeyIdentifier key)
     {
+      if (0 != submissionBatch.depth)
+      {
+        submissionBatch.pressedKeys.insert(key);
+        return;
+      }
+
       InitializeAndBeginUpdating();
 
       if (false == keyboardTracker.IsMarkedPressed(key))
       {
-        auto lock = keyboardTracker.Lock();
         keyboardTracker.MarkPressed(key);
+        PublishContributions();
       }
     }
 
     void SubmitKeyReleasedState(TKeyIdentifier key)
     {
+      if (0 != submissionBatch.depth)
+      {
+        submissionBatch.releasedKeys.insert(key);
+        return;
+      }
+
       InitializeAndBeginUpdating();
 
       if (false == keyboardTracker.IsMarkedReleased(key))
       {
-        auto lock = keyboardTracker.Lock();
         keyboardTracker.MarkRelease(key);
+        PublishContributions();
       }
     }
+#else
+    // Builds without input emission accept keyboard state submissions from mappers but discard
+    // them, so there is neither a keyboard event thread nor any interaction with the system.
+
+    bool IsDirectInputBackendEnabled(void)
+    {
+      return false;
+    }
+
+    void MergeIntoDirectInputKeyboardState(uint8_t (&keyboardState)[kVirtualKeyboardKeyCount]) {}
+
+    Api::IInputEmissionStatistics::SStatistics GetEmissionStatistics(void)
+    {
+      return {};
+    }
+
+    void BeginSubmissionBatch(void) {}
+
+    void EndSubmissionBatch(void) {}
+
+    void SubmitKeyPressedState(TKeyIdentifier key) {}
+
+    void SubmitKeyReleasedState(TKeyIdentifier key) {}
+#endif
   } // namespace Keyboard
 } // namespace Xidi
@@ -0,0 +1,290 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file LiveMetrics.cpp
+ *   Implementation of functionality for exporting live metrics to external tools using a shared
+ *   memory section.
+ **************************************************************************************************/
+
+#include "LiveMetrics.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <Infra/Core/Message.h>
+#include <Infra/Core/Strings.h>
+#include <Infra/Core/TemporaryBuffer.h>
+
+#include "ApiWindows.h"
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "Globals.h"
+#include "Keyboard.h"
+#include "LiveMetricsLayout.h"
+#include "Mouse.h"
+#include "PhysicalController.h"
+#include "PollingStatistics.h"
+#include "Strings.h"
+#include "WorkerThread.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace LiveMetrics
+    {
+      static_assert(
+          kControllerSlotCount == kMaxPhysicalControllerCount,
+          "Live metrics layout does not match the number of physical controllers.");
+
+      /// Physical actuator values most recently written to each physical controller, packed with
+      /// one 16-bit actuator value per actuator in the order they appear in the layout.
+      static std::atomic<uint64_t> recordedActuatorValues[kMaxPhysicalControllerCount];
+
+      /// Number of virtual controllers most recently observed to be registered with each physical
+      /// controller.
+      static std::atomic<uint32_t> recordedNumVirtualControllers[kMaxPhysicalControllerCount];
+
+      /// Largest event buffer fill level most recently observed for each physical controller.
+      static std::atomic<uint32_t> recordedEventBufferCount[kMaxPhysicalControllerCount];
+
+      /// Capacity of the event buffer holding the most events for each physical controller.
+      static std::atomic<uint32_t> recordedEventBufferCapacity[kMaxPhysicalControllerCount];
+
+      /// Converts duration statistics obtained through the Xidi API to the layout representation.
+      /// @param [in] statistics Duration statistics to convert.
+      /// @return Converted duration statistics.
+      static SDuration DurationFromStatistics(const Api::SDurationStatistics& statistics)
+      {
+        return {
+            .numSamples = statistics.numSamples,
+            .p50Microseconds = statistics.p50Microseconds,
+            .p99Microseconds = statistics.p99Microseconds,
+            .maxMicroseconds = statistics.maxMicroseconds};
+      }
+
+      /// Converts input emission statistics obtained through the Xidi API to the layout
+      /// representation.
+      /// @param [in] statistics Input emission statistics to convert.
+      /// @return Converted input emission statistics.
+      static SEmitter EmitterFromStatistics(
+          const Api::IInputEmissionStatistics::SStatistics& statistics)
+      {
+        return {
+            .numTicks = statistics.numTicks,
+            .numTransitions = statistics.numTransitions,
+            .numSendInputCalls = statistics.numSendInputCalls,
+            .numSendInputFailures = statistics.numSendInputFailures,
+            .numEventsSent = statistics.numEventsSent};
+      }
+
+      /// Fills in the metrics for a single physical controller slot.
+      /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+      /// @param [out] slot Slot to be filled in.
+      static void FillControllerSlot(
+          TControllerIdentifier controllerIdentifier, SControllerSlot& slot)
+      {
+        const SPhysicalState physicalState =
+            GetCurrentPhysicalControllerState(controllerIdentifier);
+        const SState rawVirtualState = GetCurrentRawVirtualControllerState(controllerIdentifier);
+        const PollingStatistics::SStatistics pollingStatistics =
+            PollingStatistics::GetStatistics(controllerIdentifier);
+
+        slot.physicalDeviceStatus = static_cast<uint32_t>(physicalState.deviceStatus);
+        slot.physicalButtons = static_cast<uint32_t>(physicalState.button.to_ulong());
+        for (int i = 0; i < _countof(slot.physicalStick); ++i)
+          slot.physicalStick[i] = physicalState.stick[i];
+        for (int i = 0; i < _countof(slot.physicalTrigger); ++i)
+          slot.physicalTrigger[i] = physicalState.trigger[i];
+
+        for (int i = 0; i < _countof(slot.virtualAxis); ++i)
+          slot.virtualAxis[i] = rawVirtualState.axis[i];
+        slot.virtualButtons = rawVirtualState.ButtonBitmask();
+        slot.virtualPov = 0;
+        for (int i = 0; i < (int)EPovDirection::Count; ++i)
+        {
+          if (true == rawVirtualState.povDirection.components[i]) slot.virtualPov |= (1u << i);
+        }
+
+        const uint64_t actuatorValues =
+            recordedActuatorValues[controllerIdentifier].load(std::memory_order_relaxed);
+        for (int i = 0; i < _countof(slot.actuatorValue); ++i)
+          slot.actuatorValue[i] = static_cast<uint16_t>(actuatorValues >> (16 * i));
+
+        slot.numVirtualControllers =
+            recordedNumVirtualControllers[controllerIdentifier].load(std::memory_order_relaxed);
+        slot.eventBufferCount =
+            recordedEventBufferCount[controllerIdentifier].load(std::memory_order_relaxed);
+        slot.eventBufferCapacity =
+            recordedEventBufferCapacity[controllerIdentifier].load(std::memory_order_relaxed);
+
+        slot.pollConfiguredPeriodMicroseconds = pollingStatistics.configuredPeriodMicroseconds;
+        slot.pollMissedDeadlines = pollingStatistics.numMissedDeadlines;
+        slot.pollInterval = DurationFromStatistics(pollingStatistics.pollInterval);
+        slot.xinputGetStateDuration =
+            DurationFromStatistics(pollingStatistics.xinputGetStateDuration);
+        slot.mappingDuration = DurationFromStatistics(pollingStatistics.mappingDuration);
+      }
+
+      /// Periodically updates the shared memory section. Intended to be a thread entry point.
+      /// @param [in] section Shared memory section to update.
+      /// @param [in] updatePeriodMilliseconds Time between updates, in milliseconds.
+      static void UpdateSharedMemorySection(
+          SSection* section, unsigned int updatePeriodMilliseconds)
+      {
+        std::atomic_ref<uint32_t> sequence(section->sequence);
+
+        // Metrics are gathered into a private snapshot first so that the section is only marked
+        // as being updated for the time it takes to copy the snapshot into it.
+        SSection snapshot = *section;
+
+        while (true)
+        {
+          Sleep(updatePeriodMilliseconds);
+
+          for (TControllerIdentifier controllerIdentifier = 0;
+               controllerIdentifier < GetPhysicalControllerCount();
+               ++controllerIdentifier)
+            FillControllerSlot(controllerIdentifier, snapshot.controller[controllerIdentifier]);
+
+          snapshot.keyboard = EmitterFromStatistics(Keyboard::GetEmissionStatistics());
+          snapshot.mouse = EmitterFromStatistics(Mouse::GetEmissionStatistics());
+
+          LARGE_INTEGER now;
+          QueryPerformanceCounter(&now);
+          snapshot.updatePerformanceCounter = now.QuadPart;
+          snapshot.updateCount += 1;
+
+          const uint32_t currentSequence = sequence.load(std::memory_order_relaxed);
+          sequence.store(currentSequence + 1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+
+          section->updatePerformanceCounter = snapshot.updatePerformanceCounter;
+          section->updateCount = snapshot.updateCount;
+          for (int i = 0; i < _countof(section->controller); ++i)
+            section->controller[i] = snapshot.controller[i];
+          section->keyboard = snapshot.keyboard;
+          section->mouse = snapshot.mouse;
+
+          sequence.store(currentSequence + 2, std::memory_order_release);
+        }
+      }
+
+      bool IsEnabled(void)
+      {
+        static const bool kLiveMetricsEnabled =
+            Globals::GetConfigurationData()[Strings::kStrConfigurationSectionLog]
+                                           [Strings::kStrConfigurationSettingLogLiveMetrics]
+                                               .ValueOr(false);
+
+        return kLiveMetricsEnabled;
+      }
+
+      void Start(unsigned int updatePeriodMilliseconds)
+      {
+        if (false == IsEnabled()) return;
+
+        static std::once_flag startFlag;
+        std::call_once(
+            startFlag,
+            [updatePeriodMilliseconds]() -> void
+            {
+              const DWORD processId = GetCurrentProcessId();
+              const Infra::TemporaryString sectionName =
+                  Infra::Strings::Format(kSectionNameFormat, (unsigned int)processId);
+
+              // The section is intentionally never closed, so that it remains valid for as long as
+              // the process is running and external tools can open it at any time.
+              const HANDLE sectionHandle = CreateFileMappingW(
+                  INVALID_HANDLE_VALUE,
+                  nullptr,
+                  PAGE_READWRITE,
+                  0,
+                  sizeof(SSection),
+                  sectionName.Data());
+              if (nullptr == sectionHandle)
+              {
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Warning,
+                    L"Failed with code %u to create the live metrics shared memory section %s.",
+                    GetLastError(),
+                    sectionName.Data());
+                return;
+              }
+
+              SSection* const section = reinterpret_cast<SSection*>(
+                  MapViewOfFile(sectionHandle, FILE_MAP_WRITE, 0, 0, sizeof(SSection)));
+              if (nullptr == section)
+              {
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Warning,
+                    L"Failed with code %u to map the live metrics shared memory section %s.",
+                    GetLastError(),
+                    sectionName.Data());
+                CloseHandle(sectionHandle);
+                return;
+              }
+
+              LARGE_INTEGER frequency;
+              QueryPerformanceFrequency(&frequency);
+
+              *section = {
+                  .magic = kSectionMagic,
+                  .version = kSectionVersion,
+                  .size = sizeof(SSection),
+                  .processId = (uint32_t)processId,
+                  .sequence = 0,
+                  .performanceCounterFrequency = frequency.QuadPart};
+
+              WorkerThread::StartDetached(
+                  L"Xidi Live Metrics",
+                  WorkerThread::EPriority::Housekeeping,
+                  UpdateSharedMemorySection,
+                  section,
+                  updatePeriodMilliseconds);
+              Infra::Message::OutputFormatted(
+                  Infra::Message::ESeverity::Info,
+                  L"Exporting live metrics using shared memory section %s. Update period is %u ms.",
+                  sectionName.Data(),
+                  updatePeriodMilliseconds);
+            });
+      }
+
+      void RecordActuatorValues(
+          TControllerIdentifier controllerIdentifier,
+          const ForceFeedback::SPhysicalActuatorComponents& physicalActuatorValues)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        recordedActuatorValues[controllerIdentifier].store(
+            ((uint64_t)physicalActuatorValues.leftMotor) |
+                ((uint64_t)physicalActuatorValues.rightMotor << 16) |
+                ((uint64_t)physicalActuatorValues.leftImpulseTrigger << 32) |
+                ((uint64_t)physicalActuatorValues.rightImpulseTrigger << 48),
+            std::memory_order_relaxed);
+      }
+
+      void RecordVirtualControllers(
+          TControllerIdentifier controllerIdentifier,
+          uint32_t numVirtualControllers,
+          uint32_t eventBufferCount,
+          uint32_t eventBufferCapacity)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        recordedNumVirtualControllers[controllerIdentifier].store(
+            numVirtualControllers, std::memory_order_relaxed);
+        recordedEventBufferCount[controllerIdentifier].store(
+            eventBufferCount, std::memory_order_relaxed);
+        recordedEventBufferCapacity[controllerIdentifier].store(
+            eventBufferCapacity, std::memory_order_relaxed);
+      }
+    } // namespace LiveMetrics
+  } // namespace Controller
+} // namespace Xidi
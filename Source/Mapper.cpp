@@ -12,11 +12,15 @@
 
 #include "Mapper.h"
 
+#include <array>
+#include <atomic>
 #include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string_view>
+#include <unordered_map>
 
 #include <Infra/Core/Configuration.h>
 #include <Infra/Core/Message.h>
@@ -28,6 +32,8 @@
 #include "ElementMapper.h"
 #include "ForceFeedbackTypes.h"
 #include "Globals.h"
+#include "Keyboard.h"
+#include "Mouse.h"
 #include "Strings.h"
 
 namespace Xidi
@@ -55,6 +61,11 @@ namespace Xidi
 
         if (Infra::Message::WillOutputMessageOfSeverity(kDumpSeverity))
         {
+          // The index is not ordered, but the dump is easier to read if it is.
+          const std::shared_ptr<const SIndex> currentIndex = index.load();
+          const std::map<std::wstring_view, const Mapper*> knownMappers(
+              currentIndex->knownMappers.cbegin(), currentIndex->knownMappers.cend());
+
           Infra::Message::Output(kDumpSeverity, L"Begin dump of all known mappers.");
 
           for (const auto& knownMapper : knownMappers)
@@ -103,9 +114,13 @@ namespace Xidi
           return;
         }
 
-        knownMappers[name] = object;
+        std::scoped_lock lock(registryMutex);
+        auto updatedIndex = std::make_shared<SIndex>(*index.load());
+
+        updatedIndex->knownMappers[name] = object;
+        if (true == updatedIndex->defaultMapper.empty()) updatedIndex->defaultMapper = name;
 
-        if (true == defaultMapper.empty()) defaultMapper = name;
+        index.store(std::move(updatedIndex));
       }
 
       /// Unregisters a mapper object from this registry, if the registration details provided match
@@ -122,7 +137,11 @@ namespace Xidi
           return;
         }
 
-        if (false == knownMappers.contains(name))
+        std::scoped_lock lock(registryMutex);
+        const std::shared_ptr<const SIndex> currentIndex = index.load();
+
+        const auto mapperRecord = currentIndex->knownMappers.find(name);
+        if (currentIndex->knownMappers.cend() == mapperRecord)
         {
           Infra::Message::OutputFormatted(
               Infra::Message::ESeverity::Error,
@@ -131,7 +150,7 @@ namespace Xidi
           return;
         }
 
-        if (object != knownMappers.at(name))
+        if (object != mapperRecord->second)
         {
           Infra::Message::OutputFormatted(
               Infra::Message::ESeverity::Error,
@@ -140,9 +159,12 @@ namespace Xidi
           return;
         }
 
-        knownMappers.erase(name);
+        auto updatedIndex = std::make_shared<SIndex>(*currentIndex);
 
-        if (defaultMapper == name) defaultMapper = std::wstring_view();
+        updatedIndex->knownMappers.erase(name);
+        if (updatedIndex->defaultMapper == name) updatedIndex->defaultMapper = std::wstring_view();
+
+        index.store(std::move(updatedIndex));
       }
 
       /// Retrieves a pointer to the mapper object that corresponds to the specified name, if it
@@ -150,39 +172,58 @@ namespace Xidi
       /// @param [in] mapperName Desired mapper name.
       /// @return Pointer to the corresponding mapper object, or `nullptr` if it does not exist in
       /// the registry.
-      const Mapper* GetMapper(std::wstring_view mapperName)
+      const Mapper* GetMapper(std::wstring_view mapperName) const
       {
-        if (true == mapperName.empty()) mapperName = defaultMapper;
+        const std::shared_ptr<const SIndex> currentIndex = index.load();
+        if (true == mapperName.empty()) mapperName = currentIndex->defaultMapper;
 
-        const auto mapperRecord = knownMappers.find(mapperName);
-        if (knownMappers.cend() != mapperRecord) return mapperRecord->second;
+        const auto mapperRecord = currentIndex->knownMappers.find(mapperName);
+        if (currentIndex->knownMappers.cend() != mapperRecord) return mapperRecord->second;
 
         return nullptr;
       }
 
     private:
 
-      MapperRegistry(void) = default;
+      /// Immutable snapshot of the contents of the registry. Lookups read whichever snapshot is
+      /// current without taking any lock, and changes publish a new snapshot.
+      struct SIndex
+      {
+        /// Known mappers, keyed by name.
+        std::unordered_map<std::wstring_view, const Mapper*> knownMappers;
 
-      /// Implements the registry of known mappers.
-      std::map<std::wstring_view, const Mapper*> knownMappers;
+        /// Holds the map key that corresponds to the default mapper.
+        /// The first type of mapper that is registered becomes the default.
+        std::wstring_view defaultMapper;
+      };
 
-      /// Holds the map key that corresponds to the default mapper.
-      /// The first type of mapper that is registered becomes the default.
-      std::wstring_view defaultMapper;
+      MapperRegistry(void) : registryMutex(), index(std::make_shared<const SIndex>()) {}
+
+      /// Serializes changes to the registry. Mapper objects can be created concurrently, for
+      /// example while building custom mappers.
+      std::mutex registryMutex;
+
+      /// Current snapshot of the registry contents.
+      std::atomic<std::shared_ptr<const SIndex>> index;
     };
 
+    /// Function to invoke when a mapper is requested by name but no such mapper is registered.
+    static std::atomic<Mapper::TOnDemandBuildFunc> mapperOnDemandBuildFunc = nullptr;
+
     /// Derives the capabilities of the controller that is described by the specified element
     /// mappers in aggregate. Number of axes is determined as the total number of unique axes on the
     /// virtual controller to which element mappers contribute. Number of buttons is determined by
     /// looking at the highest button number to which element mappers contribute. Presence or
     /// absence of a POV is determined by whether or not any element mappers contribute to a POV
-    /// direction, even if not all POV directions have a contribution.
+    /// direction, even if not all POV directions have a contribution. Element mappers of chords
+    /// are considered along with those of the element map.
     /// @param [in] elements Per-element controller map.
+    /// @param [in] chords Chords held by the mapper.
     /// @param [in] forceFeedbackActuators Per-element force feedback actuator map.
     /// @return Virtual controller capabilities as derived from the per-element map in aggregate.
     static SCapabilities DeriveCapabilitiesFromElementMap(
         const Mapper::UElementMap& elements,
+        const Mapper::TChords& chords,
         Mapper::UForceFeedbackActuatorMap forceFeedbackActuators)
     {
       SCapabilities capabilities;
@@ -194,39 +235,44 @@ namespace Xidi
       int highestButtonSeen = Mapper::kMinNumButtons - 1;
       bool povPresent = Mapper::kIsPovRequired;
 
-      for (int i = 0; i < _countof(elements.all); ++i)
+      auto considerTargetElements = [&](const IElementMapper* elementMapper) -> void
       {
-        if (nullptr != elements.all[i])
+        if (nullptr == elementMapper) return;
+
+        for (int j = 0; j < elementMapper->GetTargetElementCount(); ++j)
         {
-          for (int j = 0; j < elements.all[i]->GetTargetElementCount(); ++j)
-          {
-            const std::optional<SElementIdentifier> maybeTargetElement =
-                elements.all[i]->GetTargetElementAt(j);
-            if (false == maybeTargetElement.has_value()) continue;
+          const std::optional<SElementIdentifier> maybeTargetElement =
+              elementMapper->GetTargetElementAt(j);
+          if (false == maybeTargetElement.has_value()) continue;
 
-            const SElementIdentifier targetElement = maybeTargetElement.value();
-            switch (targetElement.type)
-            {
-              case EElementType::Axis:
-                if ((int)targetElement.axis < (int)EAxis::Count)
-                  axesPresent.insert((int)targetElement.axis);
-                break;
+          const SElementIdentifier targetElement = maybeTargetElement.value();
+          switch (targetElement.type)
+          {
+            case EElementType::Axis:
+              if ((int)targetElement.axis < (int)EAxis::Count)
+                axesPresent.insert((int)targetElement.axis);
+              break;
 
-              case EElementType::Button:
-                if ((int)targetElement.button < (int)EButton::Count)
-                {
-                  if ((int)targetElement.button > highestButtonSeen)
-                    highestButtonSeen = (int)targetElement.button;
-                }
-                break;
+            case EElementType::Button:
+              if ((int)targetElement.button < (int)EButton::Count)
+              {
+                if ((int)targetElement.button > highestButtonSeen)
+                  highestButtonSeen = (int)targetElement.button;
+              }
+              break;
 
-              case EElementType::Pov:
-                povPresent = true;
-                break;
-            }
+            case EElementType::Pov:
+              povPresent = true;
+              break;
           }
         }
-      }
+      };
+
+      for (int i = 0; i < _countof(elements.all); ++i)
+        considerTargetElements(elements.all[i].get());
+
+      for (const auto& chord : chords)
+        considerTargetElements(chord.elementMapper.get());
 
       for (int i = 0; i < _countof(forceFeedbackActuators.all); ++i)
       {
@@ -254,6 +300,12 @@ namespace Xidi
         }
       }
 
+#ifdef XIDI_SKIP_FORCE_FEEDBACK
+      // Builds without force feedback still present the axes that force feedback actuators target
+      // so that the controller layout does not change, but none of them supports force feedback.
+      axesForceFeedback.clear();
+#endif
+
       for (auto axisPresent : axesPresent)
         capabilities.AppendAxis(
             {.type = (EAxis)((int)axisPresent),
@@ -289,92 +341,193 @@ namespace Xidi
       return -FilterAnalogStickValue(analogValue);
     }
 
-    /// Computes the physical force feedback actuator value for the specified actuator given a
-    /// vector of magnitude components.
-    /// @param [in] virtualEffectComponents Virtual force feedback vector expressed as a magnitude
-    /// component vector.
-    /// @param [in] actuatorElement Physical force feedback actuator element for which an actuator
-    /// value is desired.
-    /// @param [in] gain Gain modifier to apply as a scalar multiplier on the physical actuator
-    /// value.
-    /// @return Physical force feedback actuator value that can be sent directly to the actuator
-    /// itself.
-    static inline ForceFeedback::TPhysicalActuatorValue ForceFeedbackActuatorValue(
-        ForceFeedback::TOrderedMagnitudeComponents virtualEffectComponents,
-        ForceFeedback::SActuatorElement actuatorElement,
-        ForceFeedback::TEffectValue gain)
+    /// Lowers a force feedback actuator map into a matrix of squared weights. Single-axis
+    /// actuators receive a weight on their axis for each direction they respond to, and magnitude
+    /// projection actuators receive a weight on both of their axes in both directions.
+    /// @param [in] forceFeedbackActuators Force feedback actuator map to lower.
+    /// @return Force feedback actuator matrix that produces the same physical actuator values.
+    static Mapper::SForceFeedbackActuatorMatrix LowerForceFeedbackActuatorMap(
+        const Mapper::UForceFeedbackActuatorMap& forceFeedbackActuators)
     {
-      if (false == actuatorElement.isPresent) return 0;
+      Mapper::SForceFeedbackActuatorMatrix forceFeedbackActuatorMatrix = {};
 
-      ForceFeedback::TEffectValue virtualActuatorStrengthRaw = 0;
-
-      switch (actuatorElement.mode)
+      for (int i = 0; i < _countof(forceFeedbackActuators.all); ++i)
       {
-        case ForceFeedback::EActuatorMode::SingleAxis:
+        const ForceFeedback::SActuatorElement& actuatorElement = forceFeedbackActuators.all[i];
+        if (false == actuatorElement.isPresent) continue;
+
+        auto& positiveWeights = forceFeedbackActuatorMatrix.positiveWeights[i];
+        auto& negativeWeights = forceFeedbackActuatorMatrix.negativeWeights[i];
+
+        switch (actuatorElement.mode)
         {
-          if (ForceFeedback::kEffectForceMagnitudeZero ==
-              virtualEffectComponents[(int)actuatorElement.singleAxis.axis])
-            return 0;
-
-          const bool actuatorDirectionIsNegative =
-              std::signbit(virtualEffectComponents[(int)actuatorElement.singleAxis.axis]);
-          if ((EAxisDirection::Positive == actuatorElement.singleAxis.direction) &&
-              (true == actuatorDirectionIsNegative))
-            return 0;
-          if ((EAxisDirection::Negative == actuatorElement.singleAxis.direction) &&
-              (false == actuatorDirectionIsNegative))
-            return 0;
-
-          virtualActuatorStrengthRaw =
-              virtualEffectComponents[(int)actuatorElement.singleAxis.axis];
-          break;
+          case ForceFeedback::EActuatorMode::SingleAxis:
+            if (EAxisDirection::Negative != actuatorElement.singleAxis.direction)
+              positiveWeights[(int)actuatorElement.singleAxis.axis] = 1;
+            if (EAxisDirection::Positive != actuatorElement.singleAxis.direction)
+              negativeWeights[(int)actuatorElement.singleAxis.axis] = 1;
+            break;
+
+          case ForceFeedback::EActuatorMode::MagnitudeProjection:
+            // Weights accumulate so that projecting an axis onto itself counts it twice.
+            positiveWeights[(int)actuatorElement.magnitudeProjection.axisFirst] += 1;
+            negativeWeights[(int)actuatorElement.magnitudeProjection.axisFirst] += 1;
+            positiveWeights[(int)actuatorElement.magnitudeProjection.axisSecond] += 1;
+            negativeWeights[(int)actuatorElement.magnitudeProjection.axisSecond] += 1;
+            break;
+
+          default:
+            break;
         }
+      }
+
+      return forceFeedbackActuatorMatrix;
+    }
+
+    /// Makes the contributions to controller state that the specified element mapper would make
+    /// given the specified physical controller element value. The type of physical controller
+    /// element is determined by its position within the element map.
+    /// @param [in] program Compiled element mappers.
+    /// @param [in] elementMapIndex Positional index of the element mapper within the overall
+    /// element map.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] elementValue Value of the physical controller element.
+    /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+    /// associated with the state being mapped.
+    static void ContributeFromElementValue(
+        const ElementMapperProgram& program,
+        unsigned int elementMapIndex,
+        SState& controllerState,
+        int16_t elementValue,
+        uint32_t sourceControllerIdentifier)
+    {
+      const uint32_t sourceIdentifier =
+          Mapper::SourceIdentifierForElementMapper(sourceControllerIdentifier, elementMapIndex);
 
-        case ForceFeedback::EActuatorMode::MagnitudeProjection:
-          virtualActuatorStrengthRaw = (ForceFeedback::TEffectValue)std::sqrt(
-              std::pow(
-                  virtualEffectComponents[(int)actuatorElement.magnitudeProjection.axisFirst], 2) +
-              std::pow(
-                  virtualEffectComponents[(int)actuatorElement.magnitudeProjection.axisSecond], 2));
+      switch (elementMapIndex)
+      {
+        case ELEMENT_MAP_INDEX_OF(stickLeftX):
+        case ELEMENT_MAP_INDEX_OF(stickLeftY):
+        case ELEMENT_MAP_INDEX_OF(stickRightX):
+        case ELEMENT_MAP_INDEX_OF(stickRightY):
+          program.ContributeFromAnalogValue(
+              elementMapIndex, controllerState, elementValue, sourceIdentifier);
+          break;
+
+        case ELEMENT_MAP_INDEX_OF(triggerLT):
+        case ELEMENT_MAP_INDEX_OF(triggerRT):
+          program.ContributeFromTriggerValue(
+              elementMapIndex, controllerState, (uint8_t)elementValue, sourceIdentifier);
           break;
 
         default:
-          return 0;
+          program.ContributeFromButtonValue(
+              elementMapIndex, controllerState, (0 != elementValue), sourceIdentifier);
+          break;
       }
+    }
 
-      constexpr ForceFeedback::TEffectValue kPhysicalActuatorRange = (ForceFeedback::TEffectValue)(
-          std::numeric_limits<ForceFeedback::TPhysicalActuatorValue>::max() -
-          std::numeric_limits<ForceFeedback::TPhysicalActuatorValue>::min());
-      constexpr ForceFeedback::TEffectValue kVirtualMagnitudeRange =
-          ForceFeedback::kEffectForceMagnitudeMaximum - ForceFeedback::kEffectForceMagnitudeZero;
-      constexpr ForceFeedback::TEffectValue kScalingFactor =
-          kPhysicalActuatorRange / kVirtualMagnitudeRange;
+    /// Adds the specified contribution to a controller state. Axis values are summed, and buttons
+    /// and POV directions are pressed if they are pressed in either. This is how contributions are
+    /// combined when element mappers all contribute to the same controller state.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] contribution Contribution to add.
+    static void MergeContribution(SState& controllerState, const SState& contribution)
+    {
+      for (size_t i = 0; i < controllerState.axis.size(); ++i)
+        controllerState.axis[i] += contribution.axis[i];
 
-      const ForceFeedback::TEffectValue gainMultiplier =
-          gain / ForceFeedback::kEffectModifierMaximum;
-      const ForceFeedback::TEffectValue virtualActuatorStrengthMax =
-          (ForceFeedback::kEffectForceMagnitudeMaximum - ForceFeedback::kEffectForceMagnitudeZero) *
-          gainMultiplier;
+      controllerState.button |= contribution.button;
 
-      const ForceFeedback::TEffectValue virtualActuatorStrength = std::min(
-          virtualActuatorStrengthMax,
-          gainMultiplier *
-              std::abs(virtualActuatorStrengthRaw - ForceFeedback::kEffectForceMagnitudeZero));
-      const long physicalActuatorStrength = std::lround(virtualActuatorStrength * kScalingFactor);
+      for (size_t i = 0; i < controllerState.povDirection.components.size(); ++i)
+      {
+        controllerState.povDirection.components[i] =
+            (controllerState.povDirection.components[i] ||
+             contribution.povDirection.components[i]);
+      }
+    }
 
-      return (ForceFeedback::TPhysicalActuatorValue)physicalActuatorStrength;
+    /// Reads the values of all physical controller elements from a physical controller state,
+    /// applying raw transformations along the way.
+    /// @param [in] physicalState Physical controller state from which to read.
+    /// @param [in] transform Compiled extra transformations to apply to raw analog values.
+    /// @return Values of all physical controller elements.
+    static Mapper::TElementValues ReadElementValues(
+        const SPhysicalState& physicalState, const Mapper::SCompiledPhysicalTransform& transform)
+    {
+      // If requested by the user, left and right stick values need to be transformed so that a
+      // circular field of physical motion is transformed into a square field of virtual motion.
+      const Math::SAnalogStickCoordinates stickLeftCoordinates =
+          Math::TransformCoordinatesCircleToSquare(
+              {.x = physicalState[EPhysicalStick::LeftX],
+               .y = physicalState[EPhysicalStick::LeftY]},
+              transform.circleToSquareStickLeft);
+      const Math::SAnalogStickCoordinates stickRightCoordinates =
+          Math::TransformCoordinatesCircleToSquare(
+              {.x = physicalState[EPhysicalStick::RightX],
+               .y = physicalState[EPhysicalStick::RightY]},
+              transform.circleToSquareStickRight);
+
+      Mapper::TElementValues elementValues = {};
+
+      // Left and right stick values need to be saturated at the virtual controller range due to a
+      // very slight difference between XInput range and virtual controller range. This difference
+      // (-32768 extreme negative for XInput vs -32767 extreme negative for Xidi) does not affect
+      // functionality when filtered by saturation. Vertical analog axes additionally need to be
+      // inverted because XInput presents up as positive and down as negative whereas Xidi needs to
+      // do the opposite.
+
+      elementValues[ELEMENT_MAP_INDEX_OF(stickLeftX)] = Math::ApplyRawAnalogTransform(
+          FilterAnalogStickValue(stickLeftCoordinates.x), transform.analogTransformStickLeft);
+      elementValues[ELEMENT_MAP_INDEX_OF(stickLeftY)] = Math::ApplyRawAnalogTransform(
+          FilterAndInvertAnalogStickValue(stickLeftCoordinates.y),
+          transform.analogTransformStickLeft);
+      elementValues[ELEMENT_MAP_INDEX_OF(stickRightX)] = Math::ApplyRawAnalogTransform(
+          FilterAnalogStickValue(stickRightCoordinates.x), transform.analogTransformStickRight);
+      elementValues[ELEMENT_MAP_INDEX_OF(stickRightY)] = Math::ApplyRawAnalogTransform(
+          FilterAndInvertAnalogStickValue(stickRightCoordinates.y),
+          transform.analogTransformStickRight);
+
+      elementValues[ELEMENT_MAP_INDEX_OF(dpadUp)] = physicalState[EPhysicalButton::DpadUp];
+      elementValues[ELEMENT_MAP_INDEX_OF(dpadDown)] = physicalState[EPhysicalButton::DpadDown];
+      elementValues[ELEMENT_MAP_INDEX_OF(dpadLeft)] = physicalState[EPhysicalButton::DpadLeft];
+      elementValues[ELEMENT_MAP_INDEX_OF(dpadRight)] = physicalState[EPhysicalButton::DpadRight];
+
+      elementValues[ELEMENT_MAP_INDEX_OF(triggerLT)] = Math::ApplyRawTriggerTransform(
+          physicalState[EPhysicalTrigger::LT], transform.triggerTransformLT);
+      elementValues[ELEMENT_MAP_INDEX_OF(triggerRT)] = Math::ApplyRawTriggerTransform(
+          physicalState[EPhysicalTrigger::RT], transform.triggerTransformRT);
+
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonA)] = physicalState[EPhysicalButton::A];
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonB)] = physicalState[EPhysicalButton::B];
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonX)] = physicalState[EPhysicalButton::X];
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonY)] = physicalState[EPhysicalButton::Y];
+
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonLB)] = physicalState[EPhysicalButton::LB];
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonRB)] = physicalState[EPhysicalButton::RB];
+
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonBack)] = physicalState[EPhysicalButton::Back];
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonStart)] = physicalState[EPhysicalButton::Start];
+
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonLS)] = physicalState[EPhysicalButton::LS];
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonRS)] = physicalState[EPhysicalButton::RS];
+
+      elementValues[ELEMENT_MAP_INDEX_OF(buttonGuide)] = physicalState[EPhysicalButton::Guide];
+
+      return elementValues;
     }
 
-    /// Computes the opaque source identifier that is to be passed to an element mapper.
-    /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
-    /// associated with the state being mapped.
-    /// @param [in] elementMapIndex Positional index of the element mapper within the overall
-    /// element map.
-    /// @return Opaque source identifier value that can be passed to the element mapper.
-    inline uint32_t SourceIdentifierForElementMapper(
-        uint32_t sourceControllerIdentifier, uint32_t elementMapIndex)
+    /// Saturates all axis values in a controller state at the extreme ends of the allowed range.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    static void SaturateAxisValues(SState& controllerState)
     {
-      return (sourceControllerIdentifier << 8) + elementMapIndex;
+      for (auto& axisValue : controllerState.axis)
+      {
+        if (axisValue > kAnalogValueMax)
+          axisValue = kAnalogValueMax;
+        else if (axisValue < kAnalogValueMin)
+          axisValue = kAnalogValueMin;
+      }
     }
 
     Mapper::UElementMap::UElementMap(const UElementMap& other) : named()
@@ -389,10 +542,43 @@ namespace Xidi
         const std::wstring_view name,
         SElementMap&& elements,
         SForceFeedbackActuatorMap forceFeedbackActuators)
+        : Mapper(name, std::move(elements), TChords(), forceFeedbackActuators)
+    {}
+
+    Mapper::Mapper(
+        const std::wstring_view name,
+        SElementMap&& elements,
+        TChords&& chords,
+        SForceFeedbackActuatorMap forceFeedbackActuators)
         : elements(std::move(elements)),
+          program(this->elements.all),
+          chords(std::move(chords)),
           forceFeedbackActuators(forceFeedbackActuators),
-          capabilities(DeriveCapabilitiesFromElementMap(this->elements, forceFeedbackActuators)),
-          name(name)
+          forceFeedbackActuatorMatrix(LowerForceFeedbackActuatorMap(this->forceFeedbackActuators)),
+          capabilities(DeriveCapabilitiesFromElementMap(
+              this->elements, this->chords, forceFeedbackActuators)),
+          name(name),
+          specializedMapFunc(nullptr),
+          chordLatchedElements()
+    {
+      if (false == name.empty()) MapperRegistry::GetInstance().RegisterMapper(name, this);
+    }
+
+    Mapper::Mapper(
+        const std::wstring_view name,
+        SElementMap&& elements,
+        TSpecializedMapFunc specializedMapFunc,
+        SForceFeedbackActuatorMap forceFeedbackActuators)
+        : elements(std::move(elements)),
+          program(this->elements.all),
+          chords(),
+          forceFeedbackActuators(forceFeedbackActuators),
+          forceFeedbackActuatorMatrix(LowerForceFeedbackActuatorMap(this->forceFeedbackActuators)),
+          capabilities(DeriveCapabilitiesFromElementMap(
+              this->elements, this->chords, forceFeedbackActuators)),
+          name(name),
+          specializedMapFunc(specializedMapFunc),
+          chordLatchedElements()
     {
       if (false == name.empty()) MapperRegistry::GetInstance().RegisterMapper(name, this);
     }
@@ -401,6 +587,18 @@ namespace Xidi
         : Mapper(L"", std::move(elements), forceFeedbackActuators)
     {}
 
+    Mapper::Mapper(const Mapper& other)
+        : elements(other.elements),
+          program(this->elements.all),
+          chords(other.CloneChords()),
+          forceFeedbackActuators(other.forceFeedbackActuators),
+          forceFeedbackActuatorMatrix(other.forceFeedbackActuatorMatrix),
+          capabilities(other.capabilities),
+          name(other.name),
+          specializedMapFunc(nullptr),
+          chordLatchedElements()
+    {}
+
     Mapper::~Mapper(void)
     {
       if (false == name.empty()) MapperRegistry::GetInstance().UnregisterMapper(name, this);
@@ -427,6 +625,99 @@ namespace Xidi
       return *this;
     }
 
+    Mapper::TChords Mapper::CloneChords(void) const
+    {
+      TChords clonedChords;
+
+      for (size_t i = 0; i < chords.size(); ++i)
+      {
+        clonedChords[i].elements = chords[i].elements;
+        if (nullptr != chords[i].elementMapper)
+          clonedChords[i].elementMapper = chords[i].elementMapper->Clone();
+      }
+
+      return clonedChords;
+    }
+
+    void Mapper::ContributeFromChords(
+        TElementValues& elementValues,
+        SState& controllerState,
+        uint32_t sourceControllerIdentifier) const
+    {
+      TElementMapMask chordElements = 0;
+      for (const auto& chord : chords)
+        chordElements |= chord.elements;
+
+      if (0 == chordElements) return;
+
+      TElementMapMask& latchedElements =
+          chordLatchedElements[sourceControllerIdentifier % chordLatchedElements.size()];
+
+      TElementMapMask pressedElements = 0;
+      for (unsigned int elementMapIdx = 0; elementMapIdx < kElementCount; ++elementMapIdx)
+      {
+        if (0 != elementValues[elementMapIdx])
+          pressedElements |= ((TElementMapMask)1 << elementMapIdx);
+      }
+
+      // Buttons are released from a chord only once they are released physically, regardless of
+      // whether the chord is still held.
+      latchedElements &= pressedElements;
+
+      for (uint32_t chordIdx = 0; chordIdx < chords.size(); ++chordIdx)
+      {
+        const SChord& chord = chords[chordIdx];
+        if (0 == chord.elements) continue;
+
+        const bool chordHeld = (chord.elements == (pressedElements & chord.elements));
+        if (true == chordHeld) latchedElements |= chord.elements;
+
+        if (nullptr != chord.elementMapper)
+          chord.elementMapper->ContributeFromButtonValue(
+              controllerState,
+              chordHeld,
+              SourceIdentifierForChord(sourceControllerIdentifier, chordIdx));
+      }
+
+      for (unsigned int elementMapIdx = 0; elementMapIdx < kElementCount; ++elementMapIdx)
+      {
+        if (0 != (latchedElements & ((TElementMapMask)1 << elementMapIdx)))
+          elementValues[elementMapIdx] = 0;
+      }
+    }
+
+    Mapper::SCompiledPhysicalTransform Mapper::CompilePhysicalTransformProfile(
+        const SPhysicalTransformProfile& transformProfile)
+    {
+      return {
+          .circleToSquareStickLeft =
+              Math::MakeCircleToSquareTable(transformProfile.circleToSquareFractionStickLeft),
+          .circleToSquareStickRight =
+              Math::MakeCircleToSquareTable(transformProfile.circleToSquareFractionStickRight),
+          .analogTransformStickLeft = Math::MakeRawAnalogTransformParameters(
+              transformProfile.deadzonePercentStickLeft,
+              transformProfile.saturationPercentStickLeft),
+          .analogTransformStickRight = Math::MakeRawAnalogTransformParameters(
+              transformProfile.deadzonePercentStickRight,
+              transformProfile.saturationPercentStickRight),
+          .triggerTransformLT = Math::MakeRawTriggerTransformTable(
+              transformProfile.deadzonePercentTriggerLT,
+              transformProfile.saturationPercentTriggerLT),
+          .triggerTransformRT = Math::MakeRawTriggerTransformTable(
+              transformProfile.deadzonePercentTriggerRT,
+              transformProfile.saturationPercentTriggerRT)};
+    }
+
+    bool Mapper::IsMapperNameKnown(std::wstring_view mapperName)
+    {
+      return (nullptr != MapperRegistry::GetInstance().GetMapper(mapperName));
+    }
+
+    void Mapper::SetOnDemandBuildFunc(TOnDemandBuildFunc onDemandBuildFunc)
+    {
+      mapperOnDemandBuildFunc = onDemandBuildFunc;
+    }
+
     void Mapper::DumpRegisteredMappers(void)
     {
       MapperRegistry::GetInstance().DumpRegisteredMappers();
@@ -434,12 +725,18 @@ namespace Xidi
 
     const Mapper* Mapper::GetByName(std::wstring_view mapperName)
     {
-      return MapperRegistry::GetInstance().GetMapper(mapperName);
+      const Mapper* const mapper = MapperRegistry::GetInstance().GetMapper(mapperName);
+      if (nullptr != mapper) return mapper;
+
+      const TOnDemandBuildFunc onDemandBuildFunc = mapperOnDemandBuildFunc.load();
+      if (nullptr == onDemandBuildFunc) return nullptr;
+
+      return onDemandBuildFunc(mapperName);
     }
 
     const Mapper* Mapper::GetConfigured(TControllerIdentifier controllerIdentifier)
     {
-      static const Mapper* configuredMapper[kPhysicalControllerCount];
+      static const Mapper* configuredMapper[kMaxPhysicalControllerCount];
       static std::once_flag configuredMapperFlag;
 
       std::call_once(
@@ -546,6 +843,123 @@ namespace Xidi
       return configuredMapper[controllerIdentifier];
     }
 
+    const Mapper::SPhysicalTransformProfile& Mapper::GetConfiguredPhysicalTransformProfile(
+        TControllerIdentifier controllerIdentifier)
+    {
+      static SPhysicalTransformProfile configuredProfile[kMaxPhysicalControllerCount];
+      static std::once_flag configuredProfileFlag;
+
+      std::call_once(
+          configuredProfileFlag,
+          []() -> void
+          {
+            // These properties are read from the configuration file and can be used to apply extra
+            // transformations to raw analog values read from physical controllers. By default,
+            // deadzone percentage is set to 0 and saturation percentage is set to 100 to avoid any
+            // reduction in full analog range of motion, since most often applications will
+            // themselves apply a deadzone and saturation via virtual controller properties.
+            // However not all applications do this, and some interfaces like WinMM do not even
+            // support application-supplied properties. Furthermore, some games require an extra
+            // correction to map from a circular field of physical motion to a square field of
+            // virtual motion.
+            const auto& configData = Globals::GetConfigurationData();
+
+            for (TControllerIdentifier i = 0; i < _countof(configuredProfile); ++i)
+            {
+              const std::wstring_view perControllerSection =
+                  Strings::PropertiesConfigurationSectionString(i);
+
+              auto readSetting = [&configData, perControllerSection](
+                                     std::wstring_view name, int64_t defaultValue) -> int64_t
+              {
+                return configData[perControllerSection][name].ValueOr(
+                    configData[Strings::kStrConfigurationSectionProperties][name].ValueOr(
+                        defaultValue));
+              };
+
+              const int64_t circleToSquarePercentStickLeft = readSetting(
+                  Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickLeft, 0);
+              const int64_t circleToSquarePercentStickRight = readSetting(
+                  Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickRight, 0);
+
+              configuredProfile[i] = {
+                  .circleToSquareFractionStickLeft =
+                      static_cast<double>(circleToSquarePercentStickLeft) / 100.0,
+                  .circleToSquareFractionStickRight =
+                      static_cast<double>(circleToSquarePercentStickRight) / 100.0,
+                  .deadzonePercentStickLeft = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesDeadzonePercentStickLeft,
+                      kDefaultPhysicalTransformProfile.deadzonePercentStickLeft)),
+                  .deadzonePercentStickRight = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesDeadzonePercentStickRight,
+                      kDefaultPhysicalTransformProfile.deadzonePercentStickRight)),
+                  .deadzonePercentTriggerLT = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesDeadzonePercentTriggerLT,
+                      kDefaultPhysicalTransformProfile.deadzonePercentTriggerLT)),
+                  .deadzonePercentTriggerRT = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesDeadzonePercentTriggerRT,
+                      kDefaultPhysicalTransformProfile.deadzonePercentTriggerRT)),
+                  .saturationPercentStickLeft = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesSaturationPercentStickLeft,
+                      kDefaultPhysicalTransformProfile.saturationPercentStickLeft)),
+                  .saturationPercentStickRight = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesSaturationPercentStickRight,
+                      kDefaultPhysicalTransformProfile.saturationPercentStickRight)),
+                  .saturationPercentTriggerLT = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerLT,
+                      kDefaultPhysicalTransformProfile.saturationPercentTriggerLT)),
+                  .saturationPercentTriggerRT = static_cast<unsigned int>(readSetting(
+                      Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerRT,
+                      kDefaultPhysicalTransformProfile.saturationPercentTriggerRT))};
+            }
+          });
+
+      if (controllerIdentifier >= _countof(configuredProfile))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Internal error: Requesting a physical transform profile for out-of-bounds controller %u.",
+            (unsigned int)(1 + controllerIdentifier));
+        return kDefaultPhysicalTransformProfile;
+      }
+
+      return configuredProfile[controllerIdentifier];
+    }
+
+    const Mapper::SCompiledPhysicalTransform& Mapper::GetConfiguredPhysicalTransform(
+        TControllerIdentifier controllerIdentifier)
+    {
+      static SCompiledPhysicalTransform configuredTransform[kMaxPhysicalControllerCount];
+      static std::once_flag configuredTransformFlag;
+
+      std::call_once(
+          configuredTransformFlag,
+          []() -> void
+          {
+            for (TControllerIdentifier i = 0; i < _countof(configuredTransform); ++i)
+              configuredTransform[i] =
+                  CompilePhysicalTransformProfile(GetConfiguredPhysicalTransformProfile(i));
+          });
+
+      if (controllerIdentifier >= _countof(configuredTransform))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Internal error: Requesting a physical transform for out-of-bounds controller %u.",
+            (unsigned int)(1 + controllerIdentifier));
+        return GetDefaultPhysicalTransform();
+      }
+
+      return configuredTransform[controllerIdentifier];
+    }
+
+    const Mapper::SCompiledPhysicalTransform& Mapper::GetDefaultPhysicalTransform(void)
+    {
+      static const SCompiledPhysicalTransform kDefaultTransform =
+          CompilePhysicalTransformProfile(kDefaultPhysicalTransformProfile);
+      return kDefaultTransform;
+    }
+
     const Mapper* Mapper::GetNull(void)
     {
       static const Mapper kNullMapper({});
@@ -556,276 +970,187 @@ namespace Xidi
         ForceFeedback::TOrderedMagnitudeComponents virtualEffectComponents,
         ForceFeedback::TEffectValue gain) const
     {
+      constexpr ForceFeedback::TEffectValue kPhysicalActuatorRange = (ForceFeedback::TEffectValue)(
+          std::numeric_limits<ForceFeedback::TPhysicalActuatorValue>::max() -
+          std::numeric_limits<ForceFeedback::TPhysicalActuatorValue>::min());
+      constexpr ForceFeedback::TEffectValue kVirtualMagnitudeRange =
+          ForceFeedback::kEffectForceMagnitudeMaximum - ForceFeedback::kEffectForceMagnitudeZero;
+      constexpr ForceFeedback::TEffectValue kScalingFactor =
+          kPhysicalActuatorRange / kVirtualMagnitudeRange;
+
+      // Gain is the same for all physical actuators, so it is folded in once per call.
+      const ForceFeedback::TEffectValue gainMultiplier =
+          gain / ForceFeedback::kEffectModifierMaximum;
+      const ForceFeedback::TEffectValue virtualActuatorStrengthMax =
+          (ForceFeedback::kEffectForceMagnitudeMaximum - ForceFeedback::kEffectForceMagnitudeZero) *
+          gainMultiplier;
+
+      // Positive and negative parts of each virtual magnitude component are separated up front so
+      // that the per-actuator work below is a branch-free multiply-accumulate. Squares are taken
+      // in double precision, which is exact for all single-precision component values.
+      std::array<double, static_cast<int>(EAxis::Count)> positiveSquares = {};
+      std::array<double, static_cast<int>(EAxis::Count)> negativeSquares = {};
+      for (int axis = 0; axis < static_cast<int>(EAxis::Count); ++axis)
+      {
+        const double positivePart = (double)std::max(
+            virtualEffectComponents[axis] - ForceFeedback::kEffectForceMagnitudeZero,
+            (ForceFeedback::TEffectValue)0);
+        const double negativePart = (double)std::max(
+            ForceFeedback::kEffectForceMagnitudeZero - virtualEffectComponents[axis],
+            (ForceFeedback::TEffectValue)0);
+
+        positiveSquares[axis] = positivePart * positivePart;
+        negativeSquares[axis] = negativePart * negativePart;
+      }
+
+      std::array<ForceFeedback::TPhysicalActuatorValue, (int)ForceFeedback::EActuator::Count>
+          physicalActuatorValues = {};
+      for (int actuator = 0; actuator < (int)ForceFeedback::EActuator::Count; ++actuator)
+      {
+        double sumOfSquares = 0.0;
+        for (int axis = 0; axis < static_cast<int>(EAxis::Count); ++axis)
+          sumOfSquares +=
+              ((double)forceFeedbackActuatorMatrix.positiveWeights[actuator][axis] *
+               positiveSquares[axis]) +
+              ((double)forceFeedbackActuatorMatrix.negativeWeights[actuator][axis] *
+               negativeSquares[axis]);
+
+        const ForceFeedback::TEffectValue virtualActuatorStrengthRaw =
+            (ForceFeedback::TEffectValue)std::sqrt(sumOfSquares);
+        const ForceFeedback::TEffectValue virtualActuatorStrength =
+            std::min(virtualActuatorStrengthMax, gainMultiplier * virtualActuatorStrengthRaw);
+
+        physicalActuatorValues[actuator] = (ForceFeedback::TPhysicalActuatorValue)std::lround(
+            virtualActuatorStrength * kScalingFactor);
+      }
+
       return {
-          .leftMotor = ForceFeedbackActuatorValue(
-              virtualEffectComponents, forceFeedbackActuators.named.leftMotor, gain),
-          .rightMotor = ForceFeedbackActuatorValue(
-              virtualEffectComponents, forceFeedbackActuators.named.rightMotor, gain),
-          .leftImpulseTrigger = ForceFeedbackActuatorValue(
-              virtualEffectComponents, forceFeedbackActuators.named.leftImpulseTrigger, gain),
-          .rightImpulseTrigger = ForceFeedbackActuatorValue(
-              virtualEffectComponents, forceFeedbackActuators.named.rightImpulseTrigger, gain)};
+          .leftMotor = physicalActuatorValues[(int)ForceFeedback::EActuator::LeftMotor],
+          .rightMotor = physicalActuatorValues[(int)ForceFeedback::EActuator::RightMotor],
+          .leftImpulseTrigger =
+              physicalActuatorValues[(int)ForceFeedback::EActuator::LeftImpulseTrigger],
+          .rightImpulseTrigger =
+              physicalActuatorValues[(int)ForceFeedback::EActuator::RightImpulseTrigger]};
     }
 
     SState Mapper::MapStatePhysicalToVirtual(
-        SPhysicalState physicalState, uint32_t sourceControllerIdentifier) const
+        SPhysicalState physicalState,
+        const SCompiledPhysicalTransform& transform,
+        uint32_t sourceControllerIdentifier) const
     {
-      // These properties are read from the configuration file and can be used to apply extra
-      // transformations to raw analog values read from physical controllers. By default, deadzone
-      // percentage is set to 0 and saturation percentage is set to 100 to avoid any reduction in
-      // full analog range of motion, since most often applications will themselves apply a deadzone
-      // and saturation via virtual controller properties. However not all applications do this, and
-      // some interfaces like WinMM do not even support application-supplied properties.
-      // Furthermore, some games require an extra correction to map from a circular field of
-      // physical motion to a square field of virtual motion.
-      static const double kCircleToSquareFractionStickLeft =
-          static_cast<double>(
-              Globals::GetConfigurationData()
-                  [Strings::kStrConfigurationSectionProperties]
-                  [Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickLeft]
-                      .ValueOr(0)) /
-          100.0;
-      static const double kCircleToSquareFractionStickRight =
-          static_cast<double>(
-              Globals::GetConfigurationData()
-                  [Strings::kStrConfigurationSectionProperties]
-                  [Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickRight]
-                      .ValueOr(0)) /
-          100.0;
-      static const unsigned int kDeadzonePercentStickLeft = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesDeadzonePercentStickLeft]
-                  .ValueOr(0));
-      static const unsigned int kDeadzonePercentStickRight = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesDeadzonePercentStickRight]
-                  .ValueOr(0));
-      static const unsigned int kDeadzonePercentTriggerLT = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesDeadzonePercentTriggerLT]
-                  .ValueOr(0));
-      static const unsigned int kDeadzonePercentTriggerRT = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesDeadzonePercentTriggerRT]
-                  .ValueOr(0));
-      static const unsigned int kSaturationPercentStickLeft = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesSaturationPercentStickLeft]
-                  .ValueOr(100));
-      static const unsigned int kSaturationPercentStickRight = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesSaturationPercentStickRight]
-                  .ValueOr(100));
-      static const unsigned int kSaturationPercentTriggerLT = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerLT]
-                  .ValueOr(100));
-      static const unsigned int kSaturationPercentTriggerRT = static_cast<unsigned int>(
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionProperties]
-              [Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerRT]
-                  .ValueOr(100));
+      // Keyboard and mouse side effects of element mappers are committed all at once after mapping
+      // is complete, rather than individually as each element mapper makes them.
+      Keyboard::ScopedSubmissionBatch keyboardSubmissionBatch;
+      Mouse::ScopedSubmissionBatch mouseSubmissionBatch;
 
-      // If requested by the user, left and right stick values need to be transformed so that a
-      // circular field of physical motion is transformed into a square field of virtual motion.
-      const Math::SAnalogStickCoordinates stickLeftCoordinates =
-          Math::TransformCoordinatesCircleToSquare(
-              {.x = physicalState[EPhysicalStick::LeftX],
-               .y = physicalState[EPhysicalStick::LeftY]},
-              kCircleToSquareFractionStickLeft);
-      const Math::SAnalogStickCoordinates stickRightCoordinates =
-          Math::TransformCoordinatesCircleToSquare(
-              {.x = physicalState[EPhysicalStick::RightX],
-               .y = physicalState[EPhysicalStick::RightY]},
-              kCircleToSquareFractionStickRight);
+      TElementValues elementValues = ReadElementValues(physicalState, transform);
 
       SState controllerState = {};
+      ContributeFromChords(elementValues, controllerState, sourceControllerIdentifier);
 
-      // Left and right stick values need to be saturated at the virtual controller range due to a
-      // very slight difference between XInput range and virtual controller range. This difference
-      // (-32768 extreme negative for XInput vs -32767 extreme negative for Xidi) does not affect
-      // functionality when filtered by saturation. Vertical analog axes additionally need to be
-      // inverted because XInput presents up as positive and down as negative whereas Xidi needs to
-      // do the opposite.
-
-      if (nullptr != elements.named.stickLeftX)
-        elements.named.stickLeftX->ContributeFromAnalogValue(
-            controllerState,
-            Math::ApplyRawAnalogTransform(
-                FilterAnalogStickValue(stickLeftCoordinates.x),
-                kDeadzonePercentStickLeft,
-                kSaturationPercentStickLeft),
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(stickLeftX)));
-      if (nullptr != elements.named.stickLeftY)
-        elements.named.stickLeftY->ContributeFromAnalogValue(
-            controllerState,
-            Math::ApplyRawAnalogTransform(
-                FilterAndInvertAnalogStickValue(stickLeftCoordinates.y),
-                kDeadzonePercentStickLeft,
-                kSaturationPercentStickLeft),
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(stickLeftY)));
-
-      if (nullptr != elements.named.stickRightX)
-        elements.named.stickRightX->ContributeFromAnalogValue(
-            controllerState,
-            Math::ApplyRawAnalogTransform(
-                FilterAnalogStickValue(stickRightCoordinates.x),
-                kDeadzonePercentStickRight,
-                kSaturationPercentStickRight),
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(stickRightX)));
-      if (nullptr != elements.named.stickRightY)
-        elements.named.stickRightY->ContributeFromAnalogValue(
-            controllerState,
-            Math::ApplyRawAnalogTransform(
-                FilterAndInvertAnalogStickValue(stickRightCoordinates.y),
-                kDeadzonePercentStickRight,
-                kSaturationPercentStickRight),
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(stickRightY)));
-
-      if (nullptr != elements.named.dpadUp)
-        elements.named.dpadUp->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::DpadUp],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(dpadUp)));
-      if (nullptr != elements.named.dpadDown)
-        elements.named.dpadDown->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::DpadDown],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(dpadDown)));
-      if (nullptr != elements.named.dpadLeft)
-        elements.named.dpadLeft->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::DpadLeft],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(dpadLeft)));
-      if (nullptr != elements.named.dpadRight)
-        elements.named.dpadRight->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::DpadRight],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(dpadRight)));
-
-      if (nullptr != elements.named.triggerLT)
-        elements.named.triggerLT->ContributeFromTriggerValue(
-            controllerState,
-            Math::ApplyRawTriggerTransform(
-                physicalState[EPhysicalTrigger::LT],
-                kDeadzonePercentTriggerLT,
-                kSaturationPercentTriggerLT),
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(triggerLT)));
-      if (nullptr != elements.named.triggerRT)
-        elements.named.triggerRT->ContributeFromTriggerValue(
-            controllerState,
-            Math::ApplyRawTriggerTransform(
-                physicalState[EPhysicalTrigger::RT],
-                kDeadzonePercentTriggerRT,
-                kSaturationPercentTriggerRT),
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(triggerRT)));
-
-      if (nullptr != elements.named.buttonA)
-        elements.named.buttonA->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::A],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonA)));
-      if (nullptr != elements.named.buttonB)
-        elements.named.buttonB->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::B],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonB)));
-      if (nullptr != elements.named.buttonX)
-        elements.named.buttonX->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::X],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonX)));
-      if (nullptr != elements.named.buttonY)
-        elements.named.buttonY->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::Y],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonY)));
-
-      if (nullptr != elements.named.buttonLB)
-        elements.named.buttonLB->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::LB],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonLB)));
-      if (nullptr != elements.named.buttonRB)
-        elements.named.buttonRB->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::RB],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonRB)));
-
-      if (nullptr != elements.named.buttonBack)
-        elements.named.buttonBack->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::Back],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonBack)));
-      if (nullptr != elements.named.buttonStart)
-        elements.named.buttonStart->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::Start],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonStart)));
-
-      if (nullptr != elements.named.buttonLS)
-        elements.named.buttonLS->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::LS],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonLS)));
-      if (nullptr != elements.named.buttonRS)
-        elements.named.buttonRS->ContributeFromButtonValue(
-            controllerState,
-            physicalState[EPhysicalButton::RS],
-            SourceIdentifierForElementMapper(
-                sourceControllerIdentifier, ELEMENT_MAP_INDEX_OF(buttonRS)));
+      if (nullptr != specializedMapFunc)
+      {
+        specializedMapFunc(elementValues, controllerState, sourceControllerIdentifier);
+      }
+      else
+      {
+        for (unsigned int elementMapIdx = 0; elementMapIdx < kElementCount; ++elementMapIdx)
+          ContributeFromElementValue(
+              program,
+              elementMapIdx,
+              controllerState,
+              elementValues[elementMapIdx],
+              sourceControllerIdentifier);
+      }
 
       // Once all contributions have been committed, saturate all axis values at the extreme ends of
       // the allowed range. Doing this at the end means that intermediate contributions are computed
       // with much more range than the controller is allowed to report, which can increase accuracy
       // when there are multiple interfering mappers contributing to axes.
-      for (auto& axisValue : controllerState.axis)
+      SaturateAxisValues(controllerState);
+      return controllerState;
+    }
+
+    SState Mapper::MapStatePhysicalToVirtualIncremental(
+        SPhysicalState physicalState,
+        const SCompiledPhysicalTransform& transform,
+        uint32_t sourceControllerIdentifier,
+        SIncrementalMappingState& mappingState) const
+    {
+      // As with full mapping, keyboard and mouse side effects are committed all at once.
+      Keyboard::ScopedSubmissionBatch keyboardSubmissionBatch;
+      Mouse::ScopedSubmissionBatch mouseSubmissionBatch;
+
+      TElementValues elementValues = ReadElementValues(physicalState, transform);
+      const bool hasCachedContributions = (this == mappingState.mapper);
+
+      // Chords are evaluated on every mapping, before element values are compared, so that only
+      // the element values that actually reach the element map are cached.
+      SState controllerState = {};
+      ContributeFromChords(elementValues, controllerState, sourceControllerIdentifier);
+
+      // Keyboard and mouse contributions from multiple sources are combined such that a press
+      // from any source takes precedence over a release from any other source during the same
+      // mapping. For this to keep working, whenever any element mapper with side effects needs to
+      // be invoked, all of them need to be invoked.
+      bool invokeAllWithSideEffects = (false == hasCachedContributions);
+      for (unsigned int elementMapIdx = 0;
+           (false == invokeAllWithSideEffects) && (elementMapIdx < kElementCount);
+           ++elementMapIdx)
       {
-        if (axisValue > kAnalogValueMax)
-          axisValue = kAnalogValueMax;
-        else if (axisValue < kAnalogValueMin)
-          axisValue = kAnalogValueMin;
+        if (elementValues[elementMapIdx] != mappingState.elementValue[elementMapIdx])
+          invokeAllWithSideEffects = program.HasSideEffects(elementMapIdx);
       }
 
+      for (unsigned int elementMapIdx = 0; elementMapIdx < kElementCount; ++elementMapIdx)
+      {
+        const bool shouldInvoke =
+            ((false == hasCachedContributions) ||
+             (elementValues[elementMapIdx] != mappingState.elementValue[elementMapIdx]) ||
+             ((true == invokeAllWithSideEffects) &&
+              (true == program.HasSideEffects(elementMapIdx))));
+
+        if (true == shouldInvoke)
+        {
+          mappingState.elementContribution[elementMapIdx] = {};
+          ContributeFromElementValue(
+              program,
+              elementMapIdx,
+              mappingState.elementContribution[elementMapIdx],
+              elementValues[elementMapIdx],
+              sourceControllerIdentifier);
+        }
+
+        MergeContribution(controllerState, mappingState.elementContribution[elementMapIdx]);
+      }
+
+      mappingState.mapper = this;
+      mappingState.elementValue = elementValues;
+
+      SaturateAxisValues(controllerState);
       return controllerState;
     }
 
     SState Mapper::MapNeutralPhysicalToVirtual(uint32_t sourceControllerIdentifier) const
     {
+      // As with full mapping, keyboard and mouse side effects are committed all at once.
+      Keyboard::ScopedSubmissionBatch keyboardSubmissionBatch;
+      Mouse::ScopedSubmissionBatch mouseSubmissionBatch;
+
       SState controllerState = {};
 
       for (uint32_t elementMapIdx = 0; elementMapIdx < _countof(elements.all); ++elementMapIdx)
+        program.ContributeNeutral(
+            elementMapIdx,
+            controllerState,
+            SourceIdentifierForElementMapper(sourceControllerIdentifier, elementMapIdx));
+
+      chordLatchedElements[sourceControllerIdentifier % chordLatchedElements.size()] = 0;
+      for (uint32_t chordIdx = 0; chordIdx < chords.size(); ++chordIdx)
       {
-        if (nullptr != elements.all[elementMapIdx])
-          elements.all[elementMapIdx]->ContributeNeutral(
-              controllerState,
-              SourceIdentifierForElementMapper(sourceControllerIdentifier, elementMapIdx));
+        if (nullptr != chords[chordIdx].elementMapper)
+          chords[chordIdx].elementMapper->ContributeNeutral(
+              controllerState, SourceIdentifierForChord(sourceControllerIdentifier, chordIdx));
       }
 
       return controllerState;
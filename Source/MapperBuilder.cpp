@@ -11,14 +11,23 @@
 
 #include "MapperBuilder.h"
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include <Infra/Core/Message.h>
 
 #include "Mapper.h"
 #include "MapperParser.h"
+#include "StartupTrace.h"
 
 namespace Xidi
 {
@@ -38,8 +47,97 @@ namespace Xidi
       return mapperNames->emplace_back(mapperName);
     }
 
+    /// Creates a new mapper object from a blueprint, whose template, if any, has already been
+    /// resolved to an existing mapper object. The blueprint's element mappers are moved into the
+    /// new mapper object.
+    /// @param [in] mapperName Name of the mapper to create.
+    /// @param [in,out] blueprint Blueprint that describes the mapper.
+    /// @param [in] templateMapper Mapper object that acts as the template, or `nullptr` if the
+    /// mapper is being built from scratch.
+    /// @return Pointer to the new mapper object, which is owned by the internal mapper registry.
+    static const Mapper* CreateMapperFromBlueprint(
+        std::wstring_view mapperName,
+        MapperBuilder::SBlueprint& blueprint,
+        const Mapper* templateMapper)
+    {
+      Mapper::UElementMap mapperElements;
+      Mapper::UForceFeedbackActuatorMap mapperForceFeedbackActuators;
+
+      if (nullptr != templateMapper)
+        mapperForceFeedbackActuators = templateMapper->GetForceFeedbackActuatorMap();
+
+      // Element mappers described by the blueprint are moved directly into the new element map,
+      // and only the remaining controller elements are cloned from the template, if there is one.
+      // Changes are ordered by element index, so they can be consumed in a single pass.
+      auto elementChangeIter = blueprint.elementChangesFromTemplate.begin();
+      for (unsigned int i = 0; i < _countof(mapperElements.all); ++i)
+      {
+        if ((blueprint.elementChangesFromTemplate.end() != elementChangeIter) &&
+            (i == elementChangeIter->first))
+        {
+          mapperElements.all[i] = std::move(elementChangeIter->second);
+          ++elementChangeIter;
+        }
+        else if (
+            (nullptr != templateMapper) && (nullptr != templateMapper->ElementMap().all[i]))
+        {
+          mapperElements.all[i] = templateMapper->ElementMap().all[i]->Clone();
+        }
+      }
+
+      // If the actuator map is empty, then no template was specified and no actuators were parsed
+      // out of the configuration file. This means that the default actuator map should be used.
+      // Otherwise the logic is the same as for the element changes.
+      if (true == blueprint.ffActuatorChangesFromTemplate.empty())
+      {
+        mapperForceFeedbackActuators = Mapper::kDefaultForceFeedbackActuatorMap;
+      }
+      else
+      {
+        for (auto& ffActuatorChangeFromTemplate : blueprint.ffActuatorChangesFromTemplate)
+          mapperForceFeedbackActuators.all[ffActuatorChangeFromTemplate.first] =
+              ffActuatorChangeFromTemplate.second;
+      }
+
+      // Chords are handled the same way as element mappers.
+      Mapper::TChords mapperChords =
+          ((nullptr != templateMapper) ? templateMapper->CloneChords() : Mapper::TChords());
+      for (auto& chordChangeFromTemplate : blueprint.chordChangesFromTemplate)
+        mapperChords[chordChangeFromTemplate.first] = std::move(chordChangeFromTemplate.second);
+
+      return new Mapper(
+          mapperName,
+          std::move(mapperElements.named),
+          std::move(mapperChords),
+          mapperForceFeedbackActuators.named);
+    }
+
+    void MapperBuilder::AllowReplacingMapper(std::wstring_view mapperName)
+    {
+      replaceableMapperNames.insert(SafeMapperNameString(mapperName));
+    }
+
     bool MapperBuilder::Build(void)
     {
+      const StartupTrace::ScopedPhase buildPhase(L"MapperBuilder::Build");
+
+      // If every blueprint can be placed into a dependency level then blueprints are built one
+      // level at a time, with all of the blueprints in each level built concurrently. Otherwise at
+      // least one build is going to fail, so everything is built one at a time to ensure errors
+      // are reported the same way as they would be when building each mapper individually.
+      const std::optional<std::vector<std::vector<std::wstring_view>>> maybeBuildLevels =
+          ComputeBuildLevels();
+
+      if (true == maybeBuildLevels.has_value())
+      {
+        for (const auto& buildLevel : maybeBuildLevels.value())
+        {
+          if (false == BuildIndependent(buildLevel)) return false;
+        }
+
+        return true;
+      }
+
       for (const auto& blueprintItem : blueprints)
       {
         if ((true == blueprintItem.second.buildAttempted) ||
@@ -63,7 +161,7 @@ namespace Xidi
         return nullptr;
       }
 
-      if (true == Mapper::IsMapperNameKnown(mapperName))
+      if (true == IsMapperNameResolved(mapperName))
       {
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Error,
@@ -97,15 +195,14 @@ namespace Xidi
 
       blueprint.buildAttempted = true;
 
-      Mapper::UElementMap mapperElements;
-      Mapper::UForceFeedbackActuatorMap mapperForceFeedbackActuators;
+      const Mapper* templateMapper = nullptr;
 
       if (false == blueprint.templateName.empty())
       {
         // If a template is specified, then the mapper element starting point comes from an existing
         // mapper object. If the mapper object named in the template does not exist, try to build
         // it. It is an error if that dependent build operation fails.
-        if (false == Mapper::IsMapperNameKnown(blueprint.templateName))
+        if (false == IsMapperNameResolved(blueprint.templateName))
         {
           // The purpose of this check is to make error messages easier to understand by making it
           // immediately obvious why a template build operation failed. Without it, the user would
@@ -162,36 +259,83 @@ namespace Xidi
           return nullptr;
         }
 
-        mapperElements = Mapper::GetByName(blueprint.templateName)->CloneElementMap();
-        mapperForceFeedbackActuators =
-            Mapper::GetByName(blueprint.templateName)->GetForceFeedbackActuatorMap();
+        templateMapper = kTemplateMapper;
       }
 
-      // Loop through all the changes that the blueprint describes and apply them to the starting
-      // point. If the starting point is empty then this is essentially building a new element map
-      // from scratch.
-      for (auto& elementChangeFromTemplate : blueprint.elementChangesFromTemplate)
-        mapperElements.all[elementChangeFromTemplate.first] =
-            std::move(elementChangeFromTemplate.second);
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info, L"Successfully built mapper %s.", mapperName.data());
+      return CreateMapperFromBlueprint(mapperName, blueprint, templateMapper);
+    }
 
-      // If the actuator map is empty, then no template was specified and no actuators were parsed
-      // out of the configuration file. This means that the default actuator map should be used.
-      // Otherwise the logic is the same as for the element changes.
-      if (true == blueprint.ffActuatorChangesFromTemplate.empty())
+    const Mapper* MapperBuilder::BuildIfPending(std::wstring_view mapperName)
+    {
+      const auto blueprintIter = blueprints.find(mapperName);
+      if ((blueprints.cend() == blueprintIter) || (true == blueprintIter->second.buildAttempted) ||
+          (false == blueprintIter->second.buildCanAttempt))
+        return nullptr;
+
+      const StartupTrace::ScopedPhase buildPhase(L"MapperBuilder::BuildIfPending");
+      return Build(mapperName);
+    }
+
+    bool MapperBuilder::BuildIndependent(std::span<const std::wstring_view> mapperNames)
+    {
+      // Small numbers of blueprints are not worth the overhead of starting threads.
+      static constexpr size_t kMinMapperCountForConcurrentBuild = 4;
+
+      if (mapperNames.size() < kMinMapperCountForConcurrentBuild)
       {
-        mapperForceFeedbackActuators = Mapper::kDefaultForceFeedbackActuatorMap;
+        for (const auto mapperName : mapperNames)
+        {
+          if (nullptr == Build(mapperName)) return false;
+        }
+
+        return true;
       }
-      else
+
+      // Everything that touches the blueprint map or depends on the order of messages happens on
+      // this thread. Only the construction of mapper objects themselves is done concurrently.
+      std::vector<SBlueprint*> mapperBlueprints;
+      std::vector<const Mapper*> templateMappers;
+      mapperBlueprints.reserve(mapperNames.size());
+      templateMappers.reserve(mapperNames.size());
+
+      for (const auto mapperName : mapperNames)
       {
-        for (auto& ffActuatorChangeFromTemplate : blueprint.ffActuatorChangesFromTemplate)
-          mapperForceFeedbackActuators.all[ffActuatorChangeFromTemplate.first] =
-              ffActuatorChangeFromTemplate.second;
+        SBlueprint& blueprint = blueprints.at(mapperName);
+        blueprint.buildAttempted = true;
+
+        mapperBlueprints.push_back(&blueprint);
+        templateMappers.push_back(
+            (true == blueprint.templateName.empty()) ? nullptr
+                                                     : Mapper::GetByName(blueprint.templateName));
       }
 
-      Infra::Message::OutputFormatted(
-          Infra::Message::ESeverity::Info, L"Successfully built mapper %s.", mapperName.data());
-      return new Mapper(
-          mapperName, std::move(mapperElements.named), mapperForceFeedbackActuators.named);
+      std::atomic<size_t> nextMapperIndex = 0;
+      auto buildWorker = [&]() -> void
+      {
+        for (size_t i = nextMapperIndex++; i < mapperNames.size(); i = nextMapperIndex++)
+          CreateMapperFromBlueprint(mapperNames[i], *mapperBlueprints[i], templateMappers[i]);
+      };
+
+      const size_t numWorkerThreads =
+          std::min(mapperNames.size(), (size_t)std::max(1u, std::thread::hardware_concurrency()));
+
+      std::vector<std::thread> workerThreads;
+      workerThreads.reserve(numWorkerThreads - 1);
+      for (size_t i = 1; i < numWorkerThreads; ++i)
+        workerThreads.emplace_back(buildWorker);
+
+      buildWorker();
+
+      for (auto& workerThread : workerThreads)
+        workerThread.join();
+
+      for (const auto mapperName : mapperNames)
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info, L"Successfully built mapper %s.", mapperName.data());
+
+      return true;
     }
 
     bool MapperBuilder::ClearBlueprintElementMapper(
@@ -245,9 +389,81 @@ namespace Xidi
           mapperName, maybeForceFeedbackActuatorIndex.value());
     }
 
+    std::optional<std::vector<std::vector<std::wstring_view>>> MapperBuilder::ComputeBuildLevels(
+        void) const
+    {
+      std::map<std::wstring_view, unsigned int> buildLevelByName;
+      std::vector<std::vector<std::wstring_view>> buildLevels;
+
+      for (const auto& blueprintItem : blueprints)
+      {
+        if ((true == blueprintItem.second.buildAttempted) ||
+            (false == blueprintItem.second.buildCanAttempt))
+          continue;
+
+        // Follow the chain of templates until reaching either a mapper that already exists or a
+        // blueprint whose level is already known. Anything that would cause the build of any
+        // blueprint in the chain to fail means the levels cannot be computed.
+        std::vector<std::wstring_view> templateChain;
+        std::wstring_view currentName = blueprintItem.first;
+        unsigned int baseLevel = 0;
+
+        while (true)
+        {
+          const auto knownLevel = buildLevelByName.find(currentName);
+          if (buildLevelByName.cend() != knownLevel)
+          {
+            baseLevel = 1 + knownLevel->second;
+            break;
+          }
+
+          if (true == IsMapperNameResolved(currentName)) return std::nullopt;
+
+          const auto blueprintIter = blueprints.find(currentName);
+          if ((blueprints.cend() == blueprintIter) ||
+              (true == blueprintIter->second.buildAttempted) ||
+              (false == blueprintIter->second.buildCanAttempt))
+            return std::nullopt;
+
+          if (templateChain.cend() !=
+              std::find(templateChain.cbegin(), templateChain.cend(), currentName))
+            return std::nullopt;
+
+          templateChain.push_back(currentName);
+
+          const std::wstring_view templateName = blueprintIter->second.templateName;
+          if ((true == templateName.empty()) || (true == IsMapperNameResolved(templateName)))
+            break;
+
+          currentName = templateName;
+        }
+
+        // Blueprints at the end of the chain are built first, so they get the lowest levels.
+        for (auto chainIter = templateChain.crbegin(); chainIter != templateChain.crend();
+             ++chainIter)
+        {
+          if (baseLevel == buildLevels.size()) buildLevels.emplace_back();
+
+          buildLevelByName[*chainIter] = baseLevel;
+          buildLevels[baseLevel].push_back(*chainIter);
+          baseLevel += 1;
+        }
+      }
+
+      // Insertion order follows template chains rather than storage order, so restore storage
+      // order within each level. That way the order of messages does not depend on which
+      // blueprints happen to refer to which other blueprints as templates.
+      for (auto& buildLevel : buildLevels)
+        std::sort(buildLevel.begin(), buildLevel.end());
+
+      return buildLevels;
+    }
+
     bool MapperBuilder::CreateBlueprint(std::wstring_view mapperName)
     {
-      if (true == Mapper::IsMapperNameKnown(mapperName)) return false;
+      if ((true == Mapper::IsMapperNameKnown(mapperName)) &&
+          (false == replaceableMapperNames.contains(mapperName)))
+        return false;
 
       return blueprints.emplace(std::make_pair(SafeMapperNameString(mapperName), SBlueprint()))
           .second;
@@ -294,6 +510,44 @@ namespace Xidi
       return true;
     }
 
+    bool MapperBuilder::IsMapperNameResolved(std::wstring_view mapperName) const
+    {
+      if (false == Mapper::IsMapperNameKnown(mapperName)) return false;
+      if (false == replaceableMapperNames.contains(mapperName)) return true;
+
+      // An existing mapper that is allowed to be replaced continues to stand in for its name
+      // until a build attempt is made on the blueprint that replaces it.
+      const auto blueprintIter = blueprints.find(mapperName);
+      return (
+          (blueprints.cend() == blueprintIter) || (true == blueprintIter->second.buildAttempted));
+    }
+
+    bool MapperBuilder::RemoveBlueprint(std::wstring_view mapperName)
+    {
+      return (0 != blueprints.erase(mapperName));
+    }
+
+    bool MapperBuilder::SetBlueprintChord(
+        std::wstring_view mapperName, unsigned int chordIndex, Mapper::SChord&& chord)
+    {
+      const auto blueprintIter = blueprints.find(mapperName);
+      if (blueprints.end() == blueprintIter) return false;
+
+      if (chordIndex >= Mapper::kMaxChordCount) return false;
+
+      blueprintIter->second.chordChangesFromTemplate[chordIndex] = std::move(chord);
+      return true;
+    }
+
+    bool MapperBuilder::SetBlueprintChord(
+        std::wstring_view mapperName, std::wstring_view chordString, Mapper::SChord&& chord)
+    {
+      const std::optional<unsigned int> maybeChordIndex = MapperParser::FindChordIndex(chordString);
+      if (false == maybeChordIndex.has_value()) return false;
+
+      return SetBlueprintChord(mapperName, maybeChordIndex.value(), std::move(chord));
+    }
+
     bool MapperBuilder::SetBlueprintElementMapper(
         std::wstring_view mapperName,
         unsigned int elementIndex,
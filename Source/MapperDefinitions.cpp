@@ -9,6 +9,12 @@
  *   Definitions of all known mapper types.
  **************************************************************************************************/
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "Mapper.h"
@@ -17,121 +23,320 @@ namespace Xidi
 {
   namespace Controller
   {
-    /// Defines all known mapper types, one element per type. The first element is the default
-    /// mapper. Any field that corresponds to an XInput controller element can be omitted or
-    /// assigned `nullptr` and the mapper will simply ignore input from that XInput controller
+    /// Base type for compile-time descriptions of the element maps of built-in mappers. Each field
+    /// corresponds to a field of the same name in #Mapper::SElementMap. Built-in mapper layouts
+    /// derive from this type and hide any fields that correspond to XInput controller elements
+    /// they use with element mapper objects of the same name. Any fields not hidden this way
+    /// remain `nullptr`, and the mapper will simply ignore input from that XInput controller
     /// element.
+    struct SBuiltinMapperLayout
+    {
+      static constexpr std::nullptr_t stickLeftX = nullptr;
+      static constexpr std::nullptr_t stickLeftY = nullptr;
+      static constexpr std::nullptr_t stickRightX = nullptr;
+      static constexpr std::nullptr_t stickRightY = nullptr;
+      static constexpr std::nullptr_t dpadUp = nullptr;
+      static constexpr std::nullptr_t dpadDown = nullptr;
+      static constexpr std::nullptr_t dpadLeft = nullptr;
+      static constexpr std::nullptr_t dpadRight = nullptr;
+      static constexpr std::nullptr_t triggerLT = nullptr;
+      static constexpr std::nullptr_t triggerRT = nullptr;
+      static constexpr std::nullptr_t buttonA = nullptr;
+      static constexpr std::nullptr_t buttonB = nullptr;
+      static constexpr std::nullptr_t buttonX = nullptr;
+      static constexpr std::nullptr_t buttonY = nullptr;
+      static constexpr std::nullptr_t buttonLB = nullptr;
+      static constexpr std::nullptr_t buttonRB = nullptr;
+      static constexpr std::nullptr_t buttonBack = nullptr;
+      static constexpr std::nullptr_t buttonStart = nullptr;
+      static constexpr std::nullptr_t buttonLS = nullptr;
+      static constexpr std::nullptr_t buttonRS = nullptr;
+      static constexpr std::nullptr_t buttonGuide = nullptr;
+    };
+
+    /// Element map of the "StandardGamepad" built-in mapper.
+    struct SStandardGamepadLayout : public SBuiltinMapperLayout
+    {
+      static constexpr AxisMapper stickLeftX = AxisMapper(EAxis::X);
+      static constexpr AxisMapper stickLeftY = AxisMapper(EAxis::Y);
+      static constexpr AxisMapper stickRightX = AxisMapper(EAxis::Z);
+      static constexpr AxisMapper stickRightY = AxisMapper(EAxis::RotZ);
+      static constexpr PovMapper dpadUp = PovMapper(EPovDirection::Up);
+      static constexpr PovMapper dpadDown = PovMapper(EPovDirection::Down);
+      static constexpr PovMapper dpadLeft = PovMapper(EPovDirection::Left);
+      static constexpr PovMapper dpadRight = PovMapper(EPovDirection::Right);
+      static constexpr ButtonMapper triggerLT = ButtonMapper(EButton::B7);
+      static constexpr ButtonMapper triggerRT = ButtonMapper(EButton::B8);
+      static constexpr ButtonMapper buttonA = ButtonMapper(EButton::B1);
+      static constexpr ButtonMapper buttonB = ButtonMapper(EButton::B2);
+      static constexpr ButtonMapper buttonX = ButtonMapper(EButton::B3);
+      static constexpr ButtonMapper buttonY = ButtonMapper(EButton::B4);
+      static constexpr ButtonMapper buttonLB = ButtonMapper(EButton::B5);
+      static constexpr ButtonMapper buttonRB = ButtonMapper(EButton::B6);
+      static constexpr ButtonMapper buttonBack = ButtonMapper(EButton::B9);
+      static constexpr ButtonMapper buttonStart = ButtonMapper(EButton::B10);
+      static constexpr ButtonMapper buttonLS = ButtonMapper(EButton::B11);
+      static constexpr ButtonMapper buttonRS = ButtonMapper(EButton::B12);
+    };
+
+    /// Element map of the "DigitalGamepad" built-in mapper.
+    struct SDigitalGamepadLayout : public SBuiltinMapperLayout
+    {
+      static constexpr DigitalAxisMapper stickLeftX = DigitalAxisMapper(EAxis::X);
+      static constexpr DigitalAxisMapper stickLeftY = DigitalAxisMapper(EAxis::Y);
+      static constexpr DigitalAxisMapper stickRightX = DigitalAxisMapper(EAxis::Z);
+      static constexpr DigitalAxisMapper stickRightY = DigitalAxisMapper(EAxis::RotZ);
+      static constexpr DigitalAxisMapper dpadUp =
+          DigitalAxisMapper(EAxis::Y, EAxisDirection::Negative);
+      static constexpr DigitalAxisMapper dpadDown =
+          DigitalAxisMapper(EAxis::Y, EAxisDirection::Positive);
+      static constexpr DigitalAxisMapper dpadLeft =
+          DigitalAxisMapper(EAxis::X, EAxisDirection::Negative);
+      static constexpr DigitalAxisMapper dpadRight =
+          DigitalAxisMapper(EAxis::X, EAxisDirection::Positive);
+      static constexpr ButtonMapper triggerLT = ButtonMapper(EButton::B7);
+      static constexpr ButtonMapper triggerRT = ButtonMapper(EButton::B8);
+      static constexpr ButtonMapper buttonA = ButtonMapper(EButton::B1);
+      static constexpr ButtonMapper buttonB = ButtonMapper(EButton::B2);
+      static constexpr ButtonMapper buttonX = ButtonMapper(EButton::B3);
+      static constexpr ButtonMapper buttonY = ButtonMapper(EButton::B4);
+      static constexpr ButtonMapper buttonLB = ButtonMapper(EButton::B5);
+      static constexpr ButtonMapper buttonRB = ButtonMapper(EButton::B6);
+      static constexpr ButtonMapper buttonBack = ButtonMapper(EButton::B9);
+      static constexpr ButtonMapper buttonStart = ButtonMapper(EButton::B10);
+      static constexpr ButtonMapper buttonLS = ButtonMapper(EButton::B11);
+      static constexpr ButtonMapper buttonRS = ButtonMapper(EButton::B12);
+    };
+
+    /// Element map of the "ExtendedGamepad" built-in mapper.
+    struct SExtendedGamepadLayout : public SBuiltinMapperLayout
+    {
+      static constexpr AxisMapper stickLeftX = AxisMapper(EAxis::X);
+      static constexpr AxisMapper stickLeftY = AxisMapper(EAxis::Y);
+      static constexpr AxisMapper stickRightX = AxisMapper(EAxis::Z);
+      static constexpr AxisMapper stickRightY = AxisMapper(EAxis::RotZ);
+      static constexpr PovMapper dpadUp = PovMapper(EPovDirection::Up);
+      static constexpr PovMapper dpadDown = PovMapper(EPovDirection::Down);
+      static constexpr PovMapper dpadLeft = PovMapper(EPovDirection::Left);
+      static constexpr PovMapper dpadRight = PovMapper(EPovDirection::Right);
+      static constexpr AxisMapper triggerLT = AxisMapper(EAxis::RotX);
+      static constexpr AxisMapper triggerRT = AxisMapper(EAxis::RotY);
+      static constexpr ButtonMapper buttonA = ButtonMapper(EButton::B1);
+      static constexpr ButtonMapper buttonB = ButtonMapper(EButton::B2);
+      static constexpr ButtonMapper buttonX = ButtonMapper(EButton::B3);
+      static constexpr ButtonMapper buttonY = ButtonMapper(EButton::B4);
+      static constexpr ButtonMapper buttonLB = ButtonMapper(EButton::B5);
+      static constexpr ButtonMapper buttonRB = ButtonMapper(EButton::B6);
+      static constexpr ButtonMapper buttonBack = ButtonMapper(EButton::B7);
+      static constexpr ButtonMapper buttonStart = ButtonMapper(EButton::B8);
+      static constexpr ButtonMapper buttonLS = ButtonMapper(EButton::B9);
+      static constexpr ButtonMapper buttonRS = ButtonMapper(EButton::B10);
+    };
+
+    /// Element map of the "XInputNative" built-in mapper.
+    struct SXInputNativeLayout : public SBuiltinMapperLayout
+    {
+      static constexpr AxisMapper stickLeftX = AxisMapper(EAxis::X);
+      static constexpr AxisMapper stickLeftY = AxisMapper(EAxis::Y);
+      static constexpr AxisMapper stickRightX = AxisMapper(EAxis::RotX);
+      static constexpr AxisMapper stickRightY = AxisMapper(EAxis::RotY);
+      static constexpr PovMapper dpadUp = PovMapper(EPovDirection::Up);
+      static constexpr PovMapper dpadDown = PovMapper(EPovDirection::Down);
+      static constexpr PovMapper dpadLeft = PovMapper(EPovDirection::Left);
+      static constexpr PovMapper dpadRight = PovMapper(EPovDirection::Right);
+      static constexpr AxisMapper triggerLT = AxisMapper(EAxis::Z);
+      static constexpr AxisMapper triggerRT = AxisMapper(EAxis::RotZ);
+      static constexpr ButtonMapper buttonA = ButtonMapper(EButton::B1);
+      static constexpr ButtonMapper buttonB = ButtonMapper(EButton::B2);
+      static constexpr ButtonMapper buttonX = ButtonMapper(EButton::B3);
+      static constexpr ButtonMapper buttonY = ButtonMapper(EButton::B4);
+      static constexpr ButtonMapper buttonLB = ButtonMapper(EButton::B5);
+      static constexpr ButtonMapper buttonRB = ButtonMapper(EButton::B6);
+      static constexpr ButtonMapper buttonBack = ButtonMapper(EButton::B7);
+      static constexpr ButtonMapper buttonStart = ButtonMapper(EButton::B8);
+      static constexpr ButtonMapper buttonLS = ButtonMapper(EButton::B9);
+      static constexpr ButtonMapper buttonRS = ButtonMapper(EButton::B10);
+    };
+
+    /// Element map of the "XInputSharedTriggers" built-in mapper.
+    struct SXInputSharedTriggersLayout : public SBuiltinMapperLayout
+    {
+      static constexpr AxisMapper stickLeftX = AxisMapper(EAxis::X);
+      static constexpr AxisMapper stickLeftY = AxisMapper(EAxis::Y);
+      static constexpr AxisMapper stickRightX = AxisMapper(EAxis::RotX);
+      static constexpr AxisMapper stickRightY = AxisMapper(EAxis::RotY);
+      static constexpr PovMapper dpadUp = PovMapper(EPovDirection::Up);
+      static constexpr PovMapper dpadDown = PovMapper(EPovDirection::Down);
+      static constexpr PovMapper dpadLeft = PovMapper(EPovDirection::Left);
+      static constexpr PovMapper dpadRight = PovMapper(EPovDirection::Right);
+      static constexpr AxisMapper triggerLT = AxisMapper(EAxis::Z, EAxisDirection::Positive);
+      static constexpr AxisMapper triggerRT = AxisMapper(EAxis::Z, EAxisDirection::Negative);
+      static constexpr ButtonMapper buttonA = ButtonMapper(EButton::B1);
+      static constexpr ButtonMapper buttonB = ButtonMapper(EButton::B2);
+      static constexpr ButtonMapper buttonX = ButtonMapper(EButton::B3);
+      static constexpr ButtonMapper buttonY = ButtonMapper(EButton::B4);
+      static constexpr ButtonMapper buttonLB = ButtonMapper(EButton::B5);
+      static constexpr ButtonMapper buttonRB = ButtonMapper(EButton::B6);
+      static constexpr ButtonMapper buttonBack = ButtonMapper(EButton::B7);
+      static constexpr ButtonMapper buttonStart = ButtonMapper(EButton::B8);
+      static constexpr ButtonMapper buttonLS = ButtonMapper(EButton::B9);
+      static constexpr ButtonMapper buttonRS = ButtonMapper(EButton::B10);
+    };
+
+    /// Creates a heap-allocated copy of the specified built-in element mapper object.
+    /// @tparam kElementMapper Element mapper object, or `nullptr` if the element is unused.
+    /// @return Smart pointer to the copy, or `nullptr` if the element is unused.
+    template <const auto& kElementMapper> static std::unique_ptr<const IElementMapper>
+        CloneBuiltinElementMapper(void)
+    {
+      if constexpr (std::is_same_v<std::remove_cvref_t<decltype(kElementMapper)>, std::nullptr_t>)
+        return nullptr;
+      else
+        return kElementMapper.Clone();
+    }
+
+    /// Makes the contribution to controller state of a single built-in element mapper object. The
+    /// element mapper's type is known at compile time, so its contribution method is called
+    /// directly rather than virtually and can be inlined.
+    /// @tparam kElementMapper Element mapper object, or `nullptr` if the element is unused.
+    /// @tparam kElementMapIndex Positional index of the element mapper within the overall element
+    /// map, which also determines the type of physical controller element.
+    /// @param [in] elementValues Values of all physical controller elements.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+    /// associated with the state being mapped.
+    template <const auto& kElementMapper, unsigned int kElementMapIndex>
+    static inline void ContributeFromBuiltin(
+        const Mapper::TElementValues& elementValues,
+        SState& controllerState,
+        uint32_t sourceControllerIdentifier)
+    {
+      using TElementMapper = std::remove_cvref_t<decltype(kElementMapper)>;
+
+      if constexpr (false == std::is_same_v<TElementMapper, std::nullptr_t>)
+      {
+        constexpr bool kIsAnalogStick =
+            ((ELEMENT_MAP_INDEX_OF(stickLeftX) == kElementMapIndex) ||
+             (ELEMENT_MAP_INDEX_OF(stickLeftY) == kElementMapIndex) ||
+             (ELEMENT_MAP_INDEX_OF(stickRightX) == kElementMapIndex) ||
+             (ELEMENT_MAP_INDEX_OF(stickRightY) == kElementMapIndex));
+        constexpr bool kIsTrigger =
+            ((ELEMENT_MAP_INDEX_OF(triggerLT) == kElementMapIndex) ||
+             (ELEMENT_MAP_INDEX_OF(triggerRT) == kElementMapIndex));
+
+        const int16_t elementValue = elementValues[kElementMapIndex];
+        const uint32_t sourceIdentifier =
+            Mapper::SourceIdentifierForElementMapper(sourceControllerIdentifier, kElementMapIndex);
+
+        if constexpr (true == kIsAnalogStick)
+          kElementMapper.TElementMapper::ContributeFromAnalogValue(
+              controllerState, elementValue, sourceIdentifier);
+        else if constexpr (true == kIsTrigger)
+          kElementMapper.TElementMapper::ContributeFromTriggerValue(
+              controllerState, (uint8_t)elementValue, sourceIdentifier);
+        else
+          kElementMapper.TElementMapper::ContributeFromButtonValue(
+              controllerState, (0 != elementValue), sourceIdentifier);
+      }
+    }
+
+    /// Makes all of the contributions to controller state of a built-in mapper layout in a single
+    /// straight-line pass. Suitable for use as a specialized mapping function.
+    /// @tparam LayoutType Built-in mapper layout type.
+    /// @param [in] elementValues Values of all physical controller elements.
+    /// @param [in,out] controllerState Controller state data structure to be updated.
+    /// @param [in] sourceControllerIdentifier Opaque identifier of the physical controller
+    /// associated with the state being mapped.
+    template <typename LayoutType> static void MapBuiltinElementValues(
+        const Mapper::TElementValues& elementValues,
+        SState& controllerState,
+        uint32_t sourceControllerIdentifier)
+    {
+      ContributeFromBuiltin<LayoutType::stickLeftX, ELEMENT_MAP_INDEX_OF(stickLeftX)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::stickLeftY, ELEMENT_MAP_INDEX_OF(stickLeftY)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::stickRightX, ELEMENT_MAP_INDEX_OF(stickRightX)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::stickRightY, ELEMENT_MAP_INDEX_OF(stickRightY)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::dpadUp, ELEMENT_MAP_INDEX_OF(dpadUp)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::dpadDown, ELEMENT_MAP_INDEX_OF(dpadDown)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::dpadLeft, ELEMENT_MAP_INDEX_OF(dpadLeft)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::dpadRight, ELEMENT_MAP_INDEX_OF(dpadRight)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::triggerLT, ELEMENT_MAP_INDEX_OF(triggerLT)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::triggerRT, ELEMENT_MAP_INDEX_OF(triggerRT)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonA, ELEMENT_MAP_INDEX_OF(buttonA)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonB, ELEMENT_MAP_INDEX_OF(buttonB)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonX, ELEMENT_MAP_INDEX_OF(buttonX)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonY, ELEMENT_MAP_INDEX_OF(buttonY)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonLB, ELEMENT_MAP_INDEX_OF(buttonLB)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonRB, ELEMENT_MAP_INDEX_OF(buttonRB)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonBack, ELEMENT_MAP_INDEX_OF(buttonBack)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonStart, ELEMENT_MAP_INDEX_OF(buttonStart)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonLS, ELEMENT_MAP_INDEX_OF(buttonLS)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonRS, ELEMENT_MAP_INDEX_OF(buttonRS)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+      ContributeFromBuiltin<LayoutType::buttonGuide, ELEMENT_MAP_INDEX_OF(buttonGuide)>(
+          elementValues, controllerState, sourceControllerIdentifier);
+    }
+
+    /// Creates a built-in mapper from the specified layout. The layout is the single source of
+    /// truth: its element mapper objects are copied into the mapper's element map and are also
+    /// used to generate the mapper's specialized mapping function.
+    /// @tparam LayoutType Built-in mapper layout type.
+    /// @param [in] name Name of the mapper.
+    /// @return Newly-created mapper object.
+    template <typename LayoutType> static Mapper MakeBuiltinMapper(const std::wstring_view name)
+    {
+      return Mapper(
+          name,
+          {.stickLeftX = CloneBuiltinElementMapper<LayoutType::stickLeftX>(),
+           .stickLeftY = CloneBuiltinElementMapper<LayoutType::stickLeftY>(),
+           .stickRightX = CloneBuiltinElementMapper<LayoutType::stickRightX>(),
+           .stickRightY = CloneBuiltinElementMapper<LayoutType::stickRightY>(),
+           .dpadUp = CloneBuiltinElementMapper<LayoutType::dpadUp>(),
+           .dpadDown = CloneBuiltinElementMapper<LayoutType::dpadDown>(),
+           .dpadLeft = CloneBuiltinElementMapper<LayoutType::dpadLeft>(),
+           .dpadRight = CloneBuiltinElementMapper<LayoutType::dpadRight>(),
+           .triggerLT = CloneBuiltinElementMapper<LayoutType::triggerLT>(),
+           .triggerRT = CloneBuiltinElementMapper<LayoutType::triggerRT>(),
+           .buttonA = CloneBuiltinElementMapper<LayoutType::buttonA>(),
+           .buttonB = CloneBuiltinElementMapper<LayoutType::buttonB>(),
+           .buttonX = CloneBuiltinElementMapper<LayoutType::buttonX>(),
+           .buttonY = CloneBuiltinElementMapper<LayoutType::buttonY>(),
+           .buttonLB = CloneBuiltinElementMapper<LayoutType::buttonLB>(),
+           .buttonRB = CloneBuiltinElementMapper<LayoutType::buttonRB>(),
+           .buttonBack = CloneBuiltinElementMapper<LayoutType::buttonBack>(),
+           .buttonStart = CloneBuiltinElementMapper<LayoutType::buttonStart>(),
+           .buttonLS = CloneBuiltinElementMapper<LayoutType::buttonLS>(),
+           .buttonRS = CloneBuiltinElementMapper<LayoutType::buttonRS>(),
+           .buttonGuide = CloneBuiltinElementMapper<LayoutType::buttonGuide>()},
+          &MapBuiltinElementValues<LayoutType>);
+    }
+
+    /// Defines all known mapper types, one element per type. The first element is the default
+    /// mapper.
     static const Mapper kMappers[] = {
-        Mapper(
-            L"StandardGamepad",
-            {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-             .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-             .stickRightX = std::make_unique<AxisMapper>(EAxis::Z),
-             .stickRightY = std::make_unique<AxisMapper>(EAxis::RotZ),
-             .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-             .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-             .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-             .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-             .triggerLT = std::make_unique<ButtonMapper>(EButton::B7),
-             .triggerRT = std::make_unique<ButtonMapper>(EButton::B8),
-             .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-             .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-             .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-             .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-             .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-             .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-             .buttonBack = std::make_unique<ButtonMapper>(EButton::B9),
-             .buttonStart = std::make_unique<ButtonMapper>(EButton::B10),
-             .buttonLS = std::make_unique<ButtonMapper>(EButton::B11),
-             .buttonRS = std::make_unique<ButtonMapper>(EButton::B12)}),
-        Mapper(
-            L"DigitalGamepad",
-            {.stickLeftX = std::make_unique<DigitalAxisMapper>(EAxis::X),
-             .stickLeftY = std::make_unique<DigitalAxisMapper>(EAxis::Y),
-             .stickRightX = std::make_unique<DigitalAxisMapper>(EAxis::Z),
-             .stickRightY = std::make_unique<DigitalAxisMapper>(EAxis::RotZ),
-             .dpadUp = std::make_unique<DigitalAxisMapper>(EAxis::Y, EAxisDirection::Negative),
-             .dpadDown = std::make_unique<DigitalAxisMapper>(EAxis::Y, EAxisDirection::Positive),
-             .dpadLeft = std::make_unique<DigitalAxisMapper>(EAxis::X, EAxisDirection::Negative),
-             .dpadRight = std::make_unique<DigitalAxisMapper>(EAxis::X, EAxisDirection::Positive),
-             .triggerLT = std::make_unique<ButtonMapper>(EButton::B7),
-             .triggerRT = std::make_unique<ButtonMapper>(EButton::B8),
-             .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-             .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-             .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-             .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-             .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-             .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-             .buttonBack = std::make_unique<ButtonMapper>(EButton::B9),
-             .buttonStart = std::make_unique<ButtonMapper>(EButton::B10),
-             .buttonLS = std::make_unique<ButtonMapper>(EButton::B11),
-             .buttonRS = std::make_unique<ButtonMapper>(EButton::B12)}),
-        Mapper(
-            L"ExtendedGamepad",
-            {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-             .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-             .stickRightX = std::make_unique<AxisMapper>(EAxis::Z),
-             .stickRightY = std::make_unique<AxisMapper>(EAxis::RotZ),
-             .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-             .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-             .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-             .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-             .triggerLT = std::make_unique<AxisMapper>(EAxis::RotX),
-             .triggerRT = std::make_unique<AxisMapper>(EAxis::RotY),
-             .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-             .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-             .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-             .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-             .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-             .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-             .buttonBack = std::make_unique<ButtonMapper>(EButton::B7),
-             .buttonStart = std::make_unique<ButtonMapper>(EButton::B8),
-             .buttonLS = std::make_unique<ButtonMapper>(EButton::B9),
-             .buttonRS = std::make_unique<ButtonMapper>(EButton::B10)}),
-
-        Mapper(
-            L"XInputNative",
-            {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-             .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-             .stickRightX = std::make_unique<AxisMapper>(EAxis::RotX),
-             .stickRightY = std::make_unique<AxisMapper>(EAxis::RotY),
-             .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-             .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-             .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-             .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-             .triggerLT = std::make_unique<AxisMapper>(EAxis::Z),
-             .triggerRT = std::make_unique<AxisMapper>(EAxis::RotZ),
-             .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-             .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-             .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-             .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-             .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-             .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-             .buttonBack = std::make_unique<ButtonMapper>(EButton::B7),
-             .buttonStart = std::make_unique<ButtonMapper>(EButton::B8),
-             .buttonLS = std::make_unique<ButtonMapper>(EButton::B9),
-             .buttonRS = std::make_unique<ButtonMapper>(EButton::B10)}),
-        Mapper(
-            L"XInputSharedTriggers",
-            {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
-             .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
-             .stickRightX = std::make_unique<AxisMapper>(EAxis::RotX),
-             .stickRightY = std::make_unique<AxisMapper>(EAxis::RotY),
-             .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
-             .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
-             .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
-             .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
-             .triggerLT = std::make_unique<AxisMapper>(EAxis::Z, EAxisDirection::Positive),
-             .triggerRT = std::make_unique<AxisMapper>(EAxis::Z, EAxisDirection::Negative),
-             .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
-             .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
-             .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
-             .buttonY = std::make_unique<ButtonMapper>(EButton::B4),
-             .buttonLB = std::make_unique<ButtonMapper>(EButton::B5),
-             .buttonRB = std::make_unique<ButtonMapper>(EButton::B6),
-             .buttonBack = std::make_unique<ButtonMapper>(EButton::B7),
-             .buttonStart = std::make_unique<ButtonMapper>(EButton::B8),
-             .buttonLS = std::make_unique<ButtonMapper>(EButton::B9),
-             .buttonRS = std::make_unique<ButtonMapper>(EButton::B10)})};
+        MakeBuiltinMapper<SStandardGamepadLayout>(L"StandardGamepad"),
+        MakeBuiltinMapper<SDigitalGamepadLayout>(L"DigitalGamepad"),
+        MakeBuiltinMapper<SExtendedGamepadLayout>(L"ExtendedGamepad"),
+        MakeBuiltinMapper<SXInputNativeLayout>(L"XInputNative"),
+        MakeBuiltinMapper<SXInputSharedTriggersLayout>(L"XInputSharedTriggers")};
   } // namespace Controller
 } // namespace Xidi
@@ -16,9 +16,11 @@
 #include <cstddef>
 #include <cwchar>
 #include <cwctype>
-#include <map>
+#include <algorithm>
+#include <array>
 #include <optional>
 #include <string_view>
+#include <utility>
 
 #include <Infra/Core/Strings.h>
 #include <Infra/Core/ValueOrError.h>
@@ -78,6 +80,75 @@ namespace Xidi
       /// given a parameter string.
       using TMakeForceFeedbackActuatorFunc = ForceFeedbackActuatorOrError (*)(std::wstring_view);
 
+      /// Immutable table that maps strings to values. Entries are sorted when the table is built,
+      /// which happens entirely at compile time, so that lookups can be done by binary search
+      /// without any runtime construction or dynamic memory allocation.
+      /// @tparam ValueType Type of value to which each string maps.
+      /// @tparam kNumEntries Number of entries in the table.
+      template <typename ValueType, size_t kNumEntries> class StringLookupTable
+      {
+      public:
+
+        /// Type of each entry in the table.
+        using TEntry = std::pair<std::wstring_view, ValueType>;
+
+        consteval StringLookupTable(const TEntry (&unsortedEntries)[kNumEntries]) : entries()
+        {
+          for (size_t i = 0; i < kNumEntries; ++i)
+            entries[i] = unsortedEntries[i];
+
+          std::sort(
+              entries.begin(),
+              entries.end(),
+              [](const TEntry& a, const TEntry& b) -> bool
+              {
+                return a.first < b.first;
+              });
+
+          // Duplicate strings are not allowed. Reaching this point during constant evaluation
+          // makes the table fail to compile.
+          for (size_t i = 1; i < kNumEntries; ++i)
+          {
+            if (entries[i - 1].first == entries[i].first) throw "Duplicate string in lookup table";
+          }
+        }
+
+        /// Looks up the value to which the specified string maps.
+        /// @param [in] key String to look up. Comparison is exact and case-sensitive.
+        /// @return Value to which the string maps, if the string is present in the table.
+        constexpr std::optional<ValueType> Find(std::wstring_view key) const
+        {
+          const auto entryIter = std::lower_bound(
+              entries.cbegin(),
+              entries.cend(),
+              key,
+              [](const TEntry& entry, std::wstring_view key) -> bool
+              {
+                return entry.first < key;
+              });
+
+          if ((entries.cend() == entryIter) || (key != entryIter->first)) return std::nullopt;
+          return entryIter->second;
+        }
+
+      private:
+
+        /// Table entries, sorted by string.
+        std::array<TEntry, kNumEntries> entries;
+      };
+
+      /// Builds a string lookup table from an unsorted list of entries.
+      /// @tparam ValueType Type of value to which each string maps.
+      /// @tparam kNumEntries Number of entries in the table, deduced from the argument.
+      /// @param [in] unsortedEntries Entries to place into the table, in any order.
+      /// @return Lookup table containing all of the entries.
+      template <typename ValueType, size_t kNumEntries>
+      static consteval StringLookupTable<ValueType, kNumEntries> MakeStringLookupTable(
+          const std::pair<std::wstring_view, ValueType> (&unsortedEntries)[kNumEntries])
+      {
+        return StringLookupTable<ValueType, kNumEntries>(unsortedEntries);
+      }
+
       /// Holds parameters for creating various types of axis mapper objects, where those mapper
       /// objects include an axis enumerator and an axis direction enumerator.
       /// @tparam AxisEnumType Axis enumeration type that identifies the target axis.
@@ -100,7 +171,7 @@ namespace Xidi
           std::wstring_view directionString)
       {
         // Map of strings representing axis directions to axis direction enumerators.
-        static const std::map<std::wstring_view, EAxisDirection> kDirectionStrings = {
+        static constexpr auto kDirectionStrings = MakeStringLookupTable<EAxisDirection>({
             {L"bidir", EAxisDirection::Both},         {L"Bidir", EAxisDirection::Both},
             {L"BiDir", EAxisDirection::Both},         {L"BIDIR", EAxisDirection::Both},
             {L"bidirectional", EAxisDirection::Both}, {L"Bidirectional", EAxisDirection::Both},
@@ -116,12 +187,9 @@ namespace Xidi
             {L"-", EAxisDirection::Negative},         {L"-ve", EAxisDirection::Negative},
             {L"neg", EAxisDirection::Negative},       {L"Neg", EAxisDirection::Negative},
             {L"NEG", EAxisDirection::Negative},       {L"negative", EAxisDirection::Negative},
-            {L"Negative", EAxisDirection::Negative},  {L"NEGATIVE", EAxisDirection::Negative}};
+            {L"Negative", EAxisDirection::Negative},  {L"NEGATIVE", EAxisDirection::Negative}});
 
-        const auto directionIter = kDirectionStrings.find(directionString);
-        if (kDirectionStrings.cend() == directionIter) return std::nullopt;
-
-        return directionIter->second;
+        return kDirectionStrings.Find(directionString);
       }
 
       /// Attempts to map a string to an axis type enumerator. This generic version does nothing.
@@ -140,7 +208,7 @@ namespace Xidi
       template <> static std::optional<EAxis> AxisTypeFromString(std::wstring_view axisString)
       {
         // Map of strings representing axes to axis enumerators.
-        static const std::map<std::wstring_view, EAxis> kAxisStrings = {
+        static constexpr auto kAxisStrings = MakeStringLookupTable<EAxis>({
             {L"x", EAxis::X},       {L"X", EAxis::X},
 
             {L"y", EAxis::Y},       {L"Y", EAxis::Y},
@@ -157,12 +225,9 @@ namespace Xidi
 
             {L"rz", EAxis::RotZ},   {L"Rz", EAxis::RotZ},   {L"rZ", EAxis::RotZ},
             {L"RZ", EAxis::RotZ},   {L"rotz", EAxis::RotZ}, {L"rotZ", EAxis::RotZ},
-            {L"Rotz", EAxis::RotZ}, {L"RotZ", EAxis::RotZ}};
-
-        const auto axisIter = kAxisStrings.find(axisString);
-        if (kAxisStrings.cend() == axisIter) return std::nullopt;
+            {L"Rotz", EAxis::RotZ}, {L"RotZ", EAxis::RotZ}});
 
-        return axisIter->second;
+        return kAxisStrings.Find(axisString);
       }
 
       /// Attempts to map a string to an axis type enumerator, specialized for mouse axes.
@@ -172,7 +237,7 @@ namespace Xidi
           std::wstring_view axisString)
       {
         // Map of strings representing mouse axes to mouse axis enumerators.
-        static const std::map<std::wstring_view, Mouse::EMouseAxis> kMouseAxisStrings = {
+        static constexpr auto kMouseAxisStrings = MakeStringLookupTable<Mouse::EMouseAxis>({
             {L"x", Mouse::EMouseAxis::X},
             {L"X", Mouse::EMouseAxis::X},
             {L"h", Mouse::EMouseAxis::X},
@@ -207,12 +272,9 @@ namespace Xidi
             {L"wheelY", Mouse::EMouseAxis::WheelVertical},
             {L"WheelY", Mouse::EMouseAxis::WheelVertical},
             {L"wheelVertical", Mouse::EMouseAxis::WheelVertical},
-            {L"WheelVertical", Mouse::EMouseAxis::WheelVertical}};
-
-        const auto mouseAxisIter = kMouseAxisStrings.find(axisString);
-        if (kMouseAxisStrings.cend() == mouseAxisIter) return std::nullopt;
+            {L"WheelVertical", Mouse::EMouseAxis::WheelVertical}});
 
-        return mouseAxisIter->second;
+        return kMouseAxisStrings.Find(axisString);
       }
 
       /// Identifies the end position of the first parameter in the supplied string which should be
@@ -394,7 +456,7 @@ namespace Xidi
         // One pair exists per DIK_* constant. Comparisons with the input string are
         // case-insensitive because the input string is converted to uppercase to match the contents
         // of this map.
-        static const std::map<std::wstring_view, unsigned int> kKeyboardScanCodeStrings = {
+        static constexpr auto kKeyboardScanCodeStrings = MakeStringLookupTable<unsigned int>({
 
             // Convenience aliases
             {L"ESC", DIK_ESCAPE},
@@ -560,7 +622,7 @@ namespace Xidi
             {L"LEFTARROW", DIK_LEFTARROW},
             {L"RIGHTARROW", DIK_RIGHTARROW},
             {L"DOWNARROW", DIK_DOWNARROW},
-            {L"PGDN", DIK_PGDN}};
+            {L"PGDN", DIK_PGDN}});
 
         static constexpr size_t kMaxChars = 24;
         if (kbString.length() >= kMaxChars) return std::nullopt;
@@ -587,11 +649,7 @@ namespace Xidi
           }
         }
 
-        const auto keyboardScanCodeIter = kKeyboardScanCodeStrings.find(convertBuffer);
-        if (kKeyboardScanCodeStrings.cend() == keyboardScanCodeIter)
-          return std::nullopt;
-        else
-          return keyboardScanCodeIter->second;
+        return kKeyboardScanCodeStrings.Find(convertBuffer);
       }
 
       /// Parses a string representation of a mouse button into a mouse button enumerator.
@@ -602,7 +660,7 @@ namespace Xidi
       static std::optional<Mouse::EMouseButton> ParseMouseButton(std::wstring_view mbString)
       {
         // Map of strings representing mouse buttons.
-        static const std::map<std::wstring_view, Mouse::EMouseButton> kMouseButtonStrings = {
+        static constexpr auto kMouseButtonStrings = MakeStringLookupTable<Mouse::EMouseButton>({
 
             // Left button
             {L"left", Mouse::EMouseButton::Left},
@@ -651,13 +709,9 @@ namespace Xidi
             {L"Forward", Mouse::EMouseButton::X2},
             {L"forwardbutton", Mouse::EMouseButton::X2},
             {L"Forwardbutton", Mouse::EMouseButton::X2},
-            {L"ForwardButton", Mouse::EMouseButton::X2}};
+            {L"ForwardButton", Mouse::EMouseButton::X2}});
 
-        const auto mouseButtonIter = kMouseButtonStrings.find(mbString);
-        if (kMouseButtonStrings.cend() == mouseButtonIter)
-          return std::nullopt;
-        else
-          return mouseButtonIter->second;
+        return kMouseButtonStrings.Find(mbString);
       }
 
       /// Trims all whitespace from the back of the supplied string.
@@ -699,7 +753,7 @@ namespace Xidi
       {
         // Map of strings representing controller elements to indices within the element map data
         // structure. One pair exists per field in the SElementMap structure.
-        static const std::map<std::wstring_view, unsigned int> kControllerElementStrings = {
+        static constexpr auto kControllerElementStrings = MakeStringLookupTable<unsigned int>({
             {L"StickLeftX", ELEMENT_MAP_INDEX_OF(stickLeftX)},
             {L"StickLeftY", ELEMENT_MAP_INDEX_OF(stickLeftY)},
             {L"StickRightX", ELEMENT_MAP_INDEX_OF(stickRightX)},
@@ -719,28 +773,39 @@ namespace Xidi
             {L"ButtonBack", ELEMENT_MAP_INDEX_OF(buttonBack)},
             {L"ButtonStart", ELEMENT_MAP_INDEX_OF(buttonStart)},
             {L"ButtonLS", ELEMENT_MAP_INDEX_OF(buttonLS)},
-            {L"ButtonRS", ELEMENT_MAP_INDEX_OF(buttonRS)}};
+            {L"ButtonRS", ELEMENT_MAP_INDEX_OF(buttonRS)},
+            {L"ButtonGuide", ELEMENT_MAP_INDEX_OF(buttonGuide)}});
 
-        const auto controllerElementIter = kControllerElementStrings.find(controllerElementString);
-        if (kControllerElementStrings.cend() == controllerElementIter)
-          return std::nullopt;
-        else
-          return controllerElementIter->second;
+        return kControllerElementStrings.Find(controllerElementString);
       }
 
       std::optional<unsigned int> FindForceFeedbackActuatorIndex(std::wstring_view ffActuatorString)
       {
         // Map of strings representing controller elements to indices within the element map data
         // structure. One pair exists per field in the SForceFeedbackActuatorMap structure.
-        static const std::map<std::wstring_view, unsigned int> kForceFeedbackActuatorStrings = {
+        static constexpr auto kForceFeedbackActuatorStrings = MakeStringLookupTable<unsigned int>({
             {L"ForceFeedback.LeftMotor", FFACTUATOR_MAP_INDEX_OF(leftMotor)},
-            {L"ForceFeedback.RightMotor", FFACTUATOR_MAP_INDEX_OF(rightMotor)}};
+            {L"ForceFeedback.RightMotor", FFACTUATOR_MAP_INDEX_OF(rightMotor)}});
 
-        const auto ffActuatorIter = kForceFeedbackActuatorStrings.find(ffActuatorString);
-        if (kForceFeedbackActuatorStrings.cend() == ffActuatorIter)
-          return std::nullopt;
-        else
-          return ffActuatorIter->second;
+        return kForceFeedbackActuatorStrings.Find(ffActuatorString);
+      }
+
+      std::optional<unsigned int> FindChordIndex(std::wstring_view chordString)
+      {
+        // Map of strings representing chords to indices within a mapper's chords. One pair exists
+        // per chord that a mapper can hold.
+        static constexpr auto kChordStrings = MakeStringLookupTable<unsigned int>({
+            {L"Chord1", 0},
+            {L"Chord2", 1},
+            {L"Chord3", 2},
+            {L"Chord4", 3},
+            {L"Chord5", 4},
+            {L"Chord6", 5},
+            {L"Chord7", 6},
+            {L"Chord8", 7}});
+
+        static_assert(8 == Mapper::kMaxChordCount, "Chord strings do not cover all chords.");
+        return kChordStrings.Find(chordString);
       }
 
       ElementMapperOrError ElementMapperFromString(std::wstring_view elementMapperString)
@@ -750,7 +815,7 @@ namespace Xidi
         if (false == maybeRecursionDepth.has_value())
           return Infra::Strings::Format(L"Syntax error: Unbalanced parentheses").Data();
 
-        const unsigned int kRecursionDepth = ComputeRecursionDepth(elementMapperString).value();
+        const unsigned int kRecursionDepth = maybeRecursionDepth.value();
         if (kRecursionDepth > kElementMapperMaxRecursionDepth)
           return Infra::Strings::Format(
                      L"Nesting depth %u exceeds limit of %u",
@@ -777,12 +842,81 @@ namespace Xidi
         if (false == maybeRecursionDepth.has_value())
           return Infra::Strings::Format(L"Syntax error: Unbalanced parentheses").Data();
 
-        const unsigned int kRecursionDepth = ComputeRecursionDepth(ffActuatorString).value();
+        const unsigned int kRecursionDepth = maybeRecursionDepth.value();
         if (kRecursionDepth > 1) return L"Nesting is not allowed for force feedback actuators";
 
         return ParseForceFeedbackActuator(ffActuatorString);
       }
 
+      ChordOrError ChordFromString(std::wstring_view chordString)
+      {
+        Mapper::SChord chord;
+        std::wstring_view remainingString = chordString;
+
+        for (unsigned int paramNumber = 1; true; ++paramNumber)
+        {
+          const std::optional<SParamStringParts> maybeParamParts =
+              ExtractParameterListStringParts(remainingString);
+          if (false == maybeParamParts.has_value())
+            return Infra::Strings::Format(L"Parameter %u: Syntax error", paramNumber).Data();
+
+          // The last parameter is the element mapper, and all of the others are buttons.
+          if (true == maybeParamParts->remaining.empty())
+          {
+            if (paramNumber < 3) return L"At least two buttons and an element mapper are required";
+
+            ElementMapperOrError maybeElementMapper =
+                ElementMapperFromString(maybeParamParts->first);
+            if (false == maybeElementMapper.HasValue())
+              return Infra::Strings::Format(
+                         L"Parameter %u: %s", paramNumber, maybeElementMapper.Error().c_str())
+                  .Data();
+
+            chord.elementMapper = std::move(maybeElementMapper.Value());
+            return std::move(chord);
+          }
+
+          const std::optional<unsigned int> maybeElementIndex =
+              FindControllerElementIndex(maybeParamParts->first);
+          if (false == maybeElementIndex.has_value())
+            return Infra::Strings::Format(
+                       L"Parameter %u: \"%s\" is not a controller element",
+                       paramNumber,
+                       std::wstring(maybeParamParts->first).c_str())
+                .Data();
+
+          switch (maybeElementIndex.value())
+          {
+            case ELEMENT_MAP_INDEX_OF(stickLeftX):
+            case ELEMENT_MAP_INDEX_OF(stickLeftY):
+            case ELEMENT_MAP_INDEX_OF(stickRightX):
+            case ELEMENT_MAP_INDEX_OF(stickRightY):
+            case ELEMENT_MAP_INDEX_OF(triggerLT):
+            case ELEMENT_MAP_INDEX_OF(triggerRT):
+              return Infra::Strings::Format(
+                         L"Parameter %u: \"%s\" is not a button",
+                         paramNumber,
+                         std::wstring(maybeParamParts->first).c_str())
+                  .Data();
+
+            default:
+              break;
+          }
+
+          const Mapper::TElementMapMask elementBit = (Mapper::TElementMapMask)1
+              << maybeElementIndex.value();
+          if (0 != (chord.elements & elementBit))
+            return Infra::Strings::Format(
+                       L"Parameter %u: \"%s\" appears more than once",
+                       paramNumber,
+                       std::wstring(maybeParamParts->first).c_str())
+                .Data();
+
+          chord.elements |= elementBit;
+          remainingString = maybeParamParts->remaining;
+        }
+      }
+
       std::optional<unsigned int> ComputeRecursionDepth(std::wstring_view elementMapperString)
       {
         unsigned int recursionDepth = 0;
@@ -1024,6 +1158,81 @@ namespace Xidi
             maybeAxisMapperParams.Value().axis, maybeAxisMapperParams.Value().direction);
       }
 
+      ElementMapperOrError MakeFilterMapper(std::wstring_view params)
+      {
+        // Map of strings representing filter types to filter type enumerators.
+        static constexpr auto kFilterTypeStrings =
+            MakeStringLookupTable<FilterMapper::EFilterType>({
+                {L"hysteresis", FilterMapper::EFilterType::Hysteresis},
+                {L"Hysteresis", FilterMapper::EFilterType::Hysteresis},
+
+                {L"ema", FilterMapper::EFilterType::ExponentialMovingAverage},
+                {L"Ema", FilterMapper::EFilterType::ExponentialMovingAverage},
+                {L"EMA", FilterMapper::EFilterType::ExponentialMovingAverage},
+
+                {L"oneeuro", FilterMapper::EFilterType::OneEuro},
+                {L"oneEuro", FilterMapper::EFilterType::OneEuro},
+                {L"Oneeuro", FilterMapper::EFilterType::OneEuro},
+                {L"OneEuro", FilterMapper::EFilterType::OneEuro},
+
+                {L"pressrelease", FilterMapper::EFilterType::PressRelease},
+                {L"pressRelease", FilterMapper::EFilterType::PressRelease},
+                {L"Pressrelease", FilterMapper::EFilterType::PressRelease},
+                {L"PressRelease", FilterMapper::EFilterType::PressRelease},
+            });
+
+        // First parameter is required. It is a string that specifies the filter type.
+        SParamStringParts paramParts =
+            ExtractParameterListStringParts(params).value_or(SParamStringParts());
+        if (true == paramParts.first.empty()) return L"Filter: Missing or unparseable filter type";
+
+        const std::optional<FilterMapper::EFilterType> maybeFilterType =
+            kFilterTypeStrings.Find(paramParts.first);
+        if (false == maybeFilterType.has_value())
+          return Infra::Strings::Format(
+                     L"Filter: %s: Unrecognized filter type",
+                     std::wstring(paramParts.first).c_str())
+              .Data();
+
+        const FilterMapper::EFilterType filterType = maybeFilterType.value();
+        const unsigned int kMaxStrength = FilterMapper::MaxStrength(filterType);
+
+        // Second parameter is required. It is a number that specifies the filter strength.
+        paramParts =
+            ExtractParameterListStringParts(paramParts.remaining).value_or(SParamStringParts());
+        if (true == paramParts.first.empty()) return L"Filter: Missing or unparseable strength";
+
+        const std::optional<unsigned int> maybeStrength =
+            ParseUnsignedInteger(paramParts.first, 10);
+        if ((false == maybeStrength.has_value()) || (0 == maybeStrength.value()) ||
+            (maybeStrength.value() > kMaxStrength))
+          return Infra::Strings::Format(
+                     L"Filter: Strength \"%s\" must be a number between 1 and %u",
+                     std::wstring(paramParts.first).c_str(),
+                     kMaxStrength)
+              .Data();
+
+        // Third parameter is required. It is a string that specifies the element mapper whose
+        // input is filtered.
+        SElementMapperParseResult elementMapperResult =
+            ParseSingleElementMapper(paramParts.remaining);
+        if (false == elementMapperResult.maybeElementMapper.HasValue())
+          return Infra::Strings::Format(
+                     L"Filter: Parameter 3: %s",
+                     elementMapperResult.maybeElementMapper.Error().c_str())
+              .Data();
+        else if (false == elementMapperResult.remainingString.empty())
+          return Infra::Strings::Format(
+                     L"Filter: \"%s\" is extraneous",
+                     std::wstring(elementMapperResult.remainingString).c_str())
+              .Data();
+
+        return std::make_unique<FilterMapper>(
+            filterType,
+            maybeStrength.value(),
+            std::move(elementMapperResult.maybeElementMapper.Value()));
+      }
+
       ElementMapperOrError MakeInvertMapper(std::wstring_view params)
       {
         SElementMapperParseResult elementMapperResult = ParseSingleElementMapper(params);
@@ -1108,7 +1317,7 @@ namespace Xidi
       ElementMapperOrError MakePovMapper(std::wstring_view params)
       {
         // Map of strings representing axes to POV direction.
-        static const std::map<std::wstring_view, EPovDirection> kPovDirectionStrings = {
+        static constexpr auto kPovDirectionStrings = MakeStringLookupTable<EPovDirection>({
             {L"u", EPovDirection::Up},        {L"U", EPovDirection::Up},
             {L"up", EPovDirection::Up},       {L"Up", EPovDirection::Up},
             {L"UP", EPovDirection::Up},
@@ -1127,15 +1336,15 @@ namespace Xidi
             {L"rt", EPovDirection::Right},    {L"Rt", EPovDirection::Right},
             {L"RT", EPovDirection::Right},    {L"right", EPovDirection::Right},
             {L"Right", EPovDirection::Right}, {L"RIGHT", EPovDirection::Right},
-        };
+        });
 
-        const auto povDirectionIter = kPovDirectionStrings.find(params);
-        if (kPovDirectionStrings.cend() == povDirectionIter)
+        const std::optional<EPovDirection> maybePovDirection = kPovDirectionStrings.Find(params);
+        if (false == maybePovDirection.has_value())
           return Infra::Strings::Format(
                      L"Pov: %s: Unrecognized POV direction", std::wstring(params).c_str())
               .Data();
 
-        return std::make_unique<PovMapper>(povDirectionIter->second);
+        return std::make_unique<PovMapper>(maybePovDirection.value());
       }
 
       ElementMapperOrError MakeSplitMapper(std::wstring_view params)
@@ -1169,6 +1378,43 @@ namespace Xidi
             std::move(negativeElementMapperResult.maybeElementMapper.Value()));
       }
 
+      ElementMapperOrError MakeTurboMapper(std::wstring_view params)
+      {
+        // First parameter is required. It is a number that specifies the rate in presses per
+        // second.
+        SParamStringParts paramParts =
+            ExtractParameterListStringParts(params).value_or(SParamStringParts());
+        if (true == paramParts.first.empty()) return L"Turbo: Missing or unparseable rate";
+
+        const std::optional<unsigned int> maybeRate = ParseUnsignedInteger(paramParts.first, 10);
+        if ((false == maybeRate.has_value()) || (maybeRate.value() < TurboMapper::kMinRate) ||
+            (maybeRate.value() > TurboMapper::kMaxRate))
+          return Infra::Strings::Format(
+                     L"Turbo: Rate \"%s\" must be a number between %u and %u",
+                     std::wstring(paramParts.first).c_str(),
+                     TurboMapper::kMinRate,
+                     TurboMapper::kMaxRate)
+              .Data();
+
+        // Second parameter is required. It is a string that specifies the element mapper whose
+        // target is repeatedly pressed.
+        SElementMapperParseResult elementMapperResult =
+            ParseSingleElementMapper(paramParts.remaining);
+        if (false == elementMapperResult.maybeElementMapper.HasValue())
+          return Infra::Strings::Format(
+                     L"Turbo: Parameter 2: %s",
+                     elementMapperResult.maybeElementMapper.Error().c_str())
+              .Data();
+        else if (false == elementMapperResult.remainingString.empty())
+          return Infra::Strings::Format(
+                     L"Turbo: \"%s\" is extraneous",
+                     std::wstring(elementMapperResult.remainingString).c_str())
+              .Data();
+
+        return std::make_unique<TurboMapper>(
+            maybeRate.value(), std::move(elementMapperResult.maybeElementMapper.Value()));
+      }
+
       ForceFeedbackActuatorOrError MakeForceFeedbackActuatorDefault(std::wstring_view params)
       {
         if (false == params.empty())
@@ -1264,8 +1510,8 @@ namespace Xidi
 
       SElementMapperParseResult ParseSingleElementMapper(std::wstring_view elementMapperString)
       {
-        static const std::map<std::wstring_view, TMakeElementMapperFunc>
-            kMakeElementMapperFunctions = {
+        static constexpr auto kMakeElementMapperFunctions =
+            MakeStringLookupTable<TMakeElementMapperFunc>({
                 {L"axis", &MakeAxisMapper},
                 {L"Axis", &MakeAxisMapper},
 
@@ -1280,6 +1526,9 @@ namespace Xidi
                 {L"Digitalaxis", &MakeDigitalAxisMapper},
                 {L"DigitalAxis", &MakeDigitalAxisMapper},
 
+                {L"filter", &MakeFilterMapper},
+                {L"Filter", &MakeFilterMapper},
+
                 {L"invert", &MakeInvertMapper},
                 {L"Invert", &MakeInvertMapper},
 
@@ -1315,7 +1564,10 @@ namespace Xidi
                 {L"Nil", &MakeNullMapper},
 
                 {L"split", &MakeSplitMapper},
-                {L"Split", &MakeSplitMapper}};
+                {L"Split", &MakeSplitMapper},
+
+                {L"turbo", &MakeTurboMapper},
+                {L"Turbo", &MakeTurboMapper}});
 
         const std::optional<SStringParts> maybeElementMapperStringParts =
             ExtractElementMapperStringParts(elementMapperString);
@@ -1330,9 +1582,9 @@ namespace Xidi
         if (true == elementMapperStringParts.type.empty())
           return {.maybeElementMapper = L"Missing or unparseable element mapper type."};
 
-        const auto makeElementMapperIter =
-            kMakeElementMapperFunctions.find(elementMapperStringParts.type);
-        if (kMakeElementMapperFunctions.cend() == makeElementMapperIter)
+        const std::optional<TMakeElementMapperFunc> maybeMakeElementMapperFunc =
+            kMakeElementMapperFunctions.Find(elementMapperStringParts.type);
+        if (false == maybeMakeElementMapperFunc.has_value())
           return {
               .maybeElementMapper = Infra::Strings::Format(
                                         L"%s: Unrecognized element mapper type",
@@ -1340,14 +1592,15 @@ namespace Xidi
                                         .Data()};
 
         return {
-            .maybeElementMapper = makeElementMapperIter->second(elementMapperStringParts.params),
+            .maybeElementMapper =
+                maybeMakeElementMapperFunc.value()(elementMapperStringParts.params),
             .remainingString = elementMapperStringParts.remaining};
       }
 
       ForceFeedbackActuatorOrError ParseForceFeedbackActuator(std::wstring_view ffActuatorString)
       {
-        static const std::map<std::wstring_view, TMakeForceFeedbackActuatorFunc>
-            kMakeForceFeedbackActuatorFunctions = {
+        static constexpr auto kMakeForceFeedbackActuatorFunctions =
+            MakeStringLookupTable<TMakeForceFeedbackActuatorFunc>({
                 {L"disable", &MakeForceFeedbackActuatorDisabled},
                 {L"Disable", &MakeForceFeedbackActuatorDisabled},
                 {L"disabled", &MakeForceFeedbackActuatorDisabled},
@@ -1372,7 +1625,7 @@ namespace Xidi
                 {L"SingleAxis", &MakeForceFeedbackActuatorSingleAxis},
 
                 {L"magnitudeprojection", &MakeForceFeedbackActuatorMagnitudeProjection},
-                {L"MagnitudeProjection", &MakeForceFeedbackActuatorMagnitudeProjection}};
+                {L"MagnitudeProjection", &MakeForceFeedbackActuatorMagnitudeProjection}});
 
         const std::optional<SStringParts> maybeForceFeedbackActuatorStringParts =
             ExtractForceFeedbackActuatorStringParts(ffActuatorString);
@@ -1386,15 +1639,16 @@ namespace Xidi
         if (true == kForceFeedbackActuatorStringParts.type.empty())
           return L"Missing or unparseable element mapper type.";
 
-        const auto makeForceFeedbackActuatorIter =
-            kMakeForceFeedbackActuatorFunctions.find(kForceFeedbackActuatorStringParts.type);
-        if (kMakeForceFeedbackActuatorFunctions.cend() == makeForceFeedbackActuatorIter)
+        const std::optional<TMakeForceFeedbackActuatorFunc> maybeMakeForceFeedbackActuatorFunc =
+            kMakeForceFeedbackActuatorFunctions.Find(kForceFeedbackActuatorStringParts.type);
+        if (false == maybeMakeForceFeedbackActuatorFunc.has_value())
           return Infra::Strings::Format(
                      L"%s: Unrecognized force feedback actuator mode",
                      std::wstring(kForceFeedbackActuatorStringParts.type).c_str())
               .Data();
 
-        return makeForceFeedbackActuatorIter->second(kForceFeedbackActuatorStringParts.params);
+        return maybeMakeForceFeedbackActuatorFunc.value()(
+            kForceFeedbackActuatorStringParts.params);
       }
     } // namespace MapperParser
   }   // namespace Controller
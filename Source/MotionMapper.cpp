@@ -0,0 +1,107 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MotionMapper.cpp
+ *   Implementation of functionality for mapping physical controller motion to virtual controller
+ *   elements and to the virtual mouse.
+ **************************************************************************************************/
+
+#include "MotionMapper.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    MotionMapper::MotionMapper(TAxisMappers&& axisMappers, unsigned int fullScaleDegreesPerSecond)
+        : axisMappers(std::move(axisMappers)),
+          fullScaleMotionUnits(
+              std::max(1, (int32_t)fullScaleDegreesPerSecond) *
+              kPhysicalMotionUnitsPerDegreePerSecond)
+    {}
+
+    SPhysicalMotion MotionMapper::IntegrateSamples(
+        std::span<const SPhysicalMotionSample> samples, int64_t& previousTimestamp)
+    {
+      std::array<int64_t, static_cast<int>(EPhysicalMotionAxis::Count)> weightedSum = {};
+      int64_t totalWeight = 0;
+
+      for (const auto& sample : samples)
+      {
+        // A reading whose predecessor is unknown, or whose timestamp does not advance, is given
+        // the smallest possible weight rather than being dropped, so that a batch made up entirely
+        // of such readings still averages them.
+        const int64_t weight = (((0 != previousTimestamp) && (sample.timestamp > previousTimestamp))
+                                    ? (sample.timestamp - previousTimestamp)
+                                    : 1);
+
+        for (size_t i = 0; i < weightedSum.size(); ++i)
+          weightedSum[i] += (int64_t)sample.angularVelocity[i] * weight;
+
+        totalWeight += weight;
+        previousTimestamp = sample.timestamp;
+      }
+
+      SPhysicalMotion motion = {};
+      if (0 == totalWeight) return motion;
+
+      for (size_t i = 0; i < weightedSum.size(); ++i)
+        motion.angularVelocity[i] = (int16_t)(weightedSum[i] / totalWeight);
+
+      return motion;
+    }
+
+    uint32_t MotionMapper::SourceIdentifierForAxis(
+        uint32_t sourceControllerIdentifier, EPhysicalMotionAxis axis)
+    {
+      return Mapper::SourceIdentifierForElementMapper(
+          sourceControllerIdentifier, Mapper::kElementCount + static_cast<uint32_t>(axis));
+    }
+
+    void MotionMapper::ContributeFromMotion(
+        SState& controllerState,
+        const SPhysicalMotion& motion,
+        uint32_t sourceControllerIdentifier) const
+    {
+      for (int i = 0; i < static_cast<int>(EPhysicalMotionAxis::Count); ++i)
+      {
+        if (nullptr == axisMappers[i]) continue;
+
+        const int32_t analogValue = std::clamp(
+            ((int32_t)motion.angularVelocity[i] * kAnalogValueMax) / fullScaleMotionUnits,
+            kAnalogValueMin,
+            kAnalogValueMax);
+        axisMappers[i]->ContributeFromAnalogValue(
+            controllerState,
+            (int16_t)analogValue,
+            SourceIdentifierForAxis(sourceControllerIdentifier, (EPhysicalMotionAxis)i));
+      }
+    }
+
+    void MotionMapper::ContributeNeutral(
+        SState& controllerState, uint32_t sourceControllerIdentifier) const
+    {
+      for (int i = 0; i < static_cast<int>(EPhysicalMotionAxis::Count); ++i)
+      {
+        if (nullptr == axisMappers[i]) continue;
+
+        axisMappers[i]->ContributeNeutral(
+            controllerState,
+            SourceIdentifierForAxis(sourceControllerIdentifier, (EPhysicalMotionAxis)i));
+      }
+    }
+  } // namespace Controller
+} // namespace Xidi
@@ -12,10 +12,11 @@
 
 #include "Mouse.h"
 
-#include <concurrent_unordered_map.h>
-
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <bitset>
+#include <condition_variable>
 #include <cstdint>
 #include <mutex>
 #include <stop_token>
@@ -28,18 +29,140 @@
 #include "ApiWindows.h"
 #include "ControllerTypes.h"
 #include "Globals.h"
+#include "InputEmissionStatistics.h"
+#include "ProfiledMutex.h"
+#include "Settings.h"
 #include "Strings.h"
+#include "WorkerThread.h"
 
 namespace Xidi
 {
   namespace Mouse
   {
+#ifndef XIDI_SKIP_INPUT_EMISSION
     /// Type used to represent the state of a virtual mouse's buttons.
     using TButtonState = BitSetEnum<EMouseButton>;
 
-    /// Type used to represent the individually-sourced mouse movement contributions.
-    /// Operations allowed are read, append, and update.
-    using TMouseMovementContributions = concurrency::concurrent_unordered_map<uint32_t, int>;
+    /// Maximum number of distinct sources that can contribute mouse movement along a single mouse
+    /// axis. Each physical controller element is a separate source, so this leaves ample room for
+    /// every element of every physical controller.
+    static constexpr unsigned int kMaxMouseMovementSources =
+        32 * (unsigned int)Controller::kMaxPhysicalControllerCount;
+
+    /// Holds the individually-sourced mouse movement contributions along a single mouse axis.
+    /// Each source is assigned a dense slot the first time it contributes, after which updates are
+    /// simple stores into that slot. Slots are never released, so readers can iterate over all
+    /// assigned slots without locking. Operations allowed are read, append, and update.
+    class MouseMovementContributions
+    {
+    public:
+
+      inline MouseMovementContributions(void)
+          : sources(), numSources(0), sourceAssignmentGuard(L"Mouse::sourceAssignmentGuard")
+      {}
+
+      /// Resets all contributions back to motionless without releasing any slots.
+      inline void Reset(void)
+      {
+        const unsigned int kNumSources = numSources.load(std::memory_order_acquire);
+        for (unsigned int i = 0; i < kNumSources; ++i)
+          sources[i].mouseMovementUnits.store(0, std::memory_order_relaxed);
+      }
+
+      /// Computes the sum of all the contributions from all sources.
+      /// @return Sum of all mouse movement contributions, in internal mouse movement units.
+      inline int Sum(void) const
+      {
+        int sum = 0;
+
+        const unsigned int kNumSources = numSources.load(std::memory_order_acquire);
+        for (unsigned int i = 0; i < kNumSources; ++i)
+          sum += sources[i].mouseMovementUnits.load(std::memory_order_relaxed);
+
+        return sum;
+      }
+
+      /// Either inserts a contribution from a new source or updates the contribution from an
+      /// existing source.
+      /// @param [in] mouseMovementUnits Number of internal mouse movement units contributed.
+      /// @param [in] sourceIdentifier Opaque identifier for the source of the contribution.
+      void Submit(int mouseMovementUnits, uint32_t sourceIdentifier)
+      {
+        if (true == TryUpdateExisting(mouseMovementUnits, sourceIdentifier)) return;
+
+        std::scoped_lock lock(sourceAssignmentGuard);
+
+        // Another thread might have assigned a slot to the same source while this thread was
+        // waiting for the lock.
+        if (true == TryUpdateExisting(mouseMovementUnits, sourceIdentifier)) return;
+
+        const unsigned int kNewSourceIndex = numSources.load(std::memory_order_relaxed);
+        if (kNewSourceIndex >= sources.size())
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Dropping mouse movement from source 0x%08x because too many sources are contributing along the same mouse axis.",
+              (unsigned int)sourceIdentifier);
+          return;
+        }
+
+        sources[kNewSourceIndex].sourceIdentifier = sourceIdentifier;
+        sources[kNewSourceIndex].mouseMovementUnits.store(
+            mouseMovementUnits, std::memory_order_relaxed);
+        numSources.store(kNewSourceIndex + 1, std::memory_order_release);
+      }
+
+    private:
+
+      /// Updates the contribution from a source if that source already has a slot assigned.
+      /// @param [in] mouseMovementUnits Number of internal mouse movement units contributed.
+      /// @param [in] sourceIdentifier Opaque identifier for the source of the contribution.
+      /// @return `true` if the source has a slot and the contribution was updated, `false` if not.
+      inline bool TryUpdateExisting(int mouseMovementUnits, uint32_t sourceIdentifier)
+      {
+        const unsigned int kNumSources = numSources.load(std::memory_order_acquire);
+        for (unsigned int i = 0; i < kNumSources; ++i)
+        {
+          if (sourceIdentifier == sources[i].sourceIdentifier)
+          {
+            sources[i].mouseMovementUnits.store(mouseMovementUnits, std::memory_order_relaxed);
+            return true;
+          }
+        }
+
+        return false;
+      }
+
+      /// Contribution from a single source.
+      struct SSource
+      {
+        /// Opaque identifier of the source. Written once, before the slot is published.
+        uint32_t sourceIdentifier;
+
+        /// Most recent contribution from the source, in internal mouse movement units.
+        std::atomic<int> mouseMovementUnits;
+      };
+
+      /// Slots that can be assigned to sources.
+      std::array<SSource, kMaxMouseMovementSources> sources;
+
+      /// Number of slots, starting from the beginning, that are assigned to sources.
+      std::atomic<unsigned int> numSources;
+
+      /// Serializes assignment of new slots to sources.
+      ProfiledMutex<std::mutex> sourceAssignmentGuard;
+    };
+
+    /// Number of fixed-point sub-pixels that make up one whole pixel of mouse movement.
+    static constexpr int64_t kMouseSubPixelsPerPixel = 1 << 16;
+
+    /// Maximum number of mouse update periods' worth of elapsed time that is converted to mouse
+    /// movement in a single update.
+    static constexpr int64_t kMaxElapsedUpdatePeriods = 4;
+
+    /// Amount of time without any mouse activity, while no mouse buttons are pressed, after which
+    /// the mouse update thread stops polling and waits for new contributions.
+    static constexpr unsigned int kMouseIdleMillisecondsBeforeWaiting = 1000;
 
     /// Tracks mouse state contributions and generates mouse state snapshots.
     class StateContributionTracker
@@ -47,10 +170,31 @@ namespace Xidi
     public:
 
       inline StateContributionTracker(void)
+          : earliestButtonContributionTicks(0), waitingForActivity(false)
       {
         ResetButtons();
       }
 
+      /// Determines if any mouse button press or release contributions have been registered since
+      /// the last snapshot.
+      /// @return `true` if contributions have been registered, `false` if not.
+      inline bool HasButtonContributions(void) const
+      {
+        return hasButtonContributions;
+      }
+
+      /// Determines if the mouse movement contributions on any axis currently amount to movement.
+      /// @return `true` if the mouse is moving along at least one axis, `false` if not.
+      inline bool HasMovement(void) const
+      {
+        for (const auto& axisMovementContributions : mouseMovementContributions)
+        {
+          if (kMouseMovementUnitsNeutral != axisMovementContributions.Sum()) return true;
+        }
+
+        return false;
+      }
+
       /// Determines if the specified mouse button is marked as having been pressed since the last
       /// snapshot. A mouse button marked pressed can also be marked released. The two are not
       /// mutually exclusive.
@@ -75,7 +219,7 @@ namespace Xidi
       /// The returned lock object is scoped and, as a result, will automatically unlock upon its
       /// destruction.
       /// @return Scoped lock object that has acquired this object's concurrency control mutex.
-      inline std::unique_lock<std::mutex> LockButtonState(void)
+      inline std::unique_lock<ProfiledMutex<std::mutex>> LockButtonState(void)
       {
         return std::unique_lock(mouseButtonStateGuard);
       }
@@ -87,6 +231,8 @@ namespace Xidi
       inline void MarkPressed(EMouseButton button)
       {
         pressedButtons.insert((unsigned int)button);
+        hasButtonContributions = true;
+        RecordButtonContributionTime();
       }
 
       /// Registers a mouse button release contribution.
@@ -96,16 +242,55 @@ namespace Xidi
       inline void MarkRelease(EMouseButton button)
       {
         notReleasedButtons.erase((unsigned int)button);
+        hasButtonContributions = true;
+        RecordButtonContributionTime();
+      }
+
+      /// Registers all of the mouse button press and mouse button release contributions collected
+      /// by a submission batch.
+      /// @param [in] batchPressedButtons Mouse buttons submitted as pressed while the batch was
+      /// open.
+      /// @param [in] batchReleasedButtons Mouse buttons submitted as released while the batch was
+      /// open.
+      inline void MarkBatch(
+          const TButtonState& batchPressedButtons, const TButtonState& batchReleasedButtons)
+      {
+        for (auto button : batchPressedButtons)
+          MarkPressed((EMouseButton)button);
+
+        for (auto button : batchReleasedButtons)
+          MarkRelease((EMouseButton)button);
+      }
+
+      /// Wakes up the mouse update thread if it is waiting for activity. The caller must hold this
+      /// object's mouse button lock and should invoke this method after registering mouse button
+      /// contributions.
+      inline void NotifyButtonContributions(void)
+      {
+        if (true == waitingForActivity.load(std::memory_order_relaxed))
+          activityAvailable.notify_one();
       }
 
       /// Retrieves a read-only reference to all mouse movement contributions on all axes.
       /// @return Read-only reference to the mouse movement contribution tracking data structure.
-      inline const std::array<TMouseMovementContributions, (unsigned int)EMouseAxis::Count>&
+      inline const std::array<MouseMovementContributions, (unsigned int)EMouseAxis::Count>&
           MovementContributions(void)
       {
         return mouseMovementContributions;
       }
 
+      /// Retrieves the time of the earliest mouse button contribution registered since the last
+      /// time this method was invoked, and resets it so that the next contribution is recorded.
+      /// The caller must hold this object's mouse button lock.
+      /// @return Performance counter value at the time of the earliest contribution, or 0 if there
+      /// have been no contributions.
+      inline int64_t TakeEarliestButtonContributionTicks(void)
+      {
+        const int64_t contributionTicks = earliestButtonContributionTicks;
+        earliestButtonContributionTicks = 0;
+        return contributionTicks;
+      }
+
       /// Computes the next mouse button snapshot by applying the marked changes to the specified
       /// previous snapshot. Afterwards, resets internal state so no mouse buttons are marked as
       /// pressed or released.
@@ -133,16 +318,14 @@ namespace Xidi
       {
         pressedButtons.clear();
         notReleasedButtons.fill();
+        hasButtonContributions = false;
       }
 
       /// Resets all movement contributions back to motionless.
       inline void ResetMovementContributions(void)
       {
         for (auto& axisMovementContributions : mouseMovementContributions)
-        {
-          for (auto& contribution : axisMovementContributions)
-            contribution.second = 0;
-        }
+          axisMovementContributions.Reset();
       }
 
       /// Submits a mouse movement.
@@ -155,11 +338,52 @@ namespace Xidi
       inline void SubmitMouseMovement(
           EMouseAxis axis, int mouseMovementUnits, uint32_t sourceIdentifier)
       {
-        mouseMovementContributions[(unsigned int)axis][sourceIdentifier] = mouseMovementUnits;
+        mouseMovementContributions[(unsigned int)axis].Submit(mouseMovementUnits, sourceIdentifier);
+
+        if (kMouseMovementUnitsNeutral == mouseMovementUnits) return;
+
+        // Pairs with the fence in the waiting thread. Either this thread sees that the mouse
+        // update thread is waiting, or the mouse update thread sees this movement before waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (true == waitingForActivity.load(std::memory_order_relaxed))
+        {
+          auto lock = LockButtonState();
+          activityAvailable.notify_one();
+        }
+      }
+
+      /// Blocks until mouse button contributions are registered, the mouse starts moving, or a
+      /// stop is requested.
+      /// @param [in] lock Scoped lock object that has acquired this object's mouse button lock.
+      /// @param [in] stopToken Stop token used to indicate that waiting should end early.
+      inline void WaitForActivity(
+          std::unique_lock<ProfiledMutex<std::mutex>>& lock, std::stop_token stopToken)
+      {
+        waitingForActivity.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        activityAvailable.wait(
+            lock,
+            stopToken,
+            [this]() -> bool
+            {
+              return ((true == hasButtonContributions) || (true == HasMovement()));
+            });
+
+        waitingForActivity.store(false, std::memory_order_relaxed);
       }
 
     private:
 
+      /// Records the time of a mouse button contribution if it is the earliest one since the last
+      /// time the earliest contribution time was taken. The caller must hold this object's mouse
+      /// button lock.
+      inline void RecordButtonContributionTime(void)
+      {
+        if (0 == earliestButtonContributionTicks)
+          earliestButtonContributionTicks = InputEmissionStatistics::Now();
+      }
+
       /// Set of buttons marked "pressed" since the last snapshot.
       TButtonState pressedButtons;
 
@@ -167,17 +391,69 @@ namespace Xidi
       /// Buttons present in this set have not been marked released since the last snapshot.
       TButtonState notReleasedButtons;
 
+      /// Whether or not any mouse button contributions have been registered since the last
+      /// snapshot.
+      bool hasButtonContributions;
+
+      /// Performance counter value at the time of the earliest mouse button contribution
+      /// registered since it was last taken, or 0 if there have been none.
+      int64_t earliestButtonContributionTicks;
+
       /// For ensuring proper concurrency control of accesses to the virtual mouse button state
       /// represented by this object.
-      std::mutex mouseButtonStateGuard;
+      ProfiledMutex<std::mutex> mouseButtonStateGuard{L"Mouse::mouseButtonStateGuard"};
+
+      /// Signalled when activity occurs while the mouse update thread is waiting for it.
+      std::condition_variable_any activityAvailable;
+
+      /// Whether or not the mouse update thread is waiting for activity. Read without holding the
+      /// mouse button lock by threads that submit mouse movements.
+      std::atomic<bool> waitingForActivity;
 
       /// Individually-sourced mouse movement contributions.
       /// Since mouse movements are always relative, only one state data structure is needed, one
       /// per mouse axis.
-      std::array<TMouseMovementContributions, (unsigned int)EMouseAxis::Count>
+      std::array<MouseMovementContributions, (unsigned int)EMouseAxis::Count>
           mouseMovementContributions;
     };
 
+    /// Retrieves the desired physical mouse update period, which can be customized in the
+    /// configuration file.
+    /// @return Mouse update period in milliseconds.
+    static unsigned int GetMouseUpdatePeriodMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.mousePeriodMilliseconds;
+    }
+
+    /// Determines if virtual mouse wheel movement should be submitted in fractions of a wheel
+    /// detent, which can be enabled in the configuration file.
+    /// @return `true` if high-resolution wheel movement is enabled, `false` otherwise.
+    static bool IsWheelHighResolutionEnabled(void)
+    {
+      return Globals::GetSettings().properties.mouseWheelHighResolution;
+    }
+
+    /// Determines the granularity with which movement along the specified mouse axis is submitted
+    /// to the system. Movement finer than this is accumulated until it adds up to a whole unit.
+    /// @param [in] axis Identifier of the target mouse axis.
+    /// @return Granularity of submitted movement, in pixels for pointer axes or in wheel units for
+    /// wheel axes.
+    static int MouseMovementGranularity(EMouseAxis axis)
+    {
+      switch (axis)
+      {
+        case EMouseAxis::WheelHorizontal:
+        case EMouseAxis::WheelVertical:
+          return ((true == IsWheelHighResolutionEnabled()) ? 1 : WHEEL_DELTA);
+
+        default:
+          return 1;
+      }
+    }
+
+    /// Statistics about mouse input submitted to the system.
+    static InputEmissionStatistics mouseEmissionStatistics(L"Mouse");
+
     /// Manages a thread that continuously runs and updates the physical mouse state from virtual
     /// mouse state. Wraps the thread handle to ensure safe termination and clean-up.
     class MouseUpdateThread
@@ -209,8 +485,12 @@ namespace Xidi
       {
         if ((false == mouseUpdateThread.joinable()) && (false == mouseUpdateStop.stop_requested()))
         {
-          mouseUpdateThread =
-              std::thread(UpdatePhysicalMouseState, &mouseTracker, mouseUpdateStop.get_token());
+          mouseUpdateThread = WorkerThread::Create(
+              L"Xidi Mouse Emitter",
+              WorkerThread::EPriority::LatencyCritical,
+              UpdatePhysicalMouseState,
+              &mouseTracker,
+              mouseUpdateStop.get_token());
         }
       }
 
@@ -292,10 +572,36 @@ namespace Xidi
         }
       }
 
-      /// Converts internal mouse movement units to pixels.
+      /// Retrieves and returns the frequency of the performance counter.
+      /// @return Number of performance counter ticks per second.
+      static int64_t PerformanceCounterFrequency(void)
+      {
+        static const int64_t kFrequency = []() -> int64_t
+        {
+          LARGE_INTEGER frequency;
+          QueryPerformanceFrequency(&frequency);
+          return frequency.QuadPart;
+        }();
+
+        return kFrequency;
+      }
+
+      /// Retrieves and returns the current value of the performance counter.
+      /// @return Current performance counter value.
+      static inline int64_t PerformanceCounterNow(void)
+      {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+      }
+
+      /// Converts internal mouse movement units, applied over the specified amount of time, to
+      /// fixed-point sub-pixels. Because the conversion is normalized to elapsed time, the
+      /// resulting speed does not depend on how regularly the mouse update thread wakes up.
       /// @param [in] mouseMovementUnits Number of internal mouse movement units to be converted.
-      /// @return Appropriate number of pixels represented by the mouse movement units.
-      static int MouseMovementUnitsToPixels(int mouseMovementUnits)
+      /// @param [in] elapsedTicks Performance counter ticks over which the movement was applied.
+      /// @return Appropriate number of sub-pixels represented by the mouse movement units.
+      static int64_t MouseMovementUnitsToSubPixels(int mouseMovementUnits, int64_t elapsedTicks)
       {
         static const double kSpeedScalingFactor =
             static_cast<double>(
@@ -305,23 +611,21 @@ namespace Xidi
                         .ValueOr(100)) /
             100.0;
 
-        constexpr double kMillisecondsPerSecond = 1000.0;
-        constexpr double kPollingPeriodsPerSecond =
-            (kMillisecondsPerSecond / (double)kMouseUpdatePeriodMilliseconds);
-        const double fastestPixelsPerSecond = 2000.0 * kSpeedScalingFactor;
-        const double fastestPixelsPerPollingPeriod =
-            fastestPixelsPerSecond / kPollingPeriodsPerSecond;
-        const double conversionScalingFactor = fastestPixelsPerPollingPeriod /
+        const double fastestSubPixelsPerSecond =
+            2000.0 * kSpeedScalingFactor * (double)kMouseSubPixelsPerPixel;
+        const double elapsedSeconds = (double)elapsedTicks / (double)PerformanceCounterFrequency();
+        const double conversionScalingFactor = (fastestSubPixelsPerSecond * elapsedSeconds) /
             ((kMouseMovementUnitsMax - kMouseMovementUnitsMin) / 2.0);
 
-        return static_cast<int>(
+        return static_cast<int64_t>(
             static_cast<double>(mouseMovementUnits - kMouseMovementUnitsNeutral) *
             conversionScalingFactor);
       }
 
       /// Periodically checks for changes between the previous and next views of the virtual mouse
       /// button states. On detected state change, generates and submits a mouse input event to the
-      /// system.
+      /// system. Stops polling while the virtual mouse is idle and resumes as soon as new
+      /// contributions are registered.
       /// @param [in] mouseTracker Pointer to the mouse state contribution tracker object to use for
       /// updates.
       /// @param [in] mouseUpdateStopToken Stop token used to indicate that this method should
@@ -334,18 +638,57 @@ namespace Xidi
             static_cast<size_t>(EMouseAxis::Count) + static_cast<size_t>(EMouseButton::Count));
 
         TButtonState previousMouseButtonState;
+        const unsigned int kUpdatePeriodMilliseconds = GetMouseUpdatePeriodMilliseconds();
+
+        // Movement that is too small to be submitted as a whole pixel is carried over, per axis,
+        // to subsequent iterations. Elapsed time is capped so that a long stall, for example while
+        // the process is suspended, does not produce one large jump.
+        std::array<int64_t, (unsigned int)EMouseAxis::Count> subPixelAccumulators = {};
+        const int64_t kUpdatePeriodTicks =
+            ((int64_t)kUpdatePeriodMilliseconds * PerformanceCounterFrequency()) / 1000;
+        const int64_t kMaxElapsedTicks = kMaxElapsedUpdatePeriods * kUpdatePeriodTicks;
+        int64_t previousUpdateTicks = PerformanceCounterNow() - kUpdatePeriodTicks;
+
+        const unsigned int kIdleUpdatePeriodsBeforeWaiting = std::max(
+            1u, kMouseIdleMillisecondsBeforeWaiting / std::max(1u, kUpdatePeriodMilliseconds));
+        unsigned int numIdleUpdatePeriods = 0;
 
         while (true)
         {
-          Sleep(kMouseUpdatePeriodMilliseconds);
+          if (numIdleUpdatePeriods >= kIdleUpdatePeriodsBeforeWaiting)
+          {
+            {
+              auto lock = mouseTracker->LockButtonState();
+              mouseTracker->WaitForActivity(lock, mouseUpdateStopToken);
+            }
+
+            // Time spent waiting does not count as elapsed time for the purpose of mouse movement.
+            numIdleUpdatePeriods = 0;
+            previousUpdateTicks = PerformanceCounterNow() - kUpdatePeriodTicks;
+          }
+
+          Sleep(kUpdatePeriodMilliseconds);
 
           const bool haveInputFocus = Globals::DoesCurrentProcessHaveInputFocus();
           const bool terminationRequested = mouseUpdateStopToken.stop_requested();
 
+          const int64_t currentUpdateTicks = PerformanceCounterNow();
+          const int64_t elapsedTicks =
+              std::min(currentUpdateTicks - previousUpdateTicks, kMaxElapsedTicks);
+          previousUpdateTicks = currentUpdateTicks;
+
+          mouseEmissionStatistics.RecordTick();
+
+          bool isIdle = false;
+          size_t numTransitions = 0;
+          int64_t contributionTicks = 0;
+
           // Mouse buttons
           {
             auto lock = mouseTracker->LockButtonState();
 
+            const bool hadButtonContributions = mouseTracker->HasButtonContributions();
+            contributionTicks = mouseTracker->TakeEarliestButtonContributionTicks();
             TButtonState nextMouseButtonState =
                 mouseTracker->ButtonSnapshotRelativeTo(previousMouseButtonState);
 
@@ -371,46 +714,80 @@ namespace Xidi
             }
 
             previousMouseButtonState = nextMouseButtonState;
+            numTransitions = mouseEvents.size();
+
+            // Mouse buttons that remain pressed still need to be released if input focus is lost,
+            // so the virtual mouse is only idle once no mouse buttons are pressed.
+            isIdle =
+                ((false == hadButtonContributions) && (true == previousMouseButtonState.empty()));
           }
 
+          if ((true == isIdle) && (false == mouseTracker->HasMovement()))
+            numIdleUpdatePeriods += 1;
+          else
+            numIdleUpdatePeriods = 0;
+
           // Mouse movement
           if ((true == haveInputFocus) && (false == terminationRequested))
           {
-            const std::array<TMouseMovementContributions, (unsigned int)EMouseAxis::Count>&
+            const std::array<MouseMovementContributions, (unsigned int)EMouseAxis::Count>&
                 mouseMovementContributions = mouseTracker->MovementContributions();
 
             for (size_t axisIndex = 0; axisIndex < mouseMovementContributions.size(); ++axisIndex)
             {
-              const TMouseMovementContributions& axisMovementContributions =
-                  mouseMovementContributions[axisIndex];
-              int axisMovementUnits = 0;
+              int axisMovementUnits = mouseMovementContributions[axisIndex].Sum();
 
-              for (const auto& contribution : axisMovementContributions)
-                axisMovementUnits += contribution.second;
-
-              if (kMouseMovementUnitsNeutral != axisMovementUnits)
+              if (kMouseMovementUnitsNeutral == axisMovementUnits)
               {
-                if (axisMovementUnits > kMouseMovementUnitsMax)
-                  axisMovementUnits = kMouseMovementUnitsMax;
-                else if (axisMovementUnits < kMouseMovementUnitsMin)
-                  axisMovementUnits = kMouseMovementUnitsMin;
-
-                const int axisMovementPixels = MouseMovementUnitsToPixels(axisMovementUnits);
-                if (0 != axisMovementPixels)
-                  mouseEvents.emplace_back(INPUT(
-                      {.type = INPUT_MOUSE,
-                       .mi =
-                           MouseInputEventForMovement((EMouseAxis)axisIndex, axisMovementPixels)}));
+                // Leftover sub-pixel movement is discarded as soon as an axis stops moving so that
+                // it cannot cause drift later on.
+                subPixelAccumulators[axisIndex] = 0;
+                continue;
               }
+
+              if (axisMovementUnits > kMouseMovementUnitsMax)
+                axisMovementUnits = kMouseMovementUnitsMax;
+              else if (axisMovementUnits < kMouseMovementUnitsMin)
+                axisMovementUnits = kMouseMovementUnitsMin;
+
+              subPixelAccumulators[axisIndex] +=
+                  MouseMovementUnitsToSubPixels(axisMovementUnits, elapsedTicks);
+
+              // Wheel axes might only be submitted as whole detents, in which case this rounds
+              // down to a multiple of a detent and leaves the remainder accumulated.
+              const int axisMovementGranularity = MouseMovementGranularity((EMouseAxis)axisIndex);
+              const int axisMovementPixels = axisMovementGranularity *
+                  (int)(subPixelAccumulators[axisIndex] /
+                        (kMouseSubPixelsPerPixel * axisMovementGranularity));
+              subPixelAccumulators[axisIndex] -=
+                  ((int64_t)axisMovementPixels * kMouseSubPixelsPerPixel);
+
+              if (0 != axisMovementPixels)
+                mouseEvents.emplace_back(INPUT(
+                    {.type = INPUT_MOUSE,
+                     .mi = MouseInputEventForMovement((EMouseAxis)axisIndex, axisMovementPixels)}));
             }
-          };
+          }
+          else
+          {
+            subPixelAccumulators.fill(0);
+          }
+
+          mouseEmissionStatistics.RecordTransitions((unsigned int)numTransitions);
 
           if (mouseEvents.size() > 0)
           {
-            SendInput((UINT)mouseEvents.size(), mouseEvents.data(), (int)sizeof(INPUT));
+            mouseEmissionStatistics.SendInput(mouseEvents);
             mouseEvents.clear();
+
+            // Mouse movement is continuous, so latency is only meaningful for mouse buttons.
+            if ((numTransitions > 0) && (0 != contributionTicks))
+              mouseEmissionStatistics.RecordLatency(
+                  contributionTicks, InputEmissionStatistics::Now());
           }
 
+          mouseEmissionStatistics.OutputSummaryIfDue(InputEmissionStatistics::Now());
+
           if (true == terminationRequested) break;
         }
       }
@@ -433,6 +810,35 @@ namespace Xidi
     /// Singleton object that wraps the mouse update thread.
     static MouseUpdateThread mouseUpdateThread(mouseTracker);
 
+    /// Single mouse movement submission collected while a submission batch is open.
+    struct SMouseMovementSubmission
+    {
+      EMouseAxis axis;
+      int mouseMovementUnits;
+      uint32_t sourceIdentifier;
+    };
+
+    /// Mouse state submissions collected on the calling thread while a submission batch is open.
+    struct SSubmissionBatch
+    {
+      /// Nesting depth of the open submission batches. Submissions are collected only while this
+      /// value is nonzero.
+      unsigned int depth;
+
+      /// Mouse buttons submitted as pressed while the batch is open.
+      TButtonState pressedButtons;
+
+      /// Mouse buttons submitted as released while the batch is open.
+      TButtonState releasedButtons;
+
+      /// Mouse movements submitted while the batch is open, in submission order.
+      std::vector<SMouseMovementSubmission> mouseMovements;
+    };
+
+    /// Per-thread submission batch, so that mapping on one thread never defers or commits mouse
+    /// state submissions made on another.
+    static thread_local SSubmissionBatch submissionBatch = {};
+
     /// Initializes internal data structures, creates internal threads, and begins periodically
     /// checking for mouse events that need to be submitted. Idempotent and concurrency-safe.
     static void InitializeAndBeginUpdating(void)
@@ -446,36 +852,119 @@ namespace Xidi
             Infra::Message::OutputFormatted(
                 Infra::Message::ESeverity::Info,
                 L"Initialized the mouse event thread. Desired update period is %u ms.",
-                kMouseUpdatePeriodMilliseconds);
+                GetMouseUpdatePeriodMilliseconds());
           });
     }
 
+    Api::IInputEmissionStatistics::SStatistics GetEmissionStatistics(void)
+    {
+      return mouseEmissionStatistics.GetStatistics();
+    }
+
+    void BeginSubmissionBatch(void)
+    {
+      submissionBatch.depth += 1;
+    }
+
+    void EndSubmissionBatch(void)
+    {
+      if (0 == submissionBatch.depth) return;
+
+      submissionBatch.depth -= 1;
+      if (0 != submissionBatch.depth) return;
+
+      const bool haveButtonSubmissions =
+          ((false == submissionBatch.pressedButtons.empty()) ||
+           (false == submissionBatch.releasedButtons.empty()));
+      const bool haveMovementSubmissions = (false == submissionBatch.mouseMovements.empty());
+      if ((false == haveButtonSubmissions) && (false == haveMovementSubmissions)) return;
+
+      InitializeAndBeginUpdating();
+
+      if (true == haveButtonSubmissions)
+      {
+        auto lock = mouseTracker.LockButtonState();
+        mouseTracker.MarkBatch(submissionBatch.pressedButtons, submissionBatch.releasedButtons);
+        mouseTracker.NotifyButtonContributions();
+      }
+
+      for (const auto& mouseMovement : submissionBatch.mouseMovements)
+        mouseTracker.SubmitMouseMovement(
+            mouseMovement.axis, mouseMovement.mouseMovementUnits, mouseMovement.sourceIdentifier);
+
+      submissionBatch.pressedButtons.clear();
+      submissionBatch.releasedButtons.clear();
+      submissionBatch.mouseMovements.clear();
+    }
+
     void SubmitMouseButtonPressedState(EMouseButton button)
     {
+      if (0 != submissionBatch.depth)
+      {
+        submissionBatch.pressedButtons.insert((unsigned int)button);
+        return;
+      }
+
       InitializeAndBeginUpdating();
 
       if (false == mouseTracker.IsMarkedPressed(button))
       {
         auto lock = mouseTracker.LockButtonState();
         mouseTracker.MarkPressed(button);
+        mouseTracker.NotifyButtonContributions();
       }
     }
 
     void SubmitMouseButtonReleasedState(EMouseButton button)
     {
+      if (0 != submissionBatch.depth)
+      {
+        submissionBatch.releasedButtons.insert((unsigned int)button);
+        return;
+      }
+
       InitializeAndBeginUpdating();
 
       if (false == mouseTracker.IsMarkedReleased(button))
       {
         auto lock = mouseTracker.LockButtonState();
         mouseTracker.MarkRelease(button);
+        mouseTracker.NotifyButtonContributions();
       }
     }
 
     void SubmitMouseMovement(EMouseAxis axis, int mouseMovementUnits, uint32_t sourceIdentifier)
     {
+      if (0 != submissionBatch.depth)
+      {
+        submissionBatch.mouseMovements.push_back(
+            {.axis = axis,
+             .mouseMovementUnits = mouseMovementUnits,
+             .sourceIdentifier = sourceIdentifier});
+        return;
+      }
+
       InitializeAndBeginUpdating();
       mouseTracker.SubmitMouseMovement(axis, mouseMovementUnits, sourceIdentifier);
     }
+#else
+    // Builds without input emission accept mouse state submissions from mappers but discard them,
+    // so there is neither a mouse event thread nor any interaction with the system.
+
+    Api::IInputEmissionStatistics::SStatistics GetEmissionStatistics(void)
+    {
+      return {};
+    }
+
+    void BeginSubmissionBatch(void) {}
+
+    void EndSubmissionBatch(void) {}
+
+    void SubmitMouseButtonPressedState(EMouseButton button) {}
+
+    void SubmitMouseButtonReleasedState(EMouseButton button) {}
+
+    void SubmitMouseMovement(EMouseAxis axis, int mouseMovementUnits, uint32_t sourceIdentifier) {}
+#endif
   } // namespace Mouse
 } // namespace Xidi
@@ -0,0 +1,158 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PeriodicTimer.cpp
+ *   Implementation of a timer for driving periodic work against fixed deadlines.
+ **************************************************************************************************/
+
+#include "PeriodicTimer.h"
+
+#include <cstdint>
+
+#include "ApiWindows.h"
+
+// Older Windows SDK versions do not define this flag, which is supported starting with Windows 10
+// version 1803. Older versions of Windows fail waitable timer creation when it is specified.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace Xidi
+{
+  /// Number of 100-nanosecond intervals in one second, which is the unit waitable timers use.
+  static constexpr int64_t kWaitableTimerUnitsPerSecond = 10000000;
+
+  /// Retrieves and returns the frequency of the performance counter.
+  /// @return Number of performance counter ticks per second.
+  static int64_t PerformanceCounterFrequency(void)
+  {
+    static const int64_t kFrequency = []() -> int64_t
+    {
+      LARGE_INTEGER frequency;
+      QueryPerformanceFrequency(&frequency);
+      return frequency.QuadPart;
+    }();
+
+    return kFrequency;
+  }
+
+  /// Retrieves and returns the current value of the performance counter.
+  /// @return Current performance counter value.
+  static inline int64_t PerformanceCounterNow(void)
+  {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+  }
+
+  /// Converts a period in milliseconds to performance counter ticks.
+  /// @param [in] periodMilliseconds Period in milliseconds.
+  /// @return Equivalent number of performance counter ticks, which is guaranteed to be positive.
+  static inline int64_t PeriodMillisecondsToTicks(unsigned int periodMilliseconds)
+  {
+    if (0 == periodMilliseconds) periodMilliseconds = 1;
+    return ((int64_t)periodMilliseconds * PerformanceCounterFrequency()) / 1000;
+  }
+
+  PeriodicTimer::PeriodicTimer(unsigned int periodMilliseconds, bool preferHighResolution)
+      : periodMilliseconds((0 == periodMilliseconds) ? 1 : periodMilliseconds),
+        periodTicks(PeriodMillisecondsToTicks(periodMilliseconds)),
+        nextDeadline(0),
+        timerHandle(NULL),
+        isHighResolution(false)
+  {
+    if (true == preferHighResolution)
+    {
+      timerHandle = CreateWaitableTimerExW(
+          nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+      isHighResolution = (NULL != timerHandle);
+    }
+
+    if (NULL == timerHandle)
+      timerHandle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+  }
+
+  PeriodicTimer::~PeriodicTimer(void)
+  {
+    if (NULL != timerHandle) CloseHandle(timerHandle);
+  }
+
+  int64_t PeriodicTimer::Now(void)
+  {
+    return PerformanceCounterNow();
+  }
+
+  int64_t PeriodicTimer::TicksFromMicroseconds(int64_t microseconds)
+  {
+    return (microseconds * PerformanceCounterFrequency()) / 1000000;
+  }
+
+  int64_t PeriodicTimer::MicrosecondsFromTicks(int64_t ticks)
+  {
+    return (ticks * 1000000) / PerformanceCounterFrequency();
+  }
+
+  void PeriodicTimer::SetPeriodMilliseconds(unsigned int newPeriodMilliseconds)
+  {
+    periodMilliseconds = ((0 == newPeriodMilliseconds) ? 1 : newPeriodMilliseconds);
+    periodTicks = PeriodMillisecondsToTicks(periodMilliseconds);
+  }
+
+  void PeriodicTimer::SetPeriodTicks(int64_t newPeriodTicks)
+  {
+    periodTicks = ((newPeriodTicks < 1) ? 1 : newPeriodTicks);
+
+    const int64_t newPeriodMilliseconds = (periodTicks * 1000) / PerformanceCounterFrequency();
+    periodMilliseconds = ((newPeriodMilliseconds < 1) ? 1 : (unsigned int)newPeriodMilliseconds);
+  }
+
+  unsigned int PeriodicTimer::WaitForNextPeriod(void)
+  {
+    const int64_t now = PerformanceCounterNow();
+    unsigned int skippedPeriods = 0;
+
+    if (0 == nextDeadline)
+    {
+      nextDeadline = now + periodTicks;
+    }
+    else if ((now - nextDeadline) >= periodTicks)
+    {
+      // At least one whole period was missed entirely. Skip forward so that the deadline is once
+      // again the most recent point on the original schedule, which keeps the phase stable.
+      skippedPeriods = (unsigned int)((now - nextDeadline) / periodTicks);
+      nextDeadline += ((int64_t)skippedPeriods * periodTicks);
+    }
+
+    const int64_t remainingTicks = nextDeadline - now;
+    if (remainingTicks > 0) WaitTicks(remainingTicks);
+
+    nextDeadline += periodTicks;
+    return skippedPeriods;
+  }
+
+  void PeriodicTimer::WaitTicks(int64_t ticks)
+  {
+    if (NULL != timerHandle)
+    {
+      // Negative due times are interpreted as relative to the current time.
+      LARGE_INTEGER dueTime;
+      dueTime.QuadPart = -((ticks * kWaitableTimerUnitsPerSecond) / PerformanceCounterFrequency());
+      if (0 == dueTime.QuadPart) return;
+
+      if (0 != SetWaitableTimer(timerHandle, &dueTime, 0, nullptr, nullptr, FALSE))
+      {
+        WaitForSingleObject(timerHandle, INFINITE);
+        return;
+      }
+    }
+
+    // Fallback is a coarse sleep that is rounded up to the nearest millisecond so that deadlines
+    // are not woken early.
+    const int64_t frequency = PerformanceCounterFrequency();
+    Sleep((DWORD)(((ticks * 1000) + frequency - 1) / frequency));
+  }
+} // namespace Xidi
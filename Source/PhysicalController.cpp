@@ -11,49 +11,332 @@
 
 #include "PhysicalController.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <mutex>
+#include <optional>
 #include <set>
+#include <span>
 #include <stop_token>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 #include <Infra/Core/Message.h>
 
 #include "ApiWindows.h"
+#include "ApiXidi.h"
 #include "ConcurrencyWrapper.h"
 #include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "FlightRecorder.h"
 #include "ForceFeedbackDevice.h"
 #include "Globals.h"
 #include "ImportApiWinMM.h"
 #include "ImportApiXInput.h"
+#include "InputLatencyTrace.h"
+#include "LiveMetrics.h"
 #include "Mapper.h"
+#include "MapperParser.h"
+#include "MotionMapper.h"
+#include "PeriodicTimer.h"
+#include "PhysicalControllerBackend.h"
+#include "PollingStatistics.h"
+#include "ProfiledMutex.h"
+#include "Settings.h"
+#include "StartupTrace.h"
+#include "StateBroker.h"
 #include "Strings.h"
+#include "TraceEvents.h"
 #include "VirtualController.h"
+#include "WorkerThread.h"
+#include "XInputTrace.h"
 
 namespace Xidi
 {
   namespace Controller
   {
-    /// Raw physical state data for each of the possible physical controllers.
-    static ConcurrencyWrapper<SPhysicalState> physicalControllerState[kPhysicalControllerCount];
+    /// Holds the state that needs to persist between polls for a single physical controller.
+    struct SPollContext
+    {
+      /// Mapper generation observed when the mapper was picked up.
+      uint64_t mapperGeneration;
+
+      /// Mapper used to convert physical controller state to virtual controller state.
+      const Mapper* mapper;
+
+      /// Compiled extra transformations to apply to raw analog values read from the physical
+      /// controller.
+      const Mapper::SCompiledPhysicalTransform* transform;
+
+      /// Cached element mapper contributions, used when incremental mapping is enabled.
+      Mapper::SIncrementalMappingState incrementalMappingState;
+
+      /// Physical controller motion integrated during the previous poll. Only maintained if motion
+      /// is mapped.
+      SPhysicalMotion motion;
+
+      /// Timestamp of the most recent motion sensor reading, or 0 if none has been received. Only
+      /// maintained if motion is mapped.
+      int64_t motionTimestamp;
+
+      /// Time at which this context was created, in performance counter ticks. Poll timestamps
+      /// given to turbo mappers are measured from here so that their conversion to microseconds
+      /// cannot overflow.
+      int64_t epochTicks;
+    };
+
+    /// Result of reading a physical controller once, before it is processed. Kept separate from
+    /// processing so that the two can happen on different threads when pipelined polling is
+    /// enabled.
+    struct SPhysicalReading
+    {
+      /// Result code returned by the XInput state query.
+      DWORD xinputGetStateResult;
+
+      /// Physical controller state returned by the XInput state query.
+      XINPUT_STATE xinputState;
+
+      /// Performance counter value immediately before the XInput state query.
+      int64_t xinputBeginTicks;
+
+      /// Time from which input latency is measured for this reading, or 0 if input latency
+      /// tracing is disabled.
+      int64_t latencyTicks;
+    };
+
+    /// Small ring of the most recent readings of a single physical controller, written by the
+    /// thread that reads the physical controller and consumed by the thread that maps it when
+    /// pipelined polling is enabled. The consumer only ever processes the most recent reading, so
+    /// the ring just needs to be large enough that the slot being consumed is rarely overwritten.
+    /// Each ring starts on its own cache line.
+    struct alignas(64) SPhysicalReadingRing
+    {
+      /// Number of readings retained.
+      static constexpr unsigned int kCapacity = 4;
+
+      /// Retained readings, indexed by the number of readings published before each one, modulo
+      /// the capacity.
+      SeqLockConcurrencyWrapper<SPhysicalReading> readings[kCapacity];
+
+      /// Number of readings published so far. Waited on by the consumer.
+      std::atomic<uint64_t> publishedCount;
+    };
+
+    /// Timing of application reads of virtual controller state that is derived from a single
+    /// physical controller. Used to align polling with the rate at which the application
+    /// consumes state. Updated without locking, as an occasional lost update only slightly delays
+    /// convergence.
+    struct SApplicationReadTiming
+    {
+      /// Time of the first read in the most recent burst of reads, in performance counter ticks.
+      std::atomic<int64_t> lastReadTime;
+
+      /// Exponentially-weighted moving average of the time between bursts of reads, in performance
+      /// counter ticks, or 0 if not yet known.
+      std::atomic<int64_t> averageReadPeriod;
+    };
+
+    /// Holds all of the frequently-written state for a single physical controller. Each polling
+    /// thread writes only the slot for its own physical controller while application threads read
+    /// it, so each slot is aligned to start on its own cache line and no two slots share one.
+    struct alignas(64) SPhysicalControllerSlot
+    {
+      /// Raw physical state data.
+      SeqLockConcurrencyWrapper<SPhysicalState> physicalState;
+
+      /// State data after it is passed through a mapper but without any further processing.
+      SeqLockConcurrencyWrapper<SState> rawVirtualState;
+
+      /// Mutex for protecting against concurrent accesses to the physical controller state change
+      /// registration data. Held while updates are being delivered, so that unregistration cannot
+      /// complete while an update to the unregistering virtual controller is in progress.
+      std::mutex stateChangeMutex;
+
+      /// Whether or not any companion module is subscribed for state change notifications. Allows
+      /// polls to skip preparing notifications without acquiring the state change mutex.
+      std::atomic<bool> hasStateChangeSubscribers;
+
+      /// Most recent XInput packet number observed. XInput increments the packet number whenever
+      /// controller state changes, so an unchanged packet number means there is nothing new to
+      /// process. Only accessed while polling, with the poll mutex held.
+      DWORD packetNumber;
+
+      /// Whether or not the packet number was actually received from a connected physical
+      /// controller.
+      bool packetNumberValid;
+
+      /// Performance counter value at which the most recently processed reading was taken. When
+      /// pipelined polling is enabled, an on-demand poll can process a newer reading before the
+      /// mapping thread processes an older one, which is then discarded. Only accessed while
+      /// polling, with the poll mutex held.
+      int64_t processedReadingTicks;
+
+      /// Poll context, shared between the thread that periodically polls the physical controller
+      /// and any application thread that requests an on-demand poll. Accessed only with the poll
+      /// mutex held.
+      SPollContext pollContext;
+
+      /// Mutex for serializing polls. Contended only if on-demand polling is used.
+      std::mutex pollMutex;
+
+      /// Mutex for serializing reads of the physical controller. Normally always acquired with the
+      /// poll mutex already held, except when pipelined polling is enabled, in which case the
+      /// polling thread reads without holding the poll mutex.
+      std::mutex readMutex;
+
+      /// Time at which the physical controller was most recently polled, used to limit the rate of
+      /// on-demand polls. Written only with the poll mutex held.
+      std::atomic<std::chrono::steady_clock::rep> lastPollTime;
+
+      /// Timing of application reads of virtual controller state that is derived from the physical
+      /// controller.
+      SApplicationReadTiming applicationReadTiming;
+
+      /// Mutex for protecting against concurrent accesses to the physical controller force
+      /// feedback registration data.
+      ProfiledMutex<std::mutex> forceFeedbackMutex{
+          L"PhysicalController::physicalControllerForceFeedbackMutex"};
+
+      /// Overall gain applied to force feedback effects played on the physical controller,
+      /// combining the device-wide gain properties of all virtual controllers registered for force
+      /// feedback. Recomputed whenever registrations or gain properties change so that actuation
+      /// passes can read it without acquiring the registration mutex.
+      std::atomic<ForceFeedback::TEffectValue> forceFeedbackGain;
+    };
+
+    /// Frequently-written state for each of the possible physical controllers.
+    static SPhysicalControllerSlot physicalControllerSlot[kMaxPhysicalControllerCount];
+
+    /// Most recent readings of each of the possible physical controllers. Only used if pipelined
+    /// polling is enabled.
+    static SPhysicalReadingRing physicalReadingRing[kMaxPhysicalControllerCount];
+
+    /// Copies of the physical and raw virtual state of each physical controller, exported so that
+    /// other modules can read them directly from memory. Written only when the corresponding
+    /// physical controller slot is updated.
+    static Api::IStateExport::SStateBlock exportedStateBlock[kMaxPhysicalControllerCount];
+
+    /// Pointers to the virtual controller objects registered for raw virtual state updates with
+    /// each physical controller.
+    static std::set<VirtualController*>
+        physicalControllerStateChangeRegistration[kMaxPhysicalControllerCount];
+
+    /// Subscription of a companion module for state change notifications, created through the
+    /// Xidi API.
+    struct SStateChangeSubscriber
+    {
+      /// Function to invoke on every state change.
+      Api::IStateChangeSubscription::TStateChangeCallback callback;
+
+      /// Opaque value to pass to the callback function.
+      void* context;
+
+      bool operator==(const SStateChangeSubscriber& other) const = default;
+    };
 
-    /// State data for each of the possible physical controllers after it is passed through a mapper
-    /// but without any further processing.
-    static ConcurrencyWrapper<SState> rawVirtualControllerState[kPhysicalControllerCount];
+    /// All companion module subscriptions for state change notifications with a single physical
+    /// controller. Protected by the state change mutex of the corresponding physical controller
+    /// slot.
+    struct SStateChangeSubscriptions
+    {
+      /// Subscribers, in the order in which they subscribed.
+      std::vector<SStateChangeSubscriber> subscribers;
+
+      /// Raw virtual state most recently delivered to subscribers, against which the next state is
+      /// compared to identify changed elements.
+      SState notifiedRawVirtualState;
+    };
 
-    /// Per-controller force feedback device buffer objects.
-    /// These objects are not safe for dynamic initialization, so they are initialized later by
-    /// pointer.
-    static ForceFeedback::Device* physicalControllerForceFeedbackBuffer;
+    /// Companion module subscriptions for state change notifications with each physical
+    /// controller.
+    static SStateChangeSubscriptions stateChangeSubscriptions[kMaxPhysicalControllerCount];
+
+    /// Mapper resolved for each of the possible physical controllers. Resolved once during
+    /// initialization and thereafter only when explicitly invalidated, so that threads servicing
+    /// physical controllers do not need to look up the configured mapper each time they use it.
+    static std::atomic<const Mapper*> physicalControllerMapper[kMaxPhysicalControllerCount];
+
+    /// Number of times the mapper resolved for each of the possible physical controllers has been
+    /// invalidated. Threads that cache the resolved mapper compare this value against a
+    /// previously-observed value to detect that they need to pick up the newly-resolved mapper.
+    static std::atomic<uint64_t> physicalControllerMapperGeneration[kMaxPhysicalControllerCount];
+
+    /// Per-controller force feedback device buffer objects. These objects are not safe for dynamic
+    /// initialization, and most applications never use force feedback, so each one is created
+    /// along with its actuation work only once a virtual controller first registers for force
+    /// feedback with the corresponding physical controller. Written only with the force feedback
+    /// registration mutex held, and never changed once written.
+    static std::atomic<ForceFeedback::Device*>
+        physicalControllerForceFeedbackBuffer[kMaxPhysicalControllerCount];
 
     /// Pointers to the virtual controller objects registered for force feedback with each physical
     /// controller.
     static std::set<const VirtualController*>
-        physicalControllerForceFeedbackRegistration[kPhysicalControllerCount];
+        physicalControllerForceFeedbackRegistration[kMaxPhysicalControllerCount];
+
+    /// Number of device arrival notifications received from the system. Threads that are waiting
+    /// for disconnected physical controllers to be connected can compare this value against a
+    /// previously-observed value to detect that new hardware might have become available.
+    static std::atomic<uint64_t> deviceArrivalCount = 0;
+
+    /// Whether or not physical controller poll contexts are ready for use by backends that deliver
+    /// state changes as soon as they happen, rather than waiting to be polled.
+    static std::atomic<bool> backendReportsEnabled = false;
+
+    /// Mutex object for synchronizing device arrival notifications with threads waiting for them.
+    static std::mutex deviceArrivalMutex;
+
+    /// Condition variable used to wake threads that are waiting for device arrival notifications.
+    static std::condition_variable deviceArrivalCondition;
+
+    /// Bitmask of physical controllers that were connected as of their most recent poll, one bit
+    /// per controller identifier.
+    static std::atomic<uint32_t> connectedPhysicalControllerMask = 0;
+
+    /// Minimum system timer period supported by the system, in milliseconds, or 0 if it could not
+    /// be determined, in which case the system timer resolution is never changed.
+    static UINT systemTimerPeriodMinimum = 0;
+
+    /// Whether or not this process currently holds a request for a raised system timer resolution.
+    static std::atomic<bool> systemTimerResolutionIsRaised = false;
+
+    /// Mutex object for serializing changes to the system timer resolution.
+    static std::mutex systemTimerResolutionMutex;
+
+    /// Polling periods requested by applications for each physical controller, in milliseconds,
+    /// one entry per outstanding request. Requests are made through a Xidi-specific DirectInput
+    /// property and can come from multiple virtual controllers at once.
+    static std::multiset<unsigned int> pollingPeriodRequests[kMaxPhysicalControllerCount];
 
-    /// Mutex objects for protecting against concurrent accesses to the physical controller force
-    /// feedback registration data.
-    static std::mutex physicalControllerForceFeedbackMutex[kPhysicalControllerCount];
+    /// Shortest outstanding requested polling period for each physical controller, in
+    /// milliseconds, or 0 if there are no outstanding requests. Written only with the polling
+    /// period request mutex held, so that polling threads can read it without acquiring the mutex.
+    static std::atomic<unsigned int>
+        requestedPollingPeriodMilliseconds[kMaxPhysicalControllerCount];
+
+    /// Mutex object for protecting against concurrent accesses to polling period requests.
+    static std::mutex pollingPeriodRequestMutex;
+
+    /// Battery and capabilities information most recently queried for each physical controller.
+    /// Written only by the controller status service thread.
+    static SeqLockConcurrencyWrapper<Api::IControllerStatus::SControllerStatus>
+        physicalControllerStatus[kMaxPhysicalControllerCount];
+
+    /// Mutex object for synchronizing physical controller connection changes with the controller
+    /// status service thread, which waits for them.
+    static std::mutex controllerStatusServiceMutex;
+
+    /// Condition variable used to wake the controller status service thread whenever a physical
+    /// controller is connected or disconnected.
+    static std::condition_variable controllerStatusServiceCondition;
 
     /// Computes an opaque source identifier from a given controller identifier.
     /// @param [in] controllerIdentifier Identifier of the physical controller for which an
@@ -65,18 +348,465 @@ namespace Xidi
       return (uint32_t)controllerIdentifier;
     }
 
-    /// Reads physical controller state.
+    /// Determines if averaging of force feedback output is enabled in the configuration file.
+    /// @return `true` if force feedback output should be averaged over each actuation period,
+    /// `false` otherwise.
+    static bool IsForceFeedbackAveragingEnabled(void)
+    {
+      return Globals::GetSettings().properties.forceFeedbackAveraging;
+    }
+
+    /// Determines if the high-resolution polling engine is enabled in the configuration file.
+    /// @return `true` if physical controllers should be polled using a high-resolution timer,
+    /// `false` otherwise.
+    static bool IsHighResolutionPollingEnabled(void)
+    {
+      return Globals::GetSettings().properties.highResolutionPolling;
+    }
+
+    /// Determines if incremental mapping of physical controller state is enabled in the
+    /// configuration file.
+    /// @return `true` if only changed physical controller elements should be mapped on each poll,
+    /// `false` if all of them should be.
+    static bool IsIncrementalMappingEnabled(void)
+    {
+      return Globals::GetSettings().properties.incrementalMapping;
+    }
+
+    /// Retrieves the desired physical controller polling period, which can be customized in the
+    /// configuration file.
+    /// @return Polling period in milliseconds.
+    static unsigned int GetPollingPeriodMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.pollingPeriodMilliseconds;
+    }
+
+    /// Retrieves the polling period that is currently in effect for the specified physical
+    /// controller, which is the configured polling period unless an application requested a
+    /// shorter one.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @return Polling period in milliseconds.
+    static unsigned int EffectivePollingPeriodMilliseconds(
+        TControllerIdentifier controllerIdentifier)
+    {
+      const unsigned int kRequestedPollingPeriodMilliseconds =
+          requestedPollingPeriodMilliseconds[controllerIdentifier].load(std::memory_order_relaxed);
+      if (0 == kRequestedPollingPeriodMilliseconds) return GetPollingPeriodMilliseconds();
+
+      return std::min(kRequestedPollingPeriodMilliseconds, GetPollingPeriodMilliseconds());
+    }
+
+    /// Retrieves the desired physical controller polling period while this process does not have
+    /// input focus, which can be customized in the configuration file.
+    /// @return Background polling period in milliseconds, or 0 if physical controllers should not
+    /// be polled at all while in the background.
+    static unsigned int GetBackgroundPollingPeriodMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.backgroundPollingPeriodMilliseconds;
+    }
+
+    /// Applies the background polling policy. If this process does not have input focus then
+    /// waits for the background polling period, or indefinitely if background polling is disabled,
+    /// returning early as soon as input focus is gained. Does nothing if the background polling
+    /// period is configured to be no longer than the normal polling period.
+    /// @return `true` if a wait took place, in which case the caller's polling schedule is stale
+    /// and should be restarted, `false` otherwise.
+    static bool WaitWhileInBackground(void)
+    {
+      const unsigned int kBackgroundPollingPeriodMilliseconds =
+          GetBackgroundPollingPeriodMilliseconds();
+      if ((0 != kBackgroundPollingPeriodMilliseconds) &&
+          (kBackgroundPollingPeriodMilliseconds <= GetPollingPeriodMilliseconds()))
+        return false;
+
+      if (true == Globals::DoesCurrentProcessHaveInputFocus()) return false;
+
+      // There is no point holding a raised system timer resolution while waiting in the
+      // background. It is raised again by the first poll after input focus returns.
+      UpdateSystemTimerResolution();
+      Globals::WaitForInputFocus(
+          (0 == kBackgroundPollingPeriodMilliseconds) ? INFINITE
+                                                      : kBackgroundPollingPeriodMilliseconds);
+      return true;
+    }
+
+    /// Raises or restores the system timer resolution so that it is raised only while it benefits
+    /// polling, which is while at least one physical controller is connected and this process has
+    /// input focus. A raised system timer resolution affects the entire system and costs power, so
+    /// it should not be held for longer than needed. Cheap enough to invoke after every poll.
+    static void UpdateSystemTimerResolution(void)
+    {
+      if (0 == systemTimerPeriodMinimum) return;
+
+      const bool shouldBeRaised =
+          ((0 != connectedPhysicalControllerMask.load(std::memory_order_relaxed)) &&
+           (true == Globals::DoesCurrentProcessHaveInputFocus()));
+      if (shouldBeRaised == systemTimerResolutionIsRaised.load(std::memory_order_relaxed)) return;
+
+      std::scoped_lock lock(systemTimerResolutionMutex);
+      if (shouldBeRaised == systemTimerResolutionIsRaised.load(std::memory_order_relaxed)) return;
+
+      if (true == shouldBeRaised)
+      {
+        const MMRESULT timeResult = ImportApiWinMM::timeBeginPeriod(systemTimerPeriodMinimum);
+        if (MMSYSERR_NOERROR != timeResult)
+        {
+          // Leaving the resolution alone and not retrying avoids warning on every poll.
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with code %u to set the system timer resolution. It will not be changed again.",
+              timeResult);
+          systemTimerPeriodMinimum = 0;
+          return;
+        }
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Debug,
+            L"Raised the system timer resolution to %u ms.",
+            systemTimerPeriodMinimum);
+      }
+      else
+      {
+        ImportApiWinMM::timeEndPeriod(systemTimerPeriodMinimum);
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Debug,
+            L"Restored the system timer resolution because no physical controller is connected or this process does not have input focus.");
+      }
+
+      systemTimerResolutionIsRaised.store(shouldBeRaised, std::memory_order_relaxed);
+    }
+
+    /// Wakes the controller status service thread so that it can query battery and capabilities
+    /// information for a physical controller that was just connected, or mark one that was just
+    /// disconnected. Does nothing if the controller status service thread is not running.
+    static void NotifyControllerStatusService(void)
+    {
+      std::scoped_lock lock(controllerStatusServiceMutex);
+      controllerStatusServiceCondition.notify_all();
+    }
+
+    /// Records whether or not a physical controller is connected, as of its most recent poll, and
+    /// updates the system timer resolution if needed.
+    /// @param [in] controllerIdentifier Identifier of the controller that was polled.
+    /// @param [in] deviceStatus Device status read by the poll.
+    static void RecordPhysicalControllerConnection(
+        TControllerIdentifier controllerIdentifier, EPhysicalDeviceStatus deviceStatus)
+    {
+      const uint32_t controllerBit = ((uint32_t)1 << controllerIdentifier);
+
+      if (EPhysicalDeviceStatus::Ok == deviceStatus)
+      {
+        if (0 == (connectedPhysicalControllerMask.load(std::memory_order_relaxed) & controllerBit))
+        {
+          connectedPhysicalControllerMask.fetch_or(controllerBit, std::memory_order_relaxed);
+          NotifyControllerStatusService();
+        }
+      }
+      else
+      {
+        if (0 != (connectedPhysicalControllerMask.load(std::memory_order_relaxed) & controllerBit))
+        {
+          connectedPhysicalControllerMask.fetch_and(~controllerBit, std::memory_order_relaxed);
+          NotifyControllerStatusService();
+        }
+      }
+
+      UpdateSystemTimerResolution();
+    }
+
+    /// Determines if alignment of physical controller polling to application reads is enabled in
+    /// the configuration file.
+    /// @return `true` if polls should be scheduled to land shortly before the application is
+    /// expected to read state, `false` otherwise.
+    static bool IsPollingAlignmentEnabled(void)
+    {
+      return Globals::GetSettings().properties.pollingAlignment;
+    }
+
+    /// Determines if pipelined physical controller polling is enabled in the configuration file.
+    /// Has no effect if either cooperative mode or the single-threaded physical controller
+    /// scheduler is enabled.
+    /// @return `true` if each physical controller should be read and mapped by separate threads,
+    /// `false` if a single thread should do both.
+    static bool IsPipelinedPollingEnabled(void)
+    {
+      return Globals::GetSettings().properties.pipelinedPolling;
+    }
+
+    /// Determines if the single-threaded physical controller scheduler is enabled in the
+    /// configuration file.
+    /// @return `true` if all physical controllers should be serviced by a single thread, `false`
+    /// if each physical controller should be serviced by its own set of threads.
+    static bool IsSingleThreadedPollingEnabled(void)
+    {
+      return Globals::GetSettings().properties.singleThreadedPolling;
+    }
+
+    /// Determines if cooperative mode is enabled in the configuration file. Takes precedence over
+    /// the single-threaded physical controller scheduler.
+    /// @return `true` if physical controllers should be serviced on application threads whenever
+    /// the application reads state, `false` if they should be serviced by dedicated threads.
+    static bool IsCooperativeModeEnabled(void)
+    {
+      return Globals::GetSettings().properties.cooperativeMode;
+    }
+
+    /// Wakes any threads waiting for device arrival.
+    static void NotifyDeviceArrival(void)
+    {
+      {
+        std::unique_lock lock(deviceArrivalMutex);
+        deviceArrivalCount += 1;
+      }
+
+      deviceArrivalCondition.notify_all();
+    }
+
+    /// Receives device notifications from the system and wakes any threads waiting for device
+    /// arrival. Invoked by the Configuration Manager on a thread pool thread.
+    /// @param [in] action Type of device notification being delivered.
+    /// @return Always `ERROR_SUCCESS`, as required by the Configuration Manager.
+    static DWORD CALLBACK DeviceArrivalNotificationCallback(
+        HCMNOTIFICATION, PVOID, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA, DWORD)
+    {
+      if (CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL == action) NotifyDeviceArrival();
+
+      return ERROR_SUCCESS;
+    }
+
+    /// Receives notification from an event-driven backend that the identified physical controller
+    /// has new state available and polls it immediately. Defined after the polling functions.
+    /// @param [in] controllerIdentifier Identifier of the controller that has new state.
+    static void OnBackendReport(TControllerIdentifier controllerIdentifier);
+
+    /// Retrieves the backend through which physical controllers are read and actuated, selecting
+    /// it using the configuration file the first time it is needed. Replaying an XInput trace
+    /// always uses the XInput backend, because that is where replay takes place.
+    /// @return Reference to the physical controller backend.
+    static IPhysicalControllerBackend& GetBackend(void)
+    {
+      static IPhysicalControllerBackend& backend = []() -> IPhysicalControllerBackend&
+      {
+        constexpr std::wstring_view kBackendSetting =
+            Strings::kStrConfigurationSettingsPropertiesPhysicalControllerBackend;
+
+        const auto& configData = Globals::GetConfigurationData();
+        std::wstring_view requestedBackend;
+        if (true == configData.Contains(Strings::kStrConfigurationSectionProperties))
+        {
+          const auto& propertiesConfigData =
+              configData[Strings::kStrConfigurationSectionProperties];
+          if (true == propertiesConfigData.Contains(kBackendSetting))
+            requestedBackend = propertiesConfigData[kBackendSetting]->GetString();
+        }
+
+        if (true == XInputTrace::IsReplaying()) return PhysicalControllerBackend::XInput();
+
+        if (Strings::kStrConfigurationValuePhysicalControllerBackendWindowsGamingInput ==
+            requestedBackend)
+        {
+          IPhysicalControllerBackend* const windowsGamingInputBackend =
+              PhysicalControllerBackend::CreateWindowsGamingInput(&NotifyDeviceArrival);
+          if (nullptr != windowsGamingInputBackend) return *windowsGamingInputBackend;
+
+          Infra::Message::Output(
+              Infra::Message::ESeverity::Warning,
+              L"Falling back to XInput because Windows.Gaming.Input could not be initialized.");
+        }
+        else if (
+            Strings::kStrConfigurationValuePhysicalControllerBackendRawInput == requestedBackend)
+        {
+          IPhysicalControllerBackend* const rawInputBackend =
+              PhysicalControllerBackend::CreateRawInput(&NotifyDeviceArrival, &OnBackendReport);
+          if (nullptr != rawInputBackend) return *rawInputBackend;
+
+          Infra::Message::Output(
+              Infra::Message::ESeverity::Warning,
+              L"Falling back to XInput because Raw Input could not be initialized.");
+        }
+
+        return PhysicalControllerBackend::XInput();
+      }();
+
+      return backend;
+    }
+
+    /// Retrieves the motion mapper, creating it using the configuration file the first time it is
+    /// needed. Motion is only read from physical controllers if a motion mapper exists.
+    /// @return Pointer to the motion mapper, or `nullptr` if motion is not mapped.
+    static const MotionMapper* GetMotionMapper(void)
+    {
+      static const MotionMapper* const kMotionMapper = []() -> const MotionMapper*
+      {
+        constexpr std::wstring_view kAxisSettings[] = {
+            Strings::kStrConfigurationSettingsPropertiesMotionPitch,
+            Strings::kStrConfigurationSettingsPropertiesMotionYaw,
+            Strings::kStrConfigurationSettingsPropertiesMotionRoll};
+        static_assert(
+            _countof(kAxisSettings) == static_cast<int>(EPhysicalMotionAxis::Count),
+            "Mismatch between motion axis settings and motion axes.");
+
+        const auto& configData = Globals::GetConfigurationData();
+        if (false == configData.Contains(Strings::kStrConfigurationSectionProperties))
+          return nullptr;
+
+        const auto& propertiesConfigData = configData[Strings::kStrConfigurationSectionProperties];
+
+        MotionMapper::TAxisMappers axisMappers;
+        bool anyAxisMapped = false;
+        for (int i = 0; i < _countof(kAxisSettings); ++i)
+        {
+          if (false == propertiesConfigData.Contains(kAxisSettings[i])) continue;
+
+          MapperParser::ElementMapperOrError maybeElementMapper =
+              MapperParser::ElementMapperFromString(
+                  propertiesConfigData[kAxisSettings[i]]->GetString());
+          if (false == maybeElementMapper.HasValue()) continue;
+
+          axisMappers[i] = std::move(maybeElementMapper.Value());
+          anyAxisMapped = anyAxisMapped || (nullptr != axisMappers[i]);
+        }
+
+        if (false == anyAxisMapped) return nullptr;
+
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Info, L"Physical controller motion is being mapped.");
+
+        return new MotionMapper(
+            std::move(axisMappers),
+            static_cast<unsigned int>(
+                propertiesConfigData
+                    [Strings::kStrConfigurationSettingsPropertiesMotionFullScaleDegreesPerSecond]
+                        .ValueOr(MotionMapper::kDefaultFullScaleDegreesPerSecond)));
+      }();
+
+      return kMotionMapper;
+    }
+
+    /// Generates the name of a per-controller background thread.
+    /// @param [in] purpose Description of what the thread does.
+    /// @param [in] controllerIdentifier Identifier of the controller that the thread serves.
+    /// @return Thread name.
+    static std::wstring PerControllerThreadName(
+        std::wstring_view purpose, TControllerIdentifier controllerIdentifier)
+    {
+      return std::wstring(L"Xidi Controller ") + std::to_wstring(1 + controllerIdentifier) +
+          L" " + std::wstring(purpose);
+    }
+
+    /// Attempts to register for device interface arrival notifications from the system, so that
+    /// polling of disconnected physical controllers can be woken early when hardware is connected.
+    /// The Configuration Manager notification API is imported dynamically because it is not
+    /// available on all supported versions of Windows. Registration lasts for the lifetime of the
+    /// process.
+    /// @return `true` if registration succeeded, `false` otherwise.
+    static bool RegisterForDeviceArrivalNotifications(void)
+    {
+      using TCMRegisterNotification = decltype(&CM_Register_Notification);
+
+      HMODULE cfgmgrLibrary = LoadLibraryEx(
+          Strings::kStrLibraryNameCfgMgr32.data(), nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+      if (nullptr == cfgmgrLibrary) return false;
+
+      TCMRegisterNotification cmRegisterNotification = reinterpret_cast<TCMRegisterNotification>(
+          GetProcAddress(cfgmgrLibrary, "CM_Register_Notification"));
+      if (nullptr == cmRegisterNotification) return false;
+
+      CM_NOTIFY_FILTER notifyFilter = {
+          .cbSize = sizeof(CM_NOTIFY_FILTER),
+          .Flags = CM_NOTIFY_FILTER_FLAG_ALL_INTERFACE_CLASSES,
+          .FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE};
+
+      HCMNOTIFICATION notificationHandle = nullptr;
+      return (
+          CR_SUCCESS ==
+          cmRegisterNotification(
+              &notifyFilter, nullptr, &DeviceArrivalNotificationCallback, &notificationHandle));
+    }
+
+    /// Blocks until either the specified amount of time elapses or a device arrival notification
+    /// is received from the system.
+    /// @param [in,out] lastDeviceArrivalCount On input, the device arrival count last observed by
+    /// the calling thread. On output, updated to the current device arrival count.
+    /// @param [in] timeoutMilliseconds Maximum amount of time to wait, in milliseconds.
+    /// @return `true` if a device arrival notification was received, `false` if the wait timed
+    /// out.
+    static bool WaitForDeviceArrival(
+        uint64_t& lastDeviceArrivalCount, unsigned int timeoutMilliseconds)
+    {
+      std::unique_lock lock(deviceArrivalMutex);
+      const bool deviceArrived = deviceArrivalCondition.wait_for(
+          lock,
+          std::chrono::milliseconds(timeoutMilliseconds),
+          [&lastDeviceArrivalCount]() -> bool
+          {
+            return (deviceArrivalCount != lastDeviceArrivalCount);
+          });
+
+      lastDeviceArrivalCount = deviceArrivalCount;
+      return deviceArrived;
+    }
+
+    /// Computes the next back-off period to use while a physical controller remains disconnected.
+    /// @param [in] currentBackoffPeriod Back-off period that was most recently used.
+    /// @param [in] maximumBackoffPeriod Upper limit on the back-off period.
+    /// @return Next back-off period, in the same units as the input.
+    static inline unsigned int NextDisconnectedBackoffPeriod(
+        unsigned int currentBackoffPeriod, unsigned int maximumBackoffPeriod)
+    {
+      return std::min(currentBackoffPeriod * 2, maximumBackoffPeriod);
+    }
+
+    /// Determines if the Guide button is enabled in the configuration file and can actually be
+    /// reported by the loaded XInput library.
+    /// @return `true` if physical controllers should be read using the extended XInput state query,
+    /// `false` otherwise.
+    static bool IsGuideButtonEnabled(void)
+    {
+      static const bool kGuideButtonEnabled = (Globals::GetSettings().properties.guideButton) &&
+          ImportApiXInput::IsXInputGetStateExAvailable();
+
+      return kGuideButtonEnabled;
+    }
+
+    /// Queries the physical controller backend for the state of a physical controller. This is
+    /// the only state query issued for each poll. If the Guide button is enabled then the backend
+    /// is asked to report it. If physical controller state is shared with other processes and
+    /// another process owns polling, the state it most recently published is used instead of
+    /// querying the backend.
     /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
-    /// @return Physical state of the identified controller.
-    static SPhysicalState ReadPhysicalControllerState(TControllerIdentifier controllerIdentifier)
+    /// @param [out] xinputState Filled in with the state data reported by the backend.
+    /// @param [out] readingTimestamp Filled in with the performance counter value at which the
+    /// hardware reading was taken, or 0 if it is not known.
+    /// @return XInput result code from the state query.
+    static inline DWORD QueryXInputState(
+        TControllerIdentifier controllerIdentifier,
+        XINPUT_STATE& xinputState,
+        int64_t& readingTimestamp)
     {
-      constexpr uint16_t kUnusedButtonMask =
-          ~((uint16_t)((1u << (unsigned int)EPhysicalButton::UnusedGuide) |
-                       (1u << (unsigned int)EPhysicalButton::UnusedShare)));
+      DWORD xinputGetStateResult = ERROR_SUCCESS;
+      readingTimestamp = 0;
+      if (true ==
+          StateBroker::TryReadXInputState(controllerIdentifier, xinputGetStateResult, xinputState))
+        return xinputGetStateResult;
 
-      XINPUT_STATE xinputState;
-      DWORD xinputGetStateResult =
-          ImportApiXInput::XInputGetState(controllerIdentifier, &xinputState);
+      xinputGetStateResult = GetBackend().ReadState(
+          controllerIdentifier, IsGuideButtonEnabled(), xinputState, readingTimestamp);
+
+      StateBroker::PublishXInputState(controllerIdentifier, xinputGetStateResult, xinputState);
+      return xinputGetStateResult;
+    }
+
+    /// Converts the result of an XInput state query to physical controller state.
+    /// @param [in] xinputGetStateResult Return code from the XInput state query.
+    /// @param [in] xinputState State data filled in by the XInput state query. Only used if the
+    /// query succeeded.
+    /// @return Corresponding physical controller state.
+    static SPhysicalState PhysicalStateFromXInputState(
+        DWORD xinputGetStateResult, const XINPUT_STATE& xinputState)
+    {
+      constexpr uint16_t kUnusedButtonMask =
+          ~((uint16_t)(1u << (unsigned int)EPhysicalButton::UnusedShare));
 
       switch (xinputGetStateResult)
       {
@@ -102,6 +832,22 @@ namespace Xidi
       }
     }
 
+    /// Reads physical controller state.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Physical state of the identified controller.
+    static SPhysicalState ReadPhysicalControllerState(TControllerIdentifier controllerIdentifier)
+    {
+      XINPUT_STATE xinputState;
+      int64_t readingTimestamp = 0;
+      const DWORD xinputGetStateResult =
+          QueryXInputState(controllerIdentifier, xinputState, readingTimestamp);
+
+      if (true == XInputTrace::IsRecording())
+        XInputTrace::Record(controllerIdentifier, xinputGetStateResult, xinputState);
+
+      return PhysicalStateFromXInputState(xinputGetStateResult, xinputState);
+    }
+
     static_assert(1u << (unsigned int)EPhysicalButton::DpadUp == XINPUT_GAMEPAD_DPAD_UP);
     static_assert(1u << (unsigned int)EPhysicalButton::DpadDown == XINPUT_GAMEPAD_DPAD_DOWN);
     static_assert(1u << (unsigned int)EPhysicalButton::DpadLeft == XINPUT_GAMEPAD_DPAD_LEFT);
@@ -117,6 +863,10 @@ namespace Xidi
     static_assert(1u << (unsigned int)EPhysicalButton::X == XINPUT_GAMEPAD_X);
     static_assert(1u << (unsigned int)EPhysicalButton::Y == XINPUT_GAMEPAD_Y);
 
+    // The Guide button is only reported by the extended XInput state query, so the public XInput
+    // header does not define a constant for it.
+    static_assert(1u << (unsigned int)EPhysicalButton::Guide == 0x0400);
+
     /// Scales a vibration strength value by the specified scaling factor. If the resulting strength
     /// exceeds the maximum possible strength it is saturated at the maximum possible strength.
     /// @param [in] vibrationStrength Physical motor vibration strength value.
@@ -140,6 +890,39 @@ namespace Xidi
           std::min(scaledVibrationStrength, kMaxVibrationStrength));
     }
 
+    /// Retrieves the factor by which force feedback effect strength is scaled for the specified
+    /// physical controller. The per-controller properties section, if present, takes precedence
+    /// over the controller-independent properties section. Values for all physical controllers are
+    /// read from the configuration file together, the first time any of them is needed.
+    /// @param [in] controllerIdentifier Identifier of the controller of interest.
+    /// @return Scaling factor, where 1.0 means effects are not scaled.
+    static double GetForceFeedbackEffectStrengthScalingFactor(
+        TControllerIdentifier controllerIdentifier)
+    {
+      static const std::array<double, kMaxPhysicalControllerCount> kScalingFactors = []()
+      {
+        constexpr std::wstring_view kStrengthPercentSetting =
+            Strings::kStrConfigurationSettingPropertiesForceFeedbackEffectStrengthPercent;
+
+        const auto& configData = Globals::GetConfigurationData();
+        const int64_t defaultStrengthPercent =
+            configData[Strings::kStrConfigurationSectionProperties][kStrengthPercentSetting]
+                .ValueOr(100);
+
+        std::array<double, kMaxPhysicalControllerCount> scalingFactors;
+        for (TControllerIdentifier i = 0; i < kMaxPhysicalControllerCount; ++i)
+          scalingFactors[i] =
+              static_cast<double>(configData[Strings::PropertiesConfigurationSectionString(i)]
+                                            [kStrengthPercentSetting]
+                                                .ValueOr(defaultStrengthPercent)) /
+              100.0;
+
+        return scalingFactors;
+      }();
+
+      return kScalingFactors[controllerIdentifier];
+    }
+
     /// Writes a vibration command to a physical controller.
     /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
     /// @param [in] vibration Physical actuator vibration vector.
@@ -148,191 +931,1523 @@ namespace Xidi
         TControllerIdentifier controllerIdentifier,
         ForceFeedback::SPhysicalActuatorComponents vibration)
     {
-      static const double kForceFeedbackEffectStrengthScalingFactor =
-          static_cast<double>(
-              Globals::GetConfigurationData()
-                  [Strings::kStrConfigurationSectionProperties]
-                  [Strings::kStrConfigurationSettingPropertiesForceFeedbackEffectStrengthPercent]
-                      .ValueOr(100)) /
-          100.0;
-
-      // Impulse triggers are ignored because the XInput API does not support them.
-      XINPUT_VIBRATION xinputVibration = {
-          .wLeftMotorSpeed = ScaledVibrationStrength(
-              vibration.leftMotor, kForceFeedbackEffectStrengthScalingFactor),
-          .wRightMotorSpeed = ScaledVibrationStrength(
-              vibration.rightMotor, kForceFeedbackEffectStrengthScalingFactor)};
-      return (
-          ERROR_SUCCESS ==
-          ImportApiXInput::XInputSetState((DWORD)controllerIdentifier, &xinputVibration));
+      const double forceFeedbackEffectStrengthScalingFactor =
+          GetForceFeedbackEffectStrengthScalingFactor(controllerIdentifier);
+
+      const ForceFeedback::SPhysicalActuatorComponents scaledVibration = {
+          .leftMotor = ScaledVibrationStrength(
+              vibration.leftMotor, forceFeedbackEffectStrengthScalingFactor),
+          .rightMotor = ScaledVibrationStrength(
+              vibration.rightMotor, forceFeedbackEffectStrengthScalingFactor),
+          .leftImpulseTrigger = ScaledVibrationStrength(
+              vibration.leftImpulseTrigger, forceFeedbackEffectStrengthScalingFactor),
+          .rightImpulseTrigger = ScaledVibrationStrength(
+              vibration.rightImpulseTrigger, forceFeedbackEffectStrengthScalingFactor)};
+      const DWORD result = GetBackend().WriteVibration(controllerIdentifier, scaledVibration);
+      TraceEvents::XInputSetState(
+          controllerIdentifier, scaledVibration.leftMotor, scaledVibration.rightMotor, result);
+      FlightRecorder::RecordForceFeedbackWrite(
+          controllerIdentifier, scaledVibration.leftMotor, scaledVibration.rightMotor, result);
+
+      return (ERROR_SUCCESS == result);
     }
 
-    /// Periodically plays force feedback effects on the physical controller actuators.
+    /// Recomputes the overall gain applied to force feedback effects played on the specified
+    /// physical controller. Caller must hold the force feedback registration mutex for the
+    /// specified physical controller.
     /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
-    static void ForceFeedbackActuateEffects(TControllerIdentifier controllerIdentifier)
+    static void UpdateForceFeedbackGain(TControllerIdentifier controllerIdentifier)
     {
-      constexpr ForceFeedback::TOrderedMagnitudeComponents kVirtualMagnitudeVectorZero = {};
+      ForceFeedback::TEffectValue overallEffectGain = ForceFeedback::kEffectModifierMaximum;
+
+      // Gain is modified downwards by each virtual controller object.
+      // Typically there would only be one, in which case the properties of that object would be
+      // effective. Otherwise this loop is essentially modeled as multiple volume knobs connected in
+      // sequence, each lowering the volume of the effects by the value of its own device-wide gain
+      // property.
+      for (auto virtualController :
+           physicalControllerForceFeedbackRegistration[controllerIdentifier])
+        overallEffectGain *=
+            ((ForceFeedback::TEffectValue)virtualController->GetForceFeedbackGain() /
+             ForceFeedback::kEffectModifierMaximum);
+
+      physicalControllerSlot[controllerIdentifier].forceFeedbackGain = overallEffectGain;
+    }
+
+    /// Holds the state that needs to persist between force feedback actuation passes for a single
+    /// physical controller.
+    struct SForceFeedbackActuationContext
+    {
+      /// Mapper generation observed when the mapper was picked up.
+      uint64_t mapperGeneration;
 
+      /// Mapper used to convert virtual force feedback magnitudes to physical actuator values.
+      const Mapper* mapper;
+
+      /// Physical actuator values most recently written to the physical controller.
       ForceFeedback::SPhysicalActuatorComponents previousPhysicalActuatorValues;
-      ForceFeedback::SPhysicalActuatorComponents currentPhysicalActuatorValues;
 
-      const Mapper* mapper = Mapper::GetConfigured(controllerIdentifier);
-      bool lastActuationResult = true;
+      /// System time, in milliseconds, at which physical actuator values were most recently
+      /// written to the physical controller.
+      DWORD previousPhysicalActuatorWriteTime;
 
-      while (true)
-      {
-        if (true == lastActuationResult)
-          Sleep(kPhysicalForceFeedbackPeriodMilliseconds);
-        else
-          Sleep(kPhysicalErrorBackoffPeriodMilliseconds);
+      /// Whether or not the most recent actuation pass succeeded.
+      bool lastActuationResult;
 
-        if (true == Globals::DoesCurrentProcessHaveInputFocus())
-        {
-          ForceFeedback::TEffectValue overallEffectGain = 10000;
-          ForceFeedback::SPhysicalActuatorComponents physicalActuatorVector = {};
-          ForceFeedback::TOrderedMagnitudeComponents virtualMagnitudeVector =
-              physicalControllerForceFeedbackBuffer[controllerIdentifier].PlayEffects();
+      /// Virtual controller axis state most recently presented to condition effects.
+      ForceFeedback::SConditionInput conditionInput;
 
-          if (kVirtualMagnitudeVectorZero != virtualMagnitudeVector)
-          {
-            std::unique_lock lock(physicalControllerForceFeedbackMutex[controllerIdentifier]);
-
-            // Gain is modified downwards by each virtual controller object.
-            // Typically there would only be one, in which case the properties of that object would
-            // be effective. Otherwise this loop is essentially modeled as multiple volume knobs
-            // connected in sequence, each lowering the volume of the effects by the value of its
-            // own device-wide gain property.
-            for (auto virtualController :
-                 physicalControllerForceFeedbackRegistration[controllerIdentifier])
-              overallEffectGain *=
-                  ((ForceFeedback::TEffectValue)virtualController->GetForceFeedbackGain() /
-                   ForceFeedback::kEffectModifierMaximum);
-
-            physicalActuatorVector = mapper->MapForceFeedbackVirtualToPhysical(
-                virtualMagnitudeVector, overallEffectGain);
-          }
+      /// System time, in milliseconds, at which #conditionInput was most recently sampled, or 0
+      /// if it has never been sampled.
+      DWORD conditionInputSampleTime;
+    };
 
-          currentPhysicalActuatorValues = physicalActuatorVector;
-        }
-        else
-        {
-          currentPhysicalActuatorValues = {};
-        }
+    /// Creates and returns a force feedback actuation context in its initial state.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Initialized force feedback actuation context.
+    static SForceFeedbackActuationContext MakeForceFeedbackActuationContext(
+        TControllerIdentifier controllerIdentifier)
+    {
+      return {
+          .mapperGeneration = physicalControllerMapperGeneration[controllerIdentifier],
+          .mapper = physicalControllerMapper[controllerIdentifier],
+          .previousPhysicalActuatorValues = {},
+          .previousPhysicalActuatorWriteTime = 0,
+          .lastActuationResult = true,
+          .conditionInput = {},
+          .conditionInputSampleTime = 0};
+    }
 
-        if (previousPhysicalActuatorValues != currentPhysicalActuatorValues)
-        {
-          lastActuationResult =
-              WritePhysicalControllerVibration(controllerIdentifier, currentPhysicalActuatorValues);
-          previousPhysicalActuatorValues = currentPhysicalActuatorValues;
-        }
-        else
+    /// Samples the raw virtual controller axis state published for the identified physical
+    /// controller and updates the axis state presented to condition effects. Reading the published
+    /// state never blocks the polling thread, so condition effects respond to axis motion at
+    /// actuation rate rather than at the rate at which the application updates effect parameters.
+    /// Velocity and acceleration are derived from the difference between consecutive samples.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @param [in,out] context Actuation context for the identified controller, whose condition
+    /// input is updated.
+    static void SampleForceFeedbackConditionInput(
+        TControllerIdentifier controllerIdentifier, SForceFeedbackActuationContext& context)
+    {
+      const DWORD sampleTime = ImportApiWinMM::timeGetTime();
+      const DWORD elapsedTime = sampleTime - context.conditionInputSampleTime;
+
+      // Samples taken within the same millisecond carry no new timing information.
+      if ((0 != context.conditionInputSampleTime) && (0 == elapsedTime)) return;
+
+      const decltype(SState::axis) axisValues =
+          physicalControllerSlot[controllerIdentifier]
+              .rawVirtualState.GetPart<decltype(SState::axis)>(offsetof(SState, axis));
+
+      ForceFeedback::SConditionInput conditionInput = {};
+      for (size_t i = 0; i < axisValues.size(); ++i)
+      {
+        const int32_t axisValue = std::clamp(axisValues[i], kAnalogValueMin, kAnalogValueMax);
+        conditionInput.position[i] =
+            ((ForceFeedback::TEffectValue)axisValue * ForceFeedback::kEffectForceMagnitudeMaximum) /
+            (ForceFeedback::TEffectValue)kAnalogValueMax;
+
+        if (0 != context.conditionInputSampleTime)
         {
-          lastActuationResult = true;
+          const ForceFeedback::TEffectValue timeScale =
+              (ForceFeedback::TEffectValue)ForceFeedback::SConditionInput::kTimeBaseMs /
+              (ForceFeedback::TEffectValue)elapsedTime;
+          conditionInput.velocity[i] =
+              (conditionInput.position[i] - context.conditionInput.position[i]) * timeScale;
+          conditionInput.acceleration[i] =
+              (conditionInput.velocity[i] - context.conditionInput.velocity[i]) * timeScale;
         }
       }
+
+      context.conditionInput = conditionInput;
+      context.conditionInputSampleTime = sampleTime;
+    }
+
+    /// Determines whether or not new physical actuator values should be written to the physical
+    /// controller. Writing takes time on the link to the physical controller, which on wireless
+    /// controllers is shared with input reports, so small changes can be suppressed and writes can
+    /// be rate-limited as configured. Motors that are starting or stopping are always written
+    /// immediately.
+    /// @param [in] context Actuation context for the physical controller of interest.
+    /// @param [in] newPhysicalActuatorValues Physical actuator values that could be written.
+    /// @return `true` if the new values should be written, `false` otherwise.
+    static bool ShouldWritePhysicalActuatorValues(
+        const SForceFeedbackActuationContext& context,
+        const ForceFeedback::SPhysicalActuatorComponents& newPhysicalActuatorValues)
+    {
+      const SSettings::SProperties& settings = Globals::GetSettings().properties;
+      const int kWriteThreshold = std::max(
+          1,
+          (settings.forceFeedbackWriteThresholdPercent *
+           static_cast<int>(std::numeric_limits<ForceFeedback::TPhysicalActuatorValue>::max())) /
+              100);
+      const DWORD kWritePeriodMilliseconds = settings.forceFeedbackWritePeriodMilliseconds;
+
+      if (newPhysicalActuatorValues == context.previousPhysicalActuatorValues) return false;
+
+      const ForceFeedback::TPhysicalActuatorValue previousValues[] = {
+          context.previousPhysicalActuatorValues.leftMotor,
+          context.previousPhysicalActuatorValues.rightMotor,
+          context.previousPhysicalActuatorValues.leftImpulseTrigger,
+          context.previousPhysicalActuatorValues.rightImpulseTrigger};
+      const ForceFeedback::TPhysicalActuatorValue newValues[] = {
+          newPhysicalActuatorValues.leftMotor,
+          newPhysicalActuatorValues.rightMotor,
+          newPhysicalActuatorValues.leftImpulseTrigger,
+          newPhysicalActuatorValues.rightImpulseTrigger};
+
+      for (int i = 0; i < _countof(newValues); ++i)
+      {
+        if ((0 == previousValues[i]) != (0 == newValues[i])) return true;
+      }
+
+      if ((ImportApiWinMM::timeGetTime() - context.previousPhysicalActuatorWriteTime) <
+          kWritePeriodMilliseconds)
+        return false;
+
+      for (int i = 0; i < _countof(newValues); ++i)
+      {
+        if (std::abs((int)newValues[i] - (int)previousValues[i]) >= kWriteThreshold) return true;
+      }
+
+      return false;
     }
 
-    /// Periodically polls for physical controller state.
-    /// On detected state change, updates the internal data structure and notifies all waiting
-    /// threads.
+    /// Evaluates force feedback effects for a single actuation pass and determines the values to
+    /// which the physical actuators should be set, without writing them. Separated from writing so
+    /// that effects for all physical controllers can be evaluated together.
     /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
-    static void PollForPhysicalControllerStateChanges(TControllerIdentifier controllerIdentifier)
+    /// @param [in,out] context Actuation context for the identified controller, updated as a result
+    /// of this evaluation.
+    /// @return Physical actuator values to be written, or nothing if the physical actuators do not
+    /// need to be written during this actuation pass.
+    static std::optional<ForceFeedback::SPhysicalActuatorComponents> ForceFeedbackEvaluateEffects(
+        TControllerIdentifier controllerIdentifier, SForceFeedbackActuationContext& context)
     {
-      SPhysicalState newPhysicalState = physicalControllerState[controllerIdentifier].Get();
+      constexpr ForceFeedback::TOrderedMagnitudeComponents kVirtualMagnitudeVectorZero = {};
+      constexpr ForceFeedback::SPhysicalActuatorComponents kPhysicalActuatorValuesZero = {};
+
+      // Physical controllers with which no virtual controller has ever registered for force
+      // feedback have no device buffer and therefore nothing to actuate.
+      ForceFeedback::Device* const forceFeedbackDevice =
+          physicalControllerForceFeedbackBuffer[controllerIdentifier].load(
+              std::memory_order_acquire);
+      if (nullptr == forceFeedbackDevice) return std::nullopt;
+
+      // The generation is read before the mapper so that an invalidation that happens in between
+      // is still detected on the next actuation pass.
+      const uint64_t currentMapperGeneration =
+          physicalControllerMapperGeneration[controllerIdentifier];
+      if (currentMapperGeneration != context.mapperGeneration)
+      {
+        context.mapperGeneration = currentMapperGeneration;
+        context.mapper = physicalControllerMapper[controllerIdentifier];
+      }
 
-      while (true)
+      // An idle device buffer produces no output, so if the physical actuators are already at rest
+      // then there is nothing to do. This also avoids querying input focus, which is only relevant
+      // while effects are playing.
+      if ((kPhysicalActuatorValuesZero == context.previousPhysicalActuatorValues) &&
+          (true == forceFeedbackDevice->IsDeviceIdle()))
+        return std::nullopt;
+
+      if (true == TraceEvents::IsEnabled())
+        TraceEvents::ForceFeedbackTick(
+            controllerIdentifier, forceFeedbackDevice->GetCountPlayingEffects());
+
+      ForceFeedback::SPhysicalActuatorComponents currentPhysicalActuatorValues;
+
+      if (true == Globals::DoesCurrentProcessHaveInputFocus())
       {
-        if (EPhysicalDeviceStatus::Ok == newPhysicalState.deviceStatus)
-          Sleep(kPhysicalPollingPeriodMilliseconds);
-        else
-          Sleep(kPhysicalErrorBackoffPeriodMilliseconds);
+        SampleForceFeedbackConditionInput(controllerIdentifier, context);
 
-        newPhysicalState = ReadPhysicalControllerState(controllerIdentifier);
+        ForceFeedback::SPhysicalActuatorComponents physicalActuatorVector = {};
+        ForceFeedback::TOrderedMagnitudeComponents virtualMagnitudeVector =
+            forceFeedbackDevice->PlayEffects(context.conditionInput);
 
-        if (true == physicalControllerState[controllerIdentifier].Update(newPhysicalState))
+        if (kVirtualMagnitudeVectorZero != virtualMagnitudeVector)
         {
-          const SState newRawVirtualState =
-              ((EPhysicalDeviceStatus::Ok == newPhysicalState.deviceStatus)
-                   ? Mapper::GetConfigured(controllerIdentifier)
-                         ->MapStatePhysicalToVirtual(
-                             newPhysicalState,
-                             OpaqueControllerSourceIdentifier(controllerIdentifier))
-                   : Mapper::GetConfigured(controllerIdentifier)
-                         ->MapNeutralPhysicalToVirtual(
-                             OpaqueControllerSourceIdentifier(controllerIdentifier)));
-
-          rawVirtualControllerState[controllerIdentifier].Update(newRawVirtualState);
+          const ForceFeedback::TEffectValue overallEffectGain =
+              physicalControllerSlot[controllerIdentifier].forceFeedbackGain;
+          physicalActuatorVector = context.mapper->MapForceFeedbackVirtualToPhysical(
+              virtualMagnitudeVector, overallEffectGain);
         }
+
+        currentPhysicalActuatorValues = physicalActuatorVector;
+      }
+      else
+      {
+        currentPhysicalActuatorValues = {};
       }
+
+      if (false == ShouldWritePhysicalActuatorValues(context, currentPhysicalActuatorValues))
+        return std::nullopt;
+
+      return currentPhysicalActuatorValues;
     }
 
-    /// Monitors physical controller status for events like hardware connection or disconnection and
-    /// error conditions. Used exclusively for logging. Intended to be a thread entry point, one
+    /// Writes physical actuator values previously determined by evaluating force feedback effects.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @param [in,out] context Actuation context for the identified controller, updated as a result
+    /// of this write.
+    /// @param [in] physicalActuatorValues Physical actuator values to write.
+    /// @return `true` if the write succeeded, `false` otherwise.
+    static bool ForceFeedbackWriteActuators(
+        TControllerIdentifier controllerIdentifier,
+        SForceFeedbackActuationContext& context,
+        const ForceFeedback::SPhysicalActuatorComponents& physicalActuatorValues)
+    {
+      context.lastActuationResult =
+          WritePhysicalControllerVibration(controllerIdentifier, physicalActuatorValues);
+      context.previousPhysicalActuatorValues = physicalActuatorValues;
+      context.previousPhysicalActuatorWriteTime = ImportApiWinMM::timeGetTime();
+
+      if (true == LiveMetrics::IsEnabled())
+        LiveMetrics::RecordActuatorValues(controllerIdentifier, physicalActuatorValues);
+
+      return context.lastActuationResult;
+    }
+
+    /// Plays force feedback effects on the physical controller actuators for a single actuation
+    /// pass. Physical actuators are only written if their values have changed since the previous
+    /// pass.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @param [in,out] context Actuation context for the identified controller, updated as a result
+    /// of this actuation pass.
+    /// @return `true` if the actuation pass succeeded, `false` if writing to the physical actuators
+    /// failed.
+    static bool ForceFeedbackActuateEffectsOnce(
+        TControllerIdentifier controllerIdentifier, SForceFeedbackActuationContext& context)
+    {
+      const std::optional<ForceFeedback::SPhysicalActuatorComponents> physicalActuatorValues =
+          ForceFeedbackEvaluateEffects(controllerIdentifier, context);
+
+      if (false == physicalActuatorValues.has_value())
+      {
+        context.lastActuationResult = true;
+        return context.lastActuationResult;
+      }
+
+      return ForceFeedbackWriteActuators(controllerIdentifier, context, *physicalActuatorValues);
+    }
+
+    /// Periodically plays force feedback effects on the physical controller actuators. Intended to
+    /// be a thread entry point, one thread per physical controller, started only once the device
+    /// buffer for the physical controller exists.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    static void ForceFeedbackActuateEffects(TControllerIdentifier controllerIdentifier)
+    {
+      SForceFeedbackActuationContext context =
+          MakeForceFeedbackActuationContext(controllerIdentifier);
+      ForceFeedback::Device& forceFeedbackDevice =
+          *physicalControllerForceFeedbackBuffer[controllerIdentifier].load(
+              std::memory_order_acquire);
+
+      constexpr ForceFeedback::SPhysicalActuatorComponents kPhysicalActuatorValuesZero = {};
+
+      while (true)
+      {
+        if (true == context.lastActuationResult)
+        {
+          // There is no reason to wake up periodically if no effects are playing and the physical
+          // actuators are already at rest. Actuation resumes as soon as effects are changed.
+          if (kPhysicalActuatorValuesZero == context.previousPhysicalActuatorValues)
+            forceFeedbackDevice.WaitWhileDeviceIdle();
+
+          // Waking up early for an effect that is about to start or finish means the physical
+          // actuators reflect the change when it happens rather than up to a full period later.
+          unsigned int sleepMilliseconds = GetForceFeedbackPeriodMilliseconds();
+          const std::optional<ForceFeedback::TEffectTimeMs> timeUntilNextTransition =
+              forceFeedbackDevice.GetTimeUntilNextTransition();
+          if ((true == timeUntilNextTransition.has_value()) &&
+              (*timeUntilNextTransition < sleepMilliseconds))
+            sleepMilliseconds = *timeUntilNextTransition;
+
+          Sleep(sleepMilliseconds);
+        }
+        else
+        {
+          Sleep(kPhysicalErrorBackoffPeriodMilliseconds);
+        }
+
+        ForceFeedbackActuateEffectsOnce(controllerIdentifier, context);
+      }
+    }
+
+    /// Copies the current physical and raw virtual state of the specified physical controller into
+    /// its exported state block. Only invoked while polling, with the poll mutex held, or during
+    /// initialization, so that each exported state block has only one writer at a time.
+    /// @param [in] controllerIdentifier Identifier of the controller whose state is to be exported.
+    /// @return Controller state that was exported.
+    static Api::IControllerState::SControllerState ExportControllerState(
+        TControllerIdentifier controllerIdentifier)
+    {
+      const SPhysicalControllerSlot& controllerSlot = physicalControllerSlot[controllerIdentifier];
+
+      Api::IControllerState::SControllerState exportedState = {};
+      exportedState.physicalState =
+          controllerSlot.physicalState.Get(exportedState.physicalStateGeneration);
+      exportedState.rawVirtualState =
+          controllerSlot.rawVirtualState.Get(exportedState.rawVirtualStateGeneration);
+
+      exportedStateBlock[controllerIdentifier].Write(exportedState);
+      return exportedState;
+    }
+
+    /// Delivers a new controller state to all companion modules subscribed for state change
+    /// notifications with the specified physical controller. Does nothing if there are no
+    /// subscribers. Subscriber callbacks are invoked with the state change mutex held, so that
+    /// unsubscribing cannot complete while a notification to the unsubscribing callback is in
+    /// progress.
+    /// @param [in] controllerIdentifier Identifier of the controller whose state changed.
+    /// @param [in] newState New controller state to be delivered.
+    /// @param [in] timestamp Performance counter value at which the poll that produced the new
+    /// state began.
+    static void NotifyStateChangeSubscribers(
+        TControllerIdentifier controllerIdentifier,
+        const Api::IControllerState::SControllerState& newState,
+        int64_t timestamp)
+    {
+      SPhysicalControllerSlot& controllerSlot = physicalControllerSlot[controllerIdentifier];
+      if (false == controllerSlot.hasStateChangeSubscribers.load(std::memory_order_relaxed))
+        return;
+
+      std::unique_lock lock(controllerSlot.stateChangeMutex);
+      SStateChangeSubscriptions& subscriptions = stateChangeSubscriptions[controllerIdentifier];
+
+      const TElementMask changedElements = ElementMaskForStateDifference(
+          subscriptions.notifiedRawVirtualState, newState.rawVirtualState);
+      subscriptions.notifiedRawVirtualState = newState.rawVirtualState;
+
+      for (const auto& subscriber : subscriptions.subscribers)
+        subscriber.callback(
+            (unsigned int)controllerIdentifier,
+            newState,
+            changedElements,
+            timestamp,
+            subscriber.context);
+    }
+
+    /// Delivers a new raw virtual state to all virtual controllers registered with the specified
+    /// physical controller, and signals state change events for those whose state changed as a
+    /// result.
+    /// @param [in] controllerIdentifier Identifier of the controller whose state changed.
+    /// @param [in] newRawVirtualState New raw virtual state to be delivered.
+    static void DispatchRawVirtualControllerStateChange(
+        TControllerIdentifier controllerIdentifier, const SState& newRawVirtualState)
+    {
+      std::unique_lock lock(physicalControllerSlot[controllerIdentifier].stateChangeMutex);
+
+      // Virtual controllers with identical properties, such as those an application opens through
+      // several interfaces for the same physical controller, share the work of applying them.
+      // Those that nobody observes between reads, such as the ones behind the WinMM interface,
+      // defer the work until they are read.
+      VirtualController::SSharedRefresh sharedRefresh;
+      for (auto virtualController : physicalControllerStateChangeRegistration[controllerIdentifier])
+      {
+        if (true == virtualController->RefreshStateOrDefer(newRawVirtualState, sharedRefresh))
+          virtualController->SignalStateChangeEvent();
+      }
+
+      if (true == LiveMetrics::IsEnabled())
+      {
+        // Event buffer fill levels are read without locking the event buffers because they are
+        // only reported as an approximation.
+        uint32_t eventBufferCount = 0;
+        uint32_t eventBufferCapacity = 0;
+        for (auto virtualController :
+             physicalControllerStateChangeRegistration[controllerIdentifier])
+        {
+          if (virtualController->GetEventBufferCount() >= eventBufferCount)
+          {
+            eventBufferCount = virtualController->GetEventBufferCount();
+            eventBufferCapacity = virtualController->GetEventBufferCapacity();
+          }
+        }
+
+        LiveMetrics::RecordVirtualControllers(
+            controllerIdentifier,
+            (uint32_t)physicalControllerStateChangeRegistration[controllerIdentifier].size(),
+            eventBufferCount,
+            eventBufferCapacity);
+      }
+    }
+
+    /// Creates and returns a poll context in its initial state.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Initialized poll context.
+    static SPollContext MakePollContext(TControllerIdentifier controllerIdentifier)
+    {
+      // The generation is read before the mapper so that an invalidation that happens in between
+      // is still detected on the next poll.
+      return {
+          .mapperGeneration = physicalControllerMapperGeneration[controllerIdentifier],
+          .mapper = physicalControllerMapper[controllerIdentifier],
+          .transform = &Mapper::GetConfiguredPhysicalTransform(controllerIdentifier),
+          .incrementalMappingState = {},
+          .motion = {},
+          .motionTimestamp = 0,
+          .epochTicks = PeriodicTimer::Now()};
+    }
+
+    /// Suppresses small changes in the analog values of newly-read physical controller state, as
+    /// configured. Each stick axis and trigger whose value moved away from the previously-published
+    /// value by no more than the configured threshold keeps the previously-published value, unless
+    /// it reached either end of its range. Buttons and device status are never affected, and
+    /// neither is any state transition that involves an unsuccessful read.
+    /// @param [in] publishedState Most recently published physical controller state.
+    /// @param [in,out] newState Newly-read physical controller state, modified in place.
+    static void ApplyNoiseThreshold(const SPhysicalState& publishedState, SPhysicalState& newState)
+    {
+      const int kStickNoiseThreshold = Globals::GetSettings().properties.stickNoiseThreshold;
+      const int kTriggerNoiseThreshold = Globals::GetSettings().properties.triggerNoiseThreshold;
+
+      if ((0 == kStickNoiseThreshold) && (0 == kTriggerNoiseThreshold)) return;
+      if ((EPhysicalDeviceStatus::Ok != newState.deviceStatus) ||
+          (EPhysicalDeviceStatus::Ok != publishedState.deviceStatus))
+        return;
+
+      for (size_t i = 0; i < newState.stick.size(); ++i)
+      {
+        if ((std::numeric_limits<int16_t>::min() == newState.stick[i]) ||
+            (std::numeric_limits<int16_t>::max() == newState.stick[i]))
+          continue;
+
+        if (std::abs((int)newState.stick[i] - (int)publishedState.stick[i]) <= kStickNoiseThreshold)
+          newState.stick[i] = publishedState.stick[i];
+      }
+
+      for (size_t i = 0; i < newState.trigger.size(); ++i)
+      {
+        if ((std::numeric_limits<uint8_t>::min() == newState.trigger[i]) ||
+            (std::numeric_limits<uint8_t>::max() == newState.trigger[i]))
+          continue;
+
+        if (std::abs((int)newState.trigger[i] - (int)publishedState.trigger[i]) <=
+            kTriggerNoiseThreshold)
+          newState.trigger[i] = publishedState.trigger[i];
+      }
+    }
+
+    /// Reads physical controller state once, without processing it.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Newly-taken reading of the identified controller.
+    static SPhysicalReading ReadPhysicalController(TControllerIdentifier controllerIdentifier)
+    {
+      std::scoped_lock lock(physicalControllerSlot[controllerIdentifier].readMutex);
+
+      SPhysicalReading reading = {};
+      int64_t readingTimestamp = 0;
+
+      reading.xinputBeginTicks = PeriodicTimer::Now();
+      reading.xinputGetStateResult =
+          QueryXInputState(controllerIdentifier, reading.xinputState, readingTimestamp);
+      PollingStatistics::RecordXInputGetState(
+          controllerIdentifier, reading.xinputBeginTicks, PeriodicTimer::Now());
+
+      // If the backend knows when the hardware reading was actually taken, latency is measured
+      // from then rather than from when the query returned.
+      const int64_t xinputReturnedTicks = InputLatencyTrace::Stamp();
+      reading.latencyTicks =
+          (((0 != xinputReturnedTicks) && (0 != readingTimestamp))
+               ? std::min(readingTimestamp, xinputReturnedTicks)
+               : xinputReturnedTicks);
+
+      return reading;
+    }
+
+    /// Processes a single reading of physical controller state. On detected state change, updates
+    /// the internal data structure, delivers the new state to all registered virtual controllers,
+    /// and notifies all waiting threads. If XInput reports the same packet number as the previous
+    /// reading then the physical controller state has not changed, so no further processing is
+    /// done. Readings older than the most recently processed reading are discarded.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @param [in,out] context Poll context for the identified controller, updated as a result of
+    /// this poll.
+    /// @param [in] reading Reading of the identified controller to be processed.
+    /// @return Newly-read device status of the identified controller.
+    static EPhysicalDeviceStatus ProcessPhysicalControllerReading(
+        TControllerIdentifier controllerIdentifier,
+        SPollContext& context,
+        const SPhysicalReading& reading)
+    {
+      SPhysicalControllerSlot& controllerSlot = physicalControllerSlot[controllerIdentifier];
+
+      if (reading.xinputBeginTicks < controllerSlot.processedReadingTicks)
+      {
+        const EPhysicalDeviceStatus publishedDeviceStatus =
+            controllerSlot.physicalState.Get().deviceStatus;
+        TraceEvents::PollEnd(controllerIdentifier, publishedDeviceStatus);
+        return publishedDeviceStatus;
+      }
+
+      controllerSlot.processedReadingTicks = reading.xinputBeginTicks;
+
+      // If a different mapper was published since the previous poll, it is picked up here and used
+      // for the entirety of this poll. Before switching, the previous mapper is given the chance to
+      // withdraw any side effects it has, such as keyboard keys it is holding down. Even if the
+      // physical controller state has not changed, it needs to be mapped again using the new
+      // mapper.
+      const bool mapperChanged =
+          (physicalControllerMapperGeneration[controllerIdentifier] != context.mapperGeneration);
+      if (true == mapperChanged)
+      {
+        context.mapper->MapNeutralPhysicalToVirtual(
+            OpaqueControllerSourceIdentifier(controllerIdentifier));
+        context = MakePollContext(controllerIdentifier);
+      }
+
+      const DWORD xinputGetStateResult = reading.xinputGetStateResult;
+      const XINPUT_STATE& xinputState = reading.xinputState;
+      const int64_t xinputBeginTicks = reading.xinputBeginTicks;
+      InputLatencyTrace::SSample latencySample = {.xinputTicks = reading.latencyTicks};
+
+      // Motion is read on every successful poll, even if nothing else changed, because motion
+      // sensors report continuously and a controller that stops moving needs to be mapped as such.
+      const MotionMapper* const motionMapper = GetMotionMapper();
+      bool motionChanged = false;
+      if ((nullptr != motionMapper) && (ERROR_SUCCESS == xinputGetStateResult))
+      {
+        constexpr unsigned int kMaxMotionSamplesPerPoll = 32;
+
+        std::array<SPhysicalMotionSample, kMaxMotionSamplesPerPoll> motionSamples;
+        const unsigned int motionSampleCount =
+            GetBackend().ReadMotion(controllerIdentifier, motionSamples);
+        const SPhysicalMotion newMotion = MotionMapper::IntegrateSamples(
+            std::span(motionSamples.data(), motionSampleCount), context.motionTimestamp);
+
+        motionChanged = (newMotion != context.motion);
+        context.motion = newMotion;
+      }
+
+      // Turbo mappers change their contributions over time, so while any of them is held the state
+      // is mapped again on every poll, even if nothing else changed.
+      const bool turboHeld =
+          TurboMapper::IsAnyHeld(OpaqueControllerSourceIdentifier(controllerIdentifier));
+
+      if (ERROR_SUCCESS == xinputGetStateResult)
+      {
+        if ((false == mapperChanged) && (false == motionChanged) && (false == turboHeld) &&
+            (true == controllerSlot.packetNumberValid) &&
+            (xinputState.dwPacketNumber == controllerSlot.packetNumber))
+        {
+          TraceEvents::PollEnd(controllerIdentifier, EPhysicalDeviceStatus::Ok);
+          return EPhysicalDeviceStatus::Ok;
+        }
+
+        controllerSlot.packetNumber = xinputState.dwPacketNumber;
+        controllerSlot.packetNumberValid = true;
+      }
+      else
+      {
+        controllerSlot.packetNumberValid = false;
+      }
+
+      SPhysicalState newPhysicalState =
+          PhysicalStateFromXInputState(xinputGetStateResult, xinputState);
+      ApplyNoiseThreshold(controllerSlot.physicalState.Get(), newPhysicalState);
+
+      const bool physicalStateChanged = controllerSlot.physicalState.Update(newPhysicalState);
+      if (true == physicalStateChanged)
+        FlightRecorder::RecordPhysicalState(controllerIdentifier, newPhysicalState);
+
+      if ((true == physicalStateChanged) || (true == mapperChanged) || (true == motionChanged) ||
+          (true == turboHeld))
+      {
+        SState newRawVirtualState;
+        const int64_t mappingBeginTicks = PeriodicTimer::Now();
+
+        TurboMapper::SetMappingTimestamp(
+            OpaqueControllerSourceIdentifier(controllerIdentifier),
+            PeriodicTimer::MicrosecondsFromTicks(xinputBeginTicks - context.epochTicks));
+
+        if (EPhysicalDeviceStatus::Ok != newPhysicalState.deviceStatus)
+        {
+          context.incrementalMappingState.Reset();
+          newRawVirtualState = context.mapper->MapNeutralPhysicalToVirtual(
+              OpaqueControllerSourceIdentifier(controllerIdentifier));
+
+          if (nullptr != motionMapper)
+          {
+            context.motion = {};
+            context.motionTimestamp = 0;
+            motionMapper->ContributeNeutral(
+                newRawVirtualState, OpaqueControllerSourceIdentifier(controllerIdentifier));
+          }
+        }
+        else if (true == IsIncrementalMappingEnabled())
+        {
+          // Held turbo mappers must be invoked even though their physical controller elements did
+          // not change, which incremental mapping would otherwise skip.
+          if (true == turboHeld) context.incrementalMappingState.Reset();
+
+          newRawVirtualState = context.mapper->MapStatePhysicalToVirtualIncremental(
+              newPhysicalState,
+              *context.transform,
+              OpaqueControllerSourceIdentifier(controllerIdentifier),
+              context.incrementalMappingState);
+        }
+        else
+        {
+          newRawVirtualState = context.mapper->MapStatePhysicalToVirtual(
+              newPhysicalState,
+              *context.transform,
+              OpaqueControllerSourceIdentifier(controllerIdentifier));
+        }
+
+        if ((nullptr != motionMapper) &&
+            (EPhysicalDeviceStatus::Ok == newPhysicalState.deviceStatus))
+          motionMapper->ContributeFromMotion(
+              newRawVirtualState,
+              context.motion,
+              OpaqueControllerSourceIdentifier(controllerIdentifier));
+
+        PollingStatistics::RecordMapping(
+            controllerIdentifier, mappingBeginTicks, PeriodicTimer::Now());
+        latencySample.mappedTicks = InputLatencyTrace::Stamp();
+
+        if (true == controllerSlot.rawVirtualState.Update(newRawVirtualState))
+        {
+          latencySample.publishedTicks = InputLatencyTrace::Stamp();
+          TraceEvents::StatePublished(controllerIdentifier);
+          DispatchRawVirtualControllerStateChange(controllerIdentifier, newRawVirtualState);
+          latencySample.deliveredTicks = InputLatencyTrace::Stamp();
+
+          InputLatencyTrace::SubmitSample(controllerIdentifier, latencySample);
+        }
+
+        NotifyStateChangeSubscribers(
+            controllerIdentifier, ExportControllerState(controllerIdentifier), xinputBeginTicks);
+      }
+
+      TraceEvents::PollEnd(controllerIdentifier, newPhysicalState.deviceStatus);
+      return newPhysicalState.deviceStatus;
+    }
+
+    /// Polls for physical controller state once by reading it and then immediately processing the
+    /// reading.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @param [in,out] context Poll context for the identified controller, updated as a result of
+    /// this poll.
+    /// @return Newly-read device status of the identified controller.
+    static EPhysicalDeviceStatus PollForPhysicalControllerStateOnce(
+        TControllerIdentifier controllerIdentifier, SPollContext& context)
+    {
+      TraceEvents::PollBegin(controllerIdentifier);
+      return ProcessPhysicalControllerReading(
+          controllerIdentifier, context, ReadPhysicalController(controllerIdentifier));
+    }
+
+    /// Determines if the specified physical controller was polled too recently for an on-demand
+    /// poll to be worthwhile.
+    /// @param [in] controllerIdentifier Identifier of the controller of interest.
+    /// @param [in] now Current time, in steady clock ticks since its epoch.
+    /// @return `true` if the most recent poll happened within the on-demand poll minimum interval,
+    /// `false` otherwise.
+    static inline bool WasPolledRecently(
+        TControllerIdentifier controllerIdentifier, std::chrono::steady_clock::rep now)
+    {
+      constexpr std::chrono::steady_clock::rep kMinimumIntervalTicks =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::milliseconds(kPhysicalOnDemandPollMinimumIntervalMilliseconds))
+              .count();
+
+      return (
+          (now - physicalControllerSlot[controllerIdentifier].lastPollTime.load(
+                     std::memory_order_relaxed)) < kMinimumIntervalTicks);
+    }
+
+    /// Polls for physical controller state once using the shared poll context for the identified
+    /// physical controller. Intended to be invoked by threads that periodically poll physical
+    /// controllers.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Newly-read device status of the identified controller.
+    static EPhysicalDeviceStatus PollForPhysicalControllerStateOnce(
+        TControllerIdentifier controllerIdentifier)
+    {
+      std::scoped_lock lock(physicalControllerSlot[controllerIdentifier].pollMutex);
+
+      physicalControllerSlot[controllerIdentifier].lastPollTime.store(
+          std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+      const EPhysicalDeviceStatus deviceStatus = PollForPhysicalControllerStateOnce(
+          controllerIdentifier, physicalControllerSlot[controllerIdentifier].pollContext);
+
+      RecordPhysicalControllerConnection(controllerIdentifier, deviceStatus);
+      return deviceStatus;
+    }
+
+    /// Reads physical controller state once and publishes the reading for the mapping thread of
+    /// the identified controller to process. Intended to be invoked only by the polling thread of
+    /// the identified controller when pipelined polling is enabled.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Device status indicated by the newly-taken reading.
+    static EPhysicalDeviceStatus PublishPhysicalControllerReading(
+        TControllerIdentifier controllerIdentifier)
+    {
+      SPhysicalReadingRing& readingRing = physicalReadingRing[controllerIdentifier];
+      const SPhysicalReading reading = ReadPhysicalController(controllerIdentifier);
+
+      const uint64_t publishedCount = readingRing.publishedCount.load(std::memory_order_relaxed);
+      readingRing.readings[publishedCount % SPhysicalReadingRing::kCapacity].Set(reading);
+      readingRing.publishedCount.store(publishedCount + 1, std::memory_order_release);
+      readingRing.publishedCount.notify_one();
+
+      return PhysicalStateFromXInputState(reading.xinputGetStateResult, reading.xinputState)
+          .deviceStatus;
+    }
+
+    /// Processes the most recent reading of physical controller state whenever the polling thread
+    /// publishes a new one. Readings published while the previous reading is still being processed
+    /// are skipped in favor of the most recent, so mapping never delays reading. Intended to be a
+    /// thread entry point, one thread per physical controller, only when pipelined polling is
+    /// enabled.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    static void MapPhysicalControllerReadings(TControllerIdentifier controllerIdentifier)
+    {
+      SPhysicalControllerSlot& controllerSlot = physicalControllerSlot[controllerIdentifier];
+      SPhysicalReadingRing& readingRing = physicalReadingRing[controllerIdentifier];
+      uint64_t consumedCount = readingRing.publishedCount.load(std::memory_order_acquire);
+
+      while (true)
+      {
+        readingRing.publishedCount.wait(consumedCount, std::memory_order_acquire);
+        consumedCount = readingRing.publishedCount.load(std::memory_order_acquire);
+
+        const SPhysicalReading reading =
+            readingRing.readings[(consumedCount - 1) % SPhysicalReadingRing::kCapacity].Get();
+
+        EPhysicalDeviceStatus deviceStatus = EPhysicalDeviceStatus::Ok;
+        {
+          std::scoped_lock lock(controllerSlot.pollMutex);
+
+          controllerSlot.lastPollTime.store(
+              std::chrono::steady_clock::now().time_since_epoch().count(),
+              std::memory_order_relaxed);
+          TraceEvents::PollBegin(controllerIdentifier);
+          deviceStatus = ProcessPhysicalControllerReading(
+              controllerIdentifier, controllerSlot.pollContext, reading);
+        }
+
+        RecordPhysicalControllerConnection(controllerIdentifier, deviceStatus);
+      }
+    }
+
+    static void OnBackendReport(TControllerIdentifier controllerIdentifier)
+    {
+      // Reports can arrive while initialization is still creating the poll contexts, in which
+      // case they are dropped. Regular polling picks up the state shortly afterwards.
+      if (false == backendReportsEnabled.load(std::memory_order_acquire)) return;
+      if (false == IsPhysicalControllerEnabled(controllerIdentifier)) return;
+
+      PollForPhysicalControllerStateOnce(controllerIdentifier);
+    }
+
+    /// Adjusts the schedule of a polling timer so that a poll lands shortly before each expected
+    /// application read. The polling period is stretched so that it divides the application's read
+    /// period evenly, which means polling never happens more often than configured, and then the
+    /// phase is gradually moved towards the target. Without enough information about application
+    /// reads, the configured polling period is restored.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @param [in,out] pollingTimer Timer that governs polling of the identified controller.
+    /// @param [in] configuredPeriodTicks Configured polling period, in performance counter ticks.
+    static void AlignPollingToApplicationReads(
+        TControllerIdentifier controllerIdentifier,
+        PeriodicTimer& pollingTimer,
+        int64_t configuredPeriodTicks)
+    {
+      // Polls are targeted to complete this far ahead of the expected application read.
+      constexpr int64_t kPollLeadMicroseconds = 1000;
+
+      // Reads are considered to have stopped if none happen for this many read periods.
+      constexpr int64_t kStaleReadPeriods = 4;
+
+      // Only this fraction of the phase error is corrected per poll, which filters out jitter in
+      // application read times.
+      constexpr int64_t kPhaseCorrectionDivisor = 4;
+
+      const SApplicationReadTiming& readTiming =
+          physicalControllerSlot[controllerIdentifier].applicationReadTiming;
+      const int64_t readPeriod = readTiming.averageReadPeriod.load(std::memory_order_relaxed);
+      const int64_t lastReadTime = readTiming.lastReadTime.load(std::memory_order_relaxed);
+      const int64_t nextDeadline = pollingTimer.GetNextDeadline();
+
+      if ((0 == readPeriod) || (0 == nextDeadline) ||
+          ((PeriodicTimer::Now() - lastReadTime) > (kStaleReadPeriods * readPeriod)))
+      {
+        pollingTimer.SetPeriodTicks(configuredPeriodTicks);
+        return;
+      }
+
+      const int64_t pollsPerRead = std::max<int64_t>(1, readPeriod / configuredPeriodTicks);
+      const int64_t pollPeriod = readPeriod / pollsPerRead;
+      pollingTimer.SetPeriodTicks(pollPeriod);
+
+      const int64_t targetPollTime =
+          lastReadTime + readPeriod - PeriodicTimer::TicksFromMicroseconds(kPollLeadMicroseconds);
+      int64_t phaseError = (targetPollTime - nextDeadline) % pollPeriod;
+      if (phaseError >= (pollPeriod / 2))
+        phaseError -= pollPeriod;
+      else if (phaseError < -(pollPeriod / 2))
+        phaseError += pollPeriod;
+
+      pollingTimer.ShiftNextDeadline(phaseError / kPhaseCorrectionDivisor);
+    }
+
+    /// Periodically polls for physical controller state. Intended to be a thread entry point, one
+    /// thread per physical controller. If pipelined polling is enabled, each poll only reads the
+    /// physical controller and leaves processing the reading to the mapping thread.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    static void PollForPhysicalControllerStateChanges(TControllerIdentifier controllerIdentifier)
+    {
+      const bool isPipelined = IsPipelinedPollingEnabled();
+      EPhysicalDeviceStatus deviceStatus =
+          physicalControllerSlot[controllerIdentifier].physicalState.Get().deviceStatus;
+
+      // If the high-resolution polling engine is disabled, the timer object is still used to
+      // schedule polls against fixed deadlines, but it is backed by a standard waitable timer whose
+      // accuracy is limited by the system timer resolution.
+      unsigned int pollingPeriodMilliseconds =
+          EffectivePollingPeriodMilliseconds(controllerIdentifier);
+      PeriodicTimer pollingTimer(pollingPeriodMilliseconds, IsHighResolutionPollingEnabled());
+      int64_t configuredPollingPeriodTicks = pollingTimer.GetPeriodTicks();
+      PollingStatistics::RecordTimerConfiguration(
+          controllerIdentifier, configuredPollingPeriodTicks, pollingTimer.IsHighResolution());
+
+      // Intervals between polls are only meaningful while polls follow the timer's schedule.
+      int64_t previousScheduledPollTicks = 0;
+
+      unsigned int disconnectedBackoffMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+      uint64_t lastDeviceArrivalCount = deviceArrivalCount;
+
+      while (true)
+      {
+        switch (deviceStatus)
+        {
+          case EPhysicalDeviceStatus::Ok:
+          {
+            if (true == WaitWhileInBackground())
+            {
+              pollingTimer.Reset();
+              previousScheduledPollTicks = 0;
+              break;
+            }
+
+            // Applications can request a different polling period at any time, in which case the
+            // new period takes effect starting with the next deadline.
+            const unsigned int kEffectivePollingPeriodMilliseconds =
+                EffectivePollingPeriodMilliseconds(controllerIdentifier);
+            if (kEffectivePollingPeriodMilliseconds != pollingPeriodMilliseconds)
+            {
+              pollingPeriodMilliseconds = kEffectivePollingPeriodMilliseconds;
+              pollingTimer.SetPeriodMilliseconds(pollingPeriodMilliseconds);
+              configuredPollingPeriodTicks = pollingTimer.GetPeriodTicks();
+              PollingStatistics::RecordTimerConfiguration(
+                  controllerIdentifier,
+                  configuredPollingPeriodTicks,
+                  pollingTimer.IsHighResolution());
+            }
+
+            if (true == IsPollingAlignmentEnabled())
+              AlignPollingToApplicationReads(
+                  controllerIdentifier, pollingTimer, configuredPollingPeriodTicks);
+
+            const unsigned int skippedPeriods = pollingTimer.WaitForNextPeriod();
+            const int64_t scheduledPollTicks = PeriodicTimer::Now();
+            PollingStatistics::RecordScheduledPoll(
+                controllerIdentifier,
+                scheduledPollTicks,
+                previousScheduledPollTicks,
+                skippedPeriods);
+            previousScheduledPollTicks = scheduledPollTicks;
+
+            disconnectedBackoffMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+            break;
+          }
+
+          case EPhysicalDeviceStatus::NotConnected:
+            // Querying an empty slot can be expensive, so the wait time grows for as long as the
+            // slot remains empty. A device arrival notification restarts the back-off sequence.
+            if (true ==
+                WaitForDeviceArrival(lastDeviceArrivalCount, disconnectedBackoffMilliseconds))
+              disconnectedBackoffMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+            else
+              disconnectedBackoffMilliseconds = NextDisconnectedBackoffPeriod(
+                  disconnectedBackoffMilliseconds, kPhysicalDisconnectedBackoffMaximumMilliseconds);
+            pollingTimer.Reset();
+            previousScheduledPollTicks = 0;
+            break;
+
+          default:
+            Sleep(kPhysicalErrorBackoffPeriodMilliseconds);
+            pollingTimer.Reset();
+            previousScheduledPollTicks = 0;
+            break;
+        }
+
+        deviceStatus =
+            ((true == isPipelined) ? PublishPhysicalControllerReading(controllerIdentifier)
+                                   : PollForPhysicalControllerStateOnce(controllerIdentifier));
+      }
+    }
+
+    /// Outputs log messages that describe a change in physical controller status, such as hardware
+    /// connection or disconnection and error conditions.
+    /// @param [in] controllerIdentifier Identifier of the controller whose status changed.
+    /// @param [in] oldDeviceStatus Previously-known device status of the controller.
+    /// @param [in] newDeviceStatus Newly-observed device status of the controller.
+    static void LogPhysicalControllerStatusChange(
+        TControllerIdentifier controllerIdentifier,
+        EPhysicalDeviceStatus oldDeviceStatus,
+        EPhysicalDeviceStatus newDeviceStatus)
+    {
+      switch (newDeviceStatus)
+      {
+        case EPhysicalDeviceStatus::Ok:
+          switch (oldDeviceStatus)
+          {
+            case EPhysicalDeviceStatus::Ok:
+              break;
+
+            case EPhysicalDeviceStatus::NotConnected:
+              Infra::Message::OutputFormatted(
+                  Infra::Message::ESeverity::Info,
+                  L"Physical controller %u: Hardware connected.",
+                  (1 + controllerIdentifier));
+              break;
+
+            default:
+              Infra::Message::OutputFormatted(
+                  Infra::Message::ESeverity::Warning,
+                  L"Physical controller %u: Cleared previous error condition.",
+                  (1 + controllerIdentifier));
+              break;
+          }
+          break;
+
+        case EPhysicalDeviceStatus::NotConnected:
+          if (newDeviceStatus != oldDeviceStatus)
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Info,
+                L"Physical controller %u: Hardware disconnected.",
+                (1 + controllerIdentifier));
+          break;
+
+        default:
+          if (newDeviceStatus != oldDeviceStatus)
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Warning,
+                L"Physical controller %u: Encountered an error condition.",
+                (1 + controllerIdentifier));
+          break;
+      }
+    }
+
+    /// Determines whether or not any of the messages that describe a change in physical controller
+    /// status would actually be delivered as output. Connection and disconnection are logged as
+    /// informational messages, whereas error conditions are logged as warnings.
+    /// @return `true` if status changes should be logged, `false` otherwise.
+    static bool ShouldLogPhysicalControllerStatusChanges(void)
+    {
+      return (
+          Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Info) ||
+          Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Warning));
+    }
+
+    /// Retrieves the time between queries of physical controller battery and capabilities
+    /// information, which can be customized in the configuration file.
+    /// @return Controller status query period in seconds, or 0 if queries are disabled.
+    static unsigned int GetControllerStatusPeriodSeconds(void)
+    {
+      return Globals::GetSettings().properties.controllerStatusPeriodSeconds;
+    }
+
+    /// Queries battery and capabilities information for a single physical controller and caches
+    /// the results. Querying a physical controller that is not connected can be expensive, so no
+    /// queries are issued for those.
+    /// @param [in] controllerIdentifier Identifier of the physical controller to query.
+    /// @param [in] isConnected Whether or not the physical controller is connected.
+    static void QueryPhysicalControllerStatus(
+        TControllerIdentifier controllerIdentifier, bool isConnected)
+    {
+      Api::IControllerStatus::SControllerStatus status = {
+          .queryTimeMilliseconds = GetTickCount64(), .isConnected = isConnected};
+
+      if (true == isConnected)
+      {
+        XINPUT_CAPABILITIES capabilities = {};
+        if (ERROR_SUCCESS ==
+            ImportApiXInput::XInputGetCapabilities(
+                (DWORD)controllerIdentifier, 0, &capabilities))
+        {
+          status.hasCapabilities = true;
+          status.type = capabilities.Type;
+          status.subType = capabilities.SubType;
+          status.flags = capabilities.Flags;
+        }
+
+        XINPUT_BATTERY_INFORMATION batteryInformation = {};
+        if (ERROR_SUCCESS ==
+            ImportApiXInput::XInputGetBatteryInformation(
+                (DWORD)controllerIdentifier, BATTERY_DEVTYPE_GAMEPAD, &batteryInformation))
+        {
+          status.hasBatteryInformation = true;
+          status.batteryType = batteryInformation.BatteryType;
+          status.batteryLevel = batteryInformation.BatteryLevel;
+        }
+      }
+
+      physicalControllerStatus[controllerIdentifier].Set(status);
+    }
+
+    /// Periodically queries battery and capabilities information for all physical controllers,
+    /// and additionally queries each physical controller as soon as it is connected. Intended to
+    /// be a thread entry point.
+    static void ServiceControllerStatus(void)
+    {
+      const std::chrono::seconds kQueryPeriod(GetControllerStatusPeriodSeconds());
+      const TControllerIdentifier kControllerCount = GetPhysicalControllerCount();
+
+      uint32_t queriedConnectedMask = 0;
+      bool isPeriodicQuery = true;
+
+      while (true)
+      {
+        // Periodic queries cover all physical controllers, whereas queries that result from
+        // connection changes only cover the physical controllers whose connection changed.
+        const uint32_t connectedMask =
+            connectedPhysicalControllerMask.load(std::memory_order_relaxed);
+        const uint32_t changedMask = (connectedMask ^ queriedConnectedMask);
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kControllerCount;
+             ++controllerIdentifier)
+        {
+          const uint32_t controllerBit = ((uint32_t)1 << controllerIdentifier);
+
+          if (false == IsPhysicalControllerEnabled(controllerIdentifier)) continue;
+          if ((false == isPeriodicQuery) && (0 == (changedMask & controllerBit))) continue;
+
+          QueryPhysicalControllerStatus(
+              controllerIdentifier, (0 != (connectedMask & controllerBit)));
+        }
+
+        queriedConnectedMask = connectedMask;
+
+        std::unique_lock lock(controllerStatusServiceMutex);
+        isPeriodicQuery = (false ==
+                           controllerStatusServiceCondition.wait_for(
+                               lock,
+                               kQueryPeriod,
+                               [queriedConnectedMask]() -> bool
+                               {
+                                 return (
+                                     connectedPhysicalControllerMask.load(
+                                         std::memory_order_relaxed) != queriedConnectedMask);
+                               }));
+      }
+    }
+
+    /// Monitors physical controller status for events like hardware connection or disconnection and
+    /// error conditions. Used exclusively for logging. Intended to be a thread entry point, one
     /// thread per monitored physical controller.
     /// @param [in] controllerIdentifier Identifier of the controller to monitor.
     static void MonitorPhysicalControllerStatus(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetPhysicalControllerCount())
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Attempted to monitor physical controller with invalid identifier %u.",
+            controllerIdentifier);
+        return;
+      }
+
+      SPhysicalState oldPhysicalState = GetCurrentPhysicalControllerState(controllerIdentifier);
+      SPhysicalState newPhysicalState = oldPhysicalState;
+
+      while (true)
+      {
+        WaitForPhysicalControllerStateChange(
+            controllerIdentifier, newPhysicalState, std::stop_token());
+        LogPhysicalControllerStatusChange(
+            controllerIdentifier, oldPhysicalState.deviceStatus, newPhysicalState.deviceStatus);
+        oldPhysicalState = newPhysicalState;
+      }
+    }
+
+    /// Services all physical controllers from a single thread. Each tick polls every connected
+    /// physical controller, polls disconnected or faulted physical controllers on a slower back-off
+    /// cadence, drives force feedback actuation, and logs physical controller status changes.
+    /// Intended to be a thread entry point, replacing all of the per-controller polling, force
+    /// feedback, and status monitoring threads.
+    static void ServiceAllPhysicalControllers(void)
+    {
+      /// Per-controller state maintained by the scheduler between ticks.
+      struct SSchedulerSlot
+      {
+        /// Device status observed during the most recent poll.
+        EPhysicalDeviceStatus lastDeviceStatus;
+
+        /// Force feedback actuation context.
+        SForceFeedbackActuationContext forceFeedbackContext;
+
+        /// Number of ticks remaining until the next poll, used only while in back-off.
+        unsigned int pollTicksRemaining;
+
+        /// Current back-off period, in ticks, used while the physical controller is disconnected.
+        unsigned int disconnectedBackoffTicks;
+
+        /// Number of ticks remaining until the next force feedback actuation pass.
+        unsigned int forceFeedbackTicksRemaining;
+      };
+
+      const unsigned int kTickPeriodMilliseconds = GetPollingPeriodMilliseconds();
+      const unsigned int kBackoffTicks =
+          std::max(1u, kPhysicalErrorBackoffPeriodMilliseconds / kTickPeriodMilliseconds);
+      const unsigned int kDisconnectedBackoffMaximumTicks =
+          std::max(1u, kPhysicalDisconnectedBackoffMaximumMilliseconds / kTickPeriodMilliseconds);
+      const unsigned int kForceFeedbackTicks =
+          std::max(1u, GetForceFeedbackPeriodMilliseconds() / kTickPeriodMilliseconds);
+      const bool kShouldLogStatusChanges = ShouldLogPhysicalControllerStatusChanges();
+
+      const TControllerIdentifier kControllerCount = GetPhysicalControllerCount();
+
+      SSchedulerSlot slots[kMaxPhysicalControllerCount];
+      for (TControllerIdentifier controllerIdentifier = 0;
+           controllerIdentifier < kControllerCount;
+           ++controllerIdentifier)
+      {
+        slots[controllerIdentifier] = {
+            .lastDeviceStatus =
+                physicalControllerSlot[controllerIdentifier].physicalState.Get().deviceStatus,
+            .forceFeedbackContext = MakeForceFeedbackActuationContext(controllerIdentifier),
+            .pollTicksRemaining = kBackoffTicks,
+            .disconnectedBackoffTicks = kBackoffTicks,
+            .forceFeedbackTicksRemaining = kForceFeedbackTicks};
+      }
+
+      PeriodicTimer tickTimer(kTickPeriodMilliseconds, IsHighResolutionPollingEnabled());
+      uint64_t lastDeviceArrivalCount = deviceArrivalCount;
+      bool allActuatorsAtRest = true;
+
+      while (true)
+      {
+        // While in the background the scheduler runs at the background polling rate for all
+        // physical controllers, including force feedback, whose output is zero without input
+        // focus anyway. That only happens once all physical actuators have been brought to rest so
+        // that no physical controller is left vibrating.
+        if ((true == allActuatorsAtRest) && (true == WaitWhileInBackground()))
+          tickTimer.Reset();
+        else
+          tickTimer.WaitForNextPeriod();
+
+        // A device arrival notification means that new hardware might be available, so all
+        // disconnected physical controllers are polled immediately and their back-off restarts.
+        const uint64_t currentDeviceArrivalCount = deviceArrivalCount;
+        const bool deviceArrived = (currentDeviceArrivalCount != lastDeviceArrivalCount);
+        lastDeviceArrivalCount = currentDeviceArrivalCount;
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kControllerCount;
+             ++controllerIdentifier)
+        {
+          if (false == IsPhysicalControllerEnabled(controllerIdentifier)) continue;
+
+          SSchedulerSlot& slot = slots[controllerIdentifier];
+
+          // Connected physical controllers are polled every tick. All others are polled only once
+          // their back-off period elapses, which keeps the cost of empty slots low.
+          bool shouldPoll = true;
+          if (EPhysicalDeviceStatus::Ok != slot.lastDeviceStatus)
+          {
+            if ((true == deviceArrived) &&
+                (EPhysicalDeviceStatus::NotConnected == slot.lastDeviceStatus))
+            {
+              slot.disconnectedBackoffTicks = kBackoffTicks;
+              slot.pollTicksRemaining = 0;
+            }
+            else
+            {
+              slot.pollTicksRemaining -= 1;
+            }
+
+            shouldPoll = (0 == slot.pollTicksRemaining);
+          }
+
+          if (true == shouldPoll)
+          {
+            const EPhysicalDeviceStatus newDeviceStatus =
+                PollForPhysicalControllerStateOnce(controllerIdentifier);
+
+            if ((true == kShouldLogStatusChanges) && (newDeviceStatus != slot.lastDeviceStatus))
+              LogPhysicalControllerStatusChange(
+                  controllerIdentifier, slot.lastDeviceStatus, newDeviceStatus);
+
+            switch (newDeviceStatus)
+            {
+              case EPhysicalDeviceStatus::Ok:
+                slot.disconnectedBackoffTicks = kBackoffTicks;
+                break;
+
+              case EPhysicalDeviceStatus::NotConnected:
+                // Querying an empty slot can be expensive, so the wait time grows for as long as
+                // the slot remains empty.
+                slot.pollTicksRemaining = slot.disconnectedBackoffTicks;
+                slot.disconnectedBackoffTicks = NextDisconnectedBackoffPeriod(
+                    slot.disconnectedBackoffTicks, kDisconnectedBackoffMaximumTicks);
+                break;
+
+              default:
+                slot.pollTicksRemaining = kBackoffTicks;
+                break;
+            }
+
+            slot.lastDeviceStatus = newDeviceStatus;
+          }
+        }
+
+        // Effects for all physical controllers due for an actuation pass are evaluated together,
+        // which keeps effect code and data hot, and only then are the physical actuators written,
+        // and only for those physical controllers whose output changed.
+        std::optional<ForceFeedback::SPhysicalActuatorComponents>
+            pendingActuatorValues[kMaxPhysicalControllerCount];
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kControllerCount;
+             ++controllerIdentifier)
+        {
+          SSchedulerSlot& slot = slots[controllerIdentifier];
+
+          slot.forceFeedbackTicksRemaining -= 1;
+          if (0 != slot.forceFeedbackTicksRemaining) continue;
+
+          pendingActuatorValues[controllerIdentifier] =
+              ForceFeedbackEvaluateEffects(controllerIdentifier, slot.forceFeedbackContext);
+          slot.forceFeedbackTicksRemaining = kForceFeedbackTicks;
+        }
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kControllerCount;
+             ++controllerIdentifier)
+        {
+          if (false == pendingActuatorValues[controllerIdentifier].has_value()) continue;
+
+          SSchedulerSlot& slot = slots[controllerIdentifier];
+          if (false ==
+              ForceFeedbackWriteActuators(
+                  controllerIdentifier,
+                  slot.forceFeedbackContext,
+                  *pendingActuatorValues[controllerIdentifier]))
+            slot.forceFeedbackTicksRemaining = kBackoffTicks;
+        }
+
+        allActuatorsAtRest = true;
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kControllerCount;
+             ++controllerIdentifier)
+        {
+          if (ForceFeedback::SPhysicalActuatorComponents() !=
+              slots[controllerIdentifier].forceFeedbackContext.previousPhysicalActuatorValues)
+          {
+            allActuatorsAtRest = false;
+            break;
+          }
+        }
+      }
+    }
+
+    /// Per-controller state maintained between invocations of cooperative servicing. All fields
+    /// other than the last application service time are guarded by the mutex.
+    struct SCooperativeServiceSlot
+    {
+      /// Ensures only one thread at a time services the physical controller. Other threads do not
+      /// wait, since whichever thread holds it is already doing the same work.
+      std::mutex mutex;
+
+      /// System time, in milliseconds, at which the application most recently requested service.
+      std::atomic<DWORD> lastApplicationServiceTime;
+
+      /// Whether or not the remaining fields have been initialized.
+      bool isInitialized;
+
+      /// Device status observed during the most recent poll.
+      EPhysicalDeviceStatus lastDeviceStatus;
+
+      /// System time, in milliseconds, of the most recent poll.
+      DWORD lastPollTime;
+
+      /// Number of milliseconds that must elapse after the most recent poll before the next one.
+      unsigned int pollIntervalMilliseconds;
+
+      /// Current back-off period, in milliseconds, used while the physical controller is
+      /// disconnected.
+      unsigned int disconnectedBackoffMilliseconds;
+
+      /// Device arrival notification count observed during the most recent poll.
+      uint64_t lastDeviceArrivalCount;
+
+      /// System time, in milliseconds, of the most recent force feedback actuation pass.
+      DWORD lastForceFeedbackTime;
+
+      /// Number of milliseconds that must elapse after the most recent force feedback actuation
+      /// pass before the next one.
+      unsigned int forceFeedbackIntervalMilliseconds;
+
+      /// Force feedback actuation context.
+      SForceFeedbackActuationContext forceFeedbackContext;
+    };
+
+    /// Cooperative servicing state for each of the possible physical controllers.
+    static SCooperativeServiceSlot cooperativeServiceSlot[kMaxPhysicalControllerCount];
+
+    /// Services the specified physical controller cooperatively on the calling thread, doing
+    /// whatever polling and force feedback actuation work has become due. Does nothing if another
+    /// thread is already servicing the same physical controller.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    static void ServicePhysicalControllerCooperativelyOnce(
+        TControllerIdentifier controllerIdentifier)
+    {
+      SCooperativeServiceSlot& slot = cooperativeServiceSlot[controllerIdentifier];
+
+      std::unique_lock lock(slot.mutex, std::try_to_lock);
+      if (false == lock.owns_lock()) return;
+
+      const DWORD now = ImportApiWinMM::timeGetTime();
+
+      if (false == slot.isInitialized)
+      {
+        slot.lastDeviceStatus =
+            physicalControllerSlot[controllerIdentifier].physicalState.Get().deviceStatus;
+        slot.lastPollTime = now;
+        slot.pollIntervalMilliseconds = 0;
+        slot.disconnectedBackoffMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+        slot.lastDeviceArrivalCount = deviceArrivalCount;
+        slot.lastForceFeedbackTime = now;
+        slot.forceFeedbackIntervalMilliseconds = 0;
+        slot.forceFeedbackContext = MakeForceFeedbackActuationContext(controllerIdentifier);
+        slot.isInitialized = true;
+      }
+
+      // A device arrival notification means that new hardware might be available, so a
+      // disconnected physical controller is polled immediately and its back-off restarts.
+      const uint64_t currentDeviceArrivalCount = deviceArrivalCount;
+      if ((currentDeviceArrivalCount != slot.lastDeviceArrivalCount) &&
+          (EPhysicalDeviceStatus::NotConnected == slot.lastDeviceStatus))
+      {
+        slot.disconnectedBackoffMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+        slot.pollIntervalMilliseconds = 0;
+      }
+      slot.lastDeviceArrivalCount = currentDeviceArrivalCount;
+
+      if ((now - slot.lastPollTime) >= slot.pollIntervalMilliseconds)
+      {
+        const EPhysicalDeviceStatus newDeviceStatus =
+            PollForPhysicalControllerStateOnce(controllerIdentifier);
+
+        if ((newDeviceStatus != slot.lastDeviceStatus) &&
+            (true == ShouldLogPhysicalControllerStatusChanges()))
+          LogPhysicalControllerStatusChange(
+              controllerIdentifier, slot.lastDeviceStatus, newDeviceStatus);
+
+        switch (newDeviceStatus)
+        {
+          case EPhysicalDeviceStatus::Ok:
+            slot.pollIntervalMilliseconds =
+                EffectivePollingPeriodMilliseconds(controllerIdentifier);
+            slot.disconnectedBackoffMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+            break;
+
+          case EPhysicalDeviceStatus::NotConnected:
+            // Querying an empty slot can be expensive, so the wait time grows for as long as the
+            // slot remains empty.
+            slot.pollIntervalMilliseconds = slot.disconnectedBackoffMilliseconds;
+            slot.disconnectedBackoffMilliseconds = NextDisconnectedBackoffPeriod(
+                slot.disconnectedBackoffMilliseconds,
+                kPhysicalDisconnectedBackoffMaximumMilliseconds);
+            break;
+
+          default:
+            slot.pollIntervalMilliseconds = kPhysicalErrorBackoffPeriodMilliseconds;
+            break;
+        }
+
+        slot.lastDeviceStatus = newDeviceStatus;
+        slot.lastPollTime = now;
+      }
+
+      if ((now - slot.lastForceFeedbackTime) >= slot.forceFeedbackIntervalMilliseconds)
       {
-        Infra::Message::OutputFormatted(
-            Infra::Message::ESeverity::Error,
-            L"Attempted to monitor physical controller with invalid identifier %u.",
-            controllerIdentifier);
-        return;
+        const bool actuationResult =
+            ForceFeedbackActuateEffectsOnce(controllerIdentifier, slot.forceFeedbackContext);
+        slot.forceFeedbackIntervalMilliseconds =
+            ((true == actuationResult) ? GetForceFeedbackPeriodMilliseconds()
+                                       : kPhysicalErrorBackoffPeriodMilliseconds);
+        slot.lastForceFeedbackTime = now;
       }
+    }
 
-      SPhysicalState oldPhysicalState = GetCurrentPhysicalControllerState(controllerIdentifier);
-      SPhysicalState newPhysicalState = oldPhysicalState;
+    /// Services physical controllers that the application has stopped servicing in cooperative
+    /// mode, for example because it stops reading state while paused or while in a menu. Without
+    /// this, force feedback effects would never stop and keyboard and mouse contributions would
+    /// never be released. Intended to be a thread entry point. The thread spends nearly all of its
+    /// time sleeping.
+    static void WatchCooperativeService(void)
+    {
+      const TControllerIdentifier kControllerCount = GetPhysicalControllerCount();
 
       while (true)
       {
-        WaitForPhysicalControllerStateChange(
-            controllerIdentifier, newPhysicalState, std::stop_token());
+        Sleep(kPhysicalCooperativeWatchdogPeriodMilliseconds);
 
-        // Look for status changes and output to the log, as appropriate.
-        switch (newPhysicalState.deviceStatus)
+        const DWORD now = ImportApiWinMM::timeGetTime();
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kControllerCount;
+             ++controllerIdentifier)
         {
-          case EPhysicalDeviceStatus::Ok:
-            switch (oldPhysicalState.deviceStatus)
-            {
-              case EPhysicalDeviceStatus::Ok:
-                break;
+          if (false == IsPhysicalControllerEnabled(controllerIdentifier)) continue;
 
-              case EPhysicalDeviceStatus::NotConnected:
-                Infra::Message::OutputFormatted(
-                    Infra::Message::ESeverity::Info,
-                    L"Physical controller %u: Hardware connected.",
-                    (1 + controllerIdentifier));
-                break;
+          if ((now -
+               cooperativeServiceSlot[controllerIdentifier].lastApplicationServiceTime.load(
+                   std::memory_order_relaxed)) >= kPhysicalCooperativeWatchdogPeriodMilliseconds)
+            ServicePhysicalControllerCooperativelyOnce(controllerIdentifier);
+        }
+      }
+    }
 
-              default:
-                Infra::Message::OutputFormatted(
-                    Infra::Message::ESeverity::Warning,
-                    L"Physical controller %u: Cleared previous error condition.",
-                    (1 + controllerIdentifier));
-                break;
-            }
-            break;
+    /// Creates the force feedback device buffer for the specified physical controller and starts
+    /// the work needed to actuate its effects. If all physical controllers are serviced by a single
+    /// scheduler thread then that thread picks up the new device buffer on its own. Caller must
+    /// hold the force feedback registration mutex for the specified physical controller.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Pointer to the newly-created device buffer object.
+    static ForceFeedback::Device* CreateForceFeedbackDevice(
+        TControllerIdentifier controllerIdentifier)
+    {
+      ForceFeedback::Device* const forceFeedbackDevice = new ForceFeedback::Device();
 
-          case EPhysicalDeviceStatus::NotConnected:
-            if (newPhysicalState.deviceStatus != oldPhysicalState.deviceStatus)
-              Infra::Message::OutputFormatted(
-                  Infra::Message::ESeverity::Info,
-                  L"Physical controller %u: Hardware disconnected.",
-                  (1 + controllerIdentifier));
-            break;
+      if (true == IsForceFeedbackAveragingEnabled())
+        forceFeedbackDevice->SetAveragingWindow(GetForceFeedbackPeriodMilliseconds());
 
-          default:
-            if (newPhysicalState.deviceStatus != oldPhysicalState.deviceStatus)
-              Infra::Message::OutputFormatted(
-                  Infra::Message::ESeverity::Warning,
-                  L"Physical controller %u: Encountered an error condition.",
-                  (1 + controllerIdentifier));
-            break;
-        }
+      // The device buffer must be published before any thread that drives force feedback
+      // actuation for it is started.
+      physicalControllerForceFeedbackBuffer[controllerIdentifier].store(
+          forceFeedbackDevice, std::memory_order_release);
 
-        oldPhysicalState = newPhysicalState;
+      if ((false == IsSingleThreadedPollingEnabled()) && (false == IsCooperativeModeEnabled()))
+      {
+        WorkerThread::StartDetached(
+            PerControllerThreadName(L"Force Feedback", controllerIdentifier),
+            WorkerThread::EPriority::LatencyCritical,
+            ForceFeedbackActuateEffects,
+            controllerIdentifier);
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Initialized the physical controller force feedback actuation thread for controller %u. Desired actuation period is %u ms.",
+            (unsigned int)(1 + controllerIdentifier),
+            GetForceFeedbackPeriodMilliseconds());
       }
+
+      return forceFeedbackDevice;
     }
 
     /// Initializes internal data structures and creates worker threads.
@@ -342,48 +2457,81 @@ namespace Xidi
       // There is overhead to using call_once, even after the operation is completed, and physical
       // controller functions are called frequently. Using this additional flag avoids that overhead
       // in the common case.
-      static bool isInitialized = false;
-      if (true == isInitialized) return;
+      static std::atomic<bool> isInitialized = false;
+      if (true == isInitialized.load(std::memory_order_acquire)) return;
 
       static std::once_flag initFlag;
       std::call_once(
           initFlag,
           []() -> void
           {
+            const StartupTrace::ScopedPhase initializePhase(L"PhysicalController::Initialize");
+            const TControllerIdentifier kControllerCount = GetPhysicalControllerCount();
+
+            // Whether or not this process polls physical controllers itself must be known before
+            // the initial state of any physical controller is read.
+            StateBroker::Start();
+
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Info,
+                L"Using %s to read and actuate physical controllers.",
+                GetBackend().GetName());
+
+            if (kDefaultPhysicalControllerCount != kControllerCount)
+              Infra::Message::OutputFormatted(
+                  Infra::Message::ESeverity::Info,
+                  L"Supporting %u physical controllers.",
+                  (unsigned int)kControllerCount);
+
             // Initialize controller state data structures.
-            for (auto controllerIdentifier = 0;
-                 controllerIdentifier < _countof(physicalControllerState);
+            for (TControllerIdentifier controllerIdentifier = 0;
+                 controllerIdentifier < kControllerCount;
                  ++controllerIdentifier)
             {
+              // Disabled physical controllers are never read, so they stay disconnected.
+              const Mapper* const mapper = Mapper::GetConfigured(controllerIdentifier);
               const SPhysicalState initialPhysicalState =
-                  ReadPhysicalControllerState(controllerIdentifier);
-              const SState initialRawVirtualState =
-                  Mapper::GetConfigured(controllerIdentifier)
-                      ->MapStatePhysicalToVirtual(
-                          initialPhysicalState,
-                          OpaqueControllerSourceIdentifier(controllerIdentifier));
-
-              physicalControllerState[controllerIdentifier].Set(initialPhysicalState);
-              rawVirtualControllerState[controllerIdentifier].Set(initialRawVirtualState);
+                  ((true == IsPhysicalControllerEnabled(controllerIdentifier))
+                       ? ReadPhysicalControllerState(controllerIdentifier)
+                       : SPhysicalState{.deviceStatus = EPhysicalDeviceStatus::NotConnected});
+              const SState initialRawVirtualState = mapper->MapStatePhysicalToVirtual(
+                  initialPhysicalState,
+                  Mapper::GetConfiguredPhysicalTransform(controllerIdentifier),
+                  OpaqueControllerSourceIdentifier(controllerIdentifier));
+
+              physicalControllerMapper[controllerIdentifier] = mapper;
+              SPhysicalControllerSlot& controllerSlot =
+                  physicalControllerSlot[controllerIdentifier];
+              controllerSlot.pollContext = MakePollContext(controllerIdentifier);
+              controllerSlot.forceFeedbackGain = ForceFeedback::kEffectModifierMaximum;
+              controllerSlot.physicalState.Set(initialPhysicalState);
+              controllerSlot.rawVirtualState.Set(initialRawVirtualState);
+              ExportControllerState(controllerIdentifier);
             }
 
-            // Ensure the system timer resolution is suitable for the desired polling frequency.
+            backendReportsEnabled.store(true, std::memory_order_release);
+
+            // Ensure the system timer resolution is suitable for the desired polling frequency, but
+            // only while at least one physical controller is connected and this process has input
+            // focus. Each poll keeps the system timer resolution up-to-date from here on.
             TIMECAPS timeCaps;
-            MMRESULT timeResult = ImportApiWinMM::timeGetDevCaps(&timeCaps, sizeof(timeCaps));
+            const MMRESULT timeResult =
+                ImportApiWinMM::timeGetDevCaps(&timeCaps, sizeof(timeCaps));
             if (MMSYSERR_NOERROR == timeResult)
             {
-              timeResult = ImportApiWinMM::timeBeginPeriod(timeCaps.wPeriodMin);
+              systemTimerPeriodMinimum = timeCaps.wPeriodMin;
+              PollingStatistics::RecordSystemTimerResolution(timeCaps.wPeriodMin);
+              Infra::Message::OutputFormatted(
+                  Infra::Message::ESeverity::Info,
+                  L"System timer resolution will be set to %u ms while physical controllers are in use.",
+                  timeCaps.wPeriodMin);
 
-              if (MMSYSERR_NOERROR == timeResult)
-                Infra::Message::OutputFormatted(
-                    Infra::Message::ESeverity::Info,
-                    L"Set the system timer resolution to %u ms.",
-                    timeCaps.wPeriodMin);
-              else
-                Infra::Message::OutputFormatted(
-                    Infra::Message::ESeverity::Warning,
-                    L"Failed with code %u to set the system timer resolution.",
-                    timeResult);
+              for (TControllerIdentifier controllerIdentifier = 0;
+                   controllerIdentifier < kControllerCount;
+                   ++controllerIdentifier)
+                RecordPhysicalControllerConnection(
+                    controllerIdentifier,
+                    physicalControllerSlot[controllerIdentifier].physicalState.Get().deviceStatus);
             }
             else
             {
@@ -393,41 +2541,110 @@ namespace Xidi
                   timeResult);
             }
 
-            // Create and start the polling threads.
-            for (auto controllerIdentifier = 0; controllerIdentifier < kPhysicalControllerCount;
-                 ++controllerIdentifier)
+            // Register for device arrival notifications so that polling of disconnected physical
+            // controllers can back off aggressively without delaying hardware connection.
+            if (true == RegisterForDeviceArrivalNotifications())
+              Infra::Message::Output(
+                  Infra::Message::ESeverity::Info,
+                  L"Registered for device arrival notifications.");
+            else
+              Infra::Message::Output(
+                  Infra::Message::ESeverity::Warning,
+                  L"Failed to register for device arrival notifications. Connecting a physical controller may take longer to be detected.");
+
+            // Live metrics are updated as often as physical controllers are polled.
+            LiveMetrics::Start(GetPollingPeriodMilliseconds());
+
+            const StartupTrace::ScopedPhase threadCreationPhase(L"Worker thread creation");
+
+            if (true == IsCooperativeModeEnabled())
             {
-              std::thread(PollForPhysicalControllerStateChanges, controllerIdentifier).detach();
+              // Application threads take the place of all of the per-controller threads, so only
+              // the watchdog thread is needed.
+              WorkerThread::StartDetached(
+                  L"Xidi Cooperative Watchdog",
+                  WorkerThread::EPriority::Housekeeping,
+                  WatchCooperativeService);
               Infra::Message::OutputFormatted(
                   Infra::Message::ESeverity::Info,
-                  L"Initialized the physical controller state polling thread for controller %u. Desired polling period is %u ms.",
-                  (unsigned int)(1 + controllerIdentifier),
-                  kPhysicalPollingPeriodMilliseconds);
+                  L"Initialized cooperative mode for %u controllers. Physical controllers are serviced whenever the application reads state. Desired polling period is %u ms. Desired force feedback actuation period is %u ms.",
+                  (unsigned int)kControllerCount,
+                  GetPollingPeriodMilliseconds(),
+                  GetForceFeedbackPeriodMilliseconds());
+
+              isInitialized.store(true, std::memory_order_release);
+              return;
+            }
+
+            if (true == IsSingleThreadedPollingEnabled())
+            {
+              // A single scheduler thread takes the place of all of the per-controller threads.
+              WorkerThread::StartDetached(
+                  L"Xidi Controller Scheduler",
+                  WorkerThread::EPriority::LatencyCritical,
+                  ServiceAllPhysicalControllers);
+              Infra::Message::OutputFormatted(
+                  Infra::Message::ESeverity::Info,
+                  L"Initialized the single-threaded physical controller scheduler for %u controllers. Desired polling period is %u ms%s. Desired force feedback actuation period is %u ms.",
+                  (unsigned int)kControllerCount,
+                  GetPollingPeriodMilliseconds(),
+                  ((true == IsHighResolutionPollingEnabled()) ? L" using a high-resolution timer"
+                                                                : L""),
+                  GetForceFeedbackPeriodMilliseconds());
+
+              isInitialized.store(true, std::memory_order_release);
+              return;
             }
 
-            // Allocate the force feedback device buffers, then create and start the force feedback
-            // threads.
-            physicalControllerForceFeedbackBuffer =
-                new ForceFeedback::Device[kPhysicalControllerCount];
-            for (auto controllerIdentifier = 0; controllerIdentifier < kPhysicalControllerCount;
+            // Create and start the polling threads.
+            for (TControllerIdentifier controllerIdentifier = 0;
+                 controllerIdentifier < kControllerCount;
                  ++controllerIdentifier)
             {
-              std::thread(ForceFeedbackActuateEffects, controllerIdentifier).detach();
+              if (false == IsPhysicalControllerEnabled(controllerIdentifier)) continue;
+
+              WorkerThread::StartDetached(
+                  PerControllerThreadName(L"Polling", controllerIdentifier),
+                  WorkerThread::EPriority::LatencyCritical,
+                  PollForPhysicalControllerStateChanges,
+                  controllerIdentifier);
               Infra::Message::OutputFormatted(
                   Infra::Message::ESeverity::Info,
-                  L"Initialized the physical controller force feedback actuation thread for controller %u. Desired actuation period is %u ms.",
+                  L"Initialized the physical controller state polling thread for controller %u. Desired polling period is %u ms%s.",
                   (unsigned int)(1 + controllerIdentifier),
-                  kPhysicalForceFeedbackPeriodMilliseconds);
+                  GetPollingPeriodMilliseconds(),
+                  ((true == IsHighResolutionPollingEnabled()) ? L" using a high-resolution timer"
+                                                                : L""));
+
+              if (true == IsPipelinedPollingEnabled())
+              {
+                WorkerThread::StartDetached(
+                    PerControllerThreadName(L"Mapping", controllerIdentifier),
+                    WorkerThread::EPriority::LatencyCritical,
+                    MapPhysicalControllerReadings,
+                    controllerIdentifier);
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Info,
+                    L"Initialized the physical controller state mapping thread for controller %u. Readings are mapped separately from polling.",
+                    (unsigned int)(1 + controllerIdentifier));
+              }
             }
 
             // Create and start the physical controller hardware status monitoring threads, but only
             // if the messages generated by those threads will actually be delivered as output.
             if (Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Warning))
             {
-              for (auto controllerIdentifier = 0; controllerIdentifier < kPhysicalControllerCount;
+              for (TControllerIdentifier controllerIdentifier = 0;
+                   controllerIdentifier < kControllerCount;
                    ++controllerIdentifier)
               {
-                std::thread(MonitorPhysicalControllerStatus, controllerIdentifier).detach();
+                if (false == IsPhysicalControllerEnabled(controllerIdentifier)) continue;
+
+                WorkerThread::StartDetached(
+                    PerControllerThreadName(L"Status Monitor", controllerIdentifier),
+                    WorkerThread::EPriority::Housekeeping,
+                    MonitorPhysicalControllerStatus,
+                    controllerIdentifier);
                 Infra::Message::OutputFormatted(
                     Infra::Message::ESeverity::Info,
                     L"Initialized the physical controller hardware status monitoring thread for controller %u.",
@@ -435,26 +2652,82 @@ namespace Xidi
               }
             }
 
-            isInitialized = true;
+            isInitialized.store(true, std::memory_order_release);
           });
     }
 
+    TControllerIdentifier GetPhysicalControllerCount(void)
+    {
+      return Globals::GetSettings().properties.physicalControllerCount;
+    }
+
+    bool IsPhysicalControllerEnabled(TControllerIdentifier controllerIdentifier)
+    {
+      const SSettings::SProperties& settings = Globals::GetSettings().properties;
+
+      if (controllerIdentifier >= settings.physicalControllerCount) return false;
+      return (0 != (settings.physicalControllerMask & ((uint32_t)1 << controllerIdentifier)));
+    }
+
+    unsigned int GetForceFeedbackPeriodMilliseconds(void)
+    {
+      return Globals::GetSettings().properties.forceFeedbackPeriodMilliseconds;
+    }
+
     SCapabilities GetControllerCapabilities(TControllerIdentifier controllerIdentifier)
     {
       Initialize();
-      return Mapper::GetConfigured(controllerIdentifier)->GetCapabilities();
+      return physicalControllerMapper[controllerIdentifier].load()->GetCapabilities();
+    }
+
+    const Mapper* GetControllerMapper(TControllerIdentifier controllerIdentifier)
+    {
+      Initialize();
+      return physicalControllerMapper[controllerIdentifier];
     }
 
     SPhysicalState GetCurrentPhysicalControllerState(TControllerIdentifier controllerIdentifier)
     {
       Initialize();
-      return physicalControllerState[controllerIdentifier].Get();
+      return physicalControllerSlot[controllerIdentifier].physicalState.Get();
+    }
+
+    SPhysicalState GetCurrentPhysicalControllerState(
+        TControllerIdentifier controllerIdentifier, TGeneration& generation)
+    {
+      Initialize();
+      return physicalControllerSlot[controllerIdentifier].physicalState.Get(generation);
     }
 
     SState GetCurrentRawVirtualControllerState(TControllerIdentifier controllerIdentifier)
     {
       Initialize();
-      return rawVirtualControllerState[controllerIdentifier].Get();
+      return physicalControllerSlot[controllerIdentifier].rawVirtualState.Get();
+    }
+
+    SState GetCurrentRawVirtualControllerState(
+        TControllerIdentifier controllerIdentifier, TGeneration& generation)
+    {
+      Initialize();
+      return physicalControllerSlot[controllerIdentifier].rawVirtualState.Get(generation);
+    }
+
+    TGeneration GetCurrentRawVirtualControllerStateGeneration(
+        TControllerIdentifier controllerIdentifier)
+    {
+      Initialize();
+      return physicalControllerSlot[controllerIdentifier].rawVirtualState.GetGeneration();
+    }
+
+    std::span<const Api::IStateExport::SStateBlock> GetExportedStateBlocks(void)
+    {
+      Initialize();
+      return std::span(exportedStateBlock, GetPhysicalControllerCount());
+    }
+
+    void InvalidateConfiguredMapper(TControllerIdentifier controllerIdentifier)
+    {
+      SetControllerMapper(controllerIdentifier, Mapper::GetConfigured(controllerIdentifier));
     }
 
     ForceFeedback::Device* PhysicalControllerForceFeedbackRegister(
@@ -462,7 +2735,7 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetPhysicalControllerCount())
       {
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Error,
@@ -471,10 +2744,27 @@ namespace Xidi
         return nullptr;
       }
 
-      std::unique_lock lock(physicalControllerForceFeedbackMutex[controllerIdentifier]);
+#ifdef XIDI_SKIP_FORCE_FEEDBACK
+      // Builds without force feedback never create device buffers, so there is never any actuation
+      // work to be done.
+      return nullptr;
+#else
+      // Disabled physical controllers get no device buffer and therefore no actuation work.
+      if (false == IsPhysicalControllerEnabled(controllerIdentifier)) return nullptr;
+
+      std::unique_lock lock(physicalControllerSlot[controllerIdentifier].forceFeedbackMutex);
+
+      ForceFeedback::Device* forceFeedbackDevice =
+          physicalControllerForceFeedbackBuffer[controllerIdentifier].load(
+              std::memory_order_relaxed);
+      if (nullptr == forceFeedbackDevice)
+        forceFeedbackDevice = CreateForceFeedbackDevice(controllerIdentifier);
+
       physicalControllerForceFeedbackRegistration[controllerIdentifier].insert(virtualController);
+      UpdateForceFeedbackGain(controllerIdentifier);
 
-      return &physicalControllerForceFeedbackBuffer[controllerIdentifier];
+      return forceFeedbackDevice;
+#endif
     }
 
     void PhysicalControllerForceFeedbackUnregister(
@@ -482,7 +2772,7 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetPhysicalControllerCount())
       {
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Error,
@@ -491,8 +2781,308 @@ namespace Xidi
         return;
       }
 
-      std::unique_lock lock(physicalControllerForceFeedbackMutex[controllerIdentifier]);
-      physicalControllerForceFeedbackRegistration[controllerIdentifier].erase(virtualController);
+      std::unique_lock lock(physicalControllerSlot[controllerIdentifier].forceFeedbackMutex);
+      if (0 == physicalControllerForceFeedbackRegistration[controllerIdentifier].erase(
+                   virtualController))
+        return;
+
+      UpdateForceFeedbackGain(controllerIdentifier);
+
+      // Once nothing is left to control the effects on the device buffer they are released, which
+      // also brings the physical actuators to rest and lets actuation go idle.
+      if (true == physicalControllerForceFeedbackRegistration[controllerIdentifier].empty())
+        physicalControllerForceFeedbackBuffer[controllerIdentifier]
+            .load(std::memory_order_relaxed)
+            ->Clear();
+    }
+
+    void PhysicalControllerForceFeedbackRefreshGain(TControllerIdentifier controllerIdentifier)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetPhysicalControllerCount())
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Attempted to refresh force feedback gain for a physical controller with invalid identifier %u.",
+            controllerIdentifier);
+        return;
+      }
+
+      std::unique_lock lock(physicalControllerSlot[controllerIdentifier].forceFeedbackMutex);
+      UpdateForceFeedbackGain(controllerIdentifier);
+    }
+
+    bool PhysicalControllerStateChangeRegister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetPhysicalControllerCount())
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Attempted to register with a physical controller for state changes with invalid identifier %u.",
+            controllerIdentifier);
+        return false;
+      }
+
+      // Refreshing while holding the lock ensures the virtual controller cannot miss an update
+      // that is published concurrently with registration, nor receive one out of order.
+      std::unique_lock lock(physicalControllerSlot[controllerIdentifier].stateChangeMutex);
+      physicalControllerStateChangeRegistration[controllerIdentifier].insert(virtualController);
+      virtualController->RefreshState(
+          physicalControllerSlot[controllerIdentifier].rawVirtualState.Get());
+
+      return true;
+    }
+
+    void PhysicalControllerStateChangeUnregister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetPhysicalControllerCount())
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Attempted to unregister with a physical controller for state changes with invalid identifier %u.",
+            controllerIdentifier);
+        return;
+      }
+
+      std::unique_lock lock(physicalControllerSlot[controllerIdentifier].stateChangeMutex);
+      physicalControllerStateChangeRegistration[controllerIdentifier].erase(virtualController);
+    }
+
+    bool PhysicalControllerStateChangeSubscribe(
+        TControllerIdentifier controllerIdentifier,
+        Api::IStateChangeSubscription::TStateChangeCallback callback,
+        void* context)
+    {
+      Initialize();
+
+      if ((controllerIdentifier >= GetPhysicalControllerCount()) || (nullptr == callback))
+        return false;
+
+      const SStateChangeSubscriber newSubscriber = {.callback = callback, .context = context};
+
+      SPhysicalControllerSlot& controllerSlot = physicalControllerSlot[controllerIdentifier];
+      std::unique_lock lock(controllerSlot.stateChangeMutex);
+      SStateChangeSubscriptions& subscriptions = stateChangeSubscriptions[controllerIdentifier];
+
+      if (subscriptions.subscribers.cend() !=
+          std::find(
+              subscriptions.subscribers.cbegin(), subscriptions.subscribers.cend(), newSubscriber))
+        return false;
+
+      // The first subscriber sees changes relative to the state that was current when it
+      // subscribed. Later subscribers share the baseline of those already subscribed.
+      if (true == subscriptions.subscribers.empty())
+        subscriptions.notifiedRawVirtualState = controllerSlot.rawVirtualState.Get();
+
+      subscriptions.subscribers.push_back(newSubscriber);
+      controllerSlot.hasStateChangeSubscribers.store(true, std::memory_order_relaxed);
+      return true;
+    }
+
+    bool PhysicalControllerStateChangeUnsubscribe(
+        TControllerIdentifier controllerIdentifier,
+        Api::IStateChangeSubscription::TStateChangeCallback callback,
+        void* context)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetPhysicalControllerCount()) return false;
+
+      const SStateChangeSubscriber subscriber = {.callback = callback, .context = context};
+
+      SPhysicalControllerSlot& controllerSlot = physicalControllerSlot[controllerIdentifier];
+      std::unique_lock lock(controllerSlot.stateChangeMutex);
+      SStateChangeSubscriptions& subscriptions = stateChangeSubscriptions[controllerIdentifier];
+
+      auto existingSubscriber = std::find(
+          subscriptions.subscribers.begin(), subscriptions.subscribers.end(), subscriber);
+      if (subscriptions.subscribers.end() == existingSubscriber) return false;
+
+      subscriptions.subscribers.erase(existingSubscriber);
+      controllerSlot.hasStateChangeSubscribers.store(
+          (false == subscriptions.subscribers.empty()), std::memory_order_relaxed);
+      return true;
+    }
+
+    void NotifyApplicationStateRead(TControllerIdentifier controllerIdentifier)
+    {
+      // Reads that closely follow a previous read are taken to be part of the same burst, such as
+      // when multiple subsystems of the application read state during the same frame.
+      constexpr int64_t kMinimumReadPeriodMicroseconds = 2000;
+
+      // Gaps between reads longer than this are pauses rather than read periods.
+      constexpr int64_t kMaximumReadPeriodMicroseconds = 100000;
+
+      // Weight of each new sample in the moving average of the read period is the inverse of this.
+      constexpr int64_t kReadPeriodAverageDivisor = 8;
+
+      if (false == IsPollingAlignmentEnabled()) return;
+      if (controllerIdentifier >= GetPhysicalControllerCount()) return;
+
+      SApplicationReadTiming& readTiming =
+          physicalControllerSlot[controllerIdentifier].applicationReadTiming;
+      const int64_t now = PeriodicTimer::Now();
+      const int64_t readPeriod = now - readTiming.lastReadTime.load(std::memory_order_relaxed);
+
+      if (readPeriod < PeriodicTimer::TicksFromMicroseconds(kMinimumReadPeriodMicroseconds)) return;
+      readTiming.lastReadTime.store(now, std::memory_order_relaxed);
+
+      if (readPeriod > PeriodicTimer::TicksFromMicroseconds(kMaximumReadPeriodMicroseconds)) return;
+
+      const int64_t averageReadPeriod =
+          readTiming.averageReadPeriod.load(std::memory_order_relaxed);
+      const int64_t updatedAverageReadPeriod =
+          ((0 == averageReadPeriod)
+               ? readPeriod
+               : (averageReadPeriod +
+                  ((readPeriod - averageReadPeriod) / kReadPeriodAverageDivisor)));
+      readTiming.averageReadPeriod.store(updatedAverageReadPeriod, std::memory_order_relaxed);
+    }
+
+    void NotifyApplicationStateObserved(TControllerIdentifier controllerIdentifier)
+    {
+      InputLatencyTrace::RecordApplicationRead(controllerIdentifier);
+    }
+
+    void RequestPollingPeriod(
+        TControllerIdentifier controllerIdentifier, unsigned int periodMilliseconds)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+      std::scoped_lock lock(pollingPeriodRequestMutex);
+      pollingPeriodRequests[controllerIdentifier].insert(periodMilliseconds);
+      requestedPollingPeriodMilliseconds[controllerIdentifier].store(
+          *pollingPeriodRequests[controllerIdentifier].cbegin(), std::memory_order_relaxed);
+    }
+
+    void WithdrawPollingPeriodRequest(
+        TControllerIdentifier controllerIdentifier, unsigned int periodMilliseconds)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+      std::scoped_lock lock(pollingPeriodRequestMutex);
+
+      auto request = pollingPeriodRequests[controllerIdentifier].find(periodMilliseconds);
+      if (pollingPeriodRequests[controllerIdentifier].end() == request) return;
+      pollingPeriodRequests[controllerIdentifier].erase(request);
+
+      requestedPollingPeriodMilliseconds[controllerIdentifier].store(
+          ((true == pollingPeriodRequests[controllerIdentifier].empty())
+               ? 0
+               : *pollingPeriodRequests[controllerIdentifier].cbegin()),
+          std::memory_order_relaxed);
+    }
+
+    unsigned int GetEffectivePollingPeriodMilliseconds(TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        return GetPollingPeriodMilliseconds();
+
+      return EffectivePollingPeriodMilliseconds(controllerIdentifier);
+    }
+
+    bool IsControllerStatusServiceEnabled(void)
+    {
+      Initialize();
+
+      // Battery and capabilities information is queried using XInput, which identifies physical
+      // controllers the same way as Xidi only if XInput is also used to read their state.
+      return (0 != GetControllerStatusPeriodSeconds()) &&
+          (&GetBackend() == &PhysicalControllerBackend::XInput()) &&
+          (false == XInputTrace::IsReplaying());
+    }
+
+    Api::IControllerStatus::SControllerStatus GetControllerStatus(
+        TControllerIdentifier controllerIdentifier)
+    {
+      static std::once_flag startFlag;
+      std::call_once(
+          startFlag,
+          []() -> void
+          {
+            if (false == IsControllerStatusServiceEnabled()) return;
+
+            WorkerThread::StartDetached(
+                L"Xidi Controller Status Service",
+                WorkerThread::EPriority::Housekeeping,
+                ServiceControllerStatus);
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Info,
+                L"Initialized the physical controller status service. Battery and capabilities information is queried every %u seconds and whenever a physical controller is connected.",
+                GetControllerStatusPeriodSeconds());
+          });
+
+      if (controllerIdentifier >= kMaxPhysicalControllerCount) return {};
+      return physicalControllerStatus[controllerIdentifier].Get();
+    }
+
+    bool PollPhysicalControllerOnDemand(TControllerIdentifier controllerIdentifier)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetPhysicalControllerCount()) return false;
+
+      // Querying a physical controller that is not connected can be expensive, so those are left
+      // entirely to the polling threads and their back-off.
+      if (EPhysicalDeviceStatus::Ok !=
+          physicalControllerSlot[controllerIdentifier].physicalState.Get().deviceStatus)
+        return false;
+
+      if (true ==
+          WasPolledRecently(
+              controllerIdentifier, std::chrono::steady_clock::now().time_since_epoch().count()))
+        return false;
+
+      // Another poll might have completed while waiting for the lock, in which case its result is
+      // just as fresh.
+      std::scoped_lock lock(physicalControllerSlot[controllerIdentifier].pollMutex);
+
+      const std::chrono::steady_clock::rep now =
+          std::chrono::steady_clock::now().time_since_epoch().count();
+      if (true == WasPolledRecently(controllerIdentifier, now)) return false;
+
+      physicalControllerSlot[controllerIdentifier].lastPollTime.store(
+          now, std::memory_order_relaxed);
+      PollForPhysicalControllerStateOnce(
+          controllerIdentifier, physicalControllerSlot[controllerIdentifier].pollContext);
+      return true;
+    }
+
+    void ServicePhysicalControllerCooperatively(TControllerIdentifier controllerIdentifier)
+    {
+      if (false == IsCooperativeModeEnabled()) return;
+
+      Initialize();
+
+      if (false == IsPhysicalControllerEnabled(controllerIdentifier)) return;
+
+      cooperativeServiceSlot[controllerIdentifier].lastApplicationServiceTime.store(
+          ImportApiWinMM::timeGetTime(), std::memory_order_relaxed);
+      ServicePhysicalControllerCooperativelyOnce(controllerIdentifier);
+    }
+
+    void PrewarmPhysicalControllers(void)
+    {
+      Initialize();
+    }
+
+    void SetControllerMapper(TControllerIdentifier controllerIdentifier, const Mapper* mapper)
+    {
+      Initialize();
+
+      // Mapper objects are never destroyed once created, so a mapper that was replaced can still
+      // safely be used by any thread that picked it up before the replacement. The generation is
+      // incremented after the new mapper is published so that any thread observing the new
+      // generation also observes the new mapper.
+      physicalControllerMapper[controllerIdentifier] = mapper;
+      physicalControllerMapperGeneration[controllerIdentifier] += 1;
     }
 
     bool WaitForPhysicalControllerStateChange(
@@ -502,9 +3092,10 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount) return false;
+      if (controllerIdentifier >= GetPhysicalControllerCount()) return false;
 
-      return physicalControllerState[controllerIdentifier].WaitForUpdate(state, stopToken);
+      return physicalControllerSlot[controllerIdentifier].physicalState.WaitForUpdate(
+          state, stopToken);
     }
 
     bool WaitForRawVirtualControllerStateChange(
@@ -512,9 +3103,24 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount) return false;
+      if (controllerIdentifier >= GetPhysicalControllerCount()) return false;
+
+      return physicalControllerSlot[controllerIdentifier].rawVirtualState.WaitForUpdate(
+          state, stopToken);
+    }
+
+    bool WaitForRawVirtualControllerStateChange(
+        TControllerIdentifier controllerIdentifier,
+        SState& state,
+        TGeneration& generation,
+        std::stop_token stopToken)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetPhysicalControllerCount()) return false;
 
-      return rawVirtualControllerState[controllerIdentifier].WaitForUpdate(state, stopToken);
+      return physicalControllerSlot[controllerIdentifier].rawVirtualState.WaitForUpdate(
+          state, generation, stopToken);
     }
   } // namespace Controller
 } // namespace Xidi
@@ -0,0 +1,722 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PhysicalControllerBackendRawInput.cpp
+ *   Implementation of the physical controller backend that receives HID input reports from
+ *   XInput-compatible controllers using the Raw Input API. Reports are parsed as soon as they
+ *   arrive, so physical controller state changes are delivered without waiting for a poll.
+ **************************************************************************************************/
+
+#include "PhysicalControllerBackend.h"
+
+// HID header files depend on Windows header files, which are are sensitive to include order.
+// See "ApiWindows.h" for more information.
+
+// clang-format off
+
+#include "ApiWindows.h"
+#include <hidsdi.h>
+#include <hidusage.h>
+
+// clang-format on
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cwctype>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "PhysicalController.h"
+#include "Strings.h"
+#include "WorkerThread.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace PhysicalControllerBackend
+    {
+      /// Name of the window class used to receive raw input.
+      static constexpr wchar_t kRawInputWindowClassName[] = L"Xidi.RawInput";
+
+      /// Substring that identifies the device name of the HID collection that XInput-compatible
+      /// controllers expose alongside their XInput interface.
+      static constexpr std::wstring_view kXInputCompatibleDeviceNameMarker = L"IG_";
+
+      /// Maximum number of buttons read from a single input report.
+      static constexpr ULONG kMaxButtonUsages = 32;
+
+      /// XInput buttons corresponding to HID button usages 1 to 10, in that order, using the
+      /// layout of the HID collection exposed by XInput-compatible controllers.
+      static constexpr std::array<WORD, 10> kXInputButtonForButtonUsage = {
+          XINPUT_GAMEPAD_A,
+          XINPUT_GAMEPAD_B,
+          XINPUT_GAMEPAD_X,
+          XINPUT_GAMEPAD_Y,
+          XINPUT_GAMEPAD_LEFT_SHOULDER,
+          XINPUT_GAMEPAD_RIGHT_SHOULDER,
+          XINPUT_GAMEPAD_BACK,
+          XINPUT_GAMEPAD_START,
+          XINPUT_GAMEPAD_LEFT_THUMB,
+          XINPUT_GAMEPAD_RIGHT_THUMB};
+
+      /// XInput d-pad buttons corresponding to each of the eight hat switch positions, starting
+      /// with up and proceeding clockwise.
+      static constexpr std::array<WORD, 8> kXInputButtonsForHatPosition = {
+          XINPUT_GAMEPAD_DPAD_UP,
+          XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_RIGHT,
+          XINPUT_GAMEPAD_DPAD_RIGHT,
+          XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_RIGHT,
+          XINPUT_GAMEPAD_DPAD_DOWN,
+          XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_LEFT,
+          XINPUT_GAMEPAD_DPAD_LEFT,
+          XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_LEFT};
+
+      /// HID parsing functions, which are imported dynamically so that no additional import
+      /// library is needed.
+      struct SHidFunctions
+      {
+        /// Retrieves the capabilities of a HID collection.
+        decltype(&HidP_GetCaps) hidpGetCaps;
+
+        /// Retrieves the capabilities of all values in a HID collection.
+        decltype(&HidP_GetValueCaps) hidpGetValueCaps;
+
+        /// Extracts the pressed buttons from a HID report.
+        decltype(&HidP_GetUsages) hidpGetUsages;
+
+        /// Extracts a single value from a HID report.
+        decltype(&HidP_GetUsageValue) hidpGetUsageValue;
+      };
+
+      /// Attempts to import all needed HID parsing functions.
+      /// @param [out] hidFunctions Filled in with the addresses of the imported functions.
+      /// @return `true` if all functions were imported successfully, `false` otherwise.
+      static bool ImportHidFunctions(SHidFunctions& hidFunctions)
+      {
+        HMODULE hidLibrary = LoadLibraryEx(
+            Strings::kStrLibraryNameHid.data(), nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+        if (nullptr == hidLibrary) return false;
+
+        hidFunctions = {
+            .hidpGetCaps = reinterpret_cast<decltype(&HidP_GetCaps)>(
+                GetProcAddress(hidLibrary, "HidP_GetCaps")),
+            .hidpGetValueCaps = reinterpret_cast<decltype(&HidP_GetValueCaps)>(
+                GetProcAddress(hidLibrary, "HidP_GetValueCaps")),
+            .hidpGetUsages = reinterpret_cast<decltype(&HidP_GetUsages)>(
+                GetProcAddress(hidLibrary, "HidP_GetUsages")),
+            .hidpGetUsageValue = reinterpret_cast<decltype(&HidP_GetUsageValue)>(
+                GetProcAddress(hidLibrary, "HidP_GetUsageValue"))};
+
+        return (
+            (nullptr != hidFunctions.hidpGetCaps) && (nullptr != hidFunctions.hidpGetValueCaps) &&
+            (nullptr != hidFunctions.hidpGetUsages) && (nullptr != hidFunctions.hidpGetUsageValue));
+      }
+
+      /// Range of raw values that a single HID value can take.
+      struct SValueRange
+      {
+        /// Whether or not the HID collection contains this value at all.
+        bool present;
+
+        /// Minimum raw value.
+        ULONG minimum;
+
+        /// Maximum raw value.
+        ULONG maximum;
+
+        /// Maps a raw value to the range 0.0 to 1.0, saturating at either end.
+        /// @param [in] rawValue Raw value extracted from a report.
+        /// @return Normalized value.
+        inline double Normalize(ULONG rawValue) const
+        {
+          if (maximum <= minimum) return 0.0;
+
+          const ULONG clampedValue = std::clamp(rawValue, minimum, maximum);
+          return static_cast<double>(clampedValue - minimum) /
+              static_cast<double>(maximum - minimum);
+        }
+      };
+
+      /// Identifies the values that are read from each input report.
+      enum class EValue
+      {
+        LeftStickX,
+        LeftStickY,
+        RightStickX,
+        RightStickY,
+        Triggers,
+        HatSwitch,
+        Count
+      };
+
+      /// HID usages of the values that are read from each input report, indexed by value.
+      static constexpr std::array<USAGE, (size_t)EValue::Count> kValueUsages = {
+          HID_USAGE_GENERIC_X,
+          HID_USAGE_GENERIC_Y,
+          HID_USAGE_GENERIC_RX,
+          HID_USAGE_GENERIC_RY,
+          HID_USAGE_GENERIC_Z,
+          HID_USAGE_GENERIC_HATSWITCH};
+
+      /// Converts a normalized stick axis value to XInput representation.
+      /// @param [in] normalizedValue Value from 0.0 to 1.0, with the center at 0.5.
+      /// @param [in] invert Whether or not the axis direction should be reversed.
+      /// @return Equivalent XInput thumbstick axis value.
+      static SHORT XInputThumbstickValue(double normalizedValue, bool invert)
+      {
+        const double centeredValue = ((normalizedValue * 2.0) - 1.0) * (invert ? -1.0 : 1.0);
+        return static_cast<SHORT>(std::clamp(centeredValue * 32767.0, -32768.0, 32767.0));
+      }
+
+      /// Converts a normalized trigger value to XInput representation.
+      /// @param [in] normalizedValue Value from 0.0 to 1.0.
+      /// @return Equivalent XInput trigger value.
+      static BYTE XInputTriggerValue(double normalizedValue)
+      {
+        return static_cast<BYTE>(std::clamp(normalizedValue * 255.0, 0.0, 255.0));
+      }
+
+      /// Receives HID input reports from XInput-compatible controllers using the Raw Input API.
+      /// Devices are assigned to physical controller identifiers in the order in which they
+      /// connect, and each keeps its identifier until it disconnects.
+      class RawInputBackend : public IPhysicalControllerBackend
+      {
+      public:
+
+        inline RawInputBackend(
+            const SHidFunctions& hidFunctions,
+            TArrivalCallback arrivalCallback,
+            TReportCallback reportCallback)
+            : hidFunctions(hidFunctions),
+              arrivalCallback(arrivalCallback),
+              reportCallback(reportCallback),
+              slotMutex(),
+              slot(),
+              rawInputBuffer()
+        {}
+
+        RawInputBackend(const RawInputBackend& other) = delete;
+        RawInputBackend& operator=(const RawInputBackend& other) = delete;
+
+        /// Creates the message-only window, registers it for raw input, and then dispatches
+        /// messages for the rest of the process lifetime. Intended to be a thread entry point.
+        /// @param [in] backend Backend object that receives and parses the raw input.
+        /// @param [in] windowReady Promise to fulfill, with the outcome, once the window either
+        /// is ready to receive raw input or could not be made ready.
+        static void ReceiveRawInput(RawInputBackend* backend, std::promise<bool> windowReady);
+
+        // IPhysicalControllerBackend
+        const wchar_t* GetName(void) const override
+        {
+          return L"Raw Input";
+        }
+
+        DWORD ReadState(
+            TControllerIdentifier controllerIdentifier,
+            bool,
+            XINPUT_STATE& xinputState,
+            int64_t& readingTimestamp) override
+        {
+          readingTimestamp = 0;
+          if (controllerIdentifier >= kMaxPhysicalControllerCount)
+            return ERROR_DEVICE_NOT_CONNECTED;
+
+          std::scoped_lock lock(slotMutex);
+
+          const SSlot& readSlot = slot[controllerIdentifier];
+          if (nullptr == readSlot.deviceHandle) return ERROR_DEVICE_NOT_CONNECTED;
+
+          xinputState = readSlot.xinputState;
+          readingTimestamp = readSlot.readingTimestamp;
+          return ERROR_SUCCESS;
+        }
+
+        DWORD WriteVibration(
+            TControllerIdentifier controllerIdentifier,
+            ForceFeedback::SPhysicalActuatorComponents vibration) override
+        {
+          // The HID collection exposed by XInput-compatible controllers has no output reports, so
+          // vibration still goes through XInput. Both assign identifiers in connection order.
+          return XInput().WriteVibration(controllerIdentifier, vibration);
+        }
+
+      private:
+
+        /// Physical controller identifier assignment and most recently received state.
+        struct SSlot
+        {
+          /// Raw input handle of the assigned device, or `nullptr` if none is assigned.
+          HANDLE deviceHandle;
+
+          /// Buffer holding the preparsed HID collection data of the assigned device.
+          std::unique_ptr<uint8_t[]> preparsedData;
+
+          /// Ranges of the values read from each input report, indexed by value.
+          std::array<SValueRange, (size_t)EValue::Count> valueRange;
+
+          /// State parsed from the most recently received input report.
+          XINPUT_STATE xinputState;
+
+          /// Performance counter value at which the most recent input report was received.
+          int64_t readingTimestamp;
+        };
+
+        /// Window procedure for the message-only window that receives raw input.
+        static LRESULT CALLBACK RawInputWindowProc(
+            HWND window, UINT message, WPARAM wParam, LPARAM lParam);
+
+        /// Assigns an identifier to a newly-connected device, if it is XInput-compatible, an
+        /// identifier is available, and the device does not already have one.
+        /// @param [in] deviceHandle Raw input handle of the device that was connected.
+        void OnDeviceArrival(HANDLE deviceHandle);
+
+        /// Releases the identifier assigned to a device that disconnected.
+        /// @param [in] deviceHandle Raw input handle of the device that was disconnected.
+        void OnDeviceRemoval(HANDLE deviceHandle);
+
+        /// Parses all of the input reports contained in a raw input message and, for the last
+        /// one, updates the state of the physical controller to which the device is assigned.
+        /// @param [in] rawInputHandle Handle of the raw input data, received with the message.
+        void OnRawInput(HRAWINPUT rawInputHandle);
+
+        /// Parses a single input report into XInput state.
+        /// @param [in] parseSlot Slot of the device that generated the report.
+        /// @param [in] report Input report data.
+        /// @param [in] reportLength Size of the input report, in bytes.
+        /// @param [out] gamepad Filled in with the parsed state.
+        void ParseReport(
+            const SSlot& parseSlot,
+            PCHAR report,
+            ULONG reportLength,
+            XINPUT_GAMEPAD& gamepad) const;
+
+        /// Imported HID parsing functions.
+        const SHidFunctions hidFunctions;
+
+        /// Function to invoke whenever a device is connected.
+        const TArrivalCallback arrivalCallback;
+
+        /// Function to invoke whenever a new input report is received.
+        const TReportCallback reportCallback;
+
+        /// Guards the assignment of devices to physical controller identifiers and the state they
+        /// most recently reported.
+        std::mutex slotMutex;
+
+        /// Assignment and state for each physical controller identifier.
+        SSlot slot[kMaxPhysicalControllerCount];
+
+        /// Buffer into which raw input data are read. Only accessed by the raw input thread.
+        std::vector<uint8_t> rawInputBuffer;
+      };
+
+      void RawInputBackend::ReceiveRawInput(
+          RawInputBackend* backend, std::promise<bool> windowReady)
+      {
+        const WNDCLASSEXW windowClass = {
+            .cbSize = sizeof(WNDCLASSEXW),
+            .lpfnWndProc = &RawInputWindowProc,
+            .hInstance = GetModuleHandleW(nullptr),
+            .lpszClassName = kRawInputWindowClassName};
+        RegisterClassExW(&windowClass);
+
+        const HWND window = CreateWindowExW(
+            0,
+            kRawInputWindowClassName,
+            L"",
+            0,
+            0,
+            0,
+            0,
+            0,
+            HWND_MESSAGE,
+            nullptr,
+            windowClass.hInstance,
+            nullptr);
+        if (nullptr == window)
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with code %u to create the raw input window.",
+              GetLastError());
+          windowReady.set_value(false);
+          return;
+        }
+
+        SetWindowLongPtrW(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(backend));
+
+        // Input sink mode delivers input even while the application is in the background, and
+        // device notifications announce devices that were already connected at registration.
+        const RAWINPUTDEVICE rawInputDevice = {
+            .usUsagePage = HID_USAGE_PAGE_GENERIC,
+            .usUsage = HID_USAGE_GENERIC_GAMEPAD,
+            .dwFlags = RIDEV_INPUTSINK | RIDEV_DEVNOTIFY,
+            .hwndTarget = window};
+        if (FALSE == RegisterRawInputDevices(&rawInputDevice, 1, sizeof(rawInputDevice)))
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with code %u to register for raw input from gamepads.",
+              GetLastError());
+          DestroyWindow(window);
+          windowReady.set_value(false);
+          return;
+        }
+
+        windowReady.set_value(true);
+
+        MSG message;
+        while (GetMessageW(&message, nullptr, 0, 0) > 0)
+        {
+          TranslateMessage(&message);
+          DispatchMessageW(&message);
+        }
+      }
+
+      LRESULT CALLBACK RawInputBackend::RawInputWindowProc(
+          HWND window, UINT message, WPARAM wParam, LPARAM lParam)
+      {
+        RawInputBackend* const backend =
+            reinterpret_cast<RawInputBackend*>(GetWindowLongPtrW(window, GWLP_USERDATA));
+
+        if (nullptr != backend)
+        {
+          switch (message)
+          {
+            case WM_INPUT:
+              backend->OnRawInput(reinterpret_cast<HRAWINPUT>(lParam));
+              break;
+
+            case WM_INPUT_DEVICE_CHANGE:
+              if (GIDC_ARRIVAL == wParam)
+                backend->OnDeviceArrival(reinterpret_cast<HANDLE>(lParam));
+              else if (GIDC_REMOVAL == wParam)
+                backend->OnDeviceRemoval(reinterpret_cast<HANDLE>(lParam));
+              return 0;
+
+            default:
+              break;
+          }
+        }
+
+        return DefWindowProcW(window, message, wParam, lParam);
+      }
+
+      void RawInputBackend::OnDeviceArrival(HANDLE deviceHandle)
+      {
+        UINT deviceNameLength = 0;
+        GetRawInputDeviceInfoW(deviceHandle, RIDI_DEVICENAME, nullptr, &deviceNameLength);
+        if (0 == deviceNameLength) return;
+
+        std::vector<wchar_t> deviceName(deviceNameLength + 1, L'\0');
+        if (static_cast<UINT>(-1) ==
+            GetRawInputDeviceInfoW(
+                deviceHandle, RIDI_DEVICENAME, deviceName.data(), &deviceNameLength))
+          return;
+
+        // Device names are not consistent in their use of case.
+        std::wstring upperCaseDeviceName(deviceName.data());
+        std::transform(
+            upperCaseDeviceName.begin(),
+            upperCaseDeviceName.end(),
+            upperCaseDeviceName.begin(),
+            [](wchar_t c) -> wchar_t
+            {
+              return static_cast<wchar_t>(towupper(c));
+            });
+        if (std::wstring::npos == upperCaseDeviceName.find(kXInputCompatibleDeviceNameMarker))
+          return;
+
+        UINT preparsedDataSize = 0;
+        GetRawInputDeviceInfoW(deviceHandle, RIDI_PREPARSEDDATA, nullptr, &preparsedDataSize);
+        if (0 == preparsedDataSize) return;
+
+        std::unique_ptr<uint8_t[]> preparsedData = std::make_unique<uint8_t[]>(preparsedDataSize);
+        if (static_cast<UINT>(-1) ==
+            GetRawInputDeviceInfoW(
+                deviceHandle, RIDI_PREPARSEDDATA, preparsedData.get(), &preparsedDataSize))
+          return;
+
+        const PHIDP_PREPARSED_DATA hidPreparsedData =
+            reinterpret_cast<PHIDP_PREPARSED_DATA>(preparsedData.get());
+
+        HIDP_CAPS hidCaps;
+        if (HIDP_STATUS_SUCCESS != hidFunctions.hidpGetCaps(hidPreparsedData, &hidCaps)) return;
+
+        std::vector<HIDP_VALUE_CAPS> hidValueCaps(hidCaps.NumberInputValueCaps);
+        USHORT numHidValueCaps = hidCaps.NumberInputValueCaps;
+        if ((numHidValueCaps > 0) &&
+            (HIDP_STATUS_SUCCESS !=
+             hidFunctions.hidpGetValueCaps(
+                 HidP_Input, hidValueCaps.data(), &numHidValueCaps, hidPreparsedData)))
+          return;
+
+        std::array<SValueRange, (size_t)EValue::Count> valueRange = {};
+        for (USHORT i = 0; i < numHidValueCaps; ++i)
+        {
+          const HIDP_VALUE_CAPS& valueCaps = hidValueCaps[i];
+          if ((HID_USAGE_PAGE_GENERIC != valueCaps.UsagePage) || (TRUE == valueCaps.IsRange))
+            continue;
+
+          for (size_t value = 0; value < kValueUsages.size(); ++value)
+          {
+            if (kValueUsages[value] != valueCaps.NotRange.Usage) continue;
+
+            // Logical limits are signed, so a maximum that uses every available bit can appear
+            // to be less than the minimum. Such values are actually unsigned.
+            ULONG maximum = static_cast<ULONG>(valueCaps.LogicalMax);
+            if ((valueCaps.LogicalMax < valueCaps.LogicalMin) && (valueCaps.BitSize < 32))
+              maximum = (1ul << valueCaps.BitSize) - 1;
+
+            valueRange[value] = {
+                .present = true,
+                .minimum = static_cast<ULONG>(valueCaps.LogicalMin),
+                .maximum = maximum};
+          }
+        }
+
+        const TControllerIdentifier kControllerCount = GetPhysicalControllerCount();
+
+        TControllerIdentifier assignedControllerIdentifier = kMaxPhysicalControllerCount;
+        {
+          std::scoped_lock lock(slotMutex);
+
+          for (const auto& existingSlot : slot)
+          {
+            if (deviceHandle == existingSlot.deviceHandle) return;
+          }
+
+          for (TControllerIdentifier controllerIdentifier = 0;
+               controllerIdentifier < kControllerCount;
+               ++controllerIdentifier)
+          {
+            if (nullptr != slot[controllerIdentifier].deviceHandle) continue;
+
+            slot[controllerIdentifier] = {
+                .deviceHandle = deviceHandle,
+                .preparsedData = std::move(preparsedData),
+                .valueRange = valueRange,
+                .xinputState = {},
+                .readingTimestamp = 0};
+            assignedControllerIdentifier = controllerIdentifier;
+            break;
+          }
+        }
+
+        if (assignedControllerIdentifier >= kControllerCount)
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Ignoring an XInput-compatible HID device that was connected because all %u physical controllers are already assigned.",
+              (unsigned int)kControllerCount);
+          return;
+        }
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Assigned XInput-compatible HID device %s to physical controller %u.",
+            deviceName.data(),
+            (unsigned int)(1 + assignedControllerIdentifier));
+
+        if (nullptr != arrivalCallback) arrivalCallback();
+      }
+
+      void RawInputBackend::OnDeviceRemoval(HANDLE deviceHandle)
+      {
+        std::scoped_lock lock(slotMutex);
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kMaxPhysicalControllerCount;
+             ++controllerIdentifier)
+        {
+          if (deviceHandle != slot[controllerIdentifier].deviceHandle) continue;
+
+          slot[controllerIdentifier] = {};
+
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Info,
+              L"Released physical controller %u because its XInput-compatible HID device was disconnected.",
+              (unsigned int)(1 + controllerIdentifier));
+          return;
+        }
+      }
+
+      void RawInputBackend::OnRawInput(HRAWINPUT rawInputHandle)
+      {
+        LARGE_INTEGER receivedTimestamp;
+        QueryPerformanceCounter(&receivedTimestamp);
+
+        UINT rawInputSize = 0;
+        GetRawInputData(
+            rawInputHandle, RID_INPUT, nullptr, &rawInputSize, sizeof(RAWINPUTHEADER));
+        if (0 == rawInputSize) return;
+
+        if (rawInputBuffer.size() < rawInputSize) rawInputBuffer.resize(rawInputSize);
+        if (static_cast<UINT>(-1) ==
+            GetRawInputData(
+                rawInputHandle,
+                RID_INPUT,
+                rawInputBuffer.data(),
+                &rawInputSize,
+                sizeof(RAWINPUTHEADER)))
+          return;
+
+        const RAWINPUT* const rawInput = reinterpret_cast<const RAWINPUT*>(rawInputBuffer.data());
+        if ((RIM_TYPEHID != rawInput->header.dwType) || (0 == rawInput->data.hid.dwCount)) return;
+
+        TControllerIdentifier updatedControllerIdentifier = kMaxPhysicalControllerCount;
+        {
+          std::scoped_lock lock(slotMutex);
+
+          for (TControllerIdentifier controllerIdentifier = 0;
+               controllerIdentifier < kMaxPhysicalControllerCount;
+               ++controllerIdentifier)
+          {
+            SSlot& updateSlot = slot[controllerIdentifier];
+            if (rawInput->header.hDevice != updateSlot.deviceHandle) continue;
+
+            // Only the most recent report matters, since each one is a complete snapshot.
+            const DWORD reportSize = rawInput->data.hid.dwSizeHid;
+            PCHAR const lastReport = reinterpret_cast<PCHAR>(const_cast<BYTE*>(
+                &rawInput->data.hid.bRawData[reportSize * (rawInput->data.hid.dwCount - 1)]));
+
+            ParseReport(updateSlot, lastReport, reportSize, updateSlot.xinputState.Gamepad);
+            updateSlot.xinputState.dwPacketNumber += 1;
+            updateSlot.readingTimestamp = receivedTimestamp.QuadPart;
+
+            updatedControllerIdentifier = controllerIdentifier;
+            break;
+          }
+        }
+
+        if ((updatedControllerIdentifier < kMaxPhysicalControllerCount) &&
+            (nullptr != reportCallback))
+          reportCallback(updatedControllerIdentifier);
+      }
+
+      void RawInputBackend::ParseReport(
+          const SSlot& parseSlot, PCHAR report, ULONG reportLength, XINPUT_GAMEPAD& gamepad) const
+      {
+        const PHIDP_PREPARSED_DATA hidPreparsedData =
+            reinterpret_cast<PHIDP_PREPARSED_DATA>(parseSlot.preparsedData.get());
+
+        std::array<double, (size_t)EValue::Count> normalizedValue = {0.5, 0.5, 0.5, 0.5, 0.5, 0.0};
+        std::array<ULONG, (size_t)EValue::Count> rawValue = {};
+        for (size_t value = 0; value < kValueUsages.size(); ++value)
+        {
+          if (false == parseSlot.valueRange[value].present) continue;
+          if (HIDP_STATUS_SUCCESS !=
+              hidFunctions.hidpGetUsageValue(
+                  HidP_Input,
+                  HID_USAGE_PAGE_GENERIC,
+                  0,
+                  kValueUsages[value],
+                  &rawValue[value],
+                  hidPreparsedData,
+                  report,
+                  reportLength))
+            continue;
+
+          normalizedValue[value] = parseSlot.valueRange[value].Normalize(rawValue[value]);
+        }
+
+        // Vertical axes increase downwards in HID and upwards in XInput.
+        gamepad.sThumbLX =
+            XInputThumbstickValue(normalizedValue[(size_t)EValue::LeftStickX], false);
+        gamepad.sThumbLY = XInputThumbstickValue(normalizedValue[(size_t)EValue::LeftStickY], true);
+        gamepad.sThumbRX =
+            XInputThumbstickValue(normalizedValue[(size_t)EValue::RightStickX], false);
+        gamepad.sThumbRY =
+            XInputThumbstickValue(normalizedValue[(size_t)EValue::RightStickY], true);
+
+        // Both triggers share a single axis. The left trigger moves it above center and the right
+        // trigger moves it below center, so pressing both at once reads as neither.
+        const double triggerValue = (normalizedValue[(size_t)EValue::Triggers] * 2.0) - 1.0;
+        gamepad.bLeftTrigger = XInputTriggerValue(std::max(triggerValue, 0.0));
+        gamepad.bRightTrigger = XInputTriggerValue(std::max(-triggerValue, 0.0));
+
+        WORD xinputButtons = 0;
+
+        USAGE buttonUsages[kMaxButtonUsages];
+        ULONG numButtonUsages = _countof(buttonUsages);
+        if (HIDP_STATUS_SUCCESS ==
+            hidFunctions.hidpGetUsages(
+                HidP_Input,
+                HID_USAGE_PAGE_BUTTON,
+                0,
+                buttonUsages,
+                &numButtonUsages,
+                hidPreparsedData,
+                report,
+                reportLength))
+        {
+          for (ULONG i = 0; i < numButtonUsages; ++i)
+          {
+            const USAGE buttonUsage = buttonUsages[i];
+            if ((buttonUsage >= 1) && (buttonUsage <= kXInputButtonForButtonUsage.size()))
+              xinputButtons |= kXInputButtonForButtonUsage[buttonUsage - 1];
+          }
+        }
+
+        // The hat switch reports a position from 0 to 7 relative to its logical minimum, or
+        // anything outside that range when centered.
+        const SValueRange& hatSwitchRange = parseSlot.valueRange[(size_t)EValue::HatSwitch];
+        if (true == hatSwitchRange.present)
+        {
+          const ULONG hatPosition = rawValue[(size_t)EValue::HatSwitch] - hatSwitchRange.minimum;
+          if ((rawValue[(size_t)EValue::HatSwitch] >= hatSwitchRange.minimum) &&
+              (hatPosition < kXInputButtonsForHatPosition.size()))
+            xinputButtons |= kXInputButtonsForHatPosition[hatPosition];
+        }
+
+        gamepad.wButtons = xinputButtons;
+      }
+
+      IPhysicalControllerBackend* CreateRawInput(
+          TArrivalCallback arrivalCallback, TReportCallback reportCallback)
+      {
+        SHidFunctions hidFunctions;
+        if (false == ImportHidFunctions(hidFunctions))
+        {
+          Infra::Message::Output(
+              Infra::Message::ESeverity::Warning,
+              L"Failed to import HID parsing functions, so Raw Input cannot be used.");
+          return nullptr;
+        }
+
+        // If the window cannot be made ready then the thread exits without having registered
+        // for anything, but the backend object is still never destroyed in case a message
+        // arrives while the thread is exiting.
+        RawInputBackend* const backend =
+            new RawInputBackend(hidFunctions, arrivalCallback, reportCallback);
+
+        std::promise<bool> windowReady;
+        std::future<bool> windowReadyResult = windowReady.get_future();
+        WorkerThread::StartDetached(
+            L"Xidi Raw Input",
+            WorkerThread::EPriority::LatencyCritical,
+            &RawInputBackend::ReceiveRawInput,
+            backend,
+            std::move(windowReady));
+
+        if (false == windowReadyResult.get()) return nullptr;
+
+        return backend;
+      }
+    } // namespace PhysicalControllerBackend
+  } // namespace Controller
+} // namespace Xidi
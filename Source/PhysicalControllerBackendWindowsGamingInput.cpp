@@ -0,0 +1,598 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PhysicalControllerBackendWindowsGamingInput.cpp
+ *   Implementation of the physical controller backend that uses the `Windows.Gaming.Input`
+ *   gamepad API. The Windows Runtime is accessed through its ABI rather than a language
+ *   projection, and all runtime functions are imported dynamically, so that Xidi continues to load
+ *   on versions of Windows that do not offer it.
+ **************************************************************************************************/
+
+#include "PhysicalControllerBackend.h"
+
+// Windows Runtime header files depend on Windows header files, which are are sensitive to include
+// order. See "ApiWindows.h" for more information.
+
+// clang-format off
+
+#include "ApiWindows.h"
+#include <roapi.h>
+#include <winstring.h>
+#include <windows.gaming.input.h>
+
+// clang-format on
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+
+#include <Infra/Core/Message.h>
+
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "PhysicalController.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace PhysicalControllerBackend
+    {
+      using ABI::Windows::Gaming::Input::GamepadButtons;
+      using ABI::Windows::Gaming::Input::GamepadReading;
+      using ABI::Windows::Gaming::Input::GamepadVibration;
+      using ABI::Windows::Gaming::Input::IGamepad;
+      using ABI::Windows::Gaming::Input::IGamepadStatics;
+
+      /// Type of the event handler that receives gamepad connection and disconnection events.
+      using TGamepadEventHandler =
+          ABI::Windows::Foundation::IEventHandler<ABI::Windows::Gaming::Input::Gamepad*>;
+
+      /// Type of the read-only list of gamepads that are currently connected.
+      using TGamepadVectorView =
+          ABI::Windows::Foundation::Collections::IVectorView<ABI::Windows::Gaming::Input::Gamepad*>;
+
+      /// Correspondence between a `Windows.Gaming.Input` gamepad button and an XInput button.
+      struct SButtonCorrespondence
+      {
+        /// `Windows.Gaming.Input` button flag.
+        GamepadButtons gamepadButton;
+
+        /// XInput button flag.
+        WORD xinputButton;
+      };
+
+      /// All buttons that have XInput equivalents. The Guide button is not reported by this API.
+      static constexpr std::array kButtonCorrespondences = {
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_DPadUp, XINPUT_GAMEPAD_DPAD_UP},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_DPadDown, XINPUT_GAMEPAD_DPAD_DOWN},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_DPadLeft, XINPUT_GAMEPAD_DPAD_LEFT},
+          SButtonCorrespondence{
+              GamepadButtons::GamepadButtons_DPadRight, XINPUT_GAMEPAD_DPAD_RIGHT},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_Menu, XINPUT_GAMEPAD_START},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_View, XINPUT_GAMEPAD_BACK},
+          SButtonCorrespondence{
+              GamepadButtons::GamepadButtons_LeftThumbstick, XINPUT_GAMEPAD_LEFT_THUMB},
+          SButtonCorrespondence{
+              GamepadButtons::GamepadButtons_RightThumbstick, XINPUT_GAMEPAD_RIGHT_THUMB},
+          SButtonCorrespondence{
+              GamepadButtons::GamepadButtons_LeftShoulder, XINPUT_GAMEPAD_LEFT_SHOULDER},
+          SButtonCorrespondence{
+              GamepadButtons::GamepadButtons_RightShoulder, XINPUT_GAMEPAD_RIGHT_SHOULDER},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_A, XINPUT_GAMEPAD_A},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_B, XINPUT_GAMEPAD_B},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_X, XINPUT_GAMEPAD_X},
+          SButtonCorrespondence{GamepadButtons::GamepadButtons_Y, XINPUT_GAMEPAD_Y}};
+
+      /// Windows Runtime functions, which are imported dynamically because they are not
+      /// available on all supported versions of Windows.
+      struct SRuntimeFunctions
+      {
+        /// Keeps the multithreaded apartment alive, so that threads that never initialize COM
+        /// can still use Windows Runtime objects.
+        decltype(&CoIncrementMTAUsage) coIncrementMTAUsage;
+
+        /// Retrieves the activation factory for a Windows Runtime class.
+        decltype(&RoGetActivationFactory) roGetActivationFactory;
+
+        /// Creates a Windows Runtime string that refers to existing string data.
+        decltype(&WindowsCreateStringReference) windowsCreateStringReference;
+      };
+
+      /// Attempts to import all needed Windows Runtime functions.
+      /// @param [out] runtimeFunctions Filled in with the addresses of the imported functions.
+      /// @return `true` if all functions were imported successfully, `false` otherwise.
+      static bool ImportRuntimeFunctions(SRuntimeFunctions& runtimeFunctions)
+      {
+        HMODULE combaseLibrary = LoadLibraryEx(
+            Strings::kStrLibraryNameCombase.data(), nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+        if (nullptr == combaseLibrary) return false;
+
+        runtimeFunctions = {
+            .coIncrementMTAUsage = reinterpret_cast<decltype(&CoIncrementMTAUsage)>(
+                GetProcAddress(combaseLibrary, "CoIncrementMTAUsage")),
+            .roGetActivationFactory = reinterpret_cast<decltype(&RoGetActivationFactory)>(
+                GetProcAddress(combaseLibrary, "RoGetActivationFactory")),
+            .windowsCreateStringReference =
+                reinterpret_cast<decltype(&WindowsCreateStringReference)>(
+                    GetProcAddress(combaseLibrary, "WindowsCreateStringReference"))};
+
+        return (
+            (nullptr != runtimeFunctions.coIncrementMTAUsage) &&
+            (nullptr != runtimeFunctions.roGetActivationFactory) &&
+            (nullptr != runtimeFunctions.windowsCreateStringReference));
+      }
+
+      /// Determines if two gamepad interface pointers refer to the same gamepad object. COM object
+      /// identity is defined by the `IUnknown` interface pointer.
+      /// @param [in] gamepadA First gamepad to compare.
+      /// @param [in] gamepadB Second gamepad to compare.
+      /// @return `true` if both refer to the same object, `false` otherwise.
+      static bool IsSameGamepad(IGamepad* gamepadA, IGamepad* gamepadB)
+      {
+        if (gamepadA == gamepadB) return true;
+
+        IUnknown* unknownA = nullptr;
+        IUnknown* unknownB = nullptr;
+        gamepadA->QueryInterface(IID_PPV_ARGS(&unknownA));
+        gamepadB->QueryInterface(IID_PPV_ARGS(&unknownB));
+
+        const bool isSameGamepad = ((nullptr != unknownA) && (unknownA == unknownB));
+
+        if (nullptr != unknownA) unknownA->Release();
+        if (nullptr != unknownB) unknownB->Release();
+
+        return isSameGamepad;
+      }
+
+      /// Converts a thumbstick axis value to XInput representation.
+      /// @param [in] value Thumbstick axis value, from -1.0 to +1.0.
+      /// @return Equivalent XInput thumbstick axis value.
+      static SHORT XInputThumbstickValue(double value)
+      {
+        return static_cast<SHORT>(std::clamp(
+            value * static_cast<double>(std::numeric_limits<SHORT>::max()),
+            static_cast<double>(std::numeric_limits<SHORT>::min()),
+            static_cast<double>(std::numeric_limits<SHORT>::max())));
+      }
+
+      /// Converts a trigger value to XInput representation.
+      /// @param [in] value Trigger value, from 0.0 to 1.0.
+      /// @return Equivalent XInput trigger value.
+      static BYTE XInputTriggerValue(double value)
+      {
+        return static_cast<BYTE>(std::clamp(
+            value * static_cast<double>(std::numeric_limits<BYTE>::max()),
+            0.0,
+            static_cast<double>(std::numeric_limits<BYTE>::max())));
+      }
+
+      /// Converts a physical actuator value to `Windows.Gaming.Input` representation.
+      /// @param [in] value Physical actuator value.
+      /// @return Equivalent vibration value, from 0.0 to 1.0.
+      static double GamepadVibrationValue(ForceFeedback::TPhysicalActuatorValue value)
+      {
+        return static_cast<double>(value) /
+            static_cast<double>(std::numeric_limits<ForceFeedback::TPhysicalActuatorValue>::max());
+      }
+
+      /// Reads and actuates physical controllers using the `Windows.Gaming.Input` gamepad API.
+      /// Gamepads are assigned to physical controller identifiers in the order in which they
+      /// connect, and each keeps its identifier until it disconnects.
+      class WindowsGamingInputBackend : public IPhysicalControllerBackend
+      {
+      public:
+
+        inline WindowsGamingInputBackend(
+            IGamepadStatics* gamepadStatics, TArrivalCallback arrivalCallback)
+            : gamepadStatics(gamepadStatics),
+              arrivalCallback(arrivalCallback),
+              performanceCounterFrequency(),
+              gamepadSlotMutex(),
+              gamepadSlot()
+        {
+          LARGE_INTEGER frequency;
+          QueryPerformanceFrequency(&frequency);
+          performanceCounterFrequency = frequency.QuadPart;
+        }
+
+        WindowsGamingInputBackend(const WindowsGamingInputBackend& other) = delete;
+        WindowsGamingInputBackend& operator=(const WindowsGamingInputBackend& other) = delete;
+
+        /// Registers for gamepad connection and disconnection events and assigns identifiers to
+        /// all gamepads that are already connected.
+        /// @return `true` if successful, `false` otherwise.
+        bool Start(void);
+
+        /// Assigns an identifier to a newly-connected gamepad, if one is available and the
+        /// gamepad does not already have one.
+        /// @param [in] gamepad Gamepad that was connected.
+        void OnGamepadAdded(IGamepad* gamepad);
+
+        /// Releases the identifier assigned to a gamepad that disconnected.
+        /// @param [in] gamepad Gamepad that was disconnected.
+        void OnGamepadRemoved(IGamepad* gamepad);
+
+        // IPhysicalControllerBackend
+        const wchar_t* GetName(void) const override
+        {
+          return L"Windows.Gaming.Input";
+        }
+
+        DWORD ReadState(
+            TControllerIdentifier controllerIdentifier,
+            bool includeGuideButton,
+            XINPUT_STATE& xinputState,
+            int64_t& readingTimestamp) override;
+
+        DWORD WriteVibration(
+            TControllerIdentifier controllerIdentifier,
+            ForceFeedback::SPhysicalActuatorComponents vibration) override;
+
+      private:
+
+        /// Converts a reading timestamp, which is expressed in microseconds using the same time
+        /// base as the performance counter, to a performance counter value.
+        /// @param [in] timestampMicroseconds Reading timestamp.
+        /// @return Equivalent performance counter value.
+        inline int64_t PerformanceCounterFromTimestamp(uint64_t timestampMicroseconds) const
+        {
+          // Whole seconds and the remainder are converted separately to avoid overflow.
+          constexpr uint64_t kMicrosecondsPerSecond = 1000000;
+          const uint64_t frequency = static_cast<uint64_t>(performanceCounterFrequency);
+          return static_cast<int64_t>(
+              ((timestampMicroseconds / kMicrosecondsPerSecond) * frequency) +
+              (((timestampMicroseconds % kMicrosecondsPerSecond) * frequency) /
+               kMicrosecondsPerSecond));
+        }
+
+        /// Gamepad activation factory, through which connection events are received.
+        IGamepadStatics* const gamepadStatics;
+
+        /// Function to invoke whenever a gamepad is connected.
+        const TArrivalCallback arrivalCallback;
+
+        /// Performance counter frequency, in ticks per second.
+        int64_t performanceCounterFrequency;
+
+        /// Guards the assignment of gamepads to physical controller identifiers.
+        std::shared_mutex gamepadSlotMutex;
+
+        /// Gamepad assigned to each physical controller identifier, or `nullptr` if none is.
+        /// Each non-null entry holds a reference to its gamepad.
+        IGamepad* gamepadSlot[kMaxPhysicalControllerCount];
+      };
+
+      /// Receives gamepad connection or disconnection events and forwards them to the backend.
+      /// Agile, so that the runtime can deliver events on any thread without marshalling.
+      class GamepadEventHandler : public TGamepadEventHandler, public IAgileObject
+      {
+      public:
+
+        /// Identifies the type of event that a handler object receives.
+        enum class EEventType
+        {
+          Added,
+          Removed
+        };
+
+        inline GamepadEventHandler(WindowsGamingInputBackend& backend, EEventType eventType)
+            : backend(backend), eventType(eventType), refCount(1)
+        {}
+
+        // IUnknown
+        HRESULT __stdcall QueryInterface(REFIID riid, LPVOID* ppvObj) override
+        {
+          if (nullptr == ppvObj) return E_POINTER;
+
+          if ((IID_IUnknown == riid) || (__uuidof(TGamepadEventHandler) == riid))
+            *ppvObj = static_cast<TGamepadEventHandler*>(this);
+          else if (__uuidof(IAgileObject) == riid)
+            *ppvObj = static_cast<IAgileObject*>(this);
+          else
+          {
+            *ppvObj = nullptr;
+            return E_NOINTERFACE;
+          }
+
+          AddRef();
+          return S_OK;
+        }
+
+        ULONG __stdcall AddRef(void) override
+        {
+          return ++refCount;
+        }
+
+        ULONG __stdcall Release(void) override
+        {
+          const ULONG remainingRefs = --refCount;
+          if (0 == remainingRefs) delete this;
+          return remainingRefs;
+        }
+
+        // IEventHandler
+        HRESULT __stdcall Invoke(IInspectable*, IGamepad* gamepad) override
+        {
+          if (nullptr == gamepad) return S_OK;
+
+          switch (eventType)
+          {
+            case EEventType::Added:
+              backend.OnGamepadAdded(gamepad);
+              break;
+            case EEventType::Removed:
+              backend.OnGamepadRemoved(gamepad);
+              break;
+          }
+
+          return S_OK;
+        }
+
+      private:
+
+        /// Backend to which events are forwarded.
+        WindowsGamingInputBackend& backend;
+
+        /// Type of event that this handler receives.
+        const EEventType eventType;
+
+        /// Reference count.
+        std::atomic<ULONG> refCount;
+      };
+
+      bool WindowsGamingInputBackend::Start(void)
+      {
+        // Registrations are intentionally never revoked, because this object lives for the rest
+        // of the process lifetime. The event source holds its own references to the handlers.
+        EventRegistrationToken eventRegistrationToken;
+
+        GamepadEventHandler* const addedHandler =
+            new GamepadEventHandler(*this, GamepadEventHandler::EEventType::Added);
+        const HRESULT addedResult =
+            gamepadStatics->add_GamepadAdded(addedHandler, &eventRegistrationToken);
+        addedHandler->Release();
+        if (FAILED(addedResult))
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with HRESULT 0x%08x to register for Windows.Gaming.Input gamepad connection events.",
+              (unsigned int)addedResult);
+          return false;
+        }
+
+        GamepadEventHandler* const removedHandler =
+            new GamepadEventHandler(*this, GamepadEventHandler::EEventType::Removed);
+        const HRESULT removedResult =
+            gamepadStatics->add_GamepadRemoved(removedHandler, &eventRegistrationToken);
+        removedHandler->Release();
+        if (FAILED(removedResult))
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with HRESULT 0x%08x to register for Windows.Gaming.Input gamepad disconnection events.",
+              (unsigned int)removedResult);
+          return false;
+        }
+
+        // Gamepads that were connected before registration are not necessarily announced using
+        // connection events, so they are picked up from the list of connected gamepads. Any
+        // duplicates are ignored.
+        TGamepadVectorView* connectedGamepads = nullptr;
+        if (SUCCEEDED(gamepadStatics->get_Gamepads(&connectedGamepads)))
+        {
+          unsigned int numConnectedGamepads = 0;
+          connectedGamepads->get_Size(&numConnectedGamepads);
+
+          for (unsigned int i = 0; i < numConnectedGamepads; ++i)
+          {
+            IGamepad* connectedGamepad = nullptr;
+            if (SUCCEEDED(connectedGamepads->GetAt(i, &connectedGamepad)))
+            {
+              OnGamepadAdded(connectedGamepad);
+              connectedGamepad->Release();
+            }
+          }
+
+          connectedGamepads->Release();
+        }
+
+        return true;
+      }
+
+      void WindowsGamingInputBackend::OnGamepadAdded(IGamepad* gamepad)
+      {
+        {
+          std::unique_lock lock(gamepadSlotMutex);
+
+          for (IGamepad* assignedGamepad : gamepadSlot)
+          {
+            if ((nullptr != assignedGamepad) && (true == IsSameGamepad(assignedGamepad, gamepad)))
+              return;
+          }
+
+          const TControllerIdentifier kControllerCount = GetPhysicalControllerCount();
+
+          TControllerIdentifier controllerIdentifier = 0;
+          while ((controllerIdentifier < kControllerCount) &&
+                 (nullptr != gamepadSlot[controllerIdentifier]))
+            ++controllerIdentifier;
+
+          if (controllerIdentifier >= kControllerCount)
+          {
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Warning,
+                L"Ignoring a Windows.Gaming.Input gamepad that was connected because all %u physical controllers are already assigned.",
+                (unsigned int)kControllerCount);
+            return;
+          }
+
+          gamepad->AddRef();
+          gamepadSlot[controllerIdentifier] = gamepad;
+
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Info,
+              L"Assigned a Windows.Gaming.Input gamepad that was connected to physical controller %u.",
+              (unsigned int)(1 + controllerIdentifier));
+        }
+
+        if (nullptr != arrivalCallback) arrivalCallback();
+      }
+
+      void WindowsGamingInputBackend::OnGamepadRemoved(IGamepad* gamepad)
+      {
+        std::unique_lock lock(gamepadSlotMutex);
+
+        for (TControllerIdentifier controllerIdentifier = 0;
+             controllerIdentifier < kMaxPhysicalControllerCount;
+             ++controllerIdentifier)
+        {
+          IGamepad*& assignedGamepad = gamepadSlot[controllerIdentifier];
+          if ((nullptr == assignedGamepad) || (false == IsSameGamepad(assignedGamepad, gamepad)))
+            continue;
+
+          assignedGamepad->Release();
+          assignedGamepad = nullptr;
+
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Info,
+              L"Released physical controller %u because its Windows.Gaming.Input gamepad was disconnected.",
+              (unsigned int)(1 + controllerIdentifier));
+          return;
+        }
+      }
+
+      DWORD WindowsGamingInputBackend::ReadState(
+          TControllerIdentifier controllerIdentifier,
+          bool,
+          XINPUT_STATE& xinputState,
+          int64_t& readingTimestamp)
+      {
+        readingTimestamp = 0;
+        if (controllerIdentifier >= kMaxPhysicalControllerCount)
+          return ERROR_DEVICE_NOT_CONNECTED;
+
+        GamepadReading reading;
+        {
+          std::shared_lock lock(gamepadSlotMutex);
+
+          IGamepad* const gamepad = gamepadSlot[controllerIdentifier];
+          if (nullptr == gamepad) return ERROR_DEVICE_NOT_CONNECTED;
+          if (FAILED(gamepad->GetCurrentReading(&reading))) return ERROR_DEVICE_NOT_CONNECTED;
+        }
+
+        WORD xinputButtons = 0;
+        for (const auto& buttonCorrespondence : kButtonCorrespondences)
+        {
+          if (0 != (reading.Buttons & buttonCorrespondence.gamepadButton))
+            xinputButtons |= buttonCorrespondence.xinputButton;
+        }
+
+        // The reading timestamp changes whenever the gamepad reports new data, so its lower bits
+        // serve the same purpose as an XInput packet number.
+        xinputState = {
+            .dwPacketNumber = static_cast<DWORD>(reading.Timestamp),
+            .Gamepad = {
+                .wButtons = xinputButtons,
+                .bLeftTrigger = XInputTriggerValue(reading.LeftTrigger),
+                .bRightTrigger = XInputTriggerValue(reading.RightTrigger),
+                .sThumbLX = XInputThumbstickValue(reading.LeftThumbstickX),
+                .sThumbLY = XInputThumbstickValue(reading.LeftThumbstickY),
+                .sThumbRX = XInputThumbstickValue(reading.RightThumbstickX),
+                .sThumbRY = XInputThumbstickValue(reading.RightThumbstickY)}};
+
+        readingTimestamp = PerformanceCounterFromTimestamp(reading.Timestamp);
+        return ERROR_SUCCESS;
+      }
+
+      DWORD WindowsGamingInputBackend::WriteVibration(
+          TControllerIdentifier controllerIdentifier,
+          ForceFeedback::SPhysicalActuatorComponents vibration)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount)
+          return ERROR_DEVICE_NOT_CONNECTED;
+
+        std::shared_lock lock(gamepadSlotMutex);
+
+        IGamepad* const gamepad = gamepadSlot[controllerIdentifier];
+        if (nullptr == gamepad) return ERROR_DEVICE_NOT_CONNECTED;
+
+        const GamepadVibration gamepadVibration = {
+            .LeftMotor = GamepadVibrationValue(vibration.leftMotor),
+            .RightMotor = GamepadVibrationValue(vibration.rightMotor),
+            .LeftTrigger = GamepadVibrationValue(vibration.leftImpulseTrigger),
+            .RightTrigger = GamepadVibrationValue(vibration.rightImpulseTrigger)};
+        if (FAILED(gamepad->put_Vibration(gamepadVibration))) return ERROR_DEVICE_NOT_CONNECTED;
+
+        return ERROR_SUCCESS;
+      }
+
+      IPhysicalControllerBackend* CreateWindowsGamingInput(TArrivalCallback arrivalCallback)
+      {
+        SRuntimeFunctions runtimeFunctions;
+        if (false == ImportRuntimeFunctions(runtimeFunctions))
+        {
+          Infra::Message::Output(
+              Infra::Message::ESeverity::Warning,
+              L"The Windows Runtime is not available on this system, so Windows.Gaming.Input cannot be used.");
+          return nullptr;
+        }
+
+        // The cookie is intentionally never used to decrement the usage count, so that the
+        // multithreaded apartment stays alive for the rest of the process lifetime.
+        CO_MTA_USAGE_COOKIE mtaUsageCookie = nullptr;
+        const HRESULT mtaUsageResult = runtimeFunctions.coIncrementMTAUsage(&mtaUsageCookie);
+        if (FAILED(mtaUsageResult))
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with HRESULT 0x%08x to keep the multithreaded apartment alive, so Windows.Gaming.Input cannot be used.",
+              (unsigned int)mtaUsageResult);
+          return nullptr;
+        }
+
+        const std::wstring_view kGamepadClassName = RuntimeClass_Windows_Gaming_Input_Gamepad;
+        HSTRING_HEADER gamepadClassNameHeader;
+        HSTRING gamepadClassName = nullptr;
+        runtimeFunctions.windowsCreateStringReference(
+            kGamepadClassName.data(),
+            static_cast<UINT32>(kGamepadClassName.length()),
+            &gamepadClassNameHeader,
+            &gamepadClassName);
+
+        IGamepadStatics* gamepadStatics = nullptr;
+        const HRESULT activationResult = runtimeFunctions.roGetActivationFactory(
+            gamepadClassName, IID_PPV_ARGS(&gamepadStatics));
+        if (FAILED(activationResult))
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Warning,
+              L"Failed with HRESULT 0x%08x to obtain the Windows.Gaming.Input gamepad activation factory.",
+              (unsigned int)activationResult);
+          return nullptr;
+        }
+
+        WindowsGamingInputBackend* const backend =
+            new WindowsGamingInputBackend(gamepadStatics, arrivalCallback);
+        if (false == backend->Start())
+        {
+          // Event handlers that were already registered may still refer to the backend object,
+          // so it cannot safely be destroyed.
+          return nullptr;
+        }
+
+        return backend;
+      }
+    } // namespace PhysicalControllerBackend
+  } // namespace Controller
+} // namespace Xidi
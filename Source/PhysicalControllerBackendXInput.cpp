@@ -0,0 +1,73 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PhysicalControllerBackendXInput.cpp
+ *   Implementation of the physical controller backend that uses the XInput library.
+ **************************************************************************************************/
+
+#include "PhysicalControllerBackend.h"
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "ImportApiXInput.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace PhysicalControllerBackend
+    {
+      /// Reads and actuates physical controllers using the imported XInput library functions.
+      class XInputBackend : public IPhysicalControllerBackend
+      {
+      public:
+
+        // IPhysicalControllerBackend
+        const wchar_t* GetName(void) const override
+        {
+          return L"XInput";
+        }
+
+        DWORD ReadState(
+            TControllerIdentifier controllerIdentifier,
+            bool includeGuideButton,
+            XINPUT_STATE& xinputState,
+            int64_t& readingTimestamp) override
+        {
+          readingTimestamp = 0;
+
+          // Physical controllers beyond those that XInput supports are always disconnected.
+          if (controllerIdentifier >= XUSER_MAX_COUNT) return ERROR_DEVICE_NOT_CONNECTED;
+
+          if (true == includeGuideButton)
+            return ImportApiXInput::XInputGetStateEx(controllerIdentifier, &xinputState);
+
+          return ImportApiXInput::XInputGetState(controllerIdentifier, &xinputState);
+        }
+
+        DWORD WriteVibration(
+            TControllerIdentifier controllerIdentifier,
+            ForceFeedback::SPhysicalActuatorComponents vibration) override
+        {
+          if (controllerIdentifier >= XUSER_MAX_COUNT) return ERROR_DEVICE_NOT_CONNECTED;
+
+          // Impulse triggers are ignored because the XInput API does not support them.
+          XINPUT_VIBRATION xinputVibration = {
+              .wLeftMotorSpeed = vibration.leftMotor, .wRightMotorSpeed = vibration.rightMotor};
+          return ImportApiXInput::XInputSetState((DWORD)controllerIdentifier, &xinputVibration);
+        }
+      };
+
+      IPhysicalControllerBackend& XInput(void)
+      {
+        static XInputBackend xinputBackend;
+        return xinputBackend;
+      }
+    } // namespace PhysicalControllerBackend
+  } // namespace Controller
+} // namespace Xidi
@@ -0,0 +1,139 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file PollingStatistics.cpp
+ *   Implementation of statistics about how physical controller polling is scheduled and how long
+ *   each part of a poll takes.
+ **************************************************************************************************/
+
+#include "PollingStatistics.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "ControllerTypes.h"
+#include "DurationHistogram.h"
+#include "PeriodicTimer.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace PollingStatistics
+    {
+      /// Holds all of the statistics for a single physical controller. Counters are updated using
+      /// relaxed atomic operations so that they can be read at any time from any thread. Each
+      /// polling thread updates only the statistics for its own physical controller, so they are
+      /// kept on separate cache lines.
+      struct alignas(64) SControllerStatistics
+      {
+        /// Configured polling period, in microseconds.
+        std::atomic<uint64_t> configuredPeriodMicroseconds;
+
+        /// Whether or not polls are scheduled using a high-resolution waitable timer.
+        std::atomic<bool> isHighResolutionTimer;
+
+        /// Number of whole polling periods skipped.
+        std::atomic<uint64_t> numMissedDeadlines;
+
+        /// Time between the starts of successive scheduled polls.
+        DurationHistogram pollInterval;
+
+        /// Time spent in each XInput state query.
+        DurationHistogram xinputGetStateDuration;
+
+        /// Time spent mapping physical controller state to virtual controller state.
+        DurationHistogram mappingDuration;
+      };
+
+      /// System timer resolution requested at startup, in milliseconds.
+      static std::atomic<unsigned int> systemTimerResolutionMilliseconds = 0;
+
+      /// Statistics for each physical controller.
+      static SControllerStatistics controllerStatistics[kMaxPhysicalControllerCount];
+
+      /// Converts the interval between two performance counter values to microseconds.
+      /// @param [in] beginTicks Performance counter value at the start of the interval.
+      /// @param [in] endTicks Performance counter value at the end of the interval.
+      /// @return Length of the interval in microseconds, or 0 if it is negative.
+      static uint64_t IntervalMicroseconds(int64_t beginTicks, int64_t endTicks)
+      {
+        if (endTicks <= beginTicks) return 0;
+        return (uint64_t)PeriodicTimer::MicrosecondsFromTicks(endTicks - beginTicks);
+      }
+
+      SStatistics GetStatistics(TControllerIdentifier controllerIdentifier)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return {};
+
+        const SControllerStatistics& statistics = controllerStatistics[controllerIdentifier];
+        return {
+            .configuredPeriodMicroseconds =
+                statistics.configuredPeriodMicroseconds.load(std::memory_order_relaxed),
+            .isHighResolutionTimer =
+                statistics.isHighResolutionTimer.load(std::memory_order_relaxed),
+            .systemTimerResolutionMilliseconds =
+                systemTimerResolutionMilliseconds.load(std::memory_order_relaxed),
+            .numMissedDeadlines = statistics.numMissedDeadlines.load(std::memory_order_relaxed),
+            .pollInterval = statistics.pollInterval.GetStatistics(),
+            .xinputGetStateDuration = statistics.xinputGetStateDuration.GetStatistics(),
+            .mappingDuration = statistics.mappingDuration.GetStatistics()};
+      }
+
+      void RecordSystemTimerResolution(unsigned int resolutionMilliseconds)
+      {
+        systemTimerResolutionMilliseconds.store(resolutionMilliseconds, std::memory_order_relaxed);
+      }
+
+      void RecordTimerConfiguration(
+          TControllerIdentifier controllerIdentifier, int64_t periodTicks, bool isHighResolution)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        SControllerStatistics& statistics = controllerStatistics[controllerIdentifier];
+        statistics.configuredPeriodMicroseconds.store(
+            IntervalMicroseconds(0, periodTicks), std::memory_order_relaxed);
+        statistics.isHighResolutionTimer.store(isHighResolution, std::memory_order_relaxed);
+      }
+
+      void RecordScheduledPoll(
+          TControllerIdentifier controllerIdentifier,
+          int64_t pollTicks,
+          int64_t previousPollTicks,
+          unsigned int skippedPeriods)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        SControllerStatistics& statistics = controllerStatistics[controllerIdentifier];
+
+        if (0 != skippedPeriods)
+          statistics.numMissedDeadlines.fetch_add(skippedPeriods, std::memory_order_relaxed);
+
+        if (0 != previousPollTicks)
+          statistics.pollInterval.Record(IntervalMicroseconds(previousPollTicks, pollTicks));
+      }
+
+      void RecordXInputGetState(
+          TControllerIdentifier controllerIdentifier, int64_t beginTicks, int64_t endTicks)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        controllerStatistics[controllerIdentifier].xinputGetStateDuration.Record(
+            IntervalMicroseconds(beginTicks, endTicks));
+      }
+
+      void RecordMapping(
+          TControllerIdentifier controllerIdentifier, int64_t beginTicks, int64_t endTicks)
+      {
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        controllerStatistics[controllerIdentifier].mappingDuration.Record(
+            IntervalMicroseconds(beginTicks, endTicks));
+      }
+    } // namespace PollingStatistics
+  } // namespace Controller
+} // namespace Xidi
@@ -0,0 +1,111 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ProfiledMutex.cpp
+ *   Implementation of lock contention statistics collection and reporting.
+ **************************************************************************************************/
+
+#include "ProfiledMutex.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string_view>
+
+#include <Infra/Core/Message.h>
+
+namespace Xidi
+{
+  namespace LockProfile
+  {
+    /// Retrieves the registry of lock statistics objects, keyed by lock name.
+    /// @return Mutable reference to the registry.
+    static std::map<std::wstring_view, SLockStatistics>& Registry(void)
+    {
+      static std::map<std::wstring_view, SLockStatistics> registry;
+      return registry;
+    }
+
+    /// Retrieves the mutex that guards the registry of lock statistics objects. This mutex is
+    /// itself never profiled.
+    /// @return Mutable reference to the mutex.
+    static std::mutex& RegistryMutex(void)
+    {
+      static std::mutex registryMutex;
+      return registryMutex;
+    }
+
+    /// Raises an atomically-stored maximum to the specified value if it is currently lower.
+    /// @param [in, out] maximum Stored maximum value.
+    /// @param [in] value Candidate value.
+    static inline void UpdateMaximum(std::atomic<uint64_t>& maximum, uint64_t value)
+    {
+      uint64_t currentMaximum = maximum.load(std::memory_order_relaxed);
+      while ((value > currentMaximum) &&
+             (false ==
+              maximum.compare_exchange_weak(currentMaximum, value, std::memory_order_relaxed)))
+        ;
+    }
+
+    SLockStatistics* Register(const wchar_t* name)
+    {
+      std::scoped_lock lock(RegistryMutex());
+      return &Registry().try_emplace(name).first->second;
+    }
+
+    void RecordAcquisition(SLockStatistics* statistics, TClock::duration waitTime)
+    {
+      statistics->numAcquisitions.fetch_add(1, std::memory_order_relaxed);
+      if (TClock::duration::zero() == waitTime) return;
+
+      const uint64_t waitNanoseconds =
+          (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime).count();
+      statistics->numContendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+      statistics->totalWaitNanoseconds.fetch_add(waitNanoseconds, std::memory_order_relaxed);
+      UpdateMaximum(statistics->maxWaitNanoseconds, waitNanoseconds);
+    }
+
+    void RecordRelease(SLockStatistics* statistics, TClock::duration holdTime)
+    {
+      const uint64_t holdNanoseconds =
+          (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(holdTime).count();
+      statistics->totalHoldNanoseconds.fetch_add(holdNanoseconds, std::memory_order_relaxed);
+      UpdateMaximum(statistics->maxHoldNanoseconds, holdNanoseconds);
+    }
+
+    void OutputSummary(void)
+    {
+#ifdef XIDI_PROFILE_LOCKS
+      if (false == Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Info))
+        return;
+
+      std::scoped_lock lock(RegistryMutex());
+      for (const auto& [name, statistics] : Registry())
+      {
+        const uint64_t numAcquisitions = statistics.numAcquisitions.load();
+        if (0 == numAcquisitions) continue;
+
+        const uint64_t numContendedAcquisitions = statistics.numContendedAcquisitions.load();
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Lock %s: %llu acquisitions, %llu contended (%.2f%%), wait total %llu us maximum %llu us, hold total %llu us maximum %llu us.",
+            name.data(),
+            numAcquisitions,
+            numContendedAcquisitions,
+            (100.0 * (double)numContendedAcquisitions) / (double)numAcquisitions,
+            statistics.totalWaitNanoseconds.load() / 1000,
+            statistics.maxWaitNanoseconds.load() / 1000,
+            statistics.totalHoldNanoseconds.load() / 1000,
+            statistics.maxHoldNanoseconds.load() / 1000);
+      }
+#endif
+    }
+  } // namespace LockProfile
+} // namespace Xidi
@@ -11,12 +11,39 @@
 
 #include "SetHooks.h"
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <Hookshot/Hookshot.h>
 #include <Infra/Core/Message.h>
 #include <Infra/Core/Strings.h>
 
 namespace Xidi
 {
+  /// Holds the addresses needed to hook a single function, resolved before any of them are hooked.
+  struct SHookTarget
+  {
+    /// Name of the function being hooked, as the system library exports it.
+    std::wstring_view functionName;
+
+    /// Address of the function in the system library.
+    void* systemFunc;
+
+    /// Address of the function in the main Xidi library that replaces it.
+    void* replacementFunc;
+  };
+
+  /// Appends an exported function name to a narrow-character string. Exported function names
+  /// consist only of ASCII characters, so each character is narrowed directly.
+  /// @param [in, out] destination String to which to append.
+  /// @param [in] functionName Exported function name to append.
+  static void AppendFunctionNameAscii(std::string& destination, std::wstring_view functionName)
+  {
+    for (const wchar_t functionNameChar : functionName)
+      destination.push_back((char)functionNameChar);
+  }
+
   void OutputSetHookResult(const wchar_t* functionName, Hookshot::EResult setHookResult)
   {
     if (Hookshot::SuccessfulResult(setHookResult))
@@ -69,12 +96,23 @@ namespace Xidi
       return;
     }
 
-    std::unordered_map<std::wstring_view, const void*> replacementImportFunctions;
+    // All target addresses are resolved before any hooks are set so that setting the hooks, which
+    // interrupts the process each time, happens in one uninterrupted sequence.
+    std::vector<SHookTarget> hookTargets;
+    hookTargets.reserve(replaceableImportFunctions->size());
+
+    std::string systemFunctionNameAscii;
+    std::string replacementFunctionNameAscii;
+    AppendFunctionNameAscii(replacementFunctionNameAscii, replacementFunctionPrefix);
+    const size_t replacementFunctionPrefixLength = replacementFunctionNameAscii.length();
+
     for (const auto& systemFunction : *replaceableImportFunctions)
     {
       const std::wstring_view systemFunctionName = systemFunction.first;
-      auto systemFunctionNameAscii = Infra::Strings::ConvertWideToNarrow(systemFunctionName.data());
-      void* const systemFunc = GetProcAddress(libraryHandle, systemFunctionNameAscii.Data());
+
+      systemFunctionNameAscii.clear();
+      AppendFunctionNameAscii(systemFunctionNameAscii, systemFunctionName);
+      void* const systemFunc = GetProcAddress(libraryHandle, systemFunctionNameAscii.c_str());
       if (nullptr == systemFunc)
       {
         Infra::Message::OutputFormatted(
@@ -86,27 +124,43 @@ namespace Xidi
         continue;
       }
 
-      Infra::TemporaryString replacementFunctionName = replacementFunctionPrefix;
-      replacementFunctionName << systemFunctionName;
-      auto replacementFunctionNameAscii =
-          Infra::Strings::ConvertWideToNarrow(replacementFunctionName.AsCString());
+      replacementFunctionNameAscii.resize(replacementFunctionPrefixLength);
+      AppendFunctionNameAscii(replacementFunctionNameAscii, systemFunctionName);
       void* const replacementFunc =
-          GetProcAddress(xidiLibraryHandle, replacementFunctionNameAscii.Data());
+          GetProcAddress(xidiLibraryHandle, replacementFunctionNameAscii.c_str());
       if (nullptr == replacementFunc)
       {
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Warning,
-            L"Entry point \"%s\" is missing from the main Xidi library.",
-            replacementFunctionName.AsCString());
+            L"Entry point \"%s%.*s\" is missing from the main Xidi library.",
+            replacementFunctionPrefix,
+            static_cast<int>(systemFunctionName.length()),
+            systemFunctionName.data());
         continue;
       }
 
-      const Hookshot::EResult hookResult = hookshot->CreateHook(systemFunc, replacementFunc);
-      OutputSetHookResult(systemFunctionName.data(), hookResult);
-      if (false == Hookshot::SuccessfulResult(hookResult)) continue;
+      hookTargets.push_back(
+          {.functionName = systemFunctionName,
+           .systemFunc = systemFunc,
+           .replacementFunc = replacementFunc});
+    }
+
+    std::vector<Hookshot::EResult> hookResults;
+    hookResults.reserve(hookTargets.size());
+    for (const auto& hookTarget : hookTargets)
+      hookResults.push_back(
+          hookshot->CreateHook(hookTarget.systemFunc, hookTarget.replacementFunc));
+
+    std::unordered_map<std::wstring_view, const void*> replacementImportFunctions;
+    for (size_t hookIndex = 0; hookIndex < hookTargets.size(); ++hookIndex)
+    {
+      const SHookTarget& hookTarget = hookTargets[hookIndex];
+
+      OutputSetHookResult(hookTarget.functionName.data(), hookResults[hookIndex]);
+      if (false == Hookshot::SuccessfulResult(hookResults[hookIndex])) continue;
 
-      replacementImportFunctions[systemFunctionName.data()] =
-          hookshot->GetOriginalFunction(systemFunc);
+      replacementImportFunctions[hookTarget.functionName] =
+          hookshot->GetOriginalFunction(hookTarget.systemFunc);
     }
 
     const size_t numUnsuccessfullyHooked =
@@ -0,0 +1,258 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file StartupTrace.cpp
+ *   Implementation of timing measurements for the phases of startup and initialization.
+ **************************************************************************************************/
+
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DEFINE_PROVIDER(
+    startupTraceProvider,
+    "Xidi.StartupTrace",
+    (0x6ebc9332, 0x4d57, 0x4688, 0xac, 0x7f, 0xe5, 0x90, 0xd5, 0xad, 0x2a, 0x7a));
+
+namespace Xidi
+{
+  namespace StartupTrace
+  {
+    /// Holds the measurement of a single phase.
+    struct SPhaseRecord
+    {
+      /// Name of the phase.
+      std::wstring_view name;
+
+      /// Number of phases that enclose this phase on the same thread.
+      unsigned int depth;
+
+      /// Performance counter value when the phase began.
+      int64_t beginTicks;
+
+      /// Performance counter value when the phase completed.
+      int64_t endTicks;
+    };
+
+    /// Holds all of the phases measured within a single outermost phase.
+    struct STrace
+    {
+      /// Identifier of the thread on which the phases were measured.
+      DWORD threadId;
+
+      /// Phase measurements, in the order in which the phases began.
+      std::vector<SPhaseRecord> phases;
+    };
+
+    /// Enumerates the possible ways in which traces are reported.
+    enum class EReportingState
+    {
+      /// Not yet configured, so traces are retained.
+      Unconfigured,
+
+      /// Configured to report traces using at least one mechanism.
+      Enabled,
+
+      /// Configured not to report traces at all.
+      Disabled
+    };
+
+    /// Maximum number of traces to retain while reporting is not yet configured. Limits the amount
+    /// of memory used if reporting is never configured at all.
+    static constexpr size_t kMaxRetainedTraces = 16;
+
+    /// Whether or not phases should be measured. Checked without holding the mutex so that phases
+    /// cost almost nothing once tracing is disabled.
+    static std::atomic<bool> isMeasurementEnabled = true;
+
+    /// Guards the reporting configuration and the retained traces.
+    static std::mutex reportingMutex;
+
+    /// Current reporting state.
+    static EReportingState reportingState = EReportingState::Unconfigured;
+
+    /// Whether or not traces are output as informational messages, once reporting is enabled.
+    static bool reportingOutputToLog = false;
+
+    /// Whether or not traces are emitted as TraceLogging events, once reporting is enabled.
+    static bool reportingEmitEvents = false;
+
+    /// Traces that completed before reporting was configured.
+    static std::vector<STrace> retainedTraces;
+
+    /// Phases measured so far on the current thread within its outermost phase.
+    static thread_local std::vector<SPhaseRecord> currentThreadPhases;
+
+    /// Number of phases currently in progress on the current thread.
+    static thread_local unsigned int currentThreadDepth = 0;
+
+    /// Retrieves and returns the frequency of the performance counter.
+    /// @return Number of performance counter ticks per second.
+    static int64_t PerformanceCounterFrequency(void)
+    {
+      static const int64_t kFrequency = []() -> int64_t
+      {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return frequency.QuadPart;
+      }();
+
+      return kFrequency;
+    }
+
+    /// Retrieves and returns the current value of the performance counter.
+    /// @return Current performance counter value.
+    static int64_t PerformanceCounterNow(void)
+    {
+      LARGE_INTEGER now;
+      QueryPerformanceCounter(&now);
+      return now.QuadPart;
+    }
+
+    /// Computes the duration of a phase in milliseconds.
+    /// @param [in] phase Phase measurement.
+    /// @return Duration of the phase.
+    static double PhaseDurationMilliseconds(const SPhaseRecord& phase)
+    {
+      return (static_cast<double>(phase.endTicks - phase.beginTicks) * 1000.0) /
+          static_cast<double>(PerformanceCounterFrequency());
+    }
+
+    /// Reports a complete trace using all of the configured mechanisms. Caller must hold the
+    /// reporting mutex, and reporting must be enabled.
+    /// @param [in] trace Trace to report.
+    static void ReportTrace(const STrace& trace)
+    {
+      if (true == reportingOutputToLog)
+      {
+        // Nested phases are indented by two spaces per level of nesting.
+        constexpr std::wstring_view kIndentation = L"                                ";
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Startup trace on thread %u:",
+            (unsigned int)trace.threadId);
+
+        for (const auto& phase : trace.phases)
+        {
+          Infra::Message::OutputFormatted(
+              Infra::Message::ESeverity::Info,
+              L"    %.*s%s: %.3f ms",
+              (int)std::min((size_t)(2 * phase.depth), kIndentation.length()),
+              kIndentation.data(),
+              phase.name.data(),
+              PhaseDurationMilliseconds(phase));
+        }
+      }
+
+      if (true == reportingEmitEvents)
+      {
+        TraceLoggingRegister(startupTraceProvider);
+
+        for (const auto& phase : trace.phases)
+        {
+          TraceLoggingWrite(
+              startupTraceProvider,
+              "StartupPhase",
+              TraceLoggingUInt32((UINT32)trace.threadId, "ThreadId"),
+              TraceLoggingWideString(phase.name.data(), "Phase"),
+              TraceLoggingUInt32(phase.depth, "Depth"),
+              TraceLoggingFloat64(PhaseDurationMilliseconds(phase), "DurationMilliseconds"));
+        }
+
+        TraceLoggingUnregister(startupTraceProvider);
+      }
+    }
+
+    /// Submits a complete trace for reporting, or retains it if reporting is not yet configured.
+    /// @param [in] trace Trace to submit.
+    static void SubmitTrace(STrace&& trace)
+    {
+      std::scoped_lock lock(reportingMutex);
+
+      switch (reportingState)
+      {
+        case EReportingState::Unconfigured:
+          if (retainedTraces.size() < kMaxRetainedTraces)
+            retainedTraces.emplace_back(std::move(trace));
+          break;
+
+        case EReportingState::Enabled:
+          ReportTrace(trace);
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    ScopedPhase::ScopedPhase(std::wstring_view phaseName) : recordIndex(SIZE_MAX)
+    {
+      if (false == isMeasurementEnabled.load(std::memory_order_relaxed)) return;
+
+      recordIndex = currentThreadPhases.size();
+      currentThreadPhases.push_back(
+          {.name = phaseName,
+           .depth = currentThreadDepth,
+           .beginTicks = PerformanceCounterNow(),
+           .endTicks = 0});
+
+      currentThreadDepth += 1;
+    }
+
+    ScopedPhase::~ScopedPhase(void)
+    {
+      if (SIZE_MAX == recordIndex) return;
+
+      currentThreadPhases[recordIndex].endTicks = PerformanceCounterNow();
+
+      currentThreadDepth -= 1;
+      if (0 != currentThreadDepth) return;
+
+      SubmitTrace({.threadId = GetCurrentThreadId(), .phases = std::move(currentThreadPhases)});
+      currentThreadPhases.clear();
+    }
+
+    void Configure(bool outputToLog, bool emitEvents)
+    {
+      std::scoped_lock lock(reportingMutex);
+
+      if (EReportingState::Unconfigured != reportingState) return;
+
+      if ((false == outputToLog) && (false == emitEvents))
+      {
+        reportingState = EReportingState::Disabled;
+        isMeasurementEnabled.store(false, std::memory_order_relaxed);
+      }
+      else
+      {
+        reportingState = EReportingState::Enabled;
+        reportingOutputToLog = outputToLog;
+        reportingEmitEvents = emitEvents;
+
+        for (const auto& retainedTrace : retainedTraces)
+          ReportTrace(retainedTrace);
+      }
+
+      retainedTraces.clear();
+      retainedTraces.shrink_to_fit();
+    }
+  } // namespace StartupTrace
+} // namespace Xidi
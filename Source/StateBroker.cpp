@@ -0,0 +1,314 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file StateBroker.cpp
+ *   Implementation of functionality for sharing physical controller state between all processes
+ *   in the same session that use Xidi, such that only one of them queries XInput.
+ **************************************************************************************************/
+
+#include "StateBroker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Globals.h"
+#include "Settings.h"
+#include "Strings.h"
+#include "WorkerThread.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    namespace StateBroker
+    {
+      /// Name of the shared memory section. The version suffix is incremented whenever the layout
+      /// of the section changes, so that processes using incompatible versions of Xidi never share
+      /// state with each other.
+      static constexpr wchar_t kSectionName[] = L"Local\\Xidi.StateBroker.v2";
+
+      /// Name of the mutex held by the process that owns physical controller polling for as long
+      /// as it is running.
+      static constexpr wchar_t kOwnerMutexName[] = L"Local\\Xidi.StateBroker.v2.Owner";
+
+      /// Maximum number of attempts a subscriber makes to obtain a consistent copy of a slot
+      /// before giving up and reporting the physical controller as not connected.
+      static constexpr unsigned int kMaxReadAttempts = 64;
+
+      /// Most recently published XInput state query result for a single physical controller.
+      /// Each slot occupies its own cache line so that publishing to one does not slow down
+      /// reading another.
+      struct alignas(64) SSlot
+      {
+        /// Sequence number for obtaining consistent copies. Odd while a publication is in
+        /// progress, and zero if nothing has ever been published.
+        uint32_t sequence;
+
+        /// Result code that XInput returned.
+        uint32_t result;
+
+        /// Packet number that XInput reported. Only meaningful if the query succeeded.
+        uint32_t packetNumber;
+
+        /// Button state that XInput reported, using the XInput bit layout.
+        uint16_t buttons;
+
+        /// Left and right trigger values that XInput reported, in that order.
+        uint8_t trigger[2];
+
+        /// Left stick X, left stick Y, right stick X, and right stick Y values that XInput
+        /// reported, in that order.
+        int16_t stick[4];
+      };
+
+      /// Complete contents of the shared memory section. Only fixed-width types are used, so the
+      /// layout is the same in 32-bit and 64-bit processes.
+      struct SSection
+      {
+        /// Identifier of the process that currently owns physical controller polling.
+        uint32_t ownerProcessId;
+
+        /// One slot per physical controller.
+        SSlot slot[kMaxPhysicalControllerCount];
+      };
+
+      /// Shared memory section, or `nullptr` if state sharing is disabled or could not be
+      /// started.
+      static SSection* sharedSection = nullptr;
+
+      /// Whether or not this process currently owns physical controller polling.
+      static std::atomic<bool> isOwner = false;
+
+      /// Serializes publication to each slot within the owning process, since a physical
+      /// controller can be polled both periodically and on demand.
+      static std::mutex slotPublishMutex[kMaxPhysicalControllerCount];
+
+      /// Takes over ownership of physical controller polling. Any slot left in the middle of a
+      /// publication by a previous owner that exited is first made consistent again.
+      static void BecomeOwner(void)
+      {
+        for (auto& slot : sharedSection->slot)
+        {
+          std::atomic_ref<uint32_t> sequence(slot.sequence);
+          const uint32_t currentSequence = sequence.load(std::memory_order_relaxed);
+          if (0 != (currentSequence & 1)) sequence.store(currentSequence + 1);
+        }
+
+        std::atomic_ref<uint32_t>(sharedSection->ownerProcessId)
+            .store((uint32_t)GetCurrentProcessId());
+        isOwner.store(true, std::memory_order_release);
+      }
+
+      /// Acquires the owner mutex, waiting for as long as necessary, and then holds it for the
+      /// rest of the process lifetime. Mutex ownership belongs to a thread, so this is intended
+      /// to be the entry point of a thread that never exits. The system releases the mutex when
+      /// this process exits, which wakes up exactly one of the waiting subscribers.
+      /// @param [in] ownerMutex Handle of the owner mutex.
+      /// @param [in] initialAttemptComplete Promise to fulfill once this process knows whether it
+      /// is initially the owner or a subscriber.
+      static void AcquireAndHoldOwnership(
+          HANDLE ownerMutex, std::promise<void> initialAttemptComplete)
+      {
+        DWORD waitResult = WaitForSingleObject(ownerMutex, 0);
+        if (WAIT_TIMEOUT != waitResult)
+        {
+          if ((WAIT_OBJECT_0 == waitResult) || (WAIT_ABANDONED == waitResult)) BecomeOwner();
+          initialAttemptComplete.set_value();
+        }
+        else
+        {
+          initialAttemptComplete.set_value();
+
+          waitResult = WaitForSingleObject(ownerMutex, INFINITE);
+          if ((WAIT_OBJECT_0 == waitResult) || (WAIT_ABANDONED == waitResult))
+          {
+            BecomeOwner();
+            Infra::Message::Output(
+                Infra::Message::ESeverity::Info,
+                L"Took over physical controller polling from a process that exited.");
+          }
+        }
+
+        if (true == isOwner.load(std::memory_order_relaxed))
+        {
+          while (true)
+            Sleep(INFINITE);
+        }
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Failed with code %u to wait for ownership of physical controller polling.",
+            GetLastError());
+      }
+
+      bool IsEnabled(void)
+      {
+        return Globals::GetSettings().properties.sharePhysicalControllerState;
+      }
+
+      void Start(void)
+      {
+        if (false == IsEnabled()) return;
+
+        static std::once_flag startFlag;
+        std::call_once(
+            startFlag,
+            []() -> void
+            {
+              // The section and the mutex are intentionally never closed, so that they remain
+              // valid for as long as the process is running.
+              const HANDLE sectionHandle = CreateFileMappingW(
+                  INVALID_HANDLE_VALUE,
+                  nullptr,
+                  PAGE_READWRITE,
+                  0,
+                  sizeof(SSection),
+                  kSectionName);
+              if (nullptr == sectionHandle)
+              {
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Warning,
+                    L"Failed with code %u to create the physical controller state sharing section. Physical controllers will be polled directly.",
+                    GetLastError());
+                return;
+              }
+
+              SSection* const section = reinterpret_cast<SSection*>(
+                  MapViewOfFile(sectionHandle, FILE_MAP_WRITE, 0, 0, sizeof(SSection)));
+              if (nullptr == section)
+              {
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Warning,
+                    L"Failed with code %u to map the physical controller state sharing section. Physical controllers will be polled directly.",
+                    GetLastError());
+                CloseHandle(sectionHandle);
+                return;
+              }
+
+              const HANDLE ownerMutex = CreateMutexW(nullptr, FALSE, kOwnerMutexName);
+              if (nullptr == ownerMutex)
+              {
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Warning,
+                    L"Failed with code %u to create the physical controller state sharing mutex. Physical controllers will be polled directly.",
+                    GetLastError());
+                UnmapViewOfFile(section);
+                CloseHandle(sectionHandle);
+                return;
+              }
+
+              sharedSection = section;
+
+              std::promise<void> initialAttemptComplete;
+              std::future<void> initialAttemptCompleteFuture = initialAttemptComplete.get_future();
+              WorkerThread::StartDetached(
+                  L"Xidi State Broker",
+                  WorkerThread::EPriority::Housekeeping,
+                  AcquireAndHoldOwnership,
+                  ownerMutex,
+                  std::move(initialAttemptComplete));
+              initialAttemptCompleteFuture.wait();
+
+              if (true == isOwner.load(std::memory_order_acquire))
+                Infra::Message::Output(
+                    Infra::Message::ESeverity::Info,
+                    L"Owning physical controller polling and sharing physical controller state with other processes.");
+              else
+                Infra::Message::OutputFormatted(
+                    Infra::Message::ESeverity::Info,
+                    L"Reading physical controller state shared by process %u instead of polling physical controllers directly.",
+                    (unsigned int)std::atomic_ref<uint32_t>(section->ownerProcessId).load());
+            });
+      }
+
+      void PublishXInputState(
+          TControllerIdentifier controllerIdentifier,
+          DWORD result,
+          const XINPUT_STATE& xinputState)
+      {
+        if (false == isOwner.load(std::memory_order_acquire)) return;
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return;
+
+        std::scoped_lock lock(slotPublishMutex[controllerIdentifier]);
+
+        SSlot& slot = sharedSection->slot[controllerIdentifier];
+        std::atomic_ref<uint32_t> sequence(slot.sequence);
+
+        const uint32_t currentSequence = sequence.load(std::memory_order_relaxed);
+        sequence.store(currentSequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.result = (uint32_t)result;
+        if (ERROR_SUCCESS == result)
+        {
+          slot.packetNumber = (uint32_t)xinputState.dwPacketNumber;
+          slot.buttons = xinputState.Gamepad.wButtons;
+          slot.trigger[0] = xinputState.Gamepad.bLeftTrigger;
+          slot.trigger[1] = xinputState.Gamepad.bRightTrigger;
+          slot.stick[0] = xinputState.Gamepad.sThumbLX;
+          slot.stick[1] = xinputState.Gamepad.sThumbLY;
+          slot.stick[2] = xinputState.Gamepad.sThumbRX;
+          slot.stick[3] = xinputState.Gamepad.sThumbRY;
+        }
+
+        sequence.store(currentSequence + 2, std::memory_order_release);
+      }
+
+      bool TryReadXInputState(
+          TControllerIdentifier controllerIdentifier, DWORD& result, XINPUT_STATE& xinputState)
+      {
+        if (nullptr == sharedSection) return false;
+        if (true == isOwner.load(std::memory_order_acquire)) return false;
+
+        result = ERROR_DEVICE_NOT_CONNECTED;
+        if (controllerIdentifier >= kMaxPhysicalControllerCount) return true;
+
+        SSlot& slot = sharedSection->slot[controllerIdentifier];
+        std::atomic_ref<uint32_t> sequence(slot.sequence);
+
+        for (unsigned int attempt = 0; attempt < kMaxReadAttempts; ++attempt)
+        {
+          const uint32_t sequenceBefore = sequence.load(std::memory_order_acquire);
+          if (0 == sequenceBefore) return true;
+
+          if (0 != (sequenceBefore & 1))
+          {
+            YieldProcessor();
+            continue;
+          }
+
+          const uint32_t slotResult = slot.result;
+          const XINPUT_STATE slotXInputState = {
+              .dwPacketNumber = slot.packetNumber,
+              .Gamepad = {
+                  .wButtons = slot.buttons,
+                  .bLeftTrigger = slot.trigger[0],
+                  .bRightTrigger = slot.trigger[1],
+                  .sThumbLX = slot.stick[0],
+                  .sThumbLY = slot.stick[1],
+                  .sThumbRX = slot.stick[2],
+                  .sThumbRY = slot.stick[3]}};
+
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (sequenceBefore != sequence.load(std::memory_order_relaxed)) continue;
+
+          result = (DWORD)slotResult;
+          if (ERROR_SUCCESS == result) xinputState = slotXInputState;
+          return true;
+        }
+
+        return true;
+      }
+    } // namespace StateBroker
+  } // namespace Controller
+} // namespace Xidi
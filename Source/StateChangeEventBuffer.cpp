@@ -11,58 +11,260 @@
 
 #include "StateChangeEventBuffer.h"
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cstdint>
-
-#include <boost/circular_buffer.hpp>
+#include <memory>
+#include <span>
 
 #include "ApiWindows.h"
 #include "ControllerTypes.h"
+#include "TraceEvents.h"
 
 namespace Xidi
 {
   namespace Controller
   {
-    /// Handles a possible buffer overflow condition.
-    /// @param [in] eventBuffer Event buffer object for which to check for overflow.
-    /// @return `true` if the event buffer overflowed, `false` otherwise.
-    static inline bool HandlePossibleOverflow(
-        boost::circular_buffer<StateChangeEventBuffer::SEvent>& eventBuffer)
+    /// Holds the counter from which all event buffers draw sequence numbers. Occupies an entire
+    /// cache line by itself, so that producers touching it do not also contend on unrelated data.
+    struct alignas(64) SSequenceCounter
+    {
+      /// Sequence number to assign to the next event appended to any event buffer.
+      std::atomic<uint32_t> nextSequence = 0;
+    };
+
+    static_assert(64 == sizeof(SSequenceCounter), "Sequence counter must fill a cache line.");
+
+    /// Sequence number counter shared by all event buffers. A single counter keeps sequence numbers
+    /// in the order in which events actually happen, across all devices, which applications rely
+    /// on when merging buffered events from several devices.
+    static SSequenceCounter sequenceCounter;
+
+    bool StateChangeEventBuffer::HandlePossibleOverflow(void)
     {
       // Per DirectInput documentation, we always need one free space in the buffer.
       // This is how we ensure the number of events stored is always one less than capacity.
+      // The consumer may concurrently be popping events, so the head is only ever advanced if it
+      // has not moved in the meantime.
 
-      const bool eventBufferWasFull = ((0 != eventBuffer.size()) && (true == eventBuffer.full()));
+      bool eventsWereDiscarded = false;
+      uint32_t currentHead = head.load(std::memory_order_acquire);
 
-      if (true == eventBufferWasFull) eventBuffer.pop_front();
+      while ((tail.load(std::memory_order_relaxed) - currentHead) >= eventBufferCapacity)
+      {
+        if (true ==
+            head.compare_exchange_weak(
+                currentHead,
+                currentHead + 1,
+                std::memory_order_acq_rel,
+                std::memory_order_acquire))
+        {
+          currentHead += 1;
+          eventsWereDiscarded = true;
+        }
+      }
 
-      return eventBufferWasFull;
+      return eventsWereDiscarded;
+    }
+
+    void StateChangeEventBuffer::NoteConsumerActivity(uint32_t timestamp)
+    {
+      if (true == consumerActivity.load(std::memory_order_relaxed))
+      {
+        consumerActivity.store(false, std::memory_order_relaxed);
+        lastConsumerActivityTimestamp = timestamp;
+        storageIsDormant = false;
+      }
+    }
+
+    void StateChangeEventBuffer::ResizeStorage(uint32_t newSlotCount)
+    {
+      const uint32_t newSlotIndexMask = ((0 == newSlotCount) ? 0 : (newSlotCount - 1));
+      const uint32_t currentHead = head.load(std::memory_order_relaxed);
+      const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+
+      std::unique_ptr<SEvent[]> newEvents =
+          ((0 == newSlotCount) ? nullptr : std::make_unique_for_overwrite<SEvent[]>(newSlotCount));
+      for (uint32_t i = currentHead; i != currentTail; ++i)
+        newEvents[i & newSlotIndexMask] = events[i & slotIndexMask];
+
+      events = std::move(newEvents);
+      slotIndexMask = newSlotIndexMask;
+    }
+
+    bool StateChangeEventBuffer::AreEventsIntact(const SEventSpans& eventSpans) const
+    {
+      // An empty run of events cannot have been overwritten. Storage might not even exist yet.
+      if (0 == eventSpans.GetCount()) return true;
+
+      // Pairs with the fence in the producer. If any event was read after the producer started
+      // overwriting its slot, then the tail value loaded here reflects the overwrite.
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      // The slot holding the first event is reused once the tail has advanced one full lap.
+      return ((tail.load(std::memory_order_relaxed) - eventSpans.firstEvent) <= slotIndexMask);
     }
 
     void StateChangeEventBuffer::AppendEvent(SEventData eventData, uint32_t timestamp)
     {
-      // Sequence number is globally ordered with respect to all controller events, even those from
-      // other event buffers.
-      static std::atomic<uint32_t> nextSequence = 0;
+      if (0 == eventBufferCapacity) return;
+
+      NoteConsumerActivity(timestamp);
+      if (true == storageIsDormant)
+      {
+        eventBufferOverflowed.store(true, std::memory_order_release);
+        return;
+      }
+
+      if (false == HasStorageFor(1)) ReserveStorage(1);
+
+      // The buffer never holds more than one less than capacity events, and storage either has
+      // enough slots for the full capacity or at least one more than the number of events present,
+      // so the slot at the tail is guaranteed to be free even before any overflow is handled.
+      const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      events[currentTail & slotIndexMask] = {
+          .data = eventData,
+          .timestamp = timestamp,
+          .sequence = sequenceCounter.nextSequence.fetch_add(1, std::memory_order_relaxed)};
+      tail.store(currentTail + 1, std::memory_order_release);
+
+      const bool eventsWereDiscarded = HandlePossibleOverflow();
+      if (true == eventsWereDiscarded) TraceEvents::EventBufferOverflow(this, eventBufferCapacity);
+
+      eventBufferOverflowed.store(eventsWereDiscarded, std::memory_order_release);
+    }
+
+    bool StateChangeEventBuffer::CoalesceAxisEvent(SEventData eventData)
+    {
+      if (EElementType::Axis != eventData.element.type) return false;
 
-      eventBuffer.push_back(
-          {.data = eventData, .timestamp = timestamp, .sequence = nextSequence++});
+      // Once merging is in effect, each axis occurs at most once in any run of axis events, so the
+      // search never needs to look farther back than the number of possible axes.
+      const uint32_t currentHead = head.load(std::memory_order_acquire);
+      const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+      const uint32_t numEventsToSearch =
+          std::min(currentTail - currentHead, (uint32_t)EAxis::Count);
 
-      eventBufferOverflowed = HandlePossibleOverflow(eventBuffer);
+      for (uint32_t i = 1; i <= numEventsToSearch; ++i)
+      {
+        SEvent& event = events[(currentTail - i) & slotIndexMask];
+        if (EElementType::Axis != event.data.element.type) break;
+
+        if (eventData.element.axis == event.data.element.axis)
+        {
+          event.data.value.axis = eventData.value.axis;
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    bool StateChangeEventBuffer::CheckStorageIdle(uint32_t timestamp)
+    {
+      NoteConsumerActivity(timestamp);
+
+      return (
+          (nullptr != events) && (true == IsOverflowed()) &&
+          ((timestamp - lastConsumerActivityTimestamp) >= kEventStorageIdleMilliseconds));
+    }
+
+    StateChangeEventBuffer::SEventSpans StateChangeEventBuffer::PeekOldestEvents(
+        uint32_t maxCount) const
+    {
+      SignalConsumerActivity();
+
+      const uint32_t currentHead = head.load(std::memory_order_acquire);
+      const uint32_t currentCount = tail.load(std::memory_order_acquire) - currentHead;
+      const uint32_t numEvents = std::min(maxCount, currentCount);
+
+      if (0 == numEvents) return {.firstEvent = currentHead};
+
+      const uint32_t firstSlot = (currentHead & slotIndexMask);
+      const uint32_t numEventsOlder = std::min(numEvents, (slotIndexMask + 1) - firstSlot);
+
+      return {
+          .firstEvent = currentHead,
+          .older = std::span<const SEvent>(&events[firstSlot], numEventsOlder),
+          .newer = std::span<const SEvent>(&events[0], numEvents - numEventsOlder)};
+    }
+
+    void StateChangeEventBuffer::PopEvents(const SEventSpans& eventSpans)
+    {
+      SignalConsumerActivity();
+
+      const uint32_t numEventsToPop = eventSpans.GetCount();
+
+      // Popping 0 events is a no-op.
+      if (numEventsToPop > 0)
+      {
+        // The producer may have discarded some or all of these events due to overflow, in which
+        // case the head has already moved past them and must not be moved backwards.
+        const uint32_t newHead = eventSpans.firstEvent + numEventsToPop;
+        uint32_t currentHead = head.load(std::memory_order_acquire);
+
+        while ((int32_t)(newHead - currentHead) > 0)
+        {
+          if (true ==
+              head.compare_exchange_weak(
+                  currentHead, newHead, std::memory_order_acq_rel, std::memory_order_acquire))
+            break;
+        }
+
+        eventBufferOverflowed.store(false, std::memory_order_release);
+      }
     }
 
     void StateChangeEventBuffer::PopOldestEvents(uint32_t numEventsToPop)
     {
+      SignalConsumerActivity();
+
       // Popping 0 events is a no-op.
       if (numEventsToPop > 0)
       {
-        for (uint32_t i = 0; (i < numEventsToPop) && (false == eventBuffer.empty()); ++i)
-          eventBuffer.pop_front();
+        uint32_t currentHead = head.load(std::memory_order_acquire);
+        uint32_t newHead = currentHead;
+
+        do
+        {
+          const uint32_t currentCount = tail.load(std::memory_order_acquire) - currentHead;
+          newHead = currentHead + std::min(numEventsToPop, currentCount);
+        }
+        while (false ==
+               head.compare_exchange_weak(
+                   currentHead, newHead, std::memory_order_acq_rel, std::memory_order_acquire));
 
-        eventBufferOverflowed = false;
+        eventBufferOverflowed.store(false, std::memory_order_release);
       }
     }
 
+    void StateChangeEventBuffer::ReleaseIdleStorage(void)
+    {
+      head.store(tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      ResizeStorage(0);
+
+      storageIsDormant = true;
+      eventBufferOverflowed.store(true, std::memory_order_release);
+    }
+
+    void StateChangeEventBuffer::ReserveStorage(uint32_t numEventsToAppend)
+    {
+      if (true == HasStorageFor(numEventsToAppend)) return;
+
+      const uint32_t currentCount =
+          tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+      const uint32_t newSlotCount = std::min(
+          RequiredStorageSlotCount(),
+          std::max(
+              {kEventStorageSlotCountMin,
+               std::bit_ceil(currentCount + numEventsToAppend),
+               2 * GetStorageSlotCount()}));
+
+      ResizeStorage(newSlotCount);
+    }
+
     void StateChangeEventBuffer::SetCapacity(uint32_t capacity)
     {
       // Setting the capacity to the same as the current capacity is a no-op.
@@ -70,8 +272,28 @@ namespace Xidi
       {
         const uint32_t newCapacity =
             ((capacity > kEventBufferCapacityMax) ? kEventBufferCapacityMax : capacity);
-        eventBuffer.rset_capacity(newCapacity);
-        eventBufferOverflowed = HandlePossibleOverflow(eventBuffer);
+
+        // The most recent events are retained, up to the new capacity. Overflow handling below
+        // then discards one more if needed to preserve the one free space. Storage is sized just
+        // for the retained events and grows again as more are appended.
+        const uint32_t oldHead = head.load(std::memory_order_relaxed);
+        const uint32_t oldTail = tail.load(std::memory_order_relaxed);
+        const uint32_t numEventsToKeep = std::min(oldTail - oldHead, newCapacity);
+        head.store(oldTail - numEventsToKeep, std::memory_order_relaxed);
+
+        eventBufferCapacity = newCapacity;
+        ResizeStorage(
+            ((0 == numEventsToKeep)
+                 ? 0
+                 : std::min(
+                       RequiredStorageSlotCount(),
+                       std::max(kEventStorageSlotCountMin, std::bit_ceil(numEventsToKeep)))));
+
+        storageIsDormant = false;
+        consumerActivity.store(true, std::memory_order_relaxed);
+
+        eventBufferOverflowed.store(
+            ((0 != newCapacity) && (true == HandlePossibleOverflow())), std::memory_order_release);
       }
     }
   } // namespace Controller
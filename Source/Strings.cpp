@@ -14,6 +14,7 @@
 #include <intrin.h>
 #include <sal.h>
 
+#include <array>
 #include <cctype>
 #include <cstdlib>
 #include <cwctype>
@@ -32,12 +33,166 @@ namespace Xidi
 {
   namespace Strings
   {
+    /// File extension for an auto-tuning profile file.
+    static constexpr std::wstring_view kStrAutoTuneProfileFileExtension = L".autotune";
+
     /// File extension for a configuration file.
     static constexpr std::wstring_view kStrConfigurationFileExtension = L".ini";
 
+    /// File extension for an element mapper cache file.
+    static constexpr std::wstring_view kStrElementMapperCacheFileExtension = L".mappercache";
+
     /// File extension for a log file.
     static constexpr std::wstring_view kStrLogFileExtension = L".log";
 
+    /// File extension for an XInput library probe cache file.
+    static constexpr std::wstring_view kStrXInputLibraryProbeCacheFileExtension = L".xinputprobe";
+
+    /// Fixed-capacity string that is generated entirely at compile time and therefore lives in
+    /// read-only data without requiring any initialization at runtime.
+    struct SPerControllerString
+    {
+      /// Null-terminated string contents.
+      wchar_t buf[32];
+
+      /// Number of characters in the string, excluding the null terminator.
+      size_t length;
+
+      /// Retrieves a read-only view of the string contents.
+      /// @return View of the string contents.
+      constexpr std::wstring_view View(void) const
+      {
+        return std::wstring_view(buf, length);
+      }
+    };
+
+    /// Generates per-controller strings of the form "<base>.<N>" where N is the 1-based
+    /// controller number. Exceeding the capacity of the output buffer is a compile-time error.
+    /// @param [in] base Base string that is common to all controllers.
+    /// @return Array of per-controller strings, indexed by controller identifier.
+    static consteval std::array<SPerControllerString, Controller::kMaxPhysicalControllerCount>
+        GeneratePerControllerStrings(std::wstring_view base)
+    {
+      std::array<SPerControllerString, Controller::kMaxPhysicalControllerCount>
+          perControllerStrings = {};
+
+      for (Controller::TControllerIdentifier i = 0; i < Controller::kMaxPhysicalControllerCount;
+           ++i)
+      {
+        SPerControllerString& perControllerString = perControllerStrings[i];
+
+        for (const wchar_t c : base)
+          perControllerString.buf[perControllerString.length++] = c;
+        perControllerString.buf[perControllerString.length++] = kCharConfigurationSettingSeparator;
+
+        wchar_t reversedDigits[8] = {};
+        size_t numDigits = 0;
+        for (unsigned int controllerNumber = (1 + i); controllerNumber > 0; controllerNumber /= 10)
+          reversedDigits[numDigits++] = (wchar_t)(L'0' + (controllerNumber % 10));
+        while (numDigits > 0)
+          perControllerString.buf[perControllerString.length++] = reversedDigits[--numDigits];
+
+        perControllerString.buf[perControllerString.length] = L'\0';
+      }
+
+      return perControllerStrings;
+    }
+
+    /// Per-controller mapper type configuration setting strings, indexed by controller
+    /// identifier.
+    static constexpr auto kPerControllerMapperTypeStrings =
+        GeneratePerControllerStrings(kStrConfigurationSettingMapperType);
+
+    /// Per-controller properties configuration section strings, indexed by controller identifier.
+    static constexpr auto kPerControllerPropertiesStrings =
+        GeneratePerControllerStrings(kStrConfigurationSectionProperties);
+
+    std::wstring_view GetAutoTuneProfileFilename(void)
+    {
+      static std::wstring initString;
+      static std::once_flag initFlag;
+
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            std::wstring_view pieces[] = {
+                Infra::ProcessInfo::GetThisModuleDirectoryName(),
+                L"\\",
+                Infra::ProcessInfo::GetProductName(),
+                L"_",
+                Infra::ProcessInfo::GetExecutableBaseName(),
+                kStrAutoTuneProfileFileExtension};
+
+            size_t totalLength = 0;
+            for (int i = 0; i < _countof(pieces); ++i)
+              totalLength += pieces[i].length();
+
+            initString.reserve(1 + totalLength);
+
+            for (int i = 0; i < _countof(pieces); ++i)
+              initString.append(pieces[i]);
+          });
+
+      return initString;
+    }
+
+    std::wstring_view GetConfigurationFilename(void)
+    {
+      static std::wstring initString;
+      static std::once_flag initFlag;
+
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            std::wstring_view pieces[] = {
+                Infra::ProcessInfo::GetThisModuleDirectoryName(),
+                L"\\",
+                Infra::ProcessInfo::GetProductName(),
+                kStrConfigurationFileExtension};
+
+            size_t totalLength = 0;
+            for (int i = 0; i < _countof(pieces); ++i)
+              totalLength += pieces[i].length();
+
+            initString.reserve(1 + totalLength);
+
+            for (int i = 0; i < _countof(pieces); ++i)
+              initString.append(pieces[i]);
+          });
+
+      return initString;
+    }
+
+    std::wstring_view GetElementMapperCacheFilename(void)
+    {
+      static std::wstring initString;
+      static std::once_flag initFlag;
+
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            std::wstring_view pieces[] = {
+                Infra::ProcessInfo::GetThisModuleDirectoryName(),
+                L"\\",
+                Infra::ProcessInfo::GetProductName(),
+                kStrElementMapperCacheFileExtension};
+
+            size_t totalLength = 0;
+            for (int i = 0; i < _countof(pieces); ++i)
+              totalLength += pieces[i].length();
+
+            initString.reserve(1 + totalLength);
+
+            for (int i = 0; i < _countof(pieces); ++i)
+              initString.append(pieces[i]);
+          });
+
+      return initString;
+    }
+
     std::wstring_view GetFormName(void)
     {
       static std::wstring initString;
@@ -191,6 +346,34 @@ namespace Xidi
       return initString;
     }
 
+    std::wstring_view GetXInputLibraryProbeCacheFilename(void)
+    {
+      static std::wstring initString;
+      static std::once_flag initFlag;
+
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            std::wstring_view pieces[] = {
+                Infra::ProcessInfo::GetThisModuleDirectoryName(),
+                L"\\",
+                Infra::ProcessInfo::GetProductName(),
+                kStrXInputLibraryProbeCacheFileExtension};
+
+            size_t totalLength = 0;
+            for (int i = 0; i < _countof(pieces); ++i)
+              totalLength += pieces[i].length();
+
+            initString.reserve(1 + totalLength);
+
+            for (int i = 0; i < _countof(pieces); ++i)
+              initString.append(pieces[i]);
+          });
+
+      return initString;
+    }
+
     const wchar_t* AxisTypeString(Controller::EAxis axis)
     {
       switch (axis)
@@ -232,27 +415,19 @@ namespace Xidi
     std::wstring_view MapperTypeConfigurationNameString(
         Controller::TControllerIdentifier controllerIdentifier)
     {
-      static std::wstring initStrings[Controller::kPhysicalControllerCount];
-      static std::once_flag initFlag;
+      if (controllerIdentifier >= Controller::kMaxPhysicalControllerCount)
+        return std::wstring_view();
 
-      std::call_once(
-          initFlag,
-          []() -> void
-          {
-            Infra::TemporaryString perControllerMapperTypeString;
-
-            for (Controller::TControllerIdentifier i = 0; i < _countof(initStrings); ++i)
-            {
-              perControllerMapperTypeString.Clear();
-              perControllerMapperTypeString << kStrConfigurationSettingMapperType
-                                            << kCharConfigurationSettingSeparator << (1 + i);
-              initStrings[i] = perControllerMapperTypeString;
-            }
-          });
+      return kPerControllerMapperTypeStrings[controllerIdentifier].View();
+    }
 
-      if (controllerIdentifier >= Controller::kPhysicalControllerCount) return std::wstring_view();
+    std::wstring_view PropertiesConfigurationSectionString(
+        Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= Controller::kMaxPhysicalControllerCount)
+        return std::wstring_view();
 
-      return initStrings[controllerIdentifier];
+      return kPerControllerPropertiesStrings[controllerIdentifier].View();
     }
   } // namespace Strings
 } // namespace Xidi
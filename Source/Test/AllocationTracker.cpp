@@ -0,0 +1,146 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AllocationTracker.cpp
+ *   Replacements for the global allocation operators that count dynamic memory allocations made
+ *   by each thread.
+ **************************************************************************************************/
+
+#include "AllocationTracker.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace XidiTest
+{
+  /// Number of dynamic memory allocations made by the current thread so far.
+  static thread_local uint64_t currentThreadAllocationCount = 0;
+
+  /// Allocates memory on behalf of all the replacement allocation operators and counts the
+  /// allocation. Follows the standard behavior of invoking the new handler until allocation either
+  /// succeeds or is impossible.
+  /// @param [in] size Number of bytes to allocate.
+  /// @param [in] alignment Required alignment of the allocated memory, or 0 for default alignment.
+  /// @return Pointer to the allocated memory.
+  static void* CountedAllocate(size_t size, size_t alignment)
+  {
+    currentThreadAllocationCount += 1;
+    if (0 == size) size = 1;
+
+    while (true)
+    {
+      void* const allocatedMemory =
+          ((0 == alignment) ? std::malloc(size) : _aligned_malloc(size, alignment));
+      if (nullptr != allocatedMemory) return allocatedMemory;
+
+      const std::new_handler newHandler = std::get_new_handler();
+      if (nullptr == newHandler) throw std::bad_alloc();
+      newHandler();
+    }
+  }
+
+  uint64_t GetCurrentThreadAllocationCount(void)
+  {
+    return currentThreadAllocationCount;
+  }
+} // namespace XidiTest
+
+void* operator new(size_t size)
+{
+  return XidiTest::CountedAllocate(size, 0);
+}
+
+void* operator new[](size_t size)
+{
+  return XidiTest::CountedAllocate(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+  return XidiTest::CountedAllocate(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+  return XidiTest::CountedAllocate(size, (size_t)alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return XidiTest::CountedAllocate(size, 0);
+  }
+  catch (const std::bad_alloc&)
+  {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return XidiTest::CountedAllocate(size, 0);
+  }
+  catch (const std::bad_alloc&)
+  {
+    return nullptr;
+  }
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+  _aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+  _aligned_free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+  _aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+  _aligned_free(ptr);
+}
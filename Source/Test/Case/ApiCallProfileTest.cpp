@@ -0,0 +1,58 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ApiCallProfileTest.cpp
+ *   Unit tests for counting and timing calls to DirectInput and WinMM entry points.
+ **************************************************************************************************/
+
+#include "ApiCallProfile.h"
+
+#include <cstdint>
+
+#include <Infra/Test/TestCase.h>
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+
+  // Verifies that recording calls updates the call count, the total time, and the distribution of
+  // call durations.
+  TEST_CASE(ApiCallProfile_RecordCall_Nominal)
+  {
+    ApiCallProfile::SMethodProfile methodProfile;
+
+    ApiCallProfile::RecordCall(&methodProfile, 100, 150);
+    ApiCallProfile::RecordCall(&methodProfile, 200, 300);
+    ApiCallProfile::RecordCall(&methodProfile, 400, 400);
+
+    TEST_ASSERT(3 == methodProfile.numCalls);
+    TEST_ASSERT(150 == methodProfile.totalTicks);
+    TEST_ASSERT(3 == methodProfile.callDuration.GetStatistics().numSamples);
+  }
+
+  // Verifies that a call whose end precedes its beginning, which can happen if the performance
+  // counter is not synchronized across processors, is counted with no time spent.
+  TEST_CASE(ApiCallProfile_RecordCall_NegativeDuration)
+  {
+    ApiCallProfile::SMethodProfile methodProfile;
+
+    ApiCallProfile::RecordCall(&methodProfile, 500, 400);
+
+    TEST_ASSERT(1 == methodProfile.numCalls);
+    TEST_ASSERT(0 == methodProfile.totalTicks);
+  }
+
+  // Verifies that profiling does nothing when it is not enabled, which is the default.
+  TEST_CASE(ApiCallProfile_Disabled)
+  {
+    TEST_ASSERT(false == ApiCallProfile::IsEnabled());
+    TEST_ASSERT(nullptr == ApiCallProfile::Register(L"ApiCallProfileTestFunction"));
+    TEST_ASSERT(0 == ApiCallProfile::GetStatistics({}));
+
+    const ApiCallProfile::ScopedCall profiledCall(nullptr);
+  }
+} // namespace XidiTest
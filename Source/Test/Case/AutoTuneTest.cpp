@@ -0,0 +1,137 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file AutoTuneTest.cpp
+ *   Unit tests for learning settings suited to the way the application reads input.
+ **************************************************************************************************/
+
+#include "AutoTune.h"
+
+#include <optional>
+#include <string>
+
+#include <Infra/Test/TestCase.h>
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+
+  // Verifies that no settings are suggested for a session that is too short.
+  TEST_CASE(AutoTune_SuggestSettings_SessionTooShort)
+  {
+    const AutoTune::SObservations kObservations = {
+        .sessionMilliseconds = 1000, .numStateReads = 100000};
+
+    TEST_ASSERT(false == AutoTune::SuggestSettings(kObservations).has_value());
+  }
+
+  // Verifies that no settings are suggested if the application hardly reads any input.
+  TEST_CASE(AutoTune_SuggestSettings_TooFewReads)
+  {
+    const AutoTune::SObservations kObservations = {
+        .sessionMilliseconds = 600000, .numStateReads = 10};
+
+    TEST_ASSERT(false == AutoTune::SuggestSettings(kObservations).has_value());
+  }
+
+  // Verifies the settings suggested for an application that reads device state 60 times per
+  // second without polling or using buffered events. Polling should happen twice per read.
+  TEST_CASE(AutoTune_SuggestSettings_StateReader)
+  {
+    const AutoTune::SObservations kObservations = {
+        .sessionMilliseconds = 60000, .numStateReads = 3600};
+
+    const std::optional<AutoTune::STunedSettings> maybeTunedSettings =
+        AutoTune::SuggestSettings(kObservations);
+    TEST_ASSERT(true == maybeTunedSettings.has_value());
+
+    TEST_ASSERT(8 == maybeTunedSettings->pollingPeriodMilliseconds);
+    TEST_ASSERT(false == maybeTunedSettings->onDemandPolling);
+    TEST_ASSERT(false == maybeTunedSettings->coalesceAxisEvents);
+    TEST_ASSERT(false == maybeTunedSettings->stateChangeEventPeriodMilliseconds.has_value());
+  }
+
+  // Verifies that on-demand polling is suggested for an application that polls before reading.
+  TEST_CASE(AutoTune_SuggestSettings_PollBeforeRead)
+  {
+    const AutoTune::SObservations kObservations = {
+        .sessionMilliseconds = 60000, .numStateReads = 60000, .numPolls = 60000};
+
+    const std::optional<AutoTune::STunedSettings> maybeTunedSettings =
+        AutoTune::SuggestSettings(kObservations);
+    TEST_ASSERT(true == maybeTunedSettings.has_value());
+
+    TEST_ASSERT(1 == maybeTunedSettings->pollingPeriodMilliseconds);
+    TEST_ASSERT(true == maybeTunedSettings->onDemandPolling);
+  }
+
+  // Verifies that the application read latency, if measured, takes precedence over the session
+  // average when it indicates that the application reads more often during gameplay.
+  TEST_CASE(AutoTune_SuggestSettings_ApplicationReadLatency)
+  {
+    const AutoTune::SObservations kObservations = {
+        .sessionMilliseconds = 60000,
+        .numStateReads = 1200,
+        .applicationReadMicroseconds = 2000};
+
+    const std::optional<AutoTune::STunedSettings> maybeTunedSettings =
+        AutoTune::SuggestSettings(kObservations);
+    TEST_ASSERT(true == maybeTunedSettings.has_value());
+
+    TEST_ASSERT(2 == maybeTunedSettings->pollingPeriodMilliseconds);
+  }
+
+  // Verifies that an application reading buffered events infrequently is suggested to coalesce
+  // axis events and, because it requests notifications, to throttle axis-only notifications.
+  TEST_CASE(AutoTune_SuggestSettings_InfrequentBufferedReader)
+  {
+    const AutoTune::SObservations kObservations = {
+        .sessionMilliseconds = 100000,
+        .numBufferedReads = 1000,
+        .numEventNotificationRequests = 1};
+
+    const std::optional<AutoTune::STunedSettings> maybeTunedSettings =
+        AutoTune::SuggestSettings(kObservations);
+    TEST_ASSERT(true == maybeTunedSettings.has_value());
+
+    TEST_ASSERT(16 == maybeTunedSettings->pollingPeriodMilliseconds);
+    TEST_ASSERT(true == maybeTunedSettings->coalesceAxisEvents);
+    TEST_ASSERT(true == maybeTunedSettings->stateChangeEventPeriodMilliseconds.has_value());
+    TEST_ASSERT(16 == maybeTunedSettings->stateChangeEventPeriodMilliseconds.value());
+  }
+
+  // Verifies that profile file contents hold all of the suggested settings in the properties
+  // section using configuration file syntax.
+  TEST_CASE(AutoTune_ProfileFileContents_Nominal)
+  {
+    const AutoTune::STunedSettings kTunedSettings = {
+        .pollingPeriodMilliseconds = 4,
+        .onDemandPolling = true,
+        .coalesceAxisEvents = false,
+        .stateChangeEventPeriodMilliseconds = 8};
+
+    const std::string contents = AutoTune::ProfileFileContents(kTunedSettings);
+
+    TEST_ASSERT(std::string::npos != contents.find("[Properties]\n"));
+    TEST_ASSERT(std::string::npos != contents.find("CoalesceAxisEvents = no\n"));
+    TEST_ASSERT(std::string::npos != contents.find("OnDemandPolling = yes\n"));
+    TEST_ASSERT(std::string::npos != contents.find("PollingPeriodMilliseconds = 4\n"));
+    TEST_ASSERT(std::string::npos != contents.find("StateChangeEventPeriodMilliseconds = 8\n"));
+  }
+
+  // Verifies that profile file contents omit the state change notification period if no value is
+  // suggested for it.
+  TEST_CASE(AutoTune_ProfileFileContents_NoStateChangeEventPeriod)
+  {
+    const AutoTune::STunedSettings kTunedSettings = {.pollingPeriodMilliseconds = 5};
+
+    const std::string contents = AutoTune::ProfileFileContents(kTunedSettings);
+
+    TEST_ASSERT(std::string::npos != contents.find("PollingPeriodMilliseconds = 5\n"));
+    TEST_ASSERT(std::string::npos == contents.find("StateChangeEventPeriodMilliseconds"));
+  }
+} // namespace XidiTest
@@ -0,0 +1,172 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ConcurrencyWrapperTest.cpp
+ *   Unit tests for concurrency-safe data wrappers.
+ **************************************************************************************************/
+
+#include "ConcurrencyWrapper.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ControllerTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+  using ::Xidi::Controller::EPhysicalDeviceStatus;
+  using ::Xidi::Controller::SPhysicalState;
+
+  /// Creates and returns a physical state object whose contents are derived from the specified
+  /// value. Every analog element holds the same value, so a torn read is easy to detect.
+  /// @param [in] value Value from which to derive the physical state object.
+  /// @return Physical state object derived from the specified value.
+  static SPhysicalState MakeTestPhysicalState(int16_t value)
+  {
+    return {
+        .deviceStatus = EPhysicalDeviceStatus::Ok,
+        .stick = {value, value, value, value},
+        .trigger = {static_cast<uint8_t>(value), static_cast<uint8_t>(value)}};
+  }
+
+  /// Determines if the specified physical state object is internally consistent, meaning that it
+  /// could have been produced by #MakeTestPhysicalState.
+  /// @param [in] state Physical state object to check.
+  /// @return `true` if the object is consistent, `false` otherwise.
+  static bool IsTestPhysicalStateConsistent(const SPhysicalState& state)
+  {
+    return (state == MakeTestPhysicalState(state.stick[0]));
+  }
+
+  // Verifies that data written to a sequence lock wrapper is retrieved as written.
+  TEST_CASE(SeqLockConcurrencyWrapper_SetAndGet)
+  {
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+    TEST_ASSERT(SPhysicalState() == wrapper.Get());
+
+    for (int16_t value = -3; value <= 3; ++value)
+    {
+      const SPhysicalState expectedState = MakeTestPhysicalState(value);
+      wrapper.Set(expectedState);
+      TEST_ASSERT(expectedState == wrapper.Get());
+    }
+  }
+
+  // Verifies that parts of data written to a sequence lock wrapper are retrieved as written.
+  TEST_CASE(SeqLockConcurrencyWrapper_SetAndGetPart)
+  {
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+
+    for (int16_t value = -3; value <= 3; ++value)
+    {
+      const SPhysicalState expectedState = MakeTestPhysicalState(value);
+      wrapper.Set(expectedState);
+      TEST_ASSERT(
+          expectedState.stick ==
+          wrapper.GetPart<decltype(SPhysicalState::stick)>(offsetof(SPhysicalState, stick)));
+      TEST_ASSERT(
+          expectedState.trigger ==
+          wrapper.GetPart<decltype(SPhysicalState::trigger)>(offsetof(SPhysicalState, trigger)));
+    }
+  }
+
+  // Verifies that updates are only reported if the data actually changed.
+  TEST_CASE(SeqLockConcurrencyWrapper_UpdateOnlyOnChange)
+  {
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+
+    TEST_ASSERT(true == wrapper.Update(MakeTestPhysicalState(10)));
+    TEST_ASSERT(false == wrapper.Update(MakeTestPhysicalState(10)));
+    TEST_ASSERT(true == wrapper.Update(MakeTestPhysicalState(20)));
+    TEST_ASSERT(MakeTestPhysicalState(20) == wrapper.Get());
+  }
+
+  // Verifies that the generation number obtained without reading the data matches the one obtained
+  // along with the data and only advances when the data are updated.
+  TEST_CASE(SeqLockConcurrencyWrapper_GetGeneration)
+  {
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+
+    TGeneration generation = 0;
+    wrapper.Get(generation);
+    TEST_ASSERT(generation == wrapper.GetGeneration());
+
+    TEST_ASSERT(false == wrapper.Update(SPhysicalState()));
+    TEST_ASSERT(generation == wrapper.GetGeneration());
+
+    TEST_ASSERT(true == wrapper.Update(MakeTestPhysicalState(10)));
+    TEST_ASSERT((1 + generation) == wrapper.GetGeneration());
+
+    wrapper.Get(generation);
+    TEST_ASSERT(generation == wrapper.GetGeneration());
+  }
+
+  // Verifies that waiting for an update returns immediately if the caller's last-known data are
+  // already out of date, and that the caller's copy is refreshed.
+  TEST_CASE(SeqLockConcurrencyWrapper_WaitForUpdateAlreadyChanged)
+  {
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+    wrapper.Update(MakeTestPhysicalState(5));
+
+    SPhysicalState lastKnownState = MakeTestPhysicalState(4);
+    TEST_ASSERT(true == wrapper.WaitForUpdate(lastKnownState, std::stop_token()));
+    TEST_ASSERT(MakeTestPhysicalState(5) == lastKnownState);
+  }
+
+  // Verifies that a wait can be interrupted using a stop token and that an interrupted wait does
+  // not modify the caller's copy of the data.
+  TEST_CASE(SeqLockConcurrencyWrapper_WaitForUpdateInterrupted)
+  {
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+    wrapper.Update(MakeTestPhysicalState(5));
+
+    SPhysicalState lastKnownState = MakeTestPhysicalState(5);
+    std::stop_source stopSource;
+    std::thread stopThread(
+        [&stopSource]() -> void
+        {
+          stopSource.request_stop();
+        });
+
+    TEST_ASSERT(false == wrapper.WaitForUpdate(lastKnownState, stopSource.get_token()));
+    TEST_ASSERT(MakeTestPhysicalState(5) == lastKnownState);
+    stopThread.join();
+  }
+
+  // Verifies that a reader thread waiting for updates is woken by a concurrent writer and never
+  // observes torn data, even while the writer produces updates as fast as it can.
+  TEST_CASE(SeqLockConcurrencyWrapper_ConcurrentReaderAndWriter)
+  {
+    constexpr int16_t kFinalValue = 20000;
+
+    SeqLockConcurrencyWrapper<SPhysicalState> wrapper;
+    wrapper.Set(MakeTestPhysicalState(0));
+
+    bool allReadsConsistent = true;
+    std::thread readerThread(
+        [&wrapper, &allReadsConsistent]() -> void
+        {
+          SPhysicalState lastKnownState = MakeTestPhysicalState(0);
+          while (kFinalValue != lastKnownState.stick[0])
+          {
+            wrapper.WaitForUpdate(lastKnownState, std::stop_token());
+            if (false == IsTestPhysicalStateConsistent(lastKnownState)) allReadsConsistent = false;
+          }
+        });
+
+    for (int16_t value = 1; value <= kFinalValue; ++value)
+      wrapper.Update(MakeTestPhysicalState(value));
+
+    readerThread.join();
+    TEST_ASSERT(true == allReadsConsistent);
+  }
+} // namespace XidiTest
@@ -0,0 +1,182 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ConditionEffectTest.cpp
+ *   Unit tests for force feedback effects that produce a force in response to the state of the
+ *   virtual controller axes.
+ **************************************************************************************************/
+
+#include <Infra/Test/TestCase.h>
+
+#include "ControllerTypes.h"
+#include "ForceFeedbackEffect.h"
+#include "ForceFeedbackParameters.h"
+#include "ForceFeedbackTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller::ForceFeedback;
+  using ::Xidi::Controller::EAxis;
+
+  /// Common duration value used throughout test cases.
+  static constexpr TEffectTimeMs kTestEffectDuration = 1000;
+
+  /// Common single-axis condition used throughout test cases. Generates a force of half the
+  /// displacement on the positive side and a force equal to the displacement on the negative side,
+  /// with a small dead band around an offset slightly above center.
+  static constexpr SAxisCondition kTestAxisCondition = {
+      .offset = 1000,
+      .positiveCoefficient = 5000,
+      .negativeCoefficient = 10000,
+      .positiveSaturation = 2000,
+      .negativeSaturation = 10000,
+      .deadBand = 500};
+
+  /// Initializes a condition effect using defaults for mandatory parameters, associating it with
+  /// the X and Y axes but leaving its direction unset.
+  /// @tparam ConditionEffectType Type of condition effect to initialize.
+  /// @param [in] conditionParameters Type-specific parameters for the condition effect.
+  /// @return Properly-initialized condition effect object that can be used in test cases.
+  template <typename ConditionEffectType> static ConditionEffectType MakeTestEffect(
+      const SConditionParameters& conditionParameters)
+  {
+    ConditionEffectType effect;
+    effect.SetAssociatedAxes({.count = 2, .type = {EAxis::X, EAxis::Y}});
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetTypeSpecificParameters(conditionParameters);
+    return effect;
+  }
+
+  // Verifies that a single-axis condition generates no force within the dead band, a force
+  // proportional to the distance from the edge of the dead band elsewhere, and that the force
+  // opposes the displacement and is limited by the saturation on each side of the offset.
+  TEST_CASE(ConditionEffect_ComputeAxisForce_Nominal)
+  {
+    const SpringEffect effect;
+
+    TEST_ASSERT(0 == effect.ComputeAxisForce(kTestAxisCondition, 1000));
+    TEST_ASSERT(0 == effect.ComputeAxisForce(kTestAxisCondition, 1500));
+    TEST_ASSERT(0 == effect.ComputeAxisForce(kTestAxisCondition, 500));
+
+    TEST_ASSERT(-1000 == effect.ComputeAxisForce(kTestAxisCondition, 3500));
+    TEST_ASSERT(-2000 == effect.ComputeAxisForce(kTestAxisCondition, 9000));
+
+    TEST_ASSERT(3000 == effect.ComputeAxisForce(kTestAxisCondition, -2500));
+    TEST_ASSERT(10000 == effect.ComputeAxisForce(kTestAxisCondition, -10000));
+  }
+
+  // Verifies that friction generates a force whose strength is given by the coefficient regardless
+  // of how far outside the dead band the metric is, still limited by the saturation.
+  TEST_CASE(ConditionEffect_ComputeAxisForce_Friction)
+  {
+    const FrictionEffect effect;
+
+    TEST_ASSERT(0 == effect.ComputeAxisForce(kTestAxisCondition, 1200));
+    TEST_ASSERT(-2000 == effect.ComputeAxisForce(kTestAxisCondition, 1600));
+    TEST_ASSERT(-2000 == effect.ComputeAxisForce(kTestAxisCondition, 10000));
+    TEST_ASSERT(10000 == effect.ComputeAxisForce(kTestAxisCondition, 400));
+    TEST_ASSERT(10000 == effect.ComputeAxisForce(kTestAxisCondition, -10000));
+  }
+
+  // Verifies that each type of condition effect responds to the correct axis metric and that a
+  // single condition applies to all of the associated axes.
+  TEST_CASE(ConditionEffect_ComputeOrderedMagnitudeComponents_MetricSelection)
+  {
+    constexpr SConditionParameters kTestConditionParameters = {
+        .count = 1, .axis = {kTestAxisCondition}};
+    constexpr SConditionInput kTestConditionInput = {
+        .position = {3500, -2500},
+        .velocity = {9000, -10000},
+        .acceleration = {1500, 500}};
+
+    TOrderedMagnitudeComponents expectedSpringOutput = {};
+    expectedSpringOutput[(int)EAxis::X] = -1000;
+    expectedSpringOutput[(int)EAxis::Y] = 3000;
+
+    TOrderedMagnitudeComponents expectedDamperOutput = {};
+    expectedDamperOutput[(int)EAxis::X] = -2000;
+    expectedDamperOutput[(int)EAxis::Y] = 10000;
+
+    const TOrderedMagnitudeComponents expectedInertiaOutput = {};
+
+    TEST_ASSERT(
+        expectedSpringOutput ==
+        MakeTestEffect<SpringEffect>(kTestConditionParameters)
+            .ComputeOrderedMagnitudeComponents(0, kTestConditionInput));
+    TEST_ASSERT(
+        expectedDamperOutput ==
+        MakeTestEffect<DamperEffect>(kTestConditionParameters)
+            .ComputeOrderedMagnitudeComponents(0, kTestConditionInput));
+    TEST_ASSERT(
+        expectedInertiaOutput ==
+        MakeTestEffect<InertiaEffect>(kTestConditionParameters)
+            .ComputeOrderedMagnitudeComponents(0, kTestConditionInput));
+  }
+
+  // Verifies that separate conditions apply to separate axes, that gain is applied, and that no
+  // force is generated once the duration has elapsed.
+  TEST_CASE(ConditionEffect_ComputeOrderedMagnitudeComponents_PerAxisWithGain)
+  {
+    constexpr SAxisCondition kTestSecondAxisCondition = {
+        .offset = 0,
+        .positiveCoefficient = 10000,
+        .negativeCoefficient = 10000,
+        .positiveSaturation = 10000,
+        .negativeSaturation = 10000,
+        .deadBand = 0};
+    constexpr SConditionParameters kTestConditionParameters = {
+        .count = 2, .axis = {kTestAxisCondition, kTestSecondAxisCondition}};
+    constexpr SConditionInput kTestConditionInput = {.position = {3500, -2500}};
+
+    SpringEffect effect = MakeTestEffect<SpringEffect>(kTestConditionParameters);
+    TEST_ASSERT(true == effect.IsCompletelyDefined());
+    TEST_ASSERT(true == effect.IsConditionEffect());
+    TEST_ASSERT(true == effect.SetGain(5000));
+
+    TOrderedMagnitudeComponents expectedOutput = {};
+    expectedOutput[(int)EAxis::X] = -500;
+    expectedOutput[(int)EAxis::Y] = 1250;
+
+    TEST_ASSERT(expectedOutput == effect.ComputeOrderedMagnitudeComponents(0, kTestConditionInput));
+    TEST_ASSERT(
+        TOrderedMagnitudeComponents() ==
+        effect.ComputeOrderedMagnitudeComponents(kTestEffectDuration, kTestConditionInput));
+  }
+
+  // Verifies that out-of-range condition values are fixed but that an invalid number of conditions
+  // causes the parameters to be rejected.
+  TEST_CASE(ConditionEffect_TypeSpecificParameters_Invalid)
+  {
+    constexpr SAxisCondition kOutOfRangeAxisCondition = {
+        .offset = 20000,
+        .positiveCoefficient = -20000,
+        .negativeCoefficient = 100,
+        .positiveSaturation = -1,
+        .negativeSaturation = 20000,
+        .deadBand = 100};
+    constexpr SAxisCondition kFixedAxisCondition = {
+        .offset = 10000,
+        .positiveCoefficient = -10000,
+        .negativeCoefficient = 100,
+        .positiveSaturation = 0,
+        .negativeSaturation = 10000,
+        .deadBand = 100};
+    constexpr SConditionParameters kOutOfRangeConditionParameters = {
+        .count = 1, .axis = {kOutOfRangeAxisCondition}};
+    constexpr SConditionParameters kFixedConditionParameters = {
+        .count = 1, .axis = {kFixedAxisCondition}};
+
+    SpringEffect effect;
+    TEST_ASSERT(true == effect.SetTypeSpecificParameters(kOutOfRangeConditionParameters));
+    TEST_ASSERT(kFixedConditionParameters == effect.GetTypeSpecificParameters().value());
+
+    TEST_ASSERT(false == effect.SetTypeSpecificParameters({.count = 0}));
+    TEST_ASSERT(
+        false == effect.SetTypeSpecificParameters({.count = kEffectAxesMaximumNumber + 1}));
+    TEST_ASSERT(kFixedConditionParameters == effect.GetTypeSpecificParameters().value());
+  }
+} // namespace XidiTest
@@ -159,6 +159,46 @@ namespace XidiTest
 
   // Verifies that out-of-bounds magnitudes are accepted and saturated at the extreme ends of the
   // supported range.
+  // Creates a constant force effect with an envelope and a sample period and verifies that the
+  // magnitude is reported as being stable throughout the sustain portion of the envelope but
+  // changing at each sample period boundary during the attack and fade portions. Also verifies
+  // that the magnitude really is the same throughout each interval reported as stable.
+  TEST_CASE(ConstantForceEffect_ComputeMagnitudeStableUntil_Envelope)
+  {
+    constexpr TEffectTimeMs kTestSamplePeriod = 10;
+    constexpr SEnvelope kTestEnvelope = {
+        .attackTime = kTestEffectDuration / 10,
+        .attackLevel = 7000,
+        .fadeTime = kTestEffectDuration / 5,
+        .fadeLevel = 1000};
+    constexpr TEffectTimeMs kFadeStartTime = kTestEffectDuration - kTestEnvelope.fadeTime;
+
+    ConstantForceEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetSamplePeriod(kTestSamplePeriod);
+    effect.SetTypeSpecificParameters({.magnitude = 5000});
+
+    TEST_ASSERT(kTestEffectDuration == effect.ComputeMagnitudeStableUntil(0));
+
+    effect.SetEnvelope(kTestEnvelope);
+
+    for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+    {
+      const TEffectTimeMs nextSampleTime = t - (t % kTestSamplePeriod) + kTestSamplePeriod;
+      const TEffectTimeMs expectedStableUntil =
+          (((t >= kTestEnvelope.attackTime) && (t < kFadeStartTime + kTestSamplePeriod))
+               ? (kFadeStartTime + kTestSamplePeriod)
+               : nextSampleTime);
+      const TEffectTimeMs actualStableUntil = effect.ComputeMagnitudeStableUntil(t);
+      TEST_ASSERT(actualStableUntil == expectedStableUntil);
+
+      for (TEffectTimeMs u = t; u < actualStableUntil; ++u)
+        TEST_ASSERT(effect.ComputeMagnitude(u) == effect.ComputeMagnitude(t));
+    }
+  }
+
   TEST_CASE(ConstantForceEffect_SetMagnitude_CheckAndFixTypeSpecificParameters)
   {
     constexpr TEffectValue kInputMagnitudes[] = {
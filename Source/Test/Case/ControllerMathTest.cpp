@@ -12,6 +12,9 @@
 #include "ControllerMath.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
 
 #include <Infra/Test/TestCase.h>
 
@@ -20,6 +23,11 @@
 namespace XidiTest
 {
   using namespace ::Xidi::Controller::Math;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::kAnalogValueMax;
+  using ::Xidi::Controller::kAnalogValueMin;
+  using ::Xidi::Controller::kTriggerValueMax;
+  using ::Xidi::Controller::kTriggerValueMin;
 
   /// Compares two integer values and determines if they are "sufficiently equal" or not. The
   /// comparison computes the absolute value of the difference and ensures it is within a very tight
@@ -246,6 +254,60 @@ namespace XidiTest
     }
   }
 
+  // Verifies that the precomputed version of the analog stick deadzone and saturation
+  // transformation produces results that are sufficiently equal to the floating-point version for
+  // every possible analog value.
+  TEST_CASE(ControllerMath_AnalogTransformPrecomputed_MatchesFloatingPoint)
+  {
+    constexpr struct
+    {
+      unsigned int deadzonePercent;
+      unsigned int saturationPercent;
+    } kTestSettings[] = {{0, 100}, {10, 100}, {0, 75}, {25, 80}, {45, 55}};
+
+    for (const auto& testSetting : kTestSettings)
+    {
+      const SRawAnalogTransformParameters parameters = MakeRawAnalogTransformParameters(
+          testSetting.deadzonePercent, testSetting.saturationPercent);
+
+      for (int32_t analogValue = std::numeric_limits<int16_t>::min();
+           analogValue <= std::numeric_limits<int16_t>::max();
+           ++analogValue)
+      {
+        const int16_t expectedOutput = ApplyRawAnalogTransform(
+            (int16_t)analogValue, testSetting.deadzonePercent, testSetting.saturationPercent);
+        const int16_t actualOutput = ApplyRawAnalogTransform((int16_t)analogValue, parameters);
+        TEST_ASSERT(SufficientlyEqual(actualOutput, expectedOutput));
+      }
+    }
+  }
+
+  // Verifies that the precomputed version of the trigger deadzone and saturation transformation
+  // produces results identical to the direct version for every possible trigger value.
+  TEST_CASE(ControllerMath_TriggerTransformPrecomputed_MatchesDirect)
+  {
+    constexpr struct
+    {
+      unsigned int deadzonePercent;
+      unsigned int saturationPercent;
+    } kTestSettings[] = {{0, 100}, {10, 100}, {0, 75}, {25, 80}, {45, 55}};
+
+    for (const auto& testSetting : kTestSettings)
+    {
+      const SRawTriggerTransformTable table = MakeRawTriggerTransformTable(
+          testSetting.deadzonePercent, testSetting.saturationPercent);
+
+      for (int32_t triggerValue = kTriggerValueMin; triggerValue <= kTriggerValueMax;
+           ++triggerValue)
+      {
+        const uint8_t expectedOutput = ApplyRawTriggerTransform(
+            (uint8_t)triggerValue, testSetting.deadzonePercent, testSetting.saturationPercent);
+        const uint8_t actualOutput = ApplyRawTriggerTransform((uint8_t)triggerValue, table);
+        TEST_ASSERT(actualOutput == expectedOutput);
+      }
+    }
+  }
+
   // Verifies that analog sticks are correctly identified as "pressed" as a digital button if
   // sufficiently pressed in the positive direction. Only checks extreme values to avoid enforcing a
   // specific threshold value requirement.
@@ -328,6 +390,67 @@ namespace XidiTest
     }
   }
 
+  // Verifies that transforming all axis values at once produces exactly the same results as
+  // transforming them one at a time, across the entire analog range and beyond it. Each lane uses
+  // different parameters, including a range wide enough to require both halves of the range scale
+  // factor and a lane for which transformations are disabled.
+  TEST_CASE(ControllerMath_TransformAxisValues_MatchesScalar)
+  {
+    constexpr int32_t kTestValueStep = 7;
+
+    SAxisTransformParameters parameters = {};
+    for (unsigned int lane = 0; lane < static_cast<unsigned int>(EAxis::Count); ++lane)
+    {
+      const int32_t deadzoneCutoff = (int32_t)(lane * 1500);
+      const int32_t saturationCutoff = 32767 - (int32_t)(lane * 2000);
+      const int64_t rangeDistance = ((0 == (lane % 2)) ? 10000 : 2147483647ll);
+      const uint64_t rangeScale =
+          ((uint64_t)rangeDistance << kAxisTransformScaleFactorFractionBits) /
+          (uint64_t)(saturationCutoff - deadzoneCutoff);
+
+      parameters.transformMask[lane] = ((5 == lane) ? 0 : -1);
+      parameters.deadzoneCutoffPositive[lane] = deadzoneCutoff;
+      parameters.deadzoneCutoffNegative[lane] = -deadzoneCutoff;
+      parameters.saturationDistancePositive[lane] = saturationCutoff - deadzoneCutoff;
+      parameters.saturationDistanceNegative[lane] = saturationCutoff - deadzoneCutoff;
+      parameters.rangeScaleLowPositive[lane] = (uint32_t)rangeScale;
+      parameters.rangeScaleHighPositive[lane] = (uint32_t)(rangeScale >> 32);
+      parameters.rangeScaleLowNegative[lane] = (uint32_t)rangeScale;
+      parameters.rangeScaleHighNegative[lane] = (uint32_t)(rangeScale >> 32);
+      parameters.rangeMin[lane] = (int32_t)(-rangeDistance);
+      parameters.rangeMax[lane] = (int32_t)rangeDistance;
+      parameters.rangeNeutral[lane] = 0;
+    }
+
+    for (int32_t testValue = (int32_t)kAnalogValueMin - 100;
+         testValue <= (int32_t)kAnalogValueMax + 100;
+         testValue += kTestValueStep)
+    {
+      std::array<int32_t, static_cast<int>(EAxis::Count)> actualAxisValues;
+      actualAxisValues.fill(testValue);
+      TransformAxisValues(actualAxisValues, parameters);
+
+      for (unsigned int lane = 0; lane < actualAxisValues.size(); ++lane)
+      {
+        const int32_t expectedAxisValue =
+            TransformAxisValue(testValue, parameters, static_cast<EAxis>(lane));
+        TEST_ASSERT(actualAxisValues[lane] == expectedAxisValue);
+      }
+
+      TEST_ASSERT(actualAxisValues[5] == testValue);
+    }
+
+    std::array<int32_t, static_cast<int>(EAxis::Count)> extremeAxisValues = {
+        INT32_MIN, INT32_MAX, 0, -32769, 32768, 1};
+    TransformAxisValues(extremeAxisValues, parameters);
+    TEST_ASSERT(extremeAxisValues[0] == parameters.rangeMin[0]);
+    TEST_ASSERT(extremeAxisValues[1] == parameters.rangeMax[1]);
+    TEST_ASSERT(extremeAxisValues[2] == parameters.rangeNeutral[2]);
+    TEST_ASSERT(extremeAxisValues[3] == parameters.rangeMin[3]);
+    TEST_ASSERT(extremeAxisValues[4] == parameters.rangeMax[4]);
+    TEST_ASSERT(extremeAxisValues[5] == 1);
+  }
+
   // Verifies correct application of the square correction transformation, using input coordinates
   // along only a single axis at a time. The expected result is that there should be no change in
   // the input.
@@ -451,4 +574,40 @@ namespace XidiTest
     }
   }
 
+  // Verifies that the precomputed version of the square correction transformation produces
+  // results that are sufficiently equal to the floating-point version, using input coordinates
+  // spread across the entire two-dimensional range of motion, including coordinates that are not
+  // possible in a completely circular range of motion.
+  TEST_CASE(ControllerMath_TransformCoordinatesCircleToSquarePrecomputed_MatchesFloatingPoint)
+  {
+    constexpr double kAmountFractions[] = {0.0, 0.25, 0.5, 1.0};
+    constexpr int32_t kCoordinateStep = 97;
+
+    for (const auto amountFraction : kAmountFractions)
+    {
+      const SCircleToSquareTable table = MakeCircleToSquareTable(amountFraction);
+      TEST_ASSERT(
+          (SAnalogStickCoordinates{.x = 0, .y = 0}) ==
+          TransformCoordinatesCircleToSquare(SAnalogStickCoordinates{.x = 0, .y = 0}, table));
+
+      for (int32_t x = std::numeric_limits<int16_t>::min();
+           x <= std::numeric_limits<int16_t>::max();
+           x += kCoordinateStep)
+      {
+        for (int32_t y = std::numeric_limits<int16_t>::max();
+             y >= std::numeric_limits<int16_t>::min();
+             y -= kCoordinateStep)
+        {
+          const SAnalogStickCoordinates testValue = {.x = (int16_t)x, .y = (int16_t)y};
+
+          const SAnalogStickCoordinates expectedOutput =
+              TransformCoordinatesCircleToSquare(testValue, amountFraction);
+          const SAnalogStickCoordinates actualOutput =
+              TransformCoordinatesCircleToSquare(testValue, table);
+          TEST_ASSERT(SufficientlyEqual(actualOutput.x, expectedOutput.x));
+          TEST_ASSERT(SufficientlyEqual(actualOutput.y, expectedOutput.y));
+        }
+      }
+    }
+  }
 } // namespace XidiTest
@@ -0,0 +1,137 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file CustomForceEffectTest.cpp
+ *   Unit tests for force feedback effects that produce a force whose magnitude is given by a table
+ *   of samples.
+ **************************************************************************************************/
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ForceFeedbackEffect.h"
+#include "ForceFeedbackParameters.h"
+#include "ForceFeedbackTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller::ForceFeedback;
+
+  /// Common duration value used throughout test cases.
+  static constexpr TEffectTimeMs kTestEffectDuration = 1000;
+
+  /// Common sample period value used throughout test cases.
+  static constexpr TEffectTimeMs kTestSamplePeriod = 10;
+
+  /// Creates a shared immutable sample buffer holding the specified samples.
+  /// @param [in] samples Samples to place into the buffer.
+  /// @return Shared pointer to the new buffer.
+  static std::shared_ptr<const std::vector<TEffectValue>> MakeTestSamples(
+      std::vector<TEffectValue>&& samples)
+  {
+    return std::make_shared<const std::vector<TEffectValue>>(std::move(samples));
+  }
+
+  // Creates a custom force effect and verifies that each sample is played for one sample period,
+  // one after the other, and that the samples repeat for the entire duration of the effect.
+  TEST_CASE(CustomForceEffect_ComputeMagnitude_Nominal)
+  {
+    const std::vector<TEffectValue> kTestSamples = {1000, -2000, 3000, 0, 5000};
+
+    CustomForceEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    TEST_ASSERT(
+        true ==
+        effect.SetTypeSpecificParameters(
+            {.samples = MakeTestSamples(std::vector<TEffectValue>(kTestSamples)),
+             .samplePeriod = kTestSamplePeriod}));
+
+    for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+    {
+      const TEffectValue expectedMagnitude =
+          kTestSamples[(t / kTestSamplePeriod) % kTestSamples.size()];
+      const TEffectValue actualMagnitude = effect.ComputeMagnitude(t);
+      TEST_ASSERT(actualMagnitude == expectedMagnitude);
+    }
+  }
+
+  // Verifies that a custom force effect reports its magnitude as stable until the next sample
+  // takes over, and that the magnitude really is the same throughout each such interval.
+  TEST_CASE(CustomForceEffect_ComputeMagnitudeStableUntil_Nominal)
+  {
+    CustomForceEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetTypeSpecificParameters(
+        {.samples = MakeTestSamples({1000, -2000, 3000}), .samplePeriod = kTestSamplePeriod});
+
+    for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+    {
+      const TEffectTimeMs expectedStableUntil = t - (t % kTestSamplePeriod) + kTestSamplePeriod;
+      const TEffectTimeMs actualStableUntil = effect.ComputeMagnitudeStableUntil(t);
+      TEST_ASSERT(actualStableUntil == expectedStableUntil);
+
+      for (TEffectTimeMs u = t; u < actualStableUntil; ++u)
+        TEST_ASSERT(effect.ComputeMagnitude(u) == effect.ComputeMagnitude(t));
+    }
+  }
+
+  // Verifies that copies of a custom force effect share the same sample buffer instead of each
+  // holding a copy of their own, both when cloning and when synchronizing parameters.
+  TEST_CASE(CustomForceEffect_Clone_SharesSamples)
+  {
+    CustomForceEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetTypeSpecificParameters(
+        {.samples = MakeTestSamples({100, 200, 300}), .samplePeriod = kTestSamplePeriod});
+
+    const std::unique_ptr<Effect> clonedEffect = effect.Clone();
+    TEST_ASSERT(
+        effect.GetTypeSpecificParameters()->samples ==
+        ((CustomForceEffect*)clonedEffect.get())->GetTypeSpecificParameters()->samples);
+
+    effect.SetTypeSpecificParameters(
+        {.samples = MakeTestSamples({400, 500}), .samplePeriod = kTestSamplePeriod});
+    TEST_ASSERT(true == clonedEffect->SyncParametersFrom(effect));
+    TEST_ASSERT(
+        effect.GetTypeSpecificParameters()->samples ==
+        ((CustomForceEffect*)clonedEffect.get())->GetTypeSpecificParameters()->samples);
+  }
+
+  // Verifies that out-of-range samples and sample periods are fixed but that missing samples cause
+  // the parameters to be rejected.
+  TEST_CASE(CustomForceEffect_TypeSpecificParameters_Invalid)
+  {
+    CustomForceEffect effect;
+
+    TEST_ASSERT(
+        true ==
+        effect.SetTypeSpecificParameters(
+            {.samples = MakeTestSamples({20000, -20000, 500}), .samplePeriod = 0}));
+
+    const SCustomForceParameters kExpectedFixedParameters = {
+        .samples = MakeTestSamples({10000, -10000, 500}), .samplePeriod = 1};
+    TEST_ASSERT(kExpectedFixedParameters == effect.GetTypeSpecificParameters().value());
+
+    TEST_ASSERT(
+        false ==
+        effect.SetTypeSpecificParameters({.samples = nullptr, .samplePeriod = kTestSamplePeriod}));
+    TEST_ASSERT(
+        false ==
+        effect.SetTypeSpecificParameters(
+            {.samples = MakeTestSamples({}), .samplePeriod = kTestSamplePeriod}));
+    TEST_ASSERT(kExpectedFixedParameters == effect.GetTypeSpecificParameters().value());
+  }
+} // namespace XidiTest
@@ -12,8 +12,11 @@
 
 #include "DataFormat.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include <Infra/Test/TestCase.h>
 #include <Infra/Test/Utilities.h>
@@ -196,6 +199,38 @@ namespace XidiTest
         TEST_ASSERT(actualPovOffset == expectedPovOffset);
       }
     }
+
+    // Finally, verify that every offset that has an element associated with it maps back to that
+    // same offset, and that offsets outside of the maximum packet size never map to an element.
+    for (TOffset offset = 0; offset < DataFormat::kMaxDataPacketSizeBytes; ++offset)
+    {
+      const std::optional<SElementIdentifier> maybeElement =
+          dataFormat->GetElementForOffset(offset);
+      if (true == maybeElement.has_value())
+        TEST_ASSERT(offset == dataFormat->GetOffsetForElement(maybeElement.value()).value());
+    }
+
+    TEST_ASSERT(false == dataFormat->HasOffset(DataFormat::kMaxDataPacketSizeBytes));
+    TEST_ASSERT(false == dataFormat->HasOffset(DataFormat::kInvalidOffsetValue));
+
+    // The set of elements present in the data format should match the elements that have offsets.
+    Controller::TElementMask expectedElements = 0;
+    for (int i = 0; i < _countof(expectedDataFormatSpec.axisOffset); ++i)
+    {
+      if (DataFormat::kInvalidOffsetValue != expectedDataFormatSpec.axisOffset[i])
+        expectedElements |=
+            Controller::ElementMaskForElement({.type = EElementType::Axis, .axis = (EAxis)i});
+    }
+    for (int i = 0; i < _countof(expectedDataFormatSpec.buttonOffset); ++i)
+    {
+      if (DataFormat::kInvalidOffsetValue != expectedDataFormatSpec.buttonOffset[i])
+        expectedElements |=
+            Controller::ElementMaskForElement({.type = EElementType::Button, .button = (EButton)i});
+    }
+    if (DataFormat::kInvalidOffsetValue != expectedDataFormatSpec.povOffset)
+      expectedElements |= Controller::ElementMaskForElement({.type = EElementType::Pov});
+
+    TEST_ASSERT(expectedElements == dataFormat->GetElements());
   }
 
   /// Main checks that are part of the CreateFailure suite of test cases.
@@ -210,6 +245,10 @@ namespace XidiTest
     std::unique_ptr<DataFormat> dataFormat =
         DataFormat::CreateFromApplicationFormatSpec(appFormatSpec, controllerCapabilities);
     TEST_ASSERT(nullptr == dataFormat);
+
+    std::shared_ptr<const DataFormat> reusableDataFormat =
+        DataFormat::GetOrCreateFromApplicationFormatSpec(appFormatSpec, controllerCapabilities);
+    TEST_ASSERT(nullptr == reusableDataFormat);
   }
 
   // Verifies that POV direction values are correctly produced from controller states.
@@ -547,6 +586,273 @@ namespace XidiTest
     }
   }
 
+  // Verifies that application data packets are correctly written when buttons are laid out in the
+  // same order as the virtual controller, such that they can be written several at a time, and when
+  // they are laid out in reverse order, such that each button is written individually. Also
+  // verifies that any buffer space beyond the end of the data packet is zeroed out.
+  TEST_CASE(DataFormat_WriteDataPacket_ButtonRuns)
+  {
+    static constexpr int kButtonCount = 16;
+
+    struct STestDataPacket
+    {
+      TAxisValue axisX;
+      TButtonValue button[kButtonCount];
+    };
+
+    static_assert(
+        0 == (sizeof(STestDataPacket) % 4), "Test data packet size must be divisible by 4.");
+
+    constexpr Controller::SState kTestControllerState = {
+        .axis = {1111, 2222, 3333, 4444, 5555, 6666}, .button = 0b1011001110001101};
+
+    for (bool buttonsInReverseOrder : {false, true})
+    {
+      DIOBJECTDATAFORMAT testObjectFormatSpec[1 + kButtonCount] = {
+          {.pguid = &GUID_XAxis,
+           .dwOfs = offsetof(STestDataPacket, axisX),
+           .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+           .dwFlags = 0}};
+
+      for (int i = 0; i < kButtonCount; ++i)
+      {
+        const int buttonIndex = ((true == buttonsInReverseOrder) ? (kButtonCount - 1 - i) : i);
+
+        testObjectFormatSpec[1 + i] = {
+            .pguid = nullptr,
+            .dwOfs = (DWORD)(offsetof(STestDataPacket, button) + buttonIndex),
+            .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+            .dwFlags = 0};
+      }
+
+      const DIDATAFORMAT kTestFormatSpec = {
+          .dwSize = sizeof(DIDATAFORMAT),
+          .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+          .dwFlags = DIDF_ABSAXIS,
+          .dwDataSize = sizeof(STestDataPacket),
+          .dwNumObjs = _countof(testObjectFormatSpec),
+          .rgodf = testObjectFormatSpec};
+
+      std::unique_ptr<DataFormat> dataFormat = DataFormat::CreateFromApplicationFormatSpec(
+          kTestFormatSpec, kTestMapperWithoutPov.GetCapabilities());
+      TEST_ASSERT(nullptr != dataFormat);
+
+      // Expected data packet is followed by padding, all of which is expected to be zeroed.
+      uint8_t expectedDataPacket[sizeof(STestDataPacket) + 16];
+      ZeroMemory(expectedDataPacket, sizeof(expectedDataPacket));
+      ((STestDataPacket*)expectedDataPacket)->axisX = kTestControllerState[EAxis::X];
+
+      for (int i = 0; i < kButtonCount; ++i)
+      {
+        const int buttonIndex = ((true == buttonsInReverseOrder) ? (kButtonCount - 1 - i) : i);
+
+        ((STestDataPacket*)expectedDataPacket)->button[buttonIndex] =
+            ((true == kTestControllerState.button[i]) ? DataFormat::kButtonValuePressed
+                                                      : DataFormat::kButtonValueNotPressed);
+      }
+
+      uint8_t actualDataPacket[sizeof(expectedDataPacket)];
+      FillMemory(actualDataPacket, sizeof(actualDataPacket), 0xcd);
+      TEST_ASSERT(
+          true ==
+          dataFormat->WriteDataPacket(
+              actualDataPacket, sizeof(actualDataPacket), kTestControllerState));
+      TEST_ASSERT(0 == memcmp(actualDataPacket, expectedDataPacket, sizeof(expectedDataPacket)));
+    }
+  }
+
+  // Verifies that patching an application data packet with only the elements that changed between
+  // two controller states produces the same result as writing the entire packet, and that elements
+  // not requested to be written are left untouched.
+  TEST_CASE(DataFormat_WriteDataPacketElements)
+  {
+    struct STestDataPacket
+    {
+      TAxisValue axisX;
+      TAxisValue axisY;
+      EPovValue pov;
+      TButtonValue button[4];
+    };
+
+    static_assert(
+        0 == (sizeof(STestDataPacket) % 4), "Test data packet size must be divisible by 4.");
+
+    constexpr Controller::SState kTestControllerStateOld = {
+        .axis = {1111, 2222, 3333, 4444, 5555, 6666},
+        .button = 0b0101,
+        .povDirection = {.components = {true, false, false, false}}};
+    constexpr Controller::SState kTestControllerStateNew = {
+        .axis = {1111, -2222, 3333, 4444, 5555, 6666},
+        .button = 0b0110,
+        .povDirection = {.components = {true, false, false, false}}};
+
+    DIOBJECTDATAFORMAT testObjectFormatSpec[] = {
+        {.pguid = &GUID_XAxis,
+         .dwOfs = offsetof(STestDataPacket, axisX),
+         .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+         .dwFlags = 0},
+        {.pguid = &GUID_YAxis,
+         .dwOfs = offsetof(STestDataPacket, axisY),
+         .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+         .dwFlags = 0},
+        {.pguid = nullptr,
+         .dwOfs = offsetof(STestDataPacket, pov),
+         .dwType = DIDFT_POV | DIDFT_ANYINSTANCE,
+         .dwFlags = 0},
+        {.pguid = nullptr,
+         .dwOfs = offsetof(STestDataPacket, button[0]),
+         .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+         .dwFlags = 0},
+        {.pguid = nullptr,
+         .dwOfs = offsetof(STestDataPacket, button[1]),
+         .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+         .dwFlags = 0},
+        {.pguid = nullptr,
+         .dwOfs = offsetof(STestDataPacket, button[2]),
+         .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+         .dwFlags = 0},
+        {.pguid = nullptr,
+         .dwOfs = offsetof(STestDataPacket, button[3]),
+         .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+         .dwFlags = 0}};
+
+    const DIDATAFORMAT kTestFormatSpec = {
+        .dwSize = sizeof(DIDATAFORMAT),
+        .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+        .dwFlags = DIDF_ABSAXIS,
+        .dwDataSize = sizeof(STestDataPacket),
+        .dwNumObjs = _countof(testObjectFormatSpec),
+        .rgodf = testObjectFormatSpec};
+
+    std::unique_ptr<DataFormat> dataFormat = DataFormat::CreateFromApplicationFormatSpec(
+        kTestFormatSpec, kTestMapperWithPov.GetCapabilities());
+    TEST_ASSERT(nullptr != dataFormat);
+
+    STestDataPacket expectedDataPacket;
+    TEST_ASSERT(
+        true ==
+        dataFormat->WriteDataPacket(
+            &expectedDataPacket, sizeof(expectedDataPacket), kTestControllerStateNew));
+
+    // Patching with exactly the elements that changed is expected to produce the same packet.
+    STestDataPacket actualDataPacket;
+    TEST_ASSERT(
+        true ==
+        dataFormat->WriteDataPacket(
+            &actualDataPacket, sizeof(actualDataPacket), kTestControllerStateOld));
+    TEST_ASSERT(
+        true ==
+        dataFormat->WriteDataPacketElements(
+            &actualDataPacket,
+            sizeof(actualDataPacket),
+            kTestControllerStateNew,
+            Controller::ElementMaskForStateDifference(
+                kTestControllerStateOld, kTestControllerStateNew)));
+    TEST_ASSERT(0 == memcmp(&actualDataPacket, &expectedDataPacket, sizeof(expectedDataPacket)));
+
+    // Patching with no elements at all is expected to leave the packet untouched.
+    STestDataPacket untouchedDataPacket;
+    FillMemory(&untouchedDataPacket, sizeof(untouchedDataPacket), 0xcd);
+    actualDataPacket = untouchedDataPacket;
+    TEST_ASSERT(
+        true ==
+        dataFormat->WriteDataPacketElements(
+            &actualDataPacket, sizeof(actualDataPacket), kTestControllerStateNew, 0));
+    TEST_ASSERT(0 == memcmp(&actualDataPacket, &untouchedDataPacket, sizeof(untouchedDataPacket)));
+
+    // Buffers that are too small are rejected.
+    TEST_ASSERT(
+        false ==
+        dataFormat->WriteDataPacketElements(
+            &actualDataPacket,
+            sizeof(actualDataPacket) - 1,
+            kTestControllerStateNew,
+            Controller::kElementMaskAll));
+  }
+
+  // Verifies that application data packets for the standard DirectInput joystick data formats,
+  // which are written directly as DirectInput structures, are identical to those written by
+  // executing compiled write operations. The latter are obtained by making the data packet slightly
+  // larger than the standard structure, which otherwise has an identical layout.
+  TEST_CASE(DataFormat_WriteDataPacket_StandardFormats)
+  {
+    constexpr std::pair<const GUID*, DWORD> kAxes[] = {
+        {&GUID_XAxis, DIJOFS_X},
+        {&GUID_YAxis, DIJOFS_Y},
+        {&GUID_ZAxis, DIJOFS_Z},
+        {&GUID_RxAxis, DIJOFS_RX},
+        {&GUID_RyAxis, DIJOFS_RY},
+        {&GUID_RzAxis, DIJOFS_RZ},
+        {&GUID_Slider, DIJOFS_SLIDER(0)},
+        {&GUID_Slider, DIJOFS_SLIDER(1)}};
+
+    constexpr Controller::SState kTestControllerState = {
+        .axis = {1111, -2222, 3333, -4444, 5555, -6666},
+        .button = 0b10110011100011110000111110000011,
+        .povDirection = {.components = {true, false, false, true}}};
+
+    auto testStandardFormat = [&](unsigned int numButtons, DWORD standardPacketSizeBytes) -> void
+    {
+      std::vector<DIOBJECTDATAFORMAT> testObjectFormatSpec;
+      for (const auto& axis : kAxes)
+        testObjectFormatSpec.push_back(
+            {.pguid = axis.first,
+             .dwOfs = axis.second,
+             .dwType = (DIDFT_OPTIONAL | DIDFT_AXIS | DIDFT_ANYINSTANCE),
+             .dwFlags = 0});
+      for (int pov = 0; pov < 4; ++pov)
+        testObjectFormatSpec.push_back(
+            {.pguid = &GUID_POV,
+             .dwOfs = (DWORD)DIJOFS_POV(pov),
+             .dwType = (DIDFT_OPTIONAL | DIDFT_POV | DIDFT_ANYINSTANCE),
+             .dwFlags = 0});
+      for (unsigned int button = 0; button < numButtons; ++button)
+        testObjectFormatSpec.push_back(
+            {.pguid = nullptr,
+             .dwOfs = (DWORD)DIJOFS_BUTTON(button),
+             .dwType = (DIDFT_OPTIONAL | DIDFT_BUTTON | DIDFT_ANYINSTANCE),
+             .dwFlags = 0});
+
+      for (const auto* mapper : {&kTestMapperWithPov, &kTestMapperWithoutPov})
+      {
+        DIDATAFORMAT testFormatSpec = {
+            .dwSize = sizeof(DIDATAFORMAT),
+            .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+            .dwFlags = DIDF_ABSAXIS,
+            .dwDataSize = standardPacketSizeBytes,
+            .dwNumObjs = (DWORD)testObjectFormatSpec.size(),
+            .rgodf = testObjectFormatSpec.data()};
+        std::unique_ptr<DataFormat> standardDataFormat =
+            DataFormat::CreateFromApplicationFormatSpec(testFormatSpec, mapper->GetCapabilities());
+        TEST_ASSERT(nullptr != standardDataFormat);
+
+        testFormatSpec.dwDataSize += 4;
+        std::unique_ptr<DataFormat> genericDataFormat =
+            DataFormat::CreateFromApplicationFormatSpec(testFormatSpec, mapper->GetCapabilities());
+        TEST_ASSERT(nullptr != genericDataFormat);
+
+        std::vector<uint8_t> expectedDataPacket(testFormatSpec.dwDataSize, 0xcd);
+        TEST_ASSERT(
+            true ==
+            genericDataFormat->WriteDataPacket(
+                expectedDataPacket.data(),
+                (TOffset)expectedDataPacket.size(),
+                kTestControllerState));
+
+        std::vector<uint8_t> actualDataPacket(testFormatSpec.dwDataSize, 0xcd);
+        TEST_ASSERT(
+            true ==
+            standardDataFormat->WriteDataPacket(
+                actualDataPacket.data(), (TOffset)actualDataPacket.size(), kTestControllerState));
+
+        TEST_ASSERT(actualDataPacket == expectedDataPacket);
+      }
+    };
+
+    testStandardFormat(32, sizeof(DIJOYSTATE));
+    testStandardFormat(128, sizeof(DIJOYSTATE2));
+  }
+
   // Tests a simple data packet with two axis values and allows them to be any type of axis.
   // Axis objects are declared in the object specification in increasing offset order, and axes are
   // expected to be selected in the order they appear in the object format specification array.
@@ -2826,4 +3132,68 @@ namespace XidiTest
       TestDataFormatCreateFailure(kTestFormatSpec, kTestMapperWithPov.GetCapabilities());
     }
   }
+
+  // Verifies that data format objects are reused for application data format specifications that
+  // have the same contents, even if they are located at different addresses, but only if the
+  // virtual controller capabilities are also the same.
+  TEST_CASE(DataFormat_GetOrCreate_Reuse)
+  {
+    struct STestDataPacket
+    {
+      TAxisValue axisValue;
+      TButtonValue buttonValue[4];
+    };
+
+    const GUID kTestAxisGuid[] = {GUID_XAxis, GUID_XAxis};
+    DIOBJECTDATAFORMAT testObjectFormatSpec[2][2];
+    DIDATAFORMAT testFormatSpec[2];
+
+    for (int i = 0; i < _countof(testFormatSpec); ++i)
+    {
+      testObjectFormatSpec[i][0] = {
+          .pguid = &kTestAxisGuid[i],
+          .dwOfs = offsetof(STestDataPacket, axisValue),
+          .dwType = DIDFT_OPTIONAL | DIDFT_AXIS | DIDFT_ANYINSTANCE,
+          .dwFlags = 0};
+      testObjectFormatSpec[i][1] = {
+          .pguid = nullptr,
+          .dwOfs = offsetof(STestDataPacket, buttonValue[0]),
+          .dwType = DIDFT_OPTIONAL | DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+          .dwFlags = 0};
+      testFormatSpec[i] = {
+          .dwSize = sizeof(DIDATAFORMAT),
+          .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+          .dwFlags = DIDF_ABSAXIS,
+          .dwDataSize = sizeof(STestDataPacket),
+          .dwNumObjs = _countof(testObjectFormatSpec[i]),
+          .rgodf = testObjectFormatSpec[i]};
+    }
+
+    const std::shared_ptr<const DataFormat> dataFormat =
+        DataFormat::GetOrCreateFromApplicationFormatSpec(
+            testFormatSpec[0], kTestMapperWithPov.GetCapabilities());
+    TEST_ASSERT(nullptr != dataFormat);
+
+    const std::shared_ptr<const DataFormat> sameDataFormat =
+        DataFormat::GetOrCreateFromApplicationFormatSpec(
+            testFormatSpec[1], kTestMapperWithPov.GetCapabilities());
+    TEST_ASSERT(sameDataFormat == dataFormat);
+
+    const std::shared_ptr<const DataFormat> dataFormatOtherCapabilities =
+        DataFormat::GetOrCreateFromApplicationFormatSpec(
+            testFormatSpec[1], kTestMapperWithoutPov.GetCapabilities());
+    TEST_ASSERT(nullptr != dataFormatOtherCapabilities);
+    TEST_ASSERT(dataFormatOtherCapabilities != dataFormat);
+
+    testObjectFormatSpec[1][1].dwOfs = offsetof(STestDataPacket, buttonValue[1]);
+    const std::shared_ptr<const DataFormat> dataFormatOtherContents =
+        DataFormat::GetOrCreateFromApplicationFormatSpec(
+            testFormatSpec[1], kTestMapperWithPov.GetCapabilities());
+    TEST_ASSERT(nullptr != dataFormatOtherContents);
+    TEST_ASSERT(dataFormatOtherContents != dataFormat);
+    TEST_ASSERT(
+        offsetof(STestDataPacket, buttonValue[1]) ==
+        dataFormatOtherContents->GetOffsetForElement(
+            {.type = EElementType::Button, .button = EButton::B1}));
+  }
 } // namespace XidiTest
@@ -0,0 +1,608 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file DifferentialEquivalenceTest.cpp
+ *   Randomized unit tests that feed the same inputs through reference implementations and through
+ *   their optimized counterparts and verify that the results are identical. Every test case reports
+ *   the seed it used if it fails, and setting the environment variable named by
+ *   #kSeedEnvironmentVariable to that seed reproduces the failure.
+ **************************************************************************************************/
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiDirectInput.h"
+#include "ApiGUID.h"
+#include "ApiWindows.h"
+#include "ControllerMath.h"
+#include "ControllerTypes.h"
+#include "DataFormat.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "VirtualController.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+  using namespace ::Xidi::Controller;
+  using namespace ::Xidi::Controller::Math;
+
+  /// Name of the environment variable that, if it holds a number, supplies the seed for all test
+  /// cases in this file instead of a randomly-chosen one.
+  static constexpr wchar_t kSeedEnvironmentVariable[] = L"XIDI_DIFFERENTIAL_TEST_SEED";
+
+  /// Opaque source identifier used for all mapping operations in this file.
+  static constexpr uint32_t kOpaqueSourceIdentifier = 0;
+
+  /// Maximum nesting depth of randomly-generated element mappers.
+  static constexpr int kMaxElementMapperDepth = 3;
+
+  /// Type of pseudo-random number generator used throughout these test cases.
+  using TRandomEngine = std::mt19937;
+
+  /// Obtains the seed to use for a test case, either from the environment or randomly.
+  /// @return Seed for the pseudo-random number generator.
+  static uint32_t GetTestSeed(void)
+  {
+    wchar_t seedString[16] = {};
+    const DWORD seedStringLength =
+        GetEnvironmentVariable(kSeedEnvironmentVariable, seedString, _countof(seedString));
+    if ((seedStringLength > 0) && (seedStringLength < _countof(seedString)))
+      return (uint32_t)wcstoul(seedString, nullptr, 10);
+
+    return std::random_device()();
+  }
+
+  /// Fails the current test case, reporting the seed needed to reproduce the failure, if the
+  /// results of a reference implementation and an optimized implementation differ.
+  /// @param [in] resultsAreIdentical Whether or not the results are identical.
+  /// @param [in] description Short description of what was compared.
+  /// @param [in] iteration Iteration of the test case at which the results were compared.
+  /// @param [in] seed Seed with which the test case was started.
+  static void CheckIdentical(
+      bool resultsAreIdentical, const wchar_t* description, int iteration, uint32_t seed)
+  {
+    if (false == resultsAreIdentical)
+      TEST_FAILED_BECAUSE(
+          L"%s: Optimized result differs from reference result at iteration %d (seed = %u).",
+          description,
+          iteration,
+          seed);
+  }
+
+  /// Generates a uniformly-distributed random integer within the specified inclusive range.
+  /// @tparam IntegerType Type of integer to generate.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @param [in] minValue Smallest possible value.
+  /// @param [in] maxValue Largest possible value.
+  /// @return Generated integer.
+  template <typename IntegerType> static IntegerType RandomBetween(
+      TRandomEngine& randomEngine, IntegerType minValue, IntegerType maxValue)
+  {
+    return (IntegerType)std::uniform_int_distribution<int64_t>(
+        (int64_t)minValue, (int64_t)maxValue)(randomEngine);
+  }
+
+  /// Generates a random enumerator of the specified enumeration, which must have a `Count`
+  /// enumerator.
+  /// @tparam EnumType Enumeration type.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @return Generated enumerator.
+  template <typename EnumType> static EnumType RandomEnumerator(TRandomEngine& randomEngine)
+  {
+    return (EnumType)RandomBetween<int>(randomEngine, 0, (int)EnumType::Count - 1);
+  }
+
+  /// Generates a random element mapper tree that contains only element mappers that contribute to
+  /// virtual controller state, so that the results of mapping are completely captured by it.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @param [in] depth Nesting depth of the element mapper being generated.
+  /// @return Generated element mapper, which may be `nullptr`.
+  static std::unique_ptr<IElementMapper> RandomElementMapper(TRandomEngine& randomEngine, int depth)
+  {
+    enum class EElementMapperKind
+    {
+      Null,
+      Axis,
+      Button,
+      DigitalAxis,
+      Pov,
+      Invert,
+      Split,
+      Compound,
+      Count
+    };
+
+    // Beyond the maximum depth only element mappers that do not hold other element mappers are
+    // generated, so that trees always terminate.
+    const EElementMapperKind kind = ((depth < kMaxElementMapperDepth)
+                                         ? RandomEnumerator<EElementMapperKind>(randomEngine)
+                                         : (EElementMapperKind)RandomBetween<int>(
+                                               randomEngine, 0, (int)EElementMapperKind::Pov));
+
+    switch (kind)
+    {
+      case EElementMapperKind::Axis:
+        return std::make_unique<AxisMapper>(
+            RandomEnumerator<EAxis>(randomEngine), RandomEnumerator<EAxisDirection>(randomEngine));
+
+      case EElementMapperKind::Button:
+        return std::make_unique<ButtonMapper>(RandomEnumerator<EButton>(randomEngine));
+
+      case EElementMapperKind::DigitalAxis:
+        return std::make_unique<DigitalAxisMapper>(
+            RandomEnumerator<EAxis>(randomEngine), RandomEnumerator<EAxisDirection>(randomEngine));
+
+      case EElementMapperKind::Pov:
+        return std::make_unique<PovMapper>(RandomEnumerator<EPovDirection>(randomEngine));
+
+      case EElementMapperKind::Invert:
+        return std::make_unique<InvertMapper>(RandomElementMapper(randomEngine, depth + 1));
+
+      case EElementMapperKind::Split:
+        return std::make_unique<SplitMapper>(
+            RandomElementMapper(randomEngine, depth + 1),
+            RandomElementMapper(randomEngine, depth + 1));
+
+      case EElementMapperKind::Compound:
+      {
+        CompoundMapper::TElementMappers elementMappers;
+        const int numElementMappers =
+            RandomBetween<int>(randomEngine, 1, CompoundMapper::kMaxUnderlyingElementMappers);
+        for (int i = 0; i < numElementMappers; ++i)
+          elementMappers[i] = RandomElementMapper(randomEngine, depth + 1);
+
+        return std::make_unique<CompoundMapper>(std::move(elementMappers));
+      }
+
+      default:
+        return nullptr;
+    }
+  }
+
+  /// Generates a random physical controller state with all elements chosen independently.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @return Generated physical controller state.
+  static SPhysicalState RandomPhysicalState(TRandomEngine& randomEngine)
+  {
+    SPhysicalState physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+
+    for (int stick = 0; stick < static_cast<int>(EPhysicalStick::Count); ++stick)
+      physicalState[static_cast<EPhysicalStick>(stick)] =
+          RandomBetween<int16_t>(randomEngine, INT16_MIN, INT16_MAX);
+
+    for (int trigger = 0; trigger < static_cast<int>(EPhysicalTrigger::Count); ++trigger)
+      physicalState[static_cast<EPhysicalTrigger>(trigger)] =
+          RandomBetween<uint8_t>(randomEngine, 0, UINT8_MAX);
+
+    for (int button = 0; button < static_cast<int>(EPhysicalButton::Count); ++button)
+      physicalState[static_cast<EPhysicalButton>(button)] =
+          (0 != RandomBetween<int>(randomEngine, 0, 1));
+
+    return physicalState;
+  }
+
+  /// Generates a random physical controller state in which only some of the elements differ from
+  /// the specified previous state, which is typical of consecutive reads from one controller.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @param [in] previousPhysicalState Physical controller state from which to start.
+  /// @return Generated physical controller state.
+  static SPhysicalState RandomNextPhysicalState(
+      TRandomEngine& randomEngine, const SPhysicalState& previousPhysicalState)
+  {
+    const SPhysicalState replacementPhysicalState = RandomPhysicalState(randomEngine);
+    SPhysicalState physicalState = previousPhysicalState;
+
+    for (int stick = 0; stick < static_cast<int>(EPhysicalStick::Count); ++stick)
+    {
+      if (0 == RandomBetween<int>(randomEngine, 0, 3))
+        physicalState[static_cast<EPhysicalStick>(stick)] =
+            replacementPhysicalState[static_cast<EPhysicalStick>(stick)];
+    }
+
+    for (int trigger = 0; trigger < static_cast<int>(EPhysicalTrigger::Count); ++trigger)
+    {
+      if (0 == RandomBetween<int>(randomEngine, 0, 3))
+        physicalState[static_cast<EPhysicalTrigger>(trigger)] =
+            replacementPhysicalState[static_cast<EPhysicalTrigger>(trigger)];
+    }
+
+    for (int button = 0; button < static_cast<int>(EPhysicalButton::Count); ++button)
+    {
+      if (0 == RandomBetween<int>(randomEngine, 0, 3))
+        physicalState[static_cast<EPhysicalButton>(button)] =
+            replacementPhysicalState[static_cast<EPhysicalButton>(button)];
+    }
+
+    return physicalState;
+  }
+
+  /// Generates a random virtual controller state.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @return Generated virtual controller state.
+  static SState RandomVirtualState(TRandomEngine& randomEngine)
+  {
+    SState state = {};
+
+    for (auto& axisValue : state.axis)
+      axisValue = RandomBetween<int32_t>(randomEngine, INT32_MIN, INT32_MAX);
+
+    for (int button = 0; button < static_cast<int>(EButton::Count); ++button)
+      state[static_cast<EButton>(button)] = (0 != RandomBetween<int>(randomEngine, 0, 1));
+
+    for (int povDirection = 0; povDirection < static_cast<int>(EPovDirection::Count);
+         ++povDirection)
+      state[static_cast<EPovDirection>(povDirection)] =
+          (0 != RandomBetween<int>(randomEngine, 0, 1));
+
+    return state;
+  }
+
+  /// Generates random axis properties, covering the full allowed range of each property.
+  /// @param [in,out] randomEngine Pseudo-random number generator to use.
+  /// @return Generated axis properties.
+  static VirtualController::SAxisProperties RandomAxisProperties(TRandomEngine& randomEngine)
+  {
+    VirtualController::SAxisProperties axisProperties;
+
+    const int32_t rangeMin = RandomBetween<int32_t>(randomEngine, INT32_MIN, INT32_MAX - 1);
+    const int32_t rangeMax = RandomBetween<int32_t>(randomEngine, rangeMin + 1, INT32_MAX);
+
+    axisProperties.SetDeadzone(
+        RandomBetween<uint32_t>(randomEngine, 0, VirtualController::kAxisDeadzoneMax));
+    axisProperties.SetSaturation(
+        RandomBetween<uint32_t>(randomEngine, 0, VirtualController::kAxisSaturationMax));
+    axisProperties.SetRange(rangeMin, rangeMax);
+    axisProperties.SetTransformationsEnabled(0 != RandomBetween<int>(randomEngine, 0, 7));
+
+    return axisProperties;
+  }
+
+  /// Converts axis properties to the form used to transform all axis values at once. Mirrors how
+  /// virtual controllers do the same.
+  /// @param [in] axisProperties Properties of each axis, indexed by axis enumerator.
+  /// @return Corresponding axis transformation parameters.
+  static SAxisTransformParameters AxisTransformParametersFromAxisProperties(
+      const std::array<VirtualController::SAxisProperties, static_cast<int>(EAxis::Count)>&
+          axisProperties)
+  {
+    SAxisTransformParameters parameters = {};
+
+    for (unsigned int lane = 0; lane < axisProperties.size(); ++lane)
+    {
+      const VirtualController::SAxisProperties& laneProperties = axisProperties[lane];
+
+      parameters.transformMask[lane] = ((true == laneProperties.transformationsEnabled) ? -1 : 0);
+      parameters.deadzoneCutoffPositive[lane] = laneProperties.deadzoneRawCutoffPositive;
+      parameters.deadzoneCutoffNegative[lane] = laneProperties.deadzoneRawCutoffNegative;
+      parameters.saturationDistancePositive[lane] =
+          laneProperties.saturationRawCutoffPositive - laneProperties.deadzoneRawCutoffPositive;
+      parameters.saturationDistanceNegative[lane] =
+          laneProperties.deadzoneRawCutoffNegative - laneProperties.saturationRawCutoffNegative;
+      parameters.rangeScaleLowPositive[lane] = (uint32_t)laneProperties.rangeScalePositive;
+      parameters.rangeScaleHighPositive[lane] = (uint32_t)(laneProperties.rangeScalePositive >> 32);
+      parameters.rangeScaleLowNegative[lane] = (uint32_t)laneProperties.rangeScaleNegative;
+      parameters.rangeScaleHighNegative[lane] = (uint32_t)(laneProperties.rangeScaleNegative >> 32);
+      parameters.rangeMin[lane] = laneProperties.rangeMin;
+      parameters.rangeMax[lane] = laneProperties.rangeMax;
+      parameters.rangeNeutral[lane] = laneProperties.rangeNeutral;
+    }
+
+    return parameters;
+  }
+
+  // Compiles randomly-generated element mapper trees into element mapper programs and sends both
+  // the same random analog, trigger, and button values. Verifies that the compiled programs make
+  // exactly the same contributions as the element mapper trees from which they were compiled.
+  TEST_CASE(DifferentialEquivalence_ElementMapperProgram)
+  {
+    constexpr int kNumElementMappers = 4096;
+    constexpr int kNumValuesPerElementMapper = 64;
+
+    const uint32_t seed = GetTestSeed();
+    TRandomEngine randomEngine(seed);
+
+    for (int i = 0; i < kNumElementMappers; ++i)
+    {
+      const std::array<std::unique_ptr<const IElementMapper>, 1> elementMappers = {
+          RandomElementMapper(randomEngine, 0)};
+      if (nullptr == elementMappers[0]) continue;
+
+      const IElementMapper& referenceElementMapper = *elementMappers[0];
+      const ElementMapperProgram program(elementMappers);
+
+      for (int j = 0; j < kNumValuesPerElementMapper; ++j)
+      {
+        const int16_t analogValue = RandomBetween<int16_t>(randomEngine, INT16_MIN, INT16_MAX);
+        SState expectedAnalogState = {};
+        SState actualAnalogState = {};
+        referenceElementMapper.ContributeFromAnalogValue(
+            expectedAnalogState, analogValue, kOpaqueSourceIdentifier);
+        program.ContributeFromAnalogValue(
+            0, actualAnalogState, analogValue, kOpaqueSourceIdentifier);
+        CheckIdentical(
+            (actualAnalogState == expectedAnalogState), L"Analog contribution", i, seed);
+
+        const uint8_t triggerValue = RandomBetween<uint8_t>(randomEngine, 0, UINT8_MAX);
+        SState expectedTriggerState = {};
+        SState actualTriggerState = {};
+        referenceElementMapper.ContributeFromTriggerValue(
+            expectedTriggerState, triggerValue, kOpaqueSourceIdentifier);
+        program.ContributeFromTriggerValue(
+            0, actualTriggerState, triggerValue, kOpaqueSourceIdentifier);
+        CheckIdentical(
+            (actualTriggerState == expectedTriggerState), L"Trigger contribution", i, seed);
+
+        const bool buttonValue = (0 != RandomBetween<int>(randomEngine, 0, 1));
+        SState expectedButtonState = {};
+        SState actualButtonState = {};
+        referenceElementMapper.ContributeFromButtonValue(
+            expectedButtonState, buttonValue, kOpaqueSourceIdentifier);
+        program.ContributeFromButtonValue(
+            0, actualButtonState, buttonValue, kOpaqueSourceIdentifier);
+        CheckIdentical(
+            (actualButtonState == expectedButtonState), L"Button contribution", i, seed);
+      }
+    }
+  }
+
+  // Maps random sequences of physical controller states using each built-in mapper, both fully and
+  // incrementally, and using an unnamed copy of each built-in mapper, which maps using its compiled
+  // element mapper program instead of its specialized mapping function. Verifies that all of them
+  // produce exactly the same virtual controller states.
+  TEST_CASE(DifferentialEquivalence_BuiltinMapper)
+  {
+    constexpr std::wstring_view kBuiltinMapperNames[] = {
+        L"StandardGamepad",
+        L"DigitalGamepad",
+        L"ExtendedGamepad",
+        L"XInputNative",
+        L"XInputSharedTriggers"};
+    constexpr int kNumPhysicalStatesPerMapper = 65536;
+
+    const uint32_t seed = GetTestSeed();
+    TRandomEngine randomEngine(seed);
+
+    for (const auto builtinMapperName : kBuiltinMapperNames)
+    {
+      const Mapper* const builtinMapper = Mapper::GetByName(builtinMapperName);
+      TEST_ASSERT(nullptr != builtinMapper);
+
+      const Mapper genericMapper(*builtinMapper);
+      const Mapper::SCompiledPhysicalTransform& transform = Mapper::GetDefaultPhysicalTransform();
+      Mapper::SIncrementalMappingState builtinMappingState;
+      Mapper::SIncrementalMappingState genericMappingState;
+
+      SPhysicalState physicalState = RandomPhysicalState(randomEngine);
+      for (int i = 0; i < kNumPhysicalStatesPerMapper; ++i)
+      {
+        physicalState = RandomNextPhysicalState(randomEngine, physicalState);
+
+        const SState expectedState = genericMapper.MapStatePhysicalToVirtual(
+            physicalState, transform, kOpaqueSourceIdentifier);
+        CheckIdentical(
+            (builtinMapper->MapStatePhysicalToVirtual(
+                 physicalState, transform, kOpaqueSourceIdentifier) == expectedState),
+            builtinMapperName.data(),
+            i,
+            seed);
+        CheckIdentical(
+            (builtinMapper->MapStatePhysicalToVirtualIncremental(
+                 physicalState, transform, kOpaqueSourceIdentifier, builtinMappingState) ==
+             expectedState),
+            builtinMapperName.data(),
+            i,
+            seed);
+        CheckIdentical(
+            (genericMapper.MapStatePhysicalToVirtualIncremental(
+                 physicalState, transform, kOpaqueSourceIdentifier, genericMappingState) ==
+             expectedState),
+            builtinMapperName.data(),
+            i,
+            seed);
+      }
+    }
+  }
+
+  // Transforms random axis values using random axis properties, both all at once and one axis at a
+  // time. Verifies that both produce exactly the same results.
+  TEST_CASE(DifferentialEquivalence_TransformAxisValues)
+  {
+    constexpr int kNumAxisPropertySets = 4096;
+    constexpr int kNumValuesPerAxisPropertySet = 256;
+
+    const uint32_t seed = GetTestSeed();
+    TRandomEngine randomEngine(seed);
+
+    for (int i = 0; i < kNumAxisPropertySets; ++i)
+    {
+      std::array<VirtualController::SAxisProperties, static_cast<int>(EAxis::Count)>
+          axisProperties;
+      for (auto& laneProperties : axisProperties)
+        laneProperties = RandomAxisProperties(randomEngine);
+
+      const SAxisTransformParameters parameters =
+          AxisTransformParametersFromAxisProperties(axisProperties);
+
+      for (int j = 0; j < kNumValuesPerAxisPropertySet; ++j)
+      {
+        // Most values fall within the analog range, which is what mapping produces, but values
+        // outside of it are also occasionally generated.
+        std::array<int32_t, static_cast<int>(EAxis::Count)> axisValues;
+        for (auto& axisValue : axisValues)
+          axisValue = ((0 != RandomBetween<int>(randomEngine, 0, 15))
+                           ? RandomBetween<int32_t>(randomEngine, kAnalogValueMin, kAnalogValueMax)
+                           : RandomBetween<int32_t>(randomEngine, INT32_MIN, INT32_MAX));
+
+        std::array<int32_t, static_cast<int>(EAxis::Count)> actualAxisValues = axisValues;
+        TransformAxisValues(actualAxisValues, parameters);
+
+        for (unsigned int lane = 0; lane < axisValues.size(); ++lane)
+          CheckIdentical(
+              (actualAxisValues[lane] ==
+               TransformAxisValue(axisValues[lane], parameters, static_cast<EAxis>(lane))),
+              L"Axis transformation",
+              i,
+              seed);
+      }
+    }
+  }
+
+  // Applies table-driven circle-to-square correction to random analog stick coordinates using
+  // random amounts of correction. Verifies that results stay within 1 of the floating-point
+  // reference, which is the documented accuracy of the table-driven version.
+  TEST_CASE(DifferentialEquivalence_TransformCoordinatesCircleToSquare)
+  {
+    constexpr int kNumAmounts = 64;
+    constexpr int kNumCoordinatesPerAmount = 16384;
+
+    const uint32_t seed = GetTestSeed();
+    TRandomEngine randomEngine(seed);
+
+    for (int i = 0; i < kNumAmounts; ++i)
+    {
+      const double amountFraction = (double)RandomBetween<int>(randomEngine, 0, 100) / 100.0;
+      const SCircleToSquareTable table = MakeCircleToSquareTable(amountFraction);
+
+      for (int j = 0; j < kNumCoordinatesPerAmount; ++j)
+      {
+        const SAnalogStickCoordinates coordinates = {
+            .x = RandomBetween<int16_t>(randomEngine, INT16_MIN, INT16_MAX),
+            .y = RandomBetween<int16_t>(randomEngine, INT16_MIN, INT16_MAX)};
+
+        const SAnalogStickCoordinates expectedCoordinates =
+            TransformCoordinatesCircleToSquare(coordinates, amountFraction);
+        const SAnalogStickCoordinates actualCoordinates =
+            TransformCoordinatesCircleToSquare(coordinates, table);
+
+        CheckIdentical(
+            ((std::abs((int)actualCoordinates.x - (int)expectedCoordinates.x) <= 1) &&
+             (std::abs((int)actualCoordinates.y - (int)expectedCoordinates.y) <= 1)),
+            L"Circle-to-square correction",
+            i,
+            seed);
+      }
+    }
+  }
+
+  // Writes random virtual controller states as application data packets using a standard
+  // DirectInput joystick data format, which is written directly as a DirectInput structure, and
+  // using an otherwise-identical data format that is slightly larger, which is written by executing
+  // compiled write operations. Also patches a previously-written data packet with only the elements
+  // that changed since then. Verifies that all of them produce exactly the same data packets.
+  TEST_CASE(DifferentialEquivalence_WriteDataPacket)
+  {
+    constexpr std::pair<const GUID*, DWORD> kAxes[] = {
+        {&GUID_XAxis, DIJOFS_X},
+        {&GUID_YAxis, DIJOFS_Y},
+        {&GUID_ZAxis, DIJOFS_Z},
+        {&GUID_RxAxis, DIJOFS_RX},
+        {&GUID_RyAxis, DIJOFS_RY},
+        {&GUID_RzAxis, DIJOFS_RZ},
+        {&GUID_Slider, DIJOFS_SLIDER(0)},
+        {&GUID_Slider, DIJOFS_SLIDER(1)}};
+    constexpr unsigned int kNumButtons = 128;
+    constexpr int kNumStates = 65536;
+
+    const uint32_t seed = GetTestSeed();
+    TRandomEngine randomEngine(seed);
+
+    std::vector<DIOBJECTDATAFORMAT> testObjectFormatSpec;
+    for (const auto& axis : kAxes)
+      testObjectFormatSpec.push_back(
+          {.pguid = axis.first,
+           .dwOfs = axis.second,
+           .dwType = (DIDFT_OPTIONAL | DIDFT_AXIS | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+    for (int pov = 0; pov < 4; ++pov)
+      testObjectFormatSpec.push_back(
+          {.pguid = &GUID_POV,
+           .dwOfs = (DWORD)DIJOFS_POV(pov),
+           .dwType = (DIDFT_OPTIONAL | DIDFT_POV | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+    for (unsigned int button = 0; button < kNumButtons; ++button)
+      testObjectFormatSpec.push_back(
+          {.pguid = nullptr,
+           .dwOfs = (DWORD)DIJOFS_BUTTON(button),
+           .dwType = (DIDFT_OPTIONAL | DIDFT_BUTTON | DIDFT_ANYINSTANCE),
+           .dwFlags = 0});
+
+    const Mapper* const mapper = Mapper::GetByName(L"ExtendedGamepad");
+    TEST_ASSERT(nullptr != mapper);
+
+    DIDATAFORMAT testFormatSpec = {
+        .dwSize = sizeof(DIDATAFORMAT),
+        .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+        .dwFlags = DIDF_ABSAXIS,
+        .dwDataSize = sizeof(DIJOYSTATE2),
+        .dwNumObjs = (DWORD)testObjectFormatSpec.size(),
+        .rgodf = testObjectFormatSpec.data()};
+    std::unique_ptr<DataFormat> standardDataFormat =
+        DataFormat::CreateFromApplicationFormatSpec(testFormatSpec, mapper->GetCapabilities());
+    TEST_ASSERT(nullptr != standardDataFormat);
+
+    testFormatSpec.dwDataSize += 4;
+    std::unique_ptr<DataFormat> genericDataFormat =
+        DataFormat::CreateFromApplicationFormatSpec(testFormatSpec, mapper->GetCapabilities());
+    TEST_ASSERT(nullptr != genericDataFormat);
+
+    const TOffset packetSizeBytes = (TOffset)testFormatSpec.dwDataSize;
+    std::vector<uint8_t> expectedDataPacket(packetSizeBytes, 0xcd);
+    std::vector<uint8_t> actualDataPacket(packetSizeBytes, 0xcd);
+    std::vector<uint8_t> patchedDataPacket(packetSizeBytes, 0xcd);
+
+    SState previousState = RandomVirtualState(randomEngine);
+    TEST_ASSERT(
+        true ==
+        genericDataFormat->WriteDataPacket(
+            patchedDataPacket.data(), packetSizeBytes, previousState));
+
+    for (int i = 0; i < kNumStates; ++i)
+    {
+      // Some states share elements with the previous state so that patching writes only some of
+      // the elements.
+      SState state = RandomVirtualState(randomEngine);
+      if (0 == RandomBetween<int>(randomEngine, 0, 1))
+      {
+        for (size_t axis = 0; axis < state.axis.size(); ++axis)
+        {
+          if (0 == RandomBetween<int>(randomEngine, 0, 1))
+            state.axis[axis] = previousState.axis[axis];
+        }
+      }
+
+      TEST_ASSERT(
+          true ==
+          genericDataFormat->WriteDataPacket(expectedDataPacket.data(), packetSizeBytes, state));
+      TEST_ASSERT(
+          true ==
+          standardDataFormat->WriteDataPacket(actualDataPacket.data(), packetSizeBytes, state));
+      CheckIdentical(
+          (actualDataPacket == expectedDataPacket), L"Standard data packet", i, seed);
+
+      TEST_ASSERT(
+          true ==
+          genericDataFormat->WriteDataPacketElements(
+              patchedDataPacket.data(),
+              packetSizeBytes,
+              state,
+              ElementMaskForStateDifference(previousState, state)));
+      CheckIdentical(
+          (patchedDataPacket == expectedDataPacket), L"Patched data packet", i, seed);
+
+      previousState = state;
+    }
+  }
+} // namespace XidiTest
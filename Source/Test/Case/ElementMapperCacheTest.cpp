@@ -0,0 +1,169 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ElementMapperCacheTest.cpp
+ *   Unit tests for serialization of element mappers into a persistent cache.
+ **************************************************************************************************/
+
+#include "ElementMapperCache.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "MockElementMapper.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller;
+  using ::Xidi::Controller::ElementMapperCache;
+
+  /// Creates and returns an element mapper that exercises all of the element mapper types that
+  /// can be serialized, including nesting them inside one another. Only element mappers that
+  /// target virtual controller elements are used so that results are captured entirely in the
+  /// virtual controller state.
+  /// @return Smart pointer to the newly-created element mapper.
+  static std::unique_ptr<const IElementMapper> CreateNestedElementMapper(void)
+  {
+    CompoundMapper::TElementMappers elementMappers = {
+        std::make_unique<AxisMapper>(EAxis::X),
+        std::make_unique<SplitMapper>(
+            std::make_unique<InvertMapper>(std::make_unique<ButtonMapper>(EButton::B1)),
+            std::make_unique<DigitalAxisMapper>(EAxis::Y, EAxisDirection::Negative)),
+        std::make_unique<InvertMapper>(std::make_unique<SplitMapper>(
+            std::make_unique<AxisMapper>(EAxis::Z, EAxisDirection::Positive),
+            std::make_unique<PovMapper>(EPovDirection::Left))),
+        std::make_unique<SplitMapper>(
+            nullptr, std::make_unique<AxisMapper>(EAxis::RotX, EAxisDirection::Negative)),
+        std::make_unique<PovMapper>(EPovDirection::Up)};
+
+    return std::make_unique<CompoundMapper>(std::move(elementMappers));
+  }
+
+  // Serializes and then deserializes a nested element mapper. Verifies that the reconstructed
+  // element mapper produces exactly the same controller state as the original across all possible
+  // input sources.
+  TEST_CASE(ElementMapperCache_Serialize_RoundTrip)
+  {
+    const std::unique_ptr<const IElementMapper> originalElementMapper =
+        CreateNestedElementMapper();
+
+    const auto maybeSerializedElementMapper =
+        ElementMapperCache::SerializeElementMapper(originalElementMapper.get());
+    TEST_ASSERT(true == maybeSerializedElementMapper.has_value());
+
+    const auto maybeReconstructedElementMapper =
+        ElementMapperCache::DeserializeElementMapper(maybeSerializedElementMapper.value());
+    TEST_ASSERT(true == maybeReconstructedElementMapper.has_value());
+    TEST_ASSERT(nullptr != maybeReconstructedElementMapper.value());
+
+    const IElementMapper& reconstructedElementMapper = *maybeReconstructedElementMapper.value();
+
+    for (int32_t analogValue = kAnalogValueMin; analogValue <= kAnalogValueMax;
+         analogValue += 64)
+    {
+      SState expectedState = {};
+      originalElementMapper->ContributeFromAnalogValue(expectedState, (int16_t)analogValue, 0);
+
+      SState actualState = {};
+      reconstructedElementMapper.ContributeFromAnalogValue(actualState, (int16_t)analogValue, 0);
+
+      TEST_ASSERT(actualState == expectedState);
+    }
+
+    for (bool buttonValue : {false, true})
+    {
+      SState expectedState = {};
+      originalElementMapper->ContributeFromButtonValue(expectedState, buttonValue, 0);
+
+      SState actualState = {};
+      reconstructedElementMapper.ContributeFromButtonValue(actualState, buttonValue, 0);
+
+      TEST_ASSERT(actualState == expectedState);
+    }
+
+    for (int32_t triggerValue = kTriggerValueMin; triggerValue <= kTriggerValueMax; ++triggerValue)
+    {
+      SState expectedState = {};
+      originalElementMapper->ContributeFromTriggerValue(expectedState, (uint8_t)triggerValue, 0);
+
+      SState actualState = {};
+      reconstructedElementMapper.ContributeFromTriggerValue(
+          actualState, (uint8_t)triggerValue, 0);
+
+      TEST_ASSERT(actualState == expectedState);
+    }
+  }
+
+  // Serializes the absence of an element mapper. Verifies that it round-trips back to the absence
+  // of an element mapper rather than being rejected.
+  TEST_CASE(ElementMapperCache_Serialize_Null)
+  {
+    const auto maybeSerializedElementMapper = ElementMapperCache::SerializeElementMapper(nullptr);
+    TEST_ASSERT(true == maybeSerializedElementMapper.has_value());
+    TEST_ASSERT(true == maybeSerializedElementMapper->empty());
+
+    const auto maybeReconstructedElementMapper =
+        ElementMapperCache::DeserializeElementMapper(maybeSerializedElementMapper.value());
+    TEST_ASSERT(true == maybeReconstructedElementMapper.has_value());
+    TEST_ASSERT(nullptr == maybeReconstructedElementMapper.value());
+  }
+
+  // Attempts to serialize an element mapper of a type that is not built-in. Verifies that it is
+  // rejected, both by itself and when nested inside a built-in element mapper.
+  TEST_CASE(ElementMapperCache_Serialize_NotBuiltIn)
+  {
+    const MockElementMapper mockElementMapper;
+    TEST_ASSERT(
+        false == ElementMapperCache::SerializeElementMapper(&mockElementMapper).has_value());
+
+    const InvertMapper invertMapper(std::make_unique<MockElementMapper>());
+    TEST_ASSERT(false == ElementMapperCache::SerializeElementMapper(&invertMapper).has_value());
+  }
+
+  // Attempts to deserialize several invalid serialized element mappers. Verifies that all of them
+  // are rejected.
+  TEST_CASE(ElementMapperCache_Deserialize_Invalid)
+  {
+    const auto maybeSerializedElementMapper = ElementMapperCache::SerializeElementMapper(
+        std::make_unique<SplitMapper>(
+            std::make_unique<ButtonMapper>(EButton::B2),
+            std::make_unique<PovMapper>(EPovDirection::Down))
+            .get());
+    TEST_ASSERT(true == maybeSerializedElementMapper.has_value());
+
+    const ElementMapperCache::TSerializedElementMapper kInvalidSerializedElementMappers[] = {
+        // Truncated in the middle of an instruction.
+        ElementMapperCache::TSerializedElementMapper(
+            maybeSerializedElementMapper->cbegin(), maybeSerializedElementMapper->cend() - 1),
+
+        // Truncated such that a block is missing an instruction.
+        ElementMapperCache::TSerializedElementMapper(
+            maybeSerializedElementMapper->cbegin(), maybeSerializedElementMapper->cend() - 3),
+
+        // Unknown opcode.
+        {0xffffffff, 0, 0},
+
+        // Button that does not exist.
+        {(uint32_t)ElementMapperProgram::EOpcode::Button, (uint32_t)EButton::Count, 0},
+
+        // Forwarding instruction.
+        {(uint32_t)ElementMapperProgram::EOpcode::Forward, 0, 0}};
+
+    for (const auto& invalidSerializedElementMapper : kInvalidSerializedElementMappers)
+    {
+      TEST_ASSERT(
+          false ==
+          ElementMapperCache::DeserializeElementMapper(invalidSerializedElementMapper)
+              .has_value());
+    }
+  }
+} // namespace XidiTest
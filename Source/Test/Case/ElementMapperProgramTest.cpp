@@ -0,0 +1,195 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ElementMapperProgramTest.cpp
+ *   Unit tests for flat programs compiled from controller element mappers.
+ **************************************************************************************************/
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "MockElementMapper.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller;
+  using ::Xidi::Controller::ElementMapperProgram;
+
+  /// Creates and returns an element mapper that exercises all of the block-governing instructions,
+  /// including nesting them inside one another. Only element mappers that target virtual controller
+  /// elements are used so that results are captured entirely in the virtual controller state.
+  /// @return Smart pointer to the newly-created element mapper.
+  static std::unique_ptr<const IElementMapper> CreateNestedElementMapper(void)
+  {
+    CompoundMapper::TElementMappers elementMappers = {
+        std::make_unique<AxisMapper>(EAxis::X),
+        nullptr,
+        std::make_unique<SplitMapper>(
+            std::make_unique<InvertMapper>(std::make_unique<ButtonMapper>(EButton::B1)),
+            std::make_unique<DigitalAxisMapper>(EAxis::Y, EAxisDirection::Negative)),
+        std::make_unique<InvertMapper>(std::make_unique<SplitMapper>(
+            std::make_unique<AxisMapper>(EAxis::Z, EAxisDirection::Positive),
+            std::make_unique<PovMapper>(EPovDirection::Left))),
+        std::make_unique<SplitMapper>(
+            nullptr, std::make_unique<AxisMapper>(EAxis::RotX, EAxisDirection::Negative)),
+        std::make_unique<InvertMapper>(nullptr),
+        std::make_unique<PovMapper>(EPovDirection::Up)};
+
+    return std::make_unique<CompoundMapper>(std::move(elementMappers));
+  }
+
+  // Compiles a single element mapper that contains only built-in element mappers. Verifies that
+  // the resulting instructions follow the structure of the element mapper and that none of them
+  // fall back to forwarding.
+  TEST_CASE(ElementMapperProgram_Compile_Nominal)
+  {
+    constexpr ElementMapperProgram::EOpcode kExpectedOpcodes[] = {
+        ElementMapperProgram::EOpcode::Axis,
+        ElementMapperProgram::EOpcode::Split,
+        ElementMapperProgram::EOpcode::Invert,
+        ElementMapperProgram::EOpcode::Button,
+        ElementMapperProgram::EOpcode::DigitalAxis,
+        ElementMapperProgram::EOpcode::Invert,
+        ElementMapperProgram::EOpcode::Split,
+        ElementMapperProgram::EOpcode::Axis,
+        ElementMapperProgram::EOpcode::Pov,
+        ElementMapperProgram::EOpcode::Split,
+        ElementMapperProgram::EOpcode::Axis,
+        ElementMapperProgram::EOpcode::Invert,
+        ElementMapperProgram::EOpcode::Pov};
+
+    const std::array<std::unique_ptr<const IElementMapper>, 1> elementMappers = {
+        CreateNestedElementMapper()};
+    const ElementMapperProgram program(elementMappers);
+
+    const auto instructions = program.GetInstructions(0);
+    TEST_ASSERT(_countof(kExpectedOpcodes) == instructions.size());
+
+    for (int i = 0; i < _countof(kExpectedOpcodes); ++i)
+      TEST_ASSERT(kExpectedOpcodes[i] == instructions[i].opcode);
+
+    TEST_ASSERT(2 == instructions[1].operand.split.positiveBlockLength);
+    TEST_ASSERT(1 == instructions[1].operand.split.negativeBlockLength);
+    TEST_ASSERT(1 == instructions[2].operand.invertBlockLength);
+    TEST_ASSERT(3 == instructions[5].operand.invertBlockLength);
+    TEST_ASSERT(0 == instructions[9].operand.split.positiveBlockLength);
+    TEST_ASSERT(1 == instructions[9].operand.split.negativeBlockLength);
+    TEST_ASSERT(0 == instructions[11].operand.invertBlockLength);
+  }
+
+  // Compiles several element mappers, some of which are null. Verifies that each XInput controller
+  // element receives its own run of instructions and that null element mappers receive none.
+  TEST_CASE(ElementMapperProgram_Compile_MultipleElements)
+  {
+    const std::array<std::unique_ptr<const IElementMapper>, 4> elementMappers = {
+        nullptr,
+        std::make_unique<ButtonMapper>(EButton::B3),
+        nullptr,
+        std::make_unique<KeyboardMapper>(30)};
+    const ElementMapperProgram program(elementMappers);
+
+    TEST_ASSERT(true == program.GetInstructions(0).empty());
+    TEST_ASSERT(true == program.GetInstructions(2).empty());
+
+    TEST_ASSERT(1 == program.GetInstructions(1).size());
+    TEST_ASSERT(ElementMapperProgram::EOpcode::Button == program.GetInstructions(1)[0].opcode);
+    TEST_ASSERT(EButton::B3 == program.GetInstructions(1)[0].operand.button);
+
+    TEST_ASSERT(1 == program.GetInstructions(3).size());
+    TEST_ASSERT(ElementMapperProgram::EOpcode::Keyboard == program.GetInstructions(3)[0].opcode);
+    TEST_ASSERT(30 == program.GetInstructions(3)[0].operand.key);
+  }
+
+  // Compiles an element mapper of a type that is not built-in. Verifies that it is compiled to a
+  // forwarding instruction and that contributions reach it.
+  TEST_CASE(ElementMapperProgram_Compile_Forward)
+  {
+    constexpr int16_t kTestValue = 1234;
+    int numContributions = 0;
+
+    const std::array<std::unique_ptr<const IElementMapper>, 1> elementMappers = {
+        std::make_unique<MockElementMapper>(
+            MockElementMapper::EExpectedSource::Analog, kTestValue, &numContributions)};
+    const ElementMapperProgram program(elementMappers);
+
+    TEST_ASSERT(1 == program.GetInstructions(0).size());
+    TEST_ASSERT(ElementMapperProgram::EOpcode::Forward == program.GetInstructions(0)[0].opcode);
+    TEST_ASSERT(elementMappers[0].get() == program.GetInstructions(0)[0].operand.forward);
+
+    SState actualState = {};
+    program.ContributeFromAnalogValue(0, actualState, kTestValue, 0);
+    TEST_ASSERT(1 == numContributions);
+  }
+
+  // Compiles a nested element mapper and sends it analog values across the entire analog range.
+  // Verifies that the program produces exactly the same controller state as the element mapper.
+  TEST_CASE(ElementMapperProgram_Contribute_AnalogMatchesElementMapper)
+  {
+    const std::array<std::unique_ptr<const IElementMapper>, 1> elementMappers = {
+        CreateNestedElementMapper()};
+    const ElementMapperProgram program(elementMappers);
+
+    for (int32_t analogValue = kAnalogValueMin; analogValue <= kAnalogValueMax;
+         analogValue += 64)
+    {
+      SState expectedState = {};
+      elementMappers[0]->ContributeFromAnalogValue(expectedState, (int16_t)analogValue, 0);
+
+      SState actualState = {};
+      program.ContributeFromAnalogValue(0, actualState, (int16_t)analogValue, 0);
+
+      TEST_ASSERT(actualState == expectedState);
+    }
+  }
+
+  // Compiles a nested element mapper and sends it both possible button values. Verifies that the
+  // program produces exactly the same controller state as the element mapper.
+  TEST_CASE(ElementMapperProgram_Contribute_ButtonMatchesElementMapper)
+  {
+    const std::array<std::unique_ptr<const IElementMapper>, 1> elementMappers = {
+        CreateNestedElementMapper()};
+    const ElementMapperProgram program(elementMappers);
+
+    for (bool buttonValue : {false, true})
+    {
+      SState expectedState = {};
+      elementMappers[0]->ContributeFromButtonValue(expectedState, buttonValue, 0);
+
+      SState actualState = {};
+      program.ContributeFromButtonValue(0, actualState, buttonValue, 0);
+
+      TEST_ASSERT(actualState == expectedState);
+    }
+  }
+
+  // Compiles a nested element mapper and sends it every possible trigger value. Verifies that the
+  // program produces exactly the same controller state as the element mapper.
+  TEST_CASE(ElementMapperProgram_Contribute_TriggerMatchesElementMapper)
+  {
+    const std::array<std::unique_ptr<const IElementMapper>, 1> elementMappers = {
+        CreateNestedElementMapper()};
+    const ElementMapperProgram program(elementMappers);
+
+    for (int32_t triggerValue = kTriggerValueMin; triggerValue <= kTriggerValueMax; ++triggerValue)
+    {
+      SState expectedState = {};
+      elementMappers[0]->ContributeFromTriggerValue(expectedState, (uint8_t)triggerValue, 0);
+
+      SState actualState = {};
+      program.ContributeFromTriggerValue(0, actualState, (uint8_t)triggerValue, 0);
+
+      TEST_ASSERT(actualState == expectedState);
+    }
+  }
+} // namespace XidiTest
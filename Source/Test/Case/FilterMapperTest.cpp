@@ -0,0 +1,395 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file FilterMapperTest.cpp
+ *   Unit tests for controller element mappers that filter input received and forward the result
+ *   to another element mapper.
+ **************************************************************************************************/
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiWindows.h"
+#include "ControllerMath.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MockElementMapper.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller;
+
+  /// Controller state used for tests that need such an instance but do not care about its contents.
+  static SState unusedControllerState;
+
+  /// Element mapper that records the most recent value contributed to it, so that the output of a
+  /// filter can be examined across a sequence of samples.
+  class RecordingElementMapper : public IElementMapper
+  {
+  public:
+
+    /// Holds the most recently contributed values.
+    struct SRecord
+    {
+      int16_t analog = 0;
+      bool button = false;
+      uint8_t trigger = 0;
+      int neutralCount = 0;
+    };
+
+    inline RecordingElementMapper(SRecord* record) : record(record) {}
+
+    // IElementMapper
+    std::unique_ptr<IElementMapper> Clone(void) const override
+    {
+      return std::make_unique<RecordingElementMapper>(*this);
+    }
+
+    void ContributeFromAnalogValue(
+        SState& controllerState, int16_t analogValue, uint32_t sourceIdentifier) const override
+    {
+      record->analog = analogValue;
+    }
+
+    void ContributeFromButtonValue(
+        SState& controllerState, bool buttonPressed, uint32_t sourceIdentifier) const override
+    {
+      record->button = buttonPressed;
+    }
+
+    void ContributeFromTriggerValue(
+        SState& controllerState, uint8_t triggerValue, uint32_t sourceIdentifier) const override
+    {
+      record->trigger = triggerValue;
+    }
+
+    void ContributeNeutral(SState& controllerState, uint32_t sourceIdentifier) const override
+    {
+      record->neutralCount += 1;
+    }
+
+    int GetTargetElementCount(void) const override
+    {
+      return 0;
+    }
+
+    std::optional<SElementIdentifier> GetTargetElementAt(int index) const override
+    {
+      return std::nullopt;
+    }
+
+  private:
+
+    /// Destination for contributed values.
+    SRecord* record;
+  };
+
+  // Creates one FilterMapper with an underlying compound element mapper present.
+  // Verifies correct reporting of the target elements.
+  TEST_CASE(FilterMapper_GetTargetElement_Nominal)
+  {
+    constexpr SElementIdentifier kUnderlyingElements[] = {
+        {.type = EElementType::Button, .button = EButton::B2},
+        {.type = EElementType::Button, .button = EButton::B10}};
+
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::ExponentialMovingAverage,
+        50,
+        std::make_unique<SplitMapper>(
+            std::make_unique<MockElementMapper>(kUnderlyingElements[0]),
+            std::make_unique<MockElementMapper>(kUnderlyingElements[1])));
+    TEST_ASSERT(_countof(kUnderlyingElements) == mapper.GetTargetElementCount());
+
+    for (int i = 0; i < _countof(kUnderlyingElements); ++i)
+    {
+      const std::optional<SElementIdentifier> maybeTargetElement = mapper.GetTargetElementAt(i);
+      TEST_ASSERT(true == maybeTargetElement.has_value());
+
+      const SElementIdentifier targetElement = maybeTargetElement.value();
+      TEST_ASSERT(kUnderlyingElements[i] == targetElement);
+    }
+  }
+
+  // Creates and then clones one FilterMapper with an underlying compound element mapper present.
+  // Verifies correct reporting of the target elements.
+  TEST_CASE(FilterMapper_GetTargetElement_Clone)
+  {
+    constexpr SElementIdentifier kUnderlyingElements[] = {
+        {.type = EElementType::Button, .button = EButton::B2},
+        {.type = EElementType::Button, .button = EButton::B10}};
+
+    const FilterMapper mapperOriginal(
+        FilterMapper::EFilterType::Hysteresis,
+        5,
+        std::make_unique<SplitMapper>(
+            std::make_unique<MockElementMapper>(kUnderlyingElements[0]),
+            std::make_unique<MockElementMapper>(kUnderlyingElements[1])));
+    const std::unique_ptr<IElementMapper> mapperClone = mapperOriginal.Clone();
+    TEST_ASSERT(_countof(kUnderlyingElements) == mapperClone->GetTargetElementCount());
+
+    for (int i = 0; i < _countof(kUnderlyingElements); ++i)
+    {
+      const std::optional<SElementIdentifier> maybeTargetElement =
+          mapperClone->GetTargetElementAt(i);
+      TEST_ASSERT(true == maybeTargetElement.has_value());
+
+      const SElementIdentifier targetElement = maybeTargetElement.value();
+      TEST_ASSERT(kUnderlyingElements[i] == targetElement);
+    }
+  }
+
+  // Creates one FilterMapper with no underlying mapper present.
+  // Verifies correct reporting of the target element from it.
+  TEST_CASE(FilterMapper_GetTargetElement_UnderlyingNull)
+  {
+    const FilterMapper mapper(FilterMapper::EFilterType::OneEuro, 50, nullptr);
+    TEST_ASSERT(0 == mapper.GetTargetElementCount());
+  }
+
+  // Verifies that filter strength is clamped to the maximum allowed for each filter type.
+  TEST_CASE(FilterMapper_Strength_Clamped)
+  {
+    const FilterMapper hysteresisMapper(FilterMapper::EFilterType::Hysteresis, 1000, nullptr);
+    TEST_ASSERT(FilterMapper::kMaxHysteresisStrength == hysteresisMapper.GetStrength());
+
+    const FilterMapper smoothingMapper(
+        FilterMapper::EFilterType::ExponentialMovingAverage, 1000, nullptr);
+    TEST_ASSERT(FilterMapper::kMaxSmoothingStrength == smoothingMapper.GetStrength());
+
+    const FilterMapper pressReleaseMapper(FilterMapper::EFilterType::PressRelease, 1000, nullptr);
+    TEST_ASSERT(FilterMapper::kMaxPressReleaseStrength == pressReleaseMapper.GetStrength());
+  }
+
+  // Verifies that hysteresis filters hold the previously-forwarded analog value until the reading
+  // moves away from it by more than the threshold.
+  TEST_CASE(FilterMapper_Hysteresis_Analog)
+  {
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::Hysteresis,
+        10,
+        std::make_unique<RecordingElementMapper>(&record));
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 1000);
+    TEST_ASSERT(1000 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 5000);
+    TEST_ASSERT(1000 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, -2000);
+    TEST_ASSERT(1000 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 8000);
+    TEST_ASSERT(8000 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 7000);
+    TEST_ASSERT(8000 == record.analog);
+  }
+
+  // Verifies that hysteresis filters hold the previously-forwarded trigger value until the reading
+  // moves away from it by more than the threshold.
+  TEST_CASE(FilterMapper_Hysteresis_Trigger)
+  {
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::Hysteresis,
+        10,
+        std::make_unique<RecordingElementMapper>(&record));
+
+    mapper.ContributeFromTriggerValue(unusedControllerState, 100);
+    TEST_ASSERT(100 == record.trigger);
+
+    mapper.ContributeFromTriggerValue(unusedControllerState, 110);
+    TEST_ASSERT(100 == record.trigger);
+
+    mapper.ContributeFromTriggerValue(unusedControllerState, 200);
+    TEST_ASSERT(200 == record.trigger);
+  }
+
+  // Verifies that press and release filters keep a button pressed while an analog reading hovers
+  // just below the pressed threshold, in both directions, and release it once the reading recedes
+  // past the margin.
+  TEST_CASE(FilterMapper_PressRelease_Analog)
+  {
+    constexpr int16_t kPositiveThreshold = Math::kAnalogPressedThresholdPositive;
+    constexpr int16_t kNegativeThreshold = Math::kAnalogPressedThresholdNegative;
+
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::PressRelease, 5, std::make_unique<ButtonMapper>(EButton::B1));
+
+    const int16_t kReadings[] = {
+        kPositiveThreshold - 1,
+        kPositiveThreshold,
+        kPositiveThreshold - 1,
+        kPositiveThreshold - 2000,
+        kPositiveThreshold + 100,
+        kPositiveThreshold - 5000,
+        kNegativeThreshold,
+        kNegativeThreshold + 2000,
+        kNegativeThreshold + 5000};
+    constexpr bool kExpectedPressed[] = {false, true, true, true, true, false, true, true, false};
+    static_assert(
+        _countof(kReadings) == _countof(kExpectedPressed),
+        "Mismatch between input and expected output array lengths.");
+
+    for (int i = 0; i < _countof(kReadings); ++i)
+    {
+      SState actualState = {};
+      mapper.ContributeFromAnalogValue(actualState, kReadings[i]);
+      if (kExpectedPressed[i] != actualState[EButton::B1])
+        TEST_FAILED_BECAUSE(L"Reading %d: Incorrect button state.", i);
+    }
+  }
+
+  // Verifies that press and release filters keep a button pressed while a trigger reading hovers
+  // just below the pressed threshold, and that a neutral contribution forgets the pressed state.
+  TEST_CASE(FilterMapper_PressRelease_Trigger)
+  {
+    constexpr uint8_t kThreshold = Math::kTriggerPressedThreshold;
+
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::PressRelease, 10, std::make_unique<ButtonMapper>(EButton::B1));
+
+    SState actualState = {};
+    mapper.ContributeFromTriggerValue(actualState, kThreshold);
+    TEST_ASSERT(true == actualState[EButton::B1]);
+
+    actualState = {};
+    mapper.ContributeFromTriggerValue(actualState, kThreshold - 10);
+    TEST_ASSERT(true == actualState[EButton::B1]);
+
+    actualState = {};
+    mapper.ContributeNeutral(actualState);
+    mapper.ContributeFromTriggerValue(actualState, kThreshold - 10);
+    TEST_ASSERT(false == actualState[EButton::B1]);
+
+    actualState = {};
+    mapper.ContributeFromTriggerValue(actualState, kThreshold);
+    mapper.ContributeFromTriggerValue(actualState, kThreshold - 40);
+    actualState = {};
+    mapper.ContributeFromTriggerValue(actualState, kThreshold - 10);
+    TEST_ASSERT(false == actualState[EButton::B1]);
+  }
+
+  // Verifies that exponential moving average filters converge monotonically towards a steady
+  // reading and eventually reach it exactly.
+  TEST_CASE(FilterMapper_ExponentialMovingAverage_Converge)
+  {
+    constexpr int16_t kTargetValue = 10000;
+
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::ExponentialMovingAverage,
+        50,
+        std::make_unique<RecordingElementMapper>(&record));
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 0);
+    TEST_ASSERT(0 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, kTargetValue);
+    TEST_ASSERT(5000 == record.analog);
+
+    int16_t previousValue = record.analog;
+    for (int i = 0; i < 32; ++i)
+    {
+      mapper.ContributeFromAnalogValue(unusedControllerState, kTargetValue);
+      TEST_ASSERT(record.analog >= previousValue);
+      TEST_ASSERT(record.analog <= kTargetValue);
+      previousValue = record.analog;
+    }
+
+    TEST_ASSERT(kTargetValue == record.analog);
+  }
+
+  // Verifies that one euro filters smooth slow movement but follow fast movement without lag.
+  TEST_CASE(FilterMapper_OneEuro_Speed)
+  {
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::OneEuro, 90, std::make_unique<RecordingElementMapper>(&record));
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 0);
+    TEST_ASSERT(0 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 100);
+    TEST_ASSERT(record.analog > 0);
+    TEST_ASSERT(record.analog < 100);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 30000);
+    TEST_ASSERT(30000 == record.analog);
+  }
+
+  // Verifies that button values are forwarded unmodified.
+  TEST_CASE(FilterMapper_Button_PassThrough)
+  {
+    constexpr bool kButtonValues[] = {false, true, false, true, true};
+
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::Hysteresis,
+        FilterMapper::kMaxHysteresisStrength,
+        std::make_unique<RecordingElementMapper>(&record));
+
+    for (bool buttonValue : kButtonValues)
+    {
+      mapper.ContributeFromButtonValue(unusedControllerState, buttonValue);
+      TEST_ASSERT(buttonValue == record.button);
+    }
+  }
+
+  // Verifies that a neutral contribution is forwarded and resets the filter state, such that the
+  // next reading is forwarded unfiltered.
+  TEST_CASE(FilterMapper_Neutral_Reset)
+  {
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::ExponentialMovingAverage,
+        FilterMapper::kMaxSmoothingStrength,
+        std::make_unique<RecordingElementMapper>(&record));
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 0);
+    mapper.ContributeFromAnalogValue(unusedControllerState, 20000);
+    TEST_ASSERT(record.analog < 20000);
+
+    mapper.ContributeNeutral(unusedControllerState, 0);
+    TEST_ASSERT(1 == record.neutralCount);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 20000);
+    TEST_ASSERT(20000 == record.analog);
+  }
+
+  // Verifies that filter state is held separately for each physical controller.
+  TEST_CASE(FilterMapper_State_PerController)
+  {
+    constexpr uint32_t kSourceIdentifierFirst =
+        Xidi::Controller::Mapper::SourceIdentifierForElementMapper(0, 0);
+    constexpr uint32_t kSourceIdentifierSecond =
+        Xidi::Controller::Mapper::SourceIdentifierForElementMapper(1, 0);
+
+    RecordingElementMapper::SRecord record;
+    const FilterMapper mapper(
+        FilterMapper::EFilterType::Hysteresis,
+        10,
+        std::make_unique<RecordingElementMapper>(&record));
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 0, kSourceIdentifierFirst);
+    TEST_ASSERT(0 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 2000, kSourceIdentifierSecond);
+    TEST_ASSERT(2000 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 2000, kSourceIdentifierFirst);
+    TEST_ASSERT(0 == record.analog);
+
+    mapper.ContributeFromAnalogValue(unusedControllerState, 0, kSourceIdentifierSecond);
+    TEST_ASSERT(2000 == record.analog);
+  }
+} // namespace XidiTest
@@ -0,0 +1,156 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file FlightRecorderTest.cpp
+ *   Unit tests for the flight recorder that retains recent events in memory.
+ **************************************************************************************************/
+
+#include "FlightRecorder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+  using namespace ::Xidi::Controller;
+
+  /// Contents of a flight recorder dump file, as read back from the file.
+  struct SDumpFileContents
+  {
+    FlightRecorder::SFileHeader header;
+    std::vector<FlightRecorder::SRecord> records;
+    std::vector<std::wstring> names;
+  };
+
+  /// Generates the name of a file in the temporary directory to which a dump can be written.
+  /// @return Name of the file.
+  static std::wstring TemporaryDumpFilename(void)
+  {
+    wchar_t temporaryDirectory[MAX_PATH + 1] = {};
+    GetTempPath(_countof(temporaryDirectory), temporaryDirectory);
+    return std::wstring(temporaryDirectory) + L"XidiTestFlightRecorder.bin";
+  }
+
+  /// Reads the complete contents of a dump file.
+  /// @param [in] filename Name of the dump file to read.
+  /// @param [out] contents Filled in with the contents of the file.
+  /// @return `true` if the file was read and is complete, `false` otherwise.
+  static bool ReadDumpFile(const std::wstring& filename, SDumpFileContents& contents)
+  {
+    FILE* inputFile = nullptr;
+    if (0 != _wfopen_s(&inputFile, filename.c_str(), L"rb")) return false;
+
+    bool isComplete = (1 == fread(&contents.header, sizeof(contents.header), 1, inputFile));
+
+    if (true == isComplete)
+    {
+      contents.records.resize(contents.header.recordCount);
+      isComplete =
+          (contents.records.size() ==
+           fread(
+               contents.records.data(),
+               sizeof(FlightRecorder::SRecord),
+               contents.records.size(),
+               inputFile));
+    }
+
+    for (uint32_t i = 0; (true == isComplete) && (i < contents.header.nameCount); ++i)
+    {
+      uint16_t nameLength = 0;
+      isComplete = (1 == fread(&nameLength, sizeof(nameLength), 1, inputFile));
+      if (false == isComplete) break;
+
+      std::wstring name(nameLength, L'\0');
+      isComplete = (nameLength == fread(name.data(), sizeof(wchar_t), nameLength, inputFile));
+      contents.names.push_back(std::move(name));
+    }
+
+    fclose(inputFile);
+    return isComplete;
+  }
+
+  // Verifies that recorded events of every type are written to a dump file, in the order they
+  // were recorded and with all of their contents intact, along with a name table that resolves
+  // API function names.
+  TEST_CASE(FlightRecorder_DumpToFile_Nominal)
+  {
+    static const wchar_t kTestFunctionName[] = L"FlightRecorderTestFunction";
+    const SPhysicalState kTestPhysicalState = {
+        .deviceStatus = EPhysicalDeviceStatus::Ok,
+        .stick = {1111, -2222, 3333, -4444},
+        .trigger = {55, 66},
+        .button = 0b1010};
+
+    FlightRecorder::RecordPhysicalState(2, kTestPhysicalState);
+    FlightRecorder::RecordApiCall(kTestFunctionName, 1, 77, 0x80004005);
+    FlightRecorder::RecordForceFeedbackWrite(3, 1000, 2000, ERROR_SUCCESS);
+
+    const std::wstring filename = TemporaryDumpFilename();
+    TEST_ASSERT(true == FlightRecorder::DumpToFile(filename));
+
+    SDumpFileContents contents = {};
+    const bool dumpFileRead = ReadDumpFile(filename, contents);
+    DeleteFile(filename.c_str());
+    TEST_ASSERT(true == dumpFileRead);
+
+    TEST_ASSERT(FlightRecorder::kFileMagic == contents.header.magic);
+    TEST_ASSERT(FlightRecorder::kFileVersion == contents.header.version);
+    TEST_ASSERT(sizeof(FlightRecorder::SRecord) == contents.header.recordSize);
+    TEST_ASSERT(contents.records.size() >= 3);
+    TEST_ASSERT(contents.records.size() <= FlightRecorder::kRecordCapacity);
+
+    // No other events are recorded while this test runs, so the events it recorded are the last
+    // ones in the file.
+    const FlightRecorder::SRecord& physicalStateRecord =
+        contents.records[contents.records.size() - 3];
+    const FlightRecorder::SRecord& apiCallRecord = contents.records[contents.records.size() - 2];
+    const FlightRecorder::SRecord& forceFeedbackWriteRecord =
+        contents.records[contents.records.size() - 1];
+
+    TEST_ASSERT((uint8_t)FlightRecorder::ERecordType::PhysicalState == physicalStateRecord.type);
+    TEST_ASSERT(2 == physicalStateRecord.controllerIdentifier);
+    TEST_ASSERT(
+        (uint8_t)EPhysicalDeviceStatus::Ok == physicalStateRecord.physicalState.deviceStatus);
+    TEST_ASSERT(-2222 == physicalStateRecord.physicalState.stick[1]);
+    TEST_ASSERT(66 == physicalStateRecord.physicalState.trigger[1]);
+    TEST_ASSERT(0b1010 == physicalStateRecord.physicalState.buttons);
+
+    TEST_ASSERT((uint8_t)FlightRecorder::ERecordType::ApiCall == apiCallRecord.type);
+    TEST_ASSERT(1 == apiCallRecord.controllerIdentifier);
+    TEST_ASSERT(77 == apiCallRecord.apiCall.objectId);
+    TEST_ASSERT(0x80004005 == apiCallRecord.apiCall.result);
+    TEST_ASSERT(apiCallRecord.apiCall.nameIndex < contents.names.size());
+    TEST_ASSERT(kTestFunctionName == contents.names[apiCallRecord.apiCall.nameIndex]);
+
+    TEST_ASSERT(
+        (uint8_t)FlightRecorder::ERecordType::ForceFeedbackWrite == forceFeedbackWriteRecord.type);
+    TEST_ASSERT(3 == forceFeedbackWriteRecord.controllerIdentifier);
+    TEST_ASSERT(1000 == forceFeedbackWriteRecord.forceFeedbackWrite.motorSpeed[0]);
+    TEST_ASSERT(2000 == forceFeedbackWriteRecord.forceFeedbackWrite.motorSpeed[1]);
+    TEST_ASSERT(ERROR_SUCCESS == forceFeedbackWriteRecord.forceFeedbackWrite.result);
+
+    TEST_ASSERT(physicalStateRecord.timestamp <= apiCallRecord.timestamp);
+    TEST_ASSERT(apiCallRecord.timestamp <= forceFeedbackWriteRecord.timestamp);
+    TEST_ASSERT((physicalStateRecord.sequence + 1) == apiCallRecord.sequence);
+    TEST_ASSERT((apiCallRecord.sequence + 1) == forceFeedbackWriteRecord.sequence);
+  }
+
+  // Verifies that a dump file cannot be written to an empty filename.
+  TEST_CASE(FlightRecorder_DumpToFile_EmptyFilename)
+  {
+    TEST_ASSERT(false == FlightRecorder::DumpToFile(L""));
+  }
+} // namespace XidiTest
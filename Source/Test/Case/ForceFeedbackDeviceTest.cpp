@@ -14,9 +14,11 @@
 #include <cstdint>
 #include <limits>
 #include <optional>
+#include <vector>
 
 #include <Infra/Test/TestCase.h>
 
+#include "ForceFeedbackEffect.h"
 #include "ForceFeedbackTypes.h"
 #include "MockForceFeedbackEffect.h"
 
@@ -247,6 +249,90 @@ namespace XidiTest
     TEST_ASSERT(false == Device.IsEffectPlaying(effect.Identifier()));
   }
 
+  // A single effect is downloaded, played to completion, and removed.
+  // Verifies that the device is considered idle exactly when there is nothing for it to play and
+  // no changes are waiting to be applied.
+  TEST_CASE(ForceFeedbackDevice_SingleEffect_Idle)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+
+    Device Device = MakeTestDevice();
+
+    MockEffect effect = MakeTestEffect(kTestEffectDuration);
+    TEST_ASSERT(true == Device.IsDeviceIdle());
+
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+    TEST_ASSERT(false == Device.IsDeviceIdle());
+    Device.PlayEffects(0);
+    TEST_ASSERT(true == Device.IsDeviceIdle());
+
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, kDefaultTimestampBase));
+    TEST_ASSERT(false == Device.IsDeviceIdle());
+
+    for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+    {
+      Device.PlayEffects(t);
+      TEST_ASSERT(false == Device.IsDeviceIdle());
+    }
+
+    Device.PlayEffects(kTestEffectDuration);
+    TEST_ASSERT(true == Device.IsDeviceIdle());
+
+    TEST_ASSERT(true == Device.RemoveEffect(effect.Identifier()));
+    TEST_ASSERT(false == Device.IsDeviceIdle());
+    Device.PlayEffects(kTestEffectDuration + 1);
+    TEST_ASSERT(true == Device.IsDeviceIdle());
+  }
+
+  // A single effect with a start delay and a sample period is played for two iterations.
+  // Verifies that the device reports the correct time until each transition and that output
+  // remains correct throughout, including between sample period boundaries.
+  TEST_CASE(ForceFeedbackDevice_SingleEffect_Transitions)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+    constexpr TEffectTimeMs kTestEffectStartDelay = 50;
+    constexpr TEffectTimeMs kTestEffectSamplePeriod = 10;
+
+    Device Device = MakeTestDevice();
+
+    MockEffect effect = MakeTestEffect(kTestEffectDuration);
+    TEST_ASSERT(true == effect.SetStartDelay(kTestEffectStartDelay));
+    TEST_ASSERT(true == effect.SetSamplePeriod(kTestEffectSamplePeriod));
+
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+    TEST_ASSERT(false == Device.GetTimeUntilNextTransition().has_value());
+
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 2, kDefaultTimestampBase));
+
+    for (TEffectTimeMs t = 0; t < kTestEffectStartDelay; ++t)
+    {
+      const TOrderedMagnitudeComponents expectedMagnitudeComponents = {};
+      const TOrderedMagnitudeComponents actualMagnitudeComponents = Device.PlayEffects(t);
+      TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+      TEST_ASSERT(kTestEffectStartDelay - t == Device.GetTimeUntilNextTransition());
+    }
+
+    for (TEffectTimeMs iteration = 0; iteration < 2; ++iteration)
+    {
+      const TEffectTimeMs iterationStartTime =
+          kTestEffectStartDelay + (iteration * kTestEffectDuration);
+
+      for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+      {
+        const TOrderedMagnitudeComponents expectedMagnitudeComponents =
+            effect.ComputeOrderedMagnitudeComponents(t);
+        const TOrderedMagnitudeComponents actualMagnitudeComponents =
+            Device.PlayEffects(iterationStartTime + t);
+        TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+        TEST_ASSERT(kTestEffectDuration - t == Device.GetTimeUntilNextTransition());
+      }
+    }
+
+    Device.PlayEffects(kTestEffectStartDelay + (2 * kTestEffectDuration));
+    TEST_ASSERT(false == Device.IsEffectPlaying(effect.Identifier()));
+    TEST_ASSERT(false == Device.GetTimeUntilNextTransition().has_value());
+  }
+
   // A single effect exists for playback but has a start delay.
   // Verifies that the start delay is honored and the correct magnitude vector is retrieved at each
   // time.
@@ -435,6 +521,147 @@ namespace XidiTest
     TEST_ASSERT(false == Device.IsEffectPlaying(effect.Identifier()));
   }
 
+  // A single effect is updated several times without being started, once while never having been
+  // started and again after being stopped. Verifies that such updates do not wake up playback and
+  // that the most recent parameters are in effect once the effect is started.
+  TEST_CASE(ForceFeedbackDevice_SingleEffect_StagedUpdates)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+
+    Device Device = MakeTestDevice();
+
+    MockEffect effect = MakeTestEffect(kTestEffectDuration);
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+    Device.PlayEffects(0);
+
+    for (TEffectTimeMs iteration = 0; iteration < 2; ++iteration)
+    {
+      const TEffectTimeMs iterationStartTime = iteration * kTestEffectDuration;
+
+      for (TEffectTimeMs duration = 1; duration <= kTestEffectDuration; duration *= 10)
+      {
+        TEST_ASSERT(true == effect.SetDuration(duration));
+        TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+        TEST_ASSERT(true == Device.IsDeviceIdle());
+      }
+
+      TEST_ASSERT(true == effect.SetDuration(kTestEffectDuration / 2));
+      TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+      TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, iterationStartTime));
+      TEST_ASSERT(false == Device.IsDeviceIdle());
+
+      for (TEffectTimeMs t = 0; t < (kTestEffectDuration / 2); ++t)
+      {
+        const TOrderedMagnitudeComponents expectedMagnitudeComponents =
+            effect.ComputeOrderedMagnitudeComponents(t);
+        const TOrderedMagnitudeComponents actualMagnitudeComponents =
+            Device.PlayEffects(iterationStartTime + t);
+        TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+      }
+
+      TEST_ASSERT(true == Device.StopEffect(effect.Identifier()));
+      Device.PlayEffects(iterationStartTime + (kTestEffectDuration / 2));
+      TEST_ASSERT(true == Device.IsDeviceIdle());
+    }
+  }
+
+  // A single effect is started with a start delay, played to completion, restarted, stopped, and
+  // finally removed. Verifies that the playing state published to the effect and the lock-free
+  // device status track the effect throughout.
+  TEST_CASE(ForceFeedbackDevice_SingleEffect_PublishedStatus)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+    constexpr TEffectTimeMs kTestEffectStartDelay = 10;
+
+    Device Device = MakeTestDevice();
+
+    MockEffect effect = MakeTestEffect(kTestEffectDuration);
+    TEST_ASSERT(true == effect.SetStartDelay(kTestEffectStartDelay));
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+    TEST_ASSERT(false == Device.IsDeviceEmpty());
+    TEST_ASSERT(false == Device.IsDevicePlayingAnyEffects());
+
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, 0));
+    TEST_ASSERT(true == Device.IsDevicePlayingAnyEffects());
+    TEST_ASSERT(false == effect.IsPlaying());
+
+    for (TEffectTimeMs t = 0; t < kTestEffectStartDelay; ++t)
+    {
+      Device.PlayEffects(t);
+      TEST_ASSERT(true == Device.IsDevicePlayingAnyEffects());
+      TEST_ASSERT(false == effect.IsPlaying());
+    }
+
+    for (TEffectTimeMs t = kTestEffectStartDelay; t < kTestEffectStartDelay + kTestEffectDuration;
+         ++t)
+    {
+      Device.PlayEffects(t);
+      TEST_ASSERT(true == effect.IsPlaying());
+    }
+
+    Device.PlayEffects(kTestEffectStartDelay + kTestEffectDuration);
+    TEST_ASSERT(false == Device.IsDevicePlayingAnyEffects());
+    TEST_ASSERT(false == effect.IsPlaying());
+
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, 200));
+    Device.PlayEffects(200 + kTestEffectStartDelay);
+    TEST_ASSERT(true == effect.IsPlaying());
+    TEST_ASSERT(true == Device.StopEffect(effect.Identifier()));
+    TEST_ASSERT(false == effect.IsPlaying());
+
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, 300));
+    Device.PlayEffects(300 + kTestEffectStartDelay);
+    TEST_ASSERT(true == effect.IsPlaying());
+    TEST_ASSERT(true == Device.RemoveEffect(effect.Identifier()));
+    TEST_ASSERT(false == effect.IsPlaying());
+    TEST_ASSERT(true == Device.IsDeviceEmpty());
+  }
+
+  // A single effect is played with averaging enabled, once per averaging window and then more
+  // often. Verifies that each playback operation produces the average output over the time since
+  // the previous one, never reaching back further than the averaging window or before the effect
+  // started.
+  TEST_CASE(ForceFeedbackDevice_SingleEffect_Averaging)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+    constexpr TEffectTimeMs kTestAveragingWindow = 10;
+    constexpr TEffectTimeMs kTestEffectStartTime = 5;
+
+    Device Device = MakeTestDevice();
+    Device.SetAveragingWindow(kTestAveragingWindow);
+
+    MockEffect effect = MakeTestEffect(kTestEffectDuration);
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, kTestEffectStartTime));
+
+    Device.PlayEffects(0);
+
+    TEST_ASSERT(
+        effect.ComputeAverageOrderedMagnitudeComponents(0, kTestAveragingWindow) ==
+        Device.PlayEffects(kTestEffectStartTime + kTestAveragingWindow - 1));
+
+    for (TEffectTimeMs t = 2 * kTestAveragingWindow; t <= (kTestEffectDuration / 2);
+         t += kTestAveragingWindow)
+    {
+      const TOrderedMagnitudeComponents expectedMagnitudeComponents =
+          effect.ComputeAverageOrderedMagnitudeComponents(t - kTestAveragingWindow, t);
+      const TOrderedMagnitudeComponents actualMagnitudeComponents =
+          Device.PlayEffects(kTestEffectStartTime + t - 1);
+      TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+      TEST_ASSERT(
+          actualMagnitudeComponents != effect.ComputeOrderedMagnitudeComponents(t - 1));
+    }
+
+    for (TEffectTimeMs t = (kTestEffectDuration / 2); t < kTestEffectDuration; ++t)
+    {
+      const TOrderedMagnitudeComponents expectedMagnitudeComponents =
+          effect.ComputeOrderedMagnitudeComponents(t);
+      const TOrderedMagnitudeComponents actualMagnitudeComponents =
+          Device.PlayEffects(kTestEffectStartTime + t);
+      TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+    }
+  }
+
   // A single effect is started with multiple iterations.
   // Verifies that the correct magnitude vector is retrieved at each time.
   TEST_CASE(ForceFeedbackDevice_SingleEffect_MultipleIterations)
@@ -665,4 +892,169 @@ namespace XidiTest
       TEST_ASSERT(false == Device.IsEffectPlaying(effect.Identifier()));
     }
   }
+
+  // Fills the device buffer to capacity with effects, all of which are playing.
+  // Verifies that no more effects can be added and that removing an effect frees up its space so
+  // that another effect can take its place.
+  TEST_CASE(ForceFeedbackDevice_MultipleEffects_Capacity)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+
+    Device Device = MakeTestDevice();
+
+    std::vector<MockEffect> effects;
+    for (unsigned int i = 0; i <= Device::kEffectMaxCount; ++i)
+      effects.push_back(MakeTestEffect(kTestEffectDuration));
+
+    for (unsigned int i = 0; i < Device::kEffectMaxCount; ++i)
+    {
+      TEST_ASSERT(true == Device.AddOrUpdateEffect(effects[i]));
+      TEST_ASSERT(true == Device.StartEffect(effects[i].Identifier(), 1, kDefaultTimestampBase));
+    }
+
+    TEST_ASSERT(Device::kEffectMaxCount == Device.GetCountTotalEffects());
+    TEST_ASSERT(Device::kEffectMaxCount == Device.GetCountPlayingEffects());
+    TEST_ASSERT(false == Device.AddOrUpdateEffect(effects.back()));
+    TEST_ASSERT(false == Device.IsEffectOnDevice(effects.back().Identifier()));
+
+    TEST_ASSERT(true == Device.RemoveEffect(effects.front().Identifier()));
+    TEST_ASSERT(false == Device.IsEffectOnDevice(effects.front().Identifier()));
+    TEST_ASSERT((Device::kEffectMaxCount - 1) == Device.GetCountPlayingEffects());
+
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effects.back()));
+    TEST_ASSERT(true == Device.IsEffectOnDevice(effects.back().Identifier()));
+    TEST_ASSERT(false == Device.IsEffectPlaying(effects.back().Identifier()));
+    TEST_ASSERT(Device::kEffectMaxCount == Device.GetCountTotalEffects());
+    TEST_ASSERT((Device::kEffectMaxCount - 1) == Device.GetCountPlayingEffects());
+  }
+
+  // Multiple effects whose identifiers are far apart but otherwise equivalent as far as locating
+  // them within the device buffer are added and removed in various orders. Verifies that all
+  // effects remain findable, and can be started and stopped, no matter which effects are removed.
+  TEST_CASE(ForceFeedbackDevice_MultipleEffects_IdentifierCollisions)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+    constexpr unsigned int kTestIdentifierStride = 2 * Device::kEffectMaxCount;
+
+    Device Device = MakeTestDevice();
+
+    std::vector<MockEffect> effects;
+    for (unsigned int i = 0; i <= (2 * kTestIdentifierStride); ++i)
+      effects.push_back(MakeTestEffect(kTestEffectDuration));
+
+    const std::vector<MockEffect*> testEffects = {
+        &effects[0],
+        &effects[kTestIdentifierStride],
+        &effects[1],
+        &effects[2 * kTestIdentifierStride]};
+
+    for (auto testEffect : testEffects)
+      TEST_ASSERT(true == Device.AddOrUpdateEffect(*testEffect));
+
+    for (auto removedEffect : testEffects)
+    {
+      TEST_ASSERT(true == Device.RemoveEffect(removedEffect->Identifier()));
+      TEST_ASSERT(false == Device.IsEffectOnDevice(removedEffect->Identifier()));
+
+      for (auto testEffect : testEffects)
+      {
+        if (testEffect == removedEffect) continue;
+
+        TEST_ASSERT(true == Device.IsEffectOnDevice(testEffect->Identifier()));
+        TEST_ASSERT(true == Device.StartEffect(testEffect->Identifier(), 1, kDefaultTimestampBase));
+        TEST_ASSERT(true == Device.IsEffectPlaying(testEffect->Identifier()));
+        TEST_ASSERT(true == Device.StopEffect(testEffect->Identifier()));
+        TEST_ASSERT(false == Device.IsEffectPlaying(testEffect->Identifier()));
+      }
+
+      TEST_ASSERT(true == Device.AddOrUpdateEffect(*removedEffect));
+      TEST_ASSERT(true == Device.IsEffectOnDevice(removedEffect->Identifier()));
+      TEST_ASSERT(testEffects.size() == Device.GetCountTotalEffects());
+    }
+
+    TEST_ASSERT(false == Device.IsEffectOnDevice(effects[kTestIdentifierStride + 1].Identifier()));
+    TEST_ASSERT(false == Device.RemoveEffect(effects[kTestIdentifierStride + 1].Identifier()));
+  }
+
+  // A constant force effect with an envelope is played alongside a mock effect that starts once
+  // the constant force effect reaches the sustain portion of its envelope, stopping before the
+  // fade begins. Verifies that the output, which the device can reuse while neither effect's
+  // magnitude changes, is correct at every time.
+  TEST_CASE(ForceFeedbackDevice_MultipleEffects_StableOutputReuse)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 1000;
+    constexpr SEnvelope kTestEnvelope = {
+        .attackTime = 100, .attackLevel = 0, .fadeTime = 200, .fadeLevel = 0};
+    constexpr TEffectTimeMs kTestMockEffectStartTime = 300;
+    constexpr TEffectTimeMs kTestMockEffectDuration = 100;
+
+    Device Device = MakeTestDevice();
+
+    ConstantForceEffect constantForceEffect;
+    constantForceEffect.InitializeDefaultAssociatedAxes();
+    constantForceEffect.InitializeDefaultDirection();
+    constantForceEffect.SetDuration(kTestEffectDuration);
+    constantForceEffect.SetEnvelope(kTestEnvelope);
+    constantForceEffect.SetTypeSpecificParameters({.magnitude = 5000});
+
+    MockEffect mockEffect = MakeTestEffect(kTestMockEffectDuration);
+
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(constantForceEffect));
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(mockEffect));
+    TEST_ASSERT(
+        true == Device.StartEffect(constantForceEffect.Identifier(), 1, kDefaultTimestampBase));
+
+    for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+    {
+      if (kTestMockEffectStartTime == t)
+        TEST_ASSERT(true == Device.StartEffect(mockEffect.Identifier(), 1, t));
+
+      TOrderedMagnitudeComponents expectedMagnitudeComponents =
+          constantForceEffect.ComputeOrderedMagnitudeComponents(t);
+      if ((t >= kTestMockEffectStartTime) &&
+          (t < kTestMockEffectStartTime + kTestMockEffectDuration))
+        expectedMagnitudeComponents +=
+            mockEffect.ComputeOrderedMagnitudeComponents(t - kTestMockEffectStartTime);
+
+      const TOrderedMagnitudeComponents actualMagnitudeComponents = Device.PlayEffects(t);
+      TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+    }
+  }
+
+  // Plays a condition effect and changes the axis state between playback operations at the same
+  // time. Verifies that the output follows the axis state rather than being reused.
+  TEST_CASE(ForceFeedbackDevice_ConditionEffect_FollowsAxisState)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 100;
+    constexpr SAxisCondition kTestAxisCondition = {
+        .offset = 0,
+        .positiveCoefficient = 10000,
+        .negativeCoefficient = 10000,
+        .positiveSaturation = 10000,
+        .negativeSaturation = 10000,
+        .deadBand = 0};
+    constexpr SConditionParameters kTestConditionParameters = {
+        .count = 1, .axis = {kTestAxisCondition}};
+
+    Device Device = MakeTestDevice();
+
+    SpringEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetTypeSpecificParameters(kTestConditionParameters);
+
+    TEST_ASSERT(true == Device.AddOrUpdateEffect(effect));
+    TEST_ASSERT(true == Device.StartEffect(effect.Identifier(), 1, kDefaultTimestampBase));
+
+    for (TEffectValue position : {1000.0f, -2000.0f, 0.0f, 3000.0f})
+    {
+      const SConditionInput conditionInput = {.position = {position}};
+      const TOrderedMagnitudeComponents expectedMagnitudeComponents =
+          effect.ComputeOrderedMagnitudeComponents(0, conditionInput);
+      const TOrderedMagnitudeComponents actualMagnitudeComponents =
+          Device.PlayEffects(conditionInput, 0);
+      TEST_ASSERT(actualMagnitudeComponents == expectedMagnitudeComponents);
+      TEST_ASSERT(-position == actualMagnitudeComponents[0]);
+    }
+  }
 } // namespace XidiTest
@@ -136,6 +136,36 @@ namespace XidiTest
     }
   }
 
+  // Creates a test effect with a sample period.
+  // Verifies that the average magnitude over windows of various lengths and alignments, including
+  // those that extend past the end of the duration, matches the average of the magnitudes at each
+  // millisecond within the window.
+  TEST_CASE(ForceFeedbackEffect_EffectWithSamplePeriod_AverageMagnitude)
+  {
+    constexpr TEffectTimeMs kTestWindowLengths[] = {1, 7, kTestEffectSamplePeriod, 25};
+
+    MockEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetSamplePeriod(kTestEffectSamplePeriod);
+
+    for (const auto windowLength : kTestWindowLengths)
+    {
+      for (TEffectTimeMs t = 0; t < kTestEffectDuration; t += 3)
+      {
+        TEffectValue magnitudeSum = 0;
+        for (TEffectTimeMs u = t; u < t + windowLength; ++u)
+          magnitudeSum += effect.ComputeMagnitude(u);
+
+        const TEffectValue expectedMagnitude = magnitudeSum / (TEffectValue)windowLength;
+        const TEffectValue actualMagnitude =
+            effect.ComputeAverageMagnitude(t, t + windowLength);
+        TEST_ASSERT(actualMagnitude == expectedMagnitude);
+      }
+    }
+  }
+
   // Creates a test effect with a sample period.
   // Verifies that it returns the correct values for all of its common properties.
   TEST_CASE(ForceFeedbackEffect_EffectWithSamplePeriod_Parameters)
@@ -0,0 +1,312 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file ForceFeedbackTimingTest.cpp
+ *   Timing accuracy tests for force feedback effects as they appear on the physical actuators,
+ *   driven by a simulated clock so that results are deterministic. Each test case reports the
+ *   timing it observed, which serves as a baseline for changes to effect scheduling and
+ *   evaluation, and fails if the observed timing is worse than the actuation period allows.
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ControllerTypes.h"
+#include "ForceFeedbackDevice.h"
+#include "ForceFeedbackEffect.h"
+#include "ForceFeedbackParameters.h"
+#include "ForceFeedbackTypes.h"
+#include "MockForceFeedbackActuator.h"
+#include "PhysicalController.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller::ForceFeedback;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::kPhysicalForceFeedbackPeriodMilliseconds;
+
+  /// Actuation period used throughout test cases, matching the default of the physical controller
+  /// actuation thread.
+  static constexpr TEffectTimeMs kTestActuationPeriod = kPhysicalForceFeedbackPeriodMilliseconds;
+
+  /// Common duration value used throughout test cases.
+  static constexpr TEffectTimeMs kTestEffectDuration = 1000;
+
+  /// Creates a constant force effect with the specified magnitude, using defaults for all other
+  /// mandatory parameters.
+  /// @param [in] magnitude Magnitude of the constant force.
+  /// @return Properly-initialized constant force effect.
+  static ConstantForceEffect MakeTestConstantForceEffect(TEffectValue magnitude)
+  {
+    ConstantForceEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetTypeSpecificParameters({.magnitude = magnitude});
+    return effect;
+  }
+
+  /// Determines the value of the X axis actuator at the specified time, based on the recorded
+  /// writes to the mock physical actuators.
+  /// @param [in] actuatorWrites Recorded writes, in chronological order.
+  /// @param [in] time Time of interest.
+  /// @return Value of the X axis actuator at the specified time.
+  static TEffectValue ActuatorValueAt(
+      const std::vector<SActuatorWrite>& actuatorWrites, TEffectTimeMs time)
+  {
+    TEffectValue actuatorValue = 0;
+
+    for (const auto& actuatorWrite : actuatorWrites)
+    {
+      if (actuatorWrite.timestamp > time) break;
+      actuatorValue = actuatorWrite.magnitudeComponents[(int)EAxis::X];
+    }
+
+    return actuatorValue;
+  }
+
+  // Starts a constant force effect on an idle device at various times relative to the actuation
+  // period. Verifies that the effect reaches the actuators within one actuation period of being
+  // started and reports the observed start latency.
+  TEST_CASE(ForceFeedbackTiming_StartLatency_Idle)
+  {
+    constexpr TEffectValue kTestMagnitude = 5000;
+
+    TEffectTimeMs maximumLatency = 0;
+    TEffectTimeMs totalLatency = 0;
+
+    for (TEffectTimeMs startTime = 0; startTime < (2 * kTestActuationPeriod); ++startTime)
+    {
+      MockForceFeedbackActuator actuator(kTestActuationPeriod);
+      actuator.AdvanceTo(startTime);
+
+      ConstantForceEffect effect = MakeTestConstantForceEffect(kTestMagnitude);
+      TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(effect));
+      TEST_ASSERT(true == actuator.GetDevice().StartEffect(effect.Identifier(), 1, actuator.Now()));
+      actuator.AdvanceTo(startTime + kTestEffectDuration);
+
+      const std::vector<SActuatorWrite>& actuatorWrites = actuator.GetActuatorWrites();
+      TEST_ASSERT(false == actuatorWrites.empty());
+      TEST_ASSERT(kTestMagnitude == actuatorWrites.front().magnitudeComponents[(int)EAxis::X]);
+
+      const TEffectTimeMs latency = actuatorWrites.front().timestamp - startTime;
+      TEST_ASSERT(latency <= kTestActuationPeriod);
+
+      maximumLatency = std::max(maximumLatency, latency);
+      totalLatency += latency;
+    }
+
+    Infra::Test::PrintFormatted(
+        L"Start latency from idle with a %u ms actuation period: average %.1f ms, maximum %u ms.",
+        (unsigned int)kTestActuationPeriod,
+        (double)totalLatency / (double)(2 * kTestActuationPeriod),
+        (unsigned int)maximumLatency);
+  }
+
+  // Starts a constant force effect at various times while another effect is already playing, so
+  // the actuation thread is not waiting for the device to become non-idle. Verifies that the new
+  // effect reaches the actuators within one actuation period of being started and reports the
+  // observed start latency.
+  TEST_CASE(ForceFeedbackTiming_StartLatency_Busy)
+  {
+    constexpr TEffectValue kTestBackgroundMagnitude = 1000;
+    constexpr TEffectValue kTestMagnitude = 5000;
+    constexpr TEffectTimeMs kTestBackgroundLeadTime = 100;
+
+    TEffectTimeMs maximumLatency = 0;
+    TEffectTimeMs totalLatency = 0;
+
+    for (TEffectTimeMs startOffset = 0; startOffset < (2 * kTestActuationPeriod); ++startOffset)
+    {
+      MockForceFeedbackActuator actuator(kTestActuationPeriod);
+
+      ConstantForceEffect backgroundEffect =
+          MakeTestConstantForceEffect(kTestBackgroundMagnitude);
+      TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(backgroundEffect));
+      TEST_ASSERT(
+          true == actuator.GetDevice().StartEffect(backgroundEffect.Identifier(), 1, 0));
+
+      const TEffectTimeMs startTime = kTestBackgroundLeadTime + startOffset;
+      actuator.AdvanceTo(startTime);
+
+      ConstantForceEffect effect = MakeTestConstantForceEffect(kTestMagnitude);
+      TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(effect));
+      TEST_ASSERT(true == actuator.GetDevice().StartEffect(effect.Identifier(), 1, actuator.Now()));
+      actuator.AdvanceTo(startTime + kTestActuationPeriod);
+
+      const std::vector<SActuatorWrite>& actuatorWrites = actuator.GetActuatorWrites();
+      TEST_ASSERT(false == actuatorWrites.empty());
+      TEST_ASSERT(
+          (kTestBackgroundMagnitude + kTestMagnitude) ==
+          actuatorWrites.back().magnitudeComponents[(int)EAxis::X]);
+
+      const TEffectTimeMs latency = actuatorWrites.back().timestamp - startTime;
+      TEST_ASSERT(latency <= kTestActuationPeriod);
+
+      maximumLatency = std::max(maximumLatency, latency);
+      totalLatency += latency;
+    }
+
+    Infra::Test::PrintFormatted(
+        L"Start latency while busy with a %u ms actuation period: average %.1f ms, maximum %u ms.",
+        (unsigned int)kTestActuationPeriod,
+        (double)totalLatency / (double)(2 * kTestActuationPeriod),
+        (unsigned int)maximumLatency);
+  }
+
+  // Plays a square wave whose period is not a multiple of the actuation period. Verifies that
+  // each half-period observed on the actuators differs from the intended half-period by no more
+  // than one actuation period, that the average period observed is close to the intended period,
+  // and reports the observed period error.
+  TEST_CASE(ForceFeedbackTiming_PeriodError_SquareWave)
+  {
+    constexpr TEffectTimeMs kTestWavePeriod = 46;
+    constexpr TEffectValue kTestAmplitude = 5000;
+
+    MockForceFeedbackActuator actuator(kTestActuationPeriod);
+
+    SquareWaveEffect effect;
+    effect.InitializeDefaultAssociatedAxes();
+    effect.InitializeDefaultDirection();
+    effect.SetDuration(kTestEffectDuration);
+    effect.SetTypeSpecificParameters(
+        {.amplitude = kTestAmplitude, .offset = 0, .phase = 0, .period = kTestWavePeriod});
+
+    TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(effect));
+    TEST_ASSERT(true == actuator.GetDevice().StartEffect(effect.Identifier(), 1, actuator.Now()));
+    actuator.AdvanceTo(kTestEffectDuration);
+
+    std::vector<TEffectTimeMs> polarityChangeTimes;
+    TEffectValue previousActuatorValue = 0;
+    for (const auto& actuatorWrite : actuator.GetActuatorWrites())
+    {
+      const TEffectValue actuatorValue = actuatorWrite.magnitudeComponents[(int)EAxis::X];
+      if ((0 != actuatorValue) && (0 > (actuatorValue * previousActuatorValue)))
+        polarityChangeTimes.push_back(actuatorWrite.timestamp);
+
+      if (0 != actuatorValue) previousActuatorValue = actuatorValue;
+    }
+
+    TEST_ASSERT(polarityChangeTimes.size() >= 2);
+
+    int maximumHalfPeriodError = 0;
+    for (size_t i = 1; i < polarityChangeTimes.size(); ++i)
+    {
+      const int halfPeriodError = std::abs(
+          (int)(polarityChangeTimes[i] - polarityChangeTimes[i - 1]) - (int)(kTestWavePeriod / 2));
+      TEST_ASSERT(halfPeriodError <= (int)kTestActuationPeriod);
+      maximumHalfPeriodError = std::max(maximumHalfPeriodError, halfPeriodError);
+    }
+
+    const TEffectTimeMs totalHalfPeriodTime =
+        polarityChangeTimes.back() - polarityChangeTimes.front();
+    const double averagePeriod =
+        (2.0 * (double)totalHalfPeriodTime) / (double)(polarityChangeTimes.size() - 1);
+    TEST_ASSERT(std::abs(averagePeriod - (double)kTestWavePeriod) <= 1.0);
+
+    Infra::Test::PrintFormatted(
+        L"Square wave with a %u ms period and a %u ms actuation period: average period %.2f ms, maximum half-period error %d ms.",
+        (unsigned int)kTestWavePeriod,
+        (unsigned int)kTestActuationPeriod,
+        averagePeriod,
+        maximumHalfPeriodError);
+  }
+
+  // Plays a constant force effect whose envelope has a long attack. Verifies that at every point
+  // in time the value on the actuators lags the ideal value by no more than the amount by which
+  // the envelope changes during one actuation period, and reports the observed quantization error.
+  TEST_CASE(ForceFeedbackTiming_EnvelopeQuantization_Attack)
+  {
+    constexpr TEffectValue kTestMagnitude = 10000;
+    constexpr SEnvelope kTestEnvelope = {
+        .attackTime = kTestEffectDuration / 4, .attackLevel = 0, .fadeTime = 0, .fadeLevel = 0};
+    constexpr TEffectValue kAttackSlope = kTestMagnitude / (TEffectValue)kTestEnvelope.attackTime;
+
+    MockForceFeedbackActuator actuator(kTestActuationPeriod);
+
+    ConstantForceEffect effect = MakeTestConstantForceEffect(kTestMagnitude);
+    effect.SetEnvelope(kTestEnvelope);
+
+    TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(effect));
+    TEST_ASSERT(true == actuator.GetDevice().StartEffect(effect.Identifier(), 1, actuator.Now()));
+    actuator.AdvanceTo(kTestEffectDuration);
+
+    TEffectValue maximumError = 0;
+    for (TEffectTimeMs t = 0; t < kTestEffectDuration; ++t)
+    {
+      const TEffectValue error = std::abs(
+          effect.ComputeOrderedMagnitudeComponents(t)[(int)EAxis::X] -
+          ActuatorValueAt(actuator.GetActuatorWrites(), t));
+      TEST_ASSERT(error <= ((kAttackSlope * (TEffectValue)kTestActuationPeriod) + 1));
+      maximumError = std::max(maximumError, error);
+    }
+
+    Infra::Test::PrintFormatted(
+        L"Envelope attack of %u ms with a %u ms actuation period: %u actuator writes, maximum error %.1f (%.1f%% of full scale).",
+        (unsigned int)kTestEnvelope.attackTime,
+        (unsigned int)kTestActuationPeriod,
+        (unsigned int)actuator.GetActuatorWrites().size(),
+        (double)maximumError,
+        (double)(maximumError * 100 / kTestMagnitude));
+  }
+
+  // Plays a mix of effects of several types for a long time and reports the processor time spent
+  // per actuation pass. This test case only fails if the effects do not play.
+  TEST_CASE(ForceFeedbackTiming_CostPerActuationPass)
+  {
+    constexpr unsigned int kTestNumEffectsPerType = 4;
+    constexpr TEffectTimeMs kTestLongEffectDuration = 60000;
+
+    MockForceFeedbackActuator actuator(kTestActuationPeriod);
+
+    std::vector<ConstantForceEffect> constantForceEffects;
+    std::vector<SineWaveEffect> sineWaveEffects;
+    for (unsigned int i = 0; i < kTestNumEffectsPerType; ++i)
+    {
+      ConstantForceEffect& constantForceEffect =
+          constantForceEffects.emplace_back(MakeTestConstantForceEffect(1000));
+      constantForceEffect.SetDuration(kTestLongEffectDuration);
+      constantForceEffect.SetEnvelope(
+          {.attackTime = 1000, .attackLevel = 0, .fadeTime = 1000, .fadeLevel = 0});
+
+      SineWaveEffect& sineWaveEffect = sineWaveEffects.emplace_back();
+      sineWaveEffect.InitializeDefaultAssociatedAxes();
+      sineWaveEffect.InitializeDefaultDirection();
+      sineWaveEffect.SetDuration(kTestLongEffectDuration);
+      sineWaveEffect.SetTypeSpecificParameters(
+          {.amplitude = 1000, .offset = 0, .phase = 0, .period = 100 + (10 * i)});
+
+      TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(constantForceEffect));
+      TEST_ASSERT(true == actuator.GetDevice().AddOrUpdateEffect(sineWaveEffect));
+      TEST_ASSERT(
+          true == actuator.GetDevice().StartEffect(constantForceEffect.Identifier(), 1, 0));
+      TEST_ASSERT(true == actuator.GetDevice().StartEffect(sineWaveEffect.Identifier(), 1, 0));
+    }
+
+    const auto simulationStartTime = std::chrono::steady_clock::now();
+    actuator.AdvanceTo(kTestLongEffectDuration);
+    const auto simulationDuration = std::chrono::steady_clock::now() - simulationStartTime;
+
+    TEST_ASSERT(actuator.GetActuationPassCount() > 0);
+    TEST_ASSERT(false == actuator.GetActuatorWrites().empty());
+
+    Infra::Test::PrintFormatted(
+        L"%u effects for %u ms with a %u ms actuation period: %llu actuation passes, %llu actuator writes, %.0f ns per actuation pass.",
+        (unsigned int)(kTestNumEffectsPerType * 2),
+        (unsigned int)kTestLongEffectDuration,
+        (unsigned int)kTestActuationPeriod,
+        (unsigned long long)actuator.GetActuationPassCount(),
+        (unsigned long long)actuator.GetActuatorWrites().size(),
+        std::chrono::duration<double, std::nano>(simulationDuration).count() /
+            (double)actuator.GetActuationPassCount());
+  }
+} // namespace XidiTest
@@ -0,0 +1,157 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file JoystickCapturePolicyTest.cpp
+ *   Unit tests for the policy that determines when WinMM joystick capture messages are delivered.
+ **************************************************************************************************/
+
+#include "JoystickCapturePolicy.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiWindows.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::WrapperJoyWinMM;
+
+  /// Duration of each simulated capture session, in milliseconds.
+  static constexpr uint32_t kSimulatedSessionMilliseconds = 1000;
+
+  /// Simulates the thread that delivers joystick capture messages following the specified wait
+  /// policy over a session of fixed duration, and records the times at which rounds of messages
+  /// happen.
+  /// @param [in] waitPolicy Wait policy to follow.
+  /// @param [in] stateChangeIntervalMilliseconds Time between consecutive virtual controller state
+  /// changes, or 0 if state never changes.
+  /// @return Times, in milliseconds since the start of the session, of all rounds of messages.
+  static std::vector<uint32_t> SimulateCaptureRounds(
+      const SCaptureWaitPolicy& waitPolicy, uint32_t stateChangeIntervalMilliseconds)
+  {
+    std::vector<uint32_t> roundTimes;
+
+    uint32_t currentTime = 0;
+    uint32_t lastConsumedChangeTime = 0;
+
+    while (currentTime < kSimulatedSessionMilliseconds)
+    {
+      // State change events are auto-reset, so a change that happened since the last round is
+      // still pending and ends the wait immediately.
+      uint32_t wakeTime = UINT32_MAX;
+      if ((true == waitPolicy.wakeOnStateChange) && (0 != stateChangeIntervalMilliseconds))
+      {
+        uint32_t nextChangeTime = lastConsumedChangeTime + stateChangeIntervalMilliseconds;
+        while ((nextChangeTime + stateChangeIntervalMilliseconds) <= currentTime)
+          nextChangeTime += stateChangeIntervalMilliseconds;
+        wakeTime = ((nextChangeTime > currentTime) ? nextChangeTime : currentTime);
+      }
+
+      if ((INFINITE != waitPolicy.timeoutMilliseconds) &&
+          ((currentTime + waitPolicy.timeoutMilliseconds) < wakeTime))
+        wakeTime = currentTime + waitPolicy.timeoutMilliseconds;
+
+      if (wakeTime >= kSimulatedSessionMilliseconds) break;
+
+      roundTimes.push_back(wakeTime);
+      if (0 != stateChangeIntervalMilliseconds)
+        lastConsumedChangeTime =
+            (wakeTime / stateChangeIntervalMilliseconds) * stateChangeIntervalMilliseconds;
+
+      currentTime = wakeTime + waitPolicy.holdOffMilliseconds;
+    }
+
+    return roundTimes;
+  }
+
+  /// Checks that consecutive rounds of messages are never closer together than the specified
+  /// period.
+  /// @param [in] roundTimes Times of all rounds of messages.
+  /// @param [in] periodMilliseconds Capture period.
+  /// @return `true` if the period is respected, `false` otherwise.
+  static bool IsPeriodRespected(const std::vector<uint32_t>& roundTimes, UINT periodMilliseconds)
+  {
+    for (size_t i = 1; i < roundTimes.size(); ++i)
+    {
+      if ((roundTimes[i] - roundTimes[i - 1]) < periodMilliseconds) return false;
+    }
+
+    return true;
+  }
+
+  // Verifies that, when all messages are requested, a round happens exactly once per period even
+  // though state changes far more often than that, such as at the polling rate.
+  TEST_CASE(JoystickCapturePolicy_AllMessages_FrequentStateChanges)
+  {
+    constexpr UINT kPeriodMilliseconds = 20;
+
+    const std::vector<uint32_t> roundTimes =
+        SimulateCaptureRounds(CaptureWaitPolicy(kPeriodMilliseconds, false), 1);
+
+    TEST_ASSERT(
+        ((kSimulatedSessionMilliseconds / kPeriodMilliseconds) - 1) == roundTimes.size());
+    TEST_ASSERT(true == IsPeriodRespected(roundTimes, kPeriodMilliseconds));
+  }
+
+  // Verifies that, when all messages are requested, a round happens once per period even if state
+  // never changes.
+  TEST_CASE(JoystickCapturePolicy_AllMessages_NoStateChanges)
+  {
+    constexpr UINT kPeriodMilliseconds = 50;
+
+    const std::vector<uint32_t> roundTimes =
+        SimulateCaptureRounds(CaptureWaitPolicy(kPeriodMilliseconds, false), 0);
+
+    TEST_ASSERT(
+        ((kSimulatedSessionMilliseconds / kPeriodMilliseconds) - 1) == roundTimes.size());
+    TEST_ASSERT(true == IsPeriodRespected(roundTimes, kPeriodMilliseconds));
+  }
+
+  // Verifies that, when only changes are requested, rounds happen no more than once per period
+  // even though state changes far more often than that.
+  TEST_CASE(JoystickCapturePolicy_ChangedOnly_FrequentStateChanges)
+  {
+    constexpr UINT kPeriodMilliseconds = 20;
+
+    const std::vector<uint32_t> roundTimes =
+        SimulateCaptureRounds(CaptureWaitPolicy(kPeriodMilliseconds, true), 1);
+
+    TEST_ASSERT(false == roundTimes.empty());
+    TEST_ASSERT(roundTimes.size() <= (kSimulatedSessionMilliseconds / kPeriodMilliseconds));
+    TEST_ASSERT(true == IsPeriodRespected(roundTimes, kPeriodMilliseconds));
+  }
+
+  // Verifies that, when only changes are requested, no rounds happen if state never changes.
+  TEST_CASE(JoystickCapturePolicy_ChangedOnly_NoStateChanges)
+  {
+    constexpr UINT kPeriodMilliseconds = 20;
+
+    const std::vector<uint32_t> roundTimes =
+        SimulateCaptureRounds(CaptureWaitPolicy(kPeriodMilliseconds, true), 0);
+
+    TEST_ASSERT(true == roundTimes.empty());
+  }
+
+  // Verifies that, when only changes are requested, each infrequent state change produces one round
+  // as soon as it happens.
+  TEST_CASE(JoystickCapturePolicy_ChangedOnly_InfrequentStateChanges)
+  {
+    constexpr UINT kPeriodMilliseconds = 10;
+    constexpr uint32_t kStateChangeIntervalMilliseconds = 100;
+
+    const std::vector<uint32_t> roundTimes = SimulateCaptureRounds(
+        CaptureWaitPolicy(kPeriodMilliseconds, true), kStateChangeIntervalMilliseconds);
+
+    TEST_ASSERT(
+        ((kSimulatedSessionMilliseconds / kStateChangeIntervalMilliseconds) - 1) ==
+        roundTimes.size());
+    for (size_t i = 0; i < roundTimes.size(); ++i)
+      TEST_ASSERT(((i + 1) * kStateChangeIntervalMilliseconds) == roundTimes[i]);
+  }
+} // namespace XidiTest
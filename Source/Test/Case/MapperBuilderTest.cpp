@@ -15,6 +15,7 @@
 #include <optional>
 #include <set>
 #include <string_view>
+#include <vector>
 
 #include <Infra/Test/TestCase.h>
 
@@ -533,6 +534,54 @@ namespace XidiTest
     VerifyElementMapsAreEquivalent(actualElementMap, expectedElementMap);
   }
 
+  // Verifies that element mappers supplied to a blueprint with a template are moved into the built
+  // mapper rather than being replaced by copies, and that element mappers inherited from the
+  // template are copies that the built mapper owns separately from the template.
+  TEST_CASE(MapperBuilder_Build_Template_OverrideIsMoved)
+  {
+    constexpr std::wstring_view kMapperName = L"TestMapper";
+    constexpr unsigned int kControllerElement = ELEMENT_MAP_INDEX_OF(triggerLT);
+
+    const Mapper* const kTemplateMapper = Mapper::GetByName(L"StandardGamepad");
+    TEST_ASSERT(nullptr != kTemplateMapper);
+
+    MapperBuilder builder;
+    TEST_ASSERT(true == builder.CreateBlueprint(kMapperName));
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kMapperName, kTemplateMapper->GetName()));
+
+    std::unique_ptr<IElementMapper> overrideElementMapper =
+        std::make_unique<ButtonMapper>(EButton::B15);
+    const IElementMapper* const kOverrideElementMapper = overrideElementMapper.get();
+    TEST_ASSERT(
+        true ==
+        builder.SetBlueprintElementMapper(
+            kMapperName, kControllerElement, std::move(overrideElementMapper)));
+
+    std::unique_ptr<const Mapper> mapper(builder.Build(kMapperName));
+    TEST_ASSERT(nullptr != mapper);
+
+    const Mapper::UElementMap& actualElementMap = mapper->ElementMap();
+    const Mapper::UElementMap& templateElementMap = kTemplateMapper->ElementMap();
+
+    for (unsigned int i = 0; i < _countof(actualElementMap.all); ++i)
+    {
+      if (kControllerElement == i)
+      {
+        TEST_ASSERT(actualElementMap.all[i].get() == kOverrideElementMapper);
+      }
+      else if (nullptr != templateElementMap.all[i])
+      {
+        TEST_ASSERT(nullptr != actualElementMap.all[i]);
+        TEST_ASSERT(actualElementMap.all[i].get() != templateElementMap.all[i].get());
+        VerifyElementMappersAreEquivalent(*actualElementMap.all[i], *templateElementMap.all[i]);
+      }
+      else
+      {
+        TEST_ASSERT(nullptr == actualElementMap.all[i]);
+      }
+    }
+  }
+
   // Verifies that a mapper with a template and some changes applied can be built and registered, in
   // this case the changes being element removal. After build is completed, checks that the element
   // mappers all match. For this test the template is a known and documented mapper, and the changes
@@ -736,6 +785,150 @@ namespace XidiTest
       TEST_ASSERT(nullptr == builder.Build(kMapperNames[i]));
   }
 
+  // Verifies that building all blueprints at once correctly builds many independent mappers along
+  // with mappers that use them as templates, including a chain of templates. Enough independent
+  // blueprints are used that they are built concurrently.
+  TEST_CASE(MapperBuilder_Build_All_MultipleLevels)
+  {
+    constexpr std::wstring_view kIndependentMapperNames[] = {
+        L"TestMapperA",
+        L"TestMapperB",
+        L"TestMapperC",
+        L"TestMapperD",
+        L"TestMapperE",
+        L"TestMapperF",
+        L"TestMapperG",
+        L"TestMapperH"};
+    constexpr std::wstring_view kDependentMapperName = L"TestMapperDependent";
+    constexpr std::wstring_view kChainedMapperName = L"TestMapperChained";
+
+    MapperBuilder builder;
+
+    for (int i = 0; i < _countof(kIndependentMapperNames); ++i)
+    {
+      TEST_ASSERT(true == builder.CreateBlueprint(kIndependentMapperNames[i]));
+      TEST_ASSERT(
+          true ==
+          builder.SetBlueprintElementMapper(
+              kIndependentMapperNames[i],
+              ELEMENT_MAP_INDEX_OF(buttonA),
+              std::make_unique<ButtonMapper>((EButton)i)));
+    }
+
+    // Blueprints are stored in name order, so these two are deliberately named such that they
+    // come before their templates.
+    TEST_ASSERT(true == builder.CreateBlueprint(kChainedMapperName));
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kChainedMapperName, kDependentMapperName));
+    TEST_ASSERT(
+        true ==
+        builder.SetBlueprintElementMapper(
+            kChainedMapperName,
+            ELEMENT_MAP_INDEX_OF(buttonB),
+            std::make_unique<ButtonMapper>(EButton::B16)));
+
+    TEST_ASSERT(true == builder.CreateBlueprint(kDependentMapperName));
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kDependentMapperName, L"TestMapperH"));
+
+    TEST_ASSERT(true == builder.Build());
+
+    std::vector<std::unique_ptr<const Mapper>> mappers;
+    for (int i = 0; i < _countof(kIndependentMapperNames); ++i)
+    {
+      mappers.emplace_back(Mapper::GetByName(kIndependentMapperNames[i]));
+      TEST_ASSERT(nullptr != mappers.back());
+      VerifyElementMapMatchesSpec(
+          std::set<int>({ELEMENT_MAP_INDEX_OF(buttonA)}),
+          ButtonMapper((EButton)i),
+          mappers.back()->ElementMap());
+    }
+
+    const Mapper* const kTemplateMapper = Mapper::GetByName(L"TestMapperH");
+
+    mappers.emplace_back(Mapper::GetByName(kDependentMapperName));
+    TEST_ASSERT(nullptr != mappers.back());
+    VerifyElementMapsAreEquivalent(mappers.back()->ElementMap(), kTemplateMapper->ElementMap());
+
+    mappers.emplace_back(Mapper::GetByName(kChainedMapperName));
+    TEST_ASSERT(nullptr != mappers.back());
+
+    Mapper::UElementMap expectedElementMap = kTemplateMapper->CloneElementMap();
+    expectedElementMap.named.buttonB = std::make_unique<ButtonMapper>(EButton::B16);
+    VerifyElementMapsAreEquivalent(mappers.back()->ElementMap(), expectedElementMap);
+  }
+
+  // Verifies that conditionally building a blueprint builds it only once and does nothing for
+  // blueprints that do not exist.
+  TEST_CASE(MapperBuilder_BuildIfPending_Nominal)
+  {
+    constexpr std::wstring_view kMapperName = L"TestMapper";
+
+    MapperBuilder builder;
+    TEST_ASSERT(true == builder.CreateBlueprint(kMapperName));
+
+    TEST_ASSERT(nullptr == builder.BuildIfPending(L"UnknownTestMapper"));
+
+    std::unique_ptr<const Mapper> mapper(builder.BuildIfPending(kMapperName));
+    TEST_ASSERT(nullptr != mapper);
+    TEST_ASSERT(Mapper::GetByName(kMapperName) == mapper.get());
+
+    TEST_ASSERT(nullptr == builder.BuildIfPending(kMapperName));
+  }
+
+  // Verifies that a mapper can be replaced by a new mapper of the same name, but only if that is
+  // explicitly allowed, and that blueprints using it as a template wait for the replacement.
+  TEST_CASE(MapperBuilder_Build_ReplaceExisting)
+  {
+    constexpr std::wstring_view kMapperName = L"TestMapper";
+    constexpr std::wstring_view kDependentMapperName = L"TestMapperDependent";
+
+    // Mapper objects that are replaced are never destroyed, so the original is intentionally not
+    // owned by anything here.
+    MapperBuilder originalBuilder;
+    TEST_ASSERT(true == originalBuilder.CreateBlueprint(kMapperName));
+    const Mapper* const originalMapper = originalBuilder.Build(kMapperName);
+    TEST_ASSERT(nullptr != originalMapper);
+
+    MapperBuilder replacementBuilder;
+    TEST_ASSERT(false == replacementBuilder.CreateBlueprint(kMapperName));
+
+    replacementBuilder.AllowReplacingMapper(kMapperName);
+    TEST_ASSERT(true == replacementBuilder.CreateBlueprint(kMapperName));
+    TEST_ASSERT(true == replacementBuilder.CreateBlueprint(kDependentMapperName));
+    TEST_ASSERT(true == replacementBuilder.SetBlueprintTemplate(kDependentMapperName, kMapperName));
+    TEST_ASSERT(true == replacementBuilder.CanBuildAll());
+
+    std::unique_ptr<const Mapper> dependentMapper(replacementBuilder.Build(kDependentMapperName));
+    TEST_ASSERT(nullptr != dependentMapper);
+
+    std::unique_ptr<const Mapper> replacementMapper(Mapper::GetByName(kMapperName));
+    TEST_ASSERT(nullptr != replacementMapper);
+    TEST_ASSERT(originalMapper != replacementMapper.get());
+    TEST_ASSERT(nullptr == replacementBuilder.Build(kMapperName));
+  }
+
+  // Verifies that checking whether all blueprints can be built identifies template problems
+  // without building anything.
+  TEST_CASE(MapperBuilder_CanBuildAll_TemplateProblems)
+  {
+    constexpr std::wstring_view kMapperNames[] = {L"TestMapperA", L"TestMapperB"};
+
+    MapperBuilder builder;
+    for (const auto mapperName : kMapperNames)
+      TEST_ASSERT(true == builder.CreateBlueprint(mapperName));
+
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kMapperNames[1], kMapperNames[0]));
+    TEST_ASSERT(true == builder.CanBuildAll());
+
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kMapperNames[0], L"UnknownTestMapper"));
+    TEST_ASSERT(false == builder.CanBuildAll());
+
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kMapperNames[0], kMapperNames[1]));
+    TEST_ASSERT(false == builder.CanBuildAll());
+
+    for (const auto mapperName : kMapperNames)
+      TEST_ASSERT(false == Mapper::IsMapperNameKnown(mapperName));
+  }
+
   // Verifies that a mapper is built using the default force feedback actuator map if not using a
   // template and no changes are specified.
   TEST_CASE(MapperBuilder_Build_ForceFeedback_Default)
@@ -814,4 +1007,72 @@ namespace XidiTest
         mapper->GetForceFeedbackActuatorMap();
     VerifyForceFeedbackActuatorMapsAreEquivalent(actualActuatorMap, expectedActuatorMap);
   }
+
+  // Verifies that a mapper's chords are built in combination with a template's chords if a
+  // template is specified, and that chords can be set by name or by index.
+  TEST_CASE(MapperBuilder_Build_Chord_WithTemplate)
+  {
+    constexpr std::wstring_view kMapperName = L"TestMapper";
+    constexpr std::wstring_view kTemplateMapperName = L"TestMapperChordTemplate";
+    constexpr Mapper::TElementMapMask kChordElements =
+        ((1u << ELEMENT_MAP_INDEX_OF(buttonBack)) | (1u << ELEMENT_MAP_INDEX_OF(buttonStart)));
+
+    MapperBuilder builder;
+    TEST_ASSERT(true == builder.CreateBlueprint(kTemplateMapperName));
+    TEST_ASSERT(
+        true ==
+        builder.SetBlueprintChord(
+            kTemplateMapperName,
+            L"Chord1",
+            {.elements = kChordElements,
+             .elementMapper = std::make_unique<ButtonMapper>(EButton::B1)}));
+
+    TEST_ASSERT(true == builder.CreateBlueprint(kMapperName));
+    TEST_ASSERT(true == builder.SetBlueprintTemplate(kMapperName, kTemplateMapperName));
+    TEST_ASSERT(
+        true ==
+        builder.SetBlueprintChord(
+            kMapperName,
+            2,
+            {.elements = kChordElements,
+             .elementMapper = std::make_unique<ButtonMapper>(EButton::B2)}));
+    TEST_ASSERT(
+        false ==
+        builder.SetBlueprintChord(
+            kMapperName,
+            Mapper::kMaxChordCount,
+            {.elements = kChordElements,
+             .elementMapper = std::make_unique<ButtonMapper>(EButton::B3)}));
+    TEST_ASSERT(
+        false ==
+        builder.SetBlueprintChord(
+            kMapperName,
+            L"UnknownChord",
+            {.elements = kChordElements,
+             .elementMapper = std::make_unique<ButtonMapper>(EButton::B3)}));
+
+    std::unique_ptr<const Mapper> mapper(builder.Build(kMapperName));
+    TEST_ASSERT(nullptr != mapper);
+
+    const Mapper::TChords& actualChords = mapper->Chords();
+    for (unsigned int i = 0; i < Mapper::kMaxChordCount; ++i)
+    {
+      switch (i)
+      {
+        case 0:
+        case 2:
+          TEST_ASSERT(kChordElements == actualChords[i].elements);
+          TEST_ASSERT(nullptr != actualChords[i].elementMapper);
+          break;
+
+        default:
+          TEST_ASSERT(0 == actualChords[i].elements);
+          TEST_ASSERT(nullptr == actualChords[i].elementMapper);
+          break;
+      }
+    }
+
+    TEST_ASSERT(true == Mapper::IsMapperNameKnown(kTemplateMapperName));
+    delete Mapper::GetByName(kTemplateMapperName);
+  }
 } // namespace XidiTest
@@ -124,7 +124,8 @@ namespace XidiTest
         {ELEMENT_MAP_INDEX_OF(dpadDown), L"DpadDown"},
         {ELEMENT_MAP_INDEX_OF(triggerLT), L"TriggerLT"},
         {ELEMENT_MAP_INDEX_OF(buttonRB), L"ButtonRB"},
-        {ELEMENT_MAP_INDEX_OF(buttonStart), L"ButtonStart"}};
+        {ELEMENT_MAP_INDEX_OF(buttonStart), L"ButtonStart"},
+        {ELEMENT_MAP_INDEX_OF(buttonGuide), L"ButtonGuide"}};
 
     for (const auto& controllerElement : kControllerElements)
     {
@@ -532,6 +533,78 @@ namespace XidiTest
     }
   }
 
+  // Verifies correct construction of filter mapper objects in the nominal case of valid filter
+  // parameters and very simple non-null inner element mappers represented by valid strings.
+  TEST_CASE(MapperParser_MakeFilterMapper_Nominal)
+  {
+    constexpr std::wstring_view kFilterMapperTestStrings[] = {
+        L"Hysteresis, 5, Axis(X)",
+        L" ema , 50,  Button(10) ",
+        L"OneEuro, 99, Axis(RotX, +)",
+        L"oneeuro, 1, Pov(Up)",
+        L"PressRelease, 10, Button(2)"};
+    constexpr FilterMapper::EFilterType kExpectedFilterTypes[] = {
+        FilterMapper::EFilterType::Hysteresis,
+        FilterMapper::EFilterType::ExponentialMovingAverage,
+        FilterMapper::EFilterType::OneEuro,
+        FilterMapper::EFilterType::OneEuro,
+        FilterMapper::EFilterType::PressRelease};
+    constexpr unsigned int kExpectedStrengths[] = {5, 50, 99, 1, 10};
+    constexpr SElementIdentifier expectedElements[] = {
+        {.type = EElementType::Axis, .axis = EAxis::X},
+        {.type = EElementType::Button, .button = EButton::B10},
+        {.type = EElementType::Axis, .axis = EAxis::RotX},
+        {.type = EElementType::Pov},
+        {.type = EElementType::Button, .button = EButton::B2},
+    };
+    static_assert(
+        (_countof(expectedElements) == _countof(kFilterMapperTestStrings)) &&
+            (_countof(kExpectedFilterTypes) == _countof(kFilterMapperTestStrings)) &&
+            (_countof(kExpectedStrengths) == _countof(kFilterMapperTestStrings)),
+        "Mismatch between input and expected output array lengths.");
+
+    for (int i = 0; i < _countof(kFilterMapperTestStrings); ++i)
+    {
+      ElementMapperOrError maybeFilterMapper =
+          MapperParser::MakeFilterMapper(kFilterMapperTestStrings[i]);
+
+      TEST_ASSERT(true == maybeFilterMapper.HasValue());
+      TEST_ASSERT(1 == maybeFilterMapper.Value()->GetTargetElementCount());
+      TEST_ASSERT(expectedElements[i] == maybeFilterMapper.Value()->GetTargetElementAt(0));
+
+      const FilterMapper* filterMapper =
+          dynamic_cast<FilterMapper*>(maybeFilterMapper.Value().get());
+      TEST_ASSERT(nullptr != filterMapper);
+      TEST_ASSERT(kExpectedFilterTypes[i] == filterMapper->GetFilterType());
+      TEST_ASSERT(kExpectedStrengths[i] == filterMapper->GetStrength());
+    }
+  }
+
+  // Verifies correct failure to create filter mapper objects when the parameter strings are
+  // invalid.
+  TEST_CASE(MapperParser_MakeFilterMapper_Invalid)
+  {
+    constexpr std::wstring_view kFilterMapperTestStrings[] = {
+        L"",
+        L"Hysteresis",
+        L"Hysteresis, 5",
+        L"Median, 5, Axis(X)",
+        L"Hysteresis, 0, Axis(X)",
+        L"Hysteresis, 26, Axis(X)",
+        L"Ema, 100, Axis(X)",
+        L"Ema, strong, Axis(X)",
+        L"PressRelease, 11, Button(1)",
+        L"OneEuro, 50, Button(100)",
+        L"OneEuro, 50, Axis(X), Axis(Y)"};
+
+    for (auto& filterMapperTestString : kFilterMapperTestStrings)
+    {
+      ElementMapperOrError maybeFilterMapper =
+          MapperParser::MakeFilterMapper(filterMapperTestString);
+      TEST_ASSERT(false == maybeFilterMapper.HasValue());
+    }
+  }
+
   // Verifies correct construction of invert mapper objects in the nominal case of using very simple
   // non-null inner element mappers represented by valid strings.
   TEST_CASE(MapperParser_MakeInvertMapper_Nominal)
@@ -834,6 +907,70 @@ namespace XidiTest
     }
   }
 
+  // Verifies correct construction of turbo mapper objects in the nominal case of valid rates and
+  // very simple non-null inner element mappers represented by valid strings.
+  TEST_CASE(MapperParser_MakeTurboMapper_Nominal)
+  {
+    constexpr std::wstring_view kTurboMapperTestStrings[] = {
+        L"10, Button(1)", L" 1 ,  Button(10) ", L"30, Axis(RotX, +)"};
+    constexpr unsigned int kExpectedRates[] = {10, 1, 30};
+    constexpr SElementIdentifier expectedElements[] = {
+        {.type = EElementType::Button, .button = EButton::B1},
+        {.type = EElementType::Button, .button = EButton::B10},
+        {.type = EElementType::Axis, .axis = EAxis::RotX},
+    };
+    static_assert(
+        (_countof(expectedElements) == _countof(kTurboMapperTestStrings)) &&
+            (_countof(kExpectedRates) == _countof(kTurboMapperTestStrings)),
+        "Mismatch between input and expected output array lengths.");
+
+    for (int i = 0; i < _countof(kTurboMapperTestStrings); ++i)
+    {
+      ElementMapperOrError maybeTurboMapper =
+          MapperParser::MakeTurboMapper(kTurboMapperTestStrings[i]);
+
+      TEST_ASSERT(true == maybeTurboMapper.HasValue());
+      TEST_ASSERT(1 == maybeTurboMapper.Value()->GetTargetElementCount());
+      TEST_ASSERT(expectedElements[i] == maybeTurboMapper.Value()->GetTargetElementAt(0));
+
+      const TurboMapper* turboMapper = dynamic_cast<TurboMapper*>(maybeTurboMapper.Value().get());
+      TEST_ASSERT(nullptr != turboMapper);
+      TEST_ASSERT(kExpectedRates[i] == turboMapper->GetRate());
+    }
+  }
+
+  // Verifies correct construction of turbo mapper objects whose inner element mapper is a
+  // keyboard mapper.
+  TEST_CASE(MapperParser_MakeTurboMapper_Keyboard)
+  {
+    ElementMapperOrError maybeTurboMapper = MapperParser::MakeTurboMapper(L"15, Keyboard(10)");
+    TEST_ASSERT(true == maybeTurboMapper.HasValue());
+
+    const TurboMapper* turboMapper = dynamic_cast<TurboMapper*>(maybeTurboMapper.Value().get());
+    TEST_ASSERT(nullptr != turboMapper);
+    TEST_ASSERT(nullptr != dynamic_cast<const KeyboardMapper*>(turboMapper->GetElementMapper()));
+  }
+
+  // Verifies correct failure to create turbo mapper objects when the parameter strings are
+  // invalid.
+  TEST_CASE(MapperParser_MakeTurboMapper_Invalid)
+  {
+    constexpr std::wstring_view kTurboMapperTestStrings[] = {
+        L"",
+        L"10",
+        L"0, Button(1)",
+        L"31, Button(1)",
+        L"fast, Button(1)",
+        L"10, Button(100)",
+        L"10, Button(1), Button(2)"};
+
+    for (auto& turboMapperTestString : kTurboMapperTestStrings)
+    {
+      ElementMapperOrError maybeTurboMapper = MapperParser::MakeTurboMapper(turboMapperTestString);
+      TEST_ASSERT(false == maybeTurboMapper.HasValue());
+    }
+  }
+
   // Verifies correct parsing of single axis element mappers from a valid supplied input string.
   TEST_CASE(MapperParser_ParseSingleElementMapper_Axis)
   {
@@ -1303,6 +1440,77 @@ namespace XidiTest
     }
   }
 
+  // Verifies correct identification of valid and invalid chord strings.
+  TEST_CASE(MapperParser_ChordString)
+  {
+    constexpr std::pair<unsigned int, std::wstring_view> kChords[] = {
+        {0, L"Chord1"}, {3, L"Chord4"}, {7, L"Chord8"}};
+    constexpr std::wstring_view kInvalidChordStrings[] = {
+        L"Chord0", L"Chord9", L"chord1", L"ButtonA"};
+
+    for (const auto& chord : kChords)
+    {
+      TEST_ASSERT(true == MapperParser::IsChordStringValid(chord.second));
+      TEST_ASSERT(chord.first == MapperParser::FindChordIndex(chord.second));
+    }
+
+    for (auto chordString : kInvalidChordStrings)
+      TEST_ASSERT(false == MapperParser::IsChordStringValid(chordString));
+  }
+
+  // Verifies successful parsing of chord strings to chord objects.
+  TEST_CASE(MapperParser_ChordFromString_Valid)
+  {
+    constexpr std::wstring_view kTestStrings[] = {
+        L"ButtonLB, ButtonA, Button(3)",
+        L"  DpadUp ,ButtonStart,  ButtonGuide , Split(Button(1), Button(2))  "};
+
+    const Mapper::TElementMapMask expectedElements[] = {
+        ((1u << ELEMENT_MAP_INDEX_OF(buttonLB)) | (1u << ELEMENT_MAP_INDEX_OF(buttonA))),
+        ((1u << ELEMENT_MAP_INDEX_OF(dpadUp)) | (1u << ELEMENT_MAP_INDEX_OF(buttonStart)) |
+         (1u << ELEMENT_MAP_INDEX_OF(buttonGuide)))};
+    const std::unique_ptr<IElementMapper> expectedElementMappers[] = {
+        std::make_unique<ButtonMapper>(EButton::B3),
+        std::make_unique<SplitMapper>(
+            std::make_unique<ButtonMapper>(EButton::B1),
+            std::make_unique<ButtonMapper>(EButton::B2))};
+    static_assert(
+        _countof(expectedElements) == _countof(kTestStrings),
+        "Mismatch between input and expected output array lengths.");
+    static_assert(
+        _countof(expectedElementMappers) == _countof(kTestStrings),
+        "Mismatch between input and expected output array lengths.");
+
+    for (int i = 0; i < _countof(kTestStrings); ++i)
+    {
+      const ChordOrError maybeActualChord = MapperParser::ChordFromString(kTestStrings[i]);
+      TEST_ASSERT(true == maybeActualChord.HasValue());
+      TEST_ASSERT(maybeActualChord.Value().elements == expectedElements[i]);
+      VerifyElementMapperPointersAreEquivalent(
+          maybeActualChord.Value().elementMapper.get(), expectedElementMappers[i].get());
+    }
+  }
+
+  // Verifies failure to parse chord strings that are invalid.
+  TEST_CASE(MapperParser_ChordFromString_Invalid)
+  {
+    constexpr std::wstring_view kTestStrings[] = {
+        L"",
+        L"ButtonA, Button(1)",
+        L"ButtonA, ButtonB",
+        L"ButtonA, ButtonA, Button(1)",
+        L"ButtonA, TriggerLT, Button(1)",
+        L"ButtonA, UnknownElement, Button(1)",
+        L"ButtonA, ButtonB, UnknownMapperType",
+        L"ButtonA, ButtonB, Button(1"};
+
+    for (int i = 0; i < _countof(kTestStrings); ++i)
+    {
+      const ChordOrError maybeActualChord = MapperParser::ChordFromString(kTestStrings[i]);
+      TEST_ASSERT(true == maybeActualChord.HasError());
+    }
+  }
+
   // Verifies successful parsing of force feedback actuator strings to force feedback actuator
   // description objects.
   TEST_CASE(MapperParser_ForceFeedbackActuatorFromString_Valid)
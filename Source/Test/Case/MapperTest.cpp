@@ -15,6 +15,8 @@
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <unordered_set>
 #include <utility>
 
@@ -62,7 +64,8 @@ namespace XidiTest
        .buttonBack = std::make_unique<MockElementMapper>(),
        .buttonStart = std::make_unique<MockElementMapper>(),
        .buttonLS = std::make_unique<MockElementMapper>(),
-       .buttonRS = std::make_unique<MockElementMapper>()});
+       .buttonRS = std::make_unique<MockElementMapper>(),
+       .buttonGuide = std::make_unique<MockElementMapper>()});
 
   /// Creates a button set given a compile-time-constant list of buttons.
   /// @param [in] buttons Initializer list containing all of the desired buttons to be added to the
@@ -604,6 +607,337 @@ namespace XidiTest
     TEST_ASSERT(1 == numContributions);
   }
 
+  // Guide button
+  TEST_CASE(Mapper_Route_ButtonGuide)
+  {
+    constexpr bool kTestValue = true;
+    int numContributions = 0;
+
+    const Mapper controllerMapper(
+        {.buttonGuide = std::make_unique<MockElementMapper>(
+             MockElementMapper::EExpectedSource::Button, kTestValue, &numContributions)});
+    controllerMapper.MapStatePhysicalToVirtual(
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .button = ButtonSet({EPhysicalButton::Guide})},
+        kOpaqueSourceIdentifier);
+
+    TEST_ASSERT(1 == numContributions);
+  }
+
+  // Physical transform profile, left stick deadzone.
+  // A value inside the deadzone should be mapped to neutral when the profile is applied and passed
+  // through unchanged when no profile is applied.
+  TEST_CASE(Mapper_PhysicalTransformProfile_DeadzoneStickLeft)
+  {
+    constexpr int16_t kTestValue = 5000;
+    constexpr Mapper::SPhysicalTransformProfile kTestProfile = {
+        .circleToSquareFractionStickLeft = 0.0,
+        .circleToSquareFractionStickRight = 0.0,
+        .deadzonePercentStickLeft = 20,
+        .deadzonePercentStickRight = 0,
+        .deadzonePercentTriggerLT = 0,
+        .deadzonePercentTriggerRT = 0,
+        .saturationPercentStickLeft = 100,
+        .saturationPercentStickRight = 100,
+        .saturationPercentTriggerLT = 100,
+        .saturationPercentTriggerRT = 100};
+
+    const Mapper controllerMapper({.stickLeftX = std::make_unique<AxisMapper>(EAxis::X)});
+    const SPhysicalState physicalState = {
+        .deviceStatus = EPhysicalDeviceStatus::Ok, .stick = {kTestValue, 0, 0, 0}};
+
+    const SState stateWithoutProfile =
+        controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier);
+    TEST_ASSERT(kTestValue == stateWithoutProfile[EAxis::X]);
+
+    const SState stateWithProfile = controllerMapper.MapStatePhysicalToVirtual(
+        physicalState, kTestProfile, kOpaqueSourceIdentifier);
+    TEST_ASSERT(kAnalogValueNeutral == stateWithProfile[EAxis::X]);
+  }
+
+  // Incremental mapping, several element mappers interfering with one another on the same virtual
+  // controller elements. Across a sequence of physical controller states that change one or a few
+  // physical controller elements at a time, incremental mapping should always produce the same
+  // virtual controller state as full mapping.
+  TEST_CASE(Mapper_MapStatePhysicalToVirtualIncremental_MatchesFullMapping)
+  {
+    const Mapper controllerMapper(
+        {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+         .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
+         .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
+         .triggerLT = std::make_unique<AxisMapper>(EAxis::Z, EAxisDirection::Positive),
+         .triggerRT = std::make_unique<AxisMapper>(EAxis::Z, EAxisDirection::Negative),
+         .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+         .buttonB = std::make_unique<ButtonMapper>(EButton::B1),
+         .buttonX = std::make_unique<DigitalAxisMapper>(EAxis::X, EAxisDirection::Positive),
+         .buttonY = std::make_unique<PovMapper>(EPovDirection::Up)});
+
+    SPhysicalState physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    Mapper::SIncrementalMappingState mappingState;
+
+    auto verifyMapping = [&]() -> void
+    {
+      const SState expectedState =
+          controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier);
+      const SState actualState = controllerMapper.MapStatePhysicalToVirtualIncremental(
+          physicalState,
+          Mapper::GetDefaultPhysicalTransform(),
+          kOpaqueSourceIdentifier,
+          mappingState);
+      TEST_ASSERT(actualState == expectedState);
+    };
+
+    verifyMapping();
+
+    physicalState[EPhysicalStick::LeftX] = 20000;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::X] = true;
+    verifyMapping();
+
+    physicalState[EPhysicalStick::LeftX] = -30000;
+    physicalState[EPhysicalStick::LeftY] = 12345;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::A] = true;
+    physicalState[EPhysicalButton::B] = true;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::A] = false;
+    verifyMapping();
+
+    physicalState[EPhysicalTrigger::LT] = 200;
+    physicalState[EPhysicalTrigger::RT] = 100;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::DpadUp] = true;
+    physicalState[EPhysicalButton::Y] = true;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::DpadUp] = false;
+    physicalState[EPhysicalTrigger::LT] = 0;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::X] = false;
+    physicalState[EPhysicalButton::B] = false;
+    verifyMapping();
+  }
+
+  // Incremental mapping, element mappers that do and do not have side effects.
+  // Element mappers whose physical controller elements do not change should not be invoked, except
+  // that all element mappers with possible side effects should be invoked together whenever any of
+  // them has a changed physical controller element. Mock element mappers are conservatively
+  // treated as having side effects. Resetting the incremental mapping state should cause all
+  // element mappers to be invoked again.
+  TEST_CASE(Mapper_MapStatePhysicalToVirtualIncremental_SkipsUnchangedElements)
+  {
+    int numStickContributions = 0;
+    int numTriggerContributions = 0;
+
+    const Mapper controllerMapper(
+        {.stickLeftX = std::make_unique<MockElementMapper>(
+             MockElementMapper::EExpectedSource::Analog, std::nullopt, &numStickContributions),
+         .triggerLT = std::make_unique<MockElementMapper>(
+             MockElementMapper::EExpectedSource::Trigger, std::nullopt, &numTriggerContributions),
+         .buttonA = std::make_unique<ButtonMapper>(EButton::B1)});
+
+    SPhysicalState physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    Mapper::SIncrementalMappingState mappingState;
+
+    auto doMapping = [&]() -> SState
+    {
+      return controllerMapper.MapStatePhysicalToVirtualIncremental(
+          physicalState,
+          Mapper::GetDefaultPhysicalTransform(),
+          kOpaqueSourceIdentifier,
+          mappingState);
+    };
+
+    doMapping();
+    TEST_ASSERT(1 == numStickContributions);
+    TEST_ASSERT(1 == numTriggerContributions);
+
+    doMapping();
+    TEST_ASSERT(1 == numStickContributions);
+    TEST_ASSERT(1 == numTriggerContributions);
+
+    physicalState[EPhysicalButton::A] = true;
+    TEST_ASSERT(true == doMapping()[EButton::B1]);
+    TEST_ASSERT(1 == numStickContributions);
+    TEST_ASSERT(1 == numTriggerContributions);
+
+    physicalState[EPhysicalTrigger::LT] = 100;
+    TEST_ASSERT(true == doMapping()[EButton::B1]);
+    TEST_ASSERT(2 == numStickContributions);
+    TEST_ASSERT(2 == numTriggerContributions);
+
+    mappingState.Reset();
+    TEST_ASSERT(true == doMapping()[EButton::B1]);
+    TEST_ASSERT(3 == numStickContributions);
+    TEST_ASSERT(3 == numTriggerContributions);
+  }
+
+  // Maps a variety of physical controller states using each built-in mapper, which uses its
+  // specialized mapping function, and using an unnamed mapper built from a clone of each built-in
+  // mapper's element map, which uses its compiled element mapper program. Verifies that both
+  // produce exactly the same virtual controller state.
+  TEST_CASE(Mapper_MapStatePhysicalToVirtual_BuiltinMatchesGeneric)
+  {
+    constexpr std::wstring_view kBuiltinMapperNames[] = {
+        L"StandardGamepad",
+        L"DigitalGamepad",
+        L"ExtendedGamepad",
+        L"XInputNative",
+        L"XInputSharedTriggers"};
+
+    for (const auto builtinMapperName : kBuiltinMapperNames)
+    {
+      const Mapper* const builtinMapper = Mapper::GetByName(builtinMapperName);
+      TEST_ASSERT(nullptr != builtinMapper);
+
+      Mapper::UElementMap clonedElementMap = builtinMapper->CloneElementMap();
+      const Mapper genericMapper(std::move(clonedElementMap.named));
+      uint32_t pseudoRandomValue = 1;
+
+      for (int i = 0; i < 1024; ++i)
+      {
+        SPhysicalState physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+
+        for (int stick = 0; stick < static_cast<int>(EPhysicalStick::Count); ++stick)
+        {
+          pseudoRandomValue = (pseudoRandomValue * 1103515245) + 12345;
+          physicalState[static_cast<EPhysicalStick>(stick)] =
+              static_cast<int16_t>(pseudoRandomValue >> 16);
+        }
+
+        for (int trigger = 0; trigger < static_cast<int>(EPhysicalTrigger::Count); ++trigger)
+        {
+          pseudoRandomValue = (pseudoRandomValue * 1103515245) + 12345;
+          physicalState[static_cast<EPhysicalTrigger>(trigger)] =
+              static_cast<uint8_t>(pseudoRandomValue >> 16);
+        }
+
+        for (int button = 0; button < static_cast<int>(EPhysicalButton::Count); ++button)
+        {
+          pseudoRandomValue = (pseudoRandomValue * 1103515245) + 12345;
+          physicalState[static_cast<EPhysicalButton>(button)] =
+              (0 != (pseudoRandomValue & 0x00010000));
+        }
+
+        const SState expectedState =
+            genericMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier);
+        const SState actualState =
+            builtinMapper->MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier);
+        TEST_ASSERT(actualState == expectedState);
+      }
+    }
+  }
+
+  // Holds a chord of two buttons, each of which is also mapped individually, and releases it one
+  // button at a time. Verifies that the chord's element mapper receives a press only while both
+  // buttons are held, that neither button contributes individually while the chord is held, and
+  // that a button stays suppressed until it is released after having been part of a held chord.
+  TEST_CASE(Mapper_Chord_Nominal)
+  {
+    Mapper::TChords chords;
+    chords[0] = {
+        .elements =
+            ((1u << ELEMENT_MAP_INDEX_OF(buttonLB)) | (1u << ELEMENT_MAP_INDEX_OF(buttonA))),
+        .elementMapper = std::make_unique<ButtonMapper>(EButton::B3)};
+
+    const Mapper controllerMapper(
+        L"",
+        {.buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+         .buttonLB = std::make_unique<ButtonMapper>(EButton::B2)},
+        std::move(chords));
+
+    SPhysicalState physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    SState expectedState = {};
+
+    physicalState[EPhysicalButton::LB] = true;
+    expectedState[EButton::B2] = true;
+    TEST_ASSERT(
+        controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier) ==
+        expectedState);
+
+    physicalState[EPhysicalButton::A] = true;
+    expectedState = {};
+    expectedState[EButton::B3] = true;
+    TEST_ASSERT(
+        controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier) ==
+        expectedState);
+
+    physicalState[EPhysicalButton::LB] = false;
+    expectedState = {};
+    TEST_ASSERT(
+        controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier) ==
+        expectedState);
+
+    physicalState[EPhysicalButton::A] = false;
+    TEST_ASSERT(
+        controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier) ==
+        expectedState);
+
+    physicalState[EPhysicalButton::A] = true;
+    expectedState[EButton::B1] = true;
+    TEST_ASSERT(
+        controllerMapper.MapStatePhysicalToVirtual(physicalState, kOpaqueSourceIdentifier) ==
+        expectedState);
+  }
+
+  // Holds and releases a chord while mapping both fully and incrementally, using separate physical
+  // controllers so that each type of mapping has its own chord state. Verifies that both types of
+  // mapping produce exactly the same virtual controller state.
+  TEST_CASE(Mapper_Chord_IncrementalMatchesFullMapping)
+  {
+    constexpr uint32_t kFullMappingSourceIdentifier = 1;
+    constexpr uint32_t kIncrementalMappingSourceIdentifier = 2;
+
+    Mapper::TChords chords;
+    chords[3] = {
+        .elements = ((1u << ELEMENT_MAP_INDEX_OF(dpadUp)) | (1u << ELEMENT_MAP_INDEX_OF(buttonB))),
+        .elementMapper = std::make_unique<AxisMapper>(EAxis::Z)};
+
+    const Mapper controllerMapper(
+        L"",
+        {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+         .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
+         .buttonB = std::make_unique<ButtonMapper>(EButton::B2)},
+        std::move(chords));
+
+    SPhysicalState physicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    Mapper::SIncrementalMappingState mappingState;
+
+    auto verifyMapping = [&]() -> void
+    {
+      const SState expectedState =
+          controllerMapper.MapStatePhysicalToVirtual(physicalState, kFullMappingSourceIdentifier);
+      const SState actualState = controllerMapper.MapStatePhysicalToVirtualIncremental(
+          physicalState,
+          Mapper::GetDefaultPhysicalTransform(),
+          kIncrementalMappingSourceIdentifier,
+          mappingState);
+      TEST_ASSERT(actualState == expectedState);
+    };
+
+    verifyMapping();
+
+    physicalState[EPhysicalButton::DpadUp] = true;
+    verifyMapping();
+
+    physicalState[EPhysicalStick::LeftX] = 10000;
+    physicalState[EPhysicalButton::B] = true;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::DpadUp] = false;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::B] = false;
+    verifyMapping();
+
+    physicalState[EPhysicalButton::B] = true;
+    verifyMapping();
+  }
+
   // Empty mapper.
   // Nothing should be present on the virtual controller.
   TEST_CASE(Mapper_Capabilities_EmptyMapper)
@@ -667,6 +1001,30 @@ namespace XidiTest
     TEST_ASSERT(actualCapabilities == expectedCapabilities);
   }
 
+  // Mapper with buttons, one of which is written only by the element mapper of a chord.
+  // Virtual controller should have only buttons, and the number present is based on the highest
+  // button to which any element mapper writes, including those of chords.
+  TEST_CASE(Mapper_Capabilities_Chord)
+  {
+    constexpr SCapabilities expectedCapabilities =
+        MakeExpectedCapabilities({.numAxes = 0, .numButtons = 8, .hasPov = false});
+
+    Mapper::TChords chords;
+    chords[1] = {
+        .elements =
+            ((1u << ELEMENT_MAP_INDEX_OF(buttonBack)) | (1u << ELEMENT_MAP_INDEX_OF(buttonStart))),
+        .elementMapper = std::make_unique<ButtonMapper>(EButton::B8)};
+
+    const Mapper mapper(
+        L"",
+        {.buttonBack = std::make_unique<ButtonMapper>(EButton::B3),
+         .buttonStart = std::make_unique<ButtonMapper>(EButton::B4)},
+        std::move(chords));
+
+    const SCapabilities actualCapabilities = mapper.GetCapabilities();
+    TEST_ASSERT(actualCapabilities == expectedCapabilities);
+  }
+
   // Mapper with only axes.
   // Virtual controller should have only axes based on the axes to which the element mappers write.
   TEST_CASE(Mapper_Capabilities_MultipleAxes)
@@ -0,0 +1,145 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MotionMapperTest.cpp
+ *   Unit tests for mapping physical controller motion to virtual controller elements.
+ **************************************************************************************************/
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ElementMapper.h"
+#include "Mapper.h"
+#include "MockElementMapper.h"
+#include "MotionMapper.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller;
+
+  /// Controller state used for tests that need such an instance but do not care about its contents.
+  static SState unusedControllerState;
+
+  // Verifies that integrating an empty batch of motion sensor readings produces no motion and
+  // leaves the previous timestamp unchanged.
+  TEST_CASE(MotionMapper_IntegrateSamples_Empty)
+  {
+    int64_t previousTimestamp = 1000;
+
+    const SPhysicalMotion actualMotion =
+        MotionMapper::IntegrateSamples(std::span<const SPhysicalMotionSample>(), previousTimestamp);
+    TEST_ASSERT(SPhysicalMotion() == actualMotion);
+    TEST_ASSERT(1000 == previousTimestamp);
+  }
+
+  // Verifies that integrating a batch of motion sensor readings weights each reading by the time
+  // that elapsed since the reading before it.
+  TEST_CASE(MotionMapper_IntegrateSamples_Weighted)
+  {
+    constexpr SPhysicalMotionSample kSamples[] = {
+        {.timestamp = 1100, .angularVelocity = {100, -400, 0}},
+        {.timestamp = 1400, .angularVelocity = {500, 400, 80}}};
+    constexpr SPhysicalMotion kExpectedMotion = {.angularVelocity = {400, 200, 60}};
+
+    int64_t previousTimestamp = 1000;
+
+    const SPhysicalMotion actualMotion =
+        MotionMapper::IntegrateSamples(kSamples, previousTimestamp);
+    TEST_ASSERT(kExpectedMotion == actualMotion);
+    TEST_ASSERT(1400 == previousTimestamp);
+  }
+
+  // Verifies that integrating a batch of motion sensor readings whose predecessor is unknown and
+  // whose timestamps do not advance averages the readings.
+  TEST_CASE(MotionMapper_IntegrateSamples_NoTiming)
+  {
+    constexpr SPhysicalMotionSample kSamples[] = {
+        {.timestamp = 0, .angularVelocity = {100, 200, -300}},
+        {.timestamp = 0, .angularVelocity = {300, 400, -100}}};
+    constexpr SPhysicalMotion kExpectedMotion = {.angularVelocity = {200, 300, -200}};
+
+    int64_t previousTimestamp = 0;
+
+    const SPhysicalMotion actualMotion =
+        MotionMapper::IntegrateSamples(kSamples, previousTimestamp);
+    TEST_ASSERT(kExpectedMotion == actualMotion);
+  }
+
+  // Verifies that motion is converted to analog values proportional to angular velocity, that
+  // faster motion saturates, and that axes without element mappers are ignored.
+  TEST_CASE(MotionMapper_ContributeFromMotion_Nominal)
+  {
+    constexpr unsigned int kFullScaleDegreesPerSecond = 200;
+    constexpr SPhysicalMotion kMotion = {
+        .angularVelocity = {
+            (int16_t)(-50 * kPhysicalMotionUnitsPerDegreePerSecond),
+            (int16_t)(400 * kPhysicalMotionUnitsPerDegreePerSecond),
+            (int16_t)(100 * kPhysicalMotionUnitsPerDegreePerSecond)}};
+
+    int pitchContributionCount = 0;
+    int yawContributionCount = 0;
+
+    MotionMapper::TAxisMappers axisMappers;
+    axisMappers[(int)EPhysicalMotionAxis::Pitch] = std::make_unique<MockElementMapper>(
+        MockElementMapper::EExpectedSource::Analog,
+        (int16_t)(kAnalogValueMin / 4),
+        &pitchContributionCount);
+    axisMappers[(int)EPhysicalMotionAxis::Yaw] = std::make_unique<MockElementMapper>(
+        MockElementMapper::EExpectedSource::Analog,
+        (int16_t)kAnalogValueMax,
+        &yawContributionCount);
+
+    const MotionMapper mapper(std::move(axisMappers), kFullScaleDegreesPerSecond);
+    TEST_ASSERT(nullptr == mapper.GetAxisMapper(EPhysicalMotionAxis::Roll));
+
+    mapper.ContributeFromMotion(unusedControllerState, kMotion, 0);
+    TEST_ASSERT(1 == pitchContributionCount);
+    TEST_ASSERT(1 == yawContributionCount);
+  }
+
+  // Verifies that motion contributions use source identifiers that do not collide with those used
+  // for the element map of a mapper or with those of other physical controllers.
+  TEST_CASE(MotionMapper_SourceIdentifierForAxis_Distinct)
+  {
+    for (uint32_t controller = 0; controller < 2; ++controller)
+    {
+      for (int i = 0; i < (int)EPhysicalMotionAxis::Count; ++i)
+      {
+        const uint32_t sourceIdentifier =
+            MotionMapper::SourceIdentifierForAxis(controller, (EPhysicalMotionAxis)i);
+        TEST_ASSERT(
+            controller == Mapper::SourceControllerIdentifierFromSourceIdentifier(sourceIdentifier));
+
+        for (uint32_t element = 0; element < Mapper::kElementCount; ++element)
+          TEST_ASSERT(
+              sourceIdentifier != Mapper::SourceIdentifierForElementMapper(controller, element));
+      }
+    }
+  }
+
+  // Verifies that neutral contributions are forwarded to all element mappers present.
+  TEST_CASE(MotionMapper_ContributeNeutral_Nominal)
+  {
+    int contributionCount = 0;
+
+    MotionMapper::TAxisMappers axisMappers;
+    for (auto& axisMapper : axisMappers)
+      axisMapper = std::make_unique<MockElementMapper>(
+          MockElementMapper::EExpectedSource::Neutral, false, &contributionCount);
+
+    const MotionMapper mapper(
+        std::move(axisMappers), MotionMapper::kDefaultFullScaleDegreesPerSecond);
+    mapper.ContributeNeutral(unusedControllerState, 0);
+    TEST_ASSERT((int)EPhysicalMotionAxis::Count == contributionCount);
+  }
+} // namespace XidiTest
@@ -234,6 +234,20 @@ namespace XidiTest
     }
   }
 
+  // Verifies that sine wave amplitudes are exactly equal to the rounded sine of the phase for
+  // every whole phase value in a cycle, as well as for some phase values that are not whole.
+  TEST_CASE(PeriodicEffect_WaveformAmplitude_SineWaveExact)
+  {
+    SineWaveEffect effect;
+
+    for (int phase = 0; phase <= 36000; ++phase)
+      TEST_ASSERT(
+          TrigonometrySine((TEffectValue)phase) == effect.WaveformAmplitude((TEffectValue)phase));
+
+    for (TEffectValue phase : {0.5f, 4500.25f, 35999.5f, 36000.5f, 40000.0f, -4500.0f})
+      TEST_ASSERT(TrigonometrySine(phase) == effect.WaveformAmplitude(phase));
+  }
+
   // Verifies correct waveform amplitude computations for various points in the waveform cycle.
   // This test case is for square wave effects.
   TEST_CASE(PeriodicEffect_WaveformAmplitude_SquareWave)
@@ -11,7 +11,9 @@
 
 #include "StateChangeEventBuffer.h"
 
+#include <atomic>
 #include <cstdint>
+#include <thread>
 
 #include <Infra/Test/TestCase.h>
 
@@ -272,6 +274,279 @@ namespace XidiTest
     TEST_ASSERT(0 == testEventBuffer.GetCount());
   }
 
+  // Verifies that the oldest events can be identified in bulk, including when they wrap around the
+  // end of the underlying storage, and that popping them removes exactly those events.
+  TEST_CASE(StateChangeEventBuffer_PeekAndPopSpans)
+  {
+    constexpr uint32_t kEventBufferCapacity = 9;
+    constexpr uint32_t kNumEventsToPeek = 5;
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(kEventBufferCapacity);
+
+    // Repeated appending and popping moves the oldest event around the underlying storage, so
+    // at some point the identified events are split into two spans.
+    bool sawSplitSpans = false;
+    for (int i = 0; i < _countof(kTestEventData); ++i)
+    {
+      for (int j = 0; j < kNumEventsToPeek; ++j)
+        testEventBuffer.AppendEvent(kTestEventData[(i + j) % _countof(kTestEventData)], j);
+
+      const StateChangeEventBuffer::SEventSpans kEventSpans =
+          testEventBuffer.PeekOldestEvents(kNumEventsToPeek);
+      TEST_ASSERT(kNumEventsToPeek == kEventSpans.GetCount());
+      TEST_ASSERT(true == testEventBuffer.AreEventsIntact(kEventSpans));
+      if (false == kEventSpans.newer.empty()) sawSplitSpans = true;
+
+      for (int j = 0; j < kNumEventsToPeek; ++j)
+      {
+        const StateChangeEventBuffer::SEvent& event =
+            ((j < kEventSpans.older.size()) ? kEventSpans.older[j]
+                                            : kEventSpans.newer[j - kEventSpans.older.size()]);
+        TEST_ASSERT(kTestEventData[(i + j) % _countof(kTestEventData)] == event.data);
+        TEST_ASSERT((uint32_t)j == event.timestamp);
+      }
+
+      testEventBuffer.PopEvents(kEventSpans);
+      TEST_ASSERT(0 == testEventBuffer.GetCount());
+    }
+
+    TEST_ASSERT(true == sawSplitSpans);
+  }
+
+  // Verifies that popping previously-identified events does not remove any newer events, even if
+  // some of the identified events were already discarded due to overflow in the meantime.
+  TEST_CASE(StateChangeEventBuffer_PopSpansAfterOverflow)
+  {
+    constexpr uint32_t kEventBufferCapacity = 5;
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(kEventBufferCapacity);
+
+    for (uint32_t i = 0; i < (kEventBufferCapacity - 1); ++i)
+      testEventBuffer.AppendEvent(kTestEventData[i], i);
+
+    const StateChangeEventBuffer::SEventSpans kEventSpans = testEventBuffer.PeekOldestEvents(2);
+    TEST_ASSERT(2 == kEventSpans.GetCount());
+
+    // Appending one more event discards the oldest event, which is one of the events identified.
+    testEventBuffer.AppendEvent(kTestEventData[kEventBufferCapacity], kEventBufferCapacity);
+    TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+
+    testEventBuffer.PopEvents(kEventSpans);
+    TEST_ASSERT(false == testEventBuffer.IsOverflowed());
+    TEST_ASSERT((kEventBufferCapacity - 2) == testEventBuffer.GetCount());
+    TEST_ASSERT(kTestEventData[2] == testEventBuffer[0].data);
+  }
+
+  // Verifies that axis events are merged into the most recent unread event for the same axis, but
+  // only as long as no button or POV event was appended after that event. Merged events keep their
+  // original position and sequence number.
+  TEST_CASE(StateChangeEventBuffer_CoalesceAxisEvents)
+  {
+    constexpr uint32_t kEventBufferCapacity = 16;
+    constexpr StateChangeEventBuffer::SEventData kEventAxisX1 = {
+        .element = {.type = EElementType::Axis, .axis = EAxis::X}, .value = {.axis = 100}};
+    constexpr StateChangeEventBuffer::SEventData kEventAxisX2 = {
+        .element = {.type = EElementType::Axis, .axis = EAxis::X}, .value = {.axis = 200}};
+    constexpr StateChangeEventBuffer::SEventData kEventAxisX3 = {
+        .element = {.type = EElementType::Axis, .axis = EAxis::X}, .value = {.axis = 300}};
+    constexpr StateChangeEventBuffer::SEventData kEventAxisY = {
+        .element = {.type = EElementType::Axis, .axis = EAxis::Y}, .value = {.axis = 400}};
+    constexpr StateChangeEventBuffer::SEventData kEventButton = {
+        .element = {.type = EElementType::Button, .button = EButton::B1},
+        .value = {.button = true}};
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(kEventBufferCapacity);
+    TEST_ASSERT(false == testEventBuffer.CoalesceAxisEvent(kEventAxisX1));
+
+    testEventBuffer.AppendEvent(kEventAxisX1, kTimestamp);
+    testEventBuffer.AppendEvent(kEventAxisY, kTimestamp);
+    const uint32_t kSequenceAxisX = testEventBuffer[0].sequence;
+
+    TEST_ASSERT(true == testEventBuffer.CoalesceAxisEvent(kEventAxisX2));
+    TEST_ASSERT(2 == testEventBuffer.GetCount());
+    TEST_ASSERT(kEventAxisX2 == testEventBuffer[0].data);
+    TEST_ASSERT(kSequenceAxisX == testEventBuffer[0].sequence);
+    TEST_ASSERT(kEventAxisY == testEventBuffer[1].data);
+
+    TEST_ASSERT(false == testEventBuffer.CoalesceAxisEvent(kEventButton));
+    testEventBuffer.AppendEvent(kEventButton, kTimestamp);
+
+    TEST_ASSERT(false == testEventBuffer.CoalesceAxisEvent(kEventAxisX3));
+    testEventBuffer.AppendEvent(kEventAxisX3, kTimestamp);
+    TEST_ASSERT(4 == testEventBuffer.GetCount());
+    TEST_ASSERT(kEventAxisX2 == testEventBuffer[0].data);
+    TEST_ASSERT(kEventButton == testEventBuffer[2].data);
+    TEST_ASSERT(kEventAxisX3 == testEventBuffer[3].data);
+  }
+
+  // Verifies that sequence numbers follow the global order in which events are appended, even when
+  // multiple event buffers append events in an interleaved manner, so that applications merging
+  // events from several devices by sequence number see them in the order they happened.
+  TEST_CASE(StateChangeEventBuffer_SequenceAcrossBuffers)
+  {
+    constexpr uint32_t kEventBufferCapacity = (1 + _countof(kTestEventData));
+
+    StateChangeEventBuffer testEventBuffers[2];
+    for (auto& testEventBuffer : testEventBuffers)
+      testEventBuffer.SetCapacity(kEventBufferCapacity);
+
+    for (const auto& testEventData : kTestEventData)
+    {
+      for (auto& testEventBuffer : testEventBuffers)
+        testEventBuffer.AppendEvent(testEventData, kTimestamp);
+    }
+
+    for (const auto& testEventBuffer : testEventBuffers)
+    {
+      for (uint32_t i = 1; i < testEventBuffer.GetCount(); ++i)
+        TEST_ASSERT(testEventBuffer[i].sequence > testEventBuffer[i - 1].sequence);
+    }
+
+    TEST_ASSERT(testEventBuffers[0].GetCount() == testEventBuffers[1].GetCount());
+    for (uint32_t i = 0; i < testEventBuffers[0].GetCount(); ++i)
+    {
+      TEST_ASSERT(testEventBuffers[1][i].sequence > testEventBuffers[0][i].sequence);
+
+      if ((i + 1) < testEventBuffers[0].GetCount())
+        TEST_ASSERT(testEventBuffers[0][i + 1].sequence > testEventBuffers[1][i].sequence);
+    }
+  }
+
+  // Verifies that one producer and one consumer can operate on the event buffer concurrently. The
+  // producer appends far more events than the buffer can hold while the consumer continuously
+  // pops events. The consumer should never observe more events than the buffer can hold, and once
+  // the producer is finished the remaining events should be the most recent ones, in order.
+  TEST_CASE(StateChangeEventBuffer_ConcurrentProducerAndConsumer)
+  {
+    constexpr uint32_t kEventBufferCapacity = 37;
+    constexpr uint32_t kNumEventsToAppend = 100000;
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(kEventBufferCapacity);
+
+    std::atomic<bool> producerFinished = false;
+    std::thread producer(
+        [&testEventBuffer, &producerFinished]() -> void
+        {
+          for (uint32_t i = 0; i < kNumEventsToAppend; ++i)
+            testEventBuffer.AppendEvent(kTestEventData[i % _countof(kTestEventData)], i);
+
+          producerFinished = true;
+        });
+
+    uint32_t numEventsPopped = 0;
+    while (false == producerFinished)
+    {
+      const uint32_t eventCount = testEventBuffer.GetCount();
+      TEST_ASSERT(eventCount < kEventBufferCapacity);
+
+      if (0 != eventCount)
+      {
+        testEventBuffer.PopOldestEvents(1);
+        numEventsPopped += 1;
+      }
+    }
+
+    producer.join();
+
+    const uint32_t finalEventCount = testEventBuffer.GetCount();
+    TEST_ASSERT(finalEventCount < kEventBufferCapacity);
+    TEST_ASSERT(numEventsPopped + finalEventCount <= kNumEventsToAppend);
+
+    for (uint32_t i = 0; i < finalEventCount; ++i)
+    {
+      const uint32_t expectedTimestamp = (kNumEventsToAppend - finalEventCount) + i;
+      TEST_ASSERT(expectedTimestamp == testEventBuffer[i].timestamp);
+    }
+  }
+
+  // Verifies that event storage is not allocated until events are appended, that it grows
+  // geometrically while retaining its contents, and that it is released when the buffer is
+  // disabled.
+  TEST_CASE(StateChangeEventBuffer_LazyStorage)
+  {
+    constexpr uint32_t kNumEventsToAppend = (3 * StateChangeEventBuffer::kEventStorageSlotCountMin);
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(StateChangeEventBuffer::kEventBufferCapacityMax);
+    TEST_ASSERT(0 == testEventBuffer.GetStorageSlotCount());
+
+    testEventBuffer.AppendEvent(kTestEventData[0], 0);
+    TEST_ASSERT(
+        StateChangeEventBuffer::kEventStorageSlotCountMin == testEventBuffer.GetStorageSlotCount());
+
+    for (uint32_t i = 1; i < kNumEventsToAppend; ++i)
+      testEventBuffer.AppendEvent(kTestEventData[i % _countof(kTestEventData)], i);
+
+    TEST_ASSERT(
+        (4 * StateChangeEventBuffer::kEventStorageSlotCountMin) ==
+        testEventBuffer.GetStorageSlotCount());
+    TEST_ASSERT(kNumEventsToAppend == testEventBuffer.GetCount());
+    TEST_ASSERT(false == testEventBuffer.IsOverflowed());
+
+    for (uint32_t i = 0; i < kNumEventsToAppend; ++i)
+    {
+      TEST_ASSERT(kTestEventData[i % _countof(kTestEventData)] == testEventBuffer[i].data);
+      TEST_ASSERT(i == testEventBuffer[i].timestamp);
+    }
+
+    testEventBuffer.SetCapacity(0);
+    TEST_ASSERT(0 == testEventBuffer.GetStorageSlotCount());
+  }
+
+  // Verifies that event storage never grows beyond what the declared capacity requires.
+  TEST_CASE(StateChangeEventBuffer_LazyStorageLimitedByCapacity)
+  {
+    constexpr uint32_t kEventBufferCapacity = 5;
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(kEventBufferCapacity);
+
+    for (const auto& testEventData : kTestEventData)
+      testEventBuffer.AppendEvent(testEventData, kTimestamp);
+
+    TEST_ASSERT(8 == testEventBuffer.GetStorageSlotCount());
+    TEST_ASSERT((kEventBufferCapacity - 1) == testEventBuffer.GetCount());
+  }
+
+  // Verifies that storage for an overflowing buffer whose consumer has been inactive for long
+  // enough is considered idle, that releasing it discards events while keeping the overflow
+  // condition, and that events are only appended again once the consumer is active.
+  TEST_CASE(StateChangeEventBuffer_ReleaseIdleStorage)
+  {
+    constexpr uint32_t kEventBufferCapacity = 4;
+    constexpr uint32_t kIdleTimestamp = StateChangeEventBuffer::kEventStorageIdleMilliseconds;
+
+    StateChangeEventBuffer testEventBuffer;
+    testEventBuffer.SetCapacity(kEventBufferCapacity);
+
+    for (const auto& testEventData : kTestEventData)
+      testEventBuffer.AppendEvent(testEventData, kTimestamp);
+
+    TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+    TEST_ASSERT(false == testEventBuffer.CheckStorageIdle(kIdleTimestamp - 1));
+    TEST_ASSERT(true == testEventBuffer.CheckStorageIdle(kIdleTimestamp));
+
+    testEventBuffer.ReleaseIdleStorage();
+    TEST_ASSERT(0 == testEventBuffer.GetStorageSlotCount());
+    TEST_ASSERT(0 == testEventBuffer.GetCount());
+    TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+
+    testEventBuffer.AppendEvent(kTestEventData[0], kIdleTimestamp);
+    TEST_ASSERT(0 == testEventBuffer.GetStorageSlotCount());
+    TEST_ASSERT(0 == testEventBuffer.GetCount());
+    TEST_ASSERT(true == testEventBuffer.IsOverflowed());
+
+    testEventBuffer.PopOldestEvents(1);
+    testEventBuffer.AppendEvent(kTestEventData[1], kIdleTimestamp);
+    TEST_ASSERT(1 == testEventBuffer.GetCount());
+    TEST_ASSERT(kTestEventData[1] == testEventBuffer[0].data);
+    TEST_ASSERT(false == testEventBuffer.CheckStorageIdle(2 * kIdleTimestamp));
+  }
+
   // Verifies that the event buffer correctly reports is enabled and disabled status based on its
   // capacity.
   TEST_CASE(StateChangeBuffer_EnableAndDisable)
@@ -0,0 +1,290 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file SteadyStateAllocationTest.cpp
+ *   Unit tests that verify that frequently-executed code paths do not allocate dynamic memory
+ *   once they reach a steady state.
+ **************************************************************************************************/
+
+#include <bitset>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+
+#include <Infra/Test/TestCase.h>
+
+#include "AllocationTracker.h"
+#include "ApiDirectInput.h"
+#include "ApiGUID.h"
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "DataFormat.h"
+#include "ElementMapper.h"
+#include "ForceFeedbackDevice.h"
+#include "Mapper.h"
+#include "MockForceFeedbackEffect.h"
+#include "MockPhysicalController.h"
+#include "VirtualController.h"
+#include "VirtualDirectInputDevice.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+  using ::Xidi::Controller::AxisMapper;
+  using ::Xidi::Controller::ButtonMapper;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::EButton;
+  using ::Xidi::Controller::EPhysicalButton;
+  using ::Xidi::Controller::EPhysicalDeviceStatus;
+  using ::Xidi::Controller::EPovDirection;
+  using ::Xidi::Controller::ForceFeedback::Device;
+  using ::Xidi::Controller::ForceFeedback::TEffectTimeMs;
+  using ::Xidi::Controller::Mapper;
+  using ::Xidi::Controller::PovMapper;
+  using ::Xidi::Controller::SPhysicalState;
+  using ::Xidi::Controller::TControllerIdentifier;
+  using ::Xidi::Controller::VirtualController;
+
+  /// Controller identifier used throughout these test cases.
+  static constexpr TControllerIdentifier kTestControllerIdentifier = 0;
+
+  /// Number of times each code path under test is executed after reaching a steady state.
+  static constexpr int kTestIterationCount = 256;
+
+  /// Test mapper used throughout these test cases.
+  /// Describes a virtual controller with 4 axes, 4 buttons, and a POV.
+  static const Mapper kTestMapper(
+      {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+       .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
+       .stickRightX = std::make_unique<AxisMapper>(EAxis::RotX),
+       .stickRightY = std::make_unique<AxisMapper>(EAxis::RotY),
+       .dpadUp = std::make_unique<PovMapper>(EPovDirection::Up),
+       .dpadDown = std::make_unique<PovMapper>(EPovDirection::Down),
+       .dpadLeft = std::make_unique<PovMapper>(EPovDirection::Left),
+       .dpadRight = std::make_unique<PovMapper>(EPovDirection::Right),
+       .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+       .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
+       .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
+       .buttonY = std::make_unique<ButtonMapper>(EButton::B4)});
+
+  /// Data packet structure definition used for retrieving device state.
+  struct STestDataPacket
+  {
+    TAxisValue axisX;
+    TAxisValue axisY;
+    EPovValue pov;
+    TButtonValue button[4];
+  };
+
+  static_assert(
+      0 == (sizeof(STestDataPacket) % 4), "Test data packet size must be divisible by 4.");
+
+  /// Object format specification for #STestDataPacket.
+  static DIOBJECTDATAFORMAT testObjectFormatSpec[] = {
+      {.pguid = &GUID_XAxis,
+       .dwOfs = offsetof(STestDataPacket, axisX),
+       .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_YAxis,
+       .dwOfs = offsetof(STestDataPacket, axisY),
+       .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_POV,
+       .dwOfs = offsetof(STestDataPacket, pov),
+       .dwType = DIDFT_POV | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(STestDataPacket, button[0]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(STestDataPacket, button[1]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(STestDataPacket, button[2]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(STestDataPacket, button[3]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0}};
+
+  /// Complete application data format specification for #STestDataPacket.
+  static constexpr DIDATAFORMAT kTestFormatSpec = {
+      .dwSize = sizeof(DIDATAFORMAT),
+      .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+      .dwFlags = DIDF_ABSAXIS,
+      .dwDataSize = sizeof(STestDataPacket),
+      .dwNumObjs = _countof(testObjectFormatSpec),
+      .rgodf = testObjectFormatSpec};
+
+  /// Creates a button set given a compile-time-constant list of buttons.
+  /// @param [in] buttons Initializer list containing all of the desired buttons to be added to the
+  /// set.
+  /// @return Button set representation of the button list.
+  static constexpr std::bitset<(int)EPhysicalButton::Count> ButtonSet(
+      std::initializer_list<EPhysicalButton> buttons)
+  {
+    std::bitset<(int)EPhysicalButton::Count> buttonSet;
+
+    for (auto button : buttons)
+      buttonSet[(int)button] = true;
+
+    return buttonSet;
+  }
+
+  /// Generates a physical controller state that differs from the one generated for adjacent
+  /// iterations, so that every iteration of a test case results in a state change.
+  /// @param [in] iteration Iteration number for which a physical state is needed.
+  /// @return Physical controller state for the specified iteration.
+  static SPhysicalState PhysicalStateForIteration(int iteration)
+  {
+    return {
+        .deviceStatus = EPhysicalDeviceStatus::Ok,
+        .stick = {(int16_t)(iteration * 64), (int16_t)(-iteration * 64), 0, 0},
+        .button =
+            ((0 == (iteration % 2)) ? ButtonSet({EPhysicalButton::A, EPhysicalButton::DpadUp})
+                                    : ButtonSet({EPhysicalButton::B}))};
+  }
+
+  // Maps physical controller state to virtual controller state repeatedly. Verifies that mapping
+  // does not allocate.
+  TEST_CASE(SteadyStateAllocation_MapStatePhysicalToVirtual)
+  {
+    kTestMapper.MapStatePhysicalToVirtual(PhysicalStateForIteration(0), kTestControllerIdentifier);
+
+    const ScopedAllocationCounter allocationCounter;
+    for (int i = 1; i <= kTestIterationCount; ++i)
+      kTestMapper.MapStatePhysicalToVirtual(
+          PhysicalStateForIteration(i), kTestControllerIdentifier);
+
+    TEST_ASSERT(0 == allocationCounter.GetAllocationCount());
+  }
+
+  // Refreshes the state of a virtual controller repeatedly, both with and without its event buffer
+  // enabled. Verifies that refreshing state, including buffering the resulting events, does not
+  // allocate.
+  TEST_CASE(SteadyStateAllocation_RefreshState)
+  {
+    constexpr uint32_t kEventBufferCapacity = 16;
+
+    for (const bool eventBufferEnabled : {false, true})
+    {
+      MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+      VirtualController controller(kTestControllerIdentifier);
+      if (true == eventBufferEnabled) controller.SetEventBufferCapacity(kEventBufferCapacity);
+
+      controller.RefreshState(kTestMapper.MapStatePhysicalToVirtual(
+          PhysicalStateForIteration(0), kTestControllerIdentifier));
+
+      const ScopedAllocationCounter allocationCounter;
+      for (int i = 1; i <= kTestIterationCount; ++i)
+        controller.RefreshState(kTestMapper.MapStatePhysicalToVirtual(
+            PhysicalStateForIteration(i), kTestControllerIdentifier));
+
+      TEST_ASSERT(0 == allocationCounter.GetAllocationCount());
+    }
+  }
+
+  // Retrieves device state repeatedly, with the virtual controller state changing between
+  // retrievals. Verifies that once the first retrieval has produced a data packet, subsequent
+  // retrievals do not allocate.
+  TEST_CASE(SteadyStateAllocation_GetDeviceState)
+  {
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(
+        std::make_unique<VirtualController>(kTestControllerIdentifier));
+    TEST_ASSERT(DI_OK == diController.SetDataFormat(&kTestFormatSpec));
+
+    STestDataPacket dataPacket = {};
+    TEST_ASSERT(DI_OK == diController.GetDeviceState(sizeof(dataPacket), &dataPacket));
+
+    const ScopedAllocationCounter allocationCounter;
+    for (int i = 1; i <= kTestIterationCount; ++i)
+    {
+      diController.GetVirtualController().RefreshState(kTestMapper.MapStatePhysicalToVirtual(
+          PhysicalStateForIteration(i), kTestControllerIdentifier));
+      diController.GetDeviceState(sizeof(dataPacket), &dataPacket);
+    }
+
+    TEST_ASSERT(0 == allocationCounter.GetAllocationCount());
+  }
+
+  // Retrieves buffered events repeatedly, with the virtual controller state changing between
+  // retrievals. Verifies that neither producing nor retrieving buffered events allocates.
+  TEST_CASE(SteadyStateAllocation_GetDeviceData)
+  {
+    constexpr DWORD kBufferSize = 16;
+    constexpr DIPROPDWORD kBufferSizeProperty = {
+        .diph =
+            {.dwSize = sizeof(DIPROPDWORD),
+             .dwHeaderSize = sizeof(DIPROPHEADER),
+             .dwObj = 0,
+             .dwHow = DIPH_DEVICE},
+        .dwData = kBufferSize};
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(
+        std::make_unique<VirtualController>(kTestControllerIdentifier));
+    TEST_ASSERT(DI_OK == diController.SetDataFormat(&kTestFormatSpec));
+    TEST_ASSERT(
+        DI_OK ==
+        diController.SetProperty(DIPROP_BUFFERSIZE, (LPCDIPROPHEADER)&kBufferSizeProperty));
+
+    DIDEVICEOBJECTDATA objectData[kBufferSize];
+    DWORD numObjectDataElements = _countof(objectData);
+
+    diController.GetVirtualController().RefreshState(kTestMapper.MapStatePhysicalToVirtual(
+        PhysicalStateForIteration(0), kTestControllerIdentifier));
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetDeviceData(
+            sizeof(DIDEVICEOBJECTDATA), objectData, &numObjectDataElements, 0));
+
+    const ScopedAllocationCounter allocationCounter;
+    for (int i = 1; i <= kTestIterationCount; ++i)
+    {
+      diController.GetVirtualController().RefreshState(kTestMapper.MapStatePhysicalToVirtual(
+          PhysicalStateForIteration(i), kTestControllerIdentifier));
+
+      numObjectDataElements = _countof(objectData);
+      diController.GetDeviceData(
+          sizeof(DIDEVICEOBJECTDATA), objectData, &numObjectDataElements, 0);
+    }
+
+    TEST_ASSERT(0 == allocationCounter.GetAllocationCount());
+  }
+
+  // Plays force feedback effects repeatedly while they are playing. Verifies that once all pending
+  // commands have been applied, playback does not allocate.
+  TEST_CASE(SteadyStateAllocation_PlayEffects)
+  {
+    constexpr TEffectTimeMs kTestEffectDuration = 10 * kTestIterationCount;
+
+    Device device(0);
+
+    MockEffect effects[2];
+    for (auto& effect : effects)
+    {
+      effect.InitializeDefaultAssociatedAxes();
+      effect.InitializeDefaultDirection();
+      effect.SetDuration(kTestEffectDuration);
+
+      TEST_ASSERT(true == device.AddOrUpdateEffect(effect));
+      TEST_ASSERT(true == device.StartEffect(effect.Identifier(), 1, 0));
+    }
+
+    device.PlayEffects(0);
+
+    const ScopedAllocationCounter allocationCounter;
+    for (TEffectTimeMs t = 1; t <= (TEffectTimeMs)kTestIterationCount; ++t)
+      device.PlayEffects(t);
+
+    TEST_ASSERT(0 == allocationCounter.GetAllocationCount());
+  }
+} // namespace XidiTest
@@ -0,0 +1,201 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file TurboMapperTest.cpp
+ *   Unit tests for controller element mappers that repeatedly press and release the target of
+ *   another element mapper while their input is held.
+ **************************************************************************************************/
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ElementMapper.h"
+#include "Keyboard.h"
+#include "Mapper.h"
+#include "MockElementMapper.h"
+#include "MockKeyboard.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller;
+  using ::Xidi::Keyboard::TKeyIdentifier;
+
+  /// Opaque physical controller identifier used for all test cases in this file.
+  static constexpr uint32_t kTestSourceControllerIdentifier = 0;
+
+  /// Source identifier used for all contributions in this file.
+  static constexpr uint32_t kTestSourceIdentifier =
+      Mapper::SourceIdentifierForElementMapper(kTestSourceControllerIdentifier, 0);
+
+  /// Repetition rate used for all test cases in this file, in presses per second.
+  static constexpr unsigned int kTestRate = 10;
+
+  /// Duration of one press and release at the test repetition rate, in microseconds.
+  static constexpr int64_t kTestPeriodMicroseconds = 1000000 / kTestRate;
+
+  /// Target button used for test cases that forward to a button mapper.
+  static constexpr EButton kTestButton = EButton::B1;
+
+  /// Keyboard key identifier used for test cases that forward to a keyboard mapper.
+  static constexpr TKeyIdentifier kTestKeyIdentifier = 55;
+
+  /// Makes a single button contribution as it would be made during a poll at the specified time.
+  /// @param [in] mapper Turbo mapper to ask for a contribution.
+  /// @param [in] timestampMicroseconds Poll timestamp.
+  /// @param [in] buttonPressed Button state to contribute.
+  /// @return Resulting virtual controller state.
+  static SState ContributeButtonAt(
+      const TurboMapper& mapper, int64_t timestampMicroseconds, bool buttonPressed)
+  {
+    TurboMapper::SetMappingTimestamp(kTestSourceControllerIdentifier, timestampMicroseconds);
+
+    SState controllerState = {};
+    mapper.ContributeFromButtonValue(controllerState, buttonPressed, kTestSourceIdentifier);
+    return controllerState;
+  }
+
+  // Creates one turbo mapper with an underlying element mapper present.
+  // Verifies correct reporting of the target elements.
+  TEST_CASE(TurboMapper_GetTargetElement_Nominal)
+  {
+    constexpr SElementIdentifier kUnderlyingElement = {
+        .type = EElementType::Button, .button = EButton::B2};
+
+    const TurboMapper mapper(kTestRate, std::make_unique<MockElementMapper>(kUnderlyingElement));
+    TEST_ASSERT(1 == mapper.GetTargetElementCount());
+
+    const std::optional<SElementIdentifier> maybeTargetElement = mapper.GetTargetElementAt(0);
+    TEST_ASSERT(true == maybeTargetElement.has_value());
+    TEST_ASSERT(kUnderlyingElement == maybeTargetElement.value());
+  }
+
+  // Creates and then clones one turbo mapper with an underlying element mapper present.
+  // Verifies correct reporting of the target elements and of the rate.
+  TEST_CASE(TurboMapper_GetTargetElement_Clone)
+  {
+    constexpr SElementIdentifier kUnderlyingElement = {
+        .type = EElementType::Button, .button = EButton::B2};
+
+    const TurboMapper mapperOriginal(
+        kTestRate, std::make_unique<MockElementMapper>(kUnderlyingElement));
+    const std::unique_ptr<IElementMapper> mapperClone = mapperOriginal.Clone();
+    TEST_ASSERT(1 == mapperClone->GetTargetElementCount());
+    TEST_ASSERT(kUnderlyingElement == mapperClone->GetTargetElementAt(0));
+
+    const TurboMapper* turboMapperClone = dynamic_cast<TurboMapper*>(mapperClone.get());
+    TEST_ASSERT(nullptr != turboMapperClone);
+    TEST_ASSERT(kTestRate == turboMapperClone->GetRate());
+  }
+
+  // Verifies that rates outside of the allowed range are clamped.
+  TEST_CASE(TurboMapper_Rate_Clamped)
+  {
+    const TurboMapper mapperSlow(0, std::make_unique<ButtonMapper>(kTestButton));
+    TEST_ASSERT(TurboMapper::kMinRate == mapperSlow.GetRate());
+
+    const TurboMapper mapperFast(1000, std::make_unique<ButtonMapper>(kTestButton));
+    TEST_ASSERT(TurboMapper::kMaxRate == mapperFast.GetRate());
+  }
+
+  // Holds a button mapped to a virtual controller button for several repetitions and verifies
+  // that the target is pressed during the first half of each repetition and released during the
+  // second half, that the mapper reports being held throughout, and that releasing the input
+  // releases the target immediately and restarts the repetition when it is next held.
+  TEST_CASE(TurboMapper_ContributeFromButtonValue_Nominal)
+  {
+    constexpr int64_t kHalfPeriod = kTestPeriodMicroseconds / 2;
+    constexpr int64_t kStartTime = 1000;
+
+    const TurboMapper mapper(kTestRate, std::make_unique<ButtonMapper>(kTestButton));
+
+    TEST_ASSERT(true == ContributeButtonAt(mapper, kStartTime, true)[kTestButton]);
+    TEST_ASSERT(true == TurboMapper::IsAnyHeld(kTestSourceControllerIdentifier));
+    TEST_ASSERT(
+        true == ContributeButtonAt(mapper, kStartTime + kHalfPeriod - 1, true)[kTestButton]);
+    TEST_ASSERT(false == ContributeButtonAt(mapper, kStartTime + kHalfPeriod, true)[kTestButton]);
+    TEST_ASSERT(true == TurboMapper::IsAnyHeld(kTestSourceControllerIdentifier));
+    TEST_ASSERT(
+        true ==
+        ContributeButtonAt(mapper, kStartTime + kTestPeriodMicroseconds, true)[kTestButton]);
+    TEST_ASSERT(
+        false == ContributeButtonAt(mapper, kStartTime + (5 * kHalfPeriod), true)[kTestButton]);
+
+    const int64_t kReleaseTime = kStartTime + (6 * kHalfPeriod) + 1;
+    TEST_ASSERT(false == ContributeButtonAt(mapper, kReleaseTime, false)[kTestButton]);
+    TEST_ASSERT(false == TurboMapper::IsAnyHeld(kTestSourceControllerIdentifier));
+
+    const int64_t kRepressTime = kReleaseTime + kHalfPeriod + 1;
+    TEST_ASSERT(true == ContributeButtonAt(mapper, kRepressTime, true)[kTestButton]);
+    TEST_ASSERT(false == ContributeButtonAt(mapper, kRepressTime + kHalfPeriod, true)[kTestButton]);
+
+    SState controllerState = {};
+    mapper.ContributeNeutral(controllerState, kTestSourceIdentifier);
+    TEST_ASSERT(false == controllerState[kTestButton]);
+  }
+
+  // Holds a trigger mapped to a keyboard key and verifies that the key is pressed and released
+  // according to the repetition rate.
+  TEST_CASE(TurboMapper_ContributeFromTriggerValue_Keyboard)
+  {
+    constexpr int64_t kHalfPeriod = kTestPeriodMicroseconds / 2;
+    constexpr int64_t kTimestamps[] = {0, kHalfPeriod, kTestPeriodMicroseconds};
+
+    MockKeyboard expectedKeyboardStatePressed;
+    expectedKeyboardStatePressed.SubmitKeyPressedState(kTestKeyIdentifier);
+
+    MockKeyboard expectedKeyboardStateUnpressed;
+
+    const MockKeyboard* const kExpectedKeyboardStates[] = {
+        &expectedKeyboardStatePressed,
+        &expectedKeyboardStateUnpressed,
+        &expectedKeyboardStatePressed};
+    static_assert(
+        _countof(kExpectedKeyboardStates) == _countof(kTimestamps),
+        "Mismatch between input and expected output array lengths.");
+
+    const TurboMapper mapper(kTestRate, std::make_unique<KeyboardMapper>(kTestKeyIdentifier));
+
+    for (int i = 0; i < _countof(kTimestamps); ++i)
+    {
+      TurboMapper::SetMappingTimestamp(kTestSourceControllerIdentifier, kTimestamps[i]);
+
+      MockKeyboard actualState;
+      SState unusedControllerState = {};
+
+      actualState.BeginCapture();
+      mapper.ContributeFromTriggerValue(
+          unusedControllerState, (uint8_t)kTriggerValueMax, kTestSourceIdentifier);
+      actualState.EndCapture();
+
+      TEST_ASSERT(actualState == *kExpectedKeyboardStates[i]);
+    }
+
+    SState unusedControllerState = {};
+    mapper.ContributeNeutral(unusedControllerState, kTestSourceIdentifier);
+  }
+
+  // Verifies that an input that is not held is forwarded unmodified and does not cause the mapper
+  // to report being held.
+  TEST_CASE(TurboMapper_NotHeld)
+  {
+    const TurboMapper mapper(kTestRate, std::make_unique<ButtonMapper>(kTestButton));
+
+    TurboMapper::SetMappingTimestamp(kTestSourceControllerIdentifier, 0);
+
+    SState controllerState = {};
+    mapper.ContributeFromAnalogValue(controllerState, 0, kTestSourceIdentifier);
+    mapper.ContributeFromTriggerValue(
+        controllerState, (uint8_t)kTriggerValueMin, kTestSourceIdentifier);
+    mapper.ContributeFromButtonValue(controllerState, false, kTestSourceIdentifier);
+
+    TEST_ASSERT(false == controllerState[kTestButton]);
+    TEST_ASSERT(false == TurboMapper::IsAnyHeld(kTestSourceControllerIdentifier));
+  }
+} // namespace XidiTest
@@ -43,6 +43,7 @@ namespace XidiTest
   using ::Xidi::Controller::EPovDirection;
   using ::Xidi::Controller::Mapper;
   using ::Xidi::Controller::PovMapper;
+  using ::Xidi::Controller::SElementIdentifier;
   using ::Xidi::Controller::SPhysicalState;
   using ::Xidi::Controller::StateChangeEventBuffer;
   using ::Xidi::Controller::TControllerIdentifier;
@@ -810,6 +811,393 @@ namespace XidiTest
     TEST_ASSERT(actualStateAfter == kExpectedStateAfter);
   }
 
+  // Verifies that property changes made during a property transaction are visible right away but
+  // are applied to the controller state only once the outermost transaction ends, and that doing
+  // so is recorded as a single state change.
+  TEST_CASE(VirtualController_PropertyTransaction_AppliedOnceAtEnd)
+  {
+    constexpr SPhysicalState kPhysicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    constexpr int32_t kTestRangeMin = 500;
+    constexpr int32_t kTestRangeMax = 1000;
+    constexpr uint32_t kTestDeadzone = 2000;
+    constexpr uint32_t kTestSaturation = 8000;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controller(0);
+
+    controller.RefreshState(kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0));
+    const Controller::SState stateBefore = controller.GetState();
+    const uint64_t generationBefore = controller.GetStateGeneration();
+
+    controller.BeginPropertyTransaction();
+    controller.BeginPropertyTransaction();
+    TEST_ASSERT(true == controller.SetAllAxisRange(kTestRangeMin, kTestRangeMax));
+    TEST_ASSERT(true == controller.SetAllAxisDeadzone(kTestDeadzone));
+    TEST_ASSERT(
+        false == controller.SetAllAxisSaturation(VirtualController::kAxisSaturationMax + 1));
+    TEST_ASSERT(true == controller.SetAllAxisSaturation(kTestSaturation));
+    controller.EndPropertyTransaction();
+
+    for (int i = 0; i < (int)EAxis::Count; ++i)
+    {
+      TEST_ASSERT(
+          std::make_pair(kTestRangeMin, kTestRangeMax) == controller.GetAxisRange((EAxis)i));
+      TEST_ASSERT(kTestDeadzone == controller.GetAxisDeadzone((EAxis)i));
+      TEST_ASSERT(kTestSaturation == controller.GetAxisSaturation((EAxis)i));
+    }
+
+    TEST_ASSERT(controller.GetState() == stateBefore);
+    TEST_ASSERT(controller.GetStateGeneration() == generationBefore);
+
+    controller.EndPropertyTransaction();
+
+    constexpr int32_t kExpectedNeutralValue = (kTestRangeMin + kTestRangeMax) / 2;
+    const Controller::SState stateAfter = controller.GetState();
+    TEST_ASSERT(stateAfter[EAxis::X] == kExpectedNeutralValue);
+    TEST_ASSERT(stateAfter[EAxis::Y] == kExpectedNeutralValue);
+    TEST_ASSERT(controller.GetStateGeneration() == (1 + generationBefore));
+  }
+
+  // Verifies that a virtual controller correctly tracks which of its elements changed since an
+  // earlier state generation. Once enough state changes have occurred, the earlier generation is
+  // too old to be remembered and all elements are expected to be reported as changed.
+  TEST_CASE(VirtualController_StateChangedElements)
+  {
+    constexpr SPhysicalState kPhysicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    constexpr int kNumManyStateChanges = 64;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controller(0);
+
+    const Controller::SState kStateNeutral =
+        kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0);
+    controller.RefreshState(kStateNeutral);
+
+    const uint64_t generationNeutral = controller.GetStateGeneration();
+    TEST_ASSERT(0 == controller.GetStateChangedElementsSince(generationNeutral));
+
+    Controller::SState stateButtonPressed = kStateNeutral;
+    stateButtonPressed[EButton::B2] = true;
+    TEST_ASSERT(true == controller.RefreshState(stateButtonPressed));
+
+    const uint64_t generationButtonPressed = controller.GetStateGeneration();
+    TEST_ASSERT(generationButtonPressed == (1 + generationNeutral));
+    TEST_ASSERT(
+        controller.GetStateChangedElementsSince(generationNeutral) ==
+        Controller::ElementMaskForElement({.type = EElementType::Button, .button = EButton::B2}));
+
+    Controller::SState statePovPressed = stateButtonPressed;
+    statePovPressed[EPovDirection::Up] = true;
+    TEST_ASSERT(true == controller.RefreshState(statePovPressed));
+    TEST_ASSERT(false == controller.RefreshState(statePovPressed));
+    TEST_ASSERT(controller.GetStateGeneration() == (1 + generationButtonPressed));
+    TEST_ASSERT(
+        controller.GetStateChangedElementsSince(generationButtonPressed) ==
+        Controller::ElementMaskForElement({.type = EElementType::Pov}));
+    TEST_ASSERT(
+        controller.GetStateChangedElementsSince(generationNeutral) ==
+        (Controller::ElementMaskForElement({.type = EElementType::Button, .button = EButton::B2}) |
+         Controller::ElementMaskForElement({.type = EElementType::Pov})));
+
+    for (int i = 0; i < kNumManyStateChanges; ++i)
+    {
+      Controller::SState stateToggled = statePovPressed;
+      stateToggled[EButton::B3] = (0 == (i % 2));
+      TEST_ASSERT(true == controller.RefreshState(stateToggled));
+    }
+
+    TEST_ASSERT(
+        controller.GetStateChangedElementsSince(generationNeutral) == Controller::kElementMaskAll);
+  }
+
+  // Verifies that a virtual controller with neither an event buffer nor a state change event handle
+  // is in pull mode, such that it ignores raw states pushed to it and instead pulls the raw state
+  // published by the physical controller when its state is read. The pulled state should be
+  // reported as exactly one state change, no matter how many times it is read.
+  TEST_CASE(VirtualController_RefreshStateOrDefer_PullMode)
+  {
+    constexpr SPhysicalState kPhysicalStates[] = {
+        {.deviceStatus = EPhysicalDeviceStatus::Ok},
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .button = ButtonSet({EPhysicalButton::A})}};
+
+    MockPhysicalController physicalController(
+        0, kTestMapper, kPhysicalStates, _countof(kPhysicalStates));
+    VirtualController controller(0);
+
+    const Controller::SState kStateNeutral = controller.GetState();
+    const uint64_t generationNeutral = controller.GetStateGeneration();
+
+    VirtualController::SSharedRefresh sharedRefresh;
+    TEST_ASSERT(false == controller.RefreshStateOrDefer(Controller::SState(), sharedRefresh));
+    TEST_ASSERT(controller.GetState() == kStateNeutral);
+    TEST_ASSERT(controller.GetStateGeneration() == generationNeutral);
+
+    physicalController.RequestAdvancePhysicalState();
+    const Controller::SState kExpectedState = physicalController.GetCurrentRawVirtualState();
+    TEST_ASSERT(kExpectedState != kStateNeutral);
+
+    Controller::TElementMask changedElements = 0;
+    uint64_t generation = 0;
+    const Controller::SState actualState =
+        controller.GetStateSince(generationNeutral, changedElements, generation);
+
+    TEST_ASSERT(actualState == kExpectedState);
+    TEST_ASSERT(generation == (1 + generationNeutral));
+    TEST_ASSERT(0 != changedElements);
+    TEST_ASSERT(controller.GetState() == kExpectedState);
+    TEST_ASSERT(controller.GetStateGeneration() == generation);
+  }
+
+  // Verifies that a virtual controller switching from pull mode to push mode because an event
+  // buffer is enabled first pulls the latest raw state, without generating any events for it, and
+  // then applies pushed raw states immediately.
+  TEST_CASE(VirtualController_RefreshStateOrDefer_SwitchToPushMode)
+  {
+    constexpr SPhysicalState kPhysicalStates[] = {
+        {.deviceStatus = EPhysicalDeviceStatus::Ok},
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .button = ButtonSet({EPhysicalButton::A})}};
+    constexpr uint32_t kEventBufferCapacity = 16;
+
+    MockPhysicalController physicalController(
+        0, kTestMapper, kPhysicalStates, _countof(kPhysicalStates));
+    VirtualController controller(0);
+
+    const uint64_t generationNeutral = controller.GetStateGeneration();
+    physicalController.RequestAdvancePhysicalState();
+    const Controller::SState kExpectedState = physicalController.GetCurrentRawVirtualState();
+
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+    TEST_ASSERT(controller.GetState() == kExpectedState);
+    TEST_ASSERT(controller.GetStateGeneration() == (1 + generationNeutral));
+    TEST_ASSERT(0 == controller.GetEventBufferCount());
+
+    Controller::SState stateButtonPressed = kExpectedState;
+    stateButtonPressed[EButton::B2] = !stateButtonPressed[EButton::B2];
+
+    VirtualController::SSharedRefresh sharedRefresh;
+    TEST_ASSERT(true == controller.RefreshStateOrDefer(stateButtonPressed, sharedRefresh));
+    TEST_ASSERT(1 == controller.GetEventBufferCount());
+  }
+
+  // Verifies that a virtual controller with an event buffer applies a refresh immediately, so that
+  // events are generated at the time of the physical input rather than when state is read.
+  TEST_CASE(VirtualController_RefreshStateOrDefer_EventBufferEnabled)
+  {
+    constexpr SPhysicalState kPhysicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    constexpr uint32_t kEventBufferCapacity = 16;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controller(0);
+
+    const Controller::SState kStateNeutral =
+        kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0);
+    controller.RefreshState(kStateNeutral);
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+
+    Controller::SState stateButtonPressed = kStateNeutral;
+    stateButtonPressed[EButton::B2] = true;
+
+    VirtualController::SSharedRefresh sharedRefresh;
+    TEST_ASSERT(true == controller.RefreshStateOrDefer(stateButtonPressed, sharedRefresh));
+    TEST_ASSERT(1 == controller.GetEventBufferCount());
+  }
+
+  // Verifies that the event buffer records the generation of the state whose change produced the
+  // most recent events, and that refreshes producing no events leave it unchanged.
+  TEST_CASE(VirtualController_EventBufferStateGeneration)
+  {
+    constexpr SPhysicalState kPhysicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    constexpr uint32_t kEventBufferCapacity = 16;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controller(0);
+
+    const Controller::SState kStateNeutral =
+        kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0);
+    controller.RefreshState(kStateNeutral);
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+    TEST_ASSERT(0 == controller.GetEventBufferStateGeneration());
+
+    Controller::SState stateButtonPressed = kStateNeutral;
+    stateButtonPressed[EButton::B2] = true;
+
+    TEST_ASSERT(true == controller.RefreshState(stateButtonPressed));
+    const uint64_t kGenerationButtonPressed = controller.GetStateGeneration();
+    TEST_ASSERT(kGenerationButtonPressed == controller.GetEventBufferStateGeneration());
+
+    TEST_ASSERT(false == controller.RefreshState(stateButtonPressed));
+    TEST_ASSERT(kGenerationButtonPressed == controller.GetEventBufferStateGeneration());
+
+    controller.PopEventBufferOldestEvents(controller.GetEventBufferCount());
+    TEST_ASSERT(kGenerationButtonPressed == controller.GetEventBufferStateGeneration());
+
+    TEST_ASSERT(true == controller.RefreshState(kStateNeutral));
+    TEST_ASSERT((1 + kGenerationButtonPressed) == controller.GetEventBufferStateGeneration());
+  }
+
+  // Verifies that changing a property in a way that changes the processed state is recorded as a
+  // state change and that the state, its generation, and the changed elements are all reported
+  // consistently with one another.
+  TEST_CASE(VirtualController_StateSince_PropertyChange)
+  {
+    constexpr SPhysicalState kPhysicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+    constexpr int32_t kTestRangeMin = -100;
+    constexpr int32_t kTestRangeMax = 100;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controller(0);
+
+    controller.RefreshState(kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0));
+    const uint64_t generationBefore = controller.GetStateGeneration();
+
+    TEST_ASSERT(true == controller.SetAxisRange(EAxis::X, kTestRangeMin, kTestRangeMax));
+
+    Controller::TElementMask changedElements = 0;
+    uint64_t generationAfter = 0;
+    const Controller::SState actualState =
+        controller.GetStateSince(generationBefore, changedElements, generationAfter);
+
+    TEST_ASSERT(generationAfter == (1 + generationBefore));
+    TEST_ASSERT(generationAfter == controller.GetStateGeneration());
+    TEST_ASSERT(
+        changedElements ==
+        Controller::ElementMaskForElement({.type = EElementType::Axis, .axis = EAxis::X}));
+    TEST_ASSERT(actualState[EAxis::X] == ((kTestRangeMin + kTestRangeMax) / 2));
+    TEST_ASSERT(actualState == controller.GetState());
+  }
+
+  // Verifies that an axis that reverses direction is not extrapolated, no matter how quickly it was
+  // moving beforehand.
+  TEST_CASE(VirtualController_GetStateSinceExtrapolated_DirectionReversal)
+  {
+    constexpr int32_t kTestAxisValues[] = {1000, 2000, 3000, 2500};
+
+    MockPhysicalController physicalController(0, kTestSingleAxisMapper);
+    VirtualController controller(0);
+    controller.SetAllAxisRange(Controller::kAnalogValueMin, Controller::kAnalogValueMax);
+
+    for (const auto axisValue : kTestAxisValues)
+    {
+      Controller::SState rawState = {};
+      rawState[kTestSingleAxis] = axisValue;
+      controller.RefreshState(rawState);
+    }
+
+    Controller::TElementMask changedElements = 0;
+    Controller::TElementMask extrapolatedElements = 0;
+    uint64_t generation = 0;
+    const Controller::SState actualState = controller.GetStateSinceExtrapolated(
+        controller.GetStateGeneration(), changedElements, generation, extrapolatedElements);
+
+    TEST_ASSERT(0 == extrapolatedElements);
+    TEST_ASSERT(actualState == controller.GetState());
+  }
+
+  // Verifies that an axis moving quickly towards the end of its range is only ever extrapolated in
+  // the direction of motion and never past the end of its range.
+  TEST_CASE(VirtualController_GetStateSinceExtrapolated_Clamped)
+  {
+    constexpr int32_t kTestRangeMin = -100;
+    constexpr int32_t kTestRangeMax = 100;
+    constexpr int32_t kTestRawAxisValues[] = {
+        Controller::kAnalogValueMax - 300,
+        Controller::kAnalogValueMax - 200,
+        Controller::kAnalogValueMax - 100};
+
+    MockPhysicalController physicalController(0, kTestSingleAxisMapper);
+    VirtualController controller(0);
+    controller.SetAllAxisRange(kTestRangeMin, kTestRangeMax);
+
+    for (const auto rawAxisValue : kTestRawAxisValues)
+    {
+      Controller::SState rawState = {};
+      rawState[kTestSingleAxis] = rawAxisValue;
+      controller.RefreshState(rawState);
+    }
+
+    Controller::TElementMask changedElements = 0;
+    Controller::TElementMask extrapolatedElements = 0;
+    uint64_t generation = 0;
+    const Controller::SState actualState = controller.GetStateSinceExtrapolated(
+        controller.GetStateGeneration(), changedElements, generation, extrapolatedElements);
+
+    TEST_ASSERT(
+        0 ==
+        (extrapolatedElements &
+         ~Controller::ElementMaskForElement({.type = EElementType::Axis, .axis = kTestSingleAxis})));
+    TEST_ASSERT(actualState[kTestSingleAxis] >= controller.GetState()[kTestSingleAxis]);
+    TEST_ASSERT(actualState[kTestSingleAxis] <= kTestRangeMax);
+  }
+
+  // Verifies that virtual controllers refreshed one after another using the same raw state share
+  // processed state only if their properties are identical, and that in both cases each of them
+  // ends up with exactly the state it would have produced on its own.
+  TEST_CASE(VirtualController_RefreshState_SharedRefresh)
+  {
+    constexpr SPhysicalState kPhysicalState = {
+        .deviceStatus = EPhysicalDeviceStatus::Ok, .stick = {1000, -2000, 3000, -4000}};
+    constexpr int32_t kTestRangeMin = -100;
+    constexpr int32_t kTestRangeMax = 100;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controllerDefault1(0);
+    VirtualController controllerDefault2(0);
+    VirtualController controllerCustomRange(0);
+    VirtualController controllerReference(0);
+    TEST_ASSERT(true == controllerCustomRange.SetAllAxisRange(kTestRangeMin, kTestRangeMax));
+
+    const Controller::SState kRawState = kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0);
+    VirtualController::SSharedRefresh sharedRefresh;
+
+    controllerDefault1.RefreshState(kRawState, sharedRefresh);
+    const auto sharedParametersDefault = sharedRefresh.axisTransformParameters;
+    TEST_ASSERT(nullptr != sharedParametersDefault);
+
+    controllerDefault2.RefreshState(kRawState, sharedRefresh);
+    TEST_ASSERT(sharedParametersDefault == sharedRefresh.axisTransformParameters);
+
+    controllerCustomRange.RefreshState(kRawState, sharedRefresh);
+    TEST_ASSERT(sharedParametersDefault != sharedRefresh.axisTransformParameters);
+
+    controllerReference.RefreshState(kRawState);
+    TEST_ASSERT(controllerDefault1.GetState() == controllerReference.GetState());
+    TEST_ASSERT(controllerDefault2.GetState() == controllerReference.GetState());
+
+    TEST_ASSERT(true == controllerReference.SetAllAxisRange(kTestRangeMin, kTestRangeMax));
+    TEST_ASSERT(controllerCustomRange.GetState() == controllerReference.GetState());
+    TEST_ASSERT(controllerCustomRange.GetState() != controllerDefault1.GetState());
+  }
+
+  // Verifies that virtual controllers refreshed one after another using the same raw state apply
+  // the same timestamp to the buffered events they generate.
+  TEST_CASE(VirtualController_RefreshState_SharedEventTimestamp)
+  {
+    constexpr SPhysicalState kPhysicalState = {
+        .deviceStatus = EPhysicalDeviceStatus::Ok,
+        .button = ButtonSet({EPhysicalButton::A, EPhysicalButton::B})};
+    constexpr uint32_t kEventBufferCapacity = 64;
+    constexpr uint32_t kEventTimestamp = 12345;
+
+    MockPhysicalController physicalController(0, kTestMapper);
+    VirtualController controller1(0);
+    VirtualController controller2(0);
+    VirtualController* const controllers[] = {&controller1, &controller2};
+    for (auto controller : controllers)
+      controller->SetEventBufferCapacity(kEventBufferCapacity);
+
+    const Controller::SState kRawState = kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, 0);
+    VirtualController::SSharedRefresh sharedRefresh = {.eventTimestamp = kEventTimestamp};
+
+    for (auto controller : controllers)
+    {
+      TEST_ASSERT(true == controller->RefreshState(kRawState, sharedRefresh));
+      TEST_ASSERT(0 != controller->GetEventBufferCount());
+
+      for (unsigned int i = 0; i < controller->GetEventBufferCount(); ++i)
+        TEST_ASSERT(kEventTimestamp == controller->GetEventBufferEvent(i).timestamp);
+    }
+  }
+
   // Verifies that by default buffered events are disabled.
   TEST_CASE(VirtualController_EventBuffer_DefaultDisabled)
   {
@@ -997,6 +1385,74 @@ namespace XidiTest
     }
   }
 
+  // Verifies that differences between virtual controller states are identified exactly, one
+  // element at a time and several at once, for every axis, every button, and the POV.
+  TEST_CASE(VirtualController_ElementMaskForStateDifference)
+  {
+    const Controller::SState kBaselineState = {
+        .axis = {100, -200, 300, -400, 500, -600},
+        .button = 0b1010,
+        .povDirection = {.components = {true, false, false, false}}};
+
+    TEST_ASSERT(0 == Controller::ElementMaskForStateDifference(kBaselineState, kBaselineState));
+
+    for (int i = 0; i < (int)EAxis::Count; ++i)
+    {
+      Controller::SState changedState = kBaselineState;
+      changedState.axis[i] += 1;
+      TEST_ASSERT(
+          Controller::ElementMaskForElement({.type = EElementType::Axis, .axis = (EAxis)i}) ==
+          Controller::ElementMaskForStateDifference(kBaselineState, changedState));
+    }
+
+    for (int i = 0; i < (int)EButton::Count; ++i)
+    {
+      Controller::SState changedState = kBaselineState;
+      changedState.button[i] = !changedState.button[i];
+      TEST_ASSERT(
+          Controller::ElementMaskForElement(
+              {.type = EElementType::Button, .button = (EButton)i}) ==
+          Controller::ElementMaskForStateDifference(kBaselineState, changedState));
+    }
+
+    Controller::SState changedState = kBaselineState;
+    changedState.axis[(int)EAxis::RotZ] = 0;
+    changedState.button[0] = true;
+    changedState.povDirection.components[(int)EPovDirection::Right] = true;
+    TEST_ASSERT(
+        (Controller::ElementMaskForElement({.type = EElementType::Axis, .axis = EAxis::RotZ}) |
+         Controller::ElementMaskForElement({.type = EElementType::Button, .button = EButton::B1}) |
+         Controller::ElementMaskForElement({.type = EElementType::Pov})) ==
+        Controller::ElementMaskForStateDifference(kBaselineState, changedState));
+  }
+
+  // Verifies that an event filter contains exactly the elements it is given all at once, and that
+  // individual elements can still be added and removed afterwards.
+  TEST_CASE(VirtualController_EventFilter_SetElements)
+  {
+    constexpr SElementIdentifier kAxisElement = {.type = EElementType::Axis, .axis = EAxis::RotY};
+    constexpr SElementIdentifier kButtonElement = {
+        .type = EElementType::Button, .button = EButton::B5};
+    constexpr SElementIdentifier kPovElement = {.type = EElementType::Pov};
+
+    VirtualController::EventFilter eventFilter;
+    TEST_ASSERT(Controller::kElementMaskAll == eventFilter.GetElements());
+
+    eventFilter.SetElements(
+        Controller::ElementMaskForElement(kAxisElement) |
+        Controller::ElementMaskForElement(kButtonElement));
+    TEST_ASSERT(true == eventFilter.Contains(kAxisElement));
+    TEST_ASSERT(true == eventFilter.Contains(kButtonElement));
+    TEST_ASSERT(false == eventFilter.Contains(kPovElement));
+    TEST_ASSERT(false == eventFilter.Contains({.type = EElementType::Axis, .axis = EAxis::X}));
+
+    eventFilter.Remove(kAxisElement);
+    eventFilter.Add(kPovElement);
+    TEST_ASSERT(
+        (Controller::ElementMaskForElement(kButtonElement) |
+         Controller::ElementMaskForElement(kPovElement)) == eventFilter.GetElements());
+  }
+
   // Submits multiple physical state changes to the physical controller associated with a virtual
   // controller such that every single physical state change causes a virtual controller state
   // change. Enables state change notifications and verifies that each physical controller state
@@ -1096,6 +1552,98 @@ namespace XidiTest
     }
   }
 
+  // Moves an axis twice in quick succession while the minimum time between axis-only state change
+  // event signals is limited, and then stops moving it. Verifies that the first movement is
+  // signalled immediately, that the second one is postponed, and that exactly one trailing signal
+  // arrives once the period elapses so that the final axis position is not missed.
+  TEST_CASE(VirtualController_StateChangeNotification_TrailingSignal)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 2;
+    constexpr DWORD kSignalPeriodMilliseconds = 200;
+
+    constexpr SPhysicalState kPhysicalStates[] = {
+        {.deviceStatus = EPhysicalDeviceStatus::Ok},
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .stick = {8000, 0, 0, 0}},
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .stick = {16000, 0, 0, 0}}};
+
+    const HANDLE stateChangeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    TEST_ASSERT((nullptr != stateChangeEvent) && (INVALID_HANDLE_VALUE != stateChangeEvent));
+
+    MockPhysicalController physicalController(
+        kControllerIndex, kTestMapper, kPhysicalStates, _countof(kPhysicalStates));
+
+    VirtualController controller(kControllerIndex);
+    controller.SetStateChangeEventPeriod(kSignalPeriodMilliseconds);
+    controller.SetStateChangeEvent(stateChangeEvent);
+
+    physicalController.RequestAdvancePhysicalState();
+    TEST_ASSERT(
+        WAIT_OBJECT_0 ==
+        WaitForSingleObject(stateChangeEvent, kTestStateChangeEventTimeoutMilliseconds));
+
+    physicalController.RequestAdvancePhysicalState();
+    TEST_ASSERT(WAIT_TIMEOUT == WaitForSingleObject(stateChangeEvent, 0));
+
+    TEST_ASSERT(
+        WAIT_OBJECT_0 ==
+        WaitForSingleObject(
+            stateChangeEvent,
+            (kSignalPeriodMilliseconds + kTestStateChangeEventTimeoutMilliseconds)));
+    TEST_ASSERT(
+        WAIT_TIMEOUT ==
+        WaitForSingleObject(
+            stateChangeEvent,
+            (kSignalPeriodMilliseconds + kTestStateChangeEventTimeoutMilliseconds)));
+  }
+
+  // Verifies that virtual controllers register for physical controller state changes upon
+  // construction and unregister upon destruction, without any per-controller background activity
+  // that would need to be waited on. Repeated creation and destruction should leave no stale
+  // registrations behind.
+  TEST_CASE(VirtualController_StateChangeRegistration_Lifetime)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 3;
+    constexpr SPhysicalState kPhysicalState = {.deviceStatus = EPhysicalDeviceStatus::Ok};
+
+    MockPhysicalController physicalController(kControllerIndex, kTestMapper, &kPhysicalState, 1);
+
+    for (int i = 0; i < 100; ++i)
+    {
+      VirtualController* controller = new VirtualController(kControllerIndex);
+      TEST_ASSERT(
+          true == physicalController.IsVirtualControllerRegisteredForStateChange(controller));
+
+      delete controller;
+      TEST_ASSERT(
+          false == physicalController.IsVirtualControllerRegisteredForStateChange(controller));
+    }
+  }
+
+  // Verifies that physical controller state changes are delivered to virtual controllers as soon
+  // as they are published, such that the new state is immediately visible without waiting for any
+  // other thread to pick it up.
+  TEST_CASE(VirtualController_StateChangeRegistration_ImmediateDelivery)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 3;
+    constexpr SPhysicalState kPhysicalStates[] = {
+        {.deviceStatus = EPhysicalDeviceStatus::Ok},
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .button = ButtonSet({EPhysicalButton::A})}};
+
+    MockPhysicalController physicalController(
+        kControllerIndex, kTestMapper, kPhysicalStates, _countof(kPhysicalStates));
+
+    VirtualController controller(kControllerIndex);
+    VirtualController controller2(kControllerIndex);
+
+    const SState kExpectedInitialState = controller.GetState();
+    physicalController.RequestAdvancePhysicalState();
+
+    const SState kExpectedFinalState = physicalController.GetCurrentRawVirtualState();
+    TEST_ASSERT(kExpectedFinalState != kExpectedInitialState);
+    TEST_ASSERT(kExpectedFinalState == controller.GetState());
+    TEST_ASSERT(kExpectedFinalState == controller2.GetState());
+  }
+
   // Verifies that a single virtual controller can register and unregister successfully, and this
   // changes the device pointer it returns.
   TEST_CASE(VirtualController_ForceFeedback_Nominal)
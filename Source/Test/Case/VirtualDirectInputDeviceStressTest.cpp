@@ -0,0 +1,415 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file VirtualDirectInputDeviceStressTest.cpp
+ *   Stress tests for DirectInput interface objects accessed concurrently by multiple application
+ *   threads while physical controller state is being published.
+ **************************************************************************************************/
+
+#include "VirtualDirectInputDevice.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ApiDirectInput.h"
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Mapper.h"
+#include "MockPhysicalController.h"
+#include "VirtualDirectInputEffect.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi;
+  using ::Xidi::Controller::AxisMapper;
+  using ::Xidi::Controller::ButtonMapper;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::EAxisDirection;
+  using ::Xidi::Controller::EButton;
+  using ::Xidi::Controller::EPhysicalButton;
+  using ::Xidi::Controller::EPhysicalDeviceStatus;
+  using ::Xidi::Controller::Mapper;
+  using ::Xidi::Controller::SPhysicalState;
+  using ::Xidi::Controller::TControllerIdentifier;
+  using ::Xidi::Controller::VirtualController;
+
+  /// Data packet structure definition used throughout these test cases.
+  struct SStressDataPacket
+  {
+    TAxisValue axisX;
+    TAxisValue axisY;
+    TAxisValue axisRotX;
+    TAxisValue axisRotY;
+    TButtonValue button[4];
+  };
+
+  static_assert(
+      0 == (sizeof(SStressDataPacket) % 4), "Test data packet size must be divisible by 4.");
+
+  /// Number of physical controllers whose virtual controllers are accessed concurrently.
+  static constexpr TControllerIdentifier kNumStressPhysicalControllers = 2;
+
+  /// Number of DirectInput device objects created for each physical controller.
+  static constexpr unsigned int kNumDevicesPerController = 2;
+
+  /// Number of application threads that concurrently access each DirectInput device object.
+  static constexpr unsigned int kNumThreadsPerDevice = 2;
+
+  /// Number of physical states published to each physical controller, at a rate of about one per
+  /// millisecond, over the course of a stress test.
+  static constexpr size_t kNumStressPhysicalStates = 1000;
+
+  /// Buffer size, in number of events, requested by each DirectInput device object.
+  static constexpr DWORD kStressBufferSize = 32;
+
+  /// Mapper used throughout these test cases. Both sticks map to axes with identical transforms
+  /// and two buttons are always pressed together, so that a consistent snapshot of state always
+  /// has pairs of matching values.
+  static const Mapper kStressMapper(
+      {.stickLeftX = std::make_unique<AxisMapper>(EAxis::X),
+       .stickLeftY = std::make_unique<AxisMapper>(EAxis::Y),
+       .stickRightX = std::make_unique<AxisMapper>(EAxis::RotX),
+       .stickRightY = std::make_unique<AxisMapper>(EAxis::RotY),
+       .buttonA = std::make_unique<ButtonMapper>(EButton::B1),
+       .buttonB = std::make_unique<ButtonMapper>(EButton::B2),
+       .buttonX = std::make_unique<ButtonMapper>(EButton::B3),
+       .buttonY = std::make_unique<ButtonMapper>(EButton::B4)},
+      {.leftMotor =
+           {.isPresent = true,
+            .mode = Controller::ForceFeedback::EActuatorMode::SingleAxis,
+            .singleAxis = {.axis = EAxis::X, .direction = EAxisDirection::Both}},
+       .rightMotor = {
+           .isPresent = true,
+           .mode = Controller::ForceFeedback::EActuatorMode::SingleAxis,
+           .singleAxis = {.axis = EAxis::Y, .direction = EAxisDirection::Both}}});
+
+  /// Object format specification for #SStressDataPacket.
+  static DIOBJECTDATAFORMAT stressObjectFormatSpec[] = {
+      {.pguid = &GUID_XAxis,
+       .dwOfs = offsetof(SStressDataPacket, axisX),
+       .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_YAxis,
+       .dwOfs = offsetof(SStressDataPacket, axisY),
+       .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_RxAxis,
+       .dwOfs = offsetof(SStressDataPacket, axisRotX),
+       .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_RyAxis,
+       .dwOfs = offsetof(SStressDataPacket, axisRotY),
+       .dwType = DIDFT_AXIS | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(SStressDataPacket, button[0]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(SStressDataPacket, button[1]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(SStressDataPacket, button[2]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0},
+      {.pguid = &GUID_Button,
+       .dwOfs = offsetof(SStressDataPacket, button[3]),
+       .dwType = DIDFT_BUTTON | DIDFT_ANYINSTANCE,
+       .dwFlags = 0}};
+
+  /// Complete application data format specification for #SStressDataPacket.
+  static constexpr DIDATAFORMAT kStressFormatSpec = {
+      .dwSize = sizeof(DIDATAFORMAT),
+      .dwObjSize = sizeof(DIOBJECTDATAFORMAT),
+      .dwFlags = DIDF_ABSAXIS,
+      .dwDataSize = sizeof(SStressDataPacket),
+      .dwNumObjs = _countof(stressObjectFormatSpec),
+      .rgodf = stressObjectFormatSpec};
+
+  /// Results collected by a single application thread over the course of a stress test.
+  struct SWorkerResult
+  {
+    /// Number of DirectInput method invocations.
+    uint64_t numOperations = 0;
+
+    /// Number of DirectInput method invocations that returned a failure code.
+    uint64_t numFailedOperations = 0;
+
+    /// Number of device state snapshots that were not internally consistent.
+    uint64_t numTornReads = 0;
+
+    /// Number of buffered events whose sequence numbers did not increase.
+    uint64_t numOutOfOrderEvents = 0;
+
+    /// Duration of every DirectInput method invocation, in nanoseconds.
+    std::vector<int64_t> latencyNanoseconds;
+  };
+
+  /// Creates the physical state with the specified index in the sequence of states published
+  /// during a stress test.
+  /// @param [in] index Position of the physical state in the sequence.
+  /// @return Physical state object.
+  static SPhysicalState MakeStressPhysicalState(size_t index)
+  {
+    const int16_t valueX = (int16_t)(((index * 7919) % 65536) - 32768);
+    const int16_t valueY = (int16_t)(((index * 104729) % 65536) - 32768);
+    const uint16_t buttons = ((0 == (index % 2))
+                                  ? 0
+                                  : ((1u << (unsigned int)EPhysicalButton::A) |
+                                     (1u << (unsigned int)EPhysicalButton::B)));
+
+    return {
+        .deviceStatus = EPhysicalDeviceStatus::Ok,
+        .stick = {valueX, valueY, valueX, valueY},
+        .button = buttons};
+  }
+
+  /// Determines if the specified data packet could have been produced from a single physical
+  /// state created by #MakeStressPhysicalState.
+  /// @param [in] dataPacket Data packet to check.
+  /// @return `true` if its values are consistent, `false` if it is torn.
+  static bool IsStressDataPacketConsistent(const SStressDataPacket& dataPacket)
+  {
+    return (
+        (dataPacket.axisX == dataPacket.axisRotX) && (dataPacket.axisY == dataPacket.axisRotY) &&
+        (dataPacket.button[0] == dataPacket.button[1]));
+  }
+
+  /// Behaves like a game thread by repeatedly reading state and buffered events, changing a
+  /// property, and updating a force feedback effect, all on the same DirectInput device object,
+  /// until told to stop.
+  /// @param [in] diController DirectInput device object to access.
+  /// @param [in] stopRequested Flag that becomes `true` once the thread should stop.
+  /// @param [out] result Results collected by the thread.
+  static void RunStressWorker(
+      VirtualDirectInputDevice<EDirectInputVersion::k8W>& diController,
+      const std::atomic<bool>& stopRequested,
+      SWorkerResult& result)
+  {
+    DWORD axes[] = {offsetof(SStressDataPacket, axisX), offsetof(SStressDataPacket, axisY)};
+    LONG directionCartesian[] = {1, 1};
+    DICONSTANTFORCE constantForceParams = {.lMagnitude = 5000};
+
+    const DIEFFECT effectParameters = {
+        .dwSize = sizeof(DIEFFECT),
+        .dwFlags = (DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS),
+        .dwDuration = 1000000,
+        .cAxes = _countof(axes),
+        .rgdwAxes = axes,
+        .rglDirection = directionCartesian,
+        .cbTypeSpecificParams = sizeof(DICONSTANTFORCE),
+        .lpvTypeSpecificParams = (LPVOID)&constantForceParams};
+
+    LPDIRECTINPUTEFFECT diEffect = nullptr;
+    if (DI_OK !=
+        diController.CreateEffect(GUID_ConstantForce, &effectParameters, &diEffect, nullptr))
+    {
+      result.numFailedOperations += 1;
+      return;
+    }
+
+    std::array<DIDEVICEOBJECTDATA, kStressBufferSize> objectData;
+    bool hasLastSequence = false;
+    DWORD lastSequence = 0;
+
+    for (uint64_t iteration = 0; false == stopRequested.load(std::memory_order_relaxed);
+         ++iteration)
+    {
+      HRESULT operationResult = DI_OK;
+      const auto operationStartTime = std::chrono::steady_clock::now();
+
+      switch (iteration % 8)
+      {
+        case 5:
+        {
+          DWORD numObjectDataElements = (DWORD)objectData.size();
+          operationResult = diController.GetDeviceData(
+              sizeof(DIDEVICEOBJECTDATA), objectData.data(), &numObjectDataElements, 0);
+
+          for (DWORD i = 0; i < numObjectDataElements; ++i)
+          {
+            if ((true == hasLastSequence) && (objectData[i].dwSequence <= lastSequence))
+              result.numOutOfOrderEvents += 1;
+
+            hasLastSequence = true;
+            lastSequence = objectData[i].dwSequence;
+          }
+          break;
+        }
+
+        case 6:
+        {
+          const DIPROPDWORD deadzoneProperty = {
+              .diph =
+                  {.dwSize = sizeof(DIPROPDWORD),
+                   .dwHeaderSize = sizeof(DIPROPHEADER),
+                   .dwObj = 0,
+                   .dwHow = DIPH_DEVICE},
+              .dwData = ((0 == (iteration % 16)) ? 0 : 1000u)};
+          operationResult =
+              diController.SetProperty(DIPROP_DEADZONE, (LPCDIPROPHEADER)&deadzoneProperty);
+          break;
+        }
+
+        case 7:
+        {
+          DICONSTANTFORCE updatedConstantForceParams = {
+              .lMagnitude = (LONG)(iteration % DI_FFNOMINALMAX)};
+          const DIEFFECT updatedEffectParameters = {
+              .dwSize = sizeof(DIEFFECT),
+              .cbTypeSpecificParams = sizeof(DICONSTANTFORCE),
+              .lpvTypeSpecificParams = (LPVOID)&updatedConstantForceParams};
+          operationResult =
+              diEffect->SetParameters(&updatedEffectParameters, DIEP_TYPESPECIFICPARAMS);
+          break;
+        }
+
+        default:
+        {
+          SStressDataPacket dataPacket = {};
+          operationResult = diController.GetDeviceState(sizeof(dataPacket), &dataPacket);
+          if ((SUCCEEDED(operationResult)) && (false == IsStressDataPacketConsistent(dataPacket)))
+            result.numTornReads += 1;
+          break;
+        }
+      }
+
+      result.latencyNanoseconds.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - operationStartTime)
+              .count());
+      result.numOperations += 1;
+      if (FAILED(operationResult)) result.numFailedOperations += 1;
+    }
+
+    diEffect->Release();
+  }
+
+  // Creates multiple DirectInput device objects for each of multiple physical controllers and
+  // has multiple application threads access each of them concurrently, while physical controller
+  // state is published and force feedback effects are played at about 1 kHz. No thread should
+  // ever observe a torn state snapshot, out-of-order buffered events, or a failed method
+  // invocation. Throughput and latency are reported for informational purposes.
+  TEST_CASE(VirtualDirectInputDeviceStress_MultipleDevicesMultipleThreads)
+  {
+    std::vector<SPhysicalState> physicalStates;
+    for (size_t i = 0; i < kNumStressPhysicalStates; ++i)
+      physicalStates.push_back(MakeStressPhysicalState(i));
+
+    std::vector<std::unique_ptr<MockPhysicalController>> physicalControllers;
+    for (TControllerIdentifier i = 0; i < kNumStressPhysicalControllers; ++i)
+      physicalControllers.push_back(std::make_unique<MockPhysicalController>(
+          i, kStressMapper, physicalStates.data(), physicalStates.size()));
+
+    constexpr DIPROPDWORD kBufferSizeProperty = {
+        .diph =
+            {.dwSize = sizeof(DIPROPDWORD),
+             .dwHeaderSize = sizeof(DIPROPHEADER),
+             .dwObj = 0,
+             .dwHow = DIPH_DEVICE},
+        .dwData = kStressBufferSize};
+
+    std::vector<std::unique_ptr<VirtualDirectInputDevice<EDirectInputVersion::k8W>>> diControllers;
+    for (TControllerIdentifier i = 0; i < kNumStressPhysicalControllers; ++i)
+    {
+      for (unsigned int j = 0; j < kNumDevicesPerController; ++j)
+      {
+        auto diController = std::make_unique<VirtualDirectInputDevice<EDirectInputVersion::k8W>>(
+            std::make_unique<VirtualController>(i));
+        TEST_ASSERT(DI_OK == diController->SetDataFormat(&kStressFormatSpec));
+        TEST_ASSERT(
+            DI_OK ==
+            diController->SetProperty(
+                DIPROP_BUFFERSIZE, (LPCDIPROPHEADER)&kBufferSizeProperty));
+        TEST_ASSERT(
+            DI_OK ==
+            diController->SetCooperativeLevel(nullptr, DISCL_EXCLUSIVE | DISCL_FOREGROUND));
+        TEST_ASSERT(DI_OK == diController->Acquire());
+        diControllers.push_back(std::move(diController));
+      }
+    }
+
+    std::atomic<bool> stopRequested = false;
+    std::vector<SWorkerResult> workerResults(diControllers.size() * kNumThreadsPerDevice);
+    std::vector<std::thread> workerThreads;
+    for (size_t i = 0; i < workerResults.size(); ++i)
+      workerThreads.emplace_back(
+          RunStressWorker,
+          std::ref(*diControllers[i / kNumThreadsPerDevice]),
+          std::cref(stopRequested),
+          std::ref(workerResults[i]));
+
+    const auto stressStartTime = std::chrono::steady_clock::now();
+
+    for (size_t i = 1; i < kNumStressPhysicalStates; ++i)
+    {
+      for (auto& physicalController : physicalControllers)
+      {
+        physicalController->RequestAdvancePhysicalState();
+        physicalController->GetForceFeedbackDevice().PlayEffects(
+            (Controller::ForceFeedback::TEffectTimeMs)i);
+      }
+
+      Sleep(1);
+    }
+
+    stopRequested = true;
+    for (auto& workerThread : workerThreads)
+      workerThread.join();
+
+    const double stressDurationSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - stressStartTime).count();
+
+    SWorkerResult totals;
+    for (const auto& workerResult : workerResults)
+    {
+      totals.numOperations += workerResult.numOperations;
+      totals.numFailedOperations += workerResult.numFailedOperations;
+      totals.numTornReads += workerResult.numTornReads;
+      totals.numOutOfOrderEvents += workerResult.numOutOfOrderEvents;
+      totals.latencyNanoseconds.insert(
+          totals.latencyNanoseconds.end(),
+          workerResult.latencyNanoseconds.cbegin(),
+          workerResult.latencyNanoseconds.cend());
+    }
+
+    TEST_ASSERT(false == totals.latencyNanoseconds.empty());
+    std::sort(totals.latencyNanoseconds.begin(), totals.latencyNanoseconds.end());
+
+    const auto latencyPercentile = [&totals](double percentile) -> long long
+    {
+      return (long long)totals.latencyNanoseconds[(size_t)(
+          percentile * (double)(totals.latencyNanoseconds.size() - 1))];
+    };
+
+    Infra::Test::PrintFormatted(
+        L"%u threads, %llu operations in %.2f seconds (%.0f per second), latency p50 %lld ns, p99 %lld ns, p99.9 %lld ns, maximum %lld ns.",
+        (unsigned int)workerThreads.size(),
+        (unsigned long long)totals.numOperations,
+        stressDurationSeconds,
+        (double)totals.numOperations / stressDurationSeconds,
+        latencyPercentile(0.5),
+        latencyPercentile(0.99),
+        latencyPercentile(0.999),
+        (long long)totals.latencyNanoseconds.back());
+
+    TEST_ASSERT(0 == totals.numTornReads);
+    TEST_ASSERT(0 == totals.numOutOfOrderEvents);
+    TEST_ASSERT(0 == totals.numFailedOperations);
+  }
+} // namespace XidiTest
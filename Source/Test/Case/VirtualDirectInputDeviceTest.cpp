@@ -690,6 +690,30 @@ namespace XidiTest
     TEST_ASSERT(actualNumCallbacks == expectedNumCallbacks);
   }
 
+  // Enumerates the same objects both before and after the data format is set. Object instance
+  // information is prepared ahead of time, so this verifies that offsets nonetheless reflect the
+  // data format in effect when enumeration happens.
+  TEST_CASE(VirtualDirectInputDevice_EnumObjects_DataFormatChanged)
+  {
+    const auto kGetPovOffset = [](LPCDIDEVICEOBJECTINSTANCE lpddoi, LPVOID pvRef) -> BOOL
+    {
+      if (GUID_POV == lpddoi->guidType) *((DWORD*)pvRef) = lpddoi->dwOfs;
+      return DIENUM_CONTINUE;
+    };
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
+
+    DWORD actualOffset = DataFormat::kInvalidOffsetValue;
+    TEST_ASSERT(DI_OK == diController.EnumObjects(kGetPovOffset, &actualOffset, DIDFT_POV));
+    TEST_ASSERT(DataFormat::kInvalidOffsetValue != actualOffset);
+    TEST_ASSERT(offsetof(STestDataPacket, pov) != actualOffset);
+
+    TEST_ASSERT(DI_OK == diController.SetDataFormat(&kTestFormatSpec));
+    TEST_ASSERT(DI_OK == diController.EnumObjects(kGetPovOffset, &actualOffset, DIDFT_POV));
+    TEST_ASSERT(offsetof(STestDataPacket, pov) == actualOffset);
+  }
+
   // Nominal behavior in which a structure is passed, properly initialized with the size member set.
   // Expected outcome is the structure is filled with corrrect controller capabilities.
   TEST_CASE(VirtualDirectInputDevice_GetCapabilities_Nominal)
@@ -823,6 +847,33 @@ namespace XidiTest
     TEST_ASSERT(0 == memcmp(&actualDeviceInfo, &expectedDeviceInfo, sizeof(expectedDeviceInfo)));
   }
 
+  // Older version of the structure is passed. Expected outcome is the size member and the part of
+  // the structure that does not exist in the older version are left unchanged, and repeated
+  // requests produce identical results.
+  TEST_CASE(VirtualDirectInputDevice_GetDeviceInfo_LegacyRemainderUntouched)
+  {
+    constexpr uint8_t kPoisonByte = 0xcd;
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
+
+    DIDEVICEINSTANCE firstDeviceInfo;
+    FillMemory(&firstDeviceInfo, sizeof(firstDeviceInfo), kPoisonByte);
+    firstDeviceInfo.dwSize = sizeof(DIDEVICEINSTANCE_DX3);
+    TEST_ASSERT(DI_OK == diController.GetDeviceInfo(&firstDeviceInfo));
+    TEST_ASSERT(sizeof(DIDEVICEINSTANCE_DX3) == firstDeviceInfo.dwSize);
+
+    const uint8_t* const firstDeviceInfoBytes = reinterpret_cast<const uint8_t*>(&firstDeviceInfo);
+    for (size_t i = sizeof(DIDEVICEINSTANCE_DX3); i < sizeof(firstDeviceInfo); ++i)
+      TEST_ASSERT(kPoisonByte == firstDeviceInfoBytes[i]);
+
+    DIDEVICEINSTANCE secondDeviceInfo;
+    FillMemory(&secondDeviceInfo, sizeof(secondDeviceInfo), kPoisonByte);
+    secondDeviceInfo.dwSize = sizeof(DIDEVICEINSTANCE_DX3);
+    TEST_ASSERT(DI_OK == diController.GetDeviceInfo(&secondDeviceInfo));
+    TEST_ASSERT(0 == memcmp(&firstDeviceInfo, &secondDeviceInfo, sizeof(firstDeviceInfo)));
+  }
+
   // A null pointer is passed. This is expected to cause the method to fail.
   TEST_CASE(VirtualDirectInputDevice_GetDeviceInfo_BadPointer)
   {
@@ -1070,6 +1121,64 @@ namespace XidiTest
             sizeof(kExpectedDataPacketResult)));
   }
 
+  // Device state is retrieved repeatedly into different buffers, both before and after the
+  // controller state changes. Every retrieval is expected to produce a complete and up-to-date data
+  // packet, regardless of whether it was produced from a cached copy.
+  TEST_CASE(VirtualDirectInputDevice_GetDeviceState_Repeated)
+  {
+    constexpr SPhysicalState kPhysicalStates[] = {
+        {.deviceStatus = EPhysicalDeviceStatus::Ok,
+         .stick = {-1234, 0, 5678, 0},
+         .button = ButtonSet({EPhysicalButton::A, EPhysicalButton::X})},
+        {.deviceStatus = EPhysicalDeviceStatus::Ok,
+         .stick = {4321, 0, 5678, 0},
+         .button = ButtonSet({EPhysicalButton::B})}};
+
+    // Based on the mapper defined at the top of this file. POV is filled in to reflect its centered
+    // state.
+    constexpr STestDataPacket kExpectedDataPacketResults[] = {
+        {.axisX = -1234,
+         .pov = EPovValue::Center,
+         .button =
+             {DataFormat::kButtonValuePressed,
+              DataFormat::kButtonValueNotPressed,
+              DataFormat::kButtonValuePressed,
+              DataFormat::kButtonValueNotPressed}},
+        {.axisX = 4321,
+         .pov = EPovValue::Center,
+         .button = {
+             DataFormat::kButtonValueNotPressed,
+             DataFormat::kButtonValuePressed,
+             DataFormat::kButtonValueNotPressed,
+             DataFormat::kButtonValueNotPressed}}};
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
+    TEST_ASSERT(DI_OK == diController.SetDataFormat(&kTestFormatSpec));
+
+    for (int i = 0; i < _countof(kPhysicalStates); ++i)
+    {
+      diController.GetVirtualController().RefreshState(
+          kTestMapper.MapStatePhysicalToVirtual(kPhysicalStates[i], kTestControllerIdentifier));
+
+      STestDataPacket actualDataPacketResults[3];
+      FillMemory(actualDataPacketResults, sizeof(actualDataPacketResults), 0xcd);
+
+      for (auto& actualDataPacketResult : actualDataPacketResults)
+      {
+        TEST_ASSERT(
+            DI_OK ==
+            diController.GetDeviceState(sizeof(actualDataPacketResult), &actualDataPacketResult));
+        TEST_ASSERT(
+            0 ==
+            memcmp(
+                &actualDataPacketResult,
+                &kExpectedDataPacketResults[i],
+                sizeof(kExpectedDataPacketResults[i])));
+      }
+    }
+  }
+
   // Data format is not set before requesting device state.
   // Method is expected to fail.
   TEST_CASE(VirtualDirectInputDevice_GetDeviceState_DataFormatNotSet)
@@ -2041,6 +2150,137 @@ namespace XidiTest
         DIPROP_AUTOCENTER, DIPROPAUTOCENTER_OFF, DIPROPAUTOCENTER_ON, DIPH_DEVICE);
   }
 
+  // Exercises the Xidi-specific polling policy property. Polling period requests from multiple
+  // devices associated with the same physical controller should be arbitrated such that the
+  // shortest request wins, and each request should be withdrawn when the device that made it
+  // withdraws it explicitly or is destroyed.
+  TEST_CASE(VirtualDirectInputDevice_Properties_PollingPolicy)
+  {
+    constexpr DIPROPHEADER kPollingPolicyHeader = {
+        .dwSize = sizeof(DIPROPXIDIPOLLINGPOLICY),
+        .dwHeaderSize = sizeof(DIPROPHEADER),
+        .dwObj = 0,
+        .dwHow = DIPH_DEVICE};
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
+    DIPROPXIDIPOLLINGPOLICY propertyValue;
+
+    // Without any requests the default polling period should be in effect.
+    propertyValue = {.diph = kPollingPolicyHeader};
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPDIPROPHEADER)&propertyValue));
+    TEST_ASSERT(
+        Controller::kPhysicalPollingPeriodMilliseconds ==
+        propertyValue.dwPollingPeriodMilliseconds);
+    const DWORD kDefaultStateChangeEventPeriod = propertyValue.dwStateChangeEventPeriodMilliseconds;
+
+    // Request faster polling and a custom state change event period.
+    propertyValue = {
+        .diph = kPollingPolicyHeader,
+        .dwPollingPeriodMilliseconds = 3,
+        .dwStateChangeEventPeriodMilliseconds = 10};
+    TEST_ASSERT(
+        DI_OK ==
+        diController.SetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPCDIPROPHEADER)&propertyValue));
+
+    propertyValue = {.diph = kPollingPolicyHeader};
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPDIPROPHEADER)&propertyValue));
+    TEST_ASSERT(3 == propertyValue.dwPollingPeriodMilliseconds);
+    TEST_ASSERT(10 == propertyValue.dwStateChangeEventPeriodMilliseconds);
+
+    {
+      // A faster request from another device wins, but it does not affect the state change event
+      // period of the first device.
+      VirtualDirectInputDevice<EDirectInputVersion::k8W> diControllerOther(
+          CreateTestVirtualController());
+
+      propertyValue = {
+          .diph = kPollingPolicyHeader,
+          .dwPollingPeriodMilliseconds = 1,
+          .dwStateChangeEventPeriodMilliseconds = DIPROPXIDI_STATECHANGEEVENTPERIOD_DEFAULT};
+      TEST_ASSERT(
+          DI_OK ==
+          diControllerOther.SetProperty(
+              DIPROP_XIDI_POLLINGPOLICY, (LPCDIPROPHEADER)&propertyValue));
+
+      propertyValue = {.diph = kPollingPolicyHeader};
+      TEST_ASSERT(
+          DI_OK ==
+          diController.GetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPDIPROPHEADER)&propertyValue));
+      TEST_ASSERT(1 == propertyValue.dwPollingPeriodMilliseconds);
+      TEST_ASSERT(10 == propertyValue.dwStateChangeEventPeriodMilliseconds);
+    }
+
+    // Destroying the other device withdraws its request.
+    propertyValue = {.diph = kPollingPolicyHeader};
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPDIPROPHEADER)&propertyValue));
+    TEST_ASSERT(3 == propertyValue.dwPollingPeriodMilliseconds);
+
+    // Explicitly withdrawing the last request restores the defaults.
+    propertyValue = {
+        .diph = kPollingPolicyHeader,
+        .dwPollingPeriodMilliseconds = 0,
+        .dwStateChangeEventPeriodMilliseconds = DIPROPXIDI_STATECHANGEEVENTPERIOD_DEFAULT};
+    TEST_ASSERT(
+        DI_OK ==
+        diController.SetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPCDIPROPHEADER)&propertyValue));
+
+    propertyValue = {.diph = kPollingPolicyHeader};
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPDIPROPHEADER)&propertyValue));
+    TEST_ASSERT(
+        Controller::kPhysicalPollingPeriodMilliseconds ==
+        propertyValue.dwPollingPeriodMilliseconds);
+    TEST_ASSERT(
+        kDefaultStateChangeEventPeriod == propertyValue.dwStateChangeEventPeriodMilliseconds);
+  }
+
+  // Verifies that invalid uses of the Xidi-specific polling policy property are rejected.
+  TEST_CASE(VirtualDirectInputDevice_Properties_PollingPolicyInvalid)
+  {
+    constexpr DIPROPHEADER kPollingPolicyHeader = {
+        .dwSize = sizeof(DIPROPXIDIPOLLINGPOLICY),
+        .dwHeaderSize = sizeof(DIPROPHEADER),
+        .dwObj = 0,
+        .dwHow = DIPH_DEVICE};
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
+
+    // Polling period is out of range.
+    DIPROPXIDIPOLLINGPOLICY propertyValue = {
+        .diph = kPollingPolicyHeader, .dwPollingPeriodMilliseconds = 1001};
+    TEST_ASSERT(
+        DIERR_INVALIDPARAM ==
+        diController.SetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPCDIPROPHEADER)&propertyValue));
+
+    // Property is exclusively a device-wide property.
+    propertyValue = {.diph = kPollingPolicyHeader, .dwPollingPeriodMilliseconds = 1};
+    propertyValue.diph.dwHow = DIPH_BYOFFSET;
+    TEST_ASSERT(
+        DIERR_INVALIDPARAM ==
+        diController.SetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPCDIPROPHEADER)&propertyValue));
+
+    // Property uses its own structure rather than DIPROPDWORD.
+    DIPROPDWORD wrongStructValue = {
+        .diph =
+            {.dwSize = sizeof(DIPROPDWORD),
+             .dwHeaderSize = sizeof(DIPROPHEADER),
+             .dwObj = 0,
+             .dwHow = DIPH_DEVICE},
+        .dwData = 1};
+    TEST_ASSERT(
+        DIERR_INVALIDPARAM ==
+        diController.SetProperty(DIPROP_XIDI_POLLINGPOLICY, (LPCDIPROPHEADER)&wrongStructValue));
+  }
+
   // Scopes are highly varied, so more details are provided with each test case.
 
   // Verifies that the GUIDs known to be supported are actually supported and objects with those
@@ -2178,7 +2418,11 @@ namespace XidiTest
         GUID_Triangle,
         GUID_SawtoothUp,
         GUID_SawtoothDown,
-        GUID_CustomForce};
+        GUID_CustomForce,
+        GUID_Spring,
+        GUID_Damper,
+        GUID_Inertia,
+        GUID_Friction};
     std::set<GUID> actualSeenGuids;
 
     for (const auto& expectedSeenGuid : kExpectedSeenGuids)
@@ -2189,11 +2433,6 @@ namespace XidiTest
         actualSeenGuids.insert(expectedSeenGuid);
     }
 
-    constexpr DWORD kExpectedEffectTypeFlags = (DIEFT_FFATTACK | DIEFT_FFFADE);
-    constexpr DWORD kExpectedEffectParams =
-        (DIEP_AXES | DIEP_DIRECTION | DIEP_DURATION | DIEP_ENVELOPE | DIEP_GAIN |
-         DIEP_SAMPLEPERIOD | DIEP_STARTDELAY | DIEP_TYPESPECIFICPARAMS);
-
     MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
     VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
     const HRESULT enumEffectsResult = diController.EnumEffects(
@@ -2204,6 +2443,17 @@ namespace XidiTest
           TEST_ASSERT((nullptr != pdei) && (nullptr != pvRef));
           TEST_ASSERT(sizeof(*pdei) == pdei->dwSize);
 
+          // Condition effects have no envelope but support all of the condition parameters.
+          const bool isConditionEffect = (DIEFT_CONDITION == DIEFT_GETTYPE(pdei->dwEffType));
+          const DWORD kExpectedEffectTypeFlags =
+              ((true == isConditionEffect) ? (DIEFT_SATURATION | DIEFT_POSNEGCOEFFICIENTS |
+                                              DIEFT_POSNEGSATURATION | DIEFT_DEADBAND)
+                                           : (DIEFT_FFATTACK | DIEFT_FFFADE));
+          const DWORD kExpectedEffectParams =
+              ((DIEP_AXES | DIEP_DIRECTION | DIEP_DURATION | DIEP_GAIN | DIEP_SAMPLEPERIOD |
+                DIEP_STARTDELAY | DIEP_TYPESPECIFICPARAMS) |
+               ((true == isConditionEffect) ? 0 : DIEP_ENVELOPE));
+
           TEST_ASSERT(kExpectedEffectTypeFlags == (pdei->dwEffType & kExpectedEffectTypeFlags));
           TEST_ASSERT(kExpectedEffectParams == (pdei->dwStaticParams & kExpectedEffectParams));
           TEST_ASSERT(kExpectedEffectParams == (pdei->dwDynamicParams & kExpectedEffectParams));
@@ -2417,6 +2667,47 @@ namespace XidiTest
     TEST_ASSERT(actualSeenGuids == kExpectedSeenGuids);
   }
 
+  // Enumerates condition effects only and verifies correct information is provided.
+  TEST_CASE(VirtualDirectInputDevice_ForceFeedback_EnumCondition)
+  {
+    const std::set<GUID> kExpectedSeenGuids = {
+        GUID_Spring, GUID_Damper, GUID_Inertia, GUID_Friction};
+    std::set<GUID> actualSeenGuids;
+
+    for (const auto& expectedSeenGuid : kExpectedSeenGuids)
+    {
+      if (false ==
+          VirtualDirectInputDevice<EDirectInputVersion::k8W>::ForceFeedbackEffectCanCreateObject(
+              expectedSeenGuid))
+        actualSeenGuids.insert(expectedSeenGuid);
+    }
+
+    constexpr DWORD kExpectedEffectType = DIEFT_CONDITION;
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<EDirectInputVersion::k8W> diController(CreateTestVirtualController());
+    const HRESULT enumEffectsResult = diController.EnumEffects(
+        [](LPCDIEFFECTINFO pdei, LPVOID pvRef) -> BOOL
+        {
+          std::set<GUID>& seenGuids = *((std::set<GUID>*)pvRef);
+
+          TEST_ASSERT((nullptr != pdei) && (nullptr != pvRef));
+          TEST_ASSERT(sizeof(*pdei) == pdei->dwSize);
+
+          TEST_ASSERT(kExpectedEffectType == DIEFT_GETTYPE(pdei->dwEffType));
+
+          TEST_ASSERT(false == seenGuids.contains(pdei->guid));
+          seenGuids.insert(pdei->guid);
+
+          return DIENUM_CONTINUE;
+        },
+        (LPVOID)&actualSeenGuids,
+        kExpectedEffectType);
+
+    TEST_ASSERT(DI_OK == enumEffectsResult);
+    TEST_ASSERT(actualSeenGuids == kExpectedSeenGuids);
+  }
+
   // Attempts to enumerate unsupported types of effects, which should result in no calls to the
   // enumeration callback.
   TEST_CASE(VirtualDirectInputDevice_ForceFeedback_EnumNone)
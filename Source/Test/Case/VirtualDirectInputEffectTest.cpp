@@ -11,6 +11,7 @@
 
 #include "VirtualDirectInputEffect.h"
 
+#include <cstring>
 #include <memory>
 
 #include <Infra/Test/TestCase.h>
@@ -18,6 +19,7 @@
 #include "ApiDirectInput.h"
 #include "ApiGUID.h"
 #include "ControllerTypes.h"
+#include "ForceFeedbackEffect.h"
 #include "Mapper.h"
 #include "MockForceFeedbackEffect.h"
 #include "MockPhysicalController.h"
@@ -851,6 +853,40 @@ namespace XidiTest
     TEST_ASSERT(actualTypeSpecificParameters == expectedTypeSpecificParameters);
   }
 
+  // Attempts to set multiple parameters at once, one of which is invalid, and then sets only a
+  // valid subset of them. Verifies that the rejected attempt leaves no trace, neither in the
+  // effect itself nor in any subsequent successful parameter update.
+  TEST_CASE(VirtualDirectInputEffect_SetParameters_RejectedUpdateDiscarded)
+  {
+    auto physicalController = CreateMockPhysicalController();
+    auto diDevice = CreateAndAcquireTestDirectInputDevice(*physicalController);
+    auto diEffect = CreateTestDirectInputEffect(*diDevice);
+
+    MockEffectWithTypeSpecificParameters& ffEffect =
+        (MockEffectWithTypeSpecificParameters&)diEffect->UnderlyingEffect();
+
+    constexpr TEffectValue kDuration = 1000;
+    constexpr TEffectValue kInvalidGain =
+        ::Xidi::Controller::ForceFeedback::kEffectModifierMaximum + 1;
+    constexpr DIEFFECT kInvalidParameters = {
+        .dwSize = sizeof(DIEFFECT),
+        .dwDuration = (DWORD)kDuration * 1000,
+        .dwGain = (DWORD)kInvalidGain};
+    TEST_ASSERT(
+        DIERR_INVALIDPARAM ==
+        diEffect->SetParametersInternal(
+            &kInvalidParameters, (DIEP_DURATION | DIEP_GAIN | DIEP_NODOWNLOAD)));
+    TEST_ASSERT(false == ffEffect.HasDuration());
+
+    constexpr TEffectValue kGain = 1000;
+    constexpr DIEFFECT kValidParameters = {.dwSize = sizeof(DIEFFECT), .dwGain = (DWORD)kGain};
+    TEST_ASSERT(
+        DI_DOWNLOADSKIPPED ==
+        diEffect->SetParametersInternal(&kValidParameters, (DIEP_GAIN | DIEP_NODOWNLOAD)));
+    TEST_ASSERT(kGain == ffEffect.GetGain());
+    TEST_ASSERT(false == ffEffect.HasDuration());
+  }
+
   // Specifies a complete set of parameters and automatically downloads, but does not start, the
   // effect.
   TEST_CASE(VirtualDirectInputEffect_SetParameters_CompleteAndDownload)
@@ -1472,4 +1508,100 @@ namespace XidiTest
     TEST_ASSERT(DIERR_MOREDATA == diEffect->GetParameters(&parameters, DIEP_TYPESPECIFICPARAMS));
     TEST_ASSERT(sizeof(SMockTypeSpecificParameters) == parameters.cbTypeSpecificParams);
   }
+
+  // Custom force effect type-specific parameters. Samples should be copied in once and retrieved
+  // into a buffer supplied by the application, and setting the same samples again should keep
+  // the existing sample buffer.
+  TEST_CASE(VirtualDirectInputEffect_TypeSpecific_CustomForceRoundTrip)
+  {
+    auto physicalController = CreateMockPhysicalController();
+    auto diDevice = CreateAndAcquireTestDirectInputDevice(*physicalController);
+    auto diEffect = std::make_unique<CustomForceDirectInputEffect<EDirectInputVersion::kLegacyW>>(
+        *diDevice, Controller::ForceFeedback::CustomForceEffect(), GUID_CustomForce);
+
+    Controller::ForceFeedback::CustomForceEffect& ffEffect =
+        (Controller::ForceFeedback::CustomForceEffect&)diEffect->UnderlyingEffect();
+
+    LONG expectedSamples[] = {1000, -2000, 3000, -4000};
+    DICUSTOMFORCE expectedCustomForce = {
+        .cChannels = 1,
+        .dwSamplePeriod = 20000,
+        .cSamples = _countof(expectedSamples),
+        .rglForceData = expectedSamples};
+    DIEFFECT setParameters = {
+        .dwSize = sizeof(DIEFFECT),
+        .cbTypeSpecificParams = sizeof(expectedCustomForce),
+        .lpvTypeSpecificParams = &expectedCustomForce};
+    TEST_ASSERT(
+        DI_DOWNLOADSKIPPED ==
+        diEffect->SetParametersInternal(
+            &setParameters, (DIEP_TYPESPECIFICPARAMS | DIEP_NODOWNLOAD)));
+
+    const auto originalSamples = ffEffect.GetTypeSpecificParameters()->samples;
+    TEST_ASSERT(20 == ffEffect.GetTypeSpecificParameters()->samplePeriod);
+
+    TEST_ASSERT(
+        DI_DOWNLOADSKIPPED ==
+        diEffect->SetParametersInternal(
+            &setParameters, (DIEP_TYPESPECIFICPARAMS | DIEP_NODOWNLOAD)));
+    TEST_ASSERT(originalSamples == ffEffect.GetTypeSpecificParameters()->samples);
+
+    DICUSTOMFORCE actualCustomForce = {};
+    DIEFFECT getParameters = {
+        .dwSize = sizeof(DIEFFECT),
+        .cbTypeSpecificParams = sizeof(actualCustomForce),
+        .lpvTypeSpecificParams = &actualCustomForce};
+    TEST_ASSERT(
+        DIERR_MOREDATA == diEffect->GetParameters(&getParameters, DIEP_TYPESPECIFICPARAMS));
+    TEST_ASSERT(expectedCustomForce.cSamples == actualCustomForce.cSamples);
+
+    LONG actualSamples[_countof(expectedSamples)] = {};
+    actualCustomForce.rglForceData = actualSamples;
+    TEST_ASSERT(DI_OK == diEffect->GetParameters(&getParameters, DIEP_TYPESPECIFICPARAMS));
+    TEST_ASSERT(expectedCustomForce.cChannels == actualCustomForce.cChannels);
+    TEST_ASSERT(expectedCustomForce.dwSamplePeriod == actualCustomForce.dwSamplePeriod);
+    TEST_ASSERT(0 == memcmp(actualSamples, expectedSamples, sizeof(expectedSamples)));
+  }
+
+  // Condition effect type-specific parameters, one condition per axis. These should be accepted in
+  // the array form that DirectInput uses and retrieved in the same form.
+  TEST_CASE(VirtualDirectInputEffect_TypeSpecific_ConditionRoundTrip)
+  {
+    auto physicalController = CreateMockPhysicalController();
+    auto diDevice = CreateAndAcquireTestDirectInputDevice(*physicalController);
+    auto diEffect = std::make_unique<ConditionDirectInputEffect<EDirectInputVersion::kLegacyW>>(
+        *diDevice, Controller::ForceFeedback::SpringEffect(), GUID_Spring);
+
+    DICONDITION expectedConditions[] = {
+        {.lOffset = 100,
+         .lPositiveCoefficient = 2000,
+         .lNegativeCoefficient = -3000,
+         .dwPositiveSaturation = 4000,
+         .dwNegativeSaturation = 5000,
+         .lDeadBand = 600},
+        {.lOffset = -700,
+         .lPositiveCoefficient = 800,
+         .lNegativeCoefficient = 900,
+         .dwPositiveSaturation = 10000,
+         .dwNegativeSaturation = 0,
+         .lDeadBand = 0}};
+    DIEFFECT setParameters = {
+        .dwSize = sizeof(DIEFFECT),
+        .cbTypeSpecificParams = sizeof(expectedConditions),
+        .lpvTypeSpecificParams = expectedConditions};
+    TEST_ASSERT(
+        DI_DOWNLOADSKIPPED ==
+        diEffect->SetParametersInternal(
+            &setParameters, (DIEP_TYPESPECIFICPARAMS | DIEP_NODOWNLOAD)));
+
+    DIEFFECT getParameters = {.dwSize = sizeof(DIEFFECT), .cbTypeSpecificParams = 0};
+    TEST_ASSERT(
+        DIERR_MOREDATA == diEffect->GetParameters(&getParameters, DIEP_TYPESPECIFICPARAMS));
+    TEST_ASSERT(sizeof(expectedConditions) == getParameters.cbTypeSpecificParams);
+
+    DICONDITION actualConditions[_countof(expectedConditions)] = {};
+    getParameters.lpvTypeSpecificParams = actualConditions;
+    TEST_ASSERT(DI_OK == diEffect->GetParameters(&getParameters, DIEP_TYPESPECIFICPARAMS));
+    TEST_ASSERT(0 == memcmp(actualConditions, expectedConditions, sizeof(expectedConditions)));
+  }
 } // namespace XidiTest
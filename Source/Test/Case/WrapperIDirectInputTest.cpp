@@ -228,7 +228,7 @@ namespace XidiTest
     inline EnumerationState(
         EExpectedEnumerationOrder expectedOrder,
         size_t expectedNumSystemDevices = 0,
-        size_t expectedNumXidiVirtualControllers = Controller::kPhysicalControllerCount)
+        size_t expectedNumXidiVirtualControllers = Controller::kDefaultPhysicalControllerCount)
         : kExpectedOrder(expectedOrder),
           kExpectedNumSystemDevices(expectedNumSystemDevices),
           kExpectedNumXidiVirtualControllers(expectedNumXidiVirtualControllers),
@@ -397,6 +397,59 @@ namespace XidiTest
             &mockDirectInput));
   }
 
+  /// Mock DirectInput interface object handed out by #CreateDeferredMockDirectInput.
+  static MockDirectInput* deferredMockDirectInput = nullptr;
+
+  /// Number of times #CreateDeferredMockDirectInput has been invoked.
+  static unsigned int numDeferredMockDirectInputCreates = 0;
+
+  /// Stands in for the system function that creates a DirectInput interface object, for test
+  /// wrapper objects that create their underlying objects only when needed.
+  static HRESULT CreateDeferredMockDirectInput(
+      HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID* ppvOut, LPUNKNOWN punkOuter)
+  {
+    numDeferredMockDirectInputCreates += 1;
+    *ppvOut = deferredMockDirectInput;
+    return DI_OK;
+  }
+
+  // Verifies that a wrapper object that creates its underlying object only when needed does not
+  // do so for requests that involve only Xidi virtual controllers, but does so exactly once as
+  // soon as a request involves system devices.
+  TEST_CASE(WrapperIDirectInput_DeferredCreate_OnlyWhenSystemDevicesNeeded)
+  {
+    MockDirectInput mockDirectInput({kXboxOneWirelessXInputController});
+    deferredMockDirectInput = &mockDirectInput;
+    numDeferredMockDirectInputCreates = 0;
+
+    WrapperIDirectInput<EDirectInputVersion::k8W> testDirectInput(SUnderlyingDIObjectCreateParams{
+        .createFunc = &CreateDeferredMockDirectInput,
+        .hinst = nullptr,
+        .dwVersion = DIRECTINPUT_VERSION,
+        .riidltf = IID_IDirectInput8W,
+        .punkOuter = nullptr});
+
+    TEST_ASSERT(DI_OK == testDirectInput.GetDeviceStatus(VirtualControllerGuid(0)));
+    TEST_ASSERT(false == testDirectInput.HasUnderlyingDIObject());
+    TEST_ASSERT(0 == numDeferredMockDirectInputCreates);
+
+    for (int i = 0; i < 2; ++i)
+    {
+      EnumerationState enumerationState(EExpectedEnumerationOrder::XidiVirtualControllersFirst);
+      TEST_ASSERT(
+          DI_OK ==
+          testDirectInput.EnumDevices(
+              DI8DEVCLASS_GAMECTRL,
+              &EnumerationState::CheckEnumeratedDeviceCallback,
+              &enumerationState,
+              DIEDFL_ATTACHEDONLY));
+      TEST_ASSERT(enumerationState.EnumerationComplete());
+    }
+
+    TEST_ASSERT(true == testDirectInput.HasUnderlyingDIObject());
+    TEST_ASSERT(1 == numDeferredMockDirectInputCreates);
+  }
+
   // Verifies that Xidi rejects attempts to create a device object directly by GUID when the device
   // in question supports XInput. These devices are not enumerated and, for all intents and
   // purposes, do not exist in the system when Xidi is in use.
@@ -502,6 +555,34 @@ namespace XidiTest
     TEST_ASSERT(enumerationState.EnumerationComplete());
   }
 
+  // Same as above, but the application enumerates devices multiple times using the same object.
+  // Later enumerations may be served from cached results, but they should be indistinguishable
+  // from the first.
+  TEST_CASE(WrapperIDirectInput_EnumDevices_MixedSystemDevicesRepeated)
+  {
+    MockDirectInput mockDirectInput(
+        {kGenericNoForceFeedbackNonXInputController,
+         kXboxOneBluetoothXInputController,
+         kLogitechRumblepadNonXInputController});
+    auto testDirectInput = MakeTestWrapperIDirectInput(mockDirectInput);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      EnumerationState enumerationState(
+          EExpectedEnumerationOrder::XidiVirtualControllersFirst,
+          GetNonXInputSystemDeviceCount(mockDirectInput));
+
+      TEST_ASSERT(
+          DI_OK ==
+          testDirectInput.EnumDevices(
+              DI8DEVCLASS_GAMECTRL,
+              &EnumerationState::CheckEnumeratedDeviceCallback,
+              &enumerationState,
+              DIEDFL_ATTACHEDONLY));
+      TEST_ASSERT(enumerationState.EnumerationComplete());
+    }
+  }
+
   // No devices attached to the system.
   // Only Xidi virtual controllers should be enumerated, and all of them should be enumerated.
   TEST_CASE(WrapperIDirectInput_EnumForceFeedbackDevices_NoSystemDevices)
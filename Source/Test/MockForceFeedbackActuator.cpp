@@ -0,0 +1,93 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MockForceFeedbackActuator.cpp
+ *   Implementation of a mock physical actuator that drives a force feedback device buffer the
+ *   same way the physical controller actuation thread does, but using a simulated clock.
+ **************************************************************************************************/
+
+#include "MockForceFeedbackActuator.h"
+
+#include <algorithm>
+#include <optional>
+
+#include <Infra/Test/TestCase.h>
+
+#include "ForceFeedbackDevice.h"
+#include "ForceFeedbackTypes.h"
+
+namespace XidiTest
+{
+  MockForceFeedbackActuator::MockForceFeedbackActuator(TEffectTimeMs actuationPeriod)
+      : kActuationPeriod(actuationPeriod),
+        device(0),
+        currentTime(0),
+        nextActuationTime(),
+        currentActuatorValues(),
+        actuatorWrites(),
+        actuationPassCount(0)
+  {}
+
+  void MockForceFeedbackActuator::AdvanceTo(TEffectTimeMs time)
+  {
+    if (time < currentTime)
+      TEST_FAILED_BECAUSE(
+          L"%s: Test implementation error due to attempting to move the simulated clock backwards from %u to %u.",
+          __FUNCTIONW__,
+          (unsigned int)currentTime,
+          (unsigned int)time);
+
+    while (true)
+    {
+      if (false == nextActuationTime.has_value())
+      {
+        // The actuation thread waits while the device is idle and is woken up as soon as it no
+        // longer is, which can only be the result of commands issued at the current time.
+        if (true == device.IsDeviceIdle()) break;
+        nextActuationTime = currentTime + ComputeSleepTime();
+      }
+
+      if (*nextActuationTime > time) break;
+
+      currentTime = *nextActuationTime;
+      ActuateOnce();
+
+      if ((TOrderedMagnitudeComponents() == currentActuatorValues) &&
+          (true == device.IsDeviceIdle()))
+        nextActuationTime = std::nullopt;
+      else
+        nextActuationTime = currentTime + ComputeSleepTime();
+    }
+
+    currentTime = time;
+  }
+
+  void MockForceFeedbackActuator::ActuateOnce(void)
+  {
+    actuationPassCount += 1;
+
+    const TOrderedMagnitudeComponents magnitudeComponents = device.PlayEffects(currentTime);
+    if (magnitudeComponents == currentActuatorValues) return;
+
+    currentActuatorValues = magnitudeComponents;
+    actuatorWrites.push_back(
+        {.timestamp = currentTime, .magnitudeComponents = magnitudeComponents});
+  }
+
+  TEffectTimeMs MockForceFeedbackActuator::ComputeSleepTime(void)
+  {
+    TEffectTimeMs sleepTime = kActuationPeriod;
+
+    const std::optional<TEffectTimeMs> timeUntilNextTransition =
+        device.GetTimeUntilNextTransition();
+    if ((true == timeUntilNextTransition.has_value()) && (*timeUntilNextTransition < sleepTime))
+      sleepTime = *timeUntilNextTransition;
+
+    // A real sleep of zero still lets the system clock advance, but the simulated clock would not.
+    return std::max<TEffectTimeMs>(1, sleepTime);
+  }
+} // namespace XidiTest
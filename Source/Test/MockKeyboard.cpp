@@ -84,6 +84,20 @@ namespace Xidi
   {
     using namespace ::XidiTest;
 
+    // Submissions are always passed straight through to the capturing mock keyboard, so that test
+    // cases observe them in order regardless of whether or not a submission batch is open.
+
+    bool IsDirectInputBackendEnabled(void)
+    {
+      return false;
+    }
+
+    void MergeIntoDirectInputKeyboardState(uint8_t (&keyboardState)[kVirtualKeyboardKeyCount]) {}
+
+    void BeginSubmissionBatch(void) {}
+
+    void EndSubmissionBatch(void) {}
+
     void SubmitKeyPressedState(TKeyIdentifier key)
     {
       std::scoped_lock lock(captureGuard);
@@ -117,6 +117,13 @@ namespace Xidi
   {
     using namespace ::XidiTest;
 
+    // Submissions are always passed straight through to the capturing mock mouse, so that test
+    // cases observe them in order regardless of whether or not a submission batch is open.
+
+    void BeginSubmissionBatch(void) {}
+
+    void EndSubmissionBatch(void) {}
+
     void SubmitMouseButtonPressedState(EMouseButton button)
     {
       std::scoped_lock lock(captureGuard);
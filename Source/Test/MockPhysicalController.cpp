@@ -12,6 +12,8 @@
 
 #include "MockPhysicalController.h"
 
+#include <algorithm>
+#include <set>
 #include <shared_mutex>
 #include <stop_token>
 #include <vector>
@@ -34,12 +36,17 @@ namespace XidiTest
 
   /// Guards all mock physical state data structures, one per physical controller.
   /// Even in tests, additional threads may exist to wait for state changes.
-  static std::shared_mutex mockPhysicalStateGuard[kPhysicalControllerCount];
+  static std::shared_mutex mockPhysicalStateGuard[kMaxPhysicalControllerCount];
 
   /// Holds pointers to all mock physical controller objects, one per physical controller.
   /// Each such object governs the behavior of the physical controller interface for a given
   /// physical controller.
-  static MockPhysicalController* mockPhysicalController[kPhysicalControllerCount];
+  static MockPhysicalController* mockPhysicalController[kMaxPhysicalControllerCount];
+
+  /// Polling periods requested by virtual controllers for each physical controller, in
+  /// milliseconds. Mock physical controllers are never polled, so these are only tracked so that
+  /// tests can observe the outcome of arbitrating between requests.
+  static std::multiset<unsigned int> mockPollingPeriodRequests[kMaxPhysicalControllerCount];
 
   MockPhysicalController::MockPhysicalController(
       TControllerIdentifier controllerIdentifier,
@@ -50,12 +57,12 @@ namespace XidiTest
         kMockPhysicalStates(mockPhysicalStates),
         kMockPhysicalStateCount(mockPhysicalStateCount),
         currentPhysicalStateIndex(0),
-        advanceRequested(false),
         forceFeedbackDevice(0),
         mapper(mapper),
-        forceFeedbackRegistration()
+        forceFeedbackRegistration(),
+        stateChangeRegistration()
   {
-    if (controllerIdentifier >= kPhysicalControllerCount)
+    if (controllerIdentifier >= kMaxPhysicalControllerCount)
       TEST_FAILED_BECAUSE(
           L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -76,18 +83,6 @@ namespace XidiTest
     mockPhysicalController[kControllerIdentifier] = nullptr;
   }
 
-  void MockPhysicalController::AdvancePhysicalState(void)
-  {
-    if (kMockPhysicalStateCount == currentPhysicalStateIndex)
-      TEST_FAILED_BECAUSE(
-          L"%s: Test implementation error due to out-of-bounds physical state advancement for physical controller with identifier %u.",
-          __FUNCTIONW__,
-          kControllerIdentifier);
-
-    currentPhysicalStateIndex += 1;
-    advanceRequested = false;
-  }
-
   SCapabilities MockPhysicalController::GetControllerCapabilities(void) const
   {
     return mapper.GetCapabilities();
@@ -107,21 +102,32 @@ namespace XidiTest
 
   void MockPhysicalController::RequestAdvancePhysicalState(void)
   {
-    std::unique_lock lock(mockPhysicalStateGuard[kControllerIdentifier]);
+    SState newRawVirtualState;
+    std::set<VirtualController*> controllersToUpdate;
 
-    if (currentPhysicalStateIndex >= (kMockPhysicalStateCount - 1))
-      TEST_FAILED_BECAUSE(
-          L"%s: Test implementation error due to out-of-bounds physical state advancement for physical controller with identifier %u.",
-          __FUNCTIONW__,
-          kControllerIdentifier);
+    {
+      std::unique_lock lock(mockPhysicalStateGuard[kControllerIdentifier]);
 
-    if (true == advanceRequested)
-      TEST_FAILED_BECAUSE(
-          L"%s: Test implementation error due to unconsumed advance request for physical controller with identifier %u.",
-          __FUNCTIONW__,
-          kControllerIdentifier);
+      if ((nullptr == kMockPhysicalStates) ||
+          (currentPhysicalStateIndex >= (kMockPhysicalStateCount - 1)))
+        TEST_FAILED_BECAUSE(
+            L"%s: Test implementation error due to out-of-bounds physical state advancement for physical controller with identifier %u.",
+            __FUNCTIONW__,
+            kControllerIdentifier);
+
+      currentPhysicalStateIndex += 1;
+      newRawVirtualState = GetCurrentRawVirtualState();
+      controllersToUpdate = stateChangeRegistration;
+    }
 
-    advanceRequested = true;
+    // Virtual controllers query capabilities while refreshing their state, which requires the
+    // mock physical state guard, so updates are delivered only after it has been released.
+    VirtualController::SSharedRefresh sharedRefresh;
+    for (auto controllerToUpdate : controllersToUpdate)
+    {
+      if (true == controllerToUpdate->RefreshStateOrDefer(newRawVirtualState, sharedRefresh))
+        controllerToUpdate->SignalStateChangeEvent();
+    }
   }
 } // namespace XidiTest
 
@@ -131,9 +137,24 @@ namespace Xidi
   {
     using namespace ::XidiTest;
 
+    TControllerIdentifier GetPhysicalControllerCount(void)
+    {
+      return kDefaultPhysicalControllerCount;
+    }
+
+    bool IsPhysicalControllerEnabled(TControllerIdentifier controllerIdentifier)
+    {
+      return (controllerIdentifier < GetPhysicalControllerCount());
+    }
+
+    unsigned int GetForceFeedbackPeriodMilliseconds(void)
+    {
+      return kPhysicalForceFeedbackPeriodMilliseconds;
+    }
+
     SCapabilities GetControllerCapabilities(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -150,7 +171,7 @@ namespace Xidi
 
     SPhysicalState GetCurrentPhysicalControllerState(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -165,16 +186,76 @@ namespace Xidi
             controllerIdentifier);
     }
 
+    SPhysicalState GetCurrentPhysicalControllerState(
+        TControllerIdentifier controllerIdentifier, TGeneration& generation)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+      if (nullptr != mockPhysicalController[controllerIdentifier])
+      {
+        generation = mockPhysicalController[controllerIdentifier]->GetCurrentGeneration();
+        return mockPhysicalController[controllerIdentifier]->GetCurrentPhysicalState();
+      }
+      else
+        TEST_FAILED_BECAUSE(
+            L"%s: No mock physical controller associated with identifier %u.",
+            __FUNCTIONW__,
+            controllerIdentifier);
+    }
+
     SState GetCurrentRawVirtualControllerState(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+      if (nullptr != mockPhysicalController[controllerIdentifier])
+        return mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
+      else
+        TEST_FAILED_BECAUSE(
+            L"%s: No mock physical controller associated with identifier %u.",
+            __FUNCTIONW__,
+            controllerIdentifier);
+    }
+
+    SState GetCurrentRawVirtualControllerState(
+        TControllerIdentifier controllerIdentifier, TGeneration& generation)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
       std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
 
       if (nullptr != mockPhysicalController[controllerIdentifier])
+      {
+        generation = mockPhysicalController[controllerIdentifier]->GetCurrentGeneration();
         return mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
+      }
+      else
+        TEST_FAILED_BECAUSE(
+            L"%s: No mock physical controller associated with identifier %u.",
+            __FUNCTIONW__,
+            controllerIdentifier);
+    }
+
+    TGeneration GetCurrentRawVirtualControllerStateGeneration(
+        TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+      if (nullptr != mockPhysicalController[controllerIdentifier])
+        return mockPhysicalController[controllerIdentifier]->GetCurrentGeneration();
       else
         TEST_FAILED_BECAUSE(
             L"%s: No mock physical controller associated with identifier %u.",
@@ -185,7 +266,7 @@ namespace Xidi
     ForceFeedback::Device* PhysicalControllerForceFeedbackRegister(
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -204,7 +285,7 @@ namespace Xidi
     void PhysicalControllerForceFeedbackUnregister(
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -217,12 +298,121 @@ namespace Xidi
       }
     }
 
+    void PhysicalControllerForceFeedbackRefreshGain(TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+    }
+
+    bool PhysicalControllerStateChangeRegister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      SState initialRawVirtualState;
+
+      {
+        std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+        if (nullptr == mockPhysicalController[controllerIdentifier])
+          TEST_FAILED_BECAUSE(
+              L"%s: No mock physical controller associated with identifier %u.",
+              __FUNCTIONW__,
+              controllerIdentifier);
+
+        mockPhysicalController[controllerIdentifier]->InsertStateChangeRegistration(
+            virtualController);
+        initialRawVirtualState =
+            mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
+      }
+
+      virtualController->RefreshState(initialRawVirtualState);
+      return true;
+    }
+
+    void PhysicalControllerStateChangeUnregister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+      if (nullptr != mockPhysicalController[controllerIdentifier])
+      {
+        mockPhysicalController[controllerIdentifier]->EraseStateChangeRegistration(
+            virtualController);
+      }
+    }
+
+    void NotifyApplicationStateRead(TControllerIdentifier controllerIdentifier) {}
+
+    void NotifyApplicationStateObserved(TControllerIdentifier controllerIdentifier) {}
+
+    void RequestPollingPeriod(
+        TControllerIdentifier controllerIdentifier, unsigned int periodMilliseconds)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      mockPollingPeriodRequests[controllerIdentifier].insert(periodMilliseconds);
+    }
+
+    void WithdrawPollingPeriodRequest(
+        TControllerIdentifier controllerIdentifier, unsigned int periodMilliseconds)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      auto request = mockPollingPeriodRequests[controllerIdentifier].find(periodMilliseconds);
+      if (mockPollingPeriodRequests[controllerIdentifier].end() == request)
+        TEST_FAILED_BECAUSE(
+            L"%s: Test implementation error due to withdrawing a polling period request of %u for physical controller with identifier %u that was never made.",
+            __FUNCTIONW__,
+            periodMilliseconds,
+            (unsigned int)controllerIdentifier);
+
+      mockPollingPeriodRequests[controllerIdentifier].erase(request);
+    }
+
+    unsigned int GetEffectivePollingPeriodMilliseconds(TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      if (true == mockPollingPeriodRequests[controllerIdentifier].empty())
+        return kPhysicalPollingPeriodMilliseconds;
+
+      return std::min(
+          kPhysicalPollingPeriodMilliseconds,
+          *mockPollingPeriodRequests[controllerIdentifier].cbegin());
+    }
+
+    bool PollPhysicalControllerOnDemand(TControllerIdentifier controllerIdentifier)
+    {
+      // Mock physical controller state only changes when a test advances it, so there is never
+      // anything new for an on-demand poll to find.
+      return false;
+    }
+
+    void ServicePhysicalControllerCooperatively(TControllerIdentifier controllerIdentifier)
+    {
+      // Mock physical controllers are never serviced by threads, so there is nothing to do.
+    }
+
     bool WaitForPhysicalControllerStateChange(
         TControllerIdentifier controllerIdentifier,
         SPhysicalState& state,
         std::stop_token stopToken)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -232,21 +422,16 @@ namespace Xidi
 
         if (nullptr != mockPhysicalController[controllerIdentifier])
         {
-          std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+          std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
 
           if (nullptr != mockPhysicalController[controllerIdentifier])
           {
-            if (mockPhysicalController[controllerIdentifier]->IsAdvanceStateRequested())
+            SPhysicalState newState =
+                mockPhysicalController[controllerIdentifier]->GetCurrentPhysicalState();
+            if (newState != state)
             {
-              mockPhysicalController[controllerIdentifier]->AdvancePhysicalState();
-
-              SPhysicalState newState =
-                  mockPhysicalController[controllerIdentifier]->GetCurrentPhysicalState();
-              if (newState != state)
-              {
-                state = newState;
-                return true;
-              }
+              state = newState;
+              return true;
             }
           }
         }
@@ -258,7 +443,41 @@ namespace Xidi
     bool WaitForRawVirtualControllerStateChange(
         TControllerIdentifier controllerIdentifier, SState& state, std::stop_token stopToken)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      while (false == stopToken.stop_requested())
+      {
+        Sleep(1);
+
+        if (nullptr != mockPhysicalController[controllerIdentifier])
+        {
+          std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+          if (nullptr != mockPhysicalController[controllerIdentifier])
+          {
+            SState newState =
+                mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
+            if (newState != state)
+            {
+              state = newState;
+              return true;
+            }
+          }
+        }
+      }
+
+      return false;
+    }
+
+    bool WaitForRawVirtualControllerStateChange(
+        TControllerIdentifier controllerIdentifier,
+        SState& state,
+        TGeneration& generation,
+        std::stop_token stopToken)
+    {
+      if (controllerIdentifier >= kMaxPhysicalControllerCount)
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -268,21 +487,17 @@ namespace Xidi
 
         if (nullptr != mockPhysicalController[controllerIdentifier])
         {
-          std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+          std::shared_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
 
           if (nullptr != mockPhysicalController[controllerIdentifier])
           {
-            if (mockPhysicalController[controllerIdentifier]->IsAdvanceStateRequested())
+            const TGeneration newGeneration =
+                mockPhysicalController[controllerIdentifier]->GetCurrentGeneration();
+            if (newGeneration != generation)
             {
-              mockPhysicalController[controllerIdentifier]->AdvancePhysicalState();
-
-              SState newState =
-                  mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
-              if (newState != state)
-              {
-                state = newState;
-                return true;
-              }
+              state = mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
+              generation = newGeneration;
+              return true;
             }
           }
         }
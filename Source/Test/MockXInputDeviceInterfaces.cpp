@@ -0,0 +1,31 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file MockXInputDeviceInterfaces.cpp
+ *   Implementation of a mock version of XInput device identification using the system's list of
+ *   device interfaces. Mock system devices exist only within mock DirectInput objects, so the
+ *   real system's list of device interfaces must never be consulted, and identification always
+ *   falls back to querying mock device objects.
+ **************************************************************************************************/
+
+#include "XInputDeviceInterfaces.h"
+
+#include <cstdint>
+#include <optional>
+
+#include "ApiWindows.h"
+
+namespace Xidi
+{
+  namespace XInputDeviceInterfaces
+  {
+    std::optional<bool> DoesProductSupportXInput(REFGUID productGUID, uint64_t deviceChangeCount)
+    {
+      return std::nullopt;
+    }
+  } // namespace XInputDeviceInterfaces
+} // namespace Xidi
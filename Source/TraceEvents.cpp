@@ -0,0 +1,124 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file TraceEvents.cpp
+ *   Implementation of TraceLogging events emitted from frequently-executed paths, for correlating
+ *   controller input and force feedback with application frame timing in performance analysis
+ *   tools.
+ **************************************************************************************************/
+
+#include "TraceEvents.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+
+TRACELOGGING_DEFINE_PROVIDER(
+    xidiTraceEventsProvider,
+    "Xidi",
+    (0x33d2c007, 0x98eb, 0x480b, 0xbc, 0x08, 0x5a, 0x0a, 0xff, 0x1b, 0xae, 0xb3));
+
+namespace Xidi
+{
+  namespace TraceEvents
+  {
+    /// Whether or not the TraceLogging provider is currently registered.
+    static std::atomic<bool> isRegistered = false;
+
+    void Register(void)
+    {
+      if (true == isRegistered.exchange(true)) return;
+      TraceLoggingRegister(xidiTraceEventsProvider);
+    }
+
+    void Unregister(void)
+    {
+      if (false == isRegistered.exchange(false)) return;
+      TraceLoggingUnregister(xidiTraceEventsProvider);
+    }
+
+    void EmitPollBegin(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "Poll",
+          TraceLoggingOpcode(WINEVENT_OPCODE_START),
+          TraceLoggingUInt16(controllerIdentifier, "Slot"));
+    }
+
+    void EmitPollEnd(
+        Controller::TControllerIdentifier controllerIdentifier,
+        Controller::EPhysicalDeviceStatus deviceStatus)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "Poll",
+          TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+          TraceLoggingUInt16(controllerIdentifier, "Slot"),
+          TraceLoggingUInt8((uint8_t)deviceStatus, "Status"));
+    }
+
+    void EmitStatePublished(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "StatePublished",
+          TraceLoggingUInt16(controllerIdentifier, "Slot"));
+    }
+
+    void EmitEventBufferOverflow(const void* eventBuffer, uint32_t capacity)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "EventBufferOverflow",
+          TraceLoggingPointer(eventBuffer, "EventBuffer"),
+          TraceLoggingUInt32(capacity, "Capacity"));
+    }
+
+    void EmitForceFeedbackTick(
+        Controller::TControllerIdentifier controllerIdentifier, unsigned int activeEffectCount)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "ForceFeedbackTick",
+          TraceLoggingUInt16(controllerIdentifier, "Slot"),
+          TraceLoggingUInt32(activeEffectCount, "ActiveEffectCount"));
+    }
+
+    void EmitXInputSetState(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint16_t leftMotorSpeed,
+        uint16_t rightMotorSpeed,
+        DWORD result)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "XInputSetState",
+          TraceLoggingUInt16(controllerIdentifier, "Slot"),
+          TraceLoggingUInt16(leftMotorSpeed, "LeftMotorSpeed"),
+          TraceLoggingUInt16(rightMotorSpeed, "RightMotorSpeed"),
+          TraceLoggingUInt32(result, "Result"));
+    }
+
+    void EmitSendInputBatch(std::wstring_view emitterName, UINT numRequested, UINT numSent)
+    {
+      TraceLoggingWrite(
+          xidiTraceEventsProvider,
+          "SendInputBatch",
+          TraceLoggingCountedWideString(
+              emitterName.data(), (USHORT)emitterName.length(), "Emitter"),
+          TraceLoggingUInt32(numRequested, "Requested"),
+          TraceLoggingUInt32(numSent, "Sent"));
+    }
+  } // namespace TraceEvents
+} // namespace Xidi
@@ -11,73 +11,72 @@
 
 #include "VirtualController.h"
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdint>
-#include <stop_token>
-#include <thread>
-
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <Infra/Core/Configuration.h>
 #include <Infra/Core/Message.h>
 
+#include "ApiWindows.h"
+#include "ControllerMath.h"
 #include "ControllerTypes.h"
 #include "ForceFeedbackTypes.h"
+#include "Globals.h"
 #include "ImportApiWinMM.h"
 #include "Mapper.h"
 #include "PhysicalController.h"
+#include "Settings.h"
+#include "Strings.h"
 
 namespace Xidi
 {
   namespace Controller
   {
-    /// Maps a value in one range to its corresponding value in another range.
-    /// Ranges are specified as origin values and displacements, essentially one-dimensional vectors
-    /// with direction either positive (maximum displacement value is greater than origin value) or
-    /// negative (maximum displacement value is less than origin value). It is not necessary that
-    /// the direction of the vectors be the same for both old and new range.
-    /// @param [in] oldRangeValue Raw value to transform in the old range.
-    /// @param [in] oldRangeOrigin Origin value of the old range.
-    /// @param [in] oldRangeDispMax Maximum displacement value in the old range.
-    /// @param [in] newRangeOrigin Origin value of the new range.
-    /// @param [in] newRangeDispMax Maximum displacement value in the new range.
-    /// @return Result of mapping the input value from the old range to the new range.
-    static inline int32_t MapValueInRangeToRange(
-        int32_t oldRangeValue,
-        int32_t oldRangeOrigin,
-        int32_t oldRangeDispMax,
-        int32_t newRangeOrigin,
-        int32_t newRangeDispMax)
-    {
-      const int64_t oldRangeValueDisp = (int64_t)oldRangeValue - (int64_t)oldRangeOrigin;
-      const int64_t newRangeMagnitudeMax = (int64_t)newRangeDispMax - (int64_t)newRangeOrigin;
-      const int64_t oldRangeMagnitudeMax = (int64_t)oldRangeDispMax - (int64_t)oldRangeOrigin;
-
-      return newRangeOrigin +
-          (int32_t)((oldRangeValueDisp * newRangeMagnitudeMax) / oldRangeMagnitudeMax);
-    }
-
-    /// Monitors for changes in an associated physical controller's state and, on state change,
-    /// causes a virtual controller to refresh its state. Intended to be the entry point for
-    /// per-virtual-controller background threads.
-    /// @param [in] thisController Controller object for which state is to be monitored.
-    /// @param [in] initialState Initial physical state of the controller. Used as the basis for
-    /// looking for changes.
-    /// @param [in] stopMonitoringToken Used to indicate that the monitoring should stop and the
-    /// thread should exit.
-    static void MonitorPhysicalControllerState(
-        VirtualController* thisController,
-        const SState& initialState,
-        std::stop_token stopMonitoringToken)
-    {
-      const TControllerIdentifier controllerIdentifier = thisController->GetIdentifier();
-      SState state = initialState;
-
-      while (false == stopMonitoringToken.stop_requested())
+    /// Computes the timestamp to apply to state change events generated at the current time.
+    /// Derived from the performance counter, which is monotonic and much more precise than the
+    /// multimedia timer, but expressed in milliseconds and anchored to the multimedia timer so that
+    /// applications can still compare event timestamps with system time.
+    /// @return Current event timestamp, in milliseconds.
+    static uint32_t EventTimestampNow(void)
+    {
+      struct STimeBase
       {
-        if (true ==
-            WaitForRawVirtualControllerStateChange(
-                controllerIdentifier, state, stopMonitoringToken))
-        {
-          if (true == thisController->RefreshState(state)) thisController->SignalStateChangeEvent();
-        }
-      }
+        int64_t frequency;
+        int64_t baseCounter;
+        uint32_t baseMilliseconds;
+      };
+
+      static const STimeBase kTimeBase = []() -> STimeBase
+      {
+        LARGE_INTEGER frequency;
+        LARGE_INTEGER counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+
+        return {
+            .frequency = frequency.QuadPart,
+            .baseCounter = counter.QuadPart,
+            .baseMilliseconds = ImportApiWinMM::timeGetTime()};
+      }();
+
+      LARGE_INTEGER counter;
+      QueryPerformanceCounter(&counter);
+
+      // Whole seconds and the remainder are converted separately so that the multiplication cannot
+      // overflow no matter how long the process has been running.
+      const int64_t elapsedTicks = counter.QuadPart - kTimeBase.baseCounter;
+      const int64_t elapsedMilliseconds = ((elapsedTicks / kTimeBase.frequency) * 1000) +
+          (((elapsedTicks % kTimeBase.frequency) * 1000) / kTimeBase.frequency);
+
+      return kTimeBase.baseMilliseconds + (uint32_t)elapsedMilliseconds;
     }
 
     /// Looks for differences between two virtual controller state objects and submits them as
@@ -86,119 +85,205 @@ namespace Xidi
     /// @param [in] oldState Old controller state, the baseline.
     /// @param [in] newState New controller state, which is compared with the old controller state.
     /// If different, controller element values submitted to the event buffer come from this object.
+    /// @param [in] newStateGeneration Generation of the new controller state, recorded by the event
+    /// buffer if any events are submitted.
     /// @param [in] eventFilter Filter which specifies which virtual controller elements are allowed
     /// to generate events.
     /// @param [in,out] eventBuffer Event buffer object to which events are submitted.
+    /// @param [in,out] eventBufferLock Lock on the event buffer mutex, which excludes the consumer
+    /// of the event buffer if owned. Acquired if event storage needs to grow.
+    /// @param [in] coalesceAxisEvents Whether or not axis events may be merged into unread events
+    /// for the same axis instead of being appended. Only takes effect if the consumer of the event
+    /// buffer is excluded.
+    /// @param [in,out] sharedRefresh Information shared with other virtual controllers refreshed
+    /// using the same raw state, from which the event timestamp is obtained.
     static inline void SubmitStateChangeEvents(
         const SState& oldState,
         const SState& newState,
+        uint64_t newStateGeneration,
         const VirtualController::EventFilter& eventFilter,
-        StateChangeEventBuffer& eventBuffer)
+        StateChangeEventBuffer& eventBuffer,
+        std::unique_lock<ProfiledMutex<std::recursive_mutex>>& eventBufferLock,
+        bool coalesceAxisEvents,
+        VirtualController::SSharedRefresh& sharedRefresh)
     {
-      if (true == eventBuffer.IsEnabled())
+      if (false == eventBuffer.IsEnabled()) return;
+
+      TElementMask eventElements =
+          (ElementMaskForStateDifference(oldState, newState) & eventFilter.GetElements());
+      if (0 == eventElements) return;
+
+      // Every virtual controller refreshed using the same raw state applies the same timestamp, so
+      // that an application reading several of them sees one physical input happen at one time.
+      if (false == sharedRefresh.eventTimestamp.has_value())
+        sharedRefresh.eventTimestamp = EventTimestampNow();
+      const uint32_t timestamp = *sharedRefresh.eventTimestamp;
+
+      // Storage that the consumer has left idle is released, but only if that can be done without
+      // waiting. Growing storage cannot be skipped, but it happens only a few times for each
+      // capacity the application requests, so waiting for the consumer is acceptable.
+      if ((true == eventBuffer.CheckStorageIdle(timestamp)) &&
+          ((true == eventBufferLock.owns_lock()) || (true == eventBufferLock.try_lock())))
+        eventBuffer.ReleaseIdleStorage();
+
+      const uint32_t numEvents = (uint32_t)std::popcount(eventElements);
+      if (false == eventBuffer.HasStorageFor(numEvents))
       {
-        const uint32_t timestamp = ImportApiWinMM::timeGetTime();
+        if (false == eventBufferLock.owns_lock()) eventBufferLock.lock();
+        eventBuffer.ReserveStorage(numEvents);
+      }
 
-        for (unsigned int i = 0; i < oldState.axis.size(); ++i)
-        {
-          if (oldState.axis[i] != newState.axis[i])
-          {
-            const SElementIdentifier axisElement = {.type = EElementType::Axis, .axis = (EAxis)i};
+      coalesceAxisEvents = ((true == coalesceAxisEvents) && (true == eventBufferLock.owns_lock()));
 
-            if (eventFilter.Contains(axisElement))
-              eventBuffer.AppendEvent(
-                  {.element = axisElement, .value = {.axis = newState.axis[i]}}, timestamp);
-          }
-        }
+      // Elements are visited in element mask order, which is axes first, then buttons, and finally
+      // the POV.
+      for (; 0 != eventElements; eventElements &= (eventElements - 1))
+      {
+        const unsigned int elementBit = (unsigned int)std::countr_zero(eventElements);
 
-        for (unsigned int i = 0; i < oldState.button.size(); ++i)
+        if (elementBit < kElementMaskButtonShift)
         {
-          if (oldState.button[i] != newState.button[i])
-          {
-            const SElementIdentifier buttonElement = {
-                .type = EElementType::Button, .button = (EButton)i};
+          const StateChangeEventBuffer::SEventData axisEventData = {
+              .element = {.type = EElementType::Axis, .axis = (EAxis)elementBit},
+              .value = {.axis = newState.axis[elementBit]}};
 
-            if (eventFilter.Contains(buttonElement))
-              eventBuffer.AppendEvent(
-                  {.element = buttonElement, .value = {.button = newState.button[i]}}, timestamp);
-          }
+          if ((false == coalesceAxisEvents) ||
+              (false == eventBuffer.CoalesceAxisEvent(axisEventData)))
+            eventBuffer.AppendEvent(axisEventData, timestamp);
         }
-
-        if (oldState.povDirection.all != newState.povDirection.all)
+        else if (elementBit < kElementMaskPovShift)
         {
-          const SElementIdentifier povElement = {.type = EElementType::Pov};
-
-          if (eventFilter.Contains(povElement))
-            eventBuffer.AppendEvent(
-                {.element = povElement,
-                 .value = {.povDirection = {.all = newState.povDirection.all}}},
-                timestamp);
+          const unsigned int buttonIndex = elementBit - kElementMaskButtonShift;
+          eventBuffer.AppendEvent(
+              {.element = {.type = EElementType::Button, .button = (EButton)buttonIndex},
+               .value = {.button = newState.button[buttonIndex]}},
+              timestamp);
+        }
+        else
+        {
+          eventBuffer.AppendEvent(
+              {.element = {.type = EElementType::Pov},
+               .value = {.povDirection = {.all = newState.povDirection.all}}},
+              timestamp);
         }
       }
+
+      eventBuffer.SetStateGeneration(newStateGeneration);
     }
 
-    /// Transforms a raw axis value using the supplied axis properties.
-    /// @param [in] axisValueRaw Raw axis value as obtained from a mapper.
-    /// @param [in] axisProperties Axis properties to apply.
-    /// @return Axis value that results from applying the transformation.
-    static int32_t TransformAxisValue(
-        int32_t axisValueRaw, const VirtualController::SAxisProperties& axisProperties)
+    /// Converts the axis properties of a virtual controller to the form used to transform all of
+    /// its axis values at once. Axes that the virtual controller does not have are never
+    /// transformed.
+    /// @param [in] properties Virtual controller properties.
+    /// @param [in] capabilities Virtual controller capabilities.
+    /// @return Corresponding axis transformation parameters.
+    static Math::SAxisTransformParameters AxisTransformParametersFromProperties(
+        const VirtualController::SProperties& properties, const SCapabilities& capabilities)
     {
-      if (true != axisProperties.transformationsEnabled) return axisValueRaw;
+      Math::SAxisTransformParameters parameters = {};
 
-      if (axisValueRaw > kAnalogValueNeutral)
+      for (int i = 0; i < capabilities.numAxes; ++i)
       {
-        if (axisValueRaw <= axisProperties.deadzoneRawCutoffPositive)
-          return axisProperties.rangeNeutral;
-        else if (axisValueRaw >= axisProperties.saturationRawCutoffPositive)
-          return axisProperties.rangeMax;
-        else
-          return MapValueInRangeToRange(
-              axisValueRaw,
-              axisProperties.deadzoneRawCutoffPositive,
-              axisProperties.saturationRawCutoffPositive,
-              axisProperties.rangeNeutral,
-              axisProperties.rangeMax);
+        const EAxis axis = capabilities.axisCapabilities[i].type;
+        const VirtualController::SAxisProperties& axisProperties = properties[axis];
+        const unsigned int lane = static_cast<unsigned int>(axis);
+
+        parameters.transformMask[lane] = ((true == axisProperties.transformationsEnabled) ? -1 : 0);
+        parameters.deadzoneCutoffPositive[lane] = axisProperties.deadzoneRawCutoffPositive;
+        parameters.deadzoneCutoffNegative[lane] = axisProperties.deadzoneRawCutoffNegative;
+        parameters.saturationDistancePositive[lane] =
+            axisProperties.saturationRawCutoffPositive - axisProperties.deadzoneRawCutoffPositive;
+        parameters.saturationDistanceNegative[lane] =
+            axisProperties.deadzoneRawCutoffNegative - axisProperties.saturationRawCutoffNegative;
+        parameters.rangeScaleLowPositive[lane] = (uint32_t)axisProperties.rangeScalePositive;
+        parameters.rangeScaleHighPositive[lane] =
+            (uint32_t)(axisProperties.rangeScalePositive >> 32);
+        parameters.rangeScaleLowNegative[lane] = (uint32_t)axisProperties.rangeScaleNegative;
+        parameters.rangeScaleHighNegative[lane] =
+            (uint32_t)(axisProperties.rangeScaleNegative >> 32);
+        parameters.rangeMin[lane] = axisProperties.rangeMin;
+        parameters.rangeMax[lane] = axisProperties.rangeMax;
+        parameters.rangeNeutral[lane] = axisProperties.rangeNeutral;
       }
-      else
+
+      return parameters;
+    }
+
+    /// Obtains a shared copy of the specified axis transformation parameters. All virtual
+    /// controllers whose axis properties produce identical parameters receive the same copy, so
+    /// parameter identity can be checked by address. Copies are retained only for as long as at
+    /// least one holder exists.
+    /// @param [in] parameters Axis transformation parameters for which to obtain a shared copy.
+    /// @return Shared copy of the parameters.
+    static std::shared_ptr<const Math::SAxisTransformParameters> SharedAxisTransformParameters(
+        const Math::SAxisTransformParameters& parameters)
+    {
+      static std::mutex sharedParametersMutex;
+      static std::vector<std::weak_ptr<const Math::SAxisTransformParameters>> sharedParameters;
+
+      std::scoped_lock lock(sharedParametersMutex);
+      std::erase_if(
+          sharedParameters,
+          [](const auto& sharedParametersEntry) -> bool
+          {
+            return sharedParametersEntry.expired();
+          });
+
+      for (const auto& sharedParametersEntry : sharedParameters)
       {
-        if (axisValueRaw >= axisProperties.deadzoneRawCutoffNegative)
-          return axisProperties.rangeNeutral;
-        else if (axisValueRaw <= axisProperties.saturationRawCutoffNegative)
-          return axisProperties.rangeMin;
-        else
-          return MapValueInRangeToRange(
-              axisValueRaw,
-              axisProperties.deadzoneRawCutoffNegative,
-              axisProperties.saturationRawCutoffNegative,
-              axisProperties.rangeNeutral,
-              axisProperties.rangeMin);
+        auto existingParameters = sharedParametersEntry.lock();
+        if ((nullptr != existingParameters) &&
+            (0 == std::memcmp(existingParameters.get(), &parameters, sizeof(parameters))))
+          return existingParameters;
       }
+
+      std::shared_ptr<const Math::SAxisTransformParameters> newParameters(
+          new Math::SAxisTransformParameters(parameters));
+      sharedParameters.emplace_back(newParameters);
+      return newParameters;
+    }
+
+    /// Delivers a trailing state change event signal on a thread pool thread once the minimum time
+    /// between signals has elapsed. Parameters are as documented for thread pool timer callbacks,
+    /// and the context identifies the virtual controller whose signal was postponed.
+    static void __stdcall TrailingSignalTimerCallback(
+        PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer)
+    {
+      reinterpret_cast<VirtualController*>(context)->SignalStateChangeEvent();
     }
 
     VirtualController::VirtualController(TControllerIdentifier controllerId)
         : kControllerIdentifier(controllerId),
-          controllerMutex(),
+          capabilities(GetControllerCapabilities(controllerId)),
+          controllerMutex(L"VirtualController::controllerMutex"),
+          eventBufferMutex(L"VirtualController::eventBufferMutex"),
           eventBuffer(),
           eventFilter(),
           properties(),
+          axisTransformParameters(SharedAxisTransformParameters(
+              AxisTransformParametersFromProperties(properties.Get(), capabilities))),
+          propertyTransactionDepth(0),
+          arePropertiesPendingReapply(false),
           stateRaw(),
+          stateRawGeneration(kStateRawGenerationUnknown),
+          isPullModeActive(false),
           stateProcessed(),
           stateChangeEventHandle(NULL),
-          physicalControllerMonitor(),
-          physicalControllerMonitorStop(),
+          stateChangeEventPeriodOverride(kStateChangeEventPeriodNotOverridden),
+          stateLastSignalled(),
+          timeLastSignalled(0),
+          stateChangeSignalMutex(L"VirtualController::stateChangeSignalMutex"),
+          trailingSignalTimer(NULL),
           physicalControllerForceFeedbackBuffer()
     {
-      const SState initialState = GetCurrentRawVirtualControllerState(kControllerIdentifier);
+      // Registration also performs the initial state refresh.
+      PhysicalControllerStateChangeRegister(kControllerIdentifier, this);
 
-      RefreshState(initialState);
-      ReapplyProperties();
-
-      physicalControllerMonitor = std::thread(
-          MonitorPhysicalControllerState,
-          this,
-          initialState,
-          physicalControllerMonitorStop.get_token());
+      {
+        auto lock = Lock();
+        UpdateRefreshMode();
+        ReapplyProperties();
+      }
 
       Infra::Message::OutputFormatted(
           Infra::Message::ESeverity::Info,
@@ -209,9 +294,22 @@ namespace Xidi
     VirtualController::~VirtualController(void)
     {
       ForceFeedbackUnregister();
+      PhysicalControllerStateChangeUnregister(kControllerIdentifier, this);
+
+      // No more refreshes can schedule a trailing signal, but one might already be scheduled or
+      // in the middle of being delivered. Clearing the state change event handle first stops a
+      // trailing signal being delivered from scheduling yet another one.
+      {
+        std::scoped_lock signalLock(stateChangeSignalMutex);
+        stateChangeEventHandle = NULL;
+      }
 
-      physicalControllerMonitorStop.request_stop();
-      physicalControllerMonitor.join();
+      if (NULL != trailingSignalTimer)
+      {
+        SetThreadpoolTimer(trailingSignalTimer, nullptr, 0, 0);
+        WaitForThreadpoolTimerCallbacks(trailingSignalTimer, TRUE);
+        CloseThreadpoolTimer(trailingSignalTimer);
+      }
 
       Infra::Message::OutputFormatted(
           Infra::Message::ESeverity::Info,
@@ -221,13 +319,30 @@ namespace Xidi
 
     void VirtualController::ApplyProperties(SState& controllerState) const
     {
-      const SCapabilities capabilities = GetCapabilities();
+      Math::TransformAxisValues(controllerState.axis, *axisTransformParameters);
+    }
 
-      for (int i = 0; i < capabilities.numAxes; ++i)
-      {
-        const EAxis axis = capabilities.axisCapabilities[i].type;
-        controllerState[axis] = TransformAxisValue(controllerState[axis], properties[axis]);
-      }
+    bool VirtualController::CanPullState(void) const
+    {
+      // Extrapolation estimates axis velocity from the times at which new states are published, so
+      // those must be the times at which the physical controller was actually sampled.
+      return (false == eventBuffer.IsEnabled()) && (NULL == stateChangeEventHandle) &&
+          (false == Globals::GetSettings().properties.axisExtrapolation);
+    }
+
+    TElementMask VirtualController::ChangedElementsSince(
+        const SStateSnapshot& snapshot, uint64_t sinceGeneration)
+    {
+      if ((sinceGeneration > snapshot.generation) ||
+          ((snapshot.generation - sinceGeneration) > kStateChangeHistoryCount))
+        return kElementMaskAll;
+
+      TElementMask changedElements = 0;
+      for (uint64_t generation = sinceGeneration + 1; generation <= snapshot.generation;
+           ++generation)
+        changedElements |= snapshot.changeHistory[generation % kStateChangeHistoryCount];
+
+      return changedElements;
     }
 
     bool VirtualController::ForceFeedbackRegister(void)
@@ -249,58 +364,310 @@ namespace Xidi
       physicalControllerForceFeedbackBuffer = nullptr;
     }
 
-    SCapabilities VirtualController::GetCapabilities(void) const
+    TElementMask VirtualController::GetStateChangedElementsSince(uint64_t sinceGeneration) const
     {
-      return GetControllerCapabilities(kControllerIdentifier);
+      PullState();
+      return ChangedElementsSince(stateProcessed.Get(), sinceGeneration);
     }
 
-    SState VirtualController::GetState(void)
+    SState VirtualController::GetStateSince(
+        uint64_t sinceGeneration, TElementMask& changedElements, uint64_t& generation) const
     {
-      auto lock = Lock();
-      return stateProcessed;
+      PullState();
+      const SStateSnapshot snapshot = stateProcessed.Get();
+
+      changedElements = ChangedElementsSince(snapshot, sinceGeneration);
+      generation = snapshot.generation;
+      return snapshot.state;
+    }
+
+    SState VirtualController::GetStateSinceExtrapolated(
+        uint64_t sinceGeneration,
+        TElementMask& changedElements,
+        uint64_t& generation,
+        TElementMask& extrapolatedElements) const
+    {
+      PullState();
+      const SStateSnapshot snapshot = stateProcessed.Get();
+
+      changedElements = ChangedElementsSince(snapshot, sinceGeneration);
+      generation = snapshot.generation;
+      extrapolatedElements = 0;
+
+      const std::chrono::steady_clock::duration elapsedTime =
+          std::chrono::steady_clock::now() - snapshot.publishTime;
+      if ((elapsedTime <= std::chrono::steady_clock::duration::zero()) ||
+          (elapsedTime > kAxisExtrapolationHorizon))
+        return snapshot.state;
+
+      const float elapsedMilliseconds =
+          std::chrono::duration<float, std::milli>(elapsedTime).count();
+      const SProperties currentProperties = properties.Get();
+
+      SState extrapolatedState = snapshot.state;
+      for (int i = 0; i < static_cast<int>(EAxis::Count); ++i)
+      {
+        if (0.0f == snapshot.axisVelocity[i]) continue;
+
+        const EAxis axis = static_cast<EAxis>(i);
+        const SAxisProperties& axisProperties = currentProperties[axis];
+        const int32_t extrapolatedValue = std::clamp(
+            snapshot.state[axis] +
+                static_cast<int32_t>(snapshot.axisVelocity[i] * elapsedMilliseconds),
+            axisProperties.rangeMin,
+            axisProperties.rangeMax);
+
+        if (extrapolatedValue == snapshot.state[axis]) continue;
+
+        extrapolatedState[axis] = extrapolatedValue;
+        extrapolatedElements |= ElementMaskForElement({.type = EElementType::Axis, .axis = axis});
+      }
+
+      return extrapolatedState;
+    }
+
+    void VirtualController::PopEventBufferEvents(
+        const StateChangeEventBuffer::SEventSpans& eventSpans)
+    {
+      auto lock = LockEventBuffer();
+      eventBuffer.PopEvents(eventSpans);
     }
 
     void VirtualController::PopEventBufferOldestEvents(uint32_t numEventsToPop)
     {
-      auto lock = Lock();
+      auto lock = LockEventBuffer();
       eventBuffer.PopOldestEvents(numEventsToPop);
     }
 
+    bool VirtualController::PublishStateProcessed(
+        const SState& newStateProcessed, SState& oldStateProcessed, bool isPhysicalSample)
+    {
+      // Only writers holding the lock ever publish, so reading back the published snapshot never
+      // races with another write and never needs to retry.
+      SStateSnapshot snapshot = stateProcessed.Get();
+      oldStateProcessed = snapshot.state;
+
+      if (newStateProcessed == snapshot.state) return false;
+
+      const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      const std::chrono::steady_clock::duration sampleInterval = now - snapshot.publishTime;
+
+      if ((true == isPhysicalSample) &&
+          (sampleInterval > std::chrono::steady_clock::duration::zero()) &&
+          (sampleInterval <= kAxisVelocityMaximumSampleInterval))
+      {
+        const float sampleIntervalMilliseconds =
+            std::chrono::duration<float, std::milli>(sampleInterval).count();
+
+        for (int i = 0; i < static_cast<int>(EAxis::Count); ++i)
+        {
+          const float sampleVelocity =
+              static_cast<float>(newStateProcessed.axis[i] - snapshot.state.axis[i]) /
+              sampleIntervalMilliseconds;
+
+          // An axis that reverses direction would be extrapolated the wrong way, so its estimate
+          // starts over, which turns off extrapolation until its motion is consistent again.
+          if (((sampleVelocity > 0.0f) && (snapshot.axisVelocity[i] < 0.0f)) ||
+              ((sampleVelocity < 0.0f) && (snapshot.axisVelocity[i] > 0.0f)))
+            snapshot.axisVelocity[i] = 0.0f;
+          else
+            snapshot.axisVelocity[i] += kAxisVelocitySmoothingFactor *
+                (sampleVelocity - snapshot.axisVelocity[i]);
+        }
+      }
+      else
+      {
+        snapshot.axisVelocity = {};
+      }
+
+      snapshot.generation += 1;
+      snapshot.changeHistory[snapshot.generation % kStateChangeHistoryCount] =
+          ElementMaskForStateDifference(snapshot.state, newStateProcessed);
+      snapshot.state = newStateProcessed;
+      snapshot.publishTime = now;
+
+      stateProcessed.Set(snapshot);
+      return true;
+    }
+
+    bool VirtualController::PullRawStateLocked(void)
+    {
+      TGeneration generation = 0;
+      const SState newStateRaw =
+          GetCurrentRawVirtualControllerState(kControllerIdentifier, generation);
+      if (generation == stateRawGeneration.load(std::memory_order_relaxed)) return false;
+
+      stateRaw = newStateRaw;
+      stateRawGeneration.store(generation, std::memory_order_release);
+      return true;
+    }
+
+    void VirtualController::PullStateLocked(void)
+    {
+      if (false == PullRawStateLocked()) return;
+
+      SState newStateProcessed = stateRaw;
+      ApplyProperties(newStateProcessed);
+
+      SState oldStateProcessed;
+      PublishStateProcessed(newStateProcessed, oldStateProcessed, true);
+    }
+
+    void VirtualController::PullStateSlow(void) const
+    {
+      // Most reads find that the physical controller has not published anything new, which only
+      // requires comparing generation numbers.
+      if (GetCurrentRawVirtualControllerStateGeneration(kControllerIdentifier) ==
+          stateRawGeneration.load(std::memory_order_acquire))
+        return;
+
+      // Pulling changes nothing that readers can observe, other than making the state they read
+      // current, so it is allowed on behalf of the read-only accessors.
+      VirtualController& self = const_cast<VirtualController&>(*this);
+
+      auto lock = self.Lock();
+      if (true == isPullModeActive.load(std::memory_order_relaxed)) self.PullStateLocked();
+    }
+
+    void VirtualController::BeginPropertyTransaction(void)
+    {
+      auto lock = Lock();
+      propertyTransactionDepth += 1;
+    }
+
+    void VirtualController::EndPropertyTransaction(void)
+    {
+      auto lock = Lock();
+
+      if (0 == propertyTransactionDepth) return;
+      propertyTransactionDepth -= 1;
+
+      if ((0 == propertyTransactionDepth) && (true == arePropertiesPendingReapply))
+      {
+        arePropertiesPendingReapply = false;
+        ReapplyProperties();
+      }
+    }
+
+    void VirtualController::ReapplyChangedProperties(void)
+    {
+      if (0 != propertyTransactionDepth)
+      {
+        arePropertiesPendingReapply = true;
+        return;
+      }
+
+      ReapplyProperties();
+    }
+
     void VirtualController::ReapplyProperties(void)
     {
-      stateProcessed = stateRaw;
-      ApplyProperties(stateProcessed);
+      axisTransformParameters = SharedAxisTransformParameters(
+          AxisTransformParametersFromProperties(properties.Get(), capabilities));
+
+      // In pull mode the raw state might be out of date, so processed state is produced from the
+      // latest one published by the physical controller.
+      if (true == isPullModeActive.load(std::memory_order_relaxed)) PullRawStateLocked();
+
+      SState newStateProcessed = stateRaw;
+      ApplyProperties(newStateProcessed);
+
+      // Changes resulting from new properties are recorded in the state history, so that
+      // incremental readers pick them up, but they do not generate buffered events.
+      SState oldStateProcessed;
+      PublishStateProcessed(newStateProcessed, oldStateProcessed, false);
     }
 
     bool VirtualController::RefreshState(SState newStateRaw)
     {
+      SSharedRefresh sharedRefresh;
+      return RefreshState(newStateRaw, sharedRefresh);
+    }
+
+    bool VirtualController::RefreshState(SState newStateRaw, SSharedRefresh& sharedRefresh)
+    {
+      const bool kCoalesceAxisEvents = Globals::GetSettings().properties.coalesceAxisEvents;
+
       auto lock = Lock();
       stateRaw = newStateRaw;
 
-      SState newStateProcessed = newStateRaw;
-      ApplyProperties(newStateProcessed);
+      if (sharedRefresh.axisTransformParameters != axisTransformParameters)
+      {
+        sharedRefresh.axisTransformParameters = axisTransformParameters;
+        sharedRefresh.stateProcessed = newStateRaw;
+        ApplyProperties(sharedRefresh.stateProcessed);
+      }
+
+      const SState newStateProcessed = sharedRefresh.stateProcessed;
 
       // Based on the mapper and the applied properties, a change in raw virtual controller state
       // might not necessarily mean a change in processed virtual controller state. For example,
       // deadzone might result in filtering out changes in analog stick position, or if a particular
       // XInput controller element is ignored by the mapper then a change in that element does not
       // influence the virtual controller state.
-      if (newStateProcessed == stateProcessed) return false;
-
-      SubmitStateChangeEvents(stateProcessed, newStateProcessed, eventFilter, eventBuffer);
-      stateProcessed = newStateProcessed;
+      SState oldStateProcessed;
+      if (false == PublishStateProcessed(newStateProcessed, oldStateProcessed, true)) return false;
+
+      // Merging events modifies unread events in place, so it is only safe if no consumer is
+      // active. Rather than waiting for the consumer, events are simply appended if one is.
+      std::unique_lock eventBufferLock(eventBufferMutex, std::defer_lock);
+      if (true == kCoalesceAxisEvents) eventBufferLock.try_lock();
+
+      SubmitStateChangeEvents(
+          oldStateProcessed,
+          newStateProcessed,
+          stateProcessed.GetPart<uint64_t>(offsetof(SStateSnapshot, generation)),
+          eventFilter,
+          eventBuffer,
+          eventBufferLock,
+          kCoalesceAxisEvents,
+          sharedRefresh);
       return true;
     }
 
+    bool VirtualController::RefreshStateOrDefer(SState newStateRaw, SSharedRefresh& sharedRefresh)
+    {
+      // The new raw state has already been published by the physical controller. Pairs with the
+      // fence in #UpdateRefreshMode, so that a virtual controller switching out of pull mode at the
+      // same time either is seen here in push mode or itself pulls the new raw state.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (true == isPullModeActive.load(std::memory_order_relaxed)) return false;
+
+      return RefreshState(newStateRaw, sharedRefresh);
+    }
+
+    void VirtualController::ScheduleTrailingStateChangeSignal(DWORD delayMilliseconds)
+    {
+      if (NULL == stateChangeEventHandle) return;
+
+      if (NULL == trailingSignalTimer)
+      {
+        trailingSignalTimer = CreateThreadpoolTimer(&TrailingSignalTimerCallback, this, nullptr);
+        if (NULL == trailingSignalTimer) return;
+      }
+
+      // A trailing signal that is already scheduled is due no later than this one would be.
+      if (TRUE == IsThreadpoolTimerSet(trailingSignalTimer)) return;
+
+      // Negative due times are relative to now, in units of 100 nanoseconds.
+      ULARGE_INTEGER dueTime = {};
+      dueTime.QuadPart = (ULONGLONG)(-((LONGLONG)delayMilliseconds * 10000));
+      FILETIME dueTimeFileTime = {
+          .dwLowDateTime = dueTime.LowPart, .dwHighDateTime = dueTime.HighPart};
+      SetThreadpoolTimer(trailingSignalTimer, &dueTimeFileTime, 0, 0);
+    }
+
     bool VirtualController::SetAxisDeadzone(EAxis axis, uint32_t deadzone)
     {
       if ((deadzone >= kAxisDeadzoneMin) && (deadzone <= kAxisDeadzoneMax))
       {
         auto lock = Lock();
 
-        properties[axis].SetDeadzone(deadzone);
+        SProperties newProperties = properties.Get();
+        newProperties[axis].SetDeadzone(deadzone);
+        properties.Set(newProperties);
 
-        ReapplyProperties();
+        ReapplyChangedProperties();
         return true;
       }
 
@@ -313,9 +680,11 @@ namespace Xidi
       {
         auto lock = Lock();
 
-        properties[axis].SetRange(rangeMin, rangeMax);
+        SProperties newProperties = properties.Get();
+        newProperties[axis].SetRange(rangeMin, rangeMax);
+        properties.Set(newProperties);
 
-        ReapplyProperties();
+        ReapplyChangedProperties();
         return true;
       }
 
@@ -328,9 +697,11 @@ namespace Xidi
       {
         auto lock = Lock();
 
-        properties[axis].SetSaturation(saturation);
+        SProperties newProperties = properties.Get();
+        newProperties[axis].SetSaturation(saturation);
+        properties.Set(newProperties);
 
-        ReapplyProperties();
+        ReapplyChangedProperties();
         return true;
       }
 
@@ -341,9 +712,11 @@ namespace Xidi
     {
       auto lock = Lock();
 
-      properties[axis].SetTransformationsEnabled(transformationsEnabled);
+      SProperties newProperties = properties.Get();
+      newProperties[axis].SetTransformationsEnabled(transformationsEnabled);
+      properties.Set(newProperties);
 
-      ReapplyProperties();
+      ReapplyChangedProperties();
     }
 
     bool VirtualController::SetAllAxisDeadzone(uint32_t deadzone)
@@ -352,10 +725,12 @@ namespace Xidi
       {
         auto lock = Lock();
 
-        for (auto& axis : properties.axis)
+        SProperties newProperties = properties.Get();
+        for (auto& axis : newProperties.axis)
           axis.SetDeadzone(deadzone);
+        properties.Set(newProperties);
 
-        ReapplyProperties();
+        ReapplyChangedProperties();
         return true;
       }
 
@@ -368,10 +743,12 @@ namespace Xidi
       {
         auto lock = Lock();
 
-        for (auto& axis : properties.axis)
+        SProperties newProperties = properties.Get();
+        for (auto& axis : newProperties.axis)
           axis.SetRange(rangeMin, rangeMax);
+        properties.Set(newProperties);
 
-        ReapplyProperties();
+        ReapplyChangedProperties();
         return true;
       }
 
@@ -384,10 +761,12 @@ namespace Xidi
       {
         auto lock = Lock();
 
-        for (auto& axis : properties.axis)
+        SProperties newProperties = properties.Get();
+        for (auto& axis : newProperties.axis)
           axis.SetSaturation(saturation);
+        properties.Set(newProperties);
 
-        ReapplyProperties();
+        ReapplyChangedProperties();
         return true;
       }
 
@@ -398,18 +777,27 @@ namespace Xidi
     {
       auto lock = Lock();
 
-      for (auto& axis : properties.axis)
+      SProperties newProperties = properties.Get();
+      for (auto& axis : newProperties.axis)
         axis.SetTransformationsEnabled(transformationsEnabled);
+      properties.Set(newProperties);
 
-      ReapplyProperties();
+      ReapplyChangedProperties();
     }
 
     bool VirtualController::SetEventBufferCapacity(uint32_t capacity)
     {
       if (capacity != eventBuffer.GetCapacity())
       {
+        // Changing capacity requires exclusive access with respect to both appending and
+        // consuming events.
         auto lock = Lock();
+        auto eventBufferLock = LockEventBuffer();
+
+        // Events describe changes relative to the published state, so it must be current before
+        // events start being generated. Switching out of pull mode takes care of that.
         eventBuffer.SetCapacity(capacity);
+        UpdateRefreshMode();
       }
 
       return true;
@@ -421,7 +809,18 @@ namespace Xidi
       if ((newFfGain >= kFfGainMin) && (newFfGain <= kFfGainMax))
       {
         auto lock = Lock();
-        properties.device.SetFfGain(newFfGain);
+
+        SProperties newProperties = properties.Get();
+        if (newFfGain == newProperties.device.ffGain) return true;
+
+        newProperties.device.SetFfGain(newFfGain);
+        properties.Set(newProperties);
+
+        // The physical controller caches the combined gain of all registered virtual controllers,
+        // so it only needs to be told about changes that can actually affect that value.
+        if (true == ForceFeedbackIsRegistered())
+          PhysicalControllerForceFeedbackRefreshGain(kControllerIdentifier);
+
         return true;
       }
 
@@ -430,15 +829,108 @@ namespace Xidi
 
     void VirtualController::SetStateChangeEvent(HANDLE eventHandle)
     {
+      // Whether or not state is pulled depends on the state change event handle, so it must not
+      // change while a refresh is in progress, and the state must be current before the
+      // application starts relying on being signalled.
+      auto lock = Lock();
       stateChangeEventHandle = eventHandle;
+      UpdateRefreshMode();
+    }
+
+    DWORD VirtualController::GetStateChangeEventPeriod(void) const
+    {
+      const DWORD kPeriodOverride = stateChangeEventPeriodOverride.load(std::memory_order_relaxed);
+      if (kStateChangeEventPeriodNotOverridden != kPeriodOverride) return kPeriodOverride;
+
+      return Globals::GetSettings().properties.stateChangeEventPeriodMilliseconds;
+    }
+
+    void VirtualController::SetStateChangeEventPeriod(std::optional<DWORD> periodMilliseconds)
+    {
+      stateChangeEventPeriodOverride.store(
+          periodMilliseconds.value_or(kStateChangeEventPeriodNotOverridden),
+          std::memory_order_relaxed);
     }
 
     void VirtualController::SignalStateChangeEvent(void)
     {
+      const int64_t kAxisThresholdPercent =
+          Globals::GetSettings().properties.stateChangeEventAxisThresholdPercent;
+      const DWORD kAxisSignalPeriodMilliseconds = GetStateChangeEventPeriod();
+
       const HANDLE eventHandleToSignal = stateChangeEventHandle;
+      if ((NULL == eventHandleToSignal) || (INVALID_HANDLE_VALUE == eventHandleToSignal)) return;
+
+      if ((0 != kAxisThresholdPercent) || (0 != kAxisSignalPeriodMilliseconds))
+      {
+        std::scoped_lock signalLock(stateChangeSignalMutex);
+
+        // Changes are measured against the state as of the previous signal, rather than the state
+        // as of the previous refresh, so that slow but steady axis movement still adds up to a
+        // signal eventually.
+        const SState currentStateProcessed = stateProcessed.Get().state;
+        const DWORD currentTime = ImportApiWinMM::timeGetTime();
+
+        if ((currentStateProcessed.button == stateLastSignalled.button) &&
+            (currentStateProcessed.povDirection == stateLastSignalled.povDirection))
+        {
+          const DWORD kTimeSinceLastSignal = currentTime - timeLastSignalled;
+          if (kTimeSinceLastSignal < kAxisSignalPeriodMilliseconds)
+          {
+            // The axis might stop moving before the period elapses, in which case no further
+            // refresh would ever signal its final position. The same checks are therefore made
+            // again once the period has elapsed.
+            ScheduleTrailingStateChangeSignal(kAxisSignalPeriodMilliseconds - kTimeSinceLastSignal);
+            return;
+          }
+
+          const SProperties currentProperties = properties.Get();
+          bool axisChangeIsSignificant = false;
+
+          for (int i = 0; i < static_cast<int>(EAxis::Count); ++i)
+          {
+            const int64_t axisRange = (int64_t)currentProperties.axis[i].rangeMax -
+                (int64_t)currentProperties.axis[i].rangeMin;
+            const int64_t axisChange = std::abs(
+                (int64_t)currentStateProcessed.axis[i] - (int64_t)stateLastSignalled.axis[i]);
+
+            if ((axisChange * 100) > (axisRange * kAxisThresholdPercent))
+            {
+              axisChangeIsSignificant = true;
+              break;
+            }
+          }
+
+          if (false == axisChangeIsSignificant) return;
+        }
+
+        stateLastSignalled = currentStateProcessed;
+        timeLastSignalled = currentTime;
+      }
+
+      SetEvent(eventHandleToSignal);
+    }
+
+    void VirtualController::UpdateRefreshMode(void)
+    {
+      const bool kCanPullState = CanPullState();
+      if (kCanPullState == isPullModeActive.load(std::memory_order_relaxed)) return;
+
+      if (true == kCanPullState)
+      {
+        // The raw state was last pushed, so its generation is not known and the first pull must
+        // replace it unconditionally.
+        stateRawGeneration.store(kStateRawGenerationUnknown, std::memory_order_relaxed);
+        isPullModeActive.store(true, std::memory_order_release);
+        return;
+      }
 
-      if ((NULL != eventHandleToSignal) && (INVALID_HANDLE_VALUE != eventHandleToSignal))
-        SetEvent(eventHandleToSignal);
+      // Switching before pulling, rather than after, guarantees that a raw state published while
+      // switching is either pushed by the physical controller or pulled here. Pairs with the fence
+      // in #RefreshStateOrDefer.
+      isPullModeActive.store(false, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      PullStateLocked();
     }
   } // namespace Controller
 } // namespace Xidi
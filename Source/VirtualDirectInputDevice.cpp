@@ -11,63 +11,82 @@
 
 #include "VirtualDirectInputDevice.h"
 
+#include <array>
 #include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <unordered_map>
 
 #include <Infra/Core/Configuration.h>
 #include <Infra/Core/Message.h>
 #include <Infra/Core/ProcessInfo.h>
 
+#include "ApiCallProfile.h"
 #include "ApiDirectInput.h"
 #include "ApiGUID.h"
+#include "AsyncLog.h"
 #include "ControllerIdentification.h"
 #include "ControllerTypes.h"
 #include "DataFormat.h"
+#include "FlightRecorder.h"
 #include "ForceFeedbackDevice.h"
 #include "ForceFeedbackTypes.h"
 #include "Globals.h"
 #include "PhysicalController.h"
+#include "Settings.h"
+#include "StateChangeEventBuffer.h"
 #include "Strings.h"
 #include "VirtualController.h"
 #include "VirtualDirectInputEffect.h"
 
 /// Logs a DirectInput interface method invocation and returns.
-#define LOG_INVOCATION_AND_RETURN(result, severity)                                                        \
-  do                                                                                                       \
-  {                                                                                                        \
-    const HRESULT hresult = (result);                                                                      \
-    Infra::Message::OutputFormatted(                                                                       \
-        severity,                                                                                          \
-        L"Invoked %s on interface object %u associated with Xidi virtual controller %u, result = 0x%08x.", \
-        __FUNCTIONW__ L"()",                                                                               \
-        this->kObjectId,                                                                                   \
-        (1 + this->controller->GetIdentifier()),                                                           \
-        hresult);                                                                                          \
-    return hresult;                                                                                        \
-  }                                                                                                        \
+#define LOG_INVOCATION_AND_RETURN(result, severity)                                                          \
+  do                                                                                                         \
+  {                                                                                                          \
+    const HRESULT hresult = (result);                                                                        \
+    if (AsyncLog::WillOutputMessageOfSeverity(severity))                                                     \
+      AsyncLog::OutputFormatted(                                                                             \
+          severity,                                                                                          \
+          L"Invoked %s on interface object %u associated with Xidi virtual controller %u, result = 0x%08x.", \
+          __FUNCTIONW__ L"()",                                                                               \
+          this->kObjectId,                                                                                   \
+          (1 + this->controller->GetIdentifier()),                                                           \
+          hresult);                                                                                          \
+    FlightRecorder::RecordApiCall(                                                                           \
+        __FUNCTIONW__,                                                                                       \
+        this->controller->GetIdentifier(),                                                                   \
+        this->kObjectId,                                                                                     \
+        (uint32_t)hresult);                                                                                  \
+    return hresult;                                                                                          \
+  }                                                                                                          \
   while (false)
 
 /// Logs a DirectInput property-related method invocation and returns.
-#define LOG_PROPERTY_INVOCATION_AND_RETURN(result, severity, rguidprop, propvalfmt, ...)                                                          \
-  do                                                                                                                                              \
-  {                                                                                                                                               \
-    const HRESULT hresult = (result);                                                                                                             \
-    Infra::Message::OutputFormatted(                                                                                                              \
-        severity,                                                                                                                                 \
-        L"Invoked function %s on interface object %u associated with Xidi virtual controller %u, result = 0x%08x, property = %s" propvalfmt L".", \
-        __FUNCTIONW__ L"()",                                                                                                                      \
-        this->kObjectId,                                                                                                                          \
-        (1 + this->controller->GetIdentifier()),                                                                                                  \
-        hresult,                                                                                                                                  \
-        PropertyGuidString(rguidprop),                                                                                                            \
-        ##__VA_ARGS__);                                                                                                                           \
-    return hresult;                                                                                                                               \
-  }                                                                                                                                               \
+#define LOG_PROPERTY_INVOCATION_AND_RETURN(result, severity, rguidprop, propvalfmt, ...)                                                            \
+  do                                                                                                                                                \
+  {                                                                                                                                                 \
+    const HRESULT hresult = (result);                                                                                                               \
+    if (AsyncLog::WillOutputMessageOfSeverity(severity))                                                                                            \
+      AsyncLog::OutputFormatted(                                                                                                                    \
+          severity,                                                                                                                                 \
+          L"Invoked function %s on interface object %u associated with Xidi virtual controller %u, result = 0x%08x, property = %s" propvalfmt L".", \
+          __FUNCTIONW__ L"()",                                                                                                                      \
+          this->kObjectId,                                                                                                                          \
+          (1 + this->controller->GetIdentifier()),                                                                                                  \
+          hresult,                                                                                                                                  \
+          PropertyGuidString(rguidprop),                                                                                                            \
+          ##__VA_ARGS__);                                                                                                                           \
+    FlightRecorder::RecordApiCall(                                                                                                                  \
+        __FUNCTIONW__,                                                                                                                              \
+        this->controller->GetIdentifier(),                                                                                                          \
+        this->kObjectId,                                                                                                                            \
+        (uint32_t)hresult);                                                                                                                         \
+    return hresult;                                                                                                                                 \
+  }                                                                                                                                                 \
   while (false)
 
 /// Logs a DirectInput property-related method without a value and returns.
@@ -101,6 +120,19 @@
   LOG_PROPERTY_INVOCATION_AND_RETURN(                                                              \
       result, severity, rguidprop, L", value = { wsz = \"%s\" }", ((LPDIPROPSTRING)ppropval)->wsz)
 
+/// Logs a DirectInput property-related method where the value is provided in a
+/// DIPROPXIDIPOLLINGPOLICY structure and returns.
+#define LOG_PROPERTY_INVOCATION_DIPROPXIDIPOLLINGPOLICY_AND_RETURN(                                \
+    result, severity, rguidprop, ppropval)                                                         \
+  LOG_PROPERTY_INVOCATION_AND_RETURN(                                                              \
+      result,                                                                                      \
+      severity,                                                                                    \
+      rguidprop,                                                                                   \
+      L", value = { dwPollingPeriodMilliseconds = %u,"                                             \
+      L" dwStateChangeEventPeriodMilliseconds = %u }",                                             \
+      ((DIPROPXIDIPOLLINGPOLICY*)ppropval)->dwPollingPeriodMilliseconds,                           \
+      ((DIPROPXIDIPOLLINGPOLICY*)ppropval)->dwStateChangeEventPeriodMilliseconds)
+
 namespace Xidi
 {
   /// Alias for a pointer to a function that, when invoked, constructs a force feedback effect
@@ -111,6 +143,11 @@ namespace Xidi
       std::unique_ptr<VirtualDirectInputEffect<diVersion>> (*)(
           REFGUID, VirtualDirectInputDeviceBase<diVersion>&);
 
+  /// Longest physical controller polling period that an application can request using the
+  /// Xidi-specific polling policy property, in milliseconds. Matches the limit that applies to the
+  /// polling period set in the configuration file.
+  static constexpr DWORD kMaxPollingPeriodRequestMilliseconds = 1000;
+
   /// Generator for unique internal object identifiers for each #VirtualDirectInputDeviceBase object
   /// that is created.
   static std::atomic<unsigned int> nextVirtualDirectInputDeviceBaseObjectId = 0;
@@ -306,6 +343,20 @@ namespace Xidi
     }
   }
 
+  /// Determines if the specified property GUID identifies the Xidi-specific polling policy
+  /// property. Predefined DirectInput properties are identified by small integer values rather
+  /// than by pointers to actual GUIDs, so those must be ruled out before the GUID is compared.
+  /// @param [in] rguidProp GUID to check.
+  /// @return `true` if the property is the Xidi-specific polling policy property, `false`
+  /// otherwise.
+  static bool IsPollingPolicyProperty(REFGUID rguidProp)
+  {
+    // The whole pointer value is examined, because truncating it to 32 bits would misclassify
+    // addresses of real GUIDs whose bits 16 to 31 happen to be 0 in 64-bit builds.
+    if (0 == ((size_t)&rguidProp >> 16)) return false;
+    return (DIPROP_XIDI_POLLINGPOLICY == rguidProp);
+  }
+
   /// Returns a human-readable string that represents the specified property GUID.
   /// @param [in] pguid GUID to check.
   /// @return String representation of the GUID's semantics.
@@ -364,10 +415,27 @@ namespace Xidi
       case ((size_t)&DIPROP_LOGICALRANGE):
         return L"DIPROP_LOGICALRANGE";
       default:
+        if (true == IsPollingPolicyProperty(rguidProp)) return L"DIPROP_XIDI_POLLINGPOLICY";
         return L"(unknown)";
     }
   }
 
+  /// Determines if on-demand polling is enabled in the configuration file.
+  /// @return `true` if polling a device or retrieving its state should cause the physical
+  /// controller to be read immediately, `false` otherwise.
+  static bool IsOnDemandPollingEnabled(void)
+  {
+    return Globals::GetSettings().properties.onDemandPolling;
+  }
+
+  /// Determines if axis extrapolation is enabled in the configuration file.
+  /// @return `true` if axes in motion should be extrapolated to the time at which the application
+  /// retrieves device state, `false` otherwise.
+  static bool IsAxisExtrapolationEnabled(void)
+  {
+    return Globals::GetSettings().properties.axisExtrapolation;
+  }
+
   /// Performs property-specific validation of the supplied property header.
   /// Ensures the header exists and all sizes are correct.
   /// @param [in] rguidProp GUID of the property for which the header is being validated.
@@ -522,6 +590,33 @@ namespace Xidi
         break;
 
       default:
+        if (true == IsPollingPolicyProperty(rguidProp))
+        {
+          // This Xidi-specific property uses DIPROPXIDIPOLLINGPOLICY and is exclusively a
+          // device-wide property.
+          if (DIPH_DEVICE != pdiph->dwHow)
+          {
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Warning,
+                L"Rejected invalid property header for %s: Incorrect object identification method for this property (expected %s, got %s).",
+                PropertyGuidString(rguidProp),
+                IdentificationMethodString(DIPH_DEVICE),
+                IdentificationMethodString(pdiph->dwHow));
+            return false;
+          }
+          else if (sizeof(DIPROPXIDIPOLLINGPOLICY) != pdiph->dwSize)
+          {
+            Infra::Message::OutputFormatted(
+                Infra::Message::ESeverity::Warning,
+                L"Rejected invalid property header for %s: Incorrect size for DIPROPXIDIPOLLINGPOLICY (expected %u, got %u).",
+                PropertyGuidString(rguidProp),
+                (unsigned int)sizeof(DIPROPXIDIPOLLINGPOLICY),
+                (unsigned int)pdiph->dwSize);
+            return false;
+          }
+          break;
+        }
+
         // Any property not listed here is not supported by Xidi and therefore not validated by it.
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Warning,
@@ -546,7 +641,7 @@ namespace Xidi
   {
     constexpr Infra::Message::ESeverity kDumpSeverity = Infra::Message::ESeverity::Debug;
 
-    if (Infra::Message::WillOutputMessageOfSeverity(kDumpSeverity))
+    if (AsyncLog::WillOutputMessageOfSeverity(kDumpSeverity))
     {
       Infra::Message::Output(kDumpSeverity, L"Begin dump of property request.");
 
@@ -647,6 +742,41 @@ namespace Xidi
                return std::make_unique<PeriodicDirectInputEffect<diVersion>>(
                    associatedDevice, Controller::ForceFeedback::SawtoothDownEffect(), rguidEffect);
              }},
+            {GUID_CustomForce,
+             [](REFGUID rguidEffect, VirtualDirectInputDeviceBase<diVersion>& associatedDevice)
+                 -> std::unique_ptr<VirtualDirectInputEffect<diVersion>>
+             {
+               return std::make_unique<CustomForceDirectInputEffect<diVersion>>(
+                   associatedDevice, Controller::ForceFeedback::CustomForceEffect(), rguidEffect);
+             }},
+            {GUID_Spring,
+             [](REFGUID rguidEffect, VirtualDirectInputDeviceBase<diVersion>& associatedDevice)
+                 -> std::unique_ptr<VirtualDirectInputEffect<diVersion>>
+             {
+               return std::make_unique<ConditionDirectInputEffect<diVersion>>(
+                   associatedDevice, Controller::ForceFeedback::SpringEffect(), rguidEffect);
+             }},
+            {GUID_Damper,
+             [](REFGUID rguidEffect, VirtualDirectInputDeviceBase<diVersion>& associatedDevice)
+                 -> std::unique_ptr<VirtualDirectInputEffect<diVersion>>
+             {
+               return std::make_unique<ConditionDirectInputEffect<diVersion>>(
+                   associatedDevice, Controller::ForceFeedback::DamperEffect(), rguidEffect);
+             }},
+            {GUID_Inertia,
+             [](REFGUID rguidEffect, VirtualDirectInputDeviceBase<diVersion>& associatedDevice)
+                 -> std::unique_ptr<VirtualDirectInputEffect<diVersion>>
+             {
+               return std::make_unique<ConditionDirectInputEffect<diVersion>>(
+                   associatedDevice, Controller::ForceFeedback::InertiaEffect(), rguidEffect);
+             }},
+            {GUID_Friction,
+             [](REFGUID rguidEffect, VirtualDirectInputDeviceBase<diVersion>& associatedDevice)
+                 -> std::unique_ptr<VirtualDirectInputEffect<diVersion>>
+             {
+               return std::make_unique<ConditionDirectInputEffect<diVersion>>(
+                   associatedDevice, Controller::ForceFeedback::FrictionEffect(), rguidEffect);
+             }},
         };
 
     auto forceFeedbackEffectObjectCreatorIt = kForceFeedbackEffectObjectCreators.find(rguidEffect);
@@ -715,6 +845,14 @@ namespace Xidi
     if (rguidEffect == GUID_CustomForce)
       strncpy_s(
           buf, bufcount, XIDI_EFFECT_NAME_CUSTOM_FORCE, _countof(XIDI_EFFECT_NAME_CUSTOM_FORCE));
+    if (rguidEffect == GUID_Spring)
+      strncpy_s(buf, bufcount, XIDI_EFFECT_NAME_SPRING, _countof(XIDI_EFFECT_NAME_SPRING));
+    if (rguidEffect == GUID_Damper)
+      strncpy_s(buf, bufcount, XIDI_EFFECT_NAME_DAMPER, _countof(XIDI_EFFECT_NAME_DAMPER));
+    if (rguidEffect == GUID_Inertia)
+      strncpy_s(buf, bufcount, XIDI_EFFECT_NAME_INERTIA, _countof(XIDI_EFFECT_NAME_INERTIA));
+    if (rguidEffect == GUID_Friction)
+      strncpy_s(buf, bufcount, XIDI_EFFECT_NAME_FRICTION, _countof(XIDI_EFFECT_NAME_FRICTION));
   }
 
   /// Fills the specified buffer with a friendly string representation of the specified force
@@ -773,6 +911,30 @@ namespace Xidi
           bufcount,
           _CRT_WIDE(XIDI_EFFECT_NAME_CUSTOM_FORCE),
           _countof(_CRT_WIDE(XIDI_EFFECT_NAME_CUSTOM_FORCE)));
+    if (rguidEffect == GUID_Spring)
+      wcsncpy_s(
+          buf,
+          bufcount,
+          _CRT_WIDE(XIDI_EFFECT_NAME_SPRING),
+          _countof(_CRT_WIDE(XIDI_EFFECT_NAME_SPRING)));
+    if (rguidEffect == GUID_Damper)
+      wcsncpy_s(
+          buf,
+          bufcount,
+          _CRT_WIDE(XIDI_EFFECT_NAME_DAMPER),
+          _countof(_CRT_WIDE(XIDI_EFFECT_NAME_DAMPER)));
+    if (rguidEffect == GUID_Inertia)
+      wcsncpy_s(
+          buf,
+          bufcount,
+          _CRT_WIDE(XIDI_EFFECT_NAME_INERTIA),
+          _countof(_CRT_WIDE(XIDI_EFFECT_NAME_INERTIA)));
+    if (rguidEffect == GUID_Friction)
+      wcsncpy_s(
+          buf,
+          bufcount,
+          _CRT_WIDE(XIDI_EFFECT_NAME_FRICTION),
+          _countof(_CRT_WIDE(XIDI_EFFECT_NAME_FRICTION)));
   }
 
   /// Retrieves the force feedback effect type, given a force feedback effect GUID.
@@ -788,6 +950,10 @@ namespace Xidi
     if (rguidEffect == GUID_SawtoothUp) return DIEFT_PERIODIC;
     if (rguidEffect == GUID_SawtoothDown) return DIEFT_PERIODIC;
     if (rguidEffect == GUID_CustomForce) return DIEFT_CUSTOMFORCE;
+    if (rguidEffect == GUID_Spring) return DIEFT_CONDITION;
+    if (rguidEffect == GUID_Damper) return DIEFT_CONDITION;
+    if (rguidEffect == GUID_Inertia) return DIEFT_CONDITION;
+    if (rguidEffect == GUID_Friction) return DIEFT_CONDITION;
 
     return std::nullopt;
   }
@@ -817,6 +983,51 @@ namespace Xidi
     }
   }
 
+  /// Converts a contiguous run of buffered events to DirectInput object data and writes the results
+  /// to an application-supplied buffer, one element per event.
+  /// @param [in] dataFormat Application data format, used for computing offsets.
+  /// @param [in] events Buffered events to convert.
+  /// @param [out] objectData Buffer to receive the object data. Must have room for all events.
+  /// @return `true` if all events were converted successfully, `false` otherwise.
+  static bool WriteDeviceObjectData(
+      const DataFormat& dataFormat,
+      std::span<const Controller::StateChangeEventBuffer::SEvent> events,
+      LPDIDEVICEOBJECTDATA objectData)
+  {
+    for (const auto& event : events)
+    {
+      DWORD data = 0;
+
+      switch (event.data.element.type)
+      {
+        case Controller::EElementType::Axis:
+          data = (DWORD)DataFormat::DirectInputAxisValue(event.data.value.axis);
+          break;
+
+        case Controller::EElementType::Button:
+          data = (DWORD)DataFormat::DirectInputButtonValue(event.data.value.button);
+          break;
+
+        case Controller::EElementType::Pov:
+          data = (DWORD)DataFormat::DirectInputPovValue(event.data.value.povDirection);
+          break;
+
+        default: // This should never happen.
+          return false;
+      }
+
+      // Any fields not explicitly set here are zero-initialized.
+      *objectData++ = {
+          .dwOfs = dataFormat.GetOffsetForElement(event.data.element)
+                       .value(), // A value should always be present.
+          .dwData = data,
+          .dwTimeStamp = event.timestamp,
+          .dwSequence = event.sequence};
+    }
+
+    return true;
+  }
+
   /// Generates an object identifier given a controller element and its associated controller
   /// capabilities.
   /// @param [in] controllerCapabilities Capabilities that describe the layout of the virtual
@@ -857,23 +1068,100 @@ namespace Xidi
   template <EDirectInputVersion diVersion> static void FillForceFeedbackEffectInfo(
       typename DirectInputTypes<diVersion>::EffectInfoType* effectInfo)
   {
-    // All effects support envelope parameters, both attack and fade.
+    // Condition effects support separate positive and negative coefficients and saturations as
+    // well as a dead band, but they respond to axis state rather than to time and so have no
+    // envelope. All other effects support envelope parameters, both attack and fade.
+    constexpr DWORD kConditionEffectTypeExtraFlags =
+        (DIEFT_SATURATION | DIEFT_POSNEGCOEFFICIENTS | DIEFT_POSNEGSATURATION | DIEFT_DEADBAND);
     constexpr DWORD kEffectTypeExtraFlags = (DIEFT_FFATTACK | DIEFT_FFFADE);
-    effectInfo->dwEffType |= kEffectTypeExtraFlags;
+    const bool isConditionEffect = (DIEFT_CONDITION == DIEFT_GETTYPE(effectInfo->dwEffType));
+    effectInfo->dwEffType |=
+        ((true == isConditionEffect) ? kConditionEffectTypeExtraFlags : kEffectTypeExtraFlags);
 
     // All effects support these parameters, and they can be changed on-the-fly while effects are
     // playing.
     constexpr DWORD kEffectSupportedParameters =
         (DIEP_AXES | DIEP_DIRECTION | DIEP_DURATION | DIEP_ENVELOPE | DIEP_GAIN |
          DIEP_SAMPLEPERIOD | DIEP_STARTDELAY | DIEP_TYPESPECIFICPARAMS);
-    effectInfo->dwStaticParams = kEffectSupportedParameters;
-    effectInfo->dwDynamicParams = kEffectSupportedParameters;
+    const DWORD effectSupportedParameters =
+        ((true == isConditionEffect) ? (kEffectSupportedParameters & ~DIEP_ENVELOPE)
+                                     : kEffectSupportedParameters);
+    effectInfo->dwStaticParams = effectSupportedParameters;
+    effectInfo->dwDynamicParams = effectSupportedParameters;
 
     // Last step is to fill in the friendly name.
     ForceFeedbackEffectToString(
         effectInfo->guid, effectInfo->tszName, _countof(effectInfo->tszName));
   }
 
+  /// Force feedback effects that Xidi can describe to applications, in the order in which they are
+  /// enumerated.
+  static const GUID* const kForceFeedbackEffectGuids[] = {
+      &GUID_ConstantForce,
+      &GUID_RampForce,
+      &GUID_Square,
+      &GUID_Sine,
+      &GUID_Triangle,
+      &GUID_SawtoothUp,
+      &GUID_SawtoothDown,
+      &GUID_CustomForce,
+      &GUID_Spring,
+      &GUID_Damper,
+      &GUID_Inertia,
+      &GUID_Friction};
+
+  /// Retrieves the table of information structures that describe all of the force feedback effects
+  /// Xidi can describe to applications. The table is built the first time it is needed and never
+  /// changes afterwards, so enumerating or describing effects is just a matter of reading from it.
+  /// @tparam charMode Selects between ASCII ("A" suffix) and Unicode ("W") suffix versions of types
+  /// and interfaces.
+  /// @return Read-only reference to the table, in the same order as #kForceFeedbackEffectGuids.
+  template <EDirectInputVersion diVersion> static const std::array<
+      typename DirectInputTypes<diVersion>::EffectInfoType,
+      _countof(kForceFeedbackEffectGuids)>&
+      ForceFeedbackEffectInfoTable(void)
+  {
+    using EffectInfoType = typename DirectInputTypes<diVersion>::EffectInfoType;
+
+    static const std::array<EffectInfoType, _countof(kForceFeedbackEffectGuids)> kEffectInfoTable =
+        []() -> std::array<EffectInfoType, _countof(kForceFeedbackEffectGuids)>
+    {
+      std::array<EffectInfoType, _countof(kForceFeedbackEffectGuids)> effectInfoTable = {};
+
+      for (size_t i = 0; i < effectInfoTable.size(); ++i)
+      {
+        const GUID& effectGuid = *kForceFeedbackEffectGuids[i];
+
+        effectInfoTable[i] = {
+            .dwSize = sizeof(EffectInfoType),
+            .guid = effectGuid,
+            .dwEffType = ForceFeedbackEffectType(effectGuid).value()};
+        FillForceFeedbackEffectInfo<diVersion>(&effectInfoTable[i]);
+      }
+
+      return effectInfoTable;
+    }();
+
+    return kEffectInfoTable;
+  }
+
+  /// Looks up the information structure that describes the specified force feedback effect.
+  /// @tparam charMode Selects between ASCII ("A" suffix) and Unicode ("W") suffix versions of types
+  /// and interfaces.
+  /// @param [in] rguidEffect Reference to the GUID that identifies the force feedback effect.
+  /// @return Pointer to the information structure, or `nullptr` if the effect is not recognized.
+  template <EDirectInputVersion diVersion> static const
+      typename DirectInputTypes<diVersion>::EffectInfoType*
+      ForceFeedbackEffectInfo(REFGUID rguidEffect)
+  {
+    for (const auto& effectInfo : ForceFeedbackEffectInfoTable<diVersion>())
+    {
+      if (effectInfo.guid == rguidEffect) return &effectInfo;
+    }
+
+    return nullptr;
+  }
+
   /// Fills the specified object instance information structure with information about the specified
   /// HID collection. Size member must already be initialized because multiple versions of the
   /// structure exist, so it is used to determine which members to fill in.
@@ -996,16 +1284,63 @@ namespace Xidi
       : kObjectId(nextVirtualDirectInputDeviceBaseObjectId++),
         controller(std::move(controller)),
         cooperativeLevel(ECooperativeLevel::Shared),
+        objectInstanceTable(),
         dataFormat(),
+        lastDeviceState(),
+        deviceStateMutex(),
         effectRegistry(),
         refCount(1),
+        requestedPollingPeriodMilliseconds(0),
         unusedProperties()
-  {}
+  {
+    constexpr uint16_t kHidCollectionsToEnumerate[] = {
+        kVirtualControllerHidCollectionForEntireDevice,
+        kVirtualControllerHidCollectionForIndividualElements};
+
+    const Controller::SCapabilities controllerCapabilities = this->controller->GetCapabilities();
+    objectInstanceTable.reserve(
+        controllerCapabilities.numAxes + controllerCapabilities.numButtons +
+        ((true == controllerCapabilities.HasPov()) ? 1 : 0) + _countof(kHidCollectionsToEnumerate));
+
+    auto appendElementRecord = [this, &controllerCapabilities](
+                                   Controller::SElementIdentifier element) -> void
+    {
+      SObjectInstanceRecord& record = objectInstanceTable.emplace_back(SObjectInstanceRecord{
+          .element = element,
+          .instance = {.dwSize = sizeof(DirectInputTypes<diVersion>::DeviceObjectInstanceType)}});
+      FillObjectInstanceInfo<diVersion>(controllerCapabilities, element, 0, &record.instance);
+    };
+
+    for (int i = 0; i < controllerCapabilities.numAxes; ++i)
+      appendElementRecord(
+          {.type = Controller::EElementType::Axis,
+           .axis = controllerCapabilities.axisCapabilities[i].type});
+
+    for (int i = 0; i < controllerCapabilities.numButtons; ++i)
+      appendElementRecord(
+          {.type = Controller::EElementType::Button, .button = (Controller::EButton)i});
+
+    if (true == controllerCapabilities.HasPov())
+      appendElementRecord({.type = Controller::EElementType::Pov});
+
+    for (const auto hidCollectionNumber : kHidCollectionsToEnumerate)
+    {
+      SObjectInstanceRecord& record = objectInstanceTable.emplace_back(SObjectInstanceRecord{
+          .element = {.type = Controller::EElementType::WholeController},
+          .instance = {.dwSize = sizeof(DirectInputTypes<diVersion>::DeviceObjectInstanceType)}});
+      FillHidCollectionInstanceInfo<diVersion>(hidCollectionNumber, &record.instance);
+    }
+  }
 
   template <EDirectInputVersion diVersion> VirtualDirectInputDeviceBase<
       diVersion>::~VirtualDirectInputDeviceBase(void)
   {
     controller->ForceFeedbackUnregister();
+
+    const DWORD kRequestedPollingPeriodMilliseconds = requestedPollingPeriodMilliseconds.load();
+    if (0 != kRequestedPollingPeriodMilliseconds)
+      Controller::WithdrawPollingPeriodRequest(
+          controller->GetIdentifier(), kRequestedPollingPeriodMilliseconds);
   }
 
   template <EDirectInputVersion diVersion> void
@@ -1144,6 +1479,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::QueryInterface(REFIID riid, LPVOID* ppvObj)
   {
+    PROFILE_API_CALL();
+
     if (nullptr == ppvObj) return E_POINTER;
 
     if (true == DirectInputTypes<diVersion>::IsCompatibleDirectInputDeviceIID(riid))
@@ -1159,12 +1496,16 @@ namespace Xidi
   template <EDirectInputVersion diVersion> ULONG VirtualDirectInputDeviceBase<diVersion>::AddRef(
       void)
   {
+    PROFILE_API_CALL();
+
     return ++refCount;
   }
 
   template <EDirectInputVersion diVersion> ULONG VirtualDirectInputDeviceBase<diVersion>::Release(
       void)
   {
+    PROFILE_API_CALL();
+
     const unsigned long numRemainingRefs = --refCount;
 
     if (0 == numRemainingRefs) delete this;
@@ -1175,6 +1516,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputDeviceBase<diVersion>::Acquire(
       void)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     // DirectInput documentation requires that the application data format already be set before a
@@ -1196,6 +1539,11 @@ namespace Xidi
             L"Acquiring Xidi virtual controller %u in exclusive mode.",
             (1 + controller->GetIdentifier()));
 
+#ifdef XIDI_SKIP_FORCE_FEEDBACK
+        // Builds without force feedback have no device buffer to give the virtual controller, so
+        // exclusive acquisition is no different from any other.
+        LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
+#else
         if (true == controller->ForceFeedbackIsRegistered())
           LOG_INVOCATION_AND_RETURN(S_FALSE, kMethodSeverity);
 
@@ -1205,6 +1553,7 @@ namespace Xidi
         // Getting to this point means force feedback registration failed. This should not normally
         // occur.
         LOG_INVOCATION_AND_RETURN(DIERR_OTHERAPPHASPRIO, Infra::Message::ESeverity::Error);
+#endif
 
       default:
         // No other cooperative level requires any action on Xidi's part for the acquisition to
@@ -1217,6 +1566,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::CreateEffect(
           REFGUID rguid, LPCDIEFFECT lpeff, LPDIRECTINPUTEFFECT* ppdeff, LPUNKNOWN punkOuter)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (false == controller->GetCapabilities().ForceFeedbackIsSupported())
@@ -1280,6 +1631,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::EnumCreatedEffectObjects(
           LPDIENUMCREATEDEFFECTOBJECTSCALLBACK lpCallback, LPVOID pvRef, DWORD fl)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if ((nullptr == lpCallback) || (0 != fl))
@@ -1323,6 +1676,8 @@ namespace Xidi
           LPVOID pvRef,
           DWORD dwEffType)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == lpCallback) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
@@ -1336,120 +1691,23 @@ namespace Xidi
       LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
     }
 
-    const bool willEnumerateConstantForce =
-        ((DIEFT_ALL == dwEffType) || (DIEFT_CONSTANTFORCE == DIEFT_GETTYPE(dwEffType)));
-    const bool willEnumerateRampForce =
-        ((DIEFT_ALL == dwEffType) || (DIEFT_RAMPFORCE == DIEFT_GETTYPE(dwEffType)));
-    const bool willEnumeratePeriodic =
-        ((DIEFT_ALL == dwEffType) || (DIEFT_PERIODIC == DIEFT_GETTYPE(dwEffType)));
-    const bool willEnumerateCustomForce =
-        ((DIEFT_ALL == dwEffType) || (DIEFT_CUSTOMFORCE == DIEFT_GETTYPE(dwEffType)));
-
-    if ((true == willEnumerateConstantForce) || (true == willEnumerateCustomForce) ||
-        (true == willEnumeratePeriodic) || (true == willEnumerateRampForce))
-    {
-      std::unique_ptr<DirectInputTypes<diVersion>::EffectInfoType> effectDescriptor =
-          std::make_unique<DirectInputTypes<diVersion>::EffectInfoType>();
-
-      if (true == willEnumerateConstantForce)
-      {
-        const GUID* kEffectGuids[] = {&GUID_ConstantForce};
-        for (const auto effectGuid : kEffectGuids)
-        {
-          if (true == ForceFeedbackEffectCanCreateObject(*effectGuid))
-          {
-            *effectDescriptor = {
-                .dwSize = sizeof(*effectDescriptor),
-                .guid = *effectGuid,
-                .dwEffType = ForceFeedbackEffectType(*effectGuid).value()};
-            FillForceFeedbackEffectInfo<diVersion>(effectDescriptor.get());
-            switch (lpCallback(effectDescriptor.get(), pvRef))
-            {
-              case DIENUM_CONTINUE:
-                break;
-              case DIENUM_STOP:
-                LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-              default:
-                LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-            }
-          }
-        }
-      }
-
-      if (true == willEnumerateRampForce)
-      {
-        const GUID* kEffectGuids[] = {&GUID_RampForce};
-        for (const auto effectGuid : kEffectGuids)
-        {
-          if (true == ForceFeedbackEffectCanCreateObject(*effectGuid))
-          {
-            *effectDescriptor = {
-                .dwSize = sizeof(*effectDescriptor),
-                .guid = *effectGuid,
-                .dwEffType = ForceFeedbackEffectType(*effectGuid).value()};
-            FillForceFeedbackEffectInfo<diVersion>(effectDescriptor.get());
-            switch (lpCallback(effectDescriptor.get(), pvRef))
-            {
-              case DIENUM_CONTINUE:
-                break;
-              case DIENUM_STOP:
-                LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-              default:
-                LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-            }
-          }
-        }
-      }
+    const DWORD effectTypeToEnumerate = DIEFT_GETTYPE(dwEffType);
 
-      if (true == willEnumeratePeriodic)
-      {
-        const GUID* kEffectGuids[] = {
-            &GUID_Square, &GUID_Sine, &GUID_Triangle, &GUID_SawtoothUp, &GUID_SawtoothDown};
-        for (const auto effectGuid : kEffectGuids)
-        {
-          if (true == ForceFeedbackEffectCanCreateObject(*effectGuid))
-          {
-            *effectDescriptor = {
-                .dwSize = sizeof(*effectDescriptor),
-                .guid = *effectGuid,
-                .dwEffType = ForceFeedbackEffectType(*effectGuid).value()};
-            FillForceFeedbackEffectInfo<diVersion>(effectDescriptor.get());
-            switch (lpCallback(effectDescriptor.get(), pvRef))
-            {
-              case DIENUM_CONTINUE:
-                break;
-              case DIENUM_STOP:
-                LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-              default:
-                LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-            }
-          }
-        }
-      }
+    for (const auto& effectInfo : ForceFeedbackEffectInfoTable<diVersion>())
+    {
+      if ((DIEFT_ALL != dwEffType) &&
+          (effectTypeToEnumerate != DIEFT_GETTYPE(effectInfo.dwEffType)))
+        continue;
+      if (false == ForceFeedbackEffectCanCreateObject(effectInfo.guid)) continue;
 
-      if (true == willEnumerateCustomForce)
+      switch (lpCallback(&effectInfo, pvRef))
       {
-        const GUID* kEffectGuids[] = {&GUID_CustomForce};
-        for (const auto effectGuid : kEffectGuids)
-        {
-          if (true == ForceFeedbackEffectCanCreateObject(*effectGuid))
-          {
-            *effectDescriptor = {
-                .dwSize = sizeof(*effectDescriptor),
-                .guid = *effectGuid,
-                .dwEffType = ForceFeedbackEffectType(*effectGuid).value()};
-            FillForceFeedbackEffectInfo<diVersion>(effectDescriptor.get());
-            switch (lpCallback(effectDescriptor.get(), pvRef))
-            {
-              case DIENUM_CONTINUE:
-                break;
-              case DIENUM_STOP:
-                LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-              default:
-                LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
-            }
-          }
-        }
+        case DIENUM_CONTINUE:
+          break;
+        case DIENUM_STOP:
+          LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
+        default:
+          LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
       }
     }
 
@@ -1463,6 +1721,8 @@ namespace Xidi
           LPVOID pvRef,
           DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -1473,11 +1733,10 @@ namespace Xidi
           LPVOID pvRef,
           DWORD dwFlags)
   {
-    static const bool kAlwaysContinueEnumerating =
-        Globals::GetConfigurationData()
-            [Strings::kStrConfigurationSectionWorkarounds]
-            [Strings::kStrConfigurationSettingsWorkaroundsIgnoreEnumObjectsCallbackReturnCode]
-                .ValueOr(false);
+    PROFILE_API_CALL();
+
+    const bool kAlwaysContinueEnumerating =
+        Globals::GetSettings().workarounds.ignoreEnumObjectsCallbackReturnCode;
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == lpCallback) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
@@ -1503,101 +1762,53 @@ namespace Xidi
     if ((true == willEnumerateAxes) || (true == willEnumerateButtons) ||
         (true == willEnumeratePov) || (true == willEnumerateHidCollections))
     {
-      std::unique_ptr<DirectInputTypes<diVersion>::DeviceObjectInstanceType> objectDescriptor =
-          std::make_unique<DirectInputTypes<diVersion>::DeviceObjectInstanceType>();
-      const Controller::SCapabilities controllerCapabilities = controller->GetCapabilities();
+      const bool isApplicationDataFormatSet = IsApplicationDataFormatSet();
+      typename DirectInputTypes<diVersion>::DeviceObjectInstanceType objectDescriptor;
 
-      if (true == willEnumerateAxes)
+      for (const auto& record : objectInstanceTable)
       {
-        for (int i = 0; i < controllerCapabilities.numAxes; ++i)
-        {
-          if ((true == forceFeedbackActuatorsOnly) &&
-              (false == controllerCapabilities.axisCapabilities[i].supportsForceFeedback))
-            continue;
-
-          const Controller::EAxis axis = controllerCapabilities.axisCapabilities[i].type;
-          const Controller::SElementIdentifier axisIdentifier = {
-              .type = Controller::EElementType::Axis, .axis = axis};
-          const TOffset axisOffset =
-              ((true == IsApplicationDataFormatSet())
-                   ? dataFormat->GetOffsetForElement(axisIdentifier)
-                         .value_or(DataFormat::kInvalidOffsetValue)
-                   : NativeOffsetForElement(axisIdentifier));
-
-          *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-          FillObjectInstanceInfo<diVersion>(
-              controllerCapabilities, axisIdentifier, axisOffset, objectDescriptor.get());
-
-          const bool continueEnumerating =
-              (DIENUM_STOP != lpCallback(objectDescriptor.get(), pvRef));
-          if (!kAlwaysContinueEnumerating && !continueEnumerating)
-            LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-        }
-      }
+        bool willEnumerateObject = false;
 
-      if (true == willEnumerateButtons)
-      {
-        for (int i = 0; i < controllerCapabilities.numButtons; ++i)
+        switch (record.element.type)
         {
-          const Controller::EButton button = (Controller::EButton)i;
-          const Controller::SElementIdentifier buttonIdentifier = {
-              .type = Controller::EElementType::Button, .button = button};
-          const TOffset buttonOffset =
-              ((true == IsApplicationDataFormatSet())
-                   ? dataFormat->GetOffsetForElement(buttonIdentifier)
-                         .value_or(DataFormat::kInvalidOffsetValue)
-                   : NativeOffsetForElement(buttonIdentifier));
-
-          *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-          FillObjectInstanceInfo<diVersion>(
-              controllerCapabilities, buttonIdentifier, buttonOffset, objectDescriptor.get());
+          case Controller::EElementType::Axis:
+            willEnumerateObject =
+                ((true == willEnumerateAxes) &&
+                 ((false == forceFeedbackActuatorsOnly) ||
+                  (0 != (record.instance.dwType & DIDFT_FFACTUATOR))));
+            break;
 
-          const bool continueEnumerating =
-              (DIENUM_STOP != lpCallback(objectDescriptor.get(), pvRef));
-          if (!kAlwaysContinueEnumerating && !continueEnumerating)
-            LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
-        }
-      }
+          case Controller::EElementType::Button:
+            willEnumerateObject = willEnumerateButtons;
+            break;
 
-      if (true == willEnumeratePov)
-      {
-        if (true == controllerCapabilities.HasPov())
-        {
-          const Controller::SElementIdentifier povIdentifier = {
-              .type = Controller::EElementType::Pov};
-          const TOffset povOffset =
-              ((true == IsApplicationDataFormatSet())
-                   ? dataFormat->GetOffsetForElement(povIdentifier)
-                         .value_or(DataFormat::kInvalidOffsetValue)
-                   : NativeOffsetForElement(povIdentifier));
+          case Controller::EElementType::Pov:
+            willEnumerateObject = willEnumeratePov;
+            break;
 
-          *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-          FillObjectInstanceInfo<diVersion>(
-              controllerCapabilities, povIdentifier, povOffset, objectDescriptor.get());
+          case Controller::EElementType::WholeController:
+            willEnumerateObject = willEnumerateHidCollections;
+            break;
 
-          const bool continueEnumerating =
-              (DIENUM_STOP != lpCallback(objectDescriptor.get(), pvRef));
-          if (!kAlwaysContinueEnumerating && !continueEnumerating)
-            LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
+          default:
+            break;
         }
-      }
 
-      if (true == willEnumerateHidCollections)
-      {
-        constexpr uint16_t kHidCollectionsToEnumerate[] = {
-            kVirtualControllerHidCollectionForEntireDevice,
-            kVirtualControllerHidCollectionForIndividualElements};
+        if (false == willEnumerateObject) continue;
 
-        for (const auto hidCollectionNumber : kHidCollectionsToEnumerate)
+        objectDescriptor = record.instance;
+        if (Controller::EElementType::WholeController != record.element.type)
         {
-          *objectDescriptor = {.dwSize = sizeof(*objectDescriptor)};
-          FillHidCollectionInstanceInfo<diVersion>(hidCollectionNumber, objectDescriptor.get());
-
-          const bool continueEnumerating =
-              (DIENUM_STOP != lpCallback(objectDescriptor.get(), pvRef));
-          if (!kAlwaysContinueEnumerating && !continueEnumerating)
-            LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
+          objectDescriptor.dwOfs =
+              ((true == isApplicationDataFormatSet)
+                   ? dataFormat->GetOffsetForElement(record.element)
+                         .value_or(DataFormat::kInvalidOffsetValue)
+                   : NativeOffsetForElement(record.element));
         }
+
+        const bool continueEnumerating = (DIENUM_STOP != lpCallback(&objectDescriptor, pvRef));
+        if (!kAlwaysContinueEnumerating && !continueEnumerating)
+          LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
       }
     }
 
@@ -1607,6 +1818,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputDeviceBase<diVersion>::Escape(
       LPDIEFFESCAPE pesc)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -1614,12 +1827,14 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::GetCapabilities(LPDIDEVCAPS lpDIDevCaps)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == lpDIDevCaps) LOG_INVOCATION_AND_RETURN(E_POINTER, kMethodSeverity);
 
-    const bool kForceFeedbackIsSupported =
-        GetVirtualController().GetCapabilities().ForceFeedbackIsSupported();
+    const Controller::SCapabilities& controllerCapabilities = controller->GetCapabilities();
+    const bool kForceFeedbackIsSupported = controllerCapabilities.ForceFeedbackIsSupported();
 
     switch (lpDIDevCaps->dwSize)
     {
@@ -1633,7 +1848,7 @@ namespace Xidi
         {
           lpDIDevCaps->dwFFSamplePeriod =
               VirtualDirectInputEffect<diVersion>::ConvertTimeToDirectInput(
-                  Controller::kPhysicalForceFeedbackPeriodMilliseconds);
+                  Controller::GetForceFeedbackPeriodMilliseconds());
           lpDIDevCaps->dwFFMinTimeResolution =
               VirtualDirectInputEffect<diVersion>::ConvertTimeToDirectInput(1);
           lpDIDevCaps->dwFFDriverVersion = 1;
@@ -1657,9 +1872,9 @@ namespace Xidi
               (DIDC_FORCEFEEDBACK | DIDC_FFFADE | DIDC_FFATTACK | DIDC_STARTDELAY);
 
         // Information about controller layout comes from controller capabilities.
-        lpDIDevCaps->dwAxes = controller->GetCapabilities().numAxes;
-        lpDIDevCaps->dwButtons = controller->GetCapabilities().numButtons;
-        lpDIDevCaps->dwPOVs = ((true == controller->GetCapabilities().HasPov()) ? 1 : 0);
+        lpDIDevCaps->dwAxes = controllerCapabilities.numAxes;
+        lpDIDevCaps->dwButtons = controllerCapabilities.numButtons;
+        lpDIDevCaps->dwPOVs = ((true == controllerCapabilities.HasPov()) ? 1 : 0);
         break;
 
       default:
@@ -1673,6 +1888,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::GetDeviceData(
           DWORD cbObjectData, LPDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::SuperDebug;
     constexpr Infra::Message::ESeverity kMethodSeverityForError = Infra::Message::ESeverity::Info;
 
@@ -1697,46 +1914,35 @@ namespace Xidi
     if (false == controller->IsEventBufferEnabled())
       LOG_INVOCATION_AND_RETURN(DIERR_NOTBUFFERED, kMethodSeverityForError);
 
-    auto lock = controller->Lock();
-    const DWORD numEventsAffected = std::min(*pdwInOut, (DWORD)controller->GetEventBufferCount());
+    // In cooperative mode, new events are only produced while the application services the
+    // physical controller, so that happens before the event buffer is read.
+    Controller::ServicePhysicalControllerCooperatively(controller->GetIdentifier());
+
+    auto lock = controller->LockEventBuffer();
     const bool eventBufferOverflowed = controller->IsEventBufferOverflowed();
     const bool shouldPopEvents = (0 == (dwFlags & DIGDD_PEEK));
 
-    if (nullptr != rgdod)
+    // Events are converted directly out of the event buffer's storage. New events can be appended
+    // concurrently, and if that causes any of the events being converted to be overwritten then
+    // the conversion is simply redone.
+    Controller::StateChangeEventBuffer::SEventSpans events;
+    do
     {
-      for (DWORD i = 0; i < numEventsAffected; ++i)
-      {
-        const Controller::StateChangeEventBuffer::SEvent& event =
-            controller->GetEventBufferEvent(i);
-        ZeroMemory(&rgdod[i], sizeof(rgdod[i]));
-        rgdod[i].dwOfs = dataFormat->GetOffsetForElement(event.data.element)
-                             .value(); // A value should always be present.
-        rgdod[i].dwTimeStamp = event.timestamp;
-        rgdod[i].dwSequence = event.sequence;
-
-        switch (event.data.element.type)
-        {
-          case Controller::EElementType::Axis:
-            rgdod[i].dwData = (DWORD)DataFormat::DirectInputAxisValue(event.data.value.axis);
-            break;
-
-          case Controller::EElementType::Button:
-            rgdod[i].dwData = (DWORD)DataFormat::DirectInputButtonValue(event.data.value.button);
-            break;
+      events = controller->PeekEventBufferOldestEvents(*pdwInOut);
 
-          case Controller::EElementType::Pov:
-            rgdod[i].dwData = (DWORD)DataFormat::DirectInputPovValue(event.data.value.povDirection);
-            break;
-
-          default:
-            LOG_INVOCATION_AND_RETURN(
-                DIERR_GENERIC, kMethodSeverityForError); // This should never happen.
-            break;
-        }
+      if (nullptr != rgdod)
+      {
+        if ((false == WriteDeviceObjectData(*dataFormat, events.older, &rgdod[0])) ||
+            (false ==
+             WriteDeviceObjectData(*dataFormat, events.newer, &rgdod[events.older.size()])))
+          LOG_INVOCATION_AND_RETURN(DIERR_GENERIC, kMethodSeverityForError);
       }
     }
+    while (false == controller->AreEventBufferEventsIntact(events));
 
-    if (true == shouldPopEvents) controller->PopEventBufferOldestEvents(numEventsAffected);
+    const DWORD numEventsAffected = (DWORD)events.GetCount();
+    if (true == shouldPopEvents) controller->PopEventBufferEvents(events);
+    Controller::NotifyApplicationStateObserved(controller->GetIdentifier());
 
     *pdwInOut = numEventsAffected;
     LOG_INVOCATION_AND_RETURN(
@@ -1747,6 +1953,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::GetDeviceInfo(
           DirectInputTypes<diVersion>::DeviceInstanceType* pdidi)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == pdidi) LOG_INVOCATION_AND_RETURN(E_POINTER, kMethodSeverity);
@@ -1768,6 +1976,9 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::GetDeviceState(DWORD cbData, LPVOID lpvData)
   {
+    PROFILE_API_CALL();
+
+    const bool kIncrementalDeviceState = Globals::GetSettings().properties.incrementalDeviceState;
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::SuperDebug;
     constexpr Infra::Message::ESeverity kMethodSeverityForError = Infra::Message::ESeverity::Info;
 
@@ -1775,10 +1986,87 @@ namespace Xidi
         (cbData < dataFormat->GetPacketSizeBytes()))
       LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
 
+    // Applications that do not poll explicitly still benefit from on-demand polling. If they do
+    // poll right before retrieving state then this is skipped due to rate limiting.
+    Controller::NotifyApplicationStateRead(controller->GetIdentifier());
+    Controller::ServicePhysicalControllerCooperatively(controller->GetIdentifier());
+    if (true == IsOnDemandPollingEnabled())
+      Controller::PollPhysicalControllerOnDemand(controller->GetIdentifier());
+
     bool writeDataPacketResult = false;
     {
-      auto lock = controller->Lock();
-      writeDataPacketResult = dataFormat->WriteDataPacket(lpvData, cbData, controller->GetState());
+      // Virtual controller state is read as a single lock-free snapshot, so this never waits for
+      // the thread that refreshes it.
+      std::scoped_lock lock(deviceStateMutex);
+
+      Controller::TElementMask changedElements = Controller::kElementMaskAll;
+      Controller::TElementMask extrapolatedElements = 0;
+      uint64_t stateGeneration = 0;
+      const Controller::SState state = ((true == IsAxisExtrapolationEnabled())
+                                            ? controller->GetStateSinceExtrapolated(
+                                                  lastDeviceState.stateGeneration,
+                                                  changedElements,
+                                                  stateGeneration,
+                                                  extrapolatedElements)
+                                            : controller->GetStateSince(
+                                                  lastDeviceState.stateGeneration,
+                                                  changedElements,
+                                                  stateGeneration));
+      Controller::NotifyApplicationStateObserved(controller->GetIdentifier());
+
+      // Axes extrapolated now, or during the previous retrieval, differ from the published state
+      // even if its generation did not move.
+      const Controller::TElementMask extrapolatedElementsToWrite =
+          (extrapolatedElements | lastDeviceState.extrapolatedElements);
+      changedElements |= extrapolatedElementsToWrite;
+
+      // The cached data packet is brought up to date only if the state actually changed. It is
+      // private to this object, so it can always be patched in place.
+      const DWORD packetSizeBytes = (DWORD)dataFormat->GetPacketSizeBytes();
+      std::vector<uint8_t>& packet = lastDeviceState.packet;
+
+      if (true == packet.empty())
+      {
+        packet.resize(packetSizeBytes);
+        writeDataPacketResult = dataFormat->WriteDataPacket(packet.data(), packetSizeBytes, state);
+      }
+      else if (
+          (stateGeneration != lastDeviceState.stateGeneration) ||
+          (0 != extrapolatedElementsToWrite))
+      {
+        writeDataPacketResult = dataFormat->WriteDataPacketElements(
+            packet.data(), packetSizeBytes, state, changedElements);
+      }
+      else
+      {
+        writeDataPacketResult = true;
+      }
+
+      if (false == writeDataPacketResult)
+      {
+        packet.clear();
+      }
+      else if (
+          (true == kIncrementalDeviceState) && (lpvData == lastDeviceState.buffer) &&
+          (cbData == lastDeviceState.bufferSizeBytes))
+      {
+        writeDataPacketResult =
+            dataFormat->WriteDataPacketElements(lpvData, cbData, state, changedElements);
+      }
+      else
+      {
+        std::memcpy(lpvData, packet.data(), packetSizeBytes);
+        if (cbData > packetSizeBytes)
+          ZeroMemory(&((uint8_t*)lpvData)[packetSizeBytes], cbData - packetSizeBytes);
+      }
+
+      if (true == writeDataPacketResult)
+      {
+        lastDeviceState.buffer = lpvData;
+        lastDeviceState.bufferSizeBytes = cbData;
+        lastDeviceState.stateGeneration = stateGeneration;
+        lastDeviceState.extrapolatedElements = extrapolatedElements;
+      }
     }
     LOG_INVOCATION_AND_RETURN(
         ((true == writeDataPacketResult) ? DI_OK : DIERR_INVALIDPARAM), kMethodSeverity);
@@ -1788,6 +2076,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::GetEffectInfo(
           DirectInputTypes<diVersion>::EffectInfoType* pdei, REFGUID rguid)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (false == controller->GetCapabilities().ForceFeedbackIsSupported())
@@ -1804,13 +2094,11 @@ namespace Xidi
     if (sizeof(*pdei) != pdei->dwSize)
       LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
-    const std::optional<DWORD> maybeEffectType = ForceFeedbackEffectType(rguid);
-    if (false == maybeEffectType.has_value())
-      LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
+    const typename DirectInputTypes<diVersion>::EffectInfoType* const effectInfo =
+        ForceFeedbackEffectInfo<diVersion>(rguid);
+    if (nullptr == effectInfo) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
-    const DWORD effectType = maybeEffectType.value();
-    *pdei = {.dwSize = sizeof(*pdei), .guid = rguid, .dwEffType = effectType};
-    FillForceFeedbackEffectInfo<diVersion>(pdei);
+    *pdei = *effectInfo;
 
     LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
   }
@@ -1818,6 +2106,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::GetForceFeedbackState(LPDWORD pdwOut)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (false == controller->GetCapabilities().ForceFeedbackIsSupported())
@@ -1874,6 +2164,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::GetObjectInfo(
           DirectInputTypes<diVersion>::DeviceObjectInstanceType* pdidoi, DWORD dwObj, DWORD dwHow)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == pdidoi) LOG_INVOCATION_AND_RETURN(E_POINTER, kMethodSeverity);
@@ -1910,6 +2202,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::GetProperty(REFGUID rguidProp, LPDIPROPHEADER pdiph)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     DumpPropertyRequest(rguidProp, pdiph, false);
@@ -2092,6 +2386,16 @@ namespace Xidi
         }
 
       default:
+        if (true == IsPollingPolicyProperty(rguidProp))
+        {
+          ((DIPROPXIDIPOLLINGPOLICY*)pdiph)->dwPollingPeriodMilliseconds =
+              Controller::GetEffectivePollingPeriodMilliseconds(controller->GetIdentifier());
+          ((DIPROPXIDIPOLLINGPOLICY*)pdiph)->dwStateChangeEventPeriodMilliseconds =
+              controller->GetStateChangeEventPeriod();
+          LOG_PROPERTY_INVOCATION_DIPROPXIDIPOLLINGPOLICY_AND_RETURN(
+              DI_OK, kMethodSeverity, rguidProp, pdiph);
+        }
+
         LOG_PROPERTY_INVOCATION_NO_VALUE_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity, rguidProp);
     }
   }
@@ -2100,6 +2404,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::Initialize(
           HINSTANCE hinst, DWORD dwVersion, REFGUID rguid)
   {
+    PROFILE_API_CALL();
+
     // Not required for Xidi virtual controllers as they are implemented now.
     // However, this method is needed for creating IDirectInputDevice objects via COM.
 
@@ -2110,13 +2416,17 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputDeviceBase<diVersion>::Poll(
       void)
   {
-    // Not required for Xidi virtual controllers as they are implemented now.
-    // However, some applications explicitly check for return codes like `DI_OK`, which is why a
+    PROFILE_API_CALL();
+
+    // Not required for Xidi virtual controllers unless on-demand polling or cooperative mode is
+    // enabled, in which case the physical controller is read right away on this thread. Either
+    // way, some applications explicitly check for return codes like `DI_OK`, which is why a
     // workaround is allowed to change the return code.
-    static const DWORD kPollReturnCode = static_cast<DWORD>(
-        Globals::GetConfigurationData()[Strings::kStrConfigurationSectionWorkarounds]
-                                       [Strings::kStrConfigurationSettingWorkaroundsPollReturnCode]
-                                           .ValueOr(DI_NOEFFECT));
+    const DWORD kPollReturnCode = Globals::GetSettings().workarounds.pollReturnCode;
+
+    Controller::ServicePhysicalControllerCooperatively(controller->GetIdentifier());
+    if (true == IsOnDemandPollingEnabled())
+      Controller::PollPhysicalControllerOnDemand(controller->GetIdentifier());
 
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::SuperDebug;
     LOG_INVOCATION_AND_RETURN(kPollReturnCode, kMethodSeverity);
@@ -2125,6 +2435,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::RunControlPanel(HWND hwndOwner, DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -2133,6 +2445,8 @@ namespace Xidi
       VirtualDirectInputDeviceBase<diVersion>::SendDeviceData(
           DWORD cbObjectData, LPCDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD fl)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -2140,6 +2454,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::SendForceFeedbackCommand(DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (false == controller->GetCapabilities().ForceFeedbackIsSupported())
@@ -2207,6 +2523,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::SetCooperativeLevel(HWND hwnd, DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     // The only piece of information Xidi needs from the cooperative level is whether shared or
@@ -2222,49 +2540,40 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::SetDataFormat(LPCDIDATAFORMAT lpdf)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == lpdf) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
     // If this operation fails, then the current data format and event filter remain unaltered.
-    std::unique_ptr<DataFormat> newDataFormat =
-        DataFormat::CreateFromApplicationFormatSpec(*lpdf, controller->GetCapabilities());
+    std::shared_ptr<const DataFormat> newDataFormat =
+        DataFormat::GetOrCreateFromApplicationFormatSpec(*lpdf, controller->GetCapabilities());
     if (nullptr == newDataFormat) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
 
     // Use the event filter to prevent the controller from buffering any events that correspond to
     // elements with no offsets.
-    auto lock = controller->Lock();
-    controller->EventFilterAddAllElements();
-
-    for (int i = 0; i < (int)Controller::EAxis::Count; ++i)
-    {
-      const Controller::SElementIdentifier element = {
-          .type = Controller::EElementType::Axis, .axis = (Controller::EAxis)i};
-      if (false == newDataFormat->HasElement(element))
-        controller->EventFilterRemoveElement(element);
-    }
-
-    for (int i = 0; i < (int)Controller::EButton::Count; ++i)
+    // The controller lock is released before the device state lock is acquired because reading
+    // controller state while holding the device state lock can acquire the controller lock.
     {
-      const Controller::SElementIdentifier element = {
-          .type = Controller::EElementType::Button, .button = (Controller::EButton)i};
-      if (false == newDataFormat->HasElement(element))
-        controller->EventFilterRemoveElement(element);
+      auto lock = controller->Lock();
+      controller->EventFilterSetElements(newDataFormat->GetElements());
     }
 
     {
-      const Controller::SElementIdentifier element = {.type = Controller::EElementType::Pov};
-      if (false == newDataFormat->HasElement(element))
-        controller->EventFilterRemoveElement(element);
+      std::scoped_lock deviceStateLock(deviceStateMutex);
+      dataFormat = std::move(newDataFormat);
+      lastDeviceState.buffer = nullptr;
+      lastDeviceState.packet.clear();
     }
-
-    dataFormat = std::move(newDataFormat);
     LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
   }
 
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::SetEventNotification(HANDLE hEvent)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (INVALID_HANDLE_VALUE == hEvent)
@@ -2280,6 +2589,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::SetProperty(REFGUID rguidProp, LPCDIPROPHEADER pdiph)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     DumpPropertyRequest(rguidProp, pdiph, true);
@@ -2452,6 +2763,36 @@ namespace Xidi
         }
 
       default:
+        if (true == IsPollingPolicyProperty(rguidProp))
+        {
+          const DIPROPXIDIPOLLINGPOLICY& pollingPolicy = *((const DIPROPXIDIPOLLINGPOLICY*)pdiph);
+          if (pollingPolicy.dwPollingPeriodMilliseconds > kMaxPollingPeriodRequestMilliseconds)
+            LOG_PROPERTY_INVOCATION_DIPROPXIDIPOLLINGPOLICY_AND_RETURN(
+                DIERR_INVALIDPARAM, kMethodSeverity, rguidProp, pdiph);
+
+          // The new request is registered before the previous one is withdrawn so that polling
+          // never briefly reverts to the configured period while the request is being changed.
+          if (0 != pollingPolicy.dwPollingPeriodMilliseconds)
+            Controller::RequestPollingPeriod(
+                controller->GetIdentifier(), pollingPolicy.dwPollingPeriodMilliseconds);
+
+          const DWORD kPreviousPollingPeriodMilliseconds =
+              requestedPollingPeriodMilliseconds.exchange(
+                  pollingPolicy.dwPollingPeriodMilliseconds);
+          if (0 != kPreviousPollingPeriodMilliseconds)
+            Controller::WithdrawPollingPeriodRequest(
+                controller->GetIdentifier(), kPreviousPollingPeriodMilliseconds);
+
+          controller->SetStateChangeEventPeriod(
+              (DIPROPXIDI_STATECHANGEEVENTPERIOD_DEFAULT ==
+               pollingPolicy.dwStateChangeEventPeriodMilliseconds)
+                  ? std::nullopt
+                  : std::make_optional(pollingPolicy.dwStateChangeEventPeriodMilliseconds));
+
+          LOG_PROPERTY_INVOCATION_DIPROPXIDIPOLLINGPOLICY_AND_RETURN(
+              DI_OK, kMethodSeverity, rguidProp, pdiph);
+        }
+
         LOG_PROPERTY_INVOCATION_NO_VALUE_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity, rguidProp);
     }
   }
@@ -2459,6 +2800,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT
       VirtualDirectInputDeviceBase<diVersion>::Unacquire(void)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     // The only possible state that would need to be undone when unacquiring a device is
@@ -2475,6 +2818,8 @@ namespace Xidi
           LPDIFILEEFFECT rgDiFileEft,
           DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -2486,6 +2831,8 @@ namespace Xidi
       DirectInputTypes<diVersion>::ConstStringType lpszUserName,
       DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -2495,6 +2842,8 @@ namespace Xidi
   HRESULT VirtualDirectInputDeviceVersion8Only<diVersion>::GetImageInfo(
       DirectInputTypes<diVersion>::DeviceImageInfoHeaderType* lpdiDevImageInfoHeader)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -2506,6 +2855,8 @@ namespace Xidi
       DirectInputTypes<diVersion>::ConstStringType lptszUserName,
       DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -12,14 +12,20 @@
 
 #include "VirtualDirectInputEffect.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <Infra/Core/Message.h>
 #include <Infra/Core/TemporaryBuffer.h>
 
+#include "ApiCallProfile.h"
+#include "AsyncLog.h"
+#include "FlightRecorder.h"
 #include "ForceFeedbackDevice.h"
 #include "ForceFeedbackEffect.h"
 #include "ForceFeedbackParameters.h"
@@ -27,19 +33,25 @@
 #include "VirtualDirectInputDevice.h"
 
 /// Logs a DirectInput interface method invocation and returns.
-#define LOG_INVOCATION_AND_RETURN(result, severity)                                                                               \
-  do                                                                                                                              \
-  {                                                                                                                               \
-    const HRESULT hresult = (result);                                                                                             \
-    Infra::Message::OutputFormatted(                                                                                              \
-        severity,                                                                                                                 \
-        L"Invoked %s on force feedback effect with identifier %llu associated with Xidi virtual controller %u, result = 0x%08x.", \
-        __FUNCTIONW__ L"()",                                                                                                      \
-        (unsigned long long)UnderlyingEffect().Identifier(),                                                                      \
-        (1 + associatedDevice.GetVirtualController().GetIdentifier()),                                                            \
-        hresult);                                                                                                                 \
-    return hresult;                                                                                                               \
-  }                                                                                                                               \
+#define LOG_INVOCATION_AND_RETURN(result, severity)                                                                                 \
+  do                                                                                                                                \
+  {                                                                                                                                 \
+    const HRESULT hresult = (result);                                                                                               \
+    if (AsyncLog::WillOutputMessageOfSeverity(severity))                                                                            \
+      AsyncLog::OutputFormatted(                                                                                                    \
+          severity,                                                                                                                 \
+          L"Invoked %s on force feedback effect with identifier %llu associated with Xidi virtual controller %u, result = 0x%08x.", \
+          __FUNCTIONW__ L"()",                                                                                                      \
+          (unsigned long long)UnderlyingEffect().Identifier(),                                                                      \
+          (1 + associatedDevice.GetVirtualController().GetIdentifier()),                                                            \
+          hresult);                                                                                                                 \
+    FlightRecorder::RecordApiCall(                                                                                                  \
+        __FUNCTIONW__,                                                                                                              \
+        associatedDevice.GetVirtualController().GetIdentifier(),                                                                    \
+        (uint32_t)UnderlyingEffect().Identifier(),                                                                                  \
+        (uint32_t)hresult);                                                                                                         \
+    return hresult;                                                                                                                 \
+  }                                                                                                                                 \
   while (false)
 
 namespace Xidi
@@ -207,6 +219,7 @@ namespace Xidi
       const GUID& effectGuid)
       : associatedDevice(associatedDevice),
         effect(effect.Clone()),
+        stagingEffect(effect.Clone()),
         effectGuid(effectGuid),
         refCount(1)
   {
@@ -238,7 +251,7 @@ namespace Xidi
   template <EDirectInputVersion diVersion> void VirtualDirectInputEffect<diVersion>::DumpEffectParameters(
       LPCDIEFFECT peff, DWORD dwFlags) const
   {
-    if (Infra::Message::WillOutputMessageOfSeverity(kDumpSeverity))
+    if (AsyncLog::WillOutputMessageOfSeverity(kDumpSeverity))
     {
       Infra::Message::Output(kDumpSeverity, L"Begin dump of effect parameters.");
 
@@ -438,21 +451,18 @@ namespace Xidi
         return DIERR_INVALIDPARAM;
     }
 
-    // This cloned effect will receive all the parameter updates and will be synced back to the
-    // original effect once all parameter values are accepted. Doing this means that an invalid
-    // value for a parameter means the original effect remains untouched.
-    std::unique_ptr<Controller::ForceFeedback::Effect> updatedEffect;
+    // The staging effect starts out as a copy of the current parameters, receives all the
+    // parameter updates, and is synced back to the original effect once all parameter values are
+    // accepted. Doing this means that an invalid value for a parameter means the original effect
+    // remains untouched.
+    Controller::ForceFeedback::Effect& updatedEffect = *stagingEffect;
+    updatedEffect.SyncParametersFrom(*effect);
 
     if (0 != (dwFlags & DIEP_TYPESPECIFICPARAMS))
     {
       if (nullptr == peff->lpvTypeSpecificParams) return DIERR_INVALIDPARAM;
 
-      updatedEffect = CloneAndSetTypeSpecificParameters(peff);
-      if (nullptr == updatedEffect) return DIERR_INVALIDPARAM;
-    }
-    else
-    {
-      updatedEffect = effect->Clone();
+      if (false == SetTypeSpecificParameters(peff, updatedEffect)) return DIERR_INVALIDPARAM;
     }
 
     switch (peff->dwSize)
@@ -461,7 +471,7 @@ namespace Xidi
         // These parameters are present in the new version of the structure but not in the old.
         if (0 != (dwFlags & DIEP_STARTDELAY))
         {
-          if (false == updatedEffect->SetStartDelay(ConvertTimeFromDirectInput(peff->dwStartDelay)))
+          if (false == updatedEffect.SetStartDelay(ConvertTimeFromDirectInput(peff->dwStartDelay)))
             return DIERR_INVALIDPARAM;
         }
         break;
@@ -521,7 +531,7 @@ namespace Xidi
         newAssociatedAxes.type[i] = element.axis;
       }
 
-      if (false == updatedEffect->SetAssociatedAxes(newAssociatedAxes)) return DIERR_INVALIDPARAM;
+      if (false == updatedEffect.SetAssociatedAxes(newAssociatedAxes)) return DIERR_INVALIDPARAM;
     }
 
     if (0 != (dwFlags & DIEP_DIRECTION))
@@ -543,16 +553,16 @@ namespace Xidi
       {
         case DIEFF_CARTESIAN:
           coordinateSetResult =
-              updatedEffect->Direction().SetDirectionUsingCartesian(coordinates, numCoordinates);
+              updatedEffect.Direction().SetDirectionUsingCartesian(coordinates, numCoordinates);
           break;
 
         case DIEFF_POLAR:
           coordinateSetResult =
-              updatedEffect->Direction().SetDirectionUsingPolar(coordinates, numCoordinates - 1);
+              updatedEffect.Direction().SetDirectionUsingPolar(coordinates, numCoordinates - 1);
           break;
 
         case DIEFF_SPHERICAL:
-          coordinateSetResult = updatedEffect->Direction().SetDirectionUsingSpherical(
+          coordinateSetResult = updatedEffect.Direction().SetDirectionUsingSpherical(
               coordinates, numCoordinates - 1);
           break;
 
@@ -566,7 +576,7 @@ namespace Xidi
 
     if (0 != (dwFlags & DIEP_DURATION))
     {
-      if (false == updatedEffect->SetDuration(ConvertTimeFromDirectInput(peff->dwDuration)))
+      if (false == updatedEffect.SetDuration(ConvertTimeFromDirectInput(peff->dwDuration)))
         return DIERR_INVALIDPARAM;
     }
 
@@ -574,7 +584,7 @@ namespace Xidi
     {
       if (nullptr == peff->lpEnvelope)
       {
-        updatedEffect->ClearEnvelope();
+        updatedEffect.ClearEnvelope();
       }
       else
       {
@@ -586,24 +596,24 @@ namespace Xidi
             .fadeTime = ConvertTimeFromDirectInput(peff->lpEnvelope->dwFadeTime),
             .fadeLevel = (Controller::ForceFeedback::TEffectValue)peff->lpEnvelope->dwFadeLevel};
 
-        if (false == updatedEffect->SetEnvelope(newEnvelope)) return DIERR_INVALIDPARAM;
+        if (false == updatedEffect.SetEnvelope(newEnvelope)) return DIERR_INVALIDPARAM;
       }
     }
 
     if (0 != (dwFlags & DIEP_GAIN))
     {
-      if (false == updatedEffect->SetGain((Controller::ForceFeedback::TEffectValue)peff->dwGain))
+      if (false == updatedEffect.SetGain((Controller::ForceFeedback::TEffectValue)peff->dwGain))
         return DIERR_INVALIDPARAM;
     }
 
     if (0 != (dwFlags & DIEP_SAMPLEPERIOD))
     {
-      if (false == updatedEffect->SetSamplePeriod(ConvertTimeFromDirectInput(peff->dwSamplePeriod)))
+      if (false == updatedEffect.SetSamplePeriod(ConvertTimeFromDirectInput(peff->dwSamplePeriod)))
         return DIERR_INVALIDPARAM;
     }
 
     // Final sync operation is expected to succeed.
-    if (false == effect->SyncParametersFrom(*updatedEffect))
+    if (false == effect->SyncParametersFrom(updatedEffect))
     {
       Infra::Message::OutputFormatted(
           Infra::Message::ESeverity::Error,
@@ -612,10 +622,6 @@ namespace Xidi
       return DIERR_GENERIC;
     }
 
-    // Destroying this object now means that any future references to it will trigger crashes during
-    // testing.
-    updatedEffect = nullptr;
-
     // At this point parameter updates were successful. What happens next depends on the flag
     // values. The effect could either be downloaded, downloaded and (re)started, or none of these.
     if (0 != (dwFlags & DIEP_NODOWNLOAD))
@@ -805,9 +811,183 @@ namespace Xidi
     }
   }
 
+  template <EDirectInputVersion diVersion> void
+      CustomForceDirectInputEffect<diVersion>::DumpTypeSpecificParameters(LPCDIEFFECT peff) const
+  {
+    if (sizeof(DICUSTOMFORCE) == peff->cbTypeSpecificParams)
+    {
+      const DICUSTOMFORCE* const typeSpecificParams =
+          (const DICUSTOMFORCE*)peff->lpvTypeSpecificParams;
+      Infra::Message::OutputFormatted(
+          kDumpSeverity,
+          L"    cbTypeSpecificParams = %u (sizeof(DICUSTOMFORCE))",
+          peff->cbTypeSpecificParams);
+      Infra::Message::OutputFormatted(
+          kDumpSeverity,
+          L"    lpvTypeSpecificParams->cChannels = %u",
+          typeSpecificParams->cChannels);
+      Infra::Message::OutputFormatted(
+          kDumpSeverity,
+          L"    lpvTypeSpecificParams->dwSamplePeriod = %u",
+          typeSpecificParams->dwSamplePeriod);
+      Infra::Message::OutputFormatted(
+          kDumpSeverity,
+          L"    lpvTypeSpecificParams->cSamples = %u",
+          typeSpecificParams->cSamples);
+      Infra::Message::OutputFormatted(
+          kDumpSeverity,
+          L"    lpvTypeSpecificParams->rglForceData = (%s)",
+          ((nullptr == typeSpecificParams->rglForceData) ? L"nullptr" : L"present"));
+    }
+    else
+    {
+      VirtualDirectInputEffect<diVersion>::DumpTypeSpecificParameters(peff);
+    }
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT
+      CustomForceDirectInputEffect<diVersion>::GetTypeSpecificParameters(LPDIEFFECT peff)
+  {
+    if (peff->cbTypeSpecificParams < sizeof(DICUSTOMFORCE))
+    {
+      peff->cbTypeSpecificParams = sizeof(DICUSTOMFORCE);
+      return DIERR_MOREDATA;
+    }
+
+    if (nullptr == peff->lpvTypeSpecificParams) return DIERR_INVALIDPARAM;
+
+    if (false == TypedUnderlyingEffect().HasTypeSpecificParameters()) return DIERR_INVALIDPARAM;
+
+    const Controller::ForceFeedback::SCustomForceParameters& customForceParameters =
+        TypedUnderlyingEffect().GetTypeSpecificParameters().value();
+    const std::vector<Controller::ForceFeedback::TEffectValue>& samples =
+        *customForceParameters.samples;
+
+    // The application supplies the buffer that receives the samples. If it is too small then the
+    // number of samples is reported so that the application can try again with a larger buffer.
+    DICUSTOMFORCE& diCustomForce = *((DICUSTOMFORCE*)peff->lpvTypeSpecificParams);
+    const bool sampleBufferIsSufficient =
+        ((nullptr != diCustomForce.rglForceData) && (diCustomForce.cSamples >= samples.size()));
+
+    peff->cbTypeSpecificParams = sizeof(DICUSTOMFORCE);
+    diCustomForce.cChannels = 1;
+    diCustomForce.dwSamplePeriod =
+        VirtualDirectInputEffect<diVersion>::ConvertTimeToDirectInput(
+            customForceParameters.samplePeriod);
+    diCustomForce.cSamples = (DWORD)samples.size();
+
+    if (false == sampleBufferIsSufficient) return DIERR_MOREDATA;
+
+    for (size_t i = 0; i < samples.size(); ++i)
+      diCustomForce.rglForceData[i] = (LONG)samples[i];
+
+    return DI_OK;
+  }
+
+  template <EDirectInputVersion diVersion> bool
+      CustomForceDirectInputEffect<diVersion>::SetTypeSpecificParameters(
+          LPCDIEFFECT peff, Controller::ForceFeedback::Effect& targetEffect)
+  {
+    if (peff->cbTypeSpecificParams < sizeof(DICUSTOMFORCE)) return false;
+
+    if (nullptr == peff->lpvTypeSpecificParams) return false;
+
+    const DICUSTOMFORCE& diCustomForce = *((const DICUSTOMFORCE*)peff->lpvTypeSpecificParams);
+
+    // Samples for multiple channels are interleaved, one channel per axis. Only a single channel,
+    // played along the direction of the effect, is supported.
+    if (1 != diCustomForce.cChannels) return false;
+
+    if ((0 == diCustomForce.cSamples) || (nullptr == diCustomForce.rglForceData)) return false;
+
+    Controller::ForceFeedback::CustomForceEffect& targetCustomForceEffect =
+        static_cast<Controller::ForceFeedback::CustomForceEffect&>(targetEffect);
+
+    Controller::ForceFeedback::SCustomForceParameters customForceParameters = {
+        .samples = nullptr,
+        .samplePeriod = VirtualDirectInputEffect<diVersion>::ConvertTimeFromDirectInput(
+            diCustomForce.dwSamplePeriod)};
+
+    // Applications often set parameters repeatedly without changing the samples, in which case the
+    // buffer already held by the effect is reused instead of being replaced by an identical copy.
+    if (true == targetCustomForceEffect.HasTypeSpecificParameters())
+    {
+      const std::shared_ptr<const std::vector<Controller::ForceFeedback::TEffectValue>>&
+          existingSamples = targetCustomForceEffect.GetTypeSpecificParameters()->samples;
+
+      if ((nullptr != existingSamples) && (existingSamples->size() == diCustomForce.cSamples) &&
+          (true ==
+           std::equal(
+               existingSamples->cbegin(),
+               existingSamples->cend(),
+               diCustomForce.rglForceData,
+               [](Controller::ForceFeedback::TEffectValue existingSample, LONG diSample) -> bool
+               {
+                 return (existingSample == (Controller::ForceFeedback::TEffectValue)diSample);
+               })))
+        customForceParameters.samples = existingSamples;
+    }
+
+    if (nullptr == customForceParameters.samples)
+    {
+      std::vector<Controller::ForceFeedback::TEffectValue> samples;
+      samples.reserve(diCustomForce.cSamples);
+      for (DWORD i = 0; i < diCustomForce.cSamples; ++i)
+        samples.push_back((Controller::ForceFeedback::TEffectValue)diCustomForce.rglForceData[i]);
+
+      customForceParameters.samples =
+          std::make_shared<const std::vector<Controller::ForceFeedback::TEffectValue>>(
+              std::move(samples));
+    }
+
+    return targetCustomForceEffect.SetTypeSpecificParameters(customForceParameters);
+  }
+
+  template <EDirectInputVersion diVersion> void
+      ConditionDirectInputEffect<diVersion>::DumpTypeSpecificParameters(LPCDIEFFECT peff) const
+  {
+    if ((0 != peff->cbTypeSpecificParams) &&
+        (0 == (peff->cbTypeSpecificParams % sizeof(DICONDITION))))
+    {
+      const DICONDITION* const typeSpecificParams = (const DICONDITION*)peff->lpvTypeSpecificParams;
+      const DWORD count = peff->cbTypeSpecificParams / sizeof(DICONDITION);
+      Infra::Message::OutputFormatted(
+          kDumpSeverity,
+          L"    cbTypeSpecificParams = %u (%u * sizeof(DICONDITION))",
+          peff->cbTypeSpecificParams,
+          count);
+
+      if (nullptr == typeSpecificParams)
+      {
+        Infra::Message::Output(kDumpSeverity, L"    lpvTypeSpecificParams = (nullptr)");
+        return;
+      }
+
+      for (DWORD i = 0; i < count; ++i)
+      {
+        Infra::Message::OutputFormatted(
+            kDumpSeverity,
+            L"    lpvTypeSpecificParams[%u] = { lOffset = %ld, lPositiveCoefficient = %ld, lNegativeCoefficient = %ld, dwPositiveSaturation = %u, dwNegativeSaturation = %u, lDeadBand = %ld }",
+            i,
+            typeSpecificParams[i].lOffset,
+            typeSpecificParams[i].lPositiveCoefficient,
+            typeSpecificParams[i].lNegativeCoefficient,
+            typeSpecificParams[i].dwPositiveSaturation,
+            typeSpecificParams[i].dwNegativeSaturation,
+            typeSpecificParams[i].lDeadBand);
+      }
+    }
+    else
+    {
+      VirtualDirectInputEffect<diVersion>::DumpTypeSpecificParameters(peff);
+    }
+  }
+
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::QueryInterface(
       REFIID riid, LPVOID* ppvObj)
   {
+    PROFILE_API_CALL();
+
     if (nullptr == ppvObj) return E_POINTER;
 
     bool validInterfaceRequested = false;
@@ -827,11 +1007,15 @@ namespace Xidi
 
   template <EDirectInputVersion diVersion> ULONG VirtualDirectInputEffect<diVersion>::AddRef(void)
   {
+    PROFILE_API_CALL();
+
     return ++refCount;
   }
 
   template <EDirectInputVersion diVersion> ULONG VirtualDirectInputEffect<diVersion>::Release(void)
   {
+    PROFILE_API_CALL();
+
     const unsigned long numRemainingRefs = --refCount;
 
     if (0 == numRemainingRefs) delete this;
@@ -842,6 +1026,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::Initialize(
       HINSTANCE hinst, DWORD dwVersion, REFGUID rguid)
   {
+    PROFILE_API_CALL();
+
     // Not required for Xidi virtual force feedback effects as they are implemented now.
     // However, this method is needed for creating IDirectInputDevice objects via COM.
 
@@ -852,6 +1038,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::GetEffectGuid(
       LPGUID pguid)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == pguid) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
@@ -863,6 +1051,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::GetParameters(
       LPDIEFFECT peff, DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == peff) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
@@ -1086,6 +1276,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::SetParameters(
       LPCDIEFFECT peff, DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(SetParametersInternal(peff, dwFlags), kMethodSeverity);
   }
@@ -1093,12 +1285,16 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::Start(
       DWORD dwIterations, DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(StartInternal(dwIterations, dwFlags), kMethodSeverity);
   }
 
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::Stop(void)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     Controller::ForceFeedback::Device* const forceFeedbackDevice =
@@ -1113,6 +1309,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::GetEffectStatus(
       LPDWORD pdwFlags)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     if (nullptr == pdwFlags) LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverity);
@@ -1123,20 +1321,25 @@ namespace Xidi
         associatedDevice.GetVirtualController().ForceFeedbackGetDevice();
     if (nullptr == forceFeedbackDevice) LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
 
-    if (true == forceFeedbackDevice->IsEffectPlaying(effect->Identifier()))
-      *pdwFlags |= DIEGES_PLAYING;
+    // The playing state published by the force feedback device is queried directly so that
+    // applications that poll effect status frequently do not contend with effect playback.
+    if (true == effect->IsPlaying()) *pdwFlags |= DIEGES_PLAYING;
 
     LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
   }
 
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::Download(void)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DownloadInternal(), kMethodSeverity);
   }
 
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::Unload(void)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
 
     Controller::ForceFeedback::Device* const forceFeedbackDevice =
@@ -1151,6 +1354,8 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT VirtualDirectInputEffect<diVersion>::Escape(
       LPDIEFFESCAPE pesc)
   {
+    PROFILE_API_CALL();
+
     constexpr Infra::Message::ESeverity kMethodSeverity = Infra::Message::ESeverity::Info;
     LOG_INVOCATION_AND_RETURN(DIERR_UNSUPPORTED, kMethodSeverity);
   }
@@ -1171,4 +1376,12 @@ namespace Xidi
   template class RampForceDirectInputEffect<EDirectInputVersion::k8W>;
   template class RampForceDirectInputEffect<EDirectInputVersion::kLegacyA>;
   template class RampForceDirectInputEffect<EDirectInputVersion::kLegacyW>;
+  template class CustomForceDirectInputEffect<EDirectInputVersion::k8A>;
+  template class CustomForceDirectInputEffect<EDirectInputVersion::k8W>;
+  template class CustomForceDirectInputEffect<EDirectInputVersion::kLegacyA>;
+  template class CustomForceDirectInputEffect<EDirectInputVersion::kLegacyW>;
+  template class ConditionDirectInputEffect<EDirectInputVersion::k8A>;
+  template class ConditionDirectInputEffect<EDirectInputVersion::k8W>;
+  template class ConditionDirectInputEffect<EDirectInputVersion::kLegacyA>;
+  template class ConditionDirectInputEffect<EDirectInputVersion::kLegacyW>;
 } // namespace Xidi
@@ -0,0 +1,298 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file WorkerThread.cpp
+ *   Implementation of functionality for creating named background threads with priorities, and
+ *   optionally processor core types, that reflect how sensitive they are to scheduling latency.
+ **************************************************************************************************/
+
+#include "WorkerThread.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "Globals.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace WorkerThread
+  {
+    /// Enumerates the types of processor cores on which a thread can be configured to run.
+    enum class ECoreType
+    {
+      /// No preference. The system decides.
+      Any,
+
+      /// Highest-performance cores, without power throttling.
+      Performance,
+
+      /// Most power-efficient cores, with power throttling.
+      Efficiency
+    };
+
+    /// Thread configuration APIs that are imported dynamically because they are not available on
+    /// all supported versions of Windows. Any of them may be `nullptr`.
+    struct SImportedFunctions
+    {
+      /// Assigns a name to a thread. Available starting in Windows 10 version 1607.
+      decltype(&SetThreadDescription) setThreadDescription;
+
+      /// Sets the power throttling state of a thread. Available starting in Windows 8.
+      decltype(&SetThreadInformation) setThreadInformation;
+
+      /// Restricts a thread to a set of logical processors. Available starting in Windows 10.
+      decltype(&SetThreadSelectedCpuSets) setThreadSelectedCpuSets;
+
+      /// Enumerates the logical processors available to a process. Available starting in
+      /// Windows 10.
+      decltype(&GetSystemCpuSetInformation) getSystemCpuSetInformation;
+    };
+
+    /// Retrieves the dynamically-imported thread configuration APIs, importing them on first
+    /// invocation.
+    /// @return Read-only reference to the imported API addresses.
+    static const SImportedFunctions& GetImportedFunctions(void)
+    {
+      static const SImportedFunctions importedFunctions = []() -> SImportedFunctions
+      {
+        const HMODULE kernel32Library = GetModuleHandleW(L"kernel32.dll");
+        if (nullptr == kernel32Library) return {};
+
+        return {
+            .setThreadDescription = reinterpret_cast<decltype(&SetThreadDescription)>(
+                GetProcAddress(kernel32Library, "SetThreadDescription")),
+            .setThreadInformation = reinterpret_cast<decltype(&SetThreadInformation)>(
+                GetProcAddress(kernel32Library, "SetThreadInformation")),
+            .setThreadSelectedCpuSets = reinterpret_cast<decltype(&SetThreadSelectedCpuSets)>(
+                GetProcAddress(kernel32Library, "SetThreadSelectedCpuSets")),
+            .getSystemCpuSetInformation = reinterpret_cast<decltype(&GetSystemCpuSetInformation)>(
+                GetProcAddress(kernel32Library, "GetSystemCpuSetInformation"))};
+      }();
+
+      return importedFunctions;
+    }
+
+    /// Reads from the configuration file the type of processor core selected by the specified
+    /// setting.
+    /// @param [in] settingName Name of the configuration setting to read.
+    /// @return Configured core type, or no preference if the setting is absent.
+    static ECoreType ReadConfiguredCoreType(std::wstring_view settingName)
+    {
+      const auto& configData = Globals::GetConfigurationData();
+      if (false == configData.Contains(Strings::kStrConfigurationSectionProperties))
+        return ECoreType::Any;
+
+      const auto& propertiesConfigData = configData[Strings::kStrConfigurationSectionProperties];
+      if (false == propertiesConfigData.Contains(settingName)) return ECoreType::Any;
+
+      const std::wstring_view configuredValue = propertiesConfigData[settingName]->GetString();
+      if (Strings::kStrConfigurationValueThreadCoresPerformance == configuredValue)
+        return ECoreType::Performance;
+      if (Strings::kStrConfigurationValueThreadCoresEfficiency == configuredValue)
+        return ECoreType::Efficiency;
+
+      return ECoreType::Any;
+    }
+
+    /// Determines the type of processor core on which threads in the specified priority class
+    /// should run. Configuration is read once per priority class.
+    /// @param [in] priority Scheduling priority class.
+    /// @return Core type for the priority class.
+    static ECoreType CoreTypeForPriority(EPriority priority)
+    {
+      switch (priority)
+      {
+        case EPriority::Housekeeping:
+        {
+          static const ECoreType kHousekeepingCoreType = ReadConfiguredCoreType(
+              Strings::kStrConfigurationSettingsPropertiesHousekeepingThreadCores);
+          return kHousekeepingCoreType;
+        }
+
+        case EPriority::LatencyCritical:
+        {
+          static const ECoreType kLatencyCriticalCoreType = ReadConfiguredCoreType(
+              Strings::kStrConfigurationSettingsPropertiesLatencyCriticalThreadCores);
+          return kLatencyCriticalCoreType;
+        }
+
+        default:
+          return ECoreType::Any;
+      }
+    }
+
+    /// Identifies all of the CPU sets available to this process, grouped by core type. Both
+    /// groups are empty if the processor does not have more than one type of core.
+    struct SCpuSetsByCoreType
+    {
+      /// CPU set identifiers of the cores with the highest efficiency class.
+      std::vector<ULONG> performance;
+
+      /// CPU set identifiers of the cores with the lowest efficiency class.
+      std::vector<ULONG> efficiency;
+    };
+
+    /// Queries the system for the CPU sets available to this process and groups them by core
+    /// type. The query is performed once and the result is cached.
+    /// @return Read-only reference to the grouped CPU set identifiers.
+    static const SCpuSetsByCoreType& GetCpuSetsByCoreType(void)
+    {
+      static const SCpuSetsByCoreType cpuSetsByCoreType = []() -> SCpuSetsByCoreType
+      {
+        const auto getSystemCpuSetInformation = GetImportedFunctions().getSystemCpuSetInformation;
+        if (nullptr == getSystemCpuSetInformation) return {};
+
+        ULONG bufferSize = 0;
+        getSystemCpuSetInformation(nullptr, 0, &bufferSize, GetCurrentProcess(), 0);
+        if (0 == bufferSize) return {};
+
+        std::unique_ptr<uint8_t[]> buffer = std::make_unique<uint8_t[]>(bufferSize);
+        if (FALSE ==
+            getSystemCpuSetInformation(
+                reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.get()),
+                bufferSize,
+                &bufferSize,
+                GetCurrentProcess(),
+                0))
+          return {};
+
+        std::vector<const SYSTEM_CPU_SET_INFORMATION*> cpuSets;
+        for (ULONG offset = 0; offset < bufferSize;)
+        {
+          const auto cpuSet =
+              reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION*>(&buffer[offset]);
+          if (CpuSetInformation == cpuSet->Type) cpuSets.push_back(cpuSet);
+          offset += cpuSet->Size;
+        }
+        if (true == cpuSets.empty()) return {};
+
+        const auto [minEfficiencyClass, maxEfficiencyClass] = std::minmax_element(
+            cpuSets.cbegin(),
+            cpuSets.cend(),
+            [](const SYSTEM_CPU_SET_INFORMATION* a, const SYSTEM_CPU_SET_INFORMATION* b) -> bool
+            {
+              return a->CpuSet.EfficiencyClass < b->CpuSet.EfficiencyClass;
+            });
+
+        const BYTE lowestEfficiencyClass = (*minEfficiencyClass)->CpuSet.EfficiencyClass;
+        const BYTE highestEfficiencyClass = (*maxEfficiencyClass)->CpuSet.EfficiencyClass;
+        if (lowestEfficiencyClass == highestEfficiencyClass) return {};
+
+        SCpuSetsByCoreType result;
+        for (const auto cpuSet : cpuSets)
+        {
+          if (highestEfficiencyClass == cpuSet->CpuSet.EfficiencyClass)
+            result.performance.push_back(cpuSet->CpuSet.Id);
+          else if (lowestEfficiencyClass == cpuSet->CpuSet.EfficiencyClass)
+            result.efficiency.push_back(cpuSet->CpuSet.Id);
+        }
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Info,
+            L"Detected a processor with %u performance and %u efficiency logical processors available for background threads.",
+            (unsigned int)result.performance.size(),
+            (unsigned int)result.efficiency.size());
+
+        return result;
+      }();
+
+      return cpuSetsByCoreType;
+    }
+
+    /// Restricts the calling thread to the specified type of processor core and sets its power
+    /// throttling state accordingly. Does nothing if there is no preference.
+    /// @param [in] coreType Type of processor core on which the calling thread should run.
+    static void ApplyCoreType(ECoreType coreType)
+    {
+      if (ECoreType::Any == coreType) return;
+
+      const SImportedFunctions& importedFunctions = GetImportedFunctions();
+
+      if (nullptr != importedFunctions.setThreadSelectedCpuSets)
+      {
+        const std::vector<ULONG>& cpuSets =
+            ((ECoreType::Performance == coreType) ? GetCpuSetsByCoreType().performance
+                                                  : GetCpuSetsByCoreType().efficiency);
+        if (false == cpuSets.empty())
+          importedFunctions.setThreadSelectedCpuSets(
+              GetCurrentThread(), cpuSets.data(), (ULONG)cpuSets.size());
+      }
+
+      if (nullptr != importedFunctions.setThreadInformation)
+      {
+        // Explicitly controlling execution speed throttling either opts the thread into EcoQoS
+        // or guarantees that it is never throttled, regardless of what the system would prefer.
+        THREAD_POWER_THROTTLING_STATE powerThrottlingState = {
+            .Version = THREAD_POWER_THROTTLING_CURRENT_VERSION,
+            .ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED,
+            .StateMask =
+                ((ECoreType::Efficiency == coreType) ? THREAD_POWER_THROTTLING_EXECUTION_SPEED
+                                                     : 0u)};
+        importedFunctions.setThreadInformation(
+            GetCurrentThread(),
+            ThreadPowerThrottling,
+            &powerThrottlingState,
+            sizeof(powerThrottlingState));
+      }
+    }
+
+    /// Determines the Windows thread priority value that corresponds to a priority class.
+    /// @param [in] priority Scheduling priority class.
+    /// @return Windows thread priority value.
+    static int ThreadPriorityValue(EPriority priority)
+    {
+      switch (priority)
+      {
+        case EPriority::Housekeeping:
+          return THREAD_PRIORITY_BELOW_NORMAL;
+        case EPriority::LatencyCritical:
+          return THREAD_PRIORITY_ABOVE_NORMAL;
+        default:
+          return THREAD_PRIORITY_NORMAL;
+      }
+    }
+
+    void ConfigureCurrentThread(std::wstring_view name, EPriority priority)
+    {
+      const auto setThreadDescription = GetImportedFunctions().setThreadDescription;
+      if (nullptr != setThreadDescription)
+      {
+        // Thread descriptions must be null-terminated, which views are not guaranteed to be.
+        const std::wstring nullTerminatedName(name);
+        setThreadDescription(GetCurrentThread(), nullTerminatedName.c_str());
+      }
+
+      if (EPriority::Normal != priority)
+        SetThreadPriority(GetCurrentThread(), ThreadPriorityValue(priority));
+
+      ApplyCoreType(CoreTypeForPriority(priority));
+    }
+
+    bool CreateDetachedWithReducedStack(LPTHREAD_START_ROUTINE threadProc, LPVOID threadParam)
+    {
+      const HANDLE threadHandle = CreateThread(
+          nullptr,
+          kDetachedThreadStackReservationBytes,
+          threadProc,
+          threadParam,
+          STACK_SIZE_PARAM_IS_A_RESERVATION,
+          nullptr);
+      if (nullptr == threadHandle) return false;
+
+      CloseHandle(threadHandle);
+      return true;
+    }
+  } // namespace WorkerThread
+} // namespace Xidi
@@ -12,21 +12,33 @@
 
 #include "WrapperIDirectInput.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <unordered_set>
 
 #include <Infra/Core/Message.h>
 #include <Infra/Core/TemporaryBuffer.h>
 
+#include "ApiCallProfile.h"
 #include "ApiDirectInput.h"
 #include "ApiGUID.h"
+#include "ApiWindows.h"
+#include "AsyncLog.h"
 #include "ControllerIdentification.h"
+#include "Globals.h"
+#include "Keyboard.h"
 #include "Mapper.h"
+#include "Settings.h"
 #include "Strings.h"
 #include "VirtualController.h"
 #include "VirtualDirectInputDevice.h"
+#include "WrapperIDirectInputDeviceKeyboard.h"
+#include "XInputDeviceInterfaces.h"
 
 namespace Xidi
 {
@@ -49,40 +61,297 @@ namespace Xidi
     std::unordered_set<GUID> seenInstanceIdentifiers;
   };
 
+  /// Number of device interface arrival and removal notifications received from the system.
+  /// Cached device enumeration results are only valid for as long as this value does not change.
+  static std::atomic<uint64_t> deviceChangeCount = 0;
+
+  /// Receives device notifications from the system and records that the set of devices changed.
+  /// Invoked by the Configuration Manager on a thread pool thread.
+  /// @param [in] action Type of device notification being delivered.
+  /// @return Always `ERROR_SUCCESS`, as required by the Configuration Manager.
+  static DWORD CALLBACK DeviceChangeNotificationCallback(
+      HCMNOTIFICATION, PVOID, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA, DWORD)
+  {
+    if ((CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL == action) ||
+        (CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL == action))
+      deviceChangeCount += 1;
+
+    return ERROR_SUCCESS;
+  }
+
+  /// Attempts to register for device interface arrival and removal notifications from the system.
+  /// The Configuration Manager notification API is imported dynamically because it is not
+  /// available on all supported versions of Windows. Registration lasts for the lifetime of the
+  /// process.
+  /// @return `true` if registration succeeded, `false` otherwise.
+  static bool RegisterForDeviceChangeNotifications(void)
+  {
+    using TCMRegisterNotification = decltype(&CM_Register_Notification);
+
+    HMODULE cfgmgrLibrary = LoadLibraryEx(
+        Strings::kStrLibraryNameCfgMgr32.data(), nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+    if (nullptr == cfgmgrLibrary) return false;
+
+    TCMRegisterNotification cmRegisterNotification = reinterpret_cast<TCMRegisterNotification>(
+        GetProcAddress(cfgmgrLibrary, "CM_Register_Notification"));
+    if (nullptr == cmRegisterNotification) return false;
+
+    CM_NOTIFY_FILTER notifyFilter = {
+        .cbSize = sizeof(CM_NOTIFY_FILTER),
+        .Flags = CM_NOTIFY_FILTER_FLAG_ALL_INTERFACE_CLASSES,
+        .FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE};
+
+    HCMNOTIFICATION notificationHandle = nullptr;
+    return (
+        CR_SUCCESS ==
+        cmRegisterNotification(
+            &notifyFilter, nullptr, &DeviceChangeNotificationCallback, &notificationHandle));
+  }
+
+  /// Determines if device change notifications are being received from the system, registering
+  /// for them the first time this function is invoked. Device enumeration results can only be
+  /// cached if this is the case, since otherwise there is no way to know when they become stale.
+  /// @return `true` if device change notifications are available, `false` otherwise.
+  static bool AreDeviceChangeNotificationsAvailable(void)
+  {
+    static const bool kDeviceChangeNotificationsAvailable = []() -> bool
+    {
+      const bool registered = RegisterForDeviceChangeNotifications();
+      if (false == registered)
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Warning,
+            L"Failed to register for device change notifications. DirectInput device enumeration results will not be cached.");
+
+      return registered;
+    }();
+
+    return kDeviceChangeNotificationsAvailable;
+  }
+
+  /// Appends the enumerated device to the device instance list supplied as the callback argument.
+  /// Used to record the results of a device enumeration requested of the system.
+  template <EDirectInputVersion diVersion> static BOOL __stdcall CallbackEnumDevicesRecord(
+      const DirectInputTypes<diVersion>::DeviceInstanceType* lpddi, LPVOID pvRef)
+  {
+    ((std::vector<typename DirectInputTypes<diVersion>::DeviceInstanceType>*)pvRef)
+        ->push_back(*lpddi);
+    return DIENUM_CONTINUE;
+  }
+
   template <EDirectInputVersion diVersion> WrapperIDirectInputBase<diVersion>::
       WrapperIDirectInputBase(DirectInputTypes<diVersion>::IDirectInputType* underlyingDIObject)
-      : underlyingDIObject(underlyingDIObject)
+      : refCount(1),
+        underlyingDIObject(underlyingDIObject),
+        underlyingDIObjectCreateParams(),
+        underlyingDIObjectCreateResult(DI_OK),
+        underlyingDIObjectMutex(),
+        cachedDevices(),
+        cachedDeviceSupportsXInput(),
+        cachedDeviceChangeCount(deviceChangeCount),
+        cachedDevicesMutex()
   {}
 
+  template <EDirectInputVersion diVersion> WrapperIDirectInputBase<diVersion>::
+      WrapperIDirectInputBase(const SUnderlyingDIObjectCreateParams& underlyingDIObjectCreateParams)
+      : refCount(1),
+        underlyingDIObject(nullptr),
+        underlyingDIObjectCreateParams(underlyingDIObjectCreateParams),
+        underlyingDIObjectCreateResult(DI_OK),
+        underlyingDIObjectMutex(),
+        cachedDevices(),
+        cachedDeviceSupportsXInput(),
+        cachedDeviceChangeCount(deviceChangeCount),
+        cachedDevicesMutex()
+  {}
+
+  template <EDirectInputVersion diVersion> DirectInputTypes<diVersion>::IDirectInputType*
+      WrapperIDirectInputBase<diVersion>::UnderlyingDIObject(void)
+  {
+    typename DirectInputTypes<diVersion>::IDirectInputType* existingDIObject = underlyingDIObject;
+    if (nullptr != existingDIObject) return existingDIObject;
+
+    std::scoped_lock lock(underlyingDIObjectMutex);
+
+    existingDIObject = underlyingDIObject;
+    if ((nullptr != existingDIObject) || (false == underlyingDIObjectCreateParams.has_value()))
+      return existingDIObject;
+
+    const SUnderlyingDIObjectCreateParams createParams = underlyingDIObjectCreateParams.value();
+    underlyingDIObjectCreateParams.reset();
+
+    Infra::Message::Output(
+        Infra::Message::ESeverity::Debug,
+        L"Creating the system DirectInput interface object because the application made a request that requires it.");
+
+    void* createdDIObject = nullptr;
+    underlyingDIObjectCreateResult = createParams.createFunc(
+        createParams.hinst,
+        createParams.dwVersion,
+        createParams.riidltf,
+        &createdDIObject,
+        createParams.punkOuter);
+    if (DI_OK != underlyingDIObjectCreateResult) return nullptr;
+
+    existingDIObject =
+        reinterpret_cast<typename DirectInputTypes<diVersion>::IDirectInputType*>(createdDIObject);
+    underlyingDIObject = existingDIObject;
+    return existingDIObject;
+  }
+
+  template <EDirectInputVersion diVersion> void
+      WrapperIDirectInputBase<diVersion>::DiscardCachedDevicesIfChanged(void)
+  {
+    const uint64_t currentDeviceChangeCount = deviceChangeCount;
+    if (currentDeviceChangeCount == cachedDeviceChangeCount) return;
+
+    cachedDevices.clear();
+    cachedDeviceSupportsXInput.clear();
+    cachedDeviceChangeCount = currentDeviceChangeCount;
+  }
+
+  template <EDirectInputVersion diVersion> bool
+      WrapperIDirectInputBase<diVersion>::DoesSystemDeviceSupportXInput(
+          REFGUID instanceGUID, REFGUID productGUID)
+  {
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        UnderlyingDIObject();
+    if (nullptr == systemDIObject) return false;
+
+    if (false == AreDeviceChangeNotificationsAvailable())
+      return DoesDirectInputControllerSupportXInput<diVersion>(systemDIObject, instanceGUID);
+
+    uint64_t lookupDeviceChangeCount = 0;
+
+    {
+      std::scoped_lock lock(cachedDevicesMutex);
+      DiscardCachedDevicesIfChanged();
+
+      const auto cachedResult = cachedDeviceSupportsXInput.find(instanceGUID);
+      if (cachedDeviceSupportsXInput.end() != cachedResult) return cachedResult->second;
+
+      lookupDeviceChangeCount = cachedDeviceChangeCount;
+    }
+
+    // Checking the system's list of device interfaces is much faster than creating a device
+    // object to query for its path, so creating a device object is only a fallback.
+    const std::optional<bool> maybeDeviceSupportsXInput =
+        XInputDeviceInterfaces::DoesProductSupportXInput(productGUID, lookupDeviceChangeCount);
+    const bool deviceSupportsXInput =
+        (maybeDeviceSupportsXInput.has_value()
+             ? maybeDeviceSupportsXInput.value()
+             : DoesDirectInputControllerSupportXInput<diVersion>(systemDIObject, instanceGUID));
+
+    std::scoped_lock lock(cachedDevicesMutex);
+    DiscardCachedDevicesIfChanged();
+    if (lookupDeviceChangeCount == cachedDeviceChangeCount)
+      cachedDeviceSupportsXInput.insert({instanceGUID, deviceSupportsXInput});
+
+    return deviceSupportsXInput;
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT WrapperIDirectInputBase<diVersion>::
+      EnumSystemDevices(
+          DWORD dwDevType,
+          DirectInputTypes<diVersion>::EnumDevicesCallbackType lpCallback,
+          LPVOID pvRef,
+          DWORD dwFlags)
+  {
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        UnderlyingDIObject();
+    if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
+    if (false == AreDeviceChangeNotificationsAvailable())
+      return systemDIObject->EnumDevices(dwDevType, lpCallback, pvRef, dwFlags);
+
+    const std::pair<DWORD, DWORD> cacheKey = {dwDevType, dwFlags};
+    std::shared_ptr<const TDeviceInstanceList> devices;
+    uint64_t lookupDeviceChangeCount = 0;
+
+    {
+      std::scoped_lock lock(cachedDevicesMutex);
+      DiscardCachedDevicesIfChanged();
+
+      const auto cachedResult = cachedDevices.find(cacheKey);
+      if (cachedDevices.end() != cachedResult) devices = cachedResult->second;
+
+      lookupDeviceChangeCount = cachedDeviceChangeCount;
+    }
+
+    if (nullptr == devices)
+    {
+      std::shared_ptr<TDeviceInstanceList> enumeratedDevices =
+          std::make_shared<TDeviceInstanceList>();
+      const HRESULT enumResult = systemDIObject->EnumDevices(
+          dwDevType,
+          &CallbackEnumDevicesRecord<diVersion>,
+          (LPVOID)enumeratedDevices.get(),
+          dwFlags);
+      if (DI_OK != enumResult) return enumResult;
+
+      std::scoped_lock lock(cachedDevicesMutex);
+      DiscardCachedDevicesIfChanged();
+      if (lookupDeviceChangeCount == cachedDeviceChangeCount)
+        cachedDevices.insert({cacheKey, enumeratedDevices});
+
+      devices = std::move(enumeratedDevices);
+    }
+
+    for (const auto& device : *devices)
+    {
+      if (DIENUM_CONTINUE !=
+          ((BOOL(FAR PASCAL*)(const DirectInputTypes<diVersion>::DeviceInstanceType*, LPVOID))(
+              lpCallback))(&device, pvRef))
+        break;
+    }
+
+    return DI_OK;
+  }
+
   template <EDirectInputVersion diVersion> HRESULT __stdcall WrapperIDirectInputBase<
       diVersion>::QueryInterface(REFIID riid, LPVOID* ppvObj)
   {
-    void* interfacePtr = nullptr;
-    const HRESULT result = underlyingDIObject->QueryInterface(riid, &interfacePtr);
+    PROFILE_API_CALL();
+
+    if (nullptr == ppvObj) return E_POINTER;
 
-    if (S_OK == result)
+    if (true == DirectInputTypes<diVersion>::IsCompatibleDirectInputIID(riid))
     {
-      if (true == DirectInputTypes<diVersion>::IsCompatibleDirectInputIID(riid))
-        *ppvObj = this;
-      else
-        *ppvObj = interfacePtr;
+      AddRef();
+      *ppvObj = this;
+      return S_OK;
     }
 
-    return result;
+    // Any other interface can only come from the underlying object.
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        UnderlyingDIObject();
+    if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
+    return systemDIObject->QueryInterface(riid, ppvObj);
   }
 
   template <EDirectInputVersion diVersion> ULONG __stdcall WrapperIDirectInputBase<
       diVersion>::AddRef(void)
   {
-    return underlyingDIObject->AddRef();
+    PROFILE_API_CALL();
+
+    return ++refCount;
   }
 
   template <EDirectInputVersion diVersion> ULONG __stdcall WrapperIDirectInputBase<
       diVersion>::Release(void)
   {
-    const ULONG numRemainingRefs = underlyingDIObject->Release();
+    PROFILE_API_CALL();
+
+    const ULONG numRemainingRefs = --refCount;
+
+    if (0 == numRemainingRefs)
+    {
+      typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+          underlyingDIObject;
+      if (nullptr != systemDIObject) systemDIObject->Release();
 
-    if (0 == numRemainingRefs) delete this;
+      delete this;
+    }
 
     return numRemainingRefs;
   }
@@ -93,6 +362,8 @@ namespace Xidi
           DirectInputTypes<diVersion>::IDirectInputDeviceCompatType** lplpDirectInputDevice,
           LPUNKNOWN pUnkOuter)
   {
+    PROFILE_API_CALL();
+
     // WinMM's internal implementation depends on the DInput version of `CreateDevice`. When using
     // the HookModule form of Xidi, calls to the system version of WinMM will end up calling this
     // function. If called on an XInput controller, this function will fail, which prevents WinMM
@@ -109,16 +380,39 @@ namespace Xidi
     {
       // Not a virtual controller GUID, so just create the device as requested by the application.
       // However, first dump some information about the device.
+      typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+          UnderlyingDIObject();
+      if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
       typename DirectInputTypes<diVersion>::IDirectInputDeviceCompatType* createdDevice = nullptr;
       const HRESULT createDeviceResult =
-          underlyingDIObject->CreateDevice(rguid, &createdDevice, pUnkOuter);
+          systemDIObject->CreateDevice(rguid, &createdDevice, pUnkOuter);
       if (DI_OK == createDeviceResult)
       {
         if (GUID_SysKeyboard == rguid)
         {
-          Infra::Message::Output(
-              Infra::Message::ESeverity::Info,
-              L"Binding to the system keyboard device. Xidi will not handle communication with it.");
+          typename DirectInputTypes<diVersion>::IDirectInputDeviceType* fullDevice = nullptr;
+
+          if ((true == Keyboard::IsDirectInputBackendEnabled()) &&
+              (S_OK ==
+               createdDevice->QueryInterface(
+                   DirectInputTypes<diVersion>::DirectInputDeviceIID(),
+                   reinterpret_cast<LPVOID*>(&fullDevice))))
+          {
+            // Querying for the full interface added a reference, which the wrapper now owns.
+            createdDevice->Release();
+            createdDevice = new WrapperIDirectInputDeviceKeyboard<diVersion>(fullDevice);
+
+            Infra::Message::Output(
+                Infra::Message::ESeverity::Info,
+                L"Binding to the system keyboard device. Xidi will merge virtual keyboard state into the state it reports.");
+          }
+          else
+          {
+            Infra::Message::Output(
+                Infra::Message::ESeverity::Info,
+                L"Binding to the system keyboard device. Xidi will not handle communication with it.");
+          }
         }
         else if (GUID_SysMouse == rguid)
         {
@@ -133,7 +427,7 @@ namespace Xidi
           const HRESULT deviceInfoResult = createdDevice->GetDeviceInfo(&deviceInfo);
 
           const bool deviceSupportsXInput =
-              DoesDirectInputControllerSupportXInput<diVersion>(underlyingDIObject, rguid);
+              DoesSystemDeviceSupportXInput(rguid, deviceInfo.guidProduct);
           if (true == deviceSupportsXInput)
           {
             if (Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Info))
@@ -212,6 +506,8 @@ namespace Xidi
           LPVOID pvRef,
           DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     const DWORD gameControllerDevClass = 4; // DI8DEVCLASS_GAMECTRL, DIDEVTYPE_JOYSTICK
     const DWORD allDevicesDevClass = 0;     // DI8DEVCLASS_ALL, undefined for legacy
     const BOOL gameControllersRequested =
@@ -235,6 +531,50 @@ namespace Xidi
         dwDevType,
         dwFlags);
 
+    // If so configured, game controllers are exclusively Xidi virtual controllers, so the system
+    // is not asked about its game controllers at all. That takes care of the entire request if
+    // only game controllers were requested. Otherwise, every other device class is enumerated
+    // individually so that the system's game controllers are left out.
+    if (gameControllersRequested && Globals::GetSettings().properties.virtualControllersOnly)
+    {
+      Infra::Message::Output(
+          Infra::Message::ESeverity::Debug,
+          L"Enumerate: Configured to present only Xidi virtual controllers, so the system is not being asked about its game controllers.");
+
+      callbackInfo.callbackReturnCode =
+          EnumerateVirtualControllers<diVersion>(lpCallback, pvRef, forceFeedbackControllersOnly);
+
+      if (DIENUM_STOP == callbackInfo.callbackReturnCode)
+      {
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Debug, L"Application has terminated enumeration.");
+        return enumResult;
+      }
+
+      if (allDevicesDevClass == dwDevType)
+      {
+        // DI8DEVCLASS_DEVICE, DI8DEVCLASS_POINTER, and DI8DEVCLASS_KEYBOARD, which have the same
+        // values as DIDEVTYPE_DEVICE, DIDEVTYPE_MOUSE, and DIDEVTYPE_KEYBOARD for legacy.
+        for (const DWORD otherDevClass : {1, 2, 3})
+        {
+          enumResult = EnumSystemDevices(
+              otherDevClass, &CallbackEnumDevicesFiltered, (LPVOID)&callbackInfo, dwFlags);
+          if (DI_OK != enumResult) return enumResult;
+
+          if (DIENUM_STOP == callbackInfo.callbackReturnCode)
+          {
+            Infra::Message::Output(
+                Infra::Message::ESeverity::Debug, L"Application has terminated enumeration.");
+            return enumResult;
+          }
+        }
+      }
+
+      Infra::Message::Output(
+          Infra::Message::ESeverity::Debug, L"Finished enumerating DirectInput devices.");
+      return enumResult;
+    }
+
     // Enumerating game controllers requires some manipulation.
     if (gameControllersRequested)
     {
@@ -243,7 +583,7 @@ namespace Xidi
       // force feedback, even though Xidi does implement such support. For this reason any filtering
       // by force feedback support must be removed while using the system-supplied interfaces to
       // scan for XInput devices.
-      enumResult = underlyingDIObject->EnumDevices(
+      enumResult = EnumSystemDevices(
           dwDevType,
           &WrapperIDirectInputBase<diVersion>::CallbackEnumGameControllersXInputScan,
           (LPVOID)&callbackInfo,
@@ -277,7 +617,7 @@ namespace Xidi
       }
 
       // Third, enumerate all other game controllers, filtering out those that support XInput.
-      enumResult = underlyingDIObject->EnumDevices(
+      enumResult = EnumSystemDevices(
           gameControllerDevClass, &CallbackEnumDevicesFiltered, (LPVOID)&callbackInfo, dwFlags);
 
       if (DI_OK != enumResult) return enumResult;
@@ -306,7 +646,7 @@ namespace Xidi
     }
 
     // Enumerate anything else the application requested, filtering out game controllers.
-    enumResult = underlyingDIObject->EnumDevices(
+    enumResult = EnumSystemDevices(
         dwDevType, &CallbackEnumDevicesFiltered, (LPVOID)&callbackInfo, dwFlags);
 
     if (DI_OK != enumResult) return enumResult;
@@ -329,12 +669,20 @@ namespace Xidi
           DirectInputTypes<diVersion>::ConstStringType ptszName,
           LPGUID pguidInstance)
   {
-    return underlyingDIObject->FindDevice(rguidClass, ptszName, pguidInstance);
+    PROFILE_API_CALL();
+
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        UnderlyingDIObject();
+    if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
+    return systemDIObject->FindDevice(rguidClass, ptszName, pguidInstance);
   }
 
   template <EDirectInputVersion diVersion> HRESULT __stdcall WrapperIDirectInputBase<
       diVersion>::GetDeviceStatus(REFGUID rguidInstance)
   {
+    PROFILE_API_CALL();
+
     // Check if the specified instance GUID is an XInput GUID.
     const std::optional<Controller::TControllerIdentifier> maybeVirtualControllerId =
         VirtualControllerIdFromInstanceGuid(rguidInstance);
@@ -342,7 +690,11 @@ namespace Xidi
     if (false == maybeVirtualControllerId.has_value())
     {
       // Not an XInput GUID, so ask the underlying implementation for status.
-      return underlyingDIObject->GetDeviceStatus(rguidInstance);
+      typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+          UnderlyingDIObject();
+      if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
+      return systemDIObject->GetDeviceStatus(rguidInstance);
     }
     else
     {
@@ -354,13 +706,25 @@ namespace Xidi
   template <EDirectInputVersion diVersion> HRESULT __stdcall WrapperIDirectInputBase<
       diVersion>::Initialize(HINSTANCE hinst, DWORD dwVersion)
   {
-    return underlyingDIObject->Initialize(hinst, dwVersion);
+    PROFILE_API_CALL();
+
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        UnderlyingDIObject();
+    if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
+    return systemDIObject->Initialize(hinst, dwVersion);
   }
 
   template <EDirectInputVersion diVersion> HRESULT __stdcall WrapperIDirectInputBase<
       diVersion>::RunControlPanel(HWND hwndOwner, DWORD dwFlags)
   {
-    return underlyingDIObject->RunControlPanel(hwndOwner, dwFlags);
+    PROFILE_API_CALL();
+
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        UnderlyingDIObject();
+    if (nullptr == systemDIObject) return underlyingDIObjectCreateResult;
+
+    return systemDIObject->RunControlPanel(hwndOwner, dwFlags);
   }
 
   template <EDirectInputVersion diVersion> BOOL __stdcall WrapperIDirectInputBase<diVersion>::
@@ -371,11 +735,12 @@ namespace Xidi
 
     // If the present controller supports XInput, indicate such by adding it to the set of instance
     // identifiers of interest.
-    if (DoesDirectInputControllerSupportXInput<diVersion>(
-            callbackInfo->instance->underlyingDIObject, lpddi->guidInstance))
+    if (true ==
+        callbackInfo->instance->DoesSystemDeviceSupportXInput(
+            lpddi->guidInstance, lpddi->guidProduct))
     {
       callbackInfo->seenInstanceIdentifiers.insert(lpddi->guidInstance);
-      if (Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Debug))
+      if (AsyncLog::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Debug))
       {
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Debug,
@@ -386,7 +751,7 @@ namespace Xidi
     }
     else
     {
-      if (Infra::Message::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Debug))
+      if (AsyncLog::WillOutputMessageOfSeverity(Infra::Message::ESeverity::Debug))
       {
         Infra::Message::OutputFormatted(
             Infra::Message::ESeverity::Debug,
@@ -438,8 +803,13 @@ namespace Xidi
       DWORD dwFlags,
       LPVOID pvRefData)
   {
-    return this->underlyingDIObject->ConfigureDevices(
-        lpdiCallback, lpdiCDParams, dwFlags, pvRefData);
+    PROFILE_API_CALL();
+
+    typename DirectInputTypes<diVersion>::IDirectInputType* const systemDIObject =
+        this->UnderlyingDIObject();
+    if (nullptr == systemDIObject) return this->underlyingDIObjectCreateResult;
+
+    return systemDIObject->ConfigureDevices(lpdiCallback, lpdiCDParams, dwFlags, pvRefData);
   }
 
   template <EDirectInputVersion diVersion>
@@ -451,6 +821,8 @@ namespace Xidi
       LPVOID pvRef,
       DWORD dwFlags)
   {
+    PROFILE_API_CALL();
+
     // Operation not supported.
     return DIERR_UNSUPPORTED;
   }
@@ -460,6 +832,8 @@ namespace Xidi
   HRESULT __stdcall WrapperIDirectInputVersionLegacyOnly<diVersion>::CreateDeviceEx(
       REFGUID rguid, REFIID riid, LPVOID* lplpDirectInputDevice, LPUNKNOWN pUnkOuter)
   {
+    PROFILE_API_CALL();
+
     if (false == DirectInputTypes<diVersion>::IsCompatibleDirectInputDeviceIID(riid))
     {
       Infra::Message::Output(
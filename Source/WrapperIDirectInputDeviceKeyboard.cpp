@@ -0,0 +1,292 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file WrapperIDirectInputDeviceKeyboard.cpp
+ *   Implementation of the wrapper class for the system keyboard's IDirectInputDevice interface.
+ **************************************************************************************************/
+
+#include "WrapperIDirectInputDeviceKeyboard.h"
+
+#include <cstdint>
+
+#include "ApiDirectInput.h"
+#include "Keyboard.h"
+
+namespace Xidi
+{
+  template <EDirectInputVersion diVersion> WrapperIDirectInputDeviceKeyboardBase<diVersion>::
+      WrapperIDirectInputDeviceKeyboardBase(
+          DirectInputTypes<diVersion>::IDirectInputDeviceType* underlyingDIObject)
+      : underlyingDIObject(underlyingDIObject)
+  {}
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::QueryInterface(REFIID riid, LPVOID* ppvObj)
+  {
+    void* interfacePtr = nullptr;
+    const HRESULT result = underlyingDIObject->QueryInterface(riid, &interfacePtr);
+
+    if (S_OK == result)
+    {
+      if (true == DirectInputTypes<diVersion>::IsCompatibleDirectInputDeviceIID(riid))
+        *ppvObj = this;
+      else
+        *ppvObj = interfacePtr;
+    }
+
+    return result;
+  }
+
+  template <EDirectInputVersion diVersion> ULONG __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::AddRef(void)
+  {
+    return underlyingDIObject->AddRef();
+  }
+
+  template <EDirectInputVersion diVersion> ULONG __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::Release(void)
+  {
+    const ULONG numRemainingRefs = underlyingDIObject->Release();
+
+    if (0 == numRemainingRefs) delete this;
+
+    return numRemainingRefs;
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::Acquire(void)
+  {
+    return underlyingDIObject->Acquire();
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::CreateEffect(
+          REFGUID rguid, LPCDIEFFECT lpeff, LPDIRECTINPUTEFFECT* ppdeff, LPUNKNOWN punkOuter)
+  {
+    return underlyingDIObject->CreateEffect(rguid, lpeff, ppdeff, punkOuter);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::EnumCreatedEffectObjects(
+          LPDIENUMCREATEDEFFECTOBJECTSCALLBACK lpCallback, LPVOID pvRef, DWORD fl)
+  {
+    return underlyingDIObject->EnumCreatedEffectObjects(lpCallback, pvRef, fl);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::EnumEffects(
+          DirectInputTypes<diVersion>::EnumEffectsCallbackType lpCallback,
+          LPVOID pvRef,
+          DWORD dwEffType)
+  {
+    return underlyingDIObject->EnumEffects(lpCallback, pvRef, dwEffType);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::EnumEffectsInFile(
+          DirectInputTypes<diVersion>::ConstStringType lptszFileName,
+          LPDIENUMEFFECTSINFILECALLBACK pec,
+          LPVOID pvRef,
+          DWORD dwFlags)
+  {
+    return underlyingDIObject->EnumEffectsInFile(lptszFileName, pec, pvRef, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::EnumObjects(
+          DirectInputTypes<diVersion>::EnumObjectsCallbackType lpCallback,
+          LPVOID pvRef,
+          DWORD dwFlags)
+  {
+    return underlyingDIObject->EnumObjects(lpCallback, pvRef, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::Escape(LPDIEFFESCAPE pesc)
+  {
+    return underlyingDIObject->Escape(pesc);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetCapabilities(LPDIDEVCAPS lpDIDevCaps)
+  {
+    return underlyingDIObject->GetCapabilities(lpDIDevCaps);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetDeviceData(
+          DWORD cbObjectData, LPDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD dwFlags)
+  {
+    return underlyingDIObject->GetDeviceData(cbObjectData, rgdod, pdwInOut, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetDeviceInfo(
+          DirectInputTypes<diVersion>::DeviceInstanceType* pdidi)
+  {
+    return underlyingDIObject->GetDeviceInfo(pdidi);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetDeviceState(DWORD cbData, LPVOID lpvData)
+  {
+    const HRESULT result = underlyingDIObject->GetDeviceState(cbData, lpvData);
+
+    // The system keyboard device reports its state as one byte per key, indexed by scan code,
+    // whenever the application uses the standard keyboard data format. Virtual keyboard state can
+    // only be merged in if the application is using that format.
+    if ((DI_OK == result) && (nullptr != lpvData) &&
+        (sizeof(uint8_t[Keyboard::kVirtualKeyboardKeyCount]) == cbData))
+      Keyboard::MergeIntoDirectInputKeyboardState(
+          *reinterpret_cast<uint8_t(*)[Keyboard::kVirtualKeyboardKeyCount]>(lpvData));
+
+    return result;
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetEffectInfo(
+          DirectInputTypes<diVersion>::EffectInfoType* pdei, REFGUID rguid)
+  {
+    return underlyingDIObject->GetEffectInfo(pdei, rguid);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetForceFeedbackState(LPDWORD pdwOut)
+  {
+    return underlyingDIObject->GetForceFeedbackState(pdwOut);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetObjectInfo(
+          DirectInputTypes<diVersion>::DeviceObjectInstanceType* pdidoi, DWORD dwObj, DWORD dwHow)
+  {
+    return underlyingDIObject->GetObjectInfo(pdidoi, dwObj, dwHow);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::GetProperty(
+          REFGUID rguidProp, LPDIPROPHEADER pdiph)
+  {
+    return underlyingDIObject->GetProperty(rguidProp, pdiph);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::Initialize(
+          HINSTANCE hinst, DWORD dwVersion, REFGUID rguid)
+  {
+    return underlyingDIObject->Initialize(hinst, dwVersion, rguid);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::Poll(void)
+  {
+    return underlyingDIObject->Poll();
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::RunControlPanel(
+          HWND hwndOwner, DWORD dwFlags)
+  {
+    return underlyingDIObject->RunControlPanel(hwndOwner, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::SendDeviceData(
+          DWORD cbObjectData, LPCDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD fl)
+  {
+    return underlyingDIObject->SendDeviceData(cbObjectData, rgdod, pdwInOut, fl);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::SendForceFeedbackCommand(DWORD dwFlags)
+  {
+    return underlyingDIObject->SendForceFeedbackCommand(dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::SetCooperativeLevel(
+          HWND hwnd, DWORD dwFlags)
+  {
+    return underlyingDIObject->SetCooperativeLevel(hwnd, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::SetDataFormat(LPCDIDATAFORMAT lpdf)
+  {
+    return underlyingDIObject->SetDataFormat(lpdf);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::SetEventNotification(HANDLE hEvent)
+  {
+    return underlyingDIObject->SetEventNotification(hEvent);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::SetProperty(
+          REFGUID rguidProp, LPCDIPROPHEADER pdiph)
+  {
+    return underlyingDIObject->SetProperty(rguidProp, pdiph);
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::Unacquire(void)
+  {
+    return underlyingDIObject->Unacquire();
+  }
+
+  template <EDirectInputVersion diVersion> HRESULT __stdcall
+      WrapperIDirectInputDeviceKeyboardBase<diVersion>::WriteEffectToFile(
+          DirectInputTypes<diVersion>::ConstStringType lptszFileName,
+          DWORD dwEntries,
+          LPDIFILEEFFECT rgDiFileEft,
+          DWORD dwFlags)
+  {
+    return underlyingDIObject->WriteEffectToFile(lptszFileName, dwEntries, rgDiFileEft, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion>
+    requires (DirectInputVersionIs8<diVersion>)
+  HRESULT __stdcall WrapperIDirectInputDeviceKeyboardVersion8Only<diVersion>::BuildActionMap(
+      DirectInputTypes<diVersion>::ActionFormatType* lpdiaf,
+      DirectInputTypes<diVersion>::ConstStringType lpszUserName,
+      DWORD dwFlags)
+  {
+    return this->underlyingDIObject->BuildActionMap(lpdiaf, lpszUserName, dwFlags);
+  }
+
+  template <EDirectInputVersion diVersion>
+    requires (DirectInputVersionIs8<diVersion>)
+  HRESULT __stdcall WrapperIDirectInputDeviceKeyboardVersion8Only<diVersion>::GetImageInfo(
+      DirectInputTypes<diVersion>::DeviceImageInfoHeaderType* lpdiDevImageInfoHeader)
+  {
+    return this->underlyingDIObject->GetImageInfo(lpdiDevImageInfoHeader);
+  }
+
+  template <EDirectInputVersion diVersion>
+    requires (DirectInputVersionIs8<diVersion>)
+  HRESULT __stdcall WrapperIDirectInputDeviceKeyboardVersion8Only<diVersion>::SetActionMap(
+      DirectInputTypes<diVersion>::ActionFormatType* lpdiActionFormat,
+      DirectInputTypes<diVersion>::ConstStringType lptszUserName,
+      DWORD dwFlags)
+  {
+    return this->underlyingDIObject->SetActionMap(lpdiActionFormat, lptszUserName, dwFlags);
+  }
+
+  template class WrapperIDirectInputDeviceKeyboardBase<EDirectInputVersion::k8A>;
+  template class WrapperIDirectInputDeviceKeyboardBase<EDirectInputVersion::k8W>;
+  template class WrapperIDirectInputDeviceKeyboardBase<EDirectInputVersion::kLegacyA>;
+  template class WrapperIDirectInputDeviceKeyboardBase<EDirectInputVersion::kLegacyW>;
+  template class WrapperIDirectInputDeviceKeyboardVersion8Only<EDirectInputVersion::k8A>;
+  template class WrapperIDirectInputDeviceKeyboardVersion8Only<EDirectInputVersion::k8W>;
+  template class WrapperIDirectInputDeviceKeyboardVersionLegacyOnly<EDirectInputVersion::kLegacyA>;
+  template class WrapperIDirectInputDeviceKeyboardVersionLegacyOnly<EDirectInputVersion::kLegacyW>;
+  template class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::k8A>;
+  template class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::k8W>;
+  template class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::kLegacyA>;
+  template class WrapperIDirectInputDeviceKeyboard<EDirectInputVersion::kLegacyW>;
+} // namespace Xidi
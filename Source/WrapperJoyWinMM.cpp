@@ -13,31 +13,56 @@
 
 #include <regstr.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <climits>
 #include <cstdint>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <Infra/Core/Message.h>
 #include <Infra/Core/ProcessInfo.h>
 
+#include "ApiCallProfile.h"
 #include "ApiDirectInput.h"
 #include "ApiWindows.h"
+#include "AsyncLog.h"
 #include "ControllerIdentification.h"
 #include "ControllerTypes.h"
 #include "DataFormat.h"
+#include "FlightRecorder.h"
 #include "Globals.h"
 #include "ImportApiDirectInput.h"
 #include "ImportApiWinMM.h"
+#include "JoystickCapturePolicy.h"
+#include "PhysicalController.h"
+#include "Settings.h"
+#include "StartupTrace.h"
 #include "Strings.h"
 #include "VirtualController.h"
+#include "WorkerThread.h"
 
 /// Logs a WinMM device-specific function invocation.
 #define LOG_INVOCATION(severity, joyID, result)                                                    \
-  Infra::Message::OutputFormatted(                                                                 \
-      severity, L"Invoked %s on device %d, result = %u.", __FUNCTIONW__ L"()", joyID, result)
+  do                                                                                               \
+  {                                                                                                \
+    if (AsyncLog::WillOutputMessageOfSeverity(severity))                                           \
+      AsyncLog::OutputFormatted(                                                                   \
+          severity, L"Invoked %s on device %d, result = %u.", __FUNCTIONW__ L"()", joyID, result); \
+    FlightRecorder::RecordApiCall(                                                                 \
+        __FUNCTIONW__,                                                                             \
+        (Controller::TControllerIdentifier)(joyID),                                                \
+        (uint32_t)(joyID),                                                                         \
+        (uint32_t)(result));                                                                       \
+  }                                                                                                \
+  while (false)
 
 /// Logs invocation of an unsupported WinMM operation.
 #define LOG_UNSUPPORTED_OPERATION()                                                                \
@@ -87,18 +112,41 @@ namespace Xidi
     };
 
     /// Fixed set of virtual controllers.
-    static Controller::VirtualController* controllers[Controller::kPhysicalControllerCount];
+    static Controller::VirtualController* controllers[Controller::kMaxPhysicalControllerCount];
 
     /// Maps from application-specified joystick index to the actual indices to present to WinMM or
     /// use internally. Negative values indicate XInput controllers, others indicate values to be
     /// passed to WinMM as is.
     static std::vector<int> joyIndexMap;
 
+    /// Cached results of `joyGetDevCapsA`, one per element of the joystick index map. Empty
+    /// elements have not yet been queried successfully.
+    static std::vector<std::optional<JOYCAPSA>> joyCapsCacheA;
+
+    /// Cached results of `joyGetDevCapsW`, one per element of the joystick index map. Empty
+    /// elements have not yet been queried successfully.
+    static std::vector<std::optional<JOYCAPSW>> joyCapsCacheW;
+
+    /// For ensuring proper concurrency control of the cached joystick capabilities.
+    static std::mutex joyCapsCacheGuard;
+
     /// Holds information about all devices WinMM makes available.
     /// String specifies the device identifier (vendor ID and product ID string), bool value
     /// specifies whether the device supports XInput.
     static std::vector<std::pair<std::wstring, bool>> joySystemDeviceInfo;
 
+    /// Whether or not the system device information data structure has been filled at least once.
+    static bool joySystemDeviceInfoValid = false;
+
+    /// Whether or not the XInput support flags in the system device information data structure are
+    /// the result of a successful DirectInput enumeration. If so, they can be reused for as long as
+    /// the set of devices WinMM reports does not change.
+    static bool joySystemDeviceXInputDetected = false;
+
+    /// For ensuring proper concurrency control of system device enumeration, which can happen
+    /// either on a background thread or on the first invocation of a WinMM function.
+    static std::mutex joySystemDeviceInfoGuard;
+
     /// Templated wrapper around the imported `joyGetDevCaps` WinMM function, which ordinarily
     /// exists in a Unicode and non-Unicode version separately.
     /// @tparam JoyCapsType Either JOYCAPSA or JOYCAPSW depending on whether ASCII or Unicode is
@@ -118,6 +166,23 @@ namespace Xidi
       return ImportApiWinMM::joyGetDevCapsW(uJoyID, pjc, cbjc);
     }
 
+    /// Templated accessor for the cached joystick capabilities, which are held separately for the
+    /// Unicode and non-Unicode versions of `joyGetDevCaps`.
+    /// @tparam JoyCapsType Either JOYCAPSA or JOYCAPSW depending on whether ASCII or Unicode is
+    /// desired.
+    template <typename JoyCapsType> static inline std::vector<std::optional<JoyCapsType>>&
+        JoyCapsCache(void);
+
+    template <> static inline std::vector<std::optional<JOYCAPSA>>& JoyCapsCache<JOYCAPSA>(void)
+    {
+      return joyCapsCacheA;
+    }
+
+    template <> static inline std::vector<std::optional<JOYCAPSW>>& JoyCapsCache<JOYCAPSW>(void)
+    {
+      return joyCapsCacheW;
+    }
+
     /// Templated wrapper around the `LoadString` Windows API function, which ordinarily exists in a
     /// Unicode and non-Unicode version separately.
     /// @tparam StringType Either LPSTR or LPWSTR depending on whether ASCII or Unicode is desired.
@@ -144,13 +209,10 @@ namespace Xidi
     static void CreateJoyIndexMap(void)
     {
       const uint64_t activeVirtualControllerMask =
-          Globals::GetConfigurationData()
-              [Strings::kStrConfigurationSectionWorkarounds]
-              [Strings::kStrConfigurationSettingWorkaroundsActiveVirtualControllerMask]
-                  .ValueOr(UINT64_MAX);
+          Globals::GetSettings().workarounds.activeVirtualControllerMask;
 
       const size_t numDevicesFromSystem = joySystemDeviceInfo.size();
-      const size_t numXInputVirtualDevices = _countof(controllers);
+      const size_t numXInputVirtualDevices = Controller::GetPhysicalControllerCount();
       const size_t numDevicesTotal = numDevicesFromSystem + numXInputVirtualDevices;
 
       // Initialize the joystick index map with conservative defaults.
@@ -182,7 +244,9 @@ namespace Xidi
 
         for (int i = 0; i < (int)numXInputVirtualDevices; ++i)
         {
-          if (0 != (activeVirtualControllerMask & ((uint64_t)1 << i)))
+          if ((0 != (activeVirtualControllerMask & ((uint64_t)1 << i))) &&
+              (true ==
+               Controller::IsPhysicalControllerEnabled((Controller::TControllerIdentifier)i)))
           {
             Infra::Message::OutputFormatted(
                 Infra::Message::ESeverity::Debug,
@@ -200,7 +264,9 @@ namespace Xidi
 
         for (int i = 0; i < (int)numXInputVirtualDevices; ++i)
         {
-          if (0 != (activeVirtualControllerMask & ((uint64_t)1 << i)))
+          if ((0 != (activeVirtualControllerMask & ((uint64_t)1 << i))) &&
+              (true ==
+               Controller::IsPhysicalControllerEnabled((Controller::TControllerIdentifier)i)))
           {
             Infra::Message::OutputFormatted(
                 Infra::Message::ESeverity::Debug,
@@ -281,7 +347,8 @@ namespace Xidi
     }
 
     /// Fills in the system device info data structure with information from the registry and from
-    /// DirectInput.
+    /// DirectInput. Detecting XInput devices using DirectInput is the expensive part, so it is
+    /// skipped if the devices WinMM reports are unchanged since the last successful detection.
     static void CreateSystemDeviceInfo(void)
     {
       const size_t numDevicesFromSystem = (size_t)ImportApiWinMM::joyGetNumDevs();
@@ -290,7 +357,10 @@ namespace Xidi
           L"System provides %u WinMM devices.",
           (unsigned int)numDevicesFromSystem);
 
-      // Initialize the system device information data structure.
+      // Initialize the system device information data structure. The previous contents are kept
+      // aside so that their XInput support flags can be reused.
+      std::vector<std::pair<std::wstring, bool>> previousSystemDeviceInfo =
+          std::move(joySystemDeviceInfo);
       joySystemDeviceInfo.clear();
       joySystemDeviceInfo.reserve(numDevicesFromSystem);
 
@@ -385,6 +455,27 @@ namespace Xidi
           Infra::Message::ESeverity::Debug, L"Done enumerating system WinMM devices.");
       RegCloseKey(registryKey);
 
+      if ((true == joySystemDeviceXInputDetected) &&
+          (previousSystemDeviceInfo.size() == joySystemDeviceInfo.size()) &&
+          (true ==
+           std::equal(
+               previousSystemDeviceInfo.cbegin(),
+               previousSystemDeviceInfo.cend(),
+               joySystemDeviceInfo.cbegin(),
+               [](const auto& previousDevice, const auto& device) -> bool
+               {
+                 return (previousDevice.first == device.first);
+               })))
+      {
+        joySystemDeviceInfo = std::move(previousSystemDeviceInfo);
+        Infra::Message::Output(
+            Infra::Message::ESeverity::Debug,
+            L"System WinMM devices are unchanged, so previously-detected XInput devices are still valid.");
+        return;
+      }
+
+      joySystemDeviceXInputDetected = false;
+
       // Enumerate all devices using DirectInput8 to find any XInput devices with matching vendor
       // and product identifiers. This will provide information on whether each WinMM device
       // supports XInput.
@@ -408,9 +499,11 @@ namespace Xidi
       SWinMMEnumCallbackInfo callbackInfo;
       callbackInfo.systemDeviceInfo = &joySystemDeviceInfo;
       callbackInfo.directInputInterface = directInputInterface;
-      if (S_OK !=
-          directInputInterface->EnumDevices(
-              DI8DEVCLASS_GAMECTRL, CreateSystemDeviceInfoEnumCallback, (LPVOID)&callbackInfo, 0))
+      const HRESULT enumResult = directInputInterface->EnumDevices(
+          DI8DEVCLASS_GAMECTRL, CreateSystemDeviceInfoEnumCallback, (LPVOID)&callbackInfo, 0);
+      directInputInterface->Release();
+
+      if (S_OK != enumResult)
       {
         Infra::Message::Output(
             Infra::Message::ESeverity::Debug,
@@ -418,11 +511,58 @@ namespace Xidi
         return;
       }
 
+      joySystemDeviceXInputDetected = true;
       Infra::Message::Output(Infra::Message::ESeverity::Debug, L"Done detecting XInput devices.");
     }
 
+    /// Fills in the system device info data structure, unless it has already been filled and a
+    /// refresh is not requested. Concurrent invocations wait for the one in progress to finish.
+    /// @param [in] forceRefresh Whether or not to enumerate devices even if a previous
+    /// enumeration result is available.
+    static void RefreshSystemDeviceInfo(bool forceRefresh)
+    {
+      std::scoped_lock lock(joySystemDeviceInfoGuard);
+      if ((true == joySystemDeviceInfoValid) && (false == forceRefresh)) return;
+
+      CreateSystemDeviceInfo();
+      joySystemDeviceInfoValid = true;
+    }
+
+    /// Writes a string value to the registry, unless the registry already contains the same value.
+    /// Registry writes are comparatively expensive and generate change notifications for anything
+    /// watching the key, so avoiding redundant writes keeps initialization fast.
+    /// @param [in] registryKey Open registry key, with both query and set access.
+    /// @param [in] valueName Name of the value to write.
+    /// @param [in] valueData String to write, which must be null-terminated.
+    /// @param [in] valueDataCount Number of characters in the string, excluding the terminator.
+    /// @return Result of the registry write, or `ERROR_SUCCESS` if no write was needed.
+    static LSTATUS SetRegistryStringValueIfDifferent(
+        HKEY registryKey, const wchar_t* valueName, const wchar_t* valueData, int valueDataCount)
+    {
+      const DWORD valueDataSize = (DWORD)(sizeof(wchar_t) * (valueDataCount + 1));
+
+      wchar_t existingValueData[128];
+      DWORD existingValueSize = sizeof(existingValueData);
+      if ((ERROR_SUCCESS ==
+           RegGetValue(
+               registryKey,
+               nullptr,
+               valueName,
+               RRF_RT_REG_SZ,
+               nullptr,
+               existingValueData,
+               &existingValueSize)) &&
+          (existingValueSize == valueDataSize) &&
+          (0 == wmemcmp(existingValueData, valueData, valueDataCount)))
+        return ERROR_SUCCESS;
+
+      return RegSetValueEx(
+          registryKey, valueName, 0, REG_SZ, (const BYTE*)valueData, valueDataSize);
+    }
+
     /// Fills in the specified buffer with the name of the registry key to use for referencing
-    /// controller names.
+    /// controller names. The string resource is loaded only once, and subsequent invocations copy
+    /// from the loaded string. As with `LoadString`, the result is truncated to fit the buffer.
     /// @tparam StringType Either LPSTR or LPWSTR depending on whether ASCII or Unicode is desired.
     /// @param [out] buf Buffer to be filled.
     /// @param [in] bufcount Number of characters that the buffer can hold.
@@ -430,11 +570,27 @@ namespace Xidi
     template <typename StringType> static inline int FillRegistryKeyString(
         StringType buf, const size_t bufcount)
     {
-      return LoadResourceString(
-          Infra::ProcessInfo::GetThisModuleInstanceHandle(),
-          IDS_XIDI_PRODUCT_NAME,
-          buf,
-          (int)bufcount);
+      using TCharType = std::remove_pointer_t<StringType>;
+
+      static const std::basic_string<TCharType> registryKeyString = []() -> auto
+      {
+        TCharType loadedString[128];
+        const int loadedStringLength = LoadResourceString(
+            Infra::ProcessInfo::GetThisModuleInstanceHandle(),
+            IDS_XIDI_PRODUCT_NAME,
+            (StringType)loadedString,
+            (int)_countof(loadedString));
+
+        return std::basic_string<TCharType>(
+            loadedString, ((loadedStringLength > 0) ? (size_t)loadedStringLength : 0));
+      }();
+
+      if (0 == bufcount) return -1;
+
+      const size_t numCharsToCopy = std::min(registryKeyString.length(), bufcount - 1);
+      registryKeyString.copy(buf, numCharsToCopy);
+      buf[numCharsToCopy] = (TCharType)0;
+      return (int)numCharsToCopy;
     }
 
     /// Places the required keys and values into the registry so that WinMM-based applications can
@@ -452,7 +608,7 @@ namespace Xidi
       // These will be in
       // HKCU\System\CurrentControlSet\Control\MediaProperties\PrivateProperties\Joystick\OEM\Xidi#
       // and contain the name of the controller.
-      for (int i = 0; i < _countof(controllers); ++i)
+      for (int i = 0; i < (int)Controller::GetPhysicalControllerCount(); ++i)
       {
         wchar_t valueData[64];
         const int valueDataCount = FillVirtualControllerName(
@@ -470,19 +626,14 @@ namespace Xidi
             0,
             nullptr,
             REG_OPTION_VOLATILE,
-            KEY_SET_VALUE,
+            KEY_QUERY_VALUE | KEY_SET_VALUE,
             nullptr,
             &registryKey,
             nullptr);
         if (ERROR_SUCCESS != result) return;
 
-        result = RegSetValueEx(
-            registryKey,
-            REGSTR_VAL_JOYOEMNAME,
-            0,
-            REG_SZ,
-            (const BYTE*)valueData,
-            (sizeof(wchar_t) * (valueDataCount + 1)));
+        result = SetRegistryStringValueIfDifferent(
+            registryKey, REGSTR_VAL_JOYOEMNAME, valueData, valueDataCount);
         RegCloseKey(registryKey);
 
         if (ERROR_SUCCESS != result) return;
@@ -505,7 +656,7 @@ namespace Xidi
           0,
           nullptr,
           REG_OPTION_VOLATILE,
-          KEY_SET_VALUE,
+          KEY_QUERY_VALUE | KEY_SET_VALUE,
           nullptr,
           &registryKey,
           nullptr);
@@ -514,8 +665,7 @@ namespace Xidi
       for (size_t i = 0; i < joyIndexMap.size(); ++i)
       {
         wchar_t valueName[64];
-        const int valueNameCount =
-            swprintf_s(valueName, _countof(valueName), REGSTR_VAL_JOYNOEMNAME, ((int)i + 1));
+        swprintf_s(valueName, _countof(valueName), REGSTR_VAL_JOYNOEMNAME, ((int)i + 1));
 
         if (joyIndexMap[i] < 0)
         {
@@ -528,13 +678,7 @@ namespace Xidi
               valueData, _countof(valueData), L"%s%u", registryKeyName, ((UINT)(-joyIndexMap[i])));
 
           // Write the value to the registry.
-          RegSetValueEx(
-              registryKey,
-              valueName,
-              0,
-              REG_SZ,
-              (const BYTE*)valueData,
-              (sizeof(wchar_t) * (valueDataCount + 1)));
+          SetRegistryStringValueIfDifferent(registryKey, valueName, valueData, valueDataCount);
         }
         else
         {
@@ -545,15 +689,11 @@ namespace Xidi
           const int valueDataCount = (int)joySystemDeviceInfo[joyIndexMap[i]].first.length();
 
           // Write the value to the registry.
-          RegSetValueEx(
-              registryKey,
-              valueName,
-              0,
-              REG_SZ,
-              (const BYTE*)valueData,
-              (sizeof(joySystemDeviceInfo[joyIndexMap[i]].first[0]) * (valueDataCount + 1)));
+          SetRegistryStringValueIfDifferent(registryKey, valueName, valueData, valueDataCount);
         }
       }
+
+      RegCloseKey(registryKey);
     }
 
     /// Translates an application-supplied joystick index to an internal joystick index using the
@@ -568,38 +708,363 @@ namespace Xidi
         return joyIndexMap[uJoyID];
     }
 
+    /// Rebuilds one of the joystick capabilities caches so that it matches the current joystick
+    /// index map. Cached capabilities are carried over for every device that is still present, even
+    /// if its position in the map changed, so that only new or changed devices need to be queried.
+    /// @tparam JoyCapsType Either JOYCAPSA or JOYCAPSW depending on whether ASCII or Unicode is
+    /// desired.
+    /// @param [in] previousJoyIndexMap Joystick index map to which the cache currently corresponds.
+    /// @param [in] previousSystemDeviceInfo System device information from which the previous
+    /// joystick index map was created.
+    template <typename JoyCapsType> static void UpdateJoyCapsCache(
+        const std::vector<int>& previousJoyIndexMap,
+        const std::vector<std::pair<std::wstring, bool>>& previousSystemDeviceInfo)
+    {
+      std::vector<std::optional<JoyCapsType>>& joyCapsCache = JoyCapsCache<JoyCapsType>();
+      std::vector<std::optional<JoyCapsType>> updatedJoyCapsCache(joyIndexMap.size());
+
+      for (size_t i = 0; i < joyIndexMap.size(); ++i)
+      {
+        const int realJoyID = joyIndexMap[i];
+
+        // System devices are only the same device if the system still identifies them the same
+        // way. Xidi virtual controllers never change.
+        if ((realJoyID >= 0) &&
+            ((previousSystemDeviceInfo.size() <= (size_t)realJoyID) ||
+             (previousSystemDeviceInfo[realJoyID].first !=
+              joySystemDeviceInfo[realJoyID].first)))
+          continue;
+
+        for (size_t j = 0; j < std::min(previousJoyIndexMap.size(), joyCapsCache.size()); ++j)
+        {
+          if (previousJoyIndexMap[j] == realJoyID)
+          {
+            updatedJoyCapsCache[i] = joyCapsCache[j];
+            break;
+          }
+        }
+      }
+
+      joyCapsCache = std::move(updatedJoyCapsCache);
+    }
+
+    /// Rebuilds all joystick capabilities caches so that they match the current joystick index map.
+    /// Parameters are the same as for #UpdateJoyCapsCache.
+    static void UpdateAllJoyCapsCaches(
+        const std::vector<int>& previousJoyIndexMap,
+        const std::vector<std::pair<std::wstring, bool>>& previousSystemDeviceInfo)
+    {
+      std::scoped_lock lock(joyCapsCacheGuard);
+      UpdateJoyCapsCache<JOYCAPSA>(previousJoyIndexMap, previousSystemDeviceInfo);
+      UpdateJoyCapsCache<JOYCAPSW>(previousJoyIndexMap, previousSystemDeviceInfo);
+    }
+
+    /// Minimum capture period, in milliseconds, that applications can request when capturing a
+    /// Xidi virtual controller's messages to a window.
+    static constexpr UINT kCapturePeriodMinMilliseconds = 10;
+
+    /// Maximum capture period, in milliseconds, that applications can request when capturing a
+    /// Xidi virtual controller's messages to a window.
+    static constexpr UINT kCapturePeriodMaxMilliseconds = 1000;
+
+    /// Number of virtual controller buttons that are reported in joystick capture messages.
+    static constexpr unsigned int kCaptureMessageButtonCount = 4;
+
+    /// Delivers joystick messages for a single Xidi virtual controller to a window, as requested
+    /// by an application using `joySetCapture`. A thread waits for the virtual controller's state
+    /// to change, so no work is done while the controller is idle, and at most one round of
+    /// messages is posted per capture period. Wraps the thread handle to ensure safe termination
+    /// and clean-up.
+    class JoystickCapture
+    {
+    public:
+
+      inline JoystickCapture(void)
+          : captureThread(), captureStopEvent(NULL), stateChangeEvent(NULL), captureActive(false)
+      {}
+
+      JoystickCapture(const JoystickCapture& other) = delete;
+
+      /// Safely exits the capture thread if it is started.
+      ~JoystickCapture(void)
+      {
+        Stop(nullptr);
+      }
+
+      /// Determines if messages are currently being delivered to a window.
+      /// @return `true` if so, `false` if not.
+      inline bool IsActive(void) const
+      {
+        return captureActive.load(std::memory_order_acquire);
+      }
+
+      /// Starts delivering joystick messages to the specified window. The caller is responsible
+      /// for ensuring that this object is not already active.
+      /// @param [in] virtualController Virtual controller whose state changes are to be delivered.
+      /// @param [in] window Window to which messages are posted.
+      /// @param [in] messageOffset Offset to add to joystick 1 message identifiers, which is 0
+      /// for joystick 1 messages and 1 for joystick 2 messages.
+      /// @param [in] periodMilliseconds Capture period, already clamped to the supported range.
+      /// @param [in] changedOnly Whether movement messages should be posted only when positions
+      /// change, rather than every period.
+      /// @return `true` if capture started successfully, `false` otherwise.
+      bool Start(
+          Controller::VirtualController* virtualController,
+          HWND window,
+          UINT messageOffset,
+          UINT periodMilliseconds,
+          bool changedOnly)
+      {
+        Stop(virtualController);
+
+        // Events are created once and intentionally never closed. The virtual controller might
+        // still be signalling the state change event while capture is being stopped.
+        if (NULL == captureStopEvent)
+          captureStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        if (NULL == stateChangeEvent)
+          stateChangeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if ((NULL == captureStopEvent) || (NULL == stateChangeEvent)) return false;
+
+        ResetEvent(captureStopEvent);
+        virtualController->SetStateChangeEvent(stateChangeEvent);
+
+        captureActive.store(true, std::memory_order_release);
+        captureThread = WorkerThread::Create(
+            L"Xidi WinMM Capture",
+            WorkerThread::EPriority::LatencyCritical,
+            DeliverCaptureMessages,
+            this,
+            virtualController,
+            window,
+            messageOffset,
+            periodMilliseconds,
+            changedOnly);
+
+        return true;
+      }
+
+      /// Stops delivering joystick messages, if this object is active.
+      /// @param [in] virtualController Virtual controller whose state changes were being delivered,
+      /// or `nullptr` if the virtual controller is being torn down.
+      void Stop(Controller::VirtualController* virtualController)
+      {
+        if (true == captureThread.joinable())
+        {
+          SetEvent(captureStopEvent);
+          captureThread.join();
+        }
+
+        if (nullptr != virtualController) virtualController->SetStateChangeEvent(NULL);
+        captureActive.store(false, std::memory_order_release);
+      }
+
+    private:
+
+      /// Waits for virtual controller state changes and delivers them to the capturing window as
+      /// joystick messages. Runs until stopped or until the capturing window is destroyed.
+      /// Parameters are the same as for #Start.
+      static void DeliverCaptureMessages(
+          JoystickCapture* capture,
+          Controller::VirtualController* virtualController,
+          HWND window,
+          UINT messageOffset,
+          UINT periodMilliseconds,
+          bool changedOnly)
+      {
+        const HANDLE waitHandles[] = {capture->captureStopEvent, capture->stateChangeEvent};
+        const SCaptureWaitPolicy kWaitPolicy = CaptureWaitPolicy(periodMilliseconds, changedOnly);
+
+        // Forces the first round of messages to report all buttons currently pressed.
+        bool isFirstRound = true;
+        Controller::SState previousState = {};
+
+        while (true)
+        {
+          // When only changes are of interest, there is no need to wake up until a change occurs.
+          // Otherwise, messages are due every period regardless, and state changes must not cause
+          // any additional rounds.
+          const DWORD waitResult = WaitForMultipleObjects(
+              ((true == kWaitPolicy.wakeOnStateChange) ? _countof(waitHandles) : 1),
+              waitHandles,
+              FALSE,
+              kWaitPolicy.timeoutMilliseconds);
+          if (((WAIT_OBJECT_0 + 1) != waitResult) && (WAIT_TIMEOUT != waitResult)) break;
+          if (FALSE == IsWindow(window)) break;
+
+          const Controller::SState currentState = virtualController->GetState();
+
+          const WPARAM kButtonMask = (1u << kCaptureMessageButtonCount) - 1;
+          const WPARAM currentButtons = (WPARAM)currentState.ButtonBitmask() & kButtonMask;
+          const WPARAM previousButtons =
+              ((true == isFirstRound) ? 0 : ((WPARAM)previousState.ButtonBitmask() & kButtonMask));
+          const LPARAM currentPositionXY = MAKELPARAM(
+              (WORD)currentState[Controller::EAxis::X], (WORD)currentState[Controller::EAxis::Y]);
+          const LPARAM currentPositionZ = (LPARAM)(WORD)currentState[Controller::EAxis::Z];
+
+          // Button change flags occupy the bits immediately above the button state bits, starting
+          // at `JOY_BUTTON1CHG`.
+          const WPARAM pressedButtons = currentButtons & ~previousButtons;
+          const WPARAM releasedButtons = previousButtons & ~currentButtons;
+
+          if (0 != pressedButtons)
+            PostMessage(
+                window,
+                MM_JOY1BUTTONDOWN + messageOffset,
+                (pressedButtons * JOY_BUTTON1CHG) | currentButtons,
+                currentPositionXY);
+
+          if (0 != releasedButtons)
+            PostMessage(
+                window,
+                MM_JOY1BUTTONUP + messageOffset,
+                (releasedButtons * JOY_BUTTON1CHG) | currentButtons,
+                currentPositionXY);
+
+          if ((false == changedOnly) || (true == isFirstRound) ||
+              (currentState[Controller::EAxis::X] != previousState[Controller::EAxis::X]) ||
+              (currentState[Controller::EAxis::Y] != previousState[Controller::EAxis::Y]))
+            PostMessage(
+                window, MM_JOY1MOVE + messageOffset, currentButtons, currentPositionXY);
+
+          if ((false == changedOnly) || (true == isFirstRound) ||
+              (currentState[Controller::EAxis::Z] != previousState[Controller::EAxis::Z]))
+            PostMessage(
+                window, MM_JOY1ZMOVE + messageOffset, currentButtons, currentPositionZ);
+
+          previousState = currentState;
+          isFirstRound = false;
+
+          // Changes that happen during this wait remain signalled, so they are delivered as soon as
+          // the period ends. This limits message delivery to once per period.
+          if (0 != kWaitPolicy.holdOffMilliseconds)
+          {
+            if (WAIT_OBJECT_0 ==
+                WaitForSingleObject(capture->captureStopEvent, kWaitPolicy.holdOffMilliseconds))
+              break;
+          }
+        }
+
+        capture->captureActive.store(false, std::memory_order_release);
+      }
+
+      /// Handle for the capture thread itself.
+      std::thread captureThread;
+
+      /// Manual-reset event used to ask the capture thread to exit.
+      HANDLE captureStopEvent;
+
+      /// Auto-reset event that the virtual controller signals whenever its state changes.
+      HANDLE stateChangeEvent;
+
+      /// Whether or not messages are currently being delivered to a window.
+      std::atomic<bool> captureActive;
+    };
+
+    /// Joystick captures, one per virtual controller.
+    static JoystickCapture joystickCaptures[Controller::kMaxPhysicalControllerCount];
+
+    /// For ensuring proper concurrency control of joystick capture operations.
+    static std::mutex joystickCaptureGuard;
+
+    /// Number of distinct combinations of POV direction components.
+    static constexpr unsigned int kNumPovDirectionCombinations =
+        1u << static_cast<unsigned int>(Controller::EPovDirection::Count);
+
+    /// WinMM POV values for each possible combination of POV direction components, indexed by a
+    /// bitmask with one bit per component in enumerator order. Computed once so that translating a
+    /// POV reading is only a table lookup.
+    static const std::array<DWORD, kNumPovDirectionCombinations> kWinMMPovValues =
+        []() -> std::array<DWORD, kNumPovDirectionCombinations>
+    {
+      std::array<DWORD, kNumPovDirectionCombinations> winMMPovValues = {};
+
+      for (unsigned int i = 0; i < kNumPovDirectionCombinations; ++i)
+      {
+        Controller::UPovDirection pov = {};
+        for (unsigned int j = 0; j < pov.components.size(); ++j)
+          pov.components[j] = (0 != (i & (1u << j)));
+
+        // WinMM uses only 16 bits to indicate that the dpad is centered, whereas it is safe to
+        // use all 32 in DirectInput, hence the conversion (forgetting this can introduce bugs
+        // into games).
+        const EPovValue povValue = DataFormat::DirectInputPovValue(pov);
+        winMMPovValues[i] =
+            (EPovValue::Center == povValue ? (DWORD)(JOY_POVCENTERED) : (DWORD)povValue);
+      }
+
+      return winMMPovValues;
+    }();
+
+    /// Translates a virtual controller POV direction to a WinMM POV value.
+    /// @param [in] pov Virtual controller POV direction.
+    /// @return Corresponding WinMM POV value.
+    static inline DWORD WinMMPovValue(Controller::UPovDirection pov)
+    {
+      unsigned int combinationIndex = 0;
+      for (unsigned int j = 0; j < pov.components.size(); ++j)
+        combinationIndex |= ((true == pov.components[j]) ? (1u << j) : 0);
+
+      return kWinMMPovValues[combinationIndex];
+    }
+
+    /// Fills in all of the position information in a WinMM extended joystick information structure
+    /// using the state of a virtual controller. Virtual controllers have already applied range,
+    /// deadzone, and saturation by the time their state is published, so this is only a matter of
+    /// placing each value in the correct field. Size and flags are left unchanged.
+    /// @param [in] state Virtual controller state.
+    /// @param [out] joyInfo Structure to be filled in.
+    static inline void FillJoyInfoEx(const Controller::SState& state, JOYINFOEX& joyInfo)
+    {
+      const uint32_t buttons = state.ButtonBitmask();
+
+      joyInfo.dwXpos = (DWORD)state[Controller::EAxis::X];
+      joyInfo.dwYpos = (DWORD)state[Controller::EAxis::Y];
+      joyInfo.dwZpos = (DWORD)state[Controller::EAxis::Z];
+      joyInfo.dwRpos = (DWORD)state[Controller::EAxis::RotZ];
+      joyInfo.dwUpos = (DWORD)state[Controller::EAxis::RotY];
+      joyInfo.dwVpos = (DWORD)state[Controller::EAxis::RotX];
+      joyInfo.dwButtons = (DWORD)buttons;
+      joyInfo.dwButtonNumber = (DWORD)std::popcount(buttons);
+      joyInfo.dwPOV = WinMMPovValue(state.povDirection);
+      joyInfo.dwReserved1 = 0;
+      joyInfo.dwReserved2 = 0;
+    }
+
     /// Initializes all WinMM functionality.
     static void Initialize(void)
     {
       // There is overhead to using call_once, even after the operation is completed, and WinMM
       // wrapper functions are called frequently. Using this additional flag avoids that overhead in
       // the common case.
-      static bool isInitialized = false;
-      if (true == isInitialized) return;
+      static std::atomic<bool> isInitialized = false;
+      if (true == isInitialized.load(std::memory_order_acquire)) return;
 
       static std::once_flag initializationFlag;
       std::call_once(
           initializationFlag,
           []() -> void
           {
+            Globals::EnsureInitialized();
+
+            const StartupTrace::ScopedPhase initializePhase(L"WrapperJoyWinMM::Initialize");
+
             const bool enableAxisProperites =
-                Globals::GetConfigurationData()
-                    [Strings::kStrConfigurationSectionProperties]
-                    [Strings::kStrConfigurationSettingsPropertiesUseBuiltinProperties]
-                        .ValueOr(true);
+                Globals::GetSettings().properties.useBuiltinProperties;
             const uint64_t activeVirtualControllerMask =
-                Globals::GetConfigurationData()
-                    [Strings::kStrConfigurationSectionWorkarounds]
-                    [Strings::kStrConfigurationSettingWorkaroundsActiveVirtualControllerMask]
-                        .ValueOr(UINT64_MAX);
+                Globals::GetSettings().workarounds.activeVirtualControllerMask;
 
-            for (Controller::TControllerIdentifier i = 0; i < _countof(controllers); ++i)
+            for (Controller::TControllerIdentifier i = 0;
+                 i < Controller::GetPhysicalControllerCount();
+                 ++i)
             {
               controllers[i] = nullptr;
 
-              if (0 != (activeVirtualControllerMask & ((uint64_t)1 << i)))
+              if ((0 != (activeVirtualControllerMask & ((uint64_t)1 << i))) &&
+                  (true == Controller::IsPhysicalControllerEnabled(i)))
               {
                 controllers[i] = new Controller::VirtualController(i);
+
+                controllers[i]->BeginPropertyTransaction();
                 controllers[i]->SetAllAxisRange(kAxisRangeMin, kAxisRangeMax);
 
                 if (enableAxisProperites)
@@ -607,14 +1072,21 @@ namespace Xidi
                   controllers[i]->SetAllAxisDeadzone(kAxisDeadzone);
                   controllers[i]->SetAllAxisSaturation(kAxisSaturation);
                 }
+
+                controllers[i]->EndPropertyTransaction();
               }
             }
 
-            // Enumerate all devices exposed by WinMM.
-            CreateSystemDeviceInfo();
+            // Enumerate all devices exposed by WinMM. This is usually already done, or at least in
+            // progress, on a background thread.
+            {
+              const StartupTrace::ScopedPhase enumerationPhase(L"System device enumeration");
+              RefreshSystemDeviceInfo(false);
+            }
 
             // Initialize the joystick index map.
             CreateJoyIndexMap();
+            UpdateAllJoyCapsCaches({}, {});
 
             // Ensure all controllers have their names published in the system registry.
             SetControllerNameRegistryInfo();
@@ -624,25 +1096,15 @@ namespace Xidi
                 Infra::Message::ESeverity::Info,
                 L"Completed initialization of WinMM joystick wrapper.");
 
-            isInitialized = true;
+            isInitialized.store(true, std::memory_order_release);
           });
     }
 
-    /// Templated implementation of the `joyGetDevCaps` function, allowing an "A" version and a "W"
-    /// version to be exported separately.
-    template <typename JoyCapsType> static inline MMRESULT JoyGetDevCapsInternal(
+    /// Queries for joystick capabilities without using the cache.
+    /// Parameters are the same as for the `joyGetDevCaps` function.
+    template <typename JoyCapsType> static MMRESULT JoyGetDevCapsUncached(
         UINT_PTR uJoyID, JoyCapsType* pjc, UINT cbjc)
     {
-      // Special case: index is specified as -1, which the API says just means fill in the registry
-      // key.
-      if ((UINT_PTR)-1 == uJoyID)
-      {
-        FillRegistryKeyString(pjc->szRegKey, _countof(pjc->szRegKey));
-
-        const MMRESULT result = JOYERR_NOERROR;
-        return result;
-      }
-
       const int realJoyID = TranslateApplicationJoyIndex((UINT)uJoyID);
 
       if (realJoyID < 0)
@@ -712,8 +1174,65 @@ namespace Xidi
       }
     }
 
+    /// Templated implementation of the `joyGetDevCaps` function, allowing an "A" version and a "W"
+    /// version to be exported separately.
+    template <typename JoyCapsType> static inline MMRESULT JoyGetDevCapsInternal(
+        UINT_PTR uJoyID, JoyCapsType* pjc, UINT cbjc)
+    {
+      // Special case: index is specified as -1, which the API says just means fill in the registry
+      // key.
+      if ((UINT_PTR)-1 == uJoyID)
+      {
+        FillRegistryKeyString(pjc->szRegKey, _countof(pjc->szRegKey));
+
+        const MMRESULT result = JOYERR_NOERROR;
+        return result;
+      }
+
+      // Capabilities do not change until the set of devices changes, so successful results are
+      // served from memory whenever possible. Only complete capabilities structures are cached.
+      if (sizeof(*pjc) == cbjc)
+      {
+        std::scoped_lock lock(joyCapsCacheGuard);
+        const std::vector<std::optional<JoyCapsType>>& joyCapsCache = JoyCapsCache<JoyCapsType>();
+
+        if ((joyCapsCache.size() > (size_t)uJoyID) && (joyCapsCache[uJoyID].has_value()))
+        {
+          *pjc = *joyCapsCache[uJoyID];
+
+          const MMRESULT result = JOYERR_NOERROR;
+          return result;
+        }
+      }
+
+      const MMRESULT result = JoyGetDevCapsUncached(uJoyID, pjc, cbjc);
+
+      if ((JOYERR_NOERROR == result) && (sizeof(*pjc) == cbjc))
+      {
+        std::scoped_lock lock(joyCapsCacheGuard);
+        std::vector<std::optional<JoyCapsType>>& joyCapsCache = JoyCapsCache<JoyCapsType>();
+
+        if (joyCapsCache.size() > (size_t)uJoyID) joyCapsCache[uJoyID] = *pjc;
+      }
+
+      return result;
+    }
+
+    void BeginSystemDeviceEnumeration(void)
+    {
+      const StartupTrace::ScopedPhase beginEnumerationPhase(
+          L"WrapperJoyWinMM::BeginSystemDeviceEnumeration");
+      WorkerThread::StartDetached(
+          L"Xidi WinMM Device Enumeration",
+          WorkerThread::EPriority::Normal,
+          RefreshSystemDeviceInfo,
+          false);
+    }
+
     MMRESULT __stdcall joyConfigChanged(DWORD dwFlags)
     {
+      PROFILE_API_CALL();
+
       Infra::Message::Output(
           Infra::Message::ESeverity::Info,
           L"Refreshing joystick state due to a configuration change.");
@@ -722,9 +1241,15 @@ namespace Xidi
       // Redirect to the imported API so that its view of the registry can be updated.
       HRESULT result = ImportApiWinMM::joyConfigChanged(dwFlags);
 
-      // Update Xidi's view of devices.
-      CreateSystemDeviceInfo();
+      // Update Xidi's view of devices. Capabilities of devices that are unaffected by the change
+      // remain cached.
+      const std::vector<int> previousJoyIndexMap = joyIndexMap;
+      const std::vector<std::pair<std::wstring, bool>> previousSystemDeviceInfo =
+          joySystemDeviceInfo;
+
+      RefreshSystemDeviceInfo(true);
       CreateJoyIndexMap();
+      UpdateAllJoyCapsCaches(previousJoyIndexMap, previousSystemDeviceInfo);
       SetControllerNameRegistryInfo();
 
       return result;
@@ -732,6 +1257,8 @@ namespace Xidi
 
     MMRESULT __stdcall joyGetDevCapsA(UINT_PTR uJoyID, LPJOYCAPSA pjc, UINT cbjc)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       MMRESULT result = JoyGetDevCapsInternal(uJoyID, pjc, cbjc);
       LOG_INVOCATION(Infra::Message::ESeverity::Info, static_cast<unsigned int>(uJoyID), result);
@@ -740,6 +1267,8 @@ namespace Xidi
 
     MMRESULT __stdcall joyGetDevCapsW(UINT_PTR uJoyID, LPJOYCAPSW pjc, UINT cbjc)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       MMRESULT result = JoyGetDevCapsInternal(uJoyID, pjc, cbjc);
       LOG_INVOCATION(Infra::Message::ESeverity::Info, static_cast<unsigned int>(uJoyID), result);
@@ -748,6 +1277,8 @@ namespace Xidi
 
     UINT __stdcall joyGetNumDevs(void)
     {
+      PROFILE_API_CALL();
+
       Initialize();
 
       // Number of controllers = number of XInput controllers + number of driver-reported
@@ -763,6 +1294,8 @@ namespace Xidi
 
     MMRESULT __stdcall joyGetPos(UINT uJoyID, LPJOYINFO pji)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
 
@@ -772,18 +1305,15 @@ namespace Xidi
         const Controller::TControllerIdentifier xJoyID =
             (Controller::TControllerIdentifier)((-realJoyID) - 1);
 
+        Controller::NotifyApplicationStateRead(xJoyID);
+        Controller::ServicePhysicalControllerCooperatively(xJoyID);
         const Controller::SState joyStateData = controllers[xJoyID]->GetState();
+        Controller::NotifyApplicationStateObserved(xJoyID);
 
         pji->wXpos = (WORD)joyStateData[Controller::EAxis::X];
         pji->wYpos = (WORD)joyStateData[Controller::EAxis::Y];
         pji->wZpos = (WORD)joyStateData[Controller::EAxis::Z];
-        pji->wButtons = 0;
-
-        constexpr size_t maxButtonIndex = 8 * sizeof(pji->wButtons);
-        for (size_t i = 0; ((i < joyStateData.button.size()) && (i < maxButtonIndex)); ++i)
-        {
-          if (true == joyStateData.button[i]) pji->wButtons |= (1 << i);
-        }
+        pji->wButtons = (WORD)joyStateData.ButtonBitmask();
 
         const MMRESULT result = JOYERR_NOERROR;
         LOG_INVOCATION(Infra::Message::ESeverity::SuperDebug, (unsigned int)uJoyID, result);
@@ -800,6 +1330,8 @@ namespace Xidi
 
     MMRESULT __stdcall joyGetPosEx(UINT uJoyID, LPJOYINFOEX pji)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
 
@@ -817,30 +1349,10 @@ namespace Xidi
           return result;
         }
 
-        const Controller::SState joyStateData = controllers[xJoyID]->GetState();
-        const EPovValue joyStateDataPovValue =
-            DataFormat::DirectInputPovValue(joyStateData.povDirection);
-
-        // Fill in the provided structure.
-        // WinMM uses only 16 bits to indicate that the dpad is centered, whereas it is safe to
-        // use all 32 in DirectInput, hence the conversion (forgetting this can introduce bugs
-        // into games).
-        pji->dwPOV =
-            (EPovValue::Center == joyStateDataPovValue ? (DWORD)(JOY_POVCENTERED)
-                                                       : (DWORD)joyStateDataPovValue);
-        pji->dwXpos = joyStateData[Controller::EAxis::X];
-        pji->dwYpos = joyStateData[Controller::EAxis::Y];
-        pji->dwZpos = joyStateData[Controller::EAxis::Z];
-        pji->dwRpos = joyStateData[Controller::EAxis::RotZ];
-        pji->dwUpos = joyStateData[Controller::EAxis::RotY];
-        pji->dwVpos = joyStateData[Controller::EAxis::RotX];
-        pji->dwButtons = 0;
-
-        constexpr size_t maxButtonIndex = 8 * sizeof(pji->dwButtons);
-        for (size_t i = 0; ((i < joyStateData.button.size()) && (i < maxButtonIndex)); ++i)
-        {
-          if (true == joyStateData.button[i]) pji->dwButtons |= (1 << i);
-        }
+        Controller::NotifyApplicationStateRead(xJoyID);
+        Controller::ServicePhysicalControllerCooperatively(xJoyID);
+        FillJoyInfoEx(controllers[xJoyID]->GetState(), *pji);
+        Controller::NotifyApplicationStateObserved(xJoyID);
 
         const MMRESULT result = JOYERR_NOERROR;
         LOG_INVOCATION(Infra::Message::ESeverity::SuperDebug, (unsigned int)uJoyID, result);
@@ -857,6 +1369,8 @@ namespace Xidi
 
     MMRESULT __stdcall joyGetThreshold(UINT uJoyID, LPUINT puThreshold)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
 
@@ -881,16 +1395,21 @@ namespace Xidi
 
     MMRESULT __stdcall joyReleaseCapture(UINT uJoyID)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
 
       if (realJoyID < 0)
       {
         // Querying an XInput controller.
+        const Controller::TControllerIdentifier xJoyID =
+            (Controller::TControllerIdentifier)((-realJoyID) - 1);
 
-        // Operation not supported.
-        const MMRESULT result = JOYERR_NOCANDO;
-        LOG_UNSUPPORTED_OPERATION();
+        std::scoped_lock lock(joystickCaptureGuard);
+        joystickCaptures[xJoyID].Stop(controllers[xJoyID]);
+
+        const MMRESULT result = JOYERR_NOERROR;
         LOG_INVOCATION(Infra::Message::ESeverity::Info, (unsigned int)uJoyID, result);
         return result;
       }
@@ -905,16 +1424,44 @@ namespace Xidi
 
     MMRESULT __stdcall joySetCapture(HWND hwnd, UINT uJoyID, UINT uPeriod, BOOL fChanged)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
 
       if (realJoyID < 0)
       {
         // Querying an XInput controller.
+        const Controller::TControllerIdentifier xJoyID =
+            (Controller::TControllerIdentifier)((-realJoyID) - 1);
 
-        // Operation not supported.
-        const MMRESULT result = JOYERR_NOCANDO;
-        LOG_UNSUPPORTED_OPERATION();
+        // Joystick messages only exist for the first two joysticks.
+        if ((uJoyID > JOYSTICKID2) || (FALSE == IsWindow(hwnd)))
+        {
+          const MMRESULT result = JOYERR_PARMS;
+          LOG_INVOCATION(Infra::Message::ESeverity::Info, (unsigned int)uJoyID, result);
+          return result;
+        }
+
+        std::scoped_lock lock(joystickCaptureGuard);
+
+        if (true == joystickCaptures[xJoyID].IsActive())
+        {
+          const MMRESULT result = JOYERR_NOCANDO;
+          LOG_INVOCATION(Infra::Message::ESeverity::Info, (unsigned int)uJoyID, result);
+          return result;
+        }
+
+        const UINT capturePeriod =
+            std::clamp(uPeriod, kCapturePeriodMinMilliseconds, kCapturePeriodMaxMilliseconds);
+        const bool captureStarted = joystickCaptures[xJoyID].Start(
+            controllers[xJoyID],
+            hwnd,
+            ((JOYSTICKID1 == uJoyID) ? 0 : (MM_JOY2MOVE - MM_JOY1MOVE)),
+            capturePeriod,
+            (FALSE != fChanged));
+
+        const MMRESULT result = ((true == captureStarted) ? JOYERR_NOERROR : JOYERR_NOCANDO);
         LOG_INVOCATION(Infra::Message::ESeverity::Info, (unsigned int)uJoyID, result);
         return result;
       }
@@ -930,6 +1477,8 @@ namespace Xidi
 
     MMRESULT __stdcall joySetThreshold(UINT uJoyID, UINT uThreshold)
     {
+      PROFILE_API_CALL();
+
       Initialize();
       const int realJoyID = TranslateApplicationJoyIndex(uJoyID);
 
@@ -0,0 +1,202 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file XInputDeviceInterfaces.cpp
+ *   Implementation of functionality for identifying XInput devices using the system's list of
+ *   device interfaces, without needing to create DirectInput device objects.
+ **************************************************************************************************/
+
+#include "XInputDeviceInterfaces.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+#include <Infra/Core/Strings.h>
+#include <Infra/Core/TemporaryBuffer.h>
+
+#include "ApiWindows.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace XInputDeviceInterfaces
+  {
+    /// Device interface class GUID for HID devices, which is `GUID_DEVINTERFACE_HID` in the
+    /// Windows headers. Reproduced here to avoid needing to link against the HID library.
+    static constexpr GUID kHidDeviceInterfaceClassGuid = {
+        0x4d1e55b2, 0xf16f, 0x11cf, {0x88, 0xcb, 0x00, 0x11, 0x11, 0x00, 0x00, 0x30}};
+
+    /// Last 8 bytes of a DirectInput product GUID that holds vendor and product IDs in its first 4
+    /// bytes. The second and third fields of such a GUID are both 0.
+    static constexpr uint8_t kProductGuidVendorProductIdSuffix[8] = {
+        0x00, 0x00, 'P', 'I', 'D', 'V', 'I', 'D'};
+
+    /// Holds the results of reading the system's list of device interfaces.
+    struct SXInputProducts
+    {
+      /// Device change count at the time the list was read.
+      uint64_t deviceChangeCount;
+
+      /// Whether or not the list could be read.
+      bool available;
+
+      /// Vendor and product IDs of all XInput devices in the list, in the same format as the first
+      /// field of a DirectInput product GUID. The product ID occupies the upper 16 bits and the
+      /// vendor ID occupies the lower 16 bits.
+      std::unordered_set<uint32_t> vendorProductIds;
+    };
+
+    /// Function pointer types for the Configuration Manager functions used to read the list of
+    /// device interfaces. These are imported dynamically, like the device change notification
+    /// functions, so that Xidi does not acquire a load-time dependency on the Configuration
+    /// Manager library.
+    using TCMGetDeviceInterfaceListSize = decltype(&CM_Get_Device_Interface_List_SizeW);
+    using TCMGetDeviceInterfaceList = decltype(&CM_Get_Device_Interface_ListW);
+
+    /// Extracts the vendor and product IDs from a device interface path.
+    /// @param [in] devicePath Device interface path to parse.
+    /// @return Vendor and product IDs in the same format as the first field of a DirectInput
+    /// product GUID, or no value if the path does not contain both.
+    static std::optional<uint32_t> VendorProductIdFromDevicePath(std::wstring_view devicePath)
+    {
+      static constexpr std::wstring_view kVendorIdPrefix = L"VID";
+      static constexpr std::wstring_view kProductIdPrefix = L"PID";
+
+      Infra::TemporaryVector<std::wstring_view> pieces =
+          Infra::Strings::Split<wchar_t>(devicePath, {L"_", L"&", L"#", L"\\"});
+
+      std::optional<uint16_t> vendorId, productId;
+
+      for (unsigned int i = 0; (i + 1) < pieces.Size(); ++i)
+      {
+        const bool isVendorId = Infra::Strings::EqualsCaseInsensitive(pieces[i], kVendorIdPrefix);
+        const bool isProductId = Infra::Strings::EqualsCaseInsensitive(pieces[i], kProductIdPrefix);
+        if ((false == isVendorId) && (false == isProductId)) continue;
+
+        const std::wstring_view idString = pieces[++i];
+        if ((0 == idString.length()) || (idString.length() > 4)) continue;
+
+        // Pieces are views into the original null-terminated path, and whatever separator
+        // follows each identifier is not a hexadecimal digit, so parsing stops in the right place.
+        const uint16_t id = (uint16_t)wcstoul(idString.data(), nullptr, 16);
+        if (true == isVendorId)
+          vendorId = id;
+        else
+          productId = id;
+      }
+
+      if ((false == vendorId.has_value()) || (false == productId.has_value())) return std::nullopt;
+      return ((uint32_t)*productId << 16) | (uint32_t)*vendorId;
+    }
+
+    /// Reads the system's list of present HID device interfaces and identifies the XInput devices
+    /// among them. The documented way of determining if a device supports XInput is to look for
+    /// "&IG_" in its device path string.
+    /// @param [in] deviceChangeCount Device change count to record alongside the results.
+    /// @return Results of reading the list.
+    static SXInputProducts ReadXInputProducts(uint64_t deviceChangeCount)
+    {
+      SXInputProducts xinputProducts = {
+          .deviceChangeCount = deviceChangeCount, .available = false, .vendorProductIds = {}};
+
+      static const HMODULE cfgmgrLibrary = LoadLibraryEx(
+          Strings::kStrLibraryNameCfgMgr32.data(), nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32);
+      if (nullptr == cfgmgrLibrary) return xinputProducts;
+
+      static const TCMGetDeviceInterfaceListSize cmGetDeviceInterfaceListSize =
+          reinterpret_cast<TCMGetDeviceInterfaceListSize>(
+              GetProcAddress(cfgmgrLibrary, "CM_Get_Device_Interface_List_SizeW"));
+      static const TCMGetDeviceInterfaceList cmGetDeviceInterfaceList =
+          reinterpret_cast<TCMGetDeviceInterfaceList>(
+              GetProcAddress(cfgmgrLibrary, "CM_Get_Device_Interface_ListW"));
+      if ((nullptr == cmGetDeviceInterfaceListSize) || (nullptr == cmGetDeviceInterfaceList))
+        return xinputProducts;
+
+      // The list can grow between querying its size and reading it, in which case the read fails
+      // and needs to be retried with a larger buffer.
+      std::vector<wchar_t> deviceInterfaceList;
+      CONFIGRET result = CR_BUFFER_SMALL;
+      while (CR_BUFFER_SMALL == result)
+      {
+        ULONG deviceInterfaceListLength = 0;
+        result = cmGetDeviceInterfaceListSize(
+            &deviceInterfaceListLength,
+            const_cast<LPGUID>(&kHidDeviceInterfaceClassGuid),
+            nullptr,
+            CM_GET_DEVICE_INTERFACE_LIST_PRESENT);
+        if (CR_SUCCESS != result) break;
+
+        deviceInterfaceList.resize(deviceInterfaceListLength);
+        result = cmGetDeviceInterfaceList(
+            const_cast<LPGUID>(&kHidDeviceInterfaceClassGuid),
+            nullptr,
+            deviceInterfaceList.data(),
+            deviceInterfaceListLength,
+            CM_GET_DEVICE_INTERFACE_LIST_PRESENT);
+      }
+
+      if (CR_SUCCESS != result)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Unable to read the list of HID device interfaces (result = 0x%08x). XInput devices will be identified by creating DirectInput device objects instead.",
+            static_cast<unsigned int>(result));
+        return xinputProducts;
+      }
+
+      // The list is a sequence of null-terminated strings that ends with an empty string.
+      for (const wchar_t* devicePath = deviceInterfaceList.data(); L'\0' != *devicePath;
+           devicePath += (wcslen(devicePath) + 1))
+      {
+        if ((nullptr == wcsstr(devicePath, L"&IG_")) && (nullptr == wcsstr(devicePath, L"&ig_")))
+          continue;
+
+        const std::optional<uint32_t> vendorProductId = VendorProductIdFromDevicePath(devicePath);
+        if (false == vendorProductId.has_value()) continue;
+
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Debug,
+            L"Device interface with path \"%s\" identifies an XInput device.",
+            devicePath);
+        xinputProducts.vendorProductIds.insert(*vendorProductId);
+      }
+
+      xinputProducts.available = true;
+      return xinputProducts;
+    }
+
+    std::optional<bool> DoesProductSupportXInput(REFGUID productGUID, uint64_t deviceChangeCount)
+    {
+      static std::mutex xinputProductsMutex;
+      static std::optional<SXInputProducts> xinputProducts;
+
+      if ((0 != productGUID.Data2) || (0 != productGUID.Data3) ||
+          (0 !=
+           memcmp(
+               productGUID.Data4,
+               kProductGuidVendorProductIdSuffix,
+               sizeof(kProductGuidVendorProductIdSuffix))))
+        return std::nullopt;
+
+      std::scoped_lock lock(xinputProductsMutex);
+
+      if ((false == xinputProducts.has_value()) ||
+          (deviceChangeCount != xinputProducts->deviceChangeCount))
+        xinputProducts = ReadXInputProducts(deviceChangeCount);
+
+      if (false == xinputProducts->available) return std::nullopt;
+      return (0 != xinputProducts->vendorProductIds.count((uint32_t)productGUID.Data1));
+    }
+  } // namespace XInputDeviceInterfaces
+} // namespace Xidi
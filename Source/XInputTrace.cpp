@@ -0,0 +1,334 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2025
+ ***********************************************************************************************//**
+ * @file XInputTrace.cpp
+ *   Implementation of functionality for recording XInput state queries to a trace file and
+ *   replaying them in place of the native XInput library.
+ **************************************************************************************************/
+
+#include "XInputTrace.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <Infra/Core/Message.h>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Globals.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace XInputTrace
+  {
+    using Controller::kMaxPhysicalControllerCount;
+    using Controller::TControllerIdentifier;
+
+    /// Number of records to accumulate before writing them to the trace file.
+    static constexpr size_t kRecordBatchSize = 256;
+
+    /// Maximum number of records that are accepted from a trace file being loaded for replay.
+    static constexpr size_t kReplayMaxRecordCount = 64 * 1024 * 1024 / sizeof(SRecord);
+
+    /// Holds all of the state needed for recording.
+    struct SRecordingState
+    {
+      /// Serializes access to everything else in this structure.
+      std::mutex mutex;
+
+      /// Handle to the open trace file.
+      HANDLE file = INVALID_HANDLE_VALUE;
+
+      /// Performance counter value at the time recording started.
+      LARGE_INTEGER startTime = {};
+
+      /// Performance counter value at the time records were most recently written to the file.
+      LARGE_INTEGER lastWriteTime = {};
+
+      /// Maximum amount of time, in performance counter units, that records are held before they
+      /// are written to the file.
+      int64_t maxWriteDelay = 0;
+
+      /// Records that have not yet been written to the file.
+      std::vector<SRecord> pendingRecords;
+    };
+
+    /// Holds all of the state needed for replay.
+    struct SReplayState
+    {
+      /// Recorded state queries, one sequence per physical controller, in the order in which they
+      /// were recorded.
+      std::array<std::vector<SRecord>, kMaxPhysicalControllerCount> records;
+
+      /// Index of the next record to hand out, one per physical controller.
+      std::array<std::atomic<size_t>, kMaxPhysicalControllerCount> nextRecordIndex;
+    };
+
+    /// Singleton recording state.
+    static SRecordingState recordingState;
+
+    /// Singleton replay state.
+    static SReplayState replayState;
+
+    /// Retrieves the trace filename specified by a configuration setting.
+    /// @param [in] settingName Name of the configuration setting within the XInput trace section.
+    /// @return Configured filename, or an empty view if the setting is absent.
+    static std::wstring_view ConfiguredFilename(std::wstring_view settingName)
+    {
+      const auto& configData = Globals::GetConfigurationData();
+      if (false == configData.Contains(Strings::kStrConfigurationSectionXInputTrace)) return {};
+
+      const auto& traceConfigData = configData[Strings::kStrConfigurationSectionXInputTrace];
+      if (false == traceConfigData.Contains(settingName)) return {};
+
+      return traceConfigData[settingName]->GetString();
+    }
+
+    /// Writes all pending records to the trace file. Must be invoked with the recording state
+    /// mutex held.
+    static void WritePendingRecords(void)
+    {
+      if (true == recordingState.pendingRecords.empty()) return;
+
+      const DWORD numBytesToWrite =
+          (DWORD)(recordingState.pendingRecords.size() * sizeof(SRecord));
+      DWORD numBytesWritten = 0;
+      if ((0 ==
+           WriteFile(
+               recordingState.file,
+               recordingState.pendingRecords.data(),
+               numBytesToWrite,
+               &numBytesWritten,
+               nullptr)) ||
+          (numBytesToWrite != numBytesWritten))
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Warning,
+            L"Failed to write %u XInput trace record(s), Windows error code %u.",
+            (unsigned int)recordingState.pendingRecords.size(),
+            (unsigned int)GetLastError());
+
+      recordingState.pendingRecords.clear();
+    }
+
+    /// Loads the specified trace file into the replay state.
+    /// @param [in] filename Name of the trace file to load.
+    /// @return `true` if the file was loaded successfully, `false` otherwise.
+    static bool LoadReplayFile(std::wstring_view filename)
+    {
+      HANDLE file = CreateFile(
+          filename.data(),
+          GENERIC_READ,
+          FILE_SHARE_READ,
+          nullptr,
+          OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == file)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Failed to open XInput trace file %s for replay, Windows error code %u.",
+            filename.data(),
+            (unsigned int)GetLastError());
+        return false;
+      }
+
+      SFileHeader fileHeader = {};
+      DWORD numBytesRead = 0;
+      if ((0 == ReadFile(file, &fileHeader, sizeof(fileHeader), &numBytesRead, nullptr)) ||
+          (sizeof(fileHeader) != numBytesRead) || (kFileMagic != fileHeader.magic) ||
+          (kFileVersion != fileHeader.version) || (sizeof(SRecord) != fileHeader.recordSize))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"XInput trace file %s is not a valid trace file or uses an unsupported format version.",
+            filename.data());
+        CloseHandle(file);
+        return false;
+      }
+
+      size_t numRecordsLoaded = 0;
+      SRecord record = {};
+      while ((0 != ReadFile(file, &record, sizeof(record), &numBytesRead, nullptr)) &&
+             (sizeof(record) == numBytesRead) && (numRecordsLoaded < kReplayMaxRecordCount))
+      {
+        if (record.controllerIdentifier >= kMaxPhysicalControllerCount) continue;
+
+        replayState.records[record.controllerIdentifier].push_back(record);
+        numRecordsLoaded += 1;
+      }
+
+      CloseHandle(file);
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Loaded %u record(s) from XInput trace file %s for replay.",
+          (unsigned int)numRecordsLoaded,
+          filename.data());
+      return true;
+    }
+
+    /// Opens the specified trace file for recording and writes its header.
+    /// @param [in] filename Name of the trace file to create.
+    /// @return `true` if the file was created successfully, `false` otherwise.
+    static bool OpenRecordFile(std::wstring_view filename)
+    {
+      HANDLE file = CreateFile(
+          filename.data(),
+          GENERIC_WRITE,
+          FILE_SHARE_READ,
+          nullptr,
+          CREATE_ALWAYS,
+          FILE_ATTRIBUTE_NORMAL,
+          nullptr);
+      if (INVALID_HANDLE_VALUE == file)
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Failed to create XInput trace file %s for recording, Windows error code %u.",
+            filename.data(),
+            (unsigned int)GetLastError());
+        return false;
+      }
+
+      LARGE_INTEGER performanceCounterFrequency = {};
+      QueryPerformanceFrequency(&performanceCounterFrequency);
+
+      const SFileHeader fileHeader = {
+          .magic = kFileMagic,
+          .version = kFileVersion,
+          .recordSize = (uint16_t)sizeof(SRecord),
+          .performanceCounterFrequency = performanceCounterFrequency.QuadPart};
+      DWORD numBytesWritten = 0;
+      if ((0 == WriteFile(file, &fileHeader, sizeof(fileHeader), &numBytesWritten, nullptr)) ||
+          (sizeof(fileHeader) != numBytesWritten))
+      {
+        Infra::Message::OutputFormatted(
+            Infra::Message::ESeverity::Error,
+            L"Failed to write XInput trace file %s, Windows error code %u.",
+            filename.data(),
+            (unsigned int)GetLastError());
+        CloseHandle(file);
+        return false;
+      }
+
+      recordingState.file = file;
+      recordingState.maxWriteDelay = performanceCounterFrequency.QuadPart / 10;
+      recordingState.pendingRecords.reserve(kRecordBatchSize);
+      QueryPerformanceCounter(&recordingState.startTime);
+      recordingState.lastWriteTime = recordingState.startTime;
+
+      Infra::Message::OutputFormatted(
+          Infra::Message::ESeverity::Info,
+          L"Recording XInput state queries to trace file %s.",
+          filename.data());
+      return true;
+    }
+
+    bool IsRecording(void)
+    {
+      static const bool kIsRecording = []() -> bool
+      {
+        const std::wstring_view filename =
+            ConfiguredFilename(Strings::kStrConfigurationSettingXInputTraceRecordFile);
+        if (true == filename.empty()) return false;
+
+        return OpenRecordFile(filename);
+      }();
+
+      return kIsRecording;
+    }
+
+    bool IsReplaying(void)
+    {
+      static const bool kIsReplaying = []() -> bool
+      {
+        const std::wstring_view filename =
+            ConfiguredFilename(Strings::kStrConfigurationSettingXInputTraceReplayFile);
+        if (true == filename.empty()) return false;
+
+        return LoadReplayFile(filename);
+      }();
+
+      return kIsReplaying;
+    }
+
+    void Record(
+        TControllerIdentifier controllerIdentifier, DWORD result, const XINPUT_STATE& xinputState)
+    {
+      if (false == IsRecording()) return;
+
+      LARGE_INTEGER now = {};
+      QueryPerformanceCounter(&now);
+
+      SRecord record = {
+          .timestamp = 0,
+          .result = (uint32_t)result,
+          .controllerIdentifier = (uint8_t)controllerIdentifier};
+      if (ERROR_SUCCESS == result)
+      {
+        record.packetNumber = (uint32_t)xinputState.dwPacketNumber;
+        record.buttons = xinputState.Gamepad.wButtons;
+        record.trigger[0] = xinputState.Gamepad.bLeftTrigger;
+        record.trigger[1] = xinputState.Gamepad.bRightTrigger;
+        record.stick[0] = xinputState.Gamepad.sThumbLX;
+        record.stick[1] = xinputState.Gamepad.sThumbLY;
+        record.stick[2] = xinputState.Gamepad.sThumbRX;
+        record.stick[3] = xinputState.Gamepad.sThumbRY;
+      }
+
+      std::scoped_lock lock(recordingState.mutex);
+
+      record.timestamp = now.QuadPart - recordingState.startTime.QuadPart;
+      recordingState.pendingRecords.push_back(record);
+
+      if ((recordingState.pendingRecords.size() >= kRecordBatchSize) ||
+          ((now.QuadPart - recordingState.lastWriteTime.QuadPart) >= recordingState.maxWriteDelay))
+      {
+        WritePendingRecords();
+        recordingState.lastWriteTime = now;
+      }
+    }
+
+    DWORD __stdcall ReplayXInputGetState(DWORD dwUserIndex, XINPUT_STATE* pState)
+    {
+      if (dwUserIndex >= kMaxPhysicalControllerCount) return ERROR_BAD_ARGUMENTS;
+
+      const std::vector<SRecord>& records = replayState.records[dwUserIndex];
+      const size_t recordIndex =
+          replayState.nextRecordIndex[dwUserIndex].fetch_add(1, std::memory_order_relaxed);
+      if (recordIndex >= records.size()) return ERROR_DEVICE_NOT_CONNECTED;
+
+      const SRecord& record = records[recordIndex];
+      if (ERROR_SUCCESS == record.result)
+        *pState = {
+            .dwPacketNumber = record.packetNumber,
+            .Gamepad = {
+                .wButtons = record.buttons,
+                .bLeftTrigger = record.trigger[0],
+                .bRightTrigger = record.trigger[1],
+                .sThumbLX = record.stick[0],
+                .sThumbLY = record.stick[1],
+                .sThumbRX = record.stick[2],
+                .sThumbRY = record.stick[3]}};
+
+      return (DWORD)record.result;
+    }
+
+    DWORD __stdcall ReplayXInputSetState(DWORD dwUserIndex, XINPUT_VIBRATION* pVibration)
+    {
+      if (dwUserIndex >= kMaxPhysicalControllerCount) return ERROR_BAD_ARGUMENTS;
+      if (true == replayState.records[dwUserIndex].empty()) return ERROR_DEVICE_NOT_CONNECTED;
+
+      return ERROR_SUCCESS;
+    }
+  } // namespace XInputTrace
+} // namespace Xidi
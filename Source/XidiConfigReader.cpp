@@ -11,9 +11,13 @@
 
 #include "XidiConfigReader.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <string_view>
 
 #include <Infra/Core/Configuration.h>
@@ -21,11 +25,14 @@
 #include <Infra/Core/TemporaryBuffer.h>
 
 #include "ApiWindows.h"
+#include "ImportApiXInput.h"
+#include "Settings.h"
 #include "Strings.h"
 
 #ifndef XIDI_SKIP_MAPPERS
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
+#include "ElementMapperCache.h"
 #include "Mapper.h"
 #include "MapperBuilder.h"
 #include "MapperParser.h"
@@ -38,22 +45,6 @@ namespace Xidi
 #ifndef XIDI_SKIP_MAPPERS
   /// Default name for a custom mapper whose name is not specified.
   static constexpr std::wstring_view kDefaultCustomMapperName = L"Custom";
-
-  /// Enumerates the possible operations to be performed on a custom mapper blueprint.
-  enum class EBlueprintOperation
-  {
-    /// Indicates an error.
-    Error,
-
-    /// Set an element mapper for a controller element.
-    SetElementMapper,
-
-    /// Set a force feedback actuator configuration for a physical force feedback actuator.
-    SetForceFeedbackActuator,
-
-    /// Set the blueprint template.
-    SetTemplate,
-  };
 #endif
 
   /// Holds the layout of the Xidi configuration file that is known statically.
@@ -65,12 +56,26 @@ namespace Xidi
                   Strings::kStrConfigurationSettingLogEnabled, EValueType::Boolean),
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingLogLevel, EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogAsynchronous, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogApiCallProfile, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogInputLatencyTrace, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogLiveMetrics, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogStartupTrace, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogStartupTraceEvents, EValueType::Boolean),
           }),
       ConfigurationFileLayoutSection(
           Strings::kStrConfigurationSectionMapper,
           {
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingMapperType, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingMapperReloadOnChange, EValueType::Boolean),
           }),
       ConfigurationFileLayoutSection(
           Strings::kStrConfigurationSectionProperties,
@@ -81,9 +86,128 @@ namespace Xidi
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingPropertiesMouseSpeedScalingFactorPercent,
                   EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesAxisExtrapolation,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesBackgroundPollingPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesCoalesceAxisEvents,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesControllerStatusPeriodSeconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesCooperativeMode, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesForceFeedbackAveraging,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesForceFeedbackPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesForceFeedbackWritePeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesForceFeedbackWriteThresholdPercent,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesGuideButton, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesHighResolutionPolling,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesIncrementalDeviceState,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesIncrementalMapping,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesKeyboardDirectInput,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesKeyboardPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesKeyboardRepeatDelayMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesKeyboardRepeatPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesKeyboardSynchronous,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesMotionFullScaleDegreesPerSecond,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesMotionPitch, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesMotionRoll, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesMotionYaw, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesMousePeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesMouseWheelHighResolution,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesOnDemandPolling, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPipelinedPolling,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPollingAlignment,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPollingPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesSingleThreadedPolling,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesStateChangeEventAxisThresholdPercent,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesStateChangeEventPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPrewarmControllers,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesSharePhysicalControllerState,
+                  EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPhysicalControllerBackend,
+                  EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesXInputLibrary, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPhysicalControllerCount,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesPhysicalControllerMask,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesStickNoiseThreshold,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesTriggerNoiseThreshold,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesLatencyCriticalThreadCores,
+                  EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesHousekeepingThreadCores,
+                  EValueType::String),
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingsPropertiesUseBuiltinProperties,
                   EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingsPropertiesVirtualControllersOnly,
+                  EValueType::Boolean),
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickLeft,
                   EValueType::Integer),
@@ -130,6 +254,31 @@ namespace Xidi
                   Strings::kStrConfigurationSettingsWorkaroundsUseShortVirtualControllerNames,
                   EValueType::Boolean),
           }),
+      ConfigurationFileLayoutSection(
+          Strings::kStrConfigurationSectionFlightRecorder,
+          {
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingFlightRecorderCrashDumpFile,
+                  EValueType::String),
+          }),
+      ConfigurationFileLayoutSection(
+          Strings::kStrConfigurationSectionXInputTrace,
+          {
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingXInputTraceRecordFile, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingXInputTraceReplayFile, EValueType::String),
+          }),
+      ConfigurationFileLayoutSection(
+          Strings::kStrConfigurationSectionAutoTune,
+          {
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingAutoTuneLearn, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingAutoTuneSaveProfile, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingAutoTuneUseProfile, EValueType::Boolean),
+          }),
   };
 
 #ifndef XIDI_SKIP_MAPPERS
@@ -153,6 +302,11 @@ namespace Xidi
     if (true == Controller::MapperParser::IsForceFeedbackActuatorStringValid(name))
       return EBlueprintOperation::SetForceFeedbackActuator;
 
+    // If the configuration setting name identifies a valid chord, then the value should be parsed
+    // for a chord to be assigned.
+    if (true == Controller::MapperParser::IsChordStringValid(name))
+      return EBlueprintOperation::SetChord;
+
     // If the configuration setting name is known and contained within the map above, simply return
     // it.
     const auto blueprintOperationIter = kBlueprintOperationsMap.find(name);
@@ -161,6 +315,33 @@ namespace Xidi
 
     return EBlueprintOperation::Error;
   }
+
+  /// Initial value of the hash of a custom mapper section that contains no settings.
+  static constexpr uint64_t kCustomMapperSectionHashInitial = 14695981039346656037ull;
+
+  /// Incorporates a single configuration setting into the hash of the custom mapper section that
+  /// contains it. Uses the 64-bit variant of FNV-1a, with the name and value separated so that
+  /// moving characters from one to the other changes the hash.
+  /// @param [in,out] sectionHash Hash of the custom mapper section to be updated.
+  /// @param [in] name Name of the configuration setting.
+  /// @param [in] value Value of the configuration setting.
+  static void UpdateCustomMapperSectionHash(
+      uint64_t& sectionHash, std::wstring_view name, std::wstring_view value)
+  {
+    constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+    for (std::wstring_view hashedString : {name, value})
+    {
+      for (const wchar_t hashedChar : hashedString)
+      {
+        sectionHash ^= (uint64_t)hashedChar;
+        sectionHash *= kFnvPrime;
+      }
+
+      // Null characters cannot appear in configuration settings, so they act as separators.
+      sectionHash *= kFnvPrime;
+    }
+  }
 #endif
 
   /// Checks if the specified section name could correspond with a section that defines a custom
@@ -211,9 +392,190 @@ namespace Xidi
   }
 #endif
 
+  SSettings XidiConfigReader::ExtractSettings(const ConfigurationData& configData)
+  {
+    SSettings settings;
+
+    // Each setting starts out at its built-in default, which is kept if the setting is absent.
+    auto readBoolean = [](const auto& sectionData, std::wstring_view name, bool& setting) -> void
+    {
+      setting = sectionData[name].ValueOr(setting);
+    };
+    auto readInteger = []<typename IntegerType>(
+                           const auto& sectionData, std::wstring_view name, IntegerType& setting)
+        -> void
+    {
+      setting = static_cast<IntegerType>(sectionData[name].ValueOr(static_cast<int64_t>(setting)));
+    };
+
+    const auto& propertiesData = configData[Strings::kStrConfigurationSectionProperties];
+    SSettings::SProperties& properties = settings.properties;
+
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesAxisExtrapolation,
+        properties.axisExtrapolation);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesBackgroundPollingPeriodMilliseconds,
+        properties.backgroundPollingPeriodMilliseconds);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesCoalesceAxisEvents,
+        properties.coalesceAxisEvents);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesControllerStatusPeriodSeconds,
+        properties.controllerStatusPeriodSeconds);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesCooperativeMode,
+        properties.cooperativeMode);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesForceFeedbackAveraging,
+        properties.forceFeedbackAveraging);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesForceFeedbackPeriodMilliseconds,
+        properties.forceFeedbackPeriodMilliseconds);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesForceFeedbackWritePeriodMilliseconds,
+        properties.forceFeedbackWritePeriodMilliseconds);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesForceFeedbackWriteThresholdPercent,
+        properties.forceFeedbackWriteThresholdPercent);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesGuideButton,
+        properties.guideButton);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesHighResolutionPolling,
+        properties.highResolutionPolling);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesIncrementalDeviceState,
+        properties.incrementalDeviceState);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesIncrementalMapping,
+        properties.incrementalMapping);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesKeyboardDirectInput,
+        properties.keyboardDirectInput);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesKeyboardPeriodMilliseconds,
+        properties.keyboardPeriodMilliseconds);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesKeyboardRepeatDelayMilliseconds,
+        properties.keyboardRepeatDelayMilliseconds);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesKeyboardRepeatPeriodMilliseconds,
+        properties.keyboardRepeatPeriodMilliseconds);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesKeyboardSynchronous,
+        properties.keyboardSynchronous);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesMousePeriodMilliseconds,
+        properties.mousePeriodMilliseconds);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesMouseWheelHighResolution,
+        properties.mouseWheelHighResolution);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesOnDemandPolling,
+        properties.onDemandPolling);
+    properties.physicalControllerCount =
+        static_cast<Controller::TControllerIdentifier>(std::clamp<int64_t>(
+            propertiesData[Strings::kStrConfigurationSettingsPropertiesPhysicalControllerCount]
+                .ValueOr(properties.physicalControllerCount),
+            1,
+            Controller::kMaxPhysicalControllerCount));
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesPhysicalControllerMask,
+        properties.physicalControllerMask);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesPipelinedPolling,
+        properties.pipelinedPolling);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesPollingAlignment,
+        properties.pollingAlignment);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesPollingPeriodMilliseconds,
+        properties.pollingPeriodMilliseconds);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesSharePhysicalControllerState,
+        properties.sharePhysicalControllerState);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesSingleThreadedPolling,
+        properties.singleThreadedPolling);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesStateChangeEventAxisThresholdPercent,
+        properties.stateChangeEventAxisThresholdPercent);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesStateChangeEventPeriodMilliseconds,
+        properties.stateChangeEventPeriodMilliseconds);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesStickNoiseThreshold,
+        properties.stickNoiseThreshold);
+    readInteger(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesTriggerNoiseThreshold,
+        properties.triggerNoiseThreshold);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesUseBuiltinProperties,
+        properties.useBuiltinProperties);
+    readBoolean(
+        propertiesData,
+        Strings::kStrConfigurationSettingsPropertiesVirtualControllersOnly,
+        properties.virtualControllersOnly);
+
+    const auto& workaroundsData = configData[Strings::kStrConfigurationSectionWorkarounds];
+    SSettings::SWorkarounds& workarounds = settings.workarounds;
+
+    readInteger(
+        workaroundsData,
+        Strings::kStrConfigurationSettingWorkaroundsActiveVirtualControllerMask,
+        workarounds.activeVirtualControllerMask);
+    readBoolean(
+        workaroundsData,
+        Strings::kStrConfigurationSettingsWorkaroundsIgnoreEnumObjectsCallbackReturnCode,
+        workarounds.ignoreEnumObjectsCallbackReturnCode);
+    readInteger(
+        workaroundsData,
+        Strings::kStrConfigurationSettingWorkaroundsPollReturnCode,
+        workarounds.pollReturnCode);
+    readBoolean(
+        workaroundsData,
+        Strings::kStrConfigurationSettingsWorkaroundsUseShortVirtualControllerNames,
+        workarounds.useShortVirtualControllerNames);
+
+    return settings;
+  }
+
   Action XidiConfigReader::ActionForSection(std::wstring_view section)
   {
-#ifndef XIDI_SKIP_MAPPERS
+#if !defined(XIDI_SKIP_MAPPERS) && !defined(XIDI_SKIP_CUSTOM_MAPPERS)
     if ((nullptr != customMapperBuilder) && (true == IsCustomMapperSectionName(section)))
     {
       std::optional<std::wstring_view> customMapperName = ExtractCustomMapperName(section);
@@ -225,6 +587,10 @@ namespace Xidi
             L"%s: A mapper with this name already exists.", customMapperName.value().data()));
       }
 
+      if (nullptr != customMapperSectionHashes)
+        customMapperSectionHashes->insert_or_assign(
+            std::wstring(customMapperName.value()), kCustomMapperSectionHashInitial);
+
       return Action::Process();
     }
 #else
@@ -240,7 +606,9 @@ namespace Xidi
       std::wstring_view section, std::wstring_view name, TIntegerView value)
   {
 #ifndef XIDI_SKIP_MAPPERS
-    if (Strings::kStrConfigurationSectionProperties == section)
+    // Per-controller properties sections are validated the same way as the controller-independent
+    // properties section.
+    if (true == section.starts_with(Strings::kStrConfigurationSectionProperties))
     {
       if (Strings::kStrConfigurationSettingPropertiesMouseSpeedScalingFactorPercent == name)
       {
@@ -249,6 +617,55 @@ namespace Xidi
 
         if (value < 0) return Action::Error();
       }
+      else if (Strings::kStrConfigurationSettingsPropertiesPhysicalControllerCount == name)
+      {
+        // At least one physical controller must be supported, and no more than the number for
+        // which per-controller data structures are sized.
+
+        if ((value < 1) || (value > Controller::kMaxPhysicalControllerCount))
+          return Action::Error();
+        else
+          return Action::Process();
+      }
+      else if (Strings::kStrConfigurationSettingsPropertiesPhysicalControllerMask == name)
+      {
+        // At least one physical controller must be enabled, and there are only as many bits as the
+        // maximum number of physical controllers.
+
+        if ((value < 1) || (value >= ((int64_t)1 << Controller::kMaxPhysicalControllerCount)))
+          return Action::Error();
+        else
+          return Action::Process();
+      }
+      else if (Strings::kStrConfigurationSettingsPropertiesMotionFullScaleDegreesPerSecond == name)
+      {
+        // Full-scale motion must be representable in physical motion units.
+
+        if ((value < 1) ||
+            (value > (INT16_MAX / Controller::kPhysicalMotionUnitsPerDegreePerSecond)))
+          return Action::Error();
+        else
+          return Action::Process();
+      }
+      else if (Strings::kStrConfigurationSettingsPropertiesStickNoiseThreshold == name)
+      {
+        // Stick noise threshold is limited to one eighth of the range in each direction, beyond
+        // which it would suppress intentional movement rather than noise.
+
+        if ((value < 0) || (value > 4096))
+          return Action::Error();
+        else
+          return Action::Process();
+      }
+      else if (Strings::kStrConfigurationSettingsPropertiesTriggerNoiseThreshold == name)
+      {
+        // Trigger noise threshold is limited to one eighth of the range, for the same reason.
+
+        if ((value < 0) || (value > 32))
+          return Action::Error();
+        else
+          return Action::Process();
+      }
       else if (name.starts_with(XIDI_CONFIG_PROPERTIES_PREFIX_DEADZONE_PERCENT))
       {
         // Deadzone percentages must be in the range of 0 to 45 inclusive.
@@ -271,6 +688,17 @@ namespace Xidi
         else
           return Action::Process();
       }
+      else if (name.ends_with(XIDI_CONFIG_PROPERTIES_SUFFIX_PERIOD_MILLISECONDS))
+      {
+        // Periods must be in the range of 1 to 1000 milliseconds inclusive.
+        // Anything shorter cannot be honored by the system timers, and anything longer would make
+        // the associated functionality appear to be unresponsive.
+
+        if ((value < 1) || (value > 1000))
+          return Action::Error();
+        else
+          return Action::Process();
+      }
       else if (name.contains(L"Percent"))
       {
         // All other percentages must be between 0 and 100 inclusive.
@@ -301,24 +729,43 @@ namespace Xidi
     {
       std::wstring_view customMapperName = QuickExtractCustomMapperName(section);
 
-      switch (BlueprintOperationFromName(name))
+      if (nullptr != customMapperSectionHashes)
+      {
+        const auto sectionHashIter = customMapperSectionHashes->find(customMapperName);
+        if (customMapperSectionHashes->end() != sectionHashIter)
+          UpdateCustomMapperSectionHash(sectionHashIter->second, name, value);
+      }
+
+      switch (BlueprintOperationForValue(name))
       {
         case EBlueprintOperation::SetElementMapper:
         {
-          Xidi::Controller::MapperParser::ElementMapperOrError maybeElementMapper =
-              Controller::MapperParser::ElementMapperFromString(value);
-          if (false == maybeElementMapper.HasValue())
+          std::optional<std::unique_ptr<Controller::IElementMapper>> maybeCachedElementMapper =
+              ((nullptr != elementMapperCache) ? elementMapperCache->Lookup(value)
+                                               : std::nullopt);
+
+          if (false == maybeCachedElementMapper.has_value())
           {
-            return Action::ErrorWithMessage(Infra::Strings::Format(
-                L"%s: Failed to parse element mapper: %s.",
-                name.data(),
-                maybeElementMapper.Error().c_str()));
-            customMapperBuilder->InvalidateBlueprint(customMapperName);
+            Xidi::Controller::MapperParser::ElementMapperOrError maybeElementMapper =
+                Controller::MapperParser::ElementMapperFromString(value);
+            if (false == maybeElementMapper.HasValue())
+            {
+              return Action::ErrorWithMessage(Infra::Strings::Format(
+                  L"%s: Failed to parse element mapper: %s.",
+                  name.data(),
+                  maybeElementMapper.Error().c_str()));
+              customMapperBuilder->InvalidateBlueprint(customMapperName);
+            }
+
+            if (nullptr != elementMapperCache)
+              elementMapperCache->Record(value, maybeElementMapper.Value().get());
+
+            maybeCachedElementMapper = std::move(maybeElementMapper.Value());
           }
 
           if (false ==
               customMapperBuilder->SetBlueprintElementMapper(
-                  customMapperName, name, std::move(maybeElementMapper.Value())))
+                  customMapperName, name, std::move(maybeCachedElementMapper.value())))
           {
             return Action::ErrorWithMessage(Infra::Strings::Format(
                 L"%s: Internal error: Successfully parsed element mapper but failed to set it on the blueprint.",
@@ -353,6 +800,29 @@ namespace Xidi
           break;
         }
 
+        case EBlueprintOperation::SetChord:
+        {
+          Xidi::Controller::MapperParser::ChordOrError maybeChord =
+              Controller::MapperParser::ChordFromString(value);
+          if (false == maybeChord.HasValue())
+          {
+            customMapperBuilder->InvalidateBlueprint(customMapperName);
+            return Action::ErrorWithMessage(Infra::Strings::Format(
+                L"%s: Failed to parse chord: %s.", name.data(), maybeChord.Error().c_str()));
+          }
+
+          if (false ==
+              customMapperBuilder->SetBlueprintChord(
+                  customMapperName, name, std::move(maybeChord.Value())))
+          {
+            customMapperBuilder->InvalidateBlueprint(customMapperName);
+            return Action::ErrorWithMessage(Infra::Strings::Format(
+                L"%s: Internal error: Successfully parsed chord but failed to set it on the blueprint.",
+                name.data()));
+          }
+          break;
+        }
+
         case EBlueprintOperation::SetTemplate:
         {
           if (false == customMapperBuilder->SetBlueprintTemplate(customMapperName, value))
@@ -374,11 +844,66 @@ namespace Xidi
       // They do not need to be inserted into the configuration data structure.
       return Action::Skip();
     }
+
+    if (Strings::kStrConfigurationSettingsPropertiesPhysicalControllerBackend == name)
+    {
+      // Physical controller backends must be one of the recognized values.
+      if ((Strings::kStrConfigurationValuePhysicalControllerBackendXInput != value) &&
+          (Strings::kStrConfigurationValuePhysicalControllerBackendWindowsGamingInput != value) &&
+          (Strings::kStrConfigurationValuePhysicalControllerBackendRawInput != value))
+        return Action::Error();
+    }
+
+    if (Strings::kStrConfigurationSettingsPropertiesXInputLibrary == name)
+    {
+      // XInput libraries must either be selected by measurement or be one of the supported
+      // libraries.
+      if ((Strings::kStrConfigurationValueXInputLibraryFastest != value) &&
+          (std::none_of(
+              ImportApiXInput::kXInputLibraryNamesOrdered.cbegin(),
+              ImportApiXInput::kXInputLibraryNamesOrdered.cend(),
+              [value](const wchar_t* xinputLibraryName) -> bool
+              {
+                return (value == xinputLibraryName);
+              })))
+        return Action::Error();
+    }
+
+    if ((Strings::kStrConfigurationSettingsPropertiesMotionPitch == name) ||
+        (Strings::kStrConfigurationSettingsPropertiesMotionRoll == name) ||
+        (Strings::kStrConfigurationSettingsPropertiesMotionYaw == name))
+    {
+      // Motion axes must be mapped using valid element mappers.
+      Xidi::Controller::MapperParser::ElementMapperOrError maybeElementMapper =
+          Controller::MapperParser::ElementMapperFromString(value);
+      if (false == maybeElementMapper.HasValue())
+        return Action::ErrorWithMessage(Infra::Strings::Format(
+            L"%s: Failed to parse element mapper: %s.",
+            name.data(),
+            maybeElementMapper.Error().c_str()));
+    }
+
+    if ((Strings::kStrConfigurationSettingsPropertiesLatencyCriticalThreadCores == name) ||
+        (Strings::kStrConfigurationSettingsPropertiesHousekeepingThreadCores == name))
+    {
+      // Thread core types must be one of the recognized values.
+      if ((Strings::kStrConfigurationValueThreadCoresPerformance != value) &&
+          (Strings::kStrConfigurationValueThreadCoresEfficiency != value))
+        return Action::Error();
+    }
 #endif
 
     return Action::Process();
   }
 
+#ifndef XIDI_SKIP_MAPPERS
+  EBlueprintOperation XidiConfigReader::BlueprintOperationForValue(std::wstring_view name)
+  {
+    if (name == lastBlueprintOperationName) return lastBlueprintOperation;
+    return BlueprintOperationFromName(name);
+  }
+#endif
+
   void XidiConfigReader::BeginRead(void)
   {
     static std::once_flag initFlag;
@@ -390,11 +915,37 @@ namespace Xidi
           // Create the per-controller mapper settings types and submit them to the configuration
           // file layout. These are gernerated dynamically based on the number of controllers the
           // system supports.
-          for (Controller::TControllerIdentifier i = 0; i < Controller::kPhysicalControllerCount;
+          for (Controller::TControllerIdentifier i = 0;
+               i < Controller::kMaxPhysicalControllerCount;
                ++i)
             configurationFileLayout[Strings::kStrConfigurationSectionMapper]
                                    [Strings::MapperTypeConfigurationNameString(i)] =
                                        EValueType::String;
+
+          // Create the per-controller properties sections, which can override the settings that
+          // govern how raw analog values read from each physical controller are transformed and
+          // how strongly force feedback effects are played on it.
+          constexpr std::wstring_view kPerControllerPropertiesSettings[] = {
+              Strings::kStrConfigurationSettingPropertiesForceFeedbackEffectStrengthPercent,
+              Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickLeft,
+              Strings::kStrConfigurationSettingsPropertiesCircleToSquarePercentStickRight,
+              Strings::kStrConfigurationSettingsPropertiesDeadzonePercentStickLeft,
+              Strings::kStrConfigurationSettingsPropertiesDeadzonePercentStickRight,
+              Strings::kStrConfigurationSettingsPropertiesDeadzonePercentTriggerLT,
+              Strings::kStrConfigurationSettingsPropertiesDeadzonePercentTriggerRT,
+              Strings::kStrConfigurationSettingsPropertiesSaturationPercentStickLeft,
+              Strings::kStrConfigurationSettingsPropertiesSaturationPercentStickRight,
+              Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerLT,
+              Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerRT};
+
+          for (Controller::TControllerIdentifier i = 0;
+               i < Controller::kMaxPhysicalControllerCount;
+               ++i)
+          {
+            for (const auto& setting : kPerControllerPropertiesSettings)
+              configurationFileLayout[Strings::PropertiesConfigurationSectionString(i)][setting] =
+                  EValueType::Integer;
+          }
         });
   }
 
@@ -402,6 +953,10 @@ namespace Xidi
   {
 #ifndef XIDI_SKIP_MAPPERS
     customMapperBuilder = nullptr;
+    elementMapperCache = nullptr;
+    customMapperSectionHashes = nullptr;
+    lastBlueprintOperationName.clear();
+    lastBlueprintOperation = EBlueprintOperation::Error;
 #endif
   }
 
@@ -414,7 +969,10 @@ namespace Xidi
       // As long as an operation can be located for the specified configuration setting name the
       // result is a string, otherwise it is an error.
 
-      if (EBlueprintOperation::Error == BlueprintOperationFromName(name))
+      lastBlueprintOperationName.assign(name);
+      lastBlueprintOperation = BlueprintOperationFromName(name);
+
+      if (EBlueprintOperation::Error == lastBlueprintOperation)
         return EValueType::Error;
       else
         return EValueType::String;